@@ -28,18 +28,25 @@
 # THE SOFTWARE.
 #
 
+from __future__ import division
+from __future__ import print_function
+import argparse
 import datetime
+import math
 import os
 import re
 import subprocess
 import sys
 
+sys.path.append(os.path.join(os.path.dirname(os.path.realpath(__file__)), "runtestsuite"))
+import png
+
 
 #--------------------------------------------------------------------------------------------------
 # Constants.
 #--------------------------------------------------------------------------------------------------
 
-VERSION = "1.0"
+VERSION = "2.0"
 
 
 #--------------------------------------------------------------------------------------------------
@@ -51,6 +58,15 @@ def safe_make_directory(path):
         os.makedirs(path)
 
 
+def escape_xml(s):
+    return s.replace("&", "&amp;").replace("<", "&lt;").replace(">", "&gt;").replace('"', "&quot;")
+
+
+def get_time_stamp_string(now):
+    # Same format as foundation::get_time_stamp_string(), expected by the benchmark aggregator.
+    return now.strftime("%Y%m%d.%H%M%S.") + "{0:03d}".format(now.microsecond // 1000)
+
+
 #--------------------------------------------------------------------------------------------------
 # Logger.
 #--------------------------------------------------------------------------------------------------
@@ -61,64 +77,213 @@ class Logger:
         now = datetime.datetime.now()
         self.filename = now.strftime("benchmark.%Y%m%d.%H%M%S.txt")
         self.filepath = os.path.join(directory, self.filename)
-        self.file = open(self.filepath, "w", 0)     # 0: no buffering
+        self.file = open(self.filepath, "w")
 
     def get_log_file_path(self):
         return self.filepath
 
     def write(self, s=""):
         self.file.write(s + "\n")
+        self.file.flush()
         print(s)
 
 
+#--------------------------------------------------------------------------------------------------
+# Results file, in the format of foundation::XMLFileBenchmarkListener.
+#--------------------------------------------------------------------------------------------------
+
+class XmlResultsWriter:
+
+    def __init__(self, filepath, suite_name):
+        self.file = open(filepath, "w")
+        self.file.write('<?xml version="1.0" encoding="UTF-8"?>\n')
+        self.file.write("<!-- File generated by appleseed.benchmark {0}. -->\n".format(VERSION))
+        self.file.write('<benchmarkexecution configuration="render">\n')
+        self.file.write('    <benchmarksuite name="{0}">\n'.format(escape_xml(suite_name)))
+
+    def write_case(self, case_name, result):
+        self.file.write('        <benchmarkcase name="{0}">\n'.format(escape_xml(case_name)))
+        self.file.write("            <results>\n")
+        self.file.write("                <iterations>1</iterations>\n")
+        self.file.write("                <measurements>{0}</measurements>\n".format(result.measurement_count))
+        self.file.write("                <frequency>1.000000</frequency>\n")
+        self.file.write("                <ticks>{0:.6f}</ticks>\n".format(result.render_time))
+        if result.samples > 0:
+            self.file.write("                <processeditems>{0}</processeditems>\n".format(result.samples))
+        self.file.write("            </results>\n")
+        for message in result.get_messages():
+            self.file.write("            <message>{0}</message>\n".format(escape_xml(message)))
+        self.file.write("        </benchmarkcase>\n")
+        self.file.flush()
+
+    def close(self):
+        self.file.write("    </benchmarksuite>\n")
+        self.file.write("</benchmarkexecution>\n")
+        self.file.close()
+
+
+#--------------------------------------------------------------------------------------------------
+# Image comparison.
+#--------------------------------------------------------------------------------------------------
+
+def read_png_file(filepath):
+    data = png.Reader(filename=filepath).asRGBA8()
+    return data[0], data[1], list(data[2])
+
+
+# Return the RMS error of the RGB channels of two PNG images, in [0, 1], or None if the
+# images cannot be compared.
+def compute_rms_error(filepath, ref_filepath):
+    width, height, rows = read_png_file(filepath)
+    ref_width, ref_height, ref_rows = read_png_file(ref_filepath)
+
+    if width != ref_width or height != ref_height:
+        return None
+
+    sum_sq = 0
+    for row, ref_row in zip(rows, ref_rows):
+        for i in range(0, len(row), 4):
+            for c in range(3):
+                d = row[i + c] - ref_row[i + c]
+                sum_sq += d * d
+
+    return math.sqrt(sum_sq / (width * height * 3)) / 255.0
+
+
 #--------------------------------------------------------------------------------------------------
 # Benchmarking and reporting code.
 #--------------------------------------------------------------------------------------------------
 
-def benchmark_projects(appleseed_path, appleseed_args, logger):
-    for dirpath, dirnames, filenames in os.walk("."):
+class BenchmarkResult:
+
+    def __init__(self):
+        self.measurement_count = 0
+        self.setup_time = 0.0
+        self.render_time = 0.0
+        self.total_time = 0.0
+        self.samples = 0
+        self.peak_memory = 0
+        self.rms_error = None
+
+    def get_samples_per_second(self):
+        return self.samples / self.render_time if self.render_time > 0.0 else 0.0
+
+    def get_messages(self):
+        messages = ["setup_time={0:.6f}".format(self.setup_time)]
+        if self.samples > 0:
+            messages.append("samples_per_second={0:.1f}".format(self.get_samples_per_second()))
+        messages.append("peak_memory={0}".format(self.peak_memory))
+        if self.rms_error is not None:
+            messages.append("rms_error={0:.6f}".format(self.rms_error))
+        return messages
+
+
+# Return the list of (project path, reference image path or None) of a suite file.
+# Each non-empty line of a suite file is the path to a project file, relative to the suite
+# file; lines starting with # are comments. The reference image of a project, if any, is
+# expected in a ref/ subdirectory next to it, as in the test scenes.
+def load_suite(suite_filepath):
+    suite_directory = os.path.dirname(os.path.abspath(suite_filepath))
+    projects = []
+
+    with open(suite_filepath, "r") as file:
+        for line in file:
+            line = line.strip()
+            if len(line) == 0 or line.startswith("#"):
+                continue
+            projects.append(os.path.normpath(os.path.join(suite_directory, line)))
+
+    return [(project_path, get_reference_image_path(project_path)) for project_path in projects]
+
+
+def find_projects(directory):
+    projects = []
+
+    for dirpath, dirnames, filenames in os.walk(directory):
         if dirpath.endswith(".skip"):
             continue
 
-        for filename in filenames:
+        for filename in sorted(filenames):
             if os.path.splitext(filename)[1] == ".appleseed":
-                benchmark_project(os.path.join(dirpath, filename), appleseed_path, appleseed_args, logger)
+                project_path = os.path.join(dirpath, filename)
+                projects.append((project_path, get_reference_image_path(project_path)))
 
+    return projects
 
-def benchmark_project(project_path, appleseed_path, appleseed_args, logger):
+
+def get_reference_image_path(project_path):
+    project_directory, project_filename = os.path.split(project_path)
+    ref_path = os.path.join(project_directory, "ref", os.path.splitext(project_filename)[0] + ".png")
+    return ref_path if os.path.isfile(ref_path) else None
+
+
+def benchmark_projects(projects, args, logger, results_writer):
+    for project_path, ref_path in projects:
+        result = benchmark_project(project_path, ref_path, args, logger)
+        if result is not None:
+            results_writer.write_case(os.path.splitext(os.path.basename(project_path))[0], result)
+
+
+def benchmark_project(project_path, ref_path, args, logger):
     project_name = os.path.splitext(os.path.split(project_path)[1])[0]
+    output_path = os.path.join(args.renders_directory, project_name + ".png")
 
     logger.write("Benchmarking {0} scene...".format(project_name))
 
-    command_line = [appleseed_path, project_path] + appleseed_args
+    command_line = [args.appleseed_path, project_path] + args.appleseed_args
     command_line += ["--benchmark-mode"]
-    command_line += ["-o", os.path.join("renders", project_name + ".png")]
+    command_line += ["-o", output_path]
+
+    result = BenchmarkResult()
 
-    output = subprocess.check_output(command_line, stderr=subprocess.STDOUT)
+    # Keep the fastest of the repeated renders, which is the least disturbed by other processes.
+    for i in range(args.repeat):
+        try:
+            output = subprocess.check_output(command_line, stderr=subprocess.STDOUT)
+        except subprocess.CalledProcessError as e:
+            output = e.output
 
-    if was_successful(output):
-        process_output(output, logger)
-    else:
-        logger.write(output)
+        if isinstance(output, bytes):
+            output = output.decode("utf-8", "replace")
+
+        if not was_successful(output):
+            logger.write(output)
+            return None
+
+        render_time = float(get_value(output, "render_time"))
+        if result.measurement_count == 0 or render_time < result.render_time:
+            result.setup_time = float(get_value(output, "setup_time"))
+            result.render_time = render_time
+            result.total_time = float(get_value(output, "total_time"))
+            result.samples = int(get_value(output, "samples") or 0)
+            result.peak_memory = int(get_value(output, "peak_memory") or 0)
+        result.measurement_count += 1
+
+    if ref_path is not None and os.path.isfile(output_path):
+        result.rms_error = compute_rms_error(output_path, ref_path)
+
+    print_result(result, logger)
+
+    return result
 
 
 def was_successful(output):
     return get_value(output, "result") == "success"
 
 
-def process_output(output, logger):
-    setup_time = float(get_value(output, "setup_time"))
-    render_time = float(get_value(output, "render_time"))
-    total_time = float(get_value(output, "total_time"))
-
-    logger.write("  Setup Time  : {0} seconds".format(setup_time))
-    logger.write("  Render Time : {0} seconds".format(render_time))
-    logger.write("  Total Time  : {0} seconds".format(total_time))
+def print_result(result, logger):
+    logger.write("  Setup Time  : {0} seconds".format(result.setup_time))
+    logger.write("  Render Time : {0} seconds".format(result.render_time))
+    logger.write("  Total Time  : {0} seconds".format(result.total_time))
+    if result.samples > 0:
+        logger.write("  Samples/s   : {0:.1f}".format(result.get_samples_per_second()))
+    if result.rms_error is not None:
+        logger.write("  RMS Error   : {0:.6f}".format(result.rms_error))
     logger.write()
 
 
 def get_value(output, key):
-    pattern = r"^{0}=(.*)[\r\n]+$".format(key)
+    pattern = r"^{0}=(.*?)\r?$".format(key)
     match = re.search(pattern, output, re.MULTILINE)
     return match.group(1) if match else None
 
@@ -127,36 +292,57 @@ def get_value(output, key):
 # Entry point.
 #--------------------------------------------------------------------------------------------------
 
-def print_configuration(appleseed_path, appleseed_args, logger):
+def print_configuration(args, results_filepath, logger):
     logger.write("Configuration:")
     logger.write("  Log file               : {0}".format(logger.get_log_file_path()))
-    logger.write("  Path to appleseed      : {0}".format(appleseed_path))
-    logger.write("  appleseed command line : {0}".format(" ".join(appleseed_args)))
+    logger.write("  Results file           : {0}".format(results_filepath))
+    logger.write("  Scene suite            : {0}".format(args.suite if args.suite else "current directory"))
+    logger.write("  Renders per scene      : {0}".format(args.repeat))
+    logger.write("  Path to appleseed      : {0}".format(args.appleseed_path))
+    logger.write("  appleseed command line : {0}".format(" ".join(args.appleseed_args)))
     logger.write()
 
 
 def main():
     print("appleseed.benchmark version " + VERSION)
-    print
-
-    if len(sys.argv) < 2:
-        print("Usage: {0} <path-to-appleseed.cli> [arguments]".format(sys.argv[0]))
-        sys.exit(1)
-
-    appleseed_path = sys.argv[1]
-    appleseed_args = sys.argv[2:]
+    print()
+
+    parser = argparse.ArgumentParser(description="benchmark appleseed on a suite of scenes.")
+    parser.add_argument("-s", "--suite", metavar="suite-file",
+                        help="benchmark the scenes listed in this file instead of all the scenes "
+                             "found in the current directory")
+    parser.add_argument("-n", "--repeat", metavar="count", type=int, default=1,
+                        help="render each scene this many times and keep the fastest render")
+    parser.add_argument("-r", "--results-directory", metavar="path", default="results",
+                        help="set the directory where the XML results file is written")
+    parser.add_argument("appleseed_path", metavar="path-to-appleseed.cli")
+    parser.add_argument("appleseed_args", metavar="arguments", nargs=argparse.REMAINDER,
+                        help="forward additional arguments to appleseed")
+    args = parser.parse_args()
+
+    args.renders_directory = "renders"
 
     safe_make_directory("logs")
+    safe_make_directory(args.renders_directory)
+    safe_make_directory(args.results_directory)
+
     logger = Logger("logs")
 
-    print_configuration(appleseed_path, appleseed_args, logger)
+    results_filepath = os.path.join(
+        args.results_directory,
+        "benchmark.{0}.xml".format(get_time_stamp_string(datetime.datetime.now())))
+    results_writer = XmlResultsWriter(results_filepath, "Render")
 
-    safe_make_directory("renders")
+    print_configuration(args, results_filepath, logger)
+
+    projects = load_suite(args.suite) if args.suite else find_projects(".")
 
     start_time = datetime.datetime.now()
-    benchmark_projects(appleseed_path, appleseed_args, logger)
+    benchmark_projects(projects, args, logger, results_writer)
     elapsed_time = datetime.datetime.now() - start_time
 
+    results_writer.close()
+
     logger.write("\nTotal suite time: {0}\n".format(elapsed_time))
 
 if __name__ == '__main__':
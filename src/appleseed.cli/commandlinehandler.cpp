@@ -91,6 +91,17 @@ CommandLineHandler::CommandLineHandler()
             .set_syntax("n")
             .set_exact_value_count(1));
 
+    parser().add_option_handler(
+        &m_active_threads
+            .add_name("--active-threads")
+#ifdef _WIN32
+            .set_description("start rendering with only n of the rendering threads active")
+#else
+            .set_description("start rendering with only n of the rendering threads active, SIGUSR1/SIGUSR2 remove/add one")
+#endif
+            .set_syntax("n")
+            .set_exact_value_count(1));
+
     parser().add_option_handler(
         &m_output.add_name("--output")
             .add_name("-o")
@@ -101,7 +112,22 @@ CommandLineHandler::CommandLineHandler()
     parser().add_option_handler(
         &m_continuous_saving
             .add_name("--continuous-saving")
-            .set_description("write tiles to disk as soon as they are rendered"));
+            .set_description("write tiles to disk as soon as they are rendered, and checkpoint rendering progress"));
+
+    parser().add_option_handler(
+        &m_resume
+            .add_name("--resume")
+            .set_description("resume an interrupted render from its checkpoint (requires --output and --continuous-saving)"));
+
+    parser().add_option_handler(
+        &m_stream_output
+            .add_name("--stream-output")
+            .set_description("write tiles to disk as soon as they are rendered and release their memory (requires --output with an .exr file)"));
+
+    parser().add_option_handler(
+        &m_skip_unchanged
+            .add_name("--skip-unchanged")
+            .set_description("do not render frames whose output file was rendered from the same project, assets and settings"));
 
     parser().add_option_handler(
         &m_resolution
@@ -134,6 +160,26 @@ CommandLineHandler::CommandLineHandler()
             .set_syntax("n")
             .set_exact_value_count(1));
 
+    parser().add_option_handler(
+        &m_time_limit
+            .add_name("--time-limit")
+            .set_description("stop rendering after a given time")
+            .set_syntax("seconds")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_target_noise
+            .add_name("--target-noise")
+            .set_description("stop progressive rendering once the relative noise of the frame, or of every tile, falls below a threshold")
+            .set_syntax("threshold [frame|tile]")
+            .set_min_value_count(1)
+            .set_max_value_count(2));
+
+    parser().add_option_handler(
+        &m_denoise
+            .add_name("--denoise")
+            .set_description("denoise the rendered image using albedo, normal and depth feature aovs"));
+
     parser().add_option_handler(
         &m_override_shading
             .add_name("--override-shading")
@@ -148,6 +194,20 @@ CommandLineHandler::CommandLineHandler()
             .set_syntax("regex")
             .set_exact_value_count(1));
 
+    parser().add_option_handler(
+        &m_frames
+            .add_name("--frames")
+            .set_description("render a range of frames without reloading the project, writing numbered images")
+            .set_syntax("first last")
+            .set_exact_value_count(2));
+
+    parser().add_option_handler(
+        &m_sequence
+            .add_name("--sequence")
+            .set_description("apply per-frame transforms and rendering parameters read from a sequence file")
+            .set_syntax("filename")
+            .set_exact_value_count(1));
+
     parser().add_option_handler(
         &m_mplay_display
             .add_name("--mplay")
@@ -160,6 +220,62 @@ CommandLineHandler::CommandLineHandler()
             .set_syntax("socket")
             .set_exact_value_count(1));
 
+    parser().add_option_handler(
+        &m_coordinator
+            .add_name("--coordinator")
+            .set_description("distribute the frame's tiles to workers connecting to a given port")
+            .set_syntax("port")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_worker
+            .add_name("--worker")
+            .set_description("render tiles handed out by a coordinator")
+            .set_syntax("host:port")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_server
+            .add_name("--server")
+            .set_description("keep running and serve render requests of clients connecting to a given port")
+            .set_syntax("port")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_sample_partition
+            .add_name("--sample-partition")
+            .set_description("render only one of several disjoint partitions of the samples of a progressive render")
+            .set_syntax("index count")
+            .set_exact_value_count(2));
+
+    parser().add_option_handler(
+        &m_save_samples
+            .add_name("--save-samples")
+            .set_description("write the accumulated samples of a progressive render to a file, to be merged with --merge-samples")
+            .set_syntax("filename")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_merge_samples
+            .add_name("--merge-samples")
+            .set_description("merge the samples of partial progressive renders into the frame instead of rendering it")
+            .set_syntax("filename1 [filename2 ...]")
+            .set_min_value_count(1));
+
+    parser().add_option_handler(
+        &m_telemetry_interval
+            .add_name("--telemetry-interval")
+            .set_description("report live progress, throughput and memory usage at a given interval while rendering")
+            .set_syntax("seconds")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_telemetry_output
+            .add_name("--telemetry-output")
+            .set_description("report live telemetry and also publish it in JSON format to a file or to tcp://host:port")
+            .set_syntax("target")
+            .set_exact_value_count(1));
+
     parser().add_option_handler(
         &m_run_unit_tests
             .add_name("--run-unit-tests")
@@ -176,6 +292,13 @@ CommandLineHandler::CommandLineHandler()
             .set_min_value_count(0)
             .set_max_value_count(1));
 
+    parser().add_option_handler(
+        &m_compare_benchmarks
+            .add_name("--compare-benchmarks")
+            .set_description("compare two sets of benchmark results and fail if the candidate significantly regressed")
+            .set_syntax("baseline candidate")
+            .set_exact_value_count(2));
+
     parser().add_option_handler(
         &m_verbose_unit_tests
             .add_name("--verbose-unit-tests")
@@ -186,6 +309,20 @@ CommandLineHandler::CommandLineHandler()
         &m_benchmark_mode
             .add_name("--benchmark-mode")
             .set_description("enable benchmark mode"));
+
+    parser().add_option_handler(
+        &m_trace_file
+            .add_name("--trace-file")
+            .set_description("record a timeline of the render and write it to a file in chrome trace format")
+            .set_syntax("filename")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_statistics_file
+            .add_name("--statistics-file")
+            .set_description("write the render statistics to a file in JSON format")
+            .set_syntax("filename")
+            .set_exact_value_count(1));
 }
 
 void CommandLineHandler::print_program_usage(
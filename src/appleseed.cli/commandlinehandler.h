@@ -66,24 +66,50 @@ class CommandLineHandler
 
     // Aliases for rendering options.
     foundation::ValueOptionHandler<std::string>     m_threads;  // std::string because we need to handle 'auto'
+    foundation::ValueOptionHandler<int>             m_active_threads;
     foundation::ValueOptionHandler<std::string>     m_output;
     foundation::FlagOptionHandler                   m_continuous_saving;
+    foundation::FlagOptionHandler                   m_resume;
+    foundation::FlagOptionHandler                   m_stream_output;
+    foundation::FlagOptionHandler                   m_skip_unchanged;
     foundation::ValueOptionHandler<int>             m_resolution;
     foundation::ValueOptionHandler<int>             m_window;
     foundation::ValueOptionHandler<int>             m_samples;
     foundation::ValueOptionHandler<int>             m_passes;
+    foundation::ValueOptionHandler<double>          m_time_limit;
+    foundation::ValueOptionHandler<std::string>     m_target_noise;
+    foundation::FlagOptionHandler                   m_denoise;
     foundation::ValueOptionHandler<std::string>     m_override_shading;
     foundation::ValueOptionHandler<std::string>     m_select_object_instances;
 
+    // Sequence rendering options.
+    foundation::ValueOptionHandler<int>             m_frames;
+    foundation::ValueOptionHandler<std::string>     m_sequence;
+
     // Houdini-related options.
     foundation::FlagOptionHandler                   m_mplay_display;
     foundation::ValueOptionHandler<int>             m_hrmanpipe_display;
 
+    // Distributed rendering options.
+    foundation::ValueOptionHandler<int>             m_coordinator;
+    foundation::ValueOptionHandler<std::string>     m_worker;
+    foundation::ValueOptionHandler<int>             m_server;
+    foundation::ValueOptionHandler<int>             m_sample_partition;
+    foundation::ValueOptionHandler<std::string>     m_save_samples;
+    foundation::ValueOptionHandler<std::string>     m_merge_samples;
+
+    // Telemetry options.
+    foundation::ValueOptionHandler<double>          m_telemetry_interval;
+    foundation::ValueOptionHandler<std::string>     m_telemetry_output;
+
     // Developer-oriented options.
     foundation::ValueOptionHandler<std::string>     m_run_unit_tests;
     foundation::ValueOptionHandler<std::string>     m_run_unit_benchmarks;
+    foundation::ValueOptionHandler<std::string>     m_compare_benchmarks;
     foundation::FlagOptionHandler                   m_verbose_unit_tests;
     foundation::FlagOptionHandler                   m_benchmark_mode;
+    foundation::ValueOptionHandler<std::string>     m_trace_file;
+    foundation::ValueOptionHandler<std::string>     m_statistics_file;
 
     // Constructor.
     CommandLineHandler();
@@ -0,0 +1,1167 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "distributedrendering.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/aov.h"
+#include "renderer/api/camera.h"
+#include "renderer/api/frame.h"
+#include "renderer/api/project.h"
+#include "renderer/api/rendering.h"
+#include "renderer/api/scene.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exception.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/asio.hpp"
+#include "boost/bind.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+namespace asio = boost::asio;
+using asio::ip::tcp;
+
+namespace appleseed {
+namespace cli {
+
+namespace
+{
+    //
+    // Wire protocol.
+    //
+    // All messages are sequences of 32-bit words sent in network byte order.
+    // Pixels are sent as 32-bit floating point values.
+    //
+
+    const uint32 ProtocolMagic = 0x41534452;        // 'ASDR'
+    const uint32 ProtocolVersion = 1;
+
+    enum MessageType
+    {
+        MessageAccept = 1,      // coordinator -> worker: handshake accepted
+        MessageReject,          // coordinator -> worker: handshake rejected
+        MessageRender,          // coordinator -> worker: render a batch (x0 y0 x1 y1)
+        MessageQuit,            // coordinator -> worker: the frame is complete
+        MessageTile,            // worker -> coordinator: one plane of a tile, followed by its pixels
+        MessageBatchEnd,        // worker -> coordinator: all tiles of the batch were sent
+
+        // Render server messages. Each request is answered by a status message,
+        // preceded by the tiles of the frame and MessageBatchEnd for render requests.
+        MessageLoadProject,     // client -> server: load a project (path)
+        MessageSetParameter,    // client -> server: override a rendering parameter (path, value)
+        MessageSetTransform,    // client -> server: set the transform of a camera or assembly instance (name, 16 values)
+        MessageRenderFrame,     // client -> server: render the frame of the current project
+        MessageDisconnect,      // client -> server: end the session
+        MessageShutdown,        // client -> server: end the session and stop the server
+        MessageStatus           // server -> client: 1 on success or 0 on failure, followed by a message
+    };
+
+    // Handshake: magic, version, canvas width and height, tile width and height,
+    // channel count and number of AOV images.
+    const size_t HandshakeSize = 8;
+
+    // Tile header: tile x, tile y, plane index (0 for the main image), width,
+    // height and channel count.
+    const size_t TileHeaderSize = 6;
+
+    // Render server handshake: magic and version.
+    const size_t ServerHandshakeSize = 2;
+
+    // Maximum length in bytes of a string sent to the render server.
+    const size_t MaxStringLength = 64 * 1024;
+
+    // Maximum number of tiles of a tile row handed out to a worker at once.
+    // Larger batches amortize the per-render setup cost of the workers,
+    // smaller ones balance the load better.
+    const size_t TilesPerBatch = 16;
+
+    void encode_words(const uint32* values, const size_t count, vector<uint8>& bytes)
+    {
+        bytes.resize(count * 4);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            bytes[i * 4 + 0] = static_cast<uint8>(values[i] >> 24);
+            bytes[i * 4 + 1] = static_cast<uint8>(values[i] >> 16);
+            bytes[i * 4 + 2] = static_cast<uint8>(values[i] >> 8);
+            bytes[i * 4 + 3] = static_cast<uint8>(values[i]);
+        }
+    }
+
+    void decode_words(const vector<uint8>& bytes, uint32* values, const size_t count)
+    {
+        assert(bytes.size() == count * 4);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] =
+                (static_cast<uint32>(bytes[i * 4 + 0]) << 24) |
+                (static_cast<uint32>(bytes[i * 4 + 1]) << 16) |
+                (static_cast<uint32>(bytes[i * 4 + 2]) << 8) |
+                 static_cast<uint32>(bytes[i * 4 + 3]);
+        }
+    }
+
+    void write_words(tcp::socket& socket, const uint32* values, const size_t count)
+    {
+        vector<uint8> bytes;
+        encode_words(values, count, bytes);
+        asio::write(socket, asio::buffer(bytes));
+    }
+
+    void read_words(tcp::socket& socket, uint32* values, const size_t count)
+    {
+        vector<uint8> bytes(count * 4);
+        asio::read(socket, asio::buffer(bytes));
+        decode_words(bytes, values, count);
+    }
+
+    void write_word(tcp::socket& socket, const uint32 value)
+    {
+        write_words(socket, &value, 1);
+    }
+
+    uint32 read_word(tcp::socket& socket)
+    {
+        uint32 value;
+        read_words(socket, &value, 1);
+        return value;
+    }
+
+    // Strings are sent as their length in bytes followed by their characters.
+    void write_string(tcp::socket& socket, const string& s)
+    {
+        write_word(socket, static_cast<uint32>(s.size()));
+        asio::write(socket, asio::buffer(s.data(), s.size()));
+    }
+
+    string read_string(tcp::socket& socket)
+    {
+        const size_t length = read_word(socket);
+
+        if (length > MaxStringLength)
+            throw Exception("string too long");
+
+        vector<char> chars(length);
+        if (length > 0)
+            asio::read(socket, asio::buffer(chars));
+
+        return string(chars.begin(), chars.end());
+    }
+
+    void describe_frame(const Frame& frame, uint32 handshake[HandshakeSize])
+    {
+        const CanvasProperties& props = frame.image().properties();
+
+        handshake[0] = ProtocolMagic;
+        handshake[1] = ProtocolVersion;
+        handshake[2] = static_cast<uint32>(props.m_canvas_width);
+        handshake[3] = static_cast<uint32>(props.m_canvas_height);
+        handshake[4] = static_cast<uint32>(props.m_tile_width);
+        handshake[5] = static_cast<uint32>(props.m_tile_height);
+        handshake[6] = static_cast<uint32>(props.m_channel_count);
+        handshake[7] = static_cast<uint32>(frame.aov_images().size());
+    }
+
+    Image& get_plane(const Frame& frame, const size_t plane_index)
+    {
+        return
+            plane_index == 0
+                ? frame.image()
+                : frame.aov_images().get_image(plane_index - 1);
+    }
+
+    //
+    // Coordinator-side connection to a single worker.
+    //
+
+    class WorkerSession
+      : public NonCopyable
+    {
+      public:
+        WorkerSession(
+            tcp::socket*            socket,
+            Frame&                  frame,
+            TileBatchScheduler&     scheduler,
+            ITileCallback*          tile_callback,
+            boost::mutex&           frame_mutex,
+            Logger&                 logger)
+          : m_socket(socket)
+          , m_frame(frame)
+          , m_props(frame.image().properties())
+          , m_scheduler(scheduler)
+          , m_tile_callback(tile_callback)
+          , m_frame_mutex(frame_mutex)
+          , m_logger(logger)
+          , m_batch_count(0)
+        {
+            boost::system::error_code ec;
+            const tcp::endpoint endpoint = m_socket->remote_endpoint(ec);
+            m_name = ec ? "<unknown>" : endpoint.address().to_string() + ":" + foundation::to_string(endpoint.port());
+        }
+
+        void run()
+        {
+            try
+            {
+                if (!handshake())
+                    return;
+
+                LOG_INFO(m_logger, "worker %s connected.", m_name.c_str());
+
+                AABB2u batch;
+
+                while (m_scheduler.acquire(batch))
+                {
+                    try
+                    {
+                        render_batch(batch);
+                    }
+                    catch (...)
+                    {
+                        m_scheduler.abandon(batch);
+                        throw;
+                    }
+
+                    m_scheduler.complete();
+                    ++m_batch_count;
+                }
+
+                write_word(*m_socket, MessageQuit);
+
+                LOG_INFO(
+                    m_logger,
+                    "worker %s rendered %s batch%s.",
+                    m_name.c_str(),
+                    pretty_uint(m_batch_count).c_str(),
+                    m_batch_count > 1 ? "es" : "");
+            }
+            catch (const exception& e)
+            {
+                LOG_WARNING(
+                    m_logger,
+                    "lost worker %s: %s.",
+                    m_name.c_str(),
+                    e.what());
+            }
+        }
+
+      private:
+        auto_ptr<tcp::socket>       m_socket;
+        Frame&                      m_frame;
+        const CanvasProperties&     m_props;
+        TileBatchScheduler&         m_scheduler;
+        ITileCallback*              m_tile_callback;
+        boost::mutex&               m_frame_mutex;
+        Logger&                     m_logger;
+        string                      m_name;
+        size_t                      m_batch_count;
+
+        bool handshake()
+        {
+            uint32 expected[HandshakeSize];
+            describe_frame(m_frame, expected);
+
+            uint32 received[HandshakeSize];
+            read_words(*m_socket, received, HandshakeSize);
+
+            if (!equal(expected, expected + HandshakeSize, received))
+            {
+                LOG_WARNING(
+                    m_logger,
+                    "rejecting worker %s: its frame does not match the frame of this project.",
+                    m_name.c_str());
+                write_word(*m_socket, MessageReject);
+                return false;
+            }
+
+            write_word(*m_socket, MessageAccept);
+            return true;
+        }
+
+        void render_batch(const AABB2u& batch)
+        {
+            const uint32 message[5] =
+            {
+                MessageRender,
+                static_cast<uint32>(batch.min.x),
+                static_cast<uint32>(batch.min.y),
+                static_cast<uint32>(batch.max.x),
+                static_cast<uint32>(batch.max.y)
+            };
+
+            write_words(*m_socket, message, 5);
+
+            while (true)
+            {
+                const uint32 type = read_word(*m_socket);
+
+                if (type == MessageBatchEnd)
+                    break;
+
+                if (type != MessageTile)
+                    throw Exception("unexpected message");
+
+                receive_tile();
+            }
+        }
+
+        void receive_tile()
+        {
+            uint32 header[TileHeaderSize];
+            read_words(*m_socket, header, TileHeaderSize);
+
+            const size_t tile_x = header[0];
+            const size_t tile_y = header[1];
+            const size_t plane_index = header[2];
+
+            if (tile_x >= m_props.m_tile_count_x ||
+                tile_y >= m_props.m_tile_count_y ||
+                plane_index > m_frame.aov_images().size())
+                throw Exception("invalid tile");
+
+            Tile& target = get_plane(m_frame, plane_index).tile(tile_x, tile_y);
+
+            if (header[3] != target.get_width() ||
+                header[4] != target.get_height() ||
+                header[5] != target.get_channel_count())
+                throw Exception("invalid tile dimensions");
+
+            const size_t value_count = target.get_pixel_count() * target.get_channel_count();
+
+            vector<uint8> bytes(value_count * 4);
+            asio::read(*m_socket, asio::buffer(bytes));
+
+            Tile tile(
+                target.get_width(),
+                target.get_height(),
+                target.get_channel_count(),
+                PixelFormatFloat);
+
+            decode_words(bytes, reinterpret_cast<uint32*>(tile.get_storage()), value_count);
+
+            boost::mutex::scoped_lock lock(m_frame_mutex);
+
+            target.copy(tile);
+
+            // Workers send the main image last: the tile is complete.
+            if (plane_index == 0 && m_tile_callback)
+                m_tile_callback->post_render_tile(&m_frame, tile_x, tile_y);
+        }
+    };
+
+
+    //
+    // Accepts incoming worker connections and runs one session thread per worker.
+    //
+
+    class WorkerListener
+      : public NonCopyable
+    {
+      public:
+        WorkerListener(
+            asio::io_service&       io_service,
+            tcp::acceptor&          acceptor,
+            Frame&                  frame,
+            TileBatchScheduler&     scheduler,
+            ITileCallback*          tile_callback,
+            Logger&                 logger)
+          : m_io_service(io_service)
+          , m_acceptor(acceptor)
+          , m_frame(frame)
+          , m_scheduler(scheduler)
+          , m_tile_callback(tile_callback)
+          , m_logger(logger)
+        {
+        }
+
+        ~WorkerListener()
+        {
+            m_threads.join_all();
+
+            for (size_t i = 0; i < m_sessions.size(); ++i)
+                delete m_sessions[i];
+        }
+
+        void start_accept()
+        {
+            m_socket.reset(new tcp::socket(m_io_service));
+
+            m_acceptor.async_accept(
+                *m_socket,
+                boost::bind(
+                    &WorkerListener::handle_accept,
+                    this,
+                    asio::placeholders::error));
+        }
+
+      private:
+        asio::io_service&           m_io_service;
+        tcp::acceptor&              m_acceptor;
+        Frame&                      m_frame;
+        TileBatchScheduler&         m_scheduler;
+        ITileCallback*              m_tile_callback;
+        Logger&                     m_logger;
+        boost::mutex                m_frame_mutex;
+        auto_ptr<tcp::socket>       m_socket;
+        vector<WorkerSession*>      m_sessions;
+        boost::thread_group         m_threads;
+
+        void handle_accept(const boost::system::error_code& error)
+        {
+            if (error == asio::error::operation_aborted)
+                return;
+
+            if (!error)
+            {
+                WorkerSession* session =
+                    new WorkerSession(
+                        m_socket.release(),
+                        m_frame,
+                        m_scheduler,
+                        m_tile_callback,
+                        m_frame_mutex,
+                        m_logger);
+
+                m_sessions.push_back(session);
+                m_threads.create_thread(boost::bind(&WorkerSession::run, session));
+            }
+            else
+            {
+                LOG_WARNING(
+                    m_logger,
+                    "failed to accept worker connection: %s.",
+                    error.message().c_str());
+            }
+
+            start_accept();
+        }
+    };
+
+
+    //
+    // Worker-side tile callback that streams finished tiles to the coordinator.
+    //
+
+    class WorkerTileCallback
+      : public TileCallbackBase
+    {
+      public:
+        explicit WorkerTileCallback(tcp::socket& socket)
+          : m_socket(socket)
+          , m_failed(false)
+        {
+        }
+
+        virtual void release() APPLESEED_OVERRIDE
+        {
+            // Do nothing.
+        }
+
+        void begin_batch(const Frame& frame, const AABB2u& batch)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            const CanvasProperties& props = frame.image().properties();
+
+            m_first_tile_x = batch.min.x / props.m_tile_width;
+            m_first_tile_y = batch.min.y / props.m_tile_height;
+            m_batch_tile_count_x = batch.max.x / props.m_tile_width - m_first_tile_x + 1;
+            m_sent.assign(
+                m_batch_tile_count_x * (batch.max.y / props.m_tile_height - m_first_tile_y + 1),
+                false);
+        }
+
+        // Send the tiles of the batch that were not streamed during rendering,
+        // for instance because the frame renderer is not tile-based, then mark
+        // the end of the batch. Throws if the connection was lost.
+        void end_batch(const Frame& frame)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            if (m_failed)
+                throw Exception("connection to the coordinator lost");
+
+            const size_t tile_count_y = m_sent.size() / m_batch_tile_count_x;
+
+            for (size_t y = 0; y < tile_count_y; ++y)
+            {
+                for (size_t x = 0; x < m_batch_tile_count_x; ++x)
+                {
+                    if (!m_sent[y * m_batch_tile_count_x + x])
+                        send_tile(frame, m_first_tile_x + x, m_first_tile_y + y);
+                }
+            }
+
+            write_word(m_socket, MessageBatchEnd);
+        }
+
+        virtual void post_render_tile(
+            const Frame*            frame,
+            const size_t            tile_x,
+            const size_t            tile_y) APPLESEED_OVERRIDE
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            // Ignore tiles outside of the batch.
+            if (m_failed ||
+                tile_x < m_first_tile_x ||
+                tile_y < m_first_tile_y ||
+                tile_x >= m_first_tile_x + m_batch_tile_count_x ||
+                (tile_y - m_first_tile_y) * m_batch_tile_count_x >= m_sent.size())
+                return;
+
+            const size_t index = (tile_y - m_first_tile_y) * m_batch_tile_count_x + (tile_x - m_first_tile_x);
+
+            if (m_sent[index])
+                return;
+
+            try
+            {
+                send_tile(*frame, tile_x, tile_y);
+                m_sent[index] = true;
+            }
+            catch (const exception&)
+            {
+                // Reported by end_batch() once rendering is over.
+                m_failed = true;
+            }
+        }
+
+      private:
+        boost::mutex                m_mutex;
+        tcp::socket&                m_socket;
+        bool                        m_failed;
+        size_t                      m_first_tile_x;
+        size_t                      m_first_tile_y;
+        size_t                      m_batch_tile_count_x;
+        vector<bool>                m_sent;
+        vector<uint8>               m_header_bytes;
+
+        void send_tile(const Frame& frame, const size_t tile_x, const size_t tile_y)
+        {
+            // Send AOV images first so that the coordinator can present the tile
+            // as soon as the main image arrives.
+            for (size_t i = frame.aov_images().size(); i > 0; --i)
+                send_plane(frame, tile_x, tile_y, i);
+
+            send_plane(frame, tile_x, tile_y, 0);
+        }
+
+        void send_plane(
+            const Frame&            frame,
+            const size_t            tile_x,
+            const size_t            tile_y,
+            const size_t            plane_index)
+        {
+            const Tile& source = get_plane(frame, plane_index).tile(tile_x, tile_y);
+            const Tile tile(source, PixelFormatFloat);
+
+            const uint32 header[1 + TileHeaderSize] =
+            {
+                MessageTile,
+                static_cast<uint32>(tile_x),
+                static_cast<uint32>(tile_y),
+                static_cast<uint32>(plane_index),
+                static_cast<uint32>(tile.get_width()),
+                static_cast<uint32>(tile.get_height()),
+                static_cast<uint32>(tile.get_channel_count())
+            };
+
+            vector<uint8> bytes;
+            encode_words(header, 1 + TileHeaderSize, m_header_bytes);
+            encode_words(
+                reinterpret_cast<const uint32*>(tile.get_storage()),
+                tile.get_pixel_count() * tile.get_channel_count(),
+                bytes);
+
+            vector<asio::const_buffer> buffers;
+            buffers.push_back(asio::buffer(m_header_bytes));
+            buffers.push_back(asio::buffer(bytes));
+            asio::write(m_socket, buffers);
+        }
+    };
+
+    class WorkerTileCallbackFactory
+      : public ITileCallbackFactory
+    {
+      public:
+        explicit WorkerTileCallbackFactory(WorkerTileCallback* callback = 0)
+          : m_callback(callback)
+        {
+        }
+
+        virtual void release() APPLESEED_OVERRIDE
+        {
+            // Do nothing.
+        }
+
+        virtual ITileCallback* create() APPLESEED_OVERRIDE
+        {
+            return m_callback;
+        }
+
+        // Redirect the tiles of subsequent renders to another callback.
+        // The callback may be null.
+        void set_callback(WorkerTileCallback* callback)
+        {
+            m_callback = callback;
+        }
+
+      private:
+        WorkerTileCallback*         m_callback;
+    };
+
+    bool parse_matrix(const string& s, Matrix4d& matrix)
+    {
+        vector<string> tokens;
+        tokenize(s, Blanks, tokens);
+
+        if (tokens.size() != 16)
+            return false;
+
+        try
+        {
+            for (size_t i = 0; i < 16; ++i)
+                matrix[i] = from_string<double>(tokens[i]);
+        }
+        catch (const ExceptionStringConversionError&)
+        {
+            return false;
+        }
+
+        return true;
+    }
+}
+
+
+//
+// TileCoordinator class implementation.
+//
+
+TileCoordinator::TileCoordinator(
+    Project&                        project,
+    Logger&                         logger)
+  : m_project(project)
+  , m_logger(logger)
+{
+}
+
+bool TileCoordinator::run(
+    const unsigned short            port,
+    ITileCallbackFactory*           tile_callback_factory)
+{
+    Frame* frame = m_project.get_frame();
+    assert(frame);
+
+    // Match the AOV images the workers will create.
+    m_project.create_aov_images();
+    frame->clear_main_image();
+
+    asio::io_service io_service;
+    tcp::acceptor acceptor(io_service);
+
+    try
+    {
+        const tcp::endpoint endpoint(tcp::v4(), port);
+        acceptor.open(endpoint.protocol());
+        acceptor.set_option(tcp::acceptor::reuse_address(true));
+        acceptor.bind(endpoint);
+        acceptor.listen();
+    }
+    catch (const boost::system::system_error& e)
+    {
+        LOG_ERROR(m_logger, "failed to listen on port %u: %s.", port, e.what());
+        return false;
+    }
+
+    TileBatchScheduler scheduler(*frame, TilesPerBatch);
+
+    LOG_INFO(
+        m_logger,
+        "waiting for workers on port %u to render %s batch%s of tiles...",
+        port,
+        pretty_uint(scheduler.get_batch_count()).c_str(),
+        scheduler.get_batch_count() > 1 ? "es" : "");
+
+    ITileCallback* tile_callback =
+        tile_callback_factory ? tile_callback_factory->create() : 0;
+
+    {
+        WorkerListener listener(
+            io_service,
+            acceptor,
+            *frame,
+            scheduler,
+            tile_callback,
+            m_logger);
+
+        listener.start_accept();
+
+        boost::thread io_thread(boost::bind(&asio::io_service::run, &io_service));
+
+        scheduler.wait();
+
+        // Stop accepting workers; sessions terminate on their own once they
+        // find no more batches to hand out.
+        io_service.stop();
+        io_thread.join();
+    }
+
+    if (tile_callback)
+        tile_callback->release();
+
+    return true;
+}
+
+
+//
+// TileWorker class implementation.
+//
+
+TileWorker::TileWorker(
+    Project&                        project,
+    const ParamArray&               params,
+    Logger&                         logger)
+  : m_project(project)
+  , m_params(params)
+  , m_logger(logger)
+{
+}
+
+bool TileWorker::run(
+    const string&                   host,
+    const unsigned short            port)
+{
+    Frame* frame = m_project.get_frame();
+    assert(frame);
+
+    m_project.create_aov_images();
+
+    asio::io_service io_service;
+    tcp::socket socket(io_service);
+
+    try
+    {
+        LOG_INFO(m_logger, "connecting to coordinator %s:%u...", host.c_str(), port);
+
+        tcp::resolver resolver(io_service);
+        const tcp::resolver::query query(host, foundation::to_string(port));
+        asio::connect(socket, resolver.resolve(query));
+
+        uint32 handshake[HandshakeSize];
+        describe_frame(*frame, handshake);
+        write_words(socket, handshake, HandshakeSize);
+
+        if (read_word(socket) != MessageAccept)
+        {
+            LOG_ERROR(m_logger, "the coordinator rejected this worker: the frames of both projects differ.");
+            return false;
+        }
+
+        WorkerTileCallback tile_callback(socket);
+        WorkerTileCallbackFactory tile_callback_factory(&tile_callback);
+        DefaultRendererController renderer_controller;
+        MasterRenderer renderer(
+            m_project,
+            m_params,
+            &renderer_controller,
+            &tile_callback_factory);
+
+        size_t batch_count = 0;
+
+        while (true)
+        {
+            const uint32 type = read_word(socket);
+
+            if (type == MessageQuit)
+                break;
+
+            if (type != MessageRender)
+                throw Exception("unexpected message");
+
+            uint32 coordinates[4];
+            read_words(socket, coordinates, 4);
+
+            AABB2u batch;
+            batch.min.x = coordinates[0];
+            batch.min.y = coordinates[1];
+            batch.max.x = coordinates[2];
+            batch.max.y = coordinates[3];
+
+            const CanvasProperties& props = frame->image().properties();
+
+            if (!batch.is_valid() ||
+                batch.max.x >= props.m_canvas_width ||
+                batch.max.y >= props.m_canvas_height)
+                throw Exception("invalid batch");
+
+            frame->set_crop_window(batch);
+            tile_callback.begin_batch(*frame, batch);
+
+            if (!renderer.render())
+                return false;
+
+            tile_callback.end_batch(*frame);
+            ++batch_count;
+        }
+
+        LOG_INFO(
+            m_logger,
+            "coordinator reported the frame as complete; rendered %s batch%s.",
+            pretty_uint(batch_count).c_str(),
+            batch_count > 1 ? "es" : "");
+    }
+    catch (const exception& e)
+    {
+        LOG_ERROR(m_logger, "distributed rendering failed: %s.", e.what());
+        return false;
+    }
+
+    return true;
+}
+
+
+//
+// RenderServer class implementation.
+//
+
+struct RenderServer::Impl
+{
+    IProjectLoader&                 m_project_loader;
+    Logger&                         m_logger;
+
+    // Resident state, kept between requests and sessions.
+    auto_release_ptr<Project>       m_project;
+    ParamArray                      m_params;
+    DefaultRendererController       m_renderer_controller;
+    WorkerTileCallbackFactory       m_tile_callback_factory;
+    auto_ptr<MasterRenderer>        m_renderer;
+
+    Impl(
+        IProjectLoader&             project_loader,
+        Logger&                     logger)
+      : m_project_loader(project_loader)
+      , m_logger(logger)
+    {
+    }
+
+    // Serve the requests of a client until it disconnects. Return false if the client asked the server to stop.
+    bool run_session(tcp::socket& socket)
+    {
+        uint32 handshake[ServerHandshakeSize];
+        read_words(socket, handshake, ServerHandshakeSize);
+
+        if (handshake[0] != ProtocolMagic || handshake[1] != ProtocolVersion)
+        {
+            write_word(socket, MessageReject);
+            throw Exception("protocol mismatch");
+        }
+
+        write_word(socket, MessageAccept);
+
+        WorkerTileCallback tile_callback(socket);
+        m_tile_callback_factory.set_callback(&tile_callback);
+
+        try
+        {
+            while (true)
+            {
+                const uint32 type = read_word(socket);
+
+                switch (type)
+                {
+                  case MessageLoadProject:
+                    load_project(socket, read_string(socket));
+                    break;
+
+                  case MessageSetParameter:
+                    {
+                        const string path = read_string(socket);
+                        const string value = read_string(socket);
+                        set_parameter(socket, path, value);
+                    }
+                    break;
+
+                  case MessageSetTransform:
+                    {
+                        const string name = read_string(socket);
+                        const string values = read_string(socket);
+                        set_transform(socket, name, values);
+                    }
+                    break;
+
+                  case MessageRenderFrame:
+                    render_frame(socket, tile_callback);
+                    break;
+
+                  case MessageDisconnect:
+                  case MessageShutdown:
+                    write_status(socket, true, "bye");
+                    m_tile_callback_factory.set_callback(0);
+                    return type != MessageShutdown;
+
+                  default:
+                    throw Exception("unexpected message");
+                }
+            }
+        }
+        catch (...)
+        {
+            m_tile_callback_factory.set_callback(0);
+            throw;
+        }
+    }
+
+    void write_status(tcp::socket& socket, const bool success, const string& message)
+    {
+        write_word(socket, MessageStatus);
+        write_word(socket, success ? 1 : 0);
+        write_string(socket, message);
+    }
+
+    void load_project(tcp::socket& socket, const string& filepath)
+    {
+        // Release the renderer and its caches before the project they refer to.
+        m_renderer.reset();
+        m_project.reset();
+        m_params.clear();
+
+        LOG_INFO(m_logger, "loading project %s...", filepath.c_str());
+
+        m_project = m_project_loader.load(filepath, m_params);
+
+        if (m_project.get() == 0)
+        {
+            write_status(socket, false, "failed to load project " + filepath);
+            return;
+        }
+
+        write_status(socket, true, "loaded project " + filepath);
+    }
+
+    void set_parameter(tcp::socket& socket, const string& path, const string& value)
+    {
+        if (m_project.get() == 0)
+        {
+            write_status(socket, false, "no project loaded");
+            return;
+        }
+
+        // The renderer holds a copy of the rendering parameters: recreate it on the next render.
+        // The project, and thus its trees, remains resident.
+        m_params.insert_path(path, value);
+        m_renderer.reset();
+
+        write_status(socket, true, "set parameter " + path + " to " + value);
+    }
+
+    void set_transform(tcp::socket& socket, const string& name, const string& values)
+    {
+        if (m_project.get() == 0)
+        {
+            write_status(socket, false, "no project loaded");
+            return;
+        }
+
+        Matrix4d matrix;
+        if (!parse_matrix(values, matrix))
+        {
+            write_status(socket, false, "expected 16 matrix coefficients, got \"" + values + "\"");
+            return;
+        }
+
+        Transformd transform;
+        try
+        {
+            transform = Transformd::from_local_to_parent(matrix);
+        }
+        catch (const ExceptionSingularMatrix&)
+        {
+            write_status(socket, false, "singular matrix");
+            return;
+        }
+
+        Scene* scene = m_project->get_scene();
+
+        if (Camera* camera = scene->cameras().get_by_name(name.c_str()))
+        {
+            camera->transform_sequence().clear();
+            camera->transform_sequence().set_transform(0.0f, transform);
+            camera->bump_version_id();
+        }
+        else if (AssemblyInstance* assembly_instance = scene->assembly_instances().get_by_name(name.c_str()))
+        {
+            assembly_instance->transform_sequence().clear();
+            assembly_instance->transform_sequence().set_transform(0.0f, transform);
+            assembly_instance->bump_version_id();
+        }
+        else
+        {
+            write_status(socket, false, "no camera or assembly instance named " + name);
+            return;
+        }
+
+        write_status(socket, true, "set transform of " + name);
+    }
+
+    void render_frame(tcp::socket& socket, WorkerTileCallback& tile_callback)
+    {
+        if (m_project.get() == 0)
+        {
+            write_status(socket, false, "no project loaded");
+            return;
+        }
+
+        // Keep the renderer, and thus the texture cache and the compiled shaders, between frames.
+        if (m_renderer.get() == 0)
+        {
+            m_renderer.reset(
+                new MasterRenderer(
+                    m_project.ref(),
+                    m_params,
+                    &m_renderer_controller,
+                    &m_tile_callback_factory));
+        }
+
+        const Frame& frame = *m_project->get_frame();
+
+        LOG_INFO(m_logger, "rendering frame...");
+
+        tile_callback.begin_batch(frame, frame.get_crop_window());
+
+        if (!m_renderer->render())
+        {
+            write_status(socket, false, "rendering failed");
+            return;
+        }
+
+        tile_callback.end_batch(frame);
+
+        write_status(socket, true, "rendered frame");
+    }
+};
+
+RenderServer::RenderServer(
+    IProjectLoader&                 project_loader,
+    Logger&                         logger)
+  : impl(new Impl(project_loader, logger))
+{
+}
+
+RenderServer::~RenderServer()
+{
+    delete impl;
+}
+
+bool RenderServer::run(const unsigned short port)
+{
+    asio::io_service io_service;
+    tcp::acceptor acceptor(io_service);
+
+    try
+    {
+        const tcp::endpoint endpoint(tcp::v4(), port);
+        acceptor.open(endpoint.protocol());
+        acceptor.set_option(tcp::acceptor::reuse_address(true));
+        acceptor.bind(endpoint);
+        acceptor.listen();
+    }
+    catch (const boost::system::system_error& e)
+    {
+        LOG_ERROR(impl->m_logger, "failed to listen on port %u: %s.", port, e.what());
+        return false;
+    }
+
+    LOG_INFO(impl->m_logger, "render server waiting for clients on port %u...", port);
+
+    // Serve one client at a time.
+    while (true)
+    {
+        tcp::socket socket(io_service);
+
+        try
+        {
+            acceptor.accept(socket);
+        }
+        catch (const boost::system::system_error& e)
+        {
+            LOG_ERROR(impl->m_logger, "failed to accept client connection: %s.", e.what());
+            return false;
+        }
+
+        boost::system::error_code ec;
+        const tcp::endpoint endpoint = socket.remote_endpoint(ec);
+        const string name =
+            ec ? "<unknown>" : endpoint.address().to_string() + ":" + foundation::to_string(endpoint.port());
+
+        LOG_INFO(impl->m_logger, "client %s connected.", name.c_str());
+
+        try
+        {
+            if (!impl->run_session(socket))
+            {
+                LOG_INFO(impl->m_logger, "client %s stopped the render server.", name.c_str());
+                return true;
+            }
+
+            LOG_INFO(impl->m_logger, "client %s disconnected.", name.c_str());
+        }
+        catch (const exception& e)
+        {
+            LOG_WARNING(impl->m_logger, "lost client %s: %s.", name.c_str(), e.what());
+        }
+    }
+}
+
+}   // namespace cli
+}   // namespace appleseed
@@ -0,0 +1,151 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_CLI_DISTRIBUTEDRENDERING_H
+#define APPLESEED_CLI_DISTRIBUTEDRENDERING_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/utility/autoreleaseptr.h"
+
+// Standard headers.
+#include <string>
+
+// Forward declarations.
+namespace foundation    { class Logger; }
+namespace renderer      { class ITileCallbackFactory; }
+namespace renderer      { class ParamArray; }
+namespace renderer      { class Project; }
+
+namespace appleseed {
+namespace cli {
+
+//
+// Distributed tile rendering.
+//
+// The coordinator splits the frame into batches of tiles and hands them out on
+// demand to workers connected over TCP. Every worker loads the same project,
+// renders each batch it is assigned as a crop window and streams the finished
+// tiles back. The coordinator merges incoming tiles into its own frame and
+// forwards them to a tile callback, exactly as if they had been rendered locally.
+// Batches held by a worker that disconnects are handed out again.
+//
+
+class TileCoordinator
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    TileCoordinator(
+        renderer::Project&              project,
+        foundation::Logger&             logger);
+
+    // Wait for workers on a given port and distribute the frame to them.
+    // Return once all tiles have been received, or false on error.
+    bool run(
+        const unsigned short            port,
+        renderer::ITileCallbackFactory* tile_callback_factory);
+
+  private:
+    renderer::Project&                  m_project;
+    foundation::Logger&                 m_logger;
+};
+
+class TileWorker
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    TileWorker(
+        renderer::Project&              project,
+        const renderer::ParamArray&     params,
+        foundation::Logger&             logger);
+
+    // Connect to a coordinator and render the batches it assigns until it
+    // signals that the frame is complete. Return false on error.
+    bool run(
+        const std::string&              host,
+        const unsigned short            port);
+
+  private:
+    renderer::Project&                  m_project;
+    const renderer::ParamArray&         m_params;
+    foundation::Logger&                 m_logger;
+};
+
+
+//
+// Persistent render server.
+//
+// The server accepts one client at a time over TCP and serves its requests:
+// load a project, override rendering parameters, set the transform of a camera
+// or of an assembly instance, and render the frame. Tiles of rendered frames are
+// streamed back with the same messages workers use. The project and its renderer
+// stay resident between requests, and between clients, so that subsequent frames
+// reuse the trees, the compiled shaders and the texture cache. Loading another
+// project releases them.
+//
+
+class RenderServer
+  : public foundation::NonCopyable
+{
+  public:
+    // Interface to load a project and retrieve its rendering parameters.
+    class IProjectLoader
+    {
+      public:
+        // Destructor.
+        virtual ~IProjectLoader() {}
+
+        // Load a project. Return 0 on failure.
+        virtual foundation::auto_release_ptr<renderer::Project> load(
+            const std::string&          filepath,
+            renderer::ParamArray&       params) = 0;
+    };
+
+    // Constructor.
+    RenderServer(
+        IProjectLoader&                 project_loader,
+        foundation::Logger&             logger);
+
+    // Destructor.
+    ~RenderServer();
+
+    // Serve clients on a given port until one of them stops the server.
+    // Return false on error.
+    bool run(const unsigned short port);
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace cli
+}       // namespace appleseed
+
+#endif  // !APPLESEED_CLI_DISTRIBUTEDRENDERING_H
@@ -30,8 +30,11 @@
 // appleseed.cli headers.
 #include "commandlinehandler.h"
 #include "continuoussavingtilecallback.h"
+#include "distributedrendering.h"
 #include "houdinitilecallbacks.h"
 #include "progresstilecallback.h"
+#include "streamingtilecallback.h"
+#include "telemetrypublisher.h"
 
 // appleseed.renderer headers.
 #include "renderer/api/color.h"
@@ -46,12 +49,18 @@
 #include "renderer/api/utility.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
 #include "foundation/platform/thread.h"
 #include "foundation/platform/timers.h"
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/benchmark.h"
+#include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/filter.h"
+#include "foundation/utility/foreach.h"
 #include "foundation/utility/log.h"
+#include "foundation/utility/memoryaccounting.h"
+#include "foundation/utility/siphash.h"
+#include "foundation/utility/statistics.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 #include "foundation/utility/test.h"
@@ -68,10 +77,17 @@
 #include "boost/filesystem/path.hpp"
 
 // Standard headers.
+#include <algorithm>
+#include <csignal>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
 
 using namespace appleseed::cli;
 using namespace appleseed::shared;
@@ -247,6 +263,41 @@ namespace
         print_unit_benchmark_result(result);
     }
 
+    bool scan_benchmark_results(const string& path, BenchmarkAggregator& aggregator)
+    {
+        if (bf::is_directory(path))
+            aggregator.scan_directory(path.c_str());
+        else aggregator.scan_file(path.c_str());
+
+        if (aggregator.get_benchmarks().empty())
+        {
+            LOG_ERROR(g_logger, "no benchmark results found in %s.", path.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool compare_benchmarks()
+    {
+        const vector<string>& paths = g_cl.m_compare_benchmarks.values();
+
+        BenchmarkAggregator baseline, candidate;
+        if (!scan_benchmark_results(paths[0], baseline) ||
+            !scan_benchmark_results(paths[1], candidate))
+            return false;
+
+        const BenchmarkComparison comparison(baseline, candidate);
+
+        stringstream sstr;
+        comparison.write_report(sstr);
+
+        LOG_INFO(g_logger, "benchmark comparison of %s against %s:\n%s",
+            paths[1].c_str(), paths[0].c_str(), sstr.str().c_str());
+
+        return comparison.passed();
+    }
+
     void set_frame_parameter(Project& project, const string& key, const string& value)
     {
         const Frame* frame = project.get_frame();
@@ -314,6 +365,113 @@ namespace
         }
     }
 
+    void apply_checkpoint_command_line_options(ParamArray& params)
+    {
+        // Rendering progress is checkpointed next to continuously saved output images.
+        const bool checkpointing = g_cl.m_output.is_set() && g_cl.m_continuous_saving.is_set();
+
+        if (checkpointing)
+        {
+            const string checkpoint_file = g_cl.m_output.value() + ".checkpoint";
+            params.insert_path("generic_frame_renderer.checkpoint_file", checkpoint_file);
+            params.insert_path("progressive_frame_renderer.checkpoint_file", checkpoint_file);
+        }
+
+        if (g_cl.m_resume.is_set())
+        {
+            if (checkpointing)
+            {
+                params.insert_path("generic_frame_renderer.resume", true);
+                params.insert_path("progressive_frame_renderer.resume", true);
+            }
+            else LOG_WARNING(g_logger, "--resume requires --output and --continuous-saving, ignoring.");
+        }
+    }
+
+    bool is_progressive_render(const ParamArray& params)
+    {
+        const string value = params.get_required<string>("frame_renderer", "generic");
+        return value == "progressive";
+    }
+
+    void apply_sample_partition_command_line_options(ParamArray& params)
+    {
+        if (g_cl.m_sample_partition.is_set())
+        {
+            const int index = g_cl.m_sample_partition.values()[0];
+            const int count = g_cl.m_sample_partition.values()[1];
+
+            if (count > 0 && index >= 0 && index < count)
+            {
+                params.insert_path("progressive_frame_renderer.sample_partition_index", index);
+                params.insert_path("progressive_frame_renderer.sample_partition_count", count);
+            }
+            else LOG_ERROR(g_logger, "invalid sample partition %d of %d, ignoring.", index, count);
+        }
+
+        if (g_cl.m_save_samples.is_set())
+            params.insert_path("progressive_frame_renderer.sample_file", g_cl.m_save_samples.value());
+
+        if (g_cl.m_merge_samples.is_set())
+        {
+            string sample_files;
+
+            for (size_t i = 0; i < g_cl.m_merge_samples.values().size(); ++i)
+            {
+                if (i > 0)
+                    sample_files += ';';
+                sample_files += g_cl.m_merge_samples.values()[i];
+            }
+
+            params.insert_path("progressive_frame_renderer.merge_sample_files", sample_files);
+        }
+
+        if ((g_cl.m_sample_partition.is_set() || g_cl.m_save_samples.is_set() || g_cl.m_merge_samples.is_set()) &&
+            !is_progressive_render(params))
+        {
+            LOG_WARNING(
+                g_logger,
+                "--sample-partition, --save-samples and --merge-samples require the progressive frame renderer, ignoring.");
+        }
+    }
+
+    // Return true if rendered tiles are streamed to the output file instead of being kept in memory.
+    bool is_streaming_output(const ParamArray& params)
+    {
+        return
+            g_cl.m_stream_output.is_set() &&
+            g_cl.m_output.is_set() &&
+            !g_cl.m_continuous_saving.is_set() &&
+            !is_progressive_render(params) &&
+            params.get_path_optional<size_t>("generic_frame_renderer.passes", 1) == 1 &&
+            lower_case(bf::path(g_cl.m_output.value()).extension().string()) == ".exr";
+    }
+
+    void apply_stream_output_command_line_option(Project& project, ParamArray& params)
+    {
+        if (!g_cl.m_stream_output.is_set())
+            return;
+
+        if (!is_streaming_output(params))
+        {
+            LOG_WARNING(
+                g_logger,
+                "--stream-output requires --output with an .exr file, a single-pass final render "
+                "and no --continuous-saving, ignoring.");
+            return;
+        }
+
+        // Tiles are released as soon as they are written: the complete frame
+        // is never available for archiving or denoising.
+        params.insert_path("autosave", false);
+
+        if (project.get_frame()->is_denoising_enabled())
+        {
+            LOG_WARNING(g_logger, "denoising is not supported with --stream-output, disabling it.");
+            set_frame_parameter(project, "denoise", "false");
+        }
+    }
+
     void apply_select_object_instances_command_line_option(Assembly& assembly, const RegExFilter& filter)
     {
         static const char* ColorName = "opaque_black-75AB13E8-D5A2-4D27-A64E-4FC41B55A272";
@@ -415,6 +573,16 @@ namespace
         // Apply --passes option.
         apply_passes_command_line_option(params);
 
+        // Apply --denoise option.
+        if (g_cl.m_denoise.is_set())
+            set_frame_parameter(project, "denoise", "true");
+
+        // Apply --continuous-saving and --resume options.
+        apply_checkpoint_command_line_options(params);
+
+        // Apply --sample-partition, --save-samples and --merge-samples options.
+        apply_sample_partition_command_line_options(params);
+
         // Apply --override-shading option.
         if (g_cl.m_override_shading.is_set())
         {
@@ -431,8 +599,23 @@ namespace
                 g_cl.m_select_object_instances.value().c_str());
         }
 
+        // Apply --trace-file option.
+        if (g_cl.m_trace_file.is_set())
+            params.insert_path("trace_file", g_cl.m_trace_file.value());
+
+        // Apply --statistics-file option.
+        if (g_cl.m_statistics_file.is_set())
+            params.insert_path("statistics_file", g_cl.m_statistics_file.value());
+
+        // Apply --telemetry-interval option.
+        if (g_cl.m_telemetry_interval.is_set())
+            params.insert("telemetry_interval", g_cl.m_telemetry_interval.value());
+
         // Apply --parameter options.
         apply_parameter_command_line_options(params);
+
+        // Apply --stream-output option.
+        apply_stream_output_command_line_option(project, params);
     }
 
 #if defined __APPLE__ || defined _WIN32
@@ -467,7 +650,8 @@ namespace
         return
             reader.read(
                 project_filepath.c_str(),
-                schema_filepath.string().c_str());
+                schema_filepath.string().c_str(),
+                ProjectFileReader::MergeIdenticalMeshObjects);
     }
 
     bool configure_project(Project& project, ParamArray& params)
@@ -505,66 +689,322 @@ namespace
         return true;
     }
 
-    bool is_progressive_render(const ParamArray& params)
+    bool parse_port(const int value, unsigned short& port)
     {
-        const string value = params.get_required<string>("frame_renderer", "generic");
-        return value == "progressive";
+        if (value <= 0 || value > 65535)
+        {
+            LOG_ERROR(g_logger, "invalid port number %d.", value);
+            return false;
+        }
+
+        port = static_cast<unsigned short>(value);
+        return true;
     }
 
-    bool render(const string& project_filename)
+    // Create the telemetry callback selected by the command line options, if any.
+    auto_release_ptr<ITelemetryCallback> create_telemetry_callback()
     {
-        // Load the project.
-        auto_release_ptr<Project> project = load_project(project_filename);
-        if (project.get() == 0)
+        if (!g_cl.m_telemetry_interval.is_set() && !g_cl.m_telemetry_output.is_set())
+            return auto_release_ptr<ITelemetryCallback>();
+
+        return
+            auto_release_ptr<ITelemetryCallback>(
+                new TelemetryPublisher(
+                    g_cl.m_telemetry_output.is_set() ? g_cl.m_telemetry_output.value() : string(),
+                    g_logger));
+    }
+
+    // Create the renderer controller selected by the --time-limit and --target-noise options.
+    DefaultRendererController* create_renderer_controller(Project& project)
+    {
+        const double time_limit = g_cl.m_time_limit.is_set() ? g_cl.m_time_limit.value() : 0.0;
+
+        if (g_cl.m_target_noise.is_set())
+        {
+            const vector<string>& values = g_cl.m_target_noise.values();
+
+            QualityRendererController::Scope scope = QualityRendererController::WholeFrame;
+            if (values.size() > 1)
+            {
+                if (values[1] == "tile")
+                    scope = QualityRendererController::EveryTile;
+                else if (values[1] != "frame")
+                    LOG_WARNING(g_logger, "invalid --target-noise scope \"%s\", using \"frame\".", values[1].c_str());
+            }
+
+            try
+            {
+                return
+                    new QualityRendererController(
+                        *project.get_frame(),
+                        from_string<float>(values[0]),
+                        scope,
+                        time_limit);
+            }
+            catch (const ExceptionStringConversionError&)
+            {
+                LOG_ERROR(g_logger, "invalid --target-noise threshold \"%s\", ignoring.", values[0].c_str());
+            }
+        }
+
+        if (time_limit > 0.0)
+            return new TimedRendererController(time_limit);
+
+        return new DefaultRendererController();
+    }
+
+#ifndef _WIN32
+
+    // State of the rendering thread count adjusted by SIGUSR1 and SIGUSR2.
+    DefaultRendererController*  g_thread_count_controller = 0;
+    volatile sig_atomic_t       g_active_thread_count = 0;
+    volatile sig_atomic_t       g_max_thread_count = 0;
+
+    // SIGUSR1 parks one rendering thread, SIGUSR2 unparks one.
+    void handle_thread_count_signal(int signal_number)
+    {
+        sig_atomic_t count = g_active_thread_count;
+
+        if (signal_number == SIGUSR1 && count > 1)
+            --count;
+        else if (signal_number == SIGUSR2 && count < g_max_thread_count)
+            ++count;
+
+        g_active_thread_count = count;
+
+        if (g_thread_count_controller)
+            g_thread_count_controller->set_active_thread_count(static_cast<size_t>(count));
+    }
+
+#endif
+
+    // Apply the --active-threads option and allow adjusting the number of active
+    // rendering threads with signals while rendering.
+    void setup_active_thread_count(
+        const ParamArray&           params,
+        DefaultRendererController&  renderer_controller)
+    {
+        const size_t thread_count = get_rendering_thread_count(params);
+        size_t active_thread_count = thread_count;
+
+        if (g_cl.m_active_threads.is_set())
+        {
+            const int value = g_cl.m_active_threads.value();
+            if (value > 0)
+            {
+                active_thread_count = min(static_cast<size_t>(value), thread_count);
+                renderer_controller.set_active_thread_count(active_thread_count);
+            }
+            else
+                LOG_ERROR(g_logger, "invalid --active-threads value %d, ignoring.", value);
+        }
+
+#ifndef _WIN32
+        g_active_thread_count = static_cast<sig_atomic_t>(active_thread_count);
+        g_max_thread_count = static_cast<sig_atomic_t>(thread_count);
+        g_thread_count_controller = &renderer_controller;
+        signal(SIGUSR1, handle_thread_count_signal);
+        signal(SIGUSR2, handle_thread_count_signal);
+#endif
+    }
+
+    void teardown_active_thread_count()
+    {
+#ifndef _WIN32
+        signal(SIGUSR1, SIG_DFL);
+        signal(SIGUSR2, SIG_DFL);
+        g_thread_count_controller = 0;
+#endif
+    }
+
+    // Dictionaries keep their keys sorted: the hash does not depend on insertion order.
+    uint64 hash_dictionary(const Dictionary& dictionary)
+    {
+        uint64 hash = 0;
+
+        for (const_each<StringDictionary> i = dictionary.strings(); i; ++i)
+        {
+            hash = siphash24(hash, siphash24(i->key(), strlen(i->key())));
+            hash = siphash24(hash, siphash24(i->value(), strlen(i->value())));
+        }
+
+        for (const_each<DictionaryDictionary> i = dictionary.dictionaries(); i; ++i)
+        {
+            hash = siphash24(hash, siphash24(i->key(), strlen(i->key())));
+            hash = siphash24(hash, hash_dictionary(i->value()));
+        }
+
+        return hash;
+    }
+
+    // Compute a hash of everything that affects the rendering of a frame: the project, the
+    // files it references and the rendering parameters, including command line overrides.
+    bool compute_frame_hash(
+        const Project&          project,
+        const ParamArray&       params,
+        uint64&                 hash)
+    {
+        if (!ProjectFileWriter::compute_hash(project, hash))
             return false;
 
-        // Retrieve the rendering parameters.
-        ParamArray params;
-        if (!configure_project(project.ref(), params))
+        hash = siphash24(hash, hash_dictionary(params));
+        return true;
+    }
+
+    // The hash of the frame an output file was rendered from is stored next to it.
+    string get_hash_filename(const string& output_filename)
+    {
+        return output_filename + ".hash";
+    }
+
+    string hash_to_string(const uint64 hash)
+    {
+        stringstream sstr;
+        sstr << hex << setw(16) << setfill('0') << hash;
+        return sstr.str();
+    }
+
+    // Return true if an output file exists and was rendered from a frame with a given hash.
+    bool is_output_up_to_date(
+        const string&           output_filename,
+        const uint64            hash)
+    {
+        if (!bf::exists(output_filename))
             return false;
 
-        // Create the tile callback factory.
-        auto_ptr<ITileCallbackFactory> tile_callback_factory;
+        ifstream file(get_hash_filename(output_filename).c_str());
+        string stored_hash;
+        file >> stored_hash;
+
+        return stored_hash == hash_to_string(hash);
+    }
+
+    void write_output_hash(
+        const string&           output_filename,
+        const uint64            hash)
+    {
+        const string hash_filename = get_hash_filename(output_filename);
+        ofstream file(hash_filename.c_str());
+        file << hash_to_string(hash) << endl;
+
+        if (!file.good())
+            LOG_WARNING(g_logger, "failed to write %s.", hash_filename.c_str());
+    }
+
+    bool render_frame(
+        Project&                project,
+        const ParamArray&       params,
+        ITileCallbackFactory*   tile_callback_factory)
+    {
+        // Let workers render the frame when acting as a coordinator.
+        if (g_cl.m_coordinator.is_set())
+        {
+            unsigned short port;
+            if (!parse_port(g_cl.m_coordinator.value(), port))
+                return false;
+
+            TileCoordinator coordinator(project, g_logger);
+            return coordinator.run(port, tile_callback_factory);
+        }
+
+        // Create the master renderer.
+        auto_ptr<DefaultRendererController> renderer_controller(create_renderer_controller(project));
+        MasterRenderer renderer(
+            project,
+            params,
+            renderer_controller.get(),
+            tile_callback_factory);
+
+        // Report live telemetry if requested.
+        auto_release_ptr<ITelemetryCallback> telemetry_callback = create_telemetry_callback();
+        renderer.set_telemetry_callback(telemetry_callback.get());
+
+        setup_active_thread_count(params, *renderer_controller);
+        const bool success = renderer.render();
+        teardown_active_thread_count();
+
+        return success;
+    }
+
+    // Create the tile callback factory selected by the command line options, if any.
+    ITileCallbackFactory* create_tile_callback_factory(
+        const string&           project_filename,
+        const Project&          project,
+        const ParamArray&       params)
+    {
         if (g_cl.m_mplay_display.is_set())
         {
-            tile_callback_factory.reset(
+            return
                 new MPlayTileCallbackFactory(
                     project_filename.c_str(),
                     is_progressive_render(params),
-                    g_logger));
+                    g_logger);
         }
         else if (g_cl.m_hrmanpipe_display.is_set())
         {
-            tile_callback_factory.reset(
+            return
                 new HRmanPipeTileCallbackFactory(
                     g_cl.m_hrmanpipe_display.value(),
                     is_progressive_render(params),
-                    g_logger));
+                    g_logger);
+        }
+        else if (is_streaming_output(params))
+        {
+            return
+                new StreamingTileCallbackFactory(
+                    g_cl.m_output.value().c_str(),
+                    g_logger);
         }
         else if (g_cl.m_output.is_set() && g_cl.m_continuous_saving.is_set())
         {
-            tile_callback_factory.reset(
+            return
                 new ContinuousSavingTileCallbackFactory(
                     g_cl.m_output.value().c_str(),
-                    g_logger));
+                    g_logger);
         }
-        else if (project->get_display() == 0)
+        else if (project.get_display() == 0)
         {
             // Create a default tile callback if needed.
             if (params.get_optional<string>("frame_renderer", "") != "progressive")
             {
-                tile_callback_factory.reset(
-                    new ProgressTileCallbackFactory(g_logger));
+                return new ProgressTileCallbackFactory(g_logger);
             }
         }
 
-        // Create the master renderer.
-        DefaultRendererController renderer_controller;
-        MasterRenderer renderer(
-            project.ref(),
-            params,
-            &renderer_controller,
-            tile_callback_factory.get());
+        return 0;
+    }
+
+    bool render(const string& project_filename)
+    {
+        // Load the project.
+        auto_release_ptr<Project> project = load_project(project_filename);
+        if (project.get() == 0)
+            return false;
+
+        // Retrieve the rendering parameters.
+        ParamArray params;
+        if (!configure_project(project.ref(), params))
+            return false;
+
+        // Skip rendering if the output file was rendered from an identical frame.
+        const string output_path =
+            g_cl.m_output.is_set()
+                ? g_cl.m_output.value()
+                : project->get_frame()->get_parameters().get_optional<string>("output_filename");
+        uint64 frame_hash = 0;
+        const bool skip_unchanged =
+            g_cl.m_skip_unchanged.is_set() &&
+            !output_path.empty() &&
+            compute_frame_hash(project.ref(), params, frame_hash);
+        if (skip_unchanged && is_output_up_to_date(output_path, frame_hash))
+        {
+            LOG_INFO(g_logger, "%s is up to date, skipping rendering.", output_path.c_str());
+            return true;
+        }
+
+        // Create the tile callback factory.
+        auto_ptr<ITileCallbackFactory> tile_callback_factory(
+            create_tile_callback_factory(project_filename, project.ref(), params));
 
         // Render the frame.
         LOG_INFO(g_logger, "rendering frame...");
@@ -573,14 +1013,14 @@ namespace
         {
             ProcessPriorityContext background_context(ProcessPriorityLow, &g_logger);
             stopwatch.start();
-            if (!renderer.render())
+            if (!render_frame(project.ref(), params, tile_callback_factory.get()))
                 return false;
             stopwatch.measure();
         }
         else
         {
             stopwatch.start();
-            if (!renderer.render())
+            if (!render_frame(project.ref(), params, tile_callback_factory.get()))
                 return false;
             stopwatch.measure();
         }
@@ -592,6 +1032,9 @@ namespace
             "rendering finished in %s.",
             pretty_time(seconds, 3).c_str());
 
+        // Print memory usage per subsystem.
+        LOG_INFO(g_logger, "%s", get_memory_accounting_statistics().to_string().c_str());
+
         // Archive the frame to disk.
         char* archive_path = 0;
         if (params.get_optional<bool>("autosave", true))
@@ -609,7 +1052,12 @@ namespace
         }
 
         // Write the frame to disk.
-        if (g_cl.m_output.is_set() && !g_cl.m_continuous_saving.is_set())
+        if (is_streaming_output(params))
+        {
+            // Tiles are already on disk, finalize the output files.
+            tile_callback_factory.reset();
+        }
+        else if (g_cl.m_output.is_set() && !g_cl.m_continuous_saving.is_set())
         {
             LOG_INFO(g_logger, "writing frame to disk...");
             project->get_frame()->write_main_image(g_cl.m_output.value().c_str());
@@ -631,6 +1079,10 @@ namespace
             }
         }
 
+        // Remember the hash of the frame the output file was rendered from.
+        if (skip_unchanged)
+            write_output_hash(output_path, frame_hash);
+
 #if defined __APPLE__ || defined _WIN32
 
         // Display the output image.
@@ -651,6 +1103,231 @@ namespace
         return true;
     }
 
+    // Return the path of the image of a given frame. Consecutive '#' characters in the
+    // pattern are replaced by the frame number; without them, a four-digit frame number
+    // is inserted before the file extension.
+    string make_frame_filename(const string& pattern, const size_t frame)
+    {
+        if (pattern.find('#') != string::npos)
+            return get_numbered_string(pattern, frame);
+
+        const bf::path path(pattern);
+        const bf::path numbered_path =
+            path.parent_path() / (path.stem().string() + ".####" + path.extension().string());
+
+        return get_numbered_string(numbered_path.string(), frame);
+    }
+
+    bool render_sequence(const string& project_filename)
+    {
+        if (g_cl.m_coordinator.is_set() || g_cl.m_continuous_saving.is_set())
+        {
+            LOG_ERROR(g_logger, "frame sequences cannot be rendered in coordinator or continuous saving mode.");
+            return false;
+        }
+
+        // Read the per-frame changes.
+        FrameSequence sequence;
+        if (g_cl.m_sequence.is_set() && !sequence.read(g_cl.m_sequence.value().c_str(), g_logger))
+            return false;
+
+        // Determine the range of frames to render.
+        size_t first_frame, last_frame;
+        if (g_cl.m_frames.is_set())
+        {
+            const int first = g_cl.m_frames.values()[0];
+            const int last = g_cl.m_frames.values()[1];
+
+            if (first < 0 || last < first)
+            {
+                LOG_ERROR(g_logger, "invalid frame range %d-%d.", first, last);
+                return false;
+            }
+
+            first_frame = static_cast<size_t>(first);
+            last_frame = static_cast<size_t>(last);
+        }
+        else if (!sequence.empty())
+        {
+            first_frame = sequence.get_first_frame();
+            last_frame = sequence.get_last_frame();
+        }
+        else
+        {
+            LOG_ERROR(g_logger, "the sequence file does not list any frame.");
+            return false;
+        }
+
+        // Load the project.
+        auto_release_ptr<Project> project = load_project(project_filename);
+        if (project.get() == 0)
+            return false;
+
+        // Retrieve the rendering parameters.
+        ParamArray params;
+        if (!configure_project(project.ref(), params))
+            return false;
+
+        // Retrieve the pattern of the output filenames.
+        const Frame* frame = project->get_frame();
+        const string output_pattern =
+            g_cl.m_output.is_set()
+                ? g_cl.m_output.value()
+                : frame->get_parameters().get_optional<string>("output_filename");
+        const bool write_aovs =
+            g_cl.m_output.is_set() ||
+            frame->get_parameters().get_optional<bool>("output_aovs", false);
+
+        if (output_pattern.empty())
+        {
+            LOG_ERROR(g_logger, "no output filename specified for the frame sequence.");
+            return false;
+        }
+
+        // Create the tile callback factory.
+        auto_ptr<ITileCallbackFactory> tile_callback_factory(
+            create_tile_callback_factory(project_filename, project.ref(), params));
+
+        // A single master renderer renders all frames: the scene, its acceleration structures,
+        // the texture cache and the shading system remain resident, and only entities changed
+        // by the sequence are updated between frames.
+        DefaultRendererController renderer_controller;
+        MasterRenderer renderer(
+            project.ref(),
+            params,
+            &renderer_controller,
+            tile_callback_factory.get());
+
+        // Report live telemetry if requested.
+        auto_release_ptr<ITelemetryCallback> telemetry_callback = create_telemetry_callback();
+        renderer.set_telemetry_callback(telemetry_callback.get());
+
+        auto_ptr<ProcessPriorityContext> background_context;
+        if (params.get_optional<bool>("background_mode", true))
+            background_context.reset(new ProcessPriorityContext(ProcessPriorityLow, &g_logger));
+
+        Stopwatch<DefaultWallclockTimer> sequence_stopwatch;
+        sequence_stopwatch.start();
+
+        for (size_t i = first_frame; i <= last_frame; ++i)
+        {
+            if (!sequence.apply(i, project.ref(), renderer.get_parameters(), g_logger))
+                return false;
+
+            // Skip the frame if its output file was rendered from an identical frame.
+            const string output_filename = make_frame_filename(output_pattern, i);
+            uint64 frame_hash = 0;
+            const bool skip_unchanged =
+                g_cl.m_skip_unchanged.is_set() &&
+                compute_frame_hash(project.ref(), renderer.get_parameters(), frame_hash);
+            if (skip_unchanged && is_output_up_to_date(output_filename, frame_hash))
+            {
+                LOG_INFO(g_logger, "%s is up to date, skipping frame " FMT_SIZE_T ".", output_filename.c_str(), i);
+                continue;
+            }
+
+            // Render the frame.
+            LOG_INFO(g_logger, "rendering frame " FMT_SIZE_T "...", i);
+            Stopwatch<DefaultWallclockTimer> stopwatch;
+            stopwatch.start();
+            if (!renderer.render())
+                return false;
+            stopwatch.measure();
+
+            LOG_INFO(
+                g_logger,
+                "rendering of frame " FMT_SIZE_T " finished in %s.",
+                i,
+                pretty_time(stopwatch.get_seconds(), 3).c_str());
+
+            // Write the frame to disk.
+            LOG_INFO(g_logger, "writing frame to %s...", output_filename.c_str());
+            frame->write_main_image(output_filename.c_str());
+            if (write_aovs)
+                frame->write_aov_images(output_filename.c_str());
+            if (skip_unchanged)
+                write_output_hash(output_filename, frame_hash);
+        }
+
+        sequence_stopwatch.measure();
+
+        LOG_INFO(
+            g_logger,
+            "rendering of " FMT_SIZE_T " frame%s finished in %s.",
+            last_frame - first_frame + 1,
+            last_frame > first_frame ? "s" : "",
+            pretty_time(sequence_stopwatch.get_seconds(), 3).c_str());
+
+        return true;
+    }
+
+    bool worker_render(const string& project_filename)
+    {
+        // Retrieve the address of the coordinator (of the form host:port).
+        const string& address = g_cl.m_worker.value();
+        const string::size_type colon_pos = address.find_last_of(':');
+        if (colon_pos == string::npos || colon_pos == 0)
+        {
+            LOG_ERROR(g_logger, "invalid coordinator address \"%s\", expected host:port.", address.c_str());
+            return false;
+        }
+
+        unsigned short port;
+        try
+        {
+            if (!parse_port(from_string<int>(address.substr(colon_pos + 1)), port))
+                return false;
+        }
+        catch (const ExceptionStringConversionError&)
+        {
+            LOG_ERROR(g_logger, "invalid coordinator address \"%s\", expected host:port.", address.c_str());
+            return false;
+        }
+
+        // Load the project.
+        auto_release_ptr<Project> project = load_project(project_filename);
+        if (project.get() == 0)
+            return false;
+
+        // Retrieve the rendering parameters.
+        ParamArray params;
+        if (!configure_project(project.ref(), params))
+            return false;
+
+        // Render the tiles handed out by the coordinator.
+        TileWorker worker(project.ref(), params, g_logger);
+        return worker.run(address.substr(0, colon_pos), port);
+    }
+
+    class RenderServerProjectLoader
+      : public RenderServer::IProjectLoader
+    {
+      public:
+        virtual auto_release_ptr<Project> load(
+            const string&   filepath,
+            ParamArray&     params) APPLESEED_OVERRIDE
+        {
+            auto_release_ptr<Project> project = load_project(filepath);
+
+            if (project.get() && !configure_project(project.ref(), params))
+                project.reset();
+
+            return project;
+        }
+    };
+
+    bool serve(const int port_value)
+    {
+        unsigned short port;
+        if (!parse_port(port_value, port))
+            return false;
+
+        // Command line options apply to every project loaded by clients.
+        RenderServerProjectLoader project_loader;
+        RenderServer server(project_loader, g_logger);
+        return server.run(port);
+    }
+
     bool benchmark_render(const string& project_filename)
     {
         // Configure our logger.
@@ -702,6 +1379,12 @@ namespace
             render_time_seconds = stopwatch.get_seconds() - total_time_seconds;
         }
 
+        // Count the samples of the second render, which traces one camera ray per sample.
+        HotPathCounters hot_path_counters;
+        get_hot_path_counters(hot_path_counters);
+        const uint64 sample_count =
+            hot_path_counters.m_rays[HotPathCounters::ray_type_index(VisibilityFlags::CameraRay)];
+
         // Write the frame to disk.
         if (g_cl.m_output.is_set())
         {
@@ -715,6 +1398,8 @@ namespace
         LOG_INFO(g_logger, "total_time=%.6f", total_time_seconds);
         LOG_INFO(g_logger, "setup_time=%.6f", total_time_seconds - render_time_seconds);
         LOG_INFO(g_logger, "render_time=%.6f", render_time_seconds);
+        LOG_INFO(g_logger, "samples=" FMT_UINT64, sample_count);
+        LOG_INFO(g_logger, "peak_memory=" FMT_SIZE_T, get_peak_total_accounted_memory_size());
 
         return true;
     }
@@ -742,6 +1427,9 @@ int main(int argc, const char* argv[])
     // Apply command line arguments.
     g_cl.apply(g_logger);
 
+    // Keep console and file output off the rendering threads.
+    g_logger.enable_async_logging();
+
     // Configure the renderer's global logger.
     // Must be done after settings have been loaded and the command line
     // has been parsed, because these two operations may replace the log
@@ -758,13 +1446,25 @@ int main(int argc, const char* argv[])
     if (g_cl.m_run_unit_benchmarks.is_set())
         run_unit_benchmarks();
 
+    // Compare benchmark results.
+    if (g_cl.m_compare_benchmarks.is_set())
+        success = success && compare_benchmarks();
+
+    // Serve render requests.
+    if (g_cl.m_server.is_set())
+        success = success && serve(g_cl.m_server.value());
+
     // Render the specified project.
-    if (!g_cl.m_filename.values().empty())
+    else if (!g_cl.m_filename.values().empty())
     {
         const string project_filename = g_cl.m_filename.value();
 
-        if (g_cl.m_benchmark_mode.is_set())
+        if (g_cl.m_worker.is_set())
+            success = success && worker_render(project_filename);
+        else if (g_cl.m_benchmark_mode.is_set())
             success = success && benchmark_render(project_filename);
+        else if (g_cl.m_frames.is_set() || g_cl.m_sequence.is_set())
+            success = success && render_sequence(project_filename);
         else success = success && render(project_filename);
     }
 
@@ -0,0 +1,252 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "streamingtilecallback.h"
+
+// appleseed.cli headers.
+#include "progresstilecallback.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/aov.h"
+#include "renderer/api/frame.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exception.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/image/imageattributes.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/progressiveexrimagefilewriter.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/filesystem/path.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace appleseed {
+namespace cli {
+
+//
+// StreamingTileCallback.
+//
+
+namespace
+{
+    class StreamingTileCallback
+      : public ProgressTileCallback
+    {
+      public:
+        StreamingTileCallback(const string& output_path, Logger& logger)
+          : ProgressTileCallback(logger)
+          , m_output_path(output_path)
+          , m_failed(false)
+        {
+        }
+
+        ~StreamingTileCallback()
+        {
+            for (size_t i = 0, e = m_writers.size(); i < e; ++i)
+            {
+                try
+                {
+                    if (m_writers[i]->is_open())
+                    {
+                        m_writers[i]->close();
+                        LOG_INFO(m_logger, "wrote image file %s.", m_file_paths[i].c_str());
+                    }
+                }
+                catch (const Exception& e)
+                {
+                    LOG_ERROR(m_logger, "failed to write image file %s: %s.", m_file_paths[i].c_str(), e.what());
+                }
+
+                delete m_writers[i];
+            }
+        }
+
+      private:
+        const bf::path                                  m_output_path;
+        bool                                            m_failed;
+        vector<ProgressiveEXRImageFileWriter*>          m_writers;      // main image first, then AOV images
+        vector<string>                                  m_file_paths;
+
+        virtual void do_post_render_tile(
+            const Frame*    frame,
+            const size_t    tile_x,
+            const size_t    tile_y) APPLESEED_OVERRIDE
+        {
+            ProgressTileCallback::do_post_render_tile(frame, tile_x, tile_y);
+
+            if (m_failed)
+                return;
+
+            try
+            {
+                if (m_writers.empty())
+                    open_files(frame);
+
+                // Write the tile of the main image.
+                Image& image = frame->image();
+                Tile output_tile(image.tile(tile_x, tile_y), get_file_pixel_format(image));
+                frame->transform_to_output_color_space(output_tile);
+                m_writers[0]->write_tile(output_tile, tile_x, tile_y);
+
+                // Write the tiles of the AOV images. AOVs are always in the linear color space.
+                const ImageStack& aov_images = frame->aov_images();
+                for (size_t i = 0, e = aov_images.size(); i < e; ++i)
+                    write_tile(aov_images.get_image(i), tile_x, tile_y, *m_writers[i + 1]);
+            }
+            catch (const Exception& e)
+            {
+                LOG_ERROR(m_logger, "failed to stream tile to disk: %s.", e.what());
+                m_failed = true;
+                return;
+            }
+
+            // The tiles are on disk: release their memory.
+            frame->image().set_tile(tile_x, tile_y, 0);
+            for (size_t i = 0, e = frame->aov_images().size(); i < e; ++i)
+                frame->aov_images().get_image(i).set_tile(tile_x, tile_y, 0);
+        }
+
+        void open_files(const Frame* frame)
+        {
+            const ImageAttributes image_attributes =
+                ImageAttributes::create_default_attributes();
+
+            open_file(m_output_path.string(), frame->image(), image_attributes);
+
+            // AOV images are named like in renderer::Frame::write_aov_images().
+            const bf::path directory = m_output_path.parent_path();
+            const string base_file_name = m_output_path.stem().string();
+            const string extension = m_output_path.extension().string();
+
+            const ImageStack& aov_images = frame->aov_images();
+            for (size_t i = 0, e = aov_images.size(); i < e; ++i)
+            {
+                const string aov_file_name =
+                    base_file_name + "." + make_safe_filename(aov_images.get_name(i)) + extension;
+
+                open_file(
+                    (directory / aov_file_name).string(),
+                    aov_images.get_image(i),
+                    image_attributes);
+            }
+        }
+
+        void open_file(
+            const string&           file_path,
+            const Image&            image,
+            const ImageAttributes&  image_attributes)
+        {
+            const CanvasProperties& props = image.properties();
+
+            m_writers.push_back(new ProgressiveEXRImageFileWriter());
+            m_file_paths.push_back(file_path);
+
+            m_writers.back()->open(
+                file_path.c_str(),
+                CanvasProperties(
+                    props.m_canvas_width,
+                    props.m_canvas_height,
+                    props.m_tile_width,
+                    props.m_tile_height,
+                    props.m_channel_count,
+                    get_file_pixel_format(image)),
+                image_attributes);
+        }
+
+        static void write_tile(
+            const Image&                    image,
+            const size_t                    tile_x,
+            const size_t                    tile_y,
+            ProgressiveEXRImageFileWriter&  writer)
+        {
+            const Tile& tile = image.tile(tile_x, tile_y);
+
+            if (tile.get_pixel_format() == get_file_pixel_format(image))
+                writer.write_tile(tile, tile_x, tile_y);
+            else writer.write_tile(Tile(tile, get_file_pixel_format(image)), tile_x, tile_y);
+        }
+
+        // OpenEXR only stores half, float and uint32 channels.
+        static PixelFormat get_file_pixel_format(const Image& image)
+        {
+            const PixelFormat pixel_format = image.properties().m_pixel_format;
+
+            switch (pixel_format)
+            {
+              case PixelFormatHalf:
+              case PixelFormatFloat:
+              case PixelFormatUInt32:
+                return pixel_format;
+
+              default:
+                return PixelFormatHalf;
+            }
+        }
+    };
+}
+
+
+//
+// StreamingTileCallbackFactory class implementation.
+//
+
+StreamingTileCallbackFactory::StreamingTileCallbackFactory(
+    const string&   output_path,
+    Logger&         logger)
+  : m_callback(new StreamingTileCallback(output_path, logger))
+{
+}
+
+void StreamingTileCallbackFactory::release()
+{
+    delete this;
+}
+
+ITileCallback* StreamingTileCallbackFactory::create()
+{
+    return m_callback.get();
+}
+
+}   // namespace cli
+}   // namespace appleseed
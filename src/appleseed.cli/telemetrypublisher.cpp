@@ -0,0 +1,230 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "telemetrypublisher.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/log.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/asio.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+namespace asio = boost::asio;
+using asio::ip::tcp;
+
+namespace appleseed {
+namespace cli {
+
+namespace
+{
+    // Remove the line breaks and the indentation of a multi-line JSON document.
+    string make_single_line(const string& json)
+    {
+        string result;
+        result.reserve(json.size());
+
+        for (size_t i = 0, e = json.size(); i < e; ++i)
+        {
+            if (json[i] == '\n')
+            {
+                while (i + 1 < e && json[i + 1] == ' ')
+                    ++i;
+            }
+            else result += json[i];
+        }
+
+        return result;
+    }
+}
+
+
+//
+// TelemetryPublisher class implementation.
+//
+
+struct TelemetryPublisher::Impl
+{
+    Logger&                     m_logger;
+    const string                m_output;
+    ofstream                    m_file;
+    asio::io_service            m_io_service;
+    auto_ptr<tcp::socket>       m_socket;
+
+    Impl(const string& output, Logger& logger)
+      : m_logger(logger)
+      , m_output(output)
+    {
+        if (m_output.empty())
+            return;
+
+        if (m_output.compare(0, 6, "tcp://") == 0)
+            connect(m_output.substr(6));
+        else
+        {
+            m_file.open(m_output.c_str());
+
+            if (!m_file.is_open())
+                LOG_ERROR(m_logger, "failed to open telemetry file %s.", m_output.c_str());
+        }
+    }
+
+    void connect(const string& address)
+    {
+        const string::size_type colon_pos = address.find_last_of(':');
+        if (colon_pos == string::npos || colon_pos == 0)
+        {
+            LOG_ERROR(m_logger, "invalid telemetry address \"%s\", expected tcp://host:port.", m_output.c_str());
+            return;
+        }
+
+        try
+        {
+            const string host = address.substr(0, colon_pos);
+            const unsigned short port = from_string<unsigned short>(address.substr(colon_pos + 1));
+
+            m_socket.reset(new tcp::socket(m_io_service));
+
+            tcp::resolver resolver(m_io_service);
+            const tcp::resolver::query query(host, foundation::to_string(port));
+            asio::connect(*m_socket, resolver.resolve(query));
+
+            LOG_INFO(m_logger, "publishing telemetry to %s:%u.", host.c_str(), port);
+        }
+        catch (const ExceptionStringConversionError&)
+        {
+            m_socket.reset();
+            LOG_ERROR(m_logger, "invalid telemetry address \"%s\", expected tcp://host:port.", m_output.c_str());
+        }
+        catch (const boost::system::system_error& e)
+        {
+            m_socket.reset();
+            LOG_ERROR(m_logger, "failed to connect to %s: %s.", m_output.c_str(), e.what());
+        }
+    }
+
+    void log_summary(const RenderTelemetry& telemetry) const
+    {
+        string progress;
+        if (telemetry.m_progress >= 0.0)
+        {
+            progress = pretty_percent(telemetry.m_progress, 1.0) + " done, ";
+
+            if (telemetry.m_remaining_time >= 0.0)
+                progress += pretty_time(telemetry.m_remaining_time, 0) + " remaining, ";
+        }
+
+        LOG_INFO(
+            m_logger,
+            "telemetry: %s%s samples/s, %s rays/s, %s in use, texture cache hit rate %s",
+            progress.c_str(),
+            pretty_uint(static_cast<uint64>(telemetry.m_samples_per_second)).c_str(),
+            pretty_uint(static_cast<uint64>(telemetry.m_rays_per_second)).c_str(),
+            pretty_size(telemetry.m_memory_size).c_str(),
+            pretty_percent(
+                telemetry.m_texture_cache_hit_count,
+                telemetry.m_texture_cache_hit_count + telemetry.m_texture_cache_miss_count).c_str());
+    }
+
+    void publish(const RenderTelemetry& telemetry)
+    {
+        if (!m_file.is_open() && m_socket.get() == 0)
+            return;
+
+        stringstream sstr;
+        telemetry.get_statistics().write_json(sstr);
+        const string line = make_single_line(sstr.str()) + "\n";
+
+        if (m_file.is_open())
+        {
+            m_file << line;
+            m_file.flush();
+
+            if (!m_file)
+            {
+                LOG_ERROR(m_logger, "failed to write telemetry to %s, giving up.", m_output.c_str());
+                m_file.close();
+            }
+        }
+
+        if (m_socket.get())
+        {
+            try
+            {
+                asio::write(*m_socket, asio::buffer(line.data(), line.size()));
+            }
+            catch (const boost::system::system_error& e)
+            {
+                LOG_ERROR(m_logger, "failed to publish telemetry to %s: %s, giving up.", m_output.c_str(), e.what());
+                m_socket.reset();
+            }
+        }
+    }
+};
+
+TelemetryPublisher::TelemetryPublisher(
+    const string&   output,
+    Logger&         logger)
+  : impl(new Impl(output, logger))
+{
+}
+
+TelemetryPublisher::~TelemetryPublisher()
+{
+    delete impl;
+}
+
+void TelemetryPublisher::release()
+{
+    delete this;
+}
+
+void TelemetryPublisher::on_telemetry(const RenderTelemetry& telemetry)
+{
+    impl->log_summary(telemetry);
+    impl->publish(telemetry);
+}
+
+}   // namespace cli
+}   // namespace appleseed
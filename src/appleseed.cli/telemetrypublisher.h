@@ -0,0 +1,79 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_CLI_TELEMETRYPUBLISHER_H
+#define APPLESEED_CLI_TELEMETRYPUBLISHER_H
+
+// appleseed.renderer headers.
+#include "renderer/api/rendering.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+
+// Standard headers.
+#include <string>
+
+// Forward declarations.
+namespace foundation    { class Logger; }
+
+namespace appleseed {
+namespace cli {
+
+//
+// Prints a one-line summary of the render telemetry and optionally publishes it
+// as JSON, one object per line, to a file or to a TCP socket.
+//
+// The output is either a file path or an address of the form tcp://host:port.
+// Telemetry is no longer published if the output fails, but rendering goes on.
+//
+
+class TelemetryPublisher
+  : public renderer::ITelemetryCallback
+{
+  public:
+    TelemetryPublisher(
+        const std::string&  output,         // file path, tcp://host:port, or empty
+        foundation::Logger& logger);
+
+    ~TelemetryPublisher();
+
+    virtual void release() APPLESEED_OVERRIDE;
+
+    virtual void on_telemetry(const renderer::RenderTelemetry& telemetry) APPLESEED_OVERRIDE;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace cli
+}       // namespace appleseed
+
+#endif  // !APPLESEED_CLI_TELEMETRYPUBLISHER_H
@@ -31,14 +31,17 @@
 #include "pyseed.h" // has to be first, to avoid redefinition warnings
 #include "bindentitycontainers.h"
 #include "dict2dict.h"
+#include "unalignedtransform.h"
 
 // appleseed.renderer headers.
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/assemblyfactoryregistrar.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/iassemblyfactory.h"
+#include "renderer/modeling/scene/objectinstance.h"
 
 // Standard headers.
+#include <cstddef>
 #include <string>
 
 namespace bpy = boost::python;
@@ -109,6 +112,80 @@ namespace
     {
         return instance->get_assembly_name();
     }
+
+    void check_definition_length(
+        const bpy::object&  definition,
+        const bpy::ssize_t  min_length,
+        const bpy::ssize_t  max_length)
+    {
+        const bpy::ssize_t length = bpy::len(definition);
+
+        if (length < min_length || length > max_length)
+        {
+            PyErr_SetString(PyExc_TypeError, "Invalid entity definition: wrong number of items.");
+            bpy::throw_error_already_set();
+        }
+    }
+
+    // Each definition is a sequence of the arguments of the AssemblyInstance constructor,
+    // optionally followed by a transform.
+    size_t create_assembly_instances(
+        BaseGroup*          group,
+        const bpy::list&    definitions)
+    {
+        const bpy::ssize_t count = bpy::len(definitions);
+
+        for (bpy::ssize_t i = 0; i < count; ++i)
+        {
+            const bpy::object definition = definitions[i];
+            check_definition_length(definition, 3, 4);
+
+            auto_release_ptr<AssemblyInstance> instance(
+                AssemblyInstanceFactory::create(
+                    bpy::extract<string>(definition[0])().c_str(),
+                    bpy_dict_to_param_array(bpy::extract<bpy::dict>(definition[1])()),
+                    bpy::extract<string>(definition[2])().c_str()));
+
+            if (bpy::len(definition) == 4)
+            {
+                const UnalignedTransformd transform = bpy::extract<UnalignedTransformd>(definition[3]);
+                instance->transform_sequence().set_transform(0.0, transform.as_foundation_transform());
+            }
+
+            group->assembly_instances().insert(instance);
+        }
+
+        return static_cast<size_t>(count);
+    }
+
+    // Each definition is a sequence of the arguments of the ObjectInstance constructor.
+    size_t create_object_instances(
+        Assembly*           assembly,
+        const bpy::list&    definitions)
+    {
+        const bpy::ssize_t count = bpy::len(definitions);
+
+        for (bpy::ssize_t i = 0; i < count; ++i)
+        {
+            const bpy::object definition = definitions[i];
+            check_definition_length(definition, 5, 6);
+
+            const UnalignedTransformd transform = bpy::extract<UnalignedTransformd>(definition[3]);
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    bpy::extract<string>(definition[0])().c_str(),
+                    bpy_dict_to_param_array(bpy::extract<bpy::dict>(definition[1])()),
+                    bpy::extract<string>(definition[2])().c_str(),
+                    transform.as_foundation_transform(),
+                    bpy_dict_to_dictionary(bpy::extract<bpy::dict>(definition[4])()).strings(),
+                    bpy::len(definition) == 6
+                        ? bpy_dict_to_dictionary(bpy::extract<bpy::dict>(definition[5])()).strings()
+                        : StringDictionary()));
+        }
+
+        return static_cast<size_t>(count);
+    }
 }
 
 void bind_assembly()
@@ -120,6 +197,7 @@ void bind_assembly()
         .def("shader_groups", &BaseGroup::shader_groups, bpy::return_value_policy<bpy::reference_existing_object>())
         .def("assemblies", &BaseGroup::assemblies, bpy::return_value_policy<bpy::reference_existing_object>())
         .def("assembly_instances", &BaseGroup::assembly_instances, bpy::return_value_policy<bpy::reference_existing_object>())
+        .def("create_assembly_instances", create_assembly_instances)
         ;
 
     bpy::class_<Assembly, auto_release_ptr<Assembly>, bpy::bases<Entity, BaseGroup>, boost::noncopyable>("Assembly", bpy::no_init)
@@ -133,6 +211,7 @@ void bind_assembly()
         .def("lights", &Assembly::lights, bpy::return_value_policy<bpy::reference_existing_object>())
         .def("objects", &Assembly::objects, bpy::return_value_policy<bpy::reference_existing_object>())
         .def("object_instances", &Assembly::object_instances, bpy::return_value_policy<bpy::reference_existing_object>())
+        .def("create_object_instances", create_object_instances)
         .def("compute_local_bbox", &Assembly::compute_local_bbox)
         .def("compute_non_hierarchical_local_bbox", &Assembly::compute_local_bbox)
         ;
@@ -40,11 +40,15 @@
 #include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
 #include "foundation/platform/types.h"
+#include "foundation/utility/otherwise.h"
 
 // Standard headers.
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <cstring>
 #include <string>
+#include <vector>
 
 namespace bpy = boost::python;
 using namespace foundation;
@@ -109,6 +113,177 @@ namespace
         return pixels;
     }
 
+    //
+    // Buffer protocol support.
+    //
+    // Tiles expose their pixels as read-only buffers of shape (height, width, channels)
+    // without copying, so that numpy.asarray(tile) is a view of the tile. Images are
+    // stored as separate tiles, so they expose a contiguous copy of their pixels.
+    //
+
+    const char* get_buffer_format(const PixelFormat pixel_format)
+    {
+        switch (pixel_format)
+        {
+          case PixelFormatUInt8:  return "B";
+          case PixelFormatUInt16: return "H";
+          case PixelFormatUInt32: return "I";
+          case PixelFormatHalf:   return "e";
+          case PixelFormatFloat:  return "f";
+          case PixelFormatDouble: return "d";
+          assert_otherwise;
+        }
+
+        return 0;
+    }
+
+    // Per-buffer storage, owned by the Py_buffer and freed when it is released.
+    struct BufferInfo
+    {
+        Py_ssize_t          m_shape[3];
+        Py_ssize_t          m_strides[3];
+        std::vector<uint8>  m_pixels;       // only used for images
+    };
+
+    int fill_buffer(
+        Py_buffer*          view,
+        PyObject*           obj,
+        const int           flags,
+        BufferInfo*         info,
+        const uint8*        pixels,
+        const size_t        width,
+        const size_t        height,
+        const size_t        channel_count,
+        const PixelFormat   pixel_format)
+    {
+        const size_t channel_size = Pixel::size(pixel_format);
+
+        info->m_shape[0] = static_cast<Py_ssize_t>(height);
+        info->m_shape[1] = static_cast<Py_ssize_t>(width);
+        info->m_shape[2] = static_cast<Py_ssize_t>(channel_count);
+        info->m_strides[0] = static_cast<Py_ssize_t>(width * channel_count * channel_size);
+        info->m_strides[1] = static_cast<Py_ssize_t>(channel_count * channel_size);
+        info->m_strides[2] = static_cast<Py_ssize_t>(channel_size);
+
+        view->buf = const_cast<uint8*>(pixels);
+        view->obj = obj;
+        view->len = static_cast<Py_ssize_t>(width * height * channel_count * channel_size);
+        view->readonly = 1;
+        view->itemsize = static_cast<Py_ssize_t>(channel_size);
+        view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>(get_buffer_format(pixel_format)) : 0;
+        view->ndim = 3;
+        view->shape = (flags & PyBUF_ND) ? info->m_shape : 0;
+        view->strides = (flags & PyBUF_STRIDES) ? info->m_strides : 0;
+        view->suboffsets = 0;
+        view->internal = info;
+
+        Py_INCREF(obj);
+
+        return 0;
+    }
+
+    bool check_buffer_flags(Py_buffer* view, const int flags)
+    {
+        if (flags & PyBUF_WRITABLE)
+        {
+            PyErr_SetString(PyExc_BufferError, "appleseed image buffers are read-only");
+            view->obj = 0;
+            return false;
+        }
+
+        return true;
+    }
+
+    int tile_get_buffer(PyObject* obj, Py_buffer* view, int flags)
+    {
+        if (!check_buffer_flags(view, flags))
+            return -1;
+
+        const Tile& tile = bpy::extract<const Tile&>(obj)();
+
+        return
+            fill_buffer(
+                view,
+                obj,
+                flags,
+                new BufferInfo(),
+                tile.get_storage(),
+                tile.get_width(),
+                tile.get_height(),
+                tile.get_channel_count(),
+                tile.get_pixel_format());
+    }
+
+    int image_get_buffer(PyObject* obj, Py_buffer* view, int flags)
+    {
+        if (!check_buffer_flags(view, flags))
+            return -1;
+
+        const Image& image = bpy::extract<const Image&>(obj)();
+        const CanvasProperties& props = image.properties();
+
+        BufferInfo* info = new BufferInfo();
+        info->m_pixels.resize(props.m_pixel_count * props.m_pixel_size);
+
+        const size_t row_size = props.m_canvas_width * props.m_pixel_size;
+
+        for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+        {
+            for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+            {
+                const Tile& tile = image.tile(tx, ty);
+                const size_t tile_row_size = tile.get_width() * props.m_pixel_size;
+
+                for (size_t py = 0, ph = tile.get_height(); py < ph; ++py)
+                {
+                    const size_t y = ty * props.m_tile_height + py;
+
+                    memcpy(
+                        &info->m_pixels[y * row_size + tx * props.m_tile_width * props.m_pixel_size],
+                        tile.get_storage() + py * tile_row_size,
+                        tile_row_size);
+                }
+            }
+        }
+
+        return
+            fill_buffer(
+                view,
+                obj,
+                flags,
+                info,
+                info->m_pixels.empty() ? 0 : &info->m_pixels[0],
+                props.m_canvas_width,
+                props.m_canvas_height,
+                props.m_channel_count,
+                props.m_pixel_format);
+    }
+
+    void release_buffer(PyObject* obj, Py_buffer* view)
+    {
+        delete static_cast<BufferInfo*>(view->internal);
+    }
+
+    PyBufferProcs g_tile_buffer_procs;
+    PyBufferProcs g_image_buffer_procs;
+
+    void set_buffer_procs(
+        const bpy::object&  cls,
+        PyBufferProcs&      procs,
+        getbufferproc       get_buffer)
+    {
+        memset(&procs, 0, sizeof(PyBufferProcs));
+        procs.bf_getbuffer = get_buffer;
+        procs.bf_releasebuffer = release_buffer;
+
+        PyTypeObject* type = reinterpret_cast<PyTypeObject*>(cls.ptr());
+        type->tp_as_buffer = &procs;
+
+#if PY_MAJOR_VERSION == 2
+        type->tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
+    }
+
     Image* copy_image(const Image* source)
     {
         return new Image(*source);
@@ -157,28 +332,33 @@ void bind_image()
         .def("get_tile_height", &CanvasProperties::get_tile_height)
         ;
 
-    bpy::class_<Tile, boost::noncopyable>("Tile", bpy::init<size_t, size_t, size_t, PixelFormat>())
-        .def("__copy__", copy_tile, bpy::return_value_policy<bpy::manage_new_object>())
-        .def("__deepcopy__", deepcopy_tile, bpy::return_value_policy<bpy::manage_new_object>())
-        .def("get_pixel_format", &Tile::get_pixel_format)
-        .def("get_width", &Tile::get_width)
-        .def("get_height", &Tile::get_height)
-        .def("get_channel_count", &Tile::get_channel_count)
-        .def("get_pixel_count", &Tile::get_pixel_count)
-        .def("get_size", &Tile::get_size)
-        .def("copy_data_to", copy_tile_data_to_py_buffer)   // todo: maybe this needs a better name
-
-        .def("blender_tile_data", blender_tile_data)
-        ;
+    const bpy::object tile_class =
+        bpy::class_<Tile, boost::noncopyable>("Tile", bpy::init<size_t, size_t, size_t, PixelFormat>())
+            .def("__copy__", copy_tile, bpy::return_value_policy<bpy::manage_new_object>())
+            .def("__deepcopy__", deepcopy_tile, bpy::return_value_policy<bpy::manage_new_object>())
+            .def("get_pixel_format", &Tile::get_pixel_format)
+            .def("get_width", &Tile::get_width)
+            .def("get_height", &Tile::get_height)
+            .def("get_channel_count", &Tile::get_channel_count)
+            .def("get_pixel_count", &Tile::get_pixel_count)
+            .def("get_size", &Tile::get_size)
+            .def("copy_data_to", copy_tile_data_to_py_buffer)   // todo: maybe this needs a better name
+
+            .def("blender_tile_data", blender_tile_data)
+            ;
 
     const Tile& (Image::*image_get_tile)(const size_t, const size_t) const = &Image::tile;
 
-    bpy::class_<Image, boost::noncopyable>("Image", bpy::no_init)
-        .def("__copy__", copy_image, bpy::return_value_policy<bpy::manage_new_object>())
-        .def("__deepcopy__", copy_image, bpy::return_value_policy<bpy::manage_new_object>())
-        .def("properties", &Image::properties, bpy::return_value_policy<bpy::reference_existing_object>())
-        .def("tile", image_get_tile, bpy::return_value_policy<bpy::reference_existing_object>())
-        ;
+    const bpy::object image_class =
+        bpy::class_<Image, boost::noncopyable>("Image", bpy::no_init)
+            .def("__copy__", copy_image, bpy::return_value_policy<bpy::manage_new_object>())
+            .def("__deepcopy__", copy_image, bpy::return_value_policy<bpy::manage_new_object>())
+            .def("properties", &Image::properties, bpy::return_value_policy<bpy::reference_existing_object>())
+            .def("tile", image_get_tile, bpy::return_value_policy<bpy::reference_existing_object>())
+            ;
+
+    set_buffer_procs(tile_class, g_tile_buffer_procs, tile_get_buffer);
+    set_buffer_procs(image_class, g_image_buffer_procs, image_get_buffer);
 
     const Image& (ImageStack::*image_stack_get_image)(const size_t) const = &ImageStack::get_image;
 
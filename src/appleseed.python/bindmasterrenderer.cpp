@@ -30,14 +30,19 @@
 // appleseed.python headers.
 #include "pyseed.h" // has to be first, to avoid redefinition warnings
 #include "dict2dict.h"
+#include "eventdispatcher.h"
 #include "gillocks.h"
 
 // appleseed.renderer headers.
 #include "renderer/api/project.h"
 #include "renderer/api/rendering.h"
 
+// appleseed.foundation headers.
+#include "foundation/utility/statistics.h"
+
 // Standard headers.
 #include <memory>
+#include <sstream>
 
 namespace bpy = boost::python;
 using namespace foundation;
@@ -48,6 +53,8 @@ namespace
     // A class that wraps MasterRenderer and keeps a Python
     // reference to the project object to prevent it being
     // destroyed by Python before the MasterRenderer is destroyed.
+    // Controller and tile callback events reach Python through
+    // an event dispatcher.
     struct MasterRendererWrapper
     {
         MasterRendererWrapper(
@@ -56,13 +63,14 @@ namespace
             IRendererController*        renderer_controller,
             ITileCallbackFactory*       tile_callback_factory = 0)
           : m_project(project)
+          , m_dispatcher(new EventDispatcher(renderer_controller, 0))
         {
             Project* proj = bpy::extract<Project*>(project);
             m_renderer.reset(
                 new MasterRenderer(
                     *proj,
                     params,
-                    renderer_controller,
+                    m_dispatcher->get_renderer_controller(),
                     tile_callback_factory));
         }
 
@@ -71,18 +79,20 @@ namespace
             const ParamArray&           params,
             IRendererController*        renderer_controller,
             ITileCallback*              tile_callback)
-            : m_project(project)
+          : m_project(project)
+          , m_dispatcher(new EventDispatcher(renderer_controller, tile_callback))
         {
             Project* proj = bpy::extract<Project*>(project);
             m_renderer.reset(
                 new MasterRenderer(
                     *proj,
                     params,
-                    renderer_controller,
-                    tile_callback));
+                    m_dispatcher->get_renderer_controller(),
+                    m_dispatcher->get_tile_callback()));
         }
 
         bpy::object                     m_project;
+        std::auto_ptr<EventDispatcher>  m_dispatcher;
         std::auto_ptr<MasterRenderer>   m_renderer;
     };
 
@@ -126,13 +136,43 @@ namespace
         m->m_renderer->get_parameters() = bpy_dict_to_param_array(params);
     }
 
-    bool master_renderer_render(MasterRendererWrapper* m)
+    // When dispatch_events is true, controller and tile callback events are delivered to
+    // Python in batches by a dispatcher thread, and rendering threads never wait on the GIL.
+    bool master_renderer_render_dispatch_events(MasterRendererWrapper* m, const bool dispatch_events)
     {
+#if PY_VERSION_HEX < 0x03070000
+        // The dispatcher thread needs Python's thread support to lock the GIL.
+        if (dispatch_events)
+            PyEval_InitThreads();
+#endif
+
         // Unlock Python's global interpreter lock (GIL) while we do lenghty C++ computations.
         // The GIL is locked again when unlock goes out of scope.
         ScopedGILUnlock unlock;
 
-        return m->m_renderer->render();
+        if (dispatch_events)
+            m->m_dispatcher->start();
+
+        const bool result = m->m_renderer->render();
+
+        if (dispatch_events)
+            m->m_dispatcher->stop();
+
+        return result;
+    }
+
+    bool master_renderer_render(MasterRendererWrapper* m)
+    {
+        return master_renderer_render_dispatch_events(m, false);
+    }
+
+    bpy::object master_renderer_get_render_statistics(const MasterRendererWrapper* m)
+    {
+        // Go through JSON so that statistics keep their types and structure.
+        std::stringstream sstr;
+        m->m_renderer->get_render_statistics().write_json(sstr);
+
+        return bpy::import("json").attr("loads")(sstr.str());
     }
 }
 
@@ -144,5 +184,7 @@ void bind_master_renderer()
         .def("get_parameters", master_renderer_get_parameters)
         .def("set_parameters", master_renderer_set_parameters)
         .def("render", master_renderer_render)
+        .def("render", master_renderer_render_dispatch_events)
+        .def("get_render_statistics", master_renderer_get_render_statistics)
         ;
 }
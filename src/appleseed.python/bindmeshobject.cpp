@@ -31,16 +31,22 @@
 #include "pyseed.h" // has to be first, to avoid redefinition warnings
 #include "bindentitycontainers.h"
 #include "dict2dict.h"
+#include "gillocks.h"
 
 // appleseed.renderer headers.
 #include "renderer/api/object.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/searchpaths.h"
 
 // Standard headers.
 #include <cstddef>
+#include <cstring>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace bpy = boost::python;
 using namespace foundation;
@@ -74,6 +80,287 @@ namespace
         object->get_triangle(index) = triangle;
     }
 
+    //
+    // Bulk insertion from objects supporting the buffer protocol (NumPy arrays,
+    // array.array, memoryview, etc.). Arrays must be C-contiguous, and either have
+    // shape (N, C) where C is the number of components per item, or be flat with a
+    // length that is a multiple of C.
+    //
+
+    class PyBufferView
+      : public NonCopyable
+    {
+      public:
+        explicit PyBufferView(const bpy::object& obj)
+        {
+            if (PyObject_GetBuffer(obj.ptr(), &m_view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0)
+                bpy::throw_error_already_set();
+        }
+
+        ~PyBufferView()
+        {
+            PyBuffer_Release(&m_view);
+        }
+
+        // Return the format character, without byte order or alignment prefix.
+        char get_format() const
+        {
+            const char* format = m_view.format != 0 ? m_view.format : "B";
+
+            if (*format == '@' || *format == '=' || *format == '<' || *format == '>' || *format == '!')
+                ++format;
+
+            return *format;
+        }
+
+        size_t get_item_size() const
+        {
+            return static_cast<size_t>(m_view.itemsize);
+        }
+
+        const unsigned char* get_data() const
+        {
+            return static_cast<const unsigned char*>(m_view.buf);
+        }
+
+        // Return the number of items of a given number of components.
+        size_t get_item_count(const size_t components) const
+        {
+            const size_t element_count = static_cast<size_t>(m_view.len / m_view.itemsize);
+
+            if (m_view.ndim == 2 && static_cast<size_t>(m_view.shape[1]) == components)
+                return element_count / components;
+
+            if (m_view.ndim <= 1 && element_count % components == 0)
+                return element_count / components;
+
+            PyErr_SetString(PyExc_ValueError, "Incompatible array shape.");
+            bpy::throw_error_already_set();
+            return 0;
+        }
+
+        // Return an element of an integer array as a 32-bit index.
+        uint32 get_index(const size_t index) const
+        {
+            const unsigned char* p = get_data() + index * m_view.itemsize;
+            const bool is_signed = get_format() >= 'a' && get_format() <= 'z';
+
+            switch (m_view.itemsize)
+            {
+              case 1: { int8 s; memcpy(&s, p, 1); return is_signed ? static_cast<uint32>(s) : static_cast<uint8>(s); }
+              case 2: { int16 s; memcpy(&s, p, 2); return is_signed ? static_cast<uint32>(s) : static_cast<uint16>(s); }
+              case 4: { uint32 u; memcpy(&u, p, 4); return u; }
+              default: { uint64 u; memcpy(&u, p, 8); return static_cast<uint32>(u); }
+            }
+        }
+
+      private:
+        Py_buffer m_view;
+    };
+
+    void check_float_buffer(const PyBufferView& view)
+    {
+        const char format = view.get_format();
+
+        if (!(format == 'f' && view.get_item_size() == sizeof(float)) &&
+            !(format == 'd' && view.get_item_size() == sizeof(double)))
+        {
+            PyErr_SetString(PyExc_TypeError, "Incompatible type. Only float32 or float64 arrays.");
+            bpy::throw_error_already_set();
+        }
+    }
+
+    void check_index_buffer(const PyBufferView& view)
+    {
+        const char* integer_formats = "bBhHiIlLqQnN";
+        const char format = view.get_format();
+
+        if (format == '\0' || strchr(integer_formats, format) == 0)
+        {
+            PyErr_SetString(PyExc_TypeError, "Incompatible type. Only integer arrays.");
+            bpy::throw_error_already_set();
+        }
+    }
+
+    template <typename T>
+    T read_scalar(const unsigned char* data, const char format, const size_t index)
+    {
+        switch (format)
+        {
+          case 'f':
+            {
+                float value;
+                memcpy(&value, data + index * sizeof(float), sizeof(float));
+                return static_cast<T>(value);
+            }
+
+          default:
+            {
+                double value;
+                memcpy(&value, data + index * sizeof(double), sizeof(double));
+                return static_cast<T>(value);
+            }
+        }
+    }
+
+    // Copy an array of N-component vectors into a vector of GVectorN. When the layout
+    // of the buffer already matches, the data is returned in place and nothing is copied.
+    template <typename Vector>
+    const Vector* read_vectors(
+        const PyBufferView&     view,
+        const size_t            count,
+        vector<Vector>&    storage)
+    {
+        typedef typename Vector::ValueType ValueType;
+        const size_t N = Vector::Dimension;
+
+        const char format = view.get_format();
+        const char native_format = sizeof(ValueType) == sizeof(float) ? 'f' : 'd';
+
+        if (format == native_format && sizeof(Vector) == N * sizeof(ValueType))
+            return reinterpret_cast<const Vector*>(view.get_data());
+
+        storage.resize(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t j = 0; j < N; ++j)
+                storage[i][j] = read_scalar<ValueType>(view.get_data(), format, i * N + j);
+        }
+
+        return count > 0 ? &storage[0] : 0;
+    }
+
+    size_t push_vertices(MeshObject* object, const bpy::object& vertices)
+    {
+        const PyBufferView view(vertices);
+        check_float_buffer(view);
+        const size_t count = view.get_item_count(3);
+
+        ScopedGILUnlock unlock_gil;
+        vector<GVector3> storage;
+        return object->push_vertices(read_vectors(view, count, storage), count);
+    }
+
+    size_t push_vertex_normals(MeshObject* object, const bpy::object& normals)
+    {
+        const PyBufferView view(normals);
+        check_float_buffer(view);
+        const size_t count = view.get_item_count(3);
+
+        ScopedGILUnlock unlock_gil;
+        vector<GVector3> storage;
+        return object->push_vertex_normals(read_vectors(view, count, storage), count);
+    }
+
+    size_t push_tex_coords_array(MeshObject* object, const bpy::object& tex_coords)
+    {
+        const PyBufferView view(tex_coords);
+        check_float_buffer(view);
+        const size_t count = view.get_item_count(2);
+
+        ScopedGILUnlock unlock_gil;
+        vector<GVector2> storage;
+        return object->push_tex_coords(read_vectors(view, count, storage), count);
+    }
+
+    // Push triangles from arrays of vertex, vertex normal and texture coordinates indices
+    // of shape (N, 3) and an optional array of N material slot indices.
+    size_t push_triangles(
+        MeshObject*             object,
+        const bpy::object&      vertex_indices,
+        const bpy::object&      normal_indices,
+        const bpy::object&      tex_coords_indices,
+        const bpy::object&      material_slots)
+    {
+        const PyBufferView v_view(vertex_indices);
+        check_index_buffer(v_view);
+        const size_t count = v_view.get_item_count(3);
+
+        auto_ptr<PyBufferView> n_view, a_view, pa_view;
+
+        if (!normal_indices.is_none())
+        {
+            n_view.reset(new PyBufferView(normal_indices));
+            check_index_buffer(*n_view);
+        }
+
+        if (!tex_coords_indices.is_none())
+        {
+            a_view.reset(new PyBufferView(tex_coords_indices));
+            check_index_buffer(*a_view);
+        }
+
+        if (!material_slots.is_none())
+        {
+            pa_view.reset(new PyBufferView(material_slots));
+            check_index_buffer(*pa_view);
+        }
+
+        if ((n_view.get() && n_view->get_item_count(3) != count) ||
+            (a_view.get() && a_view->get_item_count(3) != count) ||
+            (pa_view.get() && pa_view->get_item_count(1) != count))
+        {
+            PyErr_SetString(PyExc_ValueError, "Index arrays must have the same number of triangles.");
+            bpy::throw_error_already_set();
+        }
+
+        ScopedGILUnlock unlock_gil;
+
+        vector<Triangle> triangles(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            Triangle& t = triangles[i];
+
+            t.m_v0 = v_view.get_index(i * 3 + 0);
+            t.m_v1 = v_view.get_index(i * 3 + 1);
+            t.m_v2 = v_view.get_index(i * 3 + 2);
+
+            if (n_view.get())
+            {
+                t.m_n0 = n_view->get_index(i * 3 + 0);
+                t.m_n1 = n_view->get_index(i * 3 + 1);
+                t.m_n2 = n_view->get_index(i * 3 + 2);
+            }
+            else t.m_n0 = t.m_n1 = t.m_n2 = Triangle::None;
+
+            if (a_view.get())
+            {
+                t.m_a0 = a_view->get_index(i * 3 + 0);
+                t.m_a1 = a_view->get_index(i * 3 + 1);
+                t.m_a2 = a_view->get_index(i * 3 + 2);
+            }
+            else t.m_a0 = t.m_a1 = t.m_a2 = Triangle::None;
+
+            t.m_pa =
+                pa_view.get()
+                    ? pa_view->get_index(i)
+                    : 0;
+        }
+
+        return object->push_triangles(count > 0 ? &triangles[0] : 0, count);
+    }
+
+    size_t push_triangles_v(MeshObject* object, const bpy::object& vertex_indices)
+    {
+        return push_triangles(object, vertex_indices, bpy::object(), bpy::object(), bpy::object());
+    }
+
+    size_t push_triangles_vn(MeshObject* object, const bpy::object& vertex_indices, const bpy::object& normal_indices)
+    {
+        return push_triangles(object, vertex_indices, normal_indices, bpy::object(), bpy::object());
+    }
+
+    size_t push_triangles_vna(
+        MeshObject*             object,
+        const bpy::object&      vertex_indices,
+        const bpy::object&      normal_indices,
+        const bpy::object&      tex_coords_indices)
+    {
+        return push_triangles(object, vertex_indices, normal_indices, tex_coords_indices, bpy::object());
+    }
+
     bpy::list read_mesh_objects(
         const bpy::list&    search_paths,
         const string&       base_object_name,
@@ -157,21 +444,28 @@ void bind_mesh_object()
 
         .def("reserve_vertices", &MeshObject::reserve_vertices)
         .def("push_vertex", &MeshObject::push_vertex)
+        .def("push_vertices", push_vertices)
         .def("get_vertex_count", &MeshObject::get_vertex_count)
         .def("get_vertex", &MeshObject::get_vertex, bpy::return_value_policy<bpy::reference_existing_object>())
 
         .def("reserve_vertex_normals", &MeshObject::reserve_vertex_normals)
         .def("push_vertex_normal", &MeshObject::push_vertex_normal)
+        .def("push_vertex_normals", push_vertex_normals)
         .def("get_vertex_normal_count", &MeshObject::get_vertex_normal_count)
-        .def("get_vertex_normal", &MeshObject::get_vertex_normal, bpy::return_value_policy<bpy::reference_existing_object>())
+        .def("get_vertex_normal", &MeshObject::get_vertex_normal)
 
         .def("reserve_tex_coords", &MeshObject::reserve_tex_coords)
-        .def("push_tex_coords", &MeshObject::push_tex_coords)
+        .def("push_tex_coords", static_cast<size_t (MeshObject::*)(const GVector2&)>(&MeshObject::push_tex_coords))
+        .def("push_tex_coords_array", push_tex_coords_array)
         .def("get_tex_coords_count", &MeshObject::get_tex_coords_count)
         .def("get_tex_coords", &MeshObject::get_tex_coords)
 
         .def("reserve_triangles", &MeshObject::reserve_triangles)
         .def("push_triangle", &MeshObject::push_triangle)
+        .def("push_triangles", push_triangles)
+        .def("push_triangles", push_triangles_vna)
+        .def("push_triangles", push_triangles_vn)
+        .def("push_triangles", push_triangles_v)
         .def("get_triangle_count", &MeshObject::get_triangle_count)
         .def("get_triangle", get_triangle, bpy::return_value_policy<bpy::reference_existing_object>())
         .def("set_triangle", set_triangle)
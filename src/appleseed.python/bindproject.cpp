@@ -31,6 +31,7 @@
 #include "pyseed.h" // has to be first, to avoid redefinition warnings
 #include "bindentitycontainers.h"
 #include "dict2dict.h"
+#include "gillocks.h"
 
 // appleseed.renderer headers.
 #include "renderer/api/display.h"
@@ -117,6 +118,7 @@ namespace
         const Project*                      project,
         const char*                         filepath)
     {
+        ScopedGILUnlock unlock_gil;
         return ProjectFileWriter::write(*project, filepath);
     }
 
@@ -126,6 +128,7 @@ namespace
         const char*                         filepath,
         int                                 opts)
     {
+        ScopedGILUnlock unlock_gil;
         return ProjectFileWriter::write(*project, filepath, opts);
     }
 
@@ -307,7 +310,8 @@ void bind_project()
         .value("OmitReadingMeshFiles", ProjectFileReader::OmitReadingMeshFiles)
         .value("OmitProjectFileUpdate", ProjectFileReader::OmitProjectFileUpdate)
         .value("OmitSearchPaths", ProjectFileReader::OmitSearchPaths)
-        .value("OmitProjectSchemaValidation", ProjectFileReader::OmitProjectSchemaValidation);
+        .value("OmitProjectSchemaValidation", ProjectFileReader::OmitProjectSchemaValidation)
+        .value("MergeIdenticalMeshObjects", ProjectFileReader::MergeIdenticalMeshObjects);
 
     bpy::class_<ProjectFileReader>("ProjectFileReader")
         .def("read", &project_file_reader_read_default_opts)
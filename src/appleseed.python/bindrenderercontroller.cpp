@@ -173,6 +173,7 @@ void bind_renderer_controller()
         .value("AbortRendering", IRendererController::AbortRendering)
         .value("RestartRendering", IRendererController::RestartRendering)
         .value("ReinitializeRendering", IRendererController::ReinitializeRendering)
+        .value("RestartRenderingAfterCameraChange", IRendererController::RestartRenderingAfterCameraChange)
         ;
 
     bpy::class_<IRendererControllerWrapper, boost::noncopyable>("IRendererController")
@@ -150,6 +150,7 @@ void bind_shader_group()
         .def("__init__", bpy::make_constructor(create_shader_group))
         .def("add_shader", add_shader)
         .def("add_connection", &ShaderGroup::add_connection)
+        .def("set_shader_param", &ShaderGroup::set_shader_param)
         .def("clear", &ShaderGroup::clear)
         ;
 
@@ -36,6 +36,8 @@
 #include "renderer/kernel/rendering/itilecallback.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
 #include "foundation/platform/compiler.h"
 
 namespace bpy = boost::python;
@@ -76,6 +78,11 @@ namespace
 
             if (bpy::override f = this->get_override("post_render_tile"))
                 f(bpy::ptr(frame), tile_x, tile_y);
+
+            // Hand the tile itself to Python. Tiles support the buffer protocol, so
+            // numpy.asarray(tile) is a view of the pixels, valid during the call only.
+            if (bpy::override f = this->get_override("post_render_tile_data"))
+                f(bpy::ptr(&frame->image().tile(tile_x, tile_y)), tile_x, tile_y);
         }
 
         void default_post_render_tile(const Frame* frame, const size_t tile_x, const size_t tile_y)
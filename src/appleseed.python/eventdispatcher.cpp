@@ -0,0 +1,398 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "eventdispatcher.h"
+
+// appleseed.python headers.
+#include "gillocks.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/irenderercontroller.h"
+#include "renderer/kernel/rendering/itilecallback.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/thread.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+#include "boost/bind.hpp"
+#include "boost/date_time/posix_time/posix_time.hpp"
+#include "boost/thread/condition_variable.hpp"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+namespace
+{
+    struct Event
+    {
+        enum Type
+        {
+            PreRender,
+            PostRenderTile,
+            PostRender
+        };
+
+        Type            m_type;
+        const Frame*    m_frame;
+        size_t          m_x;
+        size_t          m_y;
+        size_t          m_width;
+        size_t          m_height;
+    };
+
+    typedef vector<Event> EventVector;
+
+    // How often the dispatcher thread polls the controller status when no event arrives.
+    const size_t StatusPollIntervalMs = 20;
+}
+
+struct EventDispatcher::Impl
+{
+    class ControllerProxy
+      : public IRendererController
+    {
+      public:
+        explicit ControllerProxy(Impl& impl)
+          : m_impl(impl)
+        {
+        }
+
+        virtual void on_rendering_begin() APPLESEED_OVERRIDE
+        {
+            m_impl.deliver_now(&IRendererController::on_rendering_begin);
+        }
+
+        virtual void on_rendering_success() APPLESEED_OVERRIDE
+        {
+            m_impl.deliver_now(&IRendererController::on_rendering_success);
+        }
+
+        virtual void on_rendering_abort() APPLESEED_OVERRIDE
+        {
+            m_impl.deliver_now(&IRendererController::on_rendering_abort);
+        }
+
+        virtual void on_frame_begin() APPLESEED_OVERRIDE
+        {
+            m_impl.deliver_now(&IRendererController::on_frame_begin);
+        }
+
+        virtual void on_frame_end() APPLESEED_OVERRIDE
+        {
+            m_impl.deliver_now(&IRendererController::on_frame_end);
+        }
+
+        virtual void on_progress() APPLESEED_OVERRIDE
+        {
+            if (m_impl.m_running)
+                m_impl.post_progress();
+            else m_impl.m_controller->on_progress();
+        }
+
+        virtual Status get_status() const APPLESEED_OVERRIDE
+        {
+            return
+                m_impl.m_running
+                    ? static_cast<Status>(m_impl.m_status.load())
+                    : m_impl.m_controller->get_status();
+        }
+
+      private:
+        Impl& m_impl;
+    };
+
+    class TileCallbackProxy
+      : public ITileCallback
+    {
+      public:
+        explicit TileCallbackProxy(Impl& impl)
+          : m_impl(impl)
+        {
+        }
+
+        virtual void release() APPLESEED_OVERRIDE
+        {
+            // This object is owned by the dispatcher.
+        }
+
+        virtual void pre_render(
+            const size_t    x,
+            const size_t    y,
+            const size_t    width,
+            const size_t    height) APPLESEED_OVERRIDE
+        {
+            if (m_impl.m_running)
+            {
+                const Event event = { Event::PreRender, 0, x, y, width, height };
+                m_impl.post_event(event);
+            }
+            else m_impl.m_tile_callback->pre_render(x, y, width, height);
+        }
+
+        virtual void post_render_tile(
+            const Frame*    frame,
+            const size_t    tile_x,
+            const size_t    tile_y) APPLESEED_OVERRIDE
+        {
+            if (m_impl.m_running)
+            {
+                const Event event = { Event::PostRenderTile, frame, tile_x, tile_y, 0, 0 };
+                m_impl.post_event(event);
+            }
+            else m_impl.m_tile_callback->post_render_tile(frame, tile_x, tile_y);
+        }
+
+        virtual void post_render(const Frame* frame) APPLESEED_OVERRIDE
+        {
+            if (m_impl.m_running)
+            {
+                const Event event = { Event::PostRender, frame, 0, 0, 0, 0 };
+                m_impl.post_event(event);
+            }
+            else m_impl.m_tile_callback->post_render(frame);
+        }
+
+      private:
+        Impl& m_impl;
+    };
+
+    IRendererController*            m_controller;
+    ITileCallback*                  m_tile_callback;
+    auto_ptr<ControllerProxy>       m_controller_proxy;
+    auto_ptr<TileCallbackProxy>     m_tile_callback_proxy;
+
+    // Only changed while the renderer is not running.
+    bool                            m_running;
+
+    // Pending events.
+    boost::mutex                    m_mutex;
+    boost::condition_variable       m_event_posted;
+    EventVector                     m_events;
+    bool                            m_progress_pending;
+    bool                            m_stop;
+
+    // Delivery.
+    boost::mutex                    m_delivery_mutex;
+    boost::atomic<int>              m_status;
+    boost::thread                   m_thread;
+
+    Impl(
+        IRendererController*        controller,
+        ITileCallback*              tile_callback)
+      : m_controller(controller)
+      , m_tile_callback(tile_callback)
+      , m_running(false)
+      , m_progress_pending(false)
+      , m_stop(false)
+      , m_status(IRendererController::ContinueRendering)
+    {
+        m_controller_proxy.reset(new ControllerProxy(*this));
+
+        if (m_tile_callback)
+            m_tile_callback_proxy.reset(new TileCallbackProxy(*this));
+    }
+
+    void post_event(const Event& event)
+    {
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_events.push_back(event);
+        }
+
+        m_event_posted.notify_one();
+    }
+
+    void post_progress()
+    {
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_progress_pending = true;
+        }
+
+        m_event_posted.notify_one();
+    }
+
+    // Deliver pending events, then optionally call a controller method, and poll the
+    // controller status, all under a single acquisition of the GIL.
+    void deliver(
+        const EventVector&          events,
+        const bool                  progress,
+        void (IRendererController::*method)() = 0)
+    {
+        boost::mutex::scoped_lock lock(m_delivery_mutex);
+        ScopedGILLock gil_lock;
+
+        for (size_t i = 0, e = events.size(); i < e; ++i)
+        {
+            const Event& event = events[i];
+
+            switch (event.m_type)
+            {
+              case Event::PreRender:
+                m_tile_callback->pre_render(event.m_x, event.m_y, event.m_width, event.m_height);
+                break;
+
+              case Event::PostRenderTile:
+                m_tile_callback->post_render_tile(event.m_frame, event.m_x, event.m_y);
+                break;
+
+              case Event::PostRender:
+                m_tile_callback->post_render(event.m_frame);
+                break;
+            }
+        }
+
+        if (progress)
+            m_controller->on_progress();
+
+        if (method)
+            (m_controller->*method)();
+
+        m_status.store(m_controller->get_status());
+    }
+
+    // Deliver an infrequent event synchronously, after any pending event.
+    void deliver_now(void (IRendererController::*method)())
+    {
+        if (!m_running)
+        {
+            (m_controller->*method)();
+            return;
+        }
+
+        EventVector events;
+        bool progress;
+
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            events.swap(m_events);
+            progress = m_progress_pending;
+            m_progress_pending = false;
+        }
+
+        deliver(events, progress, method);
+    }
+
+    void run()
+    {
+        set_current_thread_name("python_events");
+
+        EventVector events;
+
+        while (true)
+        {
+            bool progress, stop;
+
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+
+                if (m_events.empty() && !m_progress_pending && !m_stop)
+                {
+                    m_event_posted.timed_wait(
+                        lock,
+                        boost::posix_time::milliseconds(StatusPollIntervalMs));
+                }
+
+                events.swap(m_events);
+                progress = m_progress_pending;
+                m_progress_pending = false;
+                stop = m_stop;
+            }
+
+            deliver(events, progress);
+            events.clear();
+
+            if (stop)
+                break;
+        }
+    }
+};
+
+EventDispatcher::EventDispatcher(
+    IRendererController*    controller,
+    ITileCallback*          tile_callback)
+  : impl(new Impl(controller, tile_callback))
+{
+}
+
+EventDispatcher::~EventDispatcher()
+{
+    if (impl->m_running)
+        stop();
+
+    delete impl;
+}
+
+IRendererController* EventDispatcher::get_renderer_controller() const
+{
+    return impl->m_controller_proxy.get();
+}
+
+ITileCallback* EventDispatcher::get_tile_callback() const
+{
+    return impl->m_tile_callback_proxy.get();
+}
+
+void EventDispatcher::start()
+{
+    assert(!impl->m_running);
+
+    {
+        ScopedGILLock lock;
+        impl->m_status.store(impl->m_controller->get_status());
+    }
+
+    impl->m_stop = false;
+    impl->m_running = true;
+    impl->m_thread = boost::thread(boost::bind(&Impl::run, impl));
+}
+
+void EventDispatcher::stop()
+{
+    assert(impl->m_running);
+
+    {
+        boost::mutex::scoped_lock lock(impl->m_mutex);
+        impl->m_stop = true;
+    }
+
+    impl->m_event_posted.notify_one();
+    impl->m_thread.join();
+    impl->m_running = false;
+}
@@ -0,0 +1,82 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_PYTHON_EVENTDISPATCHER_H
+#define APPLESEED_PYTHON_EVENTDISPATCHER_H
+
+// appleseed.python headers.
+#include "pyseed.h" // has to be first, to avoid redefinition warnings
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Forward declarations.
+namespace renderer  { class IRendererController; }
+namespace renderer  { class ITileCallback; }
+
+//
+// Delivers renderer controller and tile callback events to Python.
+//
+// The dispatcher stands between the renderer and the Python implementations
+// of IRendererController and ITileCallback. When it is stopped, events are
+// forwarded as they occur and each of them locks the GIL. When it is started,
+// frequent events (progress, tile and frame updates) are queued and delivered
+// in batches by a single dispatcher thread, which also polls the controller
+// status on behalf of the renderer, so that rendering threads never wait on
+// the GIL. Infrequent events (rendering and frame begin/end) are still
+// delivered synchronously, once pending events have been delivered.
+//
+
+class EventDispatcher
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. tile_callback may be null.
+    EventDispatcher(
+        renderer::IRendererController*  controller,
+        renderer::ITileCallback*        tile_callback);
+
+    // Destructor.
+    ~EventDispatcher();
+
+    // Return the objects to pass to the renderer in place of the wrapped ones.
+    renderer::IRendererController* get_renderer_controller() const;
+    renderer::ITileCallback* get_tile_callback() const;     // null if there is no tile callback
+
+    // Start and stop the dispatcher thread. Must be called without holding the GIL.
+    // stop() delivers pending events before returning.
+    void start();
+    void stop();
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+#endif  // !APPLESEED_PYTHON_EVENTDISPATCHER_H
@@ -32,5 +32,6 @@ from testbasis import *
 from testdict2dict import *
 from testentitymap import *
 from testentityvector import *
+from testmasterrenderer import *
 
 unittest.TestProgram(testRunner=unittest.TextTestRunner())
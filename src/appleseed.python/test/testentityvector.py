@@ -114,5 +114,21 @@ class TestEntityVector(unittest.TestCase):
         self.assertEqual(names, result_names)
         self.assertEqual(uids, result_uids)
 
+    def test_create_object_instances(self):
+        xform = asr.Transformd(asr.Matrix4d.identity())
+
+        count = self.ass.create_object_instances([
+            ("inst", {}, "obj", xform, {"default": "mat"}),
+            ("inst2", {}, "obj", xform, {"default": "mat"}, {"default": "back_mat"})])
+        self.assertEqual(count, 2)
+
+        insts = self.ass.object_instances()
+        self.assertEqual(len(insts), 2)
+        self.assertEqual(insts[0].get_name(), "inst")
+        self.assertEqual(insts[1].get_object_name(), "obj")
+        self.assertEqual(insts[1].get_back_material_mappings(), {"default": "back_mat"})
+
+        self.assertRaises(TypeError, self.ass.create_object_instances, [("inst3", {})])
+
 if __name__ == "__main__":
     unittest.main()
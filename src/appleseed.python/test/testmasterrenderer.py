@@ -0,0 +1,160 @@
+
+#
+# This source file is part of appleseed.
+# Visit http://appleseedhq.net/ for additional information and resources.
+#
+# This software is released under the MIT license.
+#
+# Copyright (c) 2016-2017 Francois Beaune, The appleseedhq Organization
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+import unittest
+import appleseed as asr
+
+
+class RecordingRendererController(asr.IRendererController):
+
+    def __init__(self, abort_on_frame_begin=False):
+        super(RecordingRendererController, self).__init__()
+        self.events = []
+        self.__abort_on_frame_begin = abort_on_frame_begin
+        self.__abort = False
+
+    def on_rendering_begin(self):
+        self.events.append("rendering_begin")
+
+    def on_rendering_success(self):
+        self.events.append("rendering_success")
+
+    def on_rendering_abort(self):
+        self.events.append("rendering_abort")
+
+    def on_frame_begin(self):
+        self.events.append("frame_begin")
+        self.__abort = self.__abort_on_frame_begin
+
+    def on_frame_end(self):
+        self.events.append("frame_end")
+
+    def on_progress(self):
+        self.events.append("progress")
+
+    def get_status(self):
+        if self.__abort:
+            return asr.IRenderControllerStatus.AbortRendering
+        else:
+            return asr.IRenderControllerStatus.ContinueRendering
+
+
+class RecordingTileCallback(asr.ITileCallback):
+
+    def __init__(self):
+        super(RecordingTileCallback, self).__init__()
+        self.tiles = []
+        self.post_render_count = 0
+
+    def pre_render(self, x, y, width, height):
+        pass
+
+    def post_render_tile(self, frame, tile_x, tile_y):
+        self.tiles.append((tile_x, tile_y))
+
+    def post_render(self, frame):
+        self.post_render_count += 1
+
+
+class TestMasterRenderer(unittest.TestCase):
+    """
+    Delivery of renderer controller and tile callback events to Python.
+    """
+
+    def setUp(self):
+        self.project = asr.Project("project")
+        self.project.add_default_configurations()
+
+        scene = asr.Scene()
+        scene.cameras().insert(
+            asr.Camera("pinhole_camera", "camera", {'film_dimensions': asr.Vector2f(0.025, 0.025),
+                                                    'focal_length': 0.035}))
+        self.project.set_scene(scene)
+
+        self.project.set_frame(
+            asr.Frame("beauty", {'camera': 'camera',
+                                 'resolution': asr.Vector2i(32, 32),
+                                 'tile_size': asr.Vector2i(8, 8)}))
+
+        self.params = self.project.configurations()['final'].get_inherited_parameters()
+
+    def render(self, controller, tile_callback, dispatch_events):
+        renderer = asr.MasterRenderer(self.project, self.params, controller, tile_callback)
+        return renderer.render(dispatch_events)
+
+    def check_events(self, events):
+        # Progress events must occur between the frame begin and end events.
+        self.assertEqual(events[:2], ["rendering_begin", "frame_begin"])
+        self.assertEqual(events[-2:], ["frame_end", "rendering_success"])
+        self.assertEqual(set(events[2:-2]) - set(["progress"]), set())
+
+    def test_render_without_dispatching_delivers_events_in_order(self):
+        controller = RecordingRendererController()
+        tile_callback = RecordingTileCallback()
+
+        self.assertTrue(self.render(controller, tile_callback, False))
+        self.check_events(controller.events)
+
+    def test_render_with_dispatching_delivers_events_in_order(self):
+        controller = RecordingRendererController()
+        tile_callback = RecordingTileCallback()
+
+        self.assertTrue(self.render(controller, tile_callback, True))
+        self.check_events(controller.events)
+
+    def test_render_with_dispatching_delivers_every_tile(self):
+        direct_tile_callback = RecordingTileCallback()
+        self.render(RecordingRendererController(), direct_tile_callback, False)
+
+        dispatched_tile_callback = RecordingTileCallback()
+        self.render(RecordingRendererController(), dispatched_tile_callback, True)
+
+        tile_count = self.project.get_frame().image().properties().tile_count
+        self.assertEqual(len(direct_tile_callback.tiles), tile_count)
+        self.assertEqual(sorted(dispatched_tile_callback.tiles), sorted(direct_tile_callback.tiles))
+        self.assertEqual(dispatched_tile_callback.post_render_count, direct_tile_callback.post_render_count)
+
+    def test_render_with_dispatching_picks_up_status_changes(self):
+        # The status is cached by the dispatcher; it must be refreshed once the controller changes it.
+        controller = RecordingRendererController(abort_on_frame_begin=True)
+        tile_callback = RecordingTileCallback()
+
+        self.assertFalse(self.render(controller, tile_callback, True))
+        self.assertEqual(controller.events[-1], "rendering_abort")
+        self.assertNotIn("rendering_success", controller.events)
+
+    def test_render_with_dispatching_can_be_repeated(self):
+        controller = RecordingRendererController()
+        tile_callback = RecordingTileCallback()
+        renderer = asr.MasterRenderer(self.project, self.params, controller, tile_callback)
+
+        self.assertTrue(renderer.render(True))
+        self.assertTrue(renderer.render(True))
+        self.assertEqual(controller.events.count("rendering_success"), 2)
+
+if __name__ == "__main__":
+    unittest.main()
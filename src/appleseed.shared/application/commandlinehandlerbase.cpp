@@ -174,6 +174,9 @@ void CommandLineHandlerBase::apply(SuperLogger& logger)
     if (impl->m_system.is_set())
         System::print_information(logger);
 
+    if (!System::check_instruction_sets(logger))
+        LOG_FATAL(logger, "this binary was built for a more recent CPU, please use a build targeting older instruction sets.");
+
     if (impl->m_display_options.is_set())
     {
         LOG_INFO(logger, "recognized options:");
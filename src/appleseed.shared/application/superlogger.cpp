@@ -50,12 +50,15 @@ namespace shared {
 
 SuperLogger::SuperLogger()
   : m_log_target(0)
+  , m_async_log_target(0)
 {
     set_log_target(create_open_file_log_target(stderr));
 }
 
 SuperLogger::~SuperLogger()
 {
+    // Deleting the asynchronous log target writes pending messages to the current one.
+    delete m_async_log_target;
     delete m_log_target;
 }
 
@@ -66,14 +69,18 @@ ILogTarget& SuperLogger::get_log_target() const
 
 void SuperLogger::set_log_target(ILogTarget* log_target)
 {
+    const bool async = m_async_log_target != 0;
+
     if (m_log_target)
     {
-        remove_target(m_log_target);
+        remove_target(get_registered_target());
+        delete m_async_log_target;
         delete m_log_target;
     }
 
     m_log_target = log_target;
-    add_target(m_log_target);
+    m_async_log_target = async ? create_async_log_target(*m_log_target) : 0;
+    add_target(get_registered_target());
 }
 
 void SuperLogger::enable_message_coloring()
@@ -87,6 +94,16 @@ void SuperLogger::enable_message_coloring()
     set_log_target(create_console_log_target(stderr));
 }
 
+void SuperLogger::enable_async_logging()
+{
+    if (m_async_log_target)
+        return;
+
+    remove_target(m_log_target);
+    m_async_log_target = create_async_log_target(*m_log_target);
+    add_target(m_async_log_target);
+}
+
 void SuperLogger::set_verbosity_level_from_string(const char* level_name)
 {
     const LogMessage::Category level = LogMessage::get_category_value(level_name);
@@ -116,5 +133,12 @@ void SuperLogger::configure_from_settings(const Dictionary& settings)
         set_verbosity_level_from_string(settings.get("message_verbosity"));
 }
 
+ILogTarget* SuperLogger::get_registered_target() const
+{
+    return m_async_log_target
+        ? static_cast<ILogTarget*>(m_async_log_target)
+        : m_log_target;
+}
+
 }   // namespace shared
 }   // namespace appleseed
@@ -61,6 +61,9 @@ class SHAREDDLL SuperLogger
     // Replace the current log target by one that supports message coloring.
     void enable_message_coloring();
 
+    // Forward messages to the current log target from a dedicated writer thread.
+    void enable_async_logging();
+
     // Set the verbosity level.
     void set_verbosity_level_from_string(const char* level_name);
 
@@ -68,7 +71,10 @@ class SHAREDDLL SuperLogger
     void configure_from_settings(const foundation::Dictionary& settings);
 
   private:
-    foundation::ILogTarget* m_log_target;
+    foundation::ILogTarget*     m_log_target;
+    foundation::AsyncLogTarget* m_async_log_target;
+
+    foundation::ILogTarget* get_registered_target() const;
 };
 
 }       // namespace shared
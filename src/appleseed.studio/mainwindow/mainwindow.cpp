@@ -62,10 +62,12 @@
 #include "foundation/platform/system.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/log/logmessage.h"
 #include "foundation/utility/path.h"
 #include "foundation/utility/settings.h"
+#include "foundation/utility/string.h"
 
 // Qt headers.
 #include <QAction>
@@ -284,6 +286,8 @@ void MainWindow::build_menus()
 
     connect(m_ui->action_debug_tests, SIGNAL(triggered()), SLOT(slot_show_test_window()));
     connect(m_ui->action_debug_benchmarks, SIGNAL(triggered()), SLOT(slot_show_benchmark_window()));
+    connect(m_ui->action_debug_record_event_trace, SIGNAL(toggled(bool)), SLOT(slot_toggle_event_trace_recording(const bool)));
+    connect(m_ui->action_debug_export_event_trace, SIGNAL(triggered()), SLOT(slot_export_event_trace()));
 
     //
     // Tools menu.
@@ -1675,6 +1679,59 @@ void MainWindow::slot_fullscreen()
         (*button)->set_fullscreen(m_fullscreen);
 }
 
+void MainWindow::slot_toggle_event_trace_recording(const bool checked)
+{
+    EventTracer& tracer = global_event_tracer();
+
+    if (checked)
+    {
+        // Events can only be removed while no thread is recording them.
+        if (!m_rendering_manager.is_rendering())
+            tracer.clear();
+
+        tracer.set_enabled(true);
+
+        RENDERER_LOG_INFO("event trace recording is now enabled.");
+    }
+    else
+    {
+        tracer.set_enabled(false);
+
+        RENDERER_LOG_INFO("event trace recording is now disabled.");
+    }
+}
+
+void MainWindow::slot_export_event_trace()
+{
+    QString filepath =
+        get_save_filename(
+            this,
+            "Export Event Trace...",
+            "Chrome Trace Files (*.json)",
+            m_settings,
+            SETTINGS_FILE_DIALOG_PROJECTS);
+
+    if (filepath.isEmpty())
+        return;
+
+    if (QFileInfo(filepath).suffix().isEmpty())
+        filepath += ".json";
+
+    filepath = QDir::toNativeSeparators(filepath);
+
+    const EventTracer& tracer = global_event_tracer();
+
+    if (tracer.write_chrome_trace(filepath.toAscii().constData()))
+    {
+        RENDERER_LOG_INFO(
+            "wrote %s %s to %s.",
+            pretty_uint(tracer.get_event_count()).c_str(),
+            plural(tracer.get_event_count(), "trace event").c_str(),
+            filepath.toAscii().constData());
+    }
+    else RENDERER_LOG_ERROR("failed to write event trace to %s.", filepath.toAscii().constData());
+}
+
 void MainWindow::slot_show_rendering_settings_window()
 {
     assert(m_project_manager.is_project_open());
@@ -250,6 +250,10 @@ class MainWindow
     // General UI actions.
     void slot_fullscreen();
 
+    // Event tracing.
+    void slot_toggle_event_trace_recording(const bool checked);
+    void slot_export_event_trace();
+
     // Child windows.
     void slot_show_rendering_settings_window();
     void slot_show_test_window();
@@ -65,7 +65,7 @@ FrozenDisplayRenderer::FrozenDisplayRenderer(
   , m_frame_props(frame.image().properties())
   , m_color_image(frame.image())
   , m_depth_image(frame.aov_images().get_image(frame.aov_images().get_index("depth")))
-  , m_temp_image(m_frame_props.m_pixel_count * 4)
+  , m_temp_image(m_frame_props.m_pixel_count * 5)
   , m_camera_transform(camera.transform_sequence().get_earliest_transform())
   , m_points(m_frame_props.m_pixel_count)
 {
@@ -126,6 +126,9 @@ void FrozenDisplayRenderer::capture()
             }
         }
     }
+
+    // Pixels without depth don't produce any point.
+    m_points.resize(point_index);
 }
 
 void FrozenDisplayRenderer::set_camera_transform(const Transformd& transform)
@@ -146,13 +149,15 @@ void FrozenDisplayRenderer::render()
     // Retrieve pointer to temporary image pixels.
     float* temp_pixels = &m_temp_image[0];
 
-    // Clear temporary image.
-    for (size_t i = 0; i < m_frame_props.m_pixel_count * 4; i += 4)
+    // Clear temporary image. The fourth channel is the Z-buffer, the fifth one
+    // is the distance to the camera, or -1 where no point was reprojected.
+    for (size_t i = 0; i < m_frame_props.m_pixel_count * 5; i += 5)
     {
         temp_pixels[i + 0] = 0.0f;
         temp_pixels[i + 1] = 0.0f;
         temp_pixels[i + 2] = 0.0f;
         temp_pixels[i + 3] = -numeric_limits<float>::max();
+        temp_pixels[i + 4] = -1.0f;
     }
 
     const size_t point_count = m_points.size();
@@ -179,7 +184,7 @@ void FrozenDisplayRenderer::render()
             iy >= m_frame_props.m_canvas_height)
             continue;
 
-        const size_t pixel_index = (iy * m_frame_props.m_canvas_width + ix) * 4;
+        const size_t pixel_index = (iy * m_frame_props.m_canvas_width + ix) * 5;
 
         // Check point depth against Z-buffer.
         if (point_camera.z <= temp_pixels[pixel_index + 3])
@@ -190,14 +195,17 @@ void FrozenDisplayRenderer::render()
         temp_pixels[pixel_index + 1] = point.m_color[1];
         temp_pixels[pixel_index + 2] = point.m_color[2];
         temp_pixels[pixel_index + 3] = point_camera.z;
+        temp_pixels[pixel_index + 4] = norm(point_camera);
     }
 
-    // Copy the temporary image to the frame.
+    // Copy the temporary image to the frame. The depth AOV marks the pixels that
+    // were disoccluded so that the frame can serve as a preview of the next render.
     for (size_t ty = 0; ty < m_frame_props.m_tile_count_y; ++ty)
     {
         for (size_t tx = 0; tx < m_frame_props.m_tile_count_x; ++tx)
         {
             Tile& color_tile = m_color_image.tile(tx, ty);
+            Tile& depth_tile = m_depth_image.tile(tx, ty);
             const size_t tile_width = color_tile.get_width();
             const size_t tile_height = color_tile.get_height();
 
@@ -211,9 +219,11 @@ void FrozenDisplayRenderer::render()
                     assert(ix < m_frame_props.m_canvas_width);
                     assert(iy < m_frame_props.m_canvas_height);
 
-                    const size_t pixel_index = (iy * m_frame_props.m_canvas_width + ix) * 4;
+                    const size_t pixel_index = (iy * m_frame_props.m_canvas_width + ix) * 5;
+
+                    depth_tile.set_component(px, py, 0, temp_pixels[pixel_index + 4]);
 
-                    // The third channel becomes an alpha channel.
+                    // The fourth channel becomes an alpha channel.
                     temp_pixels[pixel_index + 3] = 1.0f;
 
                     color_tile.set_pixel<float>(px, py, temp_pixels + pixel_index);
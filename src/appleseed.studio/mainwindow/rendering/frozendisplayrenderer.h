@@ -65,7 +65,8 @@ class FrozenDisplayRenderer
     void set_camera_transform(
         const foundation::Transformd&           transform);
 
-    // Render the point cloud to the frame.
+    // Render the point cloud to the frame. The depth AOV is negative
+    // for pixels where no point was reprojected.
     void render();
 
   private:
@@ -0,0 +1,103 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "performanceoverlay.h"
+
+// appleseed.studio headers.
+#include "mainwindow/rendering/performancetracker.h"
+
+// Qt headers.
+#include <QHideEvent>
+#include <QShowEvent>
+#include <QString>
+#include <Qt>
+#include <QTimer>
+#include <QWidget>
+
+namespace appleseed {
+namespace studio {
+
+//
+// PerformanceOverlay class implementation.
+//
+
+namespace
+{
+    const int RefreshInterval = 250;    // in milliseconds
+}
+
+PerformanceOverlay::PerformanceOverlay(QWidget* parent)
+  : QLabel(parent)
+  , m_tracker(0)
+{
+    setObjectName("performance_overlay");
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setTextFormat(Qt::PlainText);
+    setAlignment(Qt::AlignLeft | Qt::AlignTop);
+
+    m_timer = new QTimer(this);
+    m_timer->setInterval(RefreshInterval);
+    connect(m_timer, SIGNAL(timeout()), SLOT(slot_refresh()));
+}
+
+void PerformanceOverlay::set_tracker(const PerformanceTracker* tracker)
+{
+    m_tracker = tracker;
+    slot_refresh();
+}
+
+void PerformanceOverlay::showEvent(QShowEvent* event)
+{
+    slot_refresh();
+    m_timer->start();
+    QLabel::showEvent(event);
+}
+
+void PerformanceOverlay::hideEvent(QHideEvent* event)
+{
+    m_timer->stop();
+    QLabel::hideEvent(event);
+}
+
+void PerformanceOverlay::slot_refresh()
+{
+    if (!isVisible())
+        return;
+
+    setText(
+        m_tracker
+            ? QString::fromStdString(m_tracker->get_report())
+            : QString("No rendering in progress."));
+    adjustSize();
+}
+
+}   // namespace studio
+}   // namespace appleseed
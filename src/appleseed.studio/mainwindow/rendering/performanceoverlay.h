@@ -0,0 +1,82 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_STUDIO_MAINWINDOW_RENDERING_PERFORMANCEOVERLAY_H
+#define APPLESEED_STUDIO_MAINWINDOW_RENDERING_PERFORMANCEOVERLAY_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+
+// Qt headers.
+#include <QLabel>
+#include <QObject>
+
+// Forward declarations.
+namespace appleseed { namespace studio { class PerformanceTracker; } }
+class QHideEvent;
+class QShowEvent;
+class QTimer;
+class QWidget;
+
+namespace appleseed {
+namespace studio {
+
+//
+// A label drawn on top of the render widget that periodically displays
+// the report of a performance tracker while it is visible.
+//
+
+class PerformanceOverlay
+  : public QLabel
+{
+    Q_OBJECT
+
+  public:
+    explicit PerformanceOverlay(QWidget* parent = 0);
+
+    // Set the tracker whose report is displayed, or 0 to display nothing.
+    void set_tracker(const PerformanceTracker* tracker);
+
+  protected:
+    virtual void showEvent(QShowEvent* event) APPLESEED_OVERRIDE;
+    virtual void hideEvent(QHideEvent* event) APPLESEED_OVERRIDE;
+
+  private slots:
+    void slot_refresh();
+
+  private:
+    const PerformanceTracker*   m_tracker;
+    QTimer*                     m_timer;
+};
+
+}       // namespace studio
+}       // namespace appleseed
+
+#endif  // !APPLESEED_STUDIO_MAINWINDOW_RENDERING_PERFORMANCEOVERLAY_H
@@ -0,0 +1,147 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "performancetracker.h"
+
+// appleseed.renderer headers.
+#include "renderer/utility/startupprofiler.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+#include "foundation/utility/memoryaccounting.h"
+#include "foundation/utility/statistics.h"
+
+// Standard headers.
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+namespace appleseed {
+namespace studio {
+
+//
+// PerformanceTracker class implementation.
+//
+
+PerformanceTracker::PerformanceTracker()
+  : m_frame_timer(0)
+{
+    on_frame_begin();
+}
+
+void PerformanceTracker::release()
+{
+}
+
+void PerformanceTracker::on_frame_begin()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    m_frame_timer.start();
+    m_first_display_time = -1.0;
+    m_display_time = 0.0;
+    m_display_count = 0;
+    m_has_telemetry = false;
+}
+
+void PerformanceTracker::on_display(const double seconds)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (m_first_display_time < 0.0)
+        m_first_display_time = m_frame_timer.measure().get_seconds();
+
+    m_display_time += seconds;
+    ++m_display_count;
+}
+
+void PerformanceTracker::on_telemetry(const RenderTelemetry& telemetry)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    m_telemetry = telemetry;
+    m_has_telemetry = true;
+}
+
+string PerformanceTracker::get_report() const
+{
+    StatisticsVector stats;
+
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        Statistics frame_stats;
+        frame_stats.insert_time("frame time", m_frame_timer.measure().get_seconds());
+
+        if (m_first_display_time >= 0.0)
+            frame_stats.insert_time("first update", m_first_display_time);
+        else frame_stats.insert("first update", "pending");
+
+        frame_stats.insert<uint64>("display updates", m_display_count);
+        frame_stats.insert_time("display time", m_display_time);
+
+        if (m_has_telemetry)
+        {
+            if (m_telemetry.m_progress >= 0.0)
+                frame_stats.insert_percent("progress", m_telemetry.m_progress, 1.0);
+            frame_stats.insert("samples/s", m_telemetry.m_samples_per_second);
+            frame_stats.insert("rays/s", m_telemetry.m_rays_per_second);
+            frame_stats.insert_percent(
+                "texture hit rate",
+                m_telemetry.m_texture_cache_hit_count,
+                m_telemetry.m_texture_cache_hit_count + m_telemetry.m_texture_cache_miss_count);
+        }
+
+        stats.insert("frame", frame_stats);
+    }
+
+    // Stage timings of the last restart.
+    stats.merge(global_startup_profiler().get_statistics());
+
+    // Current memory usage of the subsystems that use memory.
+    Statistics memory_stats;
+    memory_stats.insert_size("total", get_total_accounted_memory_size());
+    for (size_t i = 0; i < MemoryTagCount; ++i)
+    {
+        const MemoryTag tag = static_cast<MemoryTag>(i);
+        const size_t size = get_accounted_memory_size(tag);
+        if (size > 0)
+            memory_stats.insert_size(string("  ") + get_memory_tag_name(tag), size);
+    }
+    stats.insert("memory", memory_stats);
+
+    return stats.to_string(20);
+}
+
+}   // namespace studio
+}   // namespace appleseed
@@ -0,0 +1,95 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_STUDIO_MAINWINDOW_RENDERING_PERFORMANCETRACKER_H
+#define APPLESEED_STUDIO_MAINWINDOW_RENDERING_PERFORMANCETRACKER_H
+
+// appleseed.studio headers.
+#include "mainwindow/rendering/renderingtimer.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/rendering.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/thread.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+namespace appleseed {
+namespace studio {
+
+//
+// Gathers the performance measurements shown in the performance overlay of the render tab:
+// how long the last restart took in each stage, how long it took to display the first
+// update of the frame, the display overhead, the renderer throughput and memory usage.
+//
+// Stage timings come from the startup profiler and throughput from the telemetry of
+// the master renderer, i.e. from the same instrumentation as appleseed.cli.
+//
+
+class PerformanceTracker
+  : public renderer::ITelemetryCallback
+{
+  public:
+    // Constructor.
+    PerformanceTracker();
+
+    // The tracker is owned by the rendering manager: this method does nothing.
+    virtual void release() APPLESEED_OVERRIDE;
+
+    // Call this method when the renderer starts or restarts rendering a frame.
+    void on_frame_begin();
+
+    // Call this method after a tile or the whole frame was displayed. Thread-safe.
+    void on_display(const double seconds);
+
+    // Receive the telemetry of the master renderer. Thread-safe.
+    virtual void on_telemetry(const renderer::RenderTelemetry& telemetry) APPLESEED_OVERRIDE;
+
+    // Return a textual report of the latest measurements. Thread-safe.
+    std::string get_report() const;
+
+  private:
+    mutable boost::mutex                    m_mutex;
+    mutable RenderingTimer                  m_frame_timer;
+    double                                  m_first_display_time;   // negative until the first display
+    double                                  m_display_time;         // time spent displaying the frame
+    size_t                                  m_display_count;
+    bool                                    m_has_telemetry;
+    renderer::RenderTelemetry               m_telemetry;
+};
+
+}       // namespace studio
+}       // namespace appleseed
+
+#endif  // !APPLESEED_STUDIO_MAINWINDOW_RENDERING_PERFORMANCETRACKER_H
@@ -37,6 +37,7 @@
 // appleseed.renderer headers.
 #include "renderer/api/frame.h"
 #include "renderer/api/project.h"
+#include "renderer/api/rendering.h"
 #include "renderer/api/scene.h"
 
 // appleseed.foundation headers.
@@ -113,14 +114,13 @@ void PixelInspectorHandler::show_tooltip()
         const Vector2d pix(m_mouse_tracker.widget_to_pixel(local_point));
         const Vector2d ndc(m_mouse_tracker.widget_to_ndc(local_point));
 
+        const size_t x = truncate<size_t>(pix.x);
+        const size_t y = truncate<size_t>(pix.y);
+
         Color4f linear_rgba;
-        m_project.get_frame()->image().get_pixel(
-            truncate<size_t>(pix.x),
-            truncate<size_t>(pix.y),
-            linear_rgba);
+        m_project.get_frame()->image().get_pixel(x, y, linear_rgba);
 
-        QToolTip::showText(
-            global_point,
+        QString text =
             QString(
                 "Pixel:\n"
                 "  X: %1\n"
@@ -141,7 +141,30 @@ void PixelInspectorHandler::show_tooltip()
                 QString::number(linear_rgba.r, 'f', 3),
                 QString::number(linear_rgba.g, 'f', 3),
                 QString::number(linear_rgba.b, 'f', 3),
-                QString::number(linear_rgba.a, 'f', 3)));
+                QString::number(linear_rgba.a, 'f', 3));
+
+        // Per-pixel sample statistics are only available during progressive rendering.
+        const PixelStatistics* pixel_stats = m_project.get_frame()->get_pixel_statistics();
+        if (pixel_stats != 0 && pixel_stats->get(x, y).m_sample_count > 0)
+        {
+            const PixelStatistics::Entry& entry = pixel_stats->get(x, y);
+
+            text +=
+                QString(
+                    "\n\n"
+                    "Samples:\n"
+                    "  Count: %1\n"
+                    "  Mean Luminance: %2\n"
+                    "  Variance: %3\n"
+                    "  Max Luminance: %4")
+                .arg(
+                    QString::number(entry.m_sample_count),
+                    QString::number(entry.get_mean(), 'f', 3),
+                    QString::number(entry.get_variance(), 'f', 3),
+                    QString::number(entry.m_max, 'f', 3));
+        }
+
+        QToolTip::showText(global_point, text);
     }
 }
 
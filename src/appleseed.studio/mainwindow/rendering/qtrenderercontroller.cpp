@@ -65,7 +65,9 @@ void QtRendererController::on_frame_begin()
 {
     const Status status = get_status();
 
-    if (status == RestartRendering || status == ReinitializeRendering)
+    if (status == RestartRendering ||
+        status == ReinitializeRendering ||
+        status == RestartRenderingAfterCameraChange)
         set_status(ContinueRendering);
 
     emit signal_frame_begin();
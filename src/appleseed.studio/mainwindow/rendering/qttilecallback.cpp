@@ -31,8 +31,13 @@
 #include "qttilecallback.h"
 
 // appleseed.studio headers.
+#include "mainwindow/rendering/performancetracker.h"
 #include "mainwindow/rendering/renderwidget.h"
 
+// appleseed.foundation headers.
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/utility/stopwatch.h"
+
 // Qt headers.
 #include <QObject>
 #include <Qt>
@@ -59,8 +64,11 @@ namespace
         Q_OBJECT
 
       public:
-        explicit QtTileCallback(RenderWidget* render_widget)
+        QtTileCallback(
+            RenderWidget*           render_widget,
+            PerformanceTracker*     performance_tracker)
           : m_render_widget(render_widget)
+          , m_performance_tracker(performance_tracker)
         {
             connect(
                 this, SIGNAL(signal_update()),
@@ -90,23 +98,35 @@ namespace
             const size_t    tile_y) APPLESEED_OVERRIDE
         {
             assert(m_render_widget);
+            m_stopwatch.start();
             m_render_widget->blit_tile(*frame, tile_x, tile_y);
             emit signal_update();
+            report_display();
         }
 
         virtual void post_render(
             const Frame*    frame) APPLESEED_OVERRIDE
         {
             assert(m_render_widget);
+            m_stopwatch.start();
             m_render_widget->blit_frame(*frame);
             emit signal_update();
+            report_display();
         }
 
       signals:
         void signal_update();
 
       private:
-        RenderWidget* m_render_widget;
+        RenderWidget*                           m_render_widget;
+        PerformanceTracker*                     m_performance_tracker;
+        Stopwatch<DefaultWallclockTimer>        m_stopwatch;
+
+        void report_display()
+        {
+            if (m_performance_tracker)
+                m_performance_tracker->on_display(m_stopwatch.measure().get_seconds());
+        }
     };
 }
 
@@ -115,8 +135,11 @@ namespace
 // QtTileCallbackFactory class implementation.
 //
 
-QtTileCallbackFactory::QtTileCallbackFactory(RenderWidget* render_widget)
+QtTileCallbackFactory::QtTileCallbackFactory(
+    RenderWidget*           render_widget,
+    PerformanceTracker*     performance_tracker)
   : m_render_widget(render_widget)
+  , m_performance_tracker(performance_tracker)
 {
 }
 
@@ -127,7 +150,7 @@ void QtTileCallbackFactory::release()
 
 ITileCallback* QtTileCallbackFactory::create()
 {
-    return new QtTileCallback(m_render_widget);
+    return new QtTileCallback(m_render_widget, m_performance_tracker);
 }
 
 }   // namespace studio
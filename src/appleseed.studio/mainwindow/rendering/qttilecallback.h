@@ -37,6 +37,7 @@
 #include "foundation/platform/compiler.h"
 
 // Forward declarations.
+namespace appleseed { namespace studio { class PerformanceTracker; } }
 namespace appleseed { namespace studio { class RenderWidget; } }
 
 namespace appleseed {
@@ -46,8 +47,10 @@ class QtTileCallbackFactory
   : public renderer::ITileCallbackFactory
 {
   public:
-    // Constructor.
-    explicit QtTileCallbackFactory(RenderWidget* render_widget);
+    // Constructor. If a performance tracker is provided, it is notified of every display update.
+    explicit QtTileCallbackFactory(
+        RenderWidget*           render_widget,
+        PerformanceTracker*     performance_tracker = 0);
 
     // Delete this instance.
     virtual void release() APPLESEED_OVERRIDE;
@@ -56,7 +59,8 @@ class QtTileCallbackFactory
     virtual renderer::ITileCallback* create() APPLESEED_OVERRIDE;
 
   private:
-    RenderWidget* m_render_widget;
+    RenderWidget*               m_render_widget;
+    PerformanceTracker*         m_performance_tracker;
 };
 
 }       // namespace studio
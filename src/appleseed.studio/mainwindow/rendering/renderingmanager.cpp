@@ -32,6 +32,7 @@
 
 // appleseed.studio headers.
 #include "mainwindow/rendering/cameracontroller.h"
+#include "mainwindow/rendering/performanceoverlay.h"
 #include "mainwindow/rendering/rendertab.h"
 #include "mainwindow/rendering/renderwidget.h"
 #include "mainwindow/statusbar.h"
@@ -169,9 +170,20 @@ void RenderingManager::start_rendering(
     m_params = params;
     m_render_tab = render_tab;
 
+    // Report telemetry often enough for the performance overlay to stay current.
+    if (!m_params.exist_path("telemetry_interval"))
+        m_params.insert("telemetry_interval", 0.5);
+
+    // Record the entities hit by primary rays so that picking doesn't need to trace rays.
+    m_project->get_frame()->enable_object_id_buffer();
+
+    // Accumulate per-pixel sample statistics for the pixel inspector.
+    m_project->get_frame()->enable_pixel_statistics();
+
     m_tile_callback_factory.reset(
         new QtTileCallbackFactory(
-            m_render_tab->get_render_widget()));
+            m_render_tab->get_render_widget(),
+            &m_performance_tracker));
 
     m_master_renderer.reset(
         new MasterRenderer(
@@ -180,6 +192,9 @@ void RenderingManager::start_rendering(
             &m_renderer_controller,
             m_tile_callback_factory.get()));
 
+    m_master_renderer->set_telemetry_callback(&m_performance_tracker);
+    m_render_tab->get_performance_overlay()->set_tracker(&m_performance_tracker);
+
     m_master_renderer_thread.reset(
         new MasterRendererThread(m_master_renderer.get()));
 
@@ -213,6 +228,15 @@ void RenderingManager::restart_rendering()
     m_renderer_controller.set_status(IRendererController::RestartRendering);
 }
 
+void RenderingManager::restart_rendering_after_camera_change()
+{
+    // Don't turn a pending restart or reinitialization into a camera update.
+    const IRendererController::Status status = m_renderer_controller.get_status();
+    if (status != IRendererController::RestartRendering &&
+        status != IRendererController::ReinitializeRendering)
+        m_renderer_controller.set_status(IRendererController::RestartRenderingAfterCameraChange);
+}
+
 void RenderingManager::reinitialize_rendering()
 {
     m_renderer_controller.set_status(IRendererController::ReinitializeRendering);
@@ -385,6 +409,9 @@ void RenderingManager::slot_frame_begin()
         m_has_camera_changed = false;
     }
 
+    // Restart the measurements of the performance overlay.
+    m_performance_tracker.on_frame_begin();
+
     // Start printing rendering time in the status bar.
     m_status_bar.start_rendering_time_display(&m_rendering_timer);
     m_rendering_timer.start();
@@ -436,7 +463,7 @@ void RenderingManager::slot_camera_changed()
     }
     else
     {
-        restart_rendering();
+        restart_rendering_after_camera_change();
     }
 }
 
@@ -449,9 +476,10 @@ void RenderingManager::slot_camera_change_end()
         m_frozen_display_thread.reset();
         m_frozen_display_func.reset();
 
-        m_project->get_frame()->clear_main_image();
+        // Keep the reprojected frame as a preview for the first passes of the new render.
+        m_project->get_frame()->set_has_preview(true);
 
-        restart_rendering();
+        restart_rendering_after_camera_change();
     }
 }
 
@@ -32,6 +32,7 @@
 
 // appleseed.studio headers.
 #include "mainwindow/rendering/frozendisplayrenderer.h"
+#include "mainwindow/rendering/performancetracker.h"
 #include "mainwindow/rendering/qtrenderercontroller.h"
 #include "mainwindow/rendering/qttilecallback.h"
 #include "mainwindow/rendering/renderingtimer.h"
@@ -94,6 +95,7 @@ class RenderingManager
     // Send orders to the renderer via the renderer controller.
     void abort_rendering();
     void restart_rendering();
+    void restart_rendering_after_camera_change();
     void reinitialize_rendering();
     void pause_rendering();
     void resume_rendering();
@@ -164,6 +166,7 @@ class RenderingManager
     std::auto_ptr<QThread>                      m_master_renderer_thread;
 
     RenderingTimer                              m_rendering_timer;
+    PerformanceTracker                          m_performance_tracker;
 
     typedef std::vector<IScheduledAction*> ScheduledActionCollection;
     typedef std::map<std::string, IStickyAction*> StickyActionCollection;
@@ -32,6 +32,7 @@
 
 // appleseed.studio headers.
 #include "mainwindow/project/projectexplorer.h"
+#include "mainwindow/rendering/performanceoverlay.h"
 #include "mainwindow/rendering/renderwidget.h"
 #include "utility/miscellaneous.h"
 
@@ -130,6 +131,11 @@ CameraController* RenderTab::get_camera_controller() const
     return m_camera_controller.get();
 }
 
+PerformanceOverlay* RenderTab::get_performance_overlay() const
+{
+    return m_performance_overlay;
+}
+
 RenderTab::State RenderTab::save_state() const
 {
     State state;
@@ -168,6 +174,11 @@ void RenderTab::slot_toggle_pixel_inspector(const bool checked)
     m_pixel_inspector_handler->update_tooltip_visibility();
 }
 
+void RenderTab::slot_toggle_performance_overlay(const bool checked)
+{
+    m_performance_overlay->setVisible(checked);
+}
+
 void RenderTab::create_render_widget()
 {
     const CanvasProperties& props = m_project.get_frame()->image().properties();
@@ -270,6 +281,18 @@ void RenderTab::create_toolbar()
         SLOT(slot_toggle_pixel_inspector(const bool)));
     m_toolbar->addWidget(m_pixel_inspector_button);
 
+    // Create the Toggle Performance Overlay button in the render toolbar.
+    m_performance_overlay_button = new QToolButton();
+    m_performance_overlay_button->setIcon(load_icons("renderwidget_toggle_performance_overlay"));
+    m_performance_overlay_button->setToolTip("Toggle Performance Overlay");
+    m_performance_overlay_button->setShortcut(Qt::Key_P);
+    m_performance_overlay_button->setCheckable(true);
+    m_performance_overlay_button->setChecked(false);
+    connect(
+        m_performance_overlay_button, SIGNAL(toggled(bool)),
+        SLOT(slot_toggle_performance_overlay(const bool)));
+    m_toolbar->addWidget(m_performance_overlay_button);
+
     m_toolbar->addSeparator();
 
     // Create the label preceding the picking mode combobox.
@@ -334,6 +357,11 @@ void RenderTab::create_scrollarea()
     m_scroll_area->setObjectName(QString::fromUtf8("render_widget_scrollarea"));
     m_scroll_area->setAlignment(Qt::AlignCenter);
     m_scroll_area->setWidget(render_widget_wrapper);
+
+    // Create the performance overlay on top of the viewport so that it does not scroll with the render widget.
+    m_performance_overlay = new PerformanceOverlay(m_scroll_area->viewport());
+    m_performance_overlay->move(10, 10);
+    m_performance_overlay->hide();
 }
 
 void RenderTab::recreate_handlers()
@@ -53,6 +53,7 @@
 #include <memory>
 
 // Forward declarations.
+namespace appleseed { namespace studio { class PerformanceOverlay; } }
 namespace appleseed { namespace studio { class ProjectExplorer; } }
 namespace appleseed { namespace studio { class RenderWidget; } }
 namespace renderer  { class Entity; }
@@ -92,6 +93,7 @@ class RenderTab
 
     RenderWidget* get_render_widget() const;
     CameraController* get_camera_controller() const;
+    PerformanceOverlay* get_performance_overlay() const;
 
     struct State
     {
@@ -122,6 +124,7 @@ class RenderTab
     void slot_toggle_render_region(const bool checked);
     void slot_set_render_region(const QRect& rect);
     void slot_toggle_pixel_inspector(const bool checked);
+    void slot_toggle_performance_overlay(const bool checked);
 
   private:
     RenderWidget*                           m_render_widget;
@@ -133,6 +136,7 @@ class RenderTab
     QToolButton*                            m_clear_render_region_button;
     QToolButton*                            m_reset_zoom_button;
     QToolButton*                            m_pixel_inspector_button;
+    QToolButton*                            m_performance_overlay_button;
     QToolButton*                            m_clear_frame_button;
     QComboBox*                              m_picking_mode_combo;
     QWidget*                                m_spacer;
@@ -141,6 +145,7 @@ class RenderTab
     QLabel*                                 m_g_label;
     QLabel*                                 m_b_label;
     QLabel*                                 m_a_label;
+    PerformanceOverlay*                     m_performance_overlay;
 
     ProjectExplorer&                        m_project_explorer;
     renderer::Project&                      m_project;
@@ -37,6 +37,7 @@
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/image.h"
 #include "foundation/image/nativedrawing.h"
+#include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
 #include "foundation/math/scalar.h"
 #include "foundation/platform/types.h"
@@ -44,11 +45,13 @@
 // Qt headers.
 #include <QColor>
 #include <QMutexLocker>
+#include <QtConcurrentMap>
 #include <Qt>
 
 // Standard headers.
 #include <algorithm>
 #include <cassert>
+#include <vector>
 
 using namespace foundation;
 using namespace renderer;
@@ -227,19 +230,114 @@ void RenderWidget::blit_tile(
     blit_tile_no_lock(frame, tile_x, tile_y);
 }
 
+namespace
+{
+    void blit_tile_to_image(
+        QImage&         image,
+        const Frame&    frame,
+        const size_t    tile_x,
+        const size_t    tile_y,
+        Tile&           float_tile_storage,
+        Tile&           uint8_tile_storage)
+    {
+        // Retrieve the source tile.
+        const Tile& tile = frame.image().tile(tile_x, tile_y);
+
+        // Convert the tile to 32-bit floating point.
+        Tile fp_rgb_tile(
+            tile,
+            PixelFormatFloat,
+            float_tile_storage.get_storage());
+
+        // Transform the tile to the color space of the frame.
+        frame.transform_to_output_color_space(fp_rgb_tile);
+
+        // Convert the tile to 8-bit RGB for display.
+        static const size_t ShuffleTable[] = { 0, 1, 2, Pixel::SkipChannel };
+        const Tile uint8_rgb_tile(
+            fp_rgb_tile,
+            PixelFormatUInt8,
+            ShuffleTable,
+            uint8_tile_storage.get_storage());
+
+        // Retrieve destination image information.
+        APPLESEED_UNUSED const size_t image_width = static_cast<size_t>(image.width());
+        APPLESEED_UNUSED const size_t image_height = static_cast<size_t>(image.height());
+        const size_t dest_stride = static_cast<size_t>(image.bytesPerLine());
+
+        // Compute the coordinates of the first destination pixel.
+        const CanvasProperties& frame_props = frame.image().properties();
+        const size_t x = tile_x * frame_props.m_tile_width;
+        const size_t y = tile_y * frame_props.m_tile_height;
+
+        // Clipping is not supported.
+        assert(x < image_width);
+        assert(y < image_height);
+        assert(x + tile.get_width() <= image_width);
+        assert(y + tile.get_height() <= image_height);
+
+        // Get a pointer to the first destination pixel.
+        uint8* dest = get_image_pointer(image, x, y);
+
+        // Blit the tile to the destination image.
+        NativeDrawing::blit(dest, dest_stride, uint8_rgb_tile);
+    }
+
+    // Convert and blit one row of tiles. Rows of tiles cover disjoint regions
+    // of the destination image and can be processed concurrently.
+    class BlitTileRow
+    {
+      public:
+        typedef void result_type;
+
+        BlitTileRow(QImage& image, const Frame& frame)
+          : m_image(image)
+          , m_frame(frame)
+        {
+        }
+
+        void operator()(const size_t& tile_y) const
+        {
+            const CanvasProperties& frame_props = m_frame.image().properties();
+
+            Tile float_tile_storage(
+                frame_props.m_tile_width,
+                frame_props.m_tile_height,
+                frame_props.m_channel_count,
+                PixelFormatFloat);
+
+            Tile uint8_tile_storage(
+                frame_props.m_tile_width,
+                frame_props.m_tile_height,
+                frame_props.m_channel_count,
+                PixelFormatUInt8);
+
+            for (size_t x = 0; x < frame_props.m_tile_count_x; ++x)
+                blit_tile_to_image(m_image, m_frame, x, tile_y, float_tile_storage, uint8_tile_storage);
+        }
+
+      private:
+        QImage&         m_image;
+        const Frame&    m_frame;
+    };
+}
+
 void RenderWidget::blit_frame(const Frame& frame)
 {
     QMutexLocker locker(&m_mutex);
 
     const CanvasProperties& frame_props = frame.image().properties();
 
-    allocate_working_storage(frame_props);
+    // Make sure the image is detached before writing to it from multiple threads.
+    get_image_pointer(m_image);
 
+    // In progressive mode the whole frame is displayed on every refresh:
+    // spread the conversion over all cores instead of stalling the display thread.
+    vector<size_t> tile_rows(frame_props.m_tile_count_y);
     for (size_t y = 0; y < frame_props.m_tile_count_y; ++y)
-    {
-        for (size_t x = 0; x < frame_props.m_tile_count_x; ++x)
-            blit_tile_no_lock(frame, x, y);
-    }
+        tile_rows[y] = y;
+
+    QtConcurrent::blockingMap(tile_rows, BlitTileRow(m_image, frame));
 }
 
 namespace
@@ -281,47 +379,13 @@ void RenderWidget::blit_tile_no_lock(
     const size_t    tile_x,
     const size_t    tile_y)
 {
-    // Retrieve the source tile.
-    const Tile& tile = frame.image().tile(tile_x, tile_y);
-
-    // Convert the tile to 32-bit floating point.
-    Tile fp_rgb_tile(
-        tile,
-        PixelFormatFloat,
-        m_float_tile_storage->get_storage());
-
-    // Transform the tile to the color space of the frame.
-    frame.transform_to_output_color_space(fp_rgb_tile);
-
-    // Convert the tile to 8-bit RGB for display.
-    static const size_t ShuffleTable[] = { 0, 1, 2, Pixel::SkipChannel };
-    const Tile uint8_rgb_tile(
-        fp_rgb_tile,
-        PixelFormatUInt8,
-        ShuffleTable,
-        m_uint8_tile_storage->get_storage());
-
-    // Retrieve destination image information.
-    APPLESEED_UNUSED const size_t image_width = static_cast<size_t>(m_image.width());
-    APPLESEED_UNUSED const size_t image_height = static_cast<size_t>(m_image.height());
-    const size_t dest_stride = static_cast<size_t>(m_image.bytesPerLine());
-
-    // Compute the coordinates of the first destination pixel.
-    const CanvasProperties& frame_props = frame.image().properties();
-    const size_t x = tile_x * frame_props.m_tile_width;
-    const size_t y = tile_y * frame_props.m_tile_height;
-
-    // Clipping is not supported.
-    assert(x < image_width);
-    assert(y < image_height);
-    assert(x + tile.get_width() <= image_width);
-    assert(y + tile.get_height() <= image_height);
-
-    // Get a pointer to the first destination pixel.
-    uint8* dest = get_image_pointer(m_image, x, y);
-
-    // Blit the tile to the destination image.
-    NativeDrawing::blit(dest, dest_stride, uint8_rgb_tile);
+    blit_tile_to_image(
+        m_image,
+        frame,
+        tile_x,
+        tile_y,
+        *m_float_tile_storage,
+        *m_uint8_tile_storage);
 }
 
 void RenderWidget::paintEvent(QPaintEvent* event)
@@ -235,30 +235,41 @@ ItemBase* ScenePickingHandler::pick(const QPoint& point)
     const Vector2i pix = m_mouse_tracker.widget_to_pixel(point);
     const Vector2d ndc = m_mouse_tracker.widget_to_ndc(point);
 
+    // Use the entities recorded during the last rendering pass if they are still valid,
+    // and only trace a ray otherwise.
     const ScenePicker scene_picker(m_project);
-    const ScenePicker::PickingResult result = scene_picker.pick(ndc);
+    ScenePicker::PickingResult result;
+    const bool traced = !scene_picker.pick_entities(pix, result);
+    if (traced)
+        result = scene_picker.pick(ndc);
 
     stringstream sstr;
 
     sstr << "picking details:" << endl;
     sstr << "  pixel coords     " << pix << endl;
     sstr << "  ndc coords       " << ndc << endl;
-    sstr << "  primitive type   " << get_primitive_type_name(result.m_primitive_type) << endl;
-    sstr << "  distance         " << result.m_distance << endl;
-
-    sstr << "  bary             " << filter_neg_zero(result.m_bary) << endl;
-    sstr << "  uv               " << filter_neg_zero(result.m_uv) << endl;
-    sstr << "  duvdx            " << filter_neg_zero(result.m_duvdx) << endl;
-    sstr << "  duvdy            " << filter_neg_zero(result.m_duvdy) << endl;
-    sstr << "  point            " << filter_neg_zero(result.m_point) << endl;
-    sstr << "  dpdu             " << filter_neg_zero(result.m_dpdu) << endl;
-    sstr << "  dpdv             " << filter_neg_zero(result.m_dpdv) << endl;
-    sstr << "  dndu             " << filter_neg_zero(result.m_dndu) << endl;
-    sstr << "  dndv             " << filter_neg_zero(result.m_dndv) << endl;
-    sstr << "  dpdx             " << filter_neg_zero(result.m_dpdx) << endl;
-    sstr << "  dpdy             " << filter_neg_zero(result.m_dpdy) << endl;
-    sstr << "  geometric normal " << filter_neg_zero(result.m_geometric_normal) << endl;
-    sstr << "  shading normal   " << filter_neg_zero(result.m_original_shading_normal) << endl;
+
+    if (traced)
+    {
+        sstr << "  primitive type   " << get_primitive_type_name(result.m_primitive_type) << endl;
+        sstr << "  distance         " << result.m_distance << endl;
+
+        sstr << "  bary             " << filter_neg_zero(result.m_bary) << endl;
+        sstr << "  uv               " << filter_neg_zero(result.m_uv) << endl;
+        sstr << "  duvdx            " << filter_neg_zero(result.m_duvdx) << endl;
+        sstr << "  duvdy            " << filter_neg_zero(result.m_duvdy) << endl;
+        sstr << "  point            " << filter_neg_zero(result.m_point) << endl;
+        sstr << "  dpdu             " << filter_neg_zero(result.m_dpdu) << endl;
+        sstr << "  dpdv             " << filter_neg_zero(result.m_dpdv) << endl;
+        sstr << "  dndu             " << filter_neg_zero(result.m_dndu) << endl;
+        sstr << "  dndv             " << filter_neg_zero(result.m_dndv) << endl;
+        sstr << "  dpdx             " << filter_neg_zero(result.m_dpdx) << endl;
+        sstr << "  dpdy             " << filter_neg_zero(result.m_dpdy) << endl;
+        sstr << "  geometric normal " << filter_neg_zero(result.m_geometric_normal) << endl;
+        sstr << "  shading normal   " << filter_neg_zero(result.m_original_shading_normal) << endl;
+    }
+    else sstr << "  source           object id buffer" << endl;
+
     sstr << "  side             " << get_side_name(result.m_side) << endl;
 
     sstr << print_entity("  camera           ", result.m_camera) << endl;
@@ -1054,7 +1054,7 @@ namespace
 
             set_widget("rendering_threads.override", config.get_parameters().strings().exist("rendering_threads"));
 
-            const string default_rendering_threads = to_string(System::get_logical_cpu_core_count());
+            const string default_rendering_threads = to_string(System::get_available_cpu_core_count());
             const string rendering_threads = get_config<string>(config, "rendering_threads", "auto");
             set_widget("rendering_threads.value", rendering_threads == "auto" ? default_rendering_threads : rendering_threads);
             set_widget("rendering_threads.auto", rendering_threads == "auto");
@@ -1123,6 +1123,7 @@ namespace
             tile_ordering->addItem("Spiral", "spiral");
             tile_ordering->addItem("Hilbert", "hilbert");
             tile_ordering->addItem("Random", "random");
+            tile_ordering->addItem("Cost", "cost");
             groupbox->setLayout(create_form_layout("Tile Ordering:", tile_ordering));
         }
     };
@@ -48,70 +48,56 @@ using namespace std;
 namespace foundation
 {
 
-namespace
+void accumulate_luminance(
+    const Tile&     tile,
+    double&         accumulated_luminance,
+    size_t&         relevant_pixel_count)
 {
-    void accumulate_luminance(
-        const Tile&     tile,
-        double&         accumulated_luminance,
-        size_t&         relevant_pixel_count)
-    {
-        const size_t tile_width = tile.get_width();
-        const size_t tile_height = tile.get_height();
+    const size_t tile_width = tile.get_width();
+    const size_t tile_height = tile.get_height();
 
-        for (size_t y = 0; y < tile_height; ++y)
+    for (size_t y = 0; y < tile_height; ++y)
+    {
+        for (size_t x = 0; x < tile_width; ++x)
         {
-            for (size_t x = 0; x < tile_width; ++x)
-            {
-                // Fetch the pixel color; assume linear RGBA.
-                Color4f linear_rgba;
-                tile.get_pixel(x, y, linear_rgba);
+            // Fetch the pixel color; assume linear RGBA.
+            Color4f linear_rgba;
+            tile.get_pixel(x, y, linear_rgba);
 
-                // Extract the RGB part (ignore the alpha channel).
-                const Color3f linear_rgb = linear_rgba.rgb();
+            // Extract the RGB part (ignore the alpha channel).
+            const Color3f linear_rgb = linear_rgba.rgb();
 
-                // Skip pixels containing NaN values.
-                if (has_nan(linear_rgb))
-                    continue;
+            // Skip pixels containing NaN values.
+            if (has_nan(linear_rgb))
+                continue;
 
-                // Compute the Rec. 709 relative luminance of this pixel.
-                const float lum = luminance(clamp_low(linear_rgb, 0.0f));
+            // Compute the Rec. 709 relative luminance of this pixel.
+            const float lum = luminance(clamp_low(linear_rgb, 0.0f));
 
-                // It should no longer be possible to have NaN at this point.
-                assert(lum == lum);
+            // It should no longer be possible to have NaN at this point.
+            assert(lum == lum);
 
-                accumulated_luminance += static_cast<double>(lum);
-                ++relevant_pixel_count;
-            }
+            accumulated_luminance += static_cast<double>(lum);
+            ++relevant_pixel_count;
         }
     }
+}
 
-    void accumulate_luminance(
-        const Image&    image,
-        double&         accumulated_luminance,
-        size_t&         relevant_pixel_count)
-    {
-        accumulated_luminance = 0.0;
-        relevant_pixel_count = 0;
+double compute_average_luminance(const Image& image)
+{
+    double accumulated_luminance = 0.0;
+    size_t relevant_pixel_count = 0;
 
-        const CanvasProperties& props = image.properties();
+    const CanvasProperties& props = image.properties();
 
-        for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+    for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+    {
+        for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
         {
-            for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
-            {
-                const Tile& tile = image.tile(tx, ty);
-                accumulate_luminance(tile, accumulated_luminance, relevant_pixel_count);
-            }
+            const Tile& tile = image.tile(tx, ty);
+            accumulate_luminance(tile, accumulated_luminance, relevant_pixel_count);
         }
     }
-}
-
-double compute_average_luminance(const Image& image)
-{
-    double accumulated_luminance;
-    size_t relevant_pixel_count;
-
-    accumulate_luminance(image, accumulated_luminance, relevant_pixel_count);
 
     return relevant_pixel_count > 0
         ? accumulated_luminance / relevant_pixel_count
@@ -148,6 +134,26 @@ namespace
     }
 }
 
+double compute_square_deviation_sum(const Tile& tile1, const Tile& tile2)
+{
+    const size_t tile_width = tile1.get_width();
+    const size_t tile_height = tile1.get_height();
+
+    assert(tile2.get_width() == tile_width);
+    assert(tile2.get_height() == tile_height);
+
+    double sum = 0.0;
+
+    for (size_t i = 0; i < tile_width * tile_height; ++i)
+    {
+        const double sum1 = sum_pixel_components(tile1, i);
+        const double sum2 = sum_pixel_components(tile2, i);
+        sum += square(sum1 - sum2);
+    }
+
+    return sum;
+}
+
 double compute_rms_deviation(const Image& image1, const Image& image2)
 {
     if (!are_images_compatible(image1, image2))
@@ -160,22 +166,7 @@ double compute_rms_deviation(const Image& image1, const Image& image2)
     for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
     {
         for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
-        {
-            const Tile& tile1 = image1.tile(tx, ty);
-            const size_t tile_width = tile1.get_width();
-            const size_t tile_height = tile1.get_height();
-
-            const Tile& tile2 = image2.tile(tx, ty);
-            assert(tile2.get_width() == tile_width);
-            assert(tile2.get_height() == tile_height);
-
-            for (size_t i = 0; i < tile_width * tile_height; ++i)
-            {
-                const double sum1 = sum_pixel_components(tile1, i);
-                const double sum2 = sum_pixel_components(tile2, i);
-                mse += square(sum1 - sum2);
-            }
-        }
+            mse += compute_square_deviation_sum(image1.tile(tx, ty), image2.tile(tx, ty));
     }
 
     mse /= props.m_pixel_count * square(props.m_channel_count);
@@ -36,8 +36,12 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation    { class Image; }
+namespace foundation    { class Tile; }
 
 namespace foundation
 {
@@ -50,6 +54,14 @@ namespace foundation
 // Pixels containing NaN values are skipped.
 APPLESEED_DLLSYMBOL double compute_average_luminance(const Image& image);
 
+// Add the Rec. 709 relative luminance of the pixels of a linear RGB tile to a running
+// sum, and the number of these pixels to a running count. Pixels containing NaN values
+// are skipped. This is the building block of compute_average_luminance().
+APPLESEED_DLLSYMBOL void accumulate_luminance(
+    const Tile&     tile,
+    double&         accumulated_luminance,
+    size_t&         relevant_pixel_count);
+
 
 //
 // Image comparisons.
@@ -68,6 +80,10 @@ struct ExceptionIncompatibleImages
 // Throws a foundation::ExceptionIncompatibleImages exception if the images are not compatible.
 APPLESEED_DLLSYMBOL double compute_rms_deviation(const Image& image1, const Image& image2);
 
+// Compute the sum of the square deviations between the pixels of two tiles of the same
+// size. This is the building block of compute_rms_deviation().
+APPLESEED_DLLSYMBOL double compute_square_deviation_sum(const Tile& tile1, const Tile& tile2);
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_IMAGE_ANALYSIS_H
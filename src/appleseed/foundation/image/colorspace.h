@@ -243,6 +243,15 @@ Color<T, 3> ciexyz_to_linear_rgb(const Color<T, 3>& xyz);
 template <typename T>
 Color<T, 3> linear_rgb_to_ciexyz(const Color<T, 3>& linear_rgb);
 
+#ifdef APPLESEED_USE_SSE
+
+// Variants of the above functions operating on the first three components of a
+// SSE register. The fourth component of the result is zero.
+inline __m128 ciexyz_to_linear_rgb(const __m128 xyz);
+inline __m128 linear_rgb_to_ciexyz(const __m128 linear_rgb);
+
+#endif
+
 
 //
 // CIE XYZ <-> CIE xyY transformations.
@@ -290,6 +299,7 @@ float fast_linear_rgb_to_srgb(const float c);
 float fast_srgb_to_linear_rgb(const float c);
 #ifdef APPLESEED_USE_SSE
 inline __m128 fast_linear_rgb_to_srgb(const __m128 linear_rgb);
+inline __m128 fast_srgb_to_linear_rgb(const __m128 srgb);
 #endif
 Color3f fast_linear_rgb_to_srgb(const Color3f& linear_rgb);
 Color3f fast_srgb_to_linear_rgb(const Color3f& srgb);
@@ -299,6 +309,7 @@ float faster_linear_rgb_to_srgb(const float c);
 float faster_srgb_to_linear_rgb(const float c);
 #ifdef APPLESEED_USE_SSE
 inline __m128 faster_linear_rgb_to_srgb(const __m128 linear_rgb);
+inline __m128 faster_srgb_to_linear_rgb(const __m128 srgb);
 #endif
 Color3f faster_linear_rgb_to_srgb(const Color3f& linear_rgb);
 Color3f faster_srgb_to_linear_rgb(const Color3f& srgb);
@@ -611,6 +622,46 @@ inline Color<T, 3> linear_rgb_to_ciexyz(const Color<T, 3>& linear_rgb)
             T(0.0));
 }
 
+#ifdef APPLESEED_USE_SSE
+
+inline __m128 ciexyz_to_linear_rgb(const __m128 xyz)
+{
+    const __m128 x = _mm_shuffle_ps(xyz, xyz, _MM_SHUFFLE(0, 0, 0, 0));
+    const __m128 y = _mm_shuffle_ps(xyz, xyz, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128 z = _mm_shuffle_ps(xyz, xyz, _MM_SHUFFLE(2, 2, 2, 2));
+
+    const __m128 c0 = _mm_set_ps(0.0f,  0.055648f, -0.969256f,  3.240479f);
+    const __m128 c1 = _mm_set_ps(0.0f, -0.204043f,  1.875991f, -1.537150f);
+    const __m128 c2 = _mm_set_ps(0.0f,  1.057311f,  0.041556f, -0.498535f);
+
+    const __m128 linear_rgb =
+        _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(c0, x), _mm_mul_ps(c1, y)),
+            _mm_mul_ps(c2, z));
+
+    return _mm_max_ps(linear_rgb, _mm_setzero_ps());
+}
+
+inline __m128 linear_rgb_to_ciexyz(const __m128 linear_rgb)
+{
+    const __m128 r = _mm_shuffle_ps(linear_rgb, linear_rgb, _MM_SHUFFLE(0, 0, 0, 0));
+    const __m128 g = _mm_shuffle_ps(linear_rgb, linear_rgb, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128 b = _mm_shuffle_ps(linear_rgb, linear_rgb, _MM_SHUFFLE(2, 2, 2, 2));
+
+    const __m128 c0 = _mm_set_ps(0.0f, 0.019334f, 0.212671f, 0.412453f);
+    const __m128 c1 = _mm_set_ps(0.0f, 0.119193f, 0.715160f, 0.357580f);
+    const __m128 c2 = _mm_set_ps(0.0f, 0.950227f, 0.072169f, 0.180423f);
+
+    const __m128 xyz =
+        _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(c0, r), _mm_mul_ps(c1, g)),
+            _mm_mul_ps(c2, b));
+
+    return _mm_max_ps(xyz, _mm_setzero_ps());
+}
+
+#endif  // APPLESEED_USE_SSE
+
 
 //
 // CIE XYZ <-> CIE xyY transformations implementation.
@@ -714,6 +765,37 @@ inline Color3f fast_linear_rgb_to_srgb(const Color3f& linear_rgb)
     return Color3f(transfer[0], transfer[1], transfer[2]);
 }
 
+inline __m128 fast_srgb_to_linear_rgb(const __m128 srgb)
+{
+    // Apply 2.4 gamma correction.
+    const __m128 y =
+        fast_pow(
+            _mm_mul_ps(_mm_add_ps(srgb, _mm_set1_ps(0.055f)), _mm_set1_ps(1.0f / 1.055f)),
+            _mm_set1_ps(2.4f));
+
+    // Compute both outcomes of the branch.
+    const __m128 a = _mm_mul_ps(_mm_set1_ps(1.0f / 12.92f), srgb);
+
+    // Interleave them based on the comparison result.
+    const __m128 mask = _mm_cmple_ps(srgb, _mm_set1_ps(0.04045f));
+    return _mm_add_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, y));
+}
+
+inline Color3f fast_srgb_to_linear_rgb(const Color3f& srgb)
+{
+    APPLESEED_SIMD4_ALIGN float transfer[4] =
+    {
+        srgb[0],
+        srgb[1],
+        srgb[2],
+        srgb[2]
+    };
+
+    _mm_store_ps(transfer, fast_srgb_to_linear_rgb(_mm_load_ps(transfer)));
+
+    return Color3f(transfer[0], transfer[1], transfer[2]);
+}
+
 #else
 
 inline Color3f fast_linear_rgb_to_srgb(const Color3f& linear_rgb)
@@ -724,8 +806,6 @@ inline Color3f fast_linear_rgb_to_srgb(const Color3f& linear_rgb)
         fast_linear_rgb_to_srgb(linear_rgb[2]));
 }
 
-#endif  // APPLESEED_USE_SSE
-
 inline Color3f fast_srgb_to_linear_rgb(const Color3f& srgb)
 {
     return Color3f(
@@ -734,6 +814,8 @@ inline Color3f fast_srgb_to_linear_rgb(const Color3f& srgb)
         fast_srgb_to_linear_rgb(srgb[2]));
 }
 
+#endif  // APPLESEED_USE_SSE
+
 inline float faster_linear_rgb_to_srgb(const float c)
 {
     return c <= 0.0031308f
@@ -779,6 +861,37 @@ inline Color3f faster_linear_rgb_to_srgb(const Color3f& linear_rgb)
     return Color3f(transfer[0], transfer[1], transfer[2]);
 }
 
+inline __m128 faster_srgb_to_linear_rgb(const __m128 srgb)
+{
+    // Apply 2.4 gamma correction.
+    const __m128 y =
+        faster_pow(
+            _mm_mul_ps(_mm_add_ps(srgb, _mm_set1_ps(0.055f)), _mm_set1_ps(1.0f / 1.055f)),
+            _mm_set1_ps(2.4f));
+
+    // Compute both outcomes of the branch.
+    const __m128 a = _mm_mul_ps(_mm_set1_ps(1.0f / 12.92f), srgb);
+
+    // Interleave them based on the comparison result.
+    const __m128 mask = _mm_cmple_ps(srgb, _mm_set1_ps(0.04045f));
+    return _mm_add_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, y));
+}
+
+inline Color3f faster_srgb_to_linear_rgb(const Color3f& srgb)
+{
+    APPLESEED_SIMD4_ALIGN float transfer[4] =
+    {
+        srgb[0],
+        srgb[1],
+        srgb[2],
+        srgb[2]
+    };
+
+    _mm_store_ps(transfer, faster_srgb_to_linear_rgb(_mm_load_ps(transfer)));
+
+    return Color3f(transfer[0], transfer[1], transfer[2]);
+}
+
 #else
 
 inline Color3f faster_linear_rgb_to_srgb(const Color3f& linear_rgb)
@@ -789,8 +902,6 @@ inline Color3f faster_linear_rgb_to_srgb(const Color3f& linear_rgb)
         faster_linear_rgb_to_srgb(linear_rgb[2]));
 }
 
-#endif  // APPLESEED_USE_SSE
-
 inline Color3f faster_srgb_to_linear_rgb(const Color3f& srgb)
 {
     return Color3f(
@@ -799,6 +910,8 @@ inline Color3f faster_srgb_to_linear_rgb(const Color3f& srgb)
         faster_srgb_to_linear_rgb(srgb[2]));
 }
 
+#endif  // APPLESEED_USE_SSE
+
 
 //
 // Relative luminance function implementation.
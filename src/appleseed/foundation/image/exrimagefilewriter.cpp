@@ -56,6 +56,8 @@ END_EXR_INCLUDES
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <cstring>
+#include <vector>
 
 using namespace Iex;
 using namespace Imath;
@@ -123,39 +125,53 @@ void EXRImageFileWriter::write(
         // Create the output file.
         TiledOutputFile file(filename, header);
 
-        // Write tiles.
+        // Write tiles one row at a time: handing a whole row of tiles to OpenEXR lets
+        // its thread pool compress them in parallel. Tiles are stored separately in memory,
+        // so each row of tiles is first gathered into a contiguous buffer.
+        const size_t channel_size = Pixel::size(props.m_pixel_format);
+        const size_t stride_x     = channel_size * props.m_channel_count;
+        const size_t stride_y     = stride_x * props.m_canvas_width;
+        vector<char> row_buffer(stride_y * props.m_tile_height);
+
         for (size_t y = 0; y < props.m_tile_count_y; ++y)
         {
+            const int iy            = static_cast<int>(y);
+            const Box2i row_range   = file.dataWindowForTile(0, iy);
+
+            // Gather the tiles of this row.
             for (size_t x = 0; x < props.m_tile_count_x; ++x)
             {
-                const int ix              = static_cast<int>(x);
-                const int iy              = static_cast<int>(y);
-                const Box2i range         = file.dataWindowForTile(ix, iy);
-                const Tile& tile          = image.tile(x, y);
-                const size_t channel_size = Pixel::size(tile.get_pixel_format());
-                const size_t stride_x     = channel_size * props.m_channel_count;
-                const size_t stride_y     = stride_x * tile.get_width();
-                const size_t tile_origin  = range.min.x * stride_x + range.min.y * stride_y;
-                const char* tile_base     = reinterpret_cast<const char*>(tile.pixel(0, 0)) - tile_origin;
-
-                // Construct FrameBuffer object.
-                FrameBuffer framebuffer;
-                for (size_t c = 0; c < props.m_channel_count; ++c)
+                const Tile& tile = image.tile(x, y);
+                const size_t tile_row_size = stride_x * tile.get_width();
+                char* dest = &row_buffer[x * props.m_tile_width * stride_x];
+
+                for (size_t ty = 0; ty < tile.get_height(); ++ty)
                 {
-                    const char* base = tile_base + c * channel_size;
-                    framebuffer.insert(
-                        ChannelName[c],
-                        Slice(
-                            pixel_type,
-                            const_cast<char*>(base),
-                            stride_x,
-                            stride_y));
+                    memcpy(
+                        dest + ty * stride_y,
+                        tile.pixel(0, ty),
+                        tile_row_size);
                 }
+            }
 
-                // Write tile.
-                file.setFrameBuffer(framebuffer);
-                file.writeTile(ix, iy);
+            // Construct FrameBuffer object.
+            const char* row_base = &row_buffer[0] - row_range.min.y * stride_y;
+            FrameBuffer framebuffer;
+            for (size_t c = 0; c < props.m_channel_count; ++c)
+            {
+                const char* base = row_base + c * channel_size;
+                framebuffer.insert(
+                    ChannelName[c],
+                    Slice(
+                        pixel_type,
+                        const_cast<char*>(base),
+                        stride_x,
+                        stride_y));
             }
+
+            // Write the row of tiles.
+            file.setFrameBuffer(framebuffer);
+            file.writeTiles(0, static_cast<int>(props.m_tile_count_x) - 1, iy, iy);
         }
     }
     catch (const BaseExc& e)
@@ -61,7 +61,7 @@ namespace
         OpenEXRInitializer()
         {
             setGlobalThreadCount(
-                static_cast<int>(System::get_logical_cpu_core_count()));
+                static_cast<int>(System::get_available_cpu_core_count()));
         }
     };
 }
@@ -35,6 +35,10 @@
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/atomic.h"
+#include "foundation/platform/compiler.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
 
 using namespace std;
 
@@ -87,54 +91,144 @@ void FilteredTile::clear()
         ptr[i] = 0.0f;
 }
 
-void FilteredTile::add(
-    const float         x,
-    const float         y,
-    const float*        values)
+namespace
 {
-    // Convert (x, y) from continuous image space to discrete image space.
-    const float dx = x - 0.5f;
-    const float dy = y - 0.5f;
-
-    // Find the pixels affected by this sample.
-    AABB2i footprint;
-    footprint.min.x = truncate<int>(fast_ceil(dx - m_filter.get_xradius()));
-    footprint.min.y = truncate<int>(fast_ceil(dy - m_filter.get_yradius()));
-    footprint.max.x = truncate<int>(fast_floor(dx + m_filter.get_xradius()));
-    footprint.max.y = truncate<int>(fast_floor(dy + m_filter.get_yradius()));
-
-    // Don't affect pixels outside the crop window.
-    footprint = AABB2i::intersect(footprint, m_crop_window);
-
-    // Bail out if the point does not fall inside the crop window.
-    // Only check the x coordinate; the y coordinate is checked in the loop below.
-    if (footprint.min.x > footprint.max.x)
-        return;
-
-    for (int ry = footprint.min.y; ry <= footprint.max.y; ++ry)
+    // Maximum width or height, in pixels, of a filter footprint for which the
+    // weights of separable filters are computed once per row and once per column.
+    const size_t MaxSeparableFootprintSize = 64;
+
+    template <bool AtomicUpdates>
+    APPLESEED_FORCE_INLINE void accumulate(
+        float* APPLESEED_RESTRICT           ptr,
+        const float* APPLESEED_RESTRICT     values,
+        const size_t                        value_count,
+        const float                         weight)
     {
-        float* APPLESEED_RESTRICT ptr = reinterpret_cast<float*>(pixel(footprint.min.x, ry));
+        if (AtomicUpdates)
+        {
+            atomic_add(ptr, weight);
 
-        for (int rx = footprint.min.x; rx <= footprint.max.x; ++rx)
+            for (size_t i = 0; i < value_count; ++i)
+                atomic_add(ptr + 1 + i, values[i] * weight);
+        }
+        else
         {
-            const float weight = m_filter.evaluate(rx - dx, ry - dy);
+            ptr[0] += weight;
+            ++ptr;
 
-#ifdef ATOMIC_UPDATES
-            atomic_add(ptr++, weight);
-#else
-            *ptr++ += weight;
-#endif
+            size_t i = 0;
+
+#ifdef APPLESEED_USE_SSE
+            const __m128 mweight = _mm_set1_ps(weight);
 
-            for (size_t i = 0, e = m_channel_count - 1; i < e; ++i)
+            for (; i + 4 <= value_count; i += 4)
             {
-#ifdef ATOMIC_UPDATES
-                atomic_add(ptr++, values[i] * weight);
-#else
-                *ptr++ += values[i] * weight;
+                _mm_storeu_ps(
+                    ptr + i,
+                    _mm_add_ps(
+                        _mm_loadu_ps(ptr + i),
+                        _mm_mul_ps(_mm_loadu_ps(values + i), mweight)));
+            }
 #endif
+
+            for (; i < value_count; ++i)
+                ptr[i] += values[i] * weight;
+        }
+    }
+
+    template <bool AtomicUpdates>
+    void add_to_tile(
+        FilteredTile&   tile,
+        const float     x,
+        const float     y,
+        const float*    values)
+    {
+        const Filter2f& filter = tile.get_filter();
+        const size_t channel_count = tile.get_channel_count();
+        const size_t value_count = channel_count - 1;
+
+        // Convert (x, y) from continuous image space to discrete image space.
+        const float dx = x - 0.5f;
+        const float dy = y - 0.5f;
+
+        // Find the pixels affected by this sample.
+        AABB2i footprint;
+        footprint.min.x = truncate<int>(fast_ceil(dx - filter.get_xradius()));
+        footprint.min.y = truncate<int>(fast_ceil(dy - filter.get_yradius()));
+        footprint.max.x = truncate<int>(fast_floor(dx + filter.get_xradius()));
+        footprint.max.y = truncate<int>(fast_floor(dy + filter.get_yradius()));
+
+        // Don't affect pixels outside the crop window.
+        footprint = AABB2i::intersect(footprint, tile.get_crop_window());
+
+        // Bail out if the point does not fall inside the crop window.
+        if (footprint.min.x > footprint.max.x || footprint.min.y > footprint.max.y)
+            return;
+
+        const size_t footprint_width = static_cast<size_t>(footprint.max.x - footprint.min.x + 1);
+        const size_t footprint_height = static_cast<size_t>(footprint.max.y - footprint.min.y + 1);
+
+        if (filter.is_separable() &&
+            footprint_width <= MaxSeparableFootprintSize &&
+            footprint_height <= MaxSeparableFootprintSize)
+        {
+            // Evaluate the filter once per column and once per row of the footprint
+            // instead of once per pixel.
+            float wx[MaxSeparableFootprintSize];
+            float wy[MaxSeparableFootprintSize];
+
+            for (size_t i = 0; i < footprint_width; ++i)
+                wx[i] = filter.evaluate_x(footprint.min.x + static_cast<int>(i) - dx);
+
+            for (size_t i = 0; i < footprint_height; ++i)
+                wy[i] = filter.evaluate_y(footprint.min.y + static_cast<int>(i) - dy);
+
+            for (size_t j = 0; j < footprint_height; ++j)
+            {
+                float* APPLESEED_RESTRICT ptr = tile.pixel(footprint.min.x, footprint.min.y + j);
+
+                for (size_t i = 0; i < footprint_width; ++i)
+                {
+                    accumulate<AtomicUpdates>(ptr, values, value_count, wx[i] * wy[j]);
+                    ptr += channel_count;
+                }
+            }
+        }
+        else
+        {
+            for (int ry = footprint.min.y; ry <= footprint.max.y; ++ry)
+            {
+                float* APPLESEED_RESTRICT ptr = tile.pixel(footprint.min.x, ry);
+
+                for (int rx = footprint.min.x; rx <= footprint.max.x; ++rx)
+                {
+                    const float weight = filter.evaluate(rx - dx, ry - dy);
+                    accumulate<AtomicUpdates>(ptr, values, value_count, weight);
+                    ptr += channel_count;
+                }
             }
         }
     }
 }
 
+void FilteredTile::add(
+    const float         x,
+    const float         y,
+    const float*        values)
+{
+#ifdef ATOMIC_UPDATES
+    add_to_tile<true>(*this, x, y, values);
+#else
+    add_to_tile<false>(*this, x, y, values);
+#endif
+}
+
+void FilteredTile::add_exclusive(
+    const float         x,
+    const float         y,
+    const float*        values)
+{
+    add_to_tile<false>(*this, x, y, values);
+}
+
 }   // namespace foundation
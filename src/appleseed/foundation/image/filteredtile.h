@@ -125,6 +125,13 @@ class FilteredTile
         const float         y,
         const float*        values);
 
+    // Like add(), but without atomic updates: the caller must guarantee that
+    // no other thread is updating pixels within the filter footprint of (x, y).
+    void add_exclusive(
+        const float         x,
+        const float         y,
+        const float*        values);
+
   protected:
     const AABB2u            m_crop_window;
     const Filter2f&         m_filter;
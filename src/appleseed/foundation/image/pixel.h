@@ -32,6 +32,9 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/scalar.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
 #include "foundation/platform/types.h"
 #include "foundation/utility/otherwise.h"
 
@@ -774,6 +777,34 @@ inline void Pixel::convert_from_format<uint8>(
       case PixelFormatFloat:                // lossy float -> uint8
         {
             const float* it = reinterpret_cast<const float*>(src_begin);
+
+#ifdef APPLESEED_USE_SSE
+            // Convert 16 contiguous values at a time. Truncation and clamping
+            // match the scalar path below, which handles the remaining values.
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                const __m128 scale = _mm_set1_ps(256.0f);
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 max_val = _mm_set1_ps(255.0f);
+
+                for (; it + 16 <= reinterpret_cast<const float*>(src_end); it += 16, dest += 16)
+                {
+                    __m128i v[4];
+                    for (size_t i = 0; i < 4; ++i)
+                    {
+                        const __m128 x = _mm_mul_ps(_mm_loadu_ps(it + i * 4), scale);
+                        v[i] = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(x, zero), max_val));
+                    }
+
+                    _mm_storeu_si128(
+                        reinterpret_cast<__m128i*>(dest),
+                        _mm_packus_epi16(
+                            _mm_packs_epi32(v[0], v[1]),
+                            _mm_packs_epi32(v[2], v[3])));
+                }
+            }
+#endif
+
             for (; it < reinterpret_cast<const float*>(src_end); it += src_stride)
             {
                 const float val = clamp(*it * 256.0f, 0.0f, 255.0f);
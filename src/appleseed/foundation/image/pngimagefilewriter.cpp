@@ -35,19 +35,28 @@
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/color.h"
 #include "foundation/image/icanvas.h"
+#include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
+#include "foundation/platform/system.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
 #include "foundation/utility/string.h"
 
 // libpng headers.
 #include "png.h"
 
+// zlib headers.
+#include "zlib.h"
+
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdio>
+#include <cstdlib>
 #include <string>
 #include <vector>
 
@@ -166,6 +175,274 @@ namespace
 
         text_chunks.clear();
     }
+
+    // Chunk names, as expected by png_write_chunk*().
+    png_byte IDATChunkName[5] = { 'I', 'D', 'A', 'T', '\0' };
+    png_byte IENDChunkName[5] = { 'I', 'E', 'N', 'D', '\0' };
+
+    // Convert one row of a canvas to 8-bit per channel.
+    void convert_row(
+        const ICanvas&              image,
+        const size_t                y,
+        uint8*                      dest)
+    {
+        const CanvasProperties& props = image.properties();
+        const size_t tile_y = y / props.m_tile_height;
+        const size_t pixel_y = y % props.m_tile_height;
+
+        for (size_t tile_x = 0; tile_x < props.m_tile_count_x; ++tile_x)
+        {
+            const Tile& tile = image.tile(tile_x, tile_y);
+            const uint8* src = tile.pixel(0, pixel_y);
+            const size_t value_count = tile.get_width() * tile.get_channel_count();
+
+            Pixel::convert_from_format<uint8>(
+                tile.get_pixel_format(),
+                src,
+                src + value_count * Pixel::size(tile.get_pixel_format()),
+                1,
+                dest + tile_x * props.m_tile_width * props.m_channel_count,
+                1);
+        }
+    }
+
+    inline uint8 paeth_predictor(const int a, const int b, const int c)
+    {
+        const int p = a + b - c;
+        const int pa = abs(p - a);
+        const int pb = abs(p - b);
+        const int pc = abs(p - c);
+
+        return static_cast<uint8>(pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+    }
+
+    // Filter one row, selecting the filter that minimizes the sum of absolute differences,
+    // the same heuristic libpng uses by default. The first byte of the output is the filter type.
+    void filter_row(
+        const uint8*                row,
+        const uint8*                prev_row,       // all zeros for the first row of the image
+        const size_t                row_size,
+        const size_t                bpp,
+        uint8*                      candidates,     // 5 * row_size bytes of scratch space
+        uint8*                      output)         // row_size + 1 bytes
+    {
+        size_t best_filter = 0;
+        size_t best_sum = ~size_t(0);
+
+        for (size_t filter = 0; filter < 5; ++filter)
+        {
+            uint8* out = candidates + filter * row_size;
+            size_t sum = 0;
+
+            for (size_t i = 0; i < row_size; ++i)
+            {
+                const int x = row[i];
+                const int a = i >= bpp ? row[i - bpp] : 0;
+                const int b = prev_row[i];
+                const int c = i >= bpp ? prev_row[i - bpp] : 0;
+
+                uint8 value;
+                switch (filter)
+                {
+                  case 0: value = static_cast<uint8>(x); break;
+                  case 1: value = static_cast<uint8>(x - a); break;
+                  case 2: value = static_cast<uint8>(x - b); break;
+                  case 3: value = static_cast<uint8>(x - ((a + b) >> 1)); break;
+                  default: value = static_cast<uint8>(x - paeth_predictor(a, b, c)); break;
+                }
+
+                out[i] = value;
+                sum += value < 128 ? value : 256 - value;
+            }
+
+            if (sum < best_sum)
+            {
+                best_sum = sum;
+                best_filter = filter;
+            }
+        }
+
+        output[0] = static_cast<uint8>(best_filter);
+        copy(candidates + best_filter * row_size, candidates + (best_filter + 1) * row_size, output + 1);
+    }
+
+    // A strip of rows, filtered and compressed independently of the others.
+    struct CompressedStrip
+    {
+        vector<uint8>   m_data;             // raw deflate data, ending on a byte boundary
+        uLong           m_adler;            // Adler-32 checksum of the uncompressed data
+        uLong           m_size;             // size in bytes of the uncompressed data
+        bool            m_success;
+    };
+
+    class CompressStripJob
+      : public IJob
+    {
+      public:
+        CompressStripJob(
+            const ICanvas&          image,
+            const size_t            begin_y,
+            const size_t            end_y,
+            CompressedStrip&        strip)
+          : m_image(image)
+          , m_begin_y(begin_y)
+          , m_end_y(end_y)
+          , m_strip(strip)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            const CanvasProperties& props = m_image.properties();
+            const size_t row_size = props.m_canvas_width * props.m_channel_count;
+            const size_t row_count = m_end_y - m_begin_y;
+            const bool is_last_strip = m_end_y == props.m_canvas_height;
+
+            // Convert the rows of the strip, preceded by the last row of the previous strip
+            // which the Up, Average and Paeth filters refer to.
+            vector<uint8> rows((row_count + 1) * row_size, 0);
+            if (m_begin_y > 0)
+                convert_row(m_image, m_begin_y - 1, &rows[0]);
+            for (size_t i = 0; i < row_count; ++i)
+                convert_row(m_image, m_begin_y + i, &rows[(i + 1) * row_size]);
+
+            // Filter the rows.
+            vector<uint8> candidates(5 * row_size);
+            vector<uint8> filtered(row_count * (row_size + 1));
+            for (size_t i = 0; i < row_count; ++i)
+            {
+                filter_row(
+                    &rows[(i + 1) * row_size],
+                    &rows[i * row_size],
+                    row_size,
+                    props.m_channel_count,
+                    &candidates[0],
+                    &filtered[i * (row_size + 1)]);
+            }
+
+            m_strip.m_size = static_cast<uLong>(filtered.size());
+            m_strip.m_adler = adler32(adler32(0, Z_NULL, 0), &filtered[0], static_cast<uInt>(filtered.size()));
+            m_strip.m_success = false;
+
+            // Compress the rows. All strips but the last one end with a sync flush
+            // so that their compressed data can simply be concatenated.
+            z_stream stream;
+            stream.zalloc = Z_NULL;
+            stream.zfree = Z_NULL;
+            stream.opaque = Z_NULL;
+            if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_FILTERED) != Z_OK)
+                return;
+
+            m_strip.m_data.resize(deflateBound(&stream, m_strip.m_size) + 16);
+            stream.next_in = &filtered[0];
+            stream.avail_in = static_cast<uInt>(filtered.size());
+            stream.next_out = &m_strip.m_data[0];
+            stream.avail_out = static_cast<uInt>(m_strip.m_data.size());
+
+            const int result = deflate(&stream, is_last_strip ? Z_FINISH : Z_SYNC_FLUSH);
+            m_strip.m_success =
+                stream.avail_in == 0 &&
+                result == (is_last_strip ? Z_STREAM_END : Z_OK);
+            m_strip.m_data.resize(stream.total_out);
+
+            deflateEnd(&stream);
+        }
+
+      private:
+        const ICanvas&      m_image;
+        const size_t        m_begin_y;
+        const size_t        m_end_y;
+        CompressedStrip&    m_strip;
+    };
+
+    // Filter and compress the image data, one row of tiles per strip.
+    void compress_strips(
+        const ICanvas&              image,
+        const size_t                thread_count,
+        vector<CompressedStrip>&    strips)
+    {
+        const CanvasProperties& props = image.properties();
+
+        strips.resize(props.m_tile_count_y);
+
+        JobQueue job_queue;
+        for (size_t tile_y = 0; tile_y < props.m_tile_count_y; ++tile_y)
+        {
+            job_queue.schedule(
+                new CompressStripJob(
+                    image,
+                    tile_y * props.m_tile_height,
+                    min((tile_y + 1) * props.m_tile_height, props.m_canvas_height),
+                    strips[tile_y]));
+        }
+
+        Logger logger;
+        JobManager job_manager(
+            logger,
+            job_queue,
+            max<size_t>(min(thread_count, strips.size()), 1));
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        for (size_t i = 0; i < strips.size(); ++i)
+        {
+            if (!strips[i].m_success)
+                throw PNGImageFileWriter::ExceptionMemoryError();
+        }
+    }
+
+    // Write the compressed image data as a zlib stream split across IDAT chunks.
+    void write_image_data(
+        png_structp                 png_ptr,
+        const vector<CompressedStrip>& strips)
+    {
+        assert(!strips.empty());
+
+        uLong adler = strips[0].m_adler;
+        for (size_t i = 1; i < strips.size(); ++i)
+            adler = adler32_combine(adler, strips[i].m_adler, strips[i].m_size);
+
+        // zlib header: deflate with a 32 KB window, default compression level.
+        png_byte header[2] = { 0x78, 0x9C };
+
+        png_byte trailer[4] =
+        {
+            static_cast<png_byte>((adler >> 24) & 0xFF),
+            static_cast<png_byte>((adler >> 16) & 0xFF),
+            static_cast<png_byte>((adler >> 8) & 0xFF),
+            static_cast<png_byte>(adler & 0xFF)
+        };
+
+        for (size_t i = 0; i < strips.size(); ++i)
+        {
+            const vector<uint8>& data = strips[i].m_data;
+            const bool is_first = i == 0;
+            const bool is_last = i + 1 == strips.size();
+
+            const size_t chunk_size =
+                data.size() + (is_first ? sizeof(header) : 0) + (is_last ? sizeof(trailer) : 0);
+
+            png_write_chunk_start(png_ptr, IDATChunkName, static_cast<png_uint_32>(chunk_size));
+            if (is_first)
+                png_write_chunk_data(png_ptr, header, sizeof(header));
+            if (!data.empty())
+                png_write_chunk_data(png_ptr, const_cast<png_bytep>(&data[0]), data.size());
+            if (is_last)
+                png_write_chunk_data(png_ptr, trailer, sizeof(trailer));
+            png_write_chunk_end(png_ptr);
+        }
+    }
+}
+
+PNGImageFileWriter::PNGImageFileWriter()
+  : m_thread_count(System::get_available_cpu_core_count())
+{
+}
+
+PNGImageFileWriter::PNGImageFileWriter(const size_t thread_count)
+  : m_thread_count(thread_count)
+{
 }
 
 void PNGImageFileWriter::write(
@@ -179,6 +456,10 @@ void PNGImageFileWriter::write(
     // todo: lift these limitations.
     assert(props.m_channel_count == 3 || props.m_channel_count == 4);
 
+    // Filter and compress the image in parallel before touching the file.
+    vector<CompressedStrip> strips;
+    compress_strips(image, m_thread_count, strips);
+
     // Open the file in write mode.
     FILE* fp = fopen(filename, "wb");
     if (fp == 0)
@@ -259,71 +540,12 @@ void PNGImageFileWriter::write(
     // Write the file header information.
     png_write_info(png_ptr, info_ptr);
 
-    // Create the temporary buffer holding one row of tiles in target format.
-    vector<uint8> buffer(
-          props.m_canvas_width
-        * props.m_tile_height
-        * props.m_channel_count);
-
-    // Construct pointers to each row of the temporary buffer.
-    vector<uint8*> buffer_rows(props.m_tile_height);
-    for (size_t y = 0; y < props.m_tile_height; ++y)
-        buffer_rows[y] = &buffer[y * props.m_canvas_width * props.m_channel_count];
-
-    // Loop over the rows of tiles.
-    for (size_t tile_y = 0; tile_y < props.m_tile_count_y; ++tile_y)
-    {
-        // Convert this row of tiles to target format.
-        for (size_t tile_x = 0; tile_x < props.m_tile_count_x; ++tile_x)
-        {
-            const Tile& tile = image.tile(tile_x, tile_y);
-            assert(tile.get_height() <= props.m_tile_height);
-            for (size_t y = 0; y < tile.get_height(); ++y)
-            {
-                for (size_t x = 0; x < tile.get_width(); ++x)
-                {
-                    // Horizontal coordinate of the pixel in the temporary buffer.
-                    const size_t buffer_x = tile_x * props.m_tile_width + x;
-
-                    // Index of the pixel in the temporary buffer.
-                    const size_t buffer_index =
-                        (y * props.m_canvas_width + buffer_x) * props.m_channel_count;
-
-                    // Fetch the pixel at coordinates (x, y) in the tile,
-                    // perform format conversion if necessary, and store
-                    // the converted pixel into the temporary buffer.
-                    if (tile.get_channel_count() == 3)
-                    {
-                        Color3b pixel;
-                        tile.get_pixel(x, y, pixel);
-                        buffer[buffer_index + 0] = pixel[0];
-                        buffer[buffer_index + 1] = pixel[1];
-                        buffer[buffer_index + 2] = pixel[2];
-                    }
-                    else
-                    {
-                        assert(tile.get_channel_count() == 4);
-                        Color4b pixel;
-                        tile.get_pixel(x, y, pixel);
-                        buffer[buffer_index + 0] = pixel[0];
-                        buffer[buffer_index + 1] = pixel[1];
-                        buffer[buffer_index + 2] = pixel[2];
-                        buffer[buffer_index + 3] = pixel[3];
-                    }
-                }
-            }
-        }
-
-        // Write this row of tiles to the file.
-        const size_t row_count = image.tile(0, tile_y).get_height();
-        png_write_rows(
-            png_ptr,
-            &buffer_rows[0],
-            static_cast<png_uint_32>(row_count));
-    }
+    // Write the image data.
+    write_image_data(png_ptr, strips);
 
-    // Finish writing the file.
-    png_write_end(png_ptr, 0);
+    // Finish writing the file. The image data was written without libpng's
+    // knowledge, so the IEND chunk must be written manually as well.
+    png_write_chunk(png_ptr, IENDChunkName, 0, 0);
 
     // Deallocate the png_struct and png_info structures.
     png_destroy_write_struct(&png_ptr, &info_ptr);
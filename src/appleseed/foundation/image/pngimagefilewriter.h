@@ -38,6 +38,9 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation    { class ICanvas; }
 
@@ -63,6 +66,9 @@ namespace foundation
 //
 // Other image attributes will be stored as generic text chunks.
 //
+// Rows of tiles are filtered and compressed in parallel, each ending with a zlib sync
+// flush so that the compressed data of all rows forms a single valid zlib stream.
+//
 // Reference: http://www.libpng.org/pub/png/spec/1.2/PNG-Chunks.html
 //
 
@@ -73,11 +79,20 @@ class APPLESEED_DLLSYMBOL PNGImageFileWriter
     // Memory allocation error.
     struct ExceptionMemoryError : public Exception {};
 
+    // Constructor. Use as many threads as there are logical CPU cores.
+    PNGImageFileWriter();
+
+    // Constructor.
+    explicit PNGImageFileWriter(const size_t thread_count);
+
     // Write a PNG image file.
     virtual void write(
         const char*             filename,
         const ICanvas&          image,
         const ImageAttributes&  image_attributes = ImageAttributes());
+
+  private:
+    const size_t m_thread_count;
 };
 
 }       // namespace foundation
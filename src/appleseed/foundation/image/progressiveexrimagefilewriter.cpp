@@ -0,0 +1,254 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "progressiveexrimagefilewriter.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/exceptionunsupportedimageformat.h"
+#include "foundation/image/exrutils.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+
+// OpenEXR headers.
+#include "foundation/platform/exrheaderguards.h"
+BEGIN_EXR_INCLUDES
+#include "OpenEXR/IexBaseExc.h"
+#include "OpenEXR/ImathBox.h"
+#include "OpenEXR/ImfChannelList.h"
+#include "OpenEXR/ImfFrameBuffer.h"
+#include "OpenEXR/ImfHeader.h"
+#include "OpenEXR/ImfLineOrder.h"
+#include "OpenEXR/ImfPixelType.h"
+#include "OpenEXR/ImfTileDescription.h"
+#include "OpenEXR/ImfTiledOutputFile.h"
+END_EXR_INCLUDES
+
+// Standard headers.
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace Iex;
+using namespace Imath;
+using namespace Imf;
+using namespace std;
+
+namespace foundation
+{
+
+//
+// ProgressiveEXRImageFileWriter class implementation.
+//
+
+namespace
+{
+    const char* ChannelName[] = { "R", "G", "B", "A" };
+}
+
+struct ProgressiveEXRImageFileWriter::Impl
+{
+    CanvasProperties            m_props;
+    PixelType                   m_pixel_type;
+    auto_ptr<TiledOutputFile>   m_file;
+    vector<bool>                m_written_tiles;
+
+    void write_tile(
+        const uint8*            pixels,
+        const size_t            tile_x,
+        const size_t            tile_y)
+    {
+        const int ix = static_cast<int>(tile_x);
+        const int iy = static_cast<int>(tile_y);
+        const Box2i range = m_file->dataWindowForTile(ix, iy);
+
+        const size_t channel_size = Pixel::size(m_props.m_pixel_format);
+        const size_t stride_x = channel_size * m_props.m_channel_count;
+        const size_t stride_y = stride_x * (range.max.x - range.min.x + 1);
+        const char* tile_base =
+              reinterpret_cast<const char*>(pixels)
+            - range.min.x * stride_x
+            - range.min.y * stride_y;
+
+        FrameBuffer framebuffer;
+        for (size_t c = 0; c < m_props.m_channel_count; ++c)
+        {
+            framebuffer.insert(
+                ChannelName[c],
+                Slice(
+                    m_pixel_type,
+                    const_cast<char*>(tile_base + c * channel_size),
+                    stride_x,
+                    stride_y));
+        }
+
+        m_file->setFrameBuffer(framebuffer);
+        m_file->writeTile(ix, iy);
+
+        m_written_tiles[tile_y * m_props.m_tile_count_x + tile_x] = true;
+    }
+};
+
+ProgressiveEXRImageFileWriter::ProgressiveEXRImageFileWriter()
+  : impl(new Impl())
+{
+}
+
+ProgressiveEXRImageFileWriter::~ProgressiveEXRImageFileWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const ExceptionIOError&)
+    {
+    }
+
+    delete impl;
+}
+
+void ProgressiveEXRImageFileWriter::open(
+    const char*             filename,
+    const CanvasProperties& props,
+    const ImageAttributes&  image_attributes)
+{
+    assert(filename);
+    assert(!is_open());
+    assert(props.m_channel_count <= 4);
+
+    initialize_openexr();
+
+    // Figure out the pixel type, based on the pixel format of the image.
+    switch (props.m_pixel_format)
+    {
+      case PixelFormatUInt32: impl->m_pixel_type = UINT; break;
+      case PixelFormatHalf: impl->m_pixel_type = HALF; break;
+      case PixelFormatFloat: impl->m_pixel_type = FLOAT; break;
+      default: throw ExceptionUnsupportedImageFormat();
+    }
+
+    try
+    {
+        // Construct ChannelList object.
+        ChannelList channels;
+        for (size_t c = 0; c < props.m_channel_count; ++c)
+            channels.insert(ChannelName[c], Channel(impl->m_pixel_type));
+
+        // Construct Header object. Tiles are stored in the order they are written.
+        Header header(
+            static_cast<int>(props.m_canvas_width),
+            static_cast<int>(props.m_canvas_height));
+        header.setTileDescription(
+            TileDescription(
+                static_cast<unsigned int>(props.m_tile_width),
+                static_cast<unsigned int>(props.m_tile_height),
+                ONE_LEVEL));
+        header.lineOrder() = RANDOM_Y;
+        header.channels() = channels;
+
+        // Add image attributes to the Header object.
+        add_attributes(image_attributes, header);
+
+        // Create the output file.
+        impl->m_file.reset(new TiledOutputFile(filename, header));
+    }
+    catch (const BaseExc& e)
+    {
+        // I/O error.
+        throw ExceptionIOError(e.what());
+    }
+
+    impl->m_props = props;
+    impl->m_written_tiles.assign(props.m_tile_count, false);
+}
+
+void ProgressiveEXRImageFileWriter::close()
+{
+    if (!is_open())
+        return;
+
+    try
+    {
+        // Fill the tiles that were never written with zeros.
+        vector<uint8> zeros(impl->m_props.m_tile_width * impl->m_props.m_tile_height * impl->m_props.m_pixel_size, 0);
+
+        for (size_t ty = 0; ty < impl->m_props.m_tile_count_y; ++ty)
+        {
+            for (size_t tx = 0; tx < impl->m_props.m_tile_count_x; ++tx)
+            {
+                if (!impl->m_written_tiles[ty * impl->m_props.m_tile_count_x + tx])
+                    impl->write_tile(&zeros[0], tx, ty);
+            }
+        }
+
+        impl->m_file.reset();
+    }
+    catch (const BaseExc& e)
+    {
+        impl->m_file.reset();
+
+        // I/O error.
+        throw ExceptionIOError(e.what());
+    }
+}
+
+bool ProgressiveEXRImageFileWriter::is_open() const
+{
+    return impl->m_file.get() != 0;
+}
+
+void ProgressiveEXRImageFileWriter::write_tile(
+    const Tile&             tile,
+    const size_t            tile_x,
+    const size_t            tile_y)
+{
+    assert(is_open());
+    assert(tile_x < impl->m_props.m_tile_count_x);
+    assert(tile_y < impl->m_props.m_tile_count_y);
+    assert(tile.get_width() == impl->m_props.get_tile_width(tile_x));
+    assert(tile.get_height() == impl->m_props.get_tile_height(tile_y));
+    assert(tile.get_channel_count() == impl->m_props.m_channel_count);
+    assert(tile.get_pixel_format() == impl->m_props.m_pixel_format);
+
+    try
+    {
+        impl->write_tile(tile.pixel(0, 0), tile_x, tile_y);
+    }
+    catch (const BaseExc& e)
+    {
+        // I/O error.
+        throw ExceptionIOError(e.what());
+    }
+}
+
+}   // namespace foundation
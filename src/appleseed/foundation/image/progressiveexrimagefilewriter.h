@@ -0,0 +1,96 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_FOUNDATION_IMAGE_PROGRESSIVEEXRIMAGEFILEWRITER_H
+#define APPLESEED_FOUNDATION_IMAGE_PROGRESSIVEEXRIMAGEFILEWRITER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/imageattributes.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class CanvasProperties; }
+namespace foundation    { class Tile; }
+
+namespace foundation
+{
+
+//
+// OpenEXR image file writer that writes an image one tile at a time.
+//
+// Tiles can be written in any order and are stored in the file as soon as they are
+// written, so that the caller can release them right away. Tiles that were never
+// written are filled with zeros when the file is closed.
+//
+// This class is not thread-safe.
+//
+
+class APPLESEED_DLLSYMBOL ProgressiveEXRImageFileWriter
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    ProgressiveEXRImageFileWriter();
+
+    // Destructor, closes the image file if it is still open.
+    ~ProgressiveEXRImageFileWriter();
+
+    // Create an image file. Only the half, float and uint32 pixel formats are supported.
+    void open(
+        const char*             filename,
+        const CanvasProperties& props,
+        const ImageAttributes&  image_attributes = ImageAttributes());
+
+    // Close the image file.
+    void close();
+
+    // Return true if an image file is currently open.
+    bool is_open() const;
+
+    // Write a tile. The tile must have the pixel format of the image file.
+    void write_tile(
+        const Tile&             tile,
+        const size_t            tile_x,
+        const size_t            tile_y);
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_IMAGE_PROGRESSIVEEXRIMAGEFILEWRITER_H
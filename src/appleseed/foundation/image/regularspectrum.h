@@ -468,6 +468,25 @@ inline RegularSpectrum<T, N>& operator-=(RegularSpectrum<T, N>& lhs, const Regul
     return lhs;
 }
 
+#ifdef APPLESEED_USE_SSE
+
+template <>
+APPLESEED_FORCE_INLINE RegularSpectrum<float, 31>& operator-=(RegularSpectrum<float, 31>& lhs, const RegularSpectrum<float, 31>& rhs)
+{
+    _mm_store_ps(&lhs[ 0], _mm_sub_ps(_mm_load_ps(&lhs[ 0]), _mm_load_ps(&rhs[ 0])));
+    _mm_store_ps(&lhs[ 4], _mm_sub_ps(_mm_load_ps(&lhs[ 4]), _mm_load_ps(&rhs[ 4])));
+    _mm_store_ps(&lhs[ 8], _mm_sub_ps(_mm_load_ps(&lhs[ 8]), _mm_load_ps(&rhs[ 8])));
+    _mm_store_ps(&lhs[12], _mm_sub_ps(_mm_load_ps(&lhs[12]), _mm_load_ps(&rhs[12])));
+    _mm_store_ps(&lhs[16], _mm_sub_ps(_mm_load_ps(&lhs[16]), _mm_load_ps(&rhs[16])));
+    _mm_store_ps(&lhs[20], _mm_sub_ps(_mm_load_ps(&lhs[20]), _mm_load_ps(&rhs[20])));
+    _mm_store_ps(&lhs[24], _mm_sub_ps(_mm_load_ps(&lhs[24]), _mm_load_ps(&rhs[24])));
+    _mm_store_ps(&lhs[28], _mm_sub_ps(_mm_load_ps(&lhs[28]), _mm_load_ps(&rhs[28])));
+
+    return lhs;
+}
+
+#endif  // APPLESEED_USE_SSE
+
 template <typename T, size_t N>
 inline RegularSpectrum<T, N>& operator*=(RegularSpectrum<T, N>& lhs, const T rhs)
 {
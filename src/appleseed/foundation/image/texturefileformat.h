@@ -0,0 +1,87 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_IMAGE_TEXTUREFILEFORMAT_H
+#define APPLESEED_FOUNDATION_IMAGE_TEXTUREFILEFORMAT_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+
+namespace foundation {
+namespace texture_file_format {
+
+//
+// Layout of appleseed texture files (all values are in native byte order):
+//
+//   char[16]   signature
+//   uint16     version
+//   uint16     flags
+//   uint32     width of the base level, in pixels
+//   uint32     height of the base level, in pixels
+//   uint32     tile width, in pixels
+//   uint32     tile height, in pixels
+//   uint32     number of channels
+//   uint32     pixel format (a foundation::PixelFormat value)
+//   uint32     number of MIP levels, including the base level
+//
+// followed by one TileEntry for each tile of each level (levels from finest to
+// coarsest, tiles in scanline order), followed by the tile data. Tile data are
+// aligned on DataAlignment bytes so that uncompressed tiles can be used in place.
+//
+
+const char Signature[16] =
+{
+    'A', 'P', 'P', 'L', 'E', 'S', 'E', 'E', 'D', 'T', 'E', 'X', 'T', 'U', 'R', 'E'
+};
+
+const uint16 Version = 1;
+
+// Flags.
+const uint16 FlagCompressed = 1 << 0;       // tiles are compressed with LZ4
+
+// Size in bytes of the header.
+const size_t HeaderSize = sizeof(Signature) + 2 * sizeof(uint16) + 7 * sizeof(uint32);
+
+// Alignment in bytes of tile data.
+const size_t DataAlignment = 16;
+
+// Location of the data of a tile in the file.
+struct TileEntry
+{
+    uint64  m_offset;                       // offset in bytes from the start of the file
+    uint64  m_size;                         // size in bytes of the (possibly compressed) data
+};
+
+}       // namespace texture_file_format
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_IMAGE_TEXTUREFILEFORMAT_H
@@ -0,0 +1,340 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "texturefilereader.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/texturefileformat.h"
+#include "foundation/image/tile.h"
+#include "foundation/platform/types.h"
+
+// lz4 headers.
+#include "lz4.h"
+
+// Boost headers.
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace boost;
+using namespace std;
+
+namespace foundation
+{
+
+//
+// TextureFileReader class implementation.
+//
+
+struct TextureFileReader::Impl
+{
+    struct Level
+    {
+        CanvasProperties                    m_props;
+        size_t                              m_first_entry;
+    };
+
+    string                                  m_filename;
+    auto_ptr<interprocess::file_mapping>    m_file_mapping;
+    auto_ptr<interprocess::mapped_region>   m_mapped_region;
+    const uint8*                            m_data;
+    size_t                                  m_data_size;
+    bool                                    m_compressed;
+    vector<Level>                           m_levels;
+    vector<texture_file_format::TileEntry>  m_entries;
+
+    template <typename T>
+    void read(size_t& offset, T& object) const
+    {
+        if (offset + sizeof(T) > m_data_size)
+            throw ExceptionIOError("truncated texture file");
+
+        memcpy(&object, m_data + offset, sizeof(T));
+        offset += sizeof(T);
+    }
+
+    void open()
+    {
+        using namespace texture_file_format;
+
+        try
+        {
+            m_file_mapping.reset(
+                new interprocess::file_mapping(m_filename.c_str(), interprocess::read_only));
+            m_mapped_region.reset(
+                new interprocess::mapped_region(*m_file_mapping, interprocess::read_only));
+        }
+        catch (const interprocess::interprocess_exception& e)
+        {
+            throw ExceptionIOError(e.what());
+        }
+
+        m_data = static_cast<const uint8*>(m_mapped_region->get_address());
+        m_data_size = m_mapped_region->get_size();
+
+        // Check the signature.
+        if (m_data_size < HeaderSize || memcmp(m_data, Signature, sizeof(Signature)))
+            throw ExceptionIOError("invalid texture file signature");
+
+        size_t offset = sizeof(Signature);
+
+        uint16 version, flags;
+        read(offset, version);
+        read(offset, flags);
+
+        if (version != Version)
+            throw ExceptionIOError("unknown texture file format version");
+
+        m_compressed = (flags & FlagCompressed) != 0;
+
+        uint32 width, height, tile_width, tile_height, channel_count, pixel_format, level_count;
+        read(offset, width);
+        read(offset, height);
+        read(offset, tile_width);
+        read(offset, tile_height);
+        read(offset, channel_count);
+        read(offset, pixel_format);
+        read(offset, level_count);
+
+        if (width == 0 || height == 0 ||
+            tile_width == 0 || tile_height == 0 ||
+            channel_count == 0 ||
+            pixel_format > PixelFormatDouble ||
+            level_count == 0 || level_count > 32)
+            throw ExceptionIOError("invalid texture file header");
+
+        // Compute the properties of all MIP levels.
+        size_t entry_count = 0;
+        m_levels.resize(level_count);
+        for (size_t i = 0; i < level_count; ++i)
+        {
+            m_levels[i].m_props =
+                CanvasProperties(
+                    max<size_t>(width >> i, 1),
+                    max<size_t>(height >> i, 1),
+                    tile_width,
+                    tile_height,
+                    channel_count,
+                    static_cast<PixelFormat>(pixel_format));
+            m_levels[i].m_first_entry = entry_count;
+            entry_count += m_levels[i].m_props.m_tile_count;
+        }
+
+        // Read the tile table.
+        m_entries.resize(entry_count);
+        for (size_t i = 0; i < entry_count; ++i)
+        {
+            TileEntry& entry = m_entries[i];
+            read(offset, entry.m_offset);
+            read(offset, entry.m_size);
+
+            if (entry.m_offset > m_data_size || entry.m_size > m_data_size - entry.m_offset)
+                throw ExceptionIOError("invalid texture file tile table");
+        }
+    }
+
+    void close()
+    {
+        m_mapped_region.reset();
+        m_file_mapping.reset();
+        m_data = 0;
+        m_data_size = 0;
+        m_levels.clear();
+        m_entries.clear();
+    }
+
+    Tile* read_tile(
+        const size_t        level,
+        const size_t        tile_x,
+        const size_t        tile_y) const
+    {
+        assert(level < m_levels.size());
+
+        const CanvasProperties& props = m_levels[level].m_props;
+        assert(tile_x < props.m_tile_count_x);
+        assert(tile_y < props.m_tile_count_y);
+
+        const texture_file_format::TileEntry& entry =
+            m_entries[m_levels[level].m_first_entry + tile_y * props.m_tile_count_x + tile_x];
+
+        const size_t width = props.get_tile_width(tile_x);
+        const size_t height = props.get_tile_height(tile_y);
+        const size_t size = width * height * props.m_pixel_size;
+
+        // Pixels are read-only, Tile simply doesn't have a notion of constness.
+        uint8* data = const_cast<uint8*>(m_data + entry.m_offset);
+
+        if (!m_compressed)
+        {
+            if (entry.m_size != size)
+                throw ExceptionIOError("invalid texture file tile size");
+
+            return
+                new Tile(
+                    width,
+                    height,
+                    props.m_channel_count,
+                    props.m_pixel_format,
+                    data);
+        }
+
+        auto_ptr<Tile> tile(
+            new Tile(
+                width,
+                height,
+                props.m_channel_count,
+                props.m_pixel_format));
+
+        const int decompressed_size =
+            LZ4_decompress_safe(
+                reinterpret_cast<const char*>(data),
+                reinterpret_cast<char*>(tile->get_storage()),
+                static_cast<int>(entry.m_size),
+                static_cast<int>(size));
+
+        if (decompressed_size != static_cast<int>(size))
+            throw ExceptionIOError("failed to decompress texture file tile");
+
+        return tile.release();
+    }
+};
+
+TextureFileReader::TextureFileReader()
+  : impl(new Impl())
+{
+    impl->m_data = 0;
+    impl->m_data_size = 0;
+    impl->m_compressed = false;
+}
+
+TextureFileReader::~TextureFileReader()
+{
+    if (is_open())
+        close();
+
+    delete impl;
+}
+
+void TextureFileReader::open(const char* filename)
+{
+    assert(filename);
+    assert(!is_open());
+
+    impl->m_filename = filename;
+
+    try
+    {
+        impl->open();
+    }
+    catch (...)
+    {
+        impl->close();
+        throw;
+    }
+}
+
+void TextureFileReader::close()
+{
+    assert(is_open());
+
+    impl->close();
+}
+
+bool TextureFileReader::is_open() const
+{
+    return impl->m_data != 0;
+}
+
+void TextureFileReader::read_canvas_properties(
+    CanvasProperties&   props)
+{
+    read_canvas_properties(0, props);
+}
+
+void TextureFileReader::read_image_attributes(
+    ImageAttributes&    attrs)
+{
+    assert(is_open());
+
+    // Texture files don't store image attributes.
+}
+
+Tile* TextureFileReader::read_tile(
+    const size_t        tile_x,
+    const size_t        tile_y)
+{
+    return read_tile(0, tile_x, tile_y);
+}
+
+size_t TextureFileReader::get_level_count() const
+{
+    assert(is_open());
+
+    return impl->m_levels.size();
+}
+
+bool TextureFileReader::is_compressed() const
+{
+    assert(is_open());
+
+    return impl->m_compressed;
+}
+
+void TextureFileReader::read_canvas_properties(
+    const size_t        level,
+    CanvasProperties&   props)
+{
+    assert(is_open());
+    assert(level < impl->m_levels.size());
+
+    props = impl->m_levels[level].m_props;
+}
+
+Tile* TextureFileReader::read_tile(
+    const size_t        level,
+    const size_t        tile_x,
+    const size_t        tile_y)
+{
+    assert(is_open());
+
+    return impl->read_tile(level, tile_x, tile_y);
+}
+
+}   // namespace foundation
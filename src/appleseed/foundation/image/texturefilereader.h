@@ -0,0 +1,118 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_IMAGE_TEXTUREFILEREADER_H
+#define APPLESEED_FOUNDATION_IMAGE_TEXTUREFILEREADER_H
+
+// appleseed.foundation headers.
+#include "foundation/image/iprogressiveimagefilereader.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class CanvasProperties; }
+namespace foundation    { class ImageAttributes; }
+namespace foundation    { class Tile; }
+
+namespace foundation
+{
+
+//
+// Reader for the appleseed texture file format (see foundation::TextureFileWriter).
+//
+// The file is memory-mapped. Uncompressed tiles are returned without copying:
+// their pixels live in the (read-only) file mapping, hence they must not be
+// modified and must be deleted before the reader is closed. Compressed tiles
+// are decompressed into newly allocated tiles.
+//
+// This class is thread-safe once a file is open.
+//
+
+class APPLESEED_DLLSYMBOL TextureFileReader
+  : public IProgressiveImageFileReader
+{
+  public:
+    // Constructor.
+    TextureFileReader();
+
+    // Destructor.
+    ~TextureFileReader();
+
+    // Open a texture file.
+    virtual void open(
+        const char*         filename);
+
+    // Close the texture file.
+    virtual void close();
+
+    // Return true if a texture file is currently open.
+    virtual bool is_open() const;
+
+    // Read canvas properties of the base level.
+    virtual void read_canvas_properties(
+        CanvasProperties&   props);
+
+    // Read image attributes.
+    virtual void read_image_attributes(
+        ImageAttributes&    attrs);
+
+    // Read a tile of the base level. Returns a newly allocated tile.
+    virtual Tile* read_tile(
+        const size_t        tile_x,
+        const size_t        tile_y);
+
+    // Return the number of MIP levels stored in the file, including the base level.
+    size_t get_level_count() const;
+
+    // Return true if tiles are stored compressed.
+    bool is_compressed() const;
+
+    // Read canvas properties of a given MIP level.
+    void read_canvas_properties(
+        const size_t        level,
+        CanvasProperties&   props);
+
+    // Read a tile of a given MIP level. Returns a newly allocated tile.
+    Tile* read_tile(
+        const size_t        level,
+        const size_t        tile_x,
+        const size_t        tile_y);
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_IMAGE_TEXTUREFILEREADER_H
@@ -0,0 +1,292 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "texturefilewriter.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/icanvas.h"
+#include "foundation/image/image.h"
+#include "foundation/image/texturefileformat.h"
+#include "foundation/image/tile.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/bufferedfile.h"
+
+// lz4 headers.
+#include "lz4.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// TextureFileWriter class implementation.
+//
+
+namespace
+{
+    typedef vector<uint8> Blob;
+
+    template <typename T>
+    void checked_write(BufferedFile& file, const T& object)
+    {
+        if (file.write(object) != sizeof(T))
+            throw ExceptionIOError();
+    }
+
+    void checked_write(BufferedFile& file, const void* inbuf, const size_t size)
+    {
+        if (size > 0 && file.write(inbuf, size) != size)
+            throw ExceptionIOError();
+    }
+
+    // Return the width or height of a given MIP level.
+    size_t get_level_size(const size_t base_size, const size_t level)
+    {
+        return max<size_t>(base_size >> level, 1);
+    }
+
+    // Convert the color channels of a pixel to the linear RGB color space, and back.
+    void to_linear_rgb(const ColorSpace color_space, const size_t channel_count, float pixel[])
+    {
+        if (color_space == ColorSpaceSRGB && channel_count >= 3)
+        {
+            for (size_t c = 0; c < 3; ++c)
+                pixel[c] = srgb_to_linear_rgb(pixel[c]);
+        }
+    }
+
+    void from_linear_rgb(const ColorSpace color_space, const size_t channel_count, float pixel[])
+    {
+        if (color_space == ColorSpaceSRGB && channel_count >= 3)
+        {
+            for (size_t c = 0; c < 3; ++c)
+                pixel[c] = linear_rgb_to_srgb(pixel[c]);
+        }
+    }
+
+    // Downsample a canvas by a factor of two with a box filter.
+    Image* downsample(
+        const ICanvas&          source,
+        const ColorSpace        color_space,
+        const size_t            width,
+        const size_t            height)
+    {
+        const CanvasProperties& props = source.properties();
+
+        Image* image =
+            new Image(
+                width,
+                height,
+                props.m_tile_width,
+                props.m_tile_height,
+                props.m_channel_count,
+                props.m_pixel_format);
+
+        vector<float> texel(props.m_channel_count);
+        vector<float> sum(props.m_channel_count);
+
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                fill(sum.begin(), sum.end(), 0.0f);
+
+                for (size_t j = 0; j < 2; ++j)
+                {
+                    for (size_t i = 0; i < 2; ++i)
+                    {
+                        const size_t sx = min(2 * x + i, props.m_canvas_width - 1);
+                        const size_t sy = min(2 * y + j, props.m_canvas_height - 1);
+
+                        source.get_pixel<float>(sx, sy, &texel[0]);
+                        to_linear_rgb(color_space, props.m_channel_count, &texel[0]);
+
+                        for (size_t c = 0; c < props.m_channel_count; ++c)
+                            sum[c] += texel[c];
+                    }
+                }
+
+                for (size_t c = 0; c < props.m_channel_count; ++c)
+                    sum[c] *= 0.25f;
+
+                from_linear_rgb(color_space, props.m_channel_count, &sum[0]);
+                image->set_pixel<float>(x, y, &sum[0]);
+            }
+        }
+
+        return image;
+    }
+
+    // Store the tiles of a canvas, optionally compressing them.
+    void store_tiles(
+        const ICanvas&          canvas,
+        const bool              compress,
+        vector<Blob>&           blobs)
+    {
+        const CanvasProperties& props = canvas.properties();
+
+        for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+        {
+            for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+            {
+                const Tile& tile = canvas.tile(tx, ty);
+                const uint8* storage = tile.get_storage();
+                const size_t size = tile.get_size();
+
+                blobs.push_back(Blob());
+                Blob& blob = blobs.back();
+
+                if (compress)
+                {
+                    blob.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(size))));
+
+                    const int compressed_size =
+                        LZ4_compress(
+                            reinterpret_cast<const char*>(storage),
+                            reinterpret_cast<char*>(&blob[0]),
+                            static_cast<int>(size));
+
+                    if (compressed_size <= 0)
+                        throw ExceptionIOError("failed to compress texture tile");
+
+                    blob.resize(static_cast<size_t>(compressed_size));
+                }
+                else blob.assign(storage, storage + size);
+            }
+        }
+    }
+}
+
+TextureFileWriter::TextureFileWriter(
+    const char*         filename,
+    const int           options)
+  : m_filename(filename)
+  , m_options(options)
+{
+}
+
+void TextureFileWriter::write(
+    const ICanvas&      canvas,
+    const ColorSpace    color_space)
+{
+    using namespace texture_file_format;
+
+    const CanvasProperties& props = canvas.properties();
+    const bool compress = (m_options & Compress) != 0;
+
+    // Count the MIP levels down to a single pixel.
+    size_t level_count = 1;
+    if (!(m_options & BaseLevelOnly))
+    {
+        while (get_level_size(props.m_canvas_width, level_count - 1) > 1 ||
+               get_level_size(props.m_canvas_height, level_count - 1) > 1)
+            ++level_count;
+    }
+
+    // Store the tiles of all levels.
+    vector<Blob> blobs;
+    store_tiles(canvas, compress, blobs);
+
+    auto_ptr<Image> previous_level;
+    for (size_t level = 1; level < level_count; ++level)
+    {
+        const ICanvas& source = level == 1 ? canvas : *previous_level.get();
+        auto_ptr<Image> current_level(
+            downsample(
+                source,
+                color_space,
+                get_level_size(props.m_canvas_width, level),
+                get_level_size(props.m_canvas_height, level)));
+        store_tiles(*current_level.get(), compress, blobs);
+        previous_level = current_level;
+    }
+
+    // Compute the location of the tiles in the file.
+    vector<TileEntry> entries(blobs.size());
+    uint64 offset = HeaderSize + blobs.size() * sizeof(TileEntry);
+    for (size_t i = 0; i < blobs.size(); ++i)
+    {
+        offset = (offset + DataAlignment - 1) & ~static_cast<uint64>(DataAlignment - 1);
+        entries[i].m_offset = offset;
+        entries[i].m_size = blobs[i].size();
+        offset += entries[i].m_size;
+    }
+
+    BufferedFile file(
+        m_filename.c_str(),
+        BufferedFile::BinaryType,
+        BufferedFile::WriteMode);
+
+    if (!file.is_open())
+        throw ExceptionIOError("failed to open texture file for writing");
+
+    // Write the header.
+    checked_write(file, Signature, sizeof(Signature));
+    checked_write(file, Version);
+    checked_write(file, compress ? FlagCompressed : static_cast<uint16>(0));
+    checked_write(file, static_cast<uint32>(props.m_canvas_width));
+    checked_write(file, static_cast<uint32>(props.m_canvas_height));
+    checked_write(file, static_cast<uint32>(props.m_tile_width));
+    checked_write(file, static_cast<uint32>(props.m_tile_height));
+    checked_write(file, static_cast<uint32>(props.m_channel_count));
+    checked_write(file, static_cast<uint32>(props.m_pixel_format));
+    checked_write(file, static_cast<uint32>(level_count));
+
+    // Write the tile table.
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        checked_write(file, entries[i].m_offset);
+        checked_write(file, entries[i].m_size);
+    }
+
+    // Write the tile data.
+    uint64 position = HeaderSize + entries.size() * sizeof(TileEntry);
+    const uint8 Padding[DataAlignment] = { 0 };
+    for (size_t i = 0; i < blobs.size(); ++i)
+    {
+        checked_write(file, Padding, static_cast<size_t>(entries[i].m_offset - position));
+        checked_write(file, blobs[i].empty() ? 0 : &blobs[i][0], blobs[i].size());
+        position = entries[i].m_offset + entries[i].m_size;
+    }
+
+    file.close();
+}
+
+}   // namespace foundation
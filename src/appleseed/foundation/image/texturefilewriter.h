@@ -0,0 +1,90 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_IMAGE_TEXTUREFILEWRITER_H
+#define APPLESEED_FOUNDATION_IMAGE_TEXTUREFILEWRITER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/colorspace.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <string>
+
+// Forward declarations.
+namespace foundation    { class ICanvas; }
+
+namespace foundation
+{
+
+//
+// Writer for the appleseed texture file format.
+//
+// Texture files store an image as a sequence of tiles for each of its MIP levels,
+// optionally compressed with LZ4. They are designed to be memory-mapped by
+// foundation::TextureFileReader so that tiles can be accessed without decoding.
+//
+// MIP level n + 1 is obtained by box-filtering level n; its width and height are
+// those of level n divided by two, rounded down, and at least one pixel. All levels
+// use the tile dimensions of the base level.
+//
+
+class APPLESEED_DLLSYMBOL TextureFileWriter
+  : public NonCopyable
+{
+  public:
+    enum Options
+    {
+        Defaults        = 0,
+        Compress        = 1 << 0,       // compress tiles with LZ4
+        BaseLevelOnly   = 1 << 1        // don't generate MIP levels
+    };
+
+    // Constructor.
+    explicit TextureFileWriter(
+        const char*         filename,
+        const int           options = Defaults);
+
+    // Write a canvas and its MIP levels to disk. The color space of the canvas is
+    // used to downsample the canvas in linear RGB. Throws a foundation::ExceptionIOError.
+    void write(
+        const ICanvas&      canvas,
+        const ColorSpace    color_space = ColorSpaceLinearRGB);
+
+  private:
+    const std::string       m_filename;
+    const int               m_options;
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_IMAGE_TEXTUREFILEWRITER_H
@@ -30,6 +30,12 @@
 // Interface header.
 #include "tile.h"
 
+// appleseed.foundation headers.
+#include "foundation/utility/memory.h"
+
+// Standard headers.
+#include <new>
+
 using namespace std;
 
 namespace foundation
@@ -39,6 +45,31 @@ namespace foundation
 // Tile class implementation.
 //
 
+namespace
+{
+    // Large tiles, typically whole untiled textures, may be backed by huge pages.
+
+    uint8* allocate_pixel_array(const size_t size)
+    {
+        if (size < HugePageMinAllocationSize)
+            return new uint8[size];
+
+        uint8* pixels = static_cast<uint8*>(huge_page_malloc(size, 16));
+
+        if (pixels == 0)
+            throw bad_alloc();
+
+        return pixels;
+    }
+
+    void deallocate_pixel_array(uint8* pixels, const size_t size)
+    {
+        if (size < HugePageMinAllocationSize)
+            delete [] pixels;
+        else huge_page_free(pixels);
+    }
+}
+
 Tile::Tile(
     const size_t        width,
     const size_t        height,
@@ -65,7 +96,7 @@ Tile::Tile(
     }
     else
     {
-        m_pixel_array = new uint8[m_array_size];
+        m_pixel_array = allocate_pixel_array(m_array_size);
         m_own_storage = true;
     }
 }
@@ -90,7 +121,7 @@ Tile::Tile(
     }
     else
     {
-        m_pixel_array = new uint8[m_array_size];
+        m_pixel_array = allocate_pixel_array(m_array_size);
         m_own_storage = true;
     }
 
@@ -125,7 +156,7 @@ Tile::Tile(
     }
     else
     {
-        m_pixel_array = new uint8[m_array_size];
+        m_pixel_array = allocate_pixel_array(m_array_size);
         m_own_storage = true;
     }
 
@@ -150,7 +181,7 @@ Tile::Tile(const Tile& rhs)
   , m_pixel_size(rhs.m_pixel_size)
   , m_array_size(rhs.m_array_size)
 {
-    m_pixel_array = new uint8[m_array_size];
+    m_pixel_array = allocate_pixel_array(m_array_size);
     m_own_storage = true;
 
     memcpy(m_pixel_array, rhs.m_pixel_array, m_array_size);
@@ -159,7 +190,7 @@ Tile::Tile(const Tile& rhs)
 Tile::~Tile()
 {
     if (m_own_storage)
-        delete [] m_pixel_array;
+        deallocate_pixel_array(m_pixel_array, m_array_size);
 }
 
 void Tile::release()
@@ -0,0 +1,309 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_ALIASTABLE_H
+#define APPLESEED_FOUNDATION_MATH_ALIASTABLE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// Discrete distribution sampled in constant time with Walker's alias method,
+// built with Vose's algorithm. Drop-in replacement for foundation::CDF<>.
+//
+// Contrary to CDF inversion, the mapping from uniform samples to items is not
+// monotonic: the stratification of low discrepancy samples is not preserved.
+//
+// Reference:
+//
+//   Michael D. Vose, A Linear Algorithm for Generating Random Numbers
+//   with a Given Distribution
+//   http://web.eecs.utk.edu/~vose/Publications/random.pdf
+//
+
+template <typename Item, typename Weight>
+class AliasTable
+  : public NonCopyable
+{
+  public:
+    typedef std::pair<Item, Weight> ItemWeightPair;
+
+    // Constructor.
+    AliasTable();
+
+    // Return true if the table is empty.
+    bool empty() const;
+
+    // Return true if the table has at least one item with a positive weight.
+    bool valid() const;
+
+    // Return the sum of the weight of all inserted items.
+    Weight weight() const;
+
+    // Remove all items from the table.
+    void clear();
+
+    // Allocate memory for a given number of items.
+    void reserve(const size_t count);
+
+    // Insert an item with a given non-negative weight.
+    void insert(const Item& item, const Weight weight);
+
+    // Access the i'th item.
+    const ItemWeightPair& operator[](const size_t i) const;
+
+    // Prepare the table for sampling.
+    // This method must be called once and only once before sample() is called.
+    void prepare();
+
+    // Sample the table. x is in [0,1).
+    const ItemWeightPair& sample(const Weight x) const;
+
+    // Write the table to a binary stream, or read it back. Item and Weight must be POD types.
+    // read() returns false if the stream could not be read.
+    void write(std::ostream& output) const;
+    bool read(std::istream& input);
+
+  private:
+    struct Entry
+    {
+        Weight          m_threshold;    // probability of keeping this entry rather than its alias
+        size_t          m_alias;
+    };
+
+    typedef std::vector<ItemWeightPair> ItemVector;
+    typedef std::vector<Entry> EntryVector;
+
+    ItemVector          m_items;
+    Weight              m_weight_sum;
+    EntryVector         m_entries;
+};
+
+
+//
+// AliasTable class implementation.
+//
+
+template <typename Item, typename Weight>
+inline AliasTable<Item, Weight>::AliasTable()
+  : m_weight_sum(0.0)
+{
+}
+
+template <typename Item, typename Weight>
+inline bool AliasTable<Item, Weight>::empty() const
+{
+    return m_items.empty();
+}
+
+template <typename Item, typename Weight>
+inline bool AliasTable<Item, Weight>::valid() const
+{
+    return m_weight_sum > Weight(0.0);
+}
+
+template <typename Item, typename Weight>
+inline Weight AliasTable<Item, Weight>::weight() const
+{
+    return m_weight_sum;
+}
+
+template <typename Item, typename Weight>
+inline void AliasTable<Item, Weight>::clear()
+{
+    m_items.clear();
+    m_weight_sum = Weight(0.0);
+}
+
+template <typename Item, typename Weight>
+inline void AliasTable<Item, Weight>::reserve(const size_t count)
+{
+    m_items.reserve(count);
+}
+
+template <typename Item, typename Weight>
+inline void AliasTable<Item, Weight>::insert(const Item& item, const Weight weight)
+{
+    assert(weight >= Weight(0.0));
+    m_items.push_back(std::make_pair(item, weight));
+    m_weight_sum += weight;
+}
+
+template <typename Item, typename Weight>
+inline const std::pair<Item, Weight>& AliasTable<Item, Weight>::operator[](const size_t i) const
+{
+    assert(i < m_items.size());
+    return m_items[i];
+}
+
+template <typename Item, typename Weight>
+void AliasTable<Item, Weight>::prepare()
+{
+    assert(valid());
+
+    const size_t item_count = m_items.size();
+
+    // Normalize weights so that they add up to 1.0.
+    const Weight rcp_weight_sum = Weight(1.0) / m_weight_sum;
+    for (size_t i = 0; i < item_count; ++i)
+        m_items[i].second *= rcp_weight_sum;
+
+    // Split items into those below and above the average weight. Scaled
+    // weights are kept in double precision to limit the accumulated error.
+    std::vector<double> scaled(item_count);
+    std::vector<size_t> small, large;
+    small.reserve(item_count);
+    large.reserve(item_count);
+    size_t fallback = 0;                // an item with a positive weight
+
+    for (size_t i = 0; i < item_count; ++i)
+    {
+        scaled[i] = static_cast<double>(m_items[i].second) * item_count;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+
+        if (scaled[i] > scaled[fallback])
+            fallback = i;
+    }
+
+    // Pair each underfull entry with an overfull one.
+    m_entries.resize(item_count);
+
+    while (!small.empty() && !large.empty())
+    {
+        const size_t s = small.back();
+        const size_t l = large.back();
+        small.pop_back();
+
+        m_entries[s].m_threshold = static_cast<Weight>(scaled[s]);
+        m_entries[s].m_alias = l;
+        fallback = l;
+
+        scaled[l] -= 1.0 - scaled[s];
+
+        if (scaled[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Remaining entries are full, up to numerical errors.
+    for (size_t i = 0; i < large.size(); ++i)
+    {
+        m_entries[large[i]].m_threshold = Weight(1.0);
+        m_entries[large[i]].m_alias = large[i];
+    }
+
+    for (size_t i = 0; i < small.size(); ++i)
+    {
+        // Never return an item with a null weight.
+        const size_t s = small[i];
+        const bool positive = m_items[s].second > Weight(0.0);
+        m_entries[s].m_threshold = positive ? Weight(1.0) : Weight(0.0);
+        m_entries[s].m_alias = positive ? s : fallback;
+    }
+}
+
+template <typename Item, typename Weight>
+inline const std::pair<Item, Weight>& AliasTable<Item, Weight>::sample(const Weight x) const
+{
+    assert(!m_entries.empty());
+    assert(x >= Weight(0.0));
+    assert(x < Weight(1.0));
+
+    const size_t entry_count = m_entries.size();
+
+    // The integer part of x * n selects an entry, its fractional part selects
+    // between the entry and its alias.
+    const double scaled_x = static_cast<double>(x) * entry_count;
+    size_t i = static_cast<size_t>(scaled_x);
+    if (i >= entry_count)
+        i = entry_count - 1;
+
+    const Entry& entry = m_entries[i];
+    const Weight u = static_cast<Weight>(scaled_x - i);
+
+    return m_items[u < entry.m_threshold ? i : entry.m_alias];
+}
+
+template <typename Item, typename Weight>
+void AliasTable<Item, Weight>::write(std::ostream& output) const
+{
+    const size_t item_count = m_items.size();
+    const size_t entry_count = m_entries.size();
+
+    output.write(reinterpret_cast<const char*>(&item_count), sizeof(item_count));
+    output.write(reinterpret_cast<const char*>(&entry_count), sizeof(entry_count));
+    output.write(reinterpret_cast<const char*>(&m_weight_sum), sizeof(m_weight_sum));
+
+    if (item_count > 0)
+        output.write(reinterpret_cast<const char*>(&m_items[0]), item_count * sizeof(ItemWeightPair));
+
+    if (entry_count > 0)
+        output.write(reinterpret_cast<const char*>(&m_entries[0]), entry_count * sizeof(Entry));
+}
+
+template <typename Item, typename Weight>
+bool AliasTable<Item, Weight>::read(std::istream& input)
+{
+    size_t item_count, entry_count;
+
+    input.read(reinterpret_cast<char*>(&item_count), sizeof(item_count));
+    input.read(reinterpret_cast<char*>(&entry_count), sizeof(entry_count));
+    input.read(reinterpret_cast<char*>(&m_weight_sum), sizeof(m_weight_sum));
+
+    if (!input || (entry_count != 0 && entry_count != item_count))
+        return false;
+
+    m_items.resize(item_count);
+    m_entries.resize(entry_count);
+
+    if (item_count > 0)
+        input.read(reinterpret_cast<char*>(&m_items[0]), item_count * sizeof(ItemWeightPair));
+
+    if (entry_count > 0)
+        input.read(reinterpret_cast<char*>(&m_entries[0]), entry_count * sizeof(Entry));
+
+    return !input.fail();
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_ALIASTABLE_H
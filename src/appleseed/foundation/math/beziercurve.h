@@ -37,6 +37,10 @@
 #include "foundation/math/ray.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+#include "foundation/platform/compiler.h"
 
 // Standard headers.
 #include <algorithm>
@@ -254,6 +258,52 @@ class BezierCurveIntersector
 };
 
 
+//
+// A batch of up to four Bezier curves of the same degree, stored in SoA form.
+//
+// Batches allow to quickly reject all the curves of a curve tree leaf at once:
+// the control points of the four curves are projected into ray space together
+// (using SSE when available) and their bounding boxes are tested against the
+// footprint of the ray. Only the curves that survive this test need to go
+// through the (much more expensive) recursive intersection test.
+//
+
+template <typename BezierCurveType>
+class BezierCurveBatch4
+{
+  public:
+    typedef typename BezierCurveType::ValueType ValueType;
+    typedef typename BezierCurveType::MatrixType MatrixType;
+
+    // Maximum number of curves in a batch.
+    static const size_t Size = 4;
+
+    // Number of control points per curve.
+    static const size_t ControlPointCount = BezierCurveType::Degree + 1;
+
+    // Constructors.
+    BezierCurveBatch4();
+    BezierCurveBatch4(const BezierCurveType curves[], const size_t count);
+
+    size_t get_curve_count() const;
+
+    // Return a bitmask where bit i is set if the bounding box of the i'th curve of the batch,
+    // once transformed by the ray projection transform xfm, overlaps the ray footprint between
+    // the ray origin and the distance max_z. This is the same test as the one performed at the
+    // top of the recursive intersection test in foundation::BezierCurveIntersector.
+    size_t compute_overlap_mask(
+        const MatrixType&       xfm,
+        const ValueType         max_z) const;
+
+  private:
+    APPLESEED_SIMD4_ALIGN ValueType m_x[ControlPointCount][Size];
+    APPLESEED_SIMD4_ALIGN ValueType m_y[ControlPointCount][Size];
+    APPLESEED_SIMD4_ALIGN ValueType m_z[ControlPointCount][Size];
+    APPLESEED_SIMD4_ALIGN ValueType m_half_max_width[Size];
+    size_t                          m_count;
+};
+
+
 //
 // BezierCurveBase class implementation.
 //
@@ -922,6 +972,159 @@ bool BezierCurveIntersector<BezierCurveType>::converge(
     }
 }
 
+
+//
+// BezierCurveBatch4 class implementation.
+//
+
+namespace bezier_impl
+{
+    template <size_t P, typename T>
+    size_t compute_batch_overlap_mask(
+        const T                 x[P][4],
+        const T                 y[P][4],
+        const T                 z[P][4],
+        const T                 half_max_width[4],
+        const Matrix<T, 4, 4>&  xfm,
+        const T                 max_z)
+    {
+        size_t mask = 0;
+
+        for (size_t c = 0; c < 4; ++c)
+        {
+            T min_x = std::numeric_limits<T>::max(), max_x = -std::numeric_limits<T>::max();
+            T min_y = std::numeric_limits<T>::max(), max_y = -std::numeric_limits<T>::max();
+            T min_z = std::numeric_limits<T>::max(), max_z_c = -std::numeric_limits<T>::max();
+
+            for (size_t i = 0; i < P; ++i)
+            {
+                const T rcp_w = T(1.0) / (xfm[12] * x[i][c] + xfm[13] * y[i][c] + xfm[14] * z[i][c] + xfm[15]);
+                const T px = (xfm[ 0] * x[i][c] + xfm[ 1] * y[i][c] + xfm[ 2] * z[i][c] + xfm[ 3]) * rcp_w;
+                const T py = (xfm[ 4] * x[i][c] + xfm[ 5] * y[i][c] + xfm[ 6] * z[i][c] + xfm[ 7]) * rcp_w;
+                const T pz = (xfm[ 8] * x[i][c] + xfm[ 9] * y[i][c] + xfm[10] * z[i][c] + xfm[11]) * rcp_w;
+
+                min_x = std::min(min_x, px); max_x = std::max(max_x, px);
+                min_y = std::min(min_y, py); max_y = std::max(max_y, py);
+                min_z = std::min(min_z, pz); max_z_c = std::max(max_z_c, pz);
+            }
+
+            const T hw = half_max_width[c];
+
+            if (!(min_z > max_z || max_z_c < T(1.0e-6) ||
+                  min_x > hw    || max_x < -hw         ||
+                  min_y > hw    || max_y < -hw))
+                mask |= size_t(1) << c;
+        }
+
+        return mask;
+    }
+
+#ifdef APPLESEED_USE_SSE
+
+    template <size_t P>
+    size_t compute_batch_overlap_mask(
+        const float             x[P][4],
+        const float             y[P][4],
+        const float             z[P][4],
+        const float             half_max_width[4],
+        const Matrix<float, 4, 4>& xfm,
+        const float             max_z)
+    {
+        const __m128 m0  = _mm_set1_ps(xfm[ 0]), m1  = _mm_set1_ps(xfm[ 1]), m2  = _mm_set1_ps(xfm[ 2]), m3  = _mm_set1_ps(xfm[ 3]);
+        const __m128 m4  = _mm_set1_ps(xfm[ 4]), m5  = _mm_set1_ps(xfm[ 5]), m6  = _mm_set1_ps(xfm[ 6]), m7  = _mm_set1_ps(xfm[ 7]);
+        const __m128 m8  = _mm_set1_ps(xfm[ 8]), m9  = _mm_set1_ps(xfm[ 9]), m10 = _mm_set1_ps(xfm[10]), m11 = _mm_set1_ps(xfm[11]);
+        const __m128 m12 = _mm_set1_ps(xfm[12]), m13 = _mm_set1_ps(xfm[13]), m14 = _mm_set1_ps(xfm[14]), m15 = _mm_set1_ps(xfm[15]);
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        __m128 min_x = _mm_set1_ps(+std::numeric_limits<float>::max());
+        __m128 max_x = _mm_set1_ps(-std::numeric_limits<float>::max());
+        __m128 min_y = min_x, max_y = max_x;
+        __m128 min_z = min_x, max_z_c = max_x;
+
+        for (size_t i = 0; i < P; ++i)
+        {
+            const __m128 cx = _mm_load_ps(x[i]);
+            const __m128 cy = _mm_load_ps(y[i]);
+            const __m128 cz = _mm_load_ps(z[i]);
+
+            const __m128 pw = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m12, cx), _mm_mul_ps(m13, cy)), _mm_mul_ps(m14, cz)), m15);
+            const __m128 rcp_w = _mm_div_ps(one, pw);
+
+            const __m128 px = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, cx), _mm_mul_ps(m1, cy)), _mm_mul_ps(m2, cz)), m3), rcp_w);
+            const __m128 py = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m4, cx), _mm_mul_ps(m5, cy)), _mm_mul_ps(m6, cz)), m7), rcp_w);
+            const __m128 pz = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m8, cx), _mm_mul_ps(m9, cy)), _mm_mul_ps(m10, cz)), m11), rcp_w);
+
+            min_x = _mm_min_ps(min_x, px); max_x = _mm_max_ps(max_x, px);
+            min_y = _mm_min_ps(min_y, py); max_y = _mm_max_ps(max_y, py);
+            min_z = _mm_min_ps(min_z, pz); max_z_c = _mm_max_ps(max_z_c, pz);
+        }
+
+        const __m128 hw = _mm_load_ps(half_max_width);
+        const __m128 neg_hw = _mm_sub_ps(_mm_setzero_ps(), hw);
+
+        const __m128 culled =
+            _mm_or_ps(
+                _mm_or_ps(
+                    _mm_or_ps(_mm_cmpgt_ps(min_z, _mm_set1_ps(max_z)), _mm_cmplt_ps(max_z_c, _mm_set1_ps(1.0e-6f))),
+                    _mm_or_ps(_mm_cmpgt_ps(min_x, hw), _mm_cmplt_ps(max_x, neg_hw))),
+                _mm_or_ps(_mm_cmpgt_ps(min_y, hw), _mm_cmplt_ps(max_y, neg_hw)));
+
+        return static_cast<size_t>(~_mm_movemask_ps(culled) & 0xF);
+    }
+
+#endif
+}
+
+template <typename BezierCurveType>
+inline BezierCurveBatch4<BezierCurveType>::BezierCurveBatch4()
+  : m_count(0)
+{
+}
+
+template <typename BezierCurveType>
+BezierCurveBatch4<BezierCurveType>::BezierCurveBatch4(
+    const BezierCurveType   curves[],
+    const size_t            count)
+  : m_count(count)
+{
+    assert(count > 0);
+    assert(count <= Size);
+
+    for (size_t c = 0; c < Size; ++c)
+    {
+        // Unused slots are filled with copies of the last curve; they are masked out anyway.
+        const BezierCurveType& curve = curves[c < count ? c : count - 1];
+
+        for (size_t i = 0; i < ControlPointCount; ++i)
+        {
+            const typename BezierCurveType::VectorType& cp = curve.get_control_point(i);
+            m_x[i][c] = cp.x;
+            m_y[i][c] = cp.y;
+            m_z[i][c] = cp.z;
+        }
+
+        m_half_max_width[c] = ValueType(0.5) * curve.compute_max_width();
+    }
+}
+
+template <typename BezierCurveType>
+inline size_t BezierCurveBatch4<BezierCurveType>::get_curve_count() const
+{
+    return m_count;
+}
+
+template <typename BezierCurveType>
+inline size_t BezierCurveBatch4<BezierCurveType>::compute_overlap_mask(
+    const MatrixType&       xfm,
+    const ValueType         max_z) const
+{
+    const size_t mask =
+        bezier_impl::compute_batch_overlap_mask<ControlPointCount>(
+            m_x, m_y, m_z, m_half_max_width, xfm, max_z);
+
+    return mask & ((size_t(1) << m_count) - 1);
+}
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_MATH_BEZIERCURVE_H
@@ -0,0 +1,300 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "bluenoise.h"
+
+namespace foundation
+{
+
+//
+// 64x64 blue-noise dither mask.
+//
+
+const uint16 BlueNoiseMask[BlueNoiseMaskSize * BlueNoiseMaskSize] =
+{
+     732, 2316,  940, 3422,  559, 2685,  294, 2871, 2397,  151, 1553, 3587,  282, 1857, 3876, 3362,
+    1675, 2807, 3578, 2553,   26,  951, 2888,  306, 1735, 2311, 1097,  686, 1856, 1345, 3980, 2339,
+    1752, 3474, 1424, 3156, 3798, 1268, 3377,  112, 3865, 2377,  495, 2891, 1890,    0, 1422, 2471,
+    3435,  391, 3765, 2224,  530, 1814, 3510, 1203, 3084, 2023,  619, 1176, 2776, 1945, 3387, 2641,
+    1805, 3736, 1318, 2145, 3859, 1141, 1948, 3646, 1010, 4050, 2065,  575, 3181, 1120, 2620,  612,
+    3062,  220, 1218, 2083, 3161, 1568, 3436, 1281, 4093, 2752, 3134, 3579, 2485, 3068,    7, 1179,
+    2870,  652, 2424, 1825,  361, 2206,  639, 2977, 1469,  837, 3252, 4061,  944, 3538, 3081, 2001,
+     721, 1320, 1645, 3029,  948, 2542,   54, 2342, 3920,  297, 3691, 1765, 3207, 1366, 3824,  459,
+    3169,  237, 2864, 1688,  158, 3237, 2309,  584, 1719, 3337, 2592,  877, 3698, 2308,  110, 2057,
+    1035, 4048, 1822,  648, 3814, 2349,  562, 2147,  898,  453, 1999,  226,  909, 1606, 3684, 2186,
+    3292,  252, 4010,  853, 3622, 2764, 1636, 3689, 2566, 2012,  217, 1390, 2264,  634, 2642,  311,
+    4021, 3235, 2694,  249, 3871, 3248, 1512,  649, 1868, 2835,  935, 2534,   14, 2210,  864, 2399,
+    1475, 3557,  615, 2460, 3002,  820, 3521, 1409, 2979,  398, 1311, 2928, 1771, 1402, 2859, 3755,
+    1527, 2401, 3475, 2690,  286, 1116, 2806, 3753, 1634, 3247, 1418, 3924, 2303, 3381,  491,  796,
+    1551, 2692, 2055, 1364, 3080, 1023, 2082,  323, 1189, 3555, 2697, 3370, 1751, 3835, 1129, 1614,
+    2158,  899, 2356, 1858, 1280, 2086, 3665, 2655, 1138, 3547, 1476, 3299,  698, 3486, 2895, 1131,
+    1963, 2656,  990, 4040, 1240, 1823, 2585,   35, 3878, 1984, 2365,  229, 3979,  504, 3399,  715,
+    3217,  385,  881, 1444, 3301, 1754, 3107,  145, 2531, 3609,  747, 2901, 1209, 2658, 1828, 2956,
+    3732,  999, 3404,  489, 2503,   34, 3287, 3852,  666, 1790, 1000,  510, 2418,  192, 3200, 2825,
+    3477,  147, 3750,  606, 2957,  314,  871, 3017,  149, 2236,  454, 1953, 3877, 1574,  273, 3976,
+    3345,  359, 2230, 1540, 3276,  433, 3738, 2171, 1132,  712, 3493, 3061,  975, 2526, 1836, 1193,
+    2660, 1919, 3007, 2266, 3926,  744, 2021, 1335,  402, 2209, 1745,  534, 2084,  117, 4054, 1303,
+    1970,  140, 2345, 1506, 3524, 1873, 1298, 2852, 2196, 3150, 3981, 2949, 1336, 3686, 1883,  549,
+    1232, 1555, 3098, 1020, 2492, 3964, 1659, 3402, 1360, 4035, 3086, 2715,  956, 2130, 2508,  662,
+    1223, 3033, 3620,  180, 2048,  770, 2856, 1592, 3221, 2632, 1681, 1244, 2102, 3580,    4, 2252,
+    3889,  250, 3602, 1255,   57, 2567, 3462, 4022, 2786, 1082, 3049, 3828, 3456,  962, 3240,  415,
+    2522, 3101, 3829,  650, 2720, 4090,  819, 2408,  392, 1525,   62, 2098,  684, 2629,  927, 2336,
+    3893, 2579, 1925, 3550, 1438, 2226,  544, 2010, 2560,  772, 1682, 1197,  120, 3144, 3746, 1711,
+    2318,  847, 1831, 2772, 3821, 2324, 3437,  973,  488, 3937,  138, 3713,  591, 2782, 1545, 3154,
+    1048, 1642,  635, 2077, 2913, 1071,  512, 1612,  799, 3335, 2472,  330, 1377, 2372, 1661, 2827,
+     743, 1228, 1731, 2201, 1107,  197, 1633, 3208, 3695, 1149, 2544, 3788, 1729, 3043, 3549,   93,
+    3215,  765,  413, 2810,   24, 3277, 2904, 1055, 3676,  222, 3434, 2427, 3632, 1399,  448, 2808,
+      43, 3903, 1333,  521, 1045, 1445,  150, 1914, 2996, 1410, 2315, 1842, 3241,  893, 4095,  422,
+    2886, 3369, 2601, 3861, 1775, 3262, 2417, 1950, 3782,   69, 1521, 1982, 2770,  561, 3559, 2054,
+    3922, 3285,  264, 3577, 2899, 3334, 2059,  604, 2707, 1902,  848, 3363,  338, 1087, 1559, 2016,
+    1338, 2211, 4087, 1738,  836, 1278, 3850,  382, 1847, 2969, 2081,  551, 2863, 1937,  800, 3513,
+    2099, 3219, 2504, 3525, 3093, 2673, 4058, 2433, 3539,  763, 2873,  397, 2551, 1441, 2388, 1979,
+     797, 2199, 1355,  339,  831, 3672,  207, 3141, 1153, 2180, 3628,  852, 3993, 3131, 1109,   40,
+    1454, 2361,  982, 1922,  479, 2484, 1329, 3935,  238, 3571, 2896, 1374, 2207, 4027, 2795,  381,
+    3719, 2935, 1078, 2420, 3650, 2089, 2630, 1558, 2389,  883, 3911, 1520, 1038, 4078, 2535, 1496,
+    2855,  656, 1685,  277, 2006,  705, 1714,  430, 1185, 2041, 3350, 1065, 3778,  181, 3447, 1237,
+    3760,  163, 3531, 3015, 1562, 2272, 1308, 2820,  618, 2564, 2999, 1259,  253, 2288, 1619, 3702,
+    2733,  586, 3036, 3978, 1570, 3675,  939, 2283, 1760,  703, 2375,  130, 3193,  578, 2478, 3455,
+     702, 1628,  182, 3395, 2869,  296,  696, 3408, 3075, 1328,  357, 3295, 2233,  172, 3179,  994,
+     236, 4008, 1195, 2383, 3801, 1304, 3174, 3652, 2785,   48, 3997, 1727, 2140, 2963,  660, 2775,
+    1708, 2363, 1031, 1954, 4037,  434, 3451, 1746, 3895,  349, 1638, 3467, 1910,  621, 2611,  888,
+    3393, 2026, 1286, 2586,  758,   51, 2839, 3459, 1173, 3112, 1599, 3678, 1939,  911, 1740, 1243,
+    2331, 3244, 2047,  605, 1460, 1893, 4011, 1099,  157, 3783, 2589, 1829, 2953,  630, 3756, 1888,
+    3540, 2038, 3353,  895, 2975,  132, 2245,  971, 1624, 2410, 1354,  468, 3202,  929, 1930, 3967,
+     528, 3251, 2646,  665, 2853, 1110, 2469,  902, 2064, 3304,  754, 2448, 2892, 3774, 3185, 1863,
+     429, 3825,  177, 3469, 1809, 3132, 2011,  333, 2529, 3891,  464, 1073, 2635, 3834, 2951,   39,
+    3963,  957, 2625, 3817, 1157, 3133, 2295, 2745, 1748, 2176,  773, 3614, 1164, 1648, 2431, 1351,
+     766, 2667,  316, 1543, 2538, 1816, 3425,  594, 3812, 3120,  835, 2683, 3679, 1585, 2500,   68,
+    1391, 3607, 1611,  111, 2138, 3227, 3768,  148, 2742, 1384, 4082,   61,  981, 1433,  223, 1200,
+    2462, 1524, 2919,  924, 2390, 1317, 4028, 1531,  868, 2100, 2933, 3433, 1416,  291, 3323, 1998,
+    1488, 3048,  312, 1716, 3473,   59,  842, 3671,  516, 3442, 1448,    3, 2688, 3382,  446, 3054,
+    2270, 1725, 3148, 3641,  480, 3930, 1089, 2648,  219, 1866, 3542, 2254,  244, 1166, 3368, 2921,
+    2228,  817, 3053, 3836, 1344, 1815,  710, 1584, 3142, 1090, 2237, 1787, 3518, 2152, 3921, 2802,
+    3303,  555, 2142, 3657,  364, 3270,  589, 2753, 3327,   88, 1846,  741, 2430, 2160,  851, 2779,
+     545, 3655, 2213,  750, 2814, 2453, 1544, 2063, 1231, 2832, 2347, 3995,  892, 2085, 3915, 1062,
+      77, 3811,  654, 1258, 2167, 2860, 1467, 2070, 3012, 1142,  536, 1528, 3914, 2111,  616, 3739,
+    1112, 1944,  309, 2284, 3412,  394, 2925, 2330, 3629,  290, 2666, 3256,  527, 2550,  729, 1951,
+    1009, 4059, 1660, 1238, 2693, 1891, 1076, 2297, 3785, 1299, 2663, 4044,  439, 3722, 1610, 3545,
+    1091, 2488, 1359, 4053, 1932,  390, 3832, 3282,  224, 3152,  587, 1926, 3108,  336, 1395, 2841,
+    3343, 1436, 2416, 3001,  876,   17, 3386,  767, 4074, 2382, 3359, 2878,  806, 3149, 1789,  365,
+    2597, 4066, 2816, 1182,  882, 2581, 4009,  993, 1912,  637, 3792, 1536, 1222, 3096, 1686, 3562,
+      13, 2337, 3079,  735, 3846,  115, 3533, 1643,  370, 3056,  965, 1702, 3197, 1183, 2600,  125,
+    1833, 2992,  232, 3213, 1052, 2944, 1324, 2610,  979, 1691, 3730, 1123, 1567, 2617, 3688, 1894,
+    2520,  442, 1991, 3977, 1687, 3616, 2451, 1741,  300, 1381, 1973,  191, 2441, 1277, 2757, 3498,
+    1492,  641, 1694, 3127, 3669, 1987,   37, 1449, 3354, 2966,  914, 2131,  139, 3673,  438, 2978,
+    1429, 2762,  292, 3365, 2066, 2436, 2942,  811, 1986, 3446, 2249,  201, 2881,  626, 2095, 3255,
+    3944,  812, 2155, 1605,  567, 3591, 2220,  677, 4026, 2036, 2501,  411, 3573, 2198,  241,  878,
+    3868, 1102, 3409,  278, 2691, 1213,  520, 3139, 2809, 3763,  974, 3637, 1647, 3998,   29,  916,
+    2323, 3302,  187, 2434,  514, 1579, 3530, 2217,  452, 2505, 1770, 3974, 2712, 2325, 1122, 2071,
+     897, 3727, 1788, 1051, 1502,  506, 1254, 3956, 2584,  640, 1396, 3612, 1882, 3869, 1407,  377,
+    2730, 1256, 3775, 3338, 2676, 1797,  284, 3376, 1477,   63, 2990, 3355,  776, 2874, 1289, 3201,
+    1840, 2885,  722, 1511, 3246, 2285, 3887, 1046, 2149,  644, 2614, 3063,  456, 2166, 3222, 1884,
+    3860, 1291, 2105, 3795,  809, 2766, 3077, 1088, 3744, 1356,  265, 3163,  737, 1489, 3886, 3199,
+    2604,  636, 2275, 4007, 2562, 3636, 3158, 1594,   27, 3769, 2778, 1103, 2473,  859, 3481, 2274,
+    1707,  538, 2513,   22,  919, 3908, 1249, 2868, 2446, 3654,  958, 1401, 1874, 4073,  553, 1578,
+      99, 2346, 3597, 2079,  917,  135, 1917, 1457, 3413,   82, 1830, 1119, 3466,  742, 1202, 2729,
+     289, 3023,  983, 3400, 1901, 1309,  233, 2362,  672, 2909, 3507, 1069, 1985, 3414,  581,  114,
+    1616, 3344,  383, 2903,  841,  251, 1879, 1013, 2341, 3116, 1677,  417, 3275,   71, 2821, 1060,
+    3171, 3653, 1974, 1341, 2352, 3105, 2115,  849, 1824,  368, 2240, 2751,  153, 2396, 3458, 2672,
+    3128, 1188,  507, 4041, 2582, 3032, 3694,  779, 2710, 4025, 2353, 1549, 2867, 2496, 1613, 3645,
+     678, 2569, 1720,   80, 2486, 3872, 3269, 1739, 4046, 1566, 2170, 2565,  188, 2872, 1804, 2358,
+    3803, 1233, 2000, 1443, 3268, 2133, 2739, 3424,  345, 2004,  769, 4085, 2215, 1482, 1943, 3958,
+     243,  788, 2955, 3502, 1692,  622,  199, 3797, 3182, 1184, 3950, 1602, 3066, 1064, 2058,  762,
+    3905, 1958, 3313, 1743, 1342,  395, 2405, 1656,  461, 3176,  875, 3575,  165, 3962,  347, 2203,
+    3308, 1385, 3957, 2876,  547,  945, 2069,  373, 2695,  867,  501, 3644, 1408, 4003, 1143, 3051,
+     923, 2765, 3537,   58, 3856, 1168,  609, 3988, 1369, 3551, 2556, 1239, 2988, 3697,  582, 2400,
+    1597, 2615, 1036,  356, 4070, 2740, 3423, 1462, 2539,  494, 3366,  697, 3605,  455, 3735, 1398,
+     331, 2525,  991,  170, 2813, 3452, 1080, 3281, 1980, 1246, 2141,  598, 1393, 1966, 2993, 1024,
+    1827,  423, 2261, 1186, 3527, 1481, 3013, 3611, 1221, 3320, 1853, 2768,  407, 2244,  671, 3589,
+     242, 2168,  738, 1689, 2386, 2967, 1761, 2512,  918, 2911,  505, 1869,  215,  966, 3374, 1271,
+    3125, 3781, 2184, 1518, 2479, 1155, 1913,  757, 2987, 2108, 1749, 2578, 1252, 2301, 1779, 2854,
+    3439, 1466, 3074, 2255, 3823,  576, 2125, 3925,  280, 2997, 2563, 3752, 3205, 2403,  751, 3818,
+    2792, 3663,  825, 3187, 1972, 2662,  717, 2422,    1, 2208, 3882, 1040, 1722, 3279, 2627, 1928,
+    1510, 4063, 2652, 3168,  960,  410, 3346,  101, 2223, 1582, 3907, 3250, 2628, 1657, 2783,  400,
+    1988,  124, 3405,  683, 3206,   81, 2278, 3569,  295, 1079, 3820,  213, 2929, 3316,   15,  913,
+    2107,  465, 3633,  793, 1908, 1515, 2640,  761, 1426, 3519,   11, 1663, 1135,  447, 3444, 1509,
+     225, 2495, 1668,  113, 4020,  341, 1786, 3802, 1435, 3164,  690, 2972, 3693,   67, 1321, 2998,
+     537, 3332,  288, 1337, 3786, 2091, 1451, 3826, 3065,  293, 1047, 2122,  714, 3495, 2251, 4033,
+     844, 2890, 1190, 1881, 3745, 2796,  954, 3996, 1575, 2432, 3284,  832, 1942, 1497, 4043, 2700,
+    3794, 1673, 2435, 1276, 3232,   95, 3558, 2936, 2393, 1877,  937, 2805, 3874, 1887, 2649, 1205,
+    2049, 3406, 1124, 2965, 2359, 1323, 3230,  972, 1994, 2609,  272, 1546, 2034,  885, 3947, 2423,
+    1074, 1769, 2489, 1968,  597, 3517, 2794,  804, 1849, 3594, 2475, 1428, 3807,   10, 1114, 1461,
+    2514, 1695, 3904, 2329,  509, 1394, 1794, 3147,  638, 2865, 1373, 2231, 3677,  613, 2429, 1199,
+     719, 3008,  221, 2727, 4083,  968, 1718,  335, 1160, 4017, 3159,  658, 2291,  334, 3119, 4077,
+     711, 2844,  470, 1898, 3748,  642, 2716, 3453,  466, 4069, 1288, 2326, 2711, 3379,  425, 2093,
+    3658,  760, 3488, 3018, 1159, 2402,  268, 1267, 2681,  570, 3380,  366, 2937, 1838, 3083, 3592,
+     583, 3258,  194,  980, 3006, 3512,  266, 2541, 2020,   55, 3928,  405, 1137, 3165,  256, 1981,
+    3378, 1105, 3706,  657, 1960, 2328, 3143, 3651, 2161,  458, 2521, 1471, 3553,  995, 1678,   75,
+    2263, 3703, 1591, 3483,  985, 2229,  175, 1679, 2938,  808, 3497, 3106,  580, 1161, 1593, 3129,
+     193, 2736, 1494,   30, 3987, 1700, 3239, 2177, 3961, 1630, 2022, 1083, 2591,  745, 2159,  260,
+    2812, 2025, 3639, 1552, 2644, 2092,  780, 3721, 1210, 3460, 1821, 3038, 2549, 3566, 1580, 2774,
+     416, 1808, 2239, 1431, 2943,  475, 1248, 2680,  866, 1750, 3348,  141, 2015, 2941, 2546, 3321,
+    1414,  846, 2558,  299, 3216, 1523, 3951, 2454, 1192, 2144, 1773,  104, 3913, 1921, 3707, 2621,
+    1314, 3901, 2257,  880, 2850,  541,  987, 3468,   70,  865, 3203, 3873, 1513, 3296, 3984, 1670,
+    1234,  771, 2438,  443, 3946, 1154, 3236, 1641, 2797,  901, 2355, 1452,  687, 2056,  953, 3990,
+    1319, 3095, 2618,  133, 3342, 3741, 1583,   56, 3837, 2946, 1262, 3726,  789, 3955, 1162,  546,
+    3827, 2031, 3028, 1212, 2113, 2875,  786, 3520,  269, 3723, 2552, 1003, 2858, 2232,  271,  915,
+    1864,  568, 3196, 2050, 3563, 2461, 1906, 2939, 1376, 2243, 2824,  164, 2357,  502,  978, 2481,
+    3690, 3184, 1346, 3364, 1835,  129, 2307,  358, 4036,  523, 3347,  228, 3892, 2883,   78, 2464,
+    3692,  791, 3941, 1039, 1757,  718, 2412, 3218, 1965,  625, 2286, 2721, 1604,  305, 2379, 1780,
+    2815,  227, 3536,  679, 3853,   50, 1352, 1904, 3090,  623, 1557, 3317, 1406,  720, 3457, 3071,
+    2376, 3590, 1113, 1595,  303, 1331, 3776,  380, 2533, 3526,  610, 1889, 1180, 3499, 2838,  396,
+    1878,   52, 2148, 2862,  907, 3777, 3031, 1327, 2494, 2027, 1683, 2654, 1225, 1747, 3300, 2174,
+    1603,  348, 1990, 3450, 2759, 2154, 4006, 1058, 1434, 3471,  209, 1026, 3094, 2127, 3509, 3243,
+     932, 1363, 1851, 2444, 1615, 2634, 3339, 2287, 1061, 2755, 3982,  378, 2354, 3804, 1620, 1194,
+     412, 2880,  123, 4091, 2722, 3309,  668, 1732, 4002, 1043, 1608, 3749, 3121, 2073, 1464, 3855,
+    3064,  992, 4084,  588, 1507, 2633, 1915,  617, 3568,  988, 3789, 3021,  823, 3647,  503, 1054,
+    3504, 2968, 2487,  556, 1265,  174, 2994,  387, 2840, 2532, 3940, 1834, 3630,  695, 1305,   23,
+    2659, 4032, 3175,  401, 3608,  949,  566, 3880,  308, 1763, 2116,  872, 2961,   16, 2670, 2132,
+    3858, 1721, 2583, 1995,  826, 2262, 1206, 3157, 2120,  203, 2947, 2406,  830,  255, 2651,  725,
+    2242, 1655, 3491, 2463,  310, 3623, 1042, 3273, 2861,  186, 1405,  436, 2290, 1946, 3103, 2608,
+    1803,    6, 1446, 3848, 3183, 1625,  838, 3599, 1698,  554, 2172, 1358,  420, 2830, 3910, 1697,
+    2164,  734, 2305, 1115, 3004, 2060, 2784, 1486, 2474, 3431, 3136, 1292, 3576, 1872,  608, 3198,
+     931, 3367,  573, 1425, 3485, 2905,   84, 2599,  801, 3391, 1315,  463, 4049, 1736, 3565, 1325,
+     200, 2793, 1207, 2002, 3138, 1764,  102, 2260, 1539, 2103, 3397, 2561, 4075,  142, 1349,  709,
+    2123, 3606,  967, 2340, 1956, 3724, 2467, 2061, 1204, 3375,  886, 3188, 2459, 1977, 1005, 3069,
+     493, 3426, 1564,  239, 3959, 1717,  108, 3554, 1156,  723,  218, 1651, 2457, 1057, 4024, 1485,
+     285, 2333, 1145, 3796,  344, 1800, 3932, 1493, 3638, 1832, 2696, 2053, 3253, 1095, 3037, 2367,
+    3784, 3340,  451,  834, 3857, 1347, 2738, 4015,  815, 3720,  564, 1709, 1130, 3352, 2837, 3927,
+    1167, 3122, 2708,  685,  367, 1117, 3266,  262, 4052, 2605,   83, 3839, 1533,  204, 3603, 2528,
+    1274, 3754, 2912, 2594, 1316, 3297,  839, 2920, 2183, 4076, 2631, 3712,  460, 3298, 2741, 2029,
+    3030, 3627, 2800, 2126, 3115, 1011, 2214,  542, 2991,  276, 3881,  905, 2524,   74, 1918,  519,
+     955, 1508, 2545, 2964, 2219,  607, 3310,  449, 2483, 1217, 2811, 3192,  756, 2189, 1563,  467,
+    2381,  212, 1693, 3989, 2974, 1519, 2737,  728, 1818, 3055, 2276, 1098, 2788, 3274,  784, 2110,
+     315, 1806,  922, 2017,  646, 2294, 3800, 1777,  437, 1550, 3045, 1967,  858, 2234,  154, 1272,
+     759, 1791,   47, 1514,  691, 2555, 3561, 1295, 2425, 1063, 1646,  565, 3503, 1532, 3718, 2900,
+    2119, 4023, 1839,   44, 3661, 1085, 2013, 1573, 3085, 1844,   33, 2366, 3666,  275, 2657, 3407,
+     884, 3779, 1284, 2104, 3454,   60, 2258, 3570, 1322,  342, 1601, 3685,  472, 1862, 1382, 4080,
+    2701, 3293,  160, 3879, 3052,  363, 1198, 2568, 3228, 1016,   65, 1372, 2836, 3918, 1664, 3392,
+    3810, 2613, 1053, 3994, 3358, 1728,  189, 3170, 2019, 3734, 2781, 3123, 2227, 1191, 2664,  777,
+    3190,  317, 1163, 3257, 1632, 2699, 3906,  231, 3484,  890, 3969, 1455, 1938, 1022, 3863, 1871,
+    3242, 2848,  426, 2607,  740, 1850, 3854,  998, 2879, 3324, 2035,  827, 2415, 3511, 2923,  558,
+    1086, 2387, 1417, 3482, 1650, 2734, 3682,  611, 2072, 3902, 2407, 3615,  526, 1094, 2450,  337,
+    2188,  548, 2986, 2313,  403, 2704,  947, 4060,  739,   18, 1312, 1900,  384, 4000,  183, 1730,
+    1348, 2590, 3552, 2373,  418,  855, 2269, 1297, 2598, 2112, 2985,  486, 3464, 3059, 1365,  602,
+    1470, 2008, 3660,  984, 3135, 1371, 2547,  440, 2202,  669, 3884, 2709, 1236,  235, 2181, 1690,
+    3787, 3011,  774, 2194,  996,    8, 1911, 1389, 3463,  302, 1744, 3089, 2114, 3472, 2926,  887,
+    3220, 1598, 3708, 1253, 1860, 3604, 1432, 2882, 1699, 2575, 3260, 3625,  798, 3027, 2394, 3432,
+    3791,  670, 1934, 1017, 2845, 3595, 3189,  706, 3742,  327, 1165, 2735,  781, 2515,  195, 2298,
+    3516,   90, 1723, 2317, 4088,  198, 3389, 1713, 3635, 1450,   25, 1778, 3102, 3938,  862, 3326,
+     106, 1920,  482, 2849, 3949, 2426, 3330, 2973,  869, 2769, 1169,  661, 1530,  136, 1870, 3888,
+    1357, 2043,  127,  794, 3162, 2151,  267, 2327, 3448,  499, 1008, 2319, 1472, 1848, 1084,  485,
+    2139, 2918,  162, 3972, 1412, 1795,   85, 1961, 1487, 3280, 1793, 3704, 2153, 1626, 4038, 2724,
+     753, 3087, 1229,  498, 2817, 1997, 1148, 2723,  863, 2995, 2456, 3440,  529, 1569, 2576, 1330,
+    2343, 3668, 1547, 3229, 1260,  692, 1588,  419, 2178, 3762, 2499, 3307, 3986, 2682, 1216,  600,
+    2571, 3522, 2902, 2482, 3916, 1096,  631, 3813, 1215, 2090, 3725, 2857,  281, 3897, 2703, 3153,
+    1600, 1247, 3291, 2225,  511, 3050, 2559, 4068, 2910,  925, 2445,  107, 1264, 3305,  399, 1139,
+    2137, 2518, 3696, 3341, 1474,  704, 3767, 2302,  352, 3953, 1181, 2117, 1015, 2887, 3618,  371,
+    3117, 1067, 2623,  326, 2106, 3584, 2669, 4013, 1273,   87, 1952,  959,  457, 2310, 3582, 3151,
+     325, 1007, 1724,  474, 1459, 2763, 3271, 1576, 3040,  131, 1766,  674, 3403, 2042,  891,   38,
+    3840,  782, 2674, 1704, 3701,  822, 1230,  304, 2279,  515, 3429, 3943,  647, 2952, 1802, 3780,
+    1504,  324, 1841,  900, 2440, 3025,  247, 3261, 1561, 1899,  579, 3687,  161, 2281, 1774,  663,
+    2075, 3965,  810, 3383, 1658,  146, 1027, 2320, 1776, 3041, 3649, 1421, 2906, 1696,  816, 1924,
+    2265, 4094, 3111, 2096, 3560,   49, 1892, 2491,  805, 2732, 4029, 1419, 2519, 1226, 3619, 1772,
+    2277, 3501,  374, 1077, 2442, 3351, 2062, 3544, 1640, 1133, 2705, 1420, 2046, 2370,  889, 2851,
+     614, 3954, 2746,  167, 3866, 1726, 2087, 1033, 2798, 3420, 2506, 3114, 1400, 4056, 3263, 1245,
+    2842,   46, 1859, 2414, 3728, 2787, 3146,  532, 3438,  828,  389, 2162, 3249,  103, 3805, 1368,
+    2689,  155, 1235,  653, 2443,  977, 3975,  428, 3384, 1146, 2268, 3286,  166, 2950,  595, 2612,
+    1339, 2970, 1992, 3945,  119, 1379, 2984,  699, 3898, 3186, 1935,  301, 3126, 3624,   53, 3401,
+    2007, 1187, 3231, 2238, 1081, 3449,  478, 4034, 1343,   96,  903, 1712, 2686,  340,  936, 2580,
+    3766, 1447, 3078, 1125,  655, 1367, 1936, 3867, 1503, 2437, 2767, 4047, 1002, 2574, 3361,  531,
+    2976, 1652, 3278, 3771, 1560, 2962, 2250, 1380, 3699, 1971,  490,  933, 1733, 2124, 3225, 4086,
+     230,  664, 3417, 1517, 2748,  524, 1813, 2588,   12, 2351,  768, 3793, 1032, 1672, 1306, 2573,
+     920, 3581, 1654,  563, 1430, 2833, 2523,  748, 2338, 3642, 2051, 3816,  708, 2193, 3535, 1933,
+     550, 2200, 3572,  386, 4051, 2157,  274,  952, 2927,  234, 1201, 1807,  569, 1556, 2109, 1101,
+    3900,  824, 2182, 2638,  214, 3410,  682, 1812,  259, 2661, 3020, 3543, 3890,  406, 1505, 1030,
+    1927, 2509,  934, 3118, 2218, 3809, 3465, 1056, 1484, 3585, 1782, 2819, 2498,  543, 4057, 3076,
+    2334,  134, 2636, 3042, 3808,    9, 1639, 3329, 3039, 1538,  496, 2866, 1287, 3082, 1590,  246,
+    3016,  874, 2516, 1762, 2894, 3264, 2602, 3631, 1710, 3238, 2094, 3461, 2960, 3709,  322, 2502,
+    1880, 3528,  431, 1066, 1969, 1275, 3833, 2458, 3209,  814, 1411, 2411, 1152, 2758, 2293, 3523,
+    2922, 3714, 1756,  343, 1211,  787, 2097, 2893,  462, 3058, 1241,  248, 3319, 2221, 1819,  376,
+    1501, 3917, 1947,  821, 2121, 3487, 1029, 1962,  240, 1070, 2246, 3415,  178, 3952, 2530, 1104,
+    3851, 1332, 3394,  159, 1463,  749, 1196, 2267,  593, 3822,  840,   36, 2306, 1307, 2823, 3428,
+     137, 1383, 2804, 4005, 3097,  487, 2822, 1018, 1617, 4014,    2, 1929,  673, 3427,  263,  792,
+    1279,  109, 2314, 4012, 2645, 3223,  169, 1627, 4042, 2191,  633, 3899, 1491,  861, 3729, 2761,
+     574, 1111, 3288,  307, 1326, 2490,  603, 3758, 2756, 4004, 2570, 1665,  950, 1885,  577, 3314,
+    2088, 2717,  675, 2304, 3862, 1854, 3430,  121, 2743, 1427, 2536, 1644, 3870,  928,  601, 1680,
+    2259, 3173,  707, 2391, 1674, 3583, 2030,  179, 3349, 2190, 2915, 3733, 1542, 3124, 2032, 3819,
+    2619, 1534, 3357,  632, 1415, 1896, 3731, 2452,  873, 3396, 2650, 1957, 2940,   72, 1220, 3177,
+    2413, 3643, 1607, 2801, 4067, 3067, 1703, 2216,  379, 1378,  681, 3113, 3700, 2369, 2971, 1437,
+      97, 1796, 3674, 1059, 2668,  427, 2037, 3999,  986, 3019, 3546,  522, 3234, 1916, 3044, 4055,
+    1001, 3634, 1867,   41, 1403,  860, 2687, 3773, 1282,  525,  946, 2679,  355, 2480, 1012, 1715,
+    3026,  445, 2018, 2931, 3601,  320, 1128, 2799, 1387,  128, 1667, 1025, 3610, 2273, 3479, 1978,
+     894, 2930,  450, 2282,  879,  143, 3617, 1140, 3195, 3515, 2033,   42, 1266,  388, 3596,  818,
+    4081, 2924,  473, 1637, 3289, 2948, 1290, 2449, 1753,  319, 2134, 1044, 2364,  156, 2577, 1468,
+     313, 2677, 1177, 3849, 2557, 3233,  328, 1784, 2395, 3070, 1631, 3506, 1261, 4031,   91, 3315,
+     713, 3934, 1108, 2497,  904, 2248, 3140,  535, 2024, 3847, 3166,  354, 2517,  680, 1571,  287,
+    3398, 1799, 3864, 1263, 1975, 2702, 1478, 2447,  829, 1768, 2917, 3909, 2241, 2818, 1705, 2128,
+    2468, 1171, 3494, 2385,    5,  906, 3640,  659, 3210, 3711, 1375, 2803, 3933, 1227, 3489, 2076,
+     676, 3010, 2197, 3371,  596, 2078, 1118, 3390,  731, 3894, 2003,  432, 2321, 1845, 2834, 1334,
+    2296, 1875, 3492,   66, 1706, 3985, 1465, 3480, 2958,  736, 2175, 3747, 1301, 3092, 4030, 2684,
+    1370,   94, 2595,  643, 3556, 3211,  517, 3970,  210, 2665, 1028, 1473,  628, 3388, 1050,  211,
+    3272,  689, 1941, 1362, 3919, 2101, 1548, 2780,  144, 1983,  726, 3336,  372, 1792,  833, 3212,
+    3761, 1653,  254,  964, 2889, 1541, 4079, 2847, 1423,   73, 2616, 3290,  795, 3613,  518, 3764,
+    2647,  318, 1283, 2750, 3322,  724, 2548,  205, 1781, 1174, 2719, 1554,  500, 1909, 1006, 2185,
+     730, 3757, 3088, 1629, 2368,  989, 1811, 3009, 2179, 3743,  444, 3476, 1976, 2606, 3931, 1596,
+    2725, 3790,  298, 2603, 3046,  560, 3372, 2280, 1208, 4071, 2596, 1565, 2271, 3656, 2843,  424,
+    2380, 1251, 3983, 1923, 3529,  206, 2470,  483, 2205, 3667, 1037, 1522, 2982, 1158, 2143, 1587,
+     921, 2989, 3883, 2169,  441, 1996, 1049, 3621, 2312, 4089,   21, 3360, 2831, 3508,  184, 3024,
+    2476, 2052, 1151,  362, 3936,   32, 3416, 1214,  651, 1572, 2360, 3035,  105,  854, 3099,  508,
+    1250, 2222, 3155,  775, 1810, 1134, 3772,  421, 1759, 3005,  477,  976, 3073,   28, 1439, 1959,
+     896, 2749, 3191,  540, 2299, 1041, 3626, 1820,  850, 3014, 1895, 3971,  279, 2706, 3421,  173,
+    3224, 1817,  620, 1480, 3110, 3815, 2877, 1589,  471, 2626, 1021, 2040,  778, 2404, 1701, 3648,
+    1495,  476, 3445, 2789, 2156, 1404, 2728, 1964, 3588, 2907, 1172, 4001, 1755, 1350, 2378, 1903,
+    3681,  963, 1621, 4018, 2760,  208, 2510, 3178,  857, 2421, 3567, 2028, 3842, 1150, 2624, 3912,
+    3441,  126, 1388, 2587, 1669, 3060, 1310, 2653, 3418,  196, 2466,  599, 2300, 1758,  755, 4072,
+    2384, 1178, 3593, 2537,  910,  258, 1269, 3333,  764, 3145, 1684, 3710, 1285, 3973,  353, 1075,
+    2908, 3875, 1855,  746, 3160, 3683,  557, 2419,  176,  845, 2129,  332, 2554, 3759, 3283,  190,
+    2897, 3443,  261, 2150, 1353, 3586, 1905, 1490, 3831,   98, 1386, 2777,  693, 1767, 3226,  590,
+    2247, 1801, 3664,  813, 3885,   19,  645, 3960, 1581, 1126, 3214, 1392, 3598, 3100, 1340, 2045,
+     539, 2791,   31, 3294, 1852, 2392, 2731, 1949, 3923, 2212,  283, 2980,  552, 2146, 2675, 3331,
+     116,  943, 2511, 1302,  257, 1734,  938, 4092, 3245, 1826, 3659, 3167, 1019,  481, 2165,  785,
+    1453, 2439,  624, 3267,  942, 2954,  667, 2204, 1072, 3318, 1865,  369, 3419, 2192,  270, 1526,
+    1004, 2981,  346, 2067, 2773, 3306, 1876, 2256,  350, 2754, 3841, 2080,  926,   86, 2593, 3514,
+    1671, 3806, 2163, 1127, 3991,  585, 3541,   92, 1456, 1136, 3574, 2455, 1483, 3172,  802, 1886,
+    2332, 1635, 3259, 3966, 2074, 2643, 2983, 1499, 1144, 2713,  629, 1479, 2846, 3534, 1175, 4062,
+    1843, 2771, 3843, 1798, 2409,  122, 3992, 2622,  329, 2932, 2348, 4016,  970, 2507, 3717, 2790,
+    4064, 2398, 3373, 1147, 1458, 2428,  961, 3130, 3670,  790, 1783,  414, 2829, 3929, 1068,  321,
+    2945,  803, 1537,  375, 2959, 1676,  930, 2335, 3003,  572, 2747, 1907,   64, 3896, 1224, 3715,
+    3470,  627, 2726,  404, 1106, 3548,  100, 2292,  409, 3830, 2371,   20, 2014, 1649, 2527, 3022,
+      89,  997, 1300,  360, 3490, 1609, 3104, 1313, 3751, 1662,  592, 1242, 3109, 1623,  727, 1296,
+     152, 1586,  688, 3770,  484, 3505,  245, 1361, 2044, 2572, 1294, 3311, 2344, 1535, 1955, 3328,
+    1270, 2493, 3204, 3680, 2289, 1257, 3265, 3716, 1785, 3838,  969, 3325,  733, 1666, 2543,  435,
+    1093, 2005, 1442, 3705, 2374,  783, 3194, 1989, 3496, 1742,  908, 3312, 3948,  716,  351, 3478,
+    2009, 3740, 3137, 2195, 2744, 1121,  513, 2039,  843, 3500, 2698, 2135,  202, 3564, 1993, 3356,
+    3034, 2136, 2714, 1931, 3000, 1618, 4039, 2828,  571, 3532,  168, 3799,  694, 3180,  469, 2235,
+    3968,  118, 1940,  701, 2678,  216, 2068,  492, 2639,  171, 1397, 2173, 2934, 3600, 2118, 3057,
+    4019, 2916,   45, 3047, 1837, 1529, 3939, 1293,  700, 3091, 2671, 1219, 2253, 2914, 1413,  912,
+    2350,  497, 1498,  752, 3942, 1897, 3662, 2477, 3254,   76, 1500, 3844, 2898,  533, 2637,  941,
+     408, 3845, 1034,   79, 2540,  807, 2322, 1861, 1092, 3072, 1622, 2187, 1170, 2718, 3737,  870,
+    1737, 2826, 1100, 3385, 1440, 4065, 2884,  856, 1577, 3411, 2465, 4045,  393, 1014,  185, 1516
+};
+
+}   // namespace foundation
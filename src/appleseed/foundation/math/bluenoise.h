@@ -0,0 +1,91 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BLUENOISE_H
+#define APPLESEED_FOUNDATION_MATH_BLUENOISE_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+
+namespace foundation
+{
+
+//
+// A tileable blue-noise dither mask generated with the void-and-cluster method.
+// Entries are the ranks 0 to BlueNoiseMaskSize^2 - 1; the pixels of rank less
+// than any threshold form a blue-noise point set.
+//
+// References:
+//
+//   Robert Ulichney, The void-and-cluster method for dither array generation
+//   http://cv.ulichney.com/papers/1993-void-cluster.pdf
+//
+//   Iliyan Georgiev and Marcos Fajardo, Blue-noise dithered sampling
+//   https://www.arnoldrenderer.com/research/dither_abstract.pdf
+//
+
+const size_t BlueNoiseMaskSize = 64;
+extern const uint16 BlueNoiseMask[BlueNoiseMaskSize * BlueNoiseMaskSize];
+
+// Return the dither value in [0,1) of a given pixel for a given dimension.
+// Each dimension reads the mask with a different toroidal shift so that the
+// values of distinct dimensions are uncorrelated.
+template <typename T>
+T blue_noise_dither(
+    const size_t    x,
+    const size_t    y,
+    const size_t    dimension);
+
+
+//
+// Implementation.
+//
+
+template <typename T>
+inline T blue_noise_dither(
+    const size_t    x,
+    const size_t    y,
+    const size_t    dimension)
+{
+    // Shift the mask along the R2 sequence, in 32-bit fixed point.
+    const uint32 d = static_cast<uint32>(dimension);
+    const size_t sx = static_cast<size_t>((d * 0xC13FA9A9u) >> 26);
+    const size_t sy = static_cast<size_t>((d * 0x91E10DA5u) >> 26);
+
+    const size_t i = ((y + sy) & (BlueNoiseMaskSize - 1)) * BlueNoiseMaskSize + ((x + sx) & (BlueNoiseMaskSize - 1));
+
+    return (static_cast<T>(BlueNoiseMask[i]) + T(0.5)) * T(1.0 / (BlueNoiseMaskSize * BlueNoiseMaskSize));
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BLUENOISE_H
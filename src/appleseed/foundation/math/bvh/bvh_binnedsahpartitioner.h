@@ -0,0 +1,307 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BVH_BVH_BINNEDSAHPARTITIONER_H
+#define APPLESEED_FOUNDATION_MATH_BVH_BVH_BINNEDSAHPARTITIONER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace foundation {
+namespace bvh {
+
+//
+// A BVH partitioner based on the Surface Area Heuristic (SAH), evaluated over
+// a fixed number of bins per dimension instead of over every possible split.
+//
+// Contrary to SAHPartitioner, items don't need to be sorted: construction is
+// O(n) per level of the tree instead of O(n log n) upfront, at the price of a
+// slightly lower tree quality. All the state used by partition() is local to
+// the range of items it is given, so this partitioner is suitable for parallel
+// builds.
+//
+
+template <typename AABBVector, size_t BinCount = 16>
+class BinnedSAHPartitioner
+  : public NonCopyable
+{
+  public:
+    typedef AABBVector AABBVectorType;
+    typedef typename AABBVectorType::value_type AABBType;
+    typedef typename AABBType::ValueType ValueType;
+
+    // Constructor.
+    BinnedSAHPartitioner(
+        const AABBVectorType&   bboxes,
+        const size_t            max_leaf_size = 1,
+        const ValueType         interior_node_traversal_cost = ValueType(1.0),
+        const ValueType         item_intersection_cost = ValueType(1.0));
+
+    // Compute the bounding box of a given set of items.
+    AABBType compute_bbox(
+        const size_t            begin,
+        const size_t            end) const;
+
+    // Partition a set of items into two distinct sets.
+    size_t partition(
+        const size_t            begin,
+        const size_t            end,
+        const AABBType&         bbox);
+
+    // Return the items ordering.
+    const std::vector<size_t>& get_item_ordering() const;
+
+  private:
+    static const size_t Dimension = AABBType::Dimension;
+
+    const AABBVectorType&       m_bboxes;
+    const size_t                m_max_leaf_size;
+    const ValueType             m_interior_node_traversal_cost;
+    const ValueType             m_item_intersection_cost;
+    std::vector<size_t>         m_indices;
+
+    // Predicate selecting the items whose centroid falls left of a split.
+    struct IsLeftOfSplit
+    {
+        const AABBVectorType&   m_bboxes;
+        const size_t            m_dim;
+        const ValueType         m_min;
+        const ValueType         m_scale;
+        const size_t            m_split_bin;
+
+        IsLeftOfSplit(
+            const AABBVectorType&   bboxes,
+            const size_t            dim,
+            const ValueType         min,
+            const ValueType         scale,
+            const size_t            split_bin)
+          : m_bboxes(bboxes)
+          , m_dim(dim)
+          , m_min(min)
+          , m_scale(scale)
+          , m_split_bin(split_bin)
+        {
+        }
+
+        bool operator()(const size_t index) const
+        {
+            return compute_bin(m_bboxes[index].center(m_dim), m_min, m_scale) <= m_split_bin;
+        }
+    };
+
+    static size_t compute_bin(
+        const ValueType         x,
+        const ValueType         min,
+        const ValueType         scale);
+};
+
+
+//
+// BinnedSAHPartitioner class implementation.
+//
+
+template <typename AABBVector, size_t BinCount>
+BinnedSAHPartitioner<AABBVector, BinCount>::BinnedSAHPartitioner(
+    const AABBVectorType&       bboxes,
+    const size_t                max_leaf_size,
+    const ValueType             interior_node_traversal_cost,
+    const ValueType             item_intersection_cost)
+  : m_bboxes(bboxes)
+  , m_max_leaf_size(max_leaf_size)
+  , m_interior_node_traversal_cost(interior_node_traversal_cost)
+  , m_item_intersection_cost(item_intersection_cost)
+  , m_indices(bboxes.size())
+{
+    for (size_t i = 0, e = m_indices.size(); i < e; ++i)
+        m_indices[i] = i;
+}
+
+template <typename AABBVector, size_t BinCount>
+typename AABBVector::value_type BinnedSAHPartitioner<AABBVector, BinCount>::compute_bbox(
+    const size_t                begin,
+    const size_t                end) const
+{
+    AABBType bbox;
+    bbox.invalidate();
+
+    for (size_t i = begin; i < end; ++i)
+        bbox.insert(m_bboxes[m_indices[i]]);
+
+    return bbox;
+}
+
+template <typename AABBVector, size_t BinCount>
+size_t BinnedSAHPartitioner<AABBVector, BinCount>::partition(
+    const size_t                begin,
+    const size_t                end,
+    const AABBType&             bbox)
+{
+    // Don't split leaves containing only degenerate triangles.
+    if (bbox.rank() < Dimension - 1)
+        return end;
+
+    const size_t count = end - begin;
+    assert(count > 1);
+
+    // Don't split leaves containing less than a predefined number of items.
+    if (count <= m_max_leaf_size)
+        return end;
+
+    // Compute the bounding box of the centroids of the items.
+    AABBType centroid_bbox;
+    centroid_bbox.invalidate();
+    for (size_t i = begin; i < end; ++i)
+        centroid_bbox.insert(m_bboxes[m_indices[i]].center());
+
+    ValueType best_split_cost = std::numeric_limits<ValueType>::max();
+    size_t best_split_dim = Dimension;
+    size_t best_split_bin = 0;
+
+    for (size_t d = 0; d < Dimension; ++d)
+    {
+        const ValueType extent = centroid_bbox.extent(d);
+        if (extent <= ValueType(0.0))
+            continue;
+
+        const ValueType scale = BinCount / extent;
+
+        // Accumulate item bounding boxes into the bins.
+        AABBType bin_bboxes[BinCount];
+        size_t bin_counts[BinCount];
+        for (size_t b = 0; b < BinCount; ++b)
+        {
+            bin_bboxes[b].invalidate();
+            bin_counts[b] = 0;
+        }
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            const AABBType& item_bbox = m_bboxes[m_indices[i]];
+            const size_t b = compute_bin(item_bbox.center(d), centroid_bbox.min[d], scale);
+            bin_bboxes[b].insert(item_bbox);
+            ++bin_counts[b];
+        }
+
+        // Right-to-left sweep to compute the surface area on the right side of each split.
+        ValueType right_areas[BinCount];
+        AABBType bbox_accumulator;
+        bbox_accumulator.invalidate();
+        for (size_t b = BinCount - 1; b > 0; --b)
+        {
+            bbox_accumulator.insert(bin_bboxes[b]);
+            right_areas[b] = bbox_accumulator.is_valid() ? half_surface_area(bbox_accumulator) : ValueType(0.0);
+        }
+
+        // Left-to-right sweep to find the best split.
+        bbox_accumulator.invalidate();
+        size_t left_count = 0;
+        for (size_t b = 0; b < BinCount - 1; ++b)
+        {
+            bbox_accumulator.insert(bin_bboxes[b]);
+            left_count += bin_counts[b];
+
+            // Skip splits leaving one side empty.
+            if (left_count == 0 || left_count == count)
+                continue;
+
+            // Compute the cost of this partition.
+            const ValueType left_cost = half_surface_area(bbox_accumulator) * left_count;
+            const ValueType right_cost = right_areas[b + 1] * (count - left_count);
+            const ValueType split_cost = left_cost + right_cost;
+
+            // Keep track of the partition with the lowest cost.
+            if (best_split_cost > split_cost)
+            {
+                best_split_cost = split_cost;
+                best_split_dim = d;
+                best_split_bin = b;
+            }
+        }
+    }
+
+    // All the centroids coincide: split the items in the middle.
+    if (best_split_dim == Dimension)
+        return begin + count / 2;
+
+    // Don't split if it's cheaper to make a leaf.
+    const ValueType split_cost =
+        m_interior_node_traversal_cost +
+        best_split_cost / half_surface_area(bbox) * m_item_intersection_cost;
+    const ValueType leaf_cost = count * m_item_intersection_cost;
+    if (leaf_cost <= split_cost)
+        return end;
+
+    // Move the items left of the split to the front of the range.
+    const IsLeftOfSplit predicate(
+        m_bboxes,
+        best_split_dim,
+        centroid_bbox.min[best_split_dim],
+        BinCount / centroid_bbox.extent(best_split_dim),
+        best_split_bin);
+    const std::vector<size_t>::iterator it =
+        std::partition(
+            m_indices.begin() + begin,
+            m_indices.begin() + end,
+            predicate);
+
+    const size_t pivot = it - m_indices.begin();
+    assert(pivot > begin);
+    assert(pivot < end);
+
+    return pivot;
+}
+
+template <typename AABBVector, size_t BinCount>
+inline const std::vector<size_t>& BinnedSAHPartitioner<AABBVector, BinCount>::get_item_ordering() const
+{
+    return m_indices;
+}
+
+template <typename AABBVector, size_t BinCount>
+inline size_t BinnedSAHPartitioner<AABBVector, BinCount>::compute_bin(
+    const ValueType             x,
+    const ValueType             min,
+    const ValueType             scale)
+{
+    const ValueType b = (x - min) * scale;
+    return b <= ValueType(0.0) ? 0 : std::min(static_cast<size_t>(b), BinCount - 1);
+}
+
+}       // namespace bvh
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BVH_BVH_BINNEDSAHPARTITIONER_H
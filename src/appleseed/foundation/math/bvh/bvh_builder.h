@@ -32,11 +32,14 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
 #include "foundation/utility/stopwatch.h"
 
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <vector>
 
 namespace foundation {
 namespace bvh {
@@ -65,6 +68,15 @@ namespace bvh {
 //              const AABBType&     bbox);
 //      };
 //
+// When building in parallel, partition() is called concurrently on disjoint
+// ranges of items, all of them spanning at most half of the items. It must
+// therefore only touch state that is local to the range it is given.
+//
+// The parallel build produces exactly the same tree as the serial build,
+// whatever the number of threads: the top of the tree is built serially,
+// independent subtrees are then built concurrently, and the nodes are finally
+// laid out in the order in which the serial build would have created them.
+//
 
 template <typename Tree, typename Partitioner>
 class Builder
@@ -82,23 +94,108 @@ class Builder
         const size_t    size,
         const size_t    items_per_leaf_hint);
 
+    // Build a tree using multiple threads. Subtrees of at most 'subtree_size'
+    // items are built concurrently. A thread count of 1 builds serially.
+    template <typename Timer>
+    void build(
+        Tree&           tree,
+        Partitioner&    partitioner,
+        const size_t    size,
+        const size_t    items_per_leaf_hint,
+        const size_t    thread_count,
+        const size_t    subtree_size = 4096);
+
     // Return the construction time.
     double get_build_time() const;
 
   private:
+    typedef typename Tree::NodeVectorType NodeVectorType;
     typedef typename Tree::NodeType NodeType;
     typedef typename NodeType::AABBType AABBType;
 
+    // A subtree built independently of the rest of the tree.
+    struct Subtree
+    {
+        size_t          m_begin;
+        size_t          m_end;
+        AABBType        m_bbox;
+        NodeVectorType  m_nodes;
+
+        explicit Subtree(const typename Tree::AllocatorType& allocator)
+          : m_nodes(allocator)
+        {
+        }
+    };
+
+    // A job building one subtree.
+    class SubtreeJob
+      : public IJob
+    {
+      public:
+        SubtreeJob(
+            Partitioner&    partitioner,
+            Subtree&        subtree)
+          : m_partitioner(partitioner)
+          , m_subtree(subtree)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            Builder::build_subtree(m_partitioner, m_subtree);
+        }
+
+      private:
+        Partitioner&        m_partitioner;
+        Subtree&            m_subtree;
+    };
+
+    static const size_t NoSubtree = ~size_t(0);
+
     double m_build_time;
 
+    // Reserve memory for the nodes of a tree or subtree of a given size.
+    static void reserve_nodes(
+        NodeVectorType& nodes,
+        const size_t    size,
+        const size_t    items_per_leaf_hint);
+
     // Recursively subdivide the tree.
-    void subdivide_recurse(
-        Tree&           tree,
+    static void subdivide_recurse(
+        NodeVectorType& nodes,
         Partitioner&    partitioner,
         const size_t    node_index,
         const size_t    begin,
         const size_t    end,
         const AABBType& bbox);
+
+    // Recursively subdivide the top of the tree, deferring small enough subtrees.
+    static void subdivide_top_recurse(
+        NodeVectorType&             nodes,
+        std::vector<size_t>&        node_subtrees,
+        std::vector<Subtree*>&      subtrees,
+        Partitioner&                partitioner,
+        const size_t                size,
+        const size_t                subtree_size,
+        const size_t                node_index,
+        const size_t                begin,
+        const size_t                end,
+        const AABBType&             bbox);
+
+    // Build a deferred subtree.
+    static void build_subtree(
+        Partitioner&    partitioner,
+        Subtree&        subtree);
+
+    // Recursively copy the nodes of the top of the tree and of the subtrees,
+    // in the order in which the serial build would have created them.
+    static void relayout_recurse(
+        NodeVectorType&                 dest,
+        const size_t                    dest_index,
+        const NodeVectorType&           src,
+        const size_t                    src_index,
+        const std::vector<size_t>*      src_subtrees,
+        const std::vector<Subtree*>&    subtrees);
 };
 
 
@@ -106,6 +203,9 @@ class Builder
 // Builder class implementation.
 //
 
+template <typename Tree, typename Partitioner>
+const size_t Builder<Tree, Partitioner>::NoSubtree;
+
 template <typename Tree, typename Partitioner>
 Builder<Tree, Partitioner>::Builder()
   : m_build_time(0.0)
@@ -128,9 +228,7 @@ void Builder<Tree, Partitioner>::build(
     tree.m_nodes.clear();
 
     // Reserve memory for the nodes.
-    const size_t leaf_count_guess = size / items_per_leaf_hint;
-    const size_t node_count_guess = leaf_count_guess > 0 ? 2 * leaf_count_guess - 1 : 0;
-    tree.m_nodes.reserve(node_count_guess);
+    reserve_nodes(tree.m_nodes, size, items_per_leaf_hint);
 
     // Create the root node of the tree.
     tree.m_nodes.push_back(NodeType());
@@ -142,7 +240,7 @@ void Builder<Tree, Partitioner>::build(
 
     // Recursively subdivide the tree.
     subdivide_recurse(
-        tree,
+        tree.m_nodes,
         partitioner,
         0,              // node index
         0,              // begin
@@ -154,22 +252,234 @@ void Builder<Tree, Partitioner>::build(
     m_build_time = stopwatch.get_seconds();
 }
 
+template <typename Tree, typename Partitioner>
+template <typename Timer>
+void Builder<Tree, Partitioner>::build(
+    Tree&               tree,
+    Partitioner&        partitioner,
+    const size_t        size,
+    const size_t        items_per_leaf_hint,
+    const size_t        thread_count,
+    const size_t        subtree_size)
+{
+    if (thread_count <= 1 || size <= subtree_size)
+    {
+        build<Timer>(tree, partitioner, size, items_per_leaf_hint);
+        return;
+    }
+
+    // Start stopwatch.
+    Stopwatch<Timer> stopwatch;
+    stopwatch.start();
+
+    // Build the top of the tree, collecting the subtrees to build in parallel.
+    NodeVectorType top_nodes(tree.m_nodes.get_allocator());
+    std::vector<size_t> node_subtrees;
+    std::vector<Subtree*> subtrees;
+    top_nodes.push_back(NodeType());
+    node_subtrees.push_back(NoSubtree);
+    subdivide_top_recurse(
+        top_nodes,
+        node_subtrees,
+        subtrees,
+        partitioner,
+        size,
+        subtree_size,
+        0,              // node index
+        0,              // begin
+        size,           // end
+        partitioner.compute_bbox(0, size));
+
+    // Build the subtrees.
+    {
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(
+            logger,
+            job_queue,
+            thread_count,
+            JobManager::KeepRunningOnEmptyQueue);
+
+        for (size_t i = 0; i < subtrees.size(); ++i)
+        {
+            subtrees[i]->m_nodes.reserve(
+                2 * ((subtrees[i]->m_end - subtrees[i]->m_begin) / items_per_leaf_hint) + 1);
+            job_queue.schedule(new SubtreeJob(partitioner, *subtrees[i]));
+        }
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+    }
+
+    // Lay the nodes out in the final tree.
+    tree.m_nodes.clear();
+    reserve_nodes(tree.m_nodes, size, items_per_leaf_hint);
+    tree.m_nodes.push_back(NodeType());
+    relayout_recurse(tree.m_nodes, 0, top_nodes, 0, &node_subtrees, subtrees);
+
+    for (size_t i = 0; i < subtrees.size(); ++i)
+        delete subtrees[i];
+
+    // Measure and save construction time.
+    stopwatch.measure();
+    m_build_time = stopwatch.get_seconds();
+}
+
 template <typename Tree, typename Partitioner>
 inline double Builder<Tree, Partitioner>::get_build_time() const
 {
     return m_build_time;
 }
 
+template <typename Tree, typename Partitioner>
+void Builder<Tree, Partitioner>::reserve_nodes(
+    NodeVectorType&     nodes,
+    const size_t        size,
+    const size_t        items_per_leaf_hint)
+{
+    const size_t leaf_count_guess = size / items_per_leaf_hint;
+    const size_t node_count_guess = leaf_count_guess > 0 ? 2 * leaf_count_guess - 1 : 0;
+    nodes.reserve(node_count_guess);
+}
+
+template <typename Tree, typename Partitioner>
+void Builder<Tree, Partitioner>::subdivide_top_recurse(
+    NodeVectorType&             nodes,
+    std::vector<size_t>&        node_subtrees,
+    std::vector<Subtree*>&      subtrees,
+    Partitioner&                partitioner,
+    const size_t                size,
+    const size_t                subtree_size,
+    const size_t                node_index,
+    const size_t                begin,
+    const size_t                end,
+    const AABBType&             bbox)
+{
+    assert(node_index < nodes.size());
+
+    // Defer small enough subtrees. The partitioner may keep state spanning
+    // more than half of the items, so larger subtrees are built serially.
+    const size_t count = end - begin;
+    if (count <= subtree_size && 2 * count <= size)
+    {
+        Subtree* subtree = new Subtree(nodes.get_allocator());
+        subtree->m_begin = begin;
+        subtree->m_end = end;
+        subtree->m_bbox = bbox;
+        node_subtrees[node_index] = subtrees.size();
+        subtrees.push_back(subtree);
+        return;
+    }
+
+    // Try to partition the set of items.
+    size_t pivot = end;
+    if (count > 1)
+    {
+        pivot = partitioner.partition(begin, end, typename Partitioner::AABBType(bbox));
+        assert(pivot > begin);
+        assert(pivot <= end);
+    }
+
+    if (pivot == end)
+    {
+        // Turn the current node into a leaf node.
+        NodeType& node = nodes[node_index];
+        node.make_leaf();
+        node.set_item_index(begin);
+        node.set_item_count(count);
+    }
+    else
+    {
+        // Compute the bounding box of the child nodes.
+        const AABBType left_bbox(partitioner.compute_bbox(begin, pivot));
+        const AABBType right_bbox(partitioner.compute_bbox(pivot, end));
+
+        // Compute the indices of the child nodes.
+        const size_t left_node_index = nodes.size();
+        const size_t right_node_index = left_node_index + 1;
+
+        // Turn the current node into an interior node.
+        NodeType& node = nodes[node_index];
+        node.make_interior();
+        node.set_left_bbox(left_bbox);
+        node.set_right_bbox(right_bbox);
+        node.set_child_node_index(left_node_index);
+
+        // Create the child nodes.
+        nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
+        node_subtrees.push_back(NoSubtree);
+        node_subtrees.push_back(NoSubtree);
+
+        // Recurse into the child subtrees.
+        subdivide_top_recurse(
+            nodes, node_subtrees, subtrees, partitioner, size, subtree_size,
+            left_node_index, begin, pivot, left_bbox);
+        subdivide_top_recurse(
+            nodes, node_subtrees, subtrees, partitioner, size, subtree_size,
+            right_node_index, pivot, end, right_bbox);
+    }
+}
+
+template <typename Tree, typename Partitioner>
+void Builder<Tree, Partitioner>::build_subtree(
+    Partitioner&        partitioner,
+    Subtree&            subtree)
+{
+    subtree.m_nodes.push_back(NodeType());
+    subdivide_recurse(
+        subtree.m_nodes,
+        partitioner,
+        0,
+        subtree.m_begin,
+        subtree.m_end,
+        subtree.m_bbox);
+}
+
+template <typename Tree, typename Partitioner>
+void Builder<Tree, Partitioner>::relayout_recurse(
+    NodeVectorType&                 dest,
+    const size_t                    dest_index,
+    const NodeVectorType&           src,
+    const size_t                    src_index,
+    const std::vector<size_t>*      src_subtrees,
+    const std::vector<Subtree*>&    subtrees)
+{
+    if (src_subtrees && (*src_subtrees)[src_index] != NoSubtree)
+    {
+        // Continue with the root node of the subtree.
+        const Subtree& subtree = *subtrees[(*src_subtrees)[src_index]];
+        relayout_recurse(dest, dest_index, subtree.m_nodes, 0, 0, subtrees);
+        return;
+    }
+
+    const NodeType& node = src[src_index];
+    dest[dest_index] = node;
+
+    if (node.is_interior())
+    {
+        const size_t src_child_index = node.get_child_node_index();
+        const size_t dest_child_index = dest.size();
+
+        dest[dest_index].set_child_node_index(dest_child_index);
+        dest.push_back(NodeType());
+        dest.push_back(NodeType());
+
+        relayout_recurse(dest, dest_child_index, src, src_child_index, src_subtrees, subtrees);
+        relayout_recurse(dest, dest_child_index + 1, src, src_child_index + 1, src_subtrees, subtrees);
+    }
+}
+
 template <typename Tree, typename Partitioner>
 void Builder<Tree, Partitioner>::subdivide_recurse(
-    Tree&               tree,
+    NodeVectorType&     nodes,
     Partitioner&        partitioner,
     const size_t        node_index,
     const size_t        begin,
     const size_t        end,
     const AABBType&     bbox)
 {
-    assert(node_index < tree.m_nodes.size());
+    assert(node_index < nodes.size());
 
     // Try to partition the set of items.
     size_t pivot = end;
@@ -183,7 +493,7 @@ void Builder<Tree, Partitioner>::subdivide_recurse(
     if (pivot == end)
     {
         // Turn the current node into a leaf node.
-        NodeType& node = tree.m_nodes[node_index];
+        NodeType& node = nodes[node_index];
         node.make_leaf();
         node.set_item_index(begin);
         node.set_item_count(end - begin);
@@ -195,23 +505,23 @@ void Builder<Tree, Partitioner>::subdivide_recurse(
         const AABBType right_bbox(partitioner.compute_bbox(pivot, end));
 
         // Compute the indices of the child nodes.
-        const size_t left_node_index = tree.m_nodes.size();
+        const size_t left_node_index = nodes.size();
         const size_t right_node_index = left_node_index + 1;
 
         // Turn the current node into an interior node.
-        NodeType& node = tree.m_nodes[node_index];
+        NodeType& node = nodes[node_index];
         node.make_interior();
         node.set_left_bbox(left_bbox);
         node.set_right_bbox(right_bbox);
         node.set_child_node_index(left_node_index);
 
         // Create the child nodes.
-        tree.m_nodes.push_back(NodeType());
-        tree.m_nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
 
         // Recurse into the left subtree.
         subdivide_recurse(
-            tree,
+            nodes,
             partitioner,
             left_node_index,
             begin,
@@ -220,7 +530,7 @@ void Builder<Tree, Partitioner>::subdivide_recurse(
 
         // Recurse into the right subtree.
         subdivide_recurse(
-            tree,
+            nodes,
             partitioner,
             right_node_index,
             pivot,
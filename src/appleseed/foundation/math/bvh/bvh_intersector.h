@@ -201,6 +201,9 @@ void Intersector<Tree, Visitor, Ray, StackSize, N>::intersect_no_motion(
                 const int far_index = tmin[0] < tmin[1] ? 1 : 0;
                 *stack_ptr++ = node_ptr + far_index - 1;
                 node_ptr -= far_index;
+
+                // Start fetching the far child node, it will be needed once the near one is done.
+                APPLESEED_PREFETCH(stack_ptr[-1]);
                 continue;
             }
 
@@ -368,6 +371,9 @@ void Intersector<Tree, Visitor, Ray, StackSize, N>::intersect_motion(
                 const int far_index = tmin[0] < tmin[1] ? 1 : 0;
                 *stack_ptr++ = node_ptr + far_index - 1;
                 node_ptr -= far_index;
+
+                // Start fetching the far child node, it will be needed once the near one is done.
+                APPLESEED_PREFETCH(stack_ptr[-1]);
                 continue;
             }
 
@@ -559,6 +565,9 @@ void Intersector<Tree, Visitor, Ray3d, StackSize, 3>::intersect_no_motion(
                             _mm_shuffle_pd(tmin, tmin, _MM_SHUFFLE2(1, 1))));
                 *stack_ptr++ = node_ptr + far_index - 1;
                 node_ptr -= far_index;
+
+                // Start fetching the far child node, it will be needed once the near one is done.
+                APPLESEED_PREFETCH(stack_ptr[-1]);
                 continue;
             }
 
@@ -833,6 +842,9 @@ void Intersector<Tree, Visitor, Ray3d, StackSize, 3>::intersect_motion(
                             _mm_shuffle_pd(tmin, tmin, _MM_SHUFFLE2(1, 1))));
                 *stack_ptr++ = node_ptr + far_index - 1;
                 node_ptr -= far_index;
+
+                // Start fetching the far child node, it will be needed once the near one is done.
+                APPLESEED_PREFETCH(stack_ptr[-1]);
                 continue;
             }
 
@@ -0,0 +1,408 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BVH_BVH_PACKETINTERSECTOR_H
+#define APPLESEED_FOUNDATION_MATH_BVH_BVH_PACKETINTERSECTOR_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/bvh/bvh_intersector.h"
+#include "foundation/math/bvh/bvh_statistics.h"
+#include "foundation/math/intersection/rayaabb.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace bvh {
+
+//
+// BVH intersector for packets of rays.
+//
+// All the rays of a packet traverse the tree together: each node is fetched once
+// for the whole packet and a bit mask keeps track of the rays that are still
+// active in the subtree being visited. Rays are divided into packets of at most
+// PacketSize rays; PacketSize cannot exceed 64.
+//
+// The Visitor class must conform to the following prototype:
+//
+//      class Visitor
+//        : public foundation::NonCopyable
+//      {
+//        public:
+//          // Return whether BVH traversal should continue or not for this ray.
+//          // 'distance' should be set to the distance to the closest hit so far.
+//          bool visit(
+//              const NodeType&             node,
+//              const size_t                ray_index,
+//              const RayType&              ray,
+//              const RayInfoType&          ray_info,
+//              ValueType&                  distance
+//      #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+//              , TraversalStatistics&      stats
+//      #endif
+//              );
+//      };
+//
+
+template <
+    typename Tree,
+    typename Visitor,
+    typename Ray,
+    size_t PacketSize = 64,
+    size_t StackSize = 64
+>
+class PacketIntersector
+  : public NonCopyable
+{
+  public:
+    typedef typename Tree::NodeType NodeType;
+    typedef typename NodeType::AABBType AABBType;
+    typedef typename AABBType::ValueType ValueType;
+    typedef Ray RayType;
+    typedef RayInfo<ValueType, AABBType::Dimension> RayInfoType;
+
+    // Intersect a stream of rays with a given BVH without motion.
+    void intersect_no_motion(
+        const Tree&             tree,
+        const size_t            ray_count,
+        const RayType*          rays,
+        const RayInfoType*      ray_infos,
+        Visitor&                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , TraversalStatistics&  stats
+#endif
+        ) const;
+
+  private:
+    void intersect_packet(
+        const Tree&             tree,
+        const size_t            first_ray,
+        const size_t            ray_count,
+        const RayType*          rays,
+        const RayInfoType*      ray_infos,
+        Visitor&                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , TraversalStatistics&  stats
+#endif
+        ) const;
+};
+
+
+//
+// PacketIntersector class implementation.
+//
+
+template <
+    typename Tree,
+    typename Visitor,
+    typename Ray,
+    size_t PacketSize,
+    size_t StackSize
+>
+void PacketIntersector<Tree, Visitor, Ray, PacketSize, StackSize>::intersect_no_motion(
+    const Tree&                 tree,
+    const size_t                ray_count,
+    const RayType*              rays,
+    const RayInfoType*          ray_infos,
+    Visitor&                    visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , TraversalStatistics&      stats
+#endif
+    ) const
+{
+    assert(PacketSize > 0 && PacketSize <= 64);
+
+    for (size_t first_ray = 0; first_ray < ray_count; first_ray += PacketSize)
+    {
+        intersect_packet(
+            tree,
+            first_ray,
+            ray_count - first_ray < PacketSize ? ray_count - first_ray : PacketSize,
+            rays,
+            ray_infos,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , stats
+#endif
+            );
+    }
+}
+
+template <
+    typename Tree,
+    typename Visitor,
+    typename Ray,
+    size_t PacketSize,
+    size_t StackSize
+>
+void PacketIntersector<Tree, Visitor, Ray, PacketSize, StackSize>::intersect_packet(
+    const Tree&                 tree,
+    const size_t                first_ray,
+    const size_t                ray_count,
+    const RayType*              rays,
+    const RayInfoType*          ray_infos,
+    Visitor&                    visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , TraversalStatistics&      stats
+#endif
+    ) const
+{
+    // Make sure the tree was built.
+    assert(!tree.m_nodes.empty());
+    assert(ray_count > 0 && ray_count <= PacketSize);
+
+    // Node stack. Each entry records the rays that entered the node, the bounding box
+    // of the node and the number of closest intersection updates when it was pushed.
+    const NodeType* node_stack[StackSize];
+    uint64 mask_stack[StackSize];
+    AABBType bbox_stack[StackSize];
+    size_t update_stack[StackSize];
+    size_t stack_size = 0;
+
+    // Current node and rays entering it.
+    const NodeType* node_ptr = &tree.m_nodes[0];
+    uint64 node_mask = ray_count == 64 ? ~uint64(0) : (uint64(1) << ray_count) - 1;
+
+    // Rays that haven't been terminated by the visitor.
+    uint64 alive_mask = node_mask;
+
+    // Distances to the closest intersections found so far.
+    ValueType ray_tmax[PacketSize];
+    for (size_t i = 0; i < ray_count; ++i)
+        ray_tmax[i] = rays[first_ray + i].m_tmax;
+
+    // Number of times ray_tmax was shortened, and value of this counter when each ray was last shortened.
+    size_t update_count = 0;
+    size_t ray_update[PacketSize];
+    for (size_t i = 0; i < ray_count; ++i)
+        ray_update[i] = 0;
+
+    // Initialize traversal statistics.
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_traversal_count += ray_count);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t visited_nodes = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t visited_leaves = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t intersected_bboxes = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t discarded_nodes = 0);
+
+    // Traverse the tree and intersect leaf nodes.
+    while (true)
+    {
+        // Fetch the node.
+        FOUNDATION_BVH_TRAVERSAL_STATS(++visited_nodes);
+
+        if (node_ptr->is_interior())
+        {
+            const AABBType left_bbox = node_ptr->get_left_bbox();
+            const AABBType right_bbox = node_ptr->get_right_bbox();
+
+            uint64 left_mask = 0;
+            uint64 right_mask = 0;
+            size_t left_first_count = 0;
+            size_t right_first_count = 0;
+
+            // Intersect the bounding boxes of both child nodes with all active rays.
+            for (uint64 m = node_mask; m != 0; m &= m - 1)
+            {
+                const size_t i = static_cast<size_t>(log2_int(m & (~m + 1)));
+                const RayType& ray = rays[first_ray + i];
+                const RayInfoType& ray_info = ray_infos[first_ray + i];
+
+                FOUNDATION_BVH_TRAVERSAL_STATS(intersected_bboxes += 2);
+
+                ValueType tmin_left, tmin_right;
+                const bool hit_left =
+                    foundation::intersect(ray, ray_info, left_bbox, tmin_left) && tmin_left < ray_tmax[i];
+                const bool hit_right =
+                    foundation::intersect(ray, ray_info, right_bbox, tmin_right) && tmin_right < ray_tmax[i];
+
+                const uint64 bit = uint64(1) << i;
+
+                if (hit_left)
+                    left_mask |= bit;
+
+                if (hit_right)
+                    right_mask |= bit;
+
+                if (hit_left && hit_right)
+                {
+                    if (tmin_left < tmin_right)
+                        ++left_first_count;
+                    else ++right_first_count;
+                }
+            }
+
+            const NodeType* child_ptr = &tree.m_nodes[node_ptr->get_child_node_index()];
+
+            if (left_mask != 0 && right_mask != 0)
+            {
+                // Push the far child node to the stack, continue with the near child node.
+                // Near and far are decided by majority among the rays that hit both children.
+                assert(stack_size < StackSize);
+                update_stack[stack_size] = update_count;
+                if (left_first_count >= right_first_count)
+                {
+                    node_stack[stack_size] = child_ptr + 1;
+                    bbox_stack[stack_size] = right_bbox;
+                    mask_stack[stack_size++] = right_mask;
+                    node_ptr = child_ptr;
+                    node_mask = left_mask;
+                }
+                else
+                {
+                    node_stack[stack_size] = child_ptr;
+                    bbox_stack[stack_size] = left_bbox;
+                    mask_stack[stack_size++] = left_mask;
+                    node_ptr = child_ptr + 1;
+                    node_mask = right_mask;
+                }
+                continue;
+            }
+
+            if (left_mask != 0)
+            {
+                // Continue with the left child node.
+                FOUNDATION_BVH_TRAVERSAL_STATS(++discarded_nodes);
+                node_ptr = child_ptr;
+                node_mask = left_mask;
+                continue;
+            }
+
+            if (right_mask != 0)
+            {
+                // Continue with the right child node.
+                FOUNDATION_BVH_TRAVERSAL_STATS(++discarded_nodes);
+                node_ptr = child_ptr + 1;
+                node_mask = right_mask;
+                continue;
+            }
+
+            FOUNDATION_BVH_TRAVERSAL_STATS(discarded_nodes += 2);
+        }
+        else
+        {
+            // Visit the leaf once for every active ray.
+            FOUNDATION_BVH_TRAVERSAL_STATS(++visited_leaves);
+
+            for (uint64 m = node_mask; m != 0; m &= m - 1)
+            {
+                const size_t i = static_cast<size_t>(log2_int(m & (~m + 1)));
+
+                ValueType distance;
+#ifndef NDEBUG
+                distance = ValueType(-1.0);
+#endif
+                const bool proceed =
+                    visitor.visit(
+                        *node_ptr,
+                        first_ray + i,
+                        rays[first_ray + i],
+                        ray_infos[first_ray + i],
+                        distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                        , stats
+#endif
+                        );
+                assert(!proceed || distance >= ValueType(0.0));
+
+                if (proceed)
+                {
+                    // Keep track of the distance to the closest intersection.
+                    if (ray_tmax[i] > distance)
+                    {
+                        ray_tmax[i] = distance;
+                        ray_update[i] = ++update_count;
+                    }
+                }
+                else
+                {
+                    // The visitor decided to terminate traversal for this ray.
+                    alive_mask &= ~(uint64(1) << i);
+                }
+            }
+
+            // Terminate traversal if all rays are done.
+            if (alive_mask == 0)
+                break;
+        }
+
+        // Pop the top node from the stack, skipping nodes whose rays have all been terminated
+        // or have found intersections closer than the node since it was pushed.
+        node_mask = 0;
+        while (stack_size > 0)
+        {
+            --stack_size;
+            node_mask = mask_stack[stack_size] & alive_mask;
+
+            if (update_count > update_stack[stack_size])
+            {
+                for (uint64 m = node_mask; m != 0; m &= m - 1)
+                {
+                    const size_t i = static_cast<size_t>(log2_int(m & (~m + 1)));
+
+                    if (ray_update[i] > update_stack[stack_size])
+                    {
+                        FOUNDATION_BVH_TRAVERSAL_STATS(++intersected_bboxes);
+
+                        ValueType tmin;
+                        if (!foundation::intersect(rays[first_ray + i], ray_infos[first_ray + i], bbox_stack[stack_size], tmin) ||
+                            tmin >= ray_tmax[i])
+                            node_mask &= ~(uint64(1) << i);
+                    }
+                }
+            }
+
+            if (node_mask != 0)
+            {
+                node_ptr = node_stack[stack_size];
+                break;
+            }
+            FOUNDATION_BVH_TRAVERSAL_STATS(++discarded_nodes);
+        }
+
+        // Terminate traversal if the node stack is empty.
+        if (node_mask == 0)
+            break;
+    }
+
+    // Store traversal statistics.
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_visited_nodes.insert(visited_nodes));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_visited_leaves.insert(visited_leaves));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_bboxes.insert(intersected_bboxes));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_discarded_nodes.insert(discarded_nodes));
+}
+
+}       // namespace bvh
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BVH_BVH_PACKETINTERSECTOR_H
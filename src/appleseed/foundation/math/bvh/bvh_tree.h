@@ -76,6 +76,9 @@ class Tree
     template <typename Tree, typename Visitor, typename Ray, size_t StackSize, size_t N>
     friend class Intersector;
 
+    template <typename Tree, typename Visitor, typename Ray, size_t PacketSize, size_t StackSize>
+    friend class PacketIntersector;
+
     typedef typename NodeType::AABBType AABBType;
     typedef std::vector<AABBType> AABBVector;
 
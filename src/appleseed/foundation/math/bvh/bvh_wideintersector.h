@@ -0,0 +1,396 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDEINTERSECTOR_H
+#define APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDEINTERSECTOR_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/bvh/bvh_intersector.h"
+#include "foundation/math/bvh/bvh_statistics.h"
+#include "foundation/math/bvh/bvh_widenode.h"
+#include "foundation/math/intersection/rayaabb.h"
+#include "foundation/math/ray.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace bvh {
+
+//
+// Intersection of a ray with the bounding boxes of all the children of a wide node.
+//
+
+template <typename NodeType, typename RayType, typename RayInfoType>
+struct WideNodeBBoxIntersector
+{
+    typedef typename NodeType::ValueType ValueType;
+
+    const RayType&      m_ray;
+    const RayInfoType&  m_ray_info;
+
+    // Constructor.
+    WideNodeBBoxIntersector(
+        const RayType&      ray,
+        const RayInfoType&  ray_info);
+
+    // Return a bit mask of the children whose bounding box is hit by the ray
+    // before 'ray_tmax'. The entry distances of these children are stored in 'tmin'.
+    size_t intersect(
+        const NodeType&     node,
+        const ValueType     ray_tmax,
+        ValueType           tmin[]) const;
+};
+
+
+//
+// BVH intersector for trees with wide nodes (see foundation::bvh::WideTree).
+//
+// The Visitor class must conform to the prototype described in bvh_intersector.h;
+// it is only ever presented with leaf nodes of the binary tree.
+//
+
+template <
+    typename Tree,
+    typename Visitor,
+    typename Ray,
+    size_t StackSize = 128
+>
+class WideIntersector
+  : public NonCopyable
+{
+  public:
+    typedef typename Tree::NodeType NodeType;
+    typedef typename Tree::WideNodeType WideNodeType;
+    typedef typename WideNodeType::ValueType ValueType;
+    typedef Ray RayType;
+    typedef RayInfo<ValueType, WideNodeType::Dimension> RayInfoType;
+
+    // Intersect a ray with a given BVH without motion.
+    void intersect_no_motion(
+        const Tree&             tree,
+        const RayType&          ray,
+        const RayInfoType&      ray_info,
+        Visitor&                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , TraversalStatistics&  stats
+#endif
+        ) const;
+};
+
+
+//
+// WideNodeBBoxIntersector class implementation.
+//
+
+template <typename NodeType, typename RayType, typename RayInfoType>
+inline WideNodeBBoxIntersector<NodeType, RayType, RayInfoType>::WideNodeBBoxIntersector(
+    const RayType&          ray,
+    const RayInfoType&      ray_info)
+  : m_ray(ray)
+  , m_ray_info(ray_info)
+{
+}
+
+template <typename NodeType, typename RayType, typename RayInfoType>
+inline size_t WideNodeBBoxIntersector<NodeType, RayType, RayInfoType>::intersect(
+    const NodeType&         node,
+    const ValueType         ray_tmax,
+    ValueType               tmin[]) const
+{
+    size_t hits = 0;
+
+    for (size_t i = 0, e = node.get_child_count(); i < e; ++i)
+    {
+        if (foundation::intersect(m_ray, m_ray_info, node.get_child_bbox(i), tmin[i]) && tmin[i] < ray_tmax)
+            hits |= size_t(1) << i;
+    }
+
+    return hits;
+}
+
+#ifdef APPLESEED_USE_SSE
+
+template <typename RayType>
+struct WideNodeBBoxIntersector<WideNode<AABB3d, 4>, RayType, RayInfo3d>
+{
+    typedef WideNode<AABB3d, 4> NodeType;
+
+    __m128d     m_org_x, m_org_y, m_org_z;
+    __m128d     m_rcp_dir_x, m_rcp_dir_y, m_rcp_dir_z;
+    __m128d     m_ray_tmin;
+    size_t      m_near_x, m_near_y, m_near_z;
+    size_t      m_far_x, m_far_y, m_far_z;
+
+    WideNodeBBoxIntersector(
+        const RayType&      ray,
+        const RayInfo3d&    ray_info)
+      : m_org_x(_mm_set1_pd(ray.m_org.x))
+      , m_org_y(_mm_set1_pd(ray.m_org.y))
+      , m_org_z(_mm_set1_pd(ray.m_org.z))
+      , m_rcp_dir_x(_mm_set1_pd(ray_info.m_rcp_dir.x))
+      , m_rcp_dir_y(_mm_set1_pd(ray_info.m_rcp_dir.y))
+      , m_rcp_dir_z(_mm_set1_pd(ray_info.m_rcp_dir.z))
+      , m_ray_tmin(_mm_set1_pd(ray.m_tmin))
+      , m_near_x((0 + 1 - ray_info.m_sgn_dir.x) * 4)
+      , m_near_y((2 + 1 - ray_info.m_sgn_dir.y) * 4)
+      , m_near_z((4 + 1 - ray_info.m_sgn_dir.z) * 4)
+      , m_far_x((0 + ray_info.m_sgn_dir.x) * 4)
+      , m_far_y((2 + ray_info.m_sgn_dir.y) * 4)
+      , m_far_z((4 + ray_info.m_sgn_dir.z) * 4)
+    {
+    }
+
+    size_t intersect(
+        const NodeType&     node,
+        const double        ray_tmax,
+        double              tmin[]) const
+    {
+        const double* bbox_data = node.m_bbox_data;
+        const __m128d mray_tmax = _mm_set1_pd(ray_tmax);
+
+        // Children 0 and 1.
+        const __m128d xl1_lo = _mm_mul_pd(m_rcp_dir_x, _mm_sub_pd(_mm_load_pd(bbox_data + m_near_x), m_org_x));
+        const __m128d xl2_lo = _mm_mul_pd(m_rcp_dir_x, _mm_sub_pd(_mm_load_pd(bbox_data + m_far_x), m_org_x));
+        const __m128d yl1_lo = _mm_mul_pd(m_rcp_dir_y, _mm_sub_pd(_mm_load_pd(bbox_data + m_near_y), m_org_y));
+        const __m128d yl2_lo = _mm_mul_pd(m_rcp_dir_y, _mm_sub_pd(_mm_load_pd(bbox_data + m_far_y), m_org_y));
+        const __m128d zl1_lo = _mm_mul_pd(m_rcp_dir_z, _mm_sub_pd(_mm_load_pd(bbox_data + m_near_z), m_org_z));
+        const __m128d zl2_lo = _mm_mul_pd(m_rcp_dir_z, _mm_sub_pd(_mm_load_pd(bbox_data + m_far_z), m_org_z));
+
+        // Children 2 and 3.
+        const __m128d xl1_hi = _mm_mul_pd(m_rcp_dir_x, _mm_sub_pd(_mm_load_pd(bbox_data + m_near_x + 2), m_org_x));
+        const __m128d xl2_hi = _mm_mul_pd(m_rcp_dir_x, _mm_sub_pd(_mm_load_pd(bbox_data + m_far_x + 2), m_org_x));
+        const __m128d yl1_hi = _mm_mul_pd(m_rcp_dir_y, _mm_sub_pd(_mm_load_pd(bbox_data + m_near_y + 2), m_org_y));
+        const __m128d yl2_hi = _mm_mul_pd(m_rcp_dir_y, _mm_sub_pd(_mm_load_pd(bbox_data + m_far_y + 2), m_org_y));
+        const __m128d zl1_hi = _mm_mul_pd(m_rcp_dir_z, _mm_sub_pd(_mm_load_pd(bbox_data + m_near_z + 2), m_org_z));
+        const __m128d zl2_hi = _mm_mul_pd(m_rcp_dir_z, _mm_sub_pd(_mm_load_pd(bbox_data + m_far_z + 2), m_org_z));
+
+        const __m128d tmin_lo = _mm_max_pd(zl1_lo, _mm_max_pd(yl1_lo, _mm_max_pd(xl1_lo, m_ray_tmin)));
+        const __m128d tmax_lo = _mm_min_pd(zl2_lo, _mm_min_pd(yl2_lo, _mm_min_pd(xl2_lo, mray_tmax)));
+        const __m128d tmin_hi = _mm_max_pd(zl1_hi, _mm_max_pd(yl1_hi, _mm_max_pd(xl1_hi, m_ray_tmin)));
+        const __m128d tmax_hi = _mm_min_pd(zl2_hi, _mm_min_pd(yl2_hi, _mm_min_pd(xl2_hi, mray_tmax)));
+
+        const int misses_lo =
+            _mm_movemask_pd(
+                _mm_or_pd(
+                    _mm_cmpgt_pd(tmin_lo, tmax_lo),
+                    _mm_or_pd(
+                        _mm_cmplt_pd(tmax_lo, m_ray_tmin),
+                        _mm_cmpge_pd(tmin_lo, mray_tmax))));
+
+        const int misses_hi =
+            _mm_movemask_pd(
+                _mm_or_pd(
+                    _mm_cmpgt_pd(tmin_hi, tmax_hi),
+                    _mm_or_pd(
+                        _mm_cmplt_pd(tmax_hi, m_ray_tmin),
+                        _mm_cmpge_pd(tmin_hi, mray_tmax))));
+
+        _mm_store_pd(tmin + 0, tmin_lo);
+        _mm_store_pd(tmin + 2, tmin_hi);
+
+        // Empty child slots have inverted bounding boxes and are always reported as misses.
+        return static_cast<size_t>((misses_lo | (misses_hi << 2)) ^ 15);
+    }
+};
+
+#endif  // APPLESEED_USE_SSE
+
+
+//
+// WideIntersector class implementation.
+//
+
+template <
+    typename Tree,
+    typename Visitor,
+    typename Ray,
+    size_t StackSize
+>
+void WideIntersector<Tree, Visitor, Ray, StackSize>::intersect_no_motion(
+    const Tree&                 tree,
+    const RayType&              ray,
+    const RayInfoType&          ray_info,
+    Visitor&                    visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , TraversalStatistics&      stats
+#endif
+    ) const
+{
+    const size_t Width = WideNodeType::Width;
+
+    // Make sure the tree was built and collapsed.
+    assert(!tree.m_wide_nodes.empty());
+
+    // Node stack. Each entry records the distance at which the ray enters the node
+    // so that nodes can be skipped if a closer hit was found in the meantime.
+    uint32 stack_refs[StackSize];
+    ValueType stack_tmin[StackSize];
+    size_t stack_size = 0;
+
+    // Current node: the root node is always the first wide node.
+    uint32 node_ref = 0;
+
+    // Initialize traversal statistics.
+    FOUNDATION_BVH_TRAVERSAL_STATS(++stats.m_traversal_count);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t visited_nodes = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t visited_leaves = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t intersected_bboxes = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t discarded_nodes = 0);
+
+    const WideNodeBBoxIntersector<WideNodeType, RayType, RayInfoType> bbox_intersector(ray, ray_info);
+
+    // Traverse the tree and intersect leaf nodes.
+    ValueType ray_tmax = ray.m_tmax;
+    while (true)
+    {
+        // Fetch the node.
+        FOUNDATION_BVH_TRAVERSAL_STATS(++visited_nodes);
+
+        if (!WideNodeType::is_leaf_ref(node_ref))
+        {
+            const WideNodeType& node = tree.m_wide_nodes[WideNodeType::get_ref_index(node_ref)];
+
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            const size_t child_count = node.get_child_count();
+            intersected_bboxes += child_count;
+#endif
+
+            // Intersect the bounding boxes of all children at once.
+            APPLESEED_SIMD4_ALIGN ValueType tmin[Width];
+            size_t hits = bbox_intersector.intersect(node, ray_tmax, tmin);
+
+            // Sort the children that were hit from near to far.
+            uint32 hit_refs[Width];
+            ValueType hit_tmin[Width];
+            size_t hit_count = 0;
+
+            for (size_t i = 0; hits != 0; ++i, hits >>= 1)
+            {
+                if (hits & 1)
+                {
+                    size_t j = hit_count++;
+
+                    while (j > 0 && hit_tmin[j - 1] > tmin[i])
+                    {
+                        hit_refs[j] = hit_refs[j - 1];
+                        hit_tmin[j] = hit_tmin[j - 1];
+                        --j;
+                    }
+
+                    hit_refs[j] = node.get_child_ref(i);
+                    hit_tmin[j] = tmin[i];
+                }
+            }
+
+            FOUNDATION_BVH_TRAVERSAL_STATS(discarded_nodes += child_count - hit_count);
+
+            if (hit_count > 0)
+            {
+                // Push the far child nodes to the stack, continue with the nearest child node.
+                assert(stack_size + hit_count - 1 <= StackSize);
+                for (size_t i = hit_count - 1; i > 0; --i)
+                {
+                    // Start fetching the far child node, it will be needed once the nearer ones are done.
+                    const uint32 ref = hit_refs[i];
+                    if (WideNodeType::is_leaf_ref(ref))
+                        APPLESEED_PREFETCH(&tree.m_nodes[WideNodeType::get_ref_index(ref)]);
+                    else APPLESEED_PREFETCH(&tree.m_wide_nodes[WideNodeType::get_ref_index(ref)]);
+
+                    stack_refs[stack_size] = hit_refs[i];
+                    stack_tmin[stack_size] = hit_tmin[i];
+                    ++stack_size;
+                }
+
+                node_ref = hit_refs[0];
+                continue;
+            }
+        }
+        else
+        {
+            // Visit the leaf.
+            FOUNDATION_BVH_TRAVERSAL_STATS(++visited_leaves);
+            ValueType distance;
+#ifndef NDEBUG
+            distance = ValueType(-1.0);
+#endif
+            const bool proceed =
+                visitor.visit(
+                    tree.m_nodes[WideNodeType::get_ref_index(node_ref)],
+                    ray,
+                    ray_info,
+                    distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                    , stats
+#endif
+                    );
+            assert(!proceed || distance >= ValueType(0.0));
+
+            // Terminate traversal if the visitor decided so.
+            if (!proceed)
+                break;
+
+            // Keep track of the distance to the closest intersection.
+            if (ray_tmax > distance)
+                ray_tmax = distance;
+        }
+
+        // Pop the next node that the ray enters before the closest intersection found so far.
+        while (stack_size > 0 && stack_tmin[stack_size - 1] >= ray_tmax)
+        {
+            FOUNDATION_BVH_TRAVERSAL_STATS(++discarded_nodes);
+            --stack_size;
+        }
+
+        // Terminate traversal if the node stack is empty.
+        if (stack_size == 0)
+            break;
+
+        node_ref = stack_refs[--stack_size];
+    }
+
+    // Store traversal statistics.
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_visited_nodes.insert(visited_nodes));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_visited_leaves.insert(visited_leaves));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_bboxes.insert(intersected_bboxes));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_discarded_nodes.insert(discarded_nodes));
+}
+
+}       // namespace bvh
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDEINTERSECTOR_H
@@ -0,0 +1,225 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDENODE_H
+#define APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDENODE_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <limits>
+
+namespace foundation {
+namespace bvh {
+
+//
+// Wide (multi-branching) interior node of a BVH.
+//
+// Wide nodes are obtained by collapsing the interior nodes of a binary BVH
+// (see foundation::bvh::WideTree). Each child of a wide node is either another
+// wide node or a leaf node of the binary BVH.
+//
+// The bounding boxes of the children are stored in structure-of-arrays form
+// so that a single ray can be tested against all of them using SIMD code.
+//
+
+template <typename AABB, size_t W>
+class APPLESEED_ALIGN(64) WideNode
+{
+  public:
+    typedef AABB AABBType;
+    typedef typename AABBType::ValueType ValueType;
+
+    static const size_t Dimension = AABBType::Dimension;
+    static const size_t Width = W;
+
+    // Constructor, leaves all child slots empty.
+    WideNode();
+
+    // Set/get the number of children.
+    void set_child_count(const size_t count);
+    size_t get_child_count() const;
+
+    // Set/get the bounding box of a given child.
+    void set_child_bbox(const size_t child, const AABBType& bbox);
+    AABBType get_child_bbox(const size_t child) const;
+
+    // Make a given child point to a wide interior node.
+    void set_interior_child(const size_t child, const size_t wide_node_index);
+
+    // Make a given child point to a leaf node of the binary tree.
+    void set_leaf_child(const size_t child, const size_t leaf_node_index);
+
+    // Return whether a given child is a leaf node.
+    bool is_leaf_child(const size_t child) const;
+
+    // Return the index of a given child, either in the wide node array
+    // or in the binary node array depending on the type of the child.
+    size_t get_child_index(const size_t child) const;
+
+    // Return the packed (index, type) reference to a given child.
+    uint32 get_child_ref(const size_t child) const;
+
+    // Decode packed child references.
+    static bool is_leaf_ref(const uint32 ref);
+    static size_t get_ref_index(const uint32 ref);
+
+  private:
+    template <typename NodeType, typename RayType, typename RayInfoType>
+    friend struct WideNodeBBoxIntersector;
+
+    static const uint32 LeafBit = 0x80000000UL;
+
+    // Child bounding boxes, stored as (min.x, max.x, min.y, max.y, ...) planes of Width values each.
+    APPLESEED_SIMD4_ALIGN ValueType m_bbox_data[2 * Dimension * Width];
+
+    uint32                          m_child_refs[Width];
+    uint32                          m_child_count;
+};
+
+
+//
+// WideNode class implementation.
+//
+
+template <typename AABB, size_t W>
+WideNode<AABB, W>::WideNode()
+  : m_child_count(0)
+{
+    // Empty slots have inverted bounding boxes that are never hit by any ray.
+    for (size_t i = 0; i < Width; ++i)
+    {
+        for (size_t d = 0; d < Dimension; ++d)
+        {
+            m_bbox_data[(d * 2 + 0) * Width + i] = std::numeric_limits<ValueType>::max();
+            m_bbox_data[(d * 2 + 1) * Width + i] = -std::numeric_limits<ValueType>::max();
+        }
+
+        m_child_refs[i] = 0;
+    }
+}
+
+template <typename AABB, size_t W>
+inline void WideNode<AABB, W>::set_child_count(const size_t count)
+{
+    assert(count <= Width);
+    m_child_count = static_cast<uint32>(count);
+}
+
+template <typename AABB, size_t W>
+inline size_t WideNode<AABB, W>::get_child_count() const
+{
+    return static_cast<size_t>(m_child_count);
+}
+
+template <typename AABB, size_t W>
+inline void WideNode<AABB, W>::set_child_bbox(const size_t child, const AABBType& bbox)
+{
+    assert(child < Width);
+
+    for (size_t d = 0; d < Dimension; ++d)
+    {
+        m_bbox_data[(d * 2 + 0) * Width + child] = bbox.min[d];
+        m_bbox_data[(d * 2 + 1) * Width + child] = bbox.max[d];
+    }
+}
+
+template <typename AABB, size_t W>
+inline AABB WideNode<AABB, W>::get_child_bbox(const size_t child) const
+{
+    assert(child < Width);
+
+    AABBType bbox;
+
+    for (size_t d = 0; d < Dimension; ++d)
+    {
+        bbox.min[d] = m_bbox_data[(d * 2 + 0) * Width + child];
+        bbox.max[d] = m_bbox_data[(d * 2 + 1) * Width + child];
+    }
+
+    return bbox;
+}
+
+template <typename AABB, size_t W>
+inline void WideNode<AABB, W>::set_interior_child(const size_t child, const size_t wide_node_index)
+{
+    assert(child < Width);
+    assert(wide_node_index < LeafBit);
+    m_child_refs[child] = static_cast<uint32>(wide_node_index);
+}
+
+template <typename AABB, size_t W>
+inline void WideNode<AABB, W>::set_leaf_child(const size_t child, const size_t leaf_node_index)
+{
+    assert(child < Width);
+    assert(leaf_node_index < LeafBit);
+    m_child_refs[child] = static_cast<uint32>(leaf_node_index) | LeafBit;
+}
+
+template <typename AABB, size_t W>
+inline bool WideNode<AABB, W>::is_leaf_child(const size_t child) const
+{
+    assert(child < Width);
+    return is_leaf_ref(m_child_refs[child]);
+}
+
+template <typename AABB, size_t W>
+inline size_t WideNode<AABB, W>::get_child_index(const size_t child) const
+{
+    assert(child < Width);
+    return get_ref_index(m_child_refs[child]);
+}
+
+template <typename AABB, size_t W>
+inline uint32 WideNode<AABB, W>::get_child_ref(const size_t child) const
+{
+    assert(child < Width);
+    return m_child_refs[child];
+}
+
+template <typename AABB, size_t W>
+inline bool WideNode<AABB, W>::is_leaf_ref(const uint32 ref)
+{
+    return (ref & LeafBit) != 0;
+}
+
+template <typename AABB, size_t W>
+inline size_t WideNode<AABB, W>::get_ref_index(const uint32 ref)
+{
+    return static_cast<size_t>(ref & ~LeafBit);
+}
+
+}       // namespace bvh
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDENODE_H
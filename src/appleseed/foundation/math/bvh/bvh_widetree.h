@@ -0,0 +1,250 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDETREE_H
+#define APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDETREE_H
+
+// appleseed.foundation headers.
+#include "foundation/math/bvh/bvh_tree.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace bvh {
+
+//
+// Bounding Volume Hierarchy (BVH) that can additionally be traversed through
+// wide (multi-branching) interior nodes.
+//
+// The tree is first built as a regular binary BVH, then collapse() collapses
+// its interior nodes into wide nodes with up to WideNodeType::Width children.
+// Leaf nodes are shared between the binary and the wide representations,
+// so leaf visitors work unchanged with both.
+//
+
+template <typename NodeVector, typename WideNodeVector>
+class WideTree
+  : public Tree<NodeVector>
+{
+  public:
+    typedef Tree<NodeVector> BinaryTreeType;
+    typedef WideTree<NodeVector, WideNodeVector> TreeType;
+    typedef typename BinaryTreeType::NodeType NodeType;
+    typedef typename BinaryTreeType::AllocatorType AllocatorType;
+    typedef WideNodeVector WideNodeVectorType;
+    typedef typename WideNodeVectorType::value_type WideNodeType;
+
+    // Constructor.
+    explicit WideTree(const AllocatorType& allocator = AllocatorType());
+
+    // Clear the tree.
+    void clear();
+
+    // Collapse the binary tree into wide nodes. The binary tree must not change afterward.
+    void collapse();
+
+    // Return true if wide nodes are available for traversal.
+    bool has_wide_nodes() const;
+
+    // Return the number of wide nodes.
+    size_t get_wide_node_count() const;
+
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
+  protected:
+    template <typename Tree, typename Visitor, typename Ray, size_t StackSize>
+    friend class WideIntersector;
+
+    typedef typename NodeType::AABBType AABBType;
+    typedef typename AABBType::ValueType ValueType;
+
+    WideNodeVector  m_wide_nodes;
+
+  private:
+    static ValueType half_surface_area(const AABBType& bbox);
+
+    size_t collapse_recurse(const size_t node_index);
+};
+
+
+//
+// WideTree class implementation.
+//
+
+template <typename NodeVector, typename WideNodeVector>
+WideTree<NodeVector, WideNodeVector>::WideTree(const AllocatorType& allocator)
+  : BinaryTreeType(allocator)
+  , m_wide_nodes(typename WideNodeVectorType::allocator_type(allocator))
+{
+}
+
+template <typename NodeVector, typename WideNodeVector>
+void WideTree<NodeVector, WideNodeVector>::clear()
+{
+    BinaryTreeType::clear();
+    m_wide_nodes.clear();
+}
+
+template <typename NodeVector, typename WideNodeVector>
+void WideTree<NodeVector, WideNodeVector>::collapse()
+{
+    m_wide_nodes.clear();
+
+    // Trees made of a single leaf are traversed through their binary representation.
+    if (this->m_nodes.empty() || this->m_nodes[0].is_leaf())
+        return;
+
+    collapse_recurse(0);
+}
+
+template <typename NodeVector, typename WideNodeVector>
+inline bool WideTree<NodeVector, WideNodeVector>::has_wide_nodes() const
+{
+    return !m_wide_nodes.empty();
+}
+
+template <typename NodeVector, typename WideNodeVector>
+inline size_t WideTree<NodeVector, WideNodeVector>::get_wide_node_count() const
+{
+    return m_wide_nodes.size();
+}
+
+template <typename NodeVector, typename WideNodeVector>
+size_t WideTree<NodeVector, WideNodeVector>::get_memory_size() const
+{
+    return
+          BinaryTreeType::get_memory_size()
+        - sizeof(BinaryTreeType)
+        + sizeof(*this)
+        + m_wide_nodes.capacity() * sizeof(WideNodeType);
+}
+
+template <typename NodeVector, typename WideNodeVector>
+typename WideTree<NodeVector, WideNodeVector>::ValueType
+WideTree<NodeVector, WideNodeVector>::half_surface_area(const AABBType& bbox)
+{
+    if (!bbox.is_valid())
+        return ValueType(0.0);
+
+    const typename AABBType::VectorType e = bbox.extent();
+
+    ValueType area(0.0);
+
+    for (size_t i = 0; i < AABBType::Dimension; ++i)
+    {
+        for (size_t j = i + 1; j < AABBType::Dimension; ++j)
+            area += e[i] * e[j];
+    }
+
+    return area;
+}
+
+template <typename NodeVector, typename WideNodeVector>
+size_t WideTree<NodeVector, WideNodeVector>::collapse_recurse(const size_t node_index)
+{
+    const NodeType& node = this->m_nodes[node_index];
+    assert(node.is_interior());
+
+    // Start with the two children of the binary node.
+    AABBType child_bboxes[WideNodeType::Width];
+    size_t child_indices[WideNodeType::Width];
+    child_bboxes[0] = node.get_left_bbox();
+    child_bboxes[1] = node.get_right_bbox();
+    child_indices[0] = node.get_child_node_index() + 0;
+    child_indices[1] = node.get_child_node_index() + 1;
+    size_t child_count = 2;
+
+    // Repeatedly replace the interior child with the largest surface area by its own children.
+    while (child_count < WideNodeType::Width)
+    {
+        size_t best_child = ~size_t(0);
+        ValueType best_area(-1.0);
+
+        for (size_t i = 0; i < child_count; ++i)
+        {
+            if (this->m_nodes[child_indices[i]].is_interior())
+            {
+                const ValueType area = half_surface_area(child_bboxes[i]);
+                if (best_area < area)
+                {
+                    best_area = area;
+                    best_child = i;
+                }
+            }
+        }
+
+        if (best_child == ~size_t(0))
+            break;
+
+        const NodeType& opened = this->m_nodes[child_indices[best_child]];
+        child_bboxes[best_child] = opened.get_left_bbox();
+        child_bboxes[child_count] = opened.get_right_bbox();
+        child_indices[child_count] = opened.get_child_node_index() + 1;
+        child_indices[best_child] = opened.get_child_node_index() + 0;
+        ++child_count;
+    }
+
+    // Allocate the wide node; it will be filled once its subtrees have been collapsed.
+    const size_t wide_node_index = m_wide_nodes.size();
+    m_wide_nodes.push_back(WideNodeType());
+
+    size_t child_refs[WideNodeType::Width];
+    bool child_is_leaf[WideNodeType::Width];
+
+    for (size_t i = 0; i < child_count; ++i)
+    {
+        child_is_leaf[i] = this->m_nodes[child_indices[i]].is_leaf();
+        child_refs[i] =
+            child_is_leaf[i]
+                ? child_indices[i]
+                : collapse_recurse(child_indices[i]);
+    }
+
+    WideNodeType& wide_node = m_wide_nodes[wide_node_index];
+    wide_node.set_child_count(child_count);
+
+    for (size_t i = 0; i < child_count; ++i)
+    {
+        wide_node.set_child_bbox(i, child_bboxes[i]);
+
+        if (child_is_leaf[i])
+            wide_node.set_leaf_child(i, child_refs[i]);
+        else wide_node.set_interior_child(i, child_refs[i]);
+    }
+
+    return wide_node_index;
+}
+
+}       // namespace bvh
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDETREE_H
@@ -38,6 +38,8 @@
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <istream>
+#include <ostream>
 #include <utility>
 #include <vector>
 
@@ -90,6 +92,11 @@ class CDF
     // Sample the CDF. x is in [0,1).
     const ItemWeightPair& sample(const Weight x) const;
 
+    // Write the CDF to a binary stream, or read it back. Item and Weight must be POD types.
+    // read() returns false if the stream could not be read.
+    void write(std::ostream& output) const;
+    bool read(std::istream& input);
+
   private:
     typedef std::vector<ItemWeightPair> ItemVector;
     typedef std::vector<Weight> DensityVector;
@@ -228,6 +235,47 @@ inline const std::pair<Item, Weight>& CDF<Item, Weight>::sample(const Weight x)
     return m_items[i];
 }
 
+template <typename Item, typename Weight>
+void CDF<Item, Weight>::write(std::ostream& output) const
+{
+    const size_t item_count = m_items.size();
+    const size_t density_count = m_densities.size();
+
+    output.write(reinterpret_cast<const char*>(&item_count), sizeof(item_count));
+    output.write(reinterpret_cast<const char*>(&density_count), sizeof(density_count));
+    output.write(reinterpret_cast<const char*>(&m_weight_sum), sizeof(m_weight_sum));
+
+    if (item_count > 0)
+        output.write(reinterpret_cast<const char*>(&m_items[0]), item_count * sizeof(ItemWeightPair));
+
+    if (density_count > 0)
+        output.write(reinterpret_cast<const char*>(&m_densities[0]), density_count * sizeof(Weight));
+}
+
+template <typename Item, typename Weight>
+bool CDF<Item, Weight>::read(std::istream& input)
+{
+    size_t item_count, density_count;
+
+    input.read(reinterpret_cast<char*>(&item_count), sizeof(item_count));
+    input.read(reinterpret_cast<char*>(&density_count), sizeof(density_count));
+    input.read(reinterpret_cast<char*>(&m_weight_sum), sizeof(m_weight_sum));
+
+    if (!input || (density_count != 0 && density_count != item_count))
+        return false;
+
+    m_items.resize(item_count);
+    m_densities.resize(density_count);
+
+    if (item_count > 0)
+        input.read(reinterpret_cast<char*>(&m_items[0]), item_count * sizeof(ItemWeightPair));
+
+    if (density_count > 0)
+        input.read(reinterpret_cast<char*>(&m_densities[0]), density_count * sizeof(Weight));
+
+    return !input.fail();
+}
+
 
 //
 // Functions implementation.
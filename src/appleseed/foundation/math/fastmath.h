@@ -31,6 +31,7 @@
 #define APPLESEED_FOUNDATION_MATH_FASTMATH_H
 
 // appleseed.foundation headers.
+#include "foundation/math/scalar.h"
 #ifdef APPLESEED_USE_SSE
 #include "foundation/platform/sse.h"
 #endif
@@ -40,6 +41,7 @@
 
 // Standard headers.
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 
 namespace foundation
@@ -122,6 +124,12 @@ namespace foundation
 //   Fast reciprocal square root:
 //     http://www.lomont.org/Math/Papers/2003/InvSqrt.pdf
 //
+//   Fast arc cosine:
+//     Handbook of Mathematical Functions, Abramowitz and Stegun, formula 4.4.45
+//
+//   Fast arc tangent:
+//     Degree 11 odd minimax polynomial over [0, 1], with octant reduction
+//
 
 // Fast approximations of 2^p.
 float fast_pow2(const float p);
@@ -153,6 +161,12 @@ float fast_cos(const float x);
 float fast_cos_full(const float x);
 float fast_cos_full_positive(const float x);    // x >= 0.0f
 
+// Fast arc cosine approximation, x in [-1, 1], absolute error < 7e-5.
+float fast_acos(const float x);
+
+// Fast two-argument arc tangent approximation, absolute error < 3e-6.
+float fast_atan2(const float y, const float x);
+
 // Fast reciprocal approximation.
 float fast_rcp(const float x);
 
@@ -176,6 +190,12 @@ __m128 fast_log(const __m128 x);
 __m128 faster_log(const __m128 x);
 __m128 fast_exp(const __m128 x);
 __m128 faster_exp(const __m128 x);
+__m128 fast_sin(const __m128 x);
+__m128 fast_sin_full(const __m128 x);
+__m128 fast_cos(const __m128 x);
+__m128 fast_cos_full(const __m128 x);
+__m128 fast_acos(const __m128 x);
+__m128 fast_atan2(const __m128 y, const __m128 x);
 #endif
 
 // Vectorized variants of some of the functions above.
@@ -192,6 +212,12 @@ void fast_log(float x[4]);
 void faster_log(float x[4]);
 void fast_exp(float x[4]);
 void faster_exp(float x[4]);
+void fast_sin(float x[4]);
+void fast_sin_full(float x[4]);
+void fast_cos(float x[4]);
+void fast_cos_full(float x[4]);
+void fast_acos(float x[4]);
+void fast_atan2(float y[4], const float x[4]);
 
 
 //
@@ -338,6 +364,38 @@ inline float fast_cos_full_positive(const float x)
     return fast_sin_full_positive(x + HalfPi<float>());
 }
 
+inline float fast_acos(const float x)
+{
+    const float a = x < 0.0f ? -x : x;
+    const float s = a < 1.0f ? std::sqrt(1.0f - a) : 0.0f;
+    const float r = s * (1.5707288f + a * (-0.2121144f + a * (0.0742610f - 0.0187293f * a)));
+    return x < 0.0f ? Pi<float>() - r : r;
+}
+
+inline float fast_atan2(const float y, const float x)
+{
+    const float ax = x < 0.0f ? -x : x;
+    const float ay = y < 0.0f ? -y : y;
+    const float hi = ax > ay ? ax : ay;
+    const float lo = ax > ay ? ay : ax;
+
+    if (hi == 0.0f)
+        return 0.0f;
+
+    // Polynomial approximation of atan() over [0, 1].
+    const float a = lo / hi;
+    const float s = a * a;
+    float r =
+        a * (0.99997726f + s * (-0.33262347f + s * (0.19354346f + s * (-0.11643287f + s * (0.05265332f + s * -0.01172120f)))));
+
+    // Map the result back to the right octant.
+    if (ay > ax) r = HalfPi<float>() - r;
+    if (x < 0.0f) r = Pi<float>() - r;
+    if (y < 0.0f) r = -r;
+
+    return r;
+}
+
 inline float fast_sqrt(const float x)
 {
     assert(x >= 0.0f);
@@ -519,6 +577,100 @@ inline __m128 faster_exp(const __m128 x)
     return faster_pow2(_mm_mul_ps(_mm_set1_ps(1.442695040f), x));
 }
 
+inline __m128 fast_sin(const __m128 x)
+{
+    const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 abs_x = _mm_andnot_ps(sign_mask, x);
+    const __m128 p = _mm_or_ps(_mm_set1_ps(0.22308510060189463f), _mm_and_ps(sign_mask, x));
+
+    const __m128 qpprox =
+        _mm_sub_ps(
+            _mm_mul_ps(_mm_set1_ps(FourOverPi<float>()), x),
+            _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(FourOverPiSquare<float>()), x), abs_x));
+
+    return _mm_mul_ps(qpprox, _mm_add_ps(_mm_set1_ps(0.77633023248007499f), _mm_mul_ps(p, qpprox)));
+}
+
+inline __m128 fast_sin_full(const __m128 x)
+{
+    const __m128i k = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(RcpTwoPi<float>())));
+    const __m128 ltzero = _mm_cmplt_ps(x, _mm_set1_ps(0.0f));
+    const __m128 half = _mm_or_ps(_mm_set1_ps(0.5f), _mm_and_ps(ltzero, _mm_castsi128_ps(_mm_set1_epi32(0x80000000))));
+
+    return
+        fast_sin(
+            _mm_sub_ps(
+                _mm_mul_ps(_mm_add_ps(half, _mm_cvtepi32_ps(k)), _mm_set1_ps(TwoPi<float>())),
+                x));
+}
+
+inline __m128 fast_cos(const __m128 x)
+{
+    const __m128 abs_x = _mm_andnot_ps(_mm_castsi128_ps(_mm_set1_epi32(0x80000000)), x);
+    const __m128 qpprox = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(TwoOverPi<float>()), abs_x));
+
+    return
+        _mm_add_ps(
+            qpprox,
+            _mm_mul_ps(
+                _mm_mul_ps(_mm_set1_ps(0.54641335845679634f), qpprox),
+                _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(qpprox, qpprox))));
+}
+
+inline __m128 fast_cos_full(const __m128 x)
+{
+    return fast_sin_full(_mm_add_ps(x, _mm_set1_ps(HalfPi<float>())));
+}
+
+inline __m128 fast_acos(const __m128 x)
+{
+    const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 a = _mm_andnot_ps(sign_mask, x);
+    const __m128 s = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), a), _mm_setzero_ps()));
+
+    __m128 r = _mm_set1_ps(-0.0187293f);
+    r = _mm_add_ps(_mm_mul_ps(r, a), _mm_set1_ps(0.0742610f));
+    r = _mm_add_ps(_mm_mul_ps(r, a), _mm_set1_ps(-0.2121144f));
+    r = _mm_add_ps(_mm_mul_ps(r, a), _mm_set1_ps(1.5707288f));
+    r = _mm_mul_ps(r, s);
+
+    const __m128 ltzero = _mm_cmplt_ps(x, _mm_setzero_ps());
+    const __m128 flipped = _mm_sub_ps(_mm_set1_ps(Pi<float>()), r);
+
+    return _mm_or_ps(_mm_andnot_ps(ltzero, r), _mm_and_ps(ltzero, flipped));
+}
+
+inline __m128 fast_atan2(const __m128 y, const __m128 x)
+{
+    const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 ax = _mm_andnot_ps(sign_mask, x);
+    const __m128 ay = _mm_andnot_ps(sign_mask, y);
+    const __m128 hi = _mm_max_ps(ax, ay);
+    const __m128 lo = _mm_min_ps(ax, ay);
+
+    // Avoid a division by zero when x = y = 0; the result is then 0.
+    const __m128 hizero = _mm_cmpeq_ps(hi, _mm_setzero_ps());
+    const __m128 a = _mm_div_ps(lo, _mm_or_ps(_mm_andnot_ps(hizero, hi), _mm_and_ps(hizero, _mm_set1_ps(1.0f))));
+
+    // Polynomial approximation of atan() over [0, 1].
+    const __m128 s = _mm_mul_ps(a, a);
+    __m128 r = _mm_set1_ps(-0.01172120f);
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.05265332f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-0.11643287f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.19354346f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-0.33262347f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.99997726f));
+    r = _mm_mul_ps(r, a);
+
+    // Map the result back to the right octant.
+    const __m128 swap = _mm_cmpgt_ps(ay, ax);
+    r = _mm_or_ps(_mm_andnot_ps(swap, r), _mm_and_ps(swap, _mm_sub_ps(_mm_set1_ps(HalfPi<float>()), r)));
+    const __m128 xneg = _mm_cmplt_ps(x, _mm_setzero_ps());
+    r = _mm_or_ps(_mm_andnot_ps(xneg, r), _mm_and_ps(xneg, _mm_sub_ps(_mm_set1_ps(Pi<float>()), r)));
+
+    return _mm_or_ps(r, _mm_and_ps(sign_mask, y));
+}
+
 inline void fast_pow2(float p[4])
 {
     assert(is_aligned(p, 16));
@@ -593,6 +745,43 @@ inline void faster_exp(float x[4])
     _mm_store_ps(x, faster_exp(_mm_load_ps(x)));
 }
 
+inline void fast_sin(float x[4])
+{
+    assert(is_aligned(x, 16));
+    _mm_store_ps(x, fast_sin(_mm_load_ps(x)));
+}
+
+inline void fast_sin_full(float x[4])
+{
+    assert(is_aligned(x, 16));
+    _mm_store_ps(x, fast_sin_full(_mm_load_ps(x)));
+}
+
+inline void fast_cos(float x[4])
+{
+    assert(is_aligned(x, 16));
+    _mm_store_ps(x, fast_cos(_mm_load_ps(x)));
+}
+
+inline void fast_cos_full(float x[4])
+{
+    assert(is_aligned(x, 16));
+    _mm_store_ps(x, fast_cos_full(_mm_load_ps(x)));
+}
+
+inline void fast_acos(float x[4])
+{
+    assert(is_aligned(x, 16));
+    _mm_store_ps(x, fast_acos(_mm_load_ps(x)));
+}
+
+inline void fast_atan2(float y[4], const float x[4])
+{
+    assert(is_aligned(y, 16));
+    assert(is_aligned(x, 16));
+    _mm_store_ps(y, fast_atan2(_mm_load_ps(y), _mm_load_ps(x)));
+}
+
 #else
 
 inline void fast_pow2(float p[4])
@@ -667,6 +856,42 @@ inline void faster_exp(float x[4])
         x[i] = faster_exp(x[i]);
 }
 
+inline void fast_sin(float x[4])
+{
+    for (size_t i = 0; i < 4; ++i)
+        x[i] = fast_sin(x[i]);
+}
+
+inline void fast_sin_full(float x[4])
+{
+    for (size_t i = 0; i < 4; ++i)
+        x[i] = fast_sin_full(x[i]);
+}
+
+inline void fast_cos(float x[4])
+{
+    for (size_t i = 0; i < 4; ++i)
+        x[i] = fast_cos(x[i]);
+}
+
+inline void fast_cos_full(float x[4])
+{
+    for (size_t i = 0; i < 4; ++i)
+        x[i] = fast_cos_full(x[i]);
+}
+
+inline void fast_acos(float x[4])
+{
+    for (size_t i = 0; i < 4; ++i)
+        x[i] = fast_acos(x[i]);
+}
+
+inline void fast_atan2(float y[4], const float x[4])
+{
+    for (size_t i = 0; i < 4; ++i)
+        y[i] = fast_atan2(y[i], x[i]);
+}
+
 #endif  // APPLESEED_USE_SSE
 
 }       // namespace foundation
@@ -32,8 +32,10 @@
 
 // Interface headers.
 #include "foundation/math/knn/knn_answer.h"
+#include "foundation/math/knn/knn_batchquery.h"
 #include "foundation/math/knn/knn_builder.h"
 #include "foundation/math/knn/knn_query.h"
+#include "foundation/math/knn/knn_rangequery.h"
 #include "foundation/math/knn/knn_statistics.h"
 #include "foundation/math/knn/knn_tree.h"
 
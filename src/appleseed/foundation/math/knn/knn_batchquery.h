@@ -0,0 +1,296 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_KNN_KNN_BATCHQUERY_H
+#define APPLESEED_FOUNDATION_MATH_KNN_KNN_BATCHQUERY_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/knn/knn_answer.h"
+#include "foundation/math/knn/knn_query.h"
+#include "foundation/math/knn/knn_tree.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace foundation {
+namespace knn {
+
+//
+// Run a large number of independent k-nn queries in parallel.
+//
+// Queries are first sorted along a Morton curve so that consecutive queries,
+// which are processed by the same thread, visit the same parts of the tree.
+// The answer of each query is stored in a flat array and can be retrieved
+// once run() returns.
+//
+
+template <typename T, size_t N>
+class BatchQuery
+  : public NonCopyable
+{
+  public:
+    typedef T ValueType;
+    static const size_t Dimension = N;
+
+    typedef Vector<T, N> VectorType;
+    typedef Tree<T, N> TreeType;
+    typedef typename Answer<T>::Entry EntryType;
+
+    BatchQuery(
+        const TreeType&     tree,
+        const size_t        answer_size);
+
+    // Run one query per point.
+    void run(
+        const VectorType    query_points[],
+        const size_t        query_count,
+        const size_t        thread_count);
+
+    // Run one query per point, limiting the search to a given distance.
+    void run(
+        const VectorType    query_points[],
+        const size_t        query_count,
+        const ValueType     query_max_square_distance,
+        const size_t        thread_count);
+
+    // Return the number of neighbors found by a given query.
+    size_t get_answer_size(const size_t query_index) const;
+
+    // Return the i'th neighbor found by a given query, in no particular order.
+    const EntryType& get_answer_entry(
+        const size_t        query_index,
+        const size_t        i) const;
+
+  private:
+    class QueryJob;
+
+    const TreeType&         m_tree;
+    const size_t            m_answer_size;
+    std::vector<EntryType>  m_entries;
+    std::vector<size_t>     m_answer_sizes;
+};
+
+typedef BatchQuery<float, 2>  BatchQuery2f;
+typedef BatchQuery<double, 2> BatchQuery2d;
+typedef BatchQuery<float, 3>  BatchQuery3f;
+typedef BatchQuery<double, 3> BatchQuery3d;
+
+
+//
+// Implementation.
+//
+
+template <typename T, size_t N>
+class BatchQuery<T, N>::QueryJob
+  : public IJob
+{
+  public:
+    QueryJob(
+        const TreeType&                             tree,
+        const size_t                                answer_size,
+        const VectorType*                           query_points,
+        const std::pair<uint64, size_t>*            begin,
+        const std::pair<uint64, size_t>*            end,
+        const ValueType                             query_max_square_distance,
+        EntryType*                                  entries,
+        size_t*                                     answer_sizes)
+      : m_tree(tree)
+      , m_answer_size(answer_size)
+      , m_query_points(query_points)
+      , m_begin(begin)
+      , m_end(end)
+      , m_query_max_square_distance(query_max_square_distance)
+      , m_entries(entries)
+      , m_answer_sizes(answer_sizes)
+    {
+    }
+
+    virtual void execute(const size_t thread_index)
+    {
+        Answer<T> answer(m_answer_size);
+        const Query<T, N> query(m_tree, answer);
+
+        for (const std::pair<uint64, size_t>* it = m_begin; it != m_end; ++it)
+        {
+            const size_t query_index = it->second;
+
+            query.run(m_query_points[query_index], m_query_max_square_distance);
+
+            const size_t answer_size = answer.size();
+            EntryType* entries = m_entries + query_index * m_answer_size;
+
+            for (size_t i = 0; i < answer_size; ++i)
+                entries[i] = answer.get(i);
+
+            m_answer_sizes[query_index] = answer_size;
+        }
+    }
+
+  private:
+    const TreeType&                                 m_tree;
+    const size_t                                    m_answer_size;
+    const VectorType*                               m_query_points;
+    const std::pair<uint64, size_t>*                m_begin;
+    const std::pair<uint64, size_t>*                m_end;
+    const ValueType                                 m_query_max_square_distance;
+    EntryType*                                      m_entries;
+    size_t*                                         m_answer_sizes;
+};
+
+template <typename T, size_t N>
+inline BatchQuery<T, N>::BatchQuery(
+    const TreeType&         tree,
+    const size_t            answer_size)
+  : m_tree(tree)
+  , m_answer_size(answer_size)
+{
+    assert(answer_size > 0);
+}
+
+template <typename T, size_t N>
+inline void BatchQuery<T, N>::run(
+    const VectorType        query_points[],
+    const size_t            query_count,
+    const size_t            thread_count)
+{
+    run(
+        query_points,
+        query_count,
+        std::numeric_limits<ValueType>::max(),
+        thread_count);
+}
+
+template <typename T, size_t N>
+void BatchQuery<T, N>::run(
+    const VectorType        query_points[],
+    const size_t            query_count,
+    const ValueType         query_max_square_distance,
+    const size_t            thread_count)
+{
+    m_entries.resize(query_count * m_answer_size);
+    m_answer_sizes.assign(query_count, 0);
+
+    if (query_count == 0 || m_tree.empty())
+        return;
+
+    // Compute the bounding box of the query points.
+    VectorType bbox_min = query_points[0];
+    VectorType bbox_max = query_points[0];
+    for (size_t i = 1; i < query_count; ++i)
+    {
+        for (size_t d = 0; d < N; ++d)
+        {
+            bbox_min[d] = std::min(bbox_min[d], query_points[i][d]);
+            bbox_max[d] = std::max(bbox_max[d], query_points[i][d]);
+        }
+    }
+
+    // Sort the queries along a Morton curve. 21 bits per dimension exceed the
+    // precision of single-precision coordinates and fit three dimensions in 64 bits.
+    const size_t BitsPerDim = std::min<size_t>(63 / N, 21);
+    const ValueType MaxCoord = static_cast<ValueType>((uint64(1) << BitsPerDim) - 1);
+    std::vector<std::pair<uint64, size_t> > order(query_count);
+    for (size_t i = 0; i < query_count; ++i)
+    {
+        uint64 coords[N];
+        for (size_t d = 0; d < N; ++d)
+        {
+            const ValueType extent = bbox_max[d] - bbox_min[d];
+            coords[d] =
+                extent > ValueType(0.0)
+                    ? static_cast<uint64>((query_points[i][d] - bbox_min[d]) / extent * MaxCoord)
+                    : 0;
+        }
+
+        uint64 code = 0;
+        for (size_t b = BitsPerDim; b-- > 0; )
+        {
+            for (size_t d = 0; d < N; ++d)
+                code = (code << 1) | ((coords[d] >> b) & 1);
+        }
+
+        order[i] = std::make_pair(code, i);
+    }
+    std::sort(order.begin(), order.end());
+
+    // Process contiguous ranges of sorted queries in parallel.
+    const size_t QueriesPerJob = 256;
+    Logger logger;
+    JobQueue job_queue;
+    JobManager job_manager(logger, job_queue, std::max<size_t>(thread_count, 1));
+
+    for (size_t begin = 0; begin < query_count; begin += QueriesPerJob)
+    {
+        const size_t end = std::min(begin + QueriesPerJob, query_count);
+        job_queue.schedule(
+            new QueryJob(
+                m_tree,
+                m_answer_size,
+                query_points,
+                &order[0] + begin,
+                &order[0] + end,
+                query_max_square_distance,
+                &m_entries[0],
+                &m_answer_sizes[0]));
+    }
+
+    job_manager.start();
+    job_queue.wait_until_completion();
+}
+
+template <typename T, size_t N>
+inline size_t BatchQuery<T, N>::get_answer_size(const size_t query_index) const
+{
+    assert(query_index < m_answer_sizes.size());
+    return m_answer_sizes[query_index];
+}
+
+template <typename T, size_t N>
+inline const typename BatchQuery<T, N>::EntryType& BatchQuery<T, N>::get_answer_entry(
+    const size_t            query_index,
+    const size_t            i) const
+{
+    assert(i < get_answer_size(query_index));
+    return m_entries[query_index * m_answer_size + i];
+}
+
+}       // namespace knn
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_KNN_KNN_BATCHQUERY_H
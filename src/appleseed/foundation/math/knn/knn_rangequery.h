@@ -0,0 +1,211 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_KNN_KNN_RANGEQUERY_H
+#define APPLESEED_FOUNDATION_MATH_KNN_KNN_RANGEQUERY_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/distance.h"
+#include "foundation/math/knn/knn_answer.h"
+#include "foundation/math/knn/knn_tree.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace knn {
+
+//
+// Fixed-radius query: find the points of a tree within a given distance of a query point.
+//
+// Contrary to knn::Query, points are not ranked: they are appended to the answer in tree
+// order, without maintaining a max-heap, which makes this query cheaper when the caller
+// only needs the points within a known radius (e.g. density estimation with a fixed kernel).
+//
+
+template <typename T, size_t N>
+class RangeQuery
+  : public NonCopyable
+{
+  public:
+    typedef T ValueType;
+    static const size_t Dimension = N;
+
+    typedef Vector<T, N> VectorType;
+    typedef Tree<T, N> TreeType;
+    typedef Answer<T> AnswerType;
+
+    RangeQuery(
+        const TreeType&     tree,
+        AnswerType&         answer);
+
+    // Collect the points within a given squared distance of the query point.
+    // Return the number of points found, which may exceed the capacity of the
+    // answer; in this case, only the first answer.max_size() points are kept.
+    size_t run(
+        const VectorType&   query_point,
+        const ValueType     query_max_square_distance) const;
+
+  private:
+    typedef typename TreeType::NodeType NodeType;
+
+    struct NodeEntry
+    {
+        const NodeType*     m_node;
+        VectorType          m_dvec;
+
+        NodeEntry() {}
+
+        NodeEntry(
+            const NodeType*     node,
+            const VectorType&   dvec)
+          : m_node(node)
+          , m_dvec(dvec)
+        {
+        }
+    };
+
+    const TreeType&         m_tree;
+    AnswerType&             m_answer;
+};
+
+typedef RangeQuery<float, 2>  RangeQuery2f;
+typedef RangeQuery<double, 2> RangeQuery2d;
+typedef RangeQuery<float, 3>  RangeQuery3f;
+typedef RangeQuery<double, 3> RangeQuery3d;
+
+
+//
+// Implementation.
+//
+
+template <typename T, size_t N>
+inline RangeQuery<T, N>::RangeQuery(
+    const TreeType&         tree,
+    AnswerType&             answer)
+  : m_tree(tree)
+  , m_answer(answer)
+{
+}
+
+template <typename T, size_t N>
+size_t RangeQuery<T, N>::run(
+    const VectorType&       query_point,
+    const ValueType         query_max_square_distance) const
+{
+    m_answer.clear();
+
+    if (m_tree.empty())
+        return 0;
+
+    const VectorType* APPLESEED_RESTRICT points = &m_tree.m_points.front();
+    const NodeType* APPLESEED_RESTRICT nodes = &m_tree.m_nodes.front();
+    const size_t max_answer_size = m_answer.max_size();
+
+    const size_t IdealLeafSize = 20;
+    const size_t NodeStackSize = 128;
+    NodeEntry node_stack[NodeStackSize];
+    size_t node_stack_size = 0;
+
+    size_t found_count = 0;
+
+    node_stack[node_stack_size++] = NodeEntry(nodes, VectorType(0.0));
+
+    while (node_stack_size > 0)
+    {
+        const NodeEntry& entry = node_stack[--node_stack_size];
+        const NodeType* APPLESEED_RESTRICT node = entry.m_node;
+        const VectorType parent_dvec = entry.m_dvec;
+
+        // Descend toward the query point, pushing the far children that overlap the search sphere.
+        // Like knn::Query, stop at nodes small enough to be scanned linearly.
+        while (node->is_interior() && node->get_point_count() >= IdealLeafSize)
+        {
+            const size_t split_dim = node->get_split_dim();
+            const ValueType distance = query_point[split_dim] - node->get_split_abs();
+            const NodeType* APPLESEED_RESTRICT left_child_node = nodes + node->get_child_node_index();
+
+            const NodeType* APPLESEED_RESTRICT follow_node;
+            const NodeType* APPLESEED_RESTRICT far_node;
+
+            if (distance > ValueType(0.0))
+            {
+                follow_node = left_child_node + 1;
+                far_node = left_child_node;
+            }
+            else
+            {
+                follow_node = left_child_node;
+                far_node = left_child_node + 1;
+            }
+
+            // The far child is at least as far as its bounding slab in every dimension split so far.
+            VectorType dvec = parent_dvec;
+            dvec[split_dim] = distance;
+
+            if (square_norm(dvec) <= query_max_square_distance)
+            {
+                assert(node_stack_size < NodeStackSize);
+                node_stack[node_stack_size++] = NodeEntry(far_node, dvec);
+            }
+
+            node = follow_node;
+        }
+
+        size_t point_index = node->get_point_index();
+        const VectorType* APPLESEED_RESTRICT point_ptr = points + point_index;
+        const VectorType* APPLESEED_RESTRICT point_end = point_ptr + node->get_point_count();
+
+        while (point_ptr < point_end)
+        {
+            const ValueType square_dist = square_distance(*point_ptr++, query_point);
+
+            if (square_dist <= query_max_square_distance)
+            {
+                if (found_count < max_answer_size)
+                    m_answer.array_insert(point_index, square_dist);
+
+                ++found_count;
+            }
+
+            ++point_index;
+        }
+    }
+
+    return found_count;
+}
+
+}       // namespace knn
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_KNN_KNN_RANGEQUERY_H
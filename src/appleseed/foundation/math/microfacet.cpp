@@ -30,9 +30,13 @@
 #include "microfacet.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/qmc.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/specialfunctions.h"
 
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
 // Standard headers.
 #include <cassert>
 #include <cmath>
@@ -773,4 +777,150 @@ float GTR1MDF::pdf(
     return D(h, alpha_x, alpha_y, gamma) * h.y;
 }
 
+
+
+//
+// MDFAlbedoTable class implementation.
+//
+
+namespace
+{
+    // Smallest alpha and cosine at which the albedo is tabulated.
+    const float MinAlbedoTableAlpha = 0.001f;
+    const float MinAlbedoTableCosTheta = 0.001f;
+
+    // Number of samples used to integrate each entry of the table.
+    const size_t AlbedoTableSampleCount = 512;
+
+    float directional_albedo(
+        const MDF&          mdf,
+        const float         cos_theta,
+        const float         alpha)
+    {
+        const Vector3f wo(std::sqrt(1.0f - square(cos_theta)), cos_theta, 0.0f);
+
+        float albedo = 0.0f;
+
+        for (size_t i = 0; i < AlbedoTableSampleCount; ++i)
+        {
+            // Sample the distribution of visible normals.
+            static const size_t Bases[] = { 2, 3 };
+            const Vector3f s = hammersley_sequence<float, 3>(Bases, AlbedoTableSampleCount, i);
+            const Vector3f m = mdf.sample(wo, s, alpha, alpha);
+
+            // No reflection below the surface.
+            const Vector3f wi = reflect(wo, m);
+            if (wi.y <= 0.0f)
+                continue;
+
+            const float cos_om = dot(wo, m);
+            const float pdf = mdf.pdf(wo, m, alpha, alpha) / (4.0f * cos_om);
+            if (pdf <= 0.0f)
+                continue;
+
+            // Accumulate f * cos(theta_i) / pdf.
+            const float D = mdf.D(m, alpha, alpha);
+            const float G = mdf.G(wi, wo, m, alpha, alpha);
+            albedo += D * G / (4.0f * cos_theta * pdf);
+        }
+
+        return std::min(albedo / AlbedoTableSampleCount, 1.0f);
+    }
+
+    float table_alpha(const size_t i, const size_t size)
+    {
+        return fit<size_t, float>(i, 0, size - 1, MinAlbedoTableAlpha, 1.0f);
+    }
+
+    float table_cos_theta(const size_t i, const size_t size)
+    {
+        return fit<size_t, float>(i, 0, size - 1, MinAlbedoTableCosTheta, 1.0f);
+    }
+
+    // Return the index of the first of the two entries to interpolate, and the interpolation weight.
+    size_t table_coordinate(
+        const float         x,
+        const float         x_min,
+        const size_t        size,
+        float&              t)
+    {
+        const float u = (saturate(x) - x_min) / (1.0f - x_min) * (size - 1);
+        const float uc = clamp(u, 0.0f, static_cast<float>(size - 1));
+        const size_t i = std::min(truncate<size_t>(uc), size - 2);
+        t = uc - static_cast<float>(i);
+        return i;
+    }
+}
+
+MDFAlbedoTable::MDFAlbedoTable(const MDF& mdf)
+{
+    for (size_t j = 0; j < TableSize; ++j)
+    {
+        const float alpha = table_alpha(j, TableSize);
+        float* row = m_albedo + j * TableSize;
+
+        for (size_t i = 0; i < TableSize; ++i)
+            row[i] = directional_albedo(mdf, table_cos_theta(i, TableSize), alpha);
+
+        // Eavg = 2 * integral of E(cos_theta) * cos_theta over [0, 1] (trapezoidal rule).
+        float avg = 0.0f;
+        for (size_t i = 0; i < TableSize - 1; ++i)
+        {
+            const float c0 = table_cos_theta(i, TableSize);
+            const float c1 = table_cos_theta(i + 1, TableSize);
+            avg += (row[i] * c0 + row[i + 1] * c1) * (c1 - c0);
+        }
+
+        m_avg_albedo[j] = std::min(avg, 1.0f);
+    }
+}
+
+float MDFAlbedoTable::get_directional_albedo(
+    const float             cos_theta,
+    const float             alpha) const
+{
+    float tc, ta;
+    const size_t ic = table_coordinate(cos_theta, MinAlbedoTableCosTheta, TableSize, tc);
+    const size_t ia = table_coordinate(alpha, MinAlbedoTableAlpha, TableSize, ta);
+
+    const float* row0 = m_albedo + ia * TableSize;
+    const float* row1 = row0 + TableSize;
+
+    return
+        lerp(
+            lerp(row0[ic], row0[ic + 1], tc),
+            lerp(row1[ic], row1[ic + 1], tc),
+            ta);
+}
+
+float MDFAlbedoTable::get_average_albedo(
+    const float             alpha) const
+{
+    float ta;
+    const size_t ia = table_coordinate(alpha, MinAlbedoTableAlpha, TableSize, ta);
+
+    return lerp(m_avg_albedo[ia], m_avg_albedo[ia + 1], ta);
+}
+
+namespace
+{
+    boost::mutex g_albedo_tables_mutex;
+}
+
+const MDFAlbedoTable& get_ggx_albedo_table()
+{
+    boost::mutex::scoped_lock lock(g_albedo_tables_mutex);
+    static const GGXMDF mdf;
+    static const MDFAlbedoTable table(mdf);
+    return table;
+}
+
+const MDFAlbedoTable& get_beckmann_albedo_table()
+{
+    boost::mutex::scoped_lock lock(g_albedo_tables_mutex);
+    static const BeckmannMDF mdf;
+    static const MDFAlbedoTable table(mdf);
+    return table;
+}
+
 }   // namespace foundation
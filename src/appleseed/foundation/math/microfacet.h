@@ -407,6 +407,52 @@ class GTR1MDF
         const float         gamma) const;
 };
 
+
+
+//
+// Directional albedo E(cos_theta, alpha) of an isotropic microfacet BRDF with a perfectly
+// reflecting Fresnel term, and its cosine-weighted average Eavg(alpha) over the hemisphere.
+//
+// These quantities are required to compensate for the energy lost by single scattering
+// microfacet models on rough surfaces, but are too expensive to integrate at every hit.
+// They are tabulated once and looked up with bilinear interpolation.
+//
+// Reference:
+//
+//   Revisiting Physically Based Shading at Imageworks
+//   Christopher Kulla, Alejandro Conty
+//   http://blog.selfshadow.com/publications/s2017-shading-course/imageworks/s2017_pbs_imageworks_slides.pdf
+//
+
+class MDFAlbedoTable
+  : public NonCopyable
+{
+  public:
+    // Tabulate the albedo of a given MDF by numerical integration.
+    explicit MDFAlbedoTable(const MDF& mdf);
+
+    // Return the directional albedo for a given cosine of the angle with the normal.
+    float get_directional_albedo(
+        const float         cos_theta,
+        const float         alpha) const;
+
+    // Return the average albedo.
+    float get_average_albedo(
+        const float         alpha) const;
+
+  private:
+    enum { TableSize = 32 };
+
+    float m_albedo[TableSize * TableSize];      // indexed by [alpha][cos_theta]
+    float m_avg_albedo[TableSize];              // indexed by [alpha]
+};
+
+// Return the albedo tables of the GGX and Beckmann MDFs.
+// The tables are computed the first time they are requested.
+// These functions are thread-safe.
+const MDFAlbedoTable& get_ggx_albedo_table();
+const MDFAlbedoTable& get_beckmann_albedo_table();
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_MATH_MICROFACET_H
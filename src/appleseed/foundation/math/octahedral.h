@@ -0,0 +1,132 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2015-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_OCTAHEDRAL_H
+#define APPLESEED_FOUNDATION_MATH_OCTAHEDRAL_H
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+
+namespace foundation
+{
+
+//
+// Octahedral encoding of unit vectors into 32 bits (two 16-bit signed normalized coordinates).
+// The maximum angular error after a round trip is about 0.005 degrees.
+//
+// Reference:
+//
+//   A Survey of Efficient Representations for Independent Unit Vectors
+//   http://jcgt.org/published/0003/02/01/paper.pdf
+//
+
+// Encode a unit vector.
+template <typename T>
+uint32 encode_octahedral(const Vector<T, 3>& v);
+
+// Decode a unit vector.
+template <typename T>
+Vector<T, 3> decode_octahedral(const uint32 packed);
+
+
+//
+// Implementation.
+//
+
+namespace octahedral_impl
+{
+    template <typename T>
+    inline T sign_not_zero(const T x)
+    {
+        return x >= T(0.0) ? T(1.0) : T(-1.0);
+    }
+
+    template <typename T>
+    inline uint32 pack_snorm16(const T x)
+    {
+        const T r = std::floor(clamp(x, T(-1.0), T(1.0)) * T(32767.0) + T(0.5));
+        return static_cast<uint32>(static_cast<uint16>(static_cast<int16>(r)));
+    }
+
+    template <typename T>
+    inline T unpack_snorm16(const uint32 x)
+    {
+        return std::max(static_cast<T>(static_cast<int16>(static_cast<uint16>(x))) * T(1.0 / 32767.0), T(-1.0));
+    }
+}
+
+template <typename T>
+inline uint32 encode_octahedral(const Vector<T, 3>& v)
+{
+    // Project the vector onto the octahedron |x| + |y| + |z| = 1.
+    const T rcp_l1 = T(1.0) / (std::abs(v[0]) + std::abs(v[1]) + std::abs(v[2]));
+    T x = v[0] * rcp_l1;
+    T y = v[1] * rcp_l1;
+
+    // Fold the lower hemisphere over the diagonals.
+    if (v[2] < T(0.0))
+    {
+        const T folded_x = (T(1.0) - std::abs(y)) * octahedral_impl::sign_not_zero(x);
+        const T folded_y = (T(1.0) - std::abs(x)) * octahedral_impl::sign_not_zero(y);
+        x = folded_x;
+        y = folded_y;
+    }
+
+    return
+          octahedral_impl::pack_snorm16(x)
+        | (octahedral_impl::pack_snorm16(y) << 16);
+}
+
+template <typename T>
+inline Vector<T, 3> decode_octahedral(const uint32 packed)
+{
+    Vector<T, 3> v;
+    v[0] = octahedral_impl::unpack_snorm16<T>(packed & 0xFFFF);
+    v[1] = octahedral_impl::unpack_snorm16<T>(packed >> 16);
+    v[2] = T(1.0) - std::abs(v[0]) - std::abs(v[1]);
+
+    // Unfold the lower hemisphere.
+    if (v[2] < T(0.0))
+    {
+        const T x = v[0];
+        v[0] = (T(1.0) - std::abs(v[1])) * octahedral_impl::sign_not_zero(x);
+        v[1] = (T(1.0) - std::abs(x)) * octahedral_impl::sign_not_zero(v[1]);
+    }
+
+    return normalize(v);
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_OCTAHEDRAL_H
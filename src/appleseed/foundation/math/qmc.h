@@ -31,6 +31,7 @@
 #define APPLESEED_FOUNDATION_MATH_QMC_H
 
 // appleseed.foundation headers.
+#include "foundation/math/hash.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/arch.h"
 #include "foundation/platform/types.h"
@@ -56,7 +57,6 @@ namespace foundation
 //   implement specializations of Halton and Hammersley sequences generators for bases (2,3).
 //   implement incremental radical inverse (for successive input values).
 //   implement vectorized radical inverse functions with SSE2.
-//   implement Sobol sequence generator.
 //
 
 
@@ -203,6 +203,45 @@ Vector<T, Dim> hammersley_zaremba_sequence(
     const size_t        i);             // sample number
 
 
+//
+// Owen-scrambled Sobol sequences.
+//
+// The first four dimensions of the Sobol sequence, scrambled with a hash-based
+// approximation of Owen scrambling. The sample index is shuffled the same way so
+// that sequences with different seeds are decorrelated; higher dimensions are
+// obtained by padding, i.e. by drawing from these four dimensions with new seeds.
+//
+// All return values are in the interval [0, 1).
+//
+// Reference:
+//
+//   Brent Burley, Practical Hash-based Owen Scrambling
+//   http://jcgt.org/published/0009/04/01/
+//
+
+const size_t SobolDimensionCount = 4;
+extern const uint32 SobolMatrices[SobolDimensionCount][32];
+
+// Reverse the order of the bits of a 32-bit integer.
+uint32 reverse_bits(uint32 value);
+
+// Return the i'th value of a given dimension of the Sobol sequence, as a 32-bit fixed point number.
+uint32 sobol_uint32(
+    const size_t        dimension,      // dimension, in [0, SobolDimensionCount)
+    uint32              i);             // sample number
+
+// Nested uniform scrambling of the bits of a 32-bit fixed point number.
+uint32 owen_scramble_uint32(
+    const uint32        value,
+    const uint32        seed);
+
+// Return the i'th sample of a shuffled and Owen-scrambled Sobol sequence.
+template <typename T, size_t Dim>
+Vector<T, Dim> owen_scrambled_sobol_sequence(
+    const uint32        seed,           // scrambling seed
+    const uint32        i);             // sample number
+
+
 //
 // Base-2 radical inverse functions implementation.
 //
@@ -2601,6 +2640,79 @@ inline Vector<T, Dim> hammersley_zaremba_sequence(
     return p;
 }
 
+
+//
+// Owen-scrambled Sobol sequences implementation.
+//
+
+inline uint32 reverse_bits(uint32 value)
+{
+    value = (value >> 16) | (value << 16);
+    value = ((value & 0xFF00FF00UL) >> 8) | ((value & 0x00FF00FFUL) << 8);
+    value = ((value & 0xF0F0F0F0UL) >> 4) | ((value & 0x0F0F0F0FUL) << 4);
+    value = ((value & 0xCCCCCCCCUL) >> 2) | ((value & 0x33333333UL) << 2);
+    value = ((value & 0xAAAAAAAAUL) >> 1) | ((value & 0x55555555UL) << 1);
+    return value;
+}
+
+inline uint32 sobol_uint32(
+    const size_t        dimension,
+    uint32              i)
+{
+    assert(dimension < SobolDimensionCount);
+
+    const uint32* matrix = SobolMatrices[dimension];
+    uint32 result = 0;
+
+    for (; i != 0; i >>= 1, ++matrix)
+    {
+        if (i & 1)
+            result ^= *matrix;
+    }
+
+    return result;
+}
+
+inline uint32 owen_scramble_uint32(
+    const uint32        value,
+    const uint32        seed)
+{
+    // Laine-Karras style permutation applied to the reversed bits: each bit
+    // only gets flipped as a function of the bits of higher significance.
+    uint32 x = reverse_bits(value);
+    x += seed;
+    x ^= x * 0x6C50B47CUL;
+    x ^= x * 0xB82F1E52UL;
+    x ^= x * 0xC7AFE638UL;
+    x ^= x * 0x8D22F6E6UL;
+    return reverse_bits(x);
+}
+
+template <typename T, size_t Dim>
+inline Vector<T, Dim> owen_scrambled_sobol_sequence(
+    const uint32        seed,
+    const uint32        i)
+{
+    BOOST_STATIC_ASSERT(Dim <= SobolDimensionCount);
+
+    const uint32 index = owen_scramble_uint32(i, hash_uint32(seed));
+
+    Vector<T, Dim> p;
+
+    for (size_t d = 0; d < Dim; ++d)
+    {
+        const uint32 x =
+            owen_scramble_uint32(
+                sobol_uint32(d, index),
+                mix_uint32(seed, static_cast<uint32>(d)));
+
+        // Keep 24 bits so that the result is exactly representable in single precision.
+        p[d] = static_cast<T>((x >> 8) * (1.0 / 16777216.0));
+    }
+
+    return p;
+}
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_MATH_QMC_H
@@ -38,10 +38,18 @@ namespace foundation
 //
 // PCG random number generator.
 //
+// The generator supports 2^63 independent streams, selected by the second constructor
+// argument, and can jump ahead by an arbitrary number of steps in logarithmic time.
+// Together, these allow deterministic random numbers to be derived from a (stream, offset)
+// pair regardless of how work is distributed among threads.
+//
 // Reference:
 //
 //   http://www.pcg-random.org/
 //
+//   Random Number Generation with Arbitrary Strides, F. B. Brown
+//   http://mcnp.lanl.gov/pdf_files/anl-rn-arb-stride.pdf
+//
 
 class PCG
 {
@@ -54,6 +62,10 @@ class PCG
     // Generate a 32-bit random number.
     uint32 rand_uint32();
 
+    // Advance the generator by a given number of steps, as if rand_uint32() had been called
+    // `delta` times. Negative offsets can be obtained by wrapping around (2^64 - n steps).
+    void advance(uint64 delta);
+
   private:
     uint64  m_state;    // current state of the generator
     uint64  m_inc;      // controls which RNG sequence (stream) is selected -- must *always* be odd
@@ -91,6 +103,29 @@ inline uint32 PCG::rand_uint32()
 
 #pragma warning (pop)
 
+inline void PCG::advance(uint64 delta)
+{
+    uint64 cur_mult = 6364136223846793005ULL;
+    uint64 cur_plus = m_inc;
+    uint64 acc_mult = 1;
+    uint64 acc_plus = 0;
+
+    while (delta > 0)
+    {
+        if (delta & 1)
+        {
+            acc_mult *= cur_mult;
+            acc_plus = acc_plus * cur_mult + cur_plus;
+        }
+
+        cur_plus = (cur_mult + 1) * cur_plus;
+        cur_mult *= cur_mult;
+        delta >>= 1;
+    }
+
+    m_state = acc_mult * m_state + acc_plus;
+}
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_MATH_RNG_PCG_H
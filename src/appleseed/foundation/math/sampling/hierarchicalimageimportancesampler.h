@@ -0,0 +1,611 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_SAMPLING_HIERARCHICALIMAGEIMPORTANCESAMPLER_H
+#define APPLESEED_FOUNDATION_MATH_SAMPLING_HIERARCHICALIMAGEIMPORTANCESAMPLER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/utility/job/iabortswitch.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// An image importance sampler based on a MIP-style pyramid of importance sums.
+//
+// The image is padded with zero-importance pixels to power-of-two dimensions.
+// Each node of the pyramid stores the sum of the importance of its 2x2 (or 2x1
+// or 1x2) children. Sampling warps the sample down the pyramid in O(log n) steps
+// touching a few adjacent nodes per level (the children of a node are stored
+// contiguously), and the probability of any pixel is obtained in constant time. Since every node only depends on its children, the
+// pyramid can be updated after a region of the image has changed without
+// resampling the rest of the image.
+//
+// The ImageSampler type must conform to the prototype documented in
+// foundation/math/sampling/imageimportancesampler.h.
+//
+// Reference:
+//
+//   Clarberg et al., Wavelet Importance Sampling: Efficiently Evaluating Products
+//   of Complex Functions
+//   http://graphics.cs.lth.se/research/papers/2005/wis/
+//
+
+template <typename Payload, typename Importance>
+class HierarchicalImageImportanceSampler
+  : public NonCopyable
+{
+  public:
+    typedef Vector<Importance, 2> Vector2Type;
+
+    // Constructor.
+    HierarchicalImageImportanceSampler(
+        const size_t        width,
+        const size_t        height);
+
+    // Resample the image and rebuild the pyramid.
+    template <typename ImageSampler>
+    void rebuild(
+        ImageSampler&       sampler,
+        IAbortSwitch*       abort_switch = 0);
+
+    // Resample a range of rows of the image. Disjoint ranges of rows may be
+    // resampled concurrently. Once all rows are resampled, rebuild_pyramid()
+    // must be called.
+    template <typename ImageSampler>
+    void rebuild_rows(
+        ImageSampler&       sampler,
+        const size_t        row_begin,
+        const size_t        row_end);
+
+    // Rebuild the upper levels of the pyramid from the image.
+    void rebuild_pyramid();
+
+    // Resample a rectangle of the image and update the nodes of the pyramid
+    // that depend on it. The rectangle is [x_begin, x_end) x [y_begin, y_end).
+    template <typename ImageSampler>
+    void update(
+        ImageSampler&       sampler,
+        const size_t        x_begin,
+        const size_t        y_begin,
+        const size_t        x_end,
+        const size_t        y_end);
+
+    // Write the importance map to a binary stream, or read it back.
+    // read() returns false if the stream could not be read or doesn't match the image size.
+    void write(std::ostream& output) const;
+    bool read(std::istream& input);
+
+    // Sample the image and return the coordinates of the chosen pixel
+    // and its probability density.
+    void sample(
+        const Vector2Type&  s,
+        size_t&             x,
+        size_t&             y,
+        Importance&         probability) const;
+
+    // Sample the image and return the coordinates of the chosen pixel,
+    // its probability density and its associated payload.
+    void sample(
+        const Vector2Type&  s,
+        size_t&             x,
+        size_t&             y,
+        Payload&            payload,
+        Importance&         probability) const;
+
+    // Return the probability density of a given pixel.
+    Importance get_pdf(
+        const size_t        x,
+        const size_t        y) const;
+
+  private:
+    struct Level
+    {
+        size_t                  m_width;
+        size_t                  m_height;
+        size_t                  m_split_x;      // 2 if this level subdivides the previous one horizontally, 1 otherwise
+        size_t                  m_split_y;      // 2 if this level subdivides the previous one vertically, 1 otherwise
+        size_t                  m_leaf_shift;   // log2 of the number of pixels (including padding) below a node
+        std::vector<Importance> m_nodes;        // the children of a node are stored contiguously
+    };
+
+    const size_t            m_width;
+    const size_t            m_height;
+    const Importance        m_rcp_pixel_count;
+
+    std::vector<Payload>    m_payloads;
+    std::vector<Level>      m_levels;           // m_levels[0] is the root, m_levels.back() the padded image
+    std::vector<size_t>     m_leaf_index_x;     // contribution of the x coordinate to the index of a pixel
+    std::vector<size_t>     m_leaf_index_y;     // contribution of the y coordinate to the index of a pixel
+
+    size_t get_node_index(
+        const size_t        level,
+        const size_t        x,
+        const size_t        y) const;
+
+    Importance get_importance(
+        const size_t        x,
+        const size_t        y) const;
+
+    Importance get_total_importance() const;
+
+    void set_importance(
+        const size_t        x,
+        const size_t        y,
+        const Importance    importance);
+
+    void rebuild_level(
+        const size_t        level,
+        const size_t        x_begin,
+        const size_t        y_begin,
+        const size_t        x_end,
+        const size_t        y_end);
+
+    void warp(
+        Vector2Type         s,
+        size_t&             x,
+        size_t&             y) const;
+
+    // Choose between two children given their weights and remap the sample
+    // to [0,1) so that it can be reused to make the next choice.
+    static size_t choose(
+        const Importance    w0,
+        const Importance    w1,
+        Importance&         s);
+};
+
+
+//
+// HierarchicalImageImportanceSampler class implementation.
+//
+
+template <typename Payload, typename Importance>
+HierarchicalImageImportanceSampler<Payload, Importance>::HierarchicalImageImportanceSampler(
+    const size_t            width,
+    const size_t            height)
+  : m_width(width)
+  , m_height(height)
+  , m_rcp_pixel_count(Importance(1.0) / (width * height))
+  , m_payloads(width * height)
+{
+    assert(width > 0);
+    assert(height > 0);
+
+    // Compute the dimensions of the levels, from the padded image up to the root.
+    std::vector<Level> levels;
+    size_t level_width = next_pow2(width);
+    size_t level_height = next_pow2(height);
+
+    while (true)
+    {
+        levels.push_back(Level());
+        levels.back().m_width = level_width;
+        levels.back().m_height = level_height;
+        levels.back().m_nodes.assign(level_width * level_height, Importance(0.0));
+
+        if (level_width == 1 && level_height == 1)
+            break;
+
+        level_width = std::max<size_t>(level_width / 2, 1);
+        level_height = std::max<size_t>(level_height / 2, 1);
+    }
+
+    m_levels.assign(levels.rbegin(), levels.rend());
+
+    const size_t leaf_width = m_levels.back().m_width;
+    const size_t leaf_height = m_levels.back().m_height;
+
+    m_leaf_index_x.assign(leaf_width, 0);
+    m_leaf_index_y.assign(leaf_height, 0);
+
+    m_levels[0].m_split_x = 1;
+    m_levels[0].m_split_y = 1;
+    m_levels[0].m_leaf_shift = 0;
+
+    for (size_t level = 1; level < m_levels.size(); ++level)
+    {
+        Level& l = m_levels[level];
+        l.m_split_x = l.m_width / m_levels[level - 1].m_width;
+        l.m_split_y = l.m_height / m_levels[level - 1].m_height;
+
+        // The children of a node are ordered by x first, then by y.
+        const size_t shift_x = leaf_width / l.m_width;
+        const size_t shift_y = leaf_height / l.m_height;
+
+        for (size_t x = 0; x < leaf_width; ++x)
+        {
+            m_leaf_index_x[x] *= l.m_split_x * l.m_split_y;
+            if (l.m_split_x == 2)
+                m_leaf_index_x[x] += (x / shift_x) & 1;
+        }
+
+        for (size_t y = 0; y < leaf_height; ++y)
+        {
+            m_leaf_index_y[y] *= l.m_split_x * l.m_split_y;
+            if (l.m_split_y == 2)
+                m_leaf_index_y[y] += ((y / shift_y) & 1) * l.m_split_x;
+        }
+    }
+
+    // Compute the number of pixels below the nodes of each level.
+    size_t leaf_shift = 0;
+    for (size_t level = m_levels.size() - 1; level > 0; --level)
+    {
+        m_levels[level].m_leaf_shift = leaf_shift;
+        leaf_shift += (m_levels[level].m_split_x == 2) + (m_levels[level].m_split_y == 2);
+    }
+    m_levels[0].m_leaf_shift = leaf_shift;
+}
+
+template <typename Payload, typename Importance>
+template <typename ImageSampler>
+void HierarchicalImageImportanceSampler<Payload, Importance>::rebuild(
+    ImageSampler&           sampler,
+    IAbortSwitch*           abort_switch)
+{
+    for (size_t y = 0, ye = m_height; y < ye; ++y)
+    {
+        if (is_aborted(abort_switch))
+            return;
+
+        rebuild_rows(sampler, y, y + 1);
+    }
+
+    rebuild_pyramid();
+}
+
+template <typename Payload, typename Importance>
+template <typename ImageSampler>
+void HierarchicalImageImportanceSampler<Payload, Importance>::rebuild_rows(
+    ImageSampler&           sampler,
+    const size_t            row_begin,
+    const size_t            row_end)
+{
+    assert(row_begin <= row_end);
+    assert(row_end <= m_height);
+
+    for (size_t y = row_begin; y < row_end; ++y)
+    {
+        for (size_t x = 0, xe = m_width; x < xe; ++x)
+        {
+            Importance importance;
+            sampler.sample(x, y, m_payloads[y * m_width + x], importance);
+            set_importance(x, y, importance);
+        }
+    }
+}
+
+template <typename Payload, typename Importance>
+void HierarchicalImageImportanceSampler<Payload, Importance>::rebuild_pyramid()
+{
+    for (size_t level = m_levels.size() - 1; level > 0; --level)
+    {
+        const Level& children = m_levels[level];
+        Level& parent = m_levels[level - 1];
+
+        const Importance* APPLESEED_RESTRICT in = &children.m_nodes[0];
+        Importance* APPLESEED_RESTRICT out = &parent.m_nodes[0];
+        const size_t count = parent.m_nodes.size();
+
+        // Children are contiguous: this reduction is easily vectorized by the compiler.
+        if (children.m_split_x * children.m_split_y == 4)
+        {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = (in[4 * i] + in[4 * i + 1]) + (in[4 * i + 2] + in[4 * i + 3]);
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = in[2 * i] + in[2 * i + 1];
+        }
+    }
+}
+
+template <typename Payload, typename Importance>
+template <typename ImageSampler>
+void HierarchicalImageImportanceSampler<Payload, Importance>::update(
+    ImageSampler&           sampler,
+    const size_t            x_begin,
+    const size_t            y_begin,
+    const size_t            x_end,
+    const size_t            y_end)
+{
+    assert(x_begin <= x_end && x_end <= m_width);
+    assert(y_begin <= y_end && y_end <= m_height);
+
+    if (x_begin == x_end || y_begin == y_end)
+        return;
+
+    for (size_t y = y_begin; y < y_end; ++y)
+    {
+        for (size_t x = x_begin; x < x_end; ++x)
+        {
+            Importance importance;
+            sampler.sample(x, y, m_payloads[y * m_width + x], importance);
+            set_importance(x, y, importance);
+        }
+    }
+
+    // Propagate the change up to the root.
+    size_t xb = x_begin, yb = y_begin, xe = x_end, ye = y_end;
+
+    for (size_t level = m_levels.size() - 1; level > 0; --level)
+    {
+        const size_t fx = m_levels[level].m_split_x;
+        const size_t fy = m_levels[level].m_split_y;
+
+        xb /= fx;
+        yb /= fy;
+        xe = (xe + fx - 1) / fx;
+        ye = (ye + fy - 1) / fy;
+
+        rebuild_level(level - 1, xb, yb, xe, ye);
+    }
+}
+
+template <typename Payload, typename Importance>
+void HierarchicalImageImportanceSampler<Payload, Importance>::write(std::ostream& output) const
+{
+    output.write(reinterpret_cast<const char*>(&m_width), sizeof(m_width));
+    output.write(reinterpret_cast<const char*>(&m_height), sizeof(m_height));
+
+    output.write(reinterpret_cast<const char*>(&m_payloads[0]), m_payloads.size() * sizeof(Payload));
+
+    const std::vector<Importance>& leaves = m_levels.back().m_nodes;
+    output.write(reinterpret_cast<const char*>(&leaves[0]), leaves.size() * sizeof(Importance));
+}
+
+template <typename Payload, typename Importance>
+bool HierarchicalImageImportanceSampler<Payload, Importance>::read(std::istream& input)
+{
+    size_t width, height;
+
+    input.read(reinterpret_cast<char*>(&width), sizeof(width));
+    input.read(reinterpret_cast<char*>(&height), sizeof(height));
+
+    if (!input || width != m_width || height != m_height)
+        return false;
+
+    input.read(reinterpret_cast<char*>(&m_payloads[0]), m_payloads.size() * sizeof(Payload));
+
+    std::vector<Importance>& leaves = m_levels.back().m_nodes;
+    input.read(reinterpret_cast<char*>(&leaves[0]), leaves.size() * sizeof(Importance));
+
+    if (input.fail())
+        return false;
+
+    rebuild_pyramid();
+
+    return true;
+}
+
+template <typename Payload, typename Importance>
+inline void HierarchicalImageImportanceSampler<Payload, Importance>::sample(
+    const Vector2Type&      s,
+    size_t&                 x,
+    size_t&                 y,
+    Importance&             probability) const
+{
+    const Importance total = get_total_importance();
+
+    if (total > Importance(0.0))
+    {
+        warp(s, x, y);
+        probability = get_importance(x, y) / total;
+    }
+    else
+    {
+        // Uniform random sampling.
+        x = truncate<size_t>(s[0] * m_width);
+        y = truncate<size_t>(s[1] * m_height);
+
+        probability = m_rcp_pixel_count;
+    }
+
+    assert(probability > Importance(0.0));
+}
+
+template <typename Payload, typename Importance>
+inline void HierarchicalImageImportanceSampler<Payload, Importance>::sample(
+    const Vector2Type&      s,
+    size_t&                 x,
+    size_t&                 y,
+    Payload&                payload,
+    Importance&             probability) const
+{
+    sample(s, x, y, probability);
+    payload = m_payloads[y * m_width + x];
+}
+
+template <typename Payload, typename Importance>
+inline Importance HierarchicalImageImportanceSampler<Payload, Importance>::get_pdf(
+    const size_t            x,
+    const size_t            y) const
+{
+    assert(x < m_width);
+    assert(y < m_height);
+
+    const Importance total = get_total_importance();
+
+    return
+        total > Importance(0.0)
+            ? get_importance(x, y) / total
+            : m_rcp_pixel_count;
+}
+
+template <typename Payload, typename Importance>
+inline size_t HierarchicalImageImportanceSampler<Payload, Importance>::get_node_index(
+    const size_t            level,
+    const size_t            x,
+    const size_t            y) const
+{
+    // The pixels below a node are contiguous and start at the index of its first pixel.
+    const Level& l = m_levels[level];
+    const size_t leaf_x = x * (m_levels.back().m_width / l.m_width);
+    const size_t leaf_y = y * (m_levels.back().m_height / l.m_height);
+
+    return (m_leaf_index_x[leaf_x] + m_leaf_index_y[leaf_y]) >> l.m_leaf_shift;
+}
+
+template <typename Payload, typename Importance>
+inline Importance HierarchicalImageImportanceSampler<Payload, Importance>::get_importance(
+    const size_t            x,
+    const size_t            y) const
+{
+    return m_levels.back().m_nodes[m_leaf_index_x[x] + m_leaf_index_y[y]];
+}
+
+template <typename Payload, typename Importance>
+inline Importance HierarchicalImageImportanceSampler<Payload, Importance>::get_total_importance() const
+{
+    return m_levels[0].m_nodes[0];
+}
+
+template <typename Payload, typename Importance>
+inline void HierarchicalImageImportanceSampler<Payload, Importance>::set_importance(
+    const size_t            x,
+    const size_t            y,
+    const Importance        importance)
+{
+    assert(importance >= Importance(0.0));
+    m_levels.back().m_nodes[m_leaf_index_x[x] + m_leaf_index_y[y]] = importance;
+}
+
+template <typename Payload, typename Importance>
+void HierarchicalImageImportanceSampler<Payload, Importance>::rebuild_level(
+    const size_t            level,
+    const size_t            x_begin,
+    const size_t            y_begin,
+    const size_t            x_end,
+    const size_t            y_end)
+{
+    Level& parent = m_levels[level];
+    const Level& children = m_levels[level + 1];
+    const size_t child_count = children.m_split_x * children.m_split_y;
+
+    for (size_t y = y_begin; y < y_end; ++y)
+    {
+        for (size_t x = x_begin; x < x_end; ++x)
+        {
+            const size_t i = get_node_index(level, x, y);
+            const Importance* in = &children.m_nodes[i * child_count];
+
+            parent.m_nodes[i] =
+                child_count == 4
+                    ? (in[0] + in[1]) + (in[2] + in[3])
+                    : in[0] + in[1];
+        }
+    }
+}
+
+template <typename Payload, typename Importance>
+void HierarchicalImageImportanceSampler<Payload, Importance>::warp(
+    Vector2Type             s,
+    size_t&                 x,
+    size_t&                 y) const
+{
+    size_t i = 0;
+    x = 0;
+    y = 0;
+
+    for (size_t level = 1, level_count = m_levels.size(); level < level_count; ++level)
+    {
+        const Level& children = m_levels[level];
+
+        if (children.m_split_x == 2)
+        {
+            if (children.m_split_y == 2)
+            {
+                // Choose a column with the first coordinate, then a row within this column.
+                const Importance* in = &children.m_nodes[4 * i];
+                const size_t col = choose(in[0] + in[2], in[1] + in[3], s[0]);
+                const size_t row = choose(in[col], in[col + 2], s[1]);
+
+                i = 4 * i + 2 * row + col;
+                x = 2 * x + col;
+                y = 2 * y + row;
+            }
+            else
+            {
+                const Importance* in = &children.m_nodes[2 * i];
+                const size_t col = choose(in[0], in[1], s[0]);
+
+                i = 2 * i + col;
+                x = 2 * x + col;
+            }
+        }
+        else
+        {
+            const Importance* in = &children.m_nodes[2 * i];
+            const size_t row = choose(in[0], in[1], s[1]);
+
+            i = 2 * i + row;
+            y = 2 * y + row;
+        }
+    }
+
+    assert(x < m_width);
+    assert(y < m_height);
+}
+
+template <typename Payload, typename Importance>
+inline size_t HierarchicalImageImportanceSampler<Payload, Importance>::choose(
+    const Importance        w0,
+    const Importance        w1,
+    Importance&             s)
+{
+    // Written without branches since both outcomes are often equally likely.
+    const Importance x = s * (w0 + w1);
+    const bool second = x >= w0 && w1 > Importance(0.0);
+    const Importance base = second ? w0 : Importance(0.0);
+    const Importance weight = second ? w1 : w0;
+
+    assert(weight > Importance(0.0));
+
+    s = std::min((x - base) / weight, Importance(1.0) - std::numeric_limits<Importance>::epsilon());
+
+    return second;
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_SAMPLING_HIERARCHICALIMAGEIMPORTANCESAMPLER_H
@@ -35,6 +35,7 @@
 #include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/image/image.h"
+#include "foundation/math/aliastable.h"
 #include "foundation/math/cdf.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
@@ -42,6 +43,8 @@
 
 // Standard headers.
 #include <cstddef>
+#include <istream>
+#include <ostream>
 #include <utility>
 
 namespace foundation
@@ -61,7 +64,11 @@ namespace foundation
 //   };
 //
 
-template <typename Payload, typename Importance>
+template <
+    typename Payload,
+    typename Importance,
+    template <typename, typename> class Distribution = CDF  // CDF or AliasTable
+>
 class ImageImportanceSampler
   : public NonCopyable
 {
@@ -82,6 +89,23 @@ class ImageImportanceSampler
         ImageSampler&       sampler,
         IAbortSwitch*       abort_switch = 0);
 
+    // Resample a range of rows of the image and rebuild their CDFs. Disjoint ranges
+    // of rows may be rebuilt concurrently. Once all rows are rebuilt, rebuild_rows_cdf()
+    // must be called.
+    template <typename ImageSampler>
+    void rebuild_rows(
+        ImageSampler&       sampler,
+        const size_t        row_begin,
+        const size_t        row_end);
+
+    // Rebuild the CDF used to select rows.
+    void rebuild_rows_cdf();
+
+    // Write the CDFs to a binary stream, or read them back.
+    // read() returns false if the stream could not be read or doesn't match the image size.
+    void write(std::ostream& output) const;
+    bool read(std::istream& input);
+
     // Sample the image and return the coordinates of the chosen pixel
     // and its probability density.
     void sample(
@@ -105,8 +129,8 @@ class ImageImportanceSampler
         const size_t        y) const;
 
   private:
-    typedef CDF<size_t, Importance> RowCDF;
-    typedef CDF<Payload, Importance> ColCDF;
+    typedef Distribution<size_t, Importance> RowCDF;
+    typedef Distribution<Payload, Importance> ColCDF;
 
     const size_t            m_width;
     const size_t            m_height;
@@ -139,8 +163,8 @@ class ImageSampler
 // ImageImportanceSampler class implementation.
 //
 
-template <typename Payload, typename Importance>
-ImageImportanceSampler<Payload, Importance>::ImageImportanceSampler(
+template <typename Payload, typename Importance, template <typename, typename> class Distribution>
+ImageImportanceSampler<Payload, Importance, Distribution>::ImageImportanceSampler(
     const size_t            width,
     const size_t            height)
   : m_width(width)
@@ -150,29 +174,43 @@ ImageImportanceSampler<Payload, Importance>::ImageImportanceSampler(
     m_cols_cdf = new ColCDF[m_height];
 }
 
-template <typename Payload, typename Importance>
-ImageImportanceSampler<Payload, Importance>::~ImageImportanceSampler()
+template <typename Payload, typename Importance, template <typename, typename> class Distribution>
+ImageImportanceSampler<Payload, Importance, Distribution>::~ImageImportanceSampler()
 {
     delete [] m_cols_cdf;
 }
 
-template <typename Payload, typename Importance>
+template <typename Payload, typename Importance, template <typename, typename> class Distribution>
 template <typename ImageSampler>
-void ImageImportanceSampler<Payload, Importance>::rebuild(
+void ImageImportanceSampler<Payload, Importance, Distribution>::rebuild(
     ImageSampler&           sampler,
     IAbortSwitch*           abort_switch)
 {
     m_rows_cdf.clear();
-    m_rows_cdf.reserve(m_height);
 
     for (size_t y = 0, ye = m_height; y < ye; ++y)
     {
         if (is_aborted(abort_switch))
-        {
-            m_rows_cdf.clear();
-            break;
-        }
+            return;
 
+        rebuild_rows(sampler, y, y + 1);
+    }
+
+    rebuild_rows_cdf();
+}
+
+template <typename Payload, typename Importance, template <typename, typename> class Distribution>
+template <typename ImageSampler>
+void ImageImportanceSampler<Payload, Importance, Distribution>::rebuild_rows(
+    ImageSampler&           sampler,
+    const size_t            row_begin,
+    const size_t            row_end)
+{
+    assert(row_begin <= row_end);
+    assert(row_end <= m_height);
+
+    for (size_t y = row_begin; y < row_end; ++y)
+    {
         m_cols_cdf[y].clear();
         m_cols_cdf[y].reserve(m_width);
 
@@ -188,16 +226,56 @@ void ImageImportanceSampler<Payload, Importance>::rebuild(
 
         if (m_cols_cdf[y].valid())
             m_cols_cdf[y].prepare();
+    }
+}
 
+template <typename Payload, typename Importance, template <typename, typename> class Distribution>
+void ImageImportanceSampler<Payload, Importance, Distribution>::rebuild_rows_cdf()
+{
+    m_rows_cdf.clear();
+    m_rows_cdf.reserve(m_height);
+
+    for (size_t y = 0, ye = m_height; y < ye; ++y)
         m_rows_cdf.insert(y, m_cols_cdf[y].weight());
-    }
 
     if (m_rows_cdf.valid())
         m_rows_cdf.prepare();
 }
 
-template <typename Payload, typename Importance>
-inline void ImageImportanceSampler<Payload, Importance>::sample(
+template <typename Payload, typename Importance, template <typename, typename> class Distribution>
+void ImageImportanceSampler<Payload, Importance, Distribution>::write(std::ostream& output) const
+{
+    output.write(reinterpret_cast<const char*>(&m_width), sizeof(m_width));
+    output.write(reinterpret_cast<const char*>(&m_height), sizeof(m_height));
+
+    for (size_t y = 0, ye = m_height; y < ye; ++y)
+        m_cols_cdf[y].write(output);
+
+    m_rows_cdf.write(output);
+}
+
+template <typename Payload, typename Importance, template <typename, typename> class Distribution>
+bool ImageImportanceSampler<Payload, Importance, Distribution>::read(std::istream& input)
+{
+    size_t width, height;
+
+    input.read(reinterpret_cast<char*>(&width), sizeof(width));
+    input.read(reinterpret_cast<char*>(&height), sizeof(height));
+
+    if (!input || width != m_width || height != m_height)
+        return false;
+
+    for (size_t y = 0, ye = m_height; y < ye; ++y)
+    {
+        if (!m_cols_cdf[y].read(input))
+            return false;
+    }
+
+    return m_rows_cdf.read(input);
+}
+
+template <typename Payload, typename Importance, template <typename, typename> class Distribution>
+inline void ImageImportanceSampler<Payload, Importance, Distribution>::sample(
     const Vector2Type&      s,
     size_t&                 x,
     size_t&                 y,
@@ -229,8 +307,8 @@ inline void ImageImportanceSampler<Payload, Importance>::sample(
     assert(probability > Importance(0.0));
 }
 
-template <typename Payload, typename Importance>
-inline void ImageImportanceSampler<Payload, Importance>::sample(
+template <typename Payload, typename Importance, template <typename, typename> class Distribution>
+inline void ImageImportanceSampler<Payload, Importance, Distribution>::sample(
     const Vector2Type&      s,
     size_t&                 x,
     size_t&                 y,
@@ -265,8 +343,8 @@ inline void ImageImportanceSampler<Payload, Importance>::sample(
     assert(probability > Importance(0.0));
 }
 
-template <typename Payload, typename Importance>
-inline Importance ImageImportanceSampler<Payload, Importance>::get_pdf(
+template <typename Payload, typename Importance, template <typename, typename> class Distribution>
+inline Importance ImageImportanceSampler<Payload, Importance, Distribution>::get_pdf(
     const size_t            x,
     const size_t            y) const
 {
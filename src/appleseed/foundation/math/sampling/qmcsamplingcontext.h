@@ -31,11 +31,13 @@
 #define APPLESEED_FOUNDATION_MATH_SAMPLING_QMCSAMPLINGCONTEXT_H
 
 // appleseed.foundation headers.
+#include "foundation/math/bluenoise.h"
 #include "foundation/math/permutation.h"
 #include "foundation/math/primes.h"
 #include "foundation/math/qmc.h"
 #include "foundation/math/rng/distribution.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/test/helpers.h"
 
 // Standard headers.
@@ -47,6 +49,8 @@ DECLARE_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, InitialStateIsCor
 DECLARE_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, TestAssignmentOperator);
 DECLARE_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, TestSplitting);
 DECLARE_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, TestDoubleSplitting);
+DECLARE_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, TestSplittingZeroDimensionalContext);
+DECLARE_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, TestDitheringIsInheritedBySplitting);
 
 namespace foundation
 {
@@ -59,11 +63,24 @@ namespace foundation
 //   - Cranley-Patterson rotation
 //   - Monte Carlo padding
 //
-// Reference:
+// Alternatively, samples can be drawn from an Owen-scrambled Sobol sequence
+// padded with a different seed for each trajectory split.
+//
+// In both modes, the samples can additionally be rotated by per-pixel values
+// read from a blue-noise mask. When all pixels share the same sequence, this
+// distributes the error as blue noise in screen space.
+//
+// References:
 //
 //   Kollig and Keller, Efficient Multidimensional Sampling
 //   www.uni-kl.de/AG-Heinrich/EMS.pdf
 //
+//   Brent Burley, Practical Hash-based Owen Scrambling
+//   http://jcgt.org/published/0009/04/01/
+//
+//   Iliyan Georgiev and Marcos Fajardo, Blue-noise dithered sampling
+//   https://www.arnoldrenderer.com/research/dither_abstract.pdf
+//
 
 template <typename RNG>
 class QMCSamplingContext
@@ -72,10 +89,11 @@ class QMCSamplingContext
     // Random number generator type.
     typedef RNG RNGType;
 
-    // This sampler can operate in two modes:
+    // This sampler can operate in three modes:
     //   1. In QMC mode, it uses possibly patent-encumbered techniques.
     //   2. In RNG mode, it works like RNGSamplingContext and sticks to random sampling.
-    enum Mode { QMCMode, RNGMode };
+    //   3. In Sobol mode, it uses Owen-scrambled Sobol sequences and doesn't consume random numbers.
+    enum Mode { QMCMode, RNGMode, SobolMode };
 
     // Construct a sampling context of dimension 0. It cannot be used
     // directly; only child contexts obtained by splitting can.
@@ -85,7 +103,11 @@ class QMCSamplingContext
 
     // Construct a sampling context for a given number of dimensions
     // and samples. Set sample_count to 0 if the required number of
-    // samples is unknown or infinite.
+    // samples is unknown or infinite. A context of dimension 0 can be
+    // split to obtain a child context whose base instance number is
+    // the given instance number: its Cranley-Patterson offsets are
+    // computed once and its samples are drawn from the start of the
+    // precomputed sequence.
     QMCSamplingContext(
         RNG&            rng,
         const Mode      mode,
@@ -110,6 +132,12 @@ class QMCSamplingContext
     // Set the instance number.
     void set_instance(const size_t instance);
 
+    // Enable blue-noise dithering at a given pixel for all sampling
+    // contexts subsequently split from this one. Has no effect in RNG mode.
+    void set_dither_pixel(
+        const size_t    x,
+        const size_t    y);
+
     // Return the next sample in [0,1)^N.
     // Works for scalars and foundation::Vector<>.
     template <typename T> T next2();
@@ -125,6 +153,8 @@ class QMCSamplingContext
     GRANT_ACCESS_TO_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, TestAssignmentOperator);
     GRANT_ACCESS_TO_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, TestSplitting);
     GRANT_ACCESS_TO_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, TestDoubleSplitting);
+    GRANT_ACCESS_TO_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, TestSplittingZeroDimensionalContext);
+    GRANT_ACCESS_TO_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, TestDitheringIsInheritedBySplitting);
 
     typedef Vector<double, 4> VectorType;
 
@@ -140,6 +170,10 @@ class QMCSamplingContext
     size_t      m_instance;
     VectorType  m_offset;
 
+    bool        m_dither;
+    size_t      m_dither_x;
+    size_t      m_dither_y;
+
     // Cranley-Patterson rotation.
     template <typename T>
     static T rotate(T x, const T offset);
@@ -150,8 +184,12 @@ class QMCSamplingContext
         const size_t    base_dimension,
         const size_t    base_instance,
         const size_t    dimension,
-        const size_t    sample_count);
+        const size_t    sample_count,
+        const bool      dither,
+        const size_t    dither_x,
+        const size_t    dither_y);
 
+    bool has_offset() const;
     void compute_offset();
 
     template <typename T> struct Tag {};
@@ -177,6 +215,9 @@ inline QMCSamplingContext<RNG>::QMCSamplingContext(
   , m_sample_count(0)
   , m_instance(0)
   , m_offset(0.0)
+  , m_dither(false)
+  , m_dither_x(0)
+  , m_dither_y(0)
 {
 }
 
@@ -195,6 +236,9 @@ inline QMCSamplingContext<RNG>::QMCSamplingContext(
   , m_sample_count(sample_count)
   , m_instance(instance)
   , m_offset(0.0)
+  , m_dither(false)
+  , m_dither_x(0)
+  , m_dither_y(0)
 {
     assert(dimension <= VectorType::Dimension);
 }
@@ -206,7 +250,10 @@ inline QMCSamplingContext<RNG>::QMCSamplingContext(
     const size_t        base_dimension,
     const size_t        base_instance,
     const size_t        dimension,
-    const size_t        sample_count)
+    const size_t        sample_count,
+    const bool          dither,
+    const size_t        dither_x,
+    const size_t        dither_y)
   : m_rng(rng)
   , m_mode(mode)
   , m_base_dimension(base_dimension)
@@ -214,10 +261,13 @@ inline QMCSamplingContext<RNG>::QMCSamplingContext(
   , m_dimension(dimension)
   , m_sample_count(sample_count)
   , m_instance(0)
+  , m_dither(dither)
+  , m_dither_x(dither_x)
+  , m_dither_y(dither_y)
 {
     assert(dimension <= VectorType::Dimension);
 
-    if (m_mode == QMCMode)
+    if (has_offset())
         compute_offset();
 }
 
@@ -232,6 +282,9 @@ QMCSamplingContext<RNG>::operator=(const QMCSamplingContext& rhs)
     m_sample_count = rhs.m_sample_count;
     m_instance = rhs.m_instance;
     m_offset = rhs.m_offset;
+    m_dither = rhs.m_dither;
+    m_dither_x = rhs.m_dither_x;
+    m_dither_y = rhs.m_dither_y;
 
     return *this;
 }
@@ -248,7 +301,10 @@ inline QMCSamplingContext<RNG> QMCSamplingContext<RNG>::split(
             m_base_dimension + m_dimension,         // dimension allocation
             m_base_instance + m_instance,           // decorrelation by generalization
             dimension,
-            sample_count);
+            sample_count,
+            m_dither,
+            m_dither_x,
+            m_dither_y);
 }
 
 template <typename RNG>
@@ -265,7 +321,7 @@ inline void QMCSamplingContext<RNG>::split_in_place(
     m_sample_count = sample_count;
     m_instance = 0;
 
-    if (m_mode == QMCMode)
+    if (has_offset())
         compute_offset();
 }
 
@@ -275,6 +331,16 @@ inline void QMCSamplingContext<RNG>::set_instance(const size_t instance)
     m_instance = instance;
 }
 
+template <typename RNG>
+inline void QMCSamplingContext<RNG>::set_dither_pixel(
+    const size_t        x,
+    const size_t        y)
+{
+    m_dither = true;
+    m_dither_x = x;
+    m_dither_y = y;
+}
+
 template <typename RNG>
 template <typename T>
 inline T QMCSamplingContext<RNG>::next2()
@@ -308,12 +374,23 @@ inline T QMCSamplingContext<RNG>::rotate(T x, const T offset)
     return x;
 }
 
+template <typename RNG>
+inline bool QMCSamplingContext<RNG>::has_offset() const
+{
+    return m_mode == QMCMode || (m_mode == SobolMode && m_dither);
+}
+
 template <typename RNG>
 inline void QMCSamplingContext<RNG>::compute_offset()
 {
     for (size_t i = 0, d = m_base_dimension; i < m_dimension; ++i, ++d)
     {
-        if (d < FaurePermutationTableSize)
+        if (m_mode == SobolMode)
+        {
+            // Sobol samples are only rotated when dithering.
+            m_offset[i] = 0.0;
+        }
+        else if (d < FaurePermutationTableSize)
         {
             assert(d < PrimeTableSize);
 
@@ -328,6 +405,9 @@ inline void QMCSamplingContext<RNG>::compute_offset()
             // Monte Carlo padding.
             m_offset[i] = rand_double2(m_rng);
         }
+
+        if (m_dither)
+            m_offset[i] = rotate(m_offset[i], blue_noise_dither<double>(m_dither_x, m_dither_y, d));
     }
 }
 
@@ -370,6 +450,20 @@ inline Vector<T, N> QMCSamplingContext<RNG>::next2(Tag<Vector<T, N> >)
             }
         }
     }
+    else if (m_mode == SobolMode)
+    {
+        // Each trajectory split draws from the same low-dimensional sequence
+        // with its own seed, and consecutive instances remain stratified.
+        v = owen_scrambled_sobol_sequence<T, N>(
+                static_cast<uint32>(m_base_dimension),
+                static_cast<uint32>(m_base_instance + m_instance));
+
+        if (m_dither)
+        {
+            for (size_t i = 0; i < N; ++i)
+                v[i] = rotate(v[i], static_cast<T>(m_offset[i]));
+        }
+    }
     else
     {
         for (size_t i = 0; i < N; ++i)
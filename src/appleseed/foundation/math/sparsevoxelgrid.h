@@ -0,0 +1,387 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_SPARSEVOXELGRID_H
+#define APPLESEED_FOUNDATION_MATH_SPARSEVOXELGRID_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/math/voxelgrid.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// A sparse 3D grid of voxels.
+//
+// The grid is divided into bricks of 8x8x8 voxels. Bricks are only allocated
+// when one of their voxels is written to, and voxels of unallocated bricks read
+// as zero. This makes large, mostly empty volumes affordable while keeping
+// lookups within a brick as cheap as in VoxelGrid3.
+//
+
+template <typename ValueType, typename CoordType>
+class SparseVoxelGrid3
+  : public NonCopyable
+{
+  public:
+    // Types.
+    typedef Vector<CoordType, 3> PointType;
+
+    // Number of voxels along each side of a brick.
+    static const size_t BrickSize = 8;
+
+    // Constructor.
+    SparseVoxelGrid3(
+        const size_t        nx,
+        const size_t        ny,
+        const size_t        nz,
+        const size_t        channel_count);
+
+    // Get the grid properties.
+    size_t get_xres() const;
+    size_t get_yres() const;
+    size_t get_zres() const;
+    size_t get_channel_count() const;
+
+    // Return the number of allocated bricks.
+    size_t get_brick_count() const;
+
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
+    // Direct access to a given voxel. The non-const version allocates the
+    // brick containing the voxel if necessary; the const version returns
+    // a voxel filled with zeroes if the brick is not allocated.
+    ValueType* voxel(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z);
+    const ValueType* voxel(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+
+    // Return true if the voxel containing a given point belongs to an unallocated brick.
+    // 'point' must be expressed in the unit cube [0,1]^3.
+    bool is_empty(const PointType& point) const;
+
+    // Perform an unfiltered lookup of the voxel grid.
+    // 'point' must be expressed in the unit cube [0,1]^3.
+    void nearest_lookup(
+        const PointType&    point,
+        ValueType*          values) const;
+
+    // Perform a trilinearly interpolated lookup of the voxel grid.
+    // 'point' must be expressed in the unit cube [0,1]^3.
+    void linear_lookup(
+        const PointType&    point,
+        ValueType*          values) const;
+
+  private:
+    static const uint32     EmptyBrick = ~uint32(0);
+    static const size_t     BrickVoxelCount = BrickSize * BrickSize * BrickSize;
+
+    const size_t            m_nx;
+    const size_t            m_ny;
+    const size_t            m_nz;
+    const CoordType         m_scalar_nx;
+    const CoordType         m_scalar_ny;
+    const CoordType         m_scalar_nz;
+    const CoordType         m_max_x;
+    const CoordType         m_max_y;
+    const CoordType         m_max_z;
+    const size_t            m_channel_count;
+    const size_t            m_bx;
+    const size_t            m_by;
+    const size_t            m_bz;
+    std::vector<uint32>     m_brick_indices;    // top-level index, EmptyBrick for unallocated bricks
+    std::vector<ValueType>  m_brick_values;     // values of all allocated bricks, brick after brick
+    std::vector<ValueType>  m_empty_voxel;
+
+    size_t brick_index(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+};
+
+
+//
+// SparseVoxelGrid3 class implementation.
+//
+
+template <typename ValueType, typename CoordType>
+const size_t SparseVoxelGrid3<ValueType, CoordType>::BrickSize;
+
+template <typename ValueType, typename CoordType>
+const uint32 SparseVoxelGrid3<ValueType, CoordType>::EmptyBrick;
+
+template <typename ValueType, typename CoordType>
+const size_t SparseVoxelGrid3<ValueType, CoordType>::BrickVoxelCount;
+
+template <typename ValueType, typename CoordType>
+SparseVoxelGrid3<ValueType, CoordType>::SparseVoxelGrid3(
+    const size_t            nx,
+    const size_t            ny,
+    const size_t            nz,
+    const size_t            channel_count)
+  : m_nx(nx)
+  , m_ny(ny)
+  , m_nz(nz)
+  , m_scalar_nx(static_cast<CoordType>(nx))
+  , m_scalar_ny(static_cast<CoordType>(ny))
+  , m_scalar_nz(static_cast<CoordType>(nz))
+  , m_max_x(static_cast<CoordType>(nx - 1))
+  , m_max_y(static_cast<CoordType>(ny - 1))
+  , m_max_z(static_cast<CoordType>(nz - 1))
+  , m_channel_count(channel_count)
+  , m_bx((nx + BrickSize - 1) / BrickSize)
+  , m_by((ny + BrickSize - 1) / BrickSize)
+  , m_bz((nz + BrickSize - 1) / BrickSize)
+  , m_brick_indices(m_bx * m_by * m_bz, EmptyBrick)
+  , m_empty_voxel(channel_count, ValueType(0.0))
+{
+    assert(m_nx > 0);
+    assert(m_ny > 0);
+    assert(m_nz > 0);
+    assert(m_channel_count > 0);
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::get_xres() const
+{
+    return m_nx;
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::get_yres() const
+{
+    return m_ny;
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::get_zres() const
+{
+    return m_nz;
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::get_channel_count() const
+{
+    return m_channel_count;
+}
+
+template <typename ValueType, typename CoordType>
+inline size_t SparseVoxelGrid3<ValueType, CoordType>::get_brick_count() const
+{
+    return m_brick_values.size() / (BrickVoxelCount * m_channel_count);
+}
+
+template <typename ValueType, typename CoordType>
+inline size_t SparseVoxelGrid3<ValueType, CoordType>::get_memory_size() const
+{
+    return
+          sizeof(*this)
+        + m_brick_indices.capacity() * sizeof(uint32)
+        + m_brick_values.capacity() * sizeof(ValueType)
+        + m_empty_voxel.capacity() * sizeof(ValueType);
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::brick_index(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z) const
+{
+    return ((z / BrickSize) * m_by + (y / BrickSize)) * m_bx + (x / BrickSize);
+}
+
+template <typename ValueType, typename CoordType>
+ValueType* SparseVoxelGrid3<ValueType, CoordType>::voxel(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z)
+{
+    assert(x < m_nx);
+    assert(y < m_ny);
+    assert(z < m_nz);
+
+    const size_t brick_value_count = BrickVoxelCount * m_channel_count;
+
+    uint32& brick = m_brick_indices[brick_index(x, y, z)];
+    if (brick == EmptyBrick)
+    {
+        brick = static_cast<uint32>(m_brick_values.size() / brick_value_count);
+        m_brick_values.resize(m_brick_values.size() + brick_value_count, ValueType(0.0));
+    }
+
+    const size_t voxel_index =
+        ((z % BrickSize) * BrickSize + (y % BrickSize)) * BrickSize + (x % BrickSize);
+
+    return &m_brick_values[brick * brick_value_count + voxel_index * m_channel_count];
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE const ValueType* SparseVoxelGrid3<ValueType, CoordType>::voxel(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z) const
+{
+    assert(x < m_nx);
+    assert(y < m_ny);
+    assert(z < m_nz);
+
+    const uint32 brick = m_brick_indices[brick_index(x, y, z)];
+    if (brick == EmptyBrick)
+        return &m_empty_voxel[0];
+
+    const size_t voxel_index =
+        ((z % BrickSize) * BrickSize + (y % BrickSize)) * BrickSize + (x % BrickSize);
+
+    return &m_brick_values[(brick * BrickVoxelCount + voxel_index) * m_channel_count];
+}
+
+template <typename ValueType, typename CoordType>
+bool SparseVoxelGrid3<ValueType, CoordType>::is_empty(const PointType& point) const
+{
+    const size_t ix = truncate<size_t>(clamp(point.x * m_scalar_nx, CoordType(0.0), m_max_x));
+    const size_t iy = truncate<size_t>(clamp(point.y * m_scalar_ny, CoordType(0.0), m_max_y));
+    const size_t iz = truncate<size_t>(clamp(point.z * m_scalar_nz, CoordType(0.0), m_max_z));
+
+    return m_brick_indices[brick_index(ix, iy, iz)] == EmptyBrick;
+}
+
+template <typename ValueType, typename CoordType>
+void SparseVoxelGrid3<ValueType, CoordType>::nearest_lookup(
+    const PointType&                point,
+    ValueType* APPLESEED_RESTRICT   values) const
+{
+    // Compute the coordinates of the voxel containing the lookup point.
+    const CoordType x = clamp(point.x * m_scalar_nx, CoordType(0.0), m_max_x);
+    const CoordType y = clamp(point.y * m_scalar_ny, CoordType(0.0), m_max_y);
+    const CoordType z = clamp(point.z * m_scalar_nz, CoordType(0.0), m_max_z);
+    const size_t ix = truncate<size_t>(x);
+    const size_t iy = truncate<size_t>(y);
+    const size_t iz = truncate<size_t>(z);
+
+    // Return the values of that voxel.
+    const ValueType* APPLESEED_RESTRICT source = voxel(ix, iy, iz);
+    for (size_t i = 0; i < m_channel_count; ++i)
+        *values++ = *source++;
+}
+
+template <typename ValueType, typename CoordType>
+void SparseVoxelGrid3<ValueType, CoordType>::linear_lookup(
+    const PointType&                point,
+    ValueType* APPLESEED_RESTRICT   values) const
+{
+    // Compute the coordinates of the voxel containing the lookup point.
+    const CoordType x = saturate(point.x) * m_max_x;
+    const CoordType y = saturate(point.y) * m_max_y;
+    const CoordType z = saturate(point.z) * m_max_z;
+    const size_t ix = truncate<size_t>(x);
+    const size_t iy = truncate<size_t>(y);
+    const size_t iz = truncate<size_t>(z);
+    const size_t ix1 = ix == m_nx - 1 ? ix : ix + 1;
+    const size_t iy1 = iy == m_ny - 1 ? iy : iy + 1;
+    const size_t iz1 = iz == m_nz - 1 ? iz : iz + 1;
+
+    // Compute interpolation weights.
+    const ValueType x1 = static_cast<ValueType>(x - ix);
+    const ValueType y1 = static_cast<ValueType>(y - iy);
+    const ValueType z1 = static_cast<ValueType>(z - iz);
+    const ValueType x0 = ValueType(1.0) - x1;
+    const ValueType y0 = ValueType(1.0) - y1;
+    const ValueType z0 = ValueType(1.0) - z1;
+    const ValueType y0z0 = y0 * z0;
+    const ValueType y1z0 = y1 * z0;
+    const ValueType y0z1 = y0 * z1;
+    const ValueType y1z1 = y1 * z1;
+    const ValueType weights[8] =
+    {
+        x0 * y0z0, x1 * y0z0, x0 * y1z0, x1 * y1z0,
+        x0 * y0z1, x1 * y0z1, x0 * y1z1, x1 * y1z1
+    };
+
+    const ValueType* src[8];
+
+    if ((ix % BrickSize) < BrickSize - 1 &&
+        (iy % BrickSize) < BrickSize - 1 &&
+        (iz % BrickSize) < BrickSize - 1)
+    {
+        // Fast path: the eight voxels belong to the same brick.
+        const uint32 brick = m_brick_indices[brick_index(ix, iy, iz)];
+        if (brick == EmptyBrick)
+        {
+            for (size_t i = 0; i < m_channel_count; ++i)
+                values[i] = ValueType(0.0);
+            return;
+        }
+
+        const size_t dx = (ix1 - ix) * m_channel_count;
+        const size_t dy = (iy1 - iy) * BrickSize * m_channel_count;
+        const size_t dz = (iz1 - iz) * BrickSize * BrickSize * m_channel_count;
+        src[0] = voxel(ix, iy, iz);
+        src[1] = src[0] + dx;
+        src[2] = src[0] + dy;
+        src[3] = src[1] + dy;
+        src[4] = src[0] + dz;
+        src[5] = src[1] + dz;
+        src[6] = src[2] + dz;
+        src[7] = src[3] + dz;
+    }
+    else
+    {
+        // The eight voxels straddle several bricks.
+        src[0] = voxel(ix,  iy,  iz);
+        src[1] = voxel(ix1, iy,  iz);
+        src[2] = voxel(ix,  iy1, iz);
+        src[3] = voxel(ix1, iy1, iz);
+        src[4] = voxel(ix,  iy,  iz1);
+        src[5] = voxel(ix1, iy,  iz1);
+        src[6] = voxel(ix,  iy1, iz1);
+        src[7] = voxel(ix1, iy1, iz1);
+    }
+
+    // Blend.
+    voxelgrid_impl::blend_trilinear(src, weights, m_channel_count, values);
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_SPARSEVOXELGRID_H
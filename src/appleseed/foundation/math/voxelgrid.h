@@ -35,6 +35,9 @@
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/compiler.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
 
 // Standard headers.
 #include <cassert>
@@ -44,6 +47,18 @@
 namespace foundation
 {
 
+namespace voxelgrid_impl
+{
+    // Blend the values of the eight corners of a voxel cell.
+    template <typename ValueType>
+    void blend_trilinear(
+        const ValueType* const  src[8],
+        const ValueType         weights[8],
+        const size_t            channel_count,
+        ValueType*              values);
+}
+
+
 //
 // A regular 3D grid of voxel.
 //
@@ -244,33 +259,24 @@ void VoxelGrid3<ValueType, CoordType>::linear_lookup(
     const ValueType w011 = x0 * y1z1;
     const ValueType w111 = x1 * y1z1;
 
+    const ValueType weights[8] = { w000, w100, w010, w110, w001, w101, w011, w111 };
+
     // Compute source pointers.
     const size_t dx = ix == m_nx - 1 ? 0 : m_channel_count;
     const size_t dy = iy == m_ny - 1 ? 0 : m_row_size;
     const size_t dz = iz == m_nz - 1 ? 0 : m_slice_size;
-    const ValueType* APPLESEED_RESTRICT src = voxel(ix, iy, iz);
-    const ValueType* APPLESEED_RESTRICT src000 = src;
-    const ValueType* APPLESEED_RESTRICT src100 = src + dx;
-    const ValueType* APPLESEED_RESTRICT src010 = src + dy;
-    const ValueType* APPLESEED_RESTRICT src001 = src + dz;
-    const ValueType* APPLESEED_RESTRICT src110 = src100 + dy;
-    const ValueType* APPLESEED_RESTRICT src101 = src100 + dz;
-    const ValueType* APPLESEED_RESTRICT src011 = src010 + dz;
-    const ValueType* APPLESEED_RESTRICT src111 = src110 + dz;
+    const ValueType* src000 = voxel(ix, iy, iz);
+    const ValueType* src100 = src000 + dx;
+    const ValueType* src010 = src000 + dy;
+    const ValueType* src110 = src100 + dy;
+    const ValueType* const src[8] =
+    {
+        src000, src100, src010, src110,
+        src000 + dz, src100 + dz, src010 + dz, src110 + dz
+    };
 
     // Blend.
-    for (size_t i = 0; i < m_channel_count; ++i)
-    {
-       *values++ =
-           *src000++ * w000 +
-           *src100++ * w100 +
-           *src010++ * w010 +
-           *src110++ * w110 +
-           *src001++ * w001 +
-           *src101++ * w101 +
-           *src011++ * w011 +
-           *src111++ * w111;
-    }
+    voxelgrid_impl::blend_trilinear(src, weights, m_channel_count, values);
 }
 
 template <typename ValueType, typename CoordType>
@@ -396,6 +402,81 @@ void VoxelGrid3<ValueType, CoordType>::quadratic_lookup(
     }
 }
 
+
+//
+// Trilinear blending implementation.
+//
+
+namespace voxelgrid_impl
+{
+    template <typename ValueType>
+    inline void blend_trilinear(
+        const ValueType* const          src[8],
+        const ValueType                 weights[8],
+        const size_t                    channel_count,
+        ValueType* APPLESEED_RESTRICT   values)
+    {
+        for (size_t i = 0; i < channel_count; ++i)
+        {
+            values[i] =
+                src[0][i] * weights[0] +
+                src[1][i] * weights[1] +
+                src[2][i] * weights[2] +
+                src[3][i] * weights[3] +
+                src[4][i] * weights[4] +
+                src[5][i] * weights[5] +
+                src[6][i] * weights[6] +
+                src[7][i] * weights[7];
+        }
+    }
+
+#ifdef APPLESEED_USE_SSE
+
+    template <>
+    inline void blend_trilinear(
+        const float* const              src[8],
+        const float                     weights[8],
+        const size_t                    channel_count,
+        float* APPLESEED_RESTRICT       values)
+    {
+        const __m128 w0 = _mm_set1_ps(weights[0]);
+        const __m128 w1 = _mm_set1_ps(weights[1]);
+        const __m128 w2 = _mm_set1_ps(weights[2]);
+        const __m128 w3 = _mm_set1_ps(weights[3]);
+        const __m128 w4 = _mm_set1_ps(weights[4]);
+        const __m128 w5 = _mm_set1_ps(weights[5]);
+        const __m128 w6 = _mm_set1_ps(weights[6]);
+        const __m128 w7 = _mm_set1_ps(weights[7]);
+
+        // Blend four channels at a time.
+        size_t i = 0;
+        for (; i + 4 <= channel_count; i += 4)
+        {
+            const __m128 a = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src[0] + i), w0), _mm_mul_ps(_mm_loadu_ps(src[1] + i), w1));
+            const __m128 b = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src[2] + i), w2), _mm_mul_ps(_mm_loadu_ps(src[3] + i), w3));
+            const __m128 c = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src[4] + i), w4), _mm_mul_ps(_mm_loadu_ps(src[5] + i), w5));
+            const __m128 d = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src[6] + i), w6), _mm_mul_ps(_mm_loadu_ps(src[7] + i), w7));
+            _mm_storeu_ps(values + i, _mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(c, d)));
+        }
+
+        // Blend the remaining channels.
+        for (; i < channel_count; ++i)
+        {
+            values[i] =
+                src[0][i] * weights[0] +
+                src[1][i] * weights[1] +
+                src[2][i] * weights[2] +
+                src[3][i] * weights[3] +
+                src[4][i] * weights[4] +
+                src[5][i] * weights[5] +
+                src[6][i] * weights[6] +
+                src[7][i] * weights[7];
+        }
+    }
+
+#endif  // APPLESEED_USE_SSE
+}
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_MATH_VOXELGRID_H
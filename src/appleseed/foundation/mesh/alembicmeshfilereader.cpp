@@ -34,7 +34,10 @@
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/vector.h"
 #include "foundation/mesh/imeshbuilder.h"
+#include "foundation/platform/system.h"
 #include "foundation/platform/types.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
 #include "foundation/utility/memory.h"
 
 // Alembic headers.
@@ -55,6 +58,7 @@ END_EXR_INCLUDES
 
 // Standard headers.
 #include <cstddef>
+#include <string>
 #include <vector>
 
 using namespace Alembic;
@@ -66,26 +70,65 @@ namespace foundation
 
 namespace
 {
-    class MeshObjectReader
+    // The sample of a mesh at the requested time.
+    struct MeshSample
+    {
+        string                      m_name;
+        IPolyMeshSchema::Sample     m_mesh_sample;
+        IN3fGeomParam::Sample       m_normal_sample;
+        IV2fGeomParam::Sample       m_uv_sample;
+    };
+
+    class FetchMeshSampleJob
+      : public IJob
+    {
+      public:
+        FetchMeshSampleJob(
+            IPolyMesh               mesh,
+            const ISampleSelector&  selector,
+            MeshSample&             sample)
+          : m_mesh(mesh)
+          , m_selector(selector)
+          , m_sample(sample)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            IPolyMeshSchema& mesh_schema = m_mesh.getSchema();
+
+            m_sample.m_name = m_mesh.getName();
+            mesh_schema.get(m_sample.m_mesh_sample, m_selector);
+
+            IN3fGeomParam normal_param = mesh_schema.getNormalsParam();
+            if (normal_param.valid())
+                m_sample.m_normal_sample = normal_param.getIndexedValue(m_selector);
+
+            IV2fGeomParam uv_param = mesh_schema.getUVsParam();
+            if (uv_param.valid())
+                m_sample.m_uv_sample = uv_param.getIndexedValue(m_selector);
+        }
+
+      private:
+        IPolyMesh               m_mesh;
+        const ISampleSelector   m_selector;
+        MeshSample&             m_sample;
+    };
+
+    class MeshSampleReader
       : public NonCopyable
     {
       public:
-        explicit MeshObjectReader(IMeshBuilder& mesh_builder)
+        explicit MeshSampleReader(IMeshBuilder& mesh_builder)
           : m_mesh_builder(mesh_builder)
           , m_has_vertex_normals(false)
           , m_has_uv(false)
         {
         }
 
-        void read(IPolyMesh mesh)
+        void read(const MeshSample& sample)
         {
-            IPolyMeshSchema& mesh_schema = mesh.getSchema();
-
-            // todo: pass as parameter.
-            const size_t sample_index = 0;
-
-            IPolyMeshSchema::Sample mesh_sample;
-            mesh_schema.get(mesh_sample, sample_index);
+            const IPolyMeshSchema::Sample& mesh_sample = sample.m_mesh_sample;
 
             if (!mesh_sample)
                 return;
@@ -94,16 +137,11 @@ namespace
             if (mesh_sample.getPositions()->size() < 3)
                 return;
 
-            m_mesh_builder.begin_mesh(mesh.getName().c_str());
+            m_mesh_builder.begin_mesh(sample.m_name.c_str());
 
             read_vertices(mesh_sample);
-            read_vertex_normals(mesh_schema);
-            read_uv(mesh_schema);
-
-            // Use the mesh topology of the first sample.
-            mesh_sample.reset();
-            mesh_schema.get(mesh_sample, 0);
-
+            read_vertex_normals(sample.m_normal_sample);
+            read_uv(sample.m_uv_sample);
             read_face_indices(mesh_sample);
 
             m_mesh_builder.end_mesh();
@@ -114,7 +152,7 @@ namespace
         bool            m_has_vertex_normals;
         bool            m_has_uv;
 
-        void read_vertices(IPolyMeshSchema::Sample mesh_sample)
+        void read_vertices(const IPolyMeshSchema::Sample& mesh_sample)
         {
             const Imath::V3f* vertices = mesh_sample.getPositions()->get();
             const size_t vertex_count = mesh_sample.getPositions()->size();
@@ -126,13 +164,8 @@ namespace
             }
         }
 
-        void read_vertex_normals(IPolyMeshSchema& mesh_schema)
+        void read_vertex_normals(const IN3fGeomParam::Sample& normal_sample)
         {
-            IN3fGeomParam normal_param = mesh_schema.getNormalsParam();
-            if (!normal_param.valid())
-                return;
-
-            IN3fGeomParam::Sample normal_sample(normal_param.getIndexedValue());
             if (!normal_sample.valid())
                 return;
 
@@ -148,13 +181,8 @@ namespace
             m_has_vertex_normals = normal_count > 0;
         }
 
-        void read_uv(IPolyMeshSchema& mesh_schema)
+        void read_uv(const IV2fGeomParam::Sample& uv_sample)
         {
-            IV2fGeomParam uv_param = mesh_schema.getUVsParam();
-            if (!uv_param.valid())
-                return;
-
-            IV2fGeomParam::Sample uv_sample(uv_param.getIndexedValue());
             if (!uv_sample.valid())
                 return;
 
@@ -170,7 +198,7 @@ namespace
             m_has_uv = uv_count > 0;
         }
 
-        void read_face_indices(IPolyMeshSchema::Sample mesh_sample)
+        void read_face_indices(const IPolyMeshSchema::Sample& mesh_sample)
         {
             const int32* face_sizes = mesh_sample.getFaceCounts()->get();
             const size_t face_count = mesh_sample.getFaceCounts()->size();
@@ -213,7 +241,8 @@ namespace
         }
     };
 
-    void read_object(IObject object, IMeshBuilder& builder)
+    // Collect all the meshes of a hierarchy of objects, in depth-first order.
+    void collect_meshes(IObject object, vector<IPolyMesh>& meshes)
     {
         const size_t children_count = object.getNumChildren();
 
@@ -222,18 +251,18 @@ namespace
             const ObjectHeader& child_header = object.getChildHeader(i);
 
             if (IPolyMesh::matches(child_header))
-            {
-                MeshObjectReader mesh_reader(builder);
-                mesh_reader.read(IPolyMesh(object, child_header.getName()));
-            }
+                meshes.push_back(IPolyMesh(object, child_header.getName()));
 
-            read_object(object.getChild(i), builder);
+            collect_meshes(object.getChild(i), meshes);
         }
     }
 }
 
-AlembicMeshFileReader::AlembicMeshFileReader(const string& filename)
+AlembicMeshFileReader::AlembicMeshFileReader(
+    const string&   filename,
+    const double    sample_time)
   : m_filename(filename)
+  , m_sample_time(sample_time)
 {
 }
 
@@ -241,7 +270,33 @@ void AlembicMeshFileReader::read(IMeshBuilder& builder)
 {
     const IArchive archive(AbcCoreHDF5::ReadArchive(), m_filename);
 
-    read_object(IObject(archive, kTop), builder);
+    vector<IPolyMesh> meshes;
+    collect_meshes(IObject(archive, kTop), meshes);
+
+    // Fetch the samples of all meshes concurrently.
+    const ISampleSelector selector(m_sample_time, ISampleSelector::kNearIndex);
+    vector<MeshSample> samples(meshes.size());
+
+    JobQueue job_queue;
+    for (size_t i = 0, e = meshes.size(); i < e; ++i)
+        job_queue.schedule(new FetchMeshSampleJob(meshes[i], selector, samples[i]));
+
+    Logger logger;
+    JobManager job_manager(
+        logger,
+        job_queue,
+        System::get_available_cpu_core_count(),
+        JobManager::KeepRunningOnEmptyQueue);
+
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    // Pass the meshes to the builder, in archive order.
+    for (size_t i = 0, e = samples.size(); i < e; ++i)
+    {
+        MeshSampleReader mesh_reader(builder);
+        mesh_reader.read(samples[i]);
+    }
 }
 
 }   // namespace foundation
@@ -51,19 +51,25 @@ namespace foundation
 //   http://www.alembic.io
 //   http://code.google.com/p/alembic/
 //
+// The samples of all the meshes of the archive are fetched concurrently;
+// meshes are then passed to the mesh builder one at a time, in archive order.
+//
 
 class AlembicMeshFileReader
   : public IMeshFileReader
 {
   public:
-    // Constructor.
-    explicit AlembicMeshFileReader(const std::string& filename);
+    // Constructor. Only the sample of each mesh nearest to sample_time is read.
+    explicit AlembicMeshFileReader(
+        const std::string&  filename,
+        const double        sample_time = 0.0);
 
     // Read a mesh.
     virtual void read(IMeshBuilder& builder) APPLESEED_OVERRIDE;
 
   private:
-    const std::string m_filename;
+    const std::string   m_filename;
+    const double        m_sample_time;
 };
 
 }       // namespace foundation
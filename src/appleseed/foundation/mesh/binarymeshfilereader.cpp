@@ -39,6 +39,9 @@
 #include "foundation/utility/bufferedfile.h"
 #include "foundation/utility/memory.h"
 
+// lz4 headers.
+#include "lz4.h"
+
 // Standard headers.
 #include <cstring>
 #include <memory>
@@ -76,6 +79,9 @@ namespace
     {
         checked_read(file, &object, sizeof(T));
     }
+
+    // Alignment in bytes of chunk data in the file.
+    const size_t ChunkAlignment = 16;
 }
 
 BinaryMeshFileReader::BinaryMeshFileReader(const string& filename)
@@ -118,6 +124,11 @@ void BinaryMeshFileReader::read(IMeshBuilder& builder)
         reader.reset(new LZ4CompressedReaderAdapter(file));
         break;
 
+      // Bulk arrays in LZ4-compressed chunks.
+      case 4:
+        read_bulk_meshes(file, builder);
+        return;
+
       // Unknown format.
       default:
         throw ExceptionIOError("unknown binarymesh format version");
@@ -280,4 +291,171 @@ void BinaryMeshFileReader::read_face(ReaderAdapter& reader, IMeshBuilder& builde
     builder.end_face();
 }
 
+void BinaryMeshFileReader::read_bulk_meshes(BufferedFile& file, IMeshBuilder& builder)
+{
+    PassthroughReaderAdapter reader(file);
+    vector<string> material_slots;
+
+    try
+    {
+        while (true)
+        {
+            // Read the name of the next mesh.
+            string mesh_name;
+            try
+            {
+                mesh_name = read_string(reader);
+            }
+            catch (const ExceptionEOF&)
+            {
+                // Expected EOF.
+                break;
+            }
+
+            // Read the mesh header.
+            uint32 vertex_count, vertex_normal_count, tex_coords_count;
+            checked_read(file, vertex_count);
+            checked_read(file, vertex_normal_count);
+            checked_read(file, tex_coords_count);
+
+            uint16 material_slot_count;
+            checked_read(file, material_slot_count);
+            material_slots.resize(material_slot_count);
+            for (uint16 i = 0; i < material_slot_count; ++i)
+                material_slots[i] = read_string(reader);
+
+            uint32 face_count, face_vertex_count;
+            checked_read(file, face_count);
+            checked_read(file, face_vertex_count);
+
+            // Read the bulk arrays.
+            read_array(file, m_vertex_array, vertex_count);
+            read_array(file, m_vertex_normal_array, vertex_normal_count);
+            read_array(file, m_tex_coords_array, tex_coords_count);
+            read_array(file, m_face_size_array, face_vertex_count != 3 * static_cast<size_t>(face_count) ? face_count : 0);
+            read_array(file, m_face_vertex_array, face_vertex_count);
+            read_array(file, m_face_vertex_normal_array, face_vertex_count);
+            read_array(file, m_face_tex_coords_array, face_vertex_count);
+            read_array(file, m_face_material_array, face_count);
+
+            // Build the mesh.
+            builder.begin_mesh(mesh_name.c_str());
+
+            for (uint32 i = 0; i < vertex_count; ++i)
+                builder.push_vertex(m_vertex_array[i]);
+
+            for (uint32 i = 0; i < vertex_normal_count; ++i)
+                builder.push_vertex_normal(m_vertex_normal_array[i]);
+
+            for (uint32 i = 0; i < tex_coords_count; ++i)
+                builder.push_tex_coords(m_tex_coords_array[i]);
+
+            for (uint16 i = 0; i < material_slot_count; ++i)
+                builder.push_material_slot(material_slots[i].c_str());
+
+            push_bulk_faces(builder, face_count, face_vertex_count);
+
+            builder.end_mesh();
+        }
+    }
+    catch (const ExceptionEOF&)
+    {
+        // Unexpected EOF.
+        throw ExceptionIOError();
+    }
+}
+
+template <typename T>
+void BinaryMeshFileReader::read_array(BufferedFile& file, vector<T>& array, const size_t count)
+{
+    array.resize(count);
+
+    if (count > 0)
+        read_chunks(file, &array[0], count * sizeof(T));
+}
+
+void BinaryMeshFileReader::read_chunks(BufferedFile& file, void* data, const size_t size)
+{
+    uint8* bytes = static_cast<uint8*>(data);
+
+    size_t offset = 0;
+    while (offset < size)
+    {
+        uint64 chunk_size, stored_size;
+        checked_read(file, chunk_size);
+        checked_read(file, stored_size);
+
+        if (chunk_size == 0 || chunk_size > size - offset || stored_size > chunk_size)
+            throw ExceptionIOError("invalid binarymesh chunk");
+
+        // Skip the padding that aligns the chunk data in the file.
+        uint8 padding[ChunkAlignment];
+        const size_t position = static_cast<size_t>(file.tell());
+        checked_read(file, padding, (ChunkAlignment - position % ChunkAlignment) % ChunkAlignment);
+
+        if (stored_size == chunk_size)
+        {
+            // Uncompressed chunks are read directly into the destination array.
+            checked_read(file, bytes + offset, static_cast<size_t>(chunk_size));
+        }
+        else
+        {
+            // Compressed chunks are decompressed directly into the destination array.
+            ensure_minimum_size(m_compressed_buffer, static_cast<size_t>(stored_size));
+            checked_read(file, &m_compressed_buffer[0], static_cast<size_t>(stored_size));
+
+            const int decompressed_size =
+                LZ4_decompress_safe(
+                    reinterpret_cast<const char*>(&m_compressed_buffer[0]),
+                    reinterpret_cast<char*>(bytes + offset),
+                    static_cast<int>(stored_size),
+                    static_cast<int>(chunk_size));
+
+            if (decompressed_size != static_cast<int>(chunk_size))
+                throw ExceptionIOError("corrupted binarymesh chunk");
+        }
+
+        offset += static_cast<size_t>(chunk_size);
+    }
+}
+
+void BinaryMeshFileReader::push_bulk_faces(
+    IMeshBuilder&   builder,
+    const size_t    face_count,
+    const size_t    face_vertex_count)
+{
+    // An empty face size array means that all faces are triangles.
+    const bool triangles = m_face_size_array.empty();
+
+    size_t index = 0;
+
+    for (size_t i = 0; i < face_count; ++i)
+    {
+        const size_t count = triangles ? 3 : m_face_size_array[i];
+
+        if (count > face_vertex_count - index)
+            throw ExceptionIOError("invalid binarymesh face sizes");
+
+        ensure_minimum_size(m_vertices, count);
+        ensure_minimum_size(m_vertex_normals, count);
+        ensure_minimum_size(m_tex_coords, count);
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            m_vertices[j] = m_face_vertex_array[index + j];
+            m_vertex_normals[j] = m_face_vertex_normal_array[index + j];
+            m_tex_coords[j] = m_face_tex_coords_array[index + j];
+        }
+
+        builder.begin_face(count);
+        builder.set_face_vertices(&m_vertices[0]);
+        builder.set_face_vertex_normals(&m_vertex_normals[0]);
+        builder.set_face_vertex_tex_coords(&m_tex_coords[0]);
+        builder.set_face_material(m_face_material_array[i]);
+        builder.end_face();
+
+        index += count;
+    }
+}
+
 }   // namespace foundation
@@ -31,8 +31,10 @@
 #define APPLESEED_FOUNDATION_MESH_BINARYMESHFILEREADER_H
 
 // appleseed.foundation headers.
+#include "foundation/math/vector.h"
 #include "foundation/mesh/imeshfilereader.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
 
 // Standard headers.
 #include <cstddef>
@@ -67,6 +69,17 @@ class BinaryMeshFileReader
     std::vector<size_t>     m_vertex_normals;
     std::vector<size_t>     m_tex_coords;
 
+    // Bulk arrays of the format version 4.
+    std::vector<Vector3d>   m_vertex_array;
+    std::vector<Vector3d>   m_vertex_normal_array;
+    std::vector<Vector2d>   m_tex_coords_array;
+    std::vector<uint16>     m_face_size_array;
+    std::vector<uint32>     m_face_vertex_array;
+    std::vector<uint32>     m_face_vertex_normal_array;
+    std::vector<uint32>     m_face_tex_coords_array;
+    std::vector<uint16>     m_face_material_array;
+    std::vector<uint8>      m_compressed_buffer;
+
     static void read_and_check_signature(BufferedFile& file);
 
     static std::string read_string(ReaderAdapter& reader);
@@ -77,6 +90,12 @@ class BinaryMeshFileReader
     void read_material_slots(ReaderAdapter& reader, IMeshBuilder& builder);
     void read_faces(ReaderAdapter& reader, IMeshBuilder& builder);
     void read_face(ReaderAdapter& reader, IMeshBuilder& builder);
+
+    void read_bulk_meshes(BufferedFile& file, IMeshBuilder& builder);
+    template <typename T>
+    void read_array(BufferedFile& file, std::vector<T>& array, const size_t count);
+    void read_chunks(BufferedFile& file, void* data, const size_t size);
+    void push_bulk_faces(IMeshBuilder& builder, const size_t face_count, const size_t face_vertex_count);
 };
 
 }       // namespace foundation
@@ -35,8 +35,13 @@
 #include "foundation/math/vector.h"
 #include "foundation/mesh/imeshwalker.h"
 #include "foundation/platform/types.h"
+#include "foundation/utility/memory.h"
+
+// lz4 headers.
+#include "lz4.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cstring>
 
 using namespace std;
@@ -64,11 +69,16 @@ namespace
     {
         checked_write(file, &object, sizeof(T));
     }
+
+    // Maximum size in bytes of the uncompressed data of a chunk.
+    const size_t MaxChunkSize = 1024 * 1024;
+
+    // Alignment in bytes of chunk data in the file.
+    const size_t ChunkAlignment = 16;
 }
 
 BinaryMeshFileWriter::BinaryMeshFileWriter(const string& filename)
   : m_filename(filename)
-  , m_writer(m_file, 256 * 1024)
 {
 }
 
@@ -100,7 +110,7 @@ void BinaryMeshFileWriter::write_signature()
 
 void BinaryMeshFileWriter::write_version()
 {
-    const uint16 Version = 3;
+    const uint16 Version = 4;
 
     checked_write(m_file, Version);
 }
@@ -109,78 +119,166 @@ void BinaryMeshFileWriter::write_string(const char* s)
 {
     const uint16 length = static_cast<uint16>(strlen(s));
 
-    checked_write(m_writer, length);
-    checked_write(m_writer, s, length);
+    checked_write(m_file, length);
+    checked_write(m_file, s, length);
+}
+
+void BinaryMeshFileWriter::write_array(const void* data, const size_t size)
+{
+    const uint8* bytes = static_cast<const uint8*>(data);
+
+    for (size_t offset = 0; offset < size; offset += MaxChunkSize)
+        write_chunk(bytes + offset, min(size - offset, MaxChunkSize));
+}
+
+void BinaryMeshFileWriter::write_chunk(const void* data, const size_t size)
+{
+    const size_t max_compressed_size =
+        static_cast<size_t>(LZ4_compressBound(static_cast<int>(size)));
+    ensure_minimum_size(m_compressed_buffer, max_compressed_size);
+
+    const size_t compressed_size =
+        static_cast<size_t>(
+            LZ4_compress(
+                static_cast<const char*>(data),
+                reinterpret_cast<char*>(&m_compressed_buffer[0]),
+                static_cast<int>(size)));
+
+    // Store the chunk uncompressed if compression does not reduce its size.
+    const bool compressed = compressed_size > 0 && compressed_size < size;
+    const size_t stored_size = compressed ? compressed_size : size;
+
+    checked_write(m_file, static_cast<uint64>(size));
+    checked_write(m_file, static_cast<uint64>(stored_size));
+
+    // Align the chunk data in the file.
+    static const uint8 Padding[ChunkAlignment] = { 0 };
+    const size_t position = static_cast<size_t>(m_file.tell());
+    checked_write(m_file, Padding, (ChunkAlignment - position % ChunkAlignment) % ChunkAlignment);
+
+    checked_write(m_file, compressed ? &m_compressed_buffer[0] : data, stored_size);
 }
 
 void BinaryMeshFileWriter::write_mesh(const IMeshWalker& walker)
 {
     write_string(walker.get_name());
+
+    checked_write(m_file, static_cast<uint32>(walker.get_vertex_count()));
+    checked_write(m_file, static_cast<uint32>(walker.get_vertex_normal_count()));
+    checked_write(m_file, static_cast<uint32>(walker.get_tex_coords_count()));
+
+    write_material_slots(walker);
+
+    gather_faces(walker);
+    checked_write(m_file, static_cast<uint32>(m_face_sizes.size()));
+    checked_write(m_file, static_cast<uint32>(m_face_vertices.size()));
+
     write_vertices(walker);
     write_vertex_normals(walker);
     write_texture_coordinates(walker);
-    write_material_slots(walker);
-    write_faces(walker);
+    write_faces();
 }
 
 void BinaryMeshFileWriter::write_vertices(const IMeshWalker& walker)
 {
-    const uint32 count = static_cast<uint32>(walker.get_vertex_count());
-    checked_write(m_writer, count);
+    const size_t count = walker.get_vertex_count();
+    clear_keep_memory(m_values);
 
-    for (uint32 i = 0; i < count; ++i)
-        checked_write(m_writer, walker.get_vertex(i));
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Vector3d v = walker.get_vertex(i);
+        m_values.push_back(v[0]);
+        m_values.push_back(v[1]);
+        m_values.push_back(v[2]);
+    }
+
+    write_array(m_values.empty() ? 0 : &m_values[0], m_values.size() * sizeof(double));
 }
 
 void BinaryMeshFileWriter::write_vertex_normals(const IMeshWalker& walker)
 {
-    const uint32 count = static_cast<uint32>(walker.get_vertex_normal_count());
-    checked_write(m_writer, count);
+    const size_t count = walker.get_vertex_normal_count();
+    clear_keep_memory(m_values);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Vector3d n = walker.get_vertex_normal(i);
+        m_values.push_back(n[0]);
+        m_values.push_back(n[1]);
+        m_values.push_back(n[2]);
+    }
 
-    for (uint32 i = 0; i < count; ++i)
-        checked_write(m_writer, walker.get_vertex_normal(i));
+    write_array(m_values.empty() ? 0 : &m_values[0], m_values.size() * sizeof(double));
 }
 
 void BinaryMeshFileWriter::write_texture_coordinates(const IMeshWalker& walker)
 {
-    const uint32 count = static_cast<uint32>(walker.get_tex_coords_count());
-    checked_write(m_writer, count);
+    const size_t count = walker.get_tex_coords_count();
+    clear_keep_memory(m_values);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Vector2d uv = walker.get_tex_coords(i);
+        m_values.push_back(uv[0]);
+        m_values.push_back(uv[1]);
+    }
 
-    for (uint32 i = 0; i < count; ++i)
-        checked_write(m_writer, walker.get_tex_coords(i));
+    write_array(m_values.empty() ? 0 : &m_values[0], m_values.size() * sizeof(double));
 }
 
 void BinaryMeshFileWriter::write_material_slots(const IMeshWalker& walker)
 {
     const uint16 count = static_cast<uint16>(walker.get_material_slot_count());
-    checked_write(m_writer, count);
+    checked_write(m_file, count);
 
     for (uint16 i = 0; i < count; ++i)
         write_string(walker.get_material_slot(i));
 }
 
-void BinaryMeshFileWriter::write_faces(const IMeshWalker& walker)
+void BinaryMeshFileWriter::gather_faces(const IMeshWalker& walker)
 {
-    const uint32 count = static_cast<uint32>(walker.get_face_count());
-    checked_write(m_writer, count);
+    const size_t face_count = walker.get_face_count();
+
+    clear_keep_memory(m_face_sizes);
+    clear_keep_memory(m_face_vertices);
+    clear_keep_memory(m_face_vertex_normals);
+    clear_keep_memory(m_face_tex_coords);
+    clear_keep_memory(m_face_materials);
+
+    for (size_t i = 0; i < face_count; ++i)
+    {
+        const size_t vertex_count = walker.get_face_vertex_count(i);
+        m_face_sizes.push_back(static_cast<uint16>(vertex_count));
 
-    for (uint32 i = 0; i < count; ++i)
-        write_face(walker, i);
+        for (size_t j = 0; j < vertex_count; ++j)
+        {
+            m_face_vertices.push_back(static_cast<uint32>(walker.get_face_vertex(i, j)));
+            m_face_vertex_normals.push_back(static_cast<uint32>(walker.get_face_vertex_normal(i, j)));
+            m_face_tex_coords.push_back(static_cast<uint32>(walker.get_face_tex_coords(i, j)));
+        }
+
+        m_face_materials.push_back(static_cast<uint16>(walker.get_face_material(i)));
+    }
 }
 
-void BinaryMeshFileWriter::write_face(const IMeshWalker& walker, const size_t face_index)
+void BinaryMeshFileWriter::write_faces()
 {
-    const uint16 count = static_cast<uint16>(walker.get_face_vertex_count(face_index));
-    checked_write(m_writer, count);
+    const size_t face_count = m_face_sizes.size();
+    const size_t face_vertex_count = m_face_vertices.size();
 
-    for (uint16 i = 0; i < count; ++i)
+    // Face sizes are implicit when all faces are triangles.
+    if (face_vertex_count != 3 * face_count)
+        write_array(&m_face_sizes[0], face_count * sizeof(uint16));
+
+    if (face_vertex_count > 0)
     {
-        checked_write(m_writer, static_cast<uint32>(walker.get_face_vertex(face_index, i)));
-        checked_write(m_writer, static_cast<uint32>(walker.get_face_vertex_normal(face_index, i)));
-        checked_write(m_writer, static_cast<uint32>(walker.get_face_tex_coords(face_index, i)));
+        write_array(&m_face_vertices[0], face_vertex_count * sizeof(uint32));
+        write_array(&m_face_vertex_normals[0], face_vertex_count * sizeof(uint32));
+        write_array(&m_face_tex_coords[0], face_vertex_count * sizeof(uint32));
     }
 
-    checked_write(m_writer, static_cast<uint16>(walker.get_face_material(face_index)));
+    if (face_count > 0)
+        write_array(&m_face_materials[0], face_count * sizeof(uint16));
 }
 
 }   // namespace foundation
@@ -33,11 +33,13 @@
 // appleseed.foundation headers.
 #include "foundation/mesh/imeshfilewriter.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/bufferedfile.h"
 
 // Standard headers.
 #include <cstddef>
 #include <string>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IMeshWalker; }
@@ -62,19 +64,27 @@ class BinaryMeshFileWriter
   private:
     const std::string           m_filename;
     BufferedFile                m_file;
-    LZ4CompressedWriterAdapter  m_writer;
+    std::vector<double>         m_values;
+    std::vector<uint16>         m_face_sizes;
+    std::vector<uint32>         m_face_vertices;
+    std::vector<uint32>         m_face_vertex_normals;
+    std::vector<uint32>         m_face_tex_coords;
+    std::vector<uint16>         m_face_materials;
+    std::vector<uint8>          m_compressed_buffer;
 
     void write_signature();
     void write_version();
 
     void write_string(const char* s);
+    void write_array(const void* data, const size_t size);
+    void write_chunk(const void* data, const size_t size);
     void write_mesh(const IMeshWalker& walker);
     void write_vertices(const IMeshWalker& walker);
     void write_vertex_normals(const IMeshWalker& walker);
     void write_texture_coordinates(const IMeshWalker& walker);
     void write_material_slots(const IMeshWalker& walker);
-    void write_faces(const IMeshWalker& walker);
-    void write_face(const IMeshWalker& walker, const size_t face_index);
+    void gather_faces(const IMeshWalker& walker);
+    void write_faces();
 };
 
 }       // namespace foundation
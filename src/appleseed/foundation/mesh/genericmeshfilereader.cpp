@@ -55,6 +55,7 @@ struct GenericMeshFileReader::Impl
 {
     string  m_filename;
     int     m_obj_options;
+    double  m_alembic_sample_time;
 };
 
 GenericMeshFileReader::GenericMeshFileReader(const char* filename)
@@ -62,6 +63,7 @@ GenericMeshFileReader::GenericMeshFileReader(const char* filename)
 {
     impl->m_filename = filename;
     impl->m_obj_options = OBJMeshFileReader::Default;
+    impl->m_alembic_sample_time = 0.0;
 }
 
 GenericMeshFileReader::~GenericMeshFileReader()
@@ -79,6 +81,16 @@ void GenericMeshFileReader::set_obj_options(const int obj_options)
     impl->m_obj_options = obj_options;
 }
 
+double GenericMeshFileReader::get_alembic_sample_time() const
+{
+    return impl->m_alembic_sample_time;
+}
+
+void GenericMeshFileReader::set_alembic_sample_time(const double sample_time)
+{
+    impl->m_alembic_sample_time = sample_time;
+}
+
 void GenericMeshFileReader::read(IMeshBuilder& builder)
 {
     const bf::path filepath(impl->m_filename);
@@ -92,7 +104,7 @@ void GenericMeshFileReader::read(IMeshBuilder& builder)
 #ifdef APPLESEED_WITH_ALEMBIC
     else if (extension == ".abc")
     {
-        AlembicMeshFileReader reader(impl->m_filename);
+        AlembicMeshFileReader reader(impl->m_filename, impl->m_alembic_sample_time);
         reader.read(builder);
     }
 #endif
@@ -60,6 +60,10 @@ class APPLESEED_DLLSYMBOL GenericMeshFileReader
     int get_obj_options() const;
     void set_obj_options(const int obj_options);
 
+    // Get/set the time at which Alembic meshes are sampled.
+    double get_alembic_sample_time() const;
+    void set_alembic_sample_time(const double sample_time);
+
     // Read a mesh.
     virtual void read(IMeshBuilder& builder);
 
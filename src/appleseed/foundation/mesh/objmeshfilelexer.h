@@ -64,6 +64,8 @@ class OBJMeshFileLexer
     explicit OBJMeshFileLexer(const ParsingMode parsing_mode = Precise)
       : m_parsing_mode(parsing_mode)
       , m_eof(false)
+      , m_memory_ptr(0)
+      , m_memory_end(0)
       , m_line_number(0)
       , m_line(4096)
       , m_line_size(0)
@@ -96,16 +98,35 @@ class OBJMeshFileLexer
         return true;
     }
 
-    // Close the input file.
+    // Open an input buffer holding the contents of a file, or a part of it.
+    // The buffer must remain valid until the lexer is closed.
+    void open(const char* begin, const char* end)
+    {
+        m_eof = false;
+        m_line_number = 0;
+        m_line_size = 0;
+        m_line_index = 0;
+
+        m_memory_ptr = begin;
+        m_memory_end = end;
+
+        read_next_line();
+    }
+
+    // Close the input file or buffer.
     void close()
     {
-        m_file.close();
+        if (m_file.is_open())
+            m_file.close();
+
+        m_memory_ptr = 0;
+        m_memory_end = 0;
     }
 
     // Return the position of the current line in the file.
     size_t get_line_number() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_line_number;
     }
@@ -113,7 +134,7 @@ class OBJMeshFileLexer
     // Return the current character in the line.
     APPLESEED_FORCE_INLINE unsigned char get_char() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_line_index == m_line_size ? '\n' : m_line[m_line_index];
     }
@@ -121,7 +142,7 @@ class OBJMeshFileLexer
     // Advance to the next character in the line.
     APPLESEED_FORCE_INLINE void next_char()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         if (m_line_index < m_line_size)
             ++m_line_index;
@@ -141,7 +162,7 @@ class OBJMeshFileLexer
     // Return true if the end of the line has been reached.
     APPLESEED_FORCE_INLINE bool is_eol() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_line_index == m_line_size;
     }
@@ -149,7 +170,7 @@ class OBJMeshFileLexer
     // Return true if the end of the file has been reached.
     APPLESEED_FORCE_INLINE bool is_eof() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_eof && is_eol();
     }
@@ -157,7 +178,7 @@ class OBJMeshFileLexer
     // Eat blank characters and comments.
     void eat_blanks()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         while (true)
         {
@@ -192,7 +213,7 @@ class OBJMeshFileLexer
     // Accept a end-of-line character, or generate a parse error.
     void accept_newline()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         if (!is_eol())
             parse_error();
@@ -203,7 +224,7 @@ class OBJMeshFileLexer
     // Accept a string of non-blank characters, or generate a parse error.
     void accept_string(const char** begin, size_t* length)
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         if (is_eof())
             parse_error();
@@ -236,7 +257,7 @@ class OBJMeshFileLexer
     // Accept a long integer, or generate a parse error.
     APPLESEED_FORCE_INLINE long accept_long()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         // Read an integer value at the current position in the line.
         const char* base_ptr = &m_line[0];
@@ -255,7 +276,7 @@ class OBJMeshFileLexer
     // Accept a double-precision floating point number, or generate a parse error.
     APPLESEED_FORCE_INLINE double accept_double()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         // Read a floating-point value at the current position in the line.
         char* base_ptr = &m_line[0];
@@ -280,22 +301,29 @@ class OBJMeshFileLexer
     bool                m_is_space[256];    // precomputed values of std::isspace(c) for all c
     BufferedFile        m_file;
     bool                m_eof;              // has the end of the file been reached?
+    const char*         m_memory_ptr;       // next character of the input buffer, if reading from memory
+    const char*         m_memory_end;       // end of the input buffer, if reading from memory
     size_t              m_line_number;      // position of the current line in the file
     std::vector<char>   m_line;             // current line
     size_t              m_line_size;        // size of the current line (not counting the zero terminator)
     size_t              m_line_index;       // position of the cursor in the current line
 
+    bool is_open() const
+    {
+        return m_file.is_open() || m_memory_end != 0;
+    }
+
     // Close the input file and throw an ExceptionParseError exception.
     void parse_error()
     {
-        m_file.close();
+        close();
         throw OBJMeshFileReader::ExceptionParseError(m_line_number);
     }
 
     // Read the next line from the input file.
     void read_next_line()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         m_line_size = 0;
 
@@ -305,9 +333,20 @@ class OBJMeshFileLexer
 
             while (m_line_size < m_line.size() - 1)
             {
-                // Read one character from the file.
+                // Read one character from the file or the input buffer.
                 char c;
-                if (m_file.read(&c) < 1)
+                if (m_memory_end != 0)
+                {
+                    if (m_memory_ptr == m_memory_end)
+                    {
+                        // Reached the end of the input buffer.
+                        m_eof = true;
+                        break;
+                    }
+
+                    c = *m_memory_ptr++;
+                }
+                else if (m_file.read(&c) < 1)
                 {
                     // Reached the end of the file.
                     m_eof = true;
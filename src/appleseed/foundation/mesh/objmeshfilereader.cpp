@@ -35,11 +35,18 @@
 #include "foundation/math/vector.h"
 #include "foundation/mesh/imeshbuilder.h"
 #include "foundation/mesh/objmeshfilelexer.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
 #include "foundation/utility/memory.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cstring>
 #include <map>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -55,506 +62,1016 @@ namespace foundation
 namespace
 {
     const size_t Undefined = ~0;
-}
-
-struct OBJMeshFileReader::Impl
-{
-    const int               m_options;
-    IMeshBuilder&           m_builder;
-    OBJMeshFileLexer        m_lexer;
-
-    // Current state.
-    bool                    m_inside_mesh_def;              // currently inside a mesh definition?
-    string                  m_current_mesh_name;            // name of the current mesh
-    map<string, size_t>     m_material_slots;               // material slots for the current mesh
-    size_t                  m_current_material_slot_index;  // index of the current material slot
-
-    // Features defined in the file.
-    vector<Vector3d>        m_vertices;
-    vector<Vector2d>        m_tex_coords;
-    vector<Vector3d>        m_normals;
-
-    // Mappings between internal indices and mesh indices.
-    vector<size_t>          m_vertex_index_mapping;
-    vector<size_t>          m_tex_coord_index_mapping;
-    vector<size_t>          m_normal_index_mapping;
-
-    // Temporary vectors for collecting indices while parsing face statements.
-    vector<size_t>          m_face_vertex_indices;
-    vector<size_t>          m_face_tex_coord_indices;
-    vector<size_t>          m_face_normal_indices;
-
-    // Constructor.
-    Impl(
-        const int           options,
-        IMeshBuilder&       builder)
-      : m_options(options)
-      , m_builder(builder)
-      , m_lexer(
-            (options & FavorSpeedOverPrecision)
-                ? OBJMeshFileLexer::Fast
-                : OBJMeshFileLexer::Precise)
-      , m_inside_mesh_def(false)
-      , m_current_material_slot_index(0)
-    {
-    }
 
-    // Close the input file and throw an ExceptionParseError exception.
-    void parse_error()
-    {
-        const size_t line_number = m_lexer.get_line_number();
+    // Minimum size in bytes of the chunks a file is split into for parallel parsing.
+    const size_t MinChunkSize = 1024 * 1024;
 
-        m_lexer.close();
 
-        throw ExceptionParseError(line_number);
-    }
+    //
+    // Parse OBJ statements from a lexer and forward them to a handler.
+    //
+    // Face indices are forwarded as they appear in the file (1-based or negative);
+    // resolving them is left to the handler.
+    //
 
-    void parse_file()
+    template <typename Handler>
+    class StatementParser
     {
-        while (true)
+      public:
+        StatementParser(
+            OBJMeshFileLexer&   lexer,
+            Handler&            handler)
+          : m_lexer(lexer)
+          , m_handler(handler)
         {
-            m_lexer.eat_blanks();
-
-            // Handle end of file.
-            if (m_lexer.is_eof())
-                break;
+        }
 
-            // Handle empty lines.
-            if (m_lexer.is_eol())
+        void parse()
+        {
+            while (true)
             {
-                m_lexer.accept_newline();
-                continue;
-            }
-
-            const char* keyword;
-            size_t keyword_length;
+                m_lexer.eat_blanks();
 
-            m_lexer.accept_string(&keyword, &keyword_length);
+                // Handle end of file.
+                if (m_lexer.is_eof())
+                    break;
 
-            if (keyword_length == 1)
-            {
-                switch (keyword[0])
+                // Handle empty lines.
+                if (m_lexer.is_eol())
                 {
-                  case 'f':
-                    parse_f_statement();
-                    break;
+                    m_lexer.accept_newline();
+                    continue;
+                }
 
-                  case 'g':
-                  case 'o':
-                    parse_o_g_statement();
-                    break;
+                const char* keyword;
+                size_t keyword_length;
 
-                  case 'v':
-                    parse_v_statement();
-                    break;
+                m_lexer.accept_string(&keyword, &keyword_length);
 
-                  default:
+                if (keyword_length == 1)
+                {
+                    switch (keyword[0])
+                    {
+                      case 'f':
+                        parse_f_statement();
+                        break;
+
+                      case 'g':
+                      case 'o':
+                        parse_o_g_statement();
+                        break;
+
+                      case 'v':
+                        parse_v_statement();
+                        break;
+
+                      default:
+                        // Ignore unknown or unhandled statements.
+                        m_lexer.eat_line();
+                        continue;
+                    }
+                }
+                else if (keyword_length == 2)
+                {
+                    switch (keyword[0] * 256 + keyword[1])
+                    {
+                      case 'v' * 256 + 'n':
+                        parse_vn_statement();
+                        break;
+
+                      case 'v' * 256 + 't':
+                        parse_vt_statement();
+                        break;
+
+                      default:
+                        // Ignore unknown or unhandled statements.
+                        m_lexer.eat_line();
+                        continue;
+                    }
+                }
+                else if (strncmp(keyword, "usemtl", keyword_length) == 0)
+                {
+                    parse_usemtl_statement();
+                }
+                else
+                {
                     // Ignore unknown or unhandled statements.
                     m_lexer.eat_line();
                     continue;
                 }
+
+                m_lexer.eat_blanks();
+                m_lexer.accept_newline();
             }
-            else if (keyword_length == 2)
+        }
+
+      private:
+        OBJMeshFileLexer&   m_lexer;
+        Handler&            m_handler;
+
+        // Temporary vectors for collecting indices while parsing face statements.
+        vector<long>        m_face_vertex_indices;
+        vector<long>        m_face_tex_coord_indices;
+        vector<long>        m_face_normal_indices;
+
+        // Close the input file and throw an ExceptionParseError exception.
+        void parse_error()
+        {
+            const size_t line_number = m_lexer.get_line_number();
+
+            m_lexer.close();
+
+            throw OBJMeshFileReader::ExceptionParseError(line_number);
+        }
+
+        void parse_f_statement()
+        {
+            clear_keep_memory(m_face_vertex_indices);
+            clear_keep_memory(m_face_tex_coord_indices);
+            clear_keep_memory(m_face_normal_indices);
+
+            while (true)
             {
-                switch (keyword[0] * 256 + keyword[1])
-                {
-                  case 'v' * 256 + 'n':
-                    parse_vn_statement();
-                    break;
+                m_lexer.eat_blanks();
 
-                  case 'v' * 256 + 't':
-                    parse_vt_statement();
+                if (m_lexer.is_eol())
                     break;
 
-                  default:
-                    // Ignore unknown or unhandled statements.
-                    m_lexer.eat_line();
-                    continue;
+                //
+                // Recognized (epsilon)
+                // Accept n
+                //
+
+                m_face_vertex_indices.push_back(m_lexer.accept_long());
+
+                //
+                // Recognized n
+                // Accept (epsilon), /
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (m_lexer.is_space(c))
+                        continue;
+                    else if (c == '/')
+                        m_lexer.next_char();
+                    else parse_error();
+                }
+
+                //
+                // Recognized n/
+                // Accept /, n
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (c == '/')
+                    {
+                        m_lexer.next_char();
+                        goto skip;
+                    }
+                    else m_face_tex_coord_indices.push_back(m_lexer.accept_long());
+                }
+
+                //
+                // Recognized n/n
+                // Accept (epsilon), /
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (m_lexer.is_space(c))
+                        continue;
+                    else if (c == '/')
+                        m_lexer.next_char();
+                    else parse_error();
+                }
+
+              skip:
+
+                //
+                // Recognized n//, n/n/
+                // Accept (epsilon), n
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (m_lexer.is_space(c))
+                        continue;
+                    else m_face_normal_indices.push_back(m_lexer.accept_long());
                 }
             }
-            else if (strncmp(keyword, "usemtl", keyword_length) == 0)
-            {
-                parse_usemtl_statement();
-            }
-            else
+
+            m_handler.on_face(
+                m_face_vertex_indices,
+                m_face_tex_coord_indices,
+                m_face_normal_indices);
+        }
+
+        void parse_o_g_statement()
+        {
+            m_handler.on_object_or_group(parse_compound_identifier());
+        }
+
+        string parse_compound_identifier()
+        {
+            string identifier;
+
+            m_lexer.eat_blanks();
+
+            while (!m_lexer.is_eol())
             {
-                // Ignore unknown or unhandled statements.
-                m_lexer.eat_line();
-                continue;
+                const char* token;
+                size_t token_length;
+
+                m_lexer.accept_string(&token, &token_length);
+                m_lexer.eat_blanks();
+
+                if (!identifier.empty())
+                    identifier += ' ';
+
+                identifier.append(token, token_length);
             }
 
+            return identifier;
+        }
+
+        void parse_v_statement()
+        {
+            Vector3d v;
+
+            m_lexer.eat_blanks();
+            v.x = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+            v.y = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+            v.z = m_lexer.accept_double();
+
             m_lexer.eat_blanks();
-            m_lexer.accept_newline();
+
+            if (!m_lexer.is_eol())
+                m_lexer.accept_double();
+
+            m_handler.on_vertex(v);
         }
 
-        // End the definition of the last object.
-        if (m_inside_mesh_def)
-            m_builder.end_mesh();
-    }
+        void parse_vt_statement()
+        {
+            Vector2d v;
 
-    void parse_f_statement()
-    {
-        clear_keep_memory(m_face_vertex_indices);
-        clear_keep_memory(m_face_tex_coord_indices);
-        clear_keep_memory(m_face_normal_indices);
+            m_lexer.eat_blanks();
+            v.x = m_lexer.accept_double();
 
-        while (true)
+            m_lexer.eat_blanks();
+            v.y = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+
+            if (!m_lexer.is_eol())
+                m_lexer.accept_double();
+
+            m_handler.on_tex_coords(v);
+        }
+
+        void parse_vn_statement()
         {
+            Vector3d n;
+
+            m_lexer.eat_blanks();
+            n.x = m_lexer.accept_double();
+
             m_lexer.eat_blanks();
+            n.y = m_lexer.accept_double();
 
-            if (m_lexer.is_eol())
-                break;
+            m_lexer.eat_blanks();
+            n.z = m_lexer.accept_double();
 
-            //
-            // Recognized (epsilon)
-            // Accept n
-            //
+            m_handler.on_normal(n);
+        }
+
+        void parse_usemtl_statement()
+        {
+            m_handler.on_use_material(parse_compound_identifier());
+        }
+    };
 
-            {
-                const long n = m_lexer.accept_long();
-                const size_t v = fix_index(n, m_vertices.size());
-                m_face_vertex_indices.push_back(v);
-            }
 
-            //
-            // Recognized n
-            // Accept (epsilon), /
-            //
+    //
+    // Turn parsed statements into meshes, delivered to a mesh builder.
+    //
 
+    class MeshAssembler
+    {
+      public:
+        // Features defined in the file.
+        vector<Vector3d>        m_vertices;
+        vector<Vector2d>        m_tex_coords;
+        vector<Vector3d>        m_normals;
+
+        MeshAssembler(
+            const int           options,
+            IMeshBuilder&       builder)
+          : m_options(options)
+          , m_builder(builder)
+          , m_inside_mesh_def(false)
+          , m_current_material_slot_index(0)
+        {
+        }
+
+        // Insert a face given its indices as found in the file. The number of
+        // features defined before the face is used to resolve negative indices.
+        void insert_face(
+            const long*         vertex_indices,
+            const size_t        vertex_index_count,
+            const long*         tex_coord_indices,
+            const size_t        tex_coord_index_count,
+            const long*         normal_indices,
+            const size_t        normal_index_count,
+            const size_t        vertex_count,
+            const size_t        tex_coord_count,
+            const size_t        normal_count,
+            const size_t        line_number)
+        {
+            m_line_number = line_number;
+
+            fix_indices(vertex_indices, vertex_index_count, vertex_count, m_face_vertex_indices);
+            fix_indices(tex_coord_indices, tex_coord_index_count, tex_coord_count, m_face_tex_coord_indices);
+            fix_indices(normal_indices, normal_index_count, normal_count, m_face_normal_indices);
+
+            // Check whether the face is well-formed.
+            const size_t vc = m_face_vertex_indices.size();
+            const size_t tc = m_face_tex_coord_indices.size();
+            const size_t nc = m_face_normal_indices.size();
+            const bool well_formed =
+                    vc >= 3
+                && (tc == 0 || tc == vc)
+                && (nc == 0 || nc == vc);
+
+            if (well_formed)
             {
-                const unsigned char c = m_lexer.get_char();
-                if (m_lexer.is_space(c))
-                    continue;
-                else if (c == '/')
-                    m_lexer.next_char();
-                else parse_error();
+                // The face is well-formed, insert it into the mesh.
+                insert_face_into_mesh();
             }
+            else
+            {
+                // The face is ill-formed, ignore it or abort parsing.
+                if (m_options & OBJMeshFileReader::StopOnInvalidFaceDef)
+                    throw OBJMeshFileReader::ExceptionInvalidFaceDef(m_line_number);
+            }
+        }
 
-            //
-            // Recognized n/
-            // Accept /, n
-            //
-
+        void begin_object_or_group(const string& upcoming_mesh_name)
+        {
+            // Start a new mesh only if the name of the object or group actually changes.
+            if (upcoming_mesh_name != m_current_mesh_name)
             {
-                const unsigned char c = m_lexer.get_char();
-                if (c == '/')
+                // End the current mesh.
+                if (m_inside_mesh_def)
                 {
-                    m_lexer.next_char();
-                    goto skip;
+                    m_builder.end_mesh();
+                    m_inside_mesh_def = false;
                 }
-                else
-                {
-                    const long n = m_lexer.accept_long();
-                    const size_t vt = fix_index(n, m_tex_coords.size());
-                    m_face_tex_coord_indices.push_back(vt);
-                }
-            }
 
-            //
-            // Recognized n/n
-            // Accept (epsilon), /
-            //
+                clear_keep_memory(m_vertex_index_mapping);
+                clear_keep_memory(m_tex_coord_index_mapping);
+                clear_keep_memory(m_normal_index_mapping);
 
-            {
-                const unsigned char c = m_lexer.get_char();
-                if (m_lexer.is_space(c))
-                    continue;
-                else if (c == '/')
-                    m_lexer.next_char();
-                else parse_error();
+                m_current_mesh_name = upcoming_mesh_name;
             }
+        }
 
-          skip:
+        void use_material(const string& material_slot_name)
+        {
+            // Begin a mesh definition if we're not already inside one.
+            ensure_mesh_def();
 
-            //
-            // Recognized n//, n/n/
-            // Accept (epsilon), n
-            //
+            // Check whether this material slot has already been defined for this mesh.
+            const map<string, size_t>::const_iterator& it =
+                m_material_slots.find(material_slot_name);
 
+            if (it != m_material_slots.end())
             {
-                const unsigned char c = m_lexer.get_char();
-                if (m_lexer.is_space(c))
-                    continue;
-                else
-                {
-                    const long n = m_lexer.accept_long();
-                    const size_t vn = fix_index(n, m_normals.size());
-                    m_face_normal_indices.push_back(vn);
-                }
+                // It has: just make it the active material slot.
+                m_current_material_slot_index = it->second;
+            }
+            else
+            {
+                // It hasn't: insert it into the mesh and make it the active material slot.
+                m_current_material_slot_index = m_builder.push_material_slot(material_slot_name.c_str());
+                m_material_slots.insert(make_pair(material_slot_name, m_current_material_slot_index));
             }
         }
 
-        // Check whether the face is well-formed.
-        const size_t vc = m_face_vertex_indices.size();
-        const size_t tc = m_face_tex_coord_indices.size();
-        const size_t nc = m_face_normal_indices.size();
-        const bool well_formed =
-                vc >= 3
-            && (tc == 0 || tc == vc)
-            && (nc == 0 || nc == vc);
+        void finish()
+        {
+            // End the definition of the last object.
+            if (m_inside_mesh_def)
+                m_builder.end_mesh();
+        }
+
+      private:
+        const int               m_options;
+        IMeshBuilder&           m_builder;
+        size_t                  m_line_number;                  // line of the statement being processed
+
+        // Current state.
+        bool                    m_inside_mesh_def;              // currently inside a mesh definition?
+        string                  m_current_mesh_name;            // name of the current mesh
+        map<string, size_t>     m_material_slots;               // material slots for the current mesh
+        size_t                  m_current_material_slot_index;  // index of the current material slot
+
+        // Mappings between internal indices and mesh indices.
+        vector<size_t>          m_vertex_index_mapping;
+        vector<size_t>          m_tex_coord_index_mapping;
+        vector<size_t>          m_normal_index_mapping;
 
-        if (well_formed)
+        // Temporary vectors for collecting resolved indices of faces.
+        vector<size_t>          m_face_vertex_indices;
+        vector<size_t>          m_face_tex_coord_indices;
+        vector<size_t>          m_face_normal_indices;
+
+        void parse_error()
         {
-            // The face is well-formed, insert it into the mesh.
-            insert_face_into_mesh();
+            throw OBJMeshFileReader::ExceptionParseError(m_line_number);
         }
-        else
+
+        void fix_indices(
+            const long*         indices,
+            const size_t        index_count,
+            const size_t        count,
+            vector<size_t>&     fixed_indices)
         {
-            // The face is ill-formed, ignore it or abort parsing.
-            if (m_options & StopOnInvalidFaceDef)
-                throw ExceptionInvalidFaceDef(m_lexer.get_line_number());
+            clear_keep_memory(fixed_indices);
+
+            for (size_t i = 0; i < index_count; ++i)
+                fixed_indices.push_back(fix_index(indices[i], count));
         }
-    }
 
-    // Convert 1-based indices (including negative indices) to 0-based indices.
-    size_t fix_index(const long index, const size_t count)
-    {
-        if (index > 0)
+        // Convert 1-based indices (including negative indices) to 0-based indices.
+        size_t fix_index(const long index, const size_t count)
         {
-            const size_t i = static_cast<size_t>(index);
-            if (i > count)
+            if (index > 0)
+            {
+                const size_t i = static_cast<size_t>(index);
+                if (i > count)
+                    parse_error();
+                return i - 1;
+            }
+            else if (index < 0)
+            {
+                const size_t i = static_cast<size_t>(-index);
+                if (i > count)
+                    parse_error();
+                return count - i;
+            }
+            else
+            {
                 parse_error();
-            return i - 1;
+                return 0;       // keep the compiler happy
+            }
         }
-        else if (index < 0)
+
+        void insert_face_into_mesh()
         {
-            const size_t i = static_cast<size_t>(-index);
-            if (i > count)
-                parse_error();
-            return count - i;
+            // Begin a mesh definition if we're not already inside one.
+            ensure_mesh_def();
+
+            // Insert the features into the mesh, updating index mappings as necessary.
+            insert_vertices_into_mesh();
+            insert_vertex_normals_into_mesh();
+            insert_tex_coords_into_mesh();
+
+            // Translate feature indices from internal space to mesh space.
+            translate_indices(m_face_vertex_indices, m_vertex_index_mapping);
+            translate_indices(m_face_normal_indices, m_normal_index_mapping);
+            translate_indices(m_face_tex_coord_indices, m_tex_coord_index_mapping);
+
+            const size_t n = m_face_vertex_indices.size();
+
+            // Begin defining a new face.
+            m_builder.begin_face(n);
+
+            // Set face vertices.
+            m_builder.set_face_vertices(&m_face_vertex_indices.front());
+
+            // Set face vertex normals (if any).
+            if (m_face_normal_indices.size() == n)
+                m_builder.set_face_vertex_normals(&m_face_normal_indices.front());
+
+            // Set face vertex texture coordinates (if any).
+            if (m_face_tex_coord_indices.size() == n)
+                m_builder.set_face_vertex_tex_coords(&m_face_tex_coord_indices.front());
+
+            // Set face material.
+            m_builder.set_face_material(m_current_material_slot_index);
+
+            // End defining the face.
+            m_builder.end_face();
         }
-        else
+
+        void insert_vertices_into_mesh()
         {
-            parse_error();
-            return 0;       // keep the compiler happy
+            const size_t face_vertex_index_count = m_face_vertex_indices.size();
+
+            for (size_t i = 0; i < face_vertex_index_count; ++i)
+            {
+                const size_t vertex_index = m_face_vertex_indices[i];
+                ensure_minimum_size(m_vertex_index_mapping, vertex_index + 1, Undefined);
+                if (m_vertex_index_mapping[vertex_index] == Undefined)
+                    m_vertex_index_mapping[vertex_index] = m_builder.push_vertex(m_vertices[vertex_index]);
+            }
         }
-    }
 
-    void insert_face_into_mesh()
-    {
-        // Begin a mesh definition if we're not already inside one.
-        ensure_mesh_def();
+        void insert_vertex_normals_into_mesh()
+        {
+            const size_t face_normal_index_count = m_face_normal_indices.size();
 
-        // Insert the features into the mesh, updating index mappings as necessary.
-        insert_vertices_into_mesh();
-        insert_vertex_normals_into_mesh();
-        insert_tex_coords_into_mesh();
+            for (size_t i = 0; i < face_normal_index_count; ++i)
+            {
+                const size_t normal_index = m_face_normal_indices[i];
+                ensure_minimum_size(m_normal_index_mapping, normal_index + 1, Undefined);
+                if (m_normal_index_mapping[normal_index] == Undefined)
+                    m_normal_index_mapping[normal_index] = m_builder.push_vertex_normal(m_normals[normal_index]);
+            }
+        }
 
-        // Translate feature indices from internal space to mesh space.
-        translate_indices(m_face_vertex_indices, m_vertex_index_mapping);
-        translate_indices(m_face_normal_indices, m_normal_index_mapping);
-        translate_indices(m_face_tex_coord_indices, m_tex_coord_index_mapping);
+        void insert_tex_coords_into_mesh()
+        {
+            const size_t face_tex_coord_index_count = m_face_tex_coord_indices.size();
 
-        const size_t n = m_face_vertex_indices.size();
+            for (size_t i = 0; i < face_tex_coord_index_count; ++i)
+            {
+                const size_t tex_coord_index = m_face_tex_coord_indices[i];
+                ensure_minimum_size(m_tex_coord_index_mapping, tex_coord_index + 1, Undefined);
+                if (m_tex_coord_index_mapping[tex_coord_index] == Undefined)
+                    m_tex_coord_index_mapping[tex_coord_index] = m_builder.push_tex_coords(m_tex_coords[tex_coord_index]);
+            }
+        }
 
-        // Begin defining a new face.
-        m_builder.begin_face(n);
+        static void translate_indices(
+            vector<size_t>&         indices,
+            const vector<size_t>&   mapping)
+        {
+            const size_t count = indices.size();
 
-        // Set face vertices.
-        m_builder.set_face_vertices(&m_face_vertex_indices.front());
+            for (size_t i = 0; i < count; ++i)
+                indices[i] = mapping[indices[i]];
+        }
 
-        // Set face vertex normals (if any).
-        if (m_face_normal_indices.size() == n)
-            m_builder.set_face_vertex_normals(&m_face_normal_indices.front());
+        void ensure_mesh_def()
+        {
+            if (!m_inside_mesh_def)
+            {
+                // Begin the definition of the new mesh.
+                m_builder.begin_mesh(m_current_mesh_name.c_str());
+                m_inside_mesh_def = true;
 
-        // Set face vertex texture coordinates (if any).
-        if (m_face_tex_coord_indices.size() == n)
-            m_builder.set_face_vertex_tex_coords(&m_face_tex_coord_indices.front());
+                // Clear material slot definitions.
+                m_material_slots.clear();
+                m_current_material_slot_index = 0;
+            }
+        }
+    };
 
-        // Set face material.
-        m_builder.set_face_material(m_current_material_slot_index);
 
-        // End defining the face.
-        m_builder.end_face();
-    }
+    //
+    // Statement handler that assembles meshes as statements are parsed.
+    //
 
-    void insert_vertices_into_mesh()
+    class SerialHandler
     {
-        const size_t face_vertex_index_count = m_face_vertex_indices.size();
+      public:
+        SerialHandler(
+            OBJMeshFileLexer&   lexer,
+            MeshAssembler&      assembler)
+          : m_lexer(lexer)
+          , m_assembler(assembler)
+        {
+        }
 
-        for (size_t i = 0; i < face_vertex_index_count; ++i)
+        void on_vertex(const Vector3d& v)
         {
-            const size_t vertex_index = m_face_vertex_indices[i];
-            ensure_minimum_size(m_vertex_index_mapping, vertex_index + 1, Undefined);
-            if (m_vertex_index_mapping[vertex_index] == Undefined)
-                m_vertex_index_mapping[vertex_index] = m_builder.push_vertex(m_vertices[vertex_index]);
+            m_assembler.m_vertices.push_back(v);
         }
-    }
 
-    void insert_vertex_normals_into_mesh()
-    {
-        const size_t face_normal_index_count = m_face_normal_indices.size();
+        void on_tex_coords(const Vector2d& v)
+        {
+            m_assembler.m_tex_coords.push_back(v);
+        }
 
-        for (size_t i = 0; i < face_normal_index_count; ++i)
+        void on_normal(const Vector3d& n)
         {
-            const size_t normal_index = m_face_normal_indices[i];
-            ensure_minimum_size(m_normal_index_mapping, normal_index + 1, Undefined);
-            if (m_normal_index_mapping[normal_index] == Undefined)
-                m_normal_index_mapping[normal_index] = m_builder.push_vertex_normal(m_normals[normal_index]);
+            m_assembler.m_normals.push_back(n);
         }
-    }
 
-    void insert_tex_coords_into_mesh()
-    {
-        const size_t face_tex_coord_index_count = m_face_tex_coord_indices.size();
+        void on_face(
+            const vector<long>& vertex_indices,
+            const vector<long>& tex_coord_indices,
+            const vector<long>& normal_indices)
+        {
+            m_assembler.insert_face(
+                vertex_indices.empty() ? 0 : &vertex_indices[0],
+                vertex_indices.size(),
+                tex_coord_indices.empty() ? 0 : &tex_coord_indices[0],
+                tex_coord_indices.size(),
+                normal_indices.empty() ? 0 : &normal_indices[0],
+                normal_indices.size(),
+                m_assembler.m_vertices.size(),
+                m_assembler.m_tex_coords.size(),
+                m_assembler.m_normals.size(),
+                m_lexer.get_line_number());
+        }
 
-        for (size_t i = 0; i < face_tex_coord_index_count; ++i)
+        void on_object_or_group(const string& name)
         {
-            const size_t tex_coord_index = m_face_tex_coord_indices[i];
-            ensure_minimum_size(m_tex_coord_index_mapping, tex_coord_index + 1, Undefined);
-            if (m_tex_coord_index_mapping[tex_coord_index] == Undefined)
-                m_tex_coord_index_mapping[tex_coord_index] = m_builder.push_tex_coords(m_tex_coords[tex_coord_index]);
+            m_assembler.begin_object_or_group(name);
         }
-    }
 
-    static void translate_indices(
-        vector<size_t>&         indices,
-        const vector<size_t>&   mapping)
-    {
-        const size_t count = indices.size();
+        void on_use_material(const string& name)
+        {
+            m_assembler.use_material(name);
+        }
 
-        for (size_t i = 0; i < count; ++i)
-            indices[i] = mapping[indices[i]];
-    }
+      private:
+        OBJMeshFileLexer&       m_lexer;
+        MeshAssembler&          m_assembler;
+    };
 
-    void parse_o_g_statement()
-    {
-        // Retrieve the name of the upcoming mesh.
-        const string upcoming_mesh_name = parse_compound_identifier();
 
-        // Start a new mesh only if the name of the object or group actually changes.
-        if (upcoming_mesh_name != m_current_mesh_name)
+    //
+    // Statements and features parsed from one chunk of a file.
+    //
+
+    struct Chunk
+    {
+        struct Statement
         {
-            // End the current mesh.
-            if (m_inside_mesh_def)
-            {
-                m_builder.end_mesh();
-                m_inside_mesh_def = false;
-            }
+            enum Type { Face, ObjectOrGroup, UseMaterial };
+
+            Type                m_type;
+            size_t              m_line_number;          // line number within the chunk
+            size_t              m_index;                // first face index in m_indices, or index in m_names
+            uint32              m_vertex_index_count;
+            uint32              m_tex_coord_index_count;
+            uint32              m_normal_index_count;
+            size_t              m_vertex_count;         // number of features defined in the chunk so far
+            size_t              m_tex_coord_count;
+            size_t              m_normal_count;
+        };
+
+        const char*             m_begin;
+        const char*             m_end;
+        size_t                  m_line_count;
+
+        vector<Vector3d>        m_vertices;
+        vector<Vector2d>        m_tex_coords;
+        vector<Vector3d>        m_normals;
+        vector<Statement>       m_statements;
+        vector<long>            m_indices;
+        vector<string>          m_names;
+
+        // Parse error, if any; statements past the error were not parsed.
+        bool                    m_parse_error;
+        size_t                  m_parse_error_line_number;
+    };
+
+
+    //
+    // Statement handler that records statements into a chunk.
+    //
+
+    class ChunkHandler
+    {
+      public:
+        ChunkHandler(
+            OBJMeshFileLexer&   lexer,
+            Chunk&              chunk)
+          : m_lexer(lexer)
+          , m_chunk(chunk)
+        {
+        }
 
-            clear_keep_memory(m_vertex_index_mapping);
-            clear_keep_memory(m_tex_coord_index_mapping);
-            clear_keep_memory(m_normal_index_mapping);
+        void on_vertex(const Vector3d& v)
+        {
+            m_chunk.m_vertices.push_back(v);
+        }
 
-            m_current_mesh_name = upcoming_mesh_name;
+        void on_tex_coords(const Vector2d& v)
+        {
+            m_chunk.m_tex_coords.push_back(v);
         }
-    }
 
-    string parse_compound_identifier()
-    {
-        string identifier;
+        void on_normal(const Vector3d& n)
+        {
+            m_chunk.m_normals.push_back(n);
+        }
 
-        m_lexer.eat_blanks();
+        void on_face(
+            const vector<long>& vertex_indices,
+            const vector<long>& tex_coord_indices,
+            const vector<long>& normal_indices)
+        {
+            Chunk::Statement& statement = push_statement(Chunk::Statement::Face, m_chunk.m_indices.size());
+            statement.m_vertex_index_count = static_cast<uint32>(vertex_indices.size());
+            statement.m_tex_coord_index_count = static_cast<uint32>(tex_coord_indices.size());
+            statement.m_normal_index_count = static_cast<uint32>(normal_indices.size());
+
+            m_chunk.m_indices.insert(m_chunk.m_indices.end(), vertex_indices.begin(), vertex_indices.end());
+            m_chunk.m_indices.insert(m_chunk.m_indices.end(), tex_coord_indices.begin(), tex_coord_indices.end());
+            m_chunk.m_indices.insert(m_chunk.m_indices.end(), normal_indices.begin(), normal_indices.end());
+        }
 
-        while (!m_lexer.is_eol())
+        void on_object_or_group(const string& name)
         {
-            const char* token;
-            size_t token_length;
+            push_statement(Chunk::Statement::ObjectOrGroup, m_chunk.m_names.size());
+            m_chunk.m_names.push_back(name);
+        }
 
-            m_lexer.accept_string(&token, &token_length);
-            m_lexer.eat_blanks();
+        void on_use_material(const string& name)
+        {
+            push_statement(Chunk::Statement::UseMaterial, m_chunk.m_names.size());
+            m_chunk.m_names.push_back(name);
+        }
 
-            if (!identifier.empty())
-                identifier += ' ';
+      private:
+        OBJMeshFileLexer&       m_lexer;
+        Chunk&                  m_chunk;
 
-            identifier.append(token, token_length);
+        Chunk::Statement& push_statement(const Chunk::Statement::Type type, const size_t index)
+        {
+            m_chunk.m_statements.push_back(Chunk::Statement());
+
+            Chunk::Statement& statement = m_chunk.m_statements.back();
+            statement.m_type = type;
+            statement.m_line_number = m_lexer.get_line_number();
+            statement.m_index = index;
+            statement.m_vertex_index_count = 0;
+            statement.m_tex_coord_index_count = 0;
+            statement.m_normal_index_count = 0;
+            statement.m_vertex_count = m_chunk.m_vertices.size();
+            statement.m_tex_coord_count = m_chunk.m_tex_coords.size();
+            statement.m_normal_count = m_chunk.m_normals.size();
+
+            return statement;
         }
+    };
 
-        return identifier;
-    }
 
-    void parse_v_statement()
+    //
+    // Job that parses one chunk of a file.
+    //
+
+    class ParseChunkJob
+      : public IJob
     {
-        Vector3d v;
+      public:
+        ParseChunkJob(
+            const OBJMeshFileLexer::ParsingMode parsing_mode,
+            Chunk&                              chunk)
+          : m_parsing_mode(parsing_mode)
+          , m_chunk(chunk)
+        {
+        }
 
-        m_lexer.eat_blanks();
-        v.x = m_lexer.accept_double();
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+        {
+            m_chunk.m_line_count = count(m_chunk.m_begin, m_chunk.m_end, '\n');
+            m_chunk.m_parse_error = false;
 
-        m_lexer.eat_blanks();
-        v.y = m_lexer.accept_double();
+            OBJMeshFileLexer lexer(m_parsing_mode);
+            lexer.open(m_chunk.m_begin, m_chunk.m_end);
 
-        m_lexer.eat_blanks();
-        v.z = m_lexer.accept_double();
+            ChunkHandler handler(lexer, m_chunk);
+            StatementParser<ChunkHandler> parser(lexer, handler);
 
-        m_lexer.eat_blanks();
+            try
+            {
+                parser.parse();
+            }
+            catch (const OBJMeshFileReader::ExceptionParseError& e)
+            {
+                m_chunk.m_parse_error = true;
+                m_chunk.m_parse_error_line_number = e.m_line;
+            }
 
-        if (!m_lexer.is_eol())
-            m_lexer.accept_double();
+            lexer.close();
+        }
 
-        m_vertices.push_back(v);
-    }
+      private:
+        const OBJMeshFileLexer::ParsingMode m_parsing_mode;
+        Chunk&                              m_chunk;
+    };
 
-    void parse_vt_statement()
+    template <typename T>
+    void append(vector<T>& dest, const vector<T>& source)
     {
-        Vector2d v;
-
-        m_lexer.eat_blanks();
-        v.x = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-        v.y = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
+        dest.insert(dest.end(), source.begin(), source.end());
+    }
+}
 
-        if (!m_lexer.is_eol())
-            m_lexer.accept_double();
+struct OBJMeshFileReader::Impl
+{
+    const int               m_options;
+    IMeshBuilder&           m_builder;
 
-        m_tex_coords.push_back(v);
+    Impl(
+        const int           options,
+        IMeshBuilder&       builder)
+      : m_options(options)
+      , m_builder(builder)
+    {
     }
 
-    void parse_vn_statement()
+    OBJMeshFileLexer::ParsingMode get_parsing_mode() const
     {
-        Vector3d n;
+        return
+            (m_options & FavorSpeedOverPrecision)
+                ? OBJMeshFileLexer::Fast
+                : OBJMeshFileLexer::Precise;
+    }
 
-        m_lexer.eat_blanks();
-        n.x = m_lexer.accept_double();
+    void read_serial(const string& filename)
+    {
+        OBJMeshFileLexer lexer(get_parsing_mode());
 
-        m_lexer.eat_blanks();
-        n.y = m_lexer.accept_double();
+        // Open the input file.
+        if (!lexer.open(filename))
+            throw ExceptionIOError();
 
-        m_lexer.eat_blanks();
-        n.z = m_lexer.accept_double();
+        // Parse the file.
+        MeshAssembler assembler(m_options, m_builder);
+        SerialHandler handler(lexer, assembler);
+        StatementParser<SerialHandler> parser(lexer, handler);
+        parser.parse();
+        assembler.finish();
 
-        m_normals.push_back(n);
+        // Close the input file.
+        lexer.close();
     }
 
-    void parse_usemtl_statement()
+    void read_parallel(const string& filename)
     {
-        // Begin a mesh definition if we're not already inside one.
-        ensure_mesh_def();
+        // Load the whole file in memory.
+        vector<char> contents;
+        load_file(filename, contents);
+
+        if (contents.empty())
+            return;
+
+        // Split the file into chunks at line boundaries.
+        const size_t thread_count = System::get_available_cpu_core_count();
+        const size_t chunk_count =
+            max<size_t>(min(4 * thread_count, contents.size() / MinChunkSize), 1);
+        const char* file_begin = contents.empty() ? 0 : &contents[0];
+        const char* file_end = file_begin + contents.size();
+
+        vector<Chunk> chunks(chunk_count);
+        const char* chunk_begin = file_begin;
+        for (size_t i = 0; i < chunk_count; ++i)
+        {
+            const char* chunk_end = file_begin + contents.size() * (i + 1) / chunk_count;
+            chunk_end = max(chunk_end, chunk_begin);
 
-        // Retrieve the name of the material slot.
-        const string material_slot_name = parse_compound_identifier();
+            // Extend the chunk to the end of its last line.
+            if (i + 1 < chunk_count)
+            {
+                while (chunk_end < file_end && chunk_end[-1] != '\n')
+                    ++chunk_end;
+            }
+            else chunk_end = file_end;
 
-        // Check whether this material slot has already been defined for this mesh.
-        const map<string, size_t>::const_iterator& it =
-            m_material_slots.find(material_slot_name);
+            chunks[i].m_begin = chunk_begin;
+            chunks[i].m_end = chunk_end;
+            chunk_begin = chunk_end;
+        }
 
-        if (it != m_material_slots.end())
+        // Parse the chunks concurrently.
         {
-            // It has: just make it the active material slot.
-            m_current_material_slot_index = it->second;
+            Logger logger;
+            JobQueue job_queue;
+            JobManager job_manager(
+                logger,
+                job_queue,
+                thread_count,
+                JobManager::KeepRunningOnEmptyQueue);
+
+            for (size_t i = 0; i < chunk_count; ++i)
+                job_queue.schedule(new ParseChunkJob(get_parsing_mode(), chunks[i]));
+
+            job_manager.start();
+            job_queue.wait_until_completion();
         }
-        else
+
+        // Replay the statements of all chunks in file order.
+        MeshAssembler assembler(m_options, m_builder);
+
+        size_t vertex_count = 0;
+        size_t tex_coord_count = 0;
+        size_t normal_count = 0;
+
+        for (size_t i = 0; i < chunk_count; ++i)
         {
-            // It hasn't: insert it into the mesh and make it the active material slot.
-            m_current_material_slot_index = m_builder.push_material_slot(material_slot_name.c_str());
-            m_material_slots.insert(make_pair(material_slot_name, m_current_material_slot_index));
+            vertex_count += chunks[i].m_vertices.size();
+            tex_coord_count += chunks[i].m_tex_coords.size();
+            normal_count += chunks[i].m_normals.size();
         }
-    }
 
-    void ensure_mesh_def()
-    {
-        if (!m_inside_mesh_def)
+        assembler.m_vertices.reserve(vertex_count);
+        assembler.m_tex_coords.reserve(tex_coord_count);
+        assembler.m_normals.reserve(normal_count);
+
+        size_t first_line_number = 0;
+
+        for (size_t i = 0; i < chunk_count; ++i)
         {
-            // Begin the definition of the new mesh.
-            m_builder.begin_mesh(m_current_mesh_name.c_str());
-            m_inside_mesh_def = true;
+            Chunk& chunk = chunks[i];
+
+            // Features of previous chunks come before the ones of this chunk.
+            const size_t base_vertex_count = assembler.m_vertices.size();
+            const size_t base_tex_coord_count = assembler.m_tex_coords.size();
+            const size_t base_normal_count = assembler.m_normals.size();
+
+            append(assembler.m_vertices, chunk.m_vertices);
+            append(assembler.m_tex_coords, chunk.m_tex_coords);
+            append(assembler.m_normals, chunk.m_normals);
+
+            for (size_t j = 0, e = chunk.m_statements.size(); j < e; ++j)
+            {
+                const Chunk::Statement& statement = chunk.m_statements[j];
+
+                switch (statement.m_type)
+                {
+                  case Chunk::Statement::Face:
+                    {
+                        const long* indices = &chunk.m_indices[statement.m_index];
+                        const long* tex_coord_indices = indices + statement.m_vertex_index_count;
+                        const long* normal_indices = tex_coord_indices + statement.m_tex_coord_index_count;
+
+                        assembler.insert_face(
+                            indices,
+                            statement.m_vertex_index_count,
+                            tex_coord_indices,
+                            statement.m_tex_coord_index_count,
+                            normal_indices,
+                            statement.m_normal_index_count,
+                            base_vertex_count + statement.m_vertex_count,
+                            base_tex_coord_count + statement.m_tex_coord_count,
+                            base_normal_count + statement.m_normal_count,
+                            first_line_number + statement.m_line_number);
+                    }
+                    break;
+
+                  case Chunk::Statement::ObjectOrGroup:
+                    assembler.begin_object_or_group(chunk.m_names[statement.m_index]);
+                    break;
+
+                  case Chunk::Statement::UseMaterial:
+                    assembler.use_material(chunk.m_names[statement.m_index]);
+                    break;
+                }
+            }
 
-            // Clear material slot definitions.
-            m_material_slots.clear();
-            m_current_material_slot_index = 0;
+            if (chunk.m_parse_error)
+                throw ExceptionParseError(first_line_number + chunk.m_parse_error_line_number);
+
+            first_line_number += chunk.m_line_count;
+
+            // Release the memory of this chunk as soon as possible.
+            clear_release_memory(chunk.m_vertices);
+            clear_release_memory(chunk.m_tex_coords);
+            clear_release_memory(chunk.m_normals);
+            clear_release_memory(chunk.m_statements);
+            clear_release_memory(chunk.m_indices);
+            clear_release_memory(chunk.m_names);
         }
+
+        assembler.finish();
+    }
+
+    static void load_file(const string& filename, vector<char>& contents)
+    {
+        BufferedFile file(
+            filename.c_str(),
+            BufferedFile::BinaryType,
+            BufferedFile::ReadMode);
+
+        if (!file.is_open())
+            throw ExceptionIOError();
+
+        if (!file.seek(0, BufferedFile::SeekFromEnd))
+            throw ExceptionIOError();
+
+        const int64 size = file.tell();
+
+        if (size < 0 || !file.seek(0, BufferedFile::SeekFromBeginning))
+            throw ExceptionIOError();
+
+        contents.resize(static_cast<size_t>(size));
+
+        if (size > 0 && file.read(&contents[0], contents.size()) != contents.size())
+            throw ExceptionIOError();
     }
 };
 
@@ -570,15 +1087,9 @@ void OBJMeshFileReader::read(IMeshBuilder& builder)
 {
     Impl impl(m_options, builder);
 
-    // Open the input file.
-    if (!impl.m_lexer.open(m_filename))
-        throw ExceptionIOError();
-
-    // Parse the file.
-    impl.parse_file();
-
-    // Close the input file.
-    impl.m_lexer.close();
+    if (m_options & ParseInParallel)
+        impl.read_parallel(m_filename);
+    else impl.read_serial(m_filename);
 }
 
 }   // namespace foundation
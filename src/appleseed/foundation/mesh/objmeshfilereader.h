@@ -83,7 +83,8 @@ class OBJMeshFileReader
     {
         Default                 = 0,            // none of the flags below
         FavorSpeedOverPrecision = 1 << 0,       // use approximate algorithm for parsing floating-point values
-        StopOnInvalidFaceDef    = 1 << 1        // stop parsing on invalid face definitions
+        StopOnInvalidFaceDef    = 1 << 1,       // stop parsing on invalid face definitions
+        ParseInParallel         = 1 << 2        // load the file in memory and parse chunks of it on all cores
     };
 
     // Constructor.
@@ -28,6 +28,7 @@
 //
 
 // appleseed.foundation headers.
+#include "foundation/math/aliastable.h"
 #include "foundation/math/cdf.h"
 #include "foundation/math/rng/distribution.h"
 #include "foundation/math/rng/xorshift.h"
@@ -88,6 +89,54 @@ BENCHMARK_SUITE(Foundation_Math_CDF)
     }
 }
 
+BENCHMARK_SUITE(Foundation_Math_AliasTable)
+{
+    template <size_t Size>
+    struct Fixture
+    {
+        typedef AliasTable<size_t, double> AliasTableType;
+
+        AliasTableType  m_table;
+        Xorshift        m_rng;
+        double          m_x;
+
+        Fixture()
+          : m_x(0.0)
+        {
+            for (size_t i = 0; i < Size; ++i)
+                m_table.insert(i, rand_double1(m_rng));
+
+            assert(m_table.valid());
+
+            m_table.prepare();
+        }
+    };
+
+    BENCHMARK_CASE_F(DoublePrecisionSampling_10Elements, Fixture<10>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_table.sample(rand_double2(m_rng)).second;
+    }
+
+    BENCHMARK_CASE_F(DoublePrecisionSampling_30Elements, Fixture<30>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_table.sample(rand_double2(m_rng)).second;
+    }
+
+    BENCHMARK_CASE_F(DoublePrecisionSampling_1000Elements, Fixture<1000>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_table.sample(rand_double2(m_rng)).second;
+    }
+
+    BENCHMARK_CASE_F(DoublePrecisionSampling_1000000Elements, Fixture<1000000>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_table.sample(rand_double2(m_rng)).second;
+    }
+}
+
 BENCHMARK_SUITE(Foundation_Math_CDF_Linear_Search)
 {
     template <size_t Size>
@@ -63,6 +63,32 @@ BENCHMARK_SUITE(Foundation_Image_ColorSpace)
         m_output = fast_linear_rgb_to_srgb(m_input);
     }
 
+    BENCHMARK_CASE_F(sRGBToLinearRGBConversion, LinearRGBTosRGBFixture)
+    {
+        m_output = srgb_to_linear_rgb(m_input);
+    }
+
+    BENCHMARK_CASE_F(FastsRGBToLinearRGBConversion, LinearRGBTosRGBFixture)
+    {
+        m_output = fast_srgb_to_linear_rgb(m_input);
+    }
+
+    BENCHMARK_CASE_F(LinearRGBToCIEXYZConversion, LinearRGBTosRGBFixture)
+    {
+        m_output = linear_rgb_to_ciexyz(m_input);
+    }
+
+#ifdef APPLESEED_USE_SSE
+
+    BENCHMARK_CASE_F(SSELinearRGBToCIEXYZConversion, LinearRGBTosRGBFixture)
+    {
+        APPLESEED_SIMD4_ALIGN float transfer[4] = { m_input[0], m_input[1], m_input[2], 0.0f };
+        _mm_store_ps(transfer, linear_rgb_to_ciexyz(_mm_load_ps(transfer)));
+        m_output = Color3f(transfer[0], transfer[1], transfer[2]);
+    }
+
+#endif
+
     struct SpectrumToCIEXYZFixture
     {
         const LightingConditions    m_lighting_conditions;
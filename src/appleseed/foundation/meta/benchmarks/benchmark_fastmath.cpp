@@ -274,6 +274,90 @@ BENCHMARK_SUITE(Foundation_Math_FastMath)
             faster_exp(&m_output[i]);
     }
 
+    //
+    // Sin(x).
+    //
+
+    BENCHMARK_CASE_F(StdSin, Fixture)
+    {
+        memcpy(m_output, m_values, N * sizeof(float));
+
+        for (size_t i = 0; i < N; ++i)
+            m_output[i] = sin(m_output[i]);
+    }
+
+    BENCHMARK_CASE_F(ScalarFastSin, Fixture)
+    {
+        memcpy(m_output, m_values, N * sizeof(float));
+
+        for (size_t i = 0; i < N; ++i)
+            m_output[i] = fast_sin_full(m_output[i]);
+    }
+
+    BENCHMARK_CASE_F(VectorFastSin, Fixture)
+    {
+        memcpy(m_output, m_values, N * sizeof(float));
+
+        for (size_t i = 0; i < N; i += 4)
+            fast_sin_full(&m_output[i]);
+    }
+
+    //
+    // Acos(x).
+    //
+
+    BENCHMARK_CASE_F(StdAcos, Fixture)
+    {
+        memcpy(m_output, m_values, N * sizeof(float));
+
+        for (size_t i = 0; i < N; ++i)
+            m_output[i] = acos(m_output[i]);
+    }
+
+    BENCHMARK_CASE_F(ScalarFastAcos, Fixture)
+    {
+        memcpy(m_output, m_values, N * sizeof(float));
+
+        for (size_t i = 0; i < N; ++i)
+            m_output[i] = fast_acos(m_output[i]);
+    }
+
+    BENCHMARK_CASE_F(VectorFastAcos, Fixture)
+    {
+        memcpy(m_output, m_values, N * sizeof(float));
+
+        for (size_t i = 0; i < N; i += 4)
+            fast_acos(&m_output[i]);
+    }
+
+    //
+    // Atan2(y, x).
+    //
+
+    BENCHMARK_CASE_F(StdAtan2, Fixture)
+    {
+        memcpy(m_output, m_values, N * sizeof(float));
+
+        for (size_t i = 0; i < N; ++i)
+            m_output[i] = atan2(m_output[i], m_values[i]);
+    }
+
+    BENCHMARK_CASE_F(ScalarFastAtan2, Fixture)
+    {
+        memcpy(m_output, m_values, N * sizeof(float));
+
+        for (size_t i = 0; i < N; ++i)
+            m_output[i] = fast_atan2(m_output[i], m_values[i]);
+    }
+
+    BENCHMARK_CASE_F(VectorFastAtan2, Fixture)
+    {
+        memcpy(m_output, m_values, N * sizeof(float));
+
+        for (size_t i = 0; i < N; i += 4)
+            fast_atan2(&m_output[i], &m_values[i]);
+    }
+
     //
     // Rcp(x).
     //
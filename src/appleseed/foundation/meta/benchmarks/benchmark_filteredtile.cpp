@@ -35,15 +35,16 @@ using namespace foundation;
 
 BENCHMARK_SUITE(Foundation_Image_FilteredTile)
 {
+    template <typename Filter>
     struct Fixture
     {
-        GaussianFilter2<float>  m_filter;
+        Filter                  m_filter;
         FilteredTile            m_tile;
         const volatile float    m_x;
         const volatile float    m_y;
 
-        Fixture()
-          : m_filter(2.0f, 2.0f, 8.0f)
+        explicit Fixture(const Filter& filter = Filter(2.0f, 2.0f))
+          : m_filter(filter)
           , m_tile(1024, 1024, 4, m_filter)
           , m_x(42.42f)
           , m_y(66.66f)
@@ -51,10 +52,42 @@ BENCHMARK_SUITE(Foundation_Image_FilteredTile)
         }
     };
 
-    BENCHMARK_CASE_F(Add, Fixture)
+    struct GaussianFixture
+      : public Fixture<GaussianFilter2<float> >
+    {
+        GaussianFixture()
+          : Fixture<GaussianFilter2<float> >(GaussianFilter2<float>(2.0f, 2.0f, 8.0f))
+        {
+        }
+    };
+
+    typedef Fixture<BlackmanHarrisFilter2<float> > BlackmanHarrisFixture;
+
+    BENCHMARK_CASE_F(Add, GaussianFixture)
+    {
+        const float Values[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+
+        m_tile.add(m_x, m_y, Values);
+    }
+
+    BENCHMARK_CASE_F(AddExclusive, GaussianFixture)
+    {
+        const float Values[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+
+        m_tile.add_exclusive(m_x, m_y, Values);
+    }
+
+    BENCHMARK_CASE_F(Add_BlackmanHarris, BlackmanHarrisFixture)
     {
         const float Values[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
 
         m_tile.add(m_x, m_y, Values);
     }
+
+    BENCHMARK_CASE_F(AddExclusive_BlackmanHarris, BlackmanHarrisFixture)
+    {
+        const float Values[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+
+        m_tile.add_exclusive(m_x, m_y, Values);
+    }
 }
@@ -31,6 +31,7 @@
 #include "foundation/image/image.h"
 #include "foundation/math/rng/distribution.h"
 #include "foundation/math/rng/xorshift.h"
+#include "foundation/math/sampling/hierarchicalimageimportancesampler.h"
 #include "foundation/math/sampling/imageimportancesampler.h"
 #include "foundation/math/vector.h"
 #include "foundation/utility/benchmark.h"
@@ -44,10 +45,9 @@ using namespace std;
 
 BENCHMARK_SUITE(Foundation_Math_Sampling_ImageImportanceSampler)
 {
+    template <typename ImportanceSamplerType>
     struct Fixture
     {
-        typedef ImageImportanceSampler<ImageSampler::Payload, float> ImportanceSamplerType;
-
         auto_ptr<ImportanceSamplerType> m_importance_sampler;
         Xorshift                        m_rng;
 
@@ -70,15 +70,29 @@ BENCHMARK_SUITE(Foundation_Math_Sampling_ImageImportanceSampler)
         }
     };
 
-    BENCHMARK_CASE_F(Sample, Fixture)
+    template <typename ImportanceSamplerType>
+    void sample(Fixture<ImportanceSamplerType>& fixture)
     {
-        const Vector2f s = rand_vector2<Vector2f>(m_rng);
+        const Vector2f s = rand_vector2<Vector2f>(fixture.m_rng);
 
         Vector2u texel_coords;
         float texel_prob;
-        m_importance_sampler->sample(s, texel_coords.x, texel_coords.y, texel_prob);
+        fixture.m_importance_sampler->sample(s, texel_coords.x, texel_coords.y, texel_prob);
+
+        fixture.m_texel_coords_sum += texel_coords;
+        fixture.m_texel_prob_sum += texel_prob;
+    }
+
+    typedef Fixture<ImageImportanceSampler<ImageSampler::Payload, float> > CDFFixture;
+    typedef Fixture<HierarchicalImageImportanceSampler<ImageSampler::Payload, float> > HierarchicalFixture;
 
-        m_texel_coords_sum += texel_coords;
-        m_texel_prob_sum += texel_prob;
+    BENCHMARK_CASE_F(Sample, CDFFixture)
+    {
+        sample(*this);
+    }
+
+    BENCHMARK_CASE_F(SampleHierarchical, HierarchicalFixture)
+    {
+        sample(*this);
     }
 }
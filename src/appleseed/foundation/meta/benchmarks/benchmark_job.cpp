@@ -27,11 +27,16 @@
 // THE SOFTWARE.
 //
 
+
 // appleseed.foundation headers.
+#include "foundation/platform/types.h"
 #include "foundation/utility/benchmark.h"
 #include "foundation/utility/job.h"
 #include "foundation/utility/log.h"
 
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
 // Standard headers.
 #include <cstddef>
 
@@ -82,4 +87,199 @@ BENCHMARK_SUITE(Foundation_Utility_Job)
     {
         payload();
     }
+
+    BENCHMARK_CASE_F(QuadThreadedJobExecution, Fixture<4>)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(OctoThreadedJobExecution, Fixture<8>)
+    {
+        payload();
+    }
+
+    //
+    // Scaling benchmarks.
+    //
+    // Each job shape is run with 1 to 128 worker threads. Throughput is reported in
+    // jobs (or samples) per second; dividing the throughput at N threads by N times
+    // the single-threaded throughput gives the parallel efficiency of the scheduler.
+    //
+    //   MicroJobs       many jobs doing almost no work: measures the cost of scheduling
+    //                   a job, dominated by contention on the job queue at high thread counts
+    //   TileJobs        one job per tile of a 1024x1024 frame, with uneven costs like TileJob
+    //   SampleJobs      one job per thread reserving batches of samples from a shared counter
+    //                   and rescheduling itself until all samples are taken, like SampleGeneratorJob
+    //   RoundTrips      a single job scheduled from the main thread then waited for:
+    //                   measures the latency between scheduling a job and its completion
+    //
+
+    // Perform a given number of iterations of a cheap computation.
+    uint32 compute(const size_t iteration_count, uint32 seed)
+    {
+        for (size_t i = 0; i < iteration_count; ++i)
+            seed = seed * 1664525 + 1013904223;
+
+        return seed;
+    }
+
+    struct ComputeJob
+      : public IJob
+    {
+        size_t  m_iteration_count;
+        uint32  m_result;
+
+        virtual void execute(const size_t thread_index)
+        {
+            m_result = compute(m_iteration_count, m_result);
+        }
+    };
+
+    struct SampleJob
+      : public IJob
+    {
+        JobQueue*               m_job_queue;
+        boost::atomic<uint32>*  m_remaining_samples;
+        uint32                  m_result;
+
+        virtual void execute(const size_t thread_index)
+        {
+            const uint32 SamplesPerJob = 256;
+            const size_t IterationsPerSample = 64;
+
+            // Reserve a batch of samples.
+            uint32 remaining = m_remaining_samples->load();
+            uint32 acquired;
+            do
+            {
+                if (remaining == 0)
+                    return;
+                acquired = remaining < SamplesPerJob ? remaining : SamplesPerJob;
+            } while (!m_remaining_samples->compare_exchange_weak(remaining, remaining - acquired));
+
+            m_result = compute(acquired * IterationsPerSample, m_result);
+
+            // Reschedule this job.
+            m_job_queue->schedule(this, false);
+        }
+    };
+
+    const size_t MicroJobCount = 4096;
+    const size_t MicroJobIterationCount = 100;
+
+    const size_t TileJobCount = 256;                        // 16x16 tiles of 64x64 pixels
+    const size_t TileJobIterationCount = 64 * 64 * 4;       // per pixel cost of 4 iterations in the cheapest tiles
+
+    const size_t MaxSampleJobCount = 128;
+    const uint32 SampleCount = 64 * 1024;
+
+    const size_t RoundTripCount = 64;
+
+    template <size_t ThreadCount>
+    struct ScalingFixture
+      : public Fixture<ThreadCount>
+    {
+        ComputeJob              m_micro_jobs[MicroJobCount];
+        ComputeJob              m_tile_jobs[TileJobCount];
+        SampleJob               m_sample_jobs[MaxSampleJobCount];
+        boost::atomic<uint32>   m_remaining_samples;
+        ComputeJob              m_round_trip_job;
+
+        ScalingFixture()
+        {
+            for (size_t i = 0; i < MicroJobCount; ++i)
+            {
+                m_micro_jobs[i].m_iteration_count = MicroJobIterationCount;
+                m_micro_jobs[i].m_result = static_cast<uint32>(i);
+            }
+
+            // Tiles cost 1x to 4x the cheapest tile, as empty and busy parts of an image do.
+            for (size_t i = 0; i < TileJobCount; ++i)
+            {
+                m_tile_jobs[i].m_iteration_count = TileJobIterationCount * (1 + (i * 7) % 4);
+                m_tile_jobs[i].m_result = static_cast<uint32>(i);
+            }
+
+            for (size_t i = 0; i < MaxSampleJobCount; ++i)
+            {
+                m_sample_jobs[i].m_job_queue = &this->m_job_queue;
+                m_sample_jobs[i].m_remaining_samples = &m_remaining_samples;
+                m_sample_jobs[i].m_result = static_cast<uint32>(i);
+            }
+
+            m_round_trip_job.m_iteration_count = 0;
+            m_round_trip_job.m_result = 0;
+        }
+
+        void run_micro_jobs()
+        {
+            for (size_t i = 0; i < MicroJobCount; ++i)
+                this->m_job_queue.schedule(&m_micro_jobs[i], false);
+
+            this->m_job_queue.wait_until_completion();
+        }
+
+        void run_tile_jobs()
+        {
+            for (size_t i = 0; i < TileJobCount; ++i)
+                this->m_job_queue.schedule(&m_tile_jobs[i], false);
+
+            this->m_job_queue.wait_until_completion();
+        }
+
+        void run_sample_jobs()
+        {
+            m_remaining_samples = SampleCount;
+
+            for (size_t i = 0; i < ThreadCount; ++i)
+                this->m_job_queue.schedule(&m_sample_jobs[i], false);
+
+            this->m_job_queue.wait_until_completion();
+        }
+
+        void run_round_trips()
+        {
+            for (size_t i = 0; i < RoundTripCount; ++i)
+            {
+                this->m_job_queue.schedule(&m_round_trip_job, false);
+                this->m_job_queue.wait_until_completion();
+            }
+        }
+    };
+
+#define DEFINE_SCALING_BENCHMARK_CASES(ThreadCount)                                             \
+    BENCHMARK_CASE_F(MicroJobs_##ThreadCount##Threads, ScalingFixture<ThreadCount>)             \
+    {                                                                                           \
+        set_processed_items(MicroJobCount);                                                     \
+        run_micro_jobs();                                                                       \
+    }                                                                                           \
+                                                                                                \
+    BENCHMARK_CASE_F(TileJobs_##ThreadCount##Threads, ScalingFixture<ThreadCount>)              \
+    {                                                                                           \
+        set_processed_items(TileJobCount);                                                      \
+        run_tile_jobs();                                                                        \
+    }                                                                                           \
+                                                                                                \
+    BENCHMARK_CASE_F(SampleJobs_##ThreadCount##Threads, ScalingFixture<ThreadCount>)            \
+    {                                                                                           \
+        set_processed_items(SampleCount);                                                       \
+        run_sample_jobs();                                                                      \
+    }                                                                                           \
+                                                                                                \
+    BENCHMARK_CASE_F(RoundTrips_##ThreadCount##Threads, ScalingFixture<ThreadCount>)            \
+    {                                                                                           \
+        set_processed_items(RoundTripCount);                                                    \
+        run_round_trips();                                                                      \
+    }
+
+    DEFINE_SCALING_BENCHMARK_CASES(1)
+    DEFINE_SCALING_BENCHMARK_CASES(2)
+    DEFINE_SCALING_BENCHMARK_CASES(4)
+    DEFINE_SCALING_BENCHMARK_CASES(8)
+    DEFINE_SCALING_BENCHMARK_CASES(16)
+    DEFINE_SCALING_BENCHMARK_CASES(32)
+    DEFINE_SCALING_BENCHMARK_CASES(64)
+    DEFINE_SCALING_BENCHMARK_CASES(128)
+
+#undef DEFINE_SCALING_BENCHMARK_CASES
 }
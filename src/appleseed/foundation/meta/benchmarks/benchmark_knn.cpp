@@ -33,6 +33,7 @@
 #include "foundation/math/rng/mersennetwister.h"
 #include "foundation/math/rng/xorshift.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/system.h"
 #include "foundation/platform/timers.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/autoreleaseptr.h"
@@ -282,3 +283,75 @@ BENCHMARK_SUITE(Foundation_Math_Knn_Query)
     BENCHMARK_CASE_F(PhotonMap_K100, PhotonMapFixture<100>)  { run_queries(); }
     BENCHMARK_CASE_F(PhotonMap_K500, PhotonMapFixture<500>)  { run_queries(); }
 }
+
+BENCHMARK_SUITE(Foundation_Math_Knn_BatchQuery)
+{
+    const size_t PointCount = 100000;
+    const size_t QueryCount = 10000;
+    const size_t AnswerSize = 20;
+    const float QueryMaxSquareDistance = 0.0001f;
+
+    struct Fixture
+    {
+        knn::Tree3f         m_tree;
+        vector<Vector3f>    m_query_points;
+        size_t              m_accumulator;
+
+        Fixture()
+          : m_accumulator(0)
+        {
+            MersenneTwister rng;
+
+            vector<Vector3f> points(PointCount);
+            for (size_t i = 0; i < PointCount; ++i)
+                points[i] = rand_vector1<Vector3f>(rng);
+
+            knn::Builder3f builder(m_tree);
+            builder.build<DefaultWallclockTimer>(&points[0], PointCount);
+
+            m_query_points.resize(QueryCount);
+            for (size_t i = 0; i < QueryCount; ++i)
+                m_query_points[i] = rand_vector1<Vector3f>(rng);
+        }
+
+        void run_batch_query(const size_t thread_count)
+        {
+            knn::BatchQuery3f query(m_tree, AnswerSize);
+            query.run(&m_query_points[0], QueryCount, QueryMaxSquareDistance, thread_count);
+
+            for (size_t i = 0; i < QueryCount; ++i)
+                m_accumulator += query.get_answer_size(i);
+        }
+    };
+
+    BENCHMARK_CASE_F(SequentialQueries, Fixture)
+    {
+        knn::Answer<float> answer(AnswerSize);
+        knn::Query3f query(m_tree, answer);
+
+        for (size_t i = 0; i < QueryCount; ++i)
+        {
+            query.run(m_query_points[i], QueryMaxSquareDistance);
+            m_accumulator += answer.size();
+        }
+    }
+
+    BENCHMARK_CASE_F(SequentialRangeQueries, Fixture)
+    {
+        knn::Answer<float> answer(AnswerSize);
+        knn::RangeQuery3f query(m_tree, answer);
+
+        for (size_t i = 0; i < QueryCount; ++i)
+            m_accumulator += query.run(m_query_points[i], QueryMaxSquareDistance);
+    }
+
+    BENCHMARK_CASE_F(BatchQuery_1Thread, Fixture)
+    {
+        run_batch_query(1);
+    }
+
+    BENCHMARK_CASE_F(BatchQuery_AllThreads, Fixture)
+    {
+        run_batch_query(System::get_logical_cpu_core_count());
+    }
+}
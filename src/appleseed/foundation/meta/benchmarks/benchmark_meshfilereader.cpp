@@ -0,0 +1,352 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/mesh/genericmeshfilereader.h"
+#include "foundation/mesh/genericmeshfilewriter.h"
+#include "foundation/mesh/imeshwalker.h"
+#include "foundation/mesh/meshbuilderbase.h"
+#include "foundation/mesh/objmeshfilereader.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/string.h"
+
+#ifdef APPLESEED_WITH_ALEMBIC
+
+// Alembic headers.
+#include "Alembic/Abc/OArchive.h"
+#include "Alembic/Abc/OObject.h"
+#include "Alembic/AbcCoreHDF5/ReadWrite.h"
+#include "Alembic/AbcGeom/OPolyMesh.h"
+
+#endif
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+namespace bf = boost::filesystem;
+
+BENCHMARK_SUITE(Foundation_Mesh_MeshFileReader)
+{
+    // A square grid of quads, each split into two triangles.
+    class GridMeshWalker
+      : public IMeshWalker
+    {
+      public:
+        explicit GridMeshWalker(const size_t resolution)
+          : m_resolution(resolution)
+        {
+        }
+
+        virtual const char* get_name() const APPLESEED_OVERRIDE
+        {
+            return "grid";
+        }
+
+        virtual size_t get_vertex_count() const APPLESEED_OVERRIDE
+        {
+            return (m_resolution + 1) * (m_resolution + 1);
+        }
+
+        virtual Vector3d get_vertex(const size_t i) const APPLESEED_OVERRIDE
+        {
+            return
+                Vector3d(
+                    static_cast<double>(i % (m_resolution + 1)),
+                    0.0,
+                    static_cast<double>(i / (m_resolution + 1)));
+        }
+
+        virtual size_t get_vertex_normal_count() const APPLESEED_OVERRIDE
+        {
+            return 1;
+        }
+
+        virtual Vector3d get_vertex_normal(const size_t i) const APPLESEED_OVERRIDE
+        {
+            return Vector3d(0.0, 1.0, 0.0);
+        }
+
+        virtual size_t get_tex_coords_count() const APPLESEED_OVERRIDE
+        {
+            return get_vertex_count();
+        }
+
+        virtual Vector2d get_tex_coords(const size_t i) const APPLESEED_OVERRIDE
+        {
+            const Vector3d v = get_vertex(i);
+            return Vector2d(v.x, v.z) / static_cast<double>(m_resolution);
+        }
+
+        virtual size_t get_material_slot_count() const APPLESEED_OVERRIDE
+        {
+            return 1;
+        }
+
+        virtual const char* get_material_slot(const size_t i) const APPLESEED_OVERRIDE
+        {
+            return "material";
+        }
+
+        virtual size_t get_face_count() const APPLESEED_OVERRIDE
+        {
+            return 2 * m_resolution * m_resolution;
+        }
+
+        virtual size_t get_face_vertex_count(const size_t face_index) const APPLESEED_OVERRIDE
+        {
+            return 3;
+        }
+
+        virtual size_t get_face_vertex(const size_t face_index, const size_t vertex_index) const APPLESEED_OVERRIDE
+        {
+            const size_t quad = face_index / 2;
+            const size_t v0 = (quad / m_resolution) * (m_resolution + 1) + quad % m_resolution;
+            const size_t v1 = v0 + 1;
+            const size_t v2 = v0 + m_resolution + 2;
+            const size_t v3 = v0 + m_resolution + 1;
+
+            const size_t vertices[2][3] = { { v0, v1, v2 }, { v0, v2, v3 } };
+            return vertices[face_index % 2][vertex_index];
+        }
+
+        virtual size_t get_face_vertex_normal(const size_t face_index, const size_t vertex_index) const APPLESEED_OVERRIDE
+        {
+            return 0;
+        }
+
+        virtual size_t get_face_tex_coords(const size_t face_index, const size_t vertex_index) const APPLESEED_OVERRIDE
+        {
+            return get_face_vertex(face_index, vertex_index);
+        }
+
+        virtual size_t get_face_material(const size_t face_index) const APPLESEED_OVERRIDE
+        {
+            return 0;
+        }
+
+      private:
+        const size_t m_resolution;
+    };
+
+#ifdef APPLESEED_WITH_ALEMBIC
+
+    void write_alembic_file(const string& filename, const IMeshWalker& walker)
+    {
+        using namespace Alembic::Abc;
+        using namespace Alembic::AbcGeom;
+
+        vector<V3f> positions;
+        positions.reserve(walker.get_vertex_count());
+        for (size_t i = 0; i < walker.get_vertex_count(); ++i)
+        {
+            const Vector3d v = walker.get_vertex(i);
+            positions.push_back(
+                V3f(
+                    static_cast<float>(v.x),
+                    static_cast<float>(v.y),
+                    static_cast<float>(v.z)));
+        }
+
+        vector<int32_t> indices;
+        vector<int32_t> counts;
+        indices.reserve(3 * walker.get_face_count());
+        counts.reserve(walker.get_face_count());
+        for (size_t i = 0; i < walker.get_face_count(); ++i)
+        {
+            for (size_t j = 0; j < 3; ++j)
+                indices.push_back(static_cast<int32_t>(walker.get_face_vertex(i, j)));
+            counts.push_back(3);
+        }
+
+        OArchive archive(Alembic::AbcCoreHDF5::WriteArchive(), filename);
+        OPolyMesh mesh(OObject(archive, kTop), walker.get_name());
+        mesh.getSchema().set(
+            OPolyMeshSchema::Sample(
+                P3fArraySample(positions),
+                Int32ArraySample(indices),
+                Int32ArraySample(counts)));
+    }
+
+#endif
+
+    struct NullMeshBuilder
+      : public MeshBuilderBase
+    {
+    };
+
+    template <size_t Resolution>
+    struct Fixture
+    {
+        const GridMeshWalker    m_walker;
+        NullMeshBuilder         m_builder;
+
+        Fixture()
+          : m_walker(Resolution)
+        {
+        }
+
+        // Write the grid to a file, once per benchmark case, and return the name of the file.
+        string write_file(const char* extension)
+        {
+            const string filename =
+                "unit benchmarks/outputs/benchmark_meshfilereader_" +
+                to_string(Resolution) + "." + extension;
+
+#ifdef APPLESEED_WITH_ALEMBIC
+            if (string(extension) == "abc")
+                write_alembic_file(filename, m_walker);
+            else
+#endif
+            {
+                GenericMeshFileWriter writer(filename.c_str());
+                writer.write(m_walker);
+            }
+
+            return filename;
+        }
+    };
+
+    template <size_t Resolution>
+    struct OBJFixture
+      : public Fixture<Resolution>
+    {
+        const string            m_filename;
+        const size_t            m_file_size;
+
+        OBJFixture()
+          : m_filename(Fixture<Resolution>::write_file("obj"))
+          , m_file_size(static_cast<size_t>(bf::file_size(m_filename)))
+        {
+        }
+
+        void read(const int options = OBJMeshFileReader::Default)
+        {
+            OBJMeshFileReader reader(m_filename.c_str(), options);
+            reader.read(Fixture<Resolution>::m_builder);
+        }
+    };
+
+    template <size_t Resolution>
+    struct BinaryMeshFixture
+      : public Fixture<Resolution>
+    {
+        const string            m_filename;
+        const size_t            m_file_size;
+
+        BinaryMeshFixture()
+          : m_filename(Fixture<Resolution>::write_file("binarymesh"))
+          , m_file_size(static_cast<size_t>(bf::file_size(m_filename)))
+        {
+        }
+
+        void read()
+        {
+            GenericMeshFileReader reader(m_filename.c_str());
+            reader.read(Fixture<Resolution>::m_builder);
+        }
+    };
+
+    // Small, medium and large grids: 2,048, 32,768 and 524,288 triangles.
+
+#define DEFINE_READ_BENCHMARK_CASES(Resolution, Count)                                          \
+    BENCHMARK_CASE_F(ReadOBJFile_##Count##Triangles, OBJFixture<Resolution>)                    \
+    {                                                                                           \
+        set_processed_bytes(m_file_size);                                                       \
+        set_processed_items(m_walker.get_face_count());                                         \
+        read();                                                                                 \
+    }                                                                                           \
+                                                                                                \
+    BENCHMARK_CASE_F(ReadOBJFileInParallel_##Count##Triangles, OBJFixture<Resolution>)          \
+    {                                                                                           \
+        set_processed_bytes(m_file_size);                                                       \
+        set_processed_items(m_walker.get_face_count());                                         \
+        read(OBJMeshFileReader::ParseInParallel);                                               \
+    }                                                                                           \
+                                                                                                \
+    BENCHMARK_CASE_F(ReadBinaryMeshFile_##Count##Triangles, BinaryMeshFixture<Resolution>)      \
+    {                                                                                           \
+        set_processed_bytes(m_file_size);                                                       \
+        set_processed_items(m_walker.get_face_count());                                         \
+        read();                                                                                 \
+    }
+
+    DEFINE_READ_BENCHMARK_CASES(32, 2K)
+    DEFINE_READ_BENCHMARK_CASES(128, 32K)
+    DEFINE_READ_BENCHMARK_CASES(512, 512K)
+
+#undef DEFINE_READ_BENCHMARK_CASES
+
+#ifdef APPLESEED_WITH_ALEMBIC
+
+    template <size_t Resolution>
+    struct AlembicFixture
+      : public Fixture<Resolution>
+    {
+        const string            m_filename;
+        const size_t            m_file_size;
+
+        AlembicFixture()
+          : m_filename(Fixture<Resolution>::write_file("abc"))
+          , m_file_size(static_cast<size_t>(bf::file_size(m_filename)))
+        {
+        }
+
+        void read()
+        {
+            GenericMeshFileReader reader(m_filename.c_str());
+            reader.read(Fixture<Resolution>::m_builder);
+        }
+    };
+
+#define DEFINE_READ_BENCHMARK_CASE(Resolution, Count)                                           \
+    BENCHMARK_CASE_F(ReadAlembicFile_##Count##Triangles, AlembicFixture<Resolution>)            \
+    {                                                                                           \
+        set_processed_bytes(m_file_size);                                                       \
+        set_processed_items(m_walker.get_face_count());                                         \
+        read();                                                                                 \
+    }
+
+    DEFINE_READ_BENCHMARK_CASE(32, 2K)
+    DEFINE_READ_BENCHMARK_CASE(128, 32K)
+    DEFINE_READ_BENCHMARK_CASE(512, 512K)
+
+#undef DEFINE_READ_BENCHMARK_CASE
+
+#endif
+}
@@ -31,6 +31,7 @@
 #include "foundation/platform/types.h"
 #include "foundation/utility/benchmark.h"
 #include "foundation/utility/poolallocator.h"
+#include "foundation/utility/threadcachingpoolallocator.h"
 
 // Standard headers.
 #include <cstddef>
@@ -79,12 +80,18 @@ BENCHMARK_SUITE(Foundation_Utility_PoolAllocator)
 
     typedef allocator<uint32> DefaultAllocator;
     typedef PoolAllocator<uint32, N> PoolAllocator;
+    typedef ThreadCachingPoolAllocator<uint32, N> ThreadCachingPoolAllocator;
 
     BENCHMARK_CASE_F(RepeatedAllocation_PoolAllocator, Fixture<PoolAllocator>)
     {
         m_allocator.allocate(1);
     }
 
+    BENCHMARK_CASE_F(RepeatedAllocation_ThreadCachingPoolAllocator, Fixture<ThreadCachingPoolAllocator>)
+    {
+        m_allocator.allocate(1);
+    }
+
     BENCHMARK_CASE_F(RepeatedAllocationDeallocation_DefaultAllocator, Fixture<DefaultAllocator>)
     {
         repeated_allocation_deallocation();
@@ -95,6 +102,11 @@ BENCHMARK_SUITE(Foundation_Utility_PoolAllocator)
         repeated_allocation_deallocation();
     }
 
+    BENCHMARK_CASE_F(RepeatedAllocationDeallocation_ThreadCachingPoolAllocator, Fixture<ThreadCachingPoolAllocator>)
+    {
+        repeated_allocation_deallocation();
+    }
+
     BENCHMARK_CASE_F(FirstAllocatedFirstDeallocatedBatch_DefaultAllocator, Fixture<DefaultAllocator>)
     {
         first_allocated_first_deallocated_batch();
@@ -105,6 +117,11 @@ BENCHMARK_SUITE(Foundation_Utility_PoolAllocator)
         first_allocated_first_deallocated_batch();
     }
 
+    BENCHMARK_CASE_F(FirstAllocatedFirstDeallocatedBatch_ThreadCachingPoolAllocator, Fixture<ThreadCachingPoolAllocator>)
+    {
+        first_allocated_first_deallocated_batch();
+    }
+
     BENCHMARK_CASE_F(FirstAllocatedLastDeallocatedBatch_DefaultAllocator, Fixture<DefaultAllocator>)
     {
         first_allocated_last_deallocated_batch();
@@ -114,4 +131,9 @@ BENCHMARK_SUITE(Foundation_Utility_PoolAllocator)
     {
         first_allocated_last_deallocated_batch();
     }
+
+    BENCHMARK_CASE_F(FirstAllocatedLastDeallocatedBatch_ThreadCachingPoolAllocator, Fixture<ThreadCachingPoolAllocator>)
+    {
+        first_allocated_last_deallocated_batch();
+    }
 }
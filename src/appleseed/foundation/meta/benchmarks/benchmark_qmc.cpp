@@ -256,6 +256,14 @@ BENCHMARK_SUITE(Foundation_Math_QMC)
             for (size_t i = 0; i < 64; ++i)
                 m_x += hammersley_sequence<T, 2>(Bases, 64, i);
         }
+
+        void owen_scrambled_sobol_payload()
+        {
+            m_x = Vector<T, 2>(0.0f);
+
+            for (size_t i = 0; i < 64; ++i)
+                m_x += owen_scrambled_sobol_sequence<T, 2>(0x1234567UL, static_cast<uint32>(i));
+        }
     };
 
     //
@@ -367,4 +375,18 @@ BENCHMARK_SUITE(Foundation_Math_QMC)
     {
         hammersley_payload();
     }
+
+    //
+    // Owen-scrambled Sobol sequence.
+    //
+
+    BENCHMARK_CASE_F(OwenScrambledSobolSequence_SinglePrecision, Vector2Fixture<float>)
+    {
+        owen_scrambled_sobol_payload();
+    }
+
+    BENCHMARK_CASE_F(OwenScrambledSobolSequence_DoublePrecision, Vector2Fixture<double>)
+    {
+        owen_scrambled_sobol_payload();
+    }
 }
@@ -57,6 +57,11 @@ BENCHMARK_SUITE(Foundation_Image_RegularSpectrum31f)
         m_spectrum1 += m_spectrum2;
     }
 
+    BENCHMARK_CASE_F(InPlaceSubtraction, Fixture)
+    {
+        m_spectrum1 -= m_spectrum2;
+    }
+
     BENCHMARK_CASE_F(InPlaceMultiplicationByScalar, Fixture)
     {
         m_spectrum1 *= 1.1f;
@@ -30,6 +30,7 @@
 // appleseed.foundation headers.
 #include "foundation/math/rng/distribution.h"
 #include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sparsevoxelgrid.h"
 #include "foundation/math/vector.h"
 #include "foundation/math/voxelgrid.h"
 #include "foundation/platform/compiler.h"
@@ -48,12 +49,14 @@ BENCHMARK_SUITE(Foundation_Math_VoxelGrid3)
         static const size_t ChannelCount = 4;
         static const size_t LookupPointCount = 64;
 
-        VoxelGrid3<float, double>   m_grid;
-        Vector3d                    m_lookup_points[LookupPointCount];
-        float                       m_accumulated_values[ChannelCount];
+        VoxelGrid3<float, double>       m_grid;
+        SparseVoxelGrid3<float, double> m_sparse_grid;
+        Vector3d                        m_lookup_points[LookupPointCount];
+        float                           m_accumulated_values[ChannelCount];
 
         Fixture()
           : m_grid(32, 32, 32, ChannelCount)
+          , m_sparse_grid(32, 32, 32, ChannelCount)
         {
             MersenneTwister rng;
 
@@ -65,7 +68,12 @@ BENCHMARK_SUITE(Foundation_Math_VoxelGrid3)
                     {
                         for (size_t c = 0; c < m_grid.get_channel_count(); ++c)
                         {
-                            m_grid.voxel(x, y, z)[c] = rand_float1(rng);
+                            const float value = rand_float1(rng);
+                            m_grid.voxel(x, y, z)[c] = value;
+
+                            // Only fill the lower half of the sparse grid.
+                            if (z < m_grid.get_zres() / 2)
+                                m_sparse_grid.voxel(x, y, z)[c] = value;
                         }
                     }
                 }
@@ -74,9 +82,9 @@ BENCHMARK_SUITE(Foundation_Math_VoxelGrid3)
             for (size_t i = 0; i < LookupPointCount; ++i)
             {
                 Vector3d& p = m_lookup_points[i];
-                p[0] = rand_double1(rng, 0.0, static_cast<double>(m_grid.get_xres()));
-                p[1] = rand_double1(rng, 0.0, static_cast<double>(m_grid.get_yres()));
-                p[2] = rand_double1(rng, 0.0, static_cast<double>(m_grid.get_zres()));
+                p[0] = rand_double1(rng);
+                p[1] = rand_double1(rng);
+                p[2] = rand_double1(rng);
             }
 
             for (size_t i = 0; i < ChannelCount; ++i)
@@ -119,4 +127,28 @@ BENCHMARK_SUITE(Foundation_Math_VoxelGrid3)
                 m_accumulated_values[j] += values[j];
         }
     }
+
+    BENCHMARK_CASE_F(SparseNearestLookup, Fixture)
+    {
+        for (size_t i = 0; i < LookupPointCount; ++i)
+        {
+            APPLESEED_SIMD4_ALIGN float values[ChannelCount];
+            m_sparse_grid.nearest_lookup(m_lookup_points[i], values);
+
+            for (size_t j = 0; j < ChannelCount; ++j)
+                m_accumulated_values[j] += values[j];
+        }
+    }
+
+    BENCHMARK_CASE_F(SparseLinearLookup, Fixture)
+    {
+        for (size_t i = 0; i < LookupPointCount; ++i)
+        {
+            APPLESEED_SIMD4_ALIGN float values[ChannelCount];
+            m_sparse_grid.linear_lookup(m_lookup_points[i], values);
+
+            for (size_t j = 0; j < ChannelCount; ++j)
+                m_accumulated_values[j] += values[j];
+        }
+    }
 }
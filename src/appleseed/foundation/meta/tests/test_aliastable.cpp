@@ -0,0 +1,143 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/aliastable.h"
+#include "foundation/math/fp.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <sstream>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_AliasTable)
+{
+    typedef foundation::AliasTable<int, double> AliasTable;
+
+    TEST_CASE(Empty_GivenTableInInitialState_ReturnsTrue)
+    {
+        AliasTable table;
+
+        EXPECT_TRUE(table.empty());
+    }
+
+    TEST_CASE(Valid_GivenTableWithOneItemWithZeroWeight_ReturnsFalse)
+    {
+        AliasTable table;
+        table.insert(1, 0.0);
+
+        EXPECT_FALSE(table.valid());
+    }
+
+    TEST_CASE(Sample_GivenTableWithOneItemWithPositiveWeight_ReturnsItem)
+    {
+        AliasTable table;
+        table.insert(1, 0.5);
+        table.prepare();
+
+        const AliasTable::ItemWeightPair result = table.sample(0.5);
+
+        EXPECT_EQ(1, result.first);
+        EXPECT_FEQ(1.0, result.second);
+    }
+
+    TEST_CASE(Sample_GivenInputOneUlpBeforeOne_ReturnsItemWithPositiveWeight)
+    {
+        AliasTable table;
+        table.insert(1, 0.4);
+        table.insert(2, 1.6);
+        table.insert(3, 0.0);
+        table.prepare();
+
+        const double almost_one = shift(1.0, -1);
+        const AliasTable::ItemWeightPair result = table.sample(almost_one);
+
+        EXPECT_NEQ(3, result.first);
+    }
+
+    TEST_CASE(Sample_GivenUniformInputs_ReturnsItemsProportionallyToTheirWeights)
+    {
+        static const double Weights[] = { 0.0, 1.0, 2.0, 0.0, 4.0, 0.5, 0.5 };
+        const size_t ItemCount = sizeof(Weights) / sizeof(Weights[0]);
+        const size_t SampleCount = 8000;
+
+        AliasTable table;
+        for (size_t i = 0; i < ItemCount; ++i)
+            table.insert(static_cast<int>(i), Weights[i]);
+        table.prepare();
+
+        vector<size_t> counts(ItemCount, 0);
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const double x = (i + 0.5) / SampleCount;
+            ++counts[table.sample(x).first];
+        }
+
+        // Stratified inputs map to exact proportions.
+        for (size_t i = 0; i < ItemCount; ++i)
+            EXPECT_EQ(static_cast<size_t>(Weights[i] / 8.0 * SampleCount), counts[i]);
+    }
+
+    TEST_CASE(Sample_ReturnsNormalizedWeight)
+    {
+        AliasTable table;
+        table.insert(1, 0.4);
+        table.insert(2, 1.6);
+        table.prepare();
+
+        EXPECT_FEQ(0.2, table[0].second);
+        EXPECT_FEQ(0.8, table[1].second);
+        EXPECT_FEQ(0.8, table.sample(0.9).second);
+    }
+
+    TEST_CASE(WriteAndRead_PreservesSampling)
+    {
+        AliasTable table;
+        table.insert(1, 0.3);
+        table.insert(2, 0.1);
+        table.insert(3, 0.6);
+        table.prepare();
+
+        stringstream stream;
+        table.write(stream);
+
+        AliasTable read_table;
+        ASSERT_TRUE(read_table.read(stream));
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const double x = i / 100.0;
+            EXPECT_EQ(table.sample(x).first, read_table.sample(x).first);
+        }
+    }
+}
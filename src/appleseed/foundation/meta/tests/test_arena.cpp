@@ -0,0 +1,141 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/arena.h"
+#include "foundation/utility/memory.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstring>
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Utility_Arena)
+{
+    TEST_CASE(Allocate_ReturnsAlignedMemory)
+    {
+        Arena arena;
+
+        void* p1 = arena.allocate(3);
+        void* p2 = arena.allocate(5);
+
+        EXPECT_TRUE(is_aligned(p1, 16));
+        EXPECT_TRUE(is_aligned(p2, 16));
+        EXPECT_NEQ(p1, p2);
+    }
+
+    TEST_CASE(Allocate_GivenRequestsExceedingCapacity_ReturnsUsableMemory)
+    {
+        Arena arena;
+        const size_t capacity = arena.get_capacity();
+
+        void* p1 = arena.allocate(capacity / 2);
+        void* p2 = arena.allocate(capacity);
+
+        std::memset(p1, 0xAB, capacity / 2);
+        std::memset(p2, 0xCD, capacity);
+
+        EXPECT_TRUE(is_aligned(p2, 16));
+        EXPECT_EQ(0xAB, static_cast<unsigned char*>(p1)[0]);
+        EXPECT_EQ(0xCD, static_cast<unsigned char*>(p2)[capacity - 1]);
+    }
+
+    TEST_CASE(Clear_TracksHighWaterMark)
+    {
+        Arena arena;
+
+        arena.allocate(1024);
+        arena.clear();
+        arena.allocate(256);
+        arena.clear();
+
+        EXPECT_EQ(1024, arena.get_high_water_mark());
+    }
+
+    TEST_CASE(Clear_AfterOverflow_GrowsArena)
+    {
+        Arena arena;
+        const size_t initial_capacity = arena.get_capacity();
+
+        arena.allocate(initial_capacity / 2);
+        arena.allocate(initial_capacity);
+        arena.clear();
+
+        EXPECT_GT(initial_capacity, arena.get_capacity());
+        EXPECT_TRUE(arena.get_high_water_mark() <= arena.get_capacity());
+    }
+
+    TEST_CASE(Release_ReusesMemoryAllocatedAfterMark)
+    {
+        Arena arena;
+
+        arena.allocate(64);
+        const Arena::Mark mark = arena.mark();
+
+        void* p1 = arena.allocate(128);
+        arena.release(mark);
+        void* p2 = arena.allocate(128);
+
+        EXPECT_EQ(p1, p2);
+    }
+
+    TEST_CASE(Release_PreservesMemoryAllocatedBeforeMark)
+    {
+        Arena arena;
+
+        unsigned char* p = static_cast<unsigned char*>(arena.allocate(16));
+        std::memset(p, 0xAB, 16);
+
+        {
+            ArenaScope scope(arena);
+            std::memset(arena.allocate(16), 0xCD, 16);
+        }
+
+        EXPECT_EQ(0xAB, p[15]);
+        EXPECT_NEQ(static_cast<void*>(p), arena.allocate(16));
+    }
+
+    TEST_CASE(Release_AfterOverflow_TracksHighWaterMark)
+    {
+        Arena arena;
+        const size_t capacity = arena.get_capacity();
+
+        const Arena::Mark mark = arena.mark();
+        arena.allocate(capacity / 2);
+        arena.allocate(capacity);
+        arena.release(mark);
+
+        EXPECT_EQ(capacity / 2 + capacity, arena.get_high_water_mark());
+
+        arena.clear();
+
+        EXPECT_GT(capacity, arena.get_capacity());
+    }
+}
@@ -0,0 +1,107 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.foundation headers.
+#include "foundation/utility/log/asynclogtarget.h"
+#include "foundation/utility/log/logmessage.h"
+#include "foundation/utility/log/stringlogtarget.h"
+#include "foundation/utility/string.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Utility_Log_AsyncLogTarget)
+{
+    struct Fixture
+    {
+        StringLogTarget         m_string_target;
+
+        void write(
+            AsyncLogTarget&             target,
+            const LogMessage::Category  category,
+            const char*                 message)
+        {
+            target.write(category, __FILE__, __LINE__, "", message);
+        }
+    };
+
+    TEST_CASE_F(Flush_ForwardsMessagesInOrder, Fixture)
+    {
+        AsyncLogTarget target(m_string_target);
+
+        write(target, LogMessage::Info, "first");
+        write(target, LogMessage::Warning, "second");
+        target.flush();
+
+        EXPECT_EQ("first\nsecond\n", string(m_string_target.get_string()));
+    }
+
+    TEST_CASE_F(Destructor_ForwardsPendingMessages, Fixture)
+    {
+        {
+            AsyncLogTarget target(m_string_target);
+            write(target, LogMessage::Info, "message");
+        }
+
+        EXPECT_EQ("message\n", string(m_string_target.get_string()));
+    }
+
+    TEST_CASE_F(Write_GivenConsecutiveIdenticalMessages_CollapsesThem, Fixture)
+    {
+        AsyncLogTarget target(m_string_target);
+
+        for (size_t i = 0; i < 5; ++i)
+            write(target, LogMessage::Warning, "self-intersection");
+        write(target, LogMessage::Warning, "other");
+        target.flush();
+
+        EXPECT_EQ(
+            "self-intersection\n(previous message repeated 4 times)\nother\n",
+            string(m_string_target.get_string()));
+    }
+
+    TEST_CASE_F(Write_GivenTooManyMessages_SuppressesMessagesBelowErrors, Fixture)
+    {
+        AsyncLogTarget target(m_string_target, 64, 2);
+
+        for (size_t i = 0; i < 5; ++i)
+            write(target, LogMessage::Warning, ("warning " + to_string(i)).c_str());
+        write(target, LogMessage::Error, "error");
+        target.flush();
+
+        EXPECT_EQ(
+            "warning 0\nwarning 1\nerror\n(3 messages suppressed, more than 2 messages per second)\n",
+            string(m_string_target.get_string()));
+    }
+}
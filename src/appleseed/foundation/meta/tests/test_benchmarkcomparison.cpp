@@ -0,0 +1,136 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.foundation headers.
+#include "foundation/utility/benchmark/benchmarkaggregator.h"
+#include "foundation/utility/benchmark/benchmarkcomparison.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Utility_Benchmark_BenchmarkComparison)
+{
+    struct Fixture
+    {
+        BenchmarkAggregator     m_baseline;
+        BenchmarkAggregator     m_candidate;
+
+        Fixture()
+        {
+            m_baseline.scan_directory("unit tests/inputs/test_benchmarkcomparison/baseline/");
+            m_candidate.scan_directory("unit tests/inputs/test_benchmarkcomparison/candidate/");
+        }
+
+        static const BenchmarkComparison::CaseComparison* find_case(
+            const BenchmarkComparison&  comparison,
+            const char*                 name)
+        {
+            for (size_t i = 0; i < comparison.get_case_count(); ++i)
+            {
+                if (strcmp(comparison.get_case(i).m_name, name) == 0)
+                    return &comparison.get_case(i);
+            }
+
+            return 0;
+        }
+    };
+
+    TEST_CASE_F(Constructor_IgnoresCasesMissingFromCandidate, Fixture)
+    {
+        const BenchmarkComparison comparison(m_baseline, m_candidate);
+
+        EXPECT_EQ(3, comparison.get_case_count());
+        EXPECT_EQ(0, find_case(comparison, "Release/Suite/Removed"));
+    }
+
+    TEST_CASE_F(Constructor_GivenSignificantSlowdown_ReportsRegression, Fixture)
+    {
+        const BenchmarkComparison comparison(m_baseline, m_candidate);
+
+        const BenchmarkComparison::CaseComparison* c = find_case(comparison, "Release/Suite/Regressed");
+
+        ASSERT_NEQ(0, c);
+        EXPECT_FEQ(1.0, c->m_baseline_time);
+        EXPECT_FEQ(1.2, c->m_candidate_time);
+        EXPECT_FEQ(0.2, c->m_delta);
+        EXPECT_LT(c->m_delta, c->m_delta_low);
+        EXPECT_GT(c->m_delta, c->m_delta_high);
+        EXPECT_EQ(BenchmarkComparison::Regression, c->m_verdict);
+    }
+
+    TEST_CASE_F(Constructor_GivenSlowdownWithinNoise_ReportsUnchanged, Fixture)
+    {
+        const BenchmarkComparison comparison(m_baseline, m_candidate);
+
+        const BenchmarkComparison::CaseComparison* c = find_case(comparison, "Release/Suite/Noisy");
+
+        ASSERT_NEQ(0, c);
+        EXPECT_FEQ(0.2, c->m_delta);
+        EXPECT_LT(0.0, c->m_delta_low);
+        EXPECT_EQ(BenchmarkComparison::Unchanged, c->m_verdict);
+    }
+
+    TEST_CASE_F(Constructor_GivenDifferentTimerFrequencies_ComparesSeconds, Fixture)
+    {
+        const BenchmarkComparison comparison(m_baseline, m_candidate);
+
+        const BenchmarkComparison::CaseComparison* c = find_case(comparison, "Release/Suite/Improved");
+
+        ASSERT_NEQ(0, c);
+        EXPECT_FEQ(-0.5, c->m_delta);
+        EXPECT_EQ(BenchmarkComparison::Improvement, c->m_verdict);
+    }
+
+    TEST_CASE_F(WriteReport_GivenRegression_ReportsFailure, Fixture)
+    {
+        const BenchmarkComparison comparison(m_baseline, m_candidate);
+
+        stringstream sstr;
+        comparison.write_report(sstr);
+
+        EXPECT_EQ(1, comparison.get_regression_count());
+        EXPECT_FALSE(comparison.passed());
+        EXPECT_NEQ(string::npos, sstr.str().find("FAILED: 1 regression in 3 benchmark cases"));
+    }
+
+    TEST_CASE_F(Constructor_GivenLargeTolerance_ReportsNoRegression, Fixture)
+    {
+        const BenchmarkComparison comparison(m_baseline, m_candidate, 0.5);
+
+        EXPECT_TRUE(comparison.passed());
+    }
+}
@@ -31,6 +31,7 @@
 #include "foundation/image/genericimagefilewriter.h"
 #include "foundation/image/image.h"
 #include "foundation/image/pixel.h"
+#include "foundation/math/aabb.h"
 #include "foundation/math/beziercurve.h"
 #include "foundation/math/matrix.h"
 #include "foundation/math/ray.h"
@@ -40,6 +41,7 @@
 #include "foundation/utility/test.h"
 
 // Standard headers.
+#include <cmath>
 #include <cstddef>
 #include <limits>
 #include <vector>
@@ -515,3 +517,108 @@ TEST_SUITE(Foundation_Math_BezierCurveIntersector)
         render_curves_to_image(Curves, countof(Curves), "unit tests/outputs/test_beziercurveintersector_bezier3curve_checkboard.png", true);
     }
 }
+
+TEST_SUITE(Foundation_Math_BezierCurveBatch4)
+{
+    template <typename BezierCurveType>
+    size_t compute_reference_mask(
+        const BezierCurveType   curves[],
+        const size_t            count,
+        const Matrix4f&         xfm,
+        const float             max_z)
+    {
+        size_t mask = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const BezierCurveType xfm_curve(curves[i], xfm);
+            const AABB3f bbox = xfm_curve.compute_bbox();
+            const float half_max_width = 0.5f * xfm_curve.compute_max_width();
+
+            if (!(bbox.min.z > max_z          || bbox.max.z < 1.0e-6f         ||
+                  bbox.min.x > half_max_width || bbox.max.x < -half_max_width ||
+                  bbox.min.y > half_max_width || bbox.max.y < -half_max_width))
+                mask |= size_t(1) << i;
+        }
+
+        return mask;
+    }
+
+    struct Fixture
+    {
+        BezierCurve3f   m_curves[4];
+
+        Fixture()
+        {
+            for (size_t i = 0; i < 4; ++i)
+            {
+                const float x = -0.6f + 0.4f * i;
+                const Vector3f ControlPoints[] =
+                {
+                    Vector3f(x, -0.5f, 0.0f),
+                    Vector3f(x + 0.1f, -0.2f, 0.0f),
+                    Vector3f(x - 0.1f, 0.2f, 0.0f),
+                    Vector3f(x, 0.5f, 0.0f)
+                };
+                m_curves[i] = BezierCurve3f(ControlPoints, 0.05f);
+            }
+        }
+    };
+
+    TEST_CASE_F(ComputeOverlapMask_RayThroughSecondCurve_ReturnsOnlySecondCurve, Fixture)
+    {
+        const BezierCurveBatch4<BezierCurve3f> batch(m_curves, 4);
+
+        const Ray3f ray(Vector3f(-0.2f, 0.0f, -3.0f), Vector3f(0.0f, 0.0f, 1.0f));
+        Matrix4f xfm_matrix;
+        make_curve_projection_transform(xfm_matrix, ray);
+
+        EXPECT_EQ(2, batch.compute_overlap_mask(xfm_matrix, numeric_limits<float>::max()));
+    }
+
+    TEST_CASE_F(ComputeOverlapMask_CurvesBeyondMaxDistance_ReturnsZero, Fixture)
+    {
+        const BezierCurveBatch4<BezierCurve3f> batch(m_curves, 4);
+
+        const Ray3f ray(Vector3f(-0.2f, 0.0f, -3.0f), Vector3f(0.0f, 0.0f, 1.0f));
+        Matrix4f xfm_matrix;
+        make_curve_projection_transform(xfm_matrix, ray);
+
+        EXPECT_EQ(0, batch.compute_overlap_mask(xfm_matrix, 2.0f));
+    }
+
+    TEST_CASE_F(ComputeOverlapMask_PartialBatch_IgnoresUnusedSlots, Fixture)
+    {
+        const BezierCurveBatch4<BezierCurve3f> batch(m_curves, 2);
+
+        // This ray only goes through the last curve, which is not part of the batch.
+        const Ray3f ray(Vector3f(0.6f, 0.0f, -3.0f), Vector3f(0.0f, 0.0f, 1.0f));
+        Matrix4f xfm_matrix;
+        make_curve_projection_transform(xfm_matrix, ray);
+
+        EXPECT_EQ(2, batch.get_curve_count());
+        EXPECT_EQ(0, batch.compute_overlap_mask(xfm_matrix, numeric_limits<float>::max()));
+    }
+
+    TEST_CASE_F(ComputeOverlapMask_MatchesPerCurveBoundingBoxTest, Fixture)
+    {
+        const BezierCurveBatch4<BezierCurve3f> batch(m_curves, 4);
+
+        for (size_t i = 0; i < 64; ++i)
+        {
+            const float angle = 0.1f * i;
+            const Vector3f org(2.0f * cos(angle), 2.0f * sin(angle), -3.0f + 0.1f * i);
+            const Vector3f target(-0.6f + 0.02f * i, 0.0f, 0.0f);
+            const Ray3f ray(org, target - org);
+
+            Matrix4f xfm_matrix;
+            make_curve_projection_transform(xfm_matrix, ray);
+
+            const float max_z = 0.1f * i;
+
+            EXPECT_EQ(
+                compute_reference_mask(m_curves, 4, xfm_matrix, max_z),
+                batch.compute_overlap_mask(xfm_matrix, max_z));
+        }
+    }
+}
@@ -0,0 +1,348 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfilereader.h"
+#include "foundation/mesh/binarymeshfilewriter.h"
+#include "foundation/mesh/imeshwalker.h"
+#include "foundation/mesh/meshbuilderbase.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Mesh_BinaryMeshFileWriter)
+{
+    struct Face
+    {
+        vector<size_t>      m_vertices;
+        vector<size_t>      m_vertex_normals;
+        vector<size_t>      m_tex_coords;
+        size_t              m_material;
+    };
+
+    struct Mesh
+    {
+        string              m_name;
+        vector<Vector3d>    m_vertices;
+        vector<Vector3d>    m_vertex_normals;
+        vector<Vector2d>    m_tex_coords;
+        vector<string>      m_material_slots;
+        vector<Face>        m_faces;
+    };
+
+    struct MeshBuilder
+      : public MeshBuilderBase
+    {
+        vector<Mesh> m_meshes;
+
+        virtual void begin_mesh(const char* name) APPLESEED_OVERRIDE
+        {
+            m_meshes.push_back(Mesh());
+            m_meshes.back().m_name = name;
+        }
+
+        virtual size_t push_vertex(const Vector3d& v) APPLESEED_OVERRIDE
+        {
+            m_meshes.back().m_vertices.push_back(v);
+            return m_meshes.back().m_vertices.size() - 1;
+        }
+
+        virtual size_t push_vertex_normal(const Vector3d& v) APPLESEED_OVERRIDE
+        {
+            m_meshes.back().m_vertex_normals.push_back(v);
+            return m_meshes.back().m_vertex_normals.size() - 1;
+        }
+
+        virtual size_t push_tex_coords(const Vector2d& v) APPLESEED_OVERRIDE
+        {
+            m_meshes.back().m_tex_coords.push_back(v);
+            return m_meshes.back().m_tex_coords.size() - 1;
+        }
+
+        virtual size_t push_material_slot(const char* name) APPLESEED_OVERRIDE
+        {
+            m_meshes.back().m_material_slots.push_back(name);
+            return m_meshes.back().m_material_slots.size() - 1;
+        }
+
+        virtual void begin_face(const size_t vertex_count) APPLESEED_OVERRIDE
+        {
+            m_meshes.back().m_faces.push_back(Face());
+            m_meshes.back().m_faces.back().m_vertices.resize(vertex_count);
+            m_meshes.back().m_faces.back().m_vertex_normals.resize(vertex_count);
+            m_meshes.back().m_faces.back().m_tex_coords.resize(vertex_count);
+        }
+
+        virtual void set_face_vertices(const size_t vertices[]) APPLESEED_OVERRIDE
+        {
+            Face& face = m_meshes.back().m_faces.back();
+            for (size_t i = 0; i < face.m_vertices.size(); ++i)
+                face.m_vertices[i] = vertices[i];
+        }
+
+        virtual void set_face_vertex_normals(const size_t vertex_normals[]) APPLESEED_OVERRIDE
+        {
+            Face& face = m_meshes.back().m_faces.back();
+            for (size_t i = 0; i < face.m_vertex_normals.size(); ++i)
+                face.m_vertex_normals[i] = vertex_normals[i];
+        }
+
+        virtual void set_face_vertex_tex_coords(const size_t tex_coords[]) APPLESEED_OVERRIDE
+        {
+            Face& face = m_meshes.back().m_faces.back();
+            for (size_t i = 0; i < face.m_tex_coords.size(); ++i)
+                face.m_tex_coords[i] = tex_coords[i];
+        }
+
+        virtual void set_face_material(const size_t material) APPLESEED_OVERRIDE
+        {
+            m_meshes.back().m_faces.back().m_material = material;
+        }
+    };
+
+    struct MeshWalker
+      : public IMeshWalker
+    {
+        const Mesh& m_mesh;
+
+        explicit MeshWalker(const Mesh& mesh)
+          : m_mesh(mesh)
+        {
+        }
+
+        virtual const char* get_name() const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_name.c_str();
+        }
+
+        virtual size_t get_vertex_count() const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_vertices.size();
+        }
+
+        virtual Vector3d get_vertex(const size_t i) const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_vertices[i];
+        }
+
+        virtual size_t get_vertex_normal_count() const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_vertex_normals.size();
+        }
+
+        virtual Vector3d get_vertex_normal(const size_t i) const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_vertex_normals[i];
+        }
+
+        virtual size_t get_tex_coords_count() const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_tex_coords.size();
+        }
+
+        virtual Vector2d get_tex_coords(const size_t i) const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_tex_coords[i];
+        }
+
+        virtual size_t get_material_slot_count() const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_material_slots.size();
+        }
+
+        virtual const char* get_material_slot(const size_t i) const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_material_slots[i].c_str();
+        }
+
+        virtual size_t get_face_count() const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_faces.size();
+        }
+
+        virtual size_t get_face_vertex_count(const size_t face_index) const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_faces[face_index].m_vertices.size();
+        }
+
+        virtual size_t get_face_vertex(const size_t face_index, const size_t vertex_index) const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_faces[face_index].m_vertices[vertex_index];
+        }
+
+        virtual size_t get_face_vertex_normal(const size_t face_index, const size_t vertex_index) const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_faces[face_index].m_vertex_normals[vertex_index];
+        }
+
+        virtual size_t get_face_tex_coords(const size_t face_index, const size_t vertex_index) const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_faces[face_index].m_tex_coords[vertex_index];
+        }
+
+        virtual size_t get_face_material(const size_t face_index) const APPLESEED_OVERRIDE
+        {
+            return m_mesh.m_faces[face_index].m_material;
+        }
+    };
+
+    // Create a grid of size x size quads, optionally split into triangles.
+    Mesh create_grid_mesh(const string& name, const size_t size, const bool triangles)
+    {
+        Mesh mesh;
+        mesh.m_name = name;
+        mesh.m_material_slots.push_back("front");
+        mesh.m_material_slots.push_back("back");
+        mesh.m_vertex_normals.push_back(Vector3d(0.0, 1.0, 0.0));
+
+        for (size_t y = 0; y <= size; ++y)
+        {
+            for (size_t x = 0; x <= size; ++x)
+            {
+                mesh.m_vertices.push_back(Vector3d(static_cast<double>(x), 0.0, static_cast<double>(y)));
+                mesh.m_tex_coords.push_back(Vector2d(static_cast<double>(x) / size, static_cast<double>(y) / size));
+            }
+        }
+
+        for (size_t y = 0; y < size; ++y)
+        {
+            for (size_t x = 0; x < size; ++x)
+            {
+                const size_t v0 = y * (size + 1) + x;
+                const size_t quad[4] = { v0, v0 + 1, v0 + size + 2, v0 + size + 1 };
+
+                if (triangles)
+                {
+                    const size_t corners[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+
+                    for (size_t i = 0; i < 2; ++i)
+                    {
+                        Face face;
+                        for (size_t j = 0; j < 3; ++j)
+                        {
+                            face.m_vertices.push_back(quad[corners[i][j]]);
+                            face.m_vertex_normals.push_back(0);
+                            face.m_tex_coords.push_back(quad[corners[i][j]]);
+                        }
+                        face.m_material = i;
+                        mesh.m_faces.push_back(face);
+                    }
+                }
+                else
+                {
+                    Face face;
+                    for (size_t j = 0; j < 4; ++j)
+                    {
+                        face.m_vertices.push_back(quad[j]);
+                        face.m_vertex_normals.push_back(0);
+                        face.m_tex_coords.push_back(quad[j]);
+                    }
+                    face.m_material = (x + y) % 2;
+                    mesh.m_faces.push_back(face);
+                }
+            }
+        }
+
+        return mesh;
+    }
+
+    bool are_equal(const Mesh& lhs, const Mesh& rhs)
+    {
+        if (lhs.m_name != rhs.m_name ||
+            lhs.m_vertices != rhs.m_vertices ||
+            lhs.m_vertex_normals != rhs.m_vertex_normals ||
+            lhs.m_tex_coords != rhs.m_tex_coords ||
+            lhs.m_material_slots != rhs.m_material_slots ||
+            lhs.m_faces.size() != rhs.m_faces.size())
+            return false;
+
+        for (size_t i = 0; i < lhs.m_faces.size(); ++i)
+        {
+            const Face& lhs_face = lhs.m_faces[i];
+            const Face& rhs_face = rhs.m_faces[i];
+
+            if (lhs_face.m_vertices != rhs_face.m_vertices ||
+                lhs_face.m_vertex_normals != rhs_face.m_vertex_normals ||
+                lhs_face.m_tex_coords != rhs_face.m_tex_coords ||
+                lhs_face.m_material != rhs_face.m_material)
+                return false;
+        }
+
+        return true;
+    }
+
+    TEST_CASE(WriteTriangleAndQuadMeshesToFile)
+    {
+        const Mesh mesh1 = create_grid_mesh("triangles", 4, true);
+        const Mesh mesh2 = create_grid_mesh("quads", 4, false);
+
+        {
+            BinaryMeshFileWriter writer("unit tests/outputs/test_binarymeshfilewriter_twoobjects.binarymesh");
+            MeshWalker walker1(mesh1);
+            writer.write(walker1);
+            MeshWalker walker2(mesh2);
+            writer.write(walker2);
+        }
+
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfilewriter_twoobjects.binarymesh");
+        MeshBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(2, builder.m_meshes.size());
+        EXPECT_TRUE(are_equal(mesh1, builder.m_meshes[0]));
+        EXPECT_TRUE(are_equal(mesh2, builder.m_meshes[1]));
+    }
+
+    TEST_CASE(WriteMeshSpanningMultipleChunksToFile)
+    {
+        // About 1.5 MB of vertex data, more than a single chunk holds.
+        const Mesh mesh = create_grid_mesh("grid", 250, true);
+
+        {
+            BinaryMeshFileWriter writer("unit tests/outputs/test_binarymeshfilewriter_largeobject.binarymesh");
+            MeshWalker walker(mesh);
+            writer.write(walker);
+        }
+
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfilewriter_largeobject.binarymesh");
+        MeshBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(1, builder.m_meshes.size());
+        EXPECT_TRUE(are_equal(mesh, builder.m_meshes[0]));
+    }
+}
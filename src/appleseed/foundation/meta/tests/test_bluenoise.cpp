@@ -0,0 +1,118 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/bluenoise.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_BlueNoise)
+{
+    const size_t MaskPixelCount = BlueNoiseMaskSize * BlueNoiseMaskSize;
+
+    TEST_CASE(BlueNoiseMask_IsPermutationOfRanks)
+    {
+        vector<bool> seen(MaskPixelCount, false);
+
+        for (size_t i = 0; i < MaskPixelCount; ++i)
+        {
+            ASSERT_TRUE(BlueNoiseMask[i] < MaskPixelCount);
+            EXPECT_FALSE(seen[BlueNoiseMask[i]]);
+            seen[BlueNoiseMask[i]] = true;
+        }
+    }
+
+    TEST_CASE(BlueNoiseMask_LowRankPixelsAreNotAdjacent)
+    {
+        // The first 10% of the pixels form a point set with no two horizontally or vertically adjacent pixels.
+        const size_t Threshold = MaskPixelCount / 10;
+        size_t adjacent_pairs = 0;
+
+        for (size_t y = 0; y < BlueNoiseMaskSize; ++y)
+        {
+            for (size_t x = 0; x < BlueNoiseMaskSize; ++x)
+            {
+                const size_t right = y * BlueNoiseMaskSize + (x + 1) % BlueNoiseMaskSize;
+                const size_t below = ((y + 1) % BlueNoiseMaskSize) * BlueNoiseMaskSize + x;
+
+                if (BlueNoiseMask[y * BlueNoiseMaskSize + x] < Threshold)
+                {
+                    if (BlueNoiseMask[right] < Threshold)
+                        ++adjacent_pairs;
+                    if (BlueNoiseMask[below] < Threshold)
+                        ++adjacent_pairs;
+                }
+            }
+        }
+
+        EXPECT_EQ(0, adjacent_pairs);
+    }
+
+    TEST_CASE(BlueNoiseDither_ReturnsValuesInUnitInterval)
+    {
+        for (size_t d = 0; d < 8; ++d)
+        {
+            for (size_t y = 0; y < BlueNoiseMaskSize; ++y)
+            {
+                for (size_t x = 0; x < BlueNoiseMaskSize; ++x)
+                {
+                    const float value = blue_noise_dither<float>(x, y, d);
+
+                    EXPECT_TRUE(value >= 0.0f && value < 1.0f);
+                }
+            }
+        }
+    }
+
+    TEST_CASE(BlueNoiseDither_IsTileable)
+    {
+        EXPECT_EQ(
+            blue_noise_dither<double>(3, 5, 2),
+            blue_noise_dither<double>(3 + BlueNoiseMaskSize, 5 + 2 * BlueNoiseMaskSize, 2));
+    }
+
+    TEST_CASE(BlueNoiseDither_DistinctDimensionsReadDistinctValues)
+    {
+        size_t equal_values = 0;
+
+        for (size_t x = 0; x < BlueNoiseMaskSize; ++x)
+        {
+            if (blue_noise_dither<double>(x, 0, 0) == blue_noise_dither<double>(x, 0, 1))
+                ++equal_values;
+        }
+
+        EXPECT_EQ(0, equal_values);
+    }
+}
@@ -30,13 +30,22 @@
 // appleseed.foundation headers.
 #include "foundation/math/aabb.h"
 #include "foundation/math/bvh.h"
+#include "foundation/math/bvh/bvh_wideintersector.h"
+#include "foundation/math/bvh/bvh_widenode.h"
+#include "foundation/math/bvh/bvh_widetree.h"
+#include "foundation/math/intersection/rayaabb.h"
 #include "foundation/math/ray.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/timers.h"
 #include "foundation/utility/alignedvector.h"
 #include "foundation/utility/iostreamop.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cstddef>
 #include <vector>
 
@@ -148,3 +157,578 @@ TEST_SUITE(Foundation_Math_BVH_Intersector_2D)
         > intersector;
     }
 }
+
+TEST_SUITE(Foundation_Math_BVH_WideNode)
+{
+    TEST_CASE(TestStorageAndRetrievalOfChildBoundingBoxes)
+    {
+        static const AABB3d BBox0(Vector3d(1.0, 2.0, 3.0), Vector3d(4.0, 5.0, 6.0));
+        static const AABB3d BBox3(Vector3d(7.0, 8.0, 9.0), Vector3d(10.0, 11.0, 12.0));
+
+        bvh::WideNode<AABB3d, 4> node;
+
+        node.set_child_bbox(0, BBox0);
+        node.set_child_bbox(3, BBox3);
+
+        EXPECT_EQ(BBox0, node.get_child_bbox(0));
+        EXPECT_EQ(BBox3, node.get_child_bbox(3));
+    }
+
+    TEST_CASE(TestStorageAndRetrievalOfChildReferences)
+    {
+        bvh::WideNode<AABB3d, 4> node;
+
+        node.set_interior_child(0, 12);
+        node.set_leaf_child(1, 34);
+
+        EXPECT_FALSE(node.is_leaf_child(0));
+        EXPECT_EQ(12, node.get_child_index(0));
+        EXPECT_TRUE(node.is_leaf_child(1));
+        EXPECT_EQ(34, node.get_child_index(1));
+    }
+}
+
+TEST_SUITE(Foundation_Math_BVH_WideIntersector)
+{
+    typedef bvh::Node<AABB3d> NodeType;
+    typedef bvh::WideNode<AABB3d, 4> WideNodeType;
+    typedef bvh::WideTree<AlignedVector<NodeType>, AlignedVector<WideNodeType> > Tree;
+    typedef vector<AABB3d> AABBVector;
+
+    struct Visitor
+    {
+        const AABBVector&       m_bboxes;
+        const vector<size_t>&   m_ordering;
+        size_t                  m_hit_item;
+        double                  m_hit_distance;
+
+        Visitor(
+            const AABBVector&       bboxes,
+            const vector<size_t>&   ordering)
+          : m_bboxes(bboxes)
+          , m_ordering(ordering)
+          , m_hit_item(~size_t(0))
+          , m_hit_distance(0.0)
+        {
+        }
+
+        bool visit(
+            const NodeType&             node,
+            const Ray3d&                ray,
+            const RayInfo3d&            ray_info,
+            double&                     distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics& stats
+#endif
+            )
+        {
+            for (size_t i = node.get_item_index(), e = i + node.get_item_count(); i < e; ++i)
+            {
+                const size_t item = m_ordering[i];
+
+                double tmin;
+                if (intersect(ray, ray_info, m_bboxes[item], tmin) &&
+                    (m_hit_item == ~size_t(0) || tmin < m_hit_distance))
+                {
+                    m_hit_item = item;
+                    m_hit_distance = tmin;
+                }
+            }
+
+            distance = m_hit_item == ~size_t(0) ? ray.m_tmax : m_hit_distance;
+            return true;
+        }
+    };
+
+    TEST_CASE(FindsSameClosestItemsAsBinaryIntersector)
+    {
+        MersenneTwister rng;
+
+        AABBVector bboxes;
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const Vector3d center(
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0));
+            const Vector3d half_extent(
+                rand_double1(rng, 0.1, 1.0),
+                rand_double1(rng, 0.1, 1.0),
+                rand_double1(rng, 0.1, 1.0));
+            bboxes.push_back(AABB3d(center - half_extent, center + half_extent));
+        }
+
+        typedef bvh::SAHPartitioner<AABBVector> Partitioner;
+        Partitioner partitioner(bboxes, 2);
+
+        Tree tree;
+        bvh::Builder<Tree, Partitioner> builder;
+        builder.build<DefaultWallclockTimer>(tree, partitioner, bboxes.size(), 2);
+        tree.collapse();
+
+        ASSERT_TRUE(tree.has_wide_nodes());
+
+        bvh::Intersector<Tree, Visitor, Ray3d> binary_intersector;
+        bvh::WideIntersector<Tree, Visitor, Ray3d> wide_intersector;
+
+        size_t hit_count = 0;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const Vector3d org(
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0));
+            const Vector3d dir =
+                sample_sphere_uniform(Vector2d(rand_double2(rng), rand_double2(rng)));
+            const Ray3d ray(org, dir);
+            const RayInfo3d ray_info(ray);
+
+            Visitor binary_visitor(bboxes, partitioner.get_item_ordering());
+            binary_intersector.intersect_no_motion(
+                tree,
+                ray,
+                ray_info,
+                binary_visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , bvh::TraversalStatistics()
+#endif
+                );
+
+            Visitor wide_visitor(bboxes, partitioner.get_item_ordering());
+            wide_intersector.intersect_no_motion(
+                tree,
+                ray,
+                ray_info,
+                wide_visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , bvh::TraversalStatistics()
+#endif
+                );
+
+            EXPECT_EQ(binary_visitor.m_hit_item, wide_visitor.m_hit_item);
+
+            if (binary_visitor.m_hit_item != ~size_t(0))
+                ++hit_count;
+        }
+
+        EXPECT_GT(0, hit_count);
+    }
+}
+
+TEST_SUITE(Foundation_Math_BVH_PacketIntersector)
+{
+    typedef bvh::Node<AABB3d> NodeType;
+    typedef bvh::Tree<AlignedVector<NodeType> > Tree;
+    typedef vector<AABB3d> AABBVector;
+
+    struct Visitor
+    {
+        const AABBVector&       m_bboxes;
+        const vector<size_t>&   m_ordering;
+        size_t                  m_hit_item;
+        double                  m_hit_distance;
+        size_t                  m_visited_leaf_count;
+
+        Visitor(
+            const AABBVector&       bboxes,
+            const vector<size_t>&   ordering)
+          : m_bboxes(bboxes)
+          , m_ordering(ordering)
+          , m_hit_item(~size_t(0))
+          , m_hit_distance(0.0)
+          , m_visited_leaf_count(0)
+        {
+        }
+
+        bool visit(
+            const NodeType&             node,
+            const Ray3d&                ray,
+            const RayInfo3d&            ray_info,
+            double&                     distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics& stats
+#endif
+            )
+        {
+            ++m_visited_leaf_count;
+
+            for (size_t i = node.get_item_index(), e = i + node.get_item_count(); i < e; ++i)
+            {
+                const size_t item = m_ordering[i];
+
+                double tmin;
+                if (intersect(ray, ray_info, m_bboxes[item], tmin) &&
+                    (m_hit_item == ~size_t(0) || tmin < m_hit_distance))
+                {
+                    m_hit_item = item;
+                    m_hit_distance = tmin;
+                }
+            }
+
+            distance = m_hit_item == ~size_t(0) ? ray.m_tmax : m_hit_distance;
+            return true;
+        }
+    };
+
+    struct PacketVisitor
+    {
+        vector<Visitor>         m_visitors;
+        bool                    m_any_hit;
+
+        PacketVisitor(
+            const AABBVector&       bboxes,
+            const vector<size_t>&   ordering,
+            const size_t            ray_count,
+            const bool              any_hit)
+          : m_visitors(ray_count, Visitor(bboxes, ordering))
+          , m_any_hit(any_hit)
+        {
+        }
+
+        bool visit(
+            const NodeType&             node,
+            const size_t                ray_index,
+            const Ray3d&                ray,
+            const RayInfo3d&            ray_info,
+            double&                     distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics& stats
+#endif
+            )
+        {
+            Visitor& visitor = m_visitors[ray_index];
+
+            visitor.visit(
+                node,
+                ray,
+                ray_info,
+                distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , stats
+#endif
+                );
+
+            return !m_any_hit || visitor.m_hit_item == ~size_t(0);
+        }
+    };
+
+    struct Fixture
+    {
+        AABBVector              m_bboxes;
+        vector<size_t>          m_ordering;
+        Tree                    m_tree;
+        vector<Ray3d>           m_rays;
+        vector<RayInfo3d>       m_ray_infos;
+
+        Fixture()
+        {
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < 100; ++i)
+            {
+                const Vector3d center(
+                    rand_double1(rng, -10.0, 10.0),
+                    rand_double1(rng, -10.0, 10.0),
+                    rand_double1(rng, -10.0, 10.0));
+                const Vector3d half_extent(
+                    rand_double1(rng, 0.1, 1.0),
+                    rand_double1(rng, 0.1, 1.0),
+                    rand_double1(rng, 0.1, 1.0));
+                m_bboxes.push_back(AABB3d(center - half_extent, center + half_extent));
+            }
+
+            typedef bvh::SAHPartitioner<AABBVector> Partitioner;
+            Partitioner partitioner(m_bboxes, 2);
+
+            bvh::Builder<Tree, Partitioner> builder;
+            builder.build<DefaultWallclockTimer>(m_tree, partitioner, m_bboxes.size(), 2);
+            m_ordering = partitioner.get_item_ordering();
+
+            // Coherent rays: a pinhole camera looking at the cloud of boxes.
+            // The ray count is not a multiple of the packet size on purpose.
+            for (size_t i = 0; i < 150; ++i)
+            {
+                const Vector3d org(0.0, 0.0, 20.0);
+                const Vector3d target(
+                    rand_double1(rng, -10.0, 10.0),
+                    rand_double1(rng, -10.0, 10.0),
+                    0.0);
+                m_rays.push_back(Ray3d(org, normalize(target - org)));
+                m_ray_infos.push_back(RayInfo3d(m_rays.back()));
+            }
+        }
+
+        size_t trace_single(const size_t ray_index) const
+        {
+            Visitor visitor(m_bboxes, m_ordering);
+            bvh::Intersector<Tree, Visitor, Ray3d> intersector;
+            intersector.intersect_no_motion(
+                m_tree,
+                m_rays[ray_index],
+                m_ray_infos[ray_index],
+                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , bvh::TraversalStatistics()
+#endif
+                );
+            return visitor.m_hit_item;
+        }
+    };
+
+    TEST_CASE_F(FindsSameClosestItemsAsSingleRayIntersector, Fixture)
+    {
+        PacketVisitor packet_visitor(m_bboxes, m_ordering, m_rays.size(), false);
+        bvh::PacketIntersector<Tree, PacketVisitor, Ray3d> packet_intersector;
+        packet_intersector.intersect_no_motion(
+            m_tree,
+            m_rays.size(),
+            &m_rays[0],
+            &m_ray_infos[0],
+            packet_visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics()
+#endif
+            );
+
+        size_t hit_count = 0;
+
+        for (size_t i = 0; i < m_rays.size(); ++i)
+        {
+            const size_t expected_item = trace_single(i);
+
+            EXPECT_EQ(expected_item, packet_visitor.m_visitors[i].m_hit_item);
+
+            if (expected_item != ~size_t(0))
+                ++hit_count;
+        }
+
+        EXPECT_GT(0, hit_count);
+    }
+
+    TEST_CASE_F(TerminatedRaysReportSameOcclusionAsSingleRayIntersector, Fixture)
+    {
+        PacketVisitor packet_visitor(m_bboxes, m_ordering, m_rays.size(), true);
+        bvh::PacketIntersector<Tree, PacketVisitor, Ray3d, 32> packet_intersector;
+        packet_intersector.intersect_no_motion(
+            m_tree,
+            m_rays.size(),
+            &m_rays[0],
+            &m_ray_infos[0],
+            packet_visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics()
+#endif
+            );
+
+        for (size_t i = 0; i < m_rays.size(); ++i)
+        {
+            const bool expected_hit = trace_single(i) != ~size_t(0);
+            EXPECT_EQ(expected_hit, packet_visitor.m_visitors[i].m_hit_item != ~size_t(0));
+        }
+    }
+
+    TEST_CASE(NodesBeyondClosestHitsAreNotVisited)
+    {
+        // Two boxes along the x axis, each in its own leaf.
+        AABBVector bboxes;
+        bboxes.push_back(AABB3d(Vector3d(1.0, -1.0, -1.0), Vector3d(2.0, 1.0, 1.0)));
+        bboxes.push_back(AABB3d(Vector3d(5.0, -1.0, -1.0), Vector3d(6.0, 1.0, 1.0)));
+
+        typedef bvh::SAHPartitioner<AABBVector> Partitioner;
+        Partitioner partitioner(bboxes, 1);
+
+        Tree tree;
+        bvh::Builder<Tree, Partitioner> builder;
+        builder.build<DefaultWallclockTimer>(tree, partitioner, bboxes.size(), 1);
+
+        // Rays hitting both boxes: the far box is pushed on the stack, then culled
+        // once the near box has been hit.
+        vector<Ray3d> rays;
+        vector<RayInfo3d> ray_infos;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            const double y = 0.05 * i - 0.4;
+            rays.push_back(Ray3d(Vector3d(0.0, y, -y), Vector3d(1.0, 0.0, 0.0)));
+            ray_infos.push_back(RayInfo3d(rays.back()));
+        }
+
+        PacketVisitor packet_visitor(bboxes, partitioner.get_item_ordering(), rays.size(), false);
+        bvh::PacketIntersector<Tree, PacketVisitor, Ray3d> packet_intersector;
+        packet_intersector.intersect_no_motion(
+            tree,
+            rays.size(),
+            &rays[0],
+            &ray_infos[0],
+            packet_visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics()
+#endif
+            );
+
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            EXPECT_EQ(0, packet_visitor.m_visitors[i].m_hit_item);
+            EXPECT_EQ(1, packet_visitor.m_visitors[i].m_visited_leaf_count);
+        }
+    }
+}
+
+TEST_SUITE(Foundation_Math_BVH_Builder)
+{
+    typedef bvh::Node<AABB3d> NodeType;
+    typedef AlignedVector<NodeType> NodeVector;
+    typedef vector<AABB3d> AABBVector;
+    typedef bvh::SAHPartitioner<AABBVector> Partitioner;
+
+    class Tree
+      : public bvh::Tree<NodeVector>
+    {
+      public:
+        const NodeVector& get_nodes() const
+        {
+            return m_nodes;
+        }
+    };
+
+    void create_bboxes(AABBVector& bboxes, const size_t count)
+    {
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Vector3d center(
+                rand_double1(rng, -100.0, 100.0),
+                rand_double1(rng, -100.0, 100.0),
+                rand_double1(rng, -100.0, 100.0));
+            const Vector3d half_extent(
+                rand_double1(rng, 0.1, 1.0),
+                rand_double1(rng, 0.1, 1.0),
+                rand_double1(rng, 0.1, 1.0));
+            bboxes.push_back(AABB3d(center - half_extent, center + half_extent));
+        }
+    }
+
+    bool are_equal(const NodeVector& lhs, const NodeVector& rhs)
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+
+        for (size_t i = 0; i < lhs.size(); ++i)
+        {
+            const NodeType& l = lhs[i];
+            const NodeType& r = rhs[i];
+
+            if (l.is_leaf() != r.is_leaf())
+                return false;
+
+            if (l.is_leaf())
+            {
+                if (l.get_item_index() != r.get_item_index() ||
+                    l.get_item_count() != r.get_item_count())
+                    return false;
+            }
+            else
+            {
+                if (l.get_child_node_index() != r.get_child_node_index() ||
+                    l.get_left_bbox() != r.get_left_bbox() ||
+                    l.get_right_bbox() != r.get_right_bbox())
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    TEST_CASE(ParallelBuildProducesSameTreeAsSerialBuild)
+    {
+        AABBVector bboxes;
+        create_bboxes(bboxes, 5000);
+
+        Partitioner serial_partitioner(bboxes, 2);
+        Tree serial_tree;
+        bvh::Builder<Tree, Partitioner> serial_builder;
+        serial_builder.build<DefaultWallclockTimer>(serial_tree, serial_partitioner, bboxes.size(), 2);
+
+        for (size_t thread_count = 1; thread_count <= 4; ++thread_count)
+        {
+            Partitioner parallel_partitioner(bboxes, 2);
+            Tree parallel_tree;
+            bvh::Builder<Tree, Partitioner> parallel_builder;
+            parallel_builder.build<DefaultWallclockTimer>(
+                parallel_tree,
+                parallel_partitioner,
+                bboxes.size(),
+                2,
+                thread_count,
+                100);
+
+            EXPECT_TRUE(are_equal(serial_tree.get_nodes(), parallel_tree.get_nodes()));
+            EXPECT_EQ(serial_partitioner.get_item_ordering(), parallel_partitioner.get_item_ordering());
+        }
+    }
+
+    TEST_CASE(ParallelBuildWithBinnedSAHPartitionerProducesSameTreeAsSerialBuild)
+    {
+        typedef bvh::BinnedSAHPartitioner<AABBVector> BinnedPartitioner;
+
+        AABBVector bboxes;
+        create_bboxes(bboxes, 5000);
+
+        BinnedPartitioner serial_partitioner(bboxes, 2);
+        Tree serial_tree;
+        bvh::Builder<Tree, BinnedPartitioner> serial_builder;
+        serial_builder.build<DefaultWallclockTimer>(serial_tree, serial_partitioner, bboxes.size(), 2);
+
+        BinnedPartitioner parallel_partitioner(bboxes, 2);
+        Tree parallel_tree;
+        bvh::Builder<Tree, BinnedPartitioner> parallel_builder;
+        parallel_builder.build<DefaultWallclockTimer>(
+            parallel_tree,
+            parallel_partitioner,
+            bboxes.size(),
+            2,
+            4,
+            100);
+
+        EXPECT_TRUE(are_equal(serial_tree.get_nodes(), parallel_tree.get_nodes()));
+        EXPECT_EQ(serial_partitioner.get_item_ordering(), parallel_partitioner.get_item_ordering());
+    }
+
+    TEST_CASE(BinnedSAHPartitionerBuildsTreeReferencingEveryItemOnce)
+    {
+        typedef bvh::BinnedSAHPartitioner<AABBVector> BinnedPartitioner;
+
+        AABBVector bboxes;
+        create_bboxes(bboxes, 1000);
+
+        // Add coincident items to exercise the fallback split.
+        for (size_t i = 0; i < 10; ++i)
+            bboxes.push_back(AABB3d(Vector3d(0.0), Vector3d(1.0)));
+
+        BinnedPartitioner partitioner(bboxes, 2);
+        Tree tree;
+        bvh::Builder<Tree, BinnedPartitioner> builder;
+        builder.build<DefaultWallclockTimer>(tree, partitioner, bboxes.size(), 2);
+
+        vector<size_t> ordering = partitioner.get_item_ordering();
+        sort(ordering.begin(), ordering.end());
+        ASSERT_EQ(bboxes.size(), ordering.size());
+        for (size_t i = 0; i < ordering.size(); ++i)
+            EXPECT_EQ(i, ordering[i]);
+
+        vector<size_t> item_refs(bboxes.size(), 0);
+        const NodeVector& nodes = tree.get_nodes();
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            if (nodes[i].is_leaf())
+            {
+                for (size_t j = nodes[i].get_item_index(), e = j + nodes[i].get_item_count(); j < e; ++j)
+                    ++item_refs[j];
+            }
+        }
+
+        EXPECT_EQ(vector<size_t>(bboxes.size(), 1), item_refs);
+    }
+}
@@ -116,6 +116,27 @@ TEST_SUITE(Foundation_Utility_Cache_SACache)
 
         EXPECT_EQ(0, element_swapper.m_unload_count);
     }
+
+    TEST_CASE(Flush_UnloadsElementsOnlyOnce)
+    {
+        ElementSwapperCountingUnloads element_swapper;
+
+        {
+            KeyHasher key_hasher;
+            SACache<Key, KeyHasher, Element, ElementSwapperCountingUnloads, 4, 1> cache(
+                key_hasher,
+                element_swapper,
+                InvalidKey);
+
+            cache.get(1);
+            cache.get(2);
+            cache.flush();
+
+            EXPECT_EQ(2, element_swapper.m_unload_count);
+        }
+
+        EXPECT_EQ(2, element_swapper.m_unload_count);
+    }
 }
 
 TEST_SUITE(Foundation_Utility_Cache_LRUCache)
@@ -466,6 +466,38 @@ TEST_SUITE(Foundation_Image_ColorSpace)
             1.0e-5f);
     }
 
+#ifdef APPLESEED_USE_SSE
+
+    TEST_CASE(TestSSELinearRGBToCIEXYZConversion)
+    {
+        const Color3f linear_rgb(0.5f, 0.7f, 0.2f);
+
+        APPLESEED_SIMD4_ALIGN float ciexyz[4] = { linear_rgb[0], linear_rgb[1], linear_rgb[2], 1.0f };
+        _mm_store_ps(ciexyz, linear_rgb_to_ciexyz(_mm_load_ps(ciexyz)));
+
+        EXPECT_FEQ_EPS(
+            linear_rgb_to_ciexyz(linear_rgb),
+            Color3f(ciexyz[0], ciexyz[1], ciexyz[2]),
+            1.0e-6f);
+        EXPECT_EQ(0.0f, ciexyz[3]);
+    }
+
+    TEST_CASE(TestSSECIEXYZToLinearRGBConversion)
+    {
+        const Color3f ciexyz(0.5f, 0.7f, 0.2f);
+
+        APPLESEED_SIMD4_ALIGN float linear_rgb[4] = { ciexyz[0], ciexyz[1], ciexyz[2], 1.0f };
+        _mm_store_ps(linear_rgb, ciexyz_to_linear_rgb(_mm_load_ps(linear_rgb)));
+
+        EXPECT_FEQ_EPS(
+            ciexyz_to_linear_rgb(ciexyz),
+            Color3f(linear_rgb[0], linear_rgb[1], linear_rgb[2]),
+            1.0e-6f);
+        EXPECT_EQ(0.0f, linear_rgb[3]);
+    }
+
+#endif
+
     static RegularSpectrum31f get_white_spectrum()
     {
         // The white color from the Cornell Box scene.
@@ -169,6 +169,43 @@ TEST_SUITE(Foundation_Utility_StringDictionary)
 
         EXPECT_EQ(&sd, result);
     }
+
+    TEST_CASE(Iteration_VisitsItemsSortedByKey)
+    {
+        StringDictionary sd;
+        sd.insert("c", 3);
+        sd.insert("a", 1);
+        sd.insert("b", 2);
+
+        StringDictionary::const_iterator it = sd.begin();
+        EXPECT_EQ(string("a"), it.key()); ++it;
+        EXPECT_EQ(string("b"), it.key()); ++it;
+        EXPECT_EQ(string("c"), it.key()); ++it;
+        EXPECT_TRUE(it == sd.end());
+    }
+
+    TEST_CASE(Insert_GivenKeyOfExistingItem_ReplacesValue)
+    {
+        StringDictionary sd;
+        sd.insert("key", 1);
+        sd.insert("key", 2);
+
+        EXPECT_EQ(1, sd.size());
+        EXPECT_EQ(2, sd.get<int>("key"));
+    }
+
+    TEST_CASE(CopyConstructor_CopyIsIndependentFromSource)
+    {
+        StringDictionary sd1;
+        sd1.insert("key", 1);
+
+        StringDictionary sd2(sd1);
+        sd2.set("key", 2);
+        sd1.remove("key");
+
+        EXPECT_FALSE(sd1.exist("key"));
+        EXPECT_EQ(2, sd2.get<int>("key"));
+    }
 }
 
 TEST_SUITE(Foundation_Utility_DictionaryDictionary)
@@ -0,0 +1,129 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/eventtracer.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Utility_EventTracer)
+{
+    TEST_CASE(Record_IncrementsEventCount)
+    {
+        EventTracer tracer;
+
+        tracer.record("rendering", "tile", 10, 20);
+        tracer.record("rendering", "tile", 20, 30);
+
+        EXPECT_EQ(2, tracer.get_event_count());
+    }
+
+    TEST_CASE(Record_GivenFullRingBuffer_KeepsMostRecentEvents)
+    {
+        EventTracer tracer(2);
+
+        tracer.record("test", "first", 0, 1);
+        tracer.record("test", "second", 1, 2);
+        tracer.record("test", "third", 2, 3);
+
+        EXPECT_EQ(2, tracer.get_event_count());
+
+        stringstream sstr;
+        tracer.write_chrome_trace(sstr);
+        const string trace = sstr.str();
+
+        EXPECT_EQ(string::npos, trace.find("\"first\""));
+        EXPECT_LT(trace.find("\"third\""), trace.find("\"second\""));
+    }
+
+    TEST_CASE(Clear_RemovesAllEvents)
+    {
+        EventTracer tracer;
+
+        tracer.record("test", "event", 0, 1);
+        tracer.clear();
+
+        EXPECT_EQ(0, tracer.get_event_count());
+    }
+
+    TEST_CASE(WriteChromeTrace_WritesCompleteEventsAndThreadNames)
+    {
+        EventTracer tracer;
+
+        tracer.set_thread_name("main");
+        tracer.record("tree", "triangle tree", 100, 350, "assembly \"a\"");
+
+        stringstream sstr;
+        tracer.write_chrome_trace(sstr);
+        const string trace = sstr.str();
+
+        EXPECT_EQ(0, trace.find("{\"traceEvents\":["));
+        EXPECT_NEQ(string::npos, trace.find("\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"main\"}"));
+        EXPECT_NEQ(string::npos, trace.find("\"name\":\"triangle tree\",\"cat\":\"tree\",\"ph\":\"X\""));
+        EXPECT_NEQ(string::npos, trace.find("\"ts\":100,\"dur\":250"));
+        EXPECT_NEQ(string::npos, trace.find("\"args\":{\"detail\":\"assembly \\\"a\\\"\"}"));
+    }
+
+    TEST_CASE(EventTraceScope_GivenDisabledTracer_RecordsNothing)
+    {
+        EventTracer& tracer = global_event_tracer();
+        tracer.set_enabled(false);
+        tracer.clear();
+
+        {
+            EventTraceScope scope("test", "scope");
+        }
+
+        EXPECT_EQ(0, tracer.get_event_count());
+    }
+
+    TEST_CASE(EventTraceScope_GivenEnabledTracer_RecordsOneEvent)
+    {
+        EventTracer& tracer = global_event_tracer();
+        tracer.clear();
+        tracer.set_enabled(true);
+
+        {
+            EventTraceScope scope("test", "scope", "detail");
+        }
+
+        tracer.set_enabled(false);
+
+        EXPECT_EQ(1, tracer.get_event_count());
+
+        tracer.clear();
+    }
+}
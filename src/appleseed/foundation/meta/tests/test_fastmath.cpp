@@ -40,6 +40,7 @@
 #include "foundation/utility/test.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <string>
@@ -592,6 +593,187 @@ TEST_SUITE(Foundation_Math_FastMath)
             1000);
     }
 
+    //
+    // Sin(x).
+    //
+
+    void vector_std_sin(float x[4])
+    {
+        for (size_t i = 0; i < 4; ++i)
+            x[i] = sin(x[i]);
+    }
+
+    TEST_CASE(ScalarFastSinFull)
+    {
+        const float error =
+            compute_avg_relative_error_scalar<float, float (*)(float)>(
+                sin,
+                fast_sin_full,
+                0.1f,
+                3.0f,
+                1000);
+
+        EXPECT_LT(0.00105f, error);
+    }
+
+    TEST_CASE(VectorFastSinFull)
+    {
+        const float error =
+            compute_avg_relative_error_vector(
+                vector_std_sin,
+                fast_sin_full,
+                0.1f,
+                3.0f,
+                1000);
+
+        EXPECT_LT(0.00105f, error);
+    }
+
+    //
+    // Cos(x).
+    //
+
+    void vector_std_cos(float x[4])
+    {
+        for (size_t i = 0; i < 4; ++i)
+            x[i] = cos(x[i]);
+    }
+
+    TEST_CASE(ScalarFastCosFull)
+    {
+        const float error =
+            compute_avg_relative_error_scalar<float, float (*)(float)>(
+                cos,
+                fast_cos_full,
+                -1.4f,
+                1.4f,
+                1000);
+
+        EXPECT_LT(0.00086f, error);
+    }
+
+    TEST_CASE(VectorFastCosFull)
+    {
+        const float error =
+            compute_avg_relative_error_vector(
+                vector_std_cos,
+                fast_cos_full,
+                -1.4f,
+                1.4f,
+                1000);
+
+        EXPECT_LT(0.00086f, error);
+    }
+
+    //
+    // Acos(x).
+    //
+
+    void vector_std_acos(float x[4])
+    {
+        for (size_t i = 0; i < 4; ++i)
+            x[i] = acos(x[i]);
+    }
+
+    TEST_CASE(ScalarFastAcos)
+    {
+        const float error =
+            compute_avg_relative_error_scalar<float, float (*)(float)>(
+                acos,
+                fast_acos,
+                -1.0f,
+                0.99f,
+                1000);
+
+        EXPECT_LT(0.0000215f, error);
+    }
+
+    TEST_CASE(VectorFastAcos)
+    {
+        const float error =
+            compute_avg_relative_error_vector(
+                vector_std_acos,
+                fast_acos,
+                -1.0f,
+                0.99f,
+                1000);
+
+        EXPECT_LT(0.0000215f, error);
+    }
+
+    TEST_CASE(PlotAcosFunctions)
+    {
+        const FuncDef<float (*)(float)> functions[] =
+        {
+            { "std::acos", "black", acos },
+            { "foundation::fast_acos", "green", fast_acos }
+        };
+
+        plot_functions(
+            "unit tests/outputs/test_fastmath_acos.gnuplot",
+            functions,
+            countof(functions),
+            -1.0f,
+            1.0f,
+            1000);
+    }
+
+    //
+    // Atan2(y, x).
+    //
+
+    TEST_CASE(ScalarFastAtan2)
+    {
+        const size_t StepCount = 100;
+        float max_error = 0.0f;
+
+        for (size_t i = 0; i < StepCount; ++i)
+        {
+            for (size_t j = 0; j < StepCount; ++j)
+            {
+                const float y = fit<size_t, float>(i, 0, StepCount - 1, -1.0f, 1.0f);
+                const float x = fit<size_t, float>(j, 0, StepCount - 1, -1.0f, 1.0f);
+                max_error = max(max_error, abs(atan2(y, x) - fast_atan2(y, x)));
+            }
+        }
+
+        EXPECT_LT(3.0e-6f, max_error);
+    }
+
+    TEST_CASE(VectorFastAtan2)
+    {
+        const size_t StepCount = 100;
+        float max_error = 0.0f;
+
+        for (size_t i = 0; i < StepCount; ++i)
+        {
+            for (size_t j = 0; j < StepCount; j += 4)
+            {
+                APPLESEED_SIMD4_ALIGN float y[4];
+                APPLESEED_SIMD4_ALIGN float x[4];
+
+                for (size_t k = 0; k < 4; ++k)
+                {
+                    y[k] = fit<size_t, float>(i, 0, StepCount - 1, -1.0f, 1.0f);
+                    x[k] = fit<size_t, float>(j + k, 0, StepCount - 1, -1.0f, 1.0f);
+                }
+
+                APPLESEED_SIMD4_ALIGN float values[4] = { y[0], y[1], y[2], y[3] };
+                fast_atan2(values, x);
+
+                for (size_t k = 0; k < 4; ++k)
+                    max_error = max(max_error, abs(atan2(y[k], x[k]) - values[k]));
+            }
+        }
+
+        EXPECT_LT(3.0e-6f, max_error);
+    }
+
+    TEST_CASE(FastAtan2_GivenOrigin_ReturnsZero)
+    {
+        EXPECT_EQ(0.0f, fast_atan2(0.0f, 0.0f));
+    }
+
     //
     // Rcp(x).
     //
@@ -33,6 +33,7 @@
 #include "foundation/utility/test.h"
 
 // Standard headers.
+#include <cmath>
 #include <cstddef>
 #include <cstdio>
 
@@ -102,4 +103,71 @@ TEST_SUITE(Foundation_Image_FilteredTile)
         const BoxFilter2<float> filter(2.0f, 2.0f);
         test("unit tests/outputs/test_filteredtile_boxfilter_radius_2_0.txt", filter);
     }
+
+    TEST_CASE(AddExclusive_GivenSameSamplesAsAdd_ProducesSameTile)
+    {
+        const GaussianFilter2<float> filter(2.0f, 2.0f, 8.0f);
+        FilteredTile tile(16, 16, 2, filter);
+        FilteredTile ref_tile(16, 16, 2, filter);
+        tile.clear();
+        ref_tile.clear();
+
+        const float values[2] = { 0.5f, 2.0f };
+        tile.add_exclusive(7.3f, 0.4f, values);
+        tile.add_exclusive(12.1f, 15.8f, values);
+        ref_tile.add(7.3f, 0.4f, values);
+        ref_tile.add(12.1f, 15.8f, values);
+
+        const float* ptr = tile.pixel(0);
+        const float* ref_ptr = ref_tile.pixel(0);
+        bool same = true;
+
+        for (size_t i = 0, e = tile.get_pixel_count() * tile.get_channel_count(); i < e; ++i)
+        {
+            if (ptr[i] != ref_ptr[i])
+                same = false;
+        }
+
+        EXPECT_TRUE(same);
+    }
+
+    TEST_CASE(Add_GivenSeparableFilter_MatchesPerPixelFilterEvaluation)
+    {
+        const BlackmanHarrisFilter2<float> filter(2.0f, 1.5f);
+        FilteredTile tile(8, 8, 5, filter);
+        tile.clear();
+
+        const float values[5] = { 0.5f, 2.0f, 3.0f, 4.0f, 5.0f };
+        tile.add(3.7f, 4.2f, values);
+
+        const float dx = 3.7f - 0.5f;
+        const float dy = 4.2f - 0.5f;
+        bool same = true;
+
+        for (size_t y = 0; y < tile.get_height(); ++y)
+        {
+            for (size_t x = 0; x < tile.get_width(); ++x)
+            {
+                const float fx = static_cast<float>(x) - dx;
+                const float fy = static_cast<float>(y) - dy;
+                const float expected_weight =
+                    abs(fx) <= filter.get_xradius() && abs(fy) <= filter.get_yradius()
+                        ? filter.evaluate(fx, fy)
+                        : 0.0f;
+
+                const float* ptr = tile.pixel(x, y);
+
+                if (abs(ptr[0] - expected_weight) > 1.0e-6f)
+                    same = false;
+
+                for (size_t i = 0; i < 5; ++i)
+                {
+                    if (abs(ptr[1 + i] - values[i] * expected_weight) > 1.0e-5f)
+                        same = false;
+                }
+            }
+        }
+
+        EXPECT_TRUE(same);
+    }
 }
@@ -0,0 +1,276 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/sampling/hierarchicalimageimportancesampler.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <sstream>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_Sampling_HierarchicalImageImportanceSampler)
+{
+    class GradientSampler
+    {
+      public:
+        typedef size_t Payload;
+
+        explicit GradientSampler(const float offset = 0.0f)
+          : m_offset(offset)
+        {
+        }
+
+        void sample(const size_t x, const size_t y, Payload& payload, float& importance) const
+        {
+            payload = 100 * y + x;
+            importance = static_cast<float>(x + y) + m_offset;
+        }
+
+      private:
+        const float m_offset;
+    };
+
+    typedef HierarchicalImageImportanceSampler<GradientSampler::Payload, float> ImportanceSamplerType;
+
+    TEST_CASE(GetPDF_ReturnsSameProbabilityAsSample)
+    {
+        ImportanceSamplerType importance_sampler(5, 3);
+        GradientSampler sampler;
+        importance_sampler.rebuild(sampler);
+
+        size_t x, y;
+        size_t payload;
+        float prob_xy;
+        importance_sampler.sample(Vector2f(0.3f, 0.7f), x, y, payload, prob_xy);
+
+        EXPECT_EQ(100 * y + x, payload);
+        EXPECT_EQ(importance_sampler.get_pdf(x, y), prob_xy);
+    }
+
+    TEST_CASE(GetPDF_ReturnsNormalizedImportance)
+    {
+        const size_t Width = 5;
+        const size_t Height = 3;
+
+        ImportanceSamplerType importance_sampler(Width, Height);
+        GradientSampler sampler;
+        importance_sampler.rebuild(sampler);
+
+        // Sum of x + y over the image.
+        const float Total = 45.0f;
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+                EXPECT_FEQ((x + y) / Total, importance_sampler.get_pdf(x, y));
+        }
+    }
+
+    TEST_CASE(Sample_GivenStratifiedSamples_ReturnsPixelsInProportionToTheirImportance)
+    {
+        const size_t Width = 5;
+        const size_t Height = 3;
+        const size_t SampleCount = 256;
+
+        ImportanceSamplerType importance_sampler(Width, Height);
+        GradientSampler sampler;
+        importance_sampler.rebuild(sampler);
+
+        vector<size_t> histogram(Width * Height, 0);
+
+        for (size_t j = 0; j < SampleCount; ++j)
+        {
+            for (size_t i = 0; i < SampleCount; ++i)
+            {
+                const Vector2f s((i + 0.5f) / SampleCount, (j + 0.5f) / SampleCount);
+
+                size_t x, y;
+                float prob_xy;
+                importance_sampler.sample(s, x, y, prob_xy);
+
+                ASSERT_TRUE(x < Width && y < Height);
+                ++histogram[y * Width + x];
+            }
+        }
+
+        // Each pixel maps to a region of the unit square whose boundary only cuts through
+        // strata along its edges: the sampling frequency of a pixel can deviate from its
+        // probability by at most a few rows or columns of strata, i.e. a few 1 / SampleCount.
+        const float MaxDeviation = 2.0f / SampleCount;
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                const float frequency = static_cast<float>(histogram[y * Width + x]) / (SampleCount * SampleCount);
+                EXPECT_LT(MaxDeviation, abs(importance_sampler.get_pdf(x, y) - frequency));
+            }
+        }
+    }
+
+    TEST_CASE(Read_GivenWrittenSampler_ReturnsSameProbabilities)
+    {
+        const size_t Width = 5;
+        const size_t Height = 3;
+
+        ImportanceSamplerType importance_sampler(Width, Height);
+        GradientSampler sampler;
+        importance_sampler.rebuild(sampler);
+
+        stringstream stream;
+        importance_sampler.write(stream);
+
+        ImportanceSamplerType read_importance_sampler(Width, Height);
+        const bool success = read_importance_sampler.read(stream);
+        ASSERT_TRUE(success);
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+                EXPECT_EQ(importance_sampler.get_pdf(x, y), read_importance_sampler.get_pdf(x, y));
+        }
+    }
+
+    TEST_CASE(Read_GivenSamplerOfDifferentSize_ReturnsFalse)
+    {
+        ImportanceSamplerType importance_sampler(5, 5);
+        GradientSampler sampler;
+        importance_sampler.rebuild(sampler);
+
+        stringstream stream;
+        importance_sampler.write(stream);
+
+        ImportanceSamplerType read_importance_sampler(4, 5);
+        EXPECT_FALSE(read_importance_sampler.read(stream));
+    }
+
+    TEST_CASE(RebuildRows_GivenAllRows_MatchesRebuild)
+    {
+        const size_t Width = 5;
+        const size_t Height = 6;
+
+        GradientSampler sampler;
+
+        ImportanceSamplerType importance_sampler(Width, Height);
+        importance_sampler.rebuild(sampler);
+
+        ImportanceSamplerType rows_importance_sampler(Width, Height);
+        rows_importance_sampler.rebuild_rows(sampler, 3, 6);
+        rows_importance_sampler.rebuild_rows(sampler, 0, 3);
+        rows_importance_sampler.rebuild_pyramid();
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+                EXPECT_EQ(importance_sampler.get_pdf(x, y), rows_importance_sampler.get_pdf(x, y));
+        }
+    }
+
+    struct RegionSampler
+    {
+        typedef size_t Payload;
+
+        void sample(const size_t x, const size_t y, Payload& payload, float& importance) const
+        {
+            payload = 0;
+            importance = x >= 2 && x < 5 && y >= 1 && y < 3 ? 8.0f : static_cast<float>(x + y);
+        }
+    };
+
+    TEST_CASE(Update_GivenChangedRegion_MatchesRebuild)
+    {
+        const size_t Width = 7;
+        const size_t Height = 5;
+
+        ImportanceSamplerType updated_importance_sampler(Width, Height);
+        GradientSampler gradient_sampler;
+        updated_importance_sampler.rebuild(gradient_sampler);
+
+        RegionSampler region_sampler;
+        updated_importance_sampler.update(region_sampler, 2, 1, 5, 3);
+
+        ImportanceSamplerType importance_sampler(Width, Height);
+        importance_sampler.rebuild(region_sampler);
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+                EXPECT_FEQ(importance_sampler.get_pdf(x, y), updated_importance_sampler.get_pdf(x, y));
+        }
+    }
+
+    struct UniformBlackImageSampler
+    {
+        typedef size_t Payload;
+
+        void sample(const size_t x, const size_t y, Payload& payload, float& importance) const
+        {
+            payload = 0;
+            importance = 0.0f;
+        }
+    };
+
+    TEST_CASE(Sample_GivenUniformBlackImage)
+    {
+        ImportanceSamplerType importance_sampler(2, 2);
+        UniformBlackImageSampler sampler;
+        importance_sampler.rebuild(sampler);
+
+        size_t x, y;
+        float prob_xy;
+        importance_sampler.sample(Vector2f(0.0f, 0.0f), x, y, prob_xy);
+
+        EXPECT_EQ(0, x);
+        EXPECT_EQ(0, y);
+        EXPECT_EQ(0.25f, prob_xy);
+        EXPECT_EQ(0.25f, importance_sampler.get_pdf(0, 1));
+    }
+
+    TEST_CASE(Sample_GivenSinglePixelImage)
+    {
+        ImportanceSamplerType importance_sampler(1, 1);
+        GradientSampler sampler(1.0f);
+        importance_sampler.rebuild(sampler);
+
+        size_t x, y;
+        float prob_xy;
+        importance_sampler.sample(Vector2f(0.9f, 0.9f), x, y, prob_xy);
+
+        EXPECT_EQ(0, x);
+        EXPECT_EQ(0, y);
+        EXPECT_EQ(1.0f, prob_xy);
+    }
+}
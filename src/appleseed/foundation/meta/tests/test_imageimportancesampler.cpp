@@ -43,6 +43,7 @@
 #include <cassert>
 #include <cstddef>
 #include <memory>
+#include <sstream>
 
 using namespace foundation;
 using namespace std;
@@ -88,6 +89,92 @@ TEST_SUITE(Foundation_Math_Sampling_ImageImportanceSampler)
         EXPECT_EQ(prob_xy, pdf);
     }
 
+    TEST_CASE(GetPDF_GivenAliasTableDistribution_ReturnsSameProbabilityAsSample)
+    {
+        const size_t Width = 5;
+        const size_t Height = 5;
+
+        ImageImportanceSampler<HorizontalGradientSampler::Payload, float, AliasTable> importance_sampler(Width, Height);
+        HorizontalGradientSampler sampler(Width, Height);
+        importance_sampler.rebuild(sampler);
+
+        size_t x, y;
+        float prob_xy;
+        importance_sampler.sample(Vector2f(0.3f, 0.7f), x, y, prob_xy);
+
+        const float pdf = importance_sampler.get_pdf(x, y);
+
+        EXPECT_GT(0u, x);
+        EXPECT_EQ(prob_xy, pdf);
+    }
+
+    TEST_CASE(Read_GivenWrittenSampler_ReturnsSameProbabilities)
+    {
+        const size_t Width = 5;
+        const size_t Height = 5;
+
+        ImageImportanceSampler<HorizontalGradientSampler::Payload, float> importance_sampler(Width, Height);
+        HorizontalGradientSampler sampler(Width, Height);
+        importance_sampler.rebuild(sampler);
+
+        stringstream stream;
+        importance_sampler.write(stream);
+
+        ImageImportanceSampler<HorizontalGradientSampler::Payload, float> read_importance_sampler(Width, Height);
+        const bool success = read_importance_sampler.read(stream);
+        ASSERT_TRUE(success);
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+                EXPECT_EQ(importance_sampler.get_pdf(x, y), read_importance_sampler.get_pdf(x, y));
+        }
+
+        size_t x1, y1, x2, y2;
+        float prob1, prob2;
+        importance_sampler.sample(Vector2f(0.3f, 0.7f), x1, y1, prob1);
+        read_importance_sampler.sample(Vector2f(0.3f, 0.7f), x2, y2, prob2);
+
+        EXPECT_EQ(x1, x2);
+        EXPECT_EQ(y1, y2);
+        EXPECT_EQ(prob1, prob2);
+    }
+
+    TEST_CASE(Read_GivenSamplerOfDifferentSize_ReturnsFalse)
+    {
+        ImageImportanceSampler<HorizontalGradientSampler::Payload, float> importance_sampler(5, 5);
+        HorizontalGradientSampler sampler(5, 5);
+        importance_sampler.rebuild(sampler);
+
+        stringstream stream;
+        importance_sampler.write(stream);
+
+        ImageImportanceSampler<HorizontalGradientSampler::Payload, float> read_importance_sampler(4, 5);
+        EXPECT_FALSE(read_importance_sampler.read(stream));
+    }
+
+    TEST_CASE(RebuildRows_GivenAllRows_MatchesRebuild)
+    {
+        const size_t Width = 5;
+        const size_t Height = 6;
+
+        HorizontalGradientSampler sampler(Width, Height);
+
+        ImageImportanceSampler<HorizontalGradientSampler::Payload, float> importance_sampler(Width, Height);
+        importance_sampler.rebuild(sampler);
+
+        ImageImportanceSampler<HorizontalGradientSampler::Payload, float> rows_importance_sampler(Width, Height);
+        rows_importance_sampler.rebuild_rows(sampler, 3, 6);
+        rows_importance_sampler.rebuild_rows(sampler, 0, 3);
+        rows_importance_sampler.rebuild_rows_cdf();
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+                EXPECT_EQ(importance_sampler.get_pdf(x, y), rows_importance_sampler.get_pdf(x, y));
+        }
+    }
+
     void generate_image(
         const char*     input_filename,
         const char*     output_image,
@@ -295,6 +295,26 @@ TEST_SUITE(Foundation_Utility_Job_JobQueue)
 
         EXPECT_EQ(0, destruction_count);
     }
+
+    TEST_CASE(RunScheduledJobReturnsFalseOnEmptyJobQueue)
+    {
+        JobQueue job_queue;
+
+        EXPECT_FALSE(job_queue.run_scheduled_job(0));
+    }
+
+    TEST_CASE(RunScheduledJobExecutesAndRetiresScheduledJob)
+    {
+        volatile uint32 execution_count = 0;
+
+        JobQueue job_queue;
+        job_queue.schedule(new JobNotifyingAboutExecution(&execution_count));
+
+        EXPECT_TRUE(job_queue.run_scheduled_job(0));
+
+        EXPECT_EQ(1, execution_count);
+        EXPECT_FALSE(job_queue.has_scheduled_or_running_jobs());
+    }
 }
 
 TEST_SUITE(Foundation_Utility_Job_JobManager)
@@ -334,6 +354,38 @@ TEST_SUITE(Foundation_Utility_Job_JobManager)
         volatile uint32*    m_execution_count;
     };
 
+    class JobWaitingForChildJobs
+      : public IJob
+    {
+      public:
+        JobWaitingForChildJobs(
+            JobQueue&           job_queue,
+            const size_t        child_count,
+            volatile uint32*    execution_count)
+          : m_job_queue(job_queue)
+          , m_child_count(child_count)
+          , m_execution_count(execution_count)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+        {
+            for (size_t i = 0; i < m_child_count; ++i)
+            {
+                m_job_queue.schedule(
+                    new JobNotifyingAboutExecution(m_execution_count));
+            }
+
+            while (atomic_read(m_execution_count) < m_child_count)
+                m_job_queue.run_scheduled_job(thread_index);
+        }
+
+      private:
+        JobQueue&           m_job_queue;
+        const size_t        m_child_count;
+        volatile uint32*    m_execution_count;
+    };
+
     TEST_CASE_F(InitialStateIsCorrect, FixtureJobManager)
     {
         EXPECT_EQ(1, job_manager.get_thread_count());
@@ -374,6 +426,98 @@ TEST_SUITE(Foundation_Utility_Job_JobManager)
 
         EXPECT_EQ(1, execution_count);
     }
+
+    TEST_CASE_F(JobManagerExecutesJobWaitingForItsSubJobs, FixtureJobManager)
+    {
+        volatile uint32 execution_count = 0;
+
+        job_queue.schedule(
+            new JobWaitingForChildJobs(job_queue, 10, &execution_count));
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        EXPECT_EQ(10, execution_count);
+    }
+
+    TEST_CASE(JobManagerWithMultipleThreadsExecutesAllJobs)
+    {
+        volatile uint32 execution_count = 0;
+
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(logger, job_queue, 4, JobManager::KeepRunningOnEmptyQueue);
+
+        // Jobs scheduled before worker threads are started go to the shared queue.
+        for (size_t i = 0; i < 1000; ++i)
+            job_queue.schedule(new JobNotifyingAboutExecution(&execution_count));
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        // Jobs scheduled afterward are distributed among worker queues.
+        for (size_t i = 0; i < 1000; ++i)
+            job_queue.schedule(new JobNotifyingAboutExecution(&execution_count));
+
+        job_queue.wait_until_completion();
+
+        EXPECT_EQ(2000, execution_count);
+    }
+
+    TEST_CASE(JobManagerWithPinnedThreadsExecutesAllJobs)
+    {
+        volatile uint32 execution_count = 0;
+
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(logger, job_queue, 4, JobManager::PinWorkerThreads);
+
+        for (size_t i = 0; i < 100; ++i)
+            job_queue.schedule(new JobNotifyingAboutExecution(&execution_count));
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        EXPECT_EQ(100, execution_count);
+    }
+
+    TEST_CASE(SetActiveThreadCount_ClampsToThreadCount)
+    {
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(logger, job_queue, 4);
+
+        job_manager.set_active_thread_count(0);
+        EXPECT_EQ(1, job_manager.get_active_thread_count());
+
+        job_manager.set_active_thread_count(8);
+        EXPECT_EQ(4, job_manager.get_active_thread_count());
+    }
+
+    TEST_CASE(JobManagerWithParkedThreadsExecutesAllJobs)
+    {
+        volatile uint32 execution_count = 0;
+
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(logger, job_queue, 4, JobManager::KeepRunningOnEmptyQueue);
+        job_manager.set_active_thread_count(1);
+        job_manager.start();
+
+        for (size_t i = 0; i < 100; ++i)
+            job_queue.schedule(new JobNotifyingAboutExecution(&execution_count));
+
+        job_queue.wait_until_completion();
+
+        // Unpark all worker threads during execution.
+        for (size_t i = 0; i < 100; ++i)
+            job_queue.schedule(new JobNotifyingAboutExecution(&execution_count));
+
+        job_manager.set_active_thread_count(4);
+        job_queue.wait_until_completion();
+
+        EXPECT_EQ(200, execution_count);
+    }
 }
 
 TEST_SUITE(Foundation_Utility_Job_WorkerThread)
@@ -0,0 +1,77 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/json.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <sstream>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Utility_Json)
+{
+    string to_json_string(const string& s)
+    {
+        stringstream sstr;
+        write_json_string(sstr, s);
+        return sstr.str();
+    }
+
+    TEST_CASE(WriteJsonString_GivenPlainString_QuotesString)
+    {
+        EXPECT_EQ("\"hello world\"", to_json_string("hello world"));
+    }
+
+    TEST_CASE(WriteJsonString_GivenEmptyString_WritesEmptyQuotes)
+    {
+        EXPECT_EQ("\"\"", to_json_string(""));
+    }
+
+    TEST_CASE(WriteJsonString_GivenQuotesAndBackslashes_EscapesThem)
+    {
+        EXPECT_EQ("\"a\\\"b\\\\c\"", to_json_string("a\"b\\c"));
+    }
+
+    TEST_CASE(WriteJsonString_GivenControlCharacters_EscapesThem)
+    {
+        EXPECT_EQ("\"\\n\\r\\t\\u0001\"", to_json_string("\n\r\t\x01"));
+    }
+
+    TEST_CASE(WriteJsonString_GivenCString_MatchesStdString)
+    {
+        stringstream sstr;
+        write_json_string(sstr, "a\"b\n");
+
+        EXPECT_EQ(to_json_string("a\"b\n"), sstr.str());
+    }
+}
@@ -444,3 +444,128 @@ TEST_SUITE(Foundation_Math_Knn_Query)
         EXPECT_TRUE(do_results_match_naive_algorithm(points, AnswerSize, QueryCount, rng));
     }
 }
+
+TEST_SUITE(Foundation_Math_Knn_RangeQuery)
+{
+    TEST_CASE(Run_GivenEmptyTree_ReturnsZero)
+    {
+        knn::Tree3d tree;
+        knn::Builder3d builder(tree);
+        builder.build<DefaultWallclockTimer>(0, 0);
+
+        knn::Answer<double> answer(4);
+        knn::RangeQuery3d query(tree, answer);
+
+        EXPECT_EQ(0, query.run(Vector3d(0.0), 1.0));
+        EXPECT_TRUE(answer.empty());
+    }
+
+    TEST_CASE(Run_GivenMoreNeighborsThanAnswerSize_ReturnsTotalCount)
+    {
+        const size_t PointCount = 8;
+
+        Vector3d points[PointCount];
+        for (size_t i = 0; i < PointCount; ++i)
+            points[i] = Vector3d(static_cast<double>(i), 0.0, 0.0);
+
+        knn::Tree3d tree;
+        knn::Builder3d builder(tree);
+        builder.build<DefaultWallclockTimer>(points, PointCount);
+
+        knn::Answer<double> answer(2);
+        knn::RangeQuery3d query(tree, answer);
+
+        EXPECT_EQ(3, query.run(Vector3d(4.0, 0.0, 0.0), square(1.5)));
+        EXPECT_EQ(2, answer.size());
+    }
+
+    TEST_CASE(Run_RandomPoints_ReturnsSamePointsAsNaiveAlgorithm)
+    {
+        const size_t PointCount = 1000;
+        const size_t QueryCount = 200;
+        const double QueryMaxSquareDistance = square(0.15);
+
+        MersenneTwister rng;
+
+        vector<Vector3d> points;
+        for (size_t i = 0; i < PointCount; ++i)
+            points.push_back(rand_vector1<Vector3d>(rng));
+
+        knn::Tree3d tree;
+        knn::Builder3d builder(tree);
+        builder.build<DefaultWallclockTimer>(&points[0], PointCount);
+
+        knn::Answer<double> answer(PointCount);
+        knn::RangeQuery3d query(tree, answer);
+
+        for (size_t i = 0; i < QueryCount; ++i)
+        {
+            const Vector3d q = rand_vector1<Vector3d>(rng);
+
+            vector<size_t> expected;
+            for (size_t j = 0; j < PointCount; ++j)
+            {
+                if (square_distance(points[j], q) <= QueryMaxSquareDistance)
+                    expected.push_back(j);
+            }
+
+            const size_t found_count = query.run(q, QueryMaxSquareDistance);
+            ASSERT_EQ(expected.size(), found_count);
+
+            vector<size_t> found;
+            for (size_t j = 0; j < answer.size(); ++j)
+                found.push_back(tree.remap(answer.get(j).m_index));
+            sort(found.begin(), found.end());
+
+            EXPECT_EQ(expected, found);
+        }
+    }
+}
+
+TEST_SUITE(Foundation_Math_Knn_BatchQuery)
+{
+    TEST_CASE(Run_RandomPoints_ReturnsSameResultsAsSequentialQueries)
+    {
+        const size_t PointCount = 1000;
+        const size_t QueryCount = 1000;
+        const size_t AnswerSize = 10;
+        const double QueryMaxSquareDistance = square(0.1);
+
+        MersenneTwister rng;
+
+        vector<Vector3d> points(PointCount);
+        for (size_t i = 0; i < PointCount; ++i)
+            points[i] = rand_vector1<Vector3d>(rng);
+
+        vector<Vector3d> query_points(QueryCount);
+        for (size_t i = 0; i < QueryCount; ++i)
+            query_points[i] = rand_vector1<Vector3d>(rng);
+
+        knn::Tree3d tree;
+        knn::Builder3d builder(tree);
+        builder.build<DefaultWallclockTimer>(&points[0], PointCount);
+
+        knn::BatchQuery3d batch_query(tree, AnswerSize);
+        batch_query.run(&query_points[0], QueryCount, QueryMaxSquareDistance, 4);
+
+        knn::Answer<double> answer(AnswerSize);
+        knn::Query3d query(tree, answer);
+
+        for (size_t i = 0; i < QueryCount; ++i)
+        {
+            query.run(query_points[i], QueryMaxSquareDistance);
+            ASSERT_EQ(answer.size(), batch_query.get_answer_size(i));
+
+            vector<size_t> expected, found;
+            for (size_t j = 0; j < answer.size(); ++j)
+            {
+                expected.push_back(answer.get(j).m_index);
+                found.push_back(batch_query.get_answer_entry(i, j).m_index);
+            }
+            sort(expected.begin(), expected.end());
+            sort(found.begin(), found.end());
+
+            EXPECT_EQ(expected, found);
+        }
+    }
+}
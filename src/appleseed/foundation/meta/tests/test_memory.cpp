@@ -160,6 +160,94 @@ TEST_SUITE(Foundation_Utility_Memory)
 
 #endif
 
+    uint8* huge_page_malloc_with_mode(const HugePageMode mode, const size_t size)
+    {
+        const HugePageMode previous_mode = get_huge_page_mode();
+        set_huge_page_mode(mode);
+
+        uint8* p = static_cast<uint8*>(huge_page_malloc(size, 64));
+
+        set_huge_page_mode(previous_mode);
+
+        return p;
+    }
+
+    // Write the first and last bytes of a block and check that they read back.
+    bool is_writable_block(uint8* p, const size_t size)
+    {
+        p[0] = 1;
+        p[size - 1] = 2;
+        return p[0] == 1 && p[size - 1] == 2;
+    }
+
+    TEST_CASE(HugePageMalloc_GivenSmallSize_ReturnsAlignedWritableBlock)
+    {
+        const size_t Size = 100;
+        uint8* p = huge_page_malloc_with_mode(HugePagesExplicit, Size);
+
+        ASSERT_TRUE(p != 0);
+        EXPECT_TRUE(is_aligned(p, 64));
+        EXPECT_TRUE(is_writable_block(p, Size));
+
+        huge_page_free(p);
+    }
+
+    TEST_CASE(HugePageMalloc_WithHugePagesDisabled_ReturnsAlignedWritableBlock)
+    {
+        const size_t Size = 3 * HugePageMinAllocationSize;
+        uint8* p = huge_page_malloc_with_mode(HugePagesDisabled, Size);
+
+        ASSERT_TRUE(p != 0);
+        EXPECT_TRUE(is_aligned(p, 64));
+        EXPECT_TRUE(is_writable_block(p, Size));
+
+        huge_page_free(p);
+    }
+
+    TEST_CASE(HugePageMalloc_WithTransparentHugePages_ReturnsAlignedWritableBlock)
+    {
+        const size_t Size = 3 * HugePageMinAllocationSize;
+        uint8* p = huge_page_malloc_with_mode(HugePagesTransparent, Size);
+
+        ASSERT_TRUE(p != 0);
+        EXPECT_TRUE(is_aligned(p, 64));
+        EXPECT_TRUE(is_writable_block(p, Size));
+
+        huge_page_free(p);
+    }
+
+    TEST_CASE(HugePageMalloc_WithExplicitHugePages_ReturnsAlignedWritableBlock)
+    {
+        // Falls back to transparent or regular pages if no huge pages are reserved.
+        const size_t Size = 3 * HugePageMinAllocationSize;
+        uint8* p = huge_page_malloc_with_mode(HugePagesExplicit, Size);
+
+        ASSERT_TRUE(p != 0);
+        EXPECT_TRUE(is_aligned(p, 64));
+        EXPECT_TRUE(is_writable_block(p, Size));
+
+        huge_page_free(p);
+    }
+
+    TEST_CASE(AlignedAllocator_GivenLargeArray_ReturnsAlignedArray)
+    {
+        const HugePageMode previous_mode = get_huge_page_mode();
+        set_huge_page_mode(HugePagesTransparent);
+
+        AlignedAllocator<int> allocator(32);
+        const size_t n = HugePageMinAllocationSize / sizeof(int) + 1;
+        int* p = allocator.allocate(n);
+
+        set_huge_page_mode(previous_mode);
+
+        EXPECT_TRUE(is_aligned(p, 32));
+
+        p[n - 1] = 42;
+        EXPECT_EQ(42, p[n - 1]);
+
+        allocator.deallocate(p, n);
+    }
+
     TEST_CASE(EnsureMinimumSize_GivenEmptyVector_ResizesVectorByInsertingDefaultValue)
     {
         vector<int> v;
@@ -0,0 +1,89 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/memoryaccounting.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Utility_MemoryAccounting)
+{
+    TEST_CASE(MemoryAccount_SetSize_UpdatesTagAndTotalSizes)
+    {
+        const size_t initial_size = get_accounted_memory_size(MemoryTagPhotons);
+        const size_t initial_total_size = get_total_accounted_memory_size();
+
+        MemoryAccount account(MemoryTagPhotons);
+        account.set_size(1000);
+
+        EXPECT_EQ(initial_size + 1000, get_accounted_memory_size(MemoryTagPhotons));
+        EXPECT_EQ(initial_total_size + 1000, get_total_accounted_memory_size());
+
+        account.set_size(400);
+
+        EXPECT_EQ(initial_size + 400, get_accounted_memory_size(MemoryTagPhotons));
+        EXPECT_EQ(initial_total_size + 400, get_total_accounted_memory_size());
+    }
+
+    TEST_CASE(MemoryAccount_Destructor_ReleasesAccountedMemory)
+    {
+        const size_t initial_size = get_accounted_memory_size(MemoryTagOSL);
+
+        {
+            MemoryAccount account(MemoryTagOSL);
+            account.grow(123);
+            account.grow(77);
+            EXPECT_EQ(200, account.get_size());
+        }
+
+        EXPECT_EQ(initial_size, get_accounted_memory_size(MemoryTagOSL));
+    }
+
+    TEST_CASE(GetPeakAccountedMemorySize_ReturnsHighWaterMarkSinceReset)
+    {
+        reset_peak_accounted_memory_sizes();
+
+        const size_t initial_size = get_accounted_memory_size(MemoryTagGeometry);
+
+        MemoryAccount account(MemoryTagGeometry);
+        account.set_size(5000);
+        account.set_size(10);
+
+        EXPECT_EQ(initial_size + 10, get_accounted_memory_size(MemoryTagGeometry));
+        EXPECT_EQ(initial_size + 5000, get_peak_accounted_memory_size(MemoryTagGeometry));
+
+        reset_peak_accounted_memory_sizes();
+
+        EXPECT_EQ(initial_size + 10, get_peak_accounted_memory_size(MemoryTagGeometry));
+    }
+}
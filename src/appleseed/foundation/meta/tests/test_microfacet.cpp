@@ -331,6 +331,31 @@ TEST_SUITE(Foundation_Math_Microfacet)
         EXPECT_WEAK_WHITE_FURNACE_PASS(result)
     }
 
+    TEST_CASE(GGXMDF_AlbedoTable_GivenSmoothSurface_ReturnsOne)
+    {
+        const MDFAlbedoTable& table = get_ggx_albedo_table();
+
+        EXPECT_FEQ_EPS(1.0f, table.get_directional_albedo(0.5f, 0.001f), 1.0e-2f);
+        EXPECT_FEQ_EPS(1.0f, table.get_average_albedo(0.001f), 1.0e-2f);
+    }
+
+    TEST_CASE(GGXMDF_AlbedoTable_GivenRoughSurface_ReturnsIntegratedAlbedo)
+    {
+        const MDFAlbedoTable& table = get_ggx_albedo_table();
+
+        // Reference values obtained by brute force integration over the hemisphere.
+        EXPECT_FEQ_EPS(0.698f, table.get_directional_albedo(0.5f, 0.5f), 1.0e-2f);
+        EXPECT_FEQ_EPS(0.307f, table.get_directional_albedo(1.0f, 1.0f), 1.0e-2f);
+    }
+
+    TEST_CASE(GGXMDF_AlbedoTable_AverageAlbedoDecreasesWithRoughness)
+    {
+        const MDFAlbedoTable& table = get_ggx_albedo_table();
+
+        EXPECT_GT(table.get_average_albedo(0.5f), table.get_average_albedo(0.25f));
+        EXPECT_GT(table.get_average_albedo(1.0f), table.get_average_albedo(0.5f));
+    }
+
 
     //
     // Ward MDF.
@@ -36,6 +36,7 @@
 
 // Standard headers.
 #include <cstddef>
+#include <cstdio>
 #include <string>
 #include <vector>
 
@@ -44,7 +45,11 @@ using namespace std;
 
 TEST_SUITE(Foundation_Mesh_OBJMeshFileReader)
 {
-    struct Face {};
+    struct Face
+    {
+        vector<size_t>      m_vertices;
+        size_t              m_material;
+    };
 
     struct Mesh
     {
@@ -87,9 +92,100 @@ TEST_SUITE(Foundation_Mesh_OBJMeshFileReader)
         virtual void begin_face(const size_t vertex_count) APPLESEED_OVERRIDE
         {
             m_meshes.back().m_faces.push_back(Face());
+            m_meshes.back().m_faces.back().m_vertices.resize(vertex_count);
+        }
+
+        virtual void set_face_vertices(const size_t vertices[]) APPLESEED_OVERRIDE
+        {
+            Face& face = m_meshes.back().m_faces.back();
+            for (size_t i = 0; i < face.m_vertices.size(); ++i)
+                face.m_vertices[i] = vertices[i];
+        }
+
+        virtual void set_face_material(const size_t material) APPLESEED_OVERRIDE
+        {
+            m_meshes.back().m_faces.back().m_material = material;
         }
     };
 
+    bool are_equal(const Mesh& lhs, const Mesh& rhs)
+    {
+        if (lhs.m_name != rhs.m_name ||
+            lhs.m_vertices != rhs.m_vertices ||
+            lhs.m_vertex_normals != rhs.m_vertex_normals ||
+            lhs.m_tex_coords != rhs.m_tex_coords ||
+            lhs.m_faces.size() != rhs.m_faces.size())
+            return false;
+
+        for (size_t i = 0; i < lhs.m_faces.size(); ++i)
+        {
+            if (lhs.m_faces[i].m_vertices != rhs.m_faces[i].m_vertices ||
+                lhs.m_faces[i].m_material != rhs.m_faces[i].m_material)
+                return false;
+        }
+
+        return true;
+    }
+
+    // Write a file of several megabytes made of grids of quads, using both
+    // absolute and relative indices.
+    bool write_large_mesh_file(const char* filename)
+    {
+        FILE* file = fopen(filename, "wt");
+        if (file == 0)
+            return false;
+
+        const size_t GridCount = 4;
+        const size_t GridSize = 150;
+
+        size_t first_vertex = 1;
+
+        for (size_t g = 0; g < GridCount; ++g)
+        {
+            fprintf(file, "o grid%d\n", static_cast<int>(g));
+
+            for (size_t y = 0; y <= GridSize; ++y)
+            {
+                for (size_t x = 0; x <= GridSize; ++x)
+                {
+                    fprintf(file, "v %d %d %d\n", static_cast<int>(x), static_cast<int>(y), static_cast<int>(g));
+                    fprintf(file, "vt %f %f\n", static_cast<double>(x) / GridSize, static_cast<double>(y) / GridSize);
+                }
+            }
+
+            const size_t vertex_count = (GridSize + 1) * (GridSize + 1);
+
+            for (size_t y = 0; y < GridSize; ++y)
+            {
+                fprintf(file, "usemtl material%d\n", static_cast<int>(y % 3));
+
+                for (size_t x = 0; x < GridSize; ++x)
+                {
+                    const size_t v0 = y * (GridSize + 1) + x;
+                    const size_t quad[4] = { v0, v0 + 1, v0 + GridSize + 2, v0 + GridSize + 1 };
+
+                    fprintf(file, "f");
+
+                    for (size_t i = 0; i < 4; ++i)
+                    {
+                        const int index =
+                            g % 2 == 0
+                                ? static_cast<int>(first_vertex + quad[i])
+                                : static_cast<int>(quad[i]) - static_cast<int>(vertex_count);
+                        fprintf(file, " %d/%d", index, index);
+                    }
+
+                    fprintf(file, "\n");
+                }
+            }
+
+            first_vertex += vertex_count;
+        }
+
+        fclose(file);
+        return true;
+    }
+
     TEST_CASE(ReadCubeMeshFile)
     {
         OBJMeshFileReader reader("unit tests/inputs/test_objmeshfilereader_cube.obj");
@@ -121,4 +217,24 @@ TEST_SUITE(Foundation_Mesh_OBJMeshFileReader)
         EXPECT_EQ(4, mesh.m_tex_coords.size());
         EXPECT_EQ(1, mesh.m_faces.size());
     }
+
+    TEST_CASE(ReadLargeMeshFileInParallel)
+    {
+        const char* Filename = "unit tests/outputs/test_objmeshfilereader_large.obj";
+        ASSERT_TRUE(write_large_mesh_file(Filename));
+
+        OBJMeshFileReader serial_reader(Filename);
+        MeshBuilder serial_builder;
+        serial_reader.read(serial_builder);
+
+        OBJMeshFileReader parallel_reader(Filename, OBJMeshFileReader::ParseInParallel);
+        MeshBuilder parallel_builder;
+        parallel_reader.read(parallel_builder);
+
+        ASSERT_EQ(4, serial_builder.m_meshes.size());
+        ASSERT_EQ(serial_builder.m_meshes.size(), parallel_builder.m_meshes.size());
+
+        for (size_t i = 0; i < serial_builder.m_meshes.size(); ++i)
+            EXPECT_TRUE(are_equal(serial_builder.m_meshes[i], parallel_builder.m_meshes[i]));
+    }
 }
@@ -0,0 +1,75 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2015-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/octahedral.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Math_Octahedral)
+{
+    TEST_CASE(EncodeDecode_GivenAxes_ReturnsAxes)
+    {
+        const Vector3f Axes[] =
+        {
+            Vector3f( 1.0f,  0.0f,  0.0f),
+            Vector3f(-1.0f,  0.0f,  0.0f),
+            Vector3f( 0.0f,  1.0f,  0.0f),
+            Vector3f( 0.0f, -1.0f,  0.0f),
+            Vector3f( 0.0f,  0.0f,  1.0f),
+            Vector3f( 0.0f,  0.0f, -1.0f)
+        };
+
+        for (size_t i = 0; i < 6; ++i)
+            EXPECT_FEQ(Axes[i], decode_octahedral<float>(encode_octahedral(Axes[i])));
+    }
+
+    TEST_CASE(EncodeDecode_GivenRandomUnitVectors_ReturnsCloseUnitVectors)
+    {
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            Vector2d s;
+            s[0] = rand_double2(rng);
+            s[1] = rand_double2(rng);
+
+            const Vector3d v = sample_sphere_uniform(s);
+            const Vector3d decoded = decode_octahedral<double>(encode_octahedral(v));
+
+            EXPECT_FEQ_EPS(1.0, norm(decoded), 1.0e-9);
+            EXPECT_LT(1.0e-4, norm(decoded - v));
+        }
+    }
+}
@@ -0,0 +1,93 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/genericprogressiveimagefilereader.h"
+#include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/pngimagefilewriter.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Image_PNGImageFileWriter)
+{
+    static const char* Filename = "unit tests/outputs/test_pngimagefilewriter.png";
+
+    Color4b make_color(const size_t x, const size_t y)
+    {
+        return Color4b(
+            static_cast<uint8>(x * 4),
+            static_cast<uint8>(y * 4),
+            static_cast<uint8>((x * 7 + y * 13) % 256),
+            static_cast<uint8>(255 - x - y));
+    }
+
+    TEST_CASE(CorrectlyWriteImageCompressedInParallel)
+    {
+        // Several rows of tiles, the last one partial, to exercise stitching of compressed rows.
+        const size_t Width = 40;
+        const size_t Height = 50;
+
+        Image image(Width, Height, 16, 16, 4, PixelFormatUInt8);
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+                image.set_pixel(x, y, make_color(x, y));
+        }
+
+        PNGImageFileWriter writer(3);
+        writer.write(Filename, image);
+
+        GenericProgressiveImageFileReader reader;
+        reader.open(Filename);
+        auto_ptr<Tile> tile(reader.read_tile(0, 0));
+
+        ASSERT_EQ(Width, tile->get_width());
+        ASSERT_EQ(Height, tile->get_height());
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                Color4b c;
+                tile->get_pixel(x, y, c);
+                EXPECT_EQ(make_color(x, y), c);
+            }
+        }
+    }
+}
@@ -0,0 +1,93 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/genericprogressiveimagefilereader.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/progressiveexrimagefilewriter.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Image_ProgressiveEXRImageFileWriter)
+{
+    static const char* Filename = "unit tests/outputs/test_progressiveexrimagefilewriter.exr";
+    static const Color4f Reference(0.25f, 0.5f, 0.75f, 1.0f);
+
+    TEST_CASE(WriteTilesInReverseOrder_SkippingOne_WritesCompleteImage)
+    {
+        // 2x2 tiles, the last row and column of tiles being partial.
+        const CanvasProperties props(6, 6, 4, 4, 4, PixelFormatFloat);
+
+        {
+            ProgressiveEXRImageFileWriter writer;
+            writer.open(Filename, props);
+
+            for (size_t i = props.m_tile_count - 1; i > 0; --i)
+            {
+                const size_t tile_x = i % props.m_tile_count_x;
+                const size_t tile_y = i / props.m_tile_count_x;
+
+                Tile tile(
+                    props.get_tile_width(tile_x),
+                    props.get_tile_height(tile_y),
+                    props.m_channel_count,
+                    props.m_pixel_format);
+                tile.clear(Reference);
+
+                writer.write_tile(tile, tile_x, tile_y);
+            }
+
+            // Tile (0, 0) is never written.
+            writer.close();
+        }
+
+        GenericProgressiveImageFileReader reader;
+        reader.open(Filename);
+
+        auto_ptr<Tile> first_tile(reader.read_tile(0, 0));
+        auto_ptr<Tile> last_tile(reader.read_tile(1, 1));
+
+        Color4f c;
+        first_tile->get_pixel(0, c);
+        EXPECT_EQ(Color4f(0.0f), c);
+        last_tile->get_pixel(0, c);
+        EXPECT_EQ(Reference, c);
+    }
+}
@@ -41,6 +41,7 @@
 #include "foundation/math/vector.h"
 #include "foundation/platform/arch.h"
 #include "foundation/utility/gnuplotfile.h"
+#include "foundation/utility/iostreamop.h"
 #include "foundation/utility/string.h"
 #include "foundation/utility/test.h"
 #include "foundation/utility/testutils.h"
@@ -360,6 +361,61 @@ TEST_SUITE(Foundation_Math_QMC)
             points);
     }
 
+    TEST_CASE(SobolUInt32_FirstDimension_IsRadicalInverseBase2)
+    {
+        for (uint32 i = 0; i < 1000; ++i)
+            EXPECT_EQ(reverse_bits(i), sobol_uint32(0, i));
+    }
+
+    TEST_CASE(SobolUInt32_SecondDimension_MatchesReferenceValues)
+    {
+        static const double Expected[] = { 0.0, 0.5, 0.75, 0.25, 0.625, 0.125, 0.375, 0.875 };
+
+        for (uint32 i = 0; i < 8; ++i)
+            EXPECT_EQ(Expected[i], sobol_uint32(1, i) / 4294967296.0);
+    }
+
+    TEST_CASE(OwenScrambledSobolSequence_FirstPowerOfTwoPoints_AreStratifiedInEachDimension)
+    {
+        const size_t N = 256;
+
+        vector<size_t> counts(4 * N, 0);
+
+        for (uint32 i = 0; i < N; ++i)
+        {
+            const Vector4d p = owen_scrambled_sobol_sequence<double, 4>(0xDEADBEEFUL, i);
+
+            for (size_t d = 0; d < 4; ++d)
+            {
+                ASSERT_TRUE(p[d] >= 0.0 && p[d] < 1.0);
+                ++counts[d * N + static_cast<size_t>(p[d] * N)];
+            }
+        }
+
+        for (size_t i = 0; i < counts.size(); ++i)
+            EXPECT_EQ(1, counts[i]);
+    }
+
+    TEST_CASE(OwenScrambledSobolSequence_DifferentSeeds_GiveDifferentPoints)
+    {
+        const Vector2d p = owen_scrambled_sobol_sequence<double, 2>(1, 0);
+        const Vector2d q = owen_scrambled_sobol_sequence<double, 2>(2, 0);
+
+        EXPECT_NEQ(p, q);
+    }
+
+    TEST_CASE(Generate2DOwenScrambledSobolSequenceImage)
+    {
+        vector<Vector2d> points;
+
+        for (size_t i = 0; i < PointCount; ++i)
+            points.push_back(owen_scrambled_sobol_sequence<double, 2>(0, static_cast<uint32>(i)));
+
+        write_point_cloud_image(
+            "unit tests/outputs/test_qmc_owen_scrambled_sobol.png",
+            points);
+    }
+
     TEST_CASE(SampleImagePlaneWithHaltonSequence)
     {
         //
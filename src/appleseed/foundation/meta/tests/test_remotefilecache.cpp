@@ -0,0 +1,64 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/remotefilecache.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Utility_RemoteFileCache)
+{
+    const char* Directory = "unit tests/outputs/test_remotefilecache/";
+
+    TEST_CASE(IsUrl_GivenHttpUrl_ReturnsTrue)
+    {
+        EXPECT_TRUE(RemoteFileCache::is_url("http://assets.example.com/textures/wood.exr"));
+    }
+
+    TEST_CASE(IsUrl_GivenFilePath_ReturnsFalse)
+    {
+        EXPECT_FALSE(RemoteFileCache::is_url("/textures/wood.exr"));
+        EXPECT_FALSE(RemoteFileCache::is_url("textures/wood.exr"));
+    }
+
+    TEST_CASE(Fetch_GivenFilePath_ReturnsEmptyString)
+    {
+        const RemoteFileCache cache(Directory);
+
+        EXPECT_EQ("", cache.fetch("textures/wood.exr"));
+    }
+
+    TEST_CASE(Fetch_GivenUnreachableServer_ReturnsEmptyString)
+    {
+        const RemoteFileCache cache(Directory);
+
+        EXPECT_EQ("", cache.fetch("http://127.0.0.1:1/textures/wood.exr"));
+    }
+}
@@ -560,6 +560,46 @@ TEST_SUITE(Foundation_Math_RNG_PCG)
         for (size_t i = 0; i < 1000; ++i)
             EXPECT_EQ(Expected[i], rng.rand_uint32());
     }
+
+    TEST_CASE(Advance_MatchesRepeatedStepping)
+    {
+        PCG expected(42, 7);
+        PCG rng(42, 7);
+
+        for (size_t i = 0; i < 1237; ++i)
+            expected.rand_uint32();
+
+        rng.advance(1237);
+
+        for (size_t i = 0; i < 10; ++i)
+            EXPECT_EQ(expected.rand_uint32(), rng.rand_uint32());
+    }
+
+    TEST_CASE(Advance_WrappingAroundStepsBackward)
+    {
+        PCG rng(42, 7);
+        const uint32 first = rng.rand_uint32();
+
+        rng.advance(~uint64(0));
+
+        EXPECT_EQ(first, rng.rand_uint32());
+    }
+
+    TEST_CASE(DistinctStreamsProduceDistinctSequences)
+    {
+        PCG rng1(42, 1);
+        PCG rng2(42, 2);
+
+        size_t matches = 0;
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            if (rng1.rand_uint32() == rng2.rand_uint32())
+                ++matches;
+        }
+
+        EXPECT_EQ(0, matches);
+    }
 }
 
 TEST_SUITE(Foundation_Math_RNG_SerialMersenneTwister)
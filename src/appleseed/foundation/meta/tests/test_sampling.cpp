@@ -28,6 +28,7 @@
 //
 
 // appleseed.foundation headers.
+#include "foundation/math/bluenoise.h"
 #include "foundation/math/fp.h"
 #include "foundation/math/qmc.h"
 #include "foundation/math/rng/mersennetwister.h"
@@ -108,6 +109,39 @@ TEST_SUITE(Foundation_Math_Sampling_QMCSamplingContext)
         EXPECT_EQ(4, child_child_context.m_dimension);
         EXPECT_EQ(0, child_child_context.m_instance);
     }
+
+    TEST_CASE(TestSplittingZeroDimensionalContext)
+    {
+        RNG rng;
+        SamplingContext context(rng, SamplingContext::QMCMode, 0, 0, 7);
+        SamplingContext child_context = context.split(2, 0);
+
+        EXPECT_EQ(0, child_context.m_base_dimension);
+        EXPECT_EQ(7, child_context.m_base_instance);
+        EXPECT_EQ(2, child_context.m_dimension);
+        EXPECT_EQ(0, child_context.m_instance);
+        EXPECT_NEQ(SamplingContext::VectorType(0.0), child_context.m_offset);
+
+        child_context.next2<Vector2d>();
+        SamplingContext child_child_context = child_context.split(3, 16);
+
+        EXPECT_EQ(2, child_child_context.m_base_dimension);
+        EXPECT_EQ(8, child_child_context.m_base_instance);
+    }
+
+    TEST_CASE(TestDitheringIsInheritedBySplitting)
+    {
+        RNG rng;
+        SamplingContext context(rng, SamplingContext::SobolMode, 0, 0, 7);
+        context.set_dither_pixel(3, 5);
+        SamplingContext child_context = context.split(2, 0);
+        SamplingContext child_child_context = child_context.split(3, 16);
+
+        EXPECT_TRUE(child_child_context.m_dither);
+        EXPECT_EQ(3, child_child_context.m_dither_x);
+        EXPECT_EQ(5, child_child_context.m_dither_y);
+        EXPECT_EQ(blue_noise_dither<double>(3, 5, 2), child_child_context.m_offset[0]);
+    }
 }
 
 TEST_SUITE(Foundation_Math_Sampling_QMCSamplingContext_DirectIlluminationSimulation)
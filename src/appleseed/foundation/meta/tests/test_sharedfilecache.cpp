@@ -0,0 +1,102 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+#include "foundation/utility/sharedfilecache.h"
+#include "foundation/utility/test.h"
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+
+// Standard headers.
+#include <cstring>
+#include <memory>
+
+using namespace foundation;
+using namespace std;
+namespace bf = boost::filesystem;
+
+TEST_SUITE(Foundation_Utility_SharedFileCache)
+{
+    const char* Directory = "unit tests/outputs/test_sharedfilecache/";
+
+    // Start and end each test with an empty cache so that files published by one
+    // test (or by a previous run) are never seen by another.
+    struct Fixture
+    {
+        Fixture()
+        {
+            bf::remove_all(Directory);
+        }
+
+        ~Fixture()
+        {
+            bf::remove_all(Directory);
+        }
+    };
+
+    TEST_CASE_F(Acquire_GivenUnknownKey_ReturnsNull, Fixture)
+    {
+        const SharedFileCache cache(Directory);
+
+        const auto_ptr<SharedFileView> view(cache.acquire(0xDEADBEEFDEADBEEFULL));
+
+        EXPECT_EQ(0, view.get());
+    }
+
+    TEST_CASE_F(Acquire_GivenPublishedKey_ReturnsPublishedData, Fixture)
+    {
+        const SharedFileCache cache(Directory);
+        const char Data[] = "shared file cache";
+
+        const bool published = cache.publish(42, Data, sizeof(Data));
+        const auto_ptr<SharedFileView> view(cache.acquire(42));
+
+        ASSERT_TRUE(published);
+        ASSERT_NEQ(0, view.get());
+        ASSERT_EQ(sizeof(Data), view->get_size());
+        EXPECT_EQ(0, memcmp(Data, view->get_data(), sizeof(Data)));
+    }
+
+    TEST_CASE_F(Publish_GivenKeyAlreadyPublished_KeepsExistingData, Fixture)
+    {
+        const SharedFileCache cache(Directory);
+        const uint32 Data1 = 1;
+        const uint32 Data2 = 2;
+
+        cache.publish(7, &Data1, sizeof(Data1));
+        cache.publish(7, &Data2, sizeof(Data2));
+        const auto_ptr<SharedFileView> view(cache.acquire(7));
+
+        ASSERT_NEQ(0, view.get());
+        EXPECT_EQ(Data1, *static_cast<const uint32*>(view->get_data()));
+    }
+}
@@ -0,0 +1,131 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/sparsevoxelgrid.h"
+#include "foundation/math/vector.h"
+#include "foundation/math/voxelgrid.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_SparseVoxelGrid3)
+{
+    TEST_CASE(Constructor_AllocatesNoBrick)
+    {
+        SparseVoxelGrid3<float, double> grid(100, 100, 100, 4);
+
+        EXPECT_EQ(0, grid.get_brick_count());
+        EXPECT_TRUE(grid.is_empty(Vector3d(0.5)));
+    }
+
+    TEST_CASE(Voxel_GivenVoxelOfUnallocatedBrick_ReturnsZeroes)
+    {
+        const SparseVoxelGrid3<float, double> grid(20, 20, 20, 2);
+
+        const float* values = grid.voxel(10, 10, 10);
+
+        EXPECT_EQ(0.0f, values[0]);
+        EXPECT_EQ(0.0f, values[1]);
+    }
+
+    TEST_CASE(Voxel_WritingOneVoxel_AllocatesOneBrick)
+    {
+        SparseVoxelGrid3<float, double> grid(20, 20, 20, 1);
+
+        grid.voxel(9, 10, 11)[0] = 1.0f;
+        grid.voxel(10, 11, 12)[0] = 2.0f;
+
+        EXPECT_EQ(1, grid.get_brick_count());
+        EXPECT_FALSE(grid.is_empty(Vector3d(0.5)));
+        EXPECT_TRUE(grid.is_empty(Vector3d(0.0)));
+
+        const SparseVoxelGrid3<float, double>& const_grid = grid;
+        EXPECT_EQ(1.0f, const_grid.voxel(9, 10, 11)[0]);
+        EXPECT_EQ(2.0f, const_grid.voxel(10, 11, 12)[0]);
+    }
+
+    TEST_CASE(Lookups_ReturnSameValuesAsDenseGrid)
+    {
+        // An odd channel count exercises both the SIMD and the scalar blending code paths.
+        const size_t Res = 21;
+        const size_t ChannelCount = 5;
+
+        VoxelGrid3<float, double> dense_grid(Res, Res, Res, ChannelCount);
+        SparseVoxelGrid3<float, double> sparse_grid(Res, Res, Res, ChannelCount);
+
+        MersenneTwister rng;
+
+        // Only fill a corner of the domain.
+        for (size_t z = 4; z < 13; ++z)
+        {
+            for (size_t y = 0; y < 9; ++y)
+            {
+                for (size_t x = 6; x < Res; ++x)
+                {
+                    for (size_t c = 0; c < ChannelCount; ++c)
+                    {
+                        const float value = rand_float1(rng);
+                        dense_grid.voxel(x, y, z)[c] = value;
+                        sparse_grid.voxel(x, y, z)[c] = value;
+                    }
+                }
+            }
+        }
+
+        EXPECT_EQ(12, sparse_grid.get_brick_count());
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const Vector3d point = rand_vector1<Vector3d>(rng);
+
+            float dense_values[ChannelCount];
+            float sparse_values[ChannelCount];
+
+            dense_grid.nearest_lookup(point, dense_values);
+            sparse_grid.nearest_lookup(point, sparse_values);
+
+            for (size_t c = 0; c < ChannelCount; ++c)
+                EXPECT_EQ(dense_values[c], sparse_values[c]);
+
+            dense_grid.linear_lookup(point, dense_values);
+            sparse_grid.linear_lookup(point, sparse_values);
+
+            for (size_t c = 0; c < ChannelCount; ++c)
+                EXPECT_FEQ(dense_values[c], sparse_values[c]);
+        }
+    }
+}
@@ -35,6 +35,7 @@
 
 // Standard headers.
 #include <cstddef>
+#include <sstream>
 #include <string>
 
 using namespace foundation;
@@ -185,6 +186,70 @@ TEST_SUITE(Foundation_Utility_Statistics)
 
         EXPECT_EQ("  existing value   17,042", stats.to_string());
     }
+
+    TEST_CASE(InsertSize_FormatsValueForDisplay)
+    {
+        Statistics stats;
+
+        stats.insert_size("some size", 3 * 1024 * 1024);
+
+        EXPECT_EQ("  some size        3.0 MB", stats.to_string());
+    }
+
+    TEST_CASE(WriteJson_GivenEmptyStatistics_WritesEmptyObject)
+    {
+        Statistics stats;
+
+        stringstream sstr;
+        stats.write_json(sstr);
+
+        EXPECT_EQ("{}", sstr.str());
+    }
+
+    TEST_CASE(WriteJson_WritesRawValues)
+    {
+        Statistics stats;
+        stats.insert<uint64>("count", 17000);
+        stats.insert("ratio", 0.25);
+        stats.insert<string>("name", "\"bunny\"");
+        stats.insert_size("size", 2048);
+        stats.insert_time("time", 90.5);
+        stats.insert_percent<uint64>("hits", 1, 4);
+        stats.insert_percent<uint64>("misses", 0, 0);
+
+        stringstream sstr;
+        stats.write_json(sstr);
+
+        EXPECT_EQ(
+            "{\n"
+            "  \"count\": 17000,\n"
+            "  \"ratio\": 0.25,\n"
+            "  \"name\": \"\\\"bunny\\\"\",\n"
+            "  \"size\": 2048,\n"
+            "  \"time\": 90.5,\n"
+            "  \"hits\": 25,\n"
+            "  \"misses\": null\n"
+            "}",
+            sstr.str());
+    }
+
+    TEST_CASE(WriteJson_GivenPopulationStatistic_WritesObject)
+    {
+        Statistics stats;
+
+        Population<size_t> pop;
+        pop.insert(1);
+        pop.insert(3);
+
+        stats.insert("some value", pop);
+
+        stringstream sstr;
+        stats.write_json(sstr);
+
+        EXPECT_EQ(
+            "{\n  \"some value\": { \"size\": 2, \"min\": 1, \"max\": 3, \"mean\": 2, \"dev\": 1 }\n}",
+            sstr.str());
+    }
 }
 
 TEST_SUITE(Foundation_Utility_StatisticsVector)
@@ -203,4 +268,54 @@ TEST_SUITE(Foundation_Utility_StatisticsVector)
 
         EXPECT_EQ("stats 1:\n  counter 1        17\nstats 2:\n  counter 2        42", vec.to_string());
     }
+
+    TEST_CASE(Update_ReplacesCollectionsWithSameName)
+    {
+        Statistics old_stats;
+        old_stats.insert<uint64>("counter", 17);
+
+        Statistics new_stats;
+        new_stats.insert<uint64>("counter", 42);
+
+        Statistics other_stats;
+        other_stats.insert<uint64>("counter", 7);
+
+        StatisticsVector vec;
+        vec.insert("stats", old_stats);
+
+        StatisticsVector update;
+        update.insert("stats", new_stats);
+        update.insert("other stats", other_stats);
+
+        vec.update(update);
+
+        EXPECT_EQ("stats:\n  counter          42\nother stats:\n  counter          7", vec.to_string());
+    }
+
+    TEST_CASE(WriteJson_GivenTwoItems)
+    {
+        Statistics stats1;
+        stats1.insert<uint64>("counter 1", 17);
+
+        Statistics stats2;
+        stats2.insert<uint64>("counter 2", 42);
+
+        StatisticsVector vec;
+        vec.insert("stats 1", stats1);
+        vec.insert("stats 2", stats2);
+
+        stringstream sstr;
+        vec.write_json(sstr);
+
+        EXPECT_EQ(
+            "{\n"
+            "  \"stats 1\": {\n"
+            "    \"counter 1\": 17\n"
+            "  },\n"
+            "  \"stats 2\": {\n"
+            "    \"counter 2\": 42\n"
+            "  }\n"
+            "}",
+            sstr.str());
+    }
 }
@@ -305,6 +305,45 @@ TEST_SUITE(Foundation_Utility_String)
         });
     }
 
+    TEST_CASE(FromString_GivenIntegerOutOfRange_ThrowsExceptionStringConversionError)
+    {
+        EXPECT_EXCEPTION(ExceptionStringConversionError,
+        {
+            from_string<int32>("2147483648");
+        });
+    }
+
+    TEST_CASE(FromString_GivenExtremeIntegers_ReturnsCorrespondingValues)
+    {
+        EXPECT_EQ(-2147483647 - 1, from_string<int32>("-2147483648"));
+        EXPECT_EQ(4294967295u, from_string<uint32>("4294967295"));
+        EXPECT_EQ(18446744073709551615ull, from_string<uint64>("18446744073709551615"));
+    }
+
+    TEST_CASE(FromString_GivenStrings_ReturnsCorrespondingDoubleValues)
+    {
+        EXPECT_EQ(0.0, from_string<double>("0"));
+        EXPECT_EQ(0.1, from_string<double>("0.1"));
+        EXPECT_EQ(-2.5e-3, from_string<double>("-2.5e-3"));
+        EXPECT_EQ(1.0e23, from_string<double>("1e23"));
+        EXPECT_EQ(3.14159265358979323846, from_string<double>("3.14159265358979323846"));
+    }
+
+    TEST_CASE(FromString_GivenStrings_ReturnsCorrespondingFloatValues)
+    {
+        EXPECT_EQ(0.1f, from_string<float>("0.1"));
+        EXPECT_EQ(-1.5e10f, from_string<float>("-1.5e10"));
+        EXPECT_EQ(1.0f, from_string<float>("1.000000059604644775390625"));
+    }
+
+    TEST_CASE(FromString_GivenDoubleFollowedBySpace_ThrowsExceptionStringConversionError)
+    {
+        EXPECT_EXCEPTION(ExceptionStringConversionError,
+        {
+            from_string<double>("1.5 ");
+        });
+    }
+
     TEST_CASE(StrcmpNoCaseHandlesEmptyString)
     {
         EXPECT_EQ(0, strcmp_nocase("", ""));
@@ -0,0 +1,146 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/texturefilereader.h"
+#include "foundation/image/texturefilewriter.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Image_TextureFile)
+{
+    struct Fixture
+    {
+        Image m_image;
+
+        Fixture()
+          : m_image(5, 3, 2, 2, 4, PixelFormatFloat)
+        {
+            for (size_t y = 0; y < 3; ++y)
+            {
+                for (size_t x = 0; x < 5; ++x)
+                {
+                    const float v = static_cast<float>(y * 5 + x);
+                    m_image.set_pixel(x, y, Color4f(v, 2.0f * v, 0.5f, 1.0f));
+                }
+            }
+        }
+
+        void write(const char* filename, const int options) const
+        {
+            TextureFileWriter writer(filename, options);
+            writer.write(m_image);
+        }
+    };
+
+    TEST_CASE_F(WriteAndRead_Uncompressed_ReturnsOriginalTilesAndMIPLevels, Fixture)
+    {
+        const char* Filename = "unit tests/outputs/test_texturefile_uncompressed.atx";
+        write(Filename, TextureFileWriter::Defaults);
+
+        TextureFileReader reader;
+        reader.open(Filename);
+
+        EXPECT_EQ(3, reader.get_level_count());
+        EXPECT_FALSE(reader.is_compressed());
+
+        CanvasProperties props;
+        reader.read_canvas_properties(props);
+        EXPECT_EQ(5, props.m_canvas_width);
+        EXPECT_EQ(3, props.m_canvas_height);
+        EXPECT_EQ(2, props.m_tile_width);
+        EXPECT_EQ(2, props.m_tile_height);
+        EXPECT_EQ(4, props.m_channel_count);
+        EXPECT_EQ(PixelFormatFloat, props.m_pixel_format);
+
+        // Border tile of the base level.
+        auto_ptr<Tile> tile(reader.read_tile(2, 1));
+        EXPECT_EQ(1, tile->get_width());
+        EXPECT_EQ(1, tile->get_height());
+
+        Color4f c;
+        tile->get_pixel(0, 0, c);
+        EXPECT_EQ(Color4f(14.0f, 28.0f, 0.5f, 1.0f), c);
+
+        // The first MIP level is 2x1 pixels and fits in a single tile.
+        reader.read_canvas_properties(1, props);
+        EXPECT_EQ(2, props.m_canvas_width);
+        EXPECT_EQ(1, props.m_canvas_height);
+
+        tile.reset(reader.read_tile(1, 0, 0));
+        tile->get_pixel(1, 0, c);
+        EXPECT_EQ(Color4f(5.0f, 10.0f, 0.5f, 1.0f), c);     // average of pixels 2, 3, 7 and 8
+    }
+
+    TEST_CASE_F(WriteAndRead_Compressed_ReturnsOriginalTilesAndMIPLevels, Fixture)
+    {
+        const char* Filename = "unit tests/outputs/test_texturefile_compressed.atx";
+        write(Filename, TextureFileWriter::Compress);
+
+        TextureFileReader reader;
+        reader.open(Filename);
+
+        EXPECT_EQ(3, reader.get_level_count());
+        EXPECT_TRUE(reader.is_compressed());
+
+        auto_ptr<Tile> tile(reader.read_tile(1, 0));
+
+        Color4f c;
+        tile->get_pixel(1, 1, c);
+        EXPECT_EQ(Color4f(8.0f, 16.0f, 0.5f, 1.0f), c);
+
+        tile.reset(reader.read_tile(2, 0, 0));
+        EXPECT_EQ(1, tile->get_width());
+        EXPECT_EQ(1, tile->get_height());
+    }
+
+    TEST_CASE_F(Write_BaseLevelOnly_WritesSingleLevel, Fixture)
+    {
+        const char* Filename = "unit tests/outputs/test_texturefile_baselevelonly.atx";
+
+        write(Filename, TextureFileWriter::BaseLevelOnly);
+
+        TextureFileReader reader;
+        reader.open(Filename);
+
+        EXPECT_EQ(1, reader.get_level_count());
+    }
+}
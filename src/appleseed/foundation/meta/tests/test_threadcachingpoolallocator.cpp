@@ -0,0 +1,149 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+#include "foundation/utility/threadcachingpoolallocator.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Utility_ThreadCachingPoolAllocator)
+{
+    TEST_CASE(IdenticalAllocatorsAreEqual)
+    {
+        ThreadCachingPoolAllocator<int, 128> a1, a2;
+
+        EXPECT_TRUE(a1 == a2);
+        EXPECT_FALSE(a1 != a2);
+    }
+
+    TEST_CASE(AllocatorsWithDifferentMagazineSizesAreNotEqual)
+    {
+        ThreadCachingPoolAllocator<int, 128, 16> a1;
+        ThreadCachingPoolAllocator<int, 128, 32> a2;
+
+        EXPECT_FALSE(a1 == a2);
+        EXPECT_TRUE(a1 != a2);
+    }
+
+    TEST_CASE(AllocateDeallocateSingleItem)
+    {
+        ThreadCachingPoolAllocator<int, 2> allocator;
+
+        int* p = allocator.allocate(1);
+        EXPECT_NEQ(0, p);
+
+        allocator.deallocate(p, 1);
+    }
+
+    TEST_CASE(AllocateDeallocateArrayOfItems)
+    {
+        ThreadCachingPoolAllocator<int, 2> allocator;
+
+        const size_t N = 10;
+
+        int* p = allocator.allocate(N);
+        EXPECT_NEQ(0, p);
+
+        allocator.deallocate(p, N);
+    }
+
+    TEST_CASE(Allocate_AfterDeallocate_ReusesItem)
+    {
+        ThreadCachingPoolAllocator<int, 16, 4> allocator;
+
+        int* p1 = allocator.allocate(1);
+        allocator.deallocate(p1, 1);
+
+        int* p2 = allocator.allocate(1);
+        allocator.deallocate(p2, 1);
+
+        EXPECT_EQ(p1, p2);
+    }
+
+    TEST_CASE(AllocateManyItems_SpanningSeveralMagazinesAndPages_ReturnsDistinctItems)
+    {
+        ThreadCachingPoolAllocator<int, 10, 4> allocator;
+
+        const size_t N = 100;
+
+        // Allocate twice, so that the second round is served from magazines spilled to the depot.
+        for (size_t round = 0; round < 2; ++round)
+        {
+            vector<int*> items;
+
+            for (size_t i = 0; i < N; ++i)
+            {
+                items.push_back(allocator.allocate(1));
+                *items.back() = static_cast<int>(i);
+            }
+
+            for (size_t i = 0; i < N; ++i)
+                EXPECT_EQ(static_cast<int>(i), *items[i]);
+
+            sort(items.begin(), items.end());
+            EXPECT_TRUE(adjacent_find(items.begin(), items.end()) == items.end());
+
+            for (size_t i = 0; i < N; ++i)
+                allocator.deallocate(items[i], 1);
+        }
+    }
+
+    TEST_CASE(FlushThreadCache_ItemsRemainAvailable)
+    {
+        ThreadCachingPoolAllocator<int, 16, 4> allocator;
+
+        int* p1 = allocator.allocate(1);
+        allocator.deallocate(p1, 1);
+
+        allocator.flush_thread_cache();
+
+        int* p2 = allocator.allocate(1);
+        allocator.deallocate(p2, 1);
+
+        EXPECT_EQ(p1, p2);
+    }
+
+    TEST_CASE(RebindVoidAllocatorToIntAllocator)
+    {
+        ThreadCachingPoolAllocator<void, 2>::rebind<int>::other allocator;
+
+        int* p = allocator.allocate(1);
+        EXPECT_NEQ(0, p);
+
+        allocator.deallocate(p, 1);
+    }
+}
@@ -56,6 +56,11 @@
 #include <sal.h>
 #endif
 
+// _mm_prefetch() is used by APPLESEED_PREFETCH with Visual Studio.
+#if defined _MSC_VER && (defined _M_IX86 || defined _M_X64)
+#include <xmmintrin.h>
+#endif
+
 namespace foundation
 {
 
@@ -95,6 +100,25 @@ namespace foundation
 #endif
 
 
+//
+// A qualifier to give each thread its own instance of a variable with static storage duration.
+// Only POD types with constant initializers are portable.
+//
+
+// Visual C++.
+#if defined _MSC_VER
+    #define APPLESEED_THREAD_LOCAL __declspec(thread)
+
+// gcc.
+#elif defined __GNUC__
+    #define APPLESEED_THREAD_LOCAL __thread
+
+// Other compilers: abort compilation.
+#else
+    #error APPLESEED_THREAD_LOCAL is not defined for this compiler.
+#endif
+
+
 //
 // Qualifiers to specify the alignment of a variable, a structure member or a structure.
 //
@@ -218,6 +242,21 @@ namespace foundation
 #endif
 
 
+//
+//  A macro to hint the processor that the memory at a given address will soon be read,
+//  so that the cache line holding it is fetched while other work proceeds.
+//  Like APPLESEED_LIKELY, it should only be used after profiling.
+//
+
+#if defined(__GNUC__)
+    #define APPLESEED_PREFETCH(p) __builtin_prefetch(p)
+#elif defined _MSC_VER && (defined _M_IX86 || defined _M_X64)
+    #define APPLESEED_PREFETCH(p) _mm_prefetch(reinterpret_cast<const char*>(p), _MM_HINT_T0)
+#else
+    #define APPLESEED_PREFETCH(p)
+#endif
+
+
 //
 //  A macro to mark a variable as unused. Useful in unit tests.
 //
@@ -42,17 +42,23 @@
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <cstdio>
 #include <cstring>
 
 // Platform headers.
 #if defined __APPLE__
 #include <mach-o/dyld.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #elif defined __linux__
 #include <sys/types.h>
+#include <fcntl.h>
 #include <pwd.h>
 #include <unistd.h>
 #elif defined __FreeBSD__
 #include <sys/sysctl.h>
+#include <fcntl.h>
 #include <pwd.h>
 #include <unistd.h>
 #endif
@@ -178,6 +184,60 @@ const char* get_home_directory()
     return path;
 }
 
+bool prefetch_file(const char* filepath)
+{
+// Windows.
+#if defined _WIN32
+
+    // No asynchronous read-ahead hint: only resolve and open the file.
+    FILE* file = fopen(filepath, "rb");
+    if (file == 0)
+        return false;
+
+    fclose(file);
+    return true;
+
+// OS X.
+#elif defined __APPLE__
+
+    const int fd = open(filepath, O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0)
+    {
+        struct radvisory advisory;
+        advisory.ra_offset = 0;
+        advisory.ra_count =
+            file_stat.st_size < 0x7FFFFFFF ? static_cast<int>(file_stat.st_size) : 0x7FFFFFFF;
+        fcntl(fd, F_RDADVISE, &advisory);
+    }
+
+    close(fd);
+    return true;
+
+// Other Unices.
+#elif defined __linux__ || defined __FreeBSD__
+
+    const int fd = open(filepath, O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    // A length of zero means until the end of the file.
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+
+    close(fd);
+    return true;
+
+// Other platforms.
+#else
+
+    #error Unsupported platform.
+
+#endif
+}
+
 void split_paths(
     const bf::path&     p1,
     const bf::path&     p2,
@@ -86,6 +86,15 @@ APPLESEED_DLLSYMBOL const char* get_executable_directory();
 // Return the path to the user's home directory.
 APPLESEED_DLLSYMBOL const char* get_home_directory();
 
+//
+// Operations on files.
+//
+
+// Hint the operating system that a file is about to be read so that its contents
+// get read ahead asynchronously. Returns immediately. Thread-safe.
+// Return false if the file could not be opened.
+APPLESEED_DLLSYMBOL bool prefetch_file(const char* filepath);
+
 //
 // Operations on boost::filesystem::path objects.
 //
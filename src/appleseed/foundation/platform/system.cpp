@@ -38,6 +38,15 @@
 // Standard headers.
 #include <string>
 
+// x86 CPUID instruction.
+#ifdef APPLESEED_X86
+    #if defined _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
 // Windows.
 #if defined _WIN32
 
@@ -66,10 +75,16 @@
 // Linux.
 #elif defined __linux__
 
+    // appleseed.foundation headers.
+    #include "foundation/platform/snprintf.h"
+
     // Standard headers.
+    #include <algorithm>
     #include <cstdio>
+    #include <cstdlib>
 
     // Platform headers.
+    #include <sched.h>
     #include <sys/sysinfo.h>
     #include <sys/types.h>
     #include <unistd.h>
@@ -98,18 +113,116 @@ namespace foundation
 // Common code.
 // ------------------------------------------------------------------------------------------------
 
+namespace
+{
+    struct InstructionSets
+    {
+        bool m_sse2;
+        bool m_sse42;
+        bool m_avx;
+        bool m_avx2;
+        bool m_fma;
+
+        InstructionSets()
+          : m_sse2(false)
+          , m_sse42(false)
+          , m_avx(false)
+          , m_avx2(false)
+          , m_fma(false)
+        {
+#ifdef APPLESEED_X86
+            uint32 regs[4];
+
+            cpuid(0, 0, regs);
+            const uint32 max_function = regs[0];
+
+            if (max_function < 1)
+                return;
+
+            cpuid(1, 0, regs);
+            m_sse2 = (regs[3] & (1UL << 26)) != 0;
+            m_sse42 = (regs[2] & (1UL << 20)) != 0;
+
+            // AVX and FMA also require the OS to save the YMM registers on context switches.
+            const bool osxsave = (regs[2] & (1UL << 27)) != 0;
+            const bool ymm_enabled = osxsave && (xgetbv(0) & 6) == 6;
+            m_avx = ymm_enabled && (regs[2] & (1UL << 28)) != 0;
+            m_fma = m_avx && (regs[2] & (1UL << 12)) != 0;
+
+            if (max_function >= 7)
+            {
+                cpuid(7, 0, regs);
+                m_avx2 = m_avx && (regs[1] & (1UL << 5)) != 0;
+            }
+#endif
+        }
+
+#ifdef APPLESEED_X86
+
+        static void cpuid(const uint32 function, const uint32 subfunction, uint32 regs[4])
+        {
+#if defined _MSC_VER
+            int info[4];
+            __cpuidex(info, static_cast<int>(function), static_cast<int>(subfunction));
+            for (size_t i = 0; i < 4; ++i)
+                regs[i] = static_cast<uint32>(info[i]);
+#else
+            __cpuid_count(function, subfunction, regs[0], regs[1], regs[2], regs[3]);
+#endif
+        }
+
+        static uint64 xgetbv(const uint32 index)
+        {
+#if defined _MSC_VER
+            return _xgetbv(index);
+#else
+            uint32 eax, edx;
+            __asm__ volatile ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (index));
+            return (static_cast<uint64>(edx) << 32) | eax;
+#endif
+        }
+
+#endif
+    };
+
+    const InstructionSets& get_instruction_sets()
+    {
+        static const InstructionSets instruction_sets;
+        return instruction_sets;
+    }
+
+    string get_instruction_sets_string()
+    {
+        const InstructionSets& sets = get_instruction_sets();
+
+        string result;
+        if (sets.m_sse2)  result += " SSE2";
+        if (sets.m_sse42) result += " SSE4.2";
+        if (sets.m_avx)   result += " AVX";
+        if (sets.m_avx2)  result += " AVX2";
+        if (sets.m_fma)   result += " FMA";
+
+        return result.empty() ? "n/a" : result.substr(1);
+    }
+}
+
 void System::print_information(Logger& logger)
 {
     LOG_INFO(
         logger,
         "system information:\n"
-        "  logical cores    %s\n"
+        "  logical cores    %s (%s available)\n"
+        "  instruction sets %s\n"
+        "  NUMA nodes       %s\n"
         "  L1 data cache    size %s, line size %s\n"
         "  L2 cache         size %s, line size %s\n"
         "  L3 cache         size %s, line size %s\n"
-        "  physical memory  size %s\n"
+        "  physical memory  size %s (%s available)\n"
         "  virtual memory   size %s",
         pretty_uint(get_logical_cpu_core_count()).c_str(),
+        pretty_uint(get_available_cpu_core_count()).c_str(),
+        get_instruction_sets_string().c_str(),
+        pretty_uint(get_numa_node_count()).c_str(),
         pretty_size(get_l1_data_cache_size()).c_str(),
         pretty_size(get_l1_data_cache_line_size()).c_str(),
         pretty_size(get_l2_cache_size()).c_str(),
@@ -117,6 +230,7 @@ void System::print_information(Logger& logger)
         pretty_size(get_l3_cache_size()).c_str(),
         pretty_size(get_l3_cache_line_size()).c_str(),
         pretty_size(get_total_physical_memory_size()).c_str(),
+        pretty_size(get_available_physical_memory_size()).c_str(),
         pretty_size(get_total_virtual_memory_size()).c_str());
 }
 
@@ -128,6 +242,70 @@ size_t System::get_logical_cpu_core_count()
     return concurrency > 1 ? concurrency : 1;
 }
 
+bool System::has_sse2()
+{
+    return get_instruction_sets().m_sse2;
+}
+
+bool System::has_sse42()
+{
+    return get_instruction_sets().m_sse42;
+}
+
+bool System::has_avx()
+{
+    return get_instruction_sets().m_avx;
+}
+
+bool System::has_avx2()
+{
+    return get_instruction_sets().m_avx2;
+}
+
+bool System::has_fma()
+{
+    return get_instruction_sets().m_fma;
+}
+
+bool System::check_instruction_sets(Logger& logger)
+{
+    bool success = true;
+
+#ifdef APPLESEED_USE_SSE
+    if (!has_sse2())
+    {
+        LOG_ERROR(logger, "this binary requires SSE2 but the CPU does not support it.");
+        success = false;
+    }
+#endif
+
+#ifdef APPLESEED_USE_SSE42
+    if (!has_sse42())
+    {
+        LOG_ERROR(logger, "this binary requires SSE4.2 but the CPU does not support it.");
+        success = false;
+    }
+#endif
+
+#ifdef APPLESEED_USE_AVX
+    if (!has_avx())
+    {
+        LOG_ERROR(logger, "this binary requires AVX but the CPU or the operating system does not support it.");
+        success = false;
+    }
+#endif
+
+#ifdef APPLESEED_USE_AVX2
+    if (!has_avx2())
+    {
+        LOG_ERROR(logger, "this binary requires AVX2 but the CPU or the operating system does not support it.");
+        success = false;
+    }
+#endif
+
+    return success;
+}
+
 // ------------------------------------------------------------------------------------------------
 // Windows.
 // ------------------------------------------------------------------------------------------------
@@ -252,6 +430,48 @@ uint64 System::get_process_virtual_memory_size()
     return pmc.PrivateUsage;
 }
 
+size_t System::get_available_cpu_core_count()
+{
+    const size_t logical_count = get_logical_cpu_core_count();
+
+    DWORD_PTR process_mask, system_mask;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask) == FALSE)
+        return logical_count;
+
+    size_t count = 0;
+    for (; process_mask != 0; process_mask &= process_mask - 1)
+        ++count;
+
+    // The affinity mask only covers the current processor group.
+    return count > 0 && count < logical_count ? count : logical_count;
+}
+
+uint64 System::get_available_physical_memory_size()
+{
+    return get_total_physical_memory_size();
+}
+
+size_t System::get_numa_node_count()
+{
+    ULONG highest_node_number;
+    if (GetNumaHighestNodeNumber(&highest_node_number) == FALSE)
+        return 1;
+
+    return static_cast<size_t>(highest_node_number) + 1;
+}
+
+size_t System::get_numa_node(const size_t cpu_core)
+{
+    if (cpu_core >= 64)
+        return 0;
+
+    UCHAR node_number;
+    if (GetNumaProcessorNode(static_cast<UCHAR>(cpu_core), &node_number) == FALSE || node_number == 0xFF)
+        return 0;
+
+    return static_cast<size_t>(node_number);
+}
+
 // ------------------------------------------------------------------------------------------------
 // OS X.
 // ------------------------------------------------------------------------------------------------
@@ -349,6 +569,26 @@ uint64 System::get_process_virtual_memory_size()
     return info.resident_size;
 }
 
+size_t System::get_available_cpu_core_count()
+{
+    return get_logical_cpu_core_count();
+}
+
+uint64 System::get_available_physical_memory_size()
+{
+    return get_total_physical_memory_size();
+}
+
+size_t System::get_numa_node_count()
+{
+    return 1;
+}
+
+size_t System::get_numa_node(const size_t cpu_core)
+{
+    return 0;
+}
+
 // ------------------------------------------------------------------------------------------------
 // Linux.
 // ------------------------------------------------------------------------------------------------
@@ -429,6 +669,189 @@ uint64 System::get_process_virtual_memory_size()
     return static_cast<uint64>(rss) * sysconf(_SC_PAGESIZE);
 }
 
+namespace
+{
+    // Return whether a given logical CPU core belongs to a CPU list such as "0-15,32-47".
+    bool is_in_cpu_list(const char* cpu_list, const size_t cpu_core)
+    {
+        const char* p = cpu_list;
+
+        while (*p != '\0' && *p != '\n')
+        {
+            char* end;
+            const unsigned long first = strtoul(p, &end, 10);
+            if (end == p)
+                return false;
+
+            unsigned long last = first;
+            p = end;
+
+            if (*p == '-')
+            {
+                last = strtoul(p + 1, &end, 10);
+                p = end;
+            }
+
+            if (cpu_core >= first && cpu_core <= last)
+                return true;
+
+            if (*p == ',')
+                ++p;
+        }
+
+        return false;
+    }
+
+    bool read_numa_node_cpu_list(const size_t node, char* cpu_list, const size_t cpu_list_size)
+    {
+        char path[64];
+        portable_snprintf(path, sizeof(path), "/sys/devices/system/node/node%lu/cpulist", (long unsigned int)node);
+
+        FILE* fp = fopen(path, "r");
+        if (fp == 0)
+            return false;
+
+        const bool success = fgets(cpu_list, static_cast<int>(cpu_list_size), fp) != 0;
+        fclose(fp);
+
+        return success;
+    }
+}
+
+namespace
+{
+    // Read the first line of a (small) file. Return false if the file cannot be read.
+    bool read_first_line(const char* path, char* line, const size_t line_size)
+    {
+        FILE* fp = fopen(path, "r");
+        if (fp == 0)
+            return false;
+
+        const bool success = fgets(line, static_cast<int>(line_size), fp) != 0;
+        fclose(fp);
+
+        return success;
+    }
+
+    // Read a non-negative integer from a file. Return false if the file cannot be read,
+    // does not start with an integer, or contains a negative value (e.g. -1 for "no limit").
+    bool read_uint64(const char* path, uint64& value)
+    {
+        char line[64];
+        if (!read_first_line(path, line, sizeof(line)))
+            return false;
+
+        long long v;
+        if (sscanf(line, "%lld", &v) != 1 || v < 0)
+            return false;
+
+        value = static_cast<uint64>(v);
+        return true;
+    }
+
+    // Return the CPU quota of the control group of the process, in CPU cores rounded up,
+    // or 0 if there is no quota.
+    size_t get_cgroup_cpu_quota()
+    {
+        uint64 quota = 0, period = 0;
+
+        // cgroup v2: "<quota> <period>" or "max <period>".
+        char line[64];
+        if (read_first_line("/sys/fs/cgroup/cpu.max", line, sizeof(line)))
+        {
+            long long q, p;
+            if (sscanf(line, "%lld %lld", &q, &p) != 2 || q <= 0 || p <= 0)
+                return 0;
+            quota = static_cast<uint64>(q);
+            period = static_cast<uint64>(p);
+        }
+
+        // cgroup v1: the CPU controller may be co-mounted with the CPU accounting controller.
+        else if (!(read_uint64("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", quota) &&
+                   read_uint64("/sys/fs/cgroup/cpu/cpu.cfs_period_us", period)) &&
+                 !(read_uint64("/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_quota_us", quota) &&
+                   read_uint64("/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_period_us", period)))
+            return 0;
+
+        if (quota == 0 || period == 0)
+            return 0;
+
+        return static_cast<size_t>((quota + period - 1) / period);
+    }
+
+    // Return the memory limit of the control group of the process, or 0 if there is no limit.
+    uint64 get_cgroup_memory_limit()
+    {
+        // cgroup v2: a size in bytes, or "max".
+        char line[64];
+        if (read_first_line("/sys/fs/cgroup/memory.max", line, sizeof(line)))
+        {
+            long long v;
+            return sscanf(line, "%lld", &v) == 1 && v > 0 ? static_cast<uint64>(v) : 0;
+        }
+
+        // cgroup v1: "no limit" is reported as a huge value, filtered out by the caller.
+        uint64 limit;
+        if (read_uint64("/sys/fs/cgroup/memory/memory.limit_in_bytes", limit))
+            return limit;
+
+        return 0;
+    }
+}
+
+size_t System::get_available_cpu_core_count()
+{
+    size_t count = get_logical_cpu_core_count();
+
+    // CPU affinity, which reflects cpuset restrictions and taskset/numactl pinning.
+    cpu_set_t cpu_set;
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0)
+    {
+        const int affinity_count = CPU_COUNT(&cpu_set);
+        if (affinity_count > 0)
+            count = min(count, static_cast<size_t>(affinity_count));
+    }
+
+    // CPU bandwidth quota (e.g. docker --cpus or a Kubernetes CPU limit).
+    const size_t quota = get_cgroup_cpu_quota();
+    if (quota > 0)
+        count = min(count, quota);
+
+    return count > 1 ? count : 1;
+}
+
+uint64 System::get_available_physical_memory_size()
+{
+    const uint64 total = get_total_physical_memory_size();
+    const uint64 limit = get_cgroup_memory_limit();
+
+    return limit > 0 && limit < total ? limit : total;
+}
+
+size_t System::get_numa_node_count()
+{
+    char cpu_list[4096];
+
+    size_t node_count = 0;
+    while (read_numa_node_cpu_list(node_count, cpu_list, sizeof(cpu_list)))
+        ++node_count;
+
+    return node_count > 1 ? node_count : 1;
+}
+
+size_t System::get_numa_node(const size_t cpu_core)
+{
+    char cpu_list[4096];
+
+    for (size_t node = 0; read_numa_node_cpu_list(node, cpu_list, sizeof(cpu_list)); ++node)
+    {
+        if (is_in_cpu_list(cpu_list, cpu_core))
+            return node;
+    }
+
+    return 0;
+}
+
 // ------------------------------------------------------------------------------------------------
 // FreeBSD.
 // ------------------------------------------------------------------------------------------------
@@ -812,6 +1235,26 @@ uint64 System::get_process_virtual_memory_size()
     return static_cast<uint64>(ru.ru_maxrss) * 1024;
 }
 
+size_t System::get_available_cpu_core_count()
+{
+    return get_logical_cpu_core_count();
+}
+
+uint64 System::get_available_physical_memory_size()
+{
+    return get_total_physical_memory_size();
+}
+
+size_t System::get_numa_node_count()
+{
+    return 1;
+}
+
+size_t System::get_numa_node(const size_t cpu_core)
+{
+    return 0;
+}
+
 #endif
 
 }   // namespace foundation
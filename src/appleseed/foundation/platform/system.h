@@ -64,6 +64,39 @@ class APPLESEED_DLLSYMBOL System
     // Return the number of logical CPU cores available in the system.
     static size_t get_logical_cpu_core_count();
 
+    // Return the number of logical CPU cores the current process may actually use.
+    // This takes into account the CPU affinity of the process and, on Linux, the
+    // CPU quota of its control group (e.g. when running inside a container).
+    static size_t get_available_cpu_core_count();
+
+    //
+    // CPU instruction sets.
+    //
+    // These functions query the CPU at run time, and also check that the
+    // operating system saves the extended register state where required.
+    // They always return false on non-x86 platforms.
+    //
+
+    static bool has_sse2();
+    static bool has_sse42();
+    static bool has_avx();
+    static bool has_avx2();
+    static bool has_fma();
+
+    // Log an error for every instruction set this binary was compiled for but
+    // that is not supported by the CPU. Return true if all are supported.
+    static bool check_instruction_sets(Logger& logger);
+
+    //
+    // NUMA topology.
+    //
+
+    // Return the number of NUMA nodes in the system, or 1 if it cannot be determined.
+    static size_t get_numa_node_count();
+
+    // Return the NUMA node of a given logical CPU core, or 0 if it cannot be determined.
+    static size_t get_numa_node(const size_t cpu_core);
+
     //
     // CPU caches.
     //
@@ -93,6 +126,10 @@ class APPLESEED_DLLSYMBOL System
     // Return the total size in bytes of the physical memory.
     static uint64 get_total_physical_memory_size();
 
+    // Return the size in bytes of the physical memory the current process may use.
+    // On Linux, this is capped by the memory limit of the process' control group.
+    static uint64 get_available_physical_memory_size();
+
     //
     // Virtual memory.
     //
@@ -49,9 +49,13 @@
 #if defined __APPLE__
 #include <pthread.h>
 #elif defined __FreeBSD__
+#include <sys/param.h>
+#include <sys/cpuset.h>
 #include <pthread.h>
 #include <pthread_np.h>
 #elif defined __linux__
+#include <pthread.h>
+#include <sched.h>
 #include <sys/prctl.h>
 #endif
 
@@ -101,6 +105,16 @@ namespace foundation
         }
     }
 
+    bool set_current_thread_cpu_affinity(const size_t cpu_core)
+    {
+        // Only the first processor group is supported.
+        if (cpu_core >= sizeof(DWORD_PTR) * 8)
+            return false;
+
+        const DWORD_PTR mask = static_cast<DWORD_PTR>(1) << cpu_core;
+        return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+    }
+
 // OS X.
 #elif defined __APPLE__
 
@@ -109,6 +123,12 @@ namespace foundation
         pthread_setname_np(name);
     }
 
+    bool set_current_thread_cpu_affinity(const size_t cpu_core)
+    {
+        // OS X does not support binding threads to CPU cores.
+        return false;
+    }
+
 // FreeBSD.
 #elif defined __FreeBSD__
 
@@ -117,6 +137,18 @@ namespace foundation
         pthread_set_name_np(pthread_self(), name);
     }
 
+    bool set_current_thread_cpu_affinity(const size_t cpu_core)
+    {
+        if (cpu_core >= CPU_SETSIZE)
+            return false;
+
+        cpuset_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu_core, &cpu_set);
+
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+    }
+
 // Linux.
 #elif defined __linux__
 
@@ -125,6 +157,18 @@ namespace foundation
         prctl(PR_SET_NAME, (unsigned long)name, 0, 0, 0);
     }
 
+    bool set_current_thread_cpu_affinity(const size_t cpu_core)
+    {
+        if (cpu_core >= CPU_SETSIZE)
+            return false;
+
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu_core, &cpu_set);
+
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+    }
+
 // Other platforms.
 #else
 
@@ -133,6 +177,11 @@ namespace foundation
         // Do nothing.
     }
 
+    bool set_current_thread_cpu_affinity(const size_t cpu_core)
+    {
+        return false;
+    }
+
 #endif
 
 void sleep(const uint32 ms)
@@ -59,6 +59,10 @@ namespace foundation
 // For portability, limit the name to 16 characters, including the terminating zero.
 APPLESEED_DLLSYMBOL void set_current_thread_name(const char* name);
 
+// Restrict the current thread to run on a given logical CPU core.
+// Return false if the affinity could not be set or if the platform does not support it.
+APPLESEED_DLLSYMBOL bool set_current_thread_cpu_affinity(const size_t cpu_core);
+
 // Suspend the current thread for a given number of milliseconds.
 APPLESEED_DLLSYMBOL void sleep(const uint32 ms);
 APPLESEED_DLLSYMBOL void sleep(const uint32 ms, IAbortSwitch& abort_switch);
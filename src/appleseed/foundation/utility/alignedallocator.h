@@ -117,7 +117,12 @@ class AlignedAllocator
         if (n == 0)
             return 0;
 
-        pointer p = static_cast<pointer>(aligned_malloc(n * sizeof(T), m_alignment));
+        // Large arrays may be backed by huge pages, see foundation::set_huge_page_mode().
+        const size_t size = n * sizeof(T);
+        pointer p = static_cast<pointer>(
+            size >= HugePageMinAllocationSize
+                ? huge_page_malloc(size, m_alignment)
+                : aligned_malloc(size, m_alignment));
 
         if (p == 0)
              throw std::bad_alloc();
@@ -128,7 +133,11 @@ class AlignedAllocator
     void deallocate(pointer p, size_type n)
     {
         if (p)
-            aligned_free(p);
+        {
+            if (n * sizeof(T) >= HugePageMinAllocationSize)
+                huge_page_free(p);
+            else aligned_free(p);
+        }
     }
 
     size_type max_size() const
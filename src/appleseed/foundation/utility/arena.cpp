@@ -0,0 +1,103 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "arena.h"
+
+// Standard headers.
+#include <algorithm>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// Arena class implementation.
+//
+
+Arena::Arena()
+  : m_base(m_storage)
+  , m_end(m_storage + ArenaSize)
+  , m_current(m_storage)
+  , m_overflow_size(0)
+  , m_high_water_mark(0)
+  , m_memory_account(MemoryTagScratch)
+{
+    m_memory_account.set_size(ArenaSize);
+}
+
+Arena::~Arena()
+{
+    for (size_t i = 0, e = m_overflow_blocks.size(); i < e; ++i)
+        aligned_free(m_overflow_blocks[i]);
+
+    if (m_base != m_storage)
+        aligned_free(m_base);
+}
+
+void* Arena::allocate_overflow(const size_t size)
+{
+    void* ptr = aligned_malloc(size, 16);
+    m_overflow_blocks.push_back(ptr);
+    m_overflow_size += align(size, 16);
+    m_memory_account.grow(align(size, 16));
+    return ptr;
+}
+
+void Arena::release_overflow(const Mark& mark)
+{
+    for (size_t i = mark.m_overflow_block_count, e = m_overflow_blocks.size(); i < e; ++i)
+        aligned_free(m_overflow_blocks[i]);
+
+    m_overflow_blocks.resize(mark.m_overflow_block_count);
+    m_memory_account.shrink(m_overflow_size - mark.m_overflow_size);
+    m_overflow_size = mark.m_overflow_size;
+}
+
+void Arena::grow()
+{
+    for (size_t i = 0, e = m_overflow_blocks.size(); i < e; ++i)
+        aligned_free(m_overflow_blocks[i]);
+
+    m_overflow_blocks.clear();
+    m_overflow_size = 0;
+
+    // Leave some headroom so that the arena doesn't need to grow again right away.
+    const size_t capacity = max(2 * get_capacity(), align(m_high_water_mark + m_high_water_mark / 2, 16));
+
+    if (m_base != m_storage)
+        aligned_free(m_base);
+
+    m_base = static_cast<uint8*>(aligned_malloc(capacity, 16));
+    m_end = m_base + capacity;
+
+    m_memory_account.set_size(ArenaSize + capacity);
+}
+
+}   // namespace foundation
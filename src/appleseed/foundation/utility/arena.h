@@ -31,14 +31,19 @@
 #define APPLESEED_FOUNDATION_UTILITY_ARENA_H
 
 // appleseed.foundation headers.
-#include "foundation/core/exceptions/exception.h"
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/memoryaccounting.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
 
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <vector>
 
 namespace foundation
 {
@@ -46,25 +51,90 @@ namespace foundation
 //
 // An arena is a temporary heap providing extremely cheap memory allocation.
 //
+// Allocations that don't fit in the arena are served from the heap until the next call
+// to clear(), at which point the arena grows to the largest amount of memory ever used
+// between two calls to clear() (its high-water mark), so that it stops overflowing.
+//
+// Nested users of an arena (e.g. the bounces of a path) can take a mark and later release
+// all allocations made after it, so that scratch memory is reused within a sample instead
+// of piling up until the next call to clear(). Marks must be released in LIFO order and
+// are invalidated by clear().
+//
 
-class Arena
+class APPLESEED_DLLSYMBOL Arena
+  : public NonCopyable
 {
   public:
     Arena();
+    ~Arena();
+
+    // A position in the arena.
+    struct Mark
+    {
+        uint8*      m_current;
+        size_t      m_overflow_block_count;
+        size_t      m_overflow_size;
+    };
 
     void clear();
 
+    // Return the current position in the arena.
+    Mark mark() const;
+
+    // Free all allocations made since a given mark was taken.
+    void release(const Mark& mark);
+
     void* allocate(const size_t size);
 
     template <typename T> T* allocate();
     template <typename T> T* allocate_noinit();
 
+    // Return the size of the arena in bytes.
+    size_t get_capacity() const;
+
+    // Return the largest amount of memory in use between two calls to clear(), in bytes.
+    size_t get_high_water_mark() const;
+
   private:
     enum { ArenaSize = 256 * 1024 };    // bytes
 
     APPLESEED_SIMD4_ALIGN uint8 m_storage[ArenaSize];
+    uint8*                      m_base;                 // m_storage, or a larger heap block once the arena has grown
     const uint8*                m_end;
     uint8*                      m_current;
+    size_t                      m_overflow_size;        // bytes allocated from the heap since the last call to clear()
+    size_t                      m_high_water_mark;
+    std::vector<void*>          m_overflow_blocks;
+    MemoryAccount               m_memory_account;       // inline storage plus heap blocks, accounted as scratch memory
+
+    void* allocate_overflow(const size_t size);
+    void release_overflow(const Mark& mark);
+    void grow();
+
+    void update_high_water_mark();
+};
+
+
+//
+// Release all allocations made in an arena during the lifetime of this object.
+//
+
+class ArenaScope
+  : public NonCopyable
+{
+  public:
+    // Constructor, marks the arena.
+    explicit ArenaScope(Arena& arena);
+
+    // Destructor, releases the allocations made since construction.
+    ~ArenaScope();
+
+    // Release the allocations made since construction; the scope remains active.
+    void release();
+
+  private:
+    Arena&              m_arena;
+    const Arena::Mark   m_mark;
 };
 
 
@@ -72,21 +142,50 @@ class Arena
 // Arena class implementation.
 //
 
-inline Arena::Arena()
-  : m_end(m_storage + ArenaSize)
-  , m_current(m_storage)
+inline void Arena::update_high_water_mark()
 {
+    const size_t used = static_cast<size_t>(m_current - m_base) + m_overflow_size;
+    if (m_high_water_mark < used)
+        m_high_water_mark = used;
 }
 
 inline void Arena::clear()
 {
-    m_current = m_storage;
+    update_high_water_mark();
+
+    // Overflow blocks may already have been released to a mark.
+    if APPLESEED_UNLIKELY(m_high_water_mark > get_capacity())
+        grow();
+
+    m_current = m_base;
+}
+
+inline Arena::Mark Arena::mark() const
+{
+    Mark mark;
+    mark.m_current = m_current;
+    mark.m_overflow_block_count = m_overflow_blocks.size();
+    mark.m_overflow_size = m_overflow_size;
+    return mark;
+}
+
+inline void Arena::release(const Mark& mark)
+{
+    assert(mark.m_current >= m_base && mark.m_current <= m_current);
+    assert(mark.m_overflow_block_count <= m_overflow_blocks.size());
+
+    update_high_water_mark();
+
+    if APPLESEED_UNLIKELY(m_overflow_blocks.size() > mark.m_overflow_block_count)
+        release_overflow(mark);
+
+    m_current = mark.m_current;
 }
 
 inline void* Arena::allocate(const size_t size)
 {
-    if (m_current + size > m_end)
-        throw Exception("out of arena memory");
+    if APPLESEED_UNLIKELY(m_current + size > m_end)
+        return allocate_overflow(size);
 
     void* ptr = m_current;
     m_current += align(size, 16);
@@ -112,6 +211,37 @@ inline T* Arena::allocate_noinit()
     return static_cast<T*>(allocate(sizeof(T)));
 }
 
+inline size_t Arena::get_capacity() const
+{
+    return static_cast<size_t>(m_end - m_base);
+}
+
+inline size_t Arena::get_high_water_mark() const
+{
+    return m_high_water_mark;
+}
+
+
+//
+// ArenaScope class implementation.
+//
+
+inline ArenaScope::ArenaScope(Arena& arena)
+  : m_arena(arena)
+  , m_mark(arena.mark())
+{
+}
+
+inline ArenaScope::~ArenaScope()
+{
+    m_arena.release(m_mark);
+}
+
+inline void ArenaScope::release()
+{
+    m_arena.release(m_mark);
+}
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_UTILITY_ARENA_H
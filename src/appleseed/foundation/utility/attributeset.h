@@ -83,6 +83,9 @@ class AttributeSet
         const ChannelID     channel_id,
         const size_t        count);
 
+    // Remove all attributes of a given attribute channel and release their memory.
+    void clear_attributes(const ChannelID channel_id);
+
     // Insert a new attribute at the end of a given attribute channel.
     // Return the index of the attribute in the attribute channel.
     template <typename T>
@@ -143,6 +146,16 @@ inline void AttributeSet::reserve_attributes(
     channel->m_storage.reserve(count * channel->m_value_size);
 }
 
+inline void AttributeSet::clear_attributes(const ChannelID channel_id)
+{
+    // Get the channel descriptor.
+    assert(channel_id < m_channels.size());
+    Channel* channel = m_channels[channel_id];
+
+    // Release memory.
+    clear_release_memory(channel->m_storage);
+}
+
 template <typename T>
 inline size_t AttributeSet::push_attribute(
     const ChannelID         channel_id,
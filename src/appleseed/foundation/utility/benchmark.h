@@ -32,6 +32,7 @@
 
 // Interface headers.
 #include "foundation/utility/benchmark/benchmarkaggregator.h"
+#include "foundation/utility/benchmark/benchmarkcomparison.h"
 #include "foundation/utility/benchmark/benchmarkdatapoint.h"
 #include "foundation/utility/benchmark/benchmarklistenerbase.h"
 #include "foundation/utility/benchmark/benchmarkresult.h"
@@ -207,28 +207,47 @@ struct BenchmarkAggregator::Impl
         if (transcode(node->getNodeName()) != "results")
             return;
 
-        node = node->getFirstChild();
+        bool has_ticks = false;
+        double ticks = 0.0;
+        double ticks_dev = 0.0;
+        size_t measurement_count = 1;
+        double frequency = 0.0;
 
-        while (node)
+        for (node = node->getFirstChild(); node; node = node->getNextSibling())
         {
-            if (node->getNodeType() == DOMNode::ELEMENT_NODE)
-            {
-                if (transcode(node->getNodeName()) == "ticks")
-                {
-                    node = node->getFirstChild();
+            if (node->getNodeType() != DOMNode::ELEMENT_NODE)
+                continue;
 
-                    if (node->getNodeType() == DOMNode::TEXT_NODE)
-                    {
-                        const string text = transcode(node->getTextContent());
-                        const double ticks = from_string<double>(text);
-                        serie.push_back(BenchmarkDataPoint(date, ticks));
-                    }
+            const DOMNode* text_node = node->getFirstChild();
 
-                    break;
-                }
+            if (!text_node || text_node->getNodeType() != DOMNode::TEXT_NODE)
+                continue;
+
+            const string name = transcode(node->getNodeName());
+            const string text = transcode(text_node->getTextContent());
+
+            if (name == "ticks")
+            {
+                ticks = from_string<double>(text);
+                has_ticks = true;
             }
+            else if (name == "ticksdev")
+                ticks_dev = from_string<double>(text);
+            else if (name == "measurements")
+                measurement_count = from_string<size_t>(text);
+            else if (name == "frequency")
+                frequency = from_string<double>(text);
+        }
 
-            node = node->getNextSibling();
+        if (has_ticks)
+        {
+            serie.push_back(
+                BenchmarkDataPoint(
+                    date,
+                    ticks,
+                    ticks_dev,
+                    measurement_count,
+                    frequency));
         }
     }
 };
@@ -0,0 +1,283 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "benchmarkcomparison.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/specialfunctions.h"
+#include "foundation/utility/benchmark/benchmarkaggregator.h"
+#include "foundation/utility/benchmark/benchmarkdatapoint.h"
+#include "foundation/utility/benchmark/benchmarkserie.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/string.h"
+#include "foundation/utility/uid.h"
+
+// Standard headers.
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// BenchmarkComparison class implementation.
+//
+
+namespace
+{
+    // Return the most recent data point of a serie.
+    const BenchmarkDataPoint& get_latest_point(const BenchmarkSerie& serie)
+    {
+        assert(!serie.empty());
+
+        size_t latest = 0;
+
+        for (size_t i = 1; i < serie.size(); ++i)
+        {
+            if (serie[latest] < serie[i])
+                latest = i;
+        }
+
+        return serie[latest];
+    }
+
+    // Running time and standard error of the running time of a data point.
+    struct Timing
+    {
+        double  m_time;
+        double  m_error;
+    };
+
+    Timing get_timing(const BenchmarkDataPoint& point, const double scale)
+    {
+        Timing timing;
+        timing.m_time = point.get_ticks() * scale;
+        timing.m_error =
+            point.get_measurement_count() > 0
+                ? point.get_ticks_dev() * scale / sqrt(static_cast<double>(point.get_measurement_count()))
+                : 0.0;
+        return timing;
+    }
+
+    const char* get_verdict_string(const BenchmarkComparison::Verdict verdict)
+    {
+        switch (verdict)
+        {
+          case BenchmarkComparison::Improvement: return "improvement";
+          case BenchmarkComparison::Regression: return "REGRESSION";
+          default: return "unchanged";
+        }
+    }
+}
+
+struct BenchmarkComparison::Impl
+{
+    double                      m_tolerance;
+    double                      m_confidence;
+    deque<string>               m_names;        // deque: pointers to elements remain valid
+    vector<CaseComparison>      m_cases;
+    size_t                      m_regression_count;
+
+    void compare(
+        const BenchmarkAggregator&  baseline,
+        const BenchmarkAggregator&  candidate)
+    {
+        // Number of standard errors spanned by each side of the confidence interval.
+        const double z = sqrt(2.0) * erf_inv(static_cast<float>(m_confidence));
+
+        const Dictionary& baseline_configs = baseline.get_benchmarks();
+        const Dictionary& candidate_configs = candidate.get_benchmarks();
+
+        for (const_each<DictionaryDictionary> c = baseline_configs.dictionaries(); c; ++c)
+        {
+            if (!candidate_configs.dictionaries().exist(c->key()))
+                continue;
+
+            const Dictionary& candidate_suites = candidate_configs.dictionaries().get(c->key());
+
+            for (const_each<DictionaryDictionary> s = c->value().dictionaries(); s; ++s)
+            {
+                if (!candidate_suites.dictionaries().exist(s->key()))
+                    continue;
+
+                const Dictionary& candidate_cases = candidate_suites.dictionaries().get(s->key());
+
+                for (const_each<StringDictionary> b = s->value().strings(); b; ++b)
+                {
+                    if (!candidate_cases.strings().exist(b->key()))
+                        continue;
+
+                    const BenchmarkSerie& baseline_serie = baseline.get_serie(b->value<UniqueID>());
+                    const BenchmarkSerie& candidate_serie =
+                        candidate.get_serie(candidate_cases.get<UniqueID>(b->key()));
+
+                    if (baseline_serie.empty() || candidate_serie.empty())
+                        continue;
+
+                    m_names.push_back(string(c->key()) + "/" + s->key() + "/" + b->key());
+
+                    compare_case(
+                        m_names.back().c_str(),
+                        get_latest_point(baseline_serie),
+                        get_latest_point(candidate_serie),
+                        z);
+                }
+            }
+        }
+    }
+
+    void compare_case(
+        const char*                 name,
+        const BenchmarkDataPoint&   baseline,
+        const BenchmarkDataPoint&   candidate,
+        const double                z)
+    {
+        // Compare times in seconds when possible since timer frequencies may differ between runs.
+        const bool has_frequencies = baseline.get_frequency() > 0.0 && candidate.get_frequency() > 0.0;
+        const Timing b = get_timing(baseline, has_frequencies ? 1.0 / baseline.get_frequency() : 1.0);
+        const Timing c = get_timing(candidate, has_frequencies ? 1.0 / candidate.get_frequency() : 1.0);
+
+        CaseComparison comparison;
+        comparison.m_name = name;
+        comparison.m_baseline_time = b.m_time;
+        comparison.m_candidate_time = c.m_time;
+
+        if (b.m_time > 0.0)
+        {
+            const double delta = c.m_time - b.m_time;
+            const double margin = z * sqrt(b.m_error * b.m_error + c.m_error * c.m_error);
+            comparison.m_delta = delta / b.m_time;
+            comparison.m_delta_low = (delta - margin) / b.m_time;
+            comparison.m_delta_high = (delta + margin) / b.m_time;
+        }
+        else
+        {
+            comparison.m_delta = 0.0;
+            comparison.m_delta_low = 0.0;
+            comparison.m_delta_high = 0.0;
+        }
+
+        if (comparison.m_delta_low > m_tolerance)
+        {
+            comparison.m_verdict = Regression;
+            ++m_regression_count;
+        }
+        else if (comparison.m_delta_high < -m_tolerance)
+            comparison.m_verdict = Improvement;
+        else comparison.m_verdict = Unchanged;
+
+        m_cases.push_back(comparison);
+    }
+};
+
+BenchmarkComparison::BenchmarkComparison(
+    const BenchmarkAggregator&  baseline,
+    const BenchmarkAggregator&  candidate,
+    const double                tolerance,
+    const double                confidence)
+  : impl(new Impl())
+{
+    assert(tolerance >= 0.0);
+    assert(confidence > 0.0 && confidence < 1.0);
+
+    impl->m_tolerance = tolerance;
+    impl->m_confidence = confidence;
+    impl->m_regression_count = 0;
+
+    impl->compare(baseline, candidate);
+}
+
+BenchmarkComparison::~BenchmarkComparison()
+{
+    delete impl;
+}
+
+size_t BenchmarkComparison::get_case_count() const
+{
+    return impl->m_cases.size();
+}
+
+const BenchmarkComparison::CaseComparison& BenchmarkComparison::get_case(const size_t index) const
+{
+    assert(index < impl->m_cases.size());
+    return impl->m_cases[index];
+}
+
+size_t BenchmarkComparison::get_regression_count() const
+{
+    return impl->m_regression_count;
+}
+
+bool BenchmarkComparison::passed() const
+{
+    return impl->m_regression_count == 0;
+}
+
+void BenchmarkComparison::write_report(ostream& output) const
+{
+    char buf[64];
+
+    for (const_each<vector<CaseComparison> > i = impl->m_cases; i; ++i)
+    {
+        sprintf(
+            buf,
+            "%+7.2f%% [%+7.2f%%, %+7.2f%%]",
+            100.0 * i->m_delta,
+            100.0 * i->m_delta_low,
+            100.0 * i->m_delta_high);
+
+        output << buf << "  " << get_verdict_string(i->m_verdict) << "  " << i->m_name << "\n";
+    }
+
+    sprintf(
+        buf,
+        "%.0f%% confidence, %.1f%% tolerance",
+        100.0 * impl->m_confidence,
+        100.0 * impl->m_tolerance);
+
+    output
+        << (passed() ? "PASSED: " : "FAILED: ")
+        << impl->m_regression_count << " "
+        << plural(impl->m_regression_count, "regression") << " in "
+        << impl->m_cases.size() << " "
+        << plural(impl->m_cases.size(), "benchmark case") << " ("
+        << buf << ").\n";
+}
+
+}   // namespace foundation
@@ -0,0 +1,115 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_BENCHMARK_BENCHMARKCOMPARISON_H
+#define APPLESEED_FOUNDATION_UTILITY_BENCHMARK_BENCHMARKCOMPARISON_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+#include <iosfwd>
+
+// Forward declarations.
+namespace foundation    { class BenchmarkAggregator; }
+
+namespace foundation
+{
+
+//
+// Compare the latest results of the benchmark cases of two aggregators, a baseline
+// and a candidate.
+//
+// For each benchmark case present in both, the relative change of the running time
+// is estimated along with a confidence interval derived from the standard deviation
+// and the number of measurements of both results. A case is a regression when the
+// whole interval lies above the tolerance, and an improvement when it lies below its
+// opposite. Results without a standard deviation are compared on their running time
+// alone.
+//
+
+class APPLESEED_DLLSYMBOL BenchmarkComparison
+  : public NonCopyable
+{
+  public:
+    enum Verdict
+    {
+        Unchanged,
+        Improvement,
+        Regression
+    };
+
+    struct CaseComparison
+    {
+        const char*     m_name;                 // configuration/suite/case
+        double          m_baseline_time;        // in seconds, or in ticks if a timer frequency is unknown
+        double          m_candidate_time;       // same unit as m_baseline_time
+        double          m_delta;                // relative change of the running time
+        double          m_delta_low;            // lower bound of the confidence interval of m_delta
+        double          m_delta_high;           // upper bound of the confidence interval of m_delta
+        Verdict         m_verdict;
+    };
+
+    // Constructor. tolerance is the relative change of the running time below which
+    // cases are considered unchanged, confidence is the level of the confidence intervals.
+    BenchmarkComparison(
+        const BenchmarkAggregator&  baseline,
+        const BenchmarkAggregator&  candidate,
+        const double                tolerance = 0.05,
+        const double                confidence = 0.95);
+
+    // Destructor.
+    ~BenchmarkComparison();
+
+    // Access the comparisons of the benchmark cases present in both aggregators.
+    size_t get_case_count() const;
+    const CaseComparison& get_case(const size_t index) const;
+
+    // Return the number of cases that regressed.
+    size_t get_regression_count() const;
+
+    // Return true if no case regressed.
+    bool passed() const;
+
+    // Write a human-readable report of the comparison.
+    void write_report(std::ostream& output) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_BENCHMARK_BENCHMARKCOMPARISON_H
@@ -41,6 +41,9 @@
 #include "boost/date_time/gregorian/gregorian.hpp"
 #include "boost/date_time/posix_time/posix_time.hpp"
 
+// Standard headers.
+#include <cstddef>
+
 namespace foundation
 {
 
@@ -53,6 +56,15 @@ class APPLESEED_DLLSYMBOL BenchmarkDataPoint
         const boost::posix_time::ptime& date,
         const double                    ticks);
 
+    // ticks_dev is the standard deviation of a single measurement, in ticks, or 0 if unknown.
+    // frequency is the frequency of the timer, or 0 if unknown.
+    BenchmarkDataPoint(
+        const boost::posix_time::ptime& date,
+        const double                    ticks,
+        const double                    ticks_dev,
+        const size_t                    measurement_count,
+        const double                    frequency);
+
     static uint64 ptime_to_microseconds(const boost::posix_time::ptime& time);
 
     static boost::posix_time::ptime microseconds_to_ptime(const uint64 microseconds);
@@ -60,6 +72,9 @@ class APPLESEED_DLLSYMBOL BenchmarkDataPoint
     boost::posix_time::ptime get_date() const;
 
     double get_ticks() const;
+    double get_ticks_dev() const;
+    size_t get_measurement_count() const;
+    double get_frequency() const;
 
     bool operator==(const BenchmarkDataPoint& rhs) const;
     bool operator!=(const BenchmarkDataPoint& rhs) const;
@@ -68,6 +83,9 @@ class APPLESEED_DLLSYMBOL BenchmarkDataPoint
   private:
     uint64  m_date_microseconds;
     double  m_ticks;
+    double  m_ticks_dev;
+    size_t  m_measurement_count;
+    double  m_frequency;
 };
 
 
@@ -89,6 +107,23 @@ inline BenchmarkDataPoint::BenchmarkDataPoint(
     const double                        ticks)
   : m_date_microseconds(ptime_to_microseconds(date))
   , m_ticks(ticks)
+  , m_ticks_dev(0.0)
+  , m_measurement_count(1)
+  , m_frequency(0.0)
+{
+}
+
+inline BenchmarkDataPoint::BenchmarkDataPoint(
+    const boost::posix_time::ptime&     date,
+    const double                        ticks,
+    const double                        ticks_dev,
+    const size_t                        measurement_count,
+    const double                        frequency)
+  : m_date_microseconds(ptime_to_microseconds(date))
+  , m_ticks(ticks)
+  , m_ticks_dev(ticks_dev)
+  , m_measurement_count(measurement_count)
+  , m_frequency(frequency)
 {
 }
 
@@ -112,6 +147,21 @@ inline double BenchmarkDataPoint::get_ticks() const
     return m_ticks;
 }
 
+inline double BenchmarkDataPoint::get_ticks_dev() const
+{
+    return m_ticks_dev;
+}
+
+inline size_t BenchmarkDataPoint::get_measurement_count() const
+{
+    return m_measurement_count;
+}
+
+inline double BenchmarkDataPoint::get_frequency() const
+{
+    return m_frequency;
+}
+
 inline bool BenchmarkDataPoint::operator==(const BenchmarkDataPoint& rhs) const
 {
     return m_date_microseconds == rhs.m_date_microseconds && m_ticks == rhs.m_ticks;
@@ -31,6 +31,7 @@
 #include "benchmarksuite.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/population.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/thread.h"
@@ -117,12 +118,14 @@ struct BenchmarkSuite::Impl
         return static_cast<double>(stopwatch.get_ticks());
     }
 
+    // Return the lowest runtime of a number of measurements, and optionally collect all of them.
     template <typename MeasurementFunction>
     static double measure_runtime(
         IBenchmarkCase*         benchmark,
         StopwatchType&          stopwatch,
         MeasurementFunction&    measurement_function,
-        const size_t            measurement_count)
+        const size_t            measurement_count,
+        Population<double>*     runtimes = 0)
     {
         double lowest_runtime = numeric_limits<double>::max();
 
@@ -130,6 +133,9 @@ struct BenchmarkSuite::Impl
         {
             const double runtime = measurement_function(benchmark, stopwatch);
             lowest_runtime = min(lowest_runtime, runtime);
+
+            if (runtimes)
+                runtimes->insert(runtime);
         }
 
         return lowest_runtime;
@@ -250,12 +256,14 @@ void BenchmarkSuite::run(
                 Impl::measure_call_overhead_ticks(stopwatch, measurement_count);
 
             // Run the benchmark case.
+            Population<double> runtimes;
             const double runtime_ticks =
                 Impl::measure_runtime(
                     benchmark.get(),
                     stopwatch,
                     BenchmarkSuite::Impl::measure_runtime_ticks,
-                    measurement_count);
+                    measurement_count,
+                    &runtimes);
 
 #ifdef GENERATE_BENCHMARK_PLOTS
             vector<Vector2d> points;
@@ -290,6 +298,9 @@ void BenchmarkSuite::run(
             timing_result.m_measurement_count = measurement_count;
             timing_result.m_frequency = static_cast<double>(stopwatch.get_timer().frequency());
             timing_result.m_ticks = runtime_ticks > overhead_ticks ? runtime_ticks - overhead_ticks : 0.0;
+            timing_result.m_ticks_dev = runtimes.get_dev();
+            timing_result.m_processed_bytes = benchmark->get_processed_bytes();
+            timing_result.m_processed_items = benchmark->get_processed_items();
 
             // Post the timing result.
             suite_result.write(
@@ -36,6 +36,9 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 namespace foundation
 {
 
@@ -47,6 +50,13 @@ class APPLESEED_DLLSYMBOL IBenchmarkCase
   : public NonCopyable
 {
   public:
+    // Constructor.
+    IBenchmarkCase()
+      : m_processed_bytes(0)
+      , m_processed_items(0)
+    {
+    }
+
     // Destructor.
     virtual ~IBenchmarkCase() {}
 
@@ -55,6 +65,20 @@ class APPLESEED_DLLSYMBOL IBenchmarkCase
 
     // Run the benchmark case.
     virtual void run() = 0;
+
+    // Return the number of bytes and of items (triangles, pixels...) processed
+    // by one run of the benchmark case, or 0 if the case didn't report them.
+    size_t get_processed_bytes() const { return m_processed_bytes; }
+    size_t get_processed_items() const { return m_processed_items; }
+
+  protected:
+    // Report the amount of data processed by one run, to get throughputs in addition to call rates.
+    void set_processed_bytes(const size_t bytes) { m_processed_bytes = bytes; }
+    void set_processed_items(const size_t items) { m_processed_items = items; }
+
+  private:
+    size_t m_processed_bytes;
+    size_t m_processed_items;
 };
 
 }       // namespace foundation
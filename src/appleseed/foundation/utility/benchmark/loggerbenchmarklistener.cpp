@@ -100,6 +100,7 @@ namespace
         {
             TimingResult result;
             result.m_ticks = 1.0;
+            result.m_ticks_dev = 0.0;
             result.m_frequency = rate;
             return pretty_callrate(result);
         }
@@ -185,6 +186,20 @@ namespace
                 callrate_string =
                     "(" + pretty_callrate(timing_result, 3) +
                     " at " + pretty_scalar(freq_mhz, 3) + " MHz)";
+
+                const double seconds = timing_result.m_ticks / timing_result.m_frequency;
+
+                if (timing_result.m_processed_bytes > 0)
+                {
+                    const double mb = static_cast<double>(timing_result.m_processed_bytes) / (1024.0 * 1024.0);
+                    callrate_string += " " + pretty_scalar(mb / seconds, 1) + " MB/s";
+                }
+
+                if (timing_result.m_processed_items > 0)
+                {
+                    const double items = static_cast<double>(timing_result.m_processed_items);
+                    callrate_string += " " + pretty_uint(static_cast<uint64>(items / seconds)) + " items/s";
+                }
             }
 
             print_suite_name(benchmark_suite);
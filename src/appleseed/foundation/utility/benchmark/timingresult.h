@@ -47,6 +47,9 @@ class TimingResult
     size_t  m_measurement_count;    // number of measurements per benchmark case
     double  m_frequency;            // frequency of the timer used for the measurement
     double  m_ticks;                // average running time, in timer ticks
+    double  m_ticks_dev;            // standard deviation of the running time of one measurement, in timer ticks, 0 if unknown
+    size_t  m_processed_bytes;      // number of bytes processed per iteration, 0 if unknown
+    size_t  m_processed_items;      // number of items processed per iteration, 0 if unknown
 };
 
 }       // namespace foundation
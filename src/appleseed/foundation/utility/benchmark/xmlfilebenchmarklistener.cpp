@@ -182,6 +182,30 @@ void XMLFileBenchmarkListener::write(
         impl->m_indenter.c_str(),
         timing_result.m_ticks);
 
+    if (timing_result.m_ticks_dev > 0.0)
+    {
+        fprintf(impl->m_file,
+            "%s<ticksdev>%f</ticksdev>\n",
+            impl->m_indenter.c_str(),
+            timing_result.m_ticks_dev);
+    }
+
+    if (timing_result.m_processed_bytes > 0)
+    {
+        fprintf(impl->m_file,
+            "%s<processedbytes>" FMT_SIZE_T "</processedbytes>\n",
+            impl->m_indenter.c_str(),
+            timing_result.m_processed_bytes);
+    }
+
+    if (timing_result.m_processed_items > 0)
+    {
+        fprintf(impl->m_file,
+            "%s<processeditems>" FMT_SIZE_T "</processeditems>\n",
+            impl->m_indenter.c_str(),
+            timing_result.m_processed_items);
+    }
+
     --impl->m_indenter;
 
     fprintf(impl->m_file, "%s</results>\n", impl->m_indenter.c_str());
@@ -76,6 +76,22 @@ namespace cache_impl
             + "  hits " + pretty_uint(m_hit_count)
             + "  misses " + pretty_uint(m_miss_count);
     }
+
+    void CacheStatisticsEntry::write_json(ostream& output) const
+    {
+        const uint64 accesses = m_hit_count + m_miss_count;
+
+        output << "{ \"accesses\": " << accesses;
+        output << ", \"hits\": " << m_hit_count;
+        output << ", \"misses\": " << m_miss_count;
+        output << ", \"efficiency\": ";
+
+        if (accesses == 0)
+            output << "null";
+        else write_json_number(output, 100.0 * m_hit_count / accesses);
+
+        output << " }";
+    }
 }
 
 }   // namespace foundation
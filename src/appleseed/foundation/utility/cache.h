@@ -383,6 +383,9 @@ class SACache
     // Clear the cache.
     void clear();
 
+    // Unload all elements and clear the cache.
+    void flush();
+
     // Get an element from the cache.
     ElementType& get(const KeyType& key);
 
@@ -473,6 +476,9 @@ class LRUCache
     // Get an element from the cache.
     ElementType& get(const KeyType& key);
 
+    // Return true if an element is in the cache. Does not affect the LRU order or the statistics.
+    bool contains(const KeyType& key) const;
+
     // Return the size (in bytes) of this object in memory.
     size_t get_memory_size() const;
 
@@ -759,6 +765,22 @@ clear()
         m_lines[i].invalidate(m_invalid_key);
 }
 
+FOUNDATION_SACACHE_TEMPLATE_DEF(void)
+flush()
+{
+    for (size_t i = 0; i < Lines; ++i)
+    {
+        for (size_t j = 0; j < LineType::Ways; ++j)
+        {
+            EntryType& entry = m_lines[i].get_entry(j);
+            if (entry.m_key != m_invalid_key)
+                m_element_swapper.unload(entry.m_key, entry.m_element);
+        }
+
+        m_lines[i].invalidate(m_invalid_key);
+    }
+}
+
 FOUNDATION_SACACHE_TEMPLATE_DEF(inline Element&)
 get(const KeyType& key)
 {
@@ -968,6 +990,12 @@ get(const KeyType& key)
     }
 }
 
+FOUNDATION_LRUCACHE_TEMPLATE_DEF(inline bool)
+contains(const KeyType& key) const
+{
+    return m_index.find(key) != m_index.end();
+}
+
 FOUNDATION_LRUCACHE_TEMPLATE_DEF(inline size_t)
 get_memory_size() const
 {
@@ -1108,6 +1136,7 @@ namespace cache_impl
         virtual std::auto_ptr<Entry> clone() const APPLESEED_OVERRIDE;
         virtual void merge(const Entry* other) APPLESEED_OVERRIDE;
         virtual std::string to_string() const APPLESEED_OVERRIDE;
+        virtual void write_json(std::ostream& output) const APPLESEED_OVERRIDE;
     };
 }
 
@@ -33,8 +33,16 @@
 // appleseed.foundation headers.
 #include "foundation/utility/foreach.h"
 
+// Boost headers.
+#include "boost/functional/hash.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/unordered_map.hpp"
+#include "boost/unordered_set.hpp"
+
 // Standard headers.
 #include <cassert>
+#include <cstring>
 #include <map>
 
 using namespace std;
@@ -42,7 +50,62 @@ using namespace std;
 namespace foundation
 {
 
-typedef map<string, string> StringMap;
+namespace
+{
+    //
+    // Keys of string dictionaries are interned: the same few parameter names are
+    // used by thousands of entities, so all dictionaries share a single copy of
+    // each distinct key. Interned keys are never released.
+    //
+
+    class KeyInterner
+    {
+      public:
+        const char* intern(const char* key)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            return m_keys.insert(key).first->c_str();
+        }
+
+      private:
+        boost::mutex                    m_mutex;
+        boost::unordered_set<string>    m_keys;
+    };
+
+    const char* intern_key(const char* key)
+    {
+        static KeyInterner interner;
+        return interner.intern(key);
+    }
+
+    struct KeyLess
+    {
+        bool operator()(const char* lhs, const char* rhs) const
+        {
+            return strcmp(lhs, rhs) < 0;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const char* key) const
+        {
+            return boost::hash_range(key, key + strlen(key));
+        }
+    };
+
+    struct KeyEqual
+    {
+        bool operator()(const char* lhs, const char* rhs) const
+        {
+            return lhs == rhs || strcmp(lhs, rhs) == 0;
+        }
+    };
+}
+
+// Items are kept sorted by key for deterministic iteration; lookups go through a hash index.
+typedef map<const char*, string, KeyLess> StringMap;
+typedef boost::unordered_map<const char*, StringMap::iterator, KeyHash, KeyEqual> StringIndex;
 typedef map<string, Dictionary> DictionaryMap;
 
 
@@ -105,7 +168,7 @@ const StringDictionary::const_iterator::value_type& StringDictionary::const_iter
 
 const char* StringDictionary::const_iterator::key() const
 {
-    return impl->m_it->first.c_str();
+    return impl->m_it->first;
 }
 
 const char* StringDictionary::const_iterator::value() const
@@ -120,7 +183,40 @@ const char* StringDictionary::const_iterator::value() const
 
 struct StringDictionary::Impl
 {
-    StringMap m_strings;
+    StringMap   m_strings;
+    StringIndex m_index;
+
+    Impl()
+    {
+    }
+
+    Impl(const Impl& rhs)
+      : m_strings(rhs.m_strings)
+    {
+        rebuild_index();
+    }
+
+    Impl& operator=(const Impl& rhs)
+    {
+        m_strings = rhs.m_strings;
+        rebuild_index();
+        return *this;
+    }
+
+    void rebuild_index()
+    {
+        m_index.clear();
+        m_index.rehash(m_strings.size());
+
+        for (StringMap::iterator i = m_strings.begin(), e = m_strings.end(); i != e; ++i)
+            m_index.insert(make_pair(i->first, i));
+    }
+
+    StringMap::iterator find(const char* key)
+    {
+        const StringIndex::const_iterator i = m_index.find(key);
+        return i == m_index.end() ? m_strings.end() : i->second;
+    }
 };
 
 StringDictionary::StringDictionary()
@@ -154,6 +250,7 @@ bool StringDictionary::operator==(const StringDictionary& rhs) const
         it != impl->m_strings.end();
         ++it, ++rhs_it)
     {
+        // Keys are interned, comparing pointers is enough.
         if (it->first != rhs_it->first || it->second != rhs_it->second)
             return false;
     }
@@ -179,6 +276,7 @@ bool StringDictionary::empty() const
 void StringDictionary::clear()
 {
     impl->m_strings.clear();
+    impl->m_index.clear();
 }
 
 StringDictionary& StringDictionary::insert(const char* key, const char* value)
@@ -186,7 +284,15 @@ StringDictionary& StringDictionary::insert(const char* key, const char* value)
     assert(key);
     assert(value);
 
-    impl->m_strings[key] = value;
+    const StringMap::iterator i = impl->find(key);
+
+    if (i == impl->m_strings.end())
+    {
+        const char* interned_key = intern_key(key);
+        const StringMap::iterator j = impl->m_strings.insert(make_pair(interned_key, string(value))).first;
+        impl->m_index.insert(make_pair(interned_key, j));
+    }
+    else i->second = value;
 
     return *this;
 }
@@ -196,7 +302,7 @@ StringDictionary& StringDictionary::set(const char* key, const char* value)
     assert(key);
     assert(value);
 
-    const StringMap::iterator i = impl->m_strings.find(key);
+    const StringMap::iterator i = impl->find(key);
 
     if (i == impl->m_strings.end())
         throw ExceptionDictionaryKeyNotFound(key);
@@ -210,7 +316,7 @@ const char* StringDictionary::get(const char* key) const
 {
     assert(key);
 
-    const StringMap::const_iterator i = impl->m_strings.find(key);
+    const StringMap::const_iterator i = impl->find(key);
 
     if (i == impl->m_strings.end())
         throw ExceptionDictionaryKeyNotFound(key);
@@ -222,17 +328,20 @@ bool StringDictionary::exist(const char* key) const
 {
     assert(key);
 
-    return impl->m_strings.find(key) != impl->m_strings.end();
+    return impl->m_index.find(key) != impl->m_index.end();
 }
 
 StringDictionary& StringDictionary::remove(const char* key)
 {
     assert(key);
 
-    const StringMap::iterator i = impl->m_strings.find(key);
+    const StringIndex::iterator i = impl->m_index.find(key);
 
-    if (i != impl->m_strings.end())
-        impl->m_strings.erase(i);
+    if (i != impl->m_index.end())
+    {
+        impl->m_strings.erase(i->second);
+        impl->m_index.erase(i);
+    }
 
     return *this;
 }
@@ -0,0 +1,330 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "eventtracer.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/singleton.h"
+#include "foundation/platform/thread.h"
+#include "foundation/utility/json.h"
+
+// Boost headers.
+#include "boost/chrono/system_clocks.hpp"
+#include "boost/thread/tss.hpp"
+
+// Standard headers.
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// EventTracer class implementation.
+//
+
+namespace
+{
+    struct Event
+    {
+        const char*     m_category;
+        const char*     m_name;
+        uint64          m_begin;
+        uint64          m_duration;
+        char            m_detail[EventTracer::MaxDetailLength + 1];
+    };
+
+    struct ThreadBuffer
+    {
+        boost::mutex*   m_owner_mutex;
+        size_t          m_thread_index;
+        string          m_thread_name;      // protected by the tracer's mutex
+        bool            m_retired;          // protected by the tracer's mutex
+        vector<Event>   m_events;
+        size_t          m_next;             // index of the next event to write
+        size_t          m_count;            // number of valid events
+    };
+
+    // Called when a thread that recorded events exits. The buffer remains owned by
+    // the tracer so that the events of that thread can still be exported.
+    void retire_thread_buffer(ThreadBuffer* buffer)
+    {
+        boost::mutex::scoped_lock lock(*buffer->m_owner_mutex);
+        buffer->m_retired = true;
+    }
+}
+
+struct EventTracer::Impl
+{
+    typedef boost::chrono::steady_clock Clock;
+
+    const size_t                            m_max_events_per_thread;
+    Clock::time_point                       m_origin;
+    mutable boost::mutex                    m_mutex;
+    vector<ThreadBuffer*>                   m_buffers;
+    size_t                                  m_next_thread_index;
+    boost::thread_specific_ptr<ThreadBuffer> m_thread_buffer;
+
+    explicit Impl(const size_t max_events_per_thread)
+      : m_max_events_per_thread(max_events_per_thread)
+      , m_origin(Clock::now())
+      , m_next_thread_index(0)
+      , m_thread_buffer(&retire_thread_buffer)
+    {
+    }
+
+    ~Impl()
+    {
+        // Detach the calling thread's buffer without invoking the cleanup function.
+        m_thread_buffer.release();
+
+        for (size_t i = 0; i < m_buffers.size(); ++i)
+            delete m_buffers[i];
+    }
+
+    ThreadBuffer& get_thread_buffer()
+    {
+        ThreadBuffer* buffer = m_thread_buffer.get();
+
+        if (buffer == 0)
+        {
+            buffer = new ThreadBuffer();
+            buffer->m_owner_mutex = &m_mutex;
+            buffer->m_retired = false;
+            buffer->m_next = 0;
+            buffer->m_count = 0;
+
+            boost::mutex::scoped_lock lock(m_mutex);
+            buffer->m_thread_index = m_next_thread_index++;
+            m_buffers.push_back(buffer);
+            m_thread_buffer.reset(buffer);
+        }
+
+        return *buffer;
+    }
+};
+
+EventTracer::EventTracer(const size_t max_events_per_thread)
+  : impl(new Impl(max_events_per_thread))
+  , m_enabled(false)
+{
+    assert(max_events_per_thread > 0);
+}
+
+EventTracer::~EventTracer()
+{
+    delete impl;
+}
+
+void EventTracer::set_enabled(const bool enabled)
+{
+    m_enabled.store(enabled, boost::memory_order_relaxed);
+}
+
+void EventTracer::clear()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    vector<ThreadBuffer*> live_buffers;
+
+    for (size_t i = 0; i < impl->m_buffers.size(); ++i)
+    {
+        ThreadBuffer* buffer = impl->m_buffers[i];
+
+        if (buffer->m_retired)
+            delete buffer;
+        else
+        {
+            buffer->m_next = 0;
+            buffer->m_count = 0;
+            live_buffers.push_back(buffer);
+        }
+    }
+
+    impl->m_buffers.swap(live_buffers);
+    impl->m_origin = Impl::Clock::now();
+}
+
+void EventTracer::set_thread_name(const char* name)
+{
+    ThreadBuffer& buffer = impl->get_thread_buffer();
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    buffer.m_thread_name = name;
+}
+
+uint64 EventTracer::now() const
+{
+    return
+        static_cast<uint64>(
+            boost::chrono::duration_cast<boost::chrono::microseconds>(
+                Impl::Clock::now() - impl->m_origin).count());
+}
+
+void EventTracer::record(
+    const char*         category,
+    const char*         name,
+    const uint64        begin,
+    const uint64        end,
+    const char*         detail)
+{
+    assert(category);
+    assert(name);
+
+    ThreadBuffer& buffer = impl->get_thread_buffer();
+
+    // Only allocate event storage for threads that actually record events.
+    if (buffer.m_events.empty())
+        buffer.m_events.resize(impl->m_max_events_per_thread);
+
+    Event& event = buffer.m_events[buffer.m_next];
+
+    event.m_category = category;
+    event.m_name = name;
+    event.m_begin = begin;
+    event.m_duration = end > begin ? end - begin : 0;
+
+    if (detail)
+    {
+        strncpy(event.m_detail, detail, MaxDetailLength);
+        event.m_detail[MaxDetailLength] = '\0';
+    }
+    else event.m_detail[0] = '\0';
+
+    if (++buffer.m_next == buffer.m_events.size())
+        buffer.m_next = 0;
+
+    if (buffer.m_count < buffer.m_events.size())
+        ++buffer.m_count;
+}
+
+size_t EventTracer::get_event_count() const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    size_t count = 0;
+
+    for (size_t i = 0; i < impl->m_buffers.size(); ++i)
+        count += impl->m_buffers[i]->m_count;
+
+    return count;
+}
+
+void EventTracer::write_chrome_trace(ostream& output) const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    output << "{\"traceEvents\":[";
+
+    bool first = true;
+
+    for (size_t i = 0; i < impl->m_buffers.size(); ++i)
+    {
+        const ThreadBuffer& buffer = *impl->m_buffers[i];
+
+        if (!buffer.m_thread_name.empty())
+        {
+            output << (first ? "\n" : ",\n");
+            output << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.m_thread_index;
+            output << ",\"args\":{\"name\":";
+            write_json_string(output, buffer.m_thread_name.c_str());
+            output << "}}";
+            first = false;
+        }
+
+        // Write events from oldest to newest.
+        const size_t capacity = buffer.m_events.size();
+        const size_t oldest = buffer.m_count < capacity ? 0 : buffer.m_next;
+
+        for (size_t j = 0; j < buffer.m_count; ++j)
+        {
+            const Event& event = buffer.m_events[(oldest + j) % capacity];
+
+            output << (first ? "\n" : ",\n");
+            output << "{\"name\":";
+            write_json_string(output, event.m_name);
+            output << ",\"cat\":";
+            write_json_string(output, event.m_category);
+            output << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.m_thread_index;
+            output << ",\"ts\":" << event.m_begin;
+            output << ",\"dur\":" << event.m_duration;
+
+            if (event.m_detail[0] != '\0')
+            {
+                output << ",\"args\":{\"detail\":";
+                write_json_string(output, event.m_detail);
+                output << "}";
+            }
+
+            output << "}";
+            first = false;
+        }
+    }
+
+    output << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+bool EventTracer::write_chrome_trace(const char* filepath) const
+{
+    ofstream file(filepath);
+
+    if (!file.is_open())
+        return false;
+
+    write_chrome_trace(file);
+
+    return file.good();
+}
+
+namespace
+{
+    class GlobalEventTracer
+      : public Singleton<EventTracer>
+    {
+      private:
+        friend class Singleton<EventTracer>;
+
+        GlobalEventTracer() {}
+    };
+}
+
+EventTracer& global_event_tracer()
+{
+    return GlobalEventTracer::instance();
+}
+
+}   // namespace foundation
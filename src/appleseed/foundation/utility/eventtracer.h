@@ -0,0 +1,189 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_EVENTTRACER_H
+#define APPLESEED_FOUNDATION_UTILITY_EVENTTRACER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <cstring>
+#include <iosfwd>
+
+namespace foundation
+{
+
+//
+// Records timed events (jobs, tiles, passes, tree builds, texture loads, etc.) and
+// exports them as a timeline in the Chrome trace event format, which can be opened
+// in chrome://tracing or in the Perfetto UI.
+//
+// Recording is disabled by default; while disabled, an event costs a single relaxed
+// atomic load. Each thread records into its own fixed-size ring buffer, so recording
+// never takes a lock; once a ring buffer is full, the oldest events of that thread
+// are overwritten.
+//
+// Category and name strings are not copied and must outlive the tracer (in practice,
+// they are string literals). Details (e.g. entity names) are copied and truncated.
+// clear() and the export methods must not be called while threads are recording.
+//
+
+class APPLESEED_DLLSYMBOL EventTracer
+  : public NonCopyable
+{
+  public:
+    // Maximum length of the detail string of an event, excluding the terminating null.
+    enum { MaxDetailLength = 31 };
+
+    // Constructor.
+    explicit EventTracer(const size_t max_events_per_thread = 8192);
+
+    // Destructor.
+    ~EventTracer();
+
+    // Enable or disable recording.
+    void set_enabled(const bool enabled);
+    bool is_enabled() const;
+
+    // Remove all recorded events and restart the clock.
+    void clear();
+
+    // Name the calling thread in exported timelines. Thread-safe.
+    void set_thread_name(const char* name);
+
+    // Return the time elapsed since the tracer was created or last cleared, in microseconds.
+    uint64 now() const;
+
+    // Record an event of the calling thread. Times are in microseconds. Thread-safe.
+    void record(
+        const char*     category,
+        const char*     name,
+        const uint64    begin,
+        const uint64    end,
+        const char*     detail = 0);
+
+    // Return the number of events currently held by the tracer.
+    size_t get_event_count() const;
+
+    // Write all events to a stream or to a file in the Chrome trace event format.
+    void write_chrome_trace(std::ostream& output) const;
+    bool write_chrome_trace(const char* filepath) const;
+
+  private:
+    struct Impl;
+    Impl*               impl;
+
+    boost::atomic<bool> m_enabled;
+};
+
+// Return the globally accessible event tracer.
+APPLESEED_DLLSYMBOL EventTracer& global_event_tracer();
+
+
+//
+// Record an event in the global event tracer for the duration of a scope.
+//
+
+class EventTraceScope
+  : public NonCopyable
+{
+  public:
+    EventTraceScope(
+        const char*     category,
+        const char*     name,
+        const char*     detail = 0);
+
+    ~EventTraceScope();
+
+  private:
+    const char*         m_category;
+    const char*         m_name;
+    const bool          m_enabled;
+    uint64              m_begin;
+    char                m_detail[EventTracer::MaxDetailLength + 1];
+};
+
+
+//
+// EventTracer class implementation.
+//
+
+inline bool EventTracer::is_enabled() const
+{
+    return m_enabled.load(boost::memory_order_relaxed);
+}
+
+
+//
+// EventTraceScope class implementation.
+//
+
+inline EventTraceScope::EventTraceScope(
+    const char*         category,
+    const char*         name,
+    const char*         detail)
+  : m_category(category)
+  , m_name(name)
+  , m_enabled(global_event_tracer().is_enabled())
+{
+    if (m_enabled)
+    {
+        if (detail)
+        {
+            std::strncpy(m_detail, detail, EventTracer::MaxDetailLength);
+            m_detail[EventTracer::MaxDetailLength] = '\0';
+        }
+        else m_detail[0] = '\0';
+
+        m_begin = global_event_tracer().now();
+    }
+}
+
+inline EventTraceScope::~EventTraceScope()
+{
+    if (m_enabled)
+    {
+        EventTracer& tracer = global_event_tracer();
+        tracer.record(m_category, m_name, m_begin, tracer.now(), m_detail[0] != '\0' ? m_detail : 0);
+    }
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_EVENTTRACER_H
@@ -31,12 +31,15 @@
 #include "jobmanager.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/system.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/job/jobqueue.h"
 #include "foundation/utility/job/workerthread.h"
 #include "foundation/utility/log.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <vector>
 
@@ -57,7 +60,9 @@ struct JobManager::Impl
     Logger&             m_logger;
     JobQueue&           m_job_queue;
     size_t              m_thread_count;
+    size_t              m_active_thread_count;
     const int           m_flags;
+    bool                m_paused;
     WorkerThreads       m_worker_threads;
 
     // Constructor.
@@ -69,9 +74,56 @@ struct JobManager::Impl
       : m_logger(logger)
       , m_job_queue(job_queue)
       , m_thread_count(thread_count)
+      , m_active_thread_count(thread_count)
       , m_flags(flags)
+      , m_paused(false)
     {
     }
+
+    // Park or unpark worker threads according to the number of active worker threads.
+    void update_parked_threads()
+    {
+        for (size_t i = 0; i < m_worker_threads.size(); ++i)
+        {
+            if (m_paused || i >= m_active_thread_count)
+                m_worker_threads[i]->pause();
+            else
+                m_worker_threads[i]->resume();
+        }
+    }
+
+    // Return logical CPU cores ordered by NUMA node, so that consecutive
+    // worker threads (which steal jobs from each other first) share a node.
+    static vector<size_t> get_cpu_cores_by_numa_node()
+    {
+        const size_t core_count = System::get_logical_cpu_core_count();
+        const size_t node_count = System::get_numa_node_count();
+
+        vector<size_t> core_nodes(core_count);
+        for (size_t i = 0; i < core_count; ++i)
+            core_nodes[i] = System::get_numa_node(i);
+
+        vector<size_t> cores;
+        cores.reserve(core_count);
+
+        for (size_t node = 0; node < node_count; ++node)
+        {
+            for (size_t i = 0; i < core_count; ++i)
+            {
+                if (core_nodes[i] == node)
+                    cores.push_back(i);
+            }
+        }
+
+        // Cores whose node is unknown or out of range are appended at the end.
+        for (size_t i = 0; i < core_count; ++i)
+        {
+            if (core_nodes[i] >= node_count)
+                cores.push_back(i);
+        }
+
+        return cores;
+    }
 };
 
 JobManager::JobManager(
@@ -103,6 +155,22 @@ void JobManager::start()
     // Create worker threads if they don't already exist.
     if (impl->m_worker_threads.empty())
     {
+        vector<size_t> cpu_cores;
+        if (impl->m_flags & PinWorkerThreads)
+        {
+            cpu_cores = Impl::get_cpu_cores_by_numa_node();
+
+            LOG_DEBUG(
+                impl->m_logger,
+                "pinning " FMT_SIZE_T " worker thread%s to " FMT_SIZE_T " cpu core%s on " FMT_SIZE_T " numa node%s.",
+                impl->m_thread_count,
+                impl->m_thread_count > 1 ? "s" : "",
+                cpu_cores.size(),
+                cpu_cores.size() > 1 ? "s" : "",
+                System::get_numa_node_count(),
+                System::get_numa_node_count() > 1 ? "s" : "");
+        }
+
         for (size_t i = 0; i < impl->m_thread_count; ++i)
         {
             impl->m_worker_threads.push_back(
@@ -110,13 +178,18 @@ void JobManager::start()
                     i,
                     impl->m_logger,
                     impl->m_job_queue,
-                    impl->m_flags));
+                    impl->m_flags,
+                    cpu_cores.empty() ? WorkerThread::NoCpuCore : cpu_cores[i % cpu_cores.size()]));
         }
     }
 
     // Start worker threads.
     for (each<Impl::WorkerThreads> i = impl->m_worker_threads; i; ++i)
         (*i)->start();
+
+    // Park worker threads beyond the number of active worker threads.
+    if (impl->m_active_thread_count < impl->m_thread_count)
+        impl->update_parked_threads();
 }
 
 void JobManager::stop()
@@ -129,14 +202,26 @@ void JobManager::stop()
 
 void JobManager::pause()
 {
-    for (each<Impl::WorkerThreads> i = impl->m_worker_threads; i; ++i)
-        (*i)->pause();
+    impl->m_paused = true;
+    impl->update_parked_threads();
 }
 
 void JobManager::resume()
 {
-    for (each<Impl::WorkerThreads> i = impl->m_worker_threads; i; ++i)
-        (*i)->resume();
+    impl->m_paused = false;
+    impl->update_parked_threads();
+}
+
+void JobManager::set_active_thread_count(const size_t thread_count)
+{
+    impl->m_active_thread_count = max<size_t>(min(thread_count, impl->m_thread_count), 1);
+
+    impl->update_parked_threads();
+}
+
+size_t JobManager::get_active_thread_count() const
+{
+    return impl->m_active_thread_count;
 }
 
 }   // namespace foundation
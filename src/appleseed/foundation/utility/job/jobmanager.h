@@ -59,7 +59,8 @@ class APPLESEED_DLLSYMBOL JobManager
     enum Flags
     {
         KeepRunningOnEmptyQueue = 1 << 0,   // the worker thread keeps running even if the job queue is empty
-        KeepRunningOnJobFailure = 1 << 1    // the worker thread keeps executing jobs from the work queue even if one or more jobs failed
+        KeepRunningOnJobFailure = 1 << 1,   // the worker thread keeps executing jobs from the work queue even if one or more jobs failed
+        PinWorkerThreads        = 1 << 2    // bind each worker thread to a CPU core, consecutive worker threads sharing a NUMA node
     };
 
     // Constructor.
@@ -75,6 +76,15 @@ class APPLESEED_DLLSYMBOL JobManager
     // Return the number of worker threads.
     size_t get_thread_count() const;
 
+    // Set the number of worker threads allowed to pick up new jobs, in [1, get_thread_count()].
+    // The other worker threads are parked once they have completed their current job and
+    // are unparked when the number grows again. Jobs are shared by all worker threads so
+    // parking threads does not affect which jobs get executed. Persists across start()/stop().
+    void set_active_thread_count(const size_t thread_count);
+
+    // Return the number of worker threads allowed to pick up new jobs.
+    size_t get_active_thread_count() const;
+
     // Start job execution. Returns immediately.
     void start();
 
@@ -33,15 +33,18 @@
 // appleseed.foundation headers.
 #include "foundation/platform/thread.h"
 #include "foundation/utility/foreach.h"
-#include "foundation/utility/iterators.h"
 #include "foundation/utility/job/abortswitch.h"
 #include "foundation/utility/job/ijob.h"
 
 // Boost headers.
+#include "boost/atomic/atomic.hpp"
 #include "boost/thread/condition_variable.hpp"
+#include "boost/thread/tss.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
+#include <deque>
 
 using namespace std;
 
@@ -52,22 +55,148 @@ namespace foundation
 // JobQueue class implementation.
 //
 
+namespace
+{
+    // Job queue and worker index bound to a worker thread.
+    struct WorkerBinding
+    {
+        const JobQueue* m_job_queue;
+        size_t          m_worker_index;
+    };
+
+    boost::thread_specific_ptr<WorkerBinding> g_worker_binding;
+
+    const size_t NoWorker = ~size_t(0);
+}
+
 struct JobQueue::Impl
 {
+    typedef deque<JobInfo> JobDeque;
+
+    struct WorkerQueue
+    {
+        Spinlock                    m_spinlock;
+        JobDeque                    m_jobs;
+    };
+
+    // Worker threads beyond this count share worker queues.
+    enum { MaxWorkerQueueCount = 256 };
+
+    // Maximum number of jobs a worker thread moves from the shared queue to its own queue at once.
+    enum { MaxBatchSize = 8 };
+
     mutable boost::mutex            m_mutex;
     boost::condition_variable_any   m_event;
-    JobList                         m_scheduled_jobs;
-    JobList                         m_running_jobs;
+    JobDeque                        m_shared_jobs;
+    WorkerQueue*                    m_worker_queues[MaxWorkerQueueCount];
+    boost::atomic<size_t>           m_worker_queue_count;
+    boost::atomic<size_t>           m_next_worker_queue;
+    boost::atomic<size_t>           m_scheduled_job_count;
+    boost::atomic<size_t>           m_total_job_count;
+    boost::atomic<size_t>           m_waiting_thread_count;
+
+    Impl()
+      : m_worker_queue_count(0)
+      , m_next_worker_queue(0)
+      , m_scheduled_job_count(0)
+      , m_total_job_count(0)
+      , m_waiting_thread_count(0)
+    {
+        fill(m_worker_queues, m_worker_queues + MaxWorkerQueueCount, static_cast<WorkerQueue*>(0));
+    }
+
+    ~Impl()
+    {
+        for (size_t i = 0; i < MaxWorkerQueueCount; ++i)
+            delete m_worker_queues[i];
+    }
 
-    static void delete_jobs(JobList& list)
+    static void delete_jobs(JobDeque& jobs)
     {
-        for (each<JobList> i = list; i; ++i)
+        for (each<JobDeque> i = jobs; i; ++i)
         {
             if (i->m_owned)
                 delete i->m_job;
         }
 
-        list.clear();
+        jobs.clear();
+    }
+
+    // Return the index of the worker queue of the calling thread, or NoWorker.
+    size_t get_bound_worker_index(const JobQueue* job_queue) const
+    {
+        const WorkerBinding* binding = g_worker_binding.get();
+        return binding && binding->m_job_queue == job_queue ? binding->m_worker_index : NoWorker;
+    }
+
+    // Wake up worker threads and threads waiting for completion, if there are any.
+    void notify_waiting_threads()
+    {
+        if (m_waiting_thread_count.load() > 0)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_event.notify_all();
+        }
+    }
+
+    bool pop_front(const size_t worker_index, JobInfo& job_info)
+    {
+        WorkerQueue* queue = m_worker_queues[worker_index];
+        Spinlock::ScopedLock lock(queue->m_spinlock);
+
+        if (queue->m_jobs.empty())
+            return false;
+
+        job_info = queue->m_jobs.front();
+        queue->m_jobs.pop_front();
+        return true;
+    }
+
+    bool pop_back(const size_t worker_index, JobInfo& job_info)
+    {
+        WorkerQueue* queue = m_worker_queues[worker_index];
+        Spinlock::ScopedLock lock(queue->m_spinlock);
+
+        if (queue->m_jobs.empty())
+            return false;
+
+        job_info = queue->m_jobs.back();
+        queue->m_jobs.pop_back();
+        return true;
+    }
+
+    bool pop_shared(const size_t worker_index, JobInfo& job_info)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        if (m_shared_jobs.empty())
+            return false;
+
+        job_info = m_shared_jobs.front();
+        m_shared_jobs.pop_front();
+
+        if (worker_index != NoWorker && !m_shared_jobs.empty())
+        {
+            // Move a batch of jobs to the queue of the worker thread, leaving enough
+            // jobs in the shared queue for the other worker threads to pick up.
+            const size_t worker_count = max<size_t>(m_worker_queue_count.load(), 1);
+            const size_t batch_size =
+                min<size_t>(m_shared_jobs.size() / (2 * worker_count), MaxBatchSize);
+
+            if (batch_size > 0)
+            {
+                WorkerQueue* queue = m_worker_queues[worker_index];
+                Spinlock::ScopedLock queue_lock(queue->m_spinlock);
+
+                for (size_t i = 0; i < batch_size; ++i)
+                {
+                    queue->m_jobs.push_back(m_shared_jobs.front());
+                    m_shared_jobs.pop_front();
+                }
+            }
+        }
+
+        return true;
     }
 };
 
@@ -81,10 +210,15 @@ JobQueue::~JobQueue()
     // We assume that worker threads are not running, so we don't lock.
 
     // At this point, no job must be running.
-    assert(impl->m_running_jobs.empty());
+    assert(impl->m_total_job_count == impl->m_scheduled_job_count);
 
     // Delete all scheduled jobs that the queue owns.
-    Impl::delete_jobs(impl->m_scheduled_jobs);
+    Impl::delete_jobs(impl->m_shared_jobs);
+    for (size_t i = 0; i < Impl::MaxWorkerQueueCount; ++i)
+    {
+        if (impl->m_worker_queues[i])
+            Impl::delete_jobs(impl->m_worker_queues[i]->m_jobs);
+    }
 
     delete impl;
 }
@@ -93,7 +227,22 @@ void JobQueue::clear_scheduled_jobs()
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
-    impl->delete_jobs(impl->m_scheduled_jobs);
+    Impl::JobDeque jobs;
+    jobs.swap(impl->m_shared_jobs);
+
+    const size_t worker_queue_count = impl->m_worker_queue_count.load();
+    for (size_t i = 0; i < worker_queue_count; ++i)
+    {
+        Impl::WorkerQueue* queue = impl->m_worker_queues[i];
+        Spinlock::ScopedLock queue_lock(queue->m_spinlock);
+        jobs.insert(jobs.end(), queue->m_jobs.begin(), queue->m_jobs.end());
+        queue->m_jobs.clear();
+    }
+
+    impl->m_scheduled_job_count -= jobs.size();
+    impl->m_total_job_count -= jobs.size();
+
+    Impl::delete_jobs(jobs);
 
     // Notify worker threads that all scheduled jobs are gone.
     impl->m_event.notify_all();
@@ -101,115 +250,220 @@ void JobQueue::clear_scheduled_jobs()
 
 bool JobQueue::has_scheduled_jobs() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    return !impl->m_scheduled_jobs.empty();
+    return impl->m_scheduled_job_count.load() > 0;
 }
 
 bool JobQueue::has_running_jobs() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    return !impl->m_running_jobs.empty();
+    return get_running_job_count() > 0;
 }
 
 bool JobQueue::has_scheduled_or_running_jobs() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    return !impl->m_scheduled_jobs.empty() || !impl->m_running_jobs.empty();
+    return impl->m_total_job_count.load() > 0;
 }
 
 size_t JobQueue::get_scheduled_job_count() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    return impl->m_scheduled_jobs.size();
+    return impl->m_scheduled_job_count.load();
 }
 
 size_t JobQueue::get_running_job_count() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    return impl->m_running_jobs.size();
+    // The scheduled job count is updated last when a job starts running.
+    const size_t total_job_count = impl->m_total_job_count.load();
+    const size_t scheduled_job_count = impl->m_scheduled_job_count.load();
+    return total_job_count > scheduled_job_count ? total_job_count - scheduled_job_count : 0;
 }
 
 size_t JobQueue::get_total_job_count() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    return impl->m_scheduled_jobs.size() + impl->m_running_jobs.size();
+    return impl->m_total_job_count.load();
 }
 
 void JobQueue::schedule(IJob* job, const bool transfer_ownership)
 {
     assert(job);
 
-    boost::mutex::scoped_lock lock(impl->m_mutex);
+    const JobInfo job_info(job, transfer_ownership);
+
+    // Counters are incremented before the job is made visible so that they never underflow.
+    ++impl->m_total_job_count;
+    ++impl->m_scheduled_job_count;
 
-    impl->m_scheduled_jobs.push_back(JobInfo(job, transfer_ownership));
+    const size_t worker_index = impl->get_bound_worker_index(this);
+
+    if (worker_index != NoWorker)
+    {
+        // Jobs scheduled from a worker thread run next in that worker thread, unless stolen.
+        Impl::WorkerQueue* queue = impl->m_worker_queues[worker_index];
+        Spinlock::ScopedLock lock(queue->m_spinlock);
+        queue->m_jobs.push_front(job_info);
+    }
+    else
+    {
+        const size_t worker_queue_count = impl->m_worker_queue_count.load();
+
+        if (worker_queue_count > 0)
+        {
+            // Distribute jobs among worker queues in a round-robin fashion.
+            const size_t index = impl->m_next_worker_queue++ % worker_queue_count;
+            Impl::WorkerQueue* queue = impl->m_worker_queues[index];
+            Spinlock::ScopedLock lock(queue->m_spinlock);
+            queue->m_jobs.push_back(job_info);
+        }
+        else
+        {
+            boost::mutex::scoped_lock lock(impl->m_mutex);
+            impl->m_shared_jobs.push_back(job_info);
+        }
+    }
 
     // Notify worker threads that a new scheduled job is available.
-    impl->m_event.notify_all();
+    impl->notify_waiting_threads();
 }
 
 void JobQueue::wait_until_completion()
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
+    ++impl->m_waiting_thread_count;
+
     // Wait until there is no more scheduled or running jobs.
-    while (!impl->m_scheduled_jobs.empty() || !impl->m_running_jobs.empty())
+    while (impl->m_total_job_count.load() > 0)
         impl->m_event.wait(lock);
+
+    --impl->m_waiting_thread_count;
 }
 
-JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job()
+bool JobQueue::run_scheduled_job(const size_t thread_index)
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
+    const RunningJobInfo running_job_info =
+        acquire_scheduled_job_for_worker(impl->get_bound_worker_index(this));
 
-    return acquire_scheduled_job_unlocked();
+    if (running_job_info.first.m_job == 0)
+        return false;
+
+    try
+    {
+        running_job_info.first.m_job->execute(thread_index);
+    }
+    catch (...)
+    {
+        retire_running_job(running_job_info);
+        throw;
+    }
+
+    retire_running_job(running_job_info);
+
+    return true;
 }
 
-JobQueue::RunningJobInfo JobQueue::wait_for_scheduled_job(AbortSwitch& abort_switch)
+size_t JobQueue::register_worker(const size_t worker_index)
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
+    const size_t queue_index = worker_index % Impl::MaxWorkerQueueCount;
 
-    // Wait for a scheduled job to be available.
-    while (!abort_switch.is_aborted() && impl->m_scheduled_jobs.empty())    // order matters
-        impl->m_event.wait(lock);
+    {
+        boost::mutex::scoped_lock lock(impl->m_mutex);
+
+        // Create all worker queues up to this one so that worker queues [0, count) always exist.
+        const size_t worker_queue_count = impl->m_worker_queue_count.load();
+        for (size_t i = worker_queue_count; i <= queue_index; ++i)
+            impl->m_worker_queues[i] = new Impl::WorkerQueue();
 
-    return acquire_scheduled_job_unlocked();
+        if (queue_index >= worker_queue_count)
+            impl->m_worker_queue_count.store(queue_index + 1);
+    }
+
+    WorkerBinding* binding = new WorkerBinding();
+    binding->m_job_queue = this;
+    binding->m_worker_index = queue_index;
+    g_worker_binding.reset(binding);
+
+    return queue_index;
 }
 
-JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job_unlocked()
+JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job()
 {
-    // Bail out if there is no scheduled job.
-    if (impl->m_scheduled_jobs.empty())
-        return RunningJobInfo(JobInfo(0, false), impl->m_running_jobs.end());
+    return acquire_scheduled_job_for_worker(NoWorker);
+}
 
-    // Move the next scheduled job to the end of the queue of running jobs.
-    const JobInfo job_info = impl->m_scheduled_jobs.front();
-    impl->m_scheduled_jobs.pop_front();
-    impl->m_running_jobs.push_back(job_info);
+JobQueue::RunningJobInfo JobQueue::wait_for_scheduled_job(
+    const size_t            worker_index,
+    AbortSwitch&            abort_switch)
+{
+    while (true)
+    {
+        const RunningJobInfo running_job_info = acquire_scheduled_job_for_worker(worker_index);
+        if (running_job_info.first.m_job)
+            return running_job_info;
 
-    // Notify worker threads that a job has moved from the scheduled to the running state.
-    impl->m_event.notify_all();
+        boost::mutex::scoped_lock lock(impl->m_mutex);
+
+        ++impl->m_waiting_thread_count;
+
+        // Wait for a scheduled job to be available.
+        while (!abort_switch.is_aborted() && impl->m_scheduled_job_count.load() == 0)    // order matters
+            impl->m_event.wait(lock);
+
+        --impl->m_waiting_thread_count;
 
-    return RunningJobInfo(job_info, pred(impl->m_running_jobs.end()));
+        if (abort_switch.is_aborted())
+            return RunningJobInfo(JobInfo(0, false), NoWorker);
+    }
 }
 
-void JobQueue::retire_running_job(const RunningJobInfo& running_job_info)
+JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job_for_worker(const size_t worker_index)
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
+    // Bail out if there is no scheduled job.
+    if (impl->m_scheduled_job_count.load() == 0)
+        return RunningJobInfo(JobInfo(0, false), NoWorker);
+
+    JobInfo job_info(0, false);
+    size_t source = worker_index;
+
+    // First look into the queue of the worker thread, then into the shared queue.
+    if (!(worker_index != NoWorker && impl->pop_front(worker_index, job_info)))
+    {
+        source = NoWorker;
+
+        if (!impl->pop_shared(worker_index, job_info))
+        {
+            // Finally try to steal a job from another worker thread.
+            const size_t worker_queue_count = impl->m_worker_queue_count.load();
+            const size_t first = worker_index != NoWorker ? worker_index + 1 : 0;
+
+            for (size_t i = 0; i < worker_queue_count; ++i)
+            {
+                const size_t victim = (first + i) % worker_queue_count;
+
+                if (victim != worker_index && impl->pop_back(victim, job_info))
+                {
+                    source = victim;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (job_info.m_job == 0)
+        return RunningJobInfo(job_info, NoWorker);
 
-    // Remove the job from the running list.
-    impl->m_running_jobs.erase(running_job_info.second);
+    // The job changes state from 'scheduled' to 'running'.
+    --impl->m_scheduled_job_count;
+
+    return RunningJobInfo(job_info, source);
+}
 
+void JobQueue::retire_running_job(const RunningJobInfo& running_job_info)
+{
     // Delete the job.
     if (running_job_info.first.m_owned)
         delete running_job_info.first.m_job;
 
-    // Notify worker threads that a scheduled job was retired.
-    impl->m_event.notify_all();
+    // Notify threads waiting for completion that the last job was retired.
+    if (--impl->m_total_job_count == 0)
+        impl->notify_waiting_threads();
 }
 
 void JobQueue::signal_event()
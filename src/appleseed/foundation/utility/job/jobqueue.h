@@ -32,7 +32,6 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
-#include "foundation/utility/poolallocator.h"
 #include "foundation/utility/test.h"
 
 // appleseed.main headers.
@@ -40,7 +39,6 @@
 
 // Standard headers.
 #include <cstddef>
-#include <list>
 #include <utility>
 
 // Forward declarations.
@@ -67,6 +65,12 @@ namespace foundation
 //   - scheduled: the job was inserted into the job queue, but hasn't yet been executed
 //   - running: the job is currently being executed
 //
+// Each worker thread owns a separate queue of scheduled jobs. A worker thread runs
+// the jobs of its own queue first, then grabs a small batch of jobs from the queue
+// shared by all threads, and finally steals jobs from the queues of other worker
+// threads. Jobs scheduled from a job running in a worker thread are inserted into
+// the queue of that worker thread and run before the other jobs of that queue.
+//
 
 class APPLESEED_DLLSYMBOL JobQueue
   : public NonCopyable
@@ -106,6 +110,11 @@ class APPLESEED_DLLSYMBOL JobQueue
     // Wait until all scheduled and running jobs are completed.
     void wait_until_completion();
 
+    // Run a single scheduled job in the calling thread, preferably one scheduled from
+    // the calling thread. Return false if there was no scheduled job. This allows a job
+    // to wait for the child jobs it has scheduled without keeping its worker thread idle.
+    bool run_scheduled_job(const size_t thread_index);
+
   private:
     friend class WorkerThread;
 
@@ -121,7 +130,7 @@ class APPLESEED_DLLSYMBOL JobQueue
     struct JobInfo
     {
         IJob*       m_job;
-        const bool  m_owned;
+        bool        m_owned;
 
         JobInfo(IJob* job, const bool owned)
           : m_job(job)
@@ -130,18 +139,23 @@ class APPLESEED_DLLSYMBOL JobQueue
         }
     };
 
-    typedef std::list<JobInfo, PoolAllocator<JobInfo, 64> > JobList;
+    // A running job and the index of the worker queue it was taken from (~0 for the shared queue).
+    typedef std::pair<JobInfo, size_t> RunningJobInfo;
 
-    typedef std::pair<JobInfo, JobList::iterator> RunningJobInfo;
+    // Create the job queue of a given worker thread and bind it to the calling thread.
+    // Return the index of the worker queue to use when acquiring jobs.
+    size_t register_worker(const size_t worker_index);
 
     // Acquire a scheduled job and change its state from 'scheduled' to 'running'.
     RunningJobInfo acquire_scheduled_job();
 
-    // Wait for a scheduled job to be available.
-    RunningJobInfo wait_for_scheduled_job(AbortSwitch& abort_switch);
+    // Wait for a scheduled job to be available to a given worker thread.
+    RunningJobInfo wait_for_scheduled_job(
+        const size_t            worker_index,
+        AbortSwitch&            abort_switch);
 
-    // Acquire a scheduled job without any locking.
-    RunningJobInfo acquire_scheduled_job_unlocked();
+    // Acquire a scheduled job on behalf of a given worker thread (~0 for none).
+    RunningJobInfo acquire_scheduled_job_for_worker(const size_t worker_index);
 
     // Retire a running job. The job is deleted if it is owned by the queue.
     void retire_running_job(const RunningJobInfo& running_job_info);
@@ -33,6 +33,7 @@
 // appleseed.foundation headers.
 #include "foundation/platform/snprintf.h"
 #include "foundation/platform/types.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/job/ijob.h"
 #include "foundation/utility/job/jobmanager.h"
 #include "foundation/utility/job/jobqueue.h"
@@ -51,15 +52,19 @@ namespace foundation
 // WorkerThread class implementation.
 //
 
+const size_t WorkerThread::NoCpuCore;
+
 WorkerThread::WorkerThread(
     const size_t    index,
     Logger&         logger,
     JobQueue&       job_queue,
-    const int       flags)
+    const int       flags,
+    const size_t    cpu_core)
   : m_index(index)
   , m_logger(logger)
   , m_job_queue(job_queue)
   , m_flags(flags)
+  , m_cpu_core(cpu_core)
   , m_thread_func(*this)
   , m_thread(0)
 {
@@ -130,11 +135,31 @@ void WorkerThread::set_thread_name()
     char thread_name[16];
     portable_snprintf(thread_name, sizeof(thread_name), "worker_%03lu", (long unsigned int)m_index);
     set_current_thread_name(thread_name);
+    global_event_tracer().set_thread_name(thread_name);
+}
+
+void WorkerThread::set_cpu_affinity()
+{
+    if (m_cpu_core == NoCpuCore)
+        return;
+
+    // Memory first touched by this thread from now on will be allocated on the NUMA node of this core.
+    if (!set_current_thread_cpu_affinity(m_cpu_core))
+    {
+        LOG_DEBUG(
+            m_logger,
+            "worker thread " FMT_SIZE_T ": could not bind thread to cpu core " FMT_SIZE_T ".",
+            m_index,
+            m_cpu_core);
+    }
 }
 
 void WorkerThread::run()
 {
     set_thread_name();
+    set_cpu_affinity();
+
+    const size_t worker_queue_index = m_job_queue.register_worker(m_index);
 
     while (!m_abort_switch.is_aborted())
     {
@@ -148,7 +173,7 @@ void WorkerThread::run()
 
         // Acquire a job.
         const JobQueue::RunningJobInfo running_job_info =
-            m_job_queue.wait_for_scheduled_job(m_abort_switch);
+            m_job_queue.wait_for_scheduled_job(worker_queue_index, m_abort_switch);
 
         // Handle the case where the job queue is empty.
         if (running_job_info.first.m_job == 0)
@@ -184,6 +209,7 @@ bool WorkerThread::execute_job(IJob& job)
 {
     try
     {
+        EventTraceScope trace_scope("job", "job");
         job.execute(m_index);
     }
     catch (const bad_alloc&)
@@ -58,12 +58,16 @@ class WorkerThread
   : public NonCopyable
 {
   public:
+    // Value of the cpu_core argument for a worker thread that is not bound to a CPU core.
+    static const size_t NoCpuCore = ~size_t(0);
+
     // Constructor.
     WorkerThread(
         const size_t    index,
         Logger&         logger,
         JobQueue&       job_queue,
-        const int       flags);     // see foundation::JobManager::Flags
+        const int       flags,      // see foundation::JobManager::Flags
+        const size_t    cpu_core = NoCpuCore);
 
     // Destructor.
     ~WorkerThread();
@@ -102,6 +106,7 @@ class WorkerThread
     Logger&                         m_logger;
     JobQueue&                       m_job_queue;
     const int                       m_flags;
+    const size_t                    m_cpu_core;
 
     AbortSwitch                     m_abort_switch;
 
@@ -113,6 +118,7 @@ class WorkerThread
     boost::mutex                    m_pause_mutex;
 
     void set_thread_name();
+    void set_cpu_affinity();
 
     // Main line of the worker thread.
     void run();
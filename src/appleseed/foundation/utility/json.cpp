@@ -0,0 +1,88 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "json.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+
+using namespace std;
+
+namespace foundation
+{
+
+namespace
+{
+    void write_json_string(ostream& output, const char* s, const size_t length)
+    {
+        output << '"';
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            const char c = s[i];
+
+            switch (c)
+            {
+              case '"': output << "\\\""; break;
+              case '\\': output << "\\\\"; break;
+              case '\n': output << "\\n"; break;
+              case '\r': output << "\\r"; break;
+              case '\t': output << "\\t"; break;
+
+              default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char buf[8];
+                    sprintf(buf, "\\u%04x", static_cast<unsigned int>(c));
+                    output << buf;
+                }
+                else output << c;
+                break;
+            }
+        }
+
+        output << '"';
+    }
+}
+
+void write_json_string(ostream& output, const char* s)
+{
+    write_json_string(output, s, strlen(s));
+}
+
+void write_json_string(ostream& output, const string& s)
+{
+    write_json_string(output, s.data(), s.size());
+}
+
+}   // namespace foundation
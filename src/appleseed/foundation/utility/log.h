@@ -31,6 +31,7 @@
 #define APPLESEED_FOUNDATION_UTILITY_LOG_H
 
 // Interface headers.
+#include "foundation/utility/log/asynclogtarget.h"
 #include "foundation/utility/log/consolelogtarget.h"
 #include "foundation/utility/log/filelogtarget.h"
 #include "foundation/utility/log/filelogtargetbase.h"
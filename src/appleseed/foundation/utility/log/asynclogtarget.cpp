@@ -0,0 +1,474 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "asynclogtarget.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+#include "boost/bind.hpp"
+#include "boost/date_time/posix_time/posix_time.hpp"
+#include "boost/thread/condition_variable.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <string>
+
+using namespace boost::posix_time;
+using namespace std;
+
+namespace foundation
+{
+
+//
+// AsyncLogTarget class implementation.
+//
+// The message queue is a bounded multi-producer queue in which every slot carries a
+// sequence number telling producers and the consumer whether the slot is free or full
+// (D. Vyukov, Bounded MPMC queue). The writer thread is the only consumer.
+//
+
+namespace
+{
+    struct Message
+    {
+        LogMessage::Category    m_category;
+        const char*             m_file;
+        size_t                  m_line;
+        string                  m_header;
+        string                  m_message;
+    };
+
+    struct Slot
+    {
+        boost::atomic<size_t>   m_sequence;
+        Message                 m_message;
+    };
+
+    // How long the writer thread sleeps when the queue is empty.
+    const size_t IdleWaitMs = 50;
+}
+
+struct AsyncLogTarget::Impl
+{
+    ILogTarget&                 m_target;
+    const size_t                m_max_messages_per_second;
+
+    // Message queue.
+    const size_t                m_mask;
+    Slot*                       m_slots;
+    boost::atomic<size_t>       m_enqueue_pos;
+    boost::atomic<size_t>       m_dequeue_pos;
+    boost::atomic<size_t>       m_dropped_count;
+
+    // Writer thread control.
+    boost::mutex                m_mutex;
+    boost::condition_variable   m_message_event;
+    boost::condition_variable   m_flush_event;
+    boost::atomic<size_t>       m_flush_requests;
+    size_t                      m_flush_completions;
+    boost::atomic<bool>         m_abort;
+    boost::thread               m_thread;
+
+    // State of the writer thread.
+    Message                     m_last;
+    bool                        m_has_last;
+    size_t                      m_repeat_count;
+    ptime                       m_window_start;
+    size_t                      m_window_count;
+    size_t                      m_suppressed_count;
+    Message                     m_last_suppressed;
+
+    Impl(
+        ILogTarget&             target,
+        const size_t            queue_capacity,
+        const size_t            max_messages_per_second)
+      : m_target(target)
+      , m_max_messages_per_second(max_messages_per_second)
+      , m_mask(next_pow2(max<size_t>(queue_capacity, 2)) - 1)
+      , m_slots(new Slot[m_mask + 1])
+      , m_enqueue_pos(0)
+      , m_dequeue_pos(0)
+      , m_dropped_count(0)
+      , m_flush_requests(0)
+      , m_flush_completions(0)
+      , m_abort(false)
+      , m_has_last(false)
+      , m_repeat_count(0)
+      , m_window_start(microsec_clock::universal_time())
+      , m_window_count(0)
+      , m_suppressed_count(0)
+    {
+        for (size_t i = 0; i <= m_mask; ++i)
+            m_slots[i].m_sequence.store(i, boost::memory_order_relaxed);
+
+        m_thread = boost::thread(boost::bind(&Impl::run, this));
+    }
+
+    ~Impl()
+    {
+        m_abort.store(true);
+        m_message_event.notify_one();
+        m_thread.join();
+
+        delete [] m_slots;
+    }
+
+    bool try_push(
+        const LogMessage::Category  category,
+        const char*                 file,
+        const size_t                line,
+        const char*                 header,
+        const char*                 message)
+    {
+        size_t pos = m_enqueue_pos.load(boost::memory_order_relaxed);
+        Slot* slot;
+
+        while (true)
+        {
+            slot = &m_slots[pos & m_mask];
+            const size_t seq = slot->m_sequence.load(boost::memory_order_acquire);
+            const isize_t diff = static_cast<isize_t>(seq) - static_cast<isize_t>(pos);
+
+            if (diff == 0)
+            {
+                // The slot is free: try to claim it.
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, boost::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                // The queue is full.
+                return false;
+            }
+            else pos = m_enqueue_pos.load(boost::memory_order_relaxed);
+        }
+
+        // Assigning to the strings reuses the capacity left by previous messages.
+        slot->m_message.m_category = category;
+        slot->m_message.m_file = file;
+        slot->m_message.m_line = line;
+        slot->m_message.m_header = header;
+        slot->m_message.m_message = message;
+        slot->m_sequence.store(pos + 1, boost::memory_order_release);
+
+        return true;
+    }
+
+    bool try_pop(Message& message)
+    {
+        const size_t pos = m_dequeue_pos.load(boost::memory_order_relaxed);
+        Slot& slot = m_slots[pos & m_mask];
+
+        if (slot.m_sequence.load(boost::memory_order_acquire) != pos + 1)
+            return false;
+
+        message.m_category = slot.m_message.m_category;
+        message.m_file = slot.m_message.m_file;
+        message.m_line = slot.m_message.m_line;
+        message.m_header.swap(slot.m_message.m_header);
+        message.m_message.swap(slot.m_message.m_message);
+
+        slot.m_sequence.store(pos + m_mask + 1, boost::memory_order_release);
+        m_dequeue_pos.store(pos + 1, boost::memory_order_relaxed);
+
+        return true;
+    }
+
+    void push(
+        const LogMessage::Category  category,
+        const char*                 file,
+        const size_t                line,
+        const char*                 header,
+        const char*                 message)
+    {
+        if (!try_push(category, file, line, header, message))
+        {
+            // Errors are important enough to wait for room in the queue; the rest is dropped.
+            if (category < LogMessage::Error)
+            {
+                m_dropped_count.fetch_add(1, boost::memory_order_relaxed);
+                return;
+            }
+
+            do
+            {
+                m_message_event.notify_one();
+                yield();
+            } while (!try_push(category, file, line, header, message));
+        }
+
+        m_message_event.notify_one();
+    }
+
+    void flush()
+    {
+        const size_t ticket = m_flush_requests.fetch_add(1) + 1;
+
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_message_event.notify_one();
+
+        while (m_flush_completions < ticket)
+            m_flush_event.wait(lock);
+    }
+
+    void run()
+    {
+        set_current_thread_name("log_writer");
+
+        Message message;
+
+        while (true)
+        {
+            const bool abort = m_abort.load();
+            const size_t flush_requests = m_flush_requests.load();
+
+            // Write all messages enqueued so far, including those still being copied into the queue.
+            const size_t end = m_enqueue_pos.load();
+            while (m_dequeue_pos.load(boost::memory_order_relaxed) != end)
+            {
+                if (try_pop(message))
+                    process(message);
+                else yield();
+            }
+
+            write_dropped_message_count();
+            update_rate_window();
+
+            if (abort || flush_requests > m_flush_completions)
+            {
+                write_pending_repeats();
+                write_suppressed_message_count();
+
+                boost::mutex::scoped_lock lock(m_mutex);
+                m_flush_completions = flush_requests;
+                m_flush_event.notify_all();
+            }
+
+            if (abort)
+                break;
+
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            if (m_dequeue_pos.load(boost::memory_order_relaxed) == m_enqueue_pos.load() &&
+                m_flush_requests.load() == m_flush_completions &&
+                !m_abort.load())
+            {
+                // Nothing came in while we were waiting: the last repeated message won't
+                // get any more repeats anytime soon, report them now.
+                if (!m_message_event.timed_wait(lock, milliseconds(IdleWaitMs)))
+                {
+                    lock.unlock();
+                    write_pending_repeats();
+                }
+            }
+        }
+    }
+
+    void process(Message& message)
+    {
+        // Collapse consecutive identical messages.
+        if (m_has_last &&
+            message.m_category == m_last.m_category &&
+            message.m_message == m_last.m_message)
+        {
+            ++m_repeat_count;
+            return;
+        }
+
+        write_pending_repeats();
+
+        // Enforce the rate limit on messages below the Error category.
+        update_rate_window();
+        if (m_max_messages_per_second > 0 &&
+            message.m_category < LogMessage::Error &&
+            m_window_count >= m_max_messages_per_second)
+        {
+            ++m_suppressed_count;
+            m_last_suppressed.m_category = message.m_category;
+            m_last_suppressed.m_file = message.m_file;
+            m_last_suppressed.m_line = message.m_line;
+            m_last_suppressed.m_header.swap(message.m_header);
+            m_last_suppressed.m_message.clear();
+            m_has_last = false;
+            return;
+        }
+
+        ++m_window_count;
+
+        m_target.write(
+            message.m_category,
+            message.m_file,
+            message.m_line,
+            message.m_header.c_str(),
+            message.m_message.c_str());
+
+        m_last.m_category = message.m_category;
+        m_last.m_file = message.m_file;
+        m_last.m_line = message.m_line;
+        m_last.m_header.swap(message.m_header);
+        m_last.m_message.swap(message.m_message);
+        m_has_last = true;
+    }
+
+    void update_rate_window()
+    {
+        const ptime now = microsec_clock::universal_time();
+
+        if (now - m_window_start >= seconds(1))
+        {
+            write_suppressed_message_count();
+            m_window_start = now;
+            m_window_count = 0;
+        }
+    }
+
+    void write_pending_repeats()
+    {
+        if (m_repeat_count == 0)
+            return;
+
+        const string text =
+            "(previous message repeated " + to_string(m_repeat_count) +
+            (m_repeat_count > 1 ? " times)" : " time)");
+
+        m_target.write(
+            m_last.m_category,
+            m_last.m_file,
+            m_last.m_line,
+            m_last.m_header.c_str(),
+            text.c_str());
+
+        m_repeat_count = 0;
+    }
+
+    void write_suppressed_message_count()
+    {
+        if (m_suppressed_count == 0)
+            return;
+
+        const string text =
+            "(" + to_string(m_suppressed_count) +
+            (m_suppressed_count > 1 ? " messages" : " message") +
+            " suppressed, more than " + to_string(m_max_messages_per_second) +
+            " messages per second)";
+
+        m_target.write(
+            m_last_suppressed.m_category,
+            m_last_suppressed.m_file,
+            m_last_suppressed.m_line,
+            m_last_suppressed.m_header.c_str(),
+            text.c_str());
+
+        m_suppressed_count = 0;
+        m_has_last = false;
+    }
+
+    void write_dropped_message_count()
+    {
+        // Dropped messages are reported with the header of the last written message.
+        if (m_last.m_header.empty())
+            return;
+
+        const size_t dropped_count = m_dropped_count.exchange(0, boost::memory_order_relaxed);
+
+        if (dropped_count == 0)
+            return;
+
+        write_pending_repeats();
+
+        const string text =
+            "(" + to_string(dropped_count) +
+            (dropped_count > 1 ? " messages" : " message") +
+            " dropped, log queue full)";
+
+        m_target.write(
+            m_last.m_category,
+            m_last.m_file,
+            m_last.m_line,
+            m_last.m_header.c_str(),
+            text.c_str());
+
+        m_has_last = false;
+    }
+};
+
+AsyncLogTarget::AsyncLogTarget(
+    ILogTarget&                 target,
+    const size_t                queue_capacity,
+    const size_t                max_messages_per_second)
+  : impl(new Impl(target, queue_capacity, max_messages_per_second))
+{
+}
+
+AsyncLogTarget::~AsyncLogTarget()
+{
+    delete impl;
+}
+
+void AsyncLogTarget::release()
+{
+    delete this;
+}
+
+void AsyncLogTarget::write(
+    const LogMessage::Category  category,
+    const char*                 file,
+    const size_t                line,
+    const char*                 header,
+    const char*                 message)
+{
+    impl->push(category, file, line, header, message);
+
+    // The logger terminates the application right after writing a fatal message.
+    if (category == LogMessage::Fatal)
+        impl->flush();
+}
+
+void AsyncLogTarget::flush()
+{
+    impl->flush();
+}
+
+AsyncLogTarget* create_async_log_target(
+    ILogTarget&                 target,
+    const size_t                queue_capacity,
+    const size_t                max_messages_per_second)
+{
+    return new AsyncLogTarget(target, queue_capacity, max_messages_per_second);
+}
+
+}   // namespace foundation
@@ -0,0 +1,101 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_LOG_ASYNCLOGTARGET_H
+#define APPLESEED_FOUNDATION_UTILITY_LOG_ASYNCLOGTARGET_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+#include "foundation/utility/log/ilogtarget.h"
+#include "foundation/utility/log/logmessage.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+namespace foundation
+{
+
+//
+// A log target that forwards messages to another log target from a dedicated writer thread.
+//
+// write() only enqueues the message into a bounded lock-free queue, so threads emitting
+// messages never wait on console or file I/O. The writer thread collapses consecutive
+// identical messages into a single "repeated N times" line and rate-limits messages below
+// the Error category. When the queue is full, messages below the Error category are dropped
+// and reported later; Error and Fatal messages are never dropped. Fatal messages are written
+// synchronously since the logger terminates the application right after writing them.
+//
+// The wrapped log target is not owned by this class and must outlive it.
+//
+
+class APPLESEED_DLLSYMBOL AsyncLogTarget
+  : public ILogTarget
+{
+  public:
+    // Constructor.
+    AsyncLogTarget(
+        ILogTarget&                 target,
+        const size_t                queue_capacity = 4096,
+        const size_t                max_messages_per_second = 200);
+
+    // Destructor. Writes all pending messages before returning.
+    ~AsyncLogTarget();
+
+    // Delete this instance.
+    virtual void release() APPLESEED_OVERRIDE;
+
+    // Write a message.
+    virtual void write(
+        const LogMessage::Category  category,
+        const char*                 file,
+        const size_t                line,
+        const char*                 header,
+        const char*                 message) APPLESEED_OVERRIDE;
+
+    // Block until all messages written so far have been forwarded to the wrapped target.
+    void flush();
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+// Create an instance of a log target that forwards messages to another one asynchronously.
+APPLESEED_DLLSYMBOL AsyncLogTarget* create_async_log_target(
+    ILogTarget&                     target,
+    const size_t                    queue_capacity = 4096,
+    const size_t                    max_messages_per_second = 200);
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_LOG_ASYNCLOGTARGET_H
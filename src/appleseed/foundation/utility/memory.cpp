@@ -33,6 +33,14 @@
 // appleseed.main headers.
 #include "main/allocator.h"
 
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
+// Platform headers.
+#if defined __linux__
+#include <sys/mman.h>
+#endif
+
 // Standard headers.
 #include <cstdlib>
 
@@ -95,4 +103,163 @@ void aligned_free(void* aligned_ptr)
     log_deallocation(aligned_ptr);
 }
 
+
+//
+// Huge pages implementation.
+//
+
+namespace
+{
+    boost::atomic<int> g_huge_page_mode(HugePagesDisabled);
+
+    enum BlockKind
+    {
+        HeapBlock,                  // allocated with malloc()
+        MappedBlock                 // allocated with mmap()
+    };
+
+    // Header stored right before the aligned pointer returned by huge_page_malloc().
+    struct BlockHeader
+    {
+        void*   m_base;             // address returned by malloc() or mmap()
+        size_t  m_size;             // size of the underlying allocation
+        size_t  m_kind;             // a BlockKind value
+    };
+
+    const size_t HugePageSize = 2 * 1024 * 1024;
+
+#if defined __linux__
+
+    const size_t GiganticPageSize = 1024 * 1024 * 1024;
+
+    void* map_huge_pages(const size_t size, const size_t page_size)
+    {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+
+#if defined MAP_HUGE_SHIFT
+        // log2(page_size) encoded in the upper bits selects the huge page size.
+        flags |= static_cast<int>(log2_int(page_size)) << MAP_HUGE_SHIFT;
+#endif
+
+        void* ptr = mmap(0, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+        return ptr == MAP_FAILED ? 0 : ptr;
+    }
+
+#endif
+
+    void* allocate_block(const size_t size, const HugePageMode mode, BlockKind& kind, size_t& allocated_size)
+    {
+#if defined __linux__
+        if (mode == HugePagesExplicit)
+        {
+            // Try 1 GB pages for very large allocations, then 2 MB pages.
+            if (size >= GiganticPageSize)
+            {
+                allocated_size = (size + GiganticPageSize - 1) & ~(GiganticPageSize - 1);
+                if (void* ptr = map_huge_pages(allocated_size, GiganticPageSize))
+                {
+                    kind = MappedBlock;
+                    return ptr;
+                }
+            }
+
+            allocated_size = (size + HugePageSize - 1) & ~(HugePageSize - 1);
+            if (void* ptr = map_huge_pages(allocated_size, HugePageSize))
+            {
+                kind = MappedBlock;
+                return ptr;
+            }
+        }
+
+        if (mode != HugePagesDisabled)
+        {
+            // Transparent huge pages only back naturally aligned 2 MB ranges.
+            allocated_size = (size + HugePageSize - 1) & ~(HugePageSize - 1);
+            void* ptr = 0;
+            if (posix_memalign(&ptr, HugePageSize, allocated_size) == 0)
+            {
+                madvise(ptr, allocated_size, MADV_HUGEPAGE);
+                kind = HeapBlock;
+                return ptr;
+            }
+        }
+#endif
+
+        allocated_size = size;
+        kind = HeapBlock;
+        return malloc(size);
+    }
+}
+
+void set_huge_page_mode(const HugePageMode mode)
+{
+    g_huge_page_mode.store(mode);
+}
+
+HugePageMode get_huge_page_mode()
+{
+    return static_cast<HugePageMode>(g_huge_page_mode.load());
+}
+
+void* huge_page_malloc(const size_t size, size_t alignment)
+{
+    // Same convention as aligned_malloc(). The block header requires pointer alignment.
+    if (alignment == 0)
+        alignment = 16;
+    if (alignment < sizeof(void*))
+        alignment = sizeof(void*);
+
+    assert(size > 0);
+    assert(is_pow2(alignment));
+
+    // The header and the padding required for alignment live in front of the user data.
+    const size_t header_size = (sizeof(BlockHeader) + alignment - 1) & ~(alignment - 1);
+    const size_t total_size = size + header_size + (alignment - 1);
+
+    const HugePageMode mode =
+        size >= HugePageMinAllocationSize ? get_huge_page_mode() : HugePagesDisabled;
+
+    BlockKind kind;
+    size_t allocated_size;
+    uint8* const base = static_cast<uint8*>(allocate_block(total_size, mode, kind, allocated_size));
+
+    // Handle allocation failures.
+    if (!base)
+    {
+        log_allocation_failure(total_size);
+        return 0;
+    }
+
+    // Compute the aligned address of the user data.
+    uint8* const aligned_ptr = align(base + header_size, alignment);
+
+    // Record how to release the block.
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(aligned_ptr) - 1;
+    header->m_base = base;
+    header->m_size = allocated_size;
+    header->m_kind = kind;
+
+    log_allocation(aligned_ptr, allocated_size);
+
+    return aligned_ptr;
+}
+
+void huge_page_free(void* aligned_ptr)
+{
+    assert(aligned_ptr);
+
+    const BlockHeader* header = reinterpret_cast<const BlockHeader*>(aligned_ptr) - 1;
+
+#if defined __linux__
+    if (header->m_kind == MappedBlock)
+        munmap(header->m_base, header->m_size);
+    else free(header->m_base);
+#else
+    free(header->m_base);
+#endif
+
+    log_deallocation(aligned_ptr);
+}
+
 }   // namespace foundation
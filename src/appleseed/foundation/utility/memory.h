@@ -65,6 +65,39 @@ void* aligned_malloc(const size_t size, size_t alignment);
 void aligned_free(void* aligned_ptr);
 
 
+//
+// Huge pages.
+//
+// Large, randomly accessed arrays (BVH nodes, leaf data, big texture tiles)
+// suffer from TLB misses when they are backed by regular 4 KB pages. When
+// huge pages are enabled, allocations of at least HugePageMinAllocationSize
+// bytes made with huge_page_malloc() are backed by 2 MB (or, for very large
+// allocations, 1 GB) pages where the platform supports it. Allocation always
+// falls back to regular pages when huge pages are unavailable.
+//
+
+enum HugePageMode
+{
+    HugePagesDisabled,          // regular pages only
+    HugePagesTransparent,       // ask the kernel to back large allocations with transparent huge pages
+    HugePagesExplicit           // map large allocations from the reserved huge page pool, then fall back to transparent huge pages
+};
+
+// Allocations smaller than this are never backed by huge pages.
+const size_t HugePageMinAllocationSize = 2 * 1024 * 1024;
+
+// Set or get the process-wide huge page mode. Defaults to HugePagesDisabled.
+void set_huge_page_mode(const HugePageMode mode);
+HugePageMode get_huge_page_mode();
+
+// Allocate memory on a specified alignment boundary, backed by huge pages if possible.
+// Return 0 if the allocation failed.
+void* huge_page_malloc(const size_t size, size_t alignment);
+
+// Free a block of memory that was allocated with huge_page_malloc().
+void huge_page_free(void* aligned_ptr);
+
+
 //
 // STL containers related functions.
 //
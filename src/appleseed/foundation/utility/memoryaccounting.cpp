@@ -0,0 +1,167 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "memoryaccounting.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/atomic.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/statistics.h"
+
+// Standard headers.
+#include <cassert>
+#include <string>
+
+using namespace std;
+
+namespace foundation
+{
+
+namespace
+{
+    struct MemoryCounter
+    {
+        boost::atomic<size_t>   m_size;
+        boost::atomic<size_t>   m_peak_size;
+    };
+
+    MemoryCounter g_tag_counters[MemoryTagCount];
+    MemoryCounter g_total_counter;
+
+    const char* TagNames[MemoryTagCount] =
+    {
+        "geometry",
+        "bvh",
+        "textures",
+        "volumes",
+        "framebuffers",
+        "aovs",
+        "photons",
+        "osl",
+        "scratch"
+    };
+
+    void update_peak(boost::atomic<size_t>& peak, const size_t value)
+    {
+        size_t peak_value = peak.load(boost::memory_order_relaxed);
+        while (peak_value < value &&
+               !peak.compare_exchange_weak(peak_value, value, boost::memory_order_relaxed)) ;
+    }
+
+    void add(MemoryCounter& counter, const size_t size)
+    {
+        const size_t new_size = counter.m_size.fetch_add(size, boost::memory_order_relaxed) + size;
+        update_peak(counter.m_peak_size, new_size);
+    }
+
+    void sub(MemoryCounter& counter, const size_t size)
+    {
+        assert(counter.m_size.load(boost::memory_order_relaxed) >= size);
+        counter.m_size.fetch_sub(size, boost::memory_order_relaxed);
+    }
+}
+
+const char* get_memory_tag_name(const MemoryTag tag)
+{
+    assert(tag < MemoryTagCount);
+    return TagNames[tag];
+}
+
+void account_memory_allocation(const MemoryTag tag, const size_t size)
+{
+    assert(tag < MemoryTagCount);
+
+    if (size > 0)
+    {
+        add(g_tag_counters[tag], size);
+        add(g_total_counter, size);
+    }
+}
+
+void account_memory_deallocation(const MemoryTag tag, const size_t size)
+{
+    assert(tag < MemoryTagCount);
+
+    if (size > 0)
+    {
+        sub(g_tag_counters[tag], size);
+        sub(g_total_counter, size);
+    }
+}
+
+size_t get_accounted_memory_size(const MemoryTag tag)
+{
+    assert(tag < MemoryTagCount);
+    return g_tag_counters[tag].m_size.load(boost::memory_order_relaxed);
+}
+
+size_t get_peak_accounted_memory_size(const MemoryTag tag)
+{
+    assert(tag < MemoryTagCount);
+    return g_tag_counters[tag].m_peak_size.load(boost::memory_order_relaxed);
+}
+
+size_t get_total_accounted_memory_size()
+{
+    return g_total_counter.m_size.load(boost::memory_order_relaxed);
+}
+
+size_t get_peak_total_accounted_memory_size()
+{
+    return g_total_counter.m_peak_size.load(boost::memory_order_relaxed);
+}
+
+void reset_peak_accounted_memory_sizes()
+{
+    for (size_t i = 0; i < MemoryTagCount; ++i)
+        g_tag_counters[i].m_peak_size.store(g_tag_counters[i].m_size.load());
+
+    g_total_counter.m_peak_size.store(g_total_counter.m_size.load());
+}
+
+StatisticsVector get_memory_accounting_statistics()
+{
+    Statistics stats;
+
+    for (size_t i = 0; i < MemoryTagCount; ++i)
+    {
+        const MemoryTag tag = static_cast<MemoryTag>(i);
+        const string name = get_memory_tag_name(tag);
+        stats.insert_size(name, get_accounted_memory_size(tag));
+        stats.insert_size(name + " peak", get_peak_accounted_memory_size(tag));
+    }
+
+    stats.insert_size("total", get_total_accounted_memory_size());
+    stats.insert_size("total peak", get_peak_total_accounted_memory_size());
+
+    return StatisticsVector::make("memory statistics", stats);
+}
+
+}   // namespace foundation
@@ -0,0 +1,167 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_MEMORYACCOUNTING_H
+#define APPLESEED_FOUNDATION_UTILITY_MEMORYACCOUNTING_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class StatisticsVector; }
+
+namespace foundation
+{
+
+//
+// Process-wide accounting of memory usage per subsystem.
+//
+// Subsystems report the memory they allocate and release under a tag. The current
+// and peak size of each tag, and of all tags together, are tracked with a couple of
+// atomic operations per report, cheap enough to be left enabled at all times.
+// Subsystems should report large allocations (tiles, trees, buffers), not every
+// small object.
+//
+
+enum MemoryTag
+{
+    MemoryTagGeometry,
+    MemoryTagBVH,
+    MemoryTagTextures,
+    MemoryTagVolumes,
+    MemoryTagFramebuffers,
+    MemoryTagAOVs,
+    MemoryTagPhotons,
+    MemoryTagOSL,
+    MemoryTagScratch,
+    MemoryTagCount
+};
+
+// Return the human-readable name of a memory tag.
+APPLESEED_DLLSYMBOL const char* get_memory_tag_name(const MemoryTag tag);
+
+// Report an allocation or a deallocation of a given size in bytes. Thread-safe.
+APPLESEED_DLLSYMBOL void account_memory_allocation(const MemoryTag tag, const size_t size);
+APPLESEED_DLLSYMBOL void account_memory_deallocation(const MemoryTag tag, const size_t size);
+
+// Return the current and peak memory size in bytes of a given tag. Thread-safe.
+APPLESEED_DLLSYMBOL size_t get_accounted_memory_size(const MemoryTag tag);
+APPLESEED_DLLSYMBOL size_t get_peak_accounted_memory_size(const MemoryTag tag);
+
+// Return the current and peak memory size in bytes of all tags together. Thread-safe.
+APPLESEED_DLLSYMBOL size_t get_total_accounted_memory_size();
+APPLESEED_DLLSYMBOL size_t get_peak_total_accounted_memory_size();
+
+// Reset peak sizes to current sizes, e.g. at the beginning of a render.
+APPLESEED_DLLSYMBOL void reset_peak_accounted_memory_sizes();
+
+// Retrieve the current and peak memory sizes of all tags.
+APPLESEED_DLLSYMBOL StatisticsVector get_memory_accounting_statistics();
+
+
+//
+// The memory accounted under a given tag by a single object, typically a member of
+// the object owning the memory. The accounted size is released on destruction.
+//
+
+class MemoryAccount
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    explicit MemoryAccount(const MemoryTag tag);
+
+    // Destructor, releases the accounted memory.
+    ~MemoryAccount();
+
+    // Set the memory size in bytes accounted by this object.
+    void set_size(const size_t size);
+
+    // Add or remove memory accounted by this object.
+    void grow(const size_t size);
+    void shrink(const size_t size);
+
+    // Return the memory size in bytes accounted by this object.
+    size_t get_size() const;
+
+  private:
+    const MemoryTag m_tag;
+    size_t          m_size;
+};
+
+
+//
+// MemoryAccount class implementation.
+//
+
+inline MemoryAccount::MemoryAccount(const MemoryTag tag)
+  : m_tag(tag)
+  , m_size(0)
+{
+}
+
+inline MemoryAccount::~MemoryAccount()
+{
+    set_size(0);
+}
+
+inline void MemoryAccount::set_size(const size_t size)
+{
+    if (size > m_size)
+        grow(size - m_size);
+    else if (size < m_size)
+        shrink(m_size - size);
+}
+
+inline void MemoryAccount::grow(const size_t size)
+{
+    account_memory_allocation(m_tag, size);
+    m_size += size;
+}
+
+inline void MemoryAccount::shrink(const size_t size)
+{
+    account_memory_deallocation(m_tag, size);
+    m_size -= size;
+}
+
+inline size_t MemoryAccount::get_size() const
+{
+    return m_size;
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_MEMORYACCOUNTING_H
@@ -0,0 +1,394 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "remotefilecache.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/siphash.h"
+
+// Boost headers.
+#include "boost/asio.hpp"
+#include "boost/filesystem.hpp"
+#include "boost/system/error_code.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <utility>
+
+using namespace boost;
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace foundation
+{
+
+//
+// RemoteFileCache class implementation.
+//
+
+namespace
+{
+    const char UrlPrefix[] = "http://";
+
+    struct Url
+    {
+        string  m_host;
+        string  m_port;
+        string  m_path;
+    };
+
+    bool parse_url(const char* url, Url& result)
+    {
+        if (strncmp(url, UrlPrefix, sizeof(UrlPrefix) - 1) != 0)
+            return false;
+
+        const string rest(url + sizeof(UrlPrefix) - 1);
+        const size_t path_begin = rest.find('/');
+        const string authority = rest.substr(0, path_begin);
+
+        const size_t colon = authority.find(':');
+        result.m_host = authority.substr(0, colon);
+        result.m_port = colon != string::npos ? authority.substr(colon + 1) : "80";
+        result.m_path = path_begin != string::npos ? rest.substr(path_begin) : "/";
+
+        return !result.m_host.empty();
+    }
+
+    // Return the extension of the file named by a URL, including the dot, without query string.
+    string get_url_extension(const string& path)
+    {
+        const string file_path = path.substr(0, path.find_first_of("?#"));
+        const size_t dot = file_path.find_last_of("./");
+
+        return dot != string::npos && file_path[dot] == '.' ? file_path.substr(dot) : string();
+    }
+
+    enum FetchResult
+    {
+        FetchSucceeded,
+        FetchNotFound,          // the server does not have the file
+        FetchFailed             // network or disk error, the request may succeed later
+    };
+
+    // Download a file with an HTTP GET request.
+    FetchResult http_get(const Url& url, const bf::path& output_path)
+    {
+        try
+        {
+            asio::io_service io_service;
+            asio::ip::tcp::resolver resolver(io_service);
+            asio::ip::tcp::socket socket(io_service);
+            asio::connect(socket, resolver.resolve(asio::ip::tcp::resolver::query(url.m_host, url.m_port)));
+
+            // HTTP/1.0 responses are never chunked and end when the connection is closed.
+            asio::streambuf request;
+            ostream request_stream(&request);
+            request_stream << "GET " << url.m_path << " HTTP/1.0\r\n";
+            request_stream << "Host: " << url.m_host << "\r\n";
+            request_stream << "Accept: */*\r\n";
+            request_stream << "Connection: close\r\n\r\n";
+            asio::write(socket, request);
+
+            // Read the status line.
+            asio::streambuf response;
+            asio::read_until(socket, response, "\r\n");
+            istream response_stream(&response);
+            string http_version;
+            unsigned int status_code = 0;
+            response_stream >> http_version >> status_code;
+            string status_message;
+            getline(response_stream, status_message);
+
+            if (http_version.compare(0, 5, "HTTP/") != 0)
+                return FetchFailed;
+
+            // Object storage commonly answers 403 rather than 404 for missing objects.
+            if (status_code == 404 || status_code == 403 || status_code == 410)
+                return FetchNotFound;
+
+            if (status_code != 200)
+                return FetchFailed;
+
+            // Read the headers.
+            asio::read_until(socket, response, "\r\n\r\n");
+            uint64 content_length = ~uint64(0);
+            string header;
+            while (getline(response_stream, header) && header != "\r")
+            {
+                static const char ContentLength[] = "content-length:";
+                if (lower_case(header.substr(0, sizeof(ContentLength) - 1)) == ContentLength)
+                    content_length = from_string<uint64>(trim_both(header.substr(sizeof(ContentLength) - 1)));
+            }
+
+            // Read the body.
+            ofstream file(output_path.string().c_str(), ios::out | ios::binary);
+            if (!file.is_open())
+                return FetchFailed;
+
+            uint64 size = 0;
+            system::error_code ec;
+            do
+            {
+                // Inserting an empty stream buffer would set the failbit of the file.
+                if (response.size() > 0)
+                {
+                    size += response.size();
+                    file << &response;
+                }
+            } while (asio::read(socket, response, asio::transfer_at_least(1), ec));
+
+            if (ec != asio::error::eof || !file.good())
+                return FetchFailed;
+
+            if (content_length != ~uint64(0) && size != content_length)
+                return FetchFailed;
+
+            return FetchSucceeded;
+        }
+        catch (const std::exception&)
+        {
+            return FetchFailed;
+        }
+    }
+}
+
+struct RemoteFileCache::Impl
+{
+    typedef multimap<time_t, bf::path> FilesByTime;
+
+    const string            m_directory;
+    const uint64            m_max_size;
+    mutable boost::mutex    m_mutex;
+    mutable set<string>     m_missing_urls;
+
+    Impl(const char* directory, const uint64 max_size)
+      : m_directory(directory)
+      , m_max_size(max_size)
+    {
+    }
+
+    bf::path get_file_path(const char* url) const
+    {
+        const uint64 key = siphash24(url, strlen(url), 0, 0);
+
+        stringstream sstr;
+        sstr << hex << setw(16) << setfill('0') << key;
+
+        Url parsed_url;
+        if (parse_url(url, parsed_url))
+            sstr << get_url_extension(parsed_url.m_path);
+
+        return bf::path(m_directory) / sstr.str();
+    }
+
+    // Remove the least recently used files until the cache fits its maximum size.
+    // The file just fetched is never removed. Must be called with the mutex locked.
+    void evict(const bf::path& keep) const
+    {
+        if (m_max_size == 0)
+            return;
+
+        FilesByTime files;
+        uint64 total_size = 0;
+
+        system::error_code dir_ec;
+        for (bf::directory_iterator i(m_directory, dir_ec), e; !dir_ec && i != e; i.increment(dir_ec))
+        {
+            const bf::path& path = i->path();
+
+            system::error_code ec;
+            if (path.extension() == ".tmp" || !bf::is_regular_file(path, ec))
+                continue;
+
+            const uint64 size = bf::file_size(path, ec);
+            const time_t time = bf::last_write_time(path, ec);
+            if (ec)
+                continue;
+
+            total_size += size;
+            files.insert(make_pair(time, path));
+        }
+
+        system::error_code ec;
+        for (FilesByTime::const_iterator i = files.begin(), e = files.end(); i != e && total_size > m_max_size; ++i)
+        {
+            if (i->second == keep)
+                continue;
+
+            const uint64 size = bf::file_size(i->second, ec);
+            if (bf::remove(i->second, ec))
+                total_size -= size;
+        }
+    }
+};
+
+bool RemoteFileCache::is_url(const char* path)
+{
+    return strncmp(path, UrlPrefix, sizeof(UrlPrefix) - 1) == 0;
+}
+
+RemoteFileCache::RemoteFileCache(
+    const char*     directory,
+    const uint64    max_size)
+  : impl(new Impl(directory, max_size))
+{
+    system::error_code ec;
+    bf::create_directories(impl->m_directory, ec);
+}
+
+RemoteFileCache::~RemoteFileCache()
+{
+    delete impl;
+}
+
+const char* RemoteFileCache::get_directory() const
+{
+    return impl->m_directory.c_str();
+}
+
+uint64 RemoteFileCache::get_max_size() const
+{
+    return impl->m_max_size;
+}
+
+char* RemoteFileCache::do_fetch(const char* url) const
+{
+    Url parsed_url;
+    if (!parse_url(url, parsed_url))
+        return 0;
+
+    const bf::path path = impl->get_file_path(url);
+
+    {
+        boost::mutex::scoped_lock lock(impl->m_mutex);
+
+        if (impl->m_missing_urls.count(url) > 0)
+            return 0;
+
+        // Cache hit: mark the file as recently used.
+        system::error_code ec;
+        if (bf::exists(path, ec))
+        {
+            bf::last_write_time(path, time(0), ec);
+            return duplicate_string(path.string().c_str());
+        }
+    }
+
+    system::error_code ec;
+
+    // Download the file under a unique temporary name, then rename it: concurrent
+    // readers, including other processes of the machine, never see a partial file.
+    const bf::path temp_path = bf::path(impl->m_directory) / bf::unique_path("%%%%%%%%%%%%%%%%.tmp", ec);
+    if (ec)
+        return 0;
+
+    const FetchResult result = http_get(parsed_url, temp_path);
+
+    if (result != FetchSucceeded)
+    {
+        bf::remove(temp_path, ec);
+
+        if (result == FetchNotFound)
+        {
+            boost::mutex::scoped_lock lock(impl->m_mutex);
+            impl->m_missing_urls.insert(url);
+        }
+
+        return 0;
+    }
+
+    bf::rename(temp_path, path, ec);
+    if (ec)
+    {
+        bf::remove(temp_path, ec);
+        return 0;
+    }
+
+    {
+        boost::mutex::scoped_lock lock(impl->m_mutex);
+        impl->evict(path);
+    }
+
+    return duplicate_string(path.string().c_str());
+}
+
+namespace
+{
+    string get_global_cache_directory()
+    {
+        if (const char* directory = getenv("APPLESEED_REMOTE_CACHE_DIR"))
+            return directory;
+
+        system::error_code ec;
+        const bf::path temp_directory = bf::temp_directory_path(ec);
+        return (temp_directory / "appleseed-remote-cache").string();
+    }
+
+    uint64 get_global_cache_max_size()
+    {
+        uint64 max_size_mb = 10240;
+
+        if (const char* value = getenv("APPLESEED_REMOTE_CACHE_SIZE"))
+        {
+            try
+            {
+                max_size_mb = from_string<uint64>(value);
+            }
+            catch (const ExceptionStringConversionError&)
+            {
+            }
+        }
+
+        return max_size_mb * 1024 * 1024;
+    }
+}
+
+RemoteFileCache& global_remote_file_cache()
+{
+    static RemoteFileCache cache(
+        get_global_cache_directory().c_str(),
+        get_global_cache_max_size());
+
+    return cache;
+}
+
+}   // namespace foundation
@@ -0,0 +1,119 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_REMOTEFILECACHE_H
+#define APPLESEED_FOUNDATION_UTILITY_REMOTEFILECACHE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/string.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <string>
+
+namespace foundation
+{
+
+//
+// A node-local disk cache of files fetched on demand from HTTP servers, including
+// object storage exposed over HTTP (public or presigned S3 URLs, S3-compatible
+// gateways, etc.)
+//
+// Cached files are named after a hash of their URL and keep the extension of the
+// remote file so that image and mesh readers can recognize their format. Remote
+// files are assumed to be immutable, as is the case for versioned asset storage.
+// When the total size of the cache exceeds its limit, the least recently used
+// files are removed.
+//
+// All methods are thread-safe.
+//
+
+class APPLESEED_DLLSYMBOL RemoteFileCache
+  : public NonCopyable
+{
+  public:
+    // Return true if a path is a URL that can be fetched by the cache.
+    static bool is_url(const char* path);
+    static bool is_url(const std::string& path);
+
+    // Constructor. The directory is created if it does not exist.
+    // A maximum size of 0 means that the size of the cache is not limited.
+    RemoteFileCache(
+        const char*     directory,
+        const uint64    max_size = 0);
+
+    // Destructor.
+    ~RemoteFileCache();
+
+    // Return the directory of the cache.
+    const char* get_directory() const;
+
+    // Return the maximum size in bytes of the cache, or 0 if it is not limited.
+    uint64 get_max_size() const;
+
+    // Return the path of the local copy of a remote file, fetching it first if it is
+    // not already cached. Return an empty string if the file could not be fetched.
+    // Files that don't exist on the server are remembered and not requested again.
+    std::string fetch(const std::string& url) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+
+    char* do_fetch(const char* url) const;
+};
+
+// Return the process-wide remote file cache. It is stored in the directory given by the
+// APPLESEED_REMOTE_CACHE_DIR environment variable (by default, in the temporary directory
+// of the system) and limited to APPLESEED_REMOTE_CACHE_SIZE megabytes (10240 by default).
+APPLESEED_DLLSYMBOL RemoteFileCache& global_remote_file_cache();
+
+
+//
+// RemoteFileCache class implementation.
+//
+
+inline bool RemoteFileCache::is_url(const std::string& path)
+{
+    return is_url(path.c_str());
+}
+
+inline std::string RemoteFileCache::fetch(const std::string& url) const
+{
+    char* path = do_fetch(url.c_str());
+    return path ? convert_to_std_string(path) : std::string();
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_REMOTEFILECACHE_H
@@ -32,6 +32,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/remotefilecache.h"
 #include "foundation/utility/string.h"
 
 // Boost headers.
@@ -69,6 +70,21 @@ const char SearchPaths::osl_path_separator()
     return ':';
 }
 
+namespace
+{
+    // Fetch a file from a URL search path into the remote file cache.
+    // Return the path of the local copy, or an empty string if the file could not be fetched.
+    string fetch_remote_file(const string& search_path, const bf::path& filepath)
+    {
+        string url = search_path;
+        if (url[url.size() - 1] != '/')
+            url += '/';
+        url += filepath.generic_string();
+
+        return global_remote_file_cache().fetch(url);
+    }
+}
+
 struct SearchPaths::Impl
 {
     typedef vector<string> PathCollection;
@@ -97,7 +113,7 @@ SearchPaths::SearchPaths(const char* envvar, const char separator)
             const bf::path fp(*i);
 
             // Ignore relative paths.
-            if (!fp.is_absolute())
+            if (!fp.is_absolute() && !RemoteFileCache::is_url(*i))
                 continue;
 
             if (!i->empty())
@@ -199,6 +215,10 @@ bool SearchPaths::exist(const char* filepath) const
 {
     assert(filepath);
 
+    // Remote files are found if they can be fetched.
+    if (RemoteFileCache::is_url(filepath))
+        return !global_remote_file_cache().fetch(filepath).empty();
+
     const bf::path fp(filepath);
 
     if (!fp.is_absolute())
@@ -207,6 +227,13 @@ bool SearchPaths::exist(const char* filepath) const
         for (Impl::PathCollection::const_reverse_iterator
                 i = impl->m_all_paths.rbegin(), e = impl->m_all_paths.rend(); i != e; ++i)
         {
+            if (RemoteFileCache::is_url(*i))
+            {
+                if (!fetch_remote_file(*i, fp).empty())
+                    return true;
+                continue;
+            }
+
             bf::path search_path(*i);
 
             // Make the search path absolute if there is a root path.
@@ -237,6 +264,16 @@ void SearchPaths::do_qualify(const char* filepath, char** qualified_filepath_cst
 {
     assert(filepath);
 
+    // Remote files are qualified to their local copy in the remote file cache.
+    if (RemoteFileCache::is_url(filepath))
+    {
+        const string local_filepath = global_remote_file_cache().fetch(filepath);
+        *qualified_filepath_cstr = duplicate_string(local_filepath.empty() ? filepath : local_filepath.c_str());
+        if (search_path_cstr)
+            *search_path_cstr = 0;
+        return;
+    }
+
     const bf::path fp(filepath);
 
     if (!fp.is_absolute())
@@ -245,6 +282,20 @@ void SearchPaths::do_qualify(const char* filepath, char** qualified_filepath_cst
         for (Impl::PathCollection::const_reverse_iterator
                 i = impl->m_all_paths.rbegin(), e = impl->m_all_paths.rend(); i != e; ++i)
         {
+            // Fetch files found in URL search paths into the remote file cache.
+            if (RemoteFileCache::is_url(*i))
+            {
+                const string local_filepath = fetch_remote_file(*i, fp);
+                if (!local_filepath.empty())
+                {
+                    *qualified_filepath_cstr = duplicate_string(local_filepath.c_str());
+                    if (search_path_cstr)
+                        *search_path_cstr = duplicate_string(i->c_str());
+                    return;
+                }
+                continue;
+            }
+
             bf::path search_path(*i);
 
             // Make the search path absolute if there is a root path.
@@ -302,6 +353,10 @@ char* SearchPaths::do_to_string(const char separator, const bool reversed) const
 
     for (size_t i = 0, e = paths.size(); i < e; ++i)
     {
+        // URL search paths can only be used through qualify().
+        if (RemoteFileCache::is_url(paths[i]))
+            continue;
+
         bf::path p(paths[i]);
 
         if (p.is_relative())
@@ -49,6 +49,10 @@ namespace foundation
 // The paths are ordered by ascending priority:
 // paths inserted later have precedence over those inserted earlier.
 //
+// Search paths and file paths may also be http:// URLs. Such files are fetched
+// on demand into the process-wide remote file cache (see remotefilecache.h) and
+// are qualified to the path of their local copy.
+//
 
 class APPLESEED_DLLSYMBOL SearchPaths
 {
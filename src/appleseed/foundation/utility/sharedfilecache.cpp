@@ -0,0 +1,188 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sharedfilecache.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+#include "boost/system/error_code.hpp"
+
+// Standard headers.
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace boost;
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace foundation
+{
+
+//
+// SharedFileView class implementation.
+//
+
+struct SharedFileView::Impl
+{
+    interprocess::file_mapping      m_file_mapping;
+    interprocess::mapped_region     m_mapped_region;
+
+    explicit Impl(const char* path)
+      : m_file_mapping(path, interprocess::read_only)
+      , m_mapped_region(m_file_mapping, interprocess::read_only)
+    {
+    }
+};
+
+SharedFileView::SharedFileView(const char* path)
+  : impl(new Impl(path))
+{
+}
+
+SharedFileView::~SharedFileView()
+{
+    delete impl;
+}
+
+const void* SharedFileView::get_data() const
+{
+    return impl->m_mapped_region.get_address();
+}
+
+size_t SharedFileView::get_size() const
+{
+    return impl->m_mapped_region.get_size();
+}
+
+
+//
+// SharedFileCache class implementation.
+//
+
+struct SharedFileCache::Impl
+{
+    string m_directory;
+
+    string get_file_path(const uint64 key) const
+    {
+        stringstream sstr;
+        sstr << hex << setw(16) << setfill('0') << key << ".bin";
+        return (bf::path(m_directory) / sstr.str()).string();
+    }
+};
+
+SharedFileCache::SharedFileCache(const char* directory)
+  : impl(new Impl())
+{
+    impl->m_directory = directory;
+
+    system::error_code ec;
+    bf::create_directories(impl->m_directory, ec);
+}
+
+SharedFileCache::~SharedFileCache()
+{
+    delete impl;
+}
+
+const char* SharedFileCache::get_directory() const
+{
+    return impl->m_directory.c_str();
+}
+
+SharedFileView* SharedFileCache::acquire(const uint64 key) const
+{
+    const string path = impl->get_file_path(key);
+
+    system::error_code ec;
+    if (!bf::exists(path, ec) || bf::file_size(path, ec) == 0 || ec)
+        return 0;
+
+    try
+    {
+        return new SharedFileView(path.c_str());
+    }
+    catch (const std::exception&)
+    {
+        return 0;
+    }
+}
+
+bool SharedFileCache::publish(
+    const uint64    key,
+    const void*     data,
+    const size_t    size) const
+{
+    const string path = impl->get_file_path(key);
+
+    system::error_code ec;
+    if (bf::exists(path, ec))
+        return true;
+    ec.clear();
+
+    // Write the file under a unique temporary name, then rename it: concurrent
+    // readers and writers never see a partially written file.
+    const bf::path temp_path =
+        bf::path(impl->m_directory) / bf::unique_path("%%%%%%%%%%%%%%%%.tmp", ec);
+    if (ec)
+        return false;
+
+    {
+        ofstream file(temp_path.string().c_str(), ios::out | ios::binary);
+        if (!file.is_open())
+            return false;
+
+        file.write(static_cast<const char*>(data), size);
+
+        if (!file.good())
+        {
+            file.close();
+            bf::remove(temp_path, ec);
+            return false;
+        }
+    }
+
+    bf::rename(temp_path, path, ec);
+    if (ec)
+    {
+        bf::remove(temp_path, ec);
+        return false;
+    }
+
+    return true;
+}
+
+}   // namespace foundation
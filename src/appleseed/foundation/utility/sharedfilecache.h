@@ -0,0 +1,115 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_SHAREDFILECACHE_H
+#define APPLESEED_FOUNDATION_UTILITY_SHAREDFILECACHE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+namespace foundation
+{
+
+//
+// A read-only view of a file of a shared file cache.
+//
+// The file is memory-mapped: all processes viewing the same file share the
+// same physical memory through the page cache of the operating system.
+//
+
+class APPLESEED_DLLSYMBOL SharedFileView
+  : public NonCopyable
+{
+  public:
+    // Destructor. Unmaps the file.
+    ~SharedFileView();
+
+    // Return the contents of the file.
+    const void* get_data() const;
+    size_t get_size() const;
+
+  private:
+    friend class SharedFileCache;
+
+    struct Impl;
+    Impl* impl;
+
+    // Constructor. Throws an exception if the file cannot be mapped.
+    explicit SharedFileView(const char* path);
+};
+
+
+//
+// A cache of immutable files identified by 64-bit keys, stored in a directory
+// shared by all the processes of a machine, e.g. concurrent renders of the
+// same shot. Files are published atomically: a file is either entirely
+// visible to other processes or not at all.
+//
+// All methods are thread-safe.
+//
+
+class APPLESEED_DLLSYMBOL SharedFileCache
+  : public NonCopyable
+{
+  public:
+    // Constructor. The directory is created if it does not exist.
+    explicit SharedFileCache(const char* directory);
+
+    // Destructor.
+    ~SharedFileCache();
+
+    // Return the directory of the cache.
+    const char* get_directory() const;
+
+    // Return a view of the file with a given key, or 0 if there is no such file.
+    // The caller owns the view.
+    SharedFileView* acquire(const uint64 key) const;
+
+    // Store a file with a given key, unless the cache holds one already.
+    // Returns false if the file could not be written.
+    bool publish(
+        const uint64    key,
+        const void*     data,
+        const size_t    size) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_SHAREDFILECACHE_H
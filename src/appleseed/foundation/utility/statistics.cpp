@@ -31,13 +31,24 @@
 #include "statistics.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/fp.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/json.h"
 
 using namespace std;
 
 namespace foundation
 {
 
+namespace
+{
+    void write_json_indent(ostream& output, const size_t level)
+    {
+        output << string(level * 2, ' ');
+    }
+}
+
+
 //
 // Statistics class implementation.
 //
@@ -122,6 +133,31 @@ string Statistics::to_string(const size_t max_header_length) const
 }
 
 
+void Statistics::write_json(ostream& output, const size_t indent) const
+{
+    output << "{";
+
+    for (const_each<EntryVector> i = m_entries; i; ++i)
+    {
+        const Entry* entry = *i;
+
+        output << (i.it() > m_entries.begin() ? ",\n" : "\n");
+        write_json_indent(output, indent + 1);
+        write_json_string(output, entry->m_name);
+        output << ": ";
+        entry->write_json(output);
+    }
+
+    if (!m_entries.empty())
+    {
+        output << "\n";
+        write_json_indent(output, indent);
+    }
+
+    output << "}";
+}
+
+
 //
 // Statistics::ExceptionDuplicateName class implementation.
 //
@@ -159,6 +195,19 @@ Statistics::Entry::Entry(
 {
 }
 
+void Statistics::Entry::write_json_number(ostream& output, const double value)
+{
+    if (FP<double>::is_inf(value) || FP<double>::is_nan(value))
+    {
+        output << "null";
+        return;
+    }
+
+    const streamsize old_precision = output.precision(15);
+    output << value;
+    output.precision(old_precision);
+}
+
 
 //
 // Statistics::IntegerEntry class implementation.
@@ -188,6 +237,11 @@ string Statistics::IntegerEntry::to_string() const
     return pretty_int(m_value);
 }
 
+void Statistics::IntegerEntry::write_json(ostream& output) const
+{
+    output << m_value;
+}
+
 
 //
 // Statistics::UnsignedIntegerEntry class implementation.
@@ -217,6 +271,11 @@ string Statistics::UnsignedIntegerEntry::to_string() const
     return pretty_uint(m_value);
 }
 
+void Statistics::UnsignedIntegerEntry::write_json(ostream& output) const
+{
+    output << m_value;
+}
+
 
 //
 // Statistics::FloatingPointEntry class implementation.
@@ -246,6 +305,11 @@ string Statistics::FloatingPointEntry::to_string() const
     return pretty_scalar(m_value);
 }
 
+void Statistics::FloatingPointEntry::write_json(ostream& output) const
+{
+    write_json_number(output, m_value);
+}
+
 
 //
 // Statistics::StringEntry class implementation.
@@ -275,6 +339,105 @@ string Statistics::StringEntry::to_string() const
     return m_value;
 }
 
+void Statistics::StringEntry::write_json(ostream& output) const
+{
+    write_json_string(output, m_value);
+}
+
+
+//
+// Statistics::SizeEntry class implementation.
+//
+
+Statistics::SizeEntry::SizeEntry(
+    const string&               name,
+    const uint64                bytes,
+    const streamsize            precision)
+  : UnsignedIntegerEntry(name, "bytes", bytes)
+  , m_precision(precision)
+{
+}
+
+auto_ptr<Statistics::Entry> Statistics::SizeEntry::clone() const
+{
+    return auto_ptr<Entry>(new SizeEntry(*this));
+}
+
+void Statistics::SizeEntry::merge(const Entry* other)
+{
+}
+
+string Statistics::SizeEntry::to_string() const
+{
+    return pretty_size(m_value, m_precision);
+}
+
+
+//
+// Statistics::TimeEntry class implementation.
+//
+
+Statistics::TimeEntry::TimeEntry(
+    const string&               name,
+    const double                seconds,
+    const streamsize            precision)
+  : FloatingPointEntry(name, "seconds", seconds)
+  , m_precision(precision)
+{
+}
+
+auto_ptr<Statistics::Entry> Statistics::TimeEntry::clone() const
+{
+    return auto_ptr<Entry>(new TimeEntry(*this));
+}
+
+void Statistics::TimeEntry::merge(const Entry* other)
+{
+}
+
+string Statistics::TimeEntry::to_string() const
+{
+    return pretty_time(m_value, m_precision);
+}
+
+
+//
+// Statistics::PercentEntry class implementation.
+//
+
+Statistics::PercentEntry::PercentEntry(
+    const string&               name,
+    const double                numerator,
+    const double                denominator,
+    const streamsize            precision)
+  : Entry(name, "%")
+  , m_numerator(numerator)
+  , m_denominator(denominator)
+  , m_precision(precision)
+{
+}
+
+auto_ptr<Statistics::Entry> Statistics::PercentEntry::clone() const
+{
+    return auto_ptr<Entry>(new PercentEntry(*this));
+}
+
+void Statistics::PercentEntry::merge(const Entry* other)
+{
+}
+
+string Statistics::PercentEntry::to_string() const
+{
+    return pretty_percent(m_numerator, m_denominator, m_precision);
+}
+
+void Statistics::PercentEntry::write_json(ostream& output) const
+{
+    if (m_denominator == 0.0)
+        output << "null";
+    else write_json_number(output, 100.0 * m_numerator / m_denominator);
+}
+
 
 //
 // StatisticsVector class implementation.
@@ -305,6 +468,27 @@ void StatisticsVector::merge(const StatisticsVector& other)
         merge(*i);
 }
 
+void StatisticsVector::update(const StatisticsVector& other)
+{
+    for (const_each<NamedStatisticsVector> i = other.m_stats; i; ++i)
+    {
+        bool found = false;
+
+        for (each<NamedStatisticsVector> j = m_stats; j; ++j)
+        {
+            if (j->m_name == i->m_name)
+            {
+                j->m_stats = i->m_stats;
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+            m_stats.push_back(*i);
+    }
+}
+
 void StatisticsVector::merge(const NamedStatistics& other)
 {
     for (each<NamedStatisticsVector> i = m_stats; i; ++i)
@@ -319,6 +503,28 @@ void StatisticsVector::merge(const NamedStatistics& other)
     m_stats.push_back(other);
 }
 
+void StatisticsVector::write_json(ostream& output, const size_t indent) const
+{
+    output << "{";
+
+    for (const_each<NamedStatisticsVector> i = m_stats; i; ++i)
+    {
+        output << (i.it() > m_stats.begin() ? ",\n" : "\n");
+        write_json_indent(output, indent + 1);
+        write_json_string(output, i->m_name);
+        output << ": ";
+        i->m_stats.write_json(output, indent + 1);
+    }
+
+    if (!m_stats.empty())
+    {
+        output << "\n";
+        write_json_indent(output, indent);
+    }
+
+    output << "}";
+}
+
 string StatisticsVector::to_string(const size_t max_header_length) const
 {
     stringstream sstr;
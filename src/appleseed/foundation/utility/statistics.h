@@ -89,6 +89,10 @@ class Statistics
         virtual std::auto_ptr<Entry> clone() const = 0;
         virtual void merge(const Entry* other) = 0;
         virtual std::string to_string() const = 0;
+        virtual void write_json(std::ostream& output) const = 0;
+
+        // Write a number in JSON format; non-finite values are written as null.
+        static void write_json_number(std::ostream& output, const double value);
     };
 
     struct IntegerEntry
@@ -104,6 +108,7 @@ class Statistics
         virtual std::auto_ptr<Entry> clone() const APPLESEED_OVERRIDE;
         virtual void merge(const Entry* other) APPLESEED_OVERRIDE;
         virtual std::string to_string() const APPLESEED_OVERRIDE;
+        virtual void write_json(std::ostream& output) const APPLESEED_OVERRIDE;
     };
 
     struct UnsignedIntegerEntry
@@ -119,6 +124,7 @@ class Statistics
         virtual std::auto_ptr<Entry> clone() const APPLESEED_OVERRIDE;
         virtual void merge(const Entry* other) APPLESEED_OVERRIDE;
         virtual std::string to_string() const APPLESEED_OVERRIDE;
+        virtual void write_json(std::ostream& output) const APPLESEED_OVERRIDE;
     };
 
     struct FloatingPointEntry
@@ -134,6 +140,7 @@ class Statistics
         virtual std::auto_ptr<Entry> clone() const APPLESEED_OVERRIDE;
         virtual void merge(const Entry* other) APPLESEED_OVERRIDE;
         virtual std::string to_string() const APPLESEED_OVERRIDE;
+        virtual void write_json(std::ostream& output) const APPLESEED_OVERRIDE;
     };
 
     struct StringEntry
@@ -149,6 +156,60 @@ class Statistics
         virtual std::auto_ptr<Entry> clone() const APPLESEED_OVERRIDE;
         virtual void merge(const Entry* other) APPLESEED_OVERRIDE;
         virtual std::string to_string() const APPLESEED_OVERRIDE;
+        virtual void write_json(std::ostream& output) const APPLESEED_OVERRIDE;
+    };
+
+    // Statistics inserted with insert_size(), insert_time() and insert_percent() keep their
+    // value for structured output (bytes, seconds and percent respectively) and format it
+    // for display. Like string statistics, they are not merged.
+
+    struct SizeEntry
+      : public UnsignedIntegerEntry
+    {
+        std::streamsize m_precision;
+
+        SizeEntry(
+            const std::string&          name,
+            const uint64                bytes,
+            const std::streamsize       precision);
+
+        virtual std::auto_ptr<Entry> clone() const APPLESEED_OVERRIDE;
+        virtual void merge(const Entry* other) APPLESEED_OVERRIDE;
+        virtual std::string to_string() const APPLESEED_OVERRIDE;
+    };
+
+    struct TimeEntry
+      : public FloatingPointEntry
+    {
+        std::streamsize m_precision;
+
+        TimeEntry(
+            const std::string&          name,
+            const double                seconds,
+            const std::streamsize       precision);
+
+        virtual std::auto_ptr<Entry> clone() const APPLESEED_OVERRIDE;
+        virtual void merge(const Entry* other) APPLESEED_OVERRIDE;
+        virtual std::string to_string() const APPLESEED_OVERRIDE;
+    };
+
+    struct PercentEntry
+      : public Entry
+    {
+        double          m_numerator;
+        double          m_denominator;
+        std::streamsize m_precision;
+
+        PercentEntry(
+            const std::string&          name,
+            const double                numerator,
+            const double                denominator,
+            const std::streamsize       precision);
+
+        virtual std::auto_ptr<Entry> clone() const APPLESEED_OVERRIDE;
+        virtual void merge(const Entry* other) APPLESEED_OVERRIDE;
+        virtual std::string to_string() const APPLESEED_OVERRIDE;
+        virtual void write_json(std::ostream& output) const APPLESEED_OVERRIDE;
     };
 
     template <typename T>
@@ -165,6 +226,7 @@ class Statistics
         virtual std::auto_ptr<Entry> clone() const APPLESEED_OVERRIDE;
         virtual void merge(const Entry* other) APPLESEED_OVERRIDE;
         virtual std::string to_string() const APPLESEED_OVERRIDE;
+        virtual void write_json(std::ostream& output) const APPLESEED_OVERRIDE;
     };
 
     Statistics();
@@ -219,6 +281,9 @@ class Statistics
 
     std::string to_string(const size_t max_header_length = 16) const;
 
+    // Write the statistics as a JSON object whose members are the statistics names.
+    void write_json(std::ostream& output, const size_t indent = 0) const;
+
   private:
     typedef std::vector<Entry*> EntryVector;
     typedef std::map<std::string, Entry*> EntryIndex;
@@ -248,8 +313,15 @@ class StatisticsVector
 
     void merge(const StatisticsVector& other);
 
+    // Replace the collections that have the same name as one of another vector,
+    // and append the other ones.
+    void update(const StatisticsVector& other);
+
     std::string to_string(const size_t max_header_length = 16) const;
 
+    // Write the statistics as a JSON object whose members are the names of the collections.
+    void write_json(std::ostream& output, const size_t indent = 0) const;
+
   private:
     struct NamedStatistics
     {
@@ -372,7 +444,9 @@ inline void Statistics::insert_size(
     const uint64                        bytes,
     const std::streamsize               precision)
 {
-    insert(name, pretty_size(bytes, precision));
+    insert(
+        std::auto_ptr<SizeEntry>(
+            new SizeEntry(name, bytes, precision)));
 }
 
 inline void Statistics::insert_time(
@@ -380,7 +454,9 @@ inline void Statistics::insert_time(
     const double                        seconds,
     const std::streamsize               precision)
 {
-    insert(name, pretty_time(seconds, precision));
+    insert(
+        std::auto_ptr<TimeEntry>(
+            new TimeEntry(name, seconds, precision)));
 }
 
 template <typename T>
@@ -390,7 +466,13 @@ void Statistics::insert_percent(
     const T                             denominator,
     const std::streamsize               precision)
 {
-    insert(name, pretty_percent(numerator, denominator, precision));
+    insert(
+        std::auto_ptr<PercentEntry>(
+            new PercentEntry(
+                name,
+                static_cast<double>(numerator),
+                static_cast<double>(denominator),
+                precision)));
 }
 
 
@@ -452,6 +534,20 @@ std::string Statistics::PopulationEntry<T>::to_string() const
     return sstr.str();
 }
 
+template <typename T>
+void Statistics::PopulationEntry<T>::write_json(std::ostream& output) const
+{
+    output << "{ \"size\": " << m_value.get_size() << ", \"min\": ";
+    write_json_number(output, static_cast<double>(m_value.get_min()));
+    output << ", \"max\": ";
+    write_json_number(output, static_cast<double>(m_value.get_max()));
+    output << ", \"mean\": ";
+    write_json_number(output, m_value.get_mean());
+    output << ", \"dev\": ";
+    write_json_number(output, m_value.get_dev());
+    output << " }";
+}
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_UTILITY_STATISTICS_H
@@ -44,11 +44,14 @@
 #include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <cfloat>
+#include <cmath>
 #include <cstddef>
 #include <ctime>
 #include <iomanip>
 #include <ios>
 #include <iterator>
+#include <limits>
 #include <sstream>
 #include <string>
 
@@ -440,18 +443,213 @@ T from_string(const char* s)
     return from_string<T>(std::string(s));
 }
 
-template <typename T>
-T from_string(const std::string& s)
+namespace impl
 {
-    std::istringstream istr(s);
+    // Stream-based conversion, used for types without a dedicated parser and for
+    // inputs that the parsers below don't handle (surrounding blanks, overflows,
+    // special values, long mantissas, etc.).
+    template <typename T>
+    T from_string_stream(const std::string& s)
+    {
+        std::istringstream istr(s);
 
-    T val;
-    istr >> val;
+        T val;
+        istr >> val;
 
-    if (!istr || !istr.eof())
-        throw ExceptionStringConversionError();
+        if (!istr || !istr.eof())
+            throw ExceptionStringConversionError();
+
+        return val;
+    }
+
+    // Parse an optionally signed sequence of decimal digits that fits in T.
+    template <typename T>
+    bool parse_integer(const std::string& s, T& value)
+    {
+        const char* p = s.c_str();
+        const char* end = p + s.size();
+
+        bool negative = false;
+        if (p < end && (*p == '+' || *p == '-'))
+        {
+            negative = *p++ == '-';
+
+            // Let the stream-based conversion handle negative unsigned values.
+            if (negative && !std::numeric_limits<T>::is_signed)
+                return false;
+        }
+
+        if (p == end)
+            return false;
+
+        const uint64 limit =
+            negative
+                ? static_cast<uint64>(std::numeric_limits<T>::max()) + 1
+                : static_cast<uint64>(std::numeric_limits<T>::max());
+
+        uint64 magnitude = 0;
+
+        for (; p < end; ++p)
+        {
+            const unsigned int digit = static_cast<unsigned int>(*p - '0');
+
+            if (digit > 9 || magnitude > (limit - digit) / 10)
+                return false;
+
+            magnitude = magnitude * 10 + digit;
+        }
+
+        value = static_cast<T>(negative ? ~magnitude + 1 : magnitude);
+
+        return true;
+    }
+
+    // Parse a number of the form [+-]digits[.digits][(e|E)[+-]digits] with at most
+    // 19 significant digits into a sign, an integer mantissa and a power of ten.
+    inline bool parse_decimal(
+        const std::string&  s,
+        bool&               negative,
+        uint64&             mantissa,
+        int&                exponent)
+    {
+        const char* p = s.c_str();
+        const char* end = p + s.size();
+
+        negative = false;
+        if (p < end && (*p == '+' || *p == '-'))
+            negative = *p++ == '-';
+
+        mantissa = 0;
+        exponent = 0;
+
+        size_t digit_count = 0;
+        bool has_digits = false;
+
+        for (; p < end && *p >= '0' && *p <= '9'; ++p)
+        {
+            has_digits = true;
+
+            if (mantissa == 0 && *p == '0')
+                continue;
+
+            if (++digit_count > 19)
+                return false;
+
+            mantissa = mantissa * 10 + static_cast<uint64>(*p - '0');
+        }
+
+        if (p < end && *p == '.')
+        {
+            for (++p; p < end && *p >= '0' && *p <= '9'; ++p)
+            {
+                has_digits = true;
+                --exponent;
+
+                if (mantissa == 0 && *p == '0')
+                    continue;
+
+                if (++digit_count > 19)
+                    return false;
+
+                mantissa = mantissa * 10 + static_cast<uint64>(*p - '0');
+            }
+        }
+
+        if (!has_digits)
+            return false;
+
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            ++p;
+
+            bool negative_exponent = false;
+            if (p < end && (*p == '+' || *p == '-'))
+                negative_exponent = *p++ == '-';
+
+            if (p == end)
+                return false;
+
+            int e = 0;
+
+            for (; p < end; ++p)
+            {
+                if (*p < '0' || *p > '9' || e > 10000)
+                    return false;
+
+                e = e * 10 + (*p - '0');
+            }
+
+            exponent += negative_exponent ? -e : e;
+        }
+
+        return p == end;
+    }
+
+    inline bool parse_double(const std::string& s, double& value)
+    {
+        bool negative;
+        uint64 mantissa;
+        int exponent;
+
+        if (!parse_decimal(s, negative, mantissa, exponent))
+            return false;
+
+        // When both the mantissa and the power of ten are exactly representable,
+        // a single multiplication or division is correctly rounded (Clinger's fast path).
+        if (mantissa > (uint64(1) << 53) || exponent < -22 || exponent > 22)
+            return false;
+
+        static const double PowersOfTen[23] =
+        {
+            1.0e0,  1.0e1,  1.0e2,  1.0e3,  1.0e4,  1.0e5,  1.0e6,  1.0e7,
+            1.0e8,  1.0e9,  1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15,
+            1.0e16, 1.0e17, 1.0e18, 1.0e19, 1.0e20, 1.0e21, 1.0e22
+        };
+
+        double v = static_cast<double>(mantissa);
+
+        if (exponent < 0)
+            v /= PowersOfTen[-exponent];
+        else v *= PowersOfTen[exponent];
+
+        value = negative ? -v : v;
+
+        return true;
+    }
+
+    inline bool parse_float(const std::string& s, float& value)
+    {
+        double d;
+
+        if (!parse_double(s, d))
+            return false;
+
+        // Let the stream-based conversion handle overflows and denormals.
+        if (std::abs(d) > FLT_MAX || (d != 0.0 && std::abs(d) < FLT_MIN))
+            return false;
 
-    return val;
+        // Rounding to double then to float gives the correctly rounded float,
+        // unless the double lies exactly halfway between two floats.
+        const float f = static_cast<float>(d);
+
+        if (static_cast<double>(f) != d)
+        {
+            const float g = std::nextafter(f, d > f ? FLT_MAX : -FLT_MAX);
+
+            if ((static_cast<double>(f) + static_cast<double>(g)) * 0.5 == d)
+                return false;
+        }
+
+        value = f;
+
+        return true;
+    }
+}
+
+template <typename T>
+T from_string(const std::string& s)
+{
+    return impl::from_string_stream<T>(s);
 }
 
 template <>
@@ -500,6 +698,62 @@ inline uint8 from_string(const std::string& s)
     return static_cast<uint8>(val);
 }
 
+template <>
+inline int from_string(const std::string& s)
+{
+    int value;
+    return impl::parse_integer(s, value) ? value : impl::from_string_stream<int>(s);
+}
+
+template <>
+inline unsigned int from_string(const std::string& s)
+{
+    unsigned int value;
+    return impl::parse_integer(s, value) ? value : impl::from_string_stream<unsigned int>(s);
+}
+
+template <>
+inline long from_string(const std::string& s)
+{
+    long value;
+    return impl::parse_integer(s, value) ? value : impl::from_string_stream<long>(s);
+}
+
+template <>
+inline unsigned long from_string(const std::string& s)
+{
+    unsigned long value;
+    return impl::parse_integer(s, value) ? value : impl::from_string_stream<unsigned long>(s);
+}
+
+template <>
+inline long long from_string(const std::string& s)
+{
+    long long value;
+    return impl::parse_integer(s, value) ? value : impl::from_string_stream<long long>(s);
+}
+
+template <>
+inline unsigned long long from_string(const std::string& s)
+{
+    unsigned long long value;
+    return impl::parse_integer(s, value) ? value : impl::from_string_stream<unsigned long long>(s);
+}
+
+template <>
+inline float from_string(const std::string& s)
+{
+    float value;
+    return impl::parse_float(s, value) ? value : impl::from_string_stream<float>(s);
+}
+
+template <>
+inline double from_string(const std::string& s)
+{
+    double value;
+    return impl::parse_double(s, value) ? value : impl::from_string_stream<double>(s);
+}
+
 
 //
 // C strings manipulation functions implementation.
@@ -0,0 +1,466 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_THREADCACHINGPOOLALLOCATOR_H
+#define APPLESEED_FOUNDATION_UTILITY_THREADCACHINGPOOLALLOCATOR_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/core/concepts/singleton.h"
+#include "foundation/platform/types.h"
+
+// Boost headers.
+#include "boost/lockfree/stack.hpp"
+#include "boost/thread/tss.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+namespace foundation
+{
+
+//
+// A standard-conformant, thread-safe, fixed-size object allocator optimized
+// for workloads where many threads allocate and deallocate items concurrently,
+// possibly freeing items allocated by other threads.
+//
+// Each thread owns a small cache made of two magazines (bounded lists of free
+// items). Allocations and deallocations are served from the calling thread's
+// magazines without any synchronization. When both magazines are full, one of
+// them is returned as a whole to a shared, lock-free depot; when both are empty,
+// a full magazine is taken from the depot, or a new one is carved out of a page
+// owned by the calling thread. Magazines held by a thread are returned to the
+// depot when the thread exits.
+//
+// Like PoolAllocator, memory allocated through this allocator is never returned
+// to the system, and thus is never made available for other uses.
+//
+
+namespace impl
+{
+    template <
+        size_t ItemSize,    // in bytes
+        size_t ItemsPerPage,
+        size_t MagazineSize
+    >
+    class MagazineDepot
+      : public Singleton<MagazineDepot<ItemSize, ItemsPerPage, MagazineSize> >
+    {
+      public:
+        // Allocate a memory block.
+        void* allocate()
+        {
+            ThreadCache& cache = get_thread_cache();
+
+            if (cache.m_loaded.m_count == 0)
+            {
+                if (cache.m_previous.m_count > 0)
+                    std::swap(cache.m_loaded, cache.m_previous);
+                else if (!pop_magazine(cache.m_loaded))
+                    cache.fill_from_page(cache.m_loaded);
+            }
+
+            return cache.m_loaded.pop();
+        }
+
+        // Return a memory block to the pool.
+        void deallocate(void* p)
+        {
+            assert(p);
+
+            ThreadCache& cache = get_thread_cache();
+
+            if (cache.m_loaded.m_count == MagazineSize)
+            {
+                if (cache.m_previous.m_count == MagazineSize)
+                    push_magazine(cache.m_previous);
+
+                std::swap(cache.m_loaded, cache.m_previous);
+            }
+
+            cache.m_loaded.push(static_cast<Node*>(p));
+        }
+
+        // Return the magazines of the calling thread to the depot.
+        void flush_thread_cache()
+        {
+            if (ThreadCache* cache = m_thread_cache.get())
+                cache->flush();
+        }
+
+      private:
+        friend class Singleton<MagazineDepot<ItemSize, ItemsPerPage, MagazineSize> >;
+
+        union Node
+        {
+            struct Link
+            {
+                Node*   m_next;         // pointer to the next free node of the magazine
+                size_t  m_count;        // number of nodes in the magazine, only valid in its first node
+            };
+
+            uint8   m_item[ItemSize];   // the actual storage for one item
+            Link    m_link;
+        };
+
+        struct Magazine
+        {
+            Node*   m_head;
+            size_t  m_count;
+
+            Magazine()
+              : m_head(0)
+              , m_count(0)
+            {
+            }
+
+            void push(Node* node)
+            {
+                node->m_link.m_next = m_head;
+                m_head = node;
+                ++m_count;
+            }
+
+            Node* pop()
+            {
+                assert(m_count > 0);
+
+                Node* node = m_head;
+                m_head = node->m_link.m_next;
+                --m_count;
+
+                return node;
+            }
+        };
+
+        struct ThreadCache
+          : public NonCopyable
+        {
+            MagazineDepot&  m_depot;
+            Magazine        m_loaded;
+            Magazine        m_previous;
+            Node*           m_page;
+            size_t          m_page_index;
+
+            explicit ThreadCache(MagazineDepot& depot)
+              : m_depot(depot)
+              , m_page(0)
+              , m_page_index(ItemsPerPage)
+            {
+            }
+
+            ~ThreadCache()
+            {
+                flush();
+            }
+
+            void flush()
+            {
+                m_depot.push_magazine(m_loaded);
+                m_depot.push_magazine(m_previous);
+            }
+
+            // Carve a new magazine out of the page owned by this thread.
+            void fill_from_page(Magazine& magazine)
+            {
+                for (size_t i = 0; i < MagazineSize; ++i)
+                {
+                    // The current page is full, allocate a new page of nodes.
+                    if (m_page_index == ItemsPerPage)
+                    {
+                        m_page = new Node[ItemsPerPage];
+                        m_page_index = 0;
+                    }
+
+                    magazine.push(&m_page[m_page_index++]);
+                }
+            }
+        };
+
+        // The depot must outlive the thread caches, which return their magazines to it.
+        boost::lockfree::stack<Node*>           m_magazines;
+        boost::thread_specific_ptr<ThreadCache> m_thread_cache;
+
+        // Constructor.
+        MagazineDepot()
+          : m_magazines(64)
+        {
+        }
+
+        ThreadCache& get_thread_cache()
+        {
+            ThreadCache* cache = m_thread_cache.get();
+
+            if (cache == 0)
+            {
+                cache = new ThreadCache(*this);
+                m_thread_cache.reset(cache);
+            }
+
+            return *cache;
+        }
+
+        // Move a non-empty magazine to the depot, leaving it empty.
+        void push_magazine(Magazine& magazine)
+        {
+            if (magazine.m_count == 0)
+                return;
+
+            magazine.m_head->m_link.m_count = magazine.m_count;
+            m_magazines.push(magazine.m_head);
+
+            magazine = Magazine();
+        }
+
+        // Take a magazine from the depot, if there is one.
+        bool pop_magazine(Magazine& magazine)
+        {
+            Node* head;
+
+            if (!m_magazines.pop(head))
+                return false;
+
+            magazine.m_head = head;
+            magazine.m_count = head->m_link.m_count;
+
+            return true;
+        }
+    };
+}
+
+template <
+    typename    T,
+    size_t      ItemsPerPage,
+    size_t      MagazineSize = 32,
+    typename    FallBackAllocator = std::allocator<T>
+>
+class ThreadCachingPoolAllocator
+{
+  public:
+    typedef T                   value_type;
+    typedef value_type*         pointer;
+    typedef const value_type*   const_pointer;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef std::ptrdiff_t      difference_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef ThreadCachingPoolAllocator<
+            U,
+            ItemsPerPage,
+            MagazineSize,
+            typename FallBackAllocator::template rebind<U>::other
+        > other;
+    };
+
+    explicit ThreadCachingPoolAllocator(FallBackAllocator allocator = FallBackAllocator())
+      : m_depot(Depot::instance())
+      , m_fallback_alloc(allocator)
+    {
+    }
+
+    template <typename U>
+    ThreadCachingPoolAllocator(const ThreadCachingPoolAllocator<U, ItemsPerPage, MagazineSize, typename FallBackAllocator::template rebind<U>::other>& rhs)
+      : m_depot(Depot::instance())
+      , m_fallback_alloc(rhs.m_fallback_alloc)
+    {
+    }
+
+    ThreadCachingPoolAllocator(const ThreadCachingPoolAllocator& rhs)
+      : m_depot(rhs.m_depot)
+      , m_fallback_alloc(rhs.m_fallback_alloc)
+    {
+    }
+
+    ThreadCachingPoolAllocator& operator=(const ThreadCachingPoolAllocator& rhs)
+    {
+        m_fallback_alloc = rhs.m_fallback_alloc;
+        return *this;
+    }
+
+    pointer address(reference x) const
+    {
+        return &x;
+    }
+
+    const_pointer address(const_reference x) const
+    {
+        return &x;
+    }
+
+    pointer allocate(size_type n, const_pointer hint = 0)
+    {
+        return n == 1
+            ? static_cast<pointer>(m_depot.allocate())
+            : m_fallback_alloc.allocate(n, hint);
+    }
+
+    void deallocate(pointer p, size_type n)
+    {
+        if (p && n == 1)
+            m_depot.deallocate(p);
+        else m_fallback_alloc.deallocate(p, n);
+    }
+
+    size_type max_size() const
+    {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    void construct(pointer p, const_reference x)
+    {
+        new(p) value_type(x);
+    }
+
+    void destroy(pointer p)
+    {
+        p->~value_type();
+    }
+
+    // Return the free items cached by the calling thread to the shared depot.
+    void flush_thread_cache()
+    {
+        m_depot.flush_thread_cache();
+    }
+
+  private:
+    // Allow allocators of different types to access each other private members.
+    template <typename, size_t, size_t, typename>
+    friend class ThreadCachingPoolAllocator;
+
+    typedef impl::MagazineDepot<sizeof(value_type), ItemsPerPage, MagazineSize> Depot;
+
+    Depot&              m_depot;
+    FallBackAllocator   m_fallback_alloc;
+};
+
+// A partial specialization for the void value type is required for rebinding
+// to another, different value type.
+template <
+    size_t      ItemsPerPage,
+    size_t      MagazineSize,
+    typename    FallBackAllocator
+>
+class ThreadCachingPoolAllocator<void, ItemsPerPage, MagazineSize, FallBackAllocator>
+{
+  public:
+    typedef void                value_type;
+    typedef value_type*         pointer;
+    typedef const value_type*   const_pointer;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef ThreadCachingPoolAllocator<
+            U,
+            ItemsPerPage,
+            MagazineSize,
+            typename FallBackAllocator::template rebind<U>::other
+        > other;
+    };
+
+    explicit ThreadCachingPoolAllocator(FallBackAllocator allocator = FallBackAllocator())
+      : m_fallback_alloc(allocator)
+    {
+    }
+
+    template <typename U>
+    ThreadCachingPoolAllocator(const ThreadCachingPoolAllocator<U, ItemsPerPage, MagazineSize, typename FallBackAllocator::template rebind<U>::other>& rhs)
+      : m_fallback_alloc(rhs.m_fallback_alloc)
+    {
+    }
+
+  private:
+    // Allow allocators of different types to access each other private members.
+    template <typename, size_t, size_t, typename>
+    friend class ThreadCachingPoolAllocator;
+
+    FallBackAllocator m_fallback_alloc;
+};
+
+template <
+    typename    T,
+    size_t      ItemsPerPage,
+    size_t      MagazineSize,
+    typename    FallBackAllocator
+>
+inline bool operator==(
+    const ThreadCachingPoolAllocator<T, ItemsPerPage, MagazineSize, FallBackAllocator>&,
+    const ThreadCachingPoolAllocator<T, ItemsPerPage, MagazineSize, FallBackAllocator>&)
+{
+    // Allocators for the same type, with the same number of items per page,
+    // the same magazine size and the same fall back allocators share the same
+    // depot and are considered equal.
+    return true;
+}
+
+template <
+    typename    LhsT,
+    typename    RhsT,
+    size_t      LhsItemsPerPage,
+    size_t      RhsItemsPerPage,
+    size_t      LhsMagazineSize,
+    size_t      RhsMagazineSize,
+    typename    LhsFallBackAllocator,
+    typename    RhsFallBackAllocator
+>
+inline bool operator==(
+    const ThreadCachingPoolAllocator<LhsT, LhsItemsPerPage, LhsMagazineSize, LhsFallBackAllocator>&,
+    const ThreadCachingPoolAllocator<RhsT, RhsItemsPerPage, RhsMagazineSize, RhsFallBackAllocator>&)
+{
+    return false;
+}
+
+template <
+    typename    LhsT,
+    typename    RhsT,
+    size_t      LhsItemsPerPage,
+    size_t      RhsItemsPerPage,
+    size_t      LhsMagazineSize,
+    size_t      RhsMagazineSize,
+    typename    LhsFallBackAllocator,
+    typename    RhsFallBackAllocator
+>
+inline bool operator!=(
+    const ThreadCachingPoolAllocator<LhsT, LhsItemsPerPage, LhsMagazineSize, LhsFallBackAllocator>& lhs,
+    const ThreadCachingPoolAllocator<RhsT, RhsItemsPerPage, RhsMagazineSize, RhsFallBackAllocator>& rhs)
+{
+    return !operator==(lhs, rhs);
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_THREADCACHINGPOOLALLOCATOR_H
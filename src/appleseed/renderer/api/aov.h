@@ -32,5 +32,6 @@
 
 // API headers.
 #include "renderer/kernel/aov/imagestack.h"
+#include "renderer/kernel/aov/objectidbuffer.h"
 
 #endif  // !APPLESEED_RENDERER_API_AOV_H
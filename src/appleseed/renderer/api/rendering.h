@@ -40,12 +40,17 @@
 #include "renderer/kernel/rendering/iframerenderer.h"
 #include "renderer/kernel/rendering/irenderercontroller.h"
 #include "renderer/kernel/rendering/isamplerenderer.h"
+#include "renderer/kernel/rendering/itelemetrycallback.h"
 #include "renderer/kernel/rendering/itilecallback.h"
 #include "renderer/kernel/rendering/itilerenderer.h"
 #include "renderer/kernel/rendering/masterrenderer.h"
 #include "renderer/kernel/rendering/nulltilecallback.h"
+#include "renderer/kernel/rendering/pixelstatistics.h"
 #include "renderer/kernel/rendering/progressive/progressiveframerenderer.h"
+#include "renderer/kernel/rendering/qualityrenderercontroller.h"
 #include "renderer/kernel/rendering/scenepicker.h"
+#include "renderer/kernel/rendering/telemetrymonitor.h"
+#include "renderer/kernel/rendering/tilebatchscheduler.h"
 #include "renderer/kernel/rendering/tilecallbackbase.h"
 #include "renderer/kernel/rendering/timedrenderercontroller.h"
 
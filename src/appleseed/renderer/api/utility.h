@@ -32,7 +32,10 @@
 
 // API headers.
 #include "renderer/utility/bbox.h"
+#include "renderer/utility/framesequence.h"
+#include "renderer/utility/hotpathcounters.h"
 #include "renderer/utility/paramarray.h"
+#include "renderer/utility/renderstatistics.h"
 #ifdef APPLESEED_WITH_DISNEY_MATERIAL
 #include "renderer/utility/seexpr.h"
 #endif
@@ -34,7 +34,9 @@
 #include "renderer/kernel/aov/tilestack.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
 #include "foundation/image/image.h"
+#include "foundation/utility/memoryaccounting.h"
 
 // Standard headers.
 #include <cassert>
@@ -63,6 +65,12 @@ struct ImageStack::Impl
     };
 
     vector<NamedImage>      m_images;
+    MemoryAccount           m_memory_account;
+
+    Impl()
+      : m_memory_account(MemoryTagAOVs)
+    {
+    }
 };
 
 ImageStack::ImageStack(
@@ -93,6 +101,7 @@ void ImageStack::clear()
         delete impl->m_images[i].m_image;
 
     impl->m_images.clear();
+    impl->m_memory_account.set_size(0);
 }
 
 bool ImageStack::empty() const
@@ -161,6 +170,9 @@ size_t ImageStack::append(
             channel_count,
             pixel_format);
 
+    const CanvasProperties& props = named_image.m_image->properties();
+    impl->m_memory_account.grow(props.m_pixel_count * props.m_pixel_size);
+
     const size_t aov_index = impl->m_images.size();
 
     impl->m_images.push_back(named_image);
@@ -0,0 +1,174 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_KERNEL_AOV_OBJECTIDBUFFER_H
+#define APPLESEED_RENDERER_KERNEL_AOV_OBJECTIDBUFFER_H
+
+// appleseed.renderer headers.
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/objectinstance.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/uid.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A per-pixel record of the entities hit by primary rays, which allows to answer
+// picking queries without tracing rays.
+//
+// Entities are recorded by unique ID and index rather than by pointer so that stale
+// records can be detected once the scene has been edited. Samples of a given pixel
+// overwrite each other; the last one wins.
+//
+
+class ObjectIDBuffer
+  : public foundation::NonCopyable
+{
+  public:
+    struct Entry
+    {
+        foundation::UniqueID    m_assembly_instance_uid;        // ~0 if nothing was recorded
+        foundation::uint32      m_object_instance_index;
+        foundation::uint32      m_primitive_attribute_index;    // Triangle::None if none
+        foundation::uint8       m_side;                         // an ObjectInstance::Side value
+
+        bool is_valid() const;
+    };
+
+    // Constructor.
+    ObjectIDBuffer(
+        const size_t                    width,
+        const size_t                    height);
+
+    size_t get_width() const;
+    size_t get_height() const;
+
+    // Forget all records.
+    void clear();
+
+    // Record the entities of a primary hit. Pixels outside the buffer are ignored.
+    void store(
+        const foundation::Vector2i&     pi,
+        const ShadingPoint&             shading_point);
+
+    // Retrieve the record of a pixel, which must be inside the buffer.
+    const Entry& get(
+        const size_t                    x,
+        const size_t                    y) const;
+
+  private:
+    const size_t                        m_width;
+    const size_t                        m_height;
+    std::vector<Entry>                  m_entries;
+};
+
+
+//
+// ObjectIDBuffer class implementation.
+//
+
+inline bool ObjectIDBuffer::Entry::is_valid() const
+{
+    return m_assembly_instance_uid != ~foundation::UniqueID(0);
+}
+
+inline ObjectIDBuffer::ObjectIDBuffer(
+    const size_t                        width,
+    const size_t                        height)
+  : m_width(width)
+  , m_height(height)
+  , m_entries(width * height)
+{
+    clear();
+}
+
+inline size_t ObjectIDBuffer::get_width() const
+{
+    return m_width;
+}
+
+inline size_t ObjectIDBuffer::get_height() const
+{
+    return m_height;
+}
+
+inline void ObjectIDBuffer::clear()
+{
+    Entry empty;
+    empty.m_assembly_instance_uid = ~foundation::UniqueID(0);
+    empty.m_object_instance_index = 0;
+    empty.m_primitive_attribute_index = Triangle::None;
+    empty.m_side = static_cast<foundation::uint8>(ObjectInstance::FrontSide);
+
+    std::fill(m_entries.begin(), m_entries.end(), empty);
+}
+
+inline void ObjectIDBuffer::store(
+    const foundation::Vector2i&         pi,
+    const ShadingPoint&                 shading_point)
+{
+    if (pi.x < 0 || pi.y < 0 ||
+        static_cast<size_t>(pi.x) >= m_width ||
+        static_cast<size_t>(pi.y) >= m_height)
+        return;
+
+    Entry& entry = m_entries[pi.y * m_width + pi.x];
+    entry.m_assembly_instance_uid = shading_point.get_assembly_instance().get_uid();
+    entry.m_object_instance_index = static_cast<foundation::uint32>(shading_point.get_object_instance_index());
+    entry.m_primitive_attribute_index = static_cast<foundation::uint32>(shading_point.get_primitive_attribute_index());
+    entry.m_side = static_cast<foundation::uint8>(shading_point.get_side());
+}
+
+inline const ObjectIDBuffer::Entry& ObjectIDBuffer::get(
+    const size_t                        x,
+    const size_t                        y) const
+{
+    assert(x < m_width);
+    assert(y < m_height);
+
+    return m_entries[y * m_width + x];
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_AOV_OBJECTIDBUFFER_H
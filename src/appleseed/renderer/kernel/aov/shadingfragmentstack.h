@@ -58,6 +58,7 @@ class ShadingFragmentStack
     explicit ShadingFragmentStack(const size_t size);
 
     size_t size() const;
+    void resize(const size_t size);
 
     ShadingFragment& operator[](const size_t index);
     const ShadingFragment& operator[](const size_t index) const;
@@ -117,6 +118,12 @@ inline size_t ShadingFragmentStack::size() const
     return m_size;
 }
 
+inline void ShadingFragmentStack::resize(const size_t size)
+{
+    assert(size <= MaxAOVCount);
+    m_size = size;
+}
+
 inline ShadingFragment& ShadingFragmentStack::operator[](const size_t index)
 {
     assert(index < m_size);
@@ -0,0 +1,228 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "alphamask.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/bitmask.h"
+
+// Standard headers.
+#include <algorithm>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// AlphaMask class implementation.
+//
+
+AlphaMask::AlphaMask(const BitMask2& bitmask)
+  : m_width(bitmask.get_width())
+  , m_height(bitmask.get_height())
+  , m_max_x(static_cast<float>(m_width) - 1.0f)
+  , m_max_y(static_cast<float>(m_height) - 1.0f)
+  , m_tile_count_x((m_width + TileMask) >> TileShift)
+  , m_tile_count_y((m_height + TileMask) >> TileShift)
+{
+    m_tiles.resize(m_tile_count_x * m_tile_count_y);
+    m_levels.push_back(vector<uint8>(m_tiles.size()));
+
+    // Compress the tiles.
+    for (size_t ty = 0; ty < m_tile_count_y; ++ty)
+    {
+        for (size_t tx = 0; tx < m_tile_count_x; ++tx)
+        {
+            const size_t x_end = min((tx + 1) << TileShift, m_width);
+            const size_t y_end = min((ty + 1) << TileShift, m_height);
+
+            // Tiles on the right and bottom edges of the mask may be partially outside of it.
+            uint64 valid_bits = 0;
+            uint64 opaque_bits = 0;
+
+            for (size_t y = ty << TileShift; y < y_end; ++y)
+            {
+                for (size_t x = tx << TileShift; x < x_end; ++x)
+                {
+                    const uint64 bit = uint64(1) << (((y & TileMask) << TileShift) | (x & TileMask));
+
+                    valid_bits |= bit;
+
+                    if (bitmask.is_set(x, y))
+                        opaque_bits |= bit;
+                }
+            }
+
+            const size_t tile_index = ty * m_tile_count_x + tx;
+
+            if (opaque_bits == valid_bits)
+            {
+                m_tiles[tile_index] = OpaqueTile;
+                m_levels[0][tile_index] = CoverageOpaque;
+            }
+            else if (opaque_bits == 0)
+            {
+                m_tiles[tile_index] = TransparentTile;
+                m_levels[0][tile_index] = CoverageTransparent;
+            }
+            else
+            {
+                m_tiles[tile_index] = static_cast<uint32>(m_mixed_tiles.size());
+                m_levels[0][tile_index] = CoverageMixed;
+                m_mixed_tiles.push_back(opaque_bits);
+            }
+        }
+    }
+
+    // Build the coverage pyramid.
+    size_t level_width = m_tile_count_x;
+    size_t level_height = m_tile_count_y;
+
+    while (level_width > 1 || level_height > 1)
+    {
+        const size_t parent_width = (level_width + 1) / 2;
+        const size_t parent_height = (level_height + 1) / 2;
+
+        vector<uint8> parent(parent_width * parent_height, 0);
+        const vector<uint8>& level = m_levels.back();
+
+        for (size_t y = 0; y < level_height; ++y)
+        {
+            for (size_t x = 0; x < level_width; ++x)
+                parent[(y / 2) * parent_width + x / 2] |= level[y * level_width + x];
+        }
+
+        m_levels.push_back(parent);
+
+        level_width = parent_width;
+        level_height = parent_height;
+    }
+}
+
+AlphaMask::Coverage AlphaMask::get_coverage(
+    const Vector2f&         uv_min,
+    const Vector2f&         uv_max) const
+{
+    return
+        get_node_coverage(
+            m_levels.size() - 1,
+            0, 0,
+            get_texel_x(uv_min[0]),
+            get_texel_y(uv_min[1]),
+            get_texel_x(uv_max[0]),
+            get_texel_y(uv_max[1]));
+}
+
+AlphaMask::Coverage AlphaMask::get_node_coverage(
+    const size_t            level,
+    const size_t            node_x,
+    const size_t            node_y,
+    const size_t            x0,
+    const size_t            y0,
+    const size_t            x1,
+    const size_t            y1) const
+{
+    // Width of the level, in nodes.
+    const size_t level_width = ((m_tile_count_x - 1) >> level) + 1;
+
+    const Coverage node_coverage =
+        static_cast<Coverage>(m_levels[level][node_y * level_width + node_x]);
+
+    // Uniform nodes have the same coverage over any of their subregions.
+    if (node_coverage != CoverageMixed)
+        return node_coverage;
+
+    if (level == 0)
+    {
+        // Compute the bits of this tile covered by the rectangle.
+        const size_t bx0 = max(x0, node_x << TileShift) & TileMask;
+        const size_t by0 = max(y0, node_y << TileShift) & TileMask;
+        const size_t bx1 = min(x1, (node_x << TileShift) | TileMask) & TileMask;
+        const size_t by1 = min(y1, (node_y << TileShift) | TileMask) & TileMask;
+
+        const uint64 row_bits = ((uint64(2) << (bx1 - bx0)) - 1) << bx0;
+        uint64 covered_bits = 0;
+        for (size_t by = by0; by <= by1; ++by)
+            covered_bits |= row_bits << (by << TileShift);
+
+        const uint64 opaque_bits = m_mixed_tiles[m_tiles[node_y * m_tile_count_x + node_x]] & covered_bits;
+
+        int coverage = 0;
+        if (opaque_bits != 0)
+            coverage |= CoverageOpaque;
+        if (opaque_bits != covered_bits)
+            coverage |= CoverageTransparent;
+
+        return static_cast<Coverage>(coverage);
+    }
+
+    // Visit the children of this node that overlap the rectangle.
+    const size_t child_level = level - 1;
+    const size_t child_shift = child_level + TileShift;
+    const size_t child_level_width = ((m_tile_count_x - 1) >> child_level) + 1;
+    const size_t child_level_height = ((m_tile_count_y - 1) >> child_level) + 1;
+
+    const size_t cx_begin = max(node_x * 2, x0 >> child_shift);
+    const size_t cy_begin = max(node_y * 2, y0 >> child_shift);
+    const size_t cx_end = min(min(node_x * 2 + 2, child_level_width), (x1 >> child_shift) + 1);
+    const size_t cy_end = min(min(node_y * 2 + 2, child_level_height), (y1 >> child_shift) + 1);
+
+    int coverage = 0;
+
+    for (size_t cy = cy_begin; cy < cy_end; ++cy)
+    {
+        for (size_t cx = cx_begin; cx < cx_end; ++cx)
+        {
+            coverage |= get_node_coverage(child_level, cx, cy, x0, y0, x1, y1);
+
+            if (coverage == CoverageMixed)
+                return CoverageMixed;
+        }
+    }
+
+    return static_cast<Coverage>(coverage);
+}
+
+size_t AlphaMask::get_memory_size() const
+{
+    size_t size =
+          sizeof(*this)
+        + m_tiles.capacity() * sizeof(uint32)
+        + m_mixed_tiles.capacity() * sizeof(uint64);
+
+    for (size_t i = 0; i < m_levels.size(); ++i)
+        size += m_levels[i].capacity() * sizeof(uint8);
+
+    return size;
+}
+
+}   // namespace renderer
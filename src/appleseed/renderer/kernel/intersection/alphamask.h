@@ -0,0 +1,149 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_INTERSECTION_ALPHAMASK_H
+#define APPLESEED_RENDERER_KERNEL_INTERSECTION_ALPHAMASK_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class BitMask2; }
+
+namespace renderer
+{
+
+//
+// An alpha mask stored as a grid of 8x8 texel tiles. Tiles that are entirely
+// opaque or entirely transparent are stored as a single tag; only mixed tiles
+// store their 64 texels, as a 64-bit word. A pyramid of coverage flags over
+// the tiles allows to quickly classify arbitrary rectangles of the mask.
+//
+
+class AlphaMask
+  : public foundation::NonCopyable
+{
+  public:
+    // Coverage flags of a region of an alpha mask. The coverage of a union
+    // of regions is the bitwise OR of the coverage of the regions.
+    enum Coverage
+    {
+        CoverageOpaque          = 1 << 0,
+        CoverageTransparent     = 1 << 1,
+        CoverageMixed           = CoverageOpaque | CoverageTransparent
+    };
+
+    // Set bits of the bit mask are opaque texels.
+    explicit AlphaMask(const foundation::BitMask2& bitmask);
+
+    bool is_opaque(const foundation::Vector2f& uv) const
+    {
+        const size_t ix = get_texel_x(uv[0]);
+        const size_t iy = get_texel_y(uv[1]);
+
+        const foundation::uint32 tile = m_tiles[(iy >> TileShift) * m_tile_count_x + (ix >> TileShift)];
+
+        if (tile == OpaqueTile)
+            return true;
+
+        if (tile == TransparentTile)
+            return false;
+
+        const size_t bit = ((iy & TileMask) << TileShift) | (ix & TileMask);
+        return ((m_mixed_tiles[tile] >> bit) & 1) != 0;
+    }
+
+    bool is_transparent(const foundation::Vector2f& uv) const
+    {
+        return !is_opaque(uv);
+    }
+
+    // Return the coverage of the texels looked up by UV coordinates in [uv_min, uv_max].
+    Coverage get_coverage(
+        const foundation::Vector2f& uv_min,
+        const foundation::Vector2f& uv_max) const;
+
+    size_t get_width() const
+    {
+        return m_width;
+    }
+
+    size_t get_height() const
+    {
+        return m_height;
+    }
+
+    size_t get_memory_size() const;
+
+  private:
+    enum { TileShift = 3, TileSize = 1 << TileShift, TileMask = TileSize - 1 };
+
+    static const foundation::uint32 OpaqueTile = 0xFFFFFFFFUL;
+    static const foundation::uint32 TransparentTile = 0xFFFFFFFEUL;
+
+    const size_t                                    m_width;
+    const size_t                                    m_height;
+    const float                                     m_max_x;
+    const float                                     m_max_y;
+    const size_t                                    m_tile_count_x;
+    const size_t                                    m_tile_count_y;
+    std::vector<foundation::uint32>                 m_tiles;            // tag or index of the tile in m_mixed_tiles
+    std::vector<foundation::uint64>                 m_mixed_tiles;
+    std::vector<std::vector<foundation::uint8> >    m_levels;           // m_levels[0] are the tiles, m_levels.back() is a single node
+
+    size_t get_texel_x(const float u) const
+    {
+        return foundation::truncate<size_t>(foundation::clamp(u * m_width, 0.0f, m_max_x));
+    }
+
+    size_t get_texel_y(const float v) const
+    {
+        return foundation::truncate<size_t>(foundation::clamp(v * m_height, 0.0f, m_max_y));
+    }
+
+    Coverage get_node_coverage(
+        const size_t        level,
+        const size_t        node_x,
+        const size_t        node_y,
+        const size_t        x0,
+        const size_t        y0,
+        const size_t        x1,
+        const size_t        y1) const;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_INTERSECTION_ALPHAMASK_H
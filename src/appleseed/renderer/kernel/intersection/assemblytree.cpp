@@ -36,6 +36,7 @@
 #include "renderer/kernel/intersection/intersectionsettings.h"
 #include "renderer/kernel/intersection/regioninfo.h"
 #include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/entity/entityvector.h"
 #include "renderer/modeling/object/curveobject.h"
 #include "renderer/modeling/object/iregion.h"
@@ -46,11 +47,15 @@
 #include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/utility/bbox.h"
+#include "renderer/utility/renderstatistics.h"
+#include "renderer/utility/startupprofiler.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/beziercurve.h"
+#include "foundation/math/hash.h"
 #include "foundation/math/permutation.h"
 #include "foundation/math/ray.h"
+#include "foundation/math/scalar.h"
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/system.h"
@@ -58,15 +63,21 @@
 #include "foundation/platform/types.h"
 #include "foundation/utility/alignedallocator.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/lazy.h"
+#include "foundation/utility/log.h"
 #include "foundation/utility/siphash.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstring>
+#include <limits>
+#include <map>
 #include <set>
 #include <utility>
 
@@ -80,22 +91,69 @@ namespace renderer
 // AssemblyTree class implementation.
 //
 
-AssemblyTree::AssemblyTree(const Scene& scene)
+struct AssemblyTree::TreeBuilder
+{
+    Logger      m_logger;
+    JobQueue    m_job_queue;
+    JobManager  m_job_manager;
+
+    TreeBuilder()
+      : m_job_manager(m_logger, m_job_queue, System::get_available_cpu_core_count())
+    {
+    }
+};
+
+AssemblyTree::AssemblyTree(
+    const Scene&    scene,
+    const bool      background_tree_construction)
   : TreeType(AlignedAllocator<void>(System::get_l1_data_cache_line_size()))
   , m_scene(scene)
+  , m_background_tree_construction(background_tree_construction)
+  , m_motion_segment_count(0)
+  , m_built_cost(0.0)
+  , m_memory_account(MemoryTagBVH)
 {
     update();
 }
 
 AssemblyTree::~AssemblyTree()
 {
+    // Child trees must not be deleted while they are being built.
+    wait_for_tree_construction();
+    m_tree_builder.reset();
+
     RENDERER_LOG_INFO("deleting assembly tree...");
 }
 
+void AssemblyTree::set_background_tree_construction(const bool enabled)
+{
+    m_background_tree_construction = enabled;
+}
+
 void AssemblyTree::update()
 {
-    rebuild_assembly_tree();
-    update_tree_hierarchy();
+    // Finish building the child trees from the previous update before modifying them.
+    wait_for_tree_construction();
+
+    {
+        StartupPhase phase("assembly tree");
+        if (!AssemblyTreeEnableRefit || !refit_assembly_tree())
+            rebuild_assembly_tree();
+    }
+
+    {
+        StartupPhase phase("child trees");
+        update_tree_hierarchy();
+    }
+
+    // Child trees account for their own memory.
+    m_memory_account.set_size(get_memory_size());
+}
+
+void AssemblyTree::wait_for_tree_construction() const
+{
+    if (m_tree_builder.get())
+        m_tree_builder->m_job_queue.wait_until_completion();
 }
 
 size_t AssemblyTree::get_memory_size() const
@@ -104,14 +162,39 @@ size_t AssemblyTree::get_memory_size() const
           TreeType::get_memory_size()
         - sizeof(*static_cast<const TreeType*>(this))
         + sizeof(*this)
-        + m_items.capacity() * sizeof(AssemblyInstance*)
+        + m_items.capacity() * sizeof(Item)
+        + m_item_ordering.capacity() * sizeof(size_t)
+        + m_node_bboxes.capacity() * sizeof(AABB3d)
         + m_assembly_versions.size() * sizeof(pair<UniqueID, VersionID>);
 }
 
+size_t AssemblyTree::get_triangle_trees_memory_size() const
+{
+    set<const TriangleTree*> trees;
+
+    for (const_each<TriangleTreeContainer> i = m_triangle_trees; i; ++i)
+    {
+        Access<TriangleTree> access(i->second);
+        if (access.get())
+            trees.insert(access.get());
+    }
+
+    size_t size = 0;
+
+    for (const_each<set<const TriangleTree*> > i = trees; i; ++i)
+        size += (*i)->get_memory_size();
+
+    // Released trees kept alive by the repository still use memory.
+    size += m_triangle_tree_repository.get_released_memory_size();
+
+    return size;
+}
+
 void AssemblyTree::collect_assembly_instances(
     const AssemblyInstanceContainer&    assembly_instances,
     const TransformSequence&            parent_transform_seq,
-    AABBVector&                         assembly_instance_bboxes)
+    ItemVector&                         items,
+    AABBVector&                         assembly_instance_bboxes) const
 {
     for (const_each<AssemblyInstanceContainer> i = assembly_instances; i; ++i)
     {
@@ -130,6 +213,7 @@ void AssemblyTree::collect_assembly_instances(
         collect_assembly_instances(
             assembly.assembly_instances(),
             cumulated_transform_seq,
+            items,
             assembly_instance_bboxes);
 
         // Skip empty assemblies.
@@ -137,7 +221,7 @@ void AssemblyTree::collect_assembly_instances(
             continue;
 
         // Create and store an item for this assembly instance.
-        m_items.push_back(
+        items.push_back(
             Item(
                 &assembly,
                 &assembly_instance,
@@ -152,11 +236,73 @@ void AssemblyTree::collect_assembly_instances(
     }
 }
 
+size_t AssemblyTree::collect_assembly_instance_motion_bboxes(
+    const ItemVector&   items,
+    AABBVector&         assembly_instance_motion_bboxes) const
+{
+    const Camera* camera = m_scene.get_active_camera();
+    if (camera == 0 || AssemblyTreeMotionSegmentCount == 0)
+        return 0;
+
+    bool has_moving_items = false;
+    for (const_each<ItemVector> i = items; i; ++i)
+    {
+        if (i->m_transform_sequence.size() > 1)
+        {
+            has_moving_items = true;
+            break;
+        }
+    }
+
+    if (!has_moving_items)
+        return 0;
+
+    const size_t segment_count = AssemblyTreeMotionSegmentCount;
+    const float shutter_open = camera->get_shutter_open_time();
+    const float shutter_close = camera->get_shutter_close_time();
+
+    assembly_instance_motion_bboxes.reserve(items.size() * (segment_count + 1));
+    AABBVector segment_bboxes(segment_count);
+
+    for (const_each<ItemVector> i = items; i; ++i)
+    {
+        const AABB3d local_bbox = i->m_assembly->compute_non_hierarchical_local_bbox();
+
+        // Compute the bounding box of the motion over each segment.
+        for (size_t s = 0; s < segment_count; ++s)
+        {
+            segment_bboxes[s] =
+                i->m_transform_sequence.to_parent(
+                    local_bbox,
+                    lerp(shutter_open, shutter_close, static_cast<float>(s) / segment_count),
+                    lerp(shutter_open, shutter_close, static_cast<float>(s + 1) / segment_count));
+            segment_bboxes[s].robust_grow(1.0e-15);
+        }
+
+        // The bounding box at each pose encloses the motion over the adjacent segments, such that
+        // interpolating the bounding boxes of two consecutive poses bounds the motion in between.
+        assembly_instance_motion_bboxes.push_back(segment_bboxes[0]);
+
+        for (size_t s = 1; s < segment_count; ++s)
+        {
+            AABB3d bbox(segment_bboxes[s - 1]);
+            bbox.insert(segment_bboxes[s]);
+            assembly_instance_motion_bboxes.push_back(bbox);
+        }
+
+        assembly_instance_motion_bboxes.push_back(segment_bboxes[segment_count - 1]);
+    }
+
+    return segment_count;
+}
+
 void AssemblyTree::rebuild_assembly_tree()
 {
     // Clear the current tree.
     clear();
+    m_node_bboxes.clear();
     m_items.clear();
+    m_item_ordering.clear();
 
     Statistics statistics;
 
@@ -166,8 +312,30 @@ void AssemblyTree::rebuild_assembly_tree()
     collect_assembly_instances(
         m_scene.assembly_instances(),
         TransformSequence(),
+        m_items,
         assembly_instance_bboxes);
 
+    // Collect the bounding boxes of moving assembly instances over time.
+    AABBVector assembly_instance_motion_bboxes;
+    m_motion_segment_count =
+        collect_assembly_instance_motion_bboxes(m_items, assembly_instance_motion_bboxes);
+
+    // Partition moving assembly instances according to their bounding boxes at the middle of
+    // the shutter interval rather than over the whole interval, such that instances that cross
+    // paths during the shutter interval don't end up in large overlapping nodes.
+    AABBVector assembly_instance_midtime_bboxes;
+    if (m_motion_segment_count > 0)
+    {
+        const size_t key_count = m_motion_segment_count + 1;
+        assembly_instance_midtime_bboxes.reserve(m_items.size());
+
+        for (size_t i = 0, e = m_items.size(); i < e; ++i)
+        {
+            assembly_instance_midtime_bboxes.push_back(
+                assembly_instance_motion_bboxes[i * key_count + m_motion_segment_count / 2]);
+        }
+    }
+
     RENDERER_LOG_INFO(
         "building assembly tree (%s %s)...",
         pretty_int(m_items.size()).c_str(),
@@ -176,7 +344,7 @@ void AssemblyTree::rebuild_assembly_tree()
     // Create the partitioner.
     typedef bvh::SAHPartitioner<AABBVector> Partitioner;
     Partitioner partitioner(
-        assembly_instance_bboxes,
+        m_motion_segment_count > 0 ? assembly_instance_midtime_bboxes : assembly_instance_bboxes,
         AssemblyTreeMaxLeafSize,
         AssemblyTreeInteriorNodeTraversalCost,
         AssemblyTreeTriangleIntersectionCost);
@@ -193,6 +361,9 @@ void AssemblyTree::rebuild_assembly_tree()
         const vector<size_t>& ordering = partitioner.get_item_ordering();
         assert(m_items.size() == ordering.size());
 
+        // Keep the ordering around to match items when refitting the tree.
+        m_item_ordering = ordering;
+
         // Reorder the items according to the tree ordering.
         ItemVector temp_assembly_instances(ordering.size());
         small_item_reorder(
@@ -201,15 +372,46 @@ void AssemblyTree::rebuild_assembly_tree()
             &ordering[0],
             ordering.size());
 
+        // The nodes of moving assembly instances were built from bounding boxes at the middle of
+        // the shutter interval: store the bounding boxes over the whole interval and over time.
+        if (m_motion_segment_count > 0)
+        {
+            const size_t key_count = m_motion_segment_count + 1;
+            AABBVector item_bboxes(ordering.size());
+            AABBVector item_motion_bboxes(ordering.size() * key_count);
+
+            for (size_t i = 0, e = ordering.size(); i < e; ++i)
+            {
+                item_bboxes[i] = assembly_instance_bboxes[ordering[i]];
+
+                for (size_t k = 0; k < key_count; ++k)
+                    item_motion_bboxes[i * key_count + k] = assembly_instance_motion_bboxes[ordering[i] * key_count + k];
+            }
+
+            fit_motion_bboxes(item_bboxes, item_motion_bboxes);
+            statistics.insert("motion segments", pretty_uint(m_motion_segment_count));
+        }
+
         // Store the items in the tree leaves whenever possible.
         store_items_in_leaves(statistics);
+
+        // Collapse the tree into wide nodes. Wide nodes have no motion bounding boxes.
+        if (AssemblyTreeUseWideNodes && m_motion_segment_count == 0)
+        {
+            collapse();
+            statistics.insert("wide nodes", pretty_uint(get_wide_node_count()));
+        }
+
+        m_built_cost = compute_cost();
     }
 
     // Print assembly tree statistics.
-    RENDERER_LOG_DEBUG("%s",
+    const StatisticsVector stats_vector =
         StatisticsVector::make(
             "assembly tree statistics",
-            statistics).to_string().c_str());
+            statistics);
+    RENDERER_LOG_DEBUG("%s", stats_vector.to_string().c_str());
+    global_render_statistics().record(stats_vector);
 }
 
 void AssemblyTree::store_items_in_leaves(Statistics& statistics)
@@ -245,12 +447,318 @@ void AssemblyTree::store_items_in_leaves(Statistics& statistics)
     statistics.insert_percent("fat leaves", fat_leaf_count, leaf_count);
 }
 
+bool AssemblyTree::refit_assembly_tree()
+{
+    if (m_items.empty())
+        return false;
+
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    // Collect assembly instances and their bounding boxes.
+    ItemVector items;
+    AABBVector assembly_instance_bboxes;
+    collect_assembly_instances(
+        m_scene.assembly_instances(),
+        TransformSequence(),
+        items,
+        assembly_instance_bboxes);
+
+    // The topology of the tree can only be kept if the same assembly instances are found in the same order.
+    if (items.size() != m_items.size())
+        return false;
+
+    // It can't be kept either if instances started or stopped moving.
+    AABBVector assembly_instance_motion_bboxes;
+    if (collect_assembly_instance_motion_bboxes(items, assembly_instance_motion_bboxes) != m_motion_segment_count)
+        return false;
+
+    for (size_t i = 0, e = m_items.size(); i < e; ++i)
+    {
+        const Item& item = items[m_item_ordering[i]];
+        if (item.m_assembly_instance != m_items[i].m_assembly_instance ||
+            item.m_assembly_uid != m_items[i].m_assembly_uid)
+            return false;
+    }
+
+    RENDERER_LOG_INFO(
+        "refitting assembly tree (%s %s)...",
+        pretty_int(m_items.size()).c_str(),
+        plural(m_items.size(), "assembly instance").c_str());
+
+    // Store the items and their bounding boxes in tree order.
+    const size_t key_count = m_motion_segment_count > 0 ? m_motion_segment_count + 1 : 0;
+    AABBVector item_bboxes(m_items.size());
+    AABBVector item_motion_bboxes(m_items.size() * key_count);
+    for (size_t i = 0, e = m_items.size(); i < e; ++i)
+    {
+        m_items[i] = items[m_item_ordering[i]];
+        item_bboxes[i] = assembly_instance_bboxes[m_item_ordering[i]];
+
+        for (size_t k = 0; k < key_count; ++k)
+            item_motion_bboxes[i * key_count + k] = assembly_instance_motion_bboxes[m_item_ordering[i] * key_count + k];
+    }
+
+    // Update the bounding boxes of the nodes.
+    if (m_motion_segment_count > 0)
+        fit_motion_bboxes(item_bboxes, item_motion_bboxes);
+    else refit_recurse(0, item_bboxes);
+
+    // Fall back to a full rebuild if the quality of the tree degraded too much.
+    const double cost = compute_cost();
+    if (cost > AssemblyTreeRefitMaxCostRatio * m_built_cost)
+    {
+        RENDERER_LOG_INFO("refitted assembly tree is of insufficient quality, rebuilding it...");
+        return false;
+    }
+
+    Statistics statistics;
+    store_items_in_leaves(statistics);
+
+    if (AssemblyTreeUseWideNodes && m_motion_segment_count == 0)
+    {
+        collapse();
+        statistics.insert("wide nodes", pretty_uint(get_wide_node_count()));
+    }
+
+    statistics.insert("cost ratio", cost / m_built_cost);
+    statistics.insert_time("refit time", stopwatch.measure().get_seconds());
+    const StatisticsVector stats_vector =
+        StatisticsVector::make(
+            "assembly tree statistics",
+            statistics);
+    RENDERER_LOG_DEBUG("%s", stats_vector.to_string().c_str());
+    global_render_statistics().record(stats_vector);
+
+    return true;
+}
+
+AABB3d AssemblyTree::refit_recurse(
+    const size_t        node_index,
+    const AABBVector&   item_bboxes)
+{
+    NodeType& node = m_nodes[node_index];
+
+    if (node.is_leaf())
+    {
+        AABB3d bbox;
+        bbox.invalidate();
+
+        for (size_t i = node.get_item_index(), e = i + node.get_item_count(); i < e; ++i)
+            bbox.insert(item_bboxes[i]);
+
+        return bbox;
+    }
+
+    const size_t child_node_index = node.get_child_node_index();
+    const AABB3d left_bbox = refit_recurse(child_node_index, item_bboxes);
+    const AABB3d right_bbox = refit_recurse(child_node_index + 1, item_bboxes);
+
+    node.set_left_bbox(left_bbox);
+    node.set_right_bbox(right_bbox);
+
+    AABB3d bbox(left_bbox);
+    bbox.insert(right_bbox);
+    return bbox;
+}
+
+void AssemblyTree::fit_motion_bboxes(
+    const AABBVector&   item_bboxes,
+    const AABBVector&   item_motion_bboxes)
+{
+    // Bounding boxes over the whole shutter interval, for traversal without motion.
+    refit_recurse(0, item_bboxes);
+
+    // Bounding boxes over time, for traversal with motion.
+    m_node_bboxes.clear();
+    compute_motion_bboxes(0, item_motion_bboxes);
+}
+
+AssemblyTree::AABBVector AssemblyTree::compute_motion_bboxes(
+    const size_t        node_index,
+    const AABBVector&   item_motion_bboxes)
+{
+    NodeType& node = m_nodes[node_index];
+
+    const size_t key_count = m_motion_segment_count + 1;
+    AABBVector bboxes(key_count);
+
+    if (node.is_leaf())
+    {
+        for (size_t k = 0; k < key_count; ++k)
+            bboxes[k].invalidate();
+
+        for (size_t i = node.get_item_index(), e = i + node.get_item_count(); i < e; ++i)
+        {
+            for (size_t k = 0; k < key_count; ++k)
+                bboxes[k].insert(item_motion_bboxes[i * key_count + k]);
+        }
+
+        return bboxes;
+    }
+
+    const size_t child_node_index = node.get_child_node_index();
+    const AABBVector left_bboxes = compute_motion_bboxes(child_node_index, item_motion_bboxes);
+    const AABBVector right_bboxes = compute_motion_bboxes(child_node_index + 1, item_motion_bboxes);
+
+    node.set_left_bbox_index(m_node_bboxes.size());
+    node.set_left_bbox_count(key_count);
+    m_node_bboxes.insert(m_node_bboxes.end(), left_bboxes.begin(), left_bboxes.end());
+
+    node.set_right_bbox_index(m_node_bboxes.size());
+    node.set_right_bbox_count(key_count);
+    m_node_bboxes.insert(m_node_bboxes.end(), right_bboxes.begin(), right_bboxes.end());
+
+    for (size_t k = 0; k < key_count; ++k)
+    {
+        bboxes[k] = left_bboxes[k];
+        bboxes[k].insert(right_bboxes[k]);
+    }
+
+    return bboxes;
+}
+
+double AssemblyTree::compute_cost() const
+{
+    if (m_nodes.empty() || m_nodes[0].is_leaf())
+        return 1.0;
+
+    AABB3d root_bbox(m_nodes[0].get_left_bbox());
+    root_bbox.insert(m_nodes[0].get_right_bbox());
+    const double root_area = foundation::half_surface_area(root_bbox);
+
+    // Sum the surface areas of all the child bounding boxes of interior nodes.
+    double cost = 0.0;
+    for (size_t i = 0, e = m_nodes.size(); i < e; ++i)
+    {
+        const NodeType& node = m_nodes[i];
+        if (node.is_interior())
+            cost += foundation::half_surface_area(node.get_left_bbox()) + foundation::half_surface_area(node.get_right_bbox());
+    }
+
+    return root_area > 0.0 ? cost / root_area : 1.0;
+}
+
+namespace
+{
+    // Width, in octaves of projected size, of the band over which assemblies switch between
+    // two levels of detail. Each assembly switches at a different size within the band such
+    // that a crowd of instances of an asset changes its level of detail gradually.
+    const float LODTransitionWidth = 0.5f;
+
+    bool has_lod_object_instances(const Assembly& assembly)
+    {
+        for (const_each<ObjectInstanceContainer> i = assembly.object_instances(); i; ++i)
+        {
+            if (i->has_lod_range())
+                return true;
+        }
+
+        return false;
+    }
+
+    // Hash the set of levels of detail of an assembly that are rendered at a given projected size.
+    uint64 hash_lod_selection(const Assembly& assembly, const float projected_size)
+    {
+        const ObjectInstanceContainer& object_instances = assembly.object_instances();
+        const size_t object_instance_count = object_instances.size();
+
+        uint64 hash = 0;
+
+        for (size_t i = 0; i < object_instance_count; ++i)
+        {
+            const ObjectInstance* object_instance = object_instances.get_by_index(i);
+
+            if (object_instance->has_lod_range() && object_instance->is_lod_selected(projected_size))
+            {
+                uint64 values[2];
+                values[0] = hash;
+                values[1] = i;
+                hash = siphash24(&values, sizeof(values));
+            }
+        }
+
+        return hash;
+    }
+}
+
+void AssemblyTree::compute_projected_sizes()
+{
+    m_projected_sizes.clear();
+
+    // Without a camera, all assemblies are rendered at their finest level of detail.
+    const Camera* camera = m_scene.get_active_camera();
+    if (camera == 0)
+        return;
+
+    const Vector3d camera_position =
+        camera->transform_sequence().get_earliest_transform().point_to_parent(Vector3d(0.0));
+
+    // Compute the local bounding boxes of the assemblies with levels of detail.
+    typedef map<const Assembly*, AABB3d> AssemblyBBoxMap;
+    AssemblyBBoxMap local_bboxes;
+    for (const_each<ItemVector> i = m_items; i; ++i)
+    {
+        const Assembly* assembly = i->m_assembly;
+        if (local_bboxes.find(assembly) == local_bboxes.end() && has_lod_object_instances(*assembly))
+            local_bboxes[assembly] = assembly->compute_non_hierarchical_local_bbox();
+    }
+
+    if (local_bboxes.empty())
+        return;
+
+    // The projected size of an assembly is the one of its closest instance.
+    for (const_each<ItemVector> i = m_items; i; ++i)
+    {
+        const AssemblyBBoxMap::const_iterator bbox_it = local_bboxes.find(i->m_assembly);
+        if (bbox_it == local_bboxes.end())
+            continue;
+
+        const AABB3d bbox =
+            i->m_transform_sequence.get_earliest_transform().to_parent(bbox_it->second);
+
+        const float projected_size =
+            bbox.contains(camera_position)
+                ? numeric_limits<float>::max()
+                : static_cast<float>(norm(bbox.extent()) / norm(bbox.center() - camera_position));
+
+        const AssemblyProjectedSizeMap::iterator size_it = m_projected_sizes.find(i->m_assembly_uid);
+        if (size_it == m_projected_sizes.end())
+            m_projected_sizes[i->m_assembly_uid] = projected_size;
+        else size_it->second = max(size_it->second, projected_size);
+    }
+
+    // Jitter the projected size of each assembly to spread level of detail transitions.
+    for (each<AssemblyProjectedSizeMap> i = m_projected_sizes; i; ++i)
+    {
+        if (i->second == numeric_limits<float>::max())
+            continue;
+
+        const float jitter = hash_uint32(static_cast<uint32>(i->first)) * (1.0f / 4294967296.0f);
+        i->second *= pow(2.0f, (jitter - 0.5f) * LODTransitionWidth);
+    }
+
+    RENDERER_LOG_DEBUG(
+        "selected levels of detail of %s %s.",
+        pretty_uint(m_projected_sizes.size()).c_str(),
+        plural(m_projected_sizes.size(), "assembly", "assemblies").c_str());
+}
+
+float AssemblyTree::get_projected_size(const Assembly& assembly) const
+{
+    const AssemblyProjectedSizeMap::const_iterator i = m_projected_sizes.find(assembly.get_uid());
+    return i != m_projected_sizes.end() ? i->second : numeric_limits<float>::max();
+}
+
 void AssemblyTree::update_tree_hierarchy()
 {
     // Collect all assemblies in the scene.
     AssemblyVector assemblies;
     collect_unique_assemblies(assemblies);
 
+    // Measure the assemblies with levels of detail as seen from the camera.
+    compute_projected_sizes();
+
     // Delete child trees of assemblies that no longer exist.
     delete_unused_child_trees(assemblies);
 
@@ -263,13 +771,17 @@ void AssemblyTree::update_tree_hierarchy()
         // Retrieve the current version ID of the assembly.
         const VersionID current_version_id = assembly.get_version_id();
 
+        // Retrieve the levels of detail currently selected for the assembly.
+        const uint64 current_lods = hash_lod_selection(assembly, get_projected_size(assembly));
+
         // Retrieve the stored version ID of the assembly.
         const AssemblyVersionMap::const_iterator stored_version_it =
             m_assembly_versions.find(assembly.get_uid());
 
         if (stored_version_it != m_assembly_versions.end())
         {
-            if (stored_version_it->second == current_version_id)
+            if (stored_version_it->second == current_version_id &&
+                m_assembly_lods[assembly.get_uid()] == current_lods)
             {
                 // The child trees of this assembly are up-to-date.
                 continue;
@@ -282,13 +794,24 @@ void AssemblyTree::update_tree_hierarchy()
         // Lazily build new child trees.
         create_child_trees(assembly);
 
-        // Store the current version ID of the assembly.
+        // Store the current version ID and levels of detail of the assembly.
         m_assembly_versions[assembly.get_uid()] = current_version_id;
+        m_assembly_lods[assembly.get_uid()] = current_lods;
     }
 
     // Update child trees.
     update_region_trees();
     update_triangle_trees();
+
+    const size_t released_tree_count = m_triangle_tree_repository.get_released_count();
+    if (released_tree_count > 0)
+    {
+        RENDERER_LOG_DEBUG(
+            "keeping %s released %s alive (%s).",
+            pretty_uint(released_tree_count).c_str(),
+            plural(released_tree_count, "triangle tree").c_str(),
+            pretty_size(m_triangle_tree_repository.get_released_memory_size()).c_str());
+    }
 }
 
 void AssemblyTree::collect_unique_assemblies(AssemblyVector& assemblies) const
@@ -322,6 +845,7 @@ void AssemblyTree::delete_unused_child_trees(const AssemblyVector& assemblies)
         if (assembly_uids.find(i->first) == assembly_uids.end())
         {
             delete_child_trees(i->first);
+            m_assembly_lods.erase(i->first);
             m_assembly_versions.erase(i++);
         }
         else ++i;
@@ -351,10 +875,13 @@ namespace
 
             if (strcmp(object.get_model(), model) == 0)
             {
-                uint64 values[2 + 16];
+                // Include the object's version so that released trees kept alive by
+                // the tree repository are not reused after the geometry was modified.
+                uint64 values[3 + 16];
                 values[0] = hash;
                 values[1] = object.get_uid();
-                memcpy(&values[2], &i->get_transform().get_local_to_parent()[0], 16 * 8);
+                values[2] = object.get_version_id();
+                memcpy(&values[3], &i->get_transform().get_local_to_parent()[0], 16 * 8);
                 hash = siphash24(&values, sizeof(values));
             }
         }
@@ -362,19 +889,24 @@ namespace
         return hash;
     }
 
-    void collect_regions(const Assembly& assembly, RegionInfoVector& regions)
+    void collect_regions(
+        const Assembly&         assembly,
+        const float             projected_size,
+        RegionInfoVector&       regions)
     {
         assert(regions.empty());
 
         const ObjectInstanceContainer& object_instances = assembly.object_instances();
         const size_t object_instance_count = object_instances.size();
 
-        // Collect all regions of all object instances of this assembly.
+        // Collect all regions of the object instances of this assembly rendered at this projected size.
         for (size_t obj_inst_index = 0; obj_inst_index < object_instance_count; ++obj_inst_index)
         {
             // Retrieve the object instance and its transformation.
             const ObjectInstance* object_instance = object_instances.get_by_index(obj_inst_index);
             assert(object_instance);
+            if (!object_instance->is_lod_selected(projected_size))
+                continue;
             const Transformd& transform = object_instance->get_transform();
 
             // Retrieve the object.
@@ -441,7 +973,13 @@ void AssemblyTree::create_region_tree(const Assembly& assembly)
 
 void AssemblyTree::create_triangle_tree(const Assembly& assembly)
 {
-    const uint64 hash = hash_assembly_geometry(assembly, MeshObjectFactory::get_model());
+    // Only the selected levels of detail are inserted into the tree. Trees of the other
+    // levels of detail may be kept alive by the repository and reused when switching back.
+    const float projected_size = get_projected_size(assembly);
+    uint64 hashes[2];
+    hashes[0] = hash_assembly_geometry(assembly, MeshObjectFactory::get_model());
+    hashes[1] = hash_lod_selection(assembly, projected_size);
+    const uint64 hash = siphash24(&hashes, sizeof(hashes));
     Lazy<TriangleTree>* tree = m_triangle_tree_repository.acquire(hash);
 
     if (tree == 0)
@@ -453,7 +991,7 @@ void AssemblyTree::create_triangle_tree(const Assembly& assembly)
                 assembly.object_instances().end());
 
         RegionInfoVector regions;
-        collect_regions(assembly, regions);
+        collect_regions(assembly, projected_size, regions);
 
         auto_ptr<ILazyFactory<TriangleTree> > triangle_tree_factory(
             new TriangleTreeFactory(
@@ -538,6 +1076,64 @@ void AssemblyTree::delete_curve_tree(const UniqueID assembly_id)
 
 namespace
 {
+    template <typename TreeType>
+    class BuildTreeJob
+      : public IJob
+    {
+      public:
+        explicit BuildTreeJob(Lazy<TreeType>& tree)
+          : m_tree(tree)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            // Accessing the tree forces its construction.
+            Access<TreeType> access(&m_tree);
+        }
+
+      private:
+        Lazy<TreeType>& m_tree;
+    };
+
+    template <typename TreeType>
+    struct ScheduleTreeBuilds
+    {
+        JobQueue& m_job_queue;
+
+        explicit ScheduleTreeBuilds(JobQueue& job_queue)
+          : m_job_queue(job_queue)
+        {
+        }
+
+        void operator()(Lazy<TreeType>& tree, const size_t ref_count)
+        {
+            m_job_queue.schedule(new BuildTreeJob<TreeType>(tree));
+        }
+    };
+
+    // Build all the trees of a repository concurrently.
+    template <typename TreeType>
+    void build_trees(TreeRepository<TreeType>& repository)
+    {
+        JobQueue job_queue;
+        ScheduleTreeBuilds<TreeType> schedule_tree_builds(job_queue);
+        repository.for_each(schedule_tree_builds);
+
+        if (job_queue.get_scheduled_job_count() < 2)
+            return;
+
+        Logger logger;
+        JobManager job_manager(
+            logger,
+            job_queue,
+            System::get_available_cpu_core_count(),
+            JobManager::KeepRunningOnEmptyQueue);
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+    }
+
     template <typename TreeType>
     struct UpdateTrees
     {
@@ -556,64 +1152,183 @@ namespace
 
 void AssemblyTree::update_region_trees()
 {
+    build_trees(m_region_tree_repository);
+
     UpdateTrees<RegionTree> update_trees;
     m_region_tree_repository.for_each(update_trees);
 }
 
 void AssemblyTree::update_triangle_trees()
 {
+    if (m_background_tree_construction)
+    {
+        build_triangle_trees_in_background();
+        return;
+    }
+
+    build_trees(m_triangle_tree_repository);
+
     UpdateTrees<TriangleTree> update_trees;
     m_triangle_tree_repository.for_each(update_trees);
 }
 
-
-//
-// Utility function to transform a ray to the space of an assembly instance.
-//
-
 namespace
 {
-    void compute_assembly_instance_ray(
-        const AssemblyInstance&     assembly_instance,
-        const Transformd&           assembly_instance_transform,
-        const ShadingPoint*         parent_sp,
-        const ShadingRay&           input_ray,
-        ShadingRay&                 output_ray)
+    double square_distance(const Vector3d& point, const AABB3d& bbox)
     {
-        // Transform the ray direction to assembly instance space.
-        output_ray.m_dir = assembly_instance_transform.vector_to_local(input_ray.m_dir);
+        double d = 0.0;
 
-        // Compute the ray origin in assembly instance space.
-        if (parent_sp &&
-            parent_sp->get_assembly_instance().get_uid() == assembly_instance.get_uid() &&
-            parent_sp->get_object_instance().get_ray_bias_method() == ObjectInstance::RayBiasMethodNone)
+        for (size_t i = 0; i < 3; ++i)
         {
-            // The caller provided the previous intersection, and we are about
-            // to intersect the assembly instance that contains the previous
-            // intersection. Use the properly offset intersection point as the
-            // origin of the child ray.
-            output_ray.m_org = parent_sp->get_offset_point(output_ray.m_dir);
+            if (point[i] < bbox.min[i])
+                d += square(bbox.min[i] - point[i]);
+            else if (point[i] > bbox.max[i])
+                d += square(point[i] - bbox.max[i]);
         }
-        else
+
+        return d;
+    }
+
+    typedef map<Lazy<TriangleTree>*, double> TreeDistanceMap;
+    typedef vector<pair<double, Lazy<TriangleTree>*> > TreeBuildVector;
+
+    struct CollectTriangleTreesToBuild
+    {
+        const TreeDistanceMap&  m_distances;
+        TreeBuildVector&        m_trees;
+
+        CollectTriangleTreesToBuild(
+            const TreeDistanceMap&  distances,
+            TreeBuildVector&        trees)
+          : m_distances(distances)
+          , m_trees(trees)
         {
-            // The caller didn't provide the previous intersection, or we are
-            // about to intersect an assembly instance that does not contain
-            // the previous intersection: simply transform the ray origin to
-            // assembly instance space.
-            output_ray.m_org = assembly_instance_transform.point_to_local(input_ray.m_org);
         }
 
-        // todo: transform ray differentials.
-        output_ray.m_has_differentials = false;
+        void operator()(Lazy<TriangleTree>& tree, const size_t ref_count)
+        {
+            const bool enable_intersection_filters = ref_count == 1;
+
+            // Update trees that were already built.
+            Update<TriangleTree> update(&tree);
+            if (update.get())
+            {
+                update->update_non_geometry(enable_intersection_filters);
+                return;
+            }
+
+            // Trees that remain to be built will be updated as part of their construction,
+            // whether they are built in the background or on demand during rendering.
+            TriangleTreeFactory* factory = static_cast<TriangleTreeFactory*>(tree.get_factory());
+            assert(factory);
+            factory->enable_non_geometry_update(enable_intersection_filters);
+
+            const TreeDistanceMap::const_iterator i = m_distances.find(&tree);
+            m_trees.push_back(
+                make_pair(
+                    i != m_distances.end() ? i->second : numeric_limits<double>::max(),
+                    &tree));
+        }
+    };
+}
+
+void AssemblyTree::build_triangle_trees_in_background()
+{
+    // Find the camera position.
+    const Camera* camera = m_scene.get_active_camera();
+    const Vector3d camera_position =
+        camera
+            ? camera->transform_sequence().get_earliest_transform().get_parent_origin()
+            : Vector3d(0.0);
+
+    // Compute the distance from the camera to the nearest instance of each triangle tree.
+    TreeDistanceMap distances;
+    for (const_each<ItemVector> i = m_items; i; ++i)
+    {
+        const TriangleTreeContainer::const_iterator tree_it = m_triangle_trees.find(i->m_assembly_uid);
+        if (tree_it == m_triangle_trees.end())
+            continue;
+
+        const AABB3d bbox(
+            i->m_transform_sequence.to_parent(
+                i->m_assembly->compute_non_hierarchical_local_bbox()));
+        const double d = square_distance(camera_position, bbox);
+
+        const pair<TreeDistanceMap::iterator, bool> result =
+            distances.insert(make_pair(tree_it->second, d));
+        if (!result.second)
+            result.first->second = min(result.first->second, d);
+    }
+
+    // Collect the trees that remain to be built.
+    TreeBuildVector trees;
+    CollectTriangleTreesToBuild collect_trees(distances, trees);
+    m_triangle_tree_repository.for_each(collect_trees);
+
+    if (trees.empty())
+        return;
 
-        // Copy the remaining members.
-        output_ray.m_tmin = input_ray.m_tmin;
-        output_ray.m_tmax = input_ray.m_tmax;
-        output_ray.m_time = input_ray.m_time;
-        output_ray.m_flags = input_ray.m_flags;
-        output_ray.m_depth = input_ray.m_depth;
-        output_ray.m_medium_count = input_ray.m_medium_count;
+    // Build the trees nearest to the camera first.
+    stable_sort(trees.begin(), trees.end());
+
+    RENDERER_LOG_INFO(
+        "building %s %s in the background...",
+        pretty_uint(trees.size()).c_str(),
+        plural(trees.size(), "triangle tree").c_str());
+
+    m_tree_builder.reset(new TreeBuilder());
+
+    for (const_each<TreeBuildVector> i = trees; i; ++i)
+        m_tree_builder->m_job_queue.schedule(new BuildTreeJob<TriangleTree>(*i->second));
+
+    m_tree_builder->m_job_manager.start();
+}
+
+
+//
+// Utility function to transform a ray to the space of an assembly instance.
+//
+
+void compute_assembly_instance_ray(
+    const AssemblyInstance&     assembly_instance,
+    const Transformd&           assembly_instance_transform,
+    const ShadingPoint*         parent_sp,
+    const ShadingRay&           input_ray,
+    ShadingRay&                 output_ray)
+{
+    // Transform the ray direction to assembly instance space.
+    output_ray.m_dir = assembly_instance_transform.vector_to_local(input_ray.m_dir);
+
+    // Compute the ray origin in assembly instance space.
+    if (parent_sp &&
+        parent_sp->get_assembly_instance().get_uid() == assembly_instance.get_uid() &&
+        parent_sp->get_object_instance().get_ray_bias_method() == ObjectInstance::RayBiasMethodNone)
+    {
+        // The caller provided the previous intersection, and we are about
+        // to intersect the assembly instance that contains the previous
+        // intersection. Use the properly offset intersection point as the
+        // origin of the child ray.
+        output_ray.m_org = parent_sp->get_offset_point(output_ray.m_dir);
     }
+    else
+    {
+        // The caller didn't provide the previous intersection, or we are
+        // about to intersect an assembly instance that does not contain
+        // the previous intersection: simply transform the ray origin to
+        // assembly instance space.
+        output_ray.m_org = assembly_instance_transform.point_to_local(input_ray.m_org);
+    }
+
+    // todo: transform ray differentials.
+    output_ray.m_has_differentials = false;
+
+    // Copy the remaining members.
+    output_ray.m_tmin = input_ray.m_tmin;
+    output_ray.m_tmax = input_ray.m_tmax;
+    output_ray.m_time = input_ray.m_time;
+    output_ray.m_flags = input_ray.m_flags;
+    output_ray.m_depth = input_ray.m_depth;
+    output_ray.m_medium_count = input_ray.m_medium_count;
 }
 
 
@@ -714,6 +1429,19 @@ bool AssemblyLeafVisitor::visit(
                         visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
                         , m_triangle_tree_stats
+#endif
+                        );
+                }
+                else if (triangle_tree->has_wide_nodes())
+                {
+                    TriangleTreeWideIntersector wide_intersector;
+                    wide_intersector.intersect_no_motion(
+                        *triangle_tree,
+                        local_shading_point.m_ray,
+                        local_ray_info,
+                        visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                        , m_triangle_tree_stats
 #endif
                         );
                 }
@@ -881,6 +1609,19 @@ bool AssemblyLeafProbeVisitor::visit(
                         visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
                         , m_triangle_tree_stats
+#endif
+                        );
+                }
+                else if (triangle_tree->has_wide_nodes())
+                {
+                    TriangleTreeWideProbeIntersector wide_intersector;
+                    wide_intersector.intersect_no_motion(
+                        *triangle_tree,
+                        local_ray,
+                        local_ray_info,
+                        visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                        , m_triangle_tree_stats
 #endif
                         );
                 }
@@ -900,6 +1641,18 @@ bool AssemblyLeafProbeVisitor::visit(
                 // Terminate traversal if there was a hit.
                 if (visitor.hit())
                 {
+                    // Cache the occluder for the next probe rays.
+                    if (m_occluder_cache &&
+                        visitor.has_static_occluder() &&
+                        item.m_transform_sequence.size() <= 1)
+                    {
+                        m_occluder_cache->set(
+                            visitor.get_occluder(),
+                            visitor.get_occluder_vis_flags() & assembly_instance.get_vis_flags(),
+                            assembly_instance,
+                            assembly_instance_transform);
+                    }
+
                     m_hit = true;
                     return false;
                 }
@@ -32,6 +32,8 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/intersection/curvetree.h"
+#include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/intersection/occludercache.h"
 #include "renderer/kernel/intersection/probevisitorbase.h"
 #include "renderer/kernel/intersection/regiontree.h"
 #include "renderer/kernel/intersection/treerepository.h"
@@ -45,13 +47,16 @@
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/aabb.h"
 #include "foundation/math/bvh.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/alignedvector.h"
+#include "foundation/utility/memoryaccounting.h"
 #include "foundation/utility/uid.h"
 #include "foundation/utility/version.h"
 
 // Standard headers.
 #include <cstddef>
 #include <map>
+#include <memory>
 #include <vector>
 
 // Forward declarations.
@@ -68,25 +73,47 @@ namespace renderer
 //
 
 class AssemblyTree
-  : public foundation::bvh::Tree<
+  : public foundation::bvh::WideTree<
                foundation::AlignedVector<
                    foundation::bvh::Node<foundation::AABB3d>
+               >,
+               foundation::AlignedVector<
+                   foundation::bvh::WideNode<foundation::AABB3d, TriangleTreeWideNodeWidth>
                >
            >
 {
   public:
     // Constructor, builds the tree for a given scene.
-    explicit AssemblyTree(const Scene& scene);
+    // If background tree construction is enabled, triangle trees are built by background
+    // threads, nearest to the camera first, and update() returns without waiting for them.
+    // Triangle trees that are needed before being built are built on demand.
+    AssemblyTree(
+        const Scene&                            scene,
+        const bool                              background_tree_construction = false);
 
     // Destructor.
     ~AssemblyTree();
 
+    // Enable or disable background construction of triangle trees in subsequent updates.
+    void set_background_tree_construction(const bool enabled);
+
     // Update the assembly tree and all the child trees.
     void update();
 
+    // Wait until all triangle trees being built in the background are built.
+    void wait_for_tree_construction() const;
+
+    // Return true if the tree has motion bounding boxes, in which case rays should be
+    // intersected with it using intersect_motion() to benefit from them. All traversal
+    // methods remain correct either way.
+    bool has_motion() const;
+
     // Return the size (in bytes) of this object in memory.
     size_t get_memory_size() const;
 
+    // Return the size (in bytes) in memory of all the triangle trees referenced by this tree.
+    size_t get_triangle_trees_memory_size() const;
+
   private:
     friend class AssemblyLeafVisitor;
     friend class AssemblyLeafProbeVisitor;
@@ -117,10 +144,21 @@ class AssemblyTree
     typedef std::vector<foundation::AABB3d> AABBVector;
     typedef std::vector<const Assembly*> AssemblyVector;
     typedef std::map<foundation::UniqueID, foundation::VersionID> AssemblyVersionMap;
+    typedef std::map<foundation::UniqueID, foundation::uint64> AssemblyLODMap;
+    typedef std::map<foundation::UniqueID, float> AssemblyProjectedSizeMap;
+
+    struct TreeBuilder;
 
     const Scene&                    m_scene;
+    bool                            m_background_tree_construction;
+    std::auto_ptr<TreeBuilder>      m_tree_builder;
     ItemVector                      m_items;
+    std::vector<size_t>             m_item_ordering;
+    size_t                          m_motion_segment_count;
+    double                          m_built_cost;
     AssemblyVersionMap              m_assembly_versions;
+    AssemblyLODMap                  m_assembly_lods;            // selected levels of detail of each assembly
+    AssemblyProjectedSizeMap        m_projected_sizes;          // only for assemblies with levels of detail
 
     TreeRepository<TriangleTree>    m_triangle_tree_repository;
     TriangleTreeContainer           m_triangle_trees;
@@ -131,15 +169,45 @@ class AssemblyTree
     TreeRepository<CurveTree>       m_curve_tree_repository;
     CurveTreeContainer              m_curve_trees;
 
+    foundation::MemoryAccount       m_memory_account;
+
     void collect_assembly_instances(
         const AssemblyInstanceContainer&        assembly_instances,
         const TransformSequence&                parent_transform_seq,
-        AABBVector&                             assembly_instance_bboxes);
+        ItemVector&                             items,
+        AABBVector&                             assembly_instance_bboxes) const;
+
+    // Compute the bounding boxes of the assembly instances at regularly spaced times of the
+    // shutter interval. Return the number of motion segments, or 0 if no instance is moving.
+    size_t collect_assembly_instance_motion_bboxes(
+        const ItemVector&                       items,
+        AABBVector&                             assembly_instance_motion_bboxes) const;
 
     void rebuild_assembly_tree();
     void store_items_in_leaves(foundation::Statistics& statistics);
 
+    // Store the bounding boxes over the whole shutter interval and the motion bounding boxes
+    // of the nodes, given the bounding boxes of the items in tree order.
+    void fit_motion_bboxes(
+        const AABBVector&                       item_bboxes,
+        const AABBVector&                       item_motion_bboxes);
+    AABBVector compute_motion_bboxes(
+        const size_t                            node_index,
+        const AABBVector&                       item_motion_bboxes);
+
+    // Update the bounding boxes of the nodes while keeping the topology of the tree.
+    // Return false if the tree must be rebuilt instead.
+    bool refit_assembly_tree();
+    foundation::AABB3d refit_recurse(
+        const size_t                            node_index,
+        const AABBVector&                       item_bboxes);
+
+    // Compute the surface area cost of the tree, relative to the surface area of its root.
+    double compute_cost() const;
+
     void update_tree_hierarchy();
+    void compute_projected_sizes();
+    float get_projected_size(const Assembly& assembly) const;
     void collect_unique_assemblies(AssemblyVector& assemblies) const;
     void delete_unused_child_trees(const AssemblyVector& assemblies);
 
@@ -155,6 +223,7 @@ class AssemblyTree
 
     void update_region_trees();
     void update_triangle_trees();
+    void build_triangle_trees_in_background();
 };
 
 
@@ -214,13 +283,14 @@ class AssemblyLeafProbeVisitor
   : public ProbeVisitorBase
 {
   public:
-    // Constructor.
+    // Constructor. Occluders are stored into 'occluder_cache' unless it is null.
     AssemblyLeafProbeVisitor(
         const AssemblyTree&                         tree,
         RegionTreeAccessCache&                      region_tree_cache,
         TriangleTreeAccessCache&                    triangle_tree_cache,
         CurveTreeAccessCache&                       curve_tree_cache,
-        const ShadingPoint*                         parent_shading_point
+        const ShadingPoint*                         parent_shading_point,
+        OccluderCache*                              occluder_cache
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
         , foundation::bvh::TraversalStatistics&     triangle_tree_stats
         , foundation::bvh::TraversalStatistics&     curve_tree_stats
@@ -244,6 +314,104 @@ class AssemblyLeafProbeVisitor
     TriangleTreeAccessCache&                        m_triangle_tree_cache;
     CurveTreeAccessCache&                           m_curve_tree_cache;
     const ShadingPoint*                             m_parent_shading_point;
+    OccluderCache*                                  m_occluder_cache;
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    foundation::bvh::TraversalStatistics&           m_triangle_tree_stats;
+    foundation::bvh::TraversalStatistics&           m_curve_tree_stats;
+#endif
+};
+
+
+//
+// Assembly leaf visitor for batches of rays, dispatches to AssemblyLeafVisitor.
+//
+
+class AssemblyLeafBatchVisitor
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    AssemblyLeafBatchVisitor(
+        ShadingPoint*                               shading_points,
+        const AssemblyTree&                         tree,
+        RegionTreeAccessCache&                      region_tree_cache,
+        TriangleTreeAccessCache&                    triangle_tree_cache,
+        CurveTreeAccessCache&                       curve_tree_cache,
+        const ShadingPoint*                         parent_shading_point
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , foundation::bvh::TraversalStatistics&     triangle_tree_stats
+        , foundation::bvh::TraversalStatistics&     curve_tree_stats
+#endif
+        );
+
+    // Visit a leaf for a given ray of the batch.
+    bool visit(
+        const AssemblyTree::NodeType&               node,
+        const size_t                                ray_index,
+        const ShadingRay&                           ray,
+        const ShadingRay::RayInfoType&              ray_info,
+        double&                                     distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , foundation::bvh::TraversalStatistics&     stats
+#endif
+        );
+
+  private:
+    ShadingPoint*                                   m_shading_points;
+    const AssemblyTree&                             m_tree;
+    RegionTreeAccessCache&                          m_region_tree_cache;
+    TriangleTreeAccessCache&                        m_triangle_tree_cache;
+    CurveTreeAccessCache&                           m_curve_tree_cache;
+    const ShadingPoint*                             m_parent_shading_point;
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    foundation::bvh::TraversalStatistics&           m_triangle_tree_stats;
+    foundation::bvh::TraversalStatistics&           m_curve_tree_stats;
+#endif
+};
+
+
+//
+// Assembly leaf visitor for batches of probe rays, dispatches to AssemblyLeafProbeVisitor.
+// Traversal stops for a ray as soon as an intersection is found along it.
+//
+
+class AssemblyLeafBatchProbeVisitor
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    AssemblyLeafBatchProbeVisitor(
+        bool*                                       hits,
+        const AssemblyTree&                         tree,
+        RegionTreeAccessCache&                      region_tree_cache,
+        TriangleTreeAccessCache&                    triangle_tree_cache,
+        CurveTreeAccessCache&                       curve_tree_cache,
+        const ShadingPoint*                         parent_shading_point
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , foundation::bvh::TraversalStatistics&     triangle_tree_stats
+        , foundation::bvh::TraversalStatistics&     curve_tree_stats
+#endif
+        );
+
+    // Visit a leaf for a given ray of the batch.
+    bool visit(
+        const AssemblyTree::NodeType&               node,
+        const size_t                                ray_index,
+        const ShadingRay&                           ray,
+        const ShadingRay::RayInfoType&              ray_info,
+        double&                                     distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , foundation::bvh::TraversalStatistics&     stats
+#endif
+        );
+
+  private:
+    bool*                                           m_hits;
+    const AssemblyTree&                             m_tree;
+    RegionTreeAccessCache&                          m_region_tree_cache;
+    TriangleTreeAccessCache&                        m_triangle_tree_cache;
+    CurveTreeAccessCache&                           m_curve_tree_cache;
+    const ShadingPoint*                             m_parent_shading_point;
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     foundation::bvh::TraversalStatistics&           m_triangle_tree_stats;
     foundation::bvh::TraversalStatistics&           m_curve_tree_stats;
@@ -267,6 +435,55 @@ typedef foundation::bvh::Intersector<
     ShadingRay
 > AssemblyTreeProbeIntersector;
 
+typedef foundation::bvh::WideIntersector<
+    AssemblyTree,
+    AssemblyLeafVisitor,
+    ShadingRay
+> AssemblyTreeWideIntersector;
+
+typedef foundation::bvh::WideIntersector<
+    AssemblyTree,
+    AssemblyLeafProbeVisitor,
+    ShadingRay
+> AssemblyTreeWideProbeIntersector;
+
+typedef foundation::bvh::PacketIntersector<
+    AssemblyTree,
+    AssemblyLeafBatchVisitor,
+    ShadingRay,
+    AssemblyTreePacketSize
+> AssemblyTreeBatchIntersector;
+
+typedef foundation::bvh::PacketIntersector<
+    AssemblyTree,
+    AssemblyLeafBatchProbeVisitor,
+    ShadingRay,
+    AssemblyTreePacketSize
+> AssemblyTreeBatchProbeIntersector;
+
+
+//
+// Transform a ray to the space of an assembly instance. If the assembly instance
+// contains the parent shading point, the ray starts at the offset intersection point.
+//
+
+void compute_assembly_instance_ray(
+    const AssemblyInstance&                         assembly_instance,
+    const foundation::Transformd&                   assembly_instance_transform,
+    const ShadingPoint*                             parent_shading_point,
+    const ShadingRay&                               input_ray,
+    ShadingRay&                                     output_ray);
+
+
+//
+// AssemblyTree class implementation.
+//
+
+inline bool AssemblyTree::has_motion() const
+{
+    return m_motion_segment_count > 0;
+}
+
 
 //
 // AssemblyLeafVisitor class implementation.
@@ -307,7 +524,8 @@ inline AssemblyLeafProbeVisitor::AssemblyLeafProbeVisitor(
     RegionTreeAccessCache&                          region_tree_cache,
     TriangleTreeAccessCache&                        triangle_tree_cache,
     CurveTreeAccessCache&                           curve_tree_cache,
-    const ShadingPoint*                             parent_shading_point
+    const ShadingPoint*                             parent_shading_point,
+    OccluderCache*                                  occluder_cache
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     , foundation::bvh::TraversalStatistics&         triangle_tree_stats
     , foundation::bvh::TraversalStatistics&         curve_tree_stats
@@ -318,6 +536,103 @@ inline AssemblyLeafProbeVisitor::AssemblyLeafProbeVisitor(
   , m_triangle_tree_cache(triangle_tree_cache)
   , m_curve_tree_cache(curve_tree_cache)
   , m_parent_shading_point(parent_shading_point)
+  , m_occluder_cache(occluder_cache)
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+  , m_triangle_tree_stats(triangle_tree_stats)
+  , m_curve_tree_stats(curve_tree_stats)
+#endif
+{
+}
+
+
+//
+// AssemblyLeafBatchVisitor class implementation.
+//
+
+inline AssemblyLeafBatchVisitor::AssemblyLeafBatchVisitor(
+    ShadingPoint*                                   shading_points,
+    const AssemblyTree&                             tree,
+    RegionTreeAccessCache&                          region_tree_cache,
+    TriangleTreeAccessCache&                        triangle_tree_cache,
+    CurveTreeAccessCache&                           curve_tree_cache,
+    const ShadingPoint*                             parent_shading_point
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , foundation::bvh::TraversalStatistics&         triangle_tree_stats
+    , foundation::bvh::TraversalStatistics&         curve_tree_stats
+#endif
+    )
+  : m_shading_points(shading_points)
+  , m_tree(tree)
+  , m_region_tree_cache(region_tree_cache)
+  , m_triangle_tree_cache(triangle_tree_cache)
+  , m_curve_tree_cache(curve_tree_cache)
+  , m_parent_shading_point(parent_shading_point)
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+  , m_triangle_tree_stats(triangle_tree_stats)
+  , m_curve_tree_stats(curve_tree_stats)
+#endif
+{
+}
+
+inline bool AssemblyLeafBatchVisitor::visit(
+    const AssemblyTree::NodeType&                   node,
+    const size_t                                    ray_index,
+    const ShadingRay&                               ray,
+    const ShadingRay::RayInfoType&                  ray_info,
+    double&                                         distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , foundation::bvh::TraversalStatistics&         stats
+#endif
+    )
+{
+    AssemblyLeafVisitor visitor(
+        m_shading_points[ray_index],
+        m_tree,
+        m_region_tree_cache,
+        m_triangle_tree_cache,
+        m_curve_tree_cache,
+        m_parent_shading_point
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , m_triangle_tree_stats
+        , m_curve_tree_stats
+#endif
+        );
+
+    return
+        visitor.visit(
+            node,
+            ray,
+            ray_info,
+            distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , stats
+#endif
+            );
+}
+
+
+//
+// AssemblyLeafBatchProbeVisitor class implementation.
+//
+
+inline AssemblyLeafBatchProbeVisitor::AssemblyLeafBatchProbeVisitor(
+    bool*                                           hits,
+    const AssemblyTree&                             tree,
+    RegionTreeAccessCache&                          region_tree_cache,
+    TriangleTreeAccessCache&                        triangle_tree_cache,
+    CurveTreeAccessCache&                           curve_tree_cache,
+    const ShadingPoint*                             parent_shading_point
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , foundation::bvh::TraversalStatistics&         triangle_tree_stats
+    , foundation::bvh::TraversalStatistics&         curve_tree_stats
+#endif
+    )
+  : m_hits(hits)
+  , m_tree(tree)
+  , m_region_tree_cache(region_tree_cache)
+  , m_triangle_tree_cache(triangle_tree_cache)
+  , m_curve_tree_cache(curve_tree_cache)
+  , m_parent_shading_point(parent_shading_point)
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
   , m_triangle_tree_stats(triangle_tree_stats)
   , m_curve_tree_stats(curve_tree_stats)
@@ -325,6 +640,47 @@ inline AssemblyLeafProbeVisitor::AssemblyLeafProbeVisitor(
 {
 }
 
+inline bool AssemblyLeafBatchProbeVisitor::visit(
+    const AssemblyTree::NodeType&                   node,
+    const size_t                                    ray_index,
+    const ShadingRay&                               ray,
+    const ShadingRay::RayInfoType&                  ray_info,
+    double&                                         distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , foundation::bvh::TraversalStatistics&         stats
+#endif
+    )
+{
+    AssemblyLeafProbeVisitor visitor(
+        m_tree,
+        m_region_tree_cache,
+        m_triangle_tree_cache,
+        m_curve_tree_cache,
+        m_parent_shading_point,
+        0
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , m_triangle_tree_stats
+        , m_curve_tree_stats
+#endif
+        );
+
+    const bool proceed =
+        visitor.visit(
+            node,
+            ray,
+            ray_info,
+            distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , stats
+#endif
+            );
+
+    if (visitor.hit())
+        m_hits[ray_index] = true;
+
+    return proceed;
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_INTERSECTION_ASSEMBLYTREE_H
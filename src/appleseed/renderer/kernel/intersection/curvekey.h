@@ -33,6 +33,7 @@
 #include "foundation/platform/types.h"
 
 // Standard headers.
+#include <cassert>
 #include <cstddef>
 
 namespace renderer
@@ -52,7 +53,8 @@ class CurveKey
         const size_t    curve_index_object,
         const size_t    curve_index_tree,
         const size_t    curve_pa,
-        const size_t    curve_degree);
+        const size_t    curve_degree,
+        const bool      curve_ribbon = false);
 
     // Return the index of the object instance within the assembly.
     size_t get_object_instance_index() const;
@@ -70,12 +72,29 @@ class CurveKey
     // Return the curve type
     size_t get_curve_degree() const;
 
+    // Return true if the curve should be intersected as a flat ribbon.
+    bool is_curve_ribbon() const;
+
+    // Set the segment of the original curve covered by this curve: curves may be
+    // split at build time, the segment is then one of the 2^level equal parts of
+    // the parameter range of the original curve.
+    void set_curve_segment(
+        const size_t    level,
+        const size_t    index);
+
+    // Map a parameter along this curve to a parameter along the original curve.
+    template <typename T>
+    T get_original_curve_parameter(const T v) const;
+
   private:
     foundation::uint32  m_object_instance_index;
     foundation::uint32  m_curve_index_object;
     foundation::uint32  m_curve_index_tree;
     foundation::uint16  m_curve_pa;
-    foundation::uint16  m_curve_degree;
+    foundation::uint8   m_curve_degree;
+    foundation::uint8   m_curve_ribbon;
+    foundation::uint8   m_segment_level;
+    foundation::uint8   m_segment_index;
 };
 
 
@@ -92,12 +111,16 @@ inline CurveKey::CurveKey(
     const size_t        curve_index_object,
     const size_t        curve_index_tree,
     const size_t        curve_pa,
-    const size_t        curve_degree)
+    const size_t        curve_degree,
+    const bool          curve_ribbon)
   : m_object_instance_index(static_cast<foundation::uint32>(object_instance_index))
   , m_curve_index_object(static_cast<foundation::uint32>(curve_index_object))
   , m_curve_index_tree(static_cast<foundation::uint32>(curve_index_tree))
   , m_curve_pa(static_cast<foundation::uint16>(curve_pa))
-  , m_curve_degree(static_cast<foundation::uint16>(curve_degree))
+  , m_curve_degree(static_cast<foundation::uint8>(curve_degree))
+  , m_curve_ribbon(curve_ribbon ? 1 : 0)
+  , m_segment_level(0)
+  , m_segment_index(0)
 {
 }
 
@@ -131,6 +154,28 @@ inline size_t CurveKey::get_curve_degree() const
     return static_cast<size_t>(m_curve_degree);
 }
 
+inline bool CurveKey::is_curve_ribbon() const
+{
+    return m_curve_ribbon != 0;
+}
+
+inline void CurveKey::set_curve_segment(
+    const size_t        level,
+    const size_t        index)
+{
+    assert(level < 8);
+    assert(index < (size_t(1) << level));
+
+    m_segment_level = static_cast<foundation::uint8>(level);
+    m_segment_index = static_cast<foundation::uint8>(index);
+}
+
+template <typename T>
+inline T CurveKey::get_original_curve_parameter(const T v) const
+{
+    return (static_cast<T>(m_segment_index) + v) / static_cast<T>(1 << m_segment_level);
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_INTERSECTION_CURVEKEY_H
@@ -38,16 +38,21 @@
 #include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/utility/messagecontext.h"
 #include "renderer/utility/paramarray.h"
+#include "renderer/utility/renderstatistics.h"
+#include "renderer/utility/startupprofiler.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exceptionnotimplemented.h"
 #include "foundation/math/beziercurve.h"
 #include "foundation/math/permutation.h"
+#include "foundation/math/scalar.h"
 #include "foundation/math/transform.h"
 #include "foundation/platform/defaulttimers.h"
 #include "foundation/platform/system.h"
 #include "foundation/utility/alignedallocator.h"
 #include "foundation/utility/api/apistring.h"
+#include "foundation/utility/eventtracer.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/memory.h"
 #include "foundation/utility/statistics.h"
@@ -55,9 +60,12 @@
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <deque>
 #include <string>
+#include <utility>
 
 using namespace foundation;
 using namespace std;
@@ -105,16 +113,188 @@ CurveTree::CurveTree(const Arguments& arguments)
     // Print curve tree statistics.
     statistics.insert_size("nodes alignment", alignment(&m_nodes[0]));
     statistics.insert_time("total time", stopwatch.measure().get_seconds());
-    RENDERER_LOG_DEBUG("%s",
+    const StatisticsVector stats_vector =
         StatisticsVector::make(
             "curve tree #" + to_string(m_arguments.m_curve_tree_uid) + " statistics",
-            statistics).to_string().c_str());
+            statistics);
+    RENDERER_LOG_DEBUG("%s", stats_vector.to_string().c_str());
+    global_render_statistics().record(stats_vector);
 }
 
-void CurveTree::collect_curves(vector<GAABB3>& curve_bboxes)
+namespace
+{
+    template <typename CurveType>
+    const CurveType& get_object_curve(const CurveObject& object, const size_t index);
+
+    template <>
+    const Curve1Type& get_object_curve<Curve1Type>(const CurveObject& object, const size_t index)
+    {
+        return object.get_curve1(index);
+    }
+
+    template <>
+    const Curve3Type& get_object_curve<Curve3Type>(const CurveObject& object, const size_t index)
+    {
+        return object.get_curve3(index);
+    }
+
+    template <typename CurveType>
+    GAABB3 compute_curve_bbox(const CurveType& curve)
+    {
+        GAABB3 bbox = curve.compute_bbox();
+        bbox.grow(GVector3(GScalar(0.5) * curve.compute_max_width()));
+        return bbox;
+    }
+
+    // Curves, curve keys and curve bounding boxes collected by one job.
+    template <typename CurveType>
+    struct CollectedCurves
+    {
+        vector<CurveType>   m_curves;
+        vector<CurveKey>    m_curve_keys;
+        vector<GAABB3>      m_curve_bboxes;
+    };
+
+    // Store a curve, recursively halving it as long as it significantly tightens its bounds.
+    template <typename CurveType>
+    void insert_curve(
+        const CurveType&                curve,
+        const GAABB3&                   curve_bbox,
+        CurveKey                        curve_key,
+        const size_t                    level,
+        const size_t                    index,
+        const size_t                    max_split_depth,
+        CollectedCurves<CurveType>&     output)
+    {
+        if (level < max_split_depth)
+        {
+            CurveType c1, c2;
+            curve.split(c1, c2);
+
+            const GAABB3 bbox1 = compute_curve_bbox(c1);
+            const GAABB3 bbox2 = compute_curve_bbox(c2);
+
+            if (half_surface_area(bbox1) + half_surface_area(bbox2) <
+                CurveTreeSplitAreaThreshold * half_surface_area(curve_bbox))
+            {
+                insert_curve(c1, bbox1, curve_key, level + 1, index * 2 + 0, max_split_depth, output);
+                insert_curve(c2, bbox2, curve_key, level + 1, index * 2 + 1, max_split_depth, output);
+                return;
+            }
+        }
+
+        curve_key.set_curve_segment(level, index);
+
+        output.m_curves.push_back(curve);
+        output.m_curve_keys.push_back(curve_key);
+        output.m_curve_bboxes.push_back(curve_bbox);
+    }
+
+    // A job transforming, splitting and bounding a range of curves of a curve object.
+    template <typename CurveType>
+    class CollectCurvesJob
+      : public IJob
+    {
+      public:
+        CollectCurvesJob(
+            const CurveObject&              curve_object,
+            const size_t                    object_instance_index,
+            const Transformd::MatrixType&   transform,
+            const size_t                    begin,
+            const size_t                    end,
+            const size_t                    max_split_depth,
+            CollectedCurves<CurveType>&     output)
+          : m_curve_object(curve_object)
+          , m_object_instance_index(object_instance_index)
+          , m_transform(transform)
+          , m_begin(begin)
+          , m_end(end)
+          , m_max_split_depth(max_split_depth)
+          , m_output(output)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+        {
+            const bool ribbon = m_curve_object.get_curve_type() == CurveObject::CurveTypeRibbon;
+
+            m_output.m_curves.reserve(m_end - m_begin);
+            m_output.m_curve_keys.reserve(m_end - m_begin);
+            m_output.m_curve_bboxes.reserve(m_end - m_begin);
+
+            for (size_t i = m_begin; i < m_end; ++i)
+            {
+                const CurveType curve(get_object_curve<CurveType>(m_curve_object, i), m_transform);
+                const CurveKey curve_key(
+                    m_object_instance_index,    // object instance index
+                    i,                          // curve index in object
+                    0,                          // curve index in tree, assigned once all curves are collected
+                    0,                          // for now we assume all the curves have the same material
+                    CurveType::Degree,          // curve degree
+                    ribbon);                    // intersect as a flat ribbon
+
+                insert_curve(
+                    curve,
+                    compute_curve_bbox(curve),
+                    curve_key,
+                    0,                          // level
+                    0,                          // index
+                    m_max_split_depth,
+                    m_output);
+            }
+        }
+
+      private:
+        const CurveObject&              m_curve_object;
+        const size_t                    m_object_instance_index;
+        const Transformd::MatrixType    m_transform;
+        const size_t                    m_begin;
+        const size_t                    m_end;
+        const size_t                    m_max_split_depth;
+        CollectedCurves<CurveType>&     m_output;
+    };
+
+    // Append the curves collected by a job, assigning their index in the tree.
+    template <typename CurveType>
+    void append_collected_curves(
+        CollectedCurves<CurveType>&     collected,
+        vector<CurveType>&              curves,
+        vector<CurveKey>&               curve_keys,
+        vector<GAABB3>&                 curve_bboxes)
+    {
+        for (size_t i = 0; i < collected.m_curves.size(); ++i)
+        {
+            CurveKey& curve_key = collected.m_curve_keys[i];
+            curve_key.set_curve_index_tree(curves.size());
+
+            curves.push_back(collected.m_curves[i]);
+            curve_keys.push_back(curve_key);
+            curve_bboxes.push_back(collected.m_curve_bboxes[i]);
+        }
+
+        clear_release_memory(collected.m_curves);
+        clear_release_memory(collected.m_curve_keys);
+        clear_release_memory(collected.m_curve_bboxes);
+    }
+}
+
+void CurveTree::collect_curves(
+    const size_t            max_split_depth,
+    const size_t            thread_count,
+    vector<Curve1Type>&     curves1,
+    vector<Curve3Type>&     curves3,
+    vector<GAABB3>&         curve_bboxes)
 {
     const ObjectInstanceContainer& object_instances = m_arguments.m_assembly.object_instances();
 
+    // Split the curves of all curve objects into ranges, in the order in which they are stored in the tree.
+    // Degree-1 and degree-3 ranges are kept in separate lists since a job only handles one curve degree.
+    deque<CollectedCurves<Curve1Type> > collected_curves1;
+    deque<CollectedCurves<Curve3Type> > collected_curves3;
+    vector<pair<size_t, size_t> > range_order;     // (curve degree, index of the range in its list)
+
+    JobQueue job_queue;
+
     for (size_t i = 0; i < object_instances.size(); ++i)
     {
         // Retrieve the object instance.
@@ -134,46 +314,59 @@ void CurveTree::collect_curves(vector<GAABB3>& curve_bboxes)
         const Transformd::MatrixType& transform =
             object_instance->get_transform().get_local_to_parent();
 
-        // Store degree-1 curves, curve keys and curve bounding boxes.
+        // Schedule the collection of degree-1 curves.
         const size_t curve1_count = curve_object.get_curve1_count();
-        for (size_t j = 0; j < curve1_count; ++j)
+        for (size_t begin = 0; begin < curve1_count; begin += CurveTreeCollectionJobSize)
         {
-            const Curve1Type curve(curve_object.get_curve1(j), transform);
-            const CurveKey curve_key(
-                i,                  // object instance index
-                j,                  // curve index in object
-                m_curves1.size(),   // curve index in tree
-                0,                  // for now we assume all the curves have the same material
-                1);                 // curve degree
-
-            GAABB3 curve_bbox = curve.compute_bbox();
-            curve_bbox.grow(GVector3(GScalar(0.5) * curve.compute_max_width()));
-
-            m_curves1.push_back(curve);
-            m_curve_keys.push_back(curve_key);
-            curve_bboxes.push_back(curve_bbox);
+            range_order.push_back(make_pair(size_t(1), collected_curves1.size()));
+            collected_curves1.push_back(CollectedCurves<Curve1Type>());
+            job_queue.schedule(
+                new CollectCurvesJob<Curve1Type>(
+                    curve_object,
+                    i,
+                    transform,
+                    begin,
+                    min(begin + CurveTreeCollectionJobSize, curve1_count),
+                    max_split_depth,
+                    collected_curves1.back()));
         }
 
-        // Store degree-3 curves, curve keys and curve bounding boxes.
+        // Schedule the collection of degree-3 curves.
         const size_t curve3_count = curve_object.get_curve3_count();
-        for (size_t j = 0; j < curve3_count; ++j)
+        for (size_t begin = 0; begin < curve3_count; begin += CurveTreeCollectionJobSize)
         {
-            const Curve3Type curve(curve_object.get_curve3(j), transform);
-            const CurveKey curve_key(
-                i,                  // object instance index
-                j,                  // curve index in object
-                m_curves3.size(),   // curve index in tree
-                0,                  // for now we assume all the curves have the same material
-                3);                 // curve degree
-
-            GAABB3 curve_bbox = curve.compute_bbox();
-            curve_bbox.grow(GVector3(GScalar(0.5) * curve.compute_max_width()));
-
-            m_curves3.push_back(curve);
-            m_curve_keys.push_back(curve_key);
-            curve_bboxes.push_back(curve_bbox);
+            range_order.push_back(make_pair(size_t(3), collected_curves3.size()));
+            collected_curves3.push_back(CollectedCurves<Curve3Type>());
+            job_queue.schedule(
+                new CollectCurvesJob<Curve3Type>(
+                    curve_object,
+                    i,
+                    transform,
+                    begin,
+                    min(begin + CurveTreeCollectionJobSize, curve3_count),
+                    max_split_depth,
+                    collected_curves3.back()));
         }
     }
+
+    // Collect the curves in parallel.
+    {
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            thread_count,
+            JobManager::KeepRunningOnEmptyQueue);
+        job_manager.start();
+        job_queue.wait_until_completion();
+    }
+
+    // Store the collected curves in order.
+    for (size_t i = 0; i < range_order.size(); ++i)
+    {
+        if (range_order[i].first == 1)
+            append_collected_curves(collected_curves1[range_order[i].second], curves1, m_curve_keys, curve_bboxes);
+        else append_collected_curves(collected_curves3[range_order[i].second], curves3, m_curve_keys, curve_bboxes);
+    }
 }
 
 void CurveTree::build_bvh(
@@ -181,13 +374,22 @@ void CurveTree::build_bvh(
     const double            time,
     Statistics&             statistics)
 {
-    // Collect curves for this tree.
+    // Retrieve the construction parameters.
+    const size_t max_split_depth =
+        min(params.get_optional<size_t>("max_curve_split_depth", CurveTreeDefaultMaxSplitDepth), size_t(7));
+    size_t build_thread_count = params.get_optional<size_t>("build_thread_count", CurveTreeDefaultBuildThreadCount);
+    if (build_thread_count == 0)
+        build_thread_count = System::get_available_cpu_core_count();
+
+    // Collect curves for this tree. These full precision curves only live during construction.
     RENDERER_LOG_INFO(
         "collecting geometry for curve tree #" FMT_UNIQUE_ID " from assembly \"%s\"...",
         m_arguments.m_curve_tree_uid,
         m_arguments.m_assembly.get_path().c_str());
+    vector<Curve1Type> curves1;
+    vector<Curve3Type> curves3;
     vector<GAABB3> curve_bboxes;
-    collect_curves(curve_bboxes);
+    collect_curves(max_split_depth, build_thread_count, curves1, curves3, curve_bboxes);
 
     // Print statistics about the input geometry.
     RENDERER_LOG_INFO(
@@ -210,19 +412,28 @@ void CurveTree::build_bvh(
     builder.build<DefaultWallclockTimer>(
         *this,
         partitioner,
-        m_curves1.size() + m_curves3.size(),
-        CurveTreeDefaultMaxLeafSize);
+        curves1.size() + curves3.size(),
+        CurveTreeDefaultMaxLeafSize,
+        build_thread_count,
+        CurveTreeParallelBuildSubtreeSize);
     statistics.merge(
         bvh::TreeStatistics<CurveTree>(*this, m_arguments.m_bbox));
 
-    // Reorder the curve keys based on the nodes ordering.
-    if (!m_curves1.empty() || !m_curves3.empty())
+    // Reorder the curve keys based on the nodes ordering, then compress the curves.
+    if (!curves1.empty() || !curves3.empty())
     {
         const vector<size_t>& ordering = partitioner.get_item_ordering();
         reorder_curve_keys(ordering);
-        reorder_curves(ordering);
+        reorder_curves(ordering, curves1, curves3);
         reorder_curve_keys_in_leaf_nodes();
+        compress_curves(curves1, curves3);
     }
+
+    statistics.insert_size(
+        "curves size",
+        m_curves1.size() * sizeof(CompactCurve1) +
+        m_curves3.size() * sizeof(CompactCurve3) +
+        m_curve_keys.size() * sizeof(CurveKey));
 }
 
 void CurveTree::reorder_curve_keys(const vector<size_t>& ordering)
@@ -231,10 +442,13 @@ void CurveTree::reorder_curve_keys(const vector<size_t>& ordering)
     small_item_reorder(&m_curve_keys[0], &temp_keys[0], &ordering[0], ordering.size());
 }
 
-void CurveTree::reorder_curves(const vector<size_t>& ordering)
+void CurveTree::reorder_curves(
+    const vector<size_t>&   ordering,
+    vector<Curve1Type>&     curves1,
+    vector<Curve3Type>&     curves3)
 {
-    vector<Curve1Type> new_curves1(m_curves1.size());
-    vector<Curve3Type> new_curves3(m_curves3.size());
+    vector<Curve1Type> new_curves1(curves1.size());
+    vector<Curve3Type> new_curves3(curves3.size());
 
     size_t curve1_index = 0;
     size_t curve3_index = 0;
@@ -245,24 +459,24 @@ void CurveTree::reorder_curves(const vector<size_t>& ordering)
 
         if (key.get_curve_degree() == 1)
         {
-            new_curves1[curve1_index] = m_curves1[key.get_curve_index_tree()];
+            new_curves1[curve1_index] = curves1[key.get_curve_index_tree()];
             m_curve_keys[i].set_curve_index_tree(curve1_index);
             ++curve1_index;
         }
         else
         {
             assert(key.get_curve_degree() == 3);
-            new_curves3[curve3_index] = m_curves3[key.get_curve_index_tree()];
+            new_curves3[curve3_index] = curves3[key.get_curve_index_tree()];
             m_curve_keys[i].set_curve_index_tree(curve3_index);
             ++curve3_index;
         }
     }
 
-    assert(curve1_index == m_curves1.size());
-    assert(curve3_index == m_curves3.size());
+    assert(curve1_index == curves1.size());
+    assert(curve3_index == curves3.size());
 
-    m_curves1.swap(new_curves1);
-    m_curves3.swap(new_curves3);
+    curves1.swap(new_curves1);
+    curves3.swap(new_curves3);
 }
 
 void CurveTree::reorder_curve_keys_in_leaf_nodes()
@@ -302,6 +516,109 @@ void CurveTree::reorder_curve_keys_in_leaf_nodes()
     }
 }
 
+namespace
+{
+    template <typename CurveType>
+    void insert_control_points(
+        const CurveType     curves[],
+        const size_t        count,
+        GAABB3&             bbox)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t j = 0; j < curves[i].get_control_point_count(); ++j)
+                bbox.insert(curves[i].get_control_point(j));
+        }
+    }
+
+    template <typename CurveType, typename CompactCurveType>
+    void quantize_curves(
+        const CurveType     curves[],
+        const size_t        count,
+        const GVector3&     origin,
+        const GVector3&     rcp_scale,
+        CompactCurveType    compact_curves[])
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t j = 0; j < CompactCurveType::ControlPointCount; ++j)
+            {
+                const GVector3& point = curves[i].get_control_point(j);
+
+                for (size_t d = 0; d < 3; ++d)
+                {
+                    const int q = round<int>((point[d] - origin[d]) * rcp_scale[d]);
+                    compact_curves[i].m_points[j][d] = static_cast<uint16>(clamp(q, 0, 65535));
+                }
+
+                compact_curves[i].m_widths[j] = half(static_cast<float>(curves[i].get_width(j)));
+            }
+        }
+    }
+}
+
+void CurveTree::compress_curves(
+    const vector<Curve1Type>&   curves1,
+    const vector<Curve3Type>&   curves3)
+{
+    m_curves1.resize(curves1.size());
+    m_curves3.resize(curves3.size());
+
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        if (!m_nodes[i].is_leaf())
+            continue;
+
+        LeafUserData& user_data = m_nodes[i].get_user_data<LeafUserData>();
+
+        const Curve1Type* leaf_curves1 = curves1.empty() ? 0 : &curves1[user_data.m_curve1_offset];
+        const Curve3Type* leaf_curves3 = curves3.empty() ? 0 : &curves3[user_data.m_curve3_offset];
+
+        // Compute the bounds of the control points of the curves of this leaf.
+        GAABB3 bbox;
+        bbox.invalidate();
+        insert_control_points(leaf_curves1, user_data.m_curve1_count, bbox);
+        insert_control_points(leaf_curves3, user_data.m_curve3_count, bbox);
+
+        if (!bbox.is_valid())
+        {
+            user_data.m_origin = GVector3(0.0);
+            user_data.m_scale = GVector3(0.0);
+            continue;
+        }
+
+        // Map the bounds to the full 16-bit range along each axis.
+        const GVector3 extent = bbox.extent();
+        GVector3 rcp_scale;
+        for (size_t d = 0; d < 3; ++d)
+        {
+            user_data.m_scale[d] = extent[d] / GScalar(65535.0);
+            rcp_scale[d] = extent[d] > GScalar(0.0) ? GScalar(65535.0) / extent[d] : GScalar(0.0);
+        }
+        user_data.m_origin = bbox.min;
+
+        if (user_data.m_curve1_count > 0)
+        {
+            quantize_curves(
+                leaf_curves1,
+                user_data.m_curve1_count,
+                user_data.m_origin,
+                rcp_scale,
+                &m_curves1[user_data.m_curve1_offset]);
+        }
+
+        if (user_data.m_curve3_count > 0)
+        {
+            quantize_curves(
+                leaf_curves3,
+                user_data.m_curve3_count,
+                user_data.m_origin,
+                rcp_scale,
+                &m_curves3[user_data.m_curve3_offset]);
+        }
+    }
+}
+
 
 //
 // CurveTreeFactory class implementation.
@@ -314,7 +631,20 @@ CurveTreeFactory::CurveTreeFactory(const CurveTree::Arguments& arguments)
 
 auto_ptr<CurveTree> CurveTreeFactory::create()
 {
-    return auto_ptr<CurveTree>(new CurveTree(m_arguments));
+    EventTraceScope trace_scope("intersection", "curve tree", m_arguments.m_assembly.get_name());
+
+    Stopwatch<DefaultWallclockTimer> stopwatch(0);
+    stopwatch.start();
+
+    auto_ptr<CurveTree> tree(new CurveTree(m_arguments));
+
+    stopwatch.measure();
+    global_startup_profiler().record_entity(
+        "curve trees",
+        m_arguments.m_assembly.get_path().c_str(),
+        stopwatch.get_seconds());
+
+    return tree;
 }
 
 }   // namespace renderer
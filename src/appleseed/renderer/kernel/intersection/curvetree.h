@@ -36,6 +36,7 @@
 #include "renderer/kernel/intersection/probevisitorbase.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
+#include "renderer/utility/hotpathcounters.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
@@ -43,10 +44,17 @@
 #include "foundation/platform/types.h"
 #include "foundation/utility/alignedvector.h"
 #include "foundation/utility/lazy.h"
-#include "foundation/utility/poolallocator.h"
+#include "foundation/utility/threadcachingpoolallocator.h"
 #include "foundation/utility/uid.h"
 
+// OpenEXR headers.
+#include "foundation/platform/exrheaderguards.h"
+BEGIN_EXR_INCLUDES
+#include "OpenEXR/half.h"
+END_EXR_INCLUDES
+
 // Standard headers.
+#include <algorithm>
 #include <cstddef>
 #include <map>
 #include <memory>
@@ -96,20 +104,41 @@ class CurveTree
     friend class CurveLeafVisitor;
     friend class CurveLeafProbeVisitor;
 
+    // Curves are stored with their control points quantized to 16 bits per coordinate
+    // relative to the bounds of their leaf, and their widths stored as half floats.
+    template <typename CurveType>
+    struct CompactCurve
+    {
+        static const size_t ControlPointCount = CurveType::Degree + 1;
+
+        foundation::uint16  m_points[ControlPointCount][3];
+        half                m_widths[ControlPointCount];
+    };
+
+    typedef CompactCurve<Curve1Type> CompactCurve1;
+    typedef CompactCurve<Curve3Type> CompactCurve3;
+
     struct LeafUserData
     {
+        GVector3            m_origin;           // quantization origin
+        GVector3            m_scale;            // quantization step along each axis
         foundation::uint32  m_curve1_offset;
         foundation::uint32  m_curve1_count;
         foundation::uint32  m_curve3_offset;
         foundation::uint32  m_curve3_count;
     };
 
-    const Arguments         m_arguments;
-    std::vector<Curve1Type> m_curves1;
-    std::vector<Curve3Type> m_curves3;
-    std::vector<CurveKey>   m_curve_keys;
+    const Arguments             m_arguments;
+    std::vector<CompactCurve1>  m_curves1;
+    std::vector<CompactCurve3>  m_curves3;
+    std::vector<CurveKey>       m_curve_keys;
 
-    void collect_curves(std::vector<GAABB3>& curve_bboxes);
+    void collect_curves(
+        const size_t                            max_split_depth,
+        const size_t                            thread_count,
+        std::vector<Curve1Type>&                curves1,
+        std::vector<Curve3Type>&                curves3,
+        std::vector<GAABB3>&                    curve_bboxes);
 
     void build_bvh(
         const ParamArray&                       params,
@@ -120,10 +149,26 @@ class CurveTree
     void reorder_curve_keys(const std::vector<size_t>& ordering);
 
     // Reorder curves to match a given ordering.
-    void reorder_curves(const std::vector<size_t>& ordering);
+    void reorder_curves(
+        const std::vector<size_t>&              ordering,
+        std::vector<Curve1Type>&                curves1,
+        std::vector<Curve3Type>&                curves3);
 
     // Reorder curve keys in leaf nodes so that all degree-1 curve keys come before degree-3 ones.
     void reorder_curve_keys_in_leaf_nodes();
+
+    // Quantize the curves of each leaf node relative to the bounds of the leaf.
+    void compress_curves(
+        const std::vector<Curve1Type>&          curves1,
+        const std::vector<Curve3Type>&          curves3);
+
+    // Rebuild a number of consecutive curves of a leaf node.
+    template <typename CurveType>
+    static void decompress_curves(
+        const LeafUserData&                     user_data,
+        const CompactCurve<CurveType>           compact_curves[],
+        const size_t                            count,
+        CurveType                               curves[]);
 };
 
 
@@ -164,7 +209,7 @@ typedef foundation::AccessCacheMap<
     CurveTreeContainer,
     CurveTreeAccessCacheLines,
     CurveTreeAccessCacheWays,
-    foundation::PoolAllocator<void, CurveTreeAccessCacheLines * CurveTreeAccessCacheWays>
+    foundation::ThreadCachingPoolAllocator<void, CurveTreeAccessCacheLines * CurveTreeAccessCacheWays>
 > CurveTreeAccessCache;
 
 
@@ -250,6 +295,43 @@ typedef foundation::bvh::Intersector<
 > CurveTreeProbeIntersector;
 
 
+//
+// CurveTree class implementation.
+//
+
+template <typename CurveType>
+inline void CurveTree::decompress_curves(
+    const LeafUserData&                         user_data,
+    const CompactCurve<CurveType>               compact_curves[],
+    const size_t                                count,
+    CurveType                                   curves[])
+{
+    typedef CompactCurve<CurveType> CompactCurveType;
+
+    for (size_t c = 0; c < count; ++c)
+    {
+        const CompactCurveType& compact_curve = compact_curves[c];
+
+        GVector3 points[CompactCurveType::ControlPointCount];
+        GScalar widths[CompactCurveType::ControlPointCount];
+
+        for (size_t i = 0; i < CompactCurveType::ControlPointCount; ++i)
+        {
+            for (size_t d = 0; d < 3; ++d)
+            {
+                points[i][d] =
+                    user_data.m_origin[d] +
+                    user_data.m_scale[d] * static_cast<GScalar>(compact_curve.m_points[i][d]);
+            }
+
+            widths[i] = static_cast<GScalar>(static_cast<float>(compact_curve.m_widths[i]));
+        }
+
+        curves[c] = CurveType(points, widths);
+    }
+}
+
+
 //
 // CurveLeafVisitor class implementation.
 //
@@ -276,45 +358,84 @@ inline bool CurveLeafVisitor::visit(
 {
     const CurveTree::LeafUserData& user_data = node.get_user_data<CurveTree::LeafUserData>();
 
-    size_t curve_index = node.get_item_index();
+    APPLESEED_HOT_PATH_COUNT(hot_path_counters().visit_leaf(node.get_item_count()));
+
+    const size_t curve1_index = node.get_item_index();
+    const size_t curve3_index = curve1_index + user_data.m_curve1_count;
+    const GScalar norm_dir = foundation::norm(ray.m_dir);
     size_t hit_curve_index = ~0;
     GScalar u, v, t = ray.m_tmax;
 
-    for (foundation::uint32 i = 0; i < user_data.m_curve1_count; ++i, ++curve_index)
+    for (foundation::uint32 i = 0; i < user_data.m_curve1_count; i += Curve1BatchType::Size)
     {
-        const Curve1Type& curve = m_tree.m_curves1[user_data.m_curve1_offset + i];
-        if (Curve1IntersectorType::intersect(curve, ray, m_xfm_matrix, u, v, t))
+        const size_t count = std::min<size_t>(Curve1BatchType::Size, user_data.m_curve1_count - i);
+
+        Curve1Type curves[Curve1BatchType::Size];
+        CurveTree::decompress_curves(user_data, &m_tree.m_curves1[user_data.m_curve1_offset + i], count, curves);
+
+        const Curve1BatchType batch(curves, count);
+        const size_t mask = batch.compute_overlap_mask(m_xfm_matrix, t * norm_dir);
+
+        for (size_t j = 0; j < count; ++j)
         {
-            m_shading_point.m_primitive_type = ShadingPoint::PrimitiveCurve1;
-            m_shading_point.m_ray.m_tmax = static_cast<double>(t);
-            m_shading_point.m_bary[0] = static_cast<float>(u);
-            m_shading_point.m_bary[1] = static_cast<float>(v);
-            hit_curve_index = curve_index;
+            if ((mask & (size_t(1) << j)) == 0)
+                continue;
+
+            const bool ribbon = m_tree.m_curve_keys[curve1_index + i + j].is_curve_ribbon();
+            if (Curve1IntersectorType::intersect(
+                    curves[j], ray, m_xfm_matrix, u, v, t,
+                    ribbon ? CurveRibbonIntersectionEpsilon : CurveTubeIntersectionEpsilon,
+                    ribbon ? CurveRibbonMaxRecursionDepth : CurveTubeMaxRecursionDepth))
+            {
+                m_shading_point.m_primitive_type = ShadingPoint::PrimitiveCurve1;
+                m_shading_point.m_ray.m_tmax = static_cast<double>(t);
+                m_shading_point.m_bary[0] = static_cast<float>(u);
+                m_shading_point.m_bary[1] = static_cast<float>(v);
+                hit_curve_index = curve1_index + i + j;
+            }
         }
     }
 
-    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(curve1_curve_count));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(user_data.m_curve1_count));
 
-    for (foundation::uint32 i = 0; i < user_data.m_curve3_count; ++i, ++curve_index)
+    for (foundation::uint32 i = 0; i < user_data.m_curve3_count; i += Curve3BatchType::Size)
     {
-        const Curve3Type& curve = m_tree.m_curves3[user_data.m_curve3_offset + i];
-        if (Curve3IntersectorType::intersect(curve, ray, m_xfm_matrix, u, v, t))
+        const size_t count = std::min<size_t>(Curve3BatchType::Size, user_data.m_curve3_count - i);
+
+        Curve3Type curves[Curve3BatchType::Size];
+        CurveTree::decompress_curves(user_data, &m_tree.m_curves3[user_data.m_curve3_offset + i], count, curves);
+
+        const Curve3BatchType batch(curves, count);
+        const size_t mask = batch.compute_overlap_mask(m_xfm_matrix, t * norm_dir);
+
+        for (size_t j = 0; j < count; ++j)
         {
-            m_shading_point.m_primitive_type = ShadingPoint::PrimitiveCurve3;
-            m_shading_point.m_ray.m_tmax = static_cast<double>(t);
-            m_shading_point.m_bary[0] = static_cast<float>(u);
-            m_shading_point.m_bary[1] = static_cast<float>(v);
-            hit_curve_index = curve_index;
+            if ((mask & (size_t(1) << j)) == 0)
+                continue;
+
+            const bool ribbon = m_tree.m_curve_keys[curve3_index + i + j].is_curve_ribbon();
+            if (Curve3IntersectorType::intersect(
+                    curves[j], ray, m_xfm_matrix, u, v, t,
+                    ribbon ? CurveRibbonIntersectionEpsilon : CurveTubeIntersectionEpsilon,
+                    ribbon ? CurveRibbonMaxRecursionDepth : CurveTubeMaxRecursionDepth))
+            {
+                m_shading_point.m_primitive_type = ShadingPoint::PrimitiveCurve3;
+                m_shading_point.m_ray.m_tmax = static_cast<double>(t);
+                m_shading_point.m_bary[0] = static_cast<float>(u);
+                m_shading_point.m_bary[1] = static_cast<float>(v);
+                hit_curve_index = curve3_index + i + j;
+            }
         }
     }
 
-    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(curve3_curve_count));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(user_data.m_curve3_count));
 
     if (hit_curve_index != size_t(~0))
     {
         const CurveKey& curve_key = m_tree.m_curve_keys[hit_curve_index];
-        m_shading_point.m_object_instance_index = curve_key.get_object_instance_index();
-        m_shading_point.m_primitive_index = curve_key.get_curve_index_object();
+        m_shading_point.m_object_instance_index = static_cast<foundation::uint32>(curve_key.get_object_instance_index());
+        m_shading_point.m_primitive_index = static_cast<foundation::uint32>(curve_key.get_curve_index_object());
+        m_shading_point.m_bary[1] = curve_key.get_original_curve_parameter(m_shading_point.m_bary[1]);
     }
 
     // Continue traversal.
@@ -347,31 +468,71 @@ inline bool CurveLeafProbeVisitor::visit(
 {
     const CurveTree::LeafUserData& user_data = node.get_user_data<CurveTree::LeafUserData>();
 
-    for (foundation::uint32 i = 0; i < user_data.m_curve1_count; ++i)
+    APPLESEED_HOT_PATH_COUNT(hot_path_counters().visit_leaf(node.get_item_count()));
+
+    const size_t curve1_index = node.get_item_index();
+    const size_t curve3_index = curve1_index + user_data.m_curve1_count;
+    const GScalar max_z = ray.m_tmax * foundation::norm(ray.m_dir);
+
+    for (foundation::uint32 i = 0; i < user_data.m_curve1_count; i += Curve1BatchType::Size)
     {
-        const Curve1Type& curve = m_tree.m_curves1[user_data.m_curve1_offset + i];
-        if (Curve1IntersectorType::intersect(curve, ray, m_xfm_matrix))
+        const size_t count = std::min<size_t>(Curve1BatchType::Size, user_data.m_curve1_count - i);
+
+        Curve1Type curves[Curve1BatchType::Size];
+        CurveTree::decompress_curves(user_data, &m_tree.m_curves1[user_data.m_curve1_offset + i], count, curves);
+
+        const Curve1BatchType batch(curves, count);
+        const size_t mask = batch.compute_overlap_mask(m_xfm_matrix, max_z);
+
+        for (size_t j = 0; j < count; ++j)
         {
-            FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(i + 1));
-            m_hit = true;
-            return false;
+            if ((mask & (size_t(1) << j)) == 0)
+                continue;
+
+            const bool ribbon = m_tree.m_curve_keys[curve1_index + i + j].is_curve_ribbon();
+            if (Curve1IntersectorType::intersect(
+                    curves[j], ray, m_xfm_matrix,
+                    ribbon ? CurveRibbonIntersectionEpsilon : CurveTubeIntersectionEpsilon,
+                    ribbon ? CurveRibbonMaxRecursionDepth : CurveTubeMaxRecursionDepth))
+            {
+                FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(i + j + 1));
+                m_hit = true;
+                return false;
+            }
         }
     }
 
-    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(curve1_curve_count));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(user_data.m_curve1_count));
 
-    for (foundation::uint32 i = 0; i < user_data.m_curve3_count; ++i)
+    for (foundation::uint32 i = 0; i < user_data.m_curve3_count; i += Curve3BatchType::Size)
     {
-        const Curve3Type& curve = m_tree.m_curves3[user_data.m_curve3_offset + i];
-        if (Curve3IntersectorType::intersect(curve, ray, m_xfm_matrix))
+        const size_t count = std::min<size_t>(Curve3BatchType::Size, user_data.m_curve3_count - i);
+
+        Curve3Type curves[Curve3BatchType::Size];
+        CurveTree::decompress_curves(user_data, &m_tree.m_curves3[user_data.m_curve3_offset + i], count, curves);
+
+        const Curve3BatchType batch(curves, count);
+        const size_t mask = batch.compute_overlap_mask(m_xfm_matrix, max_z);
+
+        for (size_t j = 0; j < count; ++j)
         {
-            FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(i + 1));
-            m_hit = true;
-            return false;
+            if ((mask & (size_t(1) << j)) == 0)
+                continue;
+
+            const bool ribbon = m_tree.m_curve_keys[curve3_index + i + j].is_curve_ribbon();
+            if (Curve3IntersectorType::intersect(
+                    curves[j], ray, m_xfm_matrix,
+                    ribbon ? CurveRibbonIntersectionEpsilon : CurveTubeIntersectionEpsilon,
+                    ribbon ? CurveRibbonMaxRecursionDepth : CurveTubeMaxRecursionDepth))
+            {
+                FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(i + j + 1));
+                m_hit = true;
+                return false;
+            }
         }
     }
 
-    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(curve3_curve_count));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(user_data.m_curve3_count));
 
     // Continue traversal.
     distance = ray.m_tmax;
@@ -45,10 +45,13 @@
 
 // appleseed.foundation headers.
 #include "foundation/image/canvasproperties.h"
+#include "foundation/utility/bitmask.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/lazy.h"
+#include "foundation/utility/memory.h"
 
 // Standard headers.
+#include <algorithm>
 #include <memory>
 
 using namespace foundation;
@@ -76,63 +79,61 @@ namespace
         return triangle_count;
     }
 
-    void copy_uv_coordinates(const StaticTriangleTess& tess, vector<Vector2f>& uv)
+    void get_uv_coordinates(
+        const StaticTriangleTess&   tess,
+        const Triangle&             triangle,
+        Vector2f                    uv[3])
     {
-        for (const_each<StaticTriangleTess::PrimitiveArray> i = tess.m_primitives; i; ++i)
+        if (triangle.has_vertex_attributes() && tess.get_tex_coords_count() > 0)
         {
-            if (i->has_vertex_attributes() && tess.get_tex_coords_count() > 0)
-            {
-                const Vector2f uv0(tess.get_tex_coords(i->m_a0));
-                const Vector2f uv1(tess.get_tex_coords(i->m_a1));
-                const Vector2f uv2(tess.get_tex_coords(i->m_a2));
+            const Vector2f uv0(tess.get_tex_coords(triangle.m_a0));
+            const Vector2f uv1(tess.get_tex_coords(triangle.m_a1));
+            const Vector2f uv2(tess.get_tex_coords(triangle.m_a2));
 
-                uv.push_back(Vector2f(uv0[0], 1.0f - uv0[1]));
-                uv.push_back(Vector2f(uv1[0], 1.0f - uv1[1]));
-                uv.push_back(Vector2f(uv2[0], 1.0f - uv2[1]));
-            }
-            else
-            {
-                uv.push_back(Vector2f(0.0f));
-                uv.push_back(Vector2f(0.0f));
-                uv.push_back(Vector2f(0.0f));
-            }
+            uv[0] = Vector2f(uv0[0], 1.0f - uv0[1]);
+            uv[1] = Vector2f(uv1[0], 1.0f - uv1[1]);
+            uv[2] = Vector2f(uv2[0], 1.0f - uv2[1]);
+        }
+        else
+        {
+            uv[0] = Vector2f(0.0f);
+            uv[1] = Vector2f(0.0f);
+            uv[2] = Vector2f(0.0f);
         }
     }
 
-    void copy_uv_coordinates(Object& object, vector<Vector2f>& uv)
+    template <typename T>
+    void delete_and_clear(T*& ptr)
     {
-        Access<RegionKit> region_kit(&object.get_region_kit());
-
-        for (const_each<RegionKit> i = *region_kit; i; ++i)
-        {
-            const IRegion* region = *i;
-            Access<StaticTriangleTess> tess(&region->get_static_triangle_tess());
-
-            copy_uv_coordinates(*tess, uv);
-        }
+        delete ptr;
+        ptr = 0;
     }
 }
 
+
+//
+// IntersectionFilter class implementation.
+//
+
+const uint32 IntersectionFilter::OpaqueTriangle;
+const uint32 IntersectionFilter::TransparentTriangle;
+
 IntersectionFilter::IntersectionFilter(
     Object&                 object,
     const MaterialArray&    materials,
     TextureCache&           texture_cache)
-  : m_obj_alpha_mask(0)
-  , m_obj_alpha_map_signature(0)
+  : m_obj_alpha_map_signature(0)
+  , m_obj_alpha_mask(0)
+  , m_uv_quantized(false)
+  , m_uv_origin(0.0f)
+  , m_uv_step(0.0f)
 {
     // Initialize the material -> alpha mask mapping.
     m_material_alpha_map_signatures.assign(materials.size(), 0);
     m_material_alpha_masks.assign(materials.size(), 0);
 
-    // Create alpha masks.
+    // Create alpha masks and classify triangles.
     update(object, materials, texture_cache);
-
-    if (has_alpha_masks())
-    {
-        // Make a local copy of the object's UV coordinates.
-        m_uv.reserve(get_triangle_count(object) * 3);
-        copy_uv_coordinates(object, m_uv);
-    }
 }
 
 IntersectionFilter::~IntersectionFilter()
@@ -143,23 +144,15 @@ IntersectionFilter::~IntersectionFilter()
         delete m_material_alpha_masks[i];
 }
 
-namespace
-{
-    template <typename T>
-    void delete_and_clear(T*& ptr)
-    {
-        delete ptr;
-        ptr = 0;
-    }
-}
-
 template <typename EntityType>
-void IntersectionFilter::do_update(
+bool IntersectionFilter::do_update(
     const EntityType&               entity,
     TextureCache&                   texture_cache,
-    IntersectionFilter::AlphaMask*& mask,
+    AlphaMask*&                     mask,
     uint64&                         signature)
 {
+    const bool had_mask = mask != 0;
+
     // Intersection filters would prevent shading fully transparent shading points,
     // so don't create one if shading fully transparent shading points is enabled.
     if (entity.shade_alpha_cutouts())
@@ -174,13 +167,13 @@ void IntersectionFilter::do_update(
     if (alpha_map == 0)
     {
         delete_and_clear(mask);
-        return;
+        return had_mask;
     }
 
     // Don't do anything if there is already an alpha mask and it is up-to-date.
     const uint64 alpha_map_sig = alpha_map->compute_signature();
     if (mask != 0 && alpha_map_sig == signature)
-        return;
+        return false;
 
     // Build the alpha mask.
     double transparency;
@@ -194,38 +187,54 @@ void IntersectionFilter::do_update(
     if (transparency < 5.0 / 100)
     {
         delete_and_clear(mask);
-        return;
+        return had_mask;
     }
 
     // Store the alpha mask.
     delete mask;
     mask = alpha_mask.release();
     signature = alpha_map_sig;
+
+    return true;
 }
 
 void IntersectionFilter::update(
-    const Object&           object,
+    Object&                 object,
     const MaterialArray&    materials,
     TextureCache&           texture_cache)
 {
     assert(m_material_alpha_map_signatures.size() == materials.size());
     assert(m_material_alpha_masks.size() == materials.size());
 
-    do_update(object, texture_cache, m_obj_alpha_mask, m_obj_alpha_map_signature);
+    bool changed = do_update(object, texture_cache, m_obj_alpha_mask, m_obj_alpha_map_signature);
 
     for (size_t i = 0; i < materials.size(); ++i)
     {
         if (const Material* material = materials[i])
         {
-            do_update(
-                *material,
-                texture_cache,
-                m_material_alpha_masks[i],
-                m_material_alpha_map_signatures[i]);
+            if (do_update(
+                    *material,
+                    texture_cache,
+                    m_material_alpha_masks[i],
+                    m_material_alpha_map_signatures[i]))
+                changed = true;
         }
-        else
+        else if (m_material_alpha_masks[i])
+        {
             delete_and_clear(m_material_alpha_masks[i]);
+            changed = true;
+        }
+    }
+
+    // Classify triangles against the alpha masks whenever they change.
+    if (!has_alpha_masks())
+    {
+        clear_release_memory(m_triangles);
+        clear_release_memory(m_quantized_uv);
+        clear_release_memory(m_uv);
     }
+    else if (changed)
+        classify_triangles(object);
 }
 
 bool IntersectionFilter::has_alpha_masks() const
@@ -260,10 +269,13 @@ size_t IntersectionFilter::get_masks_memory_size() const
 
 size_t IntersectionFilter::get_uv_memory_size() const
 {
-    return m_uv.capacity() * sizeof(Vector2f);
+    return
+          m_triangles.capacity() * sizeof(uint32)
+        + m_quantized_uv.capacity() * sizeof(uint16)
+        + m_uv.capacity() * sizeof(Vector2f);
 }
 
-IntersectionFilter::AlphaMask* IntersectionFilter::create_alpha_mask(
+AlphaMask* IntersectionFilter::create_alpha_mask(
     const Source*           alpha_map,
     TextureCache&           texture_cache,
     double&                 transparency)
@@ -285,8 +297,7 @@ IntersectionFilter::AlphaMask* IntersectionFilter::create_alpha_mask(
         height = 1;
     }
 
-    // Create and initialize the alpha mask.
-    AlphaMask* alpha_mask = new AlphaMask(width, height);
+    BitMask2 bitmask(width, height);
 
     const float rcp_width = 1.0f / width;
     const float rcp_height = 1.0f / height;
@@ -306,7 +317,7 @@ IntersectionFilter::AlphaMask* IntersectionFilter::create_alpha_mask(
 
             // Mark this texel as opaque or transparent in the alpha mask.
             const bool opaque = alpha[0] > 0.0f;
-            alpha_mask->set_opaque(x, y, opaque);
+            bitmask.set(x, y, opaque);
 
             // Keep track of the number of transparent texels.
             transparent_texel_count += opaque ? 0 : 1;
@@ -316,7 +327,134 @@ IntersectionFilter::AlphaMask* IntersectionFilter::create_alpha_mask(
     // Compute the ratio of transparent texels to the total number of texels.
     transparency = static_cast<double>(transparent_texel_count) / (width * height);
 
-    return alpha_mask;
+    // Compress the alpha mask.
+    return new AlphaMask(bitmask);
+}
+
+AlphaMask::Coverage IntersectionFilter::get_triangle_coverage(
+    const Vector2f          uv[3],
+    const size_t            pa) const
+{
+    const Vector2f uv_min = component_wise_min(component_wise_min(uv[0], uv[1]), uv[2]);
+    const Vector2f uv_max = component_wise_max(component_wise_max(uv[0], uv[1]), uv[2]);
+
+    // A point is accepted if it's opaque in both the object and the material alpha masks.
+    AlphaMask::Coverage coverage = AlphaMask::CoverageOpaque;
+
+    if (m_obj_alpha_mask)
+    {
+        coverage = m_obj_alpha_mask->get_coverage(uv_min, uv_max);
+
+        if (coverage == AlphaMask::CoverageTransparent)
+            return AlphaMask::CoverageTransparent;
+    }
+
+    const AlphaMask* mtl_alpha_mask =
+        pa < m_material_alpha_masks.size() ? m_material_alpha_masks[pa] : 0;
+
+    if (mtl_alpha_mask)
+    {
+        const AlphaMask::Coverage mtl_coverage = mtl_alpha_mask->get_coverage(uv_min, uv_max);
+
+        if (mtl_coverage == AlphaMask::CoverageTransparent)
+            return AlphaMask::CoverageTransparent;
+
+        if (mtl_coverage == AlphaMask::CoverageMixed)
+            coverage = AlphaMask::CoverageMixed;
+    }
+
+    return coverage;
+}
+
+void IntersectionFilter::classify_triangles(Object& object)
+{
+    clear_release_memory(m_triangles);
+    m_triangles.reserve(get_triangle_count(object));
+
+    // UV coordinates of the triangles that need to be tested against the alpha masks.
+    vector<Vector2f> uv;
+
+    Access<RegionKit> region_kit(&object.get_region_kit());
+
+    for (const_each<RegionKit> i = *region_kit; i; ++i)
+    {
+        const IRegion* region = *i;
+        Access<StaticTriangleTess> tess(&region->get_static_triangle_tess());
+
+        for (const_each<StaticTriangleTess::PrimitiveArray> j = tess->m_primitives; j; ++j)
+        {
+            Vector2f triangle_uv[3];
+            get_uv_coordinates(*tess, *j, triangle_uv);
+
+            switch (get_triangle_coverage(triangle_uv, j->m_pa))
+            {
+              case AlphaMask::CoverageOpaque:
+                m_triangles.push_back(OpaqueTriangle);
+                break;
+
+              case AlphaMask::CoverageTransparent:
+                m_triangles.push_back(TransparentTriangle);
+                break;
+
+              default:
+                m_triangles.push_back(static_cast<uint32>(uv.size() / 3));
+                uv.insert(uv.end(), triangle_uv, triangle_uv + 3);
+                break;
+            }
+        }
+    }
+
+    clear_release_memory(m_quantized_uv);
+    clear_release_memory(m_uv);
+    m_uv_quantized = false;
+
+    if (uv.empty())
+        return;
+
+    // Compute the bounding rectangle of the UV coordinates.
+    Vector2f uv_min = uv[0];
+    Vector2f uv_max = uv[0];
+    for (size_t i = 1; i < uv.size(); ++i)
+    {
+        uv_min = component_wise_min(uv_min, uv[i]);
+        uv_max = component_wise_max(uv_max, uv[i]);
+    }
+
+    // Compute the resolution of the finest alpha mask.
+    size_t max_width = m_obj_alpha_mask ? m_obj_alpha_mask->get_width() : 0;
+    size_t max_height = m_obj_alpha_mask ? m_obj_alpha_mask->get_height() : 0;
+    for (size_t i = 0; i < m_material_alpha_masks.size(); ++i)
+    {
+        if (m_material_alpha_masks[i])
+        {
+            max_width = max(max_width, m_material_alpha_masks[i]->get_width());
+            max_height = max(max_height, m_material_alpha_masks[i]->get_height());
+        }
+    }
+
+    // Only quantize UV coordinates if the error stays well below the size of a texel.
+    m_uv_origin = uv_min;
+    m_uv_step = (uv_max - uv_min) / 65535.0f;
+    m_uv_quantized =
+        m_uv_step[0] * max_width <= 1.0f / 16 &&
+        m_uv_step[1] * max_height <= 1.0f / 16;
+
+    if (m_uv_quantized)
+    {
+        const Vector2f rcp_step(
+            m_uv_step[0] > 0.0f ? 1.0f / m_uv_step[0] : 0.0f,
+            m_uv_step[1] > 0.0f ? 1.0f / m_uv_step[1] : 0.0f);
+
+        m_quantized_uv.resize(uv.size() * 2);
+
+        for (size_t i = 0; i < uv.size(); ++i)
+        {
+            const Vector2f q = (uv[i] - m_uv_origin) * rcp_step;
+            m_quantized_uv[i * 2 + 0] = static_cast<uint16>(min(truncate<uint32>(q[0] + 0.5f), uint32(65535)));
+            m_quantized_uv[i * 2 + 1] = static_cast<uint16>(min(truncate<uint32>(q[1] + 0.5f), uint32(65535)));
+        }
+    }
+    else m_uv.swap(uv);
 }
 
 }   // namespace renderer
@@ -31,6 +31,7 @@
 #define APPLESEED_RENDERER_KERNEL_INTERSECTION_INTERSECTIONFILTER_H
 
 // appleseed.renderer headers.
+#include "renderer/kernel/intersection/alphamask.h"
 #include "renderer/kernel/intersection/trianglekey.h"
 
 // appleseed.foundation headers.
@@ -38,7 +39,6 @@
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
-#include "foundation/utility/bitmask.h"
 
 // Standard headers.
 #include <cassert>
@@ -66,7 +66,7 @@ class IntersectionFilter
     ~IntersectionFilter();
 
     void update(
-        const Object&           object,
+        Object&                 object,
         const MaterialArray&    materials,
         TextureCache&           texture_cache);
 
@@ -81,71 +81,48 @@ class IntersectionFilter
         const double            v) const;
 
   private:
-    class AlphaMask
-      : public foundation::NonCopyable
-    {
-      public:
-        AlphaMask(
-            const size_t        width,
-            const size_t        height)
-          : m_max_x(static_cast<float>(width) - 1.0f)
-          , m_max_y(static_cast<float>(height) - 1.0f)
-          , m_bitmask(width, height)
-        {
-        }
-
-        void set_opaque(
-            const size_t        x,
-            const size_t        y,
-            const bool          opaque)
-        {
-            m_bitmask.set(x, y, opaque);
-        }
-
-        bool is_opaque(const foundation::Vector2f& uv) const
-        {
-            const float fx = foundation::clamp(uv[0] * m_bitmask.get_width(), 0.0f, m_max_x);
-            const float fy = foundation::clamp(uv[1] * m_bitmask.get_height(), 0.0f, m_max_y);
-
-            const size_t ix = foundation::truncate<size_t>(fx);
-            const size_t iy = foundation::truncate<size_t>(fy);
-
-            return m_bitmask.is_set(ix, iy);
-        }
-
-        bool is_transparent(const foundation::Vector2f& uv) const
-        {
-            return !is_opaque(uv);
-        }
-
-        size_t get_memory_size() const
-        {
-            return m_bitmask.get_memory_size();
-        }
-
-      private:
-        const float             m_max_x;
-        const float             m_max_y;
-        foundation::BitMask2    m_bitmask;
-    };
+    // Triangles whose texels are all opaque or all transparent are tagged
+    // as such; the other triangles store the index of their UV coordinates.
+    static const foundation::uint32 OpaqueTriangle = 0xFFFFFFFFUL;
+    static const foundation::uint32 TransparentTriangle = 0xFFFFFFFEUL;
 
     foundation::uint64                  m_obj_alpha_map_signature;
     AlphaMask*                          m_obj_alpha_mask;
     std::vector<foundation::uint64>     m_material_alpha_map_signatures;
     std::vector<AlphaMask*>             m_material_alpha_masks;
+    std::vector<foundation::uint32>     m_triangles;                // tag or index of the triangle's UV coordinates
+
+    // UV coordinates of the triangles that need to be tested against the alpha masks,
+    // either quantized to 16-bit in [m_uv_origin, m_uv_origin + 65535 * m_uv_step] or
+    // as floats if quantization would lose too much precision.
+    bool                                m_uv_quantized;
+    foundation::Vector2f                m_uv_origin;
+    foundation::Vector2f                m_uv_step;
+    std::vector<foundation::uint16>     m_quantized_uv;
     std::vector<foundation::Vector2f>   m_uv;
 
     template <typename EntityType>
-    static void do_update(
+    static bool do_update(
         const EntityType&               entity,
         TextureCache&                   texture_cache,
-        IntersectionFilter::AlphaMask*& mask,
+        AlphaMask*&                     mask,
         foundation::uint64&             signature);
 
     static AlphaMask* create_alpha_mask(
         const Source*           alpha_map,
         TextureCache&           texture_cache,
         double&                 transparency);
+
+    AlphaMask::Coverage get_triangle_coverage(
+        const foundation::Vector2f      uv[3],
+        const size_t                    pa) const;
+
+    void classify_triangles(Object& object);
+
+    foundation::Vector2f get_uv(
+        const size_t            triangle_uv_index,
+        const float             u,
+        const float             v) const;
 };
 
 
@@ -153,6 +130,29 @@ class IntersectionFilter
 // IntersectionFilter class implementation.
 //
 
+inline foundation::Vector2f IntersectionFilter::get_uv(
+    const size_t                triangle_uv_index,
+    const float                 u,
+    const float                 v) const
+{
+    const float w = 1.0f - u - v;
+
+    if (m_uv_quantized)
+    {
+        const foundation::uint16* q = &m_quantized_uv[triangle_uv_index * 6];
+
+        return
+            foundation::Vector2f(
+                m_uv_origin[0] + m_uv_step[0] * (q[0] * w + q[2] * u + q[4] * v),
+                m_uv_origin[1] + m_uv_step[1] * (q[1] * w + q[3] * u + q[5] * v));
+    }
+
+    return
+          m_uv[triangle_uv_index * 3 + 0] * w
+        + m_uv[triangle_uv_index * 3 + 1] * u
+        + m_uv[triangle_uv_index * 3 + 2] * v;
+}
+
 inline bool IntersectionFilter::accept(
     const TriangleKey&          triangle_key,
     const double                u,
@@ -169,26 +169,28 @@ inline bool IntersectionFilter::accept(
     if (u != u || v != v)
         return true;
 
-    const AlphaMask* mtl_alpha_mask = m_material_alpha_masks[triangle_key.get_triangle_pa()];
+    // Skip the alpha masks altogether for triangles that are entirely opaque or transparent.
+    const foundation::uint32 triangle = m_triangles[triangle_key.get_triangle_index()];
 
-    if (m_obj_alpha_mask || mtl_alpha_mask)
-    {
-        const size_t triangle_index = triangle_key.get_triangle_index();
+    if (triangle == OpaqueTriangle)
+        return true;
 
-        const float fu = static_cast<float>(u);
-        const float fv = static_cast<float>(v);
+    if (triangle == TransparentTriangle)
+        return false;
 
-        const foundation::Vector2f uv =
-              m_uv[triangle_index * 3 + 0] * (1.0f - fu - fv)
-            + m_uv[triangle_index * 3 + 1] * fu
-            + m_uv[triangle_index * 3 + 2] * fv;
+    const foundation::Vector2f uv =
+        get_uv(
+            triangle,
+            static_cast<float>(u),
+            static_cast<float>(v));
 
-        if (m_obj_alpha_mask && m_obj_alpha_mask->is_transparent(uv))
-            return false;
+    if (m_obj_alpha_mask && m_obj_alpha_mask->is_transparent(uv))
+        return false;
 
-        if (mtl_alpha_mask)
-            return mtl_alpha_mask->is_opaque(uv);
-    }
+    const AlphaMask* mtl_alpha_mask = m_material_alpha_masks[triangle_key.get_triangle_pa()];
+
+    if (mtl_alpha_mask)
+        return mtl_alpha_mask->is_opaque(uv);
 
     return true;
 }
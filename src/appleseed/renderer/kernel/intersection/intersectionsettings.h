@@ -57,6 +57,23 @@ const double AssemblyTreeInteriorNodeTraversalCost = 1.0;
 // Relative cost of intersecting an assembly.
 const double AssemblyTreeTriangleIntersectionCost = 10.0;
 
+// Set to true to collapse the assembly tree into wide nodes for traversal.
+const bool AssemblyTreeUseWideNodes = true;
+
+// Set to true to refit the assembly tree instead of rebuilding it when the set of assembly instances didn't change.
+const bool AssemblyTreeEnableRefit = true;
+
+// Rebuild the assembly tree when refitting increases its surface area cost by more than this factor.
+const double AssemblyTreeRefitMaxCostRatio = 1.5;
+
+// Number of motion segments of the bounding boxes of the assembly tree in scenes with moving assembly instances.
+// Rays are then intersected with bounding boxes interpolated at their time instead of bounding boxes enclosing
+// the whole shutter interval. Set to 0 to disable motion bounding boxes.
+const size_t AssemblyTreeMotionSegmentCount = 8;
+
+// Maximum number of rays traversing the assembly tree together in batch tracing (at most 64).
+const size_t AssemblyTreePacketSize = 64;
+
 
 //
 // Region tree settings.
@@ -90,6 +107,13 @@ typedef foundation::TriangleMTSupportPlane<double> TriangleSupportPlaneType;
 // Maximum number of triangles per leaf.
 const size_t TriangleTreeDefaultMaxLeafSize = 2;
 
+// Store leaves in compact form (shared vertices) whenever possible.
+const bool TriangleTreeDefaultCompactLeaves = false;
+
+// Maximum number of triangles per leaf when leaves are stored in compact form.
+// Up to four triangles sharing vertices still fit in the node itself.
+const size_t TriangleTreeDefaultCompactMaxLeafSize = 4;
+
 // Relative cost of traversing an interior node.
 const GScalar TriangleTreeDefaultInteriorNodeTraversalCost(1.0);
 
@@ -99,6 +123,15 @@ const GScalar TriangleTreeDefaultTriangleIntersectionCost(1.0);
 // Number of bins used during SBVH construction.
 const size_t TriangleTreeDefaultBinCount = 256;
 
+// Number of bins per dimension used during binned BVH construction.
+const size_t TriangleTreeBinnedSAHBinCount = 16;
+
+// Number of threads used to build a BVH triangle tree (0 for one per logical core).
+const size_t TriangleTreeDefaultBuildThreadCount = 0;
+
+// Maximum number of triangles in the subtrees built concurrently during BVH construction.
+const size_t TriangleTreeParallelBuildSubtreeSize = 4096;
+
 // Define this symbol to enable reordering the nodes of triangle trees for better
 // locality of reference. Requires a lot of temporary memory for minimal results.
 #undef RENDERER_TRIANGLE_TREE_REORDER_NODES
@@ -113,6 +146,16 @@ const size_t TriangleTreeAccessCacheWays = 2;
 // Size of the stack (in number of nodes) used during traversal.
 const size_t TriangleTreeStackSize = 64;
 
+// Maximum number of children of the wide nodes obtained by collapsing binary triangle
+// and assembly trees. Only 4-wide nodes have an SSE-optimized intersector.
+const size_t TriangleTreeWideNodeWidth = 4;
+
+// Collapse static triangle trees into wide nodes unless the assembly disables it.
+const bool TriangleTreeDefaultUseWideNodes = true;
+
+// Size of the stack (in number of nodes) used during traversal of wide nodes.
+const size_t TriangleTreeWideStackSize = 128;
+
 
 //
 // Curve tree settings.
@@ -126,11 +169,22 @@ typedef foundation::BezierCurve3<GScalar> Curve3Type;
 typedef foundation::BezierCurveIntersector<Curve1Type> Curve1IntersectorType;
 typedef foundation::BezierCurveIntersector<Curve3Type> Curve3IntersectorType;
 
+// Subdivision tolerance (relative to the curve width) and maximum subdivision depth
+// when intersecting tube curves and ribbon curves.
+const GScalar CurveTubeIntersectionEpsilon(0.05);
+const size_t CurveTubeMaxRecursionDepth = 5;
+const GScalar CurveRibbonIntersectionEpsilon(0.5);
+const size_t CurveRibbonMaxRecursionDepth = 2;
+
+// Batches of curves tested together against rays in curve tree leaves.
+typedef foundation::BezierCurveBatch4<Curve1Type> Curve1BatchType;
+typedef foundation::BezierCurveBatch4<Curve3Type> Curve3BatchType;
+
 // Matrix used in curve intersections
 typedef foundation::Matrix<GScalar, 4, 4> CurveMatrixType;
 
 // Maximum number of curves per leaf.
-const size_t CurveTreeDefaultMaxLeafSize = 1;
+const size_t CurveTreeDefaultMaxLeafSize = 4;
 
 // Relative cost of traversing an interior node.
 const GScalar CurveTreeDefaultInteriorNodeTraversalCost(1.0);
@@ -138,6 +192,22 @@ const GScalar CurveTreeDefaultInteriorNodeTraversalCost(1.0);
 // Relative cost of intersecting a curve.
 const GScalar CurveTreeDefaultCurveIntersectionCost(1.0);
 
+// Number of threads used to build a curve tree (0 for one per logical core).
+const size_t CurveTreeDefaultBuildThreadCount = 0;
+
+// Maximum number of curves in the subtrees built concurrently during BVH construction.
+const size_t CurveTreeParallelBuildSubtreeSize = 4096;
+
+// Number of curves collected and transformed by a single job.
+const size_t CurveTreeCollectionJobSize = 16384;
+
+// Maximum number of times a curve is halved at build time to tighten its bounds.
+const size_t CurveTreeDefaultMaxSplitDepth = 3;
+
+// A curve is halved if the bounding boxes of its halves have a total surface area
+// below this fraction of the surface area of its own bounding box.
+const GScalar CurveTreeSplitAreaThreshold(0.7);
+
 // Size of the curve tree access cache.
 const size_t CurveTreeAccessCacheLines = 128;
 const size_t CurveTreeAccessCacheWays = 2;
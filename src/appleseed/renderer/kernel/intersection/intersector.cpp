@@ -36,6 +36,7 @@
 #include "renderer/kernel/intersection/tracecontext.h"
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/utility/hotpathcounters.h"
 
 // appleseed.foundation headers.
 #include "foundation/platform/compiler.h"
@@ -49,6 +50,7 @@
 // Standard headers.
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -67,6 +69,8 @@ Intersector::Intersector(
   , m_report_self_intersections(report_self_intersections)
   , m_shading_ray_count(0)
   , m_probe_ray_count(0)
+  , m_batch_ray_count(0)
+  , m_occluder_cache_hit_count(0)
 {
 }
 
@@ -249,6 +253,8 @@ bool Intersector::trace(
 
     // Update ray casting statistics.
     ++m_shading_ray_count;
+    APPLESEED_HOT_PATH_COUNT(HotPathCounters& counters = hot_path_counters());
+    APPLESEED_HOT_PATH_COUNT(counters.begin_ray(ray.m_flags));
 
     // Initialize the shading point.
     shading_point.m_region_kit_cache = &m_region_kit_cache;
@@ -270,7 +276,6 @@ bool Intersector::trace(
     const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
 
     // Check the intersection between the ray and the assembly tree.
-    AssemblyTreeIntersector intersector;
     AssemblyLeafVisitor visitor(
         shading_point,
         assembly_tree,
@@ -282,20 +287,53 @@ bool Intersector::trace(
         , m_triangle_tree_traversal_stats
 #endif
         );
-    intersector.intersect_no_motion(
-        assembly_tree,
-        shading_point.m_ray,
-        ray_info,
-        visitor
+    if (assembly_tree.has_motion())
+    {
+        AssemblyTreeIntersector intersector;
+        intersector.intersect_motion(
+            assembly_tree,
+            shading_point.m_ray,
+            ray_info,
+            shading_point.m_ray.m_time.m_normalized,
+            visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
-        , m_assembly_tree_traversal_stats
+            , m_assembly_tree_traversal_stats
 #endif
-        );
+            );
+    }
+    else if (assembly_tree.has_wide_nodes())
+    {
+        AssemblyTreeWideIntersector intersector;
+        intersector.intersect_no_motion(
+            assembly_tree,
+            shading_point.m_ray,
+            ray_info,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_assembly_tree_traversal_stats
+#endif
+            );
+    }
+    else
+    {
+        AssemblyTreeIntersector intersector;
+        intersector.intersect_no_motion(
+            assembly_tree,
+            shading_point.m_ray,
+            ray_info,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_assembly_tree_traversal_stats
+#endif
+            );
+    }
 
     // Detect and report self-intersections.
     if (m_report_self_intersections)
         report_self_intersection(shading_point, parent_shading_point);
 
+    APPLESEED_HOT_PATH_COUNT(counters.end_ray(shading_point.hit()));
+
     return shading_point.hit();
 }
 
@@ -308,9 +346,8 @@ bool Intersector::trace_probe(
 
     // Update ray casting statistics.
     ++m_probe_ray_count;
-
-    // Compute ray info once for the entire traversal.
-    const ShadingRay::RayInfoType ray_info(ray);
+    APPLESEED_HOT_PATH_COUNT(HotPathCounters& counters = hot_path_counters());
+    APPLESEED_HOT_PATH_COUNT(counters.begin_ray(ray.m_flags));
 
     // Refine and offset the previous intersection point.
     if (parent_shading_point &&
@@ -318,34 +355,253 @@ bool Intersector::trace_probe(
         !(parent_shading_point->m_members & ShadingPoint::HasRefinedPoints))
         parent_shading_point->refine_and_offset();
 
+    // Test the last occluder first, there's a good chance that it blocks this ray too.
+    if (m_occluder_cache.intersect(ray, parent_shading_point))
+    {
+        ++m_occluder_cache_hit_count;
+        APPLESEED_HOT_PATH_COUNT(counters.end_ray(true));
+        return true;
+    }
+
+    // Compute ray info once for the entire traversal.
+    const ShadingRay::RayInfoType ray_info(ray);
+
     // Retrieve assembly tree.
     const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
 
     // Check the intersection between the ray and the assembly tree.
-    AssemblyTreeProbeIntersector intersector;
     AssemblyLeafProbeVisitor visitor(
         assembly_tree,
         m_region_tree_cache,
         m_triangle_tree_cache,
         m_curve_tree_cache,
-        parent_shading_point
+        parent_shading_point,
+        &m_occluder_cache
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
         , m_triangle_tree_traversal_stats
 #endif
         );
-    intersector.intersect_no_motion(
-        assembly_tree,
-        ray,
-        ray_info,
-        visitor
+    if (assembly_tree.has_motion())
+    {
+        AssemblyTreeProbeIntersector intersector;
+        intersector.intersect_motion(
+            assembly_tree,
+            ray,
+            ray_info,
+            ray.m_time.m_normalized,
+            visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
-        , m_assembly_tree_traversal_stats
+            , m_assembly_tree_traversal_stats
 #endif
-        );
+            );
+    }
+    else if (assembly_tree.has_wide_nodes())
+    {
+        AssemblyTreeWideProbeIntersector intersector;
+        intersector.intersect_no_motion(
+            assembly_tree,
+            ray,
+            ray_info,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_assembly_tree_traversal_stats
+#endif
+            );
+    }
+    else
+    {
+        AssemblyTreeProbeIntersector intersector;
+        intersector.intersect_no_motion(
+            assembly_tree,
+            ray,
+            ray_info,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_assembly_tree_traversal_stats
+#endif
+            );
+    }
+
+    APPLESEED_HOT_PATH_COUNT(counters.end_ray(visitor.hit()));
 
     return visitor.hit();
 }
 
+size_t Intersector::trace_batch(
+    const size_t                    ray_count,
+    const ShadingRay*               rays,
+    ShadingPoint*                   shading_points,
+    const ShadingPoint*             parent_shading_point) const
+{
+    assert(parent_shading_point == 0 || parent_shading_point->hit());
+
+    // Update ray casting statistics.
+    m_shading_ray_count += ray_count;
+    m_batch_ray_count += ray_count;
+    APPLESEED_HOT_PATH_COUNT(HotPathCounters& counters = hot_path_counters());
+
+    // Refine and offset the previous intersection point.
+    if (parent_shading_point &&
+        parent_shading_point->hit() &&
+        !(parent_shading_point->m_members & ShadingPoint::HasRefinedPoints))
+        parent_shading_point->refine_and_offset();
+
+    // Retrieve assembly tree.
+    const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
+
+    size_t hit_count = 0;
+
+    for (size_t first_ray = 0; first_ray < ray_count; first_ray += AssemblyTreePacketSize)
+    {
+        const size_t packet_size = min(ray_count - first_ray, AssemblyTreePacketSize);
+        const ShadingRay* packet_rays = rays + first_ray;
+        ShadingPoint* packet_shading_points = shading_points + first_ray;
+
+        // Initialize the shading points and compute ray infos once for the entire traversal.
+        ShadingRay::RayInfoType ray_infos[AssemblyTreePacketSize];
+        for (size_t i = 0; i < packet_size; ++i)
+        {
+            ShadingPoint& shading_point = packet_shading_points[i];
+
+            assert(is_normalized(packet_rays[i].m_dir));
+            assert(shading_point.m_scene == 0);
+            assert(shading_point.hit() == false);
+            assert(parent_shading_point != &shading_point);
+
+            shading_point.m_region_kit_cache = &m_region_kit_cache;
+            shading_point.m_tess_cache = &m_tess_cache;
+            shading_point.m_texture_cache = &m_texture_cache;
+            shading_point.m_scene = &m_trace_context.get_scene();
+            shading_point.m_ray = packet_rays[i];
+
+            ray_infos[i] = ShadingRay::RayInfoType(packet_rays[i]);
+
+            // Leaf visits of a packet are attributed to the type of its last ray.
+            APPLESEED_HOT_PATH_COUNT(counters.begin_ray(packet_rays[i].m_flags));
+        }
+
+        // Check the intersection between the rays and the assembly tree.
+        AssemblyLeafBatchVisitor visitor(
+            packet_shading_points,
+            assembly_tree,
+            m_region_tree_cache,
+            m_triangle_tree_cache,
+            m_curve_tree_cache,
+            parent_shading_point
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_triangle_tree_traversal_stats
+            , m_curve_tree_traversal_stats
+#endif
+            );
+        AssemblyTreeBatchIntersector intersector;
+        intersector.intersect_no_motion(
+            assembly_tree,
+            packet_size,
+            packet_rays,
+            ray_infos,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_assembly_tree_traversal_stats
+#endif
+            );
+
+        for (size_t i = 0; i < packet_size; ++i)
+        {
+            // Detect and report self-intersections.
+            if (m_report_self_intersections)
+                report_self_intersection(packet_shading_points[i], parent_shading_point);
+
+            if (packet_shading_points[i].hit())
+            {
+                APPLESEED_HOT_PATH_COUNT(++counters.m_ray_hits[HotPathCounters::ray_type_index(packet_rays[i].m_flags)]);
+                ++hit_count;
+            }
+        }
+    }
+
+    return hit_count;
+}
+
+size_t Intersector::trace_probe_batch(
+    const size_t                    ray_count,
+    const ShadingRay*               rays,
+    bool*                           hits,
+    const ShadingPoint*             parent_shading_point) const
+{
+    assert(parent_shading_point == 0 || parent_shading_point->hit());
+
+    // Update ray casting statistics.
+    m_probe_ray_count += ray_count;
+    m_batch_ray_count += ray_count;
+    APPLESEED_HOT_PATH_COUNT(HotPathCounters& counters = hot_path_counters());
+
+    // Refine and offset the previous intersection point.
+    if (parent_shading_point &&
+        parent_shading_point->hit() &&
+        !(parent_shading_point->m_members & ShadingPoint::HasRefinedPoints))
+        parent_shading_point->refine_and_offset();
+
+    // Retrieve assembly tree.
+    const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
+
+    size_t hit_count = 0;
+
+    for (size_t first_ray = 0; first_ray < ray_count; first_ray += AssemblyTreePacketSize)
+    {
+        const size_t packet_size = min(ray_count - first_ray, AssemblyTreePacketSize);
+        const ShadingRay* packet_rays = rays + first_ray;
+        bool* packet_hits = hits + first_ray;
+
+        // Compute ray infos once for the entire traversal.
+        ShadingRay::RayInfoType ray_infos[AssemblyTreePacketSize];
+        for (size_t i = 0; i < packet_size; ++i)
+        {
+            assert(is_normalized(packet_rays[i].m_dir));
+            ray_infos[i] = ShadingRay::RayInfoType(packet_rays[i]);
+            packet_hits[i] = false;
+
+            // Leaf visits of a packet are attributed to the type of its last ray.
+            APPLESEED_HOT_PATH_COUNT(counters.begin_ray(packet_rays[i].m_flags));
+        }
+
+        // Check the intersection between the rays and the assembly tree.
+        AssemblyLeafBatchProbeVisitor visitor(
+            packet_hits,
+            assembly_tree,
+            m_region_tree_cache,
+            m_triangle_tree_cache,
+            m_curve_tree_cache,
+            parent_shading_point
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_triangle_tree_traversal_stats
+            , m_curve_tree_traversal_stats
+#endif
+            );
+        AssemblyTreeBatchProbeIntersector intersector;
+        intersector.intersect_no_motion(
+            assembly_tree,
+            packet_size,
+            packet_rays,
+            ray_infos,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_assembly_tree_traversal_stats
+#endif
+            );
+
+        for (size_t i = 0; i < packet_size; ++i)
+        {
+            if (packet_hits[i])
+            {
+                APPLESEED_HOT_PATH_COUNT(++counters.m_ray_hits[HotPathCounters::ray_type_index(packet_rays[i].m_flags)]);
+                ++hit_count;
+            }
+        }
+    }
+
+    return hit_count;
+}
+
 void Intersector::manufacture_hit(
     ShadingPoint&                       shading_point,
     const ShadingRay&                   shading_ray,
@@ -376,9 +632,9 @@ void Intersector::manufacture_hit(
     shading_point.m_assembly_instance = assembly_instance;
     shading_point.m_assembly_instance_transform = assembly_instance_transform;
     shading_point.m_assembly_instance_transform_seq = &assembly_instance->transform_sequence();
-    shading_point.m_object_instance_index = object_instance_index;
-    shading_point.m_region_index = region_index;
-    shading_point.m_primitive_index = primitive_index;
+    shading_point.m_object_instance_index = static_cast<uint32>(object_instance_index);
+    shading_point.m_region_index = static_cast<uint32>(region_index);
+    shading_point.m_primitive_index = static_cast<uint32>(primitive_index);
     shading_point.m_triangle_support_plane = triangle_support_plane;
 
     // Available on-demand results: none.
@@ -421,9 +677,19 @@ namespace
         {
             return pretty_uint(m_ray_count) + " (" + pretty_percent(m_ray_count, m_total_ray_count) + ")";
         }
+
+        virtual void write_json(ostream& output) const APPLESEED_OVERRIDE
+        {
+            output << m_ray_count;
+        }
     };
 }
 
+uint64 Intersector::get_ray_count() const
+{
+    return m_shading_ray_count + m_probe_ray_count;
+}
+
 StatisticsVector Intersector::get_statistics() const
 {
     const uint64 total_ray_count = m_shading_ray_count + m_probe_ray_count;
@@ -442,6 +708,18 @@ StatisticsVector Intersector::get_statistics() const
                 "probe rays",
                 m_probe_ray_count,
                 total_ray_count)));
+    intersection_stats.insert(
+        auto_ptr<RayCountStatisticsEntry>(
+            new RayCountStatisticsEntry(
+                "batched rays",
+                m_batch_ray_count,
+                total_ray_count)));
+    intersection_stats.insert(
+        auto_ptr<RayCountStatisticsEntry>(
+            new RayCountStatisticsEntry(
+                "occluder cache hits",
+                m_occluder_cache_hit_count,
+                m_probe_ray_count)));
 
     StatisticsVector vec;
 
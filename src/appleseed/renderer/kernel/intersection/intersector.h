@@ -33,6 +33,7 @@
 // appleseed.renderer headers.
 #include "renderer/kernel/intersection/curvetree.h"
 #include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/intersection/occludercache.h"
 #include "renderer/kernel/intersection/regiontree.h"
 #include "renderer/kernel/intersection/triangletree.h"
 #include "renderer/kernel/shading/shadingpoint.h"
@@ -103,6 +104,23 @@ class Intersector
         const ShadingRay&               ray,
         const ShadingPoint*             parent_shading_point = 0) const;
 
+    // Trace a batch of world space rays through the scene. The rays of the batch
+    // traverse the assembly tree together, which pays off for coherent rays such as
+    // camera rays or shadow rays toward a light. Return the number of rays that hit.
+    size_t trace_batch(
+        const size_t                    ray_count,
+        const ShadingRay*               rays,
+        ShadingPoint*                   shading_points,
+        const ShadingPoint*             parent_shading_point = 0) const;
+
+    // Trace a batch of world space probe rays through the scene. hits[i] is set to
+    // whether the i'th ray hit something. Return the number of rays that hit.
+    size_t trace_probe_batch(
+        const size_t                    ray_count,
+        const ShadingRay*               rays,
+        bool*                           hits,
+        const ShadingPoint*             parent_shading_point = 0) const;
+
     // Manufacture a hit "by hand".
     // There is no restriction placed on the shading point passed to this method.
     // For instance it may have been previously initialized and used.
@@ -118,6 +136,9 @@ class Intersector
         const size_t                        primitive_index,
         const TriangleSupportPlaneType&     triangle_support_plane) const;
 
+    // Return the number of shading and probe rays traced so far.
+    foundation::uint64 get_ray_count() const;
+
     // Retrieve performance statistics.
     foundation::StatisticsVector get_statistics() const;
 
@@ -133,9 +154,14 @@ class Intersector
     mutable RegionKitAccessCache                    m_region_kit_cache;
     mutable StaticTriangleTessAccessCache           m_tess_cache;
 
+    // Last triangle that occluded a probe ray.
+    mutable OccluderCache                           m_occluder_cache;
+
     // Intersection statistics.
     mutable foundation::uint64                      m_shading_ray_count;
     mutable foundation::uint64                      m_probe_ray_count;
+    mutable foundation::uint64                      m_batch_ray_count;
+    mutable foundation::uint64                      m_occluder_cache_hit_count;
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     mutable foundation::bvh::TraversalStatistics    m_assembly_tree_traversal_stats;
     mutable foundation::bvh::TraversalStatistics    m_triangle_tree_traversal_stats;
@@ -0,0 +1,64 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "occludercache.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/intersection/assemblytree.h"
+
+using namespace foundation;
+
+namespace renderer
+{
+
+//
+// OccluderCache class implementation.
+//
+
+bool OccluderCache::intersect(
+    const ShadingRay&               ray,
+    const ShadingPoint*             parent_shading_point) const
+{
+    if (!m_valid || !(m_vis_flags & ray.m_flags))
+        return false;
+
+    // Transform the ray to the space of the occluder the same way the traversal would.
+    ShadingRay local_ray;
+    compute_assembly_instance_ray(
+        *m_assembly_instance,
+        m_assembly_instance_transform,
+        parent_shading_point,
+        ray,
+        local_ray);
+
+    return m_triangle.intersect(local_ray);
+}
+
+}   // namespace renderer
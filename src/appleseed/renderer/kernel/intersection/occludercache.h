@@ -0,0 +1,124 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_INTERSECTION_OCCLUDERCACHE_H
+#define APPLESEED_RENDERER_KERNEL_INTERSECTION_OCCLUDERCACHE_H
+
+// appleseed.renderer headers.
+#include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/shading/shadingray.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/transform.h"
+#include "foundation/platform/types.h"
+
+// Forward declarations.
+namespace renderer  { class AssemblyInstance; }
+namespace renderer  { class ShadingPoint; }
+
+namespace renderer
+{
+
+//
+// A cache holding the last triangle that occluded a probe ray, in the space of
+// its assembly instance.
+//
+// Consecutive shadow rays are frequently blocked by the same triangle, so testing
+// it before traversing the scene terminates many probe rays immediately.
+// Only static triangles of static assembly instances are cached.
+//
+// Rays are transformed exactly as during traversal, including the offset origin
+// of rays leaving a parent shading point, so that the cached triangle can never
+// occlude a ray that the scene itself would not.
+//
+
+class OccluderCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    OccluderCache();
+
+    // Forget the cached occluder.
+    void clear();
+
+    // Cache a new occluder, given in assembly instance space.
+    void set(
+        const TriangleType&             triangle,
+        const foundation::uint32        vis_flags,
+        const AssemblyInstance&         assembly_instance,
+        const foundation::Transformd&   assembly_instance_transform);
+
+    // Return true if the cached occluder intersects a given world space ray.
+    bool intersect(
+        const ShadingRay&               ray,
+        const ShadingPoint*             parent_shading_point = 0) const;
+
+  private:
+    bool                                m_valid;
+    foundation::uint32                  m_vis_flags;
+    TriangleType                        m_triangle;
+    const AssemblyInstance*             m_assembly_instance;
+    foundation::Transformd              m_assembly_instance_transform;
+};
+
+
+//
+// OccluderCache class implementation.
+//
+
+inline OccluderCache::OccluderCache()
+  : m_valid(false)
+  , m_vis_flags(0)
+  , m_assembly_instance(0)
+{
+}
+
+inline void OccluderCache::clear()
+{
+    m_valid = false;
+}
+
+inline void OccluderCache::set(
+    const TriangleType&             triangle,
+    const foundation::uint32        vis_flags,
+    const AssemblyInstance&         assembly_instance,
+    const foundation::Transformd&   assembly_instance_transform)
+{
+    m_valid = true;
+    m_vis_flags = vis_flags;
+    m_triangle = triangle;
+    m_assembly_instance = &assembly_instance;
+    m_assembly_instance_transform = assembly_instance_transform;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_INTERSECTION_OCCLUDERCACHE_H
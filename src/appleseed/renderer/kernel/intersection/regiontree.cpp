@@ -47,6 +47,7 @@
 #include "foundation/math/aabb.h"
 #include "foundation/math/split.h"
 #include "foundation/math/transform.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/memory.h"
 #include "foundation/utility/string.h"
@@ -496,6 +497,8 @@ RegionTreeFactory::RegionTreeFactory(
 
 auto_ptr<RegionTree> RegionTreeFactory::create()
 {
+    EventTraceScope trace_scope("intersection", "region tree", m_arguments.m_assembly.get_name());
+
     return auto_ptr<RegionTree>(new RegionTree(m_arguments));
 }
 
@@ -532,6 +535,19 @@ double RegionLeafVisitor::visit(
                 visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
                 , m_triangle_tree_stats
+#endif
+                );
+        }
+        else if (triangle_tree->has_wide_nodes())
+        {
+            TriangleTreeWideIntersector wide_intersector;
+            wide_intersector.intersect_no_motion(
+                *triangle_tree,
+                ray,
+                ray_info,
+                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , m_triangle_tree_stats
 #endif
                 );
         }
@@ -587,6 +603,19 @@ double RegionLeafProbeVisitor::visit(
                 visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
                 , m_triangle_tree_stats
+#endif
+                );
+        }
+        else if (triangle_tree->has_wide_nodes())
+        {
+            TriangleTreeWideProbeIntersector wide_intersector;
+            wide_intersector.intersect_no_motion(
+                *triangle_tree,
+                ray,
+                ray_info,
+                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , m_triangle_tree_stats
 #endif
                 );
         }
@@ -42,7 +42,7 @@
 #include "foundation/math/bsp.h"
 #include "foundation/math/bvh.h"
 #include "foundation/utility/lazy.h"
-#include "foundation/utility/poolallocator.h"
+#include "foundation/utility/threadcachingpoolallocator.h"
 #include "foundation/utility/uid.h"
 
 // Standard headers.
@@ -160,7 +160,7 @@ typedef foundation::AccessCacheMap<
     RegionTreeContainer,
     RegionTreeAccessCacheLines,
     RegionTreeAccessCacheWays,
-    foundation::PoolAllocator<void, RegionTreeAccessCacheLines * RegionTreeAccessCacheWays>
+    foundation::ThreadCachingPoolAllocator<void, RegionTreeAccessCacheLines * RegionTreeAccessCacheWays>
 > RegionTreeAccessCache;
 
 
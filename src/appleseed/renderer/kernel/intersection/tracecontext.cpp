@@ -57,9 +57,11 @@ namespace renderer
 // TraceContext class implementation.
 //
 
-TraceContext::TraceContext(const Scene& scene)
+TraceContext::TraceContext(
+    const Scene&    scene,
+    const bool      background_tree_construction)
   : m_scene(scene)
-  , m_assembly_tree(new AssemblyTree(scene))
+  , m_assembly_tree(new AssemblyTree(scene, background_tree_construction))
 {
     RENDERER_LOG_DEBUG(
         "data structures size:\n"
@@ -84,9 +86,19 @@ TraceContext::~TraceContext()
     delete m_assembly_tree;
 }
 
+void TraceContext::set_background_tree_construction(const bool enabled)
+{
+    m_assembly_tree->set_background_tree_construction(enabled);
+}
+
 void TraceContext::update()
 {
     m_assembly_tree->update();
 }
 
+void TraceContext::wait_for_tree_construction() const
+{
+    m_assembly_tree->wait_for_tree_construction();
+}
+
 }   // namespace renderer
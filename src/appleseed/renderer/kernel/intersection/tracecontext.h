@@ -55,7 +55,10 @@ class APPLESEED_DLLSYMBOL TraceContext
 {
   public:
     // Constructor, initializes the trace context for a given scene.
-    explicit TraceContext(const Scene& scene);
+    // See AssemblyTree for a description of background tree construction.
+    explicit TraceContext(
+        const Scene&    scene,
+        const bool      background_tree_construction = false);
 
     // Destructor.
     ~TraceContext();
@@ -66,9 +69,15 @@ class APPLESEED_DLLSYMBOL TraceContext
     // Get the assembly tree.
     const AssemblyTree& get_assembly_tree() const;
 
+    // Enable or disable background tree construction in subsequent updates.
+    void set_background_tree_construction(const bool enabled);
+
     // Synchronize the trace context with the scene.
     void update();
 
+    // Wait until all acceleration structures being built in the background are built.
+    void wait_for_tree_construction() const;
+
   private:
     const Scene&    m_scene;
     AssemblyTree*   m_assembly_tree;
@@ -35,15 +35,26 @@
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/lazy.h"
 
+// Boost headers.
+#include "boost/unordered_map.hpp"
+
 // Standard headers.
 #include <cassert>
 #include <cstddef>
-#include <map>
+#include <list>
 #include <utility>
 
 namespace renderer
 {
 
+//
+// A repository of reference-counted trees, identified by a hash of their contents.
+//
+// Trees whose reference count drops to zero are not deleted right away: the most
+// recently released ones are kept alive so that acquiring them again (for instance
+// when toggling the visibility of an assembly back on) does not rebuild them.
+//
+
 template <typename TreeType>
 class TreeRepository
   : public foundation::NonCopyable
@@ -51,6 +62,12 @@ class TreeRepository
   public:
     typedef foundation::Lazy<TreeType> LazyTreeType;
 
+    // Constructor. Up to keep_alive_count released trees are kept alive.
+    explicit TreeRepository(const size_t keep_alive_count = 16)
+      : m_keep_alive_count(keep_alive_count)
+    {
+    }
+
     ~TreeRepository()
     {
         for (foundation::each<TreeContainer> i = m_trees; i; ++i)
@@ -69,6 +86,8 @@ class TreeRepository
         m_index.insert(std::make_pair(tree, key));
     }
 
+    // Return the tree with a given key, or 0 if there is no such tree.
+    // Trees that were released and are still kept alive are revived.
     LazyTreeType* acquire(const foundation::uint64 key)
     {
         const typename TreeContainer::iterator i = m_trees.find(key);
@@ -76,6 +95,9 @@ class TreeRepository
         if (i == m_trees.end())
             return 0;
 
+        if (i->second.m_ref == 0)
+            m_released.erase(i->second.m_released_it);
+
         ++i->second.m_ref;
         return i->second.m_tree;
     }
@@ -93,31 +115,110 @@ class TreeRepository
 
         if (t->second.m_ref == 0)
         {
-            delete t->second.m_tree;
-            m_trees.erase(t);
-            m_index.erase(i);
+            // Keep the tree alive as the most recently released one.
+            m_released.push_front(t->first);
+            t->second.m_released_it = m_released.begin();
+
+            while (m_released.size() > m_keep_alive_count)
+            {
+                erase(m_released.back());
+                m_released.pop_back();
+            }
         }
     }
 
+    // Delete all released trees.
+    void purge()
+    {
+        for (foundation::const_each<KeyList> i = m_released; i; ++i)
+            erase(*i);
+
+        m_released.clear();
+    }
+
+    // Return the number of trees in use, and of trees kept alive after being released.
+    size_t size() const
+    {
+        return m_trees.size() - m_released.size();
+    }
+
+    size_t get_released_count() const
+    {
+        return m_released.size();
+    }
+
+    // Return the size in bytes of a given tree, or 0 if it does not exist or was not built yet.
+    size_t get_memory_size(const foundation::uint64 key) const
+    {
+        const typename TreeContainer::const_iterator i = m_trees.find(key);
+        return i == m_trees.end() ? 0 : get_memory_size(*i->second.m_tree);
+    }
+
+    // Return the total size in bytes of the trees kept alive after being released.
+    size_t get_released_memory_size() const
+    {
+        size_t size = 0;
+
+        for (foundation::const_each<KeyList> i = m_released; i; ++i)
+            size += get_memory_size(*i);
+
+        return size;
+    }
+
+    // Invoke func(tree, ref_count) for each tree in use.
     template <typename Func>
     void for_each(Func& func)
     {
         for (foundation::each<TreeContainer> i = m_trees; i; ++i)
-            func(*(i->second.m_tree), i->second.m_ref);
+        {
+            if (i->second.m_ref > 0)
+                func(*(i->second.m_tree), i->second.m_ref);
+        }
+    }
+
+    // Invoke func(key, tree, ref_count) for each tree, including released ones.
+    template <typename Func>
+    void for_each_entry(Func& func) const
+    {
+        for (foundation::const_each<TreeContainer> i = m_trees; i; ++i)
+            func(i->first, *(i->second.m_tree), i->second.m_ref);
     }
 
   private:
+    typedef std::list<foundation::uint64> KeyList;
+
     struct TreeInfo
     {
-        LazyTreeType*   m_tree;
-        size_t          m_ref;
+        LazyTreeType*                   m_tree;
+        size_t                          m_ref;
+        typename KeyList::iterator      m_released_it;      // only valid when m_ref == 0
     };
 
-    typedef std::map<foundation::uint64, TreeInfo> TreeContainer;
-    typedef std::map<LazyTreeType*, foundation::uint64> TreeIndex;
+    typedef boost::unordered_map<foundation::uint64, TreeInfo> TreeContainer;
+    typedef boost::unordered_map<LazyTreeType*, foundation::uint64> TreeIndex;
 
+    const size_t        m_keep_alive_count;
     TreeContainer       m_trees;
     TreeIndex           m_index;
+    KeyList             m_released;         // most recently released first
+
+    void erase(const foundation::uint64 key)
+    {
+        const typename TreeContainer::iterator i = m_trees.find(key);
+        assert(i != m_trees.end());
+        assert(i->second.m_ref == 0);
+
+        m_index.erase(i->second.m_tree);
+        delete i->second.m_tree;
+        m_trees.erase(i);
+    }
+
+    static size_t get_memory_size(LazyTreeType& tree)
+    {
+        // Does not trigger the construction of trees that were not built yet.
+        foundation::Update<TreeType> update(&tree);
+        return update.get() ? update->get_memory_size() : 0;
+    }
 };
 
 }       // namespace renderer
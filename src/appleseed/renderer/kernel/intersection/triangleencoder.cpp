@@ -38,12 +38,61 @@
 #include "foundation/platform/types.h"
 #include "foundation/utility/memory.h"
 
+// Standard headers.
+#include <cassert>
+
 using namespace foundation;
 using namespace std;
 
 namespace renderer
 {
 
+namespace
+{
+    // Collect the distinct vertices of the triangles of a leaf, and the index of each triangle vertex.
+    // Return false if the leaf has more than TriangleEncoder::MaxCompactLeafVertexCount distinct vertices.
+    bool collect_leaf_vertices(
+        const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+        const vector<GVector3>&             triangle_vertices,
+        const vector<size_t>&               triangle_indices,
+        const size_t                        item_begin,
+        const size_t                        item_count,
+        vector<GVector3>&                   leaf_vertices,
+        vector<uint8>&                      leaf_indices)
+    {
+        leaf_vertices.clear();
+        leaf_indices.clear();
+
+        for (size_t i = 0; i < item_count; ++i)
+        {
+            const size_t triangle_index = triangle_indices[item_begin + i];
+            const TriangleVertexInfo& vertex_info = triangle_vertex_infos[triangle_index];
+
+            for (size_t j = 0; j < 3; ++j)
+            {
+                const GVector3& vertex = triangle_vertices[vertex_info.m_vertex_index + j];
+
+                // Leaves are small: a linear search is good enough.
+                size_t index = 0;
+                while (index < leaf_vertices.size() && leaf_vertices[index] != vertex)
+                    ++index;
+
+                if (index == leaf_vertices.size())
+                {
+                    if (index == TriangleEncoder::MaxCompactLeafVertexCount)
+                        return false;
+
+                    leaf_vertices.push_back(vertex);
+                }
+
+                leaf_indices.push_back(static_cast<uint8>(index));
+            }
+        }
+
+        return true;
+    }
+}
+
 size_t TriangleEncoder::compute_size(
     const vector<TriangleVertexInfo>&   triangle_vertex_infos,
     const vector<size_t>&               triangle_indices,
@@ -101,4 +150,99 @@ void TriangleEncoder::encode(
     }
 }
 
+bool TriangleEncoder::is_compactable(
+    const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+    const vector<GVector3>&             triangle_vertices,
+    const vector<size_t>&               triangle_indices,
+    const size_t                        item_begin,
+    const size_t                        item_count)
+{
+    if (item_count == 0)
+        return false;
+
+    const uint32 vis_flags = triangle_vertex_infos[triangle_indices[item_begin]].m_vis_flags;
+
+    for (size_t i = 0; i < item_count; ++i)
+    {
+        const size_t triangle_index = triangle_indices[item_begin + i];
+        const TriangleVertexInfo& vertex_info = triangle_vertex_infos[triangle_index];
+
+        if (vertex_info.m_motion_segment_count > 0 || vertex_info.m_vis_flags != vis_flags)
+            return false;
+    }
+
+    vector<GVector3> leaf_vertices;
+    vector<uint8> leaf_indices;
+
+    return
+        collect_leaf_vertices(
+            triangle_vertex_infos,
+            triangle_vertices,
+            triangle_indices,
+            item_begin,
+            item_count,
+            leaf_vertices,
+            leaf_indices);
+}
+
+size_t TriangleEncoder::compute_compact_size(
+    const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+    const vector<GVector3>&             triangle_vertices,
+    const vector<size_t>&               triangle_indices,
+    const size_t                        item_begin,
+    const size_t                        item_count)
+{
+    vector<GVector3> leaf_vertices;
+    vector<uint8> leaf_indices;
+
+    collect_leaf_vertices(
+        triangle_vertex_infos,
+        triangle_vertices,
+        triangle_indices,
+        item_begin,
+        item_count,
+        leaf_vertices,
+        leaf_indices);
+
+    return compute_compact_header_size(item_count) + leaf_vertices.size() * sizeof(GVector3);
+}
+
+void TriangleEncoder::encode_compact(
+    const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+    const vector<GVector3>&             triangle_vertices,
+    const vector<size_t>&               triangle_indices,
+    const size_t                        item_begin,
+    const size_t                        item_count,
+    MemoryWriter&                       writer)
+{
+    assert(is_compactable(triangle_vertex_infos, triangle_vertices, triangle_indices, item_begin, item_count));
+
+    vector<GVector3> leaf_vertices;
+    vector<uint8> leaf_indices;
+
+    collect_leaf_vertices(
+        triangle_vertex_infos,
+        triangle_vertices,
+        triangle_indices,
+        item_begin,
+        item_count,
+        leaf_vertices,
+        leaf_indices);
+
+    const uint32 vis_flags = triangle_vertex_infos[triangle_indices[item_begin]].m_vis_flags;
+    assert((vis_flags & CompactLeafFlag) == 0);
+
+    const size_t begin = writer.offset();
+
+    writer.write(static_cast<uint32>(vis_flags | CompactLeafFlag));
+    writer.write(static_cast<uint8>(leaf_vertices.size()));
+    writer.write(&leaf_indices[0], leaf_indices.size());
+
+    // Pad so that vertices are properly aligned.
+    while (writer.offset() - begin < compute_compact_header_size(item_count))
+        writer.write(uint8(0));
+
+    writer.write(&leaf_vertices[0], leaf_vertices.size() * sizeof(GVector3));
+}
+
 }   // namespace renderer
@@ -32,8 +32,13 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersectionsettings.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
 
 // Standard headers.
+#include <cassert>
 #include <cstddef>
 #include <vector>
 
@@ -44,9 +49,34 @@ namespace renderer      { class TriangleVertexInfo; }
 namespace renderer
 {
 
+//
+// Triangle leaves come in two formats:
+//
+//   - The full format stores, for each triangle, its visibility flags, its number of
+//     motion segments and its vertices (for all motion steps).
+//
+//   - The compact format only applies to leaves whose triangles are all static and
+//     share the same visibility flags. Vertices are stored once per leaf and are
+//     referenced by 8-bit indices:
+//
+//         uint32      visibility flags | CompactLeafFlag
+//         uint8       vertex count
+//         uint8       vertex indices (3 per triangle)
+//         (padding to a multiple of sizeof(GScalar))
+//         GVector3    vertices
+//
+// Both formats are lossless. The first 32-bit word of a leaf tells them apart since
+// visibility flags never use the most significant bit.
+//
+
 class TriangleEncoder
 {
   public:
+    static const foundation::uint32 CompactLeafFlag = 0x80000000UL;
+
+    // Maximum number of distinct vertices in a compact leaf.
+    static const size_t MaxCompactLeafVertexCount = 255;
+
     static size_t compute_size(
         const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
         const std::vector<size_t>&              triangle_indices,
@@ -60,8 +90,111 @@ class TriangleEncoder
         const size_t                            item_begin,
         const size_t                            item_count,
         foundation::MemoryWriter&               writer);
+
+    // Return true if a leaf can be stored in compact format.
+    static bool is_compactable(
+        const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
+        const std::vector<GVector3>&            triangle_vertices,
+        const std::vector<size_t>&              triangle_indices,
+        const size_t                            item_begin,
+        const size_t                            item_count);
+
+    static size_t compute_compact_size(
+        const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
+        const std::vector<GVector3>&            triangle_vertices,
+        const std::vector<size_t>&              triangle_indices,
+        const size_t                            item_begin,
+        const size_t                            item_count);
+
+    static void encode_compact(
+        const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
+        const std::vector<GVector3>&            triangle_vertices,
+        const std::vector<size_t>&              triangle_indices,
+        const size_t                            item_begin,
+        const size_t                            item_count,
+        foundation::MemoryWriter&               writer);
+
+    // Return true if the leaf data starting at a given address is in compact format.
+    static bool is_compact(const foundation::uint8* leaf_data);
+
+    // Return the size in bytes of the part of a compact leaf that precedes the vertices.
+    static size_t compute_compact_header_size(const size_t triangle_count);
 };
 
+
+//
+// Read access to the triangles of a leaf stored in compact format.
+//
+
+class CompactTriangleLeafReader
+{
+  public:
+    // Constructor.
+    CompactTriangleLeafReader(
+        const foundation::uint8*                leaf_data,
+        const size_t                            triangle_count);
+
+    // Return the visibility flags shared by all triangles of the leaf.
+    foundation::uint32 get_vis_flags() const;
+
+    // Decode a given triangle.
+    GTriangleType get_triangle(const size_t triangle_index) const;
+
+  private:
+    foundation::uint32                          m_vis_flags;
+    const foundation::uint8*                    m_indices;
+    const GVector3*                             m_vertices;
+};
+
+
+//
+// TriangleEncoder class implementation.
+//
+
+inline bool TriangleEncoder::is_compact(const foundation::uint8* leaf_data)
+{
+    return (*reinterpret_cast<const foundation::uint32*>(leaf_data) & CompactLeafFlag) != 0;
+}
+
+inline size_t TriangleEncoder::compute_compact_header_size(const size_t triangle_count)
+{
+    // Visibility flags, vertex count and vertex indices, padded for vertex alignment.
+    const size_t size = sizeof(foundation::uint32) + 1 + 3 * triangle_count;
+    return (size + sizeof(GScalar) - 1) & ~(sizeof(GScalar) - 1);
+}
+
+
+//
+// CompactTriangleLeafReader class implementation.
+//
+
+inline CompactTriangleLeafReader::CompactTriangleLeafReader(
+    const foundation::uint8*                    leaf_data,
+    const size_t                                triangle_count)
+{
+    assert(TriangleEncoder::is_compact(leaf_data));
+
+    m_vis_flags = *reinterpret_cast<const foundation::uint32*>(leaf_data) & ~TriangleEncoder::CompactLeafFlag;
+    m_indices = leaf_data + sizeof(foundation::uint32) + 1;
+    m_vertices = reinterpret_cast<const GVector3*>(leaf_data + TriangleEncoder::compute_compact_header_size(triangle_count));
+}
+
+inline foundation::uint32 CompactTriangleLeafReader::get_vis_flags() const
+{
+    return m_vis_flags;
+}
+
+inline GTriangleType CompactTriangleLeafReader::get_triangle(const size_t triangle_index) const
+{
+    const foundation::uint8* indices = m_indices + 3 * triangle_index;
+
+    return
+        GTriangleType(
+            m_vertices[indices[0]],
+            m_vertices[indices[1]],
+            m_vertices[indices[2]]);
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_INTERSECTION_TRIANGLEENCODER_H
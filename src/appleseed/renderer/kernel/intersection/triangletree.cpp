@@ -51,12 +51,16 @@
 #include "renderer/modeling/scene/containers.h"
 #include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/utility/bbox.h"
+#include "renderer/utility/hotpathcounters.h"
 #include "renderer/utility/messagecontext.h"
 #include "renderer/utility/paramarray.h"
+#include "renderer/utility/renderstatistics.h"
+#include "renderer/utility/startupprofiler.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/area.h"
 #include "foundation/math/intersection/aabbtriangle.h"
+#include "foundation/math/matrix.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/transform.h"
 #include "foundation/math/treeoptimizer.h"
@@ -65,21 +69,32 @@
 #include "foundation/platform/timers.h"
 #include "foundation/utility/alignedallocator.h"
 #include "foundation/utility/api/apistring.h"
+#include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/siphash.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+#include "boost/filesystem.hpp"
+
 // Standard headers.
 #include <algorithm>
 #include <cassert>
+#include <iomanip>
 #include <set>
+#include <sstream>
 #include <string>
 
 using namespace foundation;
 using namespace std;
+namespace bf = boost::filesystem;
 
 namespace renderer
 {
@@ -359,6 +374,16 @@ namespace
             // Retrieve the tessellation of the region.
             Access<StaticTriangleTess> tess(&region->get_static_triangle_tess());
 
+            // The vertices of this object were released after a previous tree construction.
+            if (tess->has_released_vertices())
+            {
+                RENDERER_LOG_ERROR(
+                    "cannot insert object instance \"%s\" into triangle tree: the vertices of object \"%s\" have been released.",
+                    object_instance->get_path().c_str(),
+                    object.get_path().c_str());
+                continue;
+            }
+
             // Collect the triangles from this tessellation.
             if (tess->get_motion_segment_count() > 0)
             {
@@ -391,6 +416,135 @@ namespace
             }
         }
     }
+
+    //
+    // Triangle tree cache files.
+    //
+    // A cache file stores a built (but not yet collapsed) triangle tree:
+    //
+    //   uint32     magic number
+    //   uint32     format version
+    //   uint32     size of a node, in bytes
+    //   uint32     size of a geometry scalar, in bytes
+    //   uint64     cache key
+    //   uint64     number of static triangles
+    //   uint64     number of moving triangles
+    //   nodes, node bounding boxes, triangle keys, leaf data
+    //
+    // where each array is stored as a uint64 element count followed by the raw elements.
+    //
+
+    const uint32 TriangleTreeCacheMagicNumber = 0x54545341;     // "ASTT"
+    const uint32 TriangleTreeCacheFormatVersion = 2;
+
+    string make_cache_file_path(const string& cache_directory, const uint64 cache_key)
+    {
+        stringstream sstr;
+        sstr << "triangletree-" << hex << setw(16) << setfill('0') << cache_key << ".bin";
+        return (bf::path(cache_directory) / sstr.str()).string();
+    }
+
+    void hash_parameters(const Dictionary& params, string& result)
+    {
+        for (const_each<StringDictionary> i = params.strings(); i; ++i)
+        {
+            // These parameters don't affect the resulting tree.
+            const string key = i->key();
+            if (key == "cache_directory" || key == "build_thread_count" || key == "wide_nodes")
+                continue;
+
+            result += key;
+            result += '=';
+            result += i->value();
+            result += ';';
+        }
+
+        for (const_each<DictionaryDictionary> i = params.dictionaries(); i; ++i)
+        {
+            result += i->key();
+            result += '{';
+            hash_parameters(i->value(), result);
+            result += '}';
+        }
+    }
+
+    template <typename Vector>
+    uint64 hash_vector(const Vector& vec)
+    {
+        return
+            vec.empty()
+                ? 0
+                : siphash24(&vec[0], vec.size() * sizeof(typename Vector::value_type));
+    }
+
+    // Compute a signature of a region of an object instance from the object instance,
+    // the object and the tessellation of the region, without collecting its triangles.
+    // Unlike entity signatures, it does not depend on unique IDs and thus remains valid
+    // across render sessions.
+    uint64 compute_region_signature(
+        const Assembly&                 assembly,
+        const RegionInfo&               region_info)
+    {
+        const ObjectInstance* object_instance =
+            assembly.object_instances().get_by_index(region_info.get_object_instance_index());
+        assert(object_instance);
+
+        Object& object = object_instance->get_object();
+        Access<RegionKit> region_kit(&object.get_region_kit());
+        const IRegion* region = (*region_kit)[region_info.get_region_index()];
+        Access<StaticTriangleTess> tess(&region->get_static_triangle_tess());
+
+        uint64 hashes[8];
+        hashes[0] = region_info.get_object_instance_index();
+        hashes[1] = region_info.get_region_index();
+        hashes[2] = Entity::combine_signatures(object_instance->get_version_id(), object.get_version_id());
+        hashes[3] = siphash24(&object_instance->get_transform().get_local_to_parent(), sizeof(Matrix4d));
+        hashes[4] = object_instance->get_vis_flags();
+        hashes[5] = hash_vector(tess->m_primitives);
+
+        // The vertices of released tessellations are missing from the tree anyway.
+        hashes[6] = tess->has_released_vertices() ? ~uint64(0) : hash_vector(tess->m_vertices);
+
+        const size_t motion_segment_count = tess->get_motion_segment_count();
+        vector<GVector3> vertex_poses;
+        vertex_poses.reserve(motion_segment_count * tess->m_vertices.size());
+        for (size_t m = 0; m < motion_segment_count; ++m)
+        {
+            for (size_t i = 0; i < tess->m_vertices.size(); ++i)
+                vertex_poses.push_back(tess->get_vertex_pose(i, m));
+        }
+        hashes[7] = hash_vector(vertex_poses);
+
+        return siphash24(hashes, sizeof(hashes));
+    }
+
+    template <typename Vector>
+    bool write_vector(BufferedFile& file, const Vector& vec)
+    {
+        const uint64 count = vec.size();
+        const size_t size = vec.size() * sizeof(typename Vector::value_type);
+
+        return
+            file.write(count) == sizeof(count) &&
+            (size == 0 || file.write(&vec[0], size) == size);
+    }
+
+    template <typename Vector>
+    bool read_vector(BufferedFile& file, const uint64 file_size, Vector& vec)
+    {
+        uint64 count;
+        if (file.read(count) != sizeof(count))
+            return false;
+
+        // Reject obviously corrupted files before allocating anything.
+        if (count > file_size / sizeof(typename Vector::value_type))
+            return false;
+
+        vec.resize(static_cast<size_t>(count));
+
+        const size_t size = vec.size() * sizeof(typename Vector::value_type);
+        return size == 0 || file.read(&vec[0], size) == size;
+    }
 }
 
 TriangleTree::Arguments::Arguments(
@@ -410,39 +564,75 @@ TriangleTree::Arguments::Arguments(
 TriangleTree::TriangleTree(const Arguments& arguments)
   : TreeType(AlignedAllocator<void>(System::get_l1_data_cache_line_size()))
   , m_arguments(arguments)
+  , m_memory_account(MemoryTagBVH)
 {
     // Retrieve construction parameters.
     const MessageContext message_context(
         format("while building triangle tree for assembly \"{0}\"", m_arguments.m_assembly.get_path()));
     const ParamArray& params = m_arguments.m_assembly.get_parameters().child("acceleration_structure");
-    const string algorithm = params.get_optional<string>("algorithm", "bvh", make_vector("bvh", "sbvh"), message_context);
+    const string algorithm = params.get_optional<string>("algorithm", "bvh", make_vector("bvh", "binned_bvh", "sbvh"), message_context);
     const double time = params.get_optional<double>("time", 0.5);
     const bool save_memory = params.get_optional<bool>("save_temporary_memory", false);
+    const bool use_wide_nodes = params.get_optional<bool>("wide_nodes", TriangleTreeDefaultUseWideNodes);
+    const string cache_directory = params.get_optional<string>("cache_directory", "");
 
     // Start stopwatch.
     Stopwatch<DefaultWallclockTimer> stopwatch;
     stopwatch.start();
 
-    // Build the tree.
     Statistics statistics;
-    if (algorithm == "bvh")
-        build_bvh(params, time, save_memory, statistics);
-    else build_sbvh(params, time, save_memory, statistics);
+
+    // Try to load the tree from the cache.
+    string cache_file_path;
+    uint64 cache_key = 0;
+    bool loaded_from_cache = false;
+    if (!cache_directory.empty())
+    {
+        cache_key = compute_cache_key(params, time);
+        cache_file_path = make_cache_file_path(cache_directory, cache_key);
+        loaded_from_cache = load_from_cache(cache_file_path, cache_key);
+        statistics.insert("cache", loaded_from_cache ? "hit" : "miss");
+    }
+
+    if (!loaded_from_cache)
+    {
+        // Build the tree.
+        if (algorithm == "bvh")
+            build_bvh(params, time, save_memory, false, statistics);
+        else if (algorithm == "binned_bvh")
+            build_bvh(params, time, save_memory, true, statistics);
+        else build_sbvh(params, time, save_memory, statistics);
 
 #ifdef RENDERER_TRIANGLE_TREE_REORDER_NODES
-    // Optimize the tree layout in memory.
-    TreeOptimizer<NodeVectorType> tree_optimizer(m_nodes);
-    tree_optimizer.optimize_node_layout(TriangleTreeSubtreeDepth);
-    assert(m_nodes.size() == m_nodes.capacity());
+        // Optimize the tree layout in memory.
+        TreeOptimizer<NodeVectorType> tree_optimizer(m_nodes);
+        tree_optimizer.optimize_node_layout(TriangleTreeSubtreeDepth);
+        assert(m_nodes.size() == m_nodes.capacity());
 #endif
 
+        // Store the tree into the cache.
+        if (!cache_file_path.empty())
+            save_to_cache(cache_file_path, cache_key);
+    }
+
+    // Collapse the tree into wide nodes. Moving triangles are handled by the binary tree only.
+    if (use_wide_nodes && m_moving_triangle_count == 0)
+    {
+        collapse();
+        statistics.insert("wide nodes", pretty_uint(get_wide_node_count()));
+    }
+
+    m_memory_account.set_size(get_memory_size());
+
     // Print triangle tree statistics.
     statistics.insert_size("nodes alignment", alignment(&m_nodes[0]));
     statistics.insert_time("total time", stopwatch.measure().get_seconds());
-    RENDERER_LOG_DEBUG("%s",
+    const StatisticsVector stats_vector =
         StatisticsVector::make(
             "triangle tree #" + to_string(m_arguments.m_triangle_tree_uid) + " statistics",
-            statistics).to_string().c_str());
+            statistics);
+    RENDERER_LOG_DEBUG("%s", stats_vector.to_string().c_str());
+    global_render_statistics().record(stats_vector);
 }
 
 TriangleTree::~TriangleTree()
@@ -460,6 +650,8 @@ void TriangleTree::update_non_geometry(const bool enable_intersection_filters)
         m_arguments.m_assembly.get_parameters().get_optional<bool>("enable_intersection_filters", true))
         update_intersection_filters();
     else delete_intersection_filters();
+
+    m_memory_account.set_size(get_memory_size());
 }
 
 size_t TriangleTree::get_memory_size() const
@@ -505,12 +697,61 @@ namespace
 
         return count;
     }
+
+    // Number of triangle trees being built. AssemblyTree builds trees concurrently, one per
+    // thread: each of these trees must only use its share of the threads of the machine.
+    boost::atomic<size_t> g_concurrent_build_count(0);
+
+    class ConcurrentBuild
+      : public NonCopyable
+    {
+      public:
+        ConcurrentBuild()
+          : m_count(++g_concurrent_build_count)
+        {
+        }
+
+        ~ConcurrentBuild()
+        {
+            --g_concurrent_build_count;
+        }
+
+        // Return the number of trees being built, including this one, when this build started.
+        size_t get_count() const
+        {
+            return m_count;
+        }
+
+      private:
+        const size_t m_count;
+    };
+
+    template <typename Partitioner>
+    double build_bvh_nodes(
+        TriangleTree&       tree,
+        Partitioner&        partitioner,
+        const size_t        triangle_count,
+        const size_t        max_leaf_size,
+        const size_t        build_thread_count)
+    {
+        typedef bvh::Builder<TriangleTree, Partitioner> Builder;
+        Builder builder;
+        builder.template build<DefaultWallclockTimer>(
+            tree,
+            partitioner,
+            triangle_count,
+            max_leaf_size,
+            build_thread_count,
+            TriangleTreeParallelBuildSubtreeSize);
+        return builder.get_build_time();
+    }
 }
 
 void TriangleTree::build_bvh(
     const ParamArray&   params,
     const double        time,
     const bool          save_memory,
+    const bool          binned,
     Statistics&         statistics)
 {
     Stopwatch<DefaultWallclockTimer> stopwatch;
@@ -550,26 +791,58 @@ void TriangleTree::build_bvh(
         plural(m_moving_triangle_count, "moving triangle").c_str());
 
     // Retrieving the partitioner parameters.
-    const size_t max_leaf_size = params.get_optional<size_t>("max_leaf_size", TriangleTreeDefaultMaxLeafSize);
+    const bool compact_leaves = params.get_optional<bool>("compact_leaves", TriangleTreeDefaultCompactLeaves);
+    const size_t max_leaf_size =
+        params.get_optional<size_t>(
+            "max_leaf_size",
+            compact_leaves ? TriangleTreeDefaultCompactMaxLeafSize : TriangleTreeDefaultMaxLeafSize);
     const GScalar interior_node_traversal_cost = params.get_optional<GScalar>("interior_node_traversal_cost", TriangleTreeDefaultInteriorNodeTraversalCost);
     const GScalar triangle_intersection_cost = params.get_optional<GScalar>("triangle_intersection_cost", TriangleTreeDefaultTriangleIntersectionCost);
-
-    // Create the partitioner.
-    typedef bvh::SAHPartitioner<vector<GAABB3> > Partitioner;
-    Partitioner partitioner(
-        triangle_bboxes,
-        max_leaf_size,
-        interior_node_traversal_cost,
-        triangle_intersection_cost);
-
-    // Build the tree.
-    typedef bvh::Builder<TriangleTree, Partitioner> Builder;
-    Builder builder;
-    builder.build<DefaultWallclockTimer>(
-        *this,
-        partitioner,
-        triangle_keys.size(),
-        max_leaf_size);
+    size_t build_thread_count = params.get_optional<size_t>("build_thread_count", TriangleTreeDefaultBuildThreadCount);
+    if (build_thread_count == 0)
+        build_thread_count = System::get_available_cpu_core_count();
+
+    // Share the build threads with the triangle trees being built at the same time.
+    const ConcurrentBuild concurrent_build;
+    build_thread_count = max<size_t>(build_thread_count / concurrent_build.get_count(), 1);
+
+    // Partition the triangles and build the tree.
+    vector<size_t> triangle_ordering;
+    double build_time;
+    if (binned)
+    {
+        typedef bvh::BinnedSAHPartitioner<vector<GAABB3>, TriangleTreeBinnedSAHBinCount> Partitioner;
+        Partitioner partitioner(
+            triangle_bboxes,
+            max_leaf_size,
+            interior_node_traversal_cost,
+            triangle_intersection_cost);
+        build_time =
+            build_bvh_nodes(
+                *this,
+                partitioner,
+                triangle_keys.size(),
+                max_leaf_size,
+                build_thread_count);
+        triangle_ordering = partitioner.get_item_ordering();
+    }
+    else
+    {
+        typedef bvh::SAHPartitioner<vector<GAABB3> > Partitioner;
+        Partitioner partitioner(
+            triangle_bboxes,
+            max_leaf_size,
+            interior_node_traversal_cost,
+            triangle_intersection_cost);
+        build_time =
+            build_bvh_nodes(
+                *this,
+                partitioner,
+                triangle_keys.size(),
+                max_leaf_size,
+                build_thread_count);
+        triangle_ordering = partitioner.get_item_ordering();
+    }
     statistics.merge(
         bvh::TreeStatistics<TriangleTree>(*this, AABB3d(m_arguments.m_bbox)));
 
@@ -591,26 +864,164 @@ void TriangleTree::build_bvh(
 
     // Compute and propagate motion bounding boxes.
     compute_motion_bboxes(
-        partitioner.get_item_ordering(),
+        triangle_ordering,
         triangle_vertex_infos,
         triangle_vertices,
         0);
 
     // Store triangles and triangle keys into the tree.
     store_triangles(
-        partitioner.get_item_ordering(),
+        triangle_ordering,
         triangle_vertex_infos,
         triangle_vertices,
         triangle_keys,
+        compact_leaves,
         statistics);
 
     const double storing_time = stopwatch.measure().get_seconds();
 
     statistics.insert_time("collection time", collection_time);
-    statistics.insert_time("partition time", builder.get_build_time());
+    statistics.insert_time("partition time", build_time);
     statistics.insert_time("store time", storing_time);
 }
 
+uint64 TriangleTree::compute_cache_key(
+    const ParamArray&   params,
+    const double        time) const
+{
+    // Identify the geometry of this tree by the signatures of its regions.
+    vector<uint64> region_signatures;
+    region_signatures.reserve(m_arguments.m_regions.size());
+    for (const_each<RegionInfoVector> i = m_arguments.m_regions; i; ++i)
+        region_signatures.push_back(compute_region_signature(m_arguments.m_assembly, *i));
+
+    string parameters;
+    hash_parameters(params, parameters);
+
+    uint64 hashes[5];
+    hashes[0] = TriangleTreeCacheFormatVersion;
+    hashes[1] = siphash24(parameters.c_str(), parameters.size());
+    hashes[2] = siphash24(&m_arguments.m_bbox, sizeof(m_arguments.m_bbox));
+    hashes[3] = siphash24(&time, sizeof(time));
+    hashes[4] = hash_vector(region_signatures);
+
+    return siphash24(hashes, sizeof(hashes));
+}
+
+bool TriangleTree::load_from_cache(
+    const string&       path,
+    const uint64        cache_key)
+{
+    boost::system::error_code ec;
+    const uint64 file_size = bf::file_size(path, ec);
+    if (ec)
+        return false;
+
+    BufferedFile file;
+    if (!file.open(path.c_str(), BufferedFile::BinaryType, BufferedFile::ReadMode))
+        return false;
+
+    uint32 magic_number, format_version, node_size, scalar_size;
+    uint64 key, static_triangle_count, moving_triangle_count;
+
+    const bool success =
+        file.read(magic_number) == sizeof(magic_number) &&
+        magic_number == TriangleTreeCacheMagicNumber &&
+        file.read(format_version) == sizeof(format_version) &&
+        format_version == TriangleTreeCacheFormatVersion &&
+        file.read(node_size) == sizeof(node_size) &&
+        node_size == sizeof(NodeType) &&
+        file.read(scalar_size) == sizeof(scalar_size) &&
+        scalar_size == sizeof(GScalar) &&
+        file.read(key) == sizeof(key) &&
+        key == cache_key &&
+        file.read(static_triangle_count) == sizeof(static_triangle_count) &&
+        file.read(moving_triangle_count) == sizeof(moving_triangle_count) &&
+        read_vector(file, file_size, m_nodes) &&
+        read_vector(file, file_size, m_node_bboxes) &&
+        read_vector(file, file_size, m_triangle_keys) &&
+        read_vector(file, file_size, m_leaf_data) &&
+        !m_nodes.empty();
+
+    if (!success)
+    {
+        m_nodes.clear();
+        m_node_bboxes.clear();
+        m_triangle_keys.clear();
+        m_leaf_data.clear();
+        return false;
+    }
+
+    m_static_triangle_count = static_cast<size_t>(static_triangle_count);
+    m_moving_triangle_count = static_cast<size_t>(moving_triangle_count);
+
+    RENDERER_LOG_INFO(
+        "loaded triangle tree #" FMT_UNIQUE_ID " from cache file %s.",
+        m_arguments.m_triangle_tree_uid,
+        path.c_str());
+
+    return true;
+}
+
+void TriangleTree::save_to_cache(
+    const string&       path,
+    const uint64        cache_key) const
+{
+    // Write to a temporary file first so that concurrent processes never see a partial file.
+    const bf::path file_path(path);
+    boost::system::error_code ec;
+    bf::create_directories(file_path.parent_path(), ec);
+    const bf::path tmp_file_path =
+        file_path.parent_path() / bf::unique_path(file_path.filename().string() + ".%%%%-%%%%-%%%%.tmp", ec);
+
+    bool success = !ec;
+
+    if (success)
+    {
+        const uint32 node_size = sizeof(NodeType);
+        const uint32 scalar_size = sizeof(GScalar);
+        const uint64 static_triangle_count = m_static_triangle_count;
+        const uint64 moving_triangle_count = m_moving_triangle_count;
+
+        BufferedFile file;
+        success =
+            file.open(tmp_file_path.string().c_str(), BufferedFile::BinaryType, BufferedFile::WriteMode) &&
+            file.write(TriangleTreeCacheMagicNumber) == sizeof(TriangleTreeCacheMagicNumber) &&
+            file.write(TriangleTreeCacheFormatVersion) == sizeof(TriangleTreeCacheFormatVersion) &&
+            file.write(node_size) == sizeof(node_size) &&
+            file.write(scalar_size) == sizeof(scalar_size) &&
+            file.write(cache_key) == sizeof(cache_key) &&
+            file.write(static_triangle_count) == sizeof(static_triangle_count) &&
+            file.write(moving_triangle_count) == sizeof(moving_triangle_count) &&
+            write_vector(file, m_nodes) &&
+            write_vector(file, m_node_bboxes) &&
+            write_vector(file, m_triangle_keys) &&
+            write_vector(file, m_leaf_data);
+        success = file.close() && success;
+    }
+
+    if (success)
+    {
+        bf::rename(tmp_file_path, file_path, ec);
+        success = !ec;
+    }
+
+    if (!success)
+    {
+        bf::remove(tmp_file_path, ec);
+        RENDERER_LOG_WARNING(
+            "failed to write triangle tree #" FMT_UNIQUE_ID " to cache file %s.",
+            m_arguments.m_triangle_tree_uid,
+            path.c_str());
+        return;
+    }
+
+    RENDERER_LOG_INFO(
+        "wrote triangle tree #" FMT_UNIQUE_ID " to cache file %s.",
+        m_arguments.m_triangle_tree_uid,
+        path.c_str());
+}
+
 void TriangleTree::build_sbvh(
     const ParamArray&   params,
     const double        time,
@@ -655,7 +1066,11 @@ void TriangleTree::build_sbvh(
         plural(m_moving_triangle_count, "moving triangle").c_str());
 
     // Retrieving the partitioner parameters.
-    const size_t max_leaf_size = params.get_optional<size_t>("max_leaf_size", TriangleTreeDefaultMaxLeafSize);
+    const bool compact_leaves = params.get_optional<bool>("compact_leaves", TriangleTreeDefaultCompactLeaves);
+    const size_t max_leaf_size =
+        params.get_optional<size_t>(
+            "max_leaf_size",
+            compact_leaves ? TriangleTreeDefaultCompactMaxLeafSize : TriangleTreeDefaultMaxLeafSize);
     const size_t bin_count = params.get_optional<size_t>("bin_count", TriangleTreeDefaultBinCount);
     const GScalar interior_node_traversal_cost = params.get_optional<GScalar>("interior_node_traversal_cost", TriangleTreeDefaultInteriorNodeTraversalCost);
     const GScalar triangle_intersection_cost = params.get_optional<GScalar>("triangle_intersection_cost", TriangleTreeDefaultTriangleIntersectionCost);
@@ -715,6 +1130,7 @@ void TriangleTree::build_sbvh(
         triangle_vertex_infos,
         triangle_vertices,
         triangle_keys,
+        compact_leaves,
         statistics);
 
     const double storing_time = stopwatch.measure().get_seconds();
@@ -767,6 +1183,20 @@ namespace
     }
 
 #endif
+
+    // Interpolate a sequence of bounding boxes of equally spaced poses at a given time in [0,1].
+    GAABB3 interpolate_pose_bboxes(const vector<GAABB3>& bboxes, const double time)
+    {
+        const size_t segment_count = bboxes.size() - 1;
+
+        if (segment_count == 0)
+            return bboxes[0];
+
+        const size_t prev_index = min(truncate<size_t>(time * segment_count), segment_count - 1);
+        const GScalar k = static_cast<GScalar>(time * segment_count - prev_index);
+
+        return lerp(bboxes[prev_index], bboxes[prev_index + 1], k);
+    }
 }
 
 vector<GAABB3> TriangleTree::compute_motion_bboxes(
@@ -812,13 +1242,16 @@ vector<GAABB3> TriangleTree::compute_motion_bboxes(
                 m_node_bboxes.push_back(swizzle(AABB3d(*i)));
         }
 
+        // Motion segment counts are powers of two: the poses of the child with the fewest
+        // motion segments are interpolated at the times of the poses of the other child.
         const size_t bbox_count = max(left_bboxes.size(), right_bboxes.size());
         vector<GAABB3> bboxes(bbox_count);
 
         for (size_t i = 0; i < bbox_count; ++i)
         {
-            bboxes[i] = left_bboxes[i * left_bboxes.size() / bbox_count];
-            bboxes[i].insert(right_bboxes[i * right_bboxes.size() / bbox_count]);
+            const double time = bbox_count > 1 ? static_cast<double>(i) / (bbox_count - 1) : 0.0;
+            bboxes[i] = interpolate_pose_bboxes(left_bboxes, time);
+            bboxes[i].insert(interpolate_pose_bboxes(right_bboxes, time));
         }
 
         return bboxes;
@@ -897,16 +1330,20 @@ void TriangleTree::store_triangles(
     const vector<TriangleVertexInfo>&   triangle_vertex_infos,
     const vector<GVector3>&             triangle_vertices,
     const vector<TriangleKey>&          triangle_keys,
+    const bool                          compact_leaves,
     Statistics&                         statistics)
 {
     const size_t node_count = m_nodes.size();
 
-    // Gather statistics.
+    // Choose the format of each leaf and gather statistics.
 
     size_t leaf_count = 0;
     size_t fat_leaf_count = 0;
+    size_t compact_leaf_count = 0;
     size_t leaf_data_size = 0;
 
+    vector<uint8> is_compact_leaf(node_count, 0);
+
     for (size_t i = 0; i < node_count; ++i)
     {
         const NodeType& node = m_nodes[i];
@@ -918,14 +1355,36 @@ void TriangleTree::store_triangles(
             const size_t item_begin = node.get_item_index();
             const size_t item_count = node.get_item_count();
 
-            const size_t leaf_size =
-                TriangleEncoder::compute_size(
+            const bool compact =
+                compact_leaves &&
+                TriangleEncoder::is_compactable(
                     triangle_vertex_infos,
+                    triangle_vertices,
                     triangle_indices,
                     item_begin,
                     item_count);
 
-            if (leaf_size < NodeType::MaxUserDataSize)
+            const size_t leaf_size =
+                compact
+                    ? TriangleEncoder::compute_compact_size(
+                          triangle_vertex_infos,
+                          triangle_vertices,
+                          triangle_indices,
+                          item_begin,
+                          item_count)
+                    : TriangleEncoder::compute_size(
+                          triangle_vertex_infos,
+                          triangle_indices,
+                          item_begin,
+                          item_count);
+
+            if (compact)
+            {
+                is_compact_leaf[i] = 1;
+                ++compact_leaf_count;
+            }
+
+            if (leaf_size <= NodeType::MaxUserDataSize - sizeof(uint32))
                 ++fat_leaf_count;
             else leaf_data_size += leaf_size;
         }
@@ -955,43 +1414,65 @@ void TriangleTree::store_triangles(
                 m_triangle_keys.push_back(triangle_keys[triangle_index]);
             }
 
+            const bool compact = is_compact_leaf[i] != 0;
+
             const size_t leaf_size =
-                TriangleEncoder::compute_size(
-                    triangle_vertex_infos,
-                    triangle_indices,
-                    item_begin,
-                    item_count);
+                compact
+                    ? TriangleEncoder::compute_compact_size(
+                          triangle_vertex_infos,
+                          triangle_vertices,
+                          triangle_indices,
+                          item_begin,
+                          item_count)
+                    : TriangleEncoder::compute_size(
+                          triangle_vertex_infos,
+                          triangle_indices,
+                          item_begin,
+                          item_count);
 
             MemoryWriter user_data_writer(&node.get_user_data<uint8>());
+            MemoryWriter* writer;
 
             if (leaf_size <= NodeType::MaxUserDataSize - sizeof(uint32))
             {
                 user_data_writer.write<uint32>(~0);
+                writer = &user_data_writer;
+            }
+            else
+            {
+                user_data_writer.write(static_cast<uint32>(leaf_data_writer.offset()));
+                writer = &leaf_data_writer;
+            }
 
-                TriangleEncoder::encode(
+            if (compact)
+            {
+                TriangleEncoder::encode_compact(
                     triangle_vertex_infos,
                     triangle_vertices,
                     triangle_indices,
                     item_begin,
                     item_count,
-                    user_data_writer);
+                    *writer);
             }
             else
             {
-                user_data_writer.write(static_cast<uint32>(leaf_data_writer.offset()));
-
                 TriangleEncoder::encode(
                     triangle_vertex_infos,
                     triangle_vertices,
                     triangle_indices,
                     item_begin,
                     item_count,
-                    leaf_data_writer);
+                    *writer);
             }
         }
     }
 
     statistics.insert_percent("fat leaves", fat_leaf_count, leaf_count);
+
+    if (compact_leaves)
+        statistics.insert_percent("compact leaves", compact_leaf_count, leaf_count);
+
+    statistics.insert_size("leaf data size", m_leaf_data.size());
 }
 
 namespace
@@ -1182,7 +1663,7 @@ namespace
                 filter_key.m_materials.size(),
                 filter_key.m_materials.size() > 1 ? "s" : "",
                 pretty_size(intersection_filter->get_masks_memory_size()).c_str(),
-                pretty_size(intersection_filter->get_masks_memory_size()).c_str(),
+                pretty_size(intersection_filter->get_uv_memory_size()).c_str(),
                 filter_key_hash);
 
             // Store this intersection filter.
@@ -1303,12 +1784,36 @@ void TriangleTree::delete_intersection_filters()
 
 TriangleTreeFactory::TriangleTreeFactory(const TriangleTree::Arguments& arguments)
   : m_arguments(arguments)
+  , m_update_non_geometry(false)
+  , m_enable_intersection_filters(false)
 {
 }
 
 auto_ptr<TriangleTree> TriangleTreeFactory::create()
 {
-    return auto_ptr<TriangleTree>(new TriangleTree(m_arguments));
+    EventTraceScope trace_scope("intersection", "triangle tree", m_arguments.m_assembly.get_name());
+
+    Stopwatch<DefaultWallclockTimer> stopwatch(0);
+    stopwatch.start();
+
+    auto_ptr<TriangleTree> tree(new TriangleTree(m_arguments));
+
+    if (m_update_non_geometry)
+        tree->update_non_geometry(m_enable_intersection_filters);
+
+    stopwatch.measure();
+    global_startup_profiler().record_entity(
+        "triangle trees",
+        m_arguments.m_assembly.get_path().c_str(),
+        stopwatch.get_seconds());
+
+    return tree;
+}
+
+void TriangleTreeFactory::enable_non_geometry_update(const bool enable_intersection_filters)
+{
+    m_update_non_geometry = true;
+    m_enable_intersection_filters = enable_intersection_filters;
 }
 
 
@@ -1364,6 +1869,8 @@ bool TriangleLeafVisitor::visit(
 #endif
     )
 {
+    APPLESEED_HOT_PATH_COUNT(hot_path_counters().visit_leaf(node.get_item_count()));
+
     // Retrieve the pointer to the data of this leaf.
     const uint8* user_data = &node.get_user_data<uint8>();
     const uint32 leaf_data_index = *reinterpret_cast<const uint32*>(user_data);
@@ -1371,6 +1878,54 @@ bool TriangleLeafVisitor::visit(
         leaf_data_index == uint32(~0)
             ? user_data + sizeof(uint32)                // triangles are stored in the leaf node
             : &m_tree.m_leaf_data[leaf_data_index];     // triangles are stored in the tree
+
+    if (TriangleEncoder::is_compact(leaf_data))
+    {
+        const CompactTriangleLeafReader leaf_reader(leaf_data, node.get_item_count());
+
+        // Check visibility flags, shared by all triangles of the leaf.
+        if (leaf_reader.get_vis_flags() & m_shading_point.m_ray.m_flags)
+        {
+            // Sequentially intersect all triangles of the leaf.
+            for (size_t i = 0, triangle_count = node.get_item_count(); i < triangle_count; ++i)
+            {
+                FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(1));
+
+                // Decode the triangle and convert it to the right format if necessary.
+                const GTriangleType triangle = leaf_reader.get_triangle(i);
+                const TriangleReader triangle_reader(triangle);
+
+                // Intersect the triangle.
+                double t, u, v;
+                if (triangle_reader.m_triangle.intersect(ray, t, u, v))
+                {
+                    const size_t triangle_index = node.get_item_index() + i;
+
+                    // Optionally filter intersections.
+                    if (m_has_intersection_filters)
+                    {
+                        const TriangleKey& triangle_key = m_tree.m_triangle_keys[triangle_index];
+                        const IntersectionFilter* filter =
+                            m_tree.m_intersection_filters[triangle_key.get_object_instance_index()];
+                        if (filter && !filter->accept(triangle_key, u, v))
+                            continue;
+                    }
+
+                    m_interpolated_triangle = triangle;
+                    m_hit_triangle = &m_interpolated_triangle;
+                    m_hit_triangle_index = triangle_index;
+                    m_shading_point.m_ray.m_tmax = t;
+                    m_shading_point.m_bary[0] = static_cast<float>(u);
+                    m_shading_point.m_bary[1] = static_cast<float>(v);
+                }
+            }
+        }
+
+        // Continue traversal.
+        distance = m_shading_point.m_ray.m_tmax;
+        return true;
+    }
+
     MemoryReader reader(leaf_data);
 
     // Sequentially intersect all triangles of the leaf.
@@ -1494,9 +2049,9 @@ void TriangleLeafVisitor::read_hit_triangle_data() const
 
         // Copy the triangle key.
         const TriangleKey& triangle_key = m_tree.m_triangle_keys[m_hit_triangle_index];
-        m_shading_point.m_object_instance_index = triangle_key.get_object_instance_index();
-        m_shading_point.m_region_index = triangle_key.get_region_index();
-        m_shading_point.m_primitive_index = triangle_key.get_triangle_index();
+        m_shading_point.m_object_instance_index = static_cast<uint32>(triangle_key.get_object_instance_index());
+        m_shading_point.m_region_index = static_cast<uint32>(triangle_key.get_region_index());
+        m_shading_point.m_primitive_index = static_cast<uint32>(triangle_key.get_triangle_index());
 
         // Compute and store the support plane of the hit triangle.
         const TriangleReader reader(*m_hit_triangle);
@@ -1519,6 +2074,8 @@ bool TriangleLeafProbeVisitor::visit(
 #endif
     )
 {
+    APPLESEED_HOT_PATH_COUNT(hot_path_counters().visit_leaf(node.get_item_count()));
+
     // Retrieve the pointer to the data of this leaf.
     const uint8* user_data = &node.get_user_data<uint8>();
     const uint32 leaf_data_index = *reinterpret_cast<const uint32*>(user_data);
@@ -1526,6 +2083,40 @@ bool TriangleLeafProbeVisitor::visit(
         leaf_data_index == uint32(~0)
             ? user_data + sizeof(uint32)                // triangles are stored in the leaf node
             : &m_tree.m_leaf_data[leaf_data_index];     // triangles are stored in the tree
+
+    if (TriangleEncoder::is_compact(leaf_data))
+    {
+        const CompactTriangleLeafReader leaf_reader(leaf_data, node.get_item_count());
+
+        // Check visibility flags, shared by all triangles of the leaf.
+        if (leaf_reader.get_vis_flags() & m_ray_flags)
+        {
+            // Sequentially intersect triangles until a hit is found.
+            for (size_t i = 0, triangle_count = node.get_item_count(); i < triangle_count; ++i)
+            {
+                FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(1));
+
+                // Decode the triangle and convert it to the right format if necessary.
+                const GTriangleType triangle = leaf_reader.get_triangle(i);
+                const TriangleReader triangle_reader(triangle);
+
+                // Intersect the triangle.
+                if (triangle_reader.m_triangle.intersect(ray))
+                {
+                    m_hit = true;
+                    m_static_occluder = true;
+                    m_occluder = triangle_reader.m_triangle;
+                    m_occluder_vis_flags = leaf_reader.get_vis_flags();
+                    return false;
+                }
+            }
+        }
+
+        // Continue traversal.
+        distance = ray.m_tmax;
+        return true;
+    }
+
     MemoryReader reader(leaf_data);
 
     // Sequentially intersect triangles until a hit is found.
@@ -1557,6 +2148,9 @@ bool TriangleLeafProbeVisitor::visit(
             if (triangle_reader.m_triangle.intersect(ray))
             {
                 m_hit = true;
+                m_static_occluder = true;
+                m_occluder = triangle_reader.m_triangle;
+                m_occluder_vis_flags = vis_flags;
                 return false;
             }
         }
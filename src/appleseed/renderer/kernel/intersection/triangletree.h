@@ -47,13 +47,15 @@
 #include "foundation/platform/types.h"
 #include "foundation/utility/alignedvector.h"
 #include "foundation/utility/lazy.h"
-#include "foundation/utility/poolallocator.h"
+#include "foundation/utility/memoryaccounting.h"
+#include "foundation/utility/threadcachingpoolallocator.h"
 #include "foundation/utility/uid.h"
 
 // Standard headers.
 #include <cstddef>
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 // Forward declarations.
@@ -75,9 +77,12 @@ typedef std::map<foundation::uint64, IntersectionFilter*> IntersectionFilterRepo
 //
 
 class TriangleTree
-  : public foundation::bvh::Tree<
+  : public foundation::bvh::WideTree<
                foundation::AlignedVector<
                    foundation::bvh::Node<foundation::AABB3d>
+               >,
+               foundation::AlignedVector<
+                   foundation::bvh::WideNode<foundation::AABB3d, TriangleTreeWideNodeWidth>
                >
            >
 {
@@ -126,17 +131,35 @@ class TriangleTree
     size_t                                      m_moving_triangle_count;
 
     std::vector<TriangleKey>                    m_triangle_keys;
-    std::vector<foundation::uint8>              m_leaf_data;
+    foundation::AlignedVector<foundation::uint8> m_leaf_data;
 
     IntersectionFilterRepository                m_intersection_filters_repository;
     std::vector<const IntersectionFilter*>      m_intersection_filters;
 
+    foundation::MemoryAccount                   m_memory_account;
+
     void build_bvh(
         const ParamArray&                       params,
         const double                            time,
         const bool                              save_memory,
+        const bool                              binned,
         foundation::Statistics&                 statistics);
 
+    // Compute a key identifying the geometry and the construction parameters of this tree.
+    foundation::uint64 compute_cache_key(
+        const ParamArray&                       params,
+        const double                            time) const;
+
+    // Load the tree from a cache file. Return false if the file is missing or doesn't match.
+    bool load_from_cache(
+        const std::string&                      path,
+        const foundation::uint64                cache_key);
+
+    // Store the tree into a cache file.
+    void save_to_cache(
+        const std::string&                      path,
+        const foundation::uint64                cache_key) const;
+
     void build_sbvh(
         const ParamArray&                       params,
         const double                            time,
@@ -154,6 +177,7 @@ class TriangleTree
         const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
         const std::vector<GVector3>&            triangle_vertices,
         const std::vector<TriangleKey>&         triangle_keys,
+        const bool                              compact_leaves,
         foundation::Statistics&                 statistics);
 
     void update_intersection_filters();
@@ -176,8 +200,13 @@ class TriangleTreeFactory
     // Create the triangle tree.
     virtual std::auto_ptr<TriangleTree> create();
 
+    // Make create() also update the non-geometry data of the trees it creates.
+    void enable_non_geometry_update(const bool enable_intersection_filters);
+
   private:
     TriangleTree::Arguments m_arguments;
+    bool                    m_update_non_geometry;
+    bool                    m_enable_intersection_filters;
 };
 
 
@@ -198,7 +227,7 @@ typedef foundation::AccessCacheMap<
     TriangleTreeContainer,
     TriangleTreeAccessCacheLines,
     TriangleTreeAccessCacheWays,
-    foundation::PoolAllocator<void, TriangleTreeAccessCacheLines * TriangleTreeAccessCacheWays>
+    foundation::ThreadCachingPoolAllocator<void, TriangleTreeAccessCacheLines * TriangleTreeAccessCacheWays>
 > TriangleTreeAccessCache;
 
 
@@ -265,11 +294,21 @@ class TriangleLeafProbeVisitor
 #endif
         );
 
+    // Return whether the triangle that was hit is static, and can thus be cached.
+    bool has_static_occluder() const;
+
+    // Return the triangle that was hit, in assembly space, and its visibility flags.
+    const TriangleType& get_occluder() const;
+    foundation::uint32 get_occluder_vis_flags() const;
+
   private:
     const TriangleTree&         m_tree;
     const double                m_ray_time;
     const VisibilityFlags::Type m_ray_flags;
     const bool                  m_has_intersection_filters;
+    bool                        m_static_occluder;
+    TriangleType                m_occluder;
+    foundation::uint32          m_occluder_vis_flags;
 };
 
 
@@ -291,6 +330,20 @@ typedef foundation::bvh::Intersector<
     TriangleTreeStackSize
 > TriangleTreeProbeIntersector;
 
+typedef foundation::bvh::WideIntersector<
+    TriangleTree,
+    TriangleLeafVisitor,
+    foundation::Ray3d,
+    TriangleTreeWideStackSize
+> TriangleTreeWideIntersector;
+
+typedef foundation::bvh::WideIntersector<
+    TriangleTree,
+    TriangleLeafProbeVisitor,
+    foundation::Ray3d,
+    TriangleTreeWideStackSize
+> TriangleTreeWideProbeIntersector;
+
 
 //
 // TriangleTree class implementation.
@@ -334,7 +387,24 @@ inline TriangleLeafProbeVisitor::TriangleLeafProbeVisitor(
   , m_ray_time(ray_time)
   , m_ray_flags(ray_flags)
   , m_has_intersection_filters(!tree.m_intersection_filters.empty())
+  , m_static_occluder(false)
+  , m_occluder_vis_flags(0)
+{
+}
+
+inline bool TriangleLeafProbeVisitor::has_static_occluder() const
+{
+    return m_static_occluder;
+}
+
+inline const TriangleType& TriangleLeafProbeVisitor::get_occluder() const
+{
+    return m_occluder;
+}
+
+inline foundation::uint32 TriangleLeafProbeVisitor::get_occluder_vis_flags() const
 {
+    return m_occluder_vis_flags;
 }
 
 }       // namespace renderer
@@ -0,0 +1,137 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "brightnessmap.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/atomic.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Width and height of a block, in pixels.
+    const size_t BlockSize = 8;
+
+    // Number of paths that must go through a block before its estimate becomes available.
+    const uint32 MinBlockPathCount = 64;
+
+    // Number of paths that must be recorded before the estimate of the image becomes available.
+    const size_t MinImagePathCount = 4096;
+}
+
+BrightnessMap::BrightnessMap(
+    const size_t    canvas_width,
+    const size_t    canvas_height)
+  : m_canvas_width(canvas_width)
+  , m_canvas_height(canvas_height)
+  , m_block_count_x((canvas_width + BlockSize - 1) / BlockSize)
+  , m_image_luminance_sum(0.0)
+  , m_image_path_count(0)
+  , m_image_luminance(0.0f)
+{
+    const size_t block_count_y = (canvas_height + BlockSize - 1) / BlockSize;
+
+    Block block;
+    block.m_luminance_sum = 0.0f;
+    block.m_path_count = 0;
+
+    m_blocks.assign(m_block_count_x * block_count_y, block);
+}
+
+void BrightnessMap::record_path(
+    const size_t    x,
+    const size_t    y,
+    const float     luminance)
+{
+    Block& block = get_block(x, y);
+
+    atomic_add(&block.m_luminance_sum, luminance);
+    atomic_inc(&block.m_path_count);
+}
+
+void BrightnessMap::record_image_paths(
+    const double    luminance_sum,
+    const size_t    path_count)
+{
+    boost::mutex::scoped_lock lock(m_image_mutex);
+
+    m_image_luminance_sum += luminance_sum;
+    m_image_path_count += path_count;
+
+    if (m_image_path_count >= MinImagePathCount)
+        m_image_luminance = static_cast<float>(m_image_luminance_sum / m_image_path_count);
+}
+
+float BrightnessMap::get_pixel_luminance(
+    const size_t    x,
+    const size_t    y) const
+{
+    const Block& block = get_block(x, y);
+
+    const uint32 path_count = atomic_read(const_cast<volatile uint32*>(&block.m_path_count));
+
+    return path_count >= MinBlockPathCount
+        ? block.m_luminance_sum / path_count
+        : 0.0f;
+}
+
+float BrightnessMap::get_image_luminance() const
+{
+    return m_image_luminance;
+}
+
+BrightnessMap::Block& BrightnessMap::get_block(
+    const size_t    x,
+    const size_t    y)
+{
+    return
+        const_cast<Block&>(
+            const_cast<const BrightnessMap*>(this)->get_block(x, y));
+}
+
+const BrightnessMap::Block& BrightnessMap::get_block(
+    const size_t    x,
+    const size_t    y) const
+{
+    const size_t bx = min(x, m_canvas_width - 1) / BlockSize;
+    const size_t by = min(y, m_canvas_height - 1) / BlockSize;
+
+    return m_blocks[by * m_block_count_x + bx];
+}
+
+}   // namespace renderer
@@ -0,0 +1,108 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_BRIGHTNESSMAP_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_BRIGHTNESSMAP_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A coarse estimate of the brightness of the image, learned from the luminance of the
+// paths traced so far. The image is divided into blocks of pixels; the estimate of a
+// block becomes available once enough paths went through it, and remains available
+// from one rendering pass to the next.
+//
+
+class BrightnessMap
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    BrightnessMap(
+        const size_t                canvas_width,
+        const size_t                canvas_height);
+
+    // Record the luminance of a path traced through a given pixel. Thread-safe.
+    void record_path(
+        const size_t                x,
+        const size_t                y,
+        const float                 luminance);
+
+    // Record the total luminance of a batch of paths traced anywhere in the image. Thread-safe.
+    void record_image_paths(
+        const double                luminance_sum,
+        const size_t                path_count);
+
+    // Return the estimated average luminance of the paths traced through a given pixel,
+    // or 0 if not enough paths were recorded there yet. Thread-safe.
+    float get_pixel_luminance(
+        const size_t                x,
+        const size_t                y) const;
+
+    // Return the estimated average luminance of the paths traced through the image,
+    // or 0 if not enough paths were recorded yet. Thread-safe.
+    float get_image_luminance() const;
+
+  private:
+    struct Block
+    {
+        volatile float              m_luminance_sum;
+        volatile foundation::uint32 m_path_count;
+    };
+
+    const size_t                    m_canvas_width;
+    const size_t                    m_canvas_height;
+    const size_t                    m_block_count_x;
+    std::vector<Block>              m_blocks;
+    double                          m_image_luminance_sum;
+    size_t                          m_image_path_count;
+    volatile float                  m_image_luminance;      // average luminance of the image, 0 if unknown
+    boost::mutex                    m_image_mutex;
+
+    Block& get_block(
+        const size_t                x,
+        const size_t                y);
+
+    const Block& get_block(
+        const size_t                x,
+        const size_t                y) const;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_BRIGHTNESSMAP_H
@@ -42,11 +42,14 @@
 #include "renderer/modeling/light/light.h"
 #include "renderer/modeling/material/material.h"
 #include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/hotpathcounters.h"
+#include "renderer/utility/shadingprofiler.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/scalar.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -66,11 +69,19 @@ namespace renderer
 //
 //   compute_outgoing_radiance_light_sampling
 //       add_emitting_triangle_sample_contribution
+//           add_light_sample_contribution
 //       add_non_physical_light_sample_contribution
+//           add_light_sample_contribution
+//       trace_shadow_ray_batch
+//           evaluate_deferred_emissions
 //
 //   compute_outgoing_radiance_light_sampling_low_variance
 //       add_emitting_triangle_sample_contribution
+//           add_light_sample_contribution
 //       add_non_physical_light_sample_contribution
+//           add_light_sample_contribution
+//       trace_shadow_ray_batch
+//           evaluate_deferred_emissions
 //
 //   compute_outgoing_radiance_combined_sampling
 //       compute_outgoing_radiance_bsdf_sampling
@@ -93,7 +104,8 @@ DirectLightingIntegrator::DirectLightingIntegrator(
     const int                   light_sampling_modes,
     const size_t                bsdf_sample_count,
     const size_t                light_sample_count,
-    const bool                  indirect)
+    const bool                  indirect,
+    ShadowRayBatch*             shadow_ray_batch)
   : m_shading_context(shading_context)
   , m_light_sampler(light_sampler)
   , m_shading_point(shading_point)
@@ -108,6 +120,7 @@ DirectLightingIntegrator::DirectLightingIntegrator(
   , m_bsdf_sample_count(bsdf_sample_count)
   , m_light_sample_count(light_sample_count)
   , m_indirect(indirect)
+  , m_shadow_ray_batch(shadow_ray_batch)
 {
 }
 
@@ -154,7 +167,7 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling(
     aovs.set(0.0f);
 
     // No light source in the scene.
-    if (!m_light_sampler.has_lights_or_emitting_triangles())
+    if (!m_light_sampler.has_lights_or_emitting_triangles(m_shading_point))
         return;
 
     // There cannot be any contribution for purely specular BSDFs.
@@ -171,6 +184,7 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling(
         m_light_sampler.sample(
             m_time,
             sampling_context.next2<Vector3f>(),
+            m_shading_point,
             sample);
 
         if (sample.m_triangle)
@@ -192,6 +206,8 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling(
         }
     }
 
+    trace_shadow_ray_batch(radiance, aovs);
+
     if (m_light_sample_count > 1)
     {
         const float rcp_light_sample_count = 1.0f / m_light_sample_count;
@@ -211,7 +227,7 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
     aovs.set(0.0f);
 
     // No light source in the scene.
-    if (!m_light_sampler.has_lights_or_emitting_triangles())
+    if (!m_light_sampler.has_lights_or_emitting_triangles(m_shading_point))
         return;
 
     // There cannot be any contribution for purely specular BSDFs.
@@ -219,7 +235,7 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
         return;
 
     // Add contributions from emitting triangles only.
-    if (m_light_sampler.get_emitting_triangle_count() > 0)
+    if (m_light_sampler.has_emitting_triangles(m_shading_point))
     {
         sampling_context.split_in_place(3, m_light_sample_count);
 
@@ -230,6 +246,7 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
             m_light_sampler.sample_emitting_triangles(
                 m_time,
                 sampling_context.next2<Vector3f>(),
+                m_shading_point,
                 sample);
 
             add_emitting_triangle_sample_contribution(
@@ -240,6 +257,8 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
                 aovs);
         }
 
+        trace_shadow_ray_batch(radiance, aovs);
+
         if (m_light_sample_count > 1)
         {
             const float rcp_light_sample_count = 1.0f / m_light_sample_count;
@@ -251,6 +270,10 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
     // Add contributions from non-physical light sources only.
     for (size_t i = 0, e = m_light_sampler.get_non_physical_light_count(); i < e; ++i)
     {
+        // Skip lights excluded by light linking.
+        if (!m_light_sampler.illuminates(i, m_shading_point))
+            continue;
+
         LightSample sample;
         m_light_sampler.sample_non_physical_light(m_time, i, sample);
 
@@ -260,6 +283,8 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
             radiance,
             aovs);
     }
+
+    trace_shadow_ray_batch(radiance, aovs);
 }
 
 void DirectLightingIntegrator::compute_outgoing_radiance_combined_sampling(
@@ -325,7 +350,7 @@ bool DirectLightingIntegrator::compute_incoming_radiance(
     radiance.set(0.0f);
 
     // No light source in the scene.
-    if (!m_light_sampler.has_lights_or_emitting_triangles())
+    if (!m_light_sampler.has_lights_or_emitting_triangles(m_shading_point))
         return false;
 
     sampling_context.split_in_place(3, 1);
@@ -335,6 +360,7 @@ bool DirectLightingIntegrator::compute_incoming_radiance(
     m_light_sampler.sample(
         m_time,
         sampling_context.next2<Vector3f>(),
+        m_shading_point,
         sample);
 
     if (sample.m_triangle)
@@ -458,12 +484,15 @@ void DirectLightingIntegrator::take_single_bsdf_sample(
 
     // Sample the BSDF.
     BSDFSample sample(&m_shading_point, Dual3f(outgoing));
-    m_bsdf.sample(
-        sampling_context,
-        m_bsdf_data,
-        false,                  // not adjoint
-        true,                   // multiply by |cos(incoming, normal)|
-        sample);
+    {
+        ShadingProfileScope profile_scope(ShadingProfile::BSDFModels, m_bsdf.get_model());
+        m_bsdf.sample(
+            sampling_context,
+            m_bsdf_data,
+            false,                  // not adjoint
+            true,                   // multiply by |cos(incoming, normal)|
+            sample);
+    }
 
     // Filter scattering modes.
     if (!(m_bsdf_sampling_modes & sample.m_mode))
@@ -497,6 +526,10 @@ void DirectLightingIntegrator::take_single_bsdf_sample(
     if (m_indirect && !(edf->get_flags() & EDF::CastIndirectLight))
         return;
 
+    // No contribution if this light does not illuminate the shading point.
+    if (!m_light_sampler.illuminates(light_shading_point, &m_shading_point.get_object_instance()))
+        return;
+
     // Cull the samples on the back side of the lights' shading surface.
     const float cos_on = dot(-sample.m_incoming.get_value(), Vector3f(light_shading_point.get_shading_normal()));
     if (cos_on <= 0.0f)
@@ -537,7 +570,8 @@ void DirectLightingIntegrator::take_single_bsdf_sample(
             const float bsdf_prob_area = sample.m_probability * cos_on / static_cast<float>(square_distance);
 
             // Compute the probability density wrt. surface area mesure of the light sample.
-            const float light_prob_area = m_light_sampler.evaluate_pdf(light_shading_point);
+            const float light_prob_area =
+                m_light_sampler.evaluate_pdf(light_shading_point, &m_shading_point.get_object_instance());
 
             // Apply the weighting function.
             weight *=
@@ -590,16 +624,21 @@ void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
     if (cos_on <= 0.0)
         return;
 
-    // Compute the transmission factor between the light sample and the shading point.
-    const float transmission =
-        m_shading_context.get_tracer().trace_between(
-            m_shading_point,
-            sample.m_point,
-            VisibilityFlags::ShadowRay);
+    // Compute the transmission factor between the light sample and the shading point,
+    // unless the shadow ray is deferred until all light samples have been evaluated.
+    float transmission = 1.0f;
+    if (m_shadow_ray_batch == 0)
+    {
+        transmission =
+            m_shading_context.get_tracer().trace_between(
+                m_shading_point,
+                sample.m_point,
+                VisibilityFlags::ShadowRay);
 
-    // Discard occluded samples.
-    if (transmission == 0.0f)
-        return;
+        // Discard occluded samples.
+        if (transmission == 0.0f)
+            return;
+    }
 
     // Compute the square distance between the light sample and the shading point.
     const double square_distance = square_norm(incoming);
@@ -615,21 +654,59 @@ void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
     cos_on *= rcp_sample_distance;
 
     // Evaluate the BSDF.
+    APPLESEED_HOT_PATH_COUNT(hot_path_counters().m_bsdf_evaluations.increment(m_bsdf.get_model()));
     Spectrum bsdf_value;
-    const float bsdf_prob =
-        m_bsdf.evaluate(
-            m_bsdf_data,
-            false,              // not adjoint
-            true,               // multiply by |cos(incoming, normal)|
-            Vector3f(m_geometric_normal),
-            Basis3f(m_shading_basis),
-            Vector3f(outgoing.get_value()),
-            Vector3f(incoming),
-            m_light_sampling_modes,
-            bsdf_value);
+    float bsdf_prob;
+    {
+        ShadingProfileScope profile_scope(ShadingProfile::BSDFModels, m_bsdf.get_model());
+        bsdf_prob =
+            m_bsdf.evaluate(
+                m_bsdf_data,
+                false,              // not adjoint
+                true,               // multiply by |cos(incoming, normal)|
+                Vector3f(m_geometric_normal),
+                Basis3f(m_shading_basis),
+                Vector3f(outgoing.get_value()),
+                Vector3f(incoming),
+                m_light_sampling_modes,
+                bsdf_value);
+    }
     if (bsdf_prob == 0.0f)
         return;
 
+    const float g = static_cast<float>(cos_on * rcp_sample_square_distance);
+    float weight = transmission * g / sample.m_probability;
+
+    // Apply MIS weighting.
+    weight *=
+        mis(
+            mis_heuristic,
+            m_light_sample_count * sample.m_probability,
+            m_bsdf_sample_count * bsdf_prob * g);
+
+    // Defer the evaluation of lights with an OSL shader group until all light samples are known.
+    if (m_shadow_ray_batch && material_data.m_shader_group)
+    {
+        ShadowRayBatch& batch = *m_shadow_ray_batch;
+        if (batch.m_emission_count == batch.m_emissions.size())
+            batch.m_emissions.resize(batch.m_emission_count + 1);
+
+        DeferredEmission& emission = batch.m_emissions[batch.m_emission_count++];
+        sample.make_shading_point(
+            emission.m_light_shading_point,
+            sample.m_shading_normal,
+            m_shading_context.get_intersector());
+        emission.m_shader_group = material_data.m_shader_group;
+        emission.m_edf = edf;
+        emission.m_geometric_normal = Vector3f(sample.m_geometric_normal);
+        emission.m_shading_normal = Vector3f(sample.m_shading_normal);
+        emission.m_outgoing = -Vector3f(incoming);
+        emission.m_weight = bsdf_value;
+        emission.m_weight *= weight;
+        emission.m_target = sample.m_point;
+        return;
+    }
+
     // Build a shading point on the light source.
     ShadingPoint light_shading_point;
     sample.make_shading_point(
@@ -653,21 +730,15 @@ void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
         -Vector3f(incoming),
         edf_value);
 
-    const float g = static_cast<float>(cos_on * rcp_sample_square_distance);
-    float weight = transmission * g / sample.m_probability;
-
-    // Apply MIS weighting.
-    weight *=
-        mis(
-            mis_heuristic,
-            m_light_sample_count * sample.m_probability,
-            m_bsdf_sample_count * bsdf_prob * g);
-
     // Add the contribution of this sample to the illumination.
     edf_value *= weight;
     edf_value *= bsdf_value;
-    radiance += edf_value;
-    aovs.add(edf->get_render_layer_index(), edf_value);
+    add_light_sample_contribution(
+        sample.m_point,
+        edf->get_render_layer_index(),
+        edf_value,
+        radiance,
+        aovs);
 }
 
 void DirectLightingIntegrator::add_non_physical_light_sample_contribution(
@@ -707,30 +778,40 @@ void DirectLightingIntegrator::add_non_physical_light_sample_contribution(
             return;
     }
 
-    // Compute the transmission factor between the light sample and the shading point.
-    const float transmission =
-        m_shading_context.get_tracer().trace_between(
-            m_shading_point,
-            emission_position,
-            VisibilityFlags::ShadowRay);
+    // Compute the transmission factor between the light sample and the shading point,
+    // unless the shadow ray is deferred until all light samples have been evaluated.
+    float transmission = 1.0f;
+    if (m_shadow_ray_batch == 0)
+    {
+        transmission =
+            m_shading_context.get_tracer().trace_between(
+                m_shading_point,
+                emission_position,
+                VisibilityFlags::ShadowRay);
 
-    // Discard occluded samples.
-    if (transmission == 0.0f)
-        return;
+        // Discard occluded samples.
+        if (transmission == 0.0f)
+            return;
+    }
 
     // Evaluate the BSDF.
+    APPLESEED_HOT_PATH_COUNT(hot_path_counters().m_bsdf_evaluations.increment(m_bsdf.get_model()));
     Spectrum bsdf_value;
-    const float bsdf_prob =
-        m_bsdf.evaluate(
-            m_bsdf_data,
-            false,              // not adjoint
-            true,               // multiply by |cos(incoming, normal)|
-            Vector3f(m_geometric_normal),
-            Basis3f(m_shading_basis),
-            Vector3f(outgoing.get_value()),
-            Vector3f(incoming),
-            m_light_sampling_modes,
-            bsdf_value);
+    float bsdf_prob;
+    {
+        ShadingProfileScope profile_scope(ShadingProfile::BSDFModels, m_bsdf.get_model());
+        bsdf_prob =
+            m_bsdf.evaluate(
+                m_bsdf_data,
+                false,              // not adjoint
+                true,               // multiply by |cos(incoming, normal)|
+                Vector3f(m_geometric_normal),
+                Basis3f(m_shading_basis),
+                Vector3f(outgoing.get_value()),
+                Vector3f(incoming),
+                m_light_sampling_modes,
+                bsdf_value);
+    }
     if (bsdf_prob == 0.0f)
         return;
 
@@ -739,8 +820,136 @@ void DirectLightingIntegrator::add_non_physical_light_sample_contribution(
     const float weight = transmission * attenuation / sample.m_probability;
     light_value *= weight;
     light_value *= bsdf_value;
-    radiance += light_value;
-    aovs.add(light->get_render_layer_index(), light_value);
+    add_light_sample_contribution(
+        emission_position,
+        light->get_render_layer_index(),
+        light_value,
+        radiance,
+        aovs);
+}
+
+void DirectLightingIntegrator::add_light_sample_contribution(
+    const Vector3d&             target,
+    const size_t                render_layer_index,
+    const Spectrum&             contribution,
+    Spectrum&                   radiance,
+    SpectrumStack&              aovs) const
+{
+    if (m_shadow_ray_batch)
+    {
+        // Samples that cannot contribute don't need a shadow ray.
+        if (is_zero(contribution))
+            return;
+
+        // Defer the shadow ray; the contribution will be added by trace_shadow_ray_batch().
+        DeferredShadowRay shadow_ray;
+        shadow_ray.m_contribution = contribution;
+        shadow_ray.m_target = target;
+        shadow_ray.m_render_layer_index = render_layer_index;
+        m_shadow_ray_batch->m_shadow_rays.push_back(shadow_ray);
+    }
+    else
+    {
+        radiance += contribution;
+        aovs.add(render_layer_index, contribution);
+    }
+}
+
+void DirectLightingIntegrator::evaluate_deferred_emissions() const
+{
+    ShadowRayBatch& batch = *m_shadow_ray_batch;
+    const size_t emission_count = batch.m_emission_count;
+
+    for (size_t i = 0; i < emission_count; ++i)
+    {
+        const ShaderGroup* shader_group = batch.m_emissions[i].m_shader_group;
+        if (shader_group == 0)
+            continue;
+
+        // Execute this shader group on all the light samples that use it.
+        for (size_t j = i; j < emission_count; ++j)
+        {
+            DeferredEmission& emission = batch.m_emissions[j];
+            if (emission.m_shader_group != shader_group)
+                continue;
+
+            m_shading_context.execute_osl_emission(
+                *shader_group,
+                emission.m_light_shading_point);
+            emission.m_shader_group = 0;
+
+            // Evaluate the EDF before the closures are overwritten by the next execution.
+            Spectrum edf_value(Spectrum::Illuminance);
+            emission.m_edf->evaluate(
+                emission.m_edf->evaluate_inputs(m_shading_context, emission.m_light_shading_point),
+                emission.m_geometric_normal,
+                Basis3f(emission.m_shading_normal),
+                emission.m_outgoing,
+                edf_value);
+
+            // Queue the shadow ray of this sample.
+            edf_value *= emission.m_weight;
+            if (!is_zero(edf_value))
+            {
+                DeferredShadowRay shadow_ray;
+                shadow_ray.m_contribution = edf_value;
+                shadow_ray.m_target = emission.m_target;
+                shadow_ray.m_render_layer_index = emission.m_edf->get_render_layer_index();
+                batch.m_shadow_rays.push_back(shadow_ray);
+            }
+        }
+    }
+
+    batch.m_emission_count = 0;
+}
+
+void DirectLightingIntegrator::trace_shadow_ray_batch(
+    Spectrum&                   radiance,
+    SpectrumStack&              aovs) const
+{
+    if (m_shadow_ray_batch == 0)
+        return;
+
+    evaluate_deferred_emissions();
+
+    Tracer& tracer = m_shading_context.get_tracer();
+
+    const size_t ChunkSize = 64;
+    Vector3d targets[ChunkSize];
+    float transmissions[ChunkSize];
+
+    const size_t shadow_ray_count = m_shadow_ray_batch->m_shadow_rays.size();
+
+    for (size_t first = 0; first < shadow_ray_count; first += ChunkSize)
+    {
+        const size_t chunk_size = min(shadow_ray_count - first, ChunkSize);
+
+        // Compute the transmission factors between the light samples and the shading point.
+        for (size_t i = 0; i < chunk_size; ++i)
+            targets[i] = m_shadow_ray_batch->m_shadow_rays[first + i].m_target;
+        tracer.trace_between_batch(
+            m_shading_point,
+            chunk_size,
+            targets,
+            VisibilityFlags::ShadowRay,
+            transmissions);
+
+        for (size_t i = 0; i < chunk_size; ++i)
+        {
+            // Discard occluded samples.
+            const float transmission = transmissions[i];
+            if (transmission == 0.0f)
+                continue;
+
+            // Add the contribution of this sample to the illumination.
+            DeferredShadowRay& shadow_ray = m_shadow_ray_batch->m_shadow_rays[first + i];
+            shadow_ray.m_contribution *= transmission;
+            radiance += shadow_ray.m_contribution;
+            aovs.add(shadow_ray.m_render_layer_index, shadow_ray.m_contribution);
+        }
+    }
+
+    m_shadow_ray_batch->m_shadow_rays.clear();
 }
 
 }   // namespace renderer
@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
 
 // appleseed.foundation headers.
@@ -39,14 +40,17 @@
 #include "foundation/math/dual.h"
 #include "foundation/math/mis.h"
 #include "foundation/math/vector.h"
+#include "foundation/utility/alignedvector.h"
 
 // Standard headers.
 #include <cstddef>
 
 // Forward declarations.
 namespace renderer  { class BSDF; }
+namespace renderer  { class EDF; }
 namespace renderer  { class LightSample; }
 namespace renderer  { class LightSampler; }
+namespace renderer  { class ShaderGroup; }
 namespace renderer  { class ShadingContext; }
 namespace renderer  { class ShadingPoint; }
 namespace renderer  { class SpectrumStack; }
@@ -68,10 +72,57 @@ namespace renderer
 //   The number of shadow rays cast by these functions may be as high as the number of light
 //   samples passed to the constructor plus the number of non-physical lights in the scene.
 //
+// Note about batched shadow rays:
+//
+//   When a shadow ray batch is passed to the constructor, the light sampling methods first
+//   evaluate the BSDF and the EDF for all light samples, discard samples that don't contribute,
+//   and only then trace the shadow rays of the remaining samples, one after the other. This
+//   keeps shading and ray traversal apart and avoids tracing shadow rays for samples that
+//   would be culled anyway, at the expense of evaluating the EDF of occluded samples.
+//
+//   The emission of lights with an OSL shader group is deferred as well: light samples are
+//   grouped by shader group, and each group is executed on all its samples back to back
+//   before its EDFs are evaluated. Closures are consumed right after each execution since
+//   OSL reuses their storage from one execution to the next.
+//
 
 class DirectLightingIntegrator
 {
   public:
+    // A light sample whose shadow ray has not been traced yet.
+    struct DeferredShadowRay
+    {
+        Spectrum                        m_contribution;             // contribution of the sample if unoccluded
+        foundation::Vector3d            m_target;                   // world space target point of the shadow ray
+        size_t                          m_render_layer_index;       // AOV receiving the contribution
+    };
+
+    // A light sample on a light with an OSL shader group, whose emission has not been evaluated yet.
+    struct DeferredEmission
+    {
+        ShadingPoint                    m_light_shading_point;
+        const ShaderGroup*              m_shader_group;             // 0 once the shader group has been executed
+        const EDF*                      m_edf;
+        foundation::Vector3f            m_geometric_normal;         // world space geometric normal at the light sample
+        foundation::Vector3f            m_shading_normal;           // world space shading normal at the light sample
+        foundation::Vector3f            m_outgoing;                 // world space direction from the light sample to the shading point
+        Spectrum                        m_weight;                   // BSDF value times sample weight
+        foundation::Vector3d            m_target;                   // world space target point of the shadow ray
+    };
+
+    // Storage for light samples deferred during light sampling, reused from one shading point to the next.
+    struct ShadowRayBatch
+    {
+        foundation::AlignedVector<DeferredShadowRay>    m_shadow_rays;
+        foundation::AlignedVector<DeferredEmission>     m_emissions;        // only grows, to reuse its shading points
+        size_t                                          m_emission_count;
+
+        ShadowRayBatch()
+          : m_emission_count(0)
+        {
+        }
+    };
+
     // Constructor.
     DirectLightingIntegrator(
         const ShadingContext&           shading_context,
@@ -83,7 +134,8 @@ class DirectLightingIntegrator
         const int                       light_sampling_modes,       // permitted scattering modes during environment sampling
         const size_t                    bsdf_sample_count,          // number of samples in BSDF sampling
         const size_t                    light_sample_count,         // number of samples in light sampling
-        const bool                      indirect);                  // are we computing indirect lighting?
+        const bool                      indirect,                   // are we computing indirect lighting?
+        ShadowRayBatch*                 shadow_ray_batch);          // storage for batched shadow rays, 0 to trace them immediately
 
     // Compute outgoing radiance due to direct lighting via combined BSDF and light sampling.
     void compute_outgoing_radiance_combined_sampling(
@@ -141,6 +193,7 @@ class DirectLightingIntegrator
     const size_t                        m_bsdf_sample_count;
     const size_t                        m_light_sample_count;
     const bool                          m_indirect;
+    ShadowRayBatch*                     m_shadow_ray_batch;
 
     void take_single_bsdf_sample(
         SamplingContext&                sampling_context,
@@ -161,6 +214,19 @@ class DirectLightingIntegrator
         const foundation::Dual3d&       outgoing,
         Spectrum&                       radiance,
         SpectrumStack&                  aovs) const;
+
+    void add_light_sample_contribution(
+        const foundation::Vector3d&     target,
+        const size_t                    render_layer_index,
+        const Spectrum&                 contribution,
+        Spectrum&                       radiance,
+        SpectrumStack&                  aovs) const;
+
+    void evaluate_deferred_emissions() const;
+
+    void trace_shadow_ray_batch(
+        Spectrum&                       radiance,
+        SpectrumStack&                  aovs) const;
 };
 
 }       // namespace renderer
@@ -35,24 +35,34 @@
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/aov/spectrumstack.h"
 #include "renderer/kernel/lighting/directlightingintegrator.h"
+#include "renderer/kernel/lighting/environmentimportancemap.h"
 #include "renderer/kernel/lighting/imagebasedlighting.h"
+#include "renderer/kernel/lighting/irradiancecache.h"
 #include "renderer/kernel/lighting/pathtracer.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
 #include "renderer/modeling/bsdf/bsdf.h"
 #include "renderer/modeling/edf/edf.h"
 #include "renderer/modeling/environment/environment.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
 #include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/hotpathcounters.h"
 #include "renderer/utility/stochasticcast.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/basis.h"
 #include "foundation/math/mis.h"
 #include "foundation/math/population.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
+#include "foundation/utility/alignedvector.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/string.h"
@@ -61,6 +71,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <limits>
 #include <string>
 
 // Forward declarations.
@@ -93,6 +104,16 @@ namespace
             const float     m_dl_light_sample_count;        // number of light samples used to estimate direct illumination
             const float     m_ibl_env_sample_count;         // number of environment samples used to estimate IBL
 
+            const bool      m_ibl_importance_map;           // sample the environment from a precomputed importance map?
+            const size_t    m_ibl_importance_map_width;     // width of the importance map, its height is half of it
+            const bool      m_ibl_mis_compensation;         // apply MIS compensation to the importance map?
+
+            const bool      m_enable_irradiance_cache;      // is the irradiance cache used for diffuse indirect lighting?
+            const size_t    m_ic_sample_count;              // number of rays used to compute an irradiance record
+            const float     m_ic_max_error;                 // maximum interpolation error of the irradiance cache
+            const float     m_ic_min_spacing;               // minimum spacing between irradiance records, relative to the scene diameter
+            const float     m_ic_max_spacing;               // maximum spacing between irradiance records, relative to the scene diameter
+
             float           m_rcp_dl_light_sample_count;
             float           m_rcp_ibl_env_sample_count;
 
@@ -102,6 +123,14 @@ namespace
               , m_rr_min_path_length(nz(params.get_optional<size_t>("rr_min_path_length", 6)))
               , m_dl_light_sample_count(params.get_optional<float>("dl_light_samples", 1.0f))
               , m_ibl_env_sample_count(params.get_optional<float>("ibl_env_samples", 1.0f))
+              , m_ibl_importance_map(params.get_optional<bool>("ibl_importance_map", false))
+              , m_ibl_importance_map_width(max<size_t>(params.get_optional<size_t>("ibl_importance_map_resolution", 256), 2))
+              , m_ibl_mis_compensation(params.get_optional<bool>("ibl_mis_compensation", true))
+              , m_enable_irradiance_cache(params.get_optional<bool>("enable_irradiance_cache", false))
+              , m_ic_sample_count(max<size_t>(params.get_optional<size_t>("ic_samples", 64), 1))
+              , m_ic_max_error(clamp(params.get_optional<float>("ic_max_error", 0.3f), 0.01f, 1.0f))
+              , m_ic_min_spacing(params.get_optional<float>("ic_min_spacing", 0.001f))
+              , m_ic_max_spacing(params.get_optional<float>("ic_max_spacing", 0.05f))
             {
                 // Precompute the reciprocal of the number of light samples.
                 m_rcp_dl_light_sample_count =
@@ -123,27 +152,50 @@ namespace
 
             void print() const
             {
+                const string importance_map =
+                    m_ibl_importance_map
+                        ? pretty_uint(m_ibl_importance_map_width) + "x" + pretty_uint(m_ibl_importance_map_width / 2) +
+                          (m_ibl_mis_compensation ? ", mis compensation" : "")
+                        : "off";
+
                 RENDERER_LOG_INFO(
                     "distribution ray tracing settings:\n"
                     "  ibl              %s\n"
                     "  max path length  %s\n"
                     "  rr min path len. %s\n"
                     "  dl light samples %s\n"
-                    "  ibl env samples  %s",
+                    "  ibl env samples  %s\n"
+                    "  ibl imp. map     %s\n"
+                    "  irradiance cache %s\n"
+                    "  ic samples       %s\n"
+                    "  ic max error     %s\n"
+                    "  ic spacing       %s to %s",
                     m_enable_ibl ? "on" : "off",
                     m_max_path_length == size_t(~0) ? "infinite" : pretty_uint(m_max_path_length).c_str(),
                     m_rr_min_path_length == size_t(~0) ? "infinite" : pretty_uint(m_rr_min_path_length).c_str(),
                     pretty_scalar(m_dl_light_sample_count).c_str(),
-                    pretty_scalar(m_ibl_env_sample_count).c_str());
+                    pretty_scalar(m_ibl_env_sample_count).c_str(),
+                    importance_map.c_str(),
+                    m_enable_irradiance_cache ? "on" : "off",
+                    pretty_uint(m_ic_sample_count).c_str(),
+                    pretty_scalar(m_ic_max_error).c_str(),
+                    pretty_scalar(m_ic_min_spacing, 4).c_str(),
+                    pretty_scalar(m_ic_max_spacing, 4).c_str());
             }
         };
 
         DRTLightingEngine(
             const LightSampler&     light_sampler,
+            IrradianceCache*        irradiance_cache,
+            EnvironmentImportanceMap* env_importance_map,
             const ParamArray&       params)
           : m_params(params)
           , m_light_sampler(light_sampler)
+          , m_irradiance_cache(irradiance_cache)
+          , m_env_importance_map(env_importance_map)
           , m_path_count(0)
+          , m_ic_lookup_count(0)
+          , m_ic_miss_count(0)
         {
         }
 
@@ -160,9 +212,17 @@ namespace
             Spectrum&               radiance,               // output radiance, in W.sr^-1.m^-2
             SpectrumStack&          aovs) APPLESEED_OVERRIDE
         {
+            // The importance map is rasterized by the first thread that needs it.
+            const EnvironmentEDF* env_edf = shading_point.get_scene().get_environment()->get_environment_edf();
+            if (m_env_importance_map && env_edf)
+                m_env_importance_map->build(shading_context, *env_edf);
+
             PathVisitor path_visitor(
                 m_params,
                 m_light_sampler,
+                m_irradiance_cache,
+                &m_pending_records,
+                m_env_importance_map,
                 sampling_context,
                 shading_context,
                 shading_point.get_scene(),
@@ -184,6 +244,17 @@ namespace
             // Update statistics.
             ++m_path_count;
             m_path_length.insert(path_length);
+            m_ic_lookup_count += path_visitor.m_ic_hit_count + m_pending_records.size();
+            m_ic_miss_count += m_pending_records.size();
+
+            // Compute the irradiance records that were missing along the path. This can only
+            // be done once the path is complete since computing a record traces other paths,
+            // which overwrites the BSDF inputs of the path vertices.
+            if (!m_pending_records.empty())
+            {
+                add_pending_records(sampling_context, shading_context, radiance);
+                m_pending_records.clear();
+            }
         }
 
         virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
@@ -192,29 +263,171 @@ namespace
             stats.insert("path count", m_path_count);
             stats.insert("path length", m_path_length);
 
+            if (m_irradiance_cache)
+            {
+                stats.insert_percent("ic misses", m_ic_miss_count, m_ic_lookup_count);
+                stats.insert<uint64>("ic records", m_irradiance_cache->size());
+            }
+
             return StatisticsVector::make("distribution ray tracing statistics", stats);
         }
 
       private:
+        // A diffuse path vertex for which the irradiance cache had no valid record.
+        struct PendingRecord
+        {
+            ShadingPoint                m_shading_point;
+            Vector3d                    m_shading_normal;       // on the side of the outgoing direction
+            Vector3d                    m_geometric_normal;     // on the side of the outgoing direction
+            Spectrum                    m_weight;               // path throughput times diffuse BSDF value
+        };
+
+        typedef AlignedVector<PendingRecord> PendingRecordVector;
+
         const Parameters        m_params;
         const LightSampler&     m_light_sampler;
+        IrradianceCache*        m_irradiance_cache;
+        EnvironmentImportanceMap* m_env_importance_map;   // 0 if the environment is sampled by its EDF
+        PendingRecordVector     m_pending_records;
 
         uint64                  m_path_count;
         Population<uint64>      m_path_length;
+        uint64                  m_ic_lookup_count;
+        uint64                  m_ic_miss_count;
+
+        void add_pending_records(
+            SamplingContext&        sampling_context,
+            const ShadingContext&   shading_context,
+            Spectrum&               radiance)
+        {
+            for (size_t i = 0, e = m_pending_records.size(); i < e; ++i)
+            {
+                const PendingRecord& record = m_pending_records[i];
+
+                Spectrum irradiance(Spectrum::Illuminance);
+                float harmonic_mean_distance;
+                compute_irradiance(
+                    sampling_context,
+                    shading_context,
+                    record,
+                    irradiance,
+                    harmonic_mean_distance);
+
+                m_irradiance_cache->insert(
+                    record.m_shading_point.get_point(),
+                    Vector3f(record.m_shading_normal),
+                    harmonic_mean_distance,
+                    irradiance);
+
+                madd(radiance, record.m_weight, irradiance);
+            }
+        }
+
+        // Estimate the irradiance due to indirect lighting at a pending record by
+        // computing direct lighting at the end of cosine-distributed rays.
+        void compute_irradiance(
+            SamplingContext&        sampling_context,
+            const ShadingContext&   shading_context,
+            const PendingRecord&    record,
+            Spectrum&               irradiance,
+            float&                  harmonic_mean_distance)
+        {
+            const ShadingPoint& origin = record.m_shading_point;
+            const Basis3d basis(record.m_shading_normal);
+            const size_t sample_count = m_params.m_ic_sample_count;
+
+            SamplingContext child_sampling_context = sampling_context.split(2, sample_count);
+
+            irradiance.set(0.0f);
+            double rcp_distance_sum = 0.0;
+
+            for (size_t i = 0; i < sample_count; ++i)
+            {
+                // Generate a cosine-weighted direction over the hemisphere.
+                const Vector2d s = child_sampling_context.next2<Vector2d>();
+                const Vector3d incoming = basis.transform_to_parent(sample_hemisphere_cosine(s));
+
+                // Don't cast rays on or below the geometric surface.
+                if (dot(incoming, record.m_geometric_normal) <= 0.0)
+                    continue;
+
+                ShadingRay ray(
+                    origin.get_biased_point(incoming),
+                    incoming,
+                    origin.get_time(),
+                    ScatteringMode::get_vis_flags(ScatteringMode::Diffuse),
+                    origin.get_ray().m_depth + 1);
+                ray.copy_media_from(origin.get_ray());
+
+                SamplingContext path_sampling_context(child_sampling_context);
+                Spectrum gather_radiance(0.0f, Spectrum::Illuminance);
+                SpectrumStack gather_aovs(0);
+
+                PathVisitor gather_visitor(
+                    m_params,
+                    m_light_sampler,
+                    0,                  // no irradiance cache
+                    0,                  // no pending records
+                    m_env_importance_map,
+                    path_sampling_context,
+                    shading_context,
+                    origin.get_scene(),
+                    gather_radiance,
+                    gather_aovs);
+
+                // Only the first vertex of the gather path is visited.
+                PathTracer<PathVisitor, false> path_tracer(     // false = not adjoint
+                    gather_visitor,
+                    ~0,                 // no Russian Roulette
+                    1,                  // max path length
+                    shading_context.get_max_iterations());
+
+                path_tracer.trace(
+                    path_sampling_context,
+                    shading_context,
+                    ray,
+                    &origin);
+
+                irradiance += gather_radiance;
+
+                if (gather_visitor.m_hit_distance > 0.0)
+                    rcp_distance_sum += 1.0 / gather_visitor.m_hit_distance;
+            }
+
+            // The cosine term cancels out with the sampling density cos(theta) / Pi.
+            irradiance *= Pi<float>() / sample_count;
+
+            harmonic_mean_distance =
+                rcp_distance_sum > 0.0
+                    ? static_cast<float>(sample_count / rcp_distance_sum)
+                    : numeric_limits<float>::max();
+        }
 
         struct PathVisitor
         {
             const Parameters&           m_params;
             const LightSampler&         m_light_sampler;
+            IrradianceCache*            m_irradiance_cache;
+            PendingRecordVector*        m_pending_records;
+            const bool                  m_is_irradiance_gather;
             SamplingContext&            m_sampling_context;
             const ShadingContext&       m_shading_context;
             const EnvironmentEDF*       m_env_edf;
+            const EnvironmentImportanceMap* m_env_importance_map; // 0 if the environment is sampled by its EDF
             Spectrum&                   m_path_radiance;
             SpectrumStack&              m_path_aovs;
+            size_t                      m_ic_hit_count;
+            double                      m_hit_distance;
 
+            // When no pending record vector is given, the visitor traces a gather path of
+            // the irradiance cache: emitted light and the environment were already taken
+            // into account by direct and image-based lighting at the origin of the path.
             PathVisitor(
                 const Parameters&       params,
                 const LightSampler&     light_sampler,
+                IrradianceCache*        irradiance_cache,
+                PendingRecordVector*    pending_records,
+                const EnvironmentImportanceMap* env_importance_map,
                 SamplingContext&        sampling_context,
                 const ShadingContext&   shading_context,
                 const Scene&            scene,
@@ -222,11 +435,17 @@ namespace
                 SpectrumStack&          path_aovs)
               : m_params(params)
               , m_light_sampler(light_sampler)
+              , m_irradiance_cache(irradiance_cache)
+              , m_pending_records(pending_records)
+              , m_is_irradiance_gather(pending_records == 0)
               , m_sampling_context(sampling_context)
               , m_shading_context(shading_context)
               , m_env_edf(scene.get_environment()->get_environment_edf())
+              , m_env_importance_map(m_env_edf ? env_importance_map : 0)
               , m_path_radiance(path_radiance)
               , m_path_aovs(path_aovs)
+              , m_ic_hit_count(0)
+              , m_hit_distance(0.0)
             {
             }
 
@@ -248,6 +467,9 @@ namespace
                 Spectrum vertex_radiance(0.0f, Spectrum::Illuminance);
                 SpectrumStack vertex_aovs(m_path_aovs.size(), 0.0f);
 
+                if (m_is_irradiance_gather)
+                    m_hit_distance = vertex.m_shading_point->get_distance();
+
                 if (vertex.m_bsdf)
                 {
                     // Direct lighting.
@@ -264,10 +486,21 @@ namespace
                             vertex_radiance,
                             vertex_aovs);
                     }
+
+                    // Diffuse indirect lighting.
+                    if (m_irradiance_cache && ScatteringMode::has_diffuse(vertex.m_bsdf->get_modes()))
+                    {
+                        add_irradiance_cache_contribution(
+                            vertex,
+                            vertex_radiance);
+                    }
                 }
 
                 // Emitted light.
-                if (vertex.m_edf && vertex.m_cos_on > 0.0)
+                if (!m_is_irradiance_gather &&
+                    vertex.m_edf &&
+                    vertex.m_cos_on > 0.0 &&
+                    vertex.is_illuminating(m_light_sampler))
                 {
                     add_emitted_light_contribution(
                         vertex,
@@ -309,7 +542,8 @@ namespace
                     ScatteringMode::All,
                     bsdf_sample_count,
                     light_sample_count,
-                    false);             // not computing indirect lighting
+                    m_is_irradiance_gather,
+                    0);                 // trace shadow rays immediately
 
                 // Always sample both the lights and the BSDF.
                 integrator.compute_outgoing_radiance_combined_sampling_low_variance(
@@ -351,6 +585,7 @@ namespace
                     m_sampling_context,
                     m_shading_context,
                     *m_env_edf,
+                    m_env_importance_map,
                     *vertex.m_shading_point,
                     vertex.m_outgoing,
                     *vertex.m_bsdf,
@@ -370,6 +605,55 @@ namespace
                 vertex_aovs.add(m_env_edf->get_render_layer_index(), ibl_radiance);
             }
 
+            void add_irradiance_cache_contribution(
+                const PathVertex&       vertex,
+                Spectrum&               vertex_radiance)
+            {
+                // Irradiance records are oriented toward the outgoing direction.
+                Vector3d shading_normal = vertex.get_shading_normal();
+                Vector3d geometric_normal = vertex.get_geometric_normal();
+                if (vertex.m_cos_on < 0.0)
+                    shading_normal = -shading_normal;
+                if (dot(vertex.m_outgoing.get_value(), geometric_normal) < 0.0)
+                    geometric_normal = -geometric_normal;
+
+                // Diffuse BSDFs are constant over the hemisphere, so evaluating the diffuse
+                // components in the direction of the normal gives the ratio of reflected
+                // radiance to irradiance.
+                APPLESEED_HOT_PATH_COUNT(hot_path_counters().m_bsdf_evaluations.increment(vertex.m_bsdf->get_model()));
+                Spectrum diffuse_value(Spectrum::Reflectance);
+                const float prob =
+                    vertex.m_bsdf->evaluate(
+                        vertex.m_bsdf_data,
+                        false,          // not adjoint
+                        false,          // do not multiply by |cos(incoming, normal)|
+                        Vector3f(geometric_normal),
+                        Basis3f(vertex.get_shading_basis()),
+                        Vector3f(vertex.m_outgoing.get_value()),
+                        Vector3f(shading_normal),
+                        ScatteringMode::Diffuse,
+                        diffuse_value);
+                if (prob == 0.0f)
+                    return;
+
+                Spectrum irradiance(Spectrum::Illuminance);
+                if (m_irradiance_cache->lookup(vertex.get_point(), Vector3f(shading_normal), irradiance))
+                {
+                    ++m_ic_hit_count;
+                    madd(vertex_radiance, diffuse_value, irradiance);
+                    return;
+                }
+
+                // Compute the missing record once the path is complete.
+                m_pending_records->push_back(PendingRecord());
+                PendingRecord& record = m_pending_records->back();
+                record.m_shading_point = *vertex.m_shading_point;
+                record.m_shading_normal = shading_normal;
+                record.m_geometric_normal = geometric_normal;
+                record.m_weight = vertex.m_throughput;
+                record.m_weight *= diffuse_value;
+            }
+
             void add_emitted_light_contribution(
                 const PathVertex&       vertex,
                 Spectrum&               vertex_radiance,
@@ -403,6 +687,10 @@ namespace
                 if (m_env_edf == 0)
                     return;
 
+                // Gather paths only collect light reflected by surfaces.
+                if (m_is_irradiance_gather)
+                    return;
+
                 // When IBL is disabled, only specular reflections should contribute here.
                 if (!m_params.m_enable_ibl && vertex.m_prev_mode != ScatteringMode::Specular)
                     return;
@@ -421,6 +709,10 @@ namespace
                 if (env_prob == 0.0)
                     return;
 
+                // The environment may be sampled from the importance map instead.
+                if (m_env_importance_map)
+                    env_prob = m_env_importance_map->evaluate_pdf(-Vector3f(vertex.m_outgoing.get_value()));
+
                 // Multiple importance sampling.
                 if (vertex.m_prev_mode != ScatteringMode::Specular)
                 {
@@ -448,12 +740,37 @@ namespace
 //
 
 DRTLightingEngineFactory::DRTLightingEngineFactory(
+    const Scene&        scene,
     const LightSampler& light_sampler,
     const ParamArray&   params)
   : m_light_sampler(light_sampler)
   , m_params(params)
 {
-    DRTLightingEngine::Parameters(params).print();
+    const DRTLightingEngine::Parameters drt_params(params);
+    drt_params.print();
+
+    if (drt_params.m_enable_irradiance_cache)
+    {
+        const float scene_diameter = static_cast<float>(AABB3d(scene.compute_bbox()).diameter());
+        m_irradiance_cache.reset(
+            new IrradianceCache(
+                drt_params.m_ic_max_error,
+                drt_params.m_ic_min_spacing * scene_diameter,
+                drt_params.m_ic_max_spacing * scene_diameter));
+    }
+
+    if (drt_params.m_enable_ibl && drt_params.m_ibl_importance_map)
+    {
+        m_env_importance_map.reset(
+            new EnvironmentImportanceMap(
+                drt_params.m_ibl_importance_map_width,
+                drt_params.m_ibl_importance_map_width / 2,
+                drt_params.m_ibl_mis_compensation));
+    }
+}
+
+DRTLightingEngineFactory::~DRTLightingEngineFactory()
+{
 }
 
 void DRTLightingEngineFactory::release()
@@ -463,7 +780,12 @@ void DRTLightingEngineFactory::release()
 
 ILightingEngine* DRTLightingEngineFactory::create()
 {
-    return new DRTLightingEngine(m_light_sampler, m_params);
+    return
+        new DRTLightingEngine(
+            m_light_sampler,
+            m_irradiance_cache.get(),
+            m_env_importance_map.get(),
+            m_params);
 }
 
 Dictionary DRTLightingEngineFactory::get_params_metadata()
@@ -489,6 +811,53 @@ Dictionary DRTLightingEngineFactory::get_params_metadata()
             .insert("min", "1")
             .insert("help", "Consider pruning low contribution paths starting with this bounce"));
 
+    add_ibl_importance_map_params_metadata(metadata);
+
+    metadata.dictionaries().insert(
+        "enable_irradiance_cache",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Irradiance Cache")
+            .insert("help", "Interpolate diffuse indirect lighting from a cache of irradiance records"));
+
+    metadata.dictionaries().insert(
+        "ic_samples",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "64")
+            .insert("min", "1")
+            .insert("label", "Irradiance Cache Samples")
+            .insert("help", "Number of rays used to compute an irradiance record"));
+
+    metadata.dictionaries().insert(
+        "ic_max_error",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.3")
+            .insert("min", "0.01")
+            .insert("max", "1.0")
+            .insert("label", "Irradiance Cache Max Error")
+            .insert("help", "Maximum interpolation error; lower values create more records"));
+
+    metadata.dictionaries().insert(
+        "ic_min_spacing",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.001")
+            .insert("min", "0.0")
+            .insert("label", "Irradiance Cache Min Spacing")
+            .insert("help", "Minimum spacing between irradiance records, relative to the scene diameter"));
+
+    metadata.dictionaries().insert(
+        "ic_max_spacing",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.05")
+            .insert("min", "0.0")
+            .insert("label", "Irradiance Cache Max Spacing")
+            .insert("help", "Maximum spacing between irradiance records, relative to the scene diameter"));
+
     return metadata;
 }
 
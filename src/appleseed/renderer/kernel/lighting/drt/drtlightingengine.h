@@ -37,9 +37,15 @@
 // appleseed.foundation headers.
 #include "foundation/platform/compiler.h"
 
+// Standard headers.
+#include <memory>
+
 // Forward declarations.
 namespace foundation    { class Dictionary; }
+namespace renderer      { class EnvironmentImportanceMap; }
+namespace renderer      { class IrradianceCache; }
 namespace renderer      { class LightSampler; }
+namespace renderer      { class Scene; }
 
 namespace renderer
 {
@@ -54,9 +60,13 @@ class DRTLightingEngineFactory
   public:
     // Constructor.
     DRTLightingEngineFactory(
+        const Scene&        scene,
         const LightSampler& light_sampler,
         const ParamArray&   params);
 
+    // Destructor.
+    ~DRTLightingEngineFactory();
+
     // Delete this instance.
     virtual void release() APPLESEED_OVERRIDE;
 
@@ -67,8 +77,10 @@ class DRTLightingEngineFactory
     static foundation::Dictionary get_params_metadata();
 
   private:
-    const LightSampler&     m_light_sampler;
-    ParamArray              m_params;
+    const LightSampler&                     m_light_sampler;
+    ParamArray                              m_params;
+    std::auto_ptr<IrradianceCache>          m_irradiance_cache;     // shared by all DRT lighting engines
+    std::auto_ptr<EnvironmentImportanceMap> m_env_importance_map;   // shared by all DRT lighting engines
 };
 
 }       // namespace renderer
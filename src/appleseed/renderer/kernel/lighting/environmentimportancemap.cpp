@@ -0,0 +1,296 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "environmentimportancemap.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/environmentedf/sphericalcoordinates.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/fp.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/atomic.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Number of samples along each axis used to rasterize a texel of the map.
+    const size_t SubsampleCount = 2;
+
+    // Find the interval of a CDF containing a given value and return the fractional
+    // position of the value inside it. The CDF starts at 0 and ends at 1.
+    size_t sample_cdf(
+        const float*    cdf,
+        const size_t    size,           // number of intervals
+        const float     s,
+        float&          t)
+    {
+        const float* bound = upper_bound(cdf + 1, cdf + size + 1, s);
+        const size_t i = min(static_cast<size_t>(bound - (cdf + 1)), size - 1);
+
+        const float width = cdf[i + 1] - cdf[i];
+        t = width > 0.0f ? saturate((s - cdf[i]) / width) : 0.5f;
+
+        return i;
+    }
+}
+
+EnvironmentImportanceMap::EnvironmentImportanceMap(
+    const size_t    width,
+    const size_t    height,
+    const bool      mis_compensation)
+  : m_width(max<size_t>(width, 1))
+  , m_height(max<size_t>(height, 1))
+  , m_mis_compensation(mis_compensation)
+  , m_built(0)
+{
+}
+
+void EnvironmentImportanceMap::build(
+    const ShadingContext&   shading_context,
+    const EnvironmentEDF&   environment_edf)
+{
+    if (atomic_read(&m_built))
+        return;
+
+    boost::mutex::scoped_lock lock(m_build_mutex);
+
+    if (atomic_read(&m_built))
+        return;
+
+    vector<float> values(m_width * m_height);
+
+    const float rcp_subsample_count = 1.0f / (SubsampleCount * SubsampleCount);
+
+    for (size_t y = 0; y < m_height; ++y)
+    {
+        for (size_t x = 0; x < m_width; ++x)
+        {
+            float value = 0.0f;
+
+            for (size_t sy = 0; sy < SubsampleCount; ++sy)
+            {
+                for (size_t sx = 0; sx < SubsampleCount; ++sx)
+                {
+                    const float u = (x + (sx + 0.5f) / SubsampleCount) / m_width;
+                    const float v = (y + (sy + 0.5f) / SubsampleCount) / m_height;
+
+                    float theta, phi;
+                    unit_square_to_angles(u, v, theta, phi);
+
+                    const Vector3f outgoing =
+                        Vector3f::make_unit_vector(
+                            cos(theta), sin(theta),
+                            cos(phi), sin(phi));
+
+                    Spectrum env_value(Spectrum::Illuminance);
+                    environment_edf.evaluate(shading_context, outgoing, env_value);
+
+                    const float avg = average_value(env_value);
+                    if (FP<float>::is_finite(avg) && avg > 0.0f)
+                        value += avg;
+                }
+            }
+
+            values[y * m_width + x] = value * rcp_subsample_count;
+        }
+    }
+
+    build_distribution(&values[0]);
+
+    atomic_write(&m_built, 1);
+}
+
+void EnvironmentImportanceMap::build(const float* luminances)
+{
+    boost::mutex::scoped_lock lock(m_build_mutex);
+
+    build_distribution(luminances);
+
+    atomic_write(&m_built, 1);
+}
+
+bool EnvironmentImportanceMap::is_built() const
+{
+    return atomic_read(const_cast<volatile uint32*>(&m_built)) != 0;
+}
+
+void EnvironmentImportanceMap::build_distribution(const float* values)
+{
+    const size_t texel_count = m_width * m_height;
+
+    // Compute the sine of the polar angle at the center of each row.
+    vector<float> row_sines(m_height);
+    for (size_t y = 0; y < m_height; ++y)
+        row_sines[y] = sin(Pi<float>() * (y + 0.5f) / m_height);
+
+    // Compute the importance of each texel.
+    m_pdfs.assign(values, values + texel_count);
+
+    if (m_mis_compensation)
+    {
+        // Compute the solid angle-weighted mean value of the map.
+        double weighted_sum = 0.0, weight_sum = 0.0;
+        for (size_t y = 0; y < m_height; ++y)
+        {
+            for (size_t x = 0; x < m_width; ++x)
+                weighted_sum += static_cast<double>(values[y * m_width + x]) * row_sines[y];
+            weight_sum += static_cast<double>(m_width) * row_sines[y];
+        }
+        const float mean = static_cast<float>(weighted_sum / weight_sum);
+
+        // Subtract the mean value, unless that would leave nothing to sample.
+        bool empty = true;
+        for (size_t i = 0; i < texel_count; ++i)
+        {
+            m_pdfs[i] = max(values[i] - mean, 0.0f);
+            if (m_pdfs[i] > 0.0f)
+                empty = false;
+        }
+
+        if (empty)
+            m_pdfs.assign(values, values + texel_count);
+    }
+
+    // Build the conditional CDF of each row and the marginal CDF of the rows.
+    m_row_cdf.assign(m_height + 1, 0.0f);
+    m_column_cdfs.assign(m_height * (m_width + 1), 0.0f);
+
+    double total = 0.0;
+
+    for (size_t y = 0; y < m_height; ++y)
+    {
+        float* column_cdf = &m_column_cdfs[y * (m_width + 1)];
+        float* pdfs = &m_pdfs[y * m_width];
+
+        double row_total = 0.0;
+        for (size_t x = 0; x < m_width; ++x)
+        {
+            pdfs[x] = max(pdfs[x], 0.0f) * row_sines[y];
+            row_total += pdfs[x];
+            column_cdf[x + 1] = static_cast<float>(row_total);
+        }
+
+        if (row_total > 0.0)
+        {
+            const float rcp_row_total = static_cast<float>(1.0 / row_total);
+            for (size_t x = 1; x < m_width; ++x)
+                column_cdf[x] *= rcp_row_total;
+            column_cdf[m_width] = 1.0f;
+        }
+
+        total += row_total;
+        m_row_cdf[y + 1] = static_cast<float>(total);
+    }
+
+    if (total > 0.0)
+    {
+        const float rcp_total = static_cast<float>(1.0 / total);
+        for (size_t y = 1; y < m_height; ++y)
+            m_row_cdf[y] *= rcp_total;
+        m_row_cdf[m_height] = 1.0f;
+
+        // Convert texel values to probability densities in [0,1]^2.
+        const float scale = static_cast<float>(texel_count) * rcp_total;
+        for (size_t i = 0; i < texel_count; ++i)
+            m_pdfs[i] *= scale;
+    }
+    else m_pdfs.assign(texel_count, 0.0f);
+}
+
+float EnvironmentImportanceMap::sample(
+    const Vector2f&         s,
+    Vector3f&               outgoing) const
+{
+    assert(is_built());
+
+    if (m_row_cdf.back() == 0.0f)
+    {
+        outgoing = Vector3f(0.0f, 1.0f, 0.0f);
+        return 0.0f;
+    }
+
+    // Sample a row, then a column in that row.
+    float ty, tx;
+    const size_t y = sample_cdf(&m_row_cdf[0], m_height, s[1], ty);
+    const size_t x = sample_cdf(&m_column_cdfs[y * (m_width + 1)], m_width, s[0], tx);
+
+    // Compute the sampled direction, jittered inside the texel.
+    const float u = (x + tx) / m_width;
+    const float v = (y + ty) / m_height;
+
+    float theta, phi;
+    unit_square_to_angles(u, v, theta, phi);
+
+    const float sin_theta = sin(theta);
+    outgoing =
+        Vector3f::make_unit_vector(
+            cos(theta), sin_theta,
+            cos(phi), sin(phi));
+
+    // Convert the probability density from [0,1]^2 to solid angle.
+    return sin_theta > 0.0f
+        ? m_pdfs[y * m_width + x] / (2.0f * Pi<float>() * Pi<float>() * sin_theta)
+        : 0.0f;
+}
+
+float EnvironmentImportanceMap::evaluate_pdf(const Vector3f& outgoing) const
+{
+    assert(is_built());
+    assert(is_normalized(outgoing));
+
+    float theta, phi;
+    unit_vector_to_angles(outgoing, theta, phi);
+
+    const float sin_theta = sin(theta);
+    if (sin_theta <= 0.0f)
+        return 0.0f;
+
+    float u, v;
+    angles_to_unit_square(clamp(theta, 0.0f, Pi<float>()), clamp(phi, -Pi<float>(), Pi<float>()), u, v);
+
+    const size_t x = min(truncate<size_t>(u * m_width), m_width - 1);
+    const size_t y = min(truncate<size_t>(v * m_height), m_height - 1);
+
+    return m_pdfs[y * m_width + x] / (2.0f * Pi<float>() * Pi<float>() * sin_theta);
+}
+
+}   // namespace renderer
@@ -0,0 +1,111 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_ENVIRONMENTIMPORTANCEMAP_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_ENVIRONMENTIMPORTANCEMAP_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class EnvironmentEDF; }
+namespace renderer  { class ShadingContext; }
+
+namespace renderer
+{
+
+//
+// A piecewise constant world space latitude-longitude importance map of an arbitrary
+// environment EDF, used to importance sample environments whose own sampling strategy
+// is poor (procedural skies, OSL backgrounds, etc.).
+//
+// When MIS compensation is enabled, the mean radiance of the environment is subtracted
+// from the importance map, leaving the low frequency part of the lighting to BSDF
+// sampling when both strategies are combined with multiple importance sampling:
+//
+//   Multiple Importance Sampling Compensation
+//   Ondrej Karlik, Martin Sik, Petr Vevoda, Tomas Skrivan, Jaroslav Krivanek
+//   https://cgg.mff.cuni.cz/~jaroslav/papers/2019-mis-compensation/
+//
+
+class EnvironmentImportanceMap
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    EnvironmentImportanceMap(
+        const size_t                width,
+        const size_t                height,
+        const bool                  mis_compensation);
+
+    // Rasterize a given environment EDF into the map, unless the map was already built.
+    // Thread-safe: concurrent callers wait until the first one has built the map.
+    void build(
+        const ShadingContext&       shading_context,
+        const EnvironmentEDF&       environment_edf);
+
+    // Build the map from width * height luminance values, in scanline order,
+    // the first scanline corresponding to the +Y direction.
+    void build(const float*         luminances);
+
+    // Return true if the map was built.
+    bool is_built() const;
+
+    // Sample the map and return the world space direction and its probability density
+    // with respect to solid angle. The probability density may be zero.
+    float sample(
+        const foundation::Vector2f& s,                      // sample in [0,1)^2
+        foundation::Vector3f&       outgoing) const;        // world space direction, unit-length
+
+    // Return the probability density with respect to solid angle of a given direction.
+    float evaluate_pdf(
+        const foundation::Vector3f& outgoing) const;        // world space direction, unit-length
+
+  private:
+    const size_t                    m_width;
+    const size_t                    m_height;
+    const bool                      m_mis_compensation;
+    std::vector<float>              m_pdfs;                 // per-texel probability density in [0,1]^2
+    std::vector<float>              m_row_cdf;              // marginal CDF of the rows, height + 1 entries
+    std::vector<float>              m_column_cdfs;          // conditional CDF of each row, height * (width + 1) entries
+    volatile foundation::uint32     m_built;
+    boost::mutex                    m_build_mutex;
+
+    void build_distribution(const float* values);
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_ENVIRONMENTIMPORTANCEMAP_H
@@ -69,4 +69,33 @@ void ILightingEngineFactory::add_common_params_metadata(
     }
 }
 
+void ILightingEngineFactory::add_ibl_importance_map_params_metadata(
+    Dictionary& metadata)
+{
+    metadata.dictionaries().insert(
+        "ibl_importance_map",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "IBL Importance Map")
+            .insert("help", "Sample the environment from an importance map rasterized at the start of rendering rather than from its own sampling method"));
+
+    metadata.dictionaries().insert(
+        "ibl_importance_map_resolution",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "256")
+            .insert("min", "2")
+            .insert("label", "IBL Importance Map Resolution")
+            .insert("help", "Width of the environment importance map, its height is half of it"));
+
+    metadata.dictionaries().insert(
+        "ibl_mis_compensation",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "true")
+            .insert("label", "IBL MIS Compensation")
+            .insert("help", "Leave the uniform part of the environment lighting to BSDF sampling when sampling the importance map"));
+}
+
 }       // namespace renderer
@@ -84,6 +84,9 @@ class ILightingEngineFactory
     static void add_common_params_metadata(
         foundation::Dictionary& metadata,
         const bool              add_lighting_samples);
+
+    static void add_ibl_importance_map_params_metadata(
+        foundation::Dictionary& metadata);
 };
 
 }       // namespace renderer
@@ -31,6 +31,7 @@
 #include "imagebasedlighting.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/lighting/environmentimportancemap.h"
 #include "renderer/kernel/lighting/tracer.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
@@ -38,6 +39,7 @@
 #include "renderer/modeling/bsdf/bsdfsample.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
 #include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/hotpathcounters.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/basis.h"
@@ -56,6 +58,7 @@ void compute_ibl_combined_sampling(
     SamplingContext&        sampling_context,
     const ShadingContext&   shading_context,
     const EnvironmentEDF&   environment_edf,
+    const EnvironmentImportanceMap* env_importance_map,
     const ShadingPoint&     shading_point,
     const Dual3d&           outgoing,
     const BSDF&             bsdf,
@@ -73,6 +76,7 @@ void compute_ibl_combined_sampling(
         sampling_context,
         shading_context,
         environment_edf,
+        env_importance_map,
         shading_point,
         outgoing,
         bsdf,
@@ -88,6 +92,7 @@ void compute_ibl_combined_sampling(
         sampling_context,
         shading_context,
         environment_edf,
+        env_importance_map,
         shading_point,
         outgoing,
         bsdf,
@@ -103,6 +108,7 @@ void compute_ibl_bsdf_sampling(
     SamplingContext&        sampling_context,
     const ShadingContext&   shading_context,
     const EnvironmentEDF&   environment_edf,
+    const EnvironmentImportanceMap* env_importance_map,
     const ShadingPoint&     shading_point,
     const Dual3d&           outgoing,
     const BSDF&             bsdf,
@@ -152,6 +158,8 @@ void compute_ibl_bsdf_sampling(
             sample.m_incoming.get_value(),
             env_value,
             env_prob);
+        if (env_importance_map)
+            env_prob = env_importance_map->evaluate_pdf(sample.m_incoming.get_value());
 
         // Apply all weights, including MIS weight.
         if (sample.m_mode == ScatteringMode::Specular)
@@ -178,6 +186,7 @@ void compute_ibl_environment_sampling(
     SamplingContext&        sampling_context,
     const ShadingContext&   shading_context,
     const EnvironmentEDF&   environment_edf,
+    const EnvironmentImportanceMap* env_importance_map,
     const ShadingPoint&     shading_point,
     const Dual3d&           outgoing,
     const BSDF&             bsdf,
@@ -209,12 +218,22 @@ void compute_ibl_environment_sampling(
         Vector3f incoming;
         Spectrum env_value(Spectrum::Illuminance);
         float env_prob;
-        environment_edf.sample(
-            shading_context,
-            s,
-            incoming,
-            env_value,
-            env_prob);
+        if (env_importance_map)
+        {
+            env_prob = env_importance_map->sample(s, incoming);
+            if (env_prob == 0.0f)
+                continue;
+            environment_edf.evaluate(shading_context, incoming, env_value);
+        }
+        else
+        {
+            environment_edf.sample(
+                shading_context,
+                s,
+                incoming,
+                env_value,
+                env_prob);
+        }
 
         // Cull samples behind the shading surface.
         assert(is_normalized(incoming));
@@ -232,6 +251,7 @@ void compute_ibl_environment_sampling(
             continue;
 
         // Evaluate the BSDF.
+        APPLESEED_HOT_PATH_COUNT(hot_path_counters().m_bsdf_evaluations.increment(bsdf.get_model()));
         Spectrum bsdf_value;
         const float bsdf_prob =
             bsdf.evaluate(
@@ -43,6 +43,7 @@
 // Forward declarations.
 namespace renderer  { class BSDF; }
 namespace renderer  { class EnvironmentEDF; }
+namespace renderer  { class EnvironmentImportanceMap; }
 namespace renderer  { class ShadingContext; }
 namespace renderer  { class ShadingPoint; }
 
@@ -58,6 +59,7 @@ void compute_ibl_combined_sampling(
     SamplingContext&                sampling_context,
     const ShadingContext&           shading_context,
     const EnvironmentEDF&           environment_edf,
+    const EnvironmentImportanceMap* env_importance_map,     // optional, replaces the environment's own sampling
     const ShadingPoint&             shading_point,
     const foundation::Dual3d&       outgoing,               // world space outgoing direction, unit-length
     const BSDF&                     bsdf,
@@ -73,6 +75,7 @@ void compute_ibl_bsdf_sampling(
     SamplingContext&                sampling_context,
     const ShadingContext&           shading_context,
     const EnvironmentEDF&           environment_edf,
+    const EnvironmentImportanceMap* env_importance_map,     // optional, replaces the environment's own sampling
     const ShadingPoint&             shading_point,
     const foundation::Dual3d&       outgoing,               // world space outgoing direction, unit-length
     const BSDF&                     bsdf,
@@ -87,6 +90,7 @@ void compute_ibl_environment_sampling(
     SamplingContext&                sampling_context,
     const ShadingContext&           shading_context,
     const EnvironmentEDF&           environment_edf,
+    const EnvironmentImportanceMap* env_importance_map,     // optional, replaces the environment's own sampling
     const ShadingPoint&             shading_point,
     const foundation::Dual3d&       outgoing,               // world space outgoing direction, unit-length
     const BSDF&                     bsdf,
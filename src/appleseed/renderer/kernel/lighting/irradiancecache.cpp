@@ -0,0 +1,180 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "irradiancecache.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// IrradianceCache class implementation.
+//
+
+IrradianceCache::IrradianceCache(
+    const float     max_error,
+    const float     min_spacing,
+    const float     max_spacing)
+  : m_max_error(max_error)
+  , m_rcp_max_error(1.0f / max_error)
+  , m_min_spacing(min_spacing)
+  , m_max_spacing(max(max_spacing, min_spacing))
+  , m_rcp_cell_size(1.0f / (max_error * m_max_spacing))
+  , m_buckets(BucketCount)
+{
+    assert(max_error > 0.0f);
+    assert(min_spacing >= 0.0f);
+}
+
+size_t IrradianceCache::size() const
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+    return m_records.size();
+}
+
+bool IrradianceCache::lookup(
+    const Vector3d& point,
+    const Vector3f& normal,
+    Spectrum&       irradiance) const
+{
+    const Vector3f p(point);
+
+    Spectrum irradiance_sum(0.0f, Spectrum::Illuminance);
+    float weight_sum = 0.0f;
+
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+
+    const vector<uint32>& bucket = m_buckets[compute_bucket(compute_cell(p))];
+
+    for (size_t i = 0, e = bucket.size(); i < e; ++i)
+    {
+        const Record& record = m_records[bucket[i]];
+
+        const float cos_normals = dot(normal, record.m_normal);
+        if (cos_normals <= 0.0f)
+            continue;
+
+        // Ward's estimate of the interpolation error.
+        const Vector3f d = p - record.m_position;
+        const float error =
+              norm(d) * record.m_rcp_radius
+            + sqrt(max(1.0f - cos_normals, 0.0f));
+        if (error >= m_max_error)
+            continue;
+
+        // Skip records in front of the point: they may not see nearby occluders.
+        if (dot(d, normal + record.m_normal) < -0.02f / record.m_rcp_radius)
+            continue;
+
+        // This weight vanishes at the boundary of the validity domain, which
+        // avoids discontinuities when records are added during rendering.
+        const float weight = 1.0f / max(error, 1.0e-4f) - m_rcp_max_error;
+
+        madd(irradiance_sum, record.m_irradiance, weight);
+        weight_sum += weight;
+    }
+
+    if (weight_sum == 0.0f)
+        return false;
+
+    irradiance = irradiance_sum;
+    irradiance /= weight_sum;
+
+    return true;
+}
+
+void IrradianceCache::insert(
+    const Vector3d& point,
+    const Vector3f& normal,
+    const float     harmonic_mean_distance,
+    const Spectrum& irradiance)
+{
+    const float radius = clamp(harmonic_mean_distance, m_min_spacing, m_max_spacing);
+
+    Record record;
+    record.m_position = Vector3f(point);
+    record.m_normal = normal;
+    record.m_rcp_radius = 1.0f / radius;
+    record.m_irradiance = irradiance;
+
+    // Cells overlapped by the validity domain of the record. Since the cell size is
+    // the largest possible extent, this is at most three cells along each axis.
+    const Vector3f extent(m_max_error * radius);
+    const Vector3i min_cell = compute_cell(record.m_position - extent);
+    const Vector3i max_cell = compute_cell(record.m_position + extent);
+
+    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+
+    const uint32 index = static_cast<uint32>(m_records.size());
+    m_records.push_back(record);
+
+    for (int z = min_cell.z; z <= max_cell.z; ++z)
+    {
+        for (int y = min_cell.y; y <= max_cell.y; ++y)
+        {
+            for (int x = min_cell.x; x <= max_cell.x; ++x)
+            {
+                // Several cells may hash to the same bucket.
+                vector<uint32>& bucket = m_buckets[compute_bucket(Vector3i(x, y, z))];
+                if (bucket.empty() || bucket.back() != index)
+                    bucket.push_back(index);
+            }
+        }
+    }
+}
+
+Vector3i IrradianceCache::compute_cell(const Vector3f& point) const
+{
+    return
+        Vector3i(
+            truncate<int>(floor(point.x * m_rcp_cell_size)),
+            truncate<int>(floor(point.y * m_rcp_cell_size)),
+            truncate<int>(floor(point.z * m_rcp_cell_size)));
+}
+
+uint32 IrradianceCache::compute_bucket(const Vector3i& cell)
+{
+    // Teschner et al., Optimized Spatial Hashing for Collision Detection of Deformable Objects.
+    return
+        ((static_cast<uint32>(cell.x) * 73856093u) ^
+         (static_cast<uint32>(cell.y) * 19349663u) ^
+         (static_cast<uint32>(cell.z) * 83492791u)) & (BucketCount - 1);
+}
+
+}   // namespace renderer
@@ -0,0 +1,120 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_IRRADIANCECACHE_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_IRRADIANCECACHE_H
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/alignedvector.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A world space cache of diffuse irradiance records, filled on demand and
+// interpolated with Ward's error-bounded weighting:
+//
+//   A Ray Tracing Solution for Diffuse Interreflection
+//   Gregory J. Ward, Francis M. Rubinstein, Robert D. Clear
+//   http://radsite.lbl.gov/radiance/papers/sg88/paper.html
+//
+// Each record is valid within a radius proportional to the harmonic mean distance
+// to the surfaces seen from it. Records are inserted into every cell of a uniform
+// hash grid that their validity sphere overlaps, so that a lookup only visits the
+// cell containing the query point. The cache may be queried and extended from
+// multiple threads concurrently.
+//
+
+class IrradianceCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    IrradianceCache(
+        const float                 max_error,              // maximum interpolation error, in ]0,1]
+        const float                 min_spacing,            // minimum validity radius of a record, in world units
+        const float                 max_spacing);           // maximum validity radius of a record, in world units
+
+    // Return the number of records in the cache. Thread-safe.
+    size_t size() const;
+
+    // Interpolate the irradiance at a given point from the records valid there.
+    // Return false if there is no such record. Thread-safe.
+    bool lookup(
+        const foundation::Vector3d& point,
+        const foundation::Vector3f& normal,                 // unit-length
+        Spectrum&                   irradiance) const;
+
+    // Insert a new record. Thread-safe.
+    void insert(
+        const foundation::Vector3d& point,
+        const foundation::Vector3f& normal,                 // unit-length
+        const float                 harmonic_mean_distance,
+        const Spectrum&             irradiance);
+
+  private:
+    enum { BucketCount = 1 << 16 };
+
+    struct Record
+    {
+        foundation::Vector3f        m_position;
+        foundation::Vector3f        m_normal;
+        float                       m_rcp_radius;           // reciprocal of the validity radius
+        Spectrum                    m_irradiance;
+    };
+
+    const float                     m_max_error;
+    const float                     m_rcp_max_error;
+    const float                     m_min_spacing;
+    const float                     m_max_spacing;
+    const float                     m_rcp_cell_size;
+    foundation::AlignedVector<Record> m_records;
+    std::vector<std::vector<foundation::uint32> > m_buckets;  // indices of the records overlapping the cells of each bucket
+    mutable boost::shared_mutex     m_mutex;
+
+    foundation::Vector3i compute_cell(
+        const foundation::Vector3f& point) const;
+
+    static foundation::uint32 compute_bucket(
+        const foundation::Vector3i& cell);
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_IRRADIANCECACHE_H
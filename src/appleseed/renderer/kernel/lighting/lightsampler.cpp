@@ -37,6 +37,7 @@
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/kernel/tessellation/statictessellation.h"
+#include "renderer/modeling/color/colorentity.h"
 #include "renderer/modeling/edf/edf.h"
 #include "renderer/modeling/light/light.h"
 #include "renderer/modeling/material/material.h"
@@ -48,19 +49,27 @@
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/textureinstance.h"
 #include "renderer/modeling/scene/visibilityflags.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/hotpathcounters.h"
+#include "renderer/utility/startupprofiler.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/sampling/mappings.h"
 #include "foundation/math/scalar.h"
+#include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/lazy.h"
+#include "foundation/utility/siphash.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <string>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -105,22 +114,95 @@ void LightSample::make_shading_point(
 
 LightSampler::LightSampler(const Scene& scene, const ParamArray& params)
   : m_params(params)
-  , m_emitting_triangle_hash_table(m_triangle_key_hasher)
+  , m_emitting_geometry_signature(compute_emitting_geometry_signature(scene))
+  , m_lighting_signature(compute_lighting_signature(scene))
 {
-    RENDERER_LOG_INFO("collecting light emitters...");
+    StartupPhase light_sampler_phase("light sampler");
 
-    // Collect all non-physical lights.
-    collect_non_physical_lights(scene.assembly_instances(), TransformSequence());
-    m_non_physical_light_count = m_non_physical_lights.size();
+    m_emitting_triangles_cdf.set_use_alias_table(m_params.m_alias_table_sampling);
 
-    // Collect all light-emitting triangles.
-    collect_emitting_triangles(
-        scene.assembly_instances(),
-        TransformSequence());
+    {
+        StartupPhase phase("emitter collection");
+
+        RENDERER_LOG_INFO("collecting light emitters...");
+
+        // Collect all non-physical lights.
+        collect_non_physical_lights(scene.assembly_instances(), TransformSequence());
+        m_non_physical_light_count = m_non_physical_lights.size();
+
+        // Collect all light-emitting triangles.
+        collect_emitting_triangles(
+            scene.assembly_instances(),
+            TransformSequence());
+
+        // Build the lookup table of emitting triangles.
+        build_emitting_triangle_lookup_table();
+    }
+
+    prepare_sampling(scene);
+}
+
+void LightSampler::update(const Scene& scene)
+{
+    StartupPhase light_sampler_phase("light sampler");
+
+    // Reuse everything if neither the lights nor the emitters changed.
+    const uint64 lighting_signature = compute_lighting_signature(scene);
+    if (lighting_signature == m_lighting_signature)
+    {
+        RENDERER_LOG_INFO("lights and light emitters are unchanged, reusing light sampler.");
+
+        // Shader groups may have been recompiled since they last received the object areas.
+        store_object_areas_in_shadergroups();
+        return;
+    }
+
+    m_lighting_signature = lighting_signature;
+
+    {
+        StartupPhase phase("emitter collection");
+
+        // Non-physical lights are cheap to collect, and lights are replaced by new entities when they are edited.
+        m_non_physical_lights.clear();
+        m_non_physical_lights_cdf.clear();
+        collect_non_physical_lights(scene.assembly_instances(), TransformSequence());
+        m_non_physical_light_count = m_non_physical_lights.size();
+
+        // Only collect emitting triangles again if the emitting geometry changed.
+        const uint64 emitting_geometry_signature = compute_emitting_geometry_signature(scene);
+        if (emitting_geometry_signature != m_emitting_geometry_signature)
+        {
+            RENDERER_LOG_INFO("collecting light emitters...");
+
+            m_emitting_geometry_signature = emitting_geometry_signature;
 
-    // Build the hash table of emitting triangles.
-    build_emitting_triangle_hash_table();
+            m_emitting_triangles.clear();
+            m_emitting_triangles_cdf.clear();
+
+            collect_emitting_triangles(
+                scene.assembly_instances(),
+                TransformSequence());
+
+            build_emitting_triangle_lookup_table();
+        }
+        else
+        {
+            RENDERER_LOG_INFO("reusing light-emitting triangles, updating light sampling data...");
 
+            // EDFs may have been edited: recompute the weights of the emitting triangles.
+            m_emitting_triangles_cdf.clear();
+            for (size_t i = 0, e = m_emitting_triangles.size(); i < e; ++i)
+                m_emitting_triangles_cdf.insert(i, compute_emitting_triangle_weight(m_emitting_triangles[i]));
+        }
+    }
+
+    m_light_sets.clear();
+
+    prepare_sampling(scene);
+}
+
+void LightSampler::prepare_sampling(const Scene& scene)
+{
     // Prepare the CDFs for sampling.
     if (m_non_physical_lights_cdf.valid())
         m_non_physical_lights_cdf.prepare();
@@ -131,13 +213,76 @@ LightSampler::LightSampler(const Scene& scene, const ParamArray& params)
     const size_t emitting_triangle_count = m_emitting_triangles.size();
     for (size_t i = 0; i < emitting_triangle_count; ++i)
         m_emitting_triangles[i].m_triangle_prob = m_emitting_triangles_cdf[i].second;
+    store_emitting_triangle_pdfs();
 
-   RENDERER_LOG_INFO(
+    RENDERER_LOG_INFO(
         "found %s %s, %s emitting %s.",
         pretty_int(m_non_physical_light_count).c_str(),
         plural(m_non_physical_light_count, "non-physical light").c_str(),
         pretty_int(m_emitting_triangles.size()).c_str(),
         plural(m_emitting_triangles.size(), "triangle").c_str());
+
+    // Store the surface areas of the emitting object instances into their OSL shader groups.
+    store_object_areas_in_shadergroups();
+
+    // Build the light tree.
+    m_light_tree.clear();
+    if (m_params.m_light_tree && m_emitting_triangles_cdf.valid())
+    {
+        StartupPhase phase("light tree");
+
+        build_light_tree();
+
+        RENDERER_LOG_INFO(
+            "built light tree with %s %s.",
+            pretty_int(m_light_tree.get_node_count()).c_str(),
+            plural(m_light_tree.get_node_count(), "node").c_str());
+    }
+
+    // Build the light sets of the object instances with light links.
+    {
+        StartupPhase phase("light sets");
+        build_light_sets(scene.assembly_instances());
+    }
+
+    if (!m_light_sets.empty())
+    {
+        RENDERER_LOG_INFO(
+            "built light sets for %s %s.",
+            pretty_uint(m_light_sets.size()).c_str(),
+            plural(m_light_sets.size(), "object instance").c_str());
+    }
+}
+
+Dictionary LightSampler::get_params_metadata()
+{
+    Dictionary metadata;
+
+    metadata.dictionaries().insert(
+        "enable_importance_sampling",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Importance Sampling")
+            .insert("help", "Sample light-emitting triangles proportionally to their area"));
+
+    metadata.dictionaries().insert(
+        "enable_light_tree",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Light Tree")
+            .insert("help", "Sample light-emitting triangles according to their estimated contribution at the shading point"));
+
+    metadata.dictionaries().insert(
+        "enable_alias_table_sampling",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Alias Table Sampling")
+            .insert("help", "Select light-emitting triangles in constant time at the cost of a weaker sample stratification"));
+
+    return metadata;
 }
 
 void LightSampler::collect_non_physical_lights(
@@ -243,8 +388,6 @@ void LightSampler::collect_emitting_triangles(
         if (!has_emitting_materials(front_materials) && !has_emitting_materials(back_materials))
             continue;
 
-        double object_area = 0.0;
-
         // Compute the object space to world space transformation.
         // todo: add support for moving light-emitters.
         const Transformd& object_instance_transform = object_instance->get_transform();
@@ -328,9 +471,9 @@ void LightSampler::collect_emitting_triangles(
                     triangle.m_n1 != Triangle::None &&
                     triangle.m_n2 != Triangle::None)
                 {
-                    n0_os = Vector3d(tess->m_vertex_normals[triangle.m_n0]);
-                    n1_os = Vector3d(tess->m_vertex_normals[triangle.m_n1]);
-                    n2_os = Vector3d(tess->m_vertex_normals[triangle.m_n2]);
+                    n0_os = Vector3d(tess->get_vertex_normal(triangle.m_n0));
+                    n1_os = Vector3d(tess->get_vertex_normal(triangle.m_n1));
+                    n2_os = Vector3d(tess->get_vertex_normal(triangle.m_n2));
                 }
                 else
                     n0_os = n1_os = n2_os = geometric_normal;
@@ -347,17 +490,6 @@ void LightSampler::collect_emitting_triangles(
                     if (material == 0 || material->has_emission() == false)
                         continue;
 
-                    // Retrieve the EDF and get the importance multiplier.
-                    float importance_multiplier = 1.0f;
-                    if (const EDF* edf = material->get_uncached_edf())
-                        importance_multiplier = edf->get_uncached_importance_multiplier();
-
-                    // Accumulate the object area for OSL shaders.
-                    object_area += area;
-
-                    // Compute the probability density of this triangle.
-                    const float triangle_importance = m_params.m_importance_sampling ? static_cast<float>(area) : 1.0f;
-                    const float triangle_prob = triangle_importance * importance_multiplier;
 
                     // Create a light-emitting triangle.
                     EmittingTriangle emitting_triangle;
@@ -373,6 +505,7 @@ void LightSampler::collect_emitting_triangles(
                     emitting_triangle.m_n2 = side == 0 ? n2 : -n2;
                     emitting_triangle.m_geometric_normal = side == 0 ? geometric_normal : -geometric_normal;
                     emitting_triangle.m_triangle_support_plane = triangle_support_plane;
+                    emitting_triangle.m_area = static_cast<float>(area);
                     emitting_triangle.m_rcp_area = static_cast<float>(rcp_area);
                     emitting_triangle.m_triangle_prob = 0.0f;   // will be initialized once the emitting triangle CDF is built
                     emitting_triangle.m_material = material;
@@ -382,44 +515,407 @@ void LightSampler::collect_emitting_triangles(
                     m_emitting_triangles.push_back(emitting_triangle);
 
                     // Insert the light-emitting triangle into the CDF.
-                    m_emitting_triangles_cdf.insert(emitting_triangle_index, triangle_prob);
+                    m_emitting_triangles_cdf.insert(
+                        emitting_triangle_index,
+                        compute_emitting_triangle_weight(emitting_triangle));
                 }
             }
         }
+    }
+}
 
-        store_object_area_in_shadergroups(
-            &assembly_instance,
-            object_instance,
-            static_cast<float>(object_area),
-            front_materials);
+float LightSampler::compute_emitting_triangle_weight(const EmittingTriangle& emitting_triangle) const
+{
+    // Retrieve the EDF and get the importance multiplier.
+    float importance_multiplier = 1.0f;
+    if (const EDF* edf = emitting_triangle.m_material->get_uncached_edf())
+        importance_multiplier = edf->get_uncached_importance_multiplier();
+
+    // Compute the probability density of this triangle.
+    const float triangle_importance = m_params.m_importance_sampling ? emitting_triangle.m_area : 1.0f;
+    return triangle_importance * importance_multiplier;
+}
 
-        store_object_area_in_shadergroups(
-            &assembly_instance,
-            object_instance,
-            static_cast<float>(object_area),
-            back_materials);
+uint64 LightSampler::compute_emitting_geometry_signature(const Scene& scene)
+{
+    return compute_emitting_geometry_signature(scene.assembly_instances(), 0);
+}
+
+uint64 LightSampler::compute_emitting_geometry_signature(
+    const AssemblyInstanceContainer&    assembly_instances,
+    const uint64                        parent_signature)
+{
+    uint64 signature = parent_signature;
+
+    for (const_each<AssemblyInstanceContainer> i = assembly_instances; i; ++i)
+    {
+        const AssemblyInstance& assembly_instance = *i;
+        const Assembly& assembly = assembly_instance.get_assembly();
+
+        // Emitting triangles refer to their assembly instance and are transformed to world space.
+        signature = Entity::combine_signatures(signature, assembly_instance.compute_signature());
+        signature = Entity::combine_signatures(signature, assembly.compute_signature());
+        signature = Entity::combine_signatures(
+            signature,
+            siphash24(assembly_instance.transform_sequence().get_earliest_transform().get_local_to_parent()));
+
+        // Recurse into child assembly instances.
+        signature = compute_emitting_geometry_signature(assembly.assembly_instances(), signature);
+
+        // Emitting triangles refer to object instances by index and to their materials by pointer.
+        for (const_each<ObjectInstanceContainer> j = assembly.object_instances(); j; ++j)
+        {
+            const ObjectInstance& object_instance = *j;
+
+            signature = Entity::combine_signatures(signature, object_instance.compute_signature());
+            signature = Entity::combine_signatures(
+                signature,
+                siphash24(object_instance.get_transform().get_local_to_parent()));
+
+            for (size_t side = 0; side < 2; ++side)
+            {
+                const MaterialArray& materials =
+                    side == 0
+                        ? object_instance.get_front_materials()
+                        : object_instance.get_back_materials();
+
+                for (size_t k = 0, e = materials.size(); k < e; ++k)
+                {
+                    const Material* material = materials[k];
+                    signature =
+                        material
+                            ? Entity::combine_signatures(
+                                  signature,
+                                  siphash24(material->compute_signature(), material->has_emission() ? 1 : 0))
+                            : Entity::combine_signatures(signature, 0);
+                }
+            }
+        }
+    }
+
+    return signature;
+}
+
+namespace
+{
+    template <typename EntityContainer>
+    uint64 combine_entity_signatures(uint64 signature, const EntityContainer& entities)
+    {
+        for (const_each<EntityContainer> i = entities; i; ++i)
+            signature = Entity::combine_signatures(signature, i->compute_signature());
+
+        return signature;
+    }
+
+    uint64 combine_base_group_signatures(uint64 signature, const BaseGroup& base_group)
+    {
+        signature = combine_entity_signatures(signature, base_group.colors());
+        signature = combine_entity_signatures(signature, base_group.textures());
+        signature = combine_entity_signatures(signature, base_group.texture_instances());
+        signature = combine_entity_signatures(signature, base_group.shader_groups());
+        return signature;
+    }
+}
+
+uint64 LightSampler::compute_lighting_signature(const Scene& scene)
+{
+    uint64 signature = compute_emitting_geometry_signature(scene);
+    signature = combine_base_group_signatures(signature, scene);
+    return compute_lighting_signature(scene.assembly_instances(), signature);
+}
+
+uint64 LightSampler::compute_lighting_signature(
+    const AssemblyInstanceContainer&    assembly_instances,
+    const uint64                        parent_signature)
+{
+    uint64 signature = parent_signature;
+
+    for (const_each<AssemblyInstanceContainer> i = assembly_instances; i; ++i)
+    {
+        const Assembly& assembly = i->get_assembly();
+
+        signature = combine_base_group_signatures(signature, assembly);
+        signature = combine_entity_signatures(signature, assembly.lights());
+        signature = combine_entity_signatures(signature, assembly.edfs());
+        signature = combine_entity_signatures(signature, assembly.materials());
+
+        // Recurse into child assembly instances.
+        signature = compute_lighting_signature(assembly.assembly_instances(), signature);
+    }
+
+    return signature;
+}
+
+void LightSampler::build_emitting_triangle_lookup_table()
+{
+    m_emitting_object_instances.clear();
+    m_emitting_regions.clear();
+    m_emitting_triangle_entries.clear();
+
+    EmittingTriangleEntry empty_entry;
+    empty_entry.m_emitting_triangle_index = ~uint32(0);
+    empty_entry.m_pdf = 0.0f;
+
+    // Emitting triangles are collected object instance by object instance, by increasing
+    // region and triangle indices. Both sides of a two-sided emitter are consecutive.
+    const size_t emitting_triangle_count = m_emitting_triangles.size();
+    size_t begin = 0;
+
+    while (begin < emitting_triangle_count)
+    {
+        const EmittingTriangle& first_triangle = m_emitting_triangles[begin];
+
+        // Find the emitting triangles of this object instance.
+        size_t end = begin + 1;
+        while (end < emitting_triangle_count &&
+               m_emitting_triangles[end].m_assembly_instance == first_triangle.m_assembly_instance &&
+               m_emitting_triangles[end].m_object_instance_index == first_triangle.m_object_instance_index)
+            ++end;
+
+        EmittingObjectInstance object_instance;
+        object_instance.m_assembly_instance_uid = first_triangle.m_assembly_instance->get_uid();
+        object_instance.m_object_instance_index = first_triangle.m_object_instance_index;
+        object_instance.m_first_region = m_emitting_regions.size();
+        object_instance.m_region_count = m_emitting_triangles[end - 1].m_region_index + 1;
+        m_emitting_object_instances.push_back(object_instance);
+
+        // Each region covers the triangles between its first and its last emitting triangle.
+        EmittingRegion empty_region;
+        empty_region.m_first_entry = 0;
+        empty_region.m_first_triangle = 0;
+        empty_region.m_triangle_count = 0;
+        m_emitting_regions.resize(object_instance.m_first_region + object_instance.m_region_count, empty_region);
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            const EmittingTriangle& triangle = m_emitting_triangles[i];
+            EmittingRegion& region = m_emitting_regions[object_instance.m_first_region + triangle.m_region_index];
+
+            if (region.m_triangle_count == 0)
+            {
+                region.m_first_entry = m_emitting_triangle_entries.size();
+                region.m_first_triangle = triangle.m_triangle_index;
+            }
+
+            region.m_triangle_count = triangle.m_triangle_index - region.m_first_triangle + 1;
+            m_emitting_triangle_entries.resize(region.m_first_entry + region.m_triangle_count, empty_entry);
+
+            // The front side of a two-sided emitter is the one found at shading points.
+            EmittingTriangleEntry& entry =
+                m_emitting_triangle_entries[region.m_first_entry + region.m_triangle_count - 1];
+            if (entry.m_emitting_triangle_index == ~uint32(0))
+                entry.m_emitting_triangle_index = static_cast<uint32>(i);
+        }
+
+        begin = end;
+    }
+
+    sort(m_emitting_object_instances.begin(), m_emitting_object_instances.end());
+}
+
+void LightSampler::store_emitting_triangle_pdfs()
+{
+    for (size_t i = 0, e = m_emitting_triangle_entries.size(); i < e; ++i)
+    {
+        EmittingTriangleEntry& entry = m_emitting_triangle_entries[i];
+
+        if (entry.m_emitting_triangle_index != ~uint32(0))
+        {
+            const EmittingTriangle& triangle = m_emitting_triangles[entry.m_emitting_triangle_index];
+            entry.m_pdf = triangle.m_triangle_prob * triangle.m_rcp_area;
+        }
     }
 }
 
-void LightSampler::build_emitting_triangle_hash_table()
+const LightSampler::EmittingTriangleEntry* LightSampler::find_emitting_triangle(const ShadingPoint& shading_point) const
+{
+    EmittingObjectInstance key;
+    key.m_assembly_instance_uid = shading_point.get_assembly_instance().get_uid();
+    key.m_object_instance_index = shading_point.get_object_instance_index();
+
+    // Scenes have few object instances with emitting materials, even with millions of emitting triangles.
+    const EmittingObjectInstanceVector::const_iterator object_instance =
+        lower_bound(
+            m_emitting_object_instances.begin(),
+            m_emitting_object_instances.end(),
+            key);
+
+    if (object_instance == m_emitting_object_instances.end() || key < *object_instance)
+        return 0;
+
+    const size_t region_index = shading_point.get_region_index();
+    if (region_index >= object_instance->m_region_count)
+        return 0;
+
+    const EmittingRegion& region = m_emitting_regions[object_instance->m_first_region + region_index];
+    const size_t triangle_index = shading_point.get_primitive_index();
+    if (triangle_index < region.m_first_triangle ||
+        triangle_index - region.m_first_triangle >= region.m_triangle_count)
+        return 0;
+
+    const EmittingTriangleEntry& entry =
+        m_emitting_triangle_entries[region.m_first_entry + triangle_index - region.m_first_triangle];
+
+    return entry.m_emitting_triangle_index != ~uint32(0) ? &entry : 0;
+}
+
+void LightSampler::build_light_tree()
 {
     const size_t emitting_triangle_count = m_emitting_triangles.size();
 
-    m_emitting_triangle_hash_table.resize(
-        emitting_triangle_count > 0 ? next_pow2(emitting_triangle_count) : 0);
+    vector<LightTree::Item> items(emitting_triangle_count);
 
     for (size_t i = 0; i < emitting_triangle_count; ++i)
     {
         const EmittingTriangle& emitting_triangle = m_emitting_triangles[i];
+        LightTree::Item& item = items[i];
+
+        item.m_bbox.invalidate();
+        item.m_bbox.insert(emitting_triangle.m_v0);
+        item.m_bbox.insert(emitting_triangle.m_v1);
+        item.m_bbox.insert(emitting_triangle.m_v2);
+
+        // The cone of normals must contain the shading normals since emission is evaluated with respect to them.
+        const Vector3d& n = emitting_triangle.m_geometric_normal;
+        item.m_axis = Vector3f(n);
+        item.m_cos_theta_o =
+            static_cast<float>(
+                min(
+                    min(dot(n, emitting_triangle.m_n0), dot(n, emitting_triangle.m_n1)),
+                    min(dot(n, emitting_triangle.m_n2), 1.0)));
+
+        // Use the same relative power as the CDF of emitting triangles.
+        item.m_power = emitting_triangle.m_triangle_prob;
+    }
+
+    m_light_tree.build(items);
+}
+
+void LightSampler::build_light_sets(const AssemblyInstanceContainer& assembly_instances)
+{
+    for (const_each<AssemblyInstanceContainer> i = assembly_instances; i; ++i)
+    {
+        // Retrieve the assembly.
+        const Assembly& assembly = i->get_assembly();
+
+        // Recurse into child assembly instances.
+        build_light_sets(assembly.assembly_instances());
+
+        // Build the light sets of the object instances of this assembly.
+        for (const_each<ObjectInstanceContainer> j = assembly.object_instances(); j; ++j)
+        {
+            const ObjectInstance& object_instance = *j;
+
+            // Skip object instances without light links, and those already visited via another assembly instance.
+            if (!object_instance.has_light_links() || m_light_sets.count(&object_instance) > 0)
+                continue;
+
+            build_light_set(object_instance, m_light_sets[&object_instance]);
+        }
+    }
+}
 
-        const EmittingTriangleKey emitting_triangle_key(
-            emitting_triangle.m_assembly_instance->get_uid(),
-            emitting_triangle.m_object_instance_index,
-            emitting_triangle.m_region_index,
-            emitting_triangle.m_triangle_index);
+void LightSampler::build_light_set(
+    const ObjectInstance&               object_instance,
+    LightSet&                           light_set) const
+{
+    light_set.m_emitting_triangles_cdf.set_use_alias_table(m_params.m_alias_table_sampling);
 
-        m_emitting_triangle_hash_table.insert(emitting_triangle_key, &emitting_triangle);
+    // Collect the non-physical lights that illuminate this object instance.
+    for (size_t i = 0, e = m_non_physical_lights.size(); i < e; ++i)
+    {
+        if (object_instance.is_illuminated_by(m_non_physical_lights[i].m_light->get_name()))
+        {
+            light_set.m_non_physical_lights.push_back(i);
+            light_set.m_non_physical_lights_cdf.insert(i, m_non_physical_lights_cdf[i].second);
+        }
     }
+
+    // Collect the emitting triangles that illuminate this object instance.
+    // Emitting triangles of a given emitting object instance are contiguous.
+    const ObjectInstance* emitter = 0;
+    bool emitter_included = false;
+    for (size_t i = 0, e = m_emitting_triangles.size(); i < e; ++i)
+    {
+        const EmittingTriangle& triangle = m_emitting_triangles[i];
+        const ObjectInstance* triangle_emitter =
+            triangle.m_assembly_instance->get_assembly().object_instances().get_by_index(
+                triangle.m_object_instance_index);
+
+        if (triangle_emitter != emitter)
+        {
+            emitter = triangle_emitter;
+            emitter_included = object_instance.is_illuminated_by(emitter->get_name());
+        }
+
+        if (emitter_included)
+        {
+            light_set.m_emitting_triangles.push_back(i);
+            light_set.m_emitting_triangles_cdf.insert(i, triangle.m_triangle_prob);
+        }
+    }
+
+    if (light_set.m_non_physical_lights_cdf.valid())
+        light_set.m_non_physical_lights_cdf.prepare();
+    if (light_set.m_emitting_triangles_cdf.valid())
+        light_set.m_emitting_triangles_cdf.prepare();
+}
+
+const LightSampler::LightSet* LightSampler::find_light_set(const ShadingPoint& shading_point) const
+{
+    return
+        m_light_sets.empty()
+            ? 0
+            : find_light_set(&shading_point.get_object_instance());
+}
+
+bool LightSampler::has_lights_or_emitting_triangles(const ShadingPoint& shading_point) const
+{
+    if (const LightSet* light_set = find_light_set(shading_point))
+        return light_set->m_non_physical_lights_cdf.valid() || light_set->m_emitting_triangles_cdf.valid();
+
+    return has_lights_or_emitting_triangles();
+}
+
+bool LightSampler::has_emitting_triangles(const ShadingPoint& shading_point) const
+{
+    if (const LightSet* light_set = find_light_set(shading_point))
+        return light_set->m_emitting_triangles_cdf.valid();
+
+    return m_emitting_triangles_cdf.valid();
+}
+
+bool LightSampler::illuminates(
+    const size_t                        light_index,
+    const ShadingPoint&                 shading_point) const
+{
+    const LightSet* light_set = find_light_set(shading_point);
+
+    return
+        light_set == 0 ||
+        binary_search(
+            light_set->m_non_physical_lights.begin(),
+            light_set->m_non_physical_lights.end(),
+            light_index);
+}
+
+bool LightSampler::illuminates(
+    const ShadingPoint&                 light_shading_point,
+    const ObjectInstance*               object_instance) const
+{
+    const LightSet* light_set = find_light_set(object_instance);
+    if (light_set == 0)
+        return true;
+
+    const EmittingTriangleEntry* entry = find_emitting_triangle(light_shading_point);
+    if (entry == 0)
+        return false;
+
+    return
+        binary_search(
+            light_set->m_emitting_triangles.begin(),
+            light_set->m_emitting_triangles.end(),
+            static_cast<size_t>(entry->m_emitting_triangle_index));
 }
 
 void LightSampler::sample_non_physical_lights(
@@ -448,12 +944,108 @@ void LightSampler::sample_emitting_triangles(
     const ShadingRay::Time&             time,
     const Vector3f&                     s,
     LightSample&                        light_sample) const
+{
+    sample_emitting_triangles(time, s, 0, light_sample);
+}
+
+void LightSampler::sample_emitting_triangles(
+    const ShadingRay::Time&             time,
+    const Vector3f&                     s,
+    const ShadingPoint&                 shading_point,
+    LightSample&                        light_sample) const
+{
+    if (const LightSet* light_set = find_light_set(shading_point))
+    {
+        assert(light_set->m_emitting_triangles_cdf.valid());
+
+        const EmitterCDF::ItemWeightPair result = light_set->m_emitting_triangles_cdf.sample(s[0]);
+
+        light_sample.m_light = 0;
+        sample_emitting_triangle(
+            time,
+            Vector2f(s[1], s[2]),
+            result.first,
+            result.second,
+            light_sample);
+    }
+    else sample_emitting_triangles(time, s, &shading_point.get_point(), light_sample);
+}
+
+void LightSampler::sample(
+    const ShadingRay::Time&             time,
+    const Vector3f&                     s,
+    LightSample&                        light_sample) const
+{
+    sample(time, s, 0, light_sample);
+}
+
+void LightSampler::sample(
+    const ShadingRay::Time&             time,
+    const Vector3f&                     s,
+    const ShadingPoint&                 shading_point,
+    LightSample&                        light_sample) const
+{
+    if (const LightSet* light_set = find_light_set(shading_point))
+        sample(time, s, *light_set, light_sample);
+    else sample(time, s, &shading_point.get_point(), light_sample);
+}
+
+float LightSampler::evaluate_pdf(
+    const ShadingPoint&                 shading_point,
+    const ObjectInstance*               object_instance) const
+{
+    assert(shading_point.is_triangle_primitive());
+
+    const EmittingTriangleEntry* entry = find_emitting_triangle(shading_point);
+    if (entry == 0)
+        return 0.0f;
+
+    const size_t triangle_index = entry->m_emitting_triangle_index;
+
+    if (const LightSet* light_set = find_light_set(object_instance))
+    {
+        const vector<size_t>::const_iterator it =
+            lower_bound(
+                light_set->m_emitting_triangles.begin(),
+                light_set->m_emitting_triangles.end(),
+                triangle_index);
+
+        if (it == light_set->m_emitting_triangles.end() || *it != triangle_index)
+            return 0.0f;
+
+        const size_t item_index = it - light_set->m_emitting_triangles.begin();
+        return light_set->m_emitting_triangles_cdf[item_index].second * m_emitting_triangles[triangle_index].m_rcp_area;
+    }
+
+    if (!m_light_tree.empty())
+    {
+        const float triangle_prob =
+            m_light_tree.evaluate_pdf(shading_point.get_ray().m_org, triangle_index);
+        return triangle_prob * m_emitting_triangles[triangle_index].m_rcp_area;
+    }
+
+    return entry->m_pdf;
+}
+
+void LightSampler::sample_emitting_triangles(
+    const ShadingRay::Time&             time,
+    const Vector3f&                     s,
+    const Vector3d*                     point,
+    LightSample&                        light_sample) const
 {
     assert(m_emitting_triangles_cdf.valid());
 
-    const EmitterCDF::ItemWeightPair result = m_emitting_triangles_cdf.sample(s[0]);
-    const size_t emitter_index = result.first;
-    const float emitter_prob = result.second;
+    size_t emitter_index;
+    float emitter_prob;
+
+    if (point && !m_light_tree.empty())
+        emitter_index = m_light_tree.sample(*point, s[0], emitter_prob);
+    else
+    {
+        const EmitterCDF::ItemWeightPair result = m_emitting_triangles_cdf.sample(s[0]);
+        emitter_index = result.first;
+        emitter_prob = result.second;
+    }
 
     light_sample.m_light = 0;
     sample_emitting_triangle(
@@ -470,6 +1062,7 @@ void LightSampler::sample_emitting_triangles(
 void LightSampler::sample(
     const ShadingRay::Time&             time,
     const Vector3f&                     s,
+    const Vector3d*                     point,
     LightSample&                        light_sample) const
 {
     assert(m_non_physical_lights_cdf.valid() || m_emitting_triangles_cdf.valid());
@@ -490,6 +1083,7 @@ void LightSampler::sample(
                 sample_emitting_triangles(
                     time,
                     Vector3f((s[0] - 0.5f) * 2.0f, s[1], s[2]),
+                    point,
                     light_sample);
             }
 
@@ -497,21 +1091,45 @@ void LightSampler::sample(
         }
         else sample_non_physical_lights(time, s, light_sample);
     }
-    else sample_emitting_triangles(time, s, light_sample);
+    else sample_emitting_triangles(time, s, point, light_sample);
 }
 
-float LightSampler::evaluate_pdf(const ShadingPoint& shading_point) const
+void LightSampler::sample(
+    const ShadingRay::Time&             time,
+    const Vector3f&                     s,
+    const LightSet&                     light_set,
+    LightSample&                        light_sample) const
 {
-    assert(shading_point.is_triangle_primitive());
+    const EmitterCDF& lights_cdf = light_set.m_non_physical_lights_cdf;
+    const EmitterCDF& triangles_cdf = light_set.m_emitting_triangles_cdf;
 
-    const EmittingTriangleKey triangle_key(
-        shading_point.get_assembly_instance().get_uid(),
-        shading_point.get_object_instance_index(),
-        shading_point.get_region_index(),
-        shading_point.get_primitive_index());
+    assert(lights_cdf.valid() || triangles_cdf.valid());
 
-    const EmittingTriangle* triangle = m_emitting_triangle_hash_table.get(triangle_key);
-    return triangle->m_triangle_prob * triangle->m_rcp_area;
+    // Pick between non-physical lights and emitting triangles as in the unlinked case.
+    Vector3f u = s;
+    float set_prob = 1.0f;
+    bool sample_lights = lights_cdf.valid();
+    if (lights_cdf.valid() && triangles_cdf.valid())
+    {
+        sample_lights = s[0] < 0.5f;
+        u[0] = sample_lights ? s[0] * 2.0f : (s[0] - 0.5f) * 2.0f;
+        set_prob = 0.5f;
+    }
+
+    if (sample_lights)
+    {
+        const EmitterCDF::ItemWeightPair result = lights_cdf.sample(u[0]);
+        light_sample.m_triangle = 0;
+        sample_non_physical_light(time, result.first, result.second, light_sample);
+    }
+    else
+    {
+        const EmitterCDF::ItemWeightPair result = triangles_cdf.sample(u[0]);
+        light_sample.m_light = 0;
+        sample_emitting_triangle(time, Vector2f(u[1], u[2]), result.first, result.second, light_sample);
+    }
+
+    light_sample.m_probability *= set_prob;
 }
 
 void LightSampler::sample_non_physical_light(
@@ -524,6 +1142,8 @@ void LightSampler::sample_non_physical_light(
     const NonPhysicalLightInfo& light_info = m_non_physical_lights[light_index];
     light_sample.m_light = light_info.m_light;
 
+    APPLESEED_HOT_PATH_COUNT(hot_path_counters().m_light_samples.increment(light_info.m_light->get_model()));
+
     // Evaluate and store the transform of the light.
     light_sample.m_light_transform =
           light_info.m_light->get_transform()
@@ -542,11 +1162,12 @@ void LightSampler::sample_emitting_triangle(
 {
     // Fetch the emitting triangle.
     const EmittingTriangle& emitting_triangle = m_emitting_triangles[triangle_index];
-    assert(emitting_triangle.m_triangle_prob == triangle_prob);
 
     // Store a pointer to the emitting triangle.
     light_sample.m_triangle = &emitting_triangle;
 
+    APPLESEED_HOT_PATH_COUNT(hot_path_counters().m_light_samples.increment("emitting triangle"));
+
     // Uniformly sample the surface of the triangle.
     const Vector3d bary = sample_triangle_uniform(Vector2d(s));
 
@@ -574,11 +1195,49 @@ void LightSampler::sample_emitting_triangle(
     light_sample.m_probability = triangle_prob * emitting_triangle.m_rcp_area;
 }
 
+void LightSampler::store_object_areas_in_shadergroups() const
+{
+    // Emitting triangles of a given emitting object instance are contiguous.
+    size_t begin = 0;
+    const size_t emitting_triangle_count = m_emitting_triangles.size();
+
+    while (begin < emitting_triangle_count)
+    {
+        const EmittingTriangle& first = m_emitting_triangles[begin];
+
+        // Accumulate the area of the emitting triangles of this object instance.
+        double object_area = 0.0;
+        size_t end = begin;
+        while (end < emitting_triangle_count &&
+               m_emitting_triangles[end].m_assembly_instance == first.m_assembly_instance &&
+               m_emitting_triangles[end].m_object_instance_index == first.m_object_instance_index)
+            object_area += m_emitting_triangles[end++].m_area;
+
+        const ObjectInstance* object_instance =
+            first.m_assembly_instance->get_assembly().object_instances().get_by_index(
+                first.m_object_instance_index);
+
+        store_object_area_in_shadergroups(
+            first.m_assembly_instance,
+            object_instance,
+            static_cast<float>(object_area),
+            object_instance->get_front_materials());
+
+        store_object_area_in_shadergroups(
+            first.m_assembly_instance,
+            object_instance,
+            static_cast<float>(object_area),
+            object_instance->get_back_materials());
+
+        begin = end;
+    }
+}
+
 void LightSampler::store_object_area_in_shadergroups(
     const AssemblyInstance*             assembly_instance,
     const ObjectInstance*               object_instance,
     const float                         object_area,
-    const MaterialArray&                materials)
+    const MaterialArray&                materials) const
 {
     for (size_t i = 0, e = materials.size(); i < e; ++i)
     {
@@ -600,6 +1259,8 @@ void LightSampler::store_object_area_in_shadergroups(
 
 LightSampler::Parameters::Parameters(const ParamArray& params)
   : m_importance_sampling(params.get_optional<bool>("enable_importance_sampling", false))
+  , m_light_tree(params.get_optional<bool>("enable_light_tree", false))
+  , m_alias_table_sampling(params.get_optional<bool>("enable_alias_table_sampling", false))
 {
 }
 
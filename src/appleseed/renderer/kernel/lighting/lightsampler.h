@@ -32,35 +32,38 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/lighting/lighttree.h"
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/modeling/scene/containers.h"
 #include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aliastable.h"
 #include "foundation/math/cdf.h"
-#include "foundation/math/hash.h"
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
-#include "foundation/utility/containers/hashtable.h"
 #include "foundation/utility/uid.h"
 
 // Standard headers.
 #include <cstddef>
+#include <map>
+#include <utility>
 #include <vector>
 
 // Forward declarations.
-namespace renderer  { class Assembly; }
-namespace renderer  { class AssemblyInstance; }
-namespace renderer  { class Intersector; }
-namespace renderer  { class Light; }
-namespace renderer  { class Material; }
-namespace renderer  { class MaterialArray; }
-namespace renderer  { class ObjectInstance; }
-namespace renderer  { class ParamArray; }
-namespace renderer  { class Scene; }
-namespace renderer  { class ShadingPoint; }
+namespace foundation    { class Dictionary; }
+namespace renderer      { class Assembly; }
+namespace renderer      { class AssemblyInstance; }
+namespace renderer      { class Intersector; }
+namespace renderer      { class Light; }
+namespace renderer      { class Material; }
+namespace renderer      { class MaterialArray; }
+namespace renderer      { class ObjectInstance; }
+namespace renderer      { class ParamArray; }
+namespace renderer      { class Scene; }
+namespace renderer      { class ShadingPoint; }
 
 namespace renderer
 {
@@ -92,51 +95,13 @@ class EmittingTriangle
     foundation::Vector3d        m_n0, m_n1, m_n2;               // world space vertex normals
     foundation::Vector3d        m_geometric_normal;             // world space geometric normal, unit-length
     TriangleSupportPlaneType    m_triangle_support_plane;       // support plane of the triangle in assembly space
+    float                       m_area;                         // world space triangle area
     float                       m_rcp_area;                     // world space triangle area reciprocal
-    float                       m_triangle_prob;                // probability density of this triangle
+    float                       m_triangle_prob;                // probability of this triangle when sampling without a light tree
     const Material*             m_material;
 };
 
 
-//
-// A key to uniquely identify a light-emitting triangle in a hash table.
-//
-
-class EmittingTriangleKey
-{
-  public:
-    foundation::UniqueID            m_assembly_instance_uid;
-    foundation::uint32              m_object_instance_index;
-    foundation::uint32              m_region_index;
-    foundation::uint32              m_triangle_index;
-
-    EmittingTriangleKey();
-    EmittingTriangleKey(
-        const foundation::UniqueID  assembly_instance_uid,
-        const size_t                object_instance_index,
-        const size_t                region_index,
-        const size_t                triangle_index);
-
-    bool operator==(const EmittingTriangleKey& rhs) const;
-};
-
-
-//
-// A hash table of light-emitting triangles.
-//
-
-struct EmittingTriangleKeyHasher
-{
-    size_t operator()(const EmittingTriangleKey& key) const;
-};
-
-typedef foundation::HashTable<
-    EmittingTriangleKey,
-    EmittingTriangleKeyHasher,
-    const EmittingTriangle*
-> EmittingTriangleHashTable;
-
-
 //
 // Light sample: the result of sampling the sets of non-physical lights and light-emitting triangles.
 //
@@ -166,10 +131,53 @@ class LightSample
 };
 
 
+//
+// Discrete distribution over light emitters.
+//
+// Emitters are selected by CDF inversion: consecutive low discrepancy samples select
+// emitters in order, so the stratification of the samples carries over to the emitters.
+// Alias tables select emitters in constant time, which matters with millions of emitting
+// triangles, but scramble the mapping from samples to emitters; they are opt-in.
+//
+
+class EmitterDistribution
+  : public foundation::NonCopyable
+{
+  public:
+    typedef std::pair<size_t, float> ItemWeightPair;
+
+    // Constructor.
+    EmitterDistribution();
+
+    // Sample with an alias table instead of inverting the CDF. Must be called before prepare().
+    void set_use_alias_table(const bool use_alias_table);
+    bool get_use_alias_table() const;
+
+    // Same interface as foundation::CDF<>.
+    bool valid() const;
+    void clear();
+    void insert(const size_t item, const float weight);
+    const ItemWeightPair& operator[](const size_t i) const;
+    void prepare();
+    const ItemWeightPair& sample(const float x) const;
+
+  private:
+    bool                                    m_use_alias_table;
+    foundation::CDF<size_t, float>          m_cdf;
+    foundation::AliasTable<size_t, float>   m_alias_table;
+};
+
+
 //
 // The light sampler collects all the light-emitting entities (non-physical lights, mesh lights)
 // and allows to sample them.
 //
+// Object instances may restrict the set of lights that illuminate them (light linking, see
+// ObjectInstance::is_illuminated_by()). For each such instance, the light sampler builds a
+// compact list of the lights that illuminate it, together with a CDF over these lights, such
+// that excluded lights are never sampled when illuminating points of this instance. The light
+// tree is not used for these instances.
+//
 
 class LightSampler
   : public foundation::NonCopyable
@@ -180,6 +188,15 @@ class LightSampler
         const Scene&                        scene,
         const ParamArray&                   params = ParamArray());
 
+    // Update the light sampler after the scene was modified. Nothing is rebuilt if neither the
+    // lights nor the emitters changed, e.g. between frames of a sequence that only animates the
+    // camera. Light-emitting triangles are only collected again if the emitting geometry changed;
+    // otherwise only the sampling CDFs, the light tree and the light sets are rebuilt, e.g. when
+    // a light or an EDF was edited. Input binding must have taken place.
+    void update(const Scene& scene);
+
+    static foundation::Dictionary get_params_metadata();
+
     // Return the number of non-physical lights in the scene.
     size_t get_non_physical_light_count() const;
 
@@ -189,6 +206,23 @@ class LightSampler
     // Return true if the scene contains at least one light or emitting triangle.
     bool has_lights_or_emitting_triangles() const;
 
+    // Return true if at least one light or emitting triangle illuminates a given shading point.
+    bool has_lights_or_emitting_triangles(const ShadingPoint& shading_point) const;
+
+    // Return true if at least one emitting triangle illuminates a given shading point.
+    bool has_emitting_triangles(const ShadingPoint& shading_point) const;
+
+    // Return true if a given non-physical light illuminates a given shading point.
+    bool illuminates(
+        const size_t                        light_index,
+        const ShadingPoint&                 shading_point) const;
+
+    // Return true if the emitting triangle at `light_shading_point` illuminates a given object
+    // instance. All lights illuminate a null object instance.
+    bool illuminates(
+        const ShadingPoint&                 light_shading_point,
+        const ObjectInstance*               object_instance) const;
+
     // Sample the set of non-physical lights.
     void sample_non_physical_lights(
         const ShadingRay::Time&             time,
@@ -207,26 +241,91 @@ class LightSampler
         const foundation::Vector3f&         s,
         LightSample&                        light_sample) const;
 
+    // Sample the set of emitting triangles for the illumination of a given shading point.
+    // If the light tree is enabled, triangles are chosen according to their estimated
+    // contribution at the shading point.
+    void sample_emitting_triangles(
+        const ShadingRay::Time&             time,
+        const foundation::Vector3f&         s,
+        const ShadingPoint&                 shading_point,
+        LightSample&                        light_sample) const;
+
     // Sample the sets of non-physical lights and emitting triangles.
     void sample(
         const ShadingRay::Time&             time,
         const foundation::Vector3f&         s,
         LightSample&                        light_sample) const;
 
-    // Compute the probability density in area measure of a given light sample.
-    float evaluate_pdf(const ShadingPoint& shading_point) const;
+    // Sample the sets of non-physical lights and emitting triangles for the illumination of a given shading point.
+    void sample(
+        const ShadingRay::Time&             time,
+        const foundation::Vector3f&         s,
+        const ShadingPoint&                 shading_point,
+        LightSample&                        light_sample) const;
+
+    // Compute the probability density in area measure of a given light sample. If the light tree
+    // is enabled, this is the density of the sample_*() methods that take a shading point, given
+    // that the illuminated point is the origin of the ray that hit the light (`shading_point`).
+    // If an illuminated object instance is provided, its light links are taken into account.
+    float evaluate_pdf(
+        const ShadingPoint&                 shading_point,
+        const ObjectInstance*               object_instance = 0) const;
 
   private:
     struct Parameters
     {
         const bool m_importance_sampling;
+        const bool m_light_tree;
+        const bool m_alias_table_sampling;
 
         explicit Parameters(const ParamArray& params);
     };
 
     typedef std::vector<NonPhysicalLightInfo> NonPhysicalLightVector;
     typedef std::vector<EmittingTriangle> EmittingTriangleVector;
-    typedef foundation::CDF<size_t, float> EmitterCDF;
+
+    typedef EmitterDistribution EmitterCDF;
+
+    // Lookup data of a triangle of an object instance with emitting materials.
+    struct EmittingTriangleEntry
+    {
+        foundation::uint32      m_emitting_triangle_index;  // ~0 if the triangle doesn't emit light
+        float                   m_pdf;                      // area measure density when sampling without a light tree
+    };
+
+    // The range of lookup table entries of a region, from its first to its last emitting triangle.
+    struct EmittingRegion
+    {
+        size_t                  m_first_entry;
+        size_t                  m_first_triangle;
+        size_t                  m_triangle_count;
+    };
+
+    // An object instance with emitting triangles.
+    struct EmittingObjectInstance
+    {
+        foundation::UniqueID    m_assembly_instance_uid;
+        size_t                  m_object_instance_index;
+        size_t                  m_first_region;             // index of its first region in m_emitting_regions
+        size_t                  m_region_count;
+
+        bool operator<(const EmittingObjectInstance& rhs) const;
+    };
+
+    typedef std::vector<EmittingTriangleEntry> EmittingTriangleEntryVector;
+    typedef std::vector<EmittingRegion> EmittingRegionVector;
+    typedef std::vector<EmittingObjectInstance> EmittingObjectInstanceVector;
+
+    // The set of lights that illuminate a given object instance.
+    struct LightSet
+    {
+        std::vector<size_t>     m_non_physical_lights;      // sorted indices of non-physical lights
+        std::vector<size_t>     m_emitting_triangles;       // sorted indices of emitting triangles
+        EmitterCDF              m_non_physical_lights_cdf;
+        EmitterCDF              m_emitting_triangles_cdf;
+    };
+
+    typedef std::map<const ObjectInstance*, LightSet> LightSetMap;
 
     const Parameters            m_params;
 
@@ -238,8 +337,31 @@ class LightSampler
     EmitterCDF                  m_non_physical_lights_cdf;
     EmitterCDF                  m_emitting_triangles_cdf;
 
-    EmittingTriangleKeyHasher   m_triangle_key_hasher;
-    EmittingTriangleHashTable   m_emitting_triangle_hash_table;
+    // Emitting triangles are found from shading points by looking up their object instance
+    // in a short sorted list, then their entry in a dense array indexed by triangle.
+    EmittingObjectInstanceVector m_emitting_object_instances;   // sorted
+    EmittingRegionVector        m_emitting_regions;
+    EmittingTriangleEntryVector m_emitting_triangle_entries;
+
+    LightTree                   m_light_tree;
+
+    LightSetMap                 m_light_sets;
+
+    foundation::uint64          m_emitting_geometry_signature;
+    foundation::uint64          m_lighting_signature;
+
+    // Compute a signature of everything the collected emitting triangles depend on.
+    static foundation::uint64 compute_emitting_geometry_signature(const Scene& scene);
+    static foundation::uint64 compute_emitting_geometry_signature(
+        const AssemblyInstanceContainer&    assembly_instances,
+        const foundation::uint64            parent_signature);
+
+    // Compute a signature of everything the light sampler depends on: the emitting geometry,
+    // the lights, and the EDFs, materials, shaders, textures and colors that may drive emission.
+    static foundation::uint64 compute_lighting_signature(const Scene& scene);
+    static foundation::uint64 compute_lighting_signature(
+        const AssemblyInstanceContainer&    assembly_instances,
+        const foundation::uint64            parent_signature);
 
     // Recursively collect non-physical lights from a given set of assembly instances.
     void collect_non_physical_lights(
@@ -262,8 +384,56 @@ class LightSampler
         const AssemblyInstance&             assembly_instance,
         const TransformSequence&            transform_sequence);
 
-    // Build a hash table that allows to find the emitting triangle at a given shading point.
-    void build_emitting_triangle_hash_table();
+    // Compute the weight of an emitting triangle in the CDF of emitting triangles.
+    float compute_emitting_triangle_weight(const EmittingTriangle& emitting_triangle) const;
+
+    // Prepare the CDFs, the light tree and the light sets once emitters have been collected.
+    void prepare_sampling(const Scene& scene);
+
+    // Build the lookup table that allows to find the emitting triangle at a given shading point.
+    void build_emitting_triangle_lookup_table();
+
+    // Store the area measure densities of the emitting triangles into the lookup table.
+    void store_emitting_triangle_pdfs();
+
+    // Return the lookup table entry of the emitting triangle at a given shading point, or 0.
+    const EmittingTriangleEntry* find_emitting_triangle(const ShadingPoint& shading_point) const;
+
+    // Build the light tree over emitting triangles.
+    void build_light_tree();
+
+    // Recursively build the light sets of the object instances with light links.
+    void build_light_sets(const AssemblyInstanceContainer& assembly_instances);
+
+    // Build the light set of a given object instance.
+    void build_light_set(
+        const ObjectInstance&               object_instance,
+        LightSet&                           light_set) const;
+
+    // Return the light set of a given object instance, or 0 if it is illuminated by all lights.
+    const LightSet* find_light_set(const ObjectInstance* object_instance) const;
+    const LightSet* find_light_set(const ShadingPoint& shading_point) const;
+
+    // Sample the set of emitting triangles, for the illumination of a given point if one is provided.
+    void sample_emitting_triangles(
+        const ShadingRay::Time&             time,
+        const foundation::Vector3f&         s,
+        const foundation::Vector3d*         point,
+        LightSample&                        light_sample) const;
+
+    // Sample the sets of non-physical lights and emitting triangles, for the illumination of a given point if one is provided.
+    void sample(
+        const ShadingRay::Time&             time,
+        const foundation::Vector3f&         s,
+        const foundation::Vector3d*         point,
+        LightSample&                        light_sample) const;
+
+    // Sample the sets of non-physical lights and emitting triangles of a given light set.
+    void sample(
+        const ShadingRay::Time&             time,
+        const foundation::Vector3f&         s,
+        const LightSet&                     light_set,
+        LightSample&                        light_sample) const;
 
     // Sample a given non-physical light.
     void sample_non_physical_light(
@@ -280,56 +450,71 @@ class LightSampler
         const float                         triangle_prob,
         LightSample&                        sample) const;
 
+    // Store the surface area of the emitting object instances into their OSL shader groups.
+    void store_object_areas_in_shadergroups() const;
+
     void store_object_area_in_shadergroups(
         const AssemblyInstance*             assembly_instance,
         const ObjectInstance*               object_instance,
         const float                         object_area,
-        const MaterialArray&                materials);
+        const MaterialArray&                materials) const;
 };
 
 
 //
-// EmittingTriangleKey class implementation.
+// EmitterDistribution class implementation.
 //
 
-inline EmittingTriangleKey::EmittingTriangleKey()
+inline EmitterDistribution::EmitterDistribution()
+  : m_use_alias_table(false)
 {
 }
 
-inline EmittingTriangleKey::EmittingTriangleKey(
-    const foundation::UniqueID              assembly_instance_uid,
-    const size_t                            object_instance_index,
-    const size_t                            region_index,
-    const size_t                            triangle_index)
-  : m_assembly_instance_uid(static_cast<foundation::uint32>(assembly_instance_uid))
-  , m_object_instance_index(static_cast<foundation::uint32>(object_instance_index))
-  , m_region_index(static_cast<foundation::uint32>(region_index))
-  , m_triangle_index(static_cast<foundation::uint32>(triangle_index))
+inline void EmitterDistribution::set_use_alias_table(const bool use_alias_table)
 {
+    m_use_alias_table = use_alias_table;
 }
 
-inline bool EmittingTriangleKey::operator==(const EmittingTriangleKey& rhs) const
+inline bool EmitterDistribution::get_use_alias_table() const
 {
-    return
-        m_triangle_index == rhs.m_triangle_index &&
-        m_object_instance_index == rhs.m_object_instance_index &&
-        m_assembly_instance_uid == rhs.m_assembly_instance_uid &&
-        m_region_index == rhs.m_region_index;
+    return m_use_alias_table;
 }
 
+inline bool EmitterDistribution::valid() const
+{
+    return m_cdf.valid();
+}
 
-//
-// EmittingTriangleKeyHasher class implementation.
-//
+inline void EmitterDistribution::clear()
+{
+    m_cdf.clear();
+    m_alias_table.clear();
+}
 
-inline size_t EmittingTriangleKeyHasher::operator()(const EmittingTriangleKey& key) const
+inline void EmitterDistribution::insert(const size_t item, const float weight)
 {
-    return
-        foundation::mix_uint32(
-            static_cast<foundation::uint32>(key.m_assembly_instance_uid),
-            key.m_object_instance_index,
-            key.m_region_index,
-            key.m_triangle_index);
+    m_cdf.insert(item, weight);
+
+    if (m_use_alias_table)
+        m_alias_table.insert(item, weight);
+}
+
+inline const EmitterDistribution::ItemWeightPair& EmitterDistribution::operator[](const size_t i) const
+{
+    return m_cdf[i];
+}
+
+inline void EmitterDistribution::prepare()
+{
+    m_cdf.prepare();
+
+    if (m_use_alias_table)
+        m_alias_table.prepare();
+}
+
+inline const EmitterDistribution::ItemWeightPair& EmitterDistribution::sample(const float x) const
+{
+    return m_use_alias_table ? m_alias_table.sample(x) : m_cdf.sample(x);
 }
 
 
@@ -337,6 +522,13 @@ inline size_t EmittingTriangleKeyHasher::operator()(const EmittingTriangleKey& k
 // LightSampler class implementation.
 //
 
+inline bool LightSampler::EmittingObjectInstance::operator<(const EmittingObjectInstance& rhs) const
+{
+    return
+        m_assembly_instance_uid < rhs.m_assembly_instance_uid ||
+        (m_assembly_instance_uid == rhs.m_assembly_instance_uid && m_object_instance_index < rhs.m_object_instance_index);
+}
+
 inline size_t LightSampler::get_non_physical_light_count() const
 {
     return m_non_physical_light_count;
@@ -352,6 +544,15 @@ inline bool LightSampler::has_lights_or_emitting_triangles() const
     return m_non_physical_lights_cdf.valid() || m_emitting_triangles_cdf.valid();
 }
 
+inline const LightSampler::LightSet* LightSampler::find_light_set(const ObjectInstance* object_instance) const
+{
+    if (m_light_sets.empty() || object_instance == 0)
+        return 0;
+
+    const LightSetMap::const_iterator i = m_light_sets.find(object_instance);
+    return i != m_light_sets.end() ? &i->second : 0;
+}
+
 inline void LightSampler::sample_non_physical_light(
     const ShadingRay::Time&                 time,
     const size_t                            light_index,
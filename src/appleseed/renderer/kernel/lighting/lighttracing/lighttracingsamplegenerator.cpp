@@ -58,6 +58,7 @@
 #include "renderer/modeling/project/project.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/hotpathcounters.h"
 #include "renderer/utility/settingsparsing.h"
 #include "renderer/utility/transformsequence.h"
 
@@ -66,6 +67,7 @@
 #include "foundation/image/color.h"
 #include "foundation/image/image.h"
 #include "foundation/math/basis.h"
+#include "foundation/math/hash.h"
 #include "foundation/math/population.h"
 #include "foundation/math/sampling/mappings.h"
 #include "foundation/math/scalar.h"
@@ -122,6 +124,8 @@ namespace
             const size_t                m_max_path_length;              // maximum path length, ~0 for unlimited
             const size_t                m_rr_min_path_length;           // minimum path length before Russian Roulette kicks in, ~0 for unlimited
 
+            const bool                  m_private_splat_buffers;        // accumulate samples into per-thread framebuffers?
+
             explicit Parameters(const ParamArray& params)
               : m_sampling_mode(get_sampling_context_mode(params))
               , m_enable_ibl(params.get_optional<bool>("enable_ibl", true))
@@ -131,6 +135,7 @@ namespace
               , m_report_self_intersections(params.get_optional<bool>("report_self_intersections", false))
               , m_max_path_length(nz(params.get_optional<size_t>("max_path_length", 0)))
               , m_rr_min_path_length(nz(params.get_optional<size_t>("rr_min_path_length", 3)))
+              , m_private_splat_buffers(params.get_optional<bool>("private_splat_buffers", false))
             {
             }
 
@@ -146,11 +151,13 @@ namespace
                     "  ibl              %s\n"
                     "  caustics         %s\n"
                     "  max path length  %s\n"
-                    "  rr min path len. %s",
+                    "  rr min path len. %s\n"
+                    "  private splats   %s",
                     m_enable_ibl ? "on" : "off",
                     m_enable_caustics ? "on" : "off",
                     m_max_path_length == size_t(~0) ? "infinite" : pretty_uint(m_max_path_length).c_str(),
-                    m_rr_min_path_length == size_t(~0) ? "infinite" : pretty_uint(m_rr_min_path_length).c_str());
+                    m_rr_min_path_length == size_t(~0) ? "infinite" : pretty_uint(m_rr_min_path_length).c_str(),
+                    m_private_splat_buffers ? "on" : "off");
             }
         };
 
@@ -167,6 +174,7 @@ namespace
             const ParamArray&           params)
           : SampleGeneratorBase(generator_index, generator_count)
           , m_params(params)
+          , m_generator_index(generator_index)
           , m_scene(*project.get_scene())
           , m_frame(frame)
           , m_light_sampler(light_sampler)
@@ -230,6 +238,23 @@ namespace
                 .increment_sample_count(m_light_sample_count);
         }
 
+        virtual void store_samples(
+            const size_t                sample_count,
+            const Sample                samples[],
+            SampleAccumulationBuffer&   buffer,
+            IAbortSwitch&               abort_switch) APPLESEED_OVERRIDE
+        {
+            // Samples land anywhere in the image: accumulating them into a framebuffer private
+            // to this generator avoids contending with other threads splatting into the same
+            // regions, at the cost of one full resolution framebuffer per rendering thread.
+            if (m_params.m_private_splat_buffers)
+            {
+                static_cast<GlobalSampleAccumulationBuffer&>(buffer)
+                    .store_private_samples(m_generator_index, sample_count, samples, abort_switch);
+            }
+            else SampleGeneratorBase::store_samples(sample_count, samples, buffer, abort_switch);
+        }
+
         virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
         {
             Statistics stats;
@@ -427,6 +452,7 @@ namespace
                         shading_normal);
 
                 // Evaluate the BSDF at the vertex position.
+                APPLESEED_HOT_PATH_COUNT(hot_path_counters().m_bsdf_evaluations.increment(vertex.m_bsdf->get_model()));
                 Spectrum bsdf_value;
                 const float bsdf_prob =
                     vertex.m_bsdf->evaluate(
@@ -483,6 +509,7 @@ namespace
         typedef PathTracer<PathVisitor, true> PathTracerType;   // true = adjoint
 
         const Parameters                m_params;
+        const size_t                    m_generator_index;
 
         const Scene&                    m_scene;
         const Frame&                    m_frame;
@@ -517,6 +544,10 @@ namespace
         {
             m_arena.clear();
 
+            // Derive the random stream from the sequence index alone so that the light paths
+            // don't depend on which thread happens to generate them.
+            m_rng = SamplingContext::RNGType(0, hash_uint64(static_cast<uint64>(sequence_index)));
+
             SamplingContext sampling_context(
                 m_rng,
                 m_params.m_sampling_mode,
@@ -890,6 +921,7 @@ SampleAccumulationBuffer* LightTracingSampleGeneratorFactory::create_sample_accu
         new GlobalSampleAccumulationBuffer(
             props.m_canvas_width,
             props.m_canvas_height,
+            m_frame.get_crop_window(),
             m_frame.get_filter());
 }
 
@@ -0,0 +1,317 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "lighttree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// LightTree class implementation.
+//
+
+namespace
+{
+    // Largest float strictly smaller than 1.
+    const float OneMinusEpsilon = 0.99999994f;
+
+    struct Cone
+    {
+        Vector3f    m_axis;
+        float       m_theta_o;
+
+        Cone(const Vector3f& axis, const float theta_o)
+          : m_axis(axis)
+          , m_theta_o(theta_o)
+        {
+        }
+    };
+
+    // Compute a cone bounding two cones.
+    Cone merge_cones(const Cone& lhs, const Cone& rhs)
+    {
+        const Cone& a = lhs.m_theta_o >= rhs.m_theta_o ? lhs : rhs;
+        const Cone& b = lhs.m_theta_o >= rhs.m_theta_o ? rhs : lhs;
+
+        const float theta_d = acos(clamp(dot(a.m_axis, b.m_axis), -1.0f, 1.0f));
+
+        // The widest cone already contains the other one.
+        if (min(theta_d + b.m_theta_o, Pi<float>()) <= a.m_theta_o)
+            return a;
+
+        const float theta_o = 0.5f * (a.m_theta_o + theta_d + b.m_theta_o);
+        if (theta_o >= Pi<float>())
+            return Cone(a.m_axis, Pi<float>());
+
+        // Rotate the axis of the widest cone toward the axis of the other one.
+        const Vector3f ortho = b.m_axis - a.m_axis * dot(a.m_axis, b.m_axis);
+        const float ortho_norm = norm(ortho);
+        if (ortho_norm == 0.0f)
+            return Cone(a.m_axis, Pi<float>());
+
+        const float theta_r = theta_o - a.m_theta_o;
+        const Vector3f axis = a.m_axis * cos(theta_r) + ortho * (sin(theta_r) / ortho_norm);
+
+        return Cone(normalize(axis), theta_o);
+    }
+
+    struct CentroidPredicate
+    {
+        const vector<LightTree::Item>&  m_items;
+        const size_t                    m_dim;
+
+        CentroidPredicate(const vector<LightTree::Item>& items, const size_t dim)
+          : m_items(items)
+          , m_dim(dim)
+        {
+        }
+
+        bool operator()(const size_t lhs, const size_t rhs) const
+        {
+            return m_items[lhs].m_bbox.center(m_dim) < m_items[rhs].m_bbox.center(m_dim);
+        }
+    };
+}
+
+LightTree::LightTree()
+{
+}
+
+void LightTree::build(const vector<Item>& items)
+{
+    m_nodes.clear();
+    m_item_to_leaf.assign(items.size(), 0);
+
+    if (items.empty())
+        return;
+
+    vector<size_t> indices(items.size());
+    for (size_t i = 0, e = items.size(); i < e; ++i)
+        indices[i] = i;
+
+    m_nodes.reserve(2 * items.size() - 1);
+    build(items, indices, 0, items.size(), ~uint32(0));
+
+    assert(m_nodes.size() == 2 * items.size() - 1);
+}
+
+uint32 LightTree::build(
+    const vector<Item>&     items,
+    vector<size_t>&         indices,
+    const size_t            begin,
+    const size_t            end,
+    const uint32            parent)
+{
+    assert(begin < end);
+
+    const uint32 node_index = static_cast<uint32>(m_nodes.size());
+    m_nodes.push_back(Node());
+
+    Node node;
+    node.m_parent = parent;
+
+    if (end - begin == 1)
+    {
+        const size_t item_index = indices[begin];
+        const Item& item = items[item_index];
+
+        node.m_bbox = item.m_bbox;
+        node.m_axis = item.m_axis;
+        node.m_theta_o = acos(clamp(item.m_cos_theta_o, -1.0f, 1.0f));
+        node.m_power = item.m_power;
+        node.m_right = 0;
+        node.m_item = static_cast<uint32>(item_index);
+
+        m_item_to_leaf[item_index] = node_index;
+    }
+    else
+    {
+        // Split at the median of the centroids along the dimension where they spread the most.
+        AABB3d centroid_bbox = AABB3d::invalid();
+        for (size_t i = begin; i < end; ++i)
+            centroid_bbox.insert(items[indices[i]].m_bbox.center());
+
+        const size_t middle = (begin + end) / 2;
+        nth_element(
+            indices.begin() + begin,
+            indices.begin() + middle,
+            indices.begin() + end,
+            CentroidPredicate(items, max_index(centroid_bbox.extent())));
+
+        build(items, indices, begin, middle, node_index);
+        const uint32 right = build(items, indices, middle, end, node_index);
+
+        const Node& left_node = m_nodes[node_index + 1];
+        const Node& right_node = m_nodes[right];
+
+        const Cone cone =
+            merge_cones(
+                Cone(left_node.m_axis, left_node.m_theta_o),
+                Cone(right_node.m_axis, right_node.m_theta_o));
+
+        node.m_bbox = left_node.m_bbox;
+        node.m_bbox.insert(right_node.m_bbox);
+        node.m_axis = cone.m_axis;
+        node.m_theta_o = cone.m_theta_o;
+        node.m_power = left_node.m_power + right_node.m_power;
+        node.m_right = right;
+        node.m_item = ~uint32(0);
+    }
+
+    m_nodes[node_index] = node;
+
+    return node_index;
+}
+
+size_t LightTree::sample(
+    const Vector3d&         point,
+    const float             s,
+    float&                  probability) const
+{
+    assert(!empty());
+
+    size_t node_index = 0;
+    float u = s;
+    probability = 1.0f;
+
+    while (!m_nodes[node_index].is_leaf())
+    {
+        const Node& node = m_nodes[node_index];
+        const float left_prob = compute_left_probability(node, point);
+
+        if (u < left_prob)
+        {
+            u /= left_prob;
+            probability *= left_prob;
+            node_index = node_index + 1;
+        }
+        else
+        {
+            u = (u - left_prob) / (1.0f - left_prob);
+            probability *= 1.0f - left_prob;
+            node_index = node.m_right;
+        }
+
+        // Keep the rescaled sample in [0,1) despite rounding errors.
+        u = min(u, OneMinusEpsilon);
+    }
+
+    return m_nodes[node_index].m_item;
+}
+
+float LightTree::evaluate_pdf(
+    const Vector3d&         point,
+    const size_t            item_index) const
+{
+    assert(item_index < m_item_to_leaf.size());
+
+    float probability = 1.0f;
+
+    // Walk up from the leaf, accumulating the probability of every choice made by sample().
+    uint32 node_index = m_item_to_leaf[item_index];
+
+    while (node_index != 0)
+    {
+        const uint32 parent_index = m_nodes[node_index].m_parent;
+        const float left_prob = compute_left_probability(m_nodes[parent_index], point);
+
+        probability *= node_index == parent_index + 1 ? left_prob : 1.0f - left_prob;
+        node_index = parent_index;
+    }
+
+    return probability;
+}
+
+float LightTree::compute_importance(
+    const Node&             node,
+    const Vector3d&         point) const
+{
+    if (node.m_power == 0.0f)
+        return 0.0f;
+
+    const Vector3d d = point - node.m_bbox.center();
+    const double square_dist = square_norm(d);
+    const double radius = node.m_bbox.radius();
+    const double square_radius = max(radius * radius, 1.0e-12);
+
+    // Points inside the bounding sphere of the node may receive light from any of its emitters.
+    if (square_dist <= square_radius)
+        return static_cast<float>(node.m_power / square_radius);
+
+    // Bound the angle between the emission directions and the direction toward the point.
+    const double dist = sqrt(square_dist);
+    const float cos_theta = dot(node.m_axis, Vector3f(d / dist));
+    const float theta = acos(clamp(cos_theta, -1.0f, 1.0f));
+    const float theta_u = static_cast<float>(asin(min(radius / dist, 1.0)));
+    const float theta_prime = max(theta - node.m_theta_o - theta_u, 0.0f);
+
+    // The point lies outside the emission hemispheres of all the emitters of the node.
+    if (theta_prime >= HalfPi<float>())
+        return 0.0f;
+
+    return static_cast<float>(node.m_power * cos(theta_prime) / square_dist);
+}
+
+float LightTree::compute_left_probability(
+    const Node&             node,
+    const Vector3d&         point) const
+{
+    assert(!node.is_leaf());
+
+    const Node& left_node = *(&node + 1);
+    const Node& right_node = m_nodes[node.m_right];
+
+    float left_importance = compute_importance(left_node, point);
+    float right_importance = compute_importance(right_node, point);
+
+    // Fall back to power when neither child is estimated to contribute.
+    if (left_importance + right_importance == 0.0f)
+    {
+        left_importance = left_node.m_power;
+        right_importance = right_node.m_power;
+
+        if (left_importance + right_importance == 0.0f)
+            return 0.5f;
+    }
+
+    return left_importance / (left_importance + right_importance);
+}
+
+}   // namespace renderer
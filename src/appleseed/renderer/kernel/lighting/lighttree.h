@@ -0,0 +1,162 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_LIGHTTREE_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_LIGHTTREE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A bounding volume hierarchy over light emitters, used to choose emitters according
+// to their estimated contribution at a given point of the scene.
+//
+// Every node stores the bounding box of its emitters, their total power and a cone
+// that bounds their emission directions. The importance of a node for a given point
+// is a conservative estimate of the power it sends to that point:
+//
+//   Importance Sampling of Many Lights with Adaptive Tree Splitting
+//   Alejandro Conty Estevez, Christopher Kulla
+//   http://www.aconty.com/pdf/many-lights-hpg2018.pdf
+//
+// Each emitter is assumed to emit into the hemisphere around its emission directions.
+//
+
+class LightTree
+  : public foundation::NonCopyable
+{
+  public:
+    // An emitter to insert into the tree.
+    struct Item
+    {
+        foundation::AABB3d          m_bbox;                 // world space bounding box
+        foundation::Vector3f        m_axis;                 // world space axis of the cone of normals, unit-length
+        float                       m_cos_theta_o;          // cosine of the half-angle of the cone of normals
+        float                       m_power;                // relative power of the emitter
+    };
+
+    // Constructor.
+    LightTree();
+
+    // Build the tree. The index of an item in `items` identifies it in sample() and evaluate_pdf().
+    void build(const std::vector<Item>& items);
+
+    // Remove all items from the tree.
+    void clear();
+
+    // Return true if the tree contains no item.
+    bool empty() const;
+
+    // Return the number of nodes of the tree.
+    size_t get_node_count() const;
+
+    // Choose an item according to its estimated contribution at a given world space point.
+    // Return the index of the item and its probability.
+    size_t sample(
+        const foundation::Vector3d& point,
+        const float                 s,                      // sample in [0,1)
+        float&                      probability) const;
+
+    // Return the probability with which sample() chooses a given item at a given point.
+    float evaluate_pdf(
+        const foundation::Vector3d& point,
+        const size_t                item_index) const;
+
+  private:
+    struct Node
+    {
+        foundation::AABB3d          m_bbox;
+        foundation::Vector3f        m_axis;
+        float                       m_theta_o;              // half-angle of the cone of normals, in radians
+        float                       m_power;
+        foundation::uint32          m_parent;               // index of the parent node
+        foundation::uint32          m_right;                // index of the right child; the left child follows its parent
+        foundation::uint32          m_item;                 // index of the item for leaves, ~0 for interior nodes
+
+        bool is_leaf() const;
+    };
+
+    std::vector<Node>               m_nodes;
+    std::vector<foundation::uint32> m_item_to_leaf;
+
+    foundation::uint32 build(
+        const std::vector<Item>&    items,
+        std::vector<size_t>&        indices,
+        const size_t                begin,
+        const size_t                end,
+        const foundation::uint32    parent);
+
+    float compute_importance(
+        const Node&                 node,
+        const foundation::Vector3d& point) const;
+
+    // Return the probability of descending into the left child of a given interior node.
+    float compute_left_probability(
+        const Node&                 node,
+        const foundation::Vector3d& point) const;
+};
+
+
+//
+// LightTree class implementation.
+//
+
+inline void LightTree::clear()
+{
+    m_nodes.clear();
+    m_item_to_leaf.clear();
+}
+
+inline bool LightTree::empty() const
+{
+    return m_nodes.empty();
+}
+
+inline size_t LightTree::get_node_count() const
+{
+    return m_nodes.size();
+}
+
+inline bool LightTree::Node::is_leaf() const
+{
+    return m_item != ~foundation::uint32(0);
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_LIGHTTREE_H
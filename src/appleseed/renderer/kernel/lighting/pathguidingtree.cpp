@@ -0,0 +1,299 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "pathguidingtree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/cdf.h"
+#include "foundation/math/fp.h"
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// PathGuidingTree class implementation.
+//
+
+PathGuidingTree::PathGuidingTree(
+    const AABB3d&   bbox,
+    const size_t    spatial_threshold,
+    const size_t    max_depth)
+  : m_bbox(bbox)
+  , m_spatial_threshold(spatial_threshold)
+  , m_max_depth(max_depth)
+  , m_is_trained(false)
+{
+    Node root;
+    root.m_axis = ~uint32(0);
+    root.m_index = 0;
+    m_nodes.push_back(root);
+
+    Leaf leaf;
+    leaf.m_training.assign(BinCount, 0.0f);
+    leaf.m_record_count = 0;
+    m_leaves.push_back(leaf);
+}
+
+float PathGuidingTree::sample(
+    const Vector3d& point,
+    const Vector2f& s,
+    Vector3f&       direction) const
+{
+    assert(m_is_trained);
+
+    const vector<float>& cdf = find_leaf(point).m_cdf;
+    assert(cdf.size() == BinCount);
+
+    // Choose a bin and reuse the first sample to choose a point inside this bin.
+    const size_t bin = sample_cdf(cdf.begin(), cdf.end(), s[0]);
+    const float bin_prob = bin_probability(cdf, bin);
+    const float bin_begin = bin > 0 ? cdf[bin - 1] : 0.0f;
+    const float r = min((s[0] - bin_begin) / bin_prob, 0.999999f);
+
+    // Map the point of the bin to a direction.
+    const float phi = TwoPi<float>() * (static_cast<float>(bin % Resolution) + r) / Resolution;
+    const float cos_theta = 2.0f * (static_cast<float>(bin / Resolution) + s[1]) / Resolution - 1.0f;
+    const float sin_theta = sqrt(max(1.0f - cos_theta * cos_theta, 0.0f));
+    direction = Vector3f::make_unit_vector(cos_theta, sin_theta, cos(phi), sin(phi));
+
+    // All bins subtend a solid angle of 4*pi/BinCount steradians.
+    return bin_prob * (BinCount * RcpFourPi<float>());
+}
+
+float PathGuidingTree::evaluate_pdf(
+    const Vector3d& point,
+    const Vector3f& direction) const
+{
+    assert(m_is_trained);
+
+    const vector<float>& cdf = find_leaf(point).m_cdf;
+    assert(cdf.size() == BinCount);
+
+    return
+          bin_probability(cdf, direction_to_bin(direction))
+        * (BinCount * RcpFourPi<float>());
+}
+
+void PathGuidingTree::append(const RecordVector& records)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    for (size_t i = 0, e = records.size(); i < e; ++i)
+    {
+        const Record& record = records[i];
+
+        // Ignore invalid records rather than corrupting the histograms.
+        if (!(record.m_radiance >= 0.0f) || !FP<float>::is_finite(record.m_radiance))
+            continue;
+
+        Leaf& leaf = const_cast<Leaf&>(find_leaf(Vector3d(record.m_position)));
+        leaf.m_training[direction_to_bin(record.m_direction)] += record.m_radiance;
+        ++leaf.m_record_count;
+    }
+}
+
+void PathGuidingTree::update()
+{
+    // Make the training histograms the new sampling distributions.
+    for (size_t i = 0, e = m_leaves.size(); i < e; ++i)
+    {
+        Leaf& leaf = m_leaves[i];
+
+        float total = 0.0f;
+        for (size_t j = 0; j < BinCount; ++j)
+            total += leaf.m_training[j];
+
+        if (total > 0.0f)
+        {
+            // Build the cumulative distribution from the radiance received by each bin.
+            leaf.m_cdf.resize(BinCount);
+
+            float sum = 0.0f;
+            for (size_t j = 0; j < BinCount; ++j)
+            {
+                sum += leaf.m_training[j];
+                leaf.m_cdf[j] = sum / total;
+            }
+
+            leaf.m_cdf[BinCount - 1] = 1.0f;
+            m_is_trained = true;
+        }
+    }
+
+    // Leaves that never received any radiance sample directions uniformly.
+    if (m_is_trained)
+    {
+        for (size_t i = 0, e = m_leaves.size(); i < e; ++i)
+        {
+            Leaf& leaf = m_leaves[i];
+
+            if (leaf.m_cdf.empty())
+            {
+                leaf.m_cdf.resize(BinCount);
+
+                for (size_t j = 0; j < BinCount; ++j)
+                    leaf.m_cdf[j] = static_cast<float>(j + 1) / BinCount;
+            }
+        }
+    }
+
+    // Refine the subdivision where many records were received.
+    split_leaves(0, m_bbox, 0);
+
+    // Reset the training histograms.
+    for (size_t i = 0, e = m_leaves.size(); i < e; ++i)
+    {
+        Leaf& leaf = m_leaves[i];
+        fill(leaf.m_training.begin(), leaf.m_training.end(), 0.0f);
+        leaf.m_record_count = 0;
+    }
+}
+
+const PathGuidingTree::Leaf& PathGuidingTree::find_leaf(const Vector3d& point) const
+{
+    AABB3d bbox(m_bbox);
+    size_t node_index = 0;
+
+    while (!m_nodes[node_index].is_leaf())
+    {
+        const Node& node = m_nodes[node_index];
+        const size_t axis = node.m_axis;
+        const double middle = 0.5 * (bbox.min[axis] + bbox.max[axis]);
+
+        if (point[axis] < middle)
+        {
+            bbox.max[axis] = middle;
+            node_index = node.m_index;
+        }
+        else
+        {
+            bbox.min[axis] = middle;
+            node_index = node.m_index + 1;
+        }
+    }
+
+    return m_leaves[m_nodes[node_index].m_index];
+}
+
+void PathGuidingTree::split_leaves(
+    const size_t    node_index,
+    const AABB3d&   bbox,
+    const size_t    depth)
+{
+    const Node node = m_nodes[node_index];
+
+    if (node.is_leaf())
+    {
+        split(node_index, bbox, depth, m_leaves[node.m_index].m_record_count);
+        return;
+    }
+
+    const double middle = 0.5 * (bbox.min[node.m_axis] + bbox.max[node.m_axis]);
+
+    AABB3d left_bbox(bbox);
+    left_bbox.max[node.m_axis] = middle;
+    split_leaves(node.m_index, left_bbox, depth + 1);
+
+    AABB3d right_bbox(bbox);
+    right_bbox.min[node.m_axis] = middle;
+    split_leaves(node.m_index + 1, right_bbox, depth + 1);
+}
+
+void PathGuidingTree::split(
+    const size_t    node_index,
+    const AABB3d&   bbox,
+    const size_t    depth,
+    const size_t    record_count)
+{
+    if (record_count <= m_spatial_threshold || depth >= m_max_depth)
+        return;
+
+    // Split along the largest dimension of the node.
+    const uint32 axis = static_cast<uint32>(max_index(bbox.extent()));
+    const double middle = 0.5 * (bbox.min[axis] + bbox.max[axis]);
+
+    // The left child keeps the leaf of the node, the right child gets a copy of it.
+    const uint32 leaf_index = m_nodes[node_index].m_index;
+    m_leaves.push_back(m_leaves[leaf_index]);
+
+    Node left;
+    left.m_axis = ~uint32(0);
+    left.m_index = leaf_index;
+
+    Node right;
+    right.m_axis = ~uint32(0);
+    right.m_index = static_cast<uint32>(m_leaves.size() - 1);
+
+    const uint32 child_index = static_cast<uint32>(m_nodes.size());
+    m_nodes.push_back(left);
+    m_nodes.push_back(right);
+    m_nodes[node_index].m_axis = axis;
+    m_nodes[node_index].m_index = child_index;
+
+    // Assume that the records are evenly distributed between the children.
+    AABB3d left_bbox(bbox);
+    left_bbox.max[axis] = middle;
+    split(child_index, left_bbox, depth + 1, record_count / 2);
+
+    AABB3d right_bbox(bbox);
+    right_bbox.min[axis] = middle;
+    split(child_index + 1, right_bbox, depth + 1, record_count / 2);
+}
+
+size_t PathGuidingTree::direction_to_bin(const Vector3f& direction)
+{
+    const float cos_theta = clamp(direction[1], -1.0f, 1.0f);
+
+    float phi = atan2(direction[2], direction[0]);
+    if (phi < 0.0f)
+        phi += TwoPi<float>();
+
+    const size_t x = min(truncate<size_t>(phi * RcpTwoPi<float>() * Resolution), size_t(Resolution - 1));
+    const size_t y = min(truncate<size_t>(0.5f * (cos_theta + 1.0f) * Resolution), size_t(Resolution - 1));
+
+    return y * Resolution + x;
+}
+
+float PathGuidingTree::bin_probability(
+    const vector<float>&    cdf,
+    const size_t            bin)
+{
+    return bin > 0 ? cdf[bin] - cdf[bin - 1] : cdf[0];
+}
+
+}   // namespace renderer
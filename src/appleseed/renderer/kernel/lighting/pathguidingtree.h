@@ -0,0 +1,187 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_PATHGUIDINGTREE_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_PATHGUIDINGTREE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A spatial-directional tree that learns the distribution of incident radiance
+// in the scene, used to guide the continuation of paths.
+//
+// The scene bounding box is subdivided by a binary tree whose leaves store a
+// histogram of incident radiance over the sphere of directions. Directions are
+// mapped to the histogram with an equal-area cylindrical mapping so that every
+// bin subtends the same solid angle. Leaves that received many records during
+// a pass are split before the next one:
+//
+//   Practical Path Guiding for Efficient Light-Transport Simulation
+//   Thomas Muller, Markus Gross, Jan Novak
+//   https://tom94.net/data/publications/mueller17practical/mueller17practical.pdf
+//
+// Radiance is recorded into a training histogram while sampling uses the
+// distribution learned until the previous call to update(). This allows
+// rendering threads to sample the tree without locking.
+//
+
+class PathGuidingTree
+  : public foundation::NonCopyable
+{
+  public:
+    // A radiance record.
+    struct Record
+    {
+        foundation::Vector3f        m_position;             // world space position of the path vertex
+        foundation::Vector3f        m_direction;            // world space direction of the incident light, unit-length
+        float                       m_radiance;             // estimate of the incident radiance divided by its sampling density
+    };
+
+    typedef std::vector<Record> RecordVector;
+
+    // Number of bins of the directional histograms along each dimension.
+    enum { Resolution = 16 };
+
+    // Constructor.
+    PathGuidingTree(
+        const foundation::AABB3d&   bbox,                   // world space bounding box of the scene
+        const size_t                spatial_threshold,      // number of records per pass beyond which a leaf is split
+        const size_t                max_depth = 24);
+
+    // Return true if the tree learned a distribution that can be sampled.
+    bool is_trained() const;
+
+    // Return the number of leaves of the tree.
+    size_t get_leaf_count() const;
+
+    // Sample the learned distribution at a given point.
+    // Return the probability density of the sampled direction with respect to solid angle.
+    float sample(
+        const foundation::Vector3d& point,
+        const foundation::Vector2f& s,                      // sample in [0,1)^2
+        foundation::Vector3f&       direction) const;       // world space direction, unit-length
+
+    // Evaluate the probability density of sample() for a given direction at a given point.
+    float evaluate_pdf(
+        const foundation::Vector3d& point,
+        const foundation::Vector3f& direction) const;       // world space direction, unit-length
+
+    // Add radiance records to the training histograms. Thread-safe.
+    void append(const RecordVector& records);
+
+    // Make the training histograms the new sampling distributions, split the leaves
+    // that received many records and reset the training histograms. Must not be
+    // called while other threads use the tree.
+    void update();
+
+  private:
+    enum { BinCount = Resolution * Resolution };
+
+    struct Node
+    {
+        foundation::uint32          m_axis;                 // split axis for interior nodes, ~0 for leaves
+        foundation::uint32          m_index;                // index of the first child for interior nodes, of the leaf otherwise
+
+        bool is_leaf() const;
+    };
+
+    struct Leaf
+    {
+        std::vector<float>          m_training;             // training histogram
+        std::vector<float>          m_cdf;                  // cumulative sampling distribution, empty if untrained
+        size_t                      m_record_count;         // number of records received since the last update
+    };
+
+    const foundation::AABB3d        m_bbox;
+    const size_t                    m_spatial_threshold;
+    const size_t                    m_max_depth;
+    std::vector<Node>               m_nodes;
+    std::vector<Leaf>               m_leaves;
+    bool                            m_is_trained;
+    boost::mutex                    m_mutex;
+
+    // Return the leaf containing a given point.
+    const Leaf& find_leaf(const foundation::Vector3d& point) const;
+
+    // Split the leaves of a subtree that received too many records.
+    void split_leaves(
+        const size_t                node_index,
+        const foundation::AABB3d&   bbox,
+        const size_t                depth);
+
+    // Recursively split a leaf until its children are expected to receive few enough records.
+    // The children inherit the sampling distribution of the leaf.
+    void split(
+        const size_t                node_index,
+        const foundation::AABB3d&   bbox,
+        const size_t                depth,
+        const size_t                record_count);
+
+    static size_t direction_to_bin(
+        const foundation::Vector3f& direction);
+
+    static float bin_probability(
+        const std::vector<float>&   cdf,
+        const size_t                bin);
+};
+
+
+//
+// PathGuidingTree class implementation.
+//
+
+inline bool PathGuidingTree::is_trained() const
+{
+    return m_is_trained;
+}
+
+inline size_t PathGuidingTree::get_leaf_count() const
+{
+    return m_leaves.size();
+}
+
+inline bool PathGuidingTree::Node::is_leaf() const
+{
+    return m_axis == ~foundation::uint32(0);
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_PATHGUIDINGTREE_H
@@ -34,11 +34,13 @@
 #include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/lighting/pathguidingtree.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/volume/fluidvolume.h"
 #include "renderer/modeling/bsdf/bsdf.h"
 #include "renderer/modeling/bsdf/bsdfsample.h"
 #include "renderer/modeling/bssrdf/bssrdf.h"
@@ -47,22 +49,28 @@
 #include "renderer/modeling/material/material.h"
 #include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/utility/hotpathcounters.h"
+#include "renderer/utility/shadingprofiler.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/basis.h"
 #include "foundation/math/dual.h"
 #include "foundation/math/ray.h"
 #include "foundation/math/rr.h"
 #include "foundation/math/sampling/mappings.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
+#include "foundation/utility/alignedvector.h"
 #include "foundation/utility/arena.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <limits>
 
 namespace renderer
 {
@@ -70,6 +78,21 @@ namespace renderer
 //
 // A generic path tracer.
 //
+// By default, paths are cut with Russian Roulette driven by their throughput. Alternatively,
+// a weight window can be used to keep the throughput of all paths close to a given value:
+// paths carrying too much weight are split into several paths, paths carrying too little
+// weight are terminated with a probability that brings them back into the window:
+//
+//   Adjoint-Driven Russian Roulette and Splitting in Light Transport Simulation
+//   Jiri Vorba, Jaroslav Krivanek
+//   http://cgg.mff.cuni.cz/~jirka/papers/2016/adrrs/
+//
+// The additional paths created by splitting are traced once the current path is complete.
+//
+// Inside media whose material has a fluid volume, collisions are sampled with delta tracking
+// and scatter the path isotropically. Such volume vertices are not passed to the path visitor:
+// like specular vertices, they rely on the path itself to reach light sources.
+//
 
 template <typename PathVisitor, bool Adjoint>
 class PathTracer
@@ -94,12 +117,114 @@ class PathTracer
         const ShadingContext&   shading_context,
         const ShadingPoint&     shading_point);
 
+    // Sample a fraction of the scattered directions from a learned distribution of
+    // incident radiance instead of the BSDF. The tree must be trained.
+    void set_path_guiding(
+        const PathGuidingTree*  guiding_tree,               // may be 0 to disable path guiding
+        const float             guided_fraction);           // fraction of guided directions, in [0,1)
+
+    // Use a weight window instead of Russian Roulette. The expected contribution of a path is
+    // its throughput times the average radiance of the scene; the center of the window is the
+    // throughput for which this contribution matches the expected value of the pixel.
+    void set_weight_window(
+        const float             center,                     // throughput at the center of the window, 0 to disable it
+        const size_t            max_split);                 // maximum number of paths a path may be split into at once
+
   private:
+    // Ratio between the upper and the lower bounds of the weight window.
+    enum { WeightWindowRatio = 5 };
+
+    // Maximum number of additional paths created by splitting during a call to trace().
+    enum { MaxBranchCount = 32 };
+
+    // A path created by splitting, waiting to be traced.
+    struct Branch
+    {
+        ShadingPoint            m_shading_point;            // first vertex of the path
+        Spectrum                m_throughput;
+        size_t                  m_path_length;
+        ScatteringMode::Mode    m_prev_mode;
+        float                   m_prev_prob;
+        const ObjectInstance*   m_prev_object_instance;
+        foundation::Vector3d    m_medium_start;
+    };
+
     PathVisitor&                m_path_visitor;
     const size_t                m_rr_min_path_length;
     const size_t                m_max_path_length;
     const size_t                m_max_iterations;
     const double                m_near_start;
+    const PathGuidingTree*      m_guiding_tree;
+    float                       m_guided_fraction;
+    float                       m_ww_center;
+    size_t                      m_ww_max_split;
+    foundation::AlignedVector<Branch> m_branches;
+    size_t                      m_branch_count;
+
+    // Trace a path starting at a given vertex.
+    void trace_path(
+        SamplingContext&        sampling_context,
+        const ShadingContext&   shading_context,
+        PathVertex&             vertex,
+        foundation::Vector3d    medium_start);
+
+    // Sample the scattered direction at a given vertex. Return false if the path must be terminated.
+    bool sample_scattering(
+        SamplingContext&        sampling_context,
+        const PathVertex&       vertex,
+        BSDFSample&             bsdf_sample);
+
+    // Sample either the BSDF or the guiding distribution of a vertex (one-sample MIS).
+    void sample_guided(
+        SamplingContext&        sampling_context,
+        const PathVertex&       vertex,
+        BSDFSample&             bsdf_sample) const;
+
+    // Construct the scattered ray at a given vertex and account for absorption in the medium it leaves.
+    void build_scattered_ray(
+        SamplingContext&        sampling_context,
+        const ShadingContext&   shading_context,
+        const PathVertex&       vertex,
+        const BSDFSample&       bsdf_sample,
+        const ShadingRay&       ray,
+        const ObjectInstance&   object_instance,
+        const bool              entering,
+        Spectrum&               throughput,
+        foundation::Vector3d&   medium_start,
+        ShadingRay&             next_ray) const;
+
+    // Apply the weight window to a given vertex. Return false if the path must be terminated.
+    bool apply_weight_window(
+        SamplingContext&        sampling_context,
+        PathVertex&             vertex,
+        size_t&                 split_count);
+
+    // Create an additional path scattered at a given vertex.
+    void split_path(
+        SamplingContext&        sampling_context,
+        const ShadingContext&   shading_context,
+        const PathVertex&       vertex,
+        const ShadingRay&       ray,
+        const ObjectInstance&   object_instance,
+        const bool              entering,
+        const foundation::Vector3d& medium_start);
+
+    // Uniform random numbers drawn from a sampling context, for delta tracking.
+    struct VolumeSampler
+    {
+        SamplingContext&        m_sampling_context;
+
+        explicit VolumeSampler(SamplingContext& sampling_context)
+          : m_sampling_context(sampling_context)
+        {
+        }
+
+        float operator()()
+        {
+            m_sampling_context.split_in_place(1, 1);
+            return m_sampling_context.next2<float>();
+        }
+    };
 
     // Determine whether a ray can pass through a surface with a given alpha value.
     static bool pass_through(
@@ -124,9 +249,38 @@ inline PathTracer<PathVisitor, Adjoint>::PathTracer(
   , m_max_path_length(max_path_length)
   , m_max_iterations(max_iterations)
   , m_near_start(near_start)
+  , m_guiding_tree(0)
+  , m_guided_fraction(0.0f)
+  , m_ww_center(0.0f)
+  , m_ww_max_split(1)
+  , m_branch_count(0)
 {
 }
 
+template <typename PathVisitor, bool Adjoint>
+inline void PathTracer<PathVisitor, Adjoint>::set_path_guiding(
+    const PathGuidingTree*      guiding_tree,
+    const float                 guided_fraction)
+{
+    assert(guiding_tree == 0 || guiding_tree->is_trained());
+    assert(guided_fraction >= 0.0f && guided_fraction < 1.0f);
+
+    m_guiding_tree = guiding_tree;
+    m_guided_fraction = guided_fraction;
+}
+
+template <typename PathVisitor, bool Adjoint>
+inline void PathTracer<PathVisitor, Adjoint>::set_weight_window(
+    const float                 center,
+    const size_t                max_split)
+{
+    assert(center >= 0.0f);
+    assert(max_split >= 1);
+
+    m_ww_center = center;
+    m_ww_max_split = max_split;
+}
+
 template <typename PathVisitor, bool Adjoint>
 inline size_t PathTracer<PathVisitor, Adjoint>::trace(
     SamplingContext&            sampling_context,
@@ -154,26 +308,75 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
     if (shading_point.hit() && shading_point.get_distance() < m_near_start)
         return 1;
 
-    ShadingPoint shading_points[2];
-    size_t shading_point_index = 0;
-
     PathVertex vertex(sampling_context);
     vertex.m_path_length = 1;
     vertex.m_throughput.set(1.0f);
     vertex.m_shading_point = &shading_point;
     vertex.m_prev_mode = ScatteringMode::Specular;
     vertex.m_prev_prob = BSDF::DiracDelta;
+    vertex.m_prev_object_instance = 0;
 
     // This variable tracks the beginning of the path segment inside the current medium.
     // While it is properly initialized when entering a medium, we also initialize it
     // here to silence a gcc warning.
     foundation::Vector3d medium_start(0.0);
 
+    m_branches.clear();
+    m_branch_count = 0;
+
+    trace_path(
+        sampling_context,
+        shading_context,
+        vertex,
+        medium_start);
+
+    size_t path_length = vertex.m_path_length;
+
+    // Trace the paths created by splitting. Branches are never reallocated (see split_path())
+    // so the path starts directly from the shading point stored in the branch, without a copy.
+    // Paths created by splitting a branch are appended and traced by later iterations.
+    for (size_t i = 0; i < m_branches.size(); ++i)
+    {
+        const Branch& branch = m_branches[i];
+        vertex.m_shading_point = &branch.m_shading_point;
+        vertex.m_throughput = branch.m_throughput;
+        vertex.m_path_length = branch.m_path_length;
+        vertex.m_prev_mode = branch.m_prev_mode;
+        vertex.m_prev_prob = branch.m_prev_prob;
+        vertex.m_prev_object_instance = branch.m_prev_object_instance;
+        medium_start = branch.m_medium_start;
+
+        trace_path(
+            sampling_context,
+            shading_context,
+            vertex,
+            medium_start);
+
+        path_length = std::max(path_length, vertex.m_path_length);
+    }
+
+    return path_length;
+}
+
+template <typename PathVisitor, bool Adjoint>
+void PathTracer<PathVisitor, Adjoint>::trace_path(
+    SamplingContext&            sampling_context,
+    const ShadingContext&       shading_context,
+    PathVertex&                 vertex,
+    foundation::Vector3d        medium_start)
+{
+    ShadingPoint shading_points[2];
+    size_t shading_point_index = 0;
+
     size_t iterations = 0;
 
+    // Scratch memory is reused from one bounce to the next. Allocations made by the
+    // caller before the path was started are preserved.
+    foundation::ArenaScope arena_scope(shading_context.get_arena());
+
     while (true)
     {
-        shading_context.get_arena().clear();
+        arena_scope.release();
 
 #ifndef NDEBUG
         // Save the sampling context at the beginning of the iteration.
@@ -209,6 +412,74 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
                     ray.m_dir - ray.m_ry.m_dir)
                 : foundation::Dual3d(-ray.m_dir);
 
+        // Sample a collision with the fluid volume the ray is traveling through, if any.
+        const ShadingRay::Medium* current_medium = ray.get_current_medium();
+        const FluidVolume* volume =
+            current_medium ? current_medium->m_material->get_render_data().m_volume : 0;
+        VolumeSampler volume_sampler(sampling_context);
+        double collision_distance;
+        if (volume &&
+            volume->sample_distance(
+                ray.m_org,
+                ray.m_dir,
+                vertex.m_shading_point->hit()
+                    ? vertex.m_shading_point->get_distance()
+                    : std::numeric_limits<double>::max(),
+                volume_sampler,
+                collision_distance))
+        {
+            // Honor the user bounce limit.
+            if (vertex.m_path_length >= m_max_path_length)
+                break;
+
+            // Terminate the path if it gets absorbed.
+            sampling_context.split_in_place(1, 1);
+            if (sampling_context.next2<float>() >= volume->get_albedo())
+                break;
+
+            // Scatter isotropically.
+            sampling_context.split_in_place(2, 1);
+            const foundation::Vector3d incoming =
+                foundation::sample_sphere_uniform(sampling_context.next2<foundation::Vector2d>());
+
+            vertex.m_prev_mode = ScatteringMode::Specular;
+            vertex.m_prev_prob = BSDF::DiracDelta;
+            vertex.m_prev_object_instance = 0;
+            ++vertex.m_path_length;
+
+            // The scattered ray remains inside the same media.
+            ShadingRay next_ray(
+                ray.point_at(collision_distance),
+                incoming,
+                ray.m_time,
+                ScatteringMode::get_vis_flags(ScatteringMode::Diffuse),
+                ray.m_depth + 1);
+            next_ray.copy_media_from(ray);
+
+            // Widen the differentials as much as isotropic scattering blurs the footprint.
+            if (ray.m_has_differentials)
+            {
+                const double spread = BSDFSample::get_pdf_spread(foundation::RcpFourPi<float>());
+                const foundation::Basis3d basis(incoming);
+                next_ray.m_rx.m_org = ray.m_rx.point_at(collision_distance);
+                next_ray.m_ry.m_org = ray.m_ry.point_at(collision_distance);
+                next_ray.m_rx.m_dir = incoming + spread * basis.get_tangent_u();
+                next_ray.m_ry.m_dir = incoming + spread * basis.get_tangent_v();
+                next_ray.m_has_differentials = true;
+            }
+
+            // Trace the ray.
+            shading_points[shading_point_index].clear();
+            shading_context.get_intersector().trace(
+                next_ray,
+                shading_points[shading_point_index]);
+
+            // Update the pointers to the shading points and loop.
+            vertex.m_shading_point = &shading_points[shading_point_index];
+            shading_point_index = 1 - shading_point_index;
+            continue;
+        }
+
         // Terminate the path if the ray didn't hit anything.
         if (!vertex.m_shading_point->hit())
         {
@@ -232,10 +503,11 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
         // Determine whether the ray is entering or leaving a medium.
         const bool entering = vertex.m_shading_point->is_entering();
 
-        // Handle false intersections.
-        if (ray.get_current_medium() &&
-            ray.get_current_medium()->m_object_instance->get_medium_priority() > object_instance.get_medium_priority() &&
-            material_data.m_bsdf != 0)
+        // Handle false intersections, and the boundaries of fluid volumes which don't scatter light.
+        if ((material_data.m_volume != 0 && material_data.m_bsdf == 0) ||
+            (ray.get_current_medium() &&
+             ray.get_current_medium()->m_object_instance->get_medium_priority() > object_instance.get_medium_priority() &&
+             material_data.m_bsdf != 0))
         {
             // Construct a ray that continues in the same direction as the incoming ray.
             ShadingRay next_ray(
@@ -258,16 +530,22 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
             // Initialize the ray's medium list.
             if (entering)
             {
-                // Execute the OSL shader if there is one.
-                if (material_data.m_shader_group)
+                float ior = 1.0f;
+
+                if (material_data.m_bsdf)
                 {
-                    shading_context.execute_osl_shading(
-                        *material_data.m_shader_group,
-                        *vertex.m_shading_point);
+                    // Execute the OSL shader if there is one.
+                    if (material_data.m_shader_group)
+                    {
+                        shading_context.execute_osl_shading(
+                            *material_data.m_shader_group,
+                            *vertex.m_shading_point);
+                    }
+
+                    const void* data = material_data.m_bsdf->evaluate_inputs(shading_context, *vertex.m_shading_point);
+                    ior = material_data.m_bsdf->sample_ior(sampling_context, data);
                 }
 
-                const void* data = material_data.m_bsdf->evaluate_inputs(shading_context, *vertex.m_shading_point);
-                const float ior = material_data.m_bsdf->sample_ior(sampling_context, data);
                 next_ray.add_medium(ray, &object_instance, material, ior);
             }
             else next_ray.remove_medium(ray, &object_instance);
@@ -288,19 +566,8 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
         // Handle alpha mapping.
         if (vertex.m_path_length > 1)
         {
-            Alpha alpha = vertex.m_shading_point->get_alpha();
-
-            // Apply OSL transparency if needed.
-            if (material_data.m_shader_group &&
-                material_data.m_shader_group->has_transparency())
-            {
-                Alpha a;
-                shading_context.execute_osl_transparency(
-                    *material_data.m_shader_group,
-                    *vertex.m_shading_point,
-                    a);
-                alpha *= a;
-            }
+            Alpha alpha;
+            shading_context.evaluate_opacity(*vertex.m_shading_point, alpha);
 
             if (pass_through(sampling_context, alpha))
             {
@@ -418,29 +685,37 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
         if (!vertex.m_bsdf)
             break;
 
-        // Above-surface scattering.
-        if (!vertex.m_bssrdf)
+        // Split or terminate the path depending on its throughput.
+        if (m_ww_center > 0.0f)
         {
-            // Sample the BSDF.
-            vertex.m_bsdf->sample(
-                sampling_context,
-                vertex.m_bsdf_data,
-                Adjoint,
-                true,       // multiply by |cos(incoming, normal)|
-                bsdf_sample);
-
-            // Terminate the path if it gets absorbed.
-            if (bsdf_sample.m_mode == ScatteringMode::Absorption)
+            size_t split_count;
+            if (!apply_weight_window(sampling_context, vertex, split_count))
                 break;
 
-            // Terminate the path if this scattering event is not accepted.
-            if (!m_path_visitor.accept_scattering(vertex.m_prev_mode, bsdf_sample.m_mode))
+            for (size_t i = 1; i < split_count; ++i)
+            {
+                split_path(
+                    sampling_context,
+                    shading_context,
+                    vertex,
+                    ray,
+                    object_instance,
+                    entering,
+                    medium_start);
+            }
+        }
+
+        // Above-surface scattering.
+        if (!vertex.m_bssrdf)
+        {
+            if (!sample_scattering(sampling_context, vertex, bsdf_sample))
                 break;
         }
 
         // Properties of this scattering event.
         vertex.m_prev_mode = bsdf_sample.m_mode;
         vertex.m_prev_prob = bsdf_sample.m_probability;
+        vertex.m_prev_object_instance = &object_instance;
 
         // Update the path throughput.
         if (bsdf_sample.m_probability != BSDF::DiracDelta)
@@ -448,7 +723,7 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
         vertex.m_throughput *= bsdf_sample.m_value;
 
         // Use Russian Roulette to cut the path without introducing bias.
-        if (vertex.m_path_length >= m_rr_min_path_length)
+        if (m_ww_center == 0.0f && vertex.m_path_length >= m_rr_min_path_length)
         {
             // Generate a uniform sample in [0,1).
             sampling_context.split_in_place(1, 1);
@@ -470,88 +745,365 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
         ++vertex.m_path_length;
 
         // Construct the scattered ray.
-        const foundation::Vector3d incoming(bsdf_sample.m_incoming.get_value());
-        ShadingRay next_ray(
+        ShadingRay next_ray;
+        build_scattered_ray(
+            sampling_context,
+            shading_context,
+            vertex,
+            bsdf_sample,
+            ray,
+            object_instance,
+            entering,
+            vertex.m_throughput,
+            medium_start,
+            next_ray);
+
+        // Trace the ray.
+        shading_points[shading_point_index].clear();
+        shading_context.get_intersector().trace(
+            next_ray,
+            shading_points[shading_point_index],
+            vertex.m_shading_point);
+
+        // Update the pointers to the shading points.
+        vertex.m_shading_point = &shading_points[shading_point_index];
+        shading_point_index = 1 - shading_point_index;
+    }
+}
+
+template <typename PathVisitor, bool Adjoint>
+bool PathTracer<PathVisitor, Adjoint>::sample_scattering(
+    SamplingContext&            sampling_context,
+    const PathVertex&           vertex,
+    BSDFSample&                 bsdf_sample)
+{
+    // Sample the BSDF, or the guiding distribution if the BSDF isn't purely specular.
+    if (m_guiding_tree && ScatteringMode::has_diffuse_or_glossy(vertex.m_bsdf->get_modes()))
+    {
+        sample_guided(
+            sampling_context,
+            vertex,
+            bsdf_sample);
+    }
+    else
+    {
+        ShadingProfileScope profile_scope(ShadingProfile::BSDFModels, vertex.m_bsdf->get_model());
+        vertex.m_bsdf->sample(
+            sampling_context,
+            vertex.m_bsdf_data,
+            Adjoint,
+            true,       // multiply by |cos(incoming, normal)|
+            bsdf_sample);
+    }
+
+    // Terminate the path if it gets absorbed.
+    if (bsdf_sample.m_mode == ScatteringMode::Absorption)
+        return false;
+
+    // Terminate the path if this scattering event is not accepted.
+    if (!m_path_visitor.accept_scattering(vertex.m_prev_mode, bsdf_sample.m_mode))
+        return false;
+
+    return true;
+}
+
+template <typename PathVisitor, bool Adjoint>
+void PathTracer<PathVisitor, Adjoint>::sample_guided(
+    SamplingContext&            sampling_context,
+    const PathVertex&           vertex,
+    BSDFSample&                 bsdf_sample) const
+{
+    //
+    // The scattered direction is sampled from the guiding distribution with probability
+    // m_guided_fraction, and from the BSDF otherwise. The throughput is divided by the
+    // density of the combined strategy, but bsdf_sample.m_probability is left to the
+    // density of the BSDF alone: multiple importance sampling against lights then keeps
+    // using the same pair of densities as the light sampling side, so that the weights
+    // still sum to one.
+    //
+
+    sampling_context.split_in_place(1, 1);
+    const bool guided = sampling_context.next2<float>() < m_guided_fraction;
+
+    if (guided)
+    {
+        // Sample the guiding distribution.
+        sampling_context.split_in_place(2, 1);
+        foundation::Vector3f incoming;
+        const float guided_prob =
+            m_guiding_tree->sample(
+                vertex.get_point(),
+                sampling_context.next2<foundation::Vector2f>(),
+                incoming);
+
+        // Evaluate the non-specular components of the BSDF in the guided direction.
+        // The scattering mode is the one of the most likely component.
+        const int bsdf_modes = vertex.m_bsdf->get_modes();
+        const ScatteringMode::Mode modes[2] = { ScatteringMode::Diffuse, ScatteringMode::Glossy };
+        float bsdf_prob = 0.0f;
+        float max_mode_prob = 0.0f;
+        bsdf_sample.m_value.set(0.0f);
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            if (!(bsdf_modes & modes[i]))
+                continue;
+
+            APPLESEED_HOT_PATH_COUNT(hot_path_counters().m_bsdf_evaluations.increment(vertex.m_bsdf->get_model()));
+            Spectrum mode_value;
+            const float mode_prob =
+                vertex.m_bsdf->evaluate(
+                    vertex.m_bsdf_data,
+                    Adjoint,
+                    true,       // multiply by |cos(incoming, normal)|
+                    bsdf_sample.m_geometric_normal,
+                    bsdf_sample.m_shading_basis,
+                    bsdf_sample.m_outgoing.get_value(),
+                    incoming,
+                    modes[i],
+                    mode_value);
+
+            if (mode_prob > 0.0f)
+            {
+                bsdf_sample.m_value += mode_value;
+                bsdf_prob += mode_prob;
+
+                if (mode_prob > max_mode_prob)
+                {
+                    max_mode_prob = mode_prob;
+                    bsdf_sample.m_mode = modes[i];
+                }
+            }
+        }
+
+        // Terminate the path if the BSDF doesn't scatter light in this direction.
+        if (bsdf_prob == 0.0f)
+        {
+            bsdf_sample.m_mode = ScatteringMode::Absorption;
+            return;
+        }
+
+        bsdf_sample.m_incoming = foundation::Dual3f(incoming);
+        bsdf_sample.m_probability = bsdf_prob;
+        bsdf_sample.compute_diffuse_differentials();
+        bsdf_sample.m_value *=
+            bsdf_prob / (m_guided_fraction * guided_prob + (1.0f - m_guided_fraction) * bsdf_prob);
+    }
+    else
+    {
+        // Sample the BSDF.
+        {
+            ShadingProfileScope profile_scope(ShadingProfile::BSDFModels, vertex.m_bsdf->get_model());
+            vertex.m_bsdf->sample(
+                sampling_context,
+                vertex.m_bsdf_data,
+                Adjoint,
+                true,       // multiply by |cos(incoming, normal)|
+                bsdf_sample);
+        }
+
+        if (bsdf_sample.m_mode == ScatteringMode::Absorption)
+            return;
+
+        if (bsdf_sample.m_probability == BSDF::DiracDelta)
+        {
+            // Specular components are only reached through BSDF sampling.
+            bsdf_sample.m_value /= 1.0f - m_guided_fraction;
+        }
+        else
+        {
+            const float guided_prob =
+                m_guiding_tree->evaluate_pdf(
+                    vertex.get_point(),
+                    bsdf_sample.m_incoming.get_value());
+            const float bsdf_prob = bsdf_sample.m_probability;
+            bsdf_sample.m_value *=
+                bsdf_prob / (m_guided_fraction * guided_prob + (1.0f - m_guided_fraction) * bsdf_prob);
+        }
+    }
+}
+
+template <typename PathVisitor, bool Adjoint>
+void PathTracer<PathVisitor, Adjoint>::build_scattered_ray(
+    SamplingContext&            sampling_context,
+    const ShadingContext&       shading_context,
+    const PathVertex&           vertex,
+    const BSDFSample&           bsdf_sample,
+    const ShadingRay&           ray,
+    const ObjectInstance&       object_instance,
+    const bool                  entering,
+    Spectrum&                   throughput,
+    foundation::Vector3d&       medium_start,
+    ShadingRay&                 next_ray) const
+{
+    const foundation::Vector3d incoming(bsdf_sample.m_incoming.get_value());
+    next_ray =
+        ShadingRay(
             vertex.m_shading_point->get_biased_point(incoming),
             incoming,
             ray.m_time,
-            ScatteringMode::get_vis_flags(vertex.m_prev_mode),
+            ScatteringMode::get_vis_flags(bsdf_sample.m_mode),
             ray.m_depth + 1);
-        next_ray.m_dir = foundation::improve_normalization<2>(next_ray.m_dir);
+    next_ray.m_dir = foundation::improve_normalization<2>(next_ray.m_dir);
 
-        // Compute scattered ray differentials.
-        if (bsdf_sample.m_incoming.has_derivatives())
+    // Compute scattered ray differentials.
+    if (bsdf_sample.m_incoming.has_derivatives())
+    {
+        next_ray.m_rx.m_org = next_ray.m_org + vertex.m_shading_point->get_dpdx();
+        next_ray.m_ry.m_org = next_ray.m_org + vertex.m_shading_point->get_dpdy();
+        next_ray.m_rx.m_dir = next_ray.m_dir + foundation::Vector3d(bsdf_sample.m_incoming.get_dx());
+        next_ray.m_ry.m_dir = next_ray.m_dir + foundation::Vector3d(bsdf_sample.m_incoming.get_dy());
+        next_ray.m_has_differentials = true;
+    }
+
+    // Build the medium list of the scattered ray.
+    const foundation::Vector3d& geometric_normal = vertex.get_geometric_normal();
+    const bool crossing_interface =
+        foundation::dot(vertex.m_outgoing.get_value(), geometric_normal) *
+        foundation::dot(next_ray.m_dir, geometric_normal) < 0.0;
+    if (vertex.m_bsdf != 0 && crossing_interface)
+    {
+        // Refracted ray: inherit the medium list of the parent ray and add/remove the current medium.
+        if (entering)
         {
-            next_ray.m_rx.m_org = next_ray.m_org + vertex.m_shading_point->get_dpdx();
-            next_ray.m_ry.m_org = next_ray.m_org + vertex.m_shading_point->get_dpdy();
-            next_ray.m_rx.m_dir = next_ray.m_dir + foundation::Vector3d(bsdf_sample.m_incoming.get_dx());
-            next_ray.m_ry.m_dir = next_ray.m_dir + foundation::Vector3d(bsdf_sample.m_incoming.get_dy());
-            next_ray.m_has_differentials = true;
+            const float ior =
+                vertex.m_bsdf->sample_ior(
+                    sampling_context,
+                    vertex.m_bsdf_data);
+            next_ray.add_medium(ray, &object_instance, vertex.get_material(), ior);
         }
+        else next_ray.remove_medium(ray, &object_instance);
 
-        // Build the medium list of the scattered ray.
-        const foundation::Vector3d& geometric_normal = vertex.get_geometric_normal();
-        const bool crossing_interface =
-            foundation::dot(vertex.m_outgoing.get_value(), geometric_normal) *
-            foundation::dot(next_ray.m_dir, geometric_normal) < 0.0;
-        if (vertex.m_bsdf != 0 && crossing_interface)
+        // Compute absorption for the segment inside the medium the path is leaving.
+        const ShadingRay::Medium* prev_medium = ray.get_current_medium();
+        if (prev_medium != 0 && prev_medium != next_ray.get_current_medium())
         {
-            // Refracted ray: inherit the medium list of the parent ray and add/remove the current medium.
-            if (entering)
-            {
-                const float ior =
-                    vertex.m_bsdf->sample_ior(
-                        sampling_context,
-                        vertex.m_bsdf_data);
-                next_ray.add_medium(ray, &object_instance, vertex.get_material(), ior);
-            }
-            else next_ray.remove_medium(ray, &object_instance);
+            const Material::RenderData& render_data = prev_medium->m_material->get_render_data();
 
-            // Compute absorption for the segment inside the medium the path is leaving.
-            const ShadingRay::Medium* prev_medium = ray.get_current_medium();
-            if (prev_medium != 0 && prev_medium != next_ray.get_current_medium())
+            if (render_data.m_bsdf)
             {
-                const Material::RenderData& render_data = prev_medium->m_material->get_render_data();
-
-                if (render_data.m_bsdf)
+                // Execute the OSL shader if there is one.
+                if (render_data.m_shader_group)
                 {
-                    // Execute the OSL shader if there is one.
-                    if (render_data.m_shader_group)
-                    {
-                        shading_context.execute_osl_shading(
-                            *render_data.m_shader_group,
-                            *vertex.m_shading_point);
-                    }
-
-                    const void* data = render_data.m_bsdf->evaluate_inputs(shading_context, *vertex.m_shading_point);
-                    const float distance = static_cast<float>(norm(vertex.get_point() - medium_start));
-                    Spectrum absorption;
-                    render_data.m_bsdf->compute_absorption(data, distance, absorption);
-                    vertex.m_throughput *= absorption;
+                    shading_context.execute_osl_shading(
+                        *render_data.m_shader_group,
+                        *vertex.m_shading_point);
                 }
-            }
 
-            medium_start = vertex.get_point();
-        }
-        else
-        {
-            // Reflected ray: inherit the medium list of the parent ray.
-            next_ray.copy_media_from(ray);
+                const void* data = render_data.m_bsdf->evaluate_inputs(shading_context, *vertex.m_shading_point);
+                const float distance = static_cast<float>(norm(vertex.get_point() - medium_start));
+                Spectrum absorption;
+                render_data.m_bsdf->compute_absorption(data, distance, absorption);
+                throughput *= absorption;
+            }
         }
 
-        // Trace the ray.
-        shading_points[shading_point_index].clear();
-        shading_context.get_intersector().trace(
-            next_ray,
-            shading_points[shading_point_index],
-            vertex.m_shading_point);
+        medium_start = vertex.get_point();
+    }
+    else
+    {
+        // Reflected ray: inherit the medium list of the parent ray.
+        next_ray.copy_media_from(ray);
+    }
+}
 
-        // Update the pointers to the shading points.
-        vertex.m_shading_point = &shading_points[shading_point_index];
-        shading_point_index = 1 - shading_point_index;
+template <typename PathVisitor, bool Adjoint>
+bool PathTracer<PathVisitor, Adjoint>::apply_weight_window(
+    SamplingContext&            sampling_context,
+    PathVertex&                 vertex,
+    size_t&                     split_count)
+{
+    split_count = 1;
+
+    const float weight = foundation::average_value(vertex.m_throughput);
+    const float lower_bound = 2.0f * m_ww_center / (1.0f + WeightWindowRatio);
+    const float upper_bound = WeightWindowRatio * lower_bound;
+
+    if (weight < lower_bound)
+    {
+        // Generate a uniform sample in [0,1).
+        sampling_context.split_in_place(1, 1);
+        const float s = sampling_context.next2<float>();
+
+        // Russian Roulette, bringing the weight of surviving paths to the center of the window.
+        const float scattering_prob = weight / m_ww_center;
+        if (!foundation::pass_rr(scattering_prob, s))
+            return false;
+
+        // Adjust throughput to account for terminated paths.
+        assert(scattering_prob > 0.0f);
+        vertex.m_throughput /= scattering_prob;
+    }
+    else if (weight > upper_bound && vertex.m_bssrdf == 0)
+    {
+        // Split the path into paths whose weight is close to the center of the window.
+        const size_t max_split = std::min(m_ww_max_split, MaxBranchCount - m_branch_count + 1);
+        split_count = std::min(foundation::truncate<size_t>(std::ceil(weight / m_ww_center)), max_split);
+
+        if (split_count > 1)
+        {
+            vertex.m_throughput /= static_cast<float>(split_count);
+            m_branch_count += split_count - 1;
+        }
     }
 
-    return vertex.m_path_length;
+    return true;
+}
+
+template <typename PathVisitor, bool Adjoint>
+void PathTracer<PathVisitor, Adjoint>::split_path(
+    SamplingContext&            sampling_context,
+    const ShadingContext&       shading_context,
+    const PathVertex&           vertex,
+    const ShadingRay&           ray,
+    const ObjectInstance&       object_instance,
+    const bool                  entering,
+    const foundation::Vector3d& medium_start)
+{
+    BSDFSample bsdf_sample(
+        vertex.m_shading_point,
+        foundation::Dual3f(vertex.m_outgoing));
+
+    if (!sample_scattering(sampling_context, vertex, bsdf_sample))
+        return;
+
+    // The weight window never creates more than MaxBranchCount branches per call to trace():
+    // reserving room for all of them once keeps branches, and their shading points, in place.
+    if (m_branches.capacity() < MaxBranchCount)
+        m_branches.reserve(MaxBranchCount);
+
+    assert(m_branches.size() < MaxBranchCount);
+    m_branches.push_back(Branch());
+    Branch& branch = m_branches.back();
+
+    branch.m_throughput = vertex.m_throughput;
+    if (bsdf_sample.m_probability != BSDF::DiracDelta)
+        bsdf_sample.m_value /= bsdf_sample.m_probability;
+    branch.m_throughput *= bsdf_sample.m_value;
+
+    branch.m_path_length = vertex.m_path_length + 1;
+    branch.m_prev_mode = bsdf_sample.m_mode;
+    branch.m_prev_prob = bsdf_sample.m_probability;
+    branch.m_prev_object_instance = &object_instance;
+    branch.m_medium_start = medium_start;
+
+    ShadingRay next_ray;
+    build_scattered_ray(
+        sampling_context,
+        shading_context,
+        vertex,
+        bsdf_sample,
+        ray,
+        object_instance,
+        entering,
+        branch.m_throughput,
+        branch.m_medium_start,
+        next_ray);
+
+    shading_context.get_intersector().trace(
+        next_ray,
+        branch.m_shading_point,
+        vertex.m_shading_point);
 }
 
 template <typename PathVisitor, bool Adjoint>
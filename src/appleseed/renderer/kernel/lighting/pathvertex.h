@@ -52,6 +52,7 @@ namespace renderer  { class BSDF; }
 namespace renderer  { class BSSRDF; }
 namespace renderer  { class EDF; }
 namespace renderer  { class Material; }
+namespace renderer  { class ObjectInstance; }
 namespace renderer  { class ShadingContext; }
 
 namespace renderer
@@ -85,6 +86,7 @@ class PathVertex
     // Properties of the last scattering event (for multiple importance sampling).
     ScatteringMode::Mode        m_prev_mode;
     float                       m_prev_prob;
+    const ObjectInstance*       m_prev_object_instance;     // null at the first vertex
 
     // Constructor.
     explicit PathVertex(SamplingContext& sampling_context);
@@ -109,6 +111,9 @@ class PathVertex
 
     // Return the probability density wrt. surface area mesure of reaching this vertex via light sampling.
     float get_light_prob_area(const LightSampler& light_sampler) const;
+
+    // Return true if the light emitted at this vertex illuminates the previous vertex of the path.
+    bool is_illuminating(const LightSampler& light_sampler) const;
 };
 
 
@@ -175,7 +180,12 @@ inline float PathVertex::get_bsdf_prob_area() const
 
 inline float PathVertex::get_light_prob_area(const LightSampler& light_sampler) const
 {
-    return light_sampler.evaluate_pdf(*m_shading_point);
+    return light_sampler.evaluate_pdf(*m_shading_point, m_prev_object_instance);
+}
+
+inline bool PathVertex::is_illuminating(const LightSampler& light_sampler) const
+{
+    return light_sampler.illuminates(*m_shading_point, m_prev_object_instance);
 }
 
 }       // namespace renderer
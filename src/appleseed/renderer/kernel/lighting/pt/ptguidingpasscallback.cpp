@@ -0,0 +1,90 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "ptguidingpasscallback.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/scene/scene.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+
+namespace renderer
+{
+
+//
+// PTGuidingPassCallback class implementation.
+//
+
+PTGuidingPassCallback::PTGuidingPassCallback(
+    const Scene&            scene,
+    const ParamArray&       params)
+  : m_guiding_tree(
+        AABB3d(scene.compute_bbox()),
+        params.get_optional<size_t>("path_guiding_spatial_threshold", 4000))
+  , m_pass_number(0)
+{
+}
+
+void PTGuidingPassCallback::release()
+{
+    delete this;
+}
+
+void PTGuidingPassCallback::pre_render(
+    const Frame&            frame,
+    JobQueue&               job_queue,
+    IAbortSwitch&           abort_switch)
+{
+}
+
+void PTGuidingPassCallback::post_render(
+    const Frame&            frame,
+    JobQueue&               job_queue,
+    IAbortSwitch&           abort_switch)
+{
+    m_guiding_tree.update();
+    ++m_pass_number;
+
+    RENDERER_LOG_DEBUG(
+        "path guiding tree after pass %s: %s %s.",
+        pretty_uint(m_pass_number).c_str(),
+        pretty_uint(m_guiding_tree.get_leaf_count()).c_str(),
+        plural(m_guiding_tree.get_leaf_count(), "leaf", "leaves").c_str());
+}
+
+}   // namespace renderer
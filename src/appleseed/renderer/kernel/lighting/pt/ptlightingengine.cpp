@@ -34,22 +34,30 @@
 #include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/aov/spectrumstack.h"
+#include "renderer/kernel/lighting/brightnessmap.h"
 #include "renderer/kernel/lighting/directlightingintegrator.h"
+#include "renderer/kernel/lighting/environmentimportancemap.h"
 #include "renderer/kernel/lighting/imagebasedlighting.h"
+#include "renderer/kernel/lighting/pathguidingtree.h"
 #include "renderer/kernel/lighting/pathtracer.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/rendering/pixelcontext.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/modeling/bsdf/bsdf.h"
 #include "renderer/modeling/edf/edf.h"
 #include "renderer/modeling/environment/environment.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/frame/frame.h"
 #include "renderer/modeling/light/light.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/utility/stochasticcast.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/math/fp.h"
 #include "foundation/math/mis.h"
 #include "foundation/math/population.h"
 #include "foundation/math/vector.h"
@@ -64,10 +72,10 @@
 #include <cmath>
 #include <cstddef>
 #include <string>
+#include <vector>
 
 // Forward declarations.
 namespace renderer  { class LightSampler; }
-namespace renderer  { class PixelContext; }
 namespace renderer  { class TextureCache; }
 
 using namespace foundation;
@@ -101,13 +109,24 @@ namespace
             const size_t    m_max_path_length;              // maximum path length, ~0 for unlimited
             const size_t    m_rr_min_path_length;           // minimum path length before Russian Roulette kicks in, ~0 for unlimited
             const bool      m_next_event_estimation;        // use next event estimation?
+            const bool      m_weight_window;                // split and terminate paths with a weight window instead of Russian Roulette?
+            const size_t    m_ww_max_split;                 // maximum number of paths a path may be split into at once
 
             const float     m_dl_light_sample_count;        // number of light samples used to estimate direct illumination
             const float     m_ibl_env_sample_count;         // number of environment samples used to estimate IBL
 
+            const bool      m_ibl_importance_map;           // sample the environment from a precomputed importance map?
+            const size_t    m_ibl_importance_map_width;     // width of the importance map, its height is half of it
+            const bool      m_ibl_mis_compensation;         // apply MIS compensation to the importance map?
+
             const bool      m_has_max_ray_intensity;
             const float     m_max_ray_intensity;
 
+            const bool      m_enable_path_guiding;          // is path guiding enabled?
+            const float     m_guided_fraction;              // fraction of the scattered directions sampled from the guiding tree
+
+            const bool      m_batch_shadow_rays;            // trace direct lighting shadow rays once all light samples are evaluated?
+
             float           m_rcp_dl_light_sample_count;
             float           m_rcp_ibl_env_sample_count;
 
@@ -118,10 +137,18 @@ namespace
               , m_max_path_length(nz(params.get_optional<size_t>("max_path_length", 0)))
               , m_rr_min_path_length(nz(params.get_optional<size_t>("rr_min_path_length", 6)))
               , m_next_event_estimation(params.get_optional<bool>("next_event_estimation", true))
+              , m_weight_window(params.get_optional<bool>("weight_window", false))
+              , m_ww_max_split(max<size_t>(params.get_optional<size_t>("weight_window_max_split", 4), 1))
               , m_dl_light_sample_count(params.get_optional<float>("dl_light_samples", 1.0f))
               , m_ibl_env_sample_count(params.get_optional<float>("ibl_env_samples", 1.0f))
+              , m_ibl_importance_map(params.get_optional<bool>("ibl_importance_map", false))
+              , m_ibl_importance_map_width(max<size_t>(params.get_optional<size_t>("ibl_importance_map_resolution", 256), 2))
+              , m_ibl_mis_compensation(params.get_optional<bool>("ibl_mis_compensation", true))
               , m_has_max_ray_intensity(params.strings().exist("max_ray_intensity"))
               , m_max_ray_intensity(params.get_optional<float>("max_ray_intensity", 0.0f))
+              , m_enable_path_guiding(params.get_optional<bool>("enable_path_guiding", false))
+              , m_guided_fraction(clamp(params.get_optional<float>("path_guiding_fraction", 0.5f), 0.0f, 0.9f))
+              , m_batch_shadow_rays(params.get_optional<bool>("dl_batch_shadow_rays", false))
             {
                 // Precompute the reciprocal of the number of light samples.
                 m_rcp_dl_light_sample_count =
@@ -143,6 +170,12 @@ namespace
 
             void print() const
             {
+                const string importance_map =
+                    m_ibl_importance_map
+                        ? pretty_uint(m_ibl_importance_map_width) + "x" + pretty_uint(m_ibl_importance_map_width / 2) +
+                          (m_ibl_mis_compensation ? ", mis compensation" : "")
+                        : "off";
+
                 RENDERER_LOG_INFO(
                     "path tracing settings:\n"
                     "  direct lighting  %s\n"
@@ -151,28 +184,54 @@ namespace
                     "  max path length  %s\n"
                     "  rr min path len. %s\n"
                     "  next event est.  %s\n"
+                    "  weight window    %s\n"
                     "  dl light samples %s\n"
                     "  ibl env samples  %s\n"
-                    "  max ray intens.  %s",
+                    "  ibl imp. map     %s\n"
+                    "  max ray intens.  %s\n"
+                    "  path guiding     %s\n"
+                    "  batch sh. rays   %s",
                     m_enable_dl ? "on" : "off",
                     m_enable_ibl ? "on" : "off",
                     m_enable_caustics ? "on" : "off",
                     m_max_path_length == size_t(~0) ? "infinite" : pretty_uint(m_max_path_length).c_str(),
                     m_rr_min_path_length == size_t(~0) ? "infinite" : pretty_uint(m_rr_min_path_length).c_str(),
                     m_next_event_estimation ? "on" : "off",
+                    m_weight_window ? ("max split " + pretty_uint(m_ww_max_split)).c_str() : "off",
                     pretty_scalar(m_dl_light_sample_count).c_str(),
                     pretty_scalar(m_ibl_env_sample_count).c_str(),
-                    m_has_max_ray_intensity ? pretty_scalar(m_max_ray_intensity).c_str() : "infinite");
+                    importance_map.c_str(),
+                    m_has_max_ray_intensity ? pretty_scalar(m_max_ray_intensity).c_str() : "infinite",
+                    m_enable_path_guiding ? pretty_percent(m_guided_fraction, 1.0f).c_str() : "off",
+                    m_batch_shadow_rays ? "on" : "off");
             }
         };
 
         PTLightingEngine(
             const LightSampler&     light_sampler,
+            PathGuidingTree*        guiding_tree,
+            EnvironmentImportanceMap* env_importance_map,
+            BrightnessMap*          brightness_map,
             const ParamArray&       params)
           : m_params(params)
           , m_light_sampler(light_sampler)
+          , m_guiding_tree(m_params.m_enable_path_guiding ? guiding_tree : 0)
+          , m_env_importance_map(env_importance_map)
+          , m_brightness_map(brightness_map)
+          , m_image_luminance_sum(0.0)
+          , m_image_path_count(0)
           , m_path_count(0)
         {
+            m_compute_lighting =
+                m_params.m_next_event_estimation
+                    ? select_compute_lighting<PathVisitorNextEventEstimation>()
+                    : select_compute_lighting<PathVisitorSimple>();
+        }
+
+        virtual ~PTLightingEngine()
+        {
+            flush_guiding_records();
+            flush_image_luminance();
         }
 
         virtual void release() APPLESEED_OVERRIDE
@@ -188,42 +247,44 @@ namespace
             Spectrum&               radiance,               // output radiance, in W.sr^-1.m^-2
             SpectrumStack&          aovs) APPLESEED_OVERRIDE
         {
-            if (m_params.m_next_event_estimation)
-            {
-                do_compute_lighting<PathVisitorNextEventEstimation>(
-                    sampling_context,
-                    shading_context,
-                    shading_point,
-                    radiance,
-                    aovs);
-            }
-            else
-            {
-                do_compute_lighting<PathVisitorSimple>(
-                    sampling_context,
-                    shading_context,
-                    shading_point,
-                    radiance,
-                    aovs);
-            }
+            (this->*m_compute_lighting)(
+                sampling_context,
+                pixel_context,
+                shading_context,
+                shading_point,
+                radiance,
+                aovs);
         }
 
         template <typename PathVisitor>
         void do_compute_lighting(
             SamplingContext&        sampling_context,
+            const PixelContext&     pixel_context,
             const ShadingContext&   shading_context,
             const ShadingPoint&     shading_point,
             Spectrum&               radiance,               // output radiance, in W.sr^-1.m^-2
             SpectrumStack&          aovs)
         {
+            const bool guided = m_guiding_tree && m_guiding_tree->is_trained();
+
+            // The importance map is rasterized by the first thread that needs it.
+            const EnvironmentEDF* env_edf = shading_point.get_scene().get_environment()->get_environment_edf();
+            const bool use_env_importance_map = m_env_importance_map && env_edf;
+            if (use_env_importance_map)
+                m_env_importance_map->build(shading_context, *env_edf);
+
             PathVisitor path_visitor(
                 m_params,
                 m_light_sampler,
+                guided ? m_guiding_tree : 0,
+                use_env_importance_map ? m_env_importance_map : 0,
                 sampling_context,
                 shading_context,
                 shading_point.get_scene(),
                 radiance,
-                aovs);
+                aovs,
+                m_guiding_tree ? &m_guiding_vertices : 0,
+                m_params.m_batch_shadow_rays ? &m_shadow_ray_batch : 0);
 
             PathTracer<PathVisitor, false> path_tracer(     // false = not adjoint
                 path_visitor,
@@ -231,12 +292,42 @@ namespace
                 m_params.m_max_path_length,
                 shading_context.get_max_iterations());
 
+            if (guided)
+                path_tracer.set_path_guiding(m_guiding_tree, m_params.m_guided_fraction);
+
+            const size_t pixel_x = static_cast<size_t>(pixel_context.get_pixel_coords().x);
+            const size_t pixel_y = static_cast<size_t>(pixel_context.get_pixel_coords().y);
+
+            // Use a weight window once the brightness of the pixel and of the image are known.
+            // Paths are not split while training the guiding tree since it expects a single
+            // path per call.
+            if (m_brightness_map)
+            {
+                const float pixel_luminance = m_brightness_map->get_pixel_luminance(pixel_x, pixel_y);
+                const float image_luminance = m_brightness_map->get_image_luminance();
+
+                if (pixel_luminance > 0.0f && image_luminance > 0.0f)
+                {
+                    path_tracer.set_weight_window(
+                        pixel_luminance / image_luminance,
+                        m_guiding_tree ? 1 : m_params.m_ww_max_split);
+                }
+            }
+
             const size_t path_length =
                 path_tracer.trace(
                     sampling_context,
                     shading_context,
                     shading_point);
 
+            // Train the guiding tree with the radiance carried by this path.
+            if (m_guiding_tree)
+                record_guiding_vertices(average_value(radiance));
+
+            // Refine the estimated brightness of the pixel and of the image.
+            if (m_brightness_map)
+                record_brightness(pixel_x, pixel_y, average_value(radiance));
+
             // Update statistics.
             ++m_path_count;
             m_path_length.insert(path_length);
@@ -252,12 +343,151 @@ namespace
         }
 
       private:
+        typedef void (PTLightingEngine::*ComputeLightingFn)(
+            SamplingContext&        sampling_context,
+            const PixelContext&     pixel_context,
+            const ShadingContext&   shading_context,
+            const ShadingPoint&     shading_point,
+            Spectrum&               radiance,
+            SpectrumStack&          aovs);
+
+        //
+        // Lighting flags of the path visitors.
+        //
+        // The flags of the most common configurations are compile-time constants: the path
+        // visitors, and the path tracer loop they are inlined into, are then specialized for
+        // them and the tests of disabled features vanish. Other configurations read the flags
+        // from the parameters.
+        //
+
+        template <bool EnableDL, bool EnableIBL, bool EnableCaustics>
+        struct StaticLightingFlags
+        {
+            static bool enable_dl(const Parameters&)                { return EnableDL; }
+            static bool enable_ibl(const Parameters&)               { return EnableIBL; }
+            static bool enable_caustics(const Parameters&)          { return EnableCaustics; }
+        };
+
+        struct DynamicLightingFlags
+        {
+            static bool enable_dl(const Parameters& params)         { return params.m_enable_dl; }
+            static bool enable_ibl(const Parameters& params)        { return params.m_enable_ibl; }
+            static bool enable_caustics(const Parameters& params)   { return params.m_enable_caustics; }
+        };
+
+        // Select the instantiation of do_compute_lighting() matching the lighting settings.
+        template <template <typename> class PathVisitor>
+        ComputeLightingFn select_compute_lighting() const
+        {
+            if (m_params.m_enable_dl && m_params.m_enable_ibl)
+            {
+                return
+                    m_params.m_enable_caustics
+                        ? &PTLightingEngine::do_compute_lighting<PathVisitor<StaticLightingFlags<true, true, true> > >
+                        : &PTLightingEngine::do_compute_lighting<PathVisitor<StaticLightingFlags<true, true, false> > >;
+            }
+            else return &PTLightingEngine::do_compute_lighting<PathVisitor<DynamicLightingFlags> >;
+        }
+
+        // A path vertex reached by sampling a non-specular scattering event.
+        struct GuidingVertex
+        {
+            Vector3f                    m_position;             // world space position of the scattering event
+            Vector3f                    m_direction;            // world space direction of the scattered ray, unit-length
+            float                       m_throughput;           // average path throughput at the vertex
+            float                       m_probability;          // density with which the direction was sampled
+            float                       m_path_radiance;        // average path radiance before the vertex
+        };
+
+        typedef vector<GuidingVertex> GuidingVertexVector;
+
+        typedef DirectLightingIntegrator::ShadowRayBatch ShadowRayBatch;
+
+        // Number of radiance records accumulated before they are added to the guiding tree.
+        enum { GuidingRecordBatchSize = 4096 };
+
+        // Number of paths whose luminance is accumulated before it is added to the brightness map.
+        enum { ImageLuminanceBatchSize = 1024 };
+
         const Parameters                m_params;
+        ComputeLightingFn               m_compute_lighting;
         const LightSampler&             m_light_sampler;
+        PathGuidingTree*                m_guiding_tree;         // 0 if path guiding is disabled
+        EnvironmentImportanceMap*       m_env_importance_map;   // 0 if the environment is sampled by its EDF
+        BrightnessMap*                  m_brightness_map;       // 0 if the weight window is disabled
+
+        GuidingVertexVector             m_guiding_vertices;
+        PathGuidingTree::RecordVector   m_guiding_records;
+
+        ShadowRayBatch                  m_shadow_ray_batch;     // only used if shadow rays are batched
+
+        double                          m_image_luminance_sum;  // luminance of the paths not yet added to the brightness map
+        size_t                          m_image_path_count;
 
         uint64                          m_path_count;
         Population<uint64>              m_path_length;
 
+        void record_guiding_vertices(const float path_radiance)
+        {
+            // The incident radiance at a scattering event is the radiance gathered by the
+            // rest of the path divided by the throughput of the path at the next vertex.
+            for (size_t i = 0, e = m_guiding_vertices.size(); i < e; ++i)
+            {
+                const GuidingVertex& vertex = m_guiding_vertices[i];
+
+                if (vertex.m_throughput > 0.0f && vertex.m_probability > 0.0f)
+                {
+                    PathGuidingTree::Record record;
+                    record.m_position = vertex.m_position;
+                    record.m_direction = vertex.m_direction;
+                    record.m_radiance =
+                        max(path_radiance - vertex.m_path_radiance, 0.0f) /
+                        (vertex.m_throughput * vertex.m_probability);
+                    m_guiding_records.push_back(record);
+                }
+            }
+
+            m_guiding_vertices.clear();
+
+            if (m_guiding_records.size() >= GuidingRecordBatchSize)
+                flush_guiding_records();
+        }
+
+        void flush_guiding_records()
+        {
+            if (m_guiding_tree && !m_guiding_records.empty())
+            {
+                m_guiding_tree->append(m_guiding_records);
+                m_guiding_records.clear();
+            }
+        }
+
+        void record_brightness(
+            const size_t                x,
+            const size_t                y,
+            const float                 luminance)
+        {
+            // Don't let a single invalid sample spoil the estimates.
+            if (!FP<float>::is_finite(luminance) || luminance < 0.0f)
+                return;
+
+            m_brightness_map->record_path(x, y, luminance);
+
+            m_image_luminance_sum += luminance;
+            if (++m_image_path_count >= ImageLuminanceBatchSize)
+                flush_image_luminance();
+        }
+
+        void flush_image_luminance()
+        {
+            if (m_brightness_map && m_image_path_count > 0)
+            {
+                m_brightness_map->record_image_paths(m_image_luminance_sum, m_image_path_count);
+                m_image_luminance_sum = 0.0;
+                m_image_path_count = 0;
+            }
+        }
+
         //
         // Base path visitor.
         //
@@ -266,39 +496,80 @@ namespace
         {
             const Parameters&           m_params;
             const LightSampler&         m_light_sampler;
+            const PathGuidingTree*      m_guiding_tree;         // 0 if paths are not guided
+            const EnvironmentImportanceMap* m_env_importance_map; // 0 if the environment is sampled by its EDF
             SamplingContext&            m_sampling_context;
             const ShadingContext&       m_shading_context;
             const EnvironmentEDF*       m_env_edf;
             Spectrum&                   m_path_radiance;
             SpectrumStack&              m_path_aovs;
+            GuidingVertexVector*        m_guiding_vertices;     // 0 if path guiding is disabled
+            ShadowRayBatch*             m_shadow_ray_batch;     // 0 if shadow rays are traced immediately
             bool                        m_omit_emitted_light;   // todo: get rid of this
 
             PathVisitorBase(
                 const Parameters&       params,
                 const LightSampler&     light_sampler,
+                const PathGuidingTree*  guiding_tree,
+                const EnvironmentImportanceMap* env_importance_map,
                 SamplingContext&        sampling_context,
                 const ShadingContext&   shading_context,
                 const Scene&            scene,
                 Spectrum&               path_radiance,
-                SpectrumStack&          path_aovs)
+                SpectrumStack&          path_aovs,
+                GuidingVertexVector*    guiding_vertices,
+                ShadowRayBatch*         shadow_ray_batch)
               : m_params(params)
               , m_light_sampler(light_sampler)
+              , m_guiding_tree(guiding_tree)
+              , m_env_importance_map(env_importance_map)
               , m_sampling_context(sampling_context)
               , m_shading_context(shading_context)
               , m_env_edf(scene.get_environment()->get_environment_edf())
               , m_path_radiance(path_radiance)
               , m_path_aovs(path_aovs)
+              , m_guiding_vertices(guiding_vertices)
+              , m_shadow_ray_batch(shadow_ray_batch)
               , m_omit_emitted_light(false)
             {
             }
 
+            void record_guiding_vertex(const PathVertex& vertex)
+            {
+                // Only non-specular scattering events are guided.
+                if (m_guiding_vertices == 0 ||
+                    vertex.m_path_length < 2 ||
+                    !ScatteringMode::has_diffuse_or_glossy(vertex.m_prev_mode))
+                    return;
+
+                const ShadingRay& ray = vertex.m_shading_point->get_ray();
+
+                GuidingVertex guiding_vertex;
+                guiding_vertex.m_position = Vector3f(ray.m_org);
+                guiding_vertex.m_direction = normalize(Vector3f(ray.m_dir));
+                guiding_vertex.m_throughput = average_value(vertex.m_throughput);
+                guiding_vertex.m_probability = vertex.m_prev_prob;
+                guiding_vertex.m_path_radiance = average_value(m_path_radiance);
+
+                // The direction may have been sampled from the guiding tree as well.
+                if (m_guiding_tree)
+                {
+                    guiding_vertex.m_probability =
+                          m_params.m_guided_fraction * m_guiding_tree->evaluate_pdf(ray.m_org, guiding_vertex.m_direction)
+                        + (1.0f - m_params.m_guided_fraction) * guiding_vertex.m_probability;
+                }
+
+                m_guiding_vertices->push_back(guiding_vertex);
+            }
+
             bool accept_scattering(
                 const ScatteringMode::Mode  prev_mode,
-                const ScatteringMode::Mode  next_mode)
+                const ScatteringMode::Mode  next_mode,
+                const bool                  enable_caustics)
             {
                 assert(next_mode != ScatteringMode::Absorption);
 
-                if (!m_params.m_enable_caustics)
+                if (!enable_caustics)
                 {
                     // Don't follow paths leading to caustics.
                     if (ScatteringMode::has_diffuse(prev_mode) &&
@@ -319,35 +590,58 @@ namespace
         // Path visitor without next event estimation.
         //
 
+        template <typename LightingFlags>
         struct PathVisitorSimple
           : public PathVisitorBase
         {
             PathVisitorSimple(
                 const Parameters&       params,
                 const LightSampler&     light_sampler,
+                const PathGuidingTree*  guiding_tree,
+                const EnvironmentImportanceMap* env_importance_map,
                 SamplingContext&        sampling_context,
                 const ShadingContext&   shading_context,
                 const Scene&            scene,
                 Spectrum&               path_radiance,
-                SpectrumStack&          path_aovs)
+                SpectrumStack&          path_aovs,
+                GuidingVertexVector*    guiding_vertices,
+                ShadowRayBatch*         shadow_ray_batch)
               : PathVisitorBase(
                     params,
                     light_sampler,
+                    guiding_tree,
+                    env_importance_map,
                     sampling_context,
                     shading_context,
                     scene,
                     path_radiance,
-                    path_aovs)
+                    path_aovs,
+                    guiding_vertices,
+                    shadow_ray_batch)
+            {
+            }
+
+            bool accept_scattering(
+                const ScatteringMode::Mode  prev_mode,
+                const ScatteringMode::Mode  next_mode)
             {
+                return
+                    PathVisitorBase::accept_scattering(
+                        prev_mode,
+                        next_mode,
+                        LightingFlags::enable_caustics(m_params));
             }
 
             void visit_vertex(const PathVertex& vertex)
             {
-                if ((!m_omit_emitted_light || m_params.m_enable_caustics) &&
+                record_guiding_vertex(vertex);
+
+                if ((!m_omit_emitted_light || LightingFlags::enable_caustics(m_params)) &&
                     vertex.m_edf &&
                     vertex.m_cos_on > 0.0 &&
-                    (vertex.m_path_length > 2 || m_params.m_enable_dl) &&
-                    (vertex.m_path_length < 2 || (vertex.m_edf->get_flags() & EDF::CastIndirectLight)))
+                    (vertex.m_path_length > 2 || LightingFlags::enable_dl(m_params)) &&
+                    (vertex.m_path_length < 2 || (vertex.m_edf->get_flags() & EDF::CastIndirectLight)) &&
+                    vertex.is_illuminating(m_light_sampler))
                 {
                     // Compute the emitted radiance.
                     Spectrum emitted_radiance(Spectrum::Illuminance);
@@ -364,12 +658,14 @@ namespace
             {
                 assert(vertex.m_prev_mode != ScatteringMode::Absorption);
 
+                record_guiding_vertex(vertex);
+
                 // Can't look up the environment if there's no environment EDF.
                 if (m_env_edf == 0)
                     return;
 
                 // When IBL is disabled, only specular reflections should contribute here.
-                if (!m_params.m_enable_ibl && vertex.m_prev_mode != ScatteringMode::Specular)
+                if (!LightingFlags::enable_ibl(m_params) && vertex.m_prev_mode != ScatteringMode::Specular)
                     return;
 
                 // Evaluate the environment EDF.
@@ -392,6 +688,7 @@ namespace
         // Path visitor with next event estimation.
         //
 
+        template <typename LightingFlags>
         struct PathVisitorNextEventEstimation
           : public PathVisitorBase
         {
@@ -400,31 +697,52 @@ namespace
             PathVisitorNextEventEstimation(
                 const Parameters&       params,
                 const LightSampler&     light_sampler,
+                const PathGuidingTree*  guiding_tree,
+                const EnvironmentImportanceMap* env_importance_map,
                 SamplingContext&        sampling_context,
                 const ShadingContext&   shading_context,
                 const Scene&            scene,
                 Spectrum&               path_radiance,
-                SpectrumStack&          path_aovs)
+                SpectrumStack&          path_aovs,
+                GuidingVertexVector*    guiding_vertices,
+                ShadowRayBatch*         shadow_ray_batch)
               : PathVisitorBase(
                     params,
                     light_sampler,
+                    guiding_tree,
+                    env_importance_map,
                     sampling_context,
                     shading_context,
                     scene,
                     path_radiance,
-                    path_aovs)
+                    path_aovs,
+                    guiding_vertices,
+                    shadow_ray_batch)
               , m_is_indirect_lighting(false)
             {
             }
 
+            bool accept_scattering(
+                const ScatteringMode::Mode  prev_mode,
+                const ScatteringMode::Mode  next_mode)
+            {
+                return
+                    PathVisitorBase::accept_scattering(
+                        prev_mode,
+                        next_mode,
+                        LightingFlags::enable_caustics(m_params));
+            }
+
             void visit_vertex(const PathVertex& vertex)
             {
+                record_guiding_vertex(vertex);
+
                 // Any light contribution after a diffuse or glossy bounce is considered indirect.
                 if (ScatteringMode::has_diffuse_or_glossy(vertex.m_prev_mode))
                     m_is_indirect_lighting = true;
 
                 const int scattering_modes =
-                    !m_params.m_enable_caustics && vertex.m_prev_mode == ScatteringMode::Diffuse
+                    !LightingFlags::enable_caustics(m_params) && vertex.m_prev_mode == ScatteringMode::Diffuse
                         ? ScatteringMode::Diffuse
                         : ScatteringMode::All;
 
@@ -434,11 +752,12 @@ namespace
                 SpectrumStack vertex_aovs(m_path_aovs.size(), 0.0f);
 
                 // Emitted light.
-                if ((!m_omit_emitted_light || m_params.m_enable_caustics) &&
+                if ((!m_omit_emitted_light || LightingFlags::enable_caustics(m_params)) &&
                     vertex.m_edf &&
                     vertex.m_cos_on > 0.0 &&
-                    (vertex.m_path_length > 2 || m_params.m_enable_dl) &&
-                    (vertex.m_path_length < 2 || (vertex.m_edf->get_flags() & EDF::CastIndirectLight)))
+                    (vertex.m_path_length > 2 || LightingFlags::enable_dl(m_params)) &&
+                    (vertex.m_path_length < 2 || (vertex.m_edf->get_flags() & EDF::CastIndirectLight)) &&
+                    vertex.is_illuminating(m_light_sampler))
                 {
                     add_emitted_light_contribution(
                         vertex,
@@ -449,7 +768,7 @@ namespace
                 // If we have an OSL shader and this is not the last vertex of the path,
                 // we need to choose one of the closures and set its shading basis into the shading point
                 // for the DirectLightingIntegrator to use it.
-                if (!last_vertex && (m_params.m_enable_dl || m_params.m_enable_ibl))
+                if (!last_vertex && (LightingFlags::enable_dl(m_params) || LightingFlags::enable_ibl(m_params)))
                 {
                     const Material::RenderData& material_data =
                         vertex.m_shading_point->get_material()->get_render_data();
@@ -463,7 +782,7 @@ namespace
                 }
 
                 // Direct lighting.
-                if (m_params.m_enable_dl || vertex.m_path_length > 1)
+                if (LightingFlags::enable_dl(m_params) || vertex.m_path_length > 1)
                 {
                     if (vertex.m_bsdf)
                     {
@@ -480,7 +799,7 @@ namespace
                 }
 
                 // Image-based lighting.
-                if (m_params.m_enable_ibl && m_env_edf)
+                if (LightingFlags::enable_ibl(m_params) && m_env_edf)
                 {
                     if (vertex.m_bsdf)
                     {
@@ -542,7 +861,8 @@ namespace
                     scattering_modes,
                     bsdf_sample_count,
                     light_sample_count,
-                    m_is_indirect_lighting);
+                    m_is_indirect_lighting,
+                    m_shadow_ray_batch);
 
                 if (last_vertex)
                 {
@@ -627,6 +947,7 @@ namespace
                         m_sampling_context,
                         m_shading_context,
                         *m_env_edf,
+                        m_env_importance_map,
                         shading_point,
                         outgoing,
                         bsdf,
@@ -644,6 +965,7 @@ namespace
                         m_sampling_context,
                         m_shading_context,
                         *m_env_edf,
+                        m_env_importance_map,
                         shading_point,
                         outgoing,
                         bsdf,
@@ -667,12 +989,14 @@ namespace
             {
                 assert(vertex.m_prev_mode != ScatteringMode::Absorption);
 
+                record_guiding_vertex(vertex);
+
                 // Can't look up the environment if there's no environment EDF.
                 if (m_env_edf == 0)
                     return;
 
                 // When IBL is disabled, only specular reflections should contribute here.
-                if (!m_params.m_enable_ibl && vertex.m_prev_mode != ScatteringMode::Specular)
+                if (!LightingFlags::enable_ibl(m_params) && vertex.m_prev_mode != ScatteringMode::Specular)
                     return;
 
                 // Evaluate the environment EDF.
@@ -689,6 +1013,10 @@ namespace
                 if (env_prob == 0.0)
                     return;
 
+                // The environment may be sampled from the importance map instead.
+                if (m_env_importance_map)
+                    env_prob = m_env_importance_map->evaluate_pdf(-Vector3f(vertex.m_outgoing.get_value()));
+
                 // Multiple importance sampling.
                 if (vertex.m_prev_mode != ScatteringMode::Specular)
                 {
@@ -736,12 +1064,38 @@ namespace
 //
 
 PTLightingEngineFactory::PTLightingEngineFactory(
+    const Frame&        frame,
     const LightSampler& light_sampler,
-    const ParamArray&   params)
+    const ParamArray&   params,
+    PathGuidingTree*    guiding_tree)
   : m_light_sampler(light_sampler)
+  , m_guiding_tree(guiding_tree)
   , m_params(params)
 {
-    PTLightingEngine::Parameters(params).print();
+    const PTLightingEngine::Parameters pt_params(params);
+    pt_params.print();
+
+    if (pt_params.m_enable_ibl && pt_params.m_ibl_importance_map)
+    {
+        m_env_importance_map.reset(
+            new EnvironmentImportanceMap(
+                pt_params.m_ibl_importance_map_width,
+                pt_params.m_ibl_importance_map_width / 2,
+                pt_params.m_ibl_mis_compensation));
+    }
+
+    if (pt_params.m_weight_window)
+    {
+        const CanvasProperties& props = frame.image().properties();
+        m_brightness_map.reset(
+            new BrightnessMap(
+                props.m_canvas_width,
+                props.m_canvas_height));
+    }
+}
+
+PTLightingEngineFactory::~PTLightingEngineFactory()
+{
 }
 
 void PTLightingEngineFactory::release()
@@ -751,7 +1105,13 @@ void PTLightingEngineFactory::release()
 
 ILightingEngine* PTLightingEngineFactory::create()
 {
-    return new PTLightingEngine(m_light_sampler, m_params);
+    return
+        new PTLightingEngine(
+            m_light_sampler,
+            m_guiding_tree,
+            m_env_importance_map.get(),
+            m_brightness_map.get(),
+            m_params);
 }
 
 Dictionary PTLightingEngineFactory::get_params_metadata()
@@ -802,6 +1162,23 @@ Dictionary PTLightingEngineFactory::get_params_metadata()
             .insert("label", "Next Event Estimation")
             .insert("help", "Explicitly connect path vertices to light sources to improve efficiency"));
 
+    metadata.dictionaries().insert(
+        "weight_window",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Weight Window")
+            .insert("help", "Split paths in dark pixels and terminate paths in bright pixels, based on the brightness of the image rendered so far, instead of using Russian Roulette"));
+
+    metadata.dictionaries().insert(
+        "weight_window_max_split",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "4")
+            .insert("min", "1")
+            .insert("label", "Weight Window Max Split")
+            .insert("help", "Maximum number of paths a path may be split into at once"));
+
     metadata.dictionaries().insert(
         "max_ray_intensity",
         Dictionary()
@@ -812,6 +1189,43 @@ Dictionary PTLightingEngineFactory::get_params_metadata()
             .insert("label", "Max Ray Intensity")
             .insert("help", "Clamp intensity of rays (after the first bounce) to this value to reduce fireflies"));
 
+    add_ibl_importance_map_params_metadata(metadata);
+
+    metadata.dictionaries().insert(
+        "enable_path_guiding",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Path Guiding")
+            .insert("help", "Learn the distribution of incident light during the passes of a multi-pass render and use it to guide paths"));
+
+    metadata.dictionaries().insert(
+        "path_guiding_fraction",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.5")
+            .insert("min", "0.0")
+            .insert("max", "0.9")
+            .insert("label", "Path Guiding Fraction")
+            .insert("help", "Fraction of the scattered directions sampled from the learned distribution rather than from the BSDF"));
+
+    metadata.dictionaries().insert(
+        "path_guiding_spatial_threshold",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "4000")
+            .insert("min", "1")
+            .insert("label", "Path Guiding Spatial Threshold")
+            .insert("help", "Number of radiance records per pass beyond which a region of the learned distribution is subdivided"));
+
+    metadata.dictionaries().insert(
+        "dl_batch_shadow_rays",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Batch Shadow Rays")
+            .insert("help", "Evaluate all light samples of a shading point before tracing their shadow rays, skipping samples that don't contribute"));
+
     return metadata;
 }
 
@@ -37,9 +37,16 @@
 // appleseed.foundation headers.
 #include "foundation/platform/compiler.h"
 
+// Standard headers.
+#include <memory>
+
 // Forward declarations.
 namespace foundation    { class Dictionary; }
+namespace renderer      { class BrightnessMap; }
+namespace renderer      { class EnvironmentImportanceMap; }
+namespace renderer      { class Frame; }
 namespace renderer      { class LightSampler; }
+namespace renderer      { class PathGuidingTree; }
 
 namespace renderer
 {
@@ -54,8 +61,13 @@ class PTLightingEngineFactory
   public:
     // Constructor.
     PTLightingEngineFactory(
+        const Frame&        frame,
         const LightSampler& light_sampler,
-        const ParamArray&   params);
+        const ParamArray&   params,
+        PathGuidingTree*    guiding_tree = 0);    // trained between passes, may be 0
+
+    // Destructor.
+    ~PTLightingEngineFactory();
 
     // Delete this instance.
     virtual void release() APPLESEED_OVERRIDE;
@@ -67,8 +79,11 @@ class PTLightingEngineFactory
     static foundation::Dictionary get_params_metadata();
 
   private:
-    const LightSampler&     m_light_sampler;
-    ParamArray              m_params;
+    const LightSampler&                     m_light_sampler;
+    PathGuidingTree*                        m_guiding_tree;
+    ParamArray                              m_params;
+    std::auto_ptr<EnvironmentImportanceMap> m_env_importance_map;   // shared by all PT lighting engines
+    std::auto_ptr<BrightnessMap>            m_brightness_map;       // shared by all PT lighting engines
 };
 
 }       // namespace renderer
@@ -47,6 +47,7 @@
 #include "renderer/modeling/environment/environment.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
 #include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/hotpathcounters.h"
 #include "renderer/utility/stochasticcast.h"
 
 // appleseed.foundation headers.
@@ -316,7 +317,8 @@ namespace
                     ScatteringMode::All,
                     bsdf_sample_count,
                     light_sample_count,
-                    false);             // not computing indirect lighting
+                    false,              // not computing indirect lighting
+                    0);                 // trace shadow rays immediately
 
                 // Always sample both the lights and the BSDF.
                 integrator.compute_outgoing_radiance_combined_sampling_low_variance(
@@ -352,8 +354,7 @@ namespace
                 const float radius = m_pass_callback.get_lookup_radius();
 
                 // Find the nearby photons around the path vertex.
-                const knn::Query3f query(photon_map, m_answer);
-                query.run(point, radius * radius);
+                photon_map.find_nearest(point, radius * radius, m_answer);
                 const size_t photon_count = m_answer.size();
 
                 // Compute the square radius of the lookup disk.
@@ -418,18 +419,22 @@ namespace
                         m_pass_callback.get_mono_photon(
                             photon_map.remap(entry.m_index));
 
+                    // Decompress the photon's directions.
+                    const Vector3f photon_incoming = photon.m_incoming.get();
+                    const Vector3f photon_geometric_normal = photon.m_geometric_normal.get();
+
                     // Reject photons from the opposite hemisphere as they won't contribute.
-                    if (dot(normal, photon.m_incoming) <= 0.0f)
+                    if (dot(normal, photon_incoming) <= 0.0f)
                         continue;
 
                     // Reject photons on a surface with too different an orientation.
                     const float NormalThreshold = 1.0e-3f;
-                    if (dot(normal, photon.m_geometric_normal) < NormalThreshold)
+                    if (dot(normal, photon_geometric_normal) < NormalThreshold)
                         continue;
 
 #if 0
                     // Reject photons on the wrong side of the surface.
-                    if (dot(vertex.m_outgoing, Vector3d(photon.m_geometric_normal)) <= 0.0)
+                    if (dot(vertex.m_outgoing, Vector3d(photon_geometric_normal)) <= 0.0)
                         continue;
 #endif
 
@@ -443,6 +448,7 @@ namespace
 #endif
 
                     // Evaluate the BSDF for this photon.
+                    APPLESEED_HOT_PATH_COUNT(hot_path_counters().m_bsdf_evaluations.increment(vertex.m_bsdf->get_model()));
                     Spectrum bsdf_value;
                     const float bsdf_prob =
                         vertex.m_bsdf->evaluate(
@@ -452,7 +458,7 @@ namespace
                             Vector3f(vertex.get_geometric_normal()),
                             Basis3f(vertex.get_shading_basis()),
                             Vector3f(vertex.m_outgoing.get_value()),    // toward the camera
-                            normalize(photon.m_incoming),               // toward the light
+                            photon_incoming,                            // toward the light
                             ScatteringMode::Diffuse,
                             bsdf_value);
                     if (bsdf_prob == 0.0f)
@@ -466,7 +472,7 @@ namespace
                     // The first step of the flux -> radiance conversion is done here.
                     // The conversion will be completed when doing density estimation.
                     float bsdf_mono_value = spectral_bsdf_value[photon.m_flux.m_wavelength];
-                    bsdf_mono_value /= abs(dot(photon.m_incoming, photon.m_geometric_normal));
+                    bsdf_mono_value /= abs(dot(photon_incoming, photon_geometric_normal));
                     bsdf_mono_value *= photon.m_flux.m_amplitude;
 
                     // Apply kernel weight.
@@ -494,18 +500,22 @@ namespace
                         m_pass_callback.get_poly_photon(
                             photon_map.remap(entry.m_index));
 
+                    // Decompress the photon's directions.
+                    const Vector3f photon_incoming = photon.m_incoming.get();
+                    const Vector3f photon_geometric_normal = photon.m_geometric_normal.get();
+
                     // Reject photons from the opposite hemisphere as they won't contribute.
-                    if (dot(normal, photon.m_incoming) <= 0.0f)
+                    if (dot(normal, photon_incoming) <= 0.0f)
                         continue;
 
                     // Reject photons on a surface with too different an orientation.
                     const float NormalThreshold = 1.0e-3f;
-                    if (dot(normal, photon.m_geometric_normal) < NormalThreshold)
+                    if (dot(normal, photon_geometric_normal) < NormalThreshold)
                         continue;
 
 #if 0
                     // Reject photons on the wrong side of the surface.
-                    if (dot(vertex.m_outgoing, Vector3d(photon.m_geometric_normal)) <= 0.0)
+                    if (dot(vertex.m_outgoing, Vector3d(photon_geometric_normal)) <= 0.0)
                         continue;
 #endif
 
@@ -519,6 +529,7 @@ namespace
 #endif
 
                     // Evaluate the BSDF for this photon.
+                    APPLESEED_HOT_PATH_COUNT(hot_path_counters().m_bsdf_evaluations.increment(vertex.m_bsdf->get_model()));
                     Spectrum bsdf_value;
                     const float bsdf_prob =
                         vertex.m_bsdf->evaluate(
@@ -528,7 +539,7 @@ namespace
                             Vector3f(vertex.get_geometric_normal()),
                             Basis3f(vertex.get_shading_basis()),
                             Vector3f(vertex.m_outgoing.get_value()),    // toward the camera
-                            normalize(photon.m_incoming),               // toward the light
+                            photon_incoming,                            // toward the light
                             ScatteringMode::Diffuse,
                             bsdf_value);
                     if (bsdf_prob == 0.0f)
@@ -537,8 +548,10 @@ namespace
                     // The photons store flux but we are computing reflected radiance.
                     // The first step of the flux -> radiance conversion is done here.
                     // The conversion will be completed when doing density estimation.
-                    bsdf_value /= abs(dot(photon.m_incoming, photon.m_geometric_normal));
-                    bsdf_value *= photon.m_flux;
+                    bsdf_value /= abs(dot(photon_incoming, photon_geometric_normal));
+                    Spectrum photon_flux;
+                    photon.m_flux.get(photon_flux);
+                    bsdf_value *= photon_flux;
 
                     // Apply kernel weight.
                     bsdf_value *= epanechnikov2d(entry.m_square_dist * rcp_max_square_dist);
@@ -595,11 +608,10 @@ namespace
             Spectrum&               radiance)
         {
             const SPPMPhotonMap& photon_map = m_pass_callback.get_photon_map();
-            const knn::Query3f query(photon_map, m_answer);
-
-            query.run(
+            photon_map.find_nearest(
                 Vector3f(shading_point.get_point()),
-                square(m_params.m_view_photons_radius));
+                square(m_params.m_view_photons_radius),
+                m_answer);
 
             radiance.set(0.0f);
 
@@ -617,10 +629,12 @@ namespace
             }
             else
             {
+                Spectrum flux;
                 for (size_t i = 0; i < photon_count; ++i)
                 {
                     const knn::Answer<float>::Entry& photon = m_answer.get(i);
-                    radiance += m_pass_callback.get_poly_photon(photon_map.remap(photon.m_index)).m_flux;
+                    m_pass_callback.get_poly_photon(photon_map.remap(photon.m_index)).m_flux.get(flux);
+                    radiance += flux;
                 }
             }
 
@@ -696,6 +710,28 @@ Dictionary SPPMLightingEngineFactory::get_params_metadata()
                             .insert("label", "Poly")
                             .insert("help", "Polychromatic photons"))));
 
+    metadata.dictionaries().insert(
+        "photon_map",
+        Dictionary()
+            .insert("type", "enum")
+            .insert("values", "kdtree|hashgrid")
+            .insert("default", "kdtree")
+            .insert("label", "Photon Map")
+            .insert("help", "Structure used to look up photons")
+            .insert(
+                "options",
+                Dictionary()
+                    .insert(
+                        "kdtree",
+                        Dictionary()
+                            .insert("label", "Kd-Tree")
+                            .insert("help", "Kd-tree built after each photon pass"))
+                    .insert(
+                        "hashgrid",
+                        Dictionary()
+                            .insert("label", "Hash Grid")
+                            .insert("help", "Uniform hash grid sized from the lookup radius, faster to build and query"))));
+
     metadata.dictionaries().insert(
         "dl_type",
         Dictionary()
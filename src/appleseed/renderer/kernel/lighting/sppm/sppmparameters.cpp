@@ -66,12 +66,39 @@ namespace
                 default_value,
                 make_vector("mono", "poly"));
 
+#ifdef APPLESEED_USE_RGB_SPECTRUM
+        if (value == "mono")
+        {
+            RENDERER_LOG_WARNING(
+                "monochromatic photons require spectral rendering, which is disabled in this build; "
+                "using polychromatic photons instead.");
+            return SPPMParameters::Polychromatic;
+        }
+#endif
+
         return
             value == "mono"
                 ? SPPMParameters::Monochromatic
                 : SPPMParameters::Polychromatic;
     }
 
+    SPPMParameters::PhotonMapType get_photon_map_type(
+        const ParamArray&   params,
+        const char*         name,
+        const char*         default_value)
+    {
+        const string value =
+            params.get_optional<string>(
+                name,
+                default_value,
+                make_vector("kdtree", "hashgrid"));
+
+        return
+            value == "hashgrid"
+                ? SPPMParameters::HashGrid
+                : SPPMParameters::KDTree;
+    }
+
     SPPMParameters::Mode get_mode(
         const ParamArray&   params,
         const char*         name,
@@ -93,6 +120,7 @@ namespace
 SPPMParameters::SPPMParameters(const ParamArray& params)
   : m_sampling_mode(get_sampling_context_mode(params))
   , m_photon_type(get_photon_type(params, "photon_type", "poly"))
+  , m_photon_map_type(get_photon_map_type(params, "photon_map", "kdtree"))
   , m_dl_mode(get_mode(params, "dl_mode", "rt"))
   , m_enable_ibl(params.get_optional<bool>("enable_ibl", true))
   , m_enable_caustics(params.get_optional<bool>("enable_caustics", true))
@@ -124,9 +152,11 @@ void SPPMParameters::print() const
     RENDERER_LOG_INFO(
         "sppm settings:\n"
         "  photon type      %s\n"
+        "  photon map       %s\n"
         "  dl               %s\n"
         "  ibl              %s",
         m_photon_type == Monochromatic ? "monochromatic" : "polychromatic",
+        m_photon_map_type == KDTree ? "kd-tree" : "hash grid",
         m_dl_mode == RayTraced ? "ray traced" :
         m_dl_mode == SPPM ? "sppm" : "off",
         m_enable_ibl ? "on" : "off");
@@ -45,10 +45,12 @@ namespace renderer
 struct SPPMParameters
 {
     enum PhotonType { Monochromatic, Polychromatic };
+    enum PhotonMapType { KDTree, HashGrid };
     enum Mode { RayTraced, SPPM, Off };
 
     const SamplingContext::Mode m_sampling_mode;
     const PhotonType            m_photon_type;
+    const PhotonMapType         m_photon_map_type;                      // structure used to look up photons
 
     const Mode                  m_dl_mode;                              // direct lighting mode
     const bool                  m_enable_ibl;                           // is image-based lighting enabled?
@@ -62,8 +62,10 @@ SPPMPassCallback::SPPMPassCallback(
     TextureStore&           texture_store,
     OIIO::TextureSystem&    oiio_texture_system,
     OSL::ShadingSystem&     shading_system,
-    const SPPMParameters&   params)
+    const SPPMParameters&   params,
+    const size_t            pass_count)
   : m_params(params)
+  , m_pass_count(pass_count)
   , m_photon_tracer(
         scene,
         light_sampler,
@@ -73,6 +75,7 @@ SPPMPassCallback::SPPMPassCallback(
         shading_system,
         params)
   , m_pass_number(0)
+  , m_next_photons_scheduled(false)
 {
     // Compute the initial lookup radius.
     const GAABB3 scene_bbox = scene.compute_bbox();
@@ -104,20 +107,44 @@ void SPPMPassCallback::pre_render(
 
     m_stopwatch.start();
 
-    // Create a new set of photons.
+    // Create a new set of photons. Unless this is the first pass, they were traced
+    // during the previous pass, and the frame renderer waited for their jobs to complete.
     m_photons.clear_keep_memory();
-    m_photon_tracer.trace_photons(
-        m_photons,
-        hash_uint32(m_pass_number),
-        job_queue,
-        abort_switch);
+    if (m_next_photons_scheduled)
+    {
+        m_photon_tracer.gather_photons(m_photons);
+        m_next_photons_scheduled = false;
+    }
+    else
+    {
+        m_photon_tracer.trace_photons(
+            m_photons,
+            hash_uint32(m_pass_number),
+            job_queue,
+            abort_switch);
+    }
 
     // Stop there if rendering was aborted.
     if (abort_switch.is_aborted())
         return;
 
     // Build a new photon map.
-    m_photon_map.reset(new SPPMPhotonMap(m_photons));
+    m_photon_map.reset(
+        new SPPMPhotonMap(
+            m_photons,
+            m_params.m_photon_map_type,
+            m_lookup_radius,
+            job_queue));
+
+    // Trace the photons of the next pass along with the tile jobs of this one.
+    if (m_pass_number + 1 < m_pass_count)
+    {
+        m_photon_tracer.schedule_photon_tracing(
+            hash_uint32(m_pass_number + 1),
+            job_queue,
+            abort_switch);
+        m_next_photons_scheduled = true;
+    }
 }
 
 void SPPMPassCallback::post_render(
@@ -74,6 +74,11 @@ namespace renderer
 //
 // This class is responsible for building a new photon map before a pass begins.
 //
+// Photons are traced one pass ahead: the photon tracing jobs of the next pass are
+// scheduled along with the tile jobs of the current pass, so that threads never wait
+// for photon tracing to complete before the eye pass can start. The photons of the
+// current pass are kept in their own vector until the next photon map is built.
+//
 
 class SPPMPassCallback
   : public IPassCallback
@@ -87,7 +92,8 @@ class SPPMPassCallback
         TextureStore&               texture_store,
         OIIO::TextureSystem&        oiio_texture_system,
         OSL::ShadingSystem&         shading_system,
-        const SPPMParameters&       params);
+        const SPPMParameters&       params,
+        const size_t                pass_count);                // number of rendering passes
 
     // Delete this instance.
     virtual void release() APPLESEED_OVERRIDE;
@@ -116,8 +122,10 @@ class SPPMPassCallback
 
   private:
     const SPPMParameters            m_params;
+    const size_t                    m_pass_count;
     SPPMPhotonTracer                m_photon_tracer;
     foundation::uint32              m_pass_number;
+    bool                            m_next_photons_scheduled;
     SPPMPhotonVector                m_photons;
     std::auto_ptr<SPPMPhotonMap>    m_photon_map;
     float                           m_initial_lookup_radius;
@@ -31,13 +31,140 @@
 #include "sppmphoton.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/scalar.h"
 #include "foundation/utility/memory.h"
 
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
 
+//
+// SPPMPackedDirection class implementation.
+//
+// Reference:
+//
+//   A Survey of Efficient Representations for Independent Unit Vectors
+//   http://jcgt.org/published/0003/02/01/paper.pdf
+//
+
+namespace
+{
+    inline float sign_not_zero(const float x)
+    {
+        return x >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    inline uint16 quantize_snorm16(const float x)
+    {
+        return round<uint16>(saturate(x * 0.5f + 0.5f) * 65535.0f);
+    }
+
+    inline float dequantize_snorm16(const uint16 x)
+    {
+        return static_cast<float>(x) * (2.0f / 65535.0f) - 1.0f;
+    }
+}
+
+void SPPMPackedDirection::set(const Vector3f& direction)
+{
+    assert(is_normalized(direction, 1.0e-4f));
+
+    const float rcp_l1_norm =
+        1.0f / (abs(direction.x) + abs(direction.y) + abs(direction.z));
+
+    float x = direction.x * rcp_l1_norm;
+    float y = direction.y * rcp_l1_norm;
+
+    // Fold the lower hemisphere over the diagonals.
+    if (direction.z < 0.0f)
+    {
+        const float fx = (1.0f - abs(y)) * sign_not_zero(x);
+        const float fy = (1.0f - abs(x)) * sign_not_zero(y);
+        x = fx;
+        y = fy;
+    }
+
+    m_x = quantize_snorm16(x);
+    m_y = quantize_snorm16(y);
+}
+
+Vector3f SPPMPackedDirection::get() const
+{
+    Vector3f v(
+        dequantize_snorm16(m_x),
+        dequantize_snorm16(m_y),
+        0.0f);
+
+    v.z = 1.0f - abs(v.x) - abs(v.y);
+
+    // Unfold the lower hemisphere.
+    if (v.z < 0.0f)
+    {
+        const float x = v.x;
+        v.x = (1.0f - abs(v.y)) * sign_not_zero(x);
+        v.y = (1.0f - abs(x)) * sign_not_zero(v.y);
+    }
+
+    return normalize(v);
+}
+
+
+//
+// SPPMPackedSpectrum class implementation.
+//
+
+void SPPMPackedSpectrum::set(const Spectrum& spectrum)
+{
+    const size_t size = spectrum.size();
+
+    m_size = static_cast<uint8>(size);
+    m_intent = static_cast<uint8>(spectrum.get_intent());
+
+    float max_value = 0.0f;
+    for (size_t i = 0; i < size; ++i)
+        max_value = max(max_value, spectrum[i]);
+
+    if (max_value < 1.0e-30f)
+    {
+        m_exponent = -128;
+        for (size_t i = 0; i < size; ++i)
+            m_mantissas[i] = 0;
+        return;
+    }
+
+    // max_value = f * 2^e with f in [0.5, 1).
+    int e;
+    frexp(max_value, &e);
+    e = clamp(e, -127, 127);
+
+    m_exponent = static_cast<int8>(e);
+
+    const float scale = ldexp(1.0f, 8 - e);
+    for (size_t i = 0; i < size; ++i)
+    {
+        const int m = round<int>(max(spectrum[i], 0.0f) * scale);
+        m_mantissas[i] = static_cast<uint8>(min(m, 255));
+    }
+}
+
+void SPPMPackedSpectrum::get(Spectrum& spectrum) const
+{
+    spectrum.resize(m_size);
+    spectrum.set_intent(static_cast<Spectrum::Intent>(m_intent));
+
+    const float scale = ldexp(1.0f, m_exponent - 8);
+    for (size_t i = 0, e = m_size; i < e; ++i)
+        spectrum[i] = static_cast<float>(m_mantissas[i]) * scale;
+}
+
+
 //
 // SPPMPhotonVector class implementation.
 //
@@ -104,8 +231,6 @@ void SPPMPhotonVector::push_back(
 
 void SPPMPhotonVector::append(const SPPMPhotonVector& rhs)
 {
-    boost::mutex::scoped_lock lock(m_mutex);
-
     m_positions.insert(m_positions.end(), rhs.m_positions.begin(), rhs.m_positions.end());
     m_mono_photons.insert(m_mono_photons.end(), rhs.m_mono_photons.begin(), rhs.m_mono_photons.end());
     m_poly_photons.insert(m_poly_photons.end(), rhs.m_poly_photons.begin(), rhs.m_poly_photons.end());
@@ -35,9 +35,6 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/vector.h"
-
-// Boost headers.
-#include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
 
 // Standard headers.
@@ -47,6 +44,50 @@
 namespace renderer
 {
 
+//
+// A unit-length direction stored in 32 bits using an octahedral mapping.
+//
+
+class SPPMPackedDirection
+{
+  public:
+    // Store a direction. The direction must be unit-length.
+    void set(const foundation::Vector3f& direction);
+
+    // Retrieve the stored direction.
+    foundation::Vector3f get() const;
+
+  private:
+    foundation::uint16      m_x;
+    foundation::uint16      m_y;
+};
+
+
+//
+// A nonnegative spectrum stored with 8 bits per component and a shared exponent.
+//
+
+class SPPMPackedSpectrum
+{
+  public:
+    // Store a spectrum. Negative components are clamped to zero.
+    void set(const Spectrum& spectrum);
+
+    // Retrieve the stored spectrum.
+    void get(Spectrum& spectrum) const;
+
+  private:
+#ifdef APPLESEED_USE_RGB_SPECTRUM
+    foundation::uint8       m_mantissas[3];
+#else
+    foundation::uint8       m_mantissas[Spectrum::Samples];
+#endif
+    foundation::int8        m_exponent;
+    foundation::uint8       m_size;
+    foundation::uint8       m_intent;
+};
+
+
 //
 // A monochromatic photon.
 //
@@ -60,8 +101,8 @@ struct SpectrumLine
 class SPPMMonoPhoton
 {
   public:
-    foundation::Vector3f    m_incoming;             // incoming direction, world space, unit length
-    foundation::Vector3f    m_geometric_normal;     // geometric normal at the photon location, world space, unit length
+    SPPMPackedDirection     m_incoming;             // incoming direction, world space, unit length
+    SPPMPackedDirection     m_geometric_normal;     // geometric normal at the photon location, world space, unit length
     SpectrumLine            m_flux;                 // flux carried by this photon (in W)
 };
 
@@ -73,15 +114,18 @@ class SPPMMonoPhoton
 class SPPMPolyPhoton
 {
   public:
-    foundation::Vector3f    m_incoming;             // incoming direction, world space, unit length
-    foundation::Vector3f    m_geometric_normal;     // geometric normal at the photon location, world space, unit length
-    Spectrum                m_flux;                 // flux carried by this photon (in W)
+    SPPMPackedDirection     m_incoming;             // incoming direction, world space, unit length
+    SPPMPackedDirection     m_geometric_normal;     // geometric normal at the photon location, world space, unit length
+    SPPMPackedSpectrum      m_flux;                 // flux carried by this photon (in W)
 };
 
 
 //
 // A vector of photons.
 //
+// Photon tracing jobs fill their own vectors, which are then appended to one another
+// in a deterministic order, so that no lock is needed while photons are stored.
+//
 
 class SPPMPhotonVector
 {
@@ -89,7 +133,6 @@ class SPPMPhotonVector
     std::vector<foundation::Vector3f>   m_positions;
     std::vector<SPPMMonoPhoton>         m_mono_photons;
     std::vector<SPPMPolyPhoton>         m_poly_photons;
-    boost::mutex                        m_mutex;
 
     bool empty() const;
     size_t size() const;
@@ -108,7 +151,7 @@ class SPPMPhotonVector
         const foundation::Vector3f&     position,
         const SPPMPolyPhoton&           photon);
 
-    // The only thread-safe method of this class.
+    // Append the photons of another vector to this one.
     void append(const SPPMPhotonVector& rhs);
 };
 
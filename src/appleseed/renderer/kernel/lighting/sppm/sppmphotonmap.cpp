@@ -1,4 +1,3 @@
-
 //
 // This source file is part of appleseed.
 // Visit http://appleseedhq.net/ for additional information and resources.
@@ -33,22 +32,115 @@
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
 #include "renderer/kernel/lighting/sppm/sppmphoton.h"
+#include "renderer/utility/renderstatistics.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/scalar.h"
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/timers.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
-#include <cstddef>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <string>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
 
-SPPMPhotonMap::SPPMPhotonMap(SPPMPhotonVector& photons)
+namespace
+{
+    // Number of photons hashed by each job when building a hash grid.
+    const size_t HashGridJobSize = 64 * 1024;
+
+    Vector3i compute_cell(
+        const Vector3f&     point,
+        const float         rcp_cell_size)
+    {
+        return
+            Vector3i(
+                truncate<int>(floor(point.x * rcp_cell_size)),
+                truncate<int>(floor(point.y * rcp_cell_size)),
+                truncate<int>(floor(point.z * rcp_cell_size)));
+    }
+
+    uint32 compute_bucket(
+        const Vector3i&     cell,
+        const uint32        bucket_mask)
+    {
+        // Teschner et al., Optimized Spatial Hashing for Collision Detection of Deformable Objects.
+        return
+            ((static_cast<uint32>(cell.x) * 73856093u) ^
+             (static_cast<uint32>(cell.y) * 19349663u) ^
+             (static_cast<uint32>(cell.z) * 83492791u)) & bucket_mask;
+    }
+
+    //
+    // A job to compute the buckets of a range of photons.
+    //
+
+    class ComputeBucketsJob
+      : public IJob
+    {
+      public:
+        ComputeBucketsJob(
+            const vector<Vector3f>& points,
+            const float             rcp_cell_size,
+            const uint32            bucket_mask,
+            vector<uint32>&         buckets,
+            const size_t            begin,
+            const size_t            end)
+          : m_points(points)
+          , m_rcp_cell_size(rcp_cell_size)
+          , m_bucket_mask(bucket_mask)
+          , m_buckets(buckets)
+          , m_begin(begin)
+          , m_end(end)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+        {
+            for (size_t i = m_begin; i < m_end; ++i)
+            {
+                m_buckets[i] =
+                    compute_bucket(
+                        compute_cell(m_points[i], m_rcp_cell_size),
+                        m_bucket_mask);
+            }
+        }
+
+      private:
+        const vector<Vector3f>&     m_points;
+        const float                 m_rcp_cell_size;
+        const uint32                m_bucket_mask;
+        vector<uint32>&             m_buckets;
+        const size_t                m_begin;
+        const size_t                m_end;
+    };
+}
+
+
+//
+// SPPMPhotonMap class implementation.
+//
+
+SPPMPhotonMap::SPPMPhotonMap(
+    SPPMPhotonVector&                   photons,
+    const SPPMParameters::PhotonMapType type,
+    const float                         lookup_radius,
+    JobQueue&                           job_queue)
+  : m_type(type)
+  , m_rcp_cell_size(0.0f)
+  , m_bucket_mask(0)
+  , m_memory_account(MemoryTagPhotons)
 {
     const size_t photon_count = photons.size();
 
@@ -59,24 +151,185 @@ SPPMPhotonMap::SPPMPhotonMap(SPPMPhotonVector& photons)
             pretty_uint(photon_count).c_str(),
             photon_count > 1 ? "photons" : "photon");
 
-        knn::Builder3f builder(*this);
-        builder.build_move_points<DefaultWallclockTimer>(photons.m_positions);
-
-        Statistics statistics;
-        statistics.insert_time("build time", builder.get_build_time());
-        statistics.insert_size("size", photons.get_memory_size());
-        statistics.merge(knn::TreeStatistics<knn::Tree3f>(*this));
-
-        RENDERER_LOG_DEBUG("%s",
-            StatisticsVector::make(
-                "sppm photon map statistics",
-                statistics).to_string().c_str());
+        if (m_type == SPPMParameters::KDTree)
+            build_kd_tree(photons);
+        else build_hash_grid(photons, lookup_radius, job_queue);
     }
     else
     {
         RENDERER_LOG_WARNING(
             "cannot build sppm photon map because no photon were stored by the photon tracing pass.");
     }
+
+    m_memory_account.set_size(
+          m_tree.get_memory_size()
+        + m_buckets.capacity() * sizeof(uint32)
+        + m_points.capacity() * sizeof(Vector3f)
+        + m_indices.capacity() * sizeof(uint32));
+}
+
+void SPPMPhotonMap::build_kd_tree(SPPMPhotonVector& photons)
+{
+    knn::Builder3f builder(m_tree);
+    builder.build_move_points<DefaultWallclockTimer>(photons.m_positions);
+
+    Statistics statistics;
+    statistics.insert_time("build time", builder.get_build_time());
+    statistics.insert_size("size", photons.get_memory_size());
+    statistics.merge(knn::TreeStatistics<knn::Tree3f>(m_tree));
+
+    const StatisticsVector stats_vector =
+        StatisticsVector::make(
+            "sppm photon map statistics",
+            statistics);
+    RENDERER_LOG_DEBUG("%s", stats_vector.to_string().c_str());
+    global_render_statistics().record(stats_vector);
+}
+
+void SPPMPhotonMap::build_hash_grid(
+    SPPMPhotonVector&   photons,
+    const float         lookup_radius,
+    JobQueue&           job_queue)
+{
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    vector<Vector3f> positions;
+    positions.swap(photons.m_positions);
+
+    const size_t photon_count = positions.size();
+    assert(photon_count <= ~uint32(0));
+
+    // Cells are twice as large as the lookup radius.
+    m_rcp_cell_size = lookup_radius > 0.0f ? 0.5f / lookup_radius : 1.0f;
+
+    // Use as many buckets as there are photons.
+    const size_t bucket_count = static_cast<size_t>(next_pow2<uint64>(photon_count));
+    m_bucket_mask = static_cast<uint32>(bucket_count - 1);
+
+    // Compute the bucket of every photon in parallel.
+    vector<uint32> photon_buckets(photon_count);
+    for (size_t begin = 0; begin < photon_count; begin += HashGridJobSize)
+    {
+        job_queue.schedule(
+            new ComputeBucketsJob(
+                positions,
+                m_rcp_cell_size,
+                m_bucket_mask,
+                photon_buckets,
+                begin,
+                min(begin + HashGridJobSize, photon_count)));
+    }
+    job_queue.wait_until_completion();
+
+    // Count the photons of each bucket.
+    m_buckets.assign(bucket_count + 1, 0);
+    for (size_t i = 0; i < photon_count; ++i)
+        ++m_buckets[photon_buckets[i] + 1];
+
+    // Compute the index of the first photon of each bucket.
+    for (size_t i = 0; i < bucket_count; ++i)
+        m_buckets[i + 1] += m_buckets[i];
+
+    // Sort photons by bucket. Photons of a bucket remain in their original order.
+    vector<uint32> cursors(m_buckets.begin(), m_buckets.end() - 1);
+    m_points.resize(photon_count);
+    m_indices.resize(photon_count);
+    for (size_t i = 0; i < photon_count; ++i)
+    {
+        const uint32 j = cursors[photon_buckets[i]]++;
+        m_points[j] = positions[i];
+        m_indices[j] = static_cast<uint32>(i);
+    }
+
+    Statistics statistics;
+    statistics.insert_time("build time", stopwatch.measure().get_seconds());
+    statistics.insert_size(
+        "size",
+        m_points.capacity() * sizeof(Vector3f) +
+        m_indices.capacity() * sizeof(uint32) +
+        m_buckets.capacity() * sizeof(uint32));
+    statistics.insert("buckets", bucket_count);
+
+    const StatisticsVector stats_vector =
+        StatisticsVector::make(
+            "sppm photon map statistics",
+            statistics);
+    RENDERER_LOG_DEBUG("%s", stats_vector.to_string().c_str());
+    global_render_statistics().record(stats_vector);
+}
+
+void SPPMPhotonMap::find_nearest(
+    const Vector3f&     point,
+    const float         max_square_dist,
+    knn::Answer<float>& answer) const
+{
+    if (m_type == SPPMParameters::KDTree)
+    {
+        const knn::Query3f query(m_tree, answer);
+        query.run(point, max_square_dist);
+        return;
+    }
+
+    answer.clear();
+
+    if (m_points.empty() || answer.max_size() == 0)
+        return;
+
+    const size_t max_answer_size = answer.max_size();
+    float query_max_square_dist = max_square_dist;
+
+    // Visit all the cells overlapping the bounding box of the lookup sphere.
+    const Vector3f extent(sqrt(max_square_dist));
+    const Vector3i min_cell = compute_cell(point - extent, m_rcp_cell_size);
+    const Vector3i max_cell = compute_cell(point + extent, m_rcp_cell_size);
+
+    for (int z = min_cell.z; z <= max_cell.z; ++z)
+    {
+        for (int y = min_cell.y; y <= max_cell.y; ++y)
+        {
+            for (int x = min_cell.x; x <= max_cell.x; ++x)
+            {
+                const Vector3i cell(x, y, z);
+                const uint32 bucket = compute_bucket(cell, m_bucket_mask);
+
+                for (uint32 i = m_buckets[bucket], e = m_buckets[bucket + 1]; i < e; ++i)
+                {
+                    const float square_dist = square_distance(m_points[i], point);
+
+                    if (answer.size() < max_answer_size)
+                    {
+                        if (square_dist > query_max_square_dist)
+                            continue;
+                    }
+                    else if (square_dist >= query_max_square_dist)
+                        continue;
+
+                    // Skip the photons of other cells that share this bucket.
+                    if (compute_cell(m_points[i], m_rcp_cell_size) != cell)
+                        continue;
+
+                    if (answer.size() < max_answer_size)
+                    {
+                        // Fill up the answer like an array, then turn it into a heap.
+                        answer.array_insert(i, square_dist);
+
+                        if (answer.size() == max_answer_size)
+                        {
+                            answer.make_heap();
+                            query_max_square_dist = answer.top().m_square_dist;
+                        }
+                    }
+                    else
+                    {
+                        // Replace the farthest photon of the answer.
+                        answer.heap_insert(i, square_dist);
+                        query_max_square_dist = answer.top().m_square_dist;
+                    }
+                }
+            }
+        }
+    }
 }
 
 }   // namespace renderer
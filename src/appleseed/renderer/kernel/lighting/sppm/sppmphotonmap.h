@@ -1,4 +1,3 @@
-
 //
 // This source file is part of appleseed.
 // Visit http://appleseedhq.net/ for additional information and resources.
@@ -30,23 +29,106 @@
 #ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_SPPM_SPPMPHOTONMAP_H
 #define APPLESEED_RENDERER_KERNEL_LIGHTING_SPPM_SPPMPHOTONMAP_H
 
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sppm/sppmparameters.h"
+
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/knn.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/memoryaccounting.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
 
 // Forward declarations.
-namespace renderer  { class SPPMPhotonVector; }
+namespace foundation    { class JobQueue; }
+namespace renderer      { class SPPMPhotonVector; }
 
 namespace renderer
 {
 
+//
+// A photon map, stored either in a kd-tree or in a uniform hash grid.
+//
+// The hash grid has cells twice as large as the lookup radius so that a lookup visits
+// at most eight cells. Cells are hashed into as many buckets as there are photons and
+// photons are sorted by bucket, which allows a linear time build.
+//
+
 class SPPMPhotonMap
-  : public foundation::knn::Tree3f
+  : public foundation::NonCopyable
 {
   public:
     // Constructor, *moves* the photon positions into the map.
-    explicit SPPMPhotonMap(SPPMPhotonVector& photons);
+    SPPMPhotonMap(
+        SPPMPhotonVector&           photons,
+        const SPPMParameters::PhotonMapType type,
+        const float                 lookup_radius,
+        foundation::JobQueue&       job_queue);
+
+    // Return true if the map contains no photon.
+    bool empty() const;
+
+    // Return the index of the photon corresponding to a point of the map.
+    size_t remap(const size_t i) const;
+
+    // Return the i'th point of the map.
+    const foundation::Vector3f& get_point(const size_t i) const;
+
+    // Find the photons closest to a given point, within a given distance. At most
+    // answer.max_size() photons are returned. Entries of the answer reference points
+    // of the map.
+    void find_nearest(
+        const foundation::Vector3f& point,
+        const float                 max_square_dist,
+        foundation::knn::Answer<float>& answer) const;
+
+  private:
+    const SPPMParameters::PhotonMapType m_type;
+
+    // Kd-tree.
+    foundation::knn::Tree3f         m_tree;
+
+    // Hash grid.
+    float                           m_rcp_cell_size;
+    foundation::uint32              m_bucket_mask;
+    std::vector<foundation::uint32> m_buckets;          // index of the first point of each bucket, plus one past the last point
+    std::vector<foundation::Vector3f> m_points;         // photon positions, sorted by bucket
+    std::vector<foundation::uint32> m_indices;          // photon index of each point
+
+    foundation::MemoryAccount       m_memory_account;
+
+    void build_kd_tree(SPPMPhotonVector& photons);
+
+    void build_hash_grid(
+        SPPMPhotonVector&           photons,
+        const float                 lookup_radius,
+        foundation::JobQueue&       job_queue);
 };
 
+
+//
+// SPPMPhotonMap class implementation.
+//
+
+inline bool SPPMPhotonMap::empty() const
+{
+    return m_type == SPPMParameters::KDTree ? m_tree.empty() : m_points.empty();
+}
+
+inline size_t SPPMPhotonMap::remap(const size_t i) const
+{
+    return m_type == SPPMParameters::KDTree ? m_tree.remap(i) : m_indices[i];
+}
+
+inline const foundation::Vector3f& SPPMPhotonMap::get_point(const size_t i) const
+{
+    return m_type == SPPMParameters::KDTree ? m_tree.get_point(i) : m_points[i];
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_SPPM_SPPMPHOTONMAP_H
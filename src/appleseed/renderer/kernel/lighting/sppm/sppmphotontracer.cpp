@@ -56,6 +56,7 @@
 #include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/renderstatistics.h"
 #include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
@@ -79,8 +80,10 @@
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <vector>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -164,8 +167,8 @@ namespace
 
                     // Create and store a new photon.
                     SPPMMonoPhoton photon;
-                    photon.m_incoming = Vector3f(vertex.m_outgoing.get_value());
-                    photon.m_geometric_normal = Vector3f(vertex.get_geometric_normal());
+                    photon.m_incoming.set(Vector3f(vertex.m_outgoing.get_value()));
+                    photon.m_geometric_normal.set(Vector3f(vertex.get_geometric_normal()));
                     photon.m_flux.m_wavelength = wavelength;
                     photon.m_flux.m_amplitude =
                         m_initial_flux[wavelength] *
@@ -179,10 +182,11 @@ namespace
 
                     // Create and store a new photon.
                     SPPMPolyPhoton photon;
-                    photon.m_incoming = Vector3f(vertex.m_outgoing.get_value());
-                    photon.m_geometric_normal = Vector3f(vertex.get_geometric_normal());
-                    photon.m_flux = m_initial_flux;
-                    photon.m_flux *= vertex.m_throughput;
+                    photon.m_incoming.set(Vector3f(vertex.m_outgoing.get_value()));
+                    photon.m_geometric_normal.set(Vector3f(vertex.get_geometric_normal()));
+                    Spectrum flux = m_initial_flux;
+                    flux *= vertex.m_throughput;
+                    photon.m_flux.set(flux);
                     m_photons.push_back(Vector3f(vertex.get_point()), photon);
                 }
             }
@@ -212,7 +216,7 @@ namespace
             OIIO::TextureSystem&    oiio_texture_system,
             OSL::ShadingSystem&     shading_system,
             const SPPMParameters&   params,
-            SPPMPhotonVector&       global_photons,
+            SPPMPhotonVector&       job_photons,
             const size_t            photon_begin,
             const size_t            photon_end,
             const size_t            pass_hash,
@@ -233,7 +237,7 @@ namespace
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations,
                 false)
-          , m_global_photons(global_photons)
+          , m_job_photons(job_photons)
           , m_photon_begin(photon_begin)
           , m_photon_end(photon_end)
           , m_pass_hash(pass_hash)
@@ -255,22 +259,30 @@ namespace
                 m_arena,
                 thread_index);
 
-            const uint32 instance = hash_uint32(static_cast<uint32>(m_pass_hash + m_photon_begin));
-            SamplingContext::RNGType rng(instance);
+            // Each photon draws from its own random stream and QMC instance, derived from
+            // the pass and the photon index only, so that photon maps don't depend on the
+            // photon packet size or on the number of rendering threads.
+            const uint64 stream_seed = hash_uint64(static_cast<uint64>(m_pass_hash));
+            const uint32 base_instance = hash_uint32(static_cast<uint32>(m_pass_hash));
+            SamplingContext::RNGType rng;
             SamplingContext sampling_context(
                 rng,
                 m_params.m_sampling_mode,
                 4,                          // number of dimensions
                 0,                          // number of samples -- unknown
-                instance);                  // initial instance number
+                base_instance);             // initial instance number
 
             for (size_t i = m_photon_begin; i < m_photon_end && !m_abort_switch.is_aborted(); ++i)
             {
+                rng = SamplingContext::RNGType(stream_seed, static_cast<uint64>(i));
+                sampling_context.set_instance(base_instance + i);
+
                 m_arena.clear();
                 trace_light_photon(shading_context, sampling_context);
             }
 
-            m_global_photons.append(m_local_photons);
+            // Hand the photons over to the photon tracer without locking.
+            m_job_photons.swap(m_local_photons);
         }
 
       private:
@@ -284,7 +296,7 @@ namespace
         OSLShaderGroupExec          m_shadergroup_exec;
         const SPPMParameters        m_params;
         Tracer                      m_tracer;
-        SPPMPhotonVector&           m_global_photons;
+        SPPMPhotonVector&           m_job_photons;
         const size_t                m_photon_begin;
         const size_t                m_photon_end;
         const size_t                m_pass_hash;
@@ -493,7 +505,7 @@ namespace
             OIIO::TextureSystem&    oiio_texture_system,
             OSL::ShadingSystem&     shading_system,
             const SPPMParameters&   params,
-            SPPMPhotonVector&       global_photons,
+            SPPMPhotonVector&       job_photons,
             const size_t            photon_begin,
             const size_t            photon_end,
             const size_t            pass_hash,
@@ -515,7 +527,7 @@ namespace
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations,
                 false)
-          , m_global_photons(global_photons)
+          , m_job_photons(job_photons)
           , m_photon_begin(photon_begin)
           , m_photon_end(photon_end)
           , m_pass_hash(pass_hash)
@@ -542,22 +554,30 @@ namespace
                 m_arena,
                 thread_index);
 
-            const uint32 instance = hash_uint32(static_cast<uint32>(m_pass_hash + m_photon_begin));
-            SamplingContext::RNGType rng(instance);
+            // Each photon draws from its own random stream and QMC instance, derived from
+            // the pass and the photon index only, so that photon maps don't depend on the
+            // photon packet size or on the number of rendering threads.
+            const uint64 stream_seed = hash_uint64(static_cast<uint64>(m_pass_hash));
+            const uint32 base_instance = hash_uint32(static_cast<uint32>(m_pass_hash));
+            SamplingContext::RNGType rng;
             SamplingContext sampling_context(
                 rng,
                 m_params.m_sampling_mode,
                 2,                          // number of dimensions
                 0,                          // number of samples -- unknown
-                instance);                  // initial instance number
+                base_instance);             // initial instance number
 
             for (size_t i = m_photon_begin; i < m_photon_end && !m_abort_switch.is_aborted(); ++i)
             {
+                rng = SamplingContext::RNGType(stream_seed, static_cast<uint64>(i));
+                sampling_context.set_instance(base_instance + i);
+
                 m_arena.clear();
                 trace_env_photon(shading_context, sampling_context);
             }
 
-            m_global_photons.append(m_local_photons);
+            // Hand the photons over to the photon tracer without locking.
+            m_job_photons.swap(m_local_photons);
         }
 
       private:
@@ -572,7 +592,7 @@ namespace
         OSLShaderGroupExec          m_shadergroup_exec;
         const SPPMParameters        m_params;
         Tracer                      m_tracer;
-        SPPMPhotonVector&           m_global_photons;
+        SPPMPhotonVector&           m_job_photons;
         const size_t                m_photon_begin;
         const size_t                m_photon_end;
         const size_t                m_pass_hash;
@@ -696,6 +716,8 @@ SPPMPhotonTracer::SPPMPhotonTracer(
   , m_total_stored_photon_count(0)
   , m_oiio_texture_system(oiio_texture_system)
   , m_shading_system(shading_system)
+  , m_job_count(0)
+  , m_emitted_photon_count(0)
 {
 }
 
@@ -763,69 +785,109 @@ void SPPMPhotonTracer::trace_photons(
     JobQueue&               job_queue,
     IAbortSwitch&           abort_switch)
 {
+    schedule_photon_tracing(pass_hash, job_queue, abort_switch);
+
+    // Wait until the photon tracing jobs have completed.
+    job_queue.wait_until_completion();
+
+    gather_photons(photons);
+}
+
+void SPPMPhotonTracer::schedule_photon_tracing(
+    const size_t            pass_hash,
+    JobQueue&               job_queue,
+    IAbortSwitch&           abort_switch)
+{
+    assert(m_job_photons.empty());
+
     // Start stopwatch.
-    Stopwatch<DefaultWallclockTimer> stopwatch;
-    stopwatch.start();
+    m_stopwatch.start();
 
     // Collect photon targets.
-    LightTargetArray photon_targets;
+    m_photon_targets = LightTargetArray();
     collect_photon_targets(
         m_scene.assembly_instances(),
         Transformd::identity(),
-        photon_targets);
+        m_photon_targets);
+
+    // Allocate one photon vector per photon tracing job.
+    const bool trace_light_photons = m_light_sampler.has_lights_or_emitting_triangles();
+    const bool trace_env_photons = m_params.m_enable_ibl && m_scene.get_environment()->get_environment_edf();
+    const size_t light_job_count = trace_light_photons ? get_job_count(m_params.m_light_photon_count) : 0;
+    const size_t env_job_count = trace_env_photons ? get_job_count(m_params.m_env_photon_count) : 0;
+    m_job_photons.resize(light_job_count + env_job_count);
 
     // Schedule photon tracing jobs.
-    size_t job_count = 0;
-    size_t emitted_photon_count = 0;
-    if (m_light_sampler.has_lights_or_emitting_triangles())
+    m_job_count = 0;
+    m_emitted_photon_count = 0;
+    if (light_job_count > 0)
     {
         schedule_light_photon_tracing_jobs(
-            photon_targets,
-            photons,
+            m_photon_targets,
+            &m_job_photons[0],
             pass_hash,
             job_queue,
-            job_count,
-            emitted_photon_count,
+            m_job_count,
+            m_emitted_photon_count,
             abort_switch);
     }
-    if (m_params.m_enable_ibl && m_scene.get_environment()->get_environment_edf())
+    if (env_job_count > 0)
     {
         schedule_environment_photon_tracing_jobs(
-            photon_targets,
-            photons,
+            m_photon_targets,
+            &m_job_photons[light_job_count],
             pass_hash,
             job_queue,
-            job_count,
-            emitted_photon_count,
+            m_job_count,
+            m_emitted_photon_count,
             abort_switch);
     }
+}
 
-    // Wait until the photon tracing jobs have completed.
-    job_queue.wait_until_completion();
+void SPPMPhotonTracer::gather_photons(SPPMPhotonVector& photons)
+{
+    // Gather the photons of all jobs, in job order so that the photon map doesn't
+    // depend on the order in which jobs completed.
+    size_t stored_photon_count = photons.size();
+    for (size_t i = 0; i < m_job_photons.size(); ++i)
+        stored_photon_count += m_job_photons[i].size();
+    if (m_params.m_photon_type == SPPMParameters::Monochromatic)
+        photons.reserve_mono_photons(stored_photon_count);
+    else photons.reserve_poly_photons(stored_photon_count);
+    for (size_t i = 0; i < m_job_photons.size(); ++i)
+        photons.append(m_job_photons[i]);
+    m_job_photons.clear();
 
     // Update photon tracing statistics.
-    m_total_emitted_photon_count += emitted_photon_count;
+    m_total_emitted_photon_count += m_emitted_photon_count;
     m_total_stored_photon_count += photons.size();
 
     // Print photon tracing statistics.
     Statistics statistics;
-    statistics.insert("tracing jobs", job_count);
-    statistics.insert_time("tracing time", stopwatch.measure().get_seconds());
+    statistics.insert("tracing jobs", m_job_count);
+    statistics.insert_time("tracing time", m_stopwatch.measure().get_seconds());
     statistics.insert("total emitted", m_total_emitted_photon_count);
     statistics.insert(
         "total stored",
         pretty_uint(m_total_stored_photon_count) + " (" +
         pretty_percent(m_total_stored_photon_count, m_total_emitted_photon_count) +
         ")");
-    RENDERER_LOG_DEBUG("%s",
+    const StatisticsVector stats_vector =
         StatisticsVector::make(
             "sppm photon tracing statistics",
-            statistics).to_string().c_str());
+            statistics);
+    RENDERER_LOG_DEBUG("%s", stats_vector.to_string().c_str());
+    global_render_statistics().record(stats_vector);
+}
+
+size_t SPPMPhotonTracer::get_job_count(const size_t photon_count) const
+{
+    return (photon_count + m_params.m_photon_packet_size - 1) / m_params.m_photon_packet_size;
 }
 
 void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
     const LightTargetArray& photon_targets,
-    SPPMPhotonVector&       photons,
+    SPPMPhotonVector*       job_photons,
     const size_t            pass_hash,
     JobQueue&               job_queue,
     size_t&                 job_count,
@@ -852,7 +914,7 @@ void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
                 m_oiio_texture_system,
                 m_shading_system,
                 m_params,
-                photons,
+                job_photons[i / m_params.m_photon_packet_size],
                 photon_begin,
                 photon_end,
                 pass_hash,
@@ -865,7 +927,7 @@ void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
 
 void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
     const LightTargetArray& photon_targets,
-    SPPMPhotonVector&       photons,
+    SPPMPhotonVector*       job_photons,
     const size_t            pass_hash,
     JobQueue&               job_queue,
     size_t&                 job_count,
@@ -892,7 +954,7 @@ void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
                 m_oiio_texture_system,
                 m_shading_system,
                 m_params,
-                photons,
+                job_photons[i / m_params.m_photon_packet_size],
                 photon_begin,
                 photon_end,
                 pass_hash,
@@ -32,9 +32,13 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/lighting/sppm/sppmparameters.h"
+#include "renderer/kernel/lighting/sppm/sppmphoton.h"
+#include "renderer/modeling/light/lighttarget.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/timers.h"
+#include "foundation/utility/stopwatch.h"
 
 // OSL headers.
 #include "foundation/platform/oslheaderguards.h"
@@ -50,14 +54,13 @@ END_OIIO_INCLUDES
 
 // Standard headers.
 #include <cstddef>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class JobQueue; }
 namespace renderer      { class LightSampler; }
-namespace renderer      { class LightTargetArray; }
 namespace renderer      { class Scene; }
-namespace renderer      { class SPPMPhotonVector; }
 namespace renderer      { class TextureStore; }
 namespace renderer      { class TraceContext; }
 
@@ -77,12 +80,25 @@ class SPPMPhotonTracer
         OSL::ShadingSystem&         shading_system,
         const SPPMParameters&       params);
 
+    // Trace photons and append them to a given photon vector.
     void trace_photons(
         SPPMPhotonVector&           photons,
         const size_t                pass_hash,
         foundation::JobQueue&       job_queue,
         foundation::IAbortSwitch&   abort_switch);
 
+    // Schedule photon tracing jobs and return without waiting for them, so that they
+    // can run alongside other jobs. Once they have completed, gather_photons() must be
+    // called before photons are scheduled again.
+    void schedule_photon_tracing(
+        const size_t                pass_hash,
+        foundation::JobQueue&       job_queue,
+        foundation::IAbortSwitch&   abort_switch);
+
+    // Append the photons traced by the completed jobs of schedule_photon_tracing()
+    // to a given photon vector, in an order that doesn't depend on job scheduling.
+    void gather_photons(SPPMPhotonVector& photons);
+
   private:
     const SPPMParameters            m_params;
     const Scene&                    m_scene;
@@ -94,9 +110,21 @@ class SPPMPhotonTracer
     OIIO::TextureSystem&            m_oiio_texture_system;
     OSL::ShadingSystem&             m_shading_system;
 
+    // State of the photon tracing jobs in flight.
+    LightTargetArray                m_photon_targets;
+    std::vector<SPPMPhotonVector>   m_job_photons;              // photons of each job
+    size_t                          m_job_count;
+    size_t                          m_emitted_photon_count;
+    foundation::Stopwatch<foundation::DefaultWallclockTimer>
+                                    m_stopwatch;
+
+    // Return the number of jobs needed to trace a given number of photons.
+    size_t get_job_count(const size_t photon_count) const;
+
+    // Schedule photon tracing jobs; the i'th job stores its photons into job_photons[i].
     void schedule_light_photon_tracing_jobs(
         const LightTargetArray&     photon_targets,
-        SPPMPhotonVector&           photons,
+        SPPMPhotonVector*           job_photons,
         const size_t                pass_hash,
         foundation::JobQueue&       job_queue,
         size_t&                     job_count,
@@ -105,7 +133,7 @@ class SPPMPhotonTracer
 
     void schedule_environment_photon_tracing_jobs(
         const LightTargetArray&     photon_targets,
-        SPPMPhotonVector&           photons,
+        SPPMPhotonVector*           job_photons,
         const size_t                pass_hash,
         foundation::JobQueue&       job_queue,
         size_t&                     job_count,
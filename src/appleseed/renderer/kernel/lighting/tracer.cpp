@@ -33,23 +33,55 @@
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
 #include "renderer/kernel/shading/oslshadergroupexec.h"
+#include "renderer/kernel/volume/fluidvolume.h"
 #include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/input/source.h"
 #include "renderer/modeling/material/material.h"
+#include "renderer/modeling/object/object.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/rng/distribution.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <string>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
 
+namespace
+{
+    // Return the fluid volume of a material if its surface is a boundary of the volume
+    // that does not scatter light, or 0 otherwise.
+    const FluidVolume* get_volume_boundary(const Material& material)
+    {
+        const Material::RenderData& render_data = material.get_render_data();
+        return render_data.m_bsdf == 0 ? render_data.m_volume : 0;
+    }
+
+    // Uniform random numbers in [0,1] for tracking through fluid volumes.
+    struct XorshiftSampler
+    {
+        Xorshift& m_rng;
+
+        explicit XorshiftSampler(Xorshift& rng)
+          : m_rng(rng)
+        {
+        }
+
+        float operator()()
+        {
+            return rand_float1(m_rng);
+        }
+    };
+}
+
 Tracer::Tracer(
     const Scene&                scene,
     const Intersector&          intersector,
@@ -73,6 +105,51 @@ Tracer::Tracer(
     }
 }
 
+void Tracer::trace_between_batch(
+    const ShadingPoint&         origin,
+    const size_t                target_count,
+    const Vector3d*             targets,
+    const VisibilityFlags::Type ray_flags,
+    float*                      transmissions)
+{
+    if (!m_assume_no_alpha_mapping)
+    {
+        for (size_t i = 0; i < target_count; ++i)
+            transmissions[i] = trace_between(origin, targets[i], ray_flags);
+        return;
+    }
+
+    ShadingRay rays[AssemblyTreePacketSize];
+    bool hits[AssemblyTreePacketSize];
+
+    for (size_t first = 0; first < target_count; first += AssemblyTreePacketSize)
+    {
+        const size_t batch_size = min(target_count - first, AssemblyTreePacketSize);
+
+        // Build the rays exactly as the single-ray variant of trace_between() does.
+        for (size_t i = 0; i < batch_size; ++i)
+        {
+            const Vector3d direction = targets[first + i] - origin.get_point();
+            const double dist = norm(direction);
+
+            rays[i] =
+                ShadingRay(
+                    origin.get_biased_point(direction),
+                    direction / dist,
+                    0.0,                        // ray tmin
+                    dist * (1.0 - 1.0e-6),      // ray tmax
+                    origin.get_time(),
+                    ray_flags,
+                    origin.get_ray().m_depth + 1);
+        }
+
+        m_intersector.trace_probe_batch(batch_size, rays, hits, &origin);
+
+        for (size_t i = 0; i < batch_size; ++i)
+            transmissions[first + i] = hits[i] ? 0.0f : 1.0f;
+    }
+}
+
 const ShadingPoint& Tracer::do_trace(
     const Vector3d&             origin,
     const Vector3d&             direction,
@@ -130,6 +207,26 @@ const ShadingPoint& Tracer::do_trace(
         if (material == 0)
             break;
 
+        // Move past the boundaries of fluid volumes, accounting for the segments inside them.
+        if (const FluidVolume* volume = get_volume_boundary(*material))
+        {
+            if (!shading_point_ptr->is_entering())
+            {
+                transmission *=
+                    evaluate_transmittance(
+                        *volume,
+                        point,
+                        direction,
+                        shading_point_ptr->get_distance());
+
+                if (transmission < m_transmission_threshold)
+                    break;
+            }
+
+            point = shading_point_ptr->get_point();
+            continue;
+        }
+
         Alpha alpha;
         evaluate_alpha(*material, *shading_point_ptr, alpha);
 
@@ -165,6 +262,7 @@ const ShadingPoint& Tracer::do_trace_between(
     const ShadingPoint* shading_point_ptr = parent_shading_point;
     size_t shading_point_index = 0;
     Vector3d point = origin;
+    const FluidVolume* current_volume = 0;
     size_t iterations = 0;
 
     while (true)
@@ -204,13 +302,41 @@ const ShadingPoint& Tracer::do_trace_between(
 
         // Stop if the ray reached the target point.
         if (!shading_point_ptr->hit())
+        {
+            // Account for the last segment if the target point is inside a fluid volume.
+            if (current_volume)
+                transmission *= evaluate_transmittance(*current_volume, point, ray.m_dir, dist);
             break;
+        }
 
         // Retrieve the material at the shading point.
         const Material* material = shading_point_ptr->get_material();
         if (material == 0)
             break;
 
+        // Move past the boundaries of fluid volumes, accounting for the segments inside them.
+        if (const FluidVolume* volume = get_volume_boundary(*material))
+        {
+            if (shading_point_ptr->is_entering())
+                current_volume = volume;
+            else
+            {
+                transmission *=
+                    evaluate_transmittance(
+                        *volume,
+                        point,
+                        ray.m_dir,
+                        shading_point_ptr->get_distance());
+                current_volume = 0;
+
+                if (transmission < m_transmission_threshold)
+                    break;
+            }
+
+            point = shading_point_ptr->get_point();
+            continue;
+        }
+
         // Evaluate the alpha map at the shading point.
         Alpha alpha;
         evaluate_alpha(*material, *shading_point_ptr, alpha);
@@ -233,22 +359,38 @@ const ShadingPoint& Tracer::do_trace_between(
     return *shading_point_ptr;
 }
 
+float Tracer::evaluate_transmittance(
+    const FluidVolume&          volume,
+    const Vector3d&             origin,
+    const Vector3d&             direction,
+    const double                distance)
+{
+    XorshiftSampler rng(m_rng);
+    return volume.evaluate_transmittance(origin, direction, distance, rng);
+}
+
 void Tracer::evaluate_alpha(
     const Material&             material,
     const ShadingPoint&         shading_point,
     Alpha&                      alpha) const
 {
+    const Material::RenderData& material_data = material.get_render_data();
+
+    // Skip the evaluation of alpha maps altogether on fully opaque surfaces.
+    if (material_data.is_opaque() && shading_point.get_object().get_alpha_map() == 0)
+    {
+        alpha.set(1.0f);
+        return;
+    }
+
     alpha = shading_point.get_alpha();
 
     // Apply OSL transparency if needed.
-    if (const ShaderGroup* sg = material.get_render_data().m_shader_group)
+    if (material_data.m_osl_transparency)
     {
-        if (sg->has_transparency())
-        {
-            Alpha a;
-            m_shadergroup_exec.execute_shadow(*sg, shading_point, a);
-            alpha *= a;
-        }
+        Alpha a;
+        m_shadergroup_exec.execute_shadow(*material_data.m_shader_group, shading_point, a);
+        alpha *= a;
     }
 }
 
@@ -39,12 +39,14 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/rng/xorshift.h"
 #include "foundation/math/vector.h"
 
 // Standard headers.
 #include <cstddef>
 
 // Forward declarations.
+namespace renderer  { class FluidVolume; }
 namespace renderer  { class Material;}
 namespace renderer  { class OSLShaderGroupExec; }
 namespace renderer  { class Scene; }
@@ -57,7 +59,7 @@ namespace renderer
 // The Tracer class wraps the Intersector class and allows to compute
 // visibility from a given point along a given direction, as well as
 // point-to-point visibility. It automatically takes into account alpha
-// transparency.
+// transparency and the transmittance of fluid volumes.
 //
 
 class Tracer
@@ -136,6 +138,15 @@ class Tracer
         const foundation::Vector3d&     target,
         const VisibilityFlags::Type     ray_flags);
 
+    // Same as above, for a batch of targets. When the scene does not use alpha
+    // mapping, the rays are traced together as a batch of probe rays.
+    void trace_between_batch(
+        const ShadingPoint&             origin,
+        const size_t                    target_count,
+        const foundation::Vector3d*     targets,
+        const VisibilityFlags::Type     ray_flags,
+        float*                          transmissions);
+
   private:
     const Intersector&                  m_intersector;
     TextureCache&                       m_texture_cache;
@@ -144,6 +155,7 @@ class Tracer
     const float                         m_transmission_threshold;
     const size_t                        m_max_iterations;
     ShadingPoint                        m_shading_points[2];
+    foundation::Xorshift                m_rng;
 
     const ShadingPoint& do_trace(
         const foundation::Vector3d&     origin,
@@ -167,6 +179,13 @@ class Tracer
         const Material&                 material,
         const ShadingPoint&             shading_point,
         Alpha&                          alpha) const;
+
+    // Compute the transmittance along a segment of a ray inside a fluid volume.
+    float evaluate_transmittance(
+        const FluidVolume&              volume,
+        const foundation::Vector3d&     origin,
+        const foundation::Vector3d&     direction,
+        const double                    distance);
 };
 
 
@@ -31,16 +31,38 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/rendering/memorybudget.h"
 #include "renderer/kernel/rendering/oiioerrorhandler.h"
 #include "renderer/kernel/rendering/rendererservices.h"
 #include "renderer/kernel/shading/closures.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/bsdf/bsdf.h"
+#include "renderer/modeling/bssrdf/bssrdf.h"
+#include "renderer/modeling/edf/edf.h"
+#include "renderer/modeling/environment/environment.h"
+#include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/environmentshader/environmentshader.h"
+#include "renderer/modeling/input/inputarray.h"
+#include "renderer/modeling/light/light.h"
+#include "renderer/modeling/material/material.h"
 #include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
 #include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/modeling/surfaceshader/surfaceshader.h"
+#include "renderer/utility/settingsparsing.h"
 
 // appleseed.foundation headers.
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/timers.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
+#include <memory>
 #include <string>
 
 using namespace foundation;
@@ -49,6 +71,71 @@ using namespace std;
 namespace renderer
 {
 
+namespace
+{
+    //
+    // Collect the shader groups bound to the inputs of the scene entities.
+    // Input binding must have taken place.
+    //
+
+    void collect_bound_shader_groups(
+        const ConnectableEntity&    entity,
+        BaseGroup::ShaderGroupSet&  shader_groups)
+    {
+        const InputArray& inputs = entity.get_inputs();
+
+        for (const_each<InputArray> i = inputs; i; ++i)
+        {
+            if (i->format() != InputFormatEntity)
+                continue;
+
+            const ShaderGroup* shader_group = dynamic_cast<const ShaderGroup*>(i->get_entity());
+
+            if (shader_group)
+                shader_groups.insert(shader_group);
+        }
+    }
+
+    template <typename EntityCollection>
+    void collect_used_shader_groups(
+        const EntityCollection&     entities,
+        BaseGroup::ShaderGroupSet&  shader_groups)
+    {
+        for (const_each<EntityCollection> i = entities; i; ++i)
+            collect_bound_shader_groups(*i, shader_groups);
+    }
+
+    void collect_used_shader_groups(
+        const Assembly&             assembly,
+        BaseGroup::ShaderGroupSet&  shader_groups)
+    {
+        collect_used_shader_groups(assembly.bsdfs(), shader_groups);
+        collect_used_shader_groups(assembly.bssrdfs(), shader_groups);
+        collect_used_shader_groups(assembly.edfs(), shader_groups);
+        collect_used_shader_groups(assembly.surface_shaders(), shader_groups);
+        collect_used_shader_groups(assembly.materials(), shader_groups);
+        collect_used_shader_groups(assembly.lights(), shader_groups);
+
+        for (const_each<AssemblyContainer> i = assembly.assemblies(); i; ++i)
+            collect_used_shader_groups(*i, shader_groups);
+    }
+
+    void collect_used_shader_groups(
+        const Scene&                scene,
+        BaseGroup::ShaderGroupSet&  shader_groups)
+    {
+        if (const Environment* environment = scene.get_environment())
+            collect_bound_shader_groups(*environment, shader_groups);
+
+        collect_used_shader_groups(scene.environment_edfs(), shader_groups);
+        collect_used_shader_groups(scene.environment_shaders(), shader_groups);
+
+        for (const_each<AssemblyContainer> i = scene.assemblies(); i; ++i)
+            collect_used_shader_groups(*i, shader_groups);
+    }
+}
+
+
 //
 // BaseRenderer class implementation.
 //
@@ -137,18 +224,79 @@ const ParamArray& BaseRenderer::get_parameters() const
 
 bool BaseRenderer::initialize_shading_system(
     TextureStore& texture_store,
-    IAbortSwitch& abort_switch)
+    IAbortSwitch& abort_switch,
+    MemoryBudget* memory_budget)
 {
-    initialize_oiio();
+    initialize_oiio(texture_store, memory_budget);
     return initialize_osl(texture_store, abort_switch);
 }
 
-void BaseRenderer::initialize_oiio()
+namespace
+{
+    size_t get_oiio_cache_memory_size(OIIO::TextureSystem& texture_system)
+    {
+        long long memory_size = 0;
+        texture_system.getattribute("stat:cache_memory_used", OIIO::TypeDesc::INT64, &memory_size);
+        return static_cast<size_t>(memory_size);
+    }
+
+    //
+    // Exposes the memory usage of an OIIO texture system to the texture store.
+    //
+
+    class OIIOTextureSystemCache
+      : public TextureStore::IExternalCache
+    {
+      public:
+        explicit OIIOTextureSystemCache(OIIO::TextureSystem& texture_system)
+          : m_texture_system(texture_system)
+        {
+        }
+
+        virtual size_t get_memory_size() const APPLESEED_OVERRIDE
+        {
+            return get_oiio_cache_memory_size(m_texture_system);
+        }
+
+      private:
+        OIIO::TextureSystem& m_texture_system;
+    };
+
+    //
+    // Exposes the memory usage of an OIIO texture system to the memory budget.
+    //
+
+    class OIIOTextureSystemPool
+      : public MemoryBudget::IPool
+    {
+      public:
+        explicit OIIOTextureSystemPool(OIIO::TextureSystem& texture_system)
+          : m_texture_system(texture_system)
+        {
+        }
+
+        virtual size_t get_memory_size() const APPLESEED_OVERRIDE
+        {
+            return get_oiio_cache_memory_size(m_texture_system);
+        }
+
+      private:
+        OIIO::TextureSystem& m_texture_system;
+    };
+}
+
+void BaseRenderer::initialize_oiio(
+    TextureStore&   texture_store,
+    MemoryBudget*   memory_budget)
 {
     const ParamArray& params = m_params.child("texture_store");
 
+    // With a memory budget, the OIIO texture cache may grow up to the whole budget;
+    // the texture store evicts its own tiles to make room for it.
     const size_t texture_cache_size_bytes =
-        params.get_optional<size_t>("max_size", 256 * 1024 * 1024);
+        memory_budget
+            ? memory_budget->get_max_memory_size()
+            : params.get_optional<size_t>("max_size", 256 * 1024 * 1024);
     RENDERER_LOG_INFO(
         "setting oiio texture cache size to %s.",
         pretty_size(texture_cache_size_bytes).c_str());
@@ -156,6 +304,22 @@ void BaseRenderer::initialize_oiio()
         static_cast<float>(texture_cache_size_bytes) / (1024 * 1024);
     m_texture_system->attribute("max_memory_MB", texture_cache_size_mb);
 
+    // Account for the OIIO texture cache in the memory budget, or optionally
+    // let it share the memory budget of the texture store.
+    if (memory_budget)
+    {
+        memory_budget->register_pool(
+            "oiio texture cache",
+            MemoryBudget::EvictablePool,
+            auto_ptr<MemoryBudget::IPool>(new OIIOTextureSystemPool(*m_texture_system)));
+    }
+    else if (params.get_optional<bool>("share_budget_with_oiio", false))
+    {
+        RENDERER_LOG_INFO("sharing texture cache budget between oiio and the texture store.");
+        texture_store.set_external_cache(
+            auto_ptr<TextureStore::IExternalCache>(new OIIOTextureSystemCache(*m_texture_system)));
+    }
+
     string prev_search_path;
     m_texture_system->getattribute("searchpath", prev_search_path);
 
@@ -183,11 +347,47 @@ bool BaseRenderer::initialize_osl(TextureStore& texture_store, IAbortSwitch& abo
         m_shading_system->attribute("searchpath:shader", new_search_path);
     }
 
+    // Only set up the shader groups that are actually bound to an entity,
+    // so that the compiled shaders of unused groups are never loaded.
+    const Scene& scene = *m_project.get_scene();
+    BaseGroup::ShaderGroupSet used_shader_groups;
+    collect_used_shader_groups(scene, used_shader_groups);
+
     // Re-optimize the shader groups that need updating.
-    return
-        m_project.get_scene()->create_optimized_osl_shader_groups(
+    if (!m_project.get_scene()->create_optimized_osl_shader_groups(
             *m_shading_system,
-            &abort_switch);
+            &abort_switch,
+            &used_shader_groups))
+        return false;
+
+#if OSL_LIBRARY_VERSION_CODE >= 10700
+    // OSL otherwise optimizes and compiles each shader group the first time it is executed,
+    // while other rendering threads that need the same shader group wait for it.
+    // Shader groups that are already optimized are skipped.
+    if (m_params.get_optional<bool>("optimize_shader_groups_upfront", false) &&
+        !abort_switch.is_aborted())
+    {
+        const size_t thread_count = get_rendering_thread_count(m_params);
+
+        RENDERER_LOG_INFO(
+            "optimizing osl shader groups using %s %s...",
+            pretty_uint(thread_count).c_str(),
+            plural(thread_count, "thread").c_str());
+
+        Stopwatch<DefaultWallclockTimer> stopwatch;
+        stopwatch.start();
+
+        m_shading_system->optimize_all_groups(static_cast<int>(thread_count));
+
+        stopwatch.measure();
+
+        RENDERER_LOG_INFO(
+            "optimized osl shader groups in %s.",
+            pretty_time(stopwatch.get_seconds()).c_str());
+    }
+#endif
+
+    return true;
 }
 
 }   // namespace renderer
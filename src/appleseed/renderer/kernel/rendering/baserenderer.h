@@ -52,6 +52,7 @@ END_OSL_INCLUDES
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class MemoryBudget; }
 namespace renderer      { class OIIOErrorHandler; }
 namespace renderer      { class Project; }
 namespace renderer      { class RendererServices; }
@@ -75,9 +76,12 @@ class APPLESEED_DLLSYMBOL BaseRenderer
     ParamArray& get_parameters();
     const ParamArray& get_parameters() const;
 
+    // Initialize OIIO and OSL. If a memory budget is provided, the OIIO texture cache
+    // is registered with it and limited to the size of the budget.
     bool initialize_shading_system(
         TextureStore&               texture_store,
-        foundation::IAbortSwitch&   abort_switch);
+        foundation::IAbortSwitch&   abort_switch,
+        MemoryBudget*               memory_budget = 0);
 
   protected:
     Project&                        m_project;
@@ -94,7 +98,9 @@ class APPLESEED_DLLSYMBOL BaseRenderer
         const ParamArray&           params);
 
   private:
-    void initialize_oiio();
+    void initialize_oiio(
+        TextureStore&               texture_store,
+        MemoryBudget*               memory_budget);
 
     bool initialize_osl(
         TextureStore&               texture_store,
@@ -0,0 +1,203 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "convergencemap.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// ConvergenceMap class implementation.
+//
+
+namespace
+{
+    // Size of a block in pixels, in each dimension.
+    const size_t BlockSize = 16;
+
+    // Number of samples stored into a block between two evaluations of its convergence.
+    const uint32 EvaluationInterval = 64;
+
+    // Average luminance below which errors are considered absolute rather than relative.
+    const double MinLuminance = 0.01;
+
+    // Sample luminances are clamped to limit the influence of fireflies on error estimates.
+    const float MaxSampleLuminance = 1000.0f;
+}
+
+struct ConvergenceMap::Block
+{
+    Spinlock                m_lock;
+    uint32                  m_sample_count;
+    double                  m_sum;
+    double                  m_sum_sq;
+    boost::atomic<bool>     m_converged;
+};
+
+ConvergenceMap::ConvergenceMap(
+    const size_t            canvas_width,
+    const size_t            canvas_height,
+    const AABB2u&           crop_window,
+    const float             noise_threshold,
+    const size_t            min_samples_per_pixel)
+  : m_canvas_width(canvas_width)
+  , m_canvas_height(canvas_height)
+  , m_crop_window(crop_window)
+  , m_noise_threshold(noise_threshold)
+  , m_min_samples_per_pixel(min_samples_per_pixel)
+{
+    assert(crop_window.is_valid());
+    assert(crop_window.max.x < canvas_width);
+    assert(crop_window.max.y < canvas_height);
+
+    m_block_count_x = (crop_window.extent()[0] + BlockSize) / BlockSize;
+    m_block_count_y = (crop_window.extent()[1] + BlockSize) / BlockSize;
+    m_blocks = new Block[m_block_count_x * m_block_count_y];
+
+    clear();
+}
+
+ConvergenceMap::~ConvergenceMap()
+{
+    delete[] m_blocks;
+}
+
+void ConvergenceMap::clear()
+{
+    for (size_t i = 0, e = m_block_count_x * m_block_count_y; i < e; ++i)
+    {
+        Block& block = m_blocks[i];
+        block.m_sample_count = 0;
+        block.m_sum = 0.0;
+        block.m_sum_sq = 0.0;
+        block.m_converged = false;
+    }
+
+    m_converged_block_count = 0;
+}
+
+void ConvergenceMap::store_samples(
+    const size_t            sample_count,
+    const Sample            samples[])
+{
+    const float fw = static_cast<float>(m_canvas_width);
+    const float fh = static_cast<float>(m_canvas_height);
+
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        const Sample& sample = samples[i];
+
+        // Find the pixel and the block this sample belongs to.
+        const size_t x = truncate<size_t>(sample.m_position.x * fw);
+        const size_t y = truncate<size_t>(sample.m_position.y * fh);
+        if (!m_crop_window.contains(Vector2u(x, y)))
+            continue;
+        const size_t bx = (x - m_crop_window.min.x) / BlockSize;
+        const size_t by = (y - m_crop_window.min.y) / BlockSize;
+        Block& block = m_blocks[by * m_block_count_x + bx];
+
+        if (block.m_converged)
+            continue;
+
+        const Color3f rgb(sample.m_values[0], sample.m_values[1], sample.m_values[2]);
+        const double lum = static_cast<double>(clamp(luminance(rgb), 0.0f, MaxSampleLuminance));
+
+        Spinlock::ScopedLock lock(block.m_lock);
+
+        ++block.m_sample_count;
+        block.m_sum += lum;
+        block.m_sum_sq += lum * lum;
+
+        if (block.m_sample_count % EvaluationInterval > 0)
+            continue;
+
+        // Wait until every pixel of the block received the minimum number of samples.
+        const double n = static_cast<double>(block.m_sample_count);
+        const double pixel_count = static_cast<double>(get_block_pixel_count(bx, by));
+        const double samples_per_pixel = n / pixel_count;
+        if (samples_per_pixel < m_min_samples_per_pixel)
+            continue;
+
+        // Estimate the standard error of the average luminance of a pixel of the block.
+        const double mean = block.m_sum / n;
+        const double variance = max(block.m_sum_sq / n - mean * mean, 0.0);
+        const double std_error = sqrt(variance / samples_per_pixel);
+        const double rel_error = std_error / max(mean, MinLuminance);
+
+        if (rel_error <= m_noise_threshold && !block.m_converged)
+        {
+            block.m_converged = true;
+            ++m_converged_block_count;
+        }
+    }
+}
+
+bool ConvergenceMap::is_converged(
+    const size_t            x,
+    const size_t            y) const
+{
+    assert(m_crop_window.contains(Vector2u(x, y)));
+
+    const size_t bx = (x - m_crop_window.min.x) / BlockSize;
+    const size_t by = (y - m_crop_window.min.y) / BlockSize;
+
+    return m_blocks[by * m_block_count_x + bx].m_converged;
+}
+
+size_t ConvergenceMap::get_block_pixel_count(
+    const size_t            bx,
+    const size_t            by) const
+{
+    const size_t width = m_crop_window.extent()[0] + 1;
+    const size_t height = m_crop_window.extent()[1] + 1;
+
+    const size_t block_width = min(BlockSize, width - bx * BlockSize);
+    const size_t block_height = min(BlockSize, height - by * BlockSize);
+
+    return block_width * block_height;
+}
+
+}   // namespace renderer
@@ -0,0 +1,130 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_CONVERGENCEMAP_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_CONVERGENCEMAP_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/platform/atomic.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace renderer      { class Sample; }
+
+namespace renderer
+{
+
+//
+// Tracks the noise level of blocks of pixels during progressive rendering.
+//
+// The relative standard error of the average luminance of a pixel is estimated from
+// the luminance of all samples that fell into its block. A block is converged once its
+// pixels received a minimum number of samples and their estimated error falls below a
+// threshold; no more samples are needed for this block.
+//
+
+class ConvergenceMap
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    ConvergenceMap(
+        const size_t                canvas_width,
+        const size_t                canvas_height,
+        const foundation::AABB2u&   crop_window,
+        const float                 noise_threshold,
+        const size_t                min_samples_per_pixel);
+
+    // Destructor.
+    ~ConvergenceMap();
+
+    // Reset the map to its initial state. Not thread-safe.
+    void clear();
+
+    // Update the statistics of the blocks that received a set of samples. Thread-safe.
+    void store_samples(
+        const size_t                sample_count,
+        const Sample                samples[]);
+
+    // Return true if a given pixel has converged. Thread-safe.
+    bool is_converged(
+        const size_t                x,
+        const size_t                y) const;
+
+    // Return true if all pixels have converged. Thread-safe.
+    bool is_converged() const;
+
+    // Return the number of converged blocks, and the total number of blocks.
+    size_t get_converged_block_count() const;
+    size_t get_block_count() const;
+
+  private:
+    struct Block;
+
+    const size_t                    m_canvas_width;
+    const size_t                    m_canvas_height;
+    const foundation::AABB2u        m_crop_window;
+    const float                     m_noise_threshold;
+    const size_t                    m_min_samples_per_pixel;
+    size_t                          m_block_count_x;
+    size_t                          m_block_count_y;
+    Block*                          m_blocks;
+    boost::atomic<size_t>           m_converged_block_count;
+
+    size_t get_block_pixel_count(
+        const size_t                bx,
+        const size_t                by) const;
+};
+
+
+//
+// ConvergenceMap class implementation.
+//
+
+inline bool ConvergenceMap::is_converged() const
+{
+    return m_converged_block_count == m_block_count_x * m_block_count_y;
+}
+
+inline size_t ConvergenceMap::get_converged_block_count() const
+{
+    return m_converged_block_count;
+}
+
+inline size_t ConvergenceMap::get_block_count() const
+{
+    return m_block_count_x * m_block_count_y;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_CONVERGENCEMAP_H
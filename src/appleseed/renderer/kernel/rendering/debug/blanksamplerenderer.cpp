@@ -36,8 +36,12 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/statistics.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace renderer  { class PixelContext; }
 
@@ -71,6 +75,25 @@ namespace
             shading_result.set_aovs_to_transparent_black_linear_rgba();
         }
 
+        virtual void render_samples(
+            const size_t        sample_count,
+            SamplingContext*    sampling_contexts,
+            const Vector2i&     pixel_coords,
+            const Vector2d*     image_points,
+            ShadingResult*      shading_results) APPLESEED_OVERRIDE
+        {
+            for (size_t i = 0; i < sample_count; ++i)
+            {
+                shading_results[i].set_main_to_transparent_black_linear_rgba();
+                shading_results[i].set_aovs_to_transparent_black_linear_rgba();
+            }
+        }
+
+        virtual uint64 get_ray_count() const APPLESEED_OVERRIDE
+        {
+            return 0;
+        }
+
         virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
         {
             return StatisticsVector();
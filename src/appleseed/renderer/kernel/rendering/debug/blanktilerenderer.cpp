@@ -85,6 +85,11 @@ namespace
             tile.clear(Color4f(0.0f, 0.0f, 0.0f, 1.0f));
         }
 
+        virtual void help_render_tiles(
+            IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE
+        {
+        }
+
         virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
         {
             return StatisticsVector();
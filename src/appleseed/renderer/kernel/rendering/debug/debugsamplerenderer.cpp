@@ -32,18 +32,18 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/rendering/pixelcontext.h"
 #include "renderer/kernel/shading/shadingresult.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/color.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/statistics.h"
 
 // Standard headers.
 #include <cmath>
-
-// Forward declarations.
-namespace renderer  { class PixelContext; }
+#include <cstddef>
 
 using namespace foundation;
 using namespace std;
@@ -83,6 +83,28 @@ namespace
             shading_result.set_aovs_to_transparent_black_linear_rgba();
         }
 
+        virtual void render_samples(
+            const size_t        sample_count,
+            SamplingContext*    sampling_contexts,
+            const Vector2i&     pixel_coords,
+            const Vector2d*     image_points,
+            ShadingResult*      shading_results) APPLESEED_OVERRIDE
+        {
+            for (size_t i = 0; i < sample_count; ++i)
+            {
+                render_sample(
+                    sampling_contexts[i],
+                    PixelContext(pixel_coords, image_points[i]),
+                    image_points[i],
+                    shading_results[i]);
+            }
+        }
+
+        virtual uint64 get_ray_count() const APPLESEED_OVERRIDE
+        {
+            return 0;
+        }
+
         virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
         {
             return StatisticsVector();
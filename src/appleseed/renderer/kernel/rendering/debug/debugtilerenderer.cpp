@@ -103,6 +103,11 @@ namespace
             tile.set_pixel(max_x, max_y, Color4f(0.0f, 0.0f, 1.0f, 1.0f));      // bottom right pixel is blue
         }
 
+        virtual void help_render_tiles(
+            IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE
+        {
+        }
+
         virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
         {
             return StatisticsVector();
@@ -30,6 +30,11 @@
 // Interface header.
 #include "defaultrenderercontroller.h"
 
+// appleseed.foundation headers.
+#include "foundation/platform/atomic.h"
+
+using namespace foundation;
+
 namespace renderer
 {
 
@@ -37,6 +42,11 @@ namespace renderer
 // DefaultRendererController class implementation.
 //
 
+DefaultRendererController::DefaultRendererController()
+  : m_active_thread_count(0)
+{
+}
+
 void DefaultRendererController::on_rendering_begin()
 {
 }
@@ -66,4 +76,14 @@ IRendererController::Status DefaultRendererController::get_status() const
     return ContinueRendering;
 }
 
+void DefaultRendererController::set_active_thread_count(const size_t thread_count)
+{
+    atomic_write(&m_active_thread_count, static_cast<uint32>(thread_count));
+}
+
+size_t DefaultRendererController::get_active_thread_count() const
+{
+    return atomic_read(const_cast<volatile uint32*>(&m_active_thread_count));
+}
+
 }   // namespace renderer
@@ -35,10 +35,14 @@
 
 // appleseed.foundation headers.
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
 
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 namespace renderer
 {
 
@@ -50,6 +54,9 @@ class APPLESEED_DLLSYMBOL DefaultRendererController
   : public IRendererController
 {
   public:
+    // Constructor.
+    DefaultRendererController();
+
     // This method is called before rendering begins.
     virtual void on_rendering_begin() APPLESEED_OVERRIDE;
 
@@ -70,6 +77,16 @@ class APPLESEED_DLLSYMBOL DefaultRendererController
 
     // Return the current rendering status.
     virtual Status get_status() const APPLESEED_OVERRIDE;
+
+    // Set the number of rendering threads that should be actively rendering, or 0 to use
+    // all of them. Thread-safe and async-signal-safe, may be called while rendering.
+    void set_active_thread_count(const size_t thread_count);
+
+    // Return the number of rendering threads that should be actively rendering.
+    virtual size_t get_active_thread_count() const APPLESEED_OVERRIDE;
+
+  private:
+    volatile foundation::uint32 m_active_thread_count;
 };
 
 }       // namespace renderer
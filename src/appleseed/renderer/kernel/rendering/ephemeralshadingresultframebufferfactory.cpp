@@ -58,7 +58,7 @@ ShadingResultFrameBuffer* EphemeralShadingResultFrameBufferFactory::create(
     const Tile& tile = frame.image().tile(tile_x, tile_y);
 
     ShadingResultFrameBuffer* framebuffer =
-        new ShadingResultFrameBuffer(
+        m_pool.acquire(
             tile.get_width(),
             tile.get_height(),
             frame.aov_images().size(),
@@ -73,7 +73,7 @@ ShadingResultFrameBuffer* EphemeralShadingResultFrameBufferFactory::create(
 void EphemeralShadingResultFrameBufferFactory::destroy(
     ShadingResultFrameBuffer*   framebuffer)
 {
-    delete framebuffer;
+    m_pool.release(framebuffer);
 }
 
 }   // namespace renderer
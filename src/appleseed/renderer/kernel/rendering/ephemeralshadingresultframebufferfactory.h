@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/rendering/ishadingresultframebufferfactory.h"
+#include "renderer/kernel/rendering/shadingresultframebufferpool.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/aabb.h"
@@ -62,6 +63,10 @@ class EphemeralShadingResultFrameBufferFactory
 
     virtual void destroy(
         ShadingResultFrameBuffer*   framebuffer) APPLESEED_OVERRIDE;
+
+  private:
+    // Framebuffers are recycled from one tile to the next.
+    ShadingResultFrameBufferPool    m_pool;
 };
 
 }       // namespace renderer
@@ -36,6 +36,7 @@
 #include "renderer/kernel/aov/aovsettings.h"
 #include "renderer/kernel/aov/imagestack.h"
 #include "renderer/kernel/aov/tilestack.h"
+#include "renderer/kernel/rendering/final/samplebudget.h"
 #include "renderer/kernel/rendering/final/variationtracker.h"
 #include "renderer/kernel/rendering/isamplerenderer.h"
 #include "renderer/kernel/rendering/pixelcontext.h"
@@ -47,18 +48,21 @@
 #include "renderer/utility/settingsparsing.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
 #include "foundation/image/color.h"
 #include "foundation/image/image.h"
 #include "foundation/image/tile.h"
 #include "foundation/math/aabb.h"
 #include "foundation/math/hash.h"
 #include "foundation/math/minmax.h"
+#include "foundation/math/rng/distribution.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
 #include <algorithm>
@@ -86,9 +90,14 @@ namespace
             const Frame&                frame,
             ISampleRendererFactory*     factory,
             const ParamArray&           params,
+            SampleBudget*               budget,
             const size_t                thread_index)
           : m_params(params)
           , m_sample_renderer(factory->create(thread_index))
+          , m_budget(budget)
+          , m_has_budget_pass(false)
+          , m_budget_pass_hash(0)
+          , m_budget_pass_index(0)
         {
             if (m_params.m_diagnostics)
             {
@@ -124,15 +133,33 @@ namespace
             m_scratch_fb_half_width = truncate<int>(ceil(frame.get_filter().get_xradius()));
             m_scratch_fb_half_height = truncate<int>(ceil(frame.get_filter().get_yradius()));
 
-            m_scratch_fb.reset(
-                new ShadingResultFrameBuffer(
-                    2 * m_scratch_fb_half_width + 1,
-                    2 * m_scratch_fb_half_height + 1,
-                    frame.aov_images().size(),
-                    frame.get_filter()));
+            const size_t scratch_fb_width = 2 * m_scratch_fb_half_width + 1;
+            const size_t scratch_fb_height = 2 * m_scratch_fb_half_height + 1;
+            const size_t aov_count = frame.aov_images().size();
+
+            // Reuse the scratch framebuffer of the previous tile when possible.
+            if (m_scratch_fb.get() == 0 ||
+                m_scratch_fb->get_width() != scratch_fb_width ||
+                m_scratch_fb->get_height() != scratch_fb_height ||
+                m_scratch_fb->get_aov_count() != aov_count ||
+                &m_scratch_fb->get_filter() != &frame.get_filter())
+            {
+                m_scratch_fb.reset(
+                    new ShadingResultFrameBuffer(
+                        scratch_fb_width,
+                        scratch_fb_height,
+                        aov_count,
+                        frame.get_filter()));
+            }
 
             if (m_params.m_diagnostics)
-                m_diagnostics.reset(new Tile(tile.get_width(), tile.get_height(), 2, PixelFormatFloat));
+            {
+                if (m_diagnostics.get() == 0 ||
+                    m_diagnostics->get_width() != tile.get_width() ||
+                    m_diagnostics->get_height() != tile.get_height())
+                    m_diagnostics.reset(new Tile(tile.get_width(), tile.get_height(), 2, PixelFormatFloat));
+                else m_diagnostics->clear(Color<float, 2>(0.0f));
+            }
         }
 
         virtual void on_tile_end(
@@ -162,6 +189,11 @@ namespace
             }
         }
 
+        virtual bool has_tile_diagnostics() const APPLESEED_OVERRIDE
+        {
+            return m_params.m_diagnostics;
+        }
+
         virtual void render_pixel(
             const Frame&                frame,
             Tile&                       tile,
@@ -173,24 +205,59 @@ namespace
             SamplingContext::RNGType&   rng,
             ShadingResultFrameBuffer&   framebuffer) APPLESEED_OVERRIDE
         {
-            const size_t aov_count = frame.aov_images().size();
+            // AOVs are not computed for pixels outside the AOV window.
+            const size_t aov_count = frame.get_aov_count(pi);
 
             on_pixel_begin();
 
             m_scratch_fb->clear();
 
-            // Create a sampling context.
+            // Create a sampling context. The hashed pixel index becomes the base instance
+            // number of the context so that the per-pixel Cranley-Patterson offset is only
+            // computed once and pixel samples are read from the precomputed sequence.
             const size_t frame_width = frame.image().properties().m_canvas_width;
             const size_t instance =
                 mix_uint32(
                     static_cast<uint32>(pass_hash),
                     static_cast<uint32>(pi.y * frame_width + pi.x));
-            SamplingContext sampling_context(
-                rng,
-                m_params.m_sampling_mode,
-                2,                          // number of dimensions
-                0,                          // number of samples -- unknown
-                instance);                  // initial instance number
+            SamplingContext sampling_context =
+                SamplingContext(
+                    rng,
+                    m_params.m_sampling_mode,
+                    0,                          // number of dimensions
+                    0,                          // number of samples -- unknown
+                    instance)                   // initial instance number
+                .split(
+                    2,                          // number of dimensions
+                    0);                         // number of samples -- unknown
+
+            // In frame budget mode, the first pass measures the variation of every pixel
+            // with 'min' samples; later passes use the samples allotted to the tile.
+            size_t max_samples = m_params.m_max_samples;
+            size_t tile_index = 0;
+            if (m_budget)
+            {
+                if (!m_has_budget_pass || pass_hash != m_budget_pass_hash)
+                {
+                    m_has_budget_pass = true;
+                    m_budget_pass_hash = pass_hash;
+                    m_budget_pass_index = m_budget->begin_pass(pass_hash);
+                }
+
+                const CanvasProperties& props = frame.image().properties();
+                tile_index =
+                    (pi.y / props.m_tile_height) * props.m_tile_count_x +
+                    (pi.x / props.m_tile_width);
+
+                if (m_budget_pass_index == 0)
+                    max_samples = m_params.m_min_samples;
+                else
+                {
+                    // Round the fractional allotment stochastically to honor the budget on average.
+                    const float pixel_samples = m_budget->get_pixel_samples(tile_index);
+                    max_samples = truncate<size_t>(pixel_samples + rand_float2(rng));
+                }
+            }
 
             VariationTracker trackers[3];
 
@@ -201,8 +268,8 @@ namespace
                 trackers[2].reset_variation();
 
                 // Don't exceed 'max' samples in total.
-                assert(trackers[0].get_size() <= m_params.m_max_samples);
-                const size_t remaining_samples = m_params.m_max_samples - trackers[0].get_size();
+                assert(trackers[0].get_size() <= max_samples);
+                const size_t remaining_samples = max_samples - trackers[0].get_size();
                 if (remaining_samples == 0)
                     break;
 
@@ -257,8 +324,23 @@ namespace
                     break;
             }
 
-            // Merge the scratch framebuffer into the output framebuffer.
-            const float rcp_sample_count = 1.0f / trackers[0].get_size();
+            const float max_variation =
+                max(
+                    trackers[0].get_variation(),
+                    trackers[1].get_variation(),
+                    trackers[2].get_variation());
+
+            // Record the variation measured during the first pass of the frame budget mode.
+            if (m_budget && m_budget_pass_index == 0 && tile_bbox.contains(pt))
+                m_budget->record_pixel(tile_index, trackers[0].get_size(), max_variation);
+
+            // Merge the scratch framebuffer into the output framebuffer. In frame budget mode,
+            // samples keep their weight so that passes combine in proportion to their sample counts.
+            // Pixels without samples leave an empty scratch framebuffer and contribute nothing.
+            const size_t sample_count = trackers[0].get_size();
+            const float rcp_sample_count =
+                m_budget ? 1.0f :
+                sample_count > 0 ? 1.0f / sample_count : 0.0f;
             for (int y = -m_scratch_fb_half_height; y <= m_scratch_fb_half_height; ++y)
             {
                 for (int x = -m_scratch_fb_half_width; x <= m_scratch_fb_half_width; ++x)
@@ -281,13 +363,7 @@ namespace
             {
                 Color<float, 2> values;
 
-                values[0] =
-                    saturate(
-                        max(
-                            trackers[0].get_variation(),
-                            trackers[1].get_variation(),
-                            trackers[2].get_variation())
-                        / m_params.m_max_variation);
+                values[0] = saturate(max_variation / m_params.m_max_variation);
 
                 values[1] =
                     m_params.m_min_samples == m_params.m_max_samples
@@ -304,6 +380,11 @@ namespace
             on_pixel_end(pi);
         }
 
+        virtual uint64 get_ray_count() const APPLESEED_OVERRIDE
+        {
+            return m_sample_renderer->get_ray_count();
+        }
+
         virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
         {
             return m_sample_renderer->get_statistics();
@@ -330,6 +411,10 @@ namespace
 
         const Parameters                    m_params;
         auto_release_ptr<ISampleRenderer>   m_sample_renderer;
+        SampleBudget*                       m_budget;
+        bool                                m_has_budget_pass;
+        size_t                              m_budget_pass_hash;
+        size_t                              m_budget_pass_index;
         size_t                              m_variation_aov_index;
         size_t                              m_samples_aov_index;
         int                                 m_scratch_fb_half_width;
@@ -358,6 +443,40 @@ AdaptivePixelRendererFactory::AdaptivePixelRendererFactory(
   : m_frame(frame)
   , m_factory(factory)
   , m_params(params)
+{
+    const float budget = params.get_optional<float>("budget", 0.0f);
+    if (budget > 0.0f)
+    {
+        const size_t pass_count = params.get_optional<size_t>("passes", 1);
+        if (pass_count < 2)
+        {
+            RENDERER_LOG_WARNING(
+                "the frame sample budget of the adaptive pixel renderer requires at least two passes; "
+                "the budget will be ignored.");
+        }
+        else
+        {
+            const AABB2u& crop_window = frame.get_crop_window();
+            const uint64 pixel_count =
+                static_cast<uint64>(crop_window.max.x - crop_window.min.x + 1) *
+                static_cast<uint64>(crop_window.max.y - crop_window.min.y + 1);
+            const uint64 total_samples = static_cast<uint64>(budget * pixel_count);
+
+            RENDERER_LOG_INFO(
+                "adaptive sampling budget: %s samples in total, redistributed across tiles after the first pass.",
+                pretty_uint(total_samples).c_str());
+
+            m_budget.reset(
+                new SampleBudget(
+                    frame.image().properties().m_tile_count,
+                    pass_count,
+                    total_samples,
+                    params.get_required<size_t>("max_samples", 256)));
+        }
+    }
+}
+
+AdaptivePixelRendererFactory::~AdaptivePixelRendererFactory()
 {
 }
 
@@ -373,6 +492,7 @@ IPixelRenderer* AdaptivePixelRendererFactory::create(
         m_frame,
         m_factory,
         m_params,
+        m_budget.get(),
         thread_index);
 }
 
@@ -404,6 +524,17 @@ Dictionary AdaptivePixelRendererFactory::get_params_metadata()
             .insert("label", "Quality")
             .insert("help", "Quality factor"));
 
+    metadata.dictionaries().insert(
+        "budget",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.0")
+            .insert("label", "Frame Budget")
+            .insert(
+                "help",
+                "Average number of samples per pixel for the whole frame, redistributed across tiles by variation "
+                "after the first pass (requires multiple passes; 0 to disable)"));
+
     metadata.dictionaries().insert(
         "enable_diagnostics",
         Dictionary()
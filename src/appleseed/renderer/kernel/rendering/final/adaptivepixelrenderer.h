@@ -39,11 +39,13 @@
 
 // Standard headers.
 #include <cstddef>
+#include <memory>
 
 // Forward declarations.
 namespace foundation    { class Dictionary; }
 namespace renderer      { class Frame; }
 namespace renderer      { class ISampleRendererFactory; }
+namespace renderer      { class SampleBudget; }
 
 namespace renderer
 {
@@ -62,6 +64,9 @@ class AdaptivePixelRendererFactory
         ISampleRendererFactory*     factory,
         const ParamArray&           params);
 
+    // Destructor.
+    ~AdaptivePixelRendererFactory();
+
     // Delete this instance.
     virtual void release() APPLESEED_OVERRIDE;
 
@@ -76,6 +81,7 @@ class AdaptivePixelRendererFactory
     const Frame&                    m_frame;
     ISampleRendererFactory*         m_factory;
     ParamArray                      m_params;
+    std::auto_ptr<SampleBudget>     m_budget;
 };
 
 }       // namespace renderer
@@ -0,0 +1,200 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "samplebudget.h"
+
+// Boost headers.
+#include "boost/thread/locks.hpp"
+
+// Standard headers.
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// SampleBudget class implementation.
+//
+
+SampleBudget::TileRecord::TileRecord()
+  : m_pixel_count(0)
+  , m_sample_count(0)
+  , m_variation(0.0)
+  , m_pixel_samples(0.0f)
+{
+}
+
+SampleBudget::SampleBudget(
+    const size_t                tile_count,
+    const size_t                pass_count,
+    const uint64                total_samples,
+    const size_t                max_pixel_samples)
+  : m_pass_count(pass_count)
+  , m_total_samples(total_samples)
+  , m_max_pixel_samples(max_pixel_samples)
+  , m_has_pass(false)
+  , m_pass_hash(0)
+  , m_pass_index(0)
+  , m_tiles(tile_count)
+{
+}
+
+size_t SampleBudget::begin_pass(const size_t pass_hash)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (!m_has_pass)
+    {
+        m_has_pass = true;
+        m_pass_hash = pass_hash;
+    }
+    else if (pass_hash != m_pass_hash)
+    {
+        // Passes are rendered one after the other: all pixels of the previous pass are recorded.
+        m_pass_hash = pass_hash;
+        if (++m_pass_index == 1)
+            allocate();
+    }
+
+    return m_pass_index;
+}
+
+void SampleBudget::record_pixel(
+    const size_t                tile_index,
+    const size_t                sample_count,
+    const float                 variation)
+{
+    assert(tile_index < m_tiles.size());
+
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    TileRecord& tile = m_tiles[tile_index];
+    ++tile.m_pixel_count;
+    tile.m_sample_count += sample_count;
+    tile.m_variation += variation;
+}
+
+float SampleBudget::get_pixel_samples(const size_t tile_index) const
+{
+    assert(tile_index < m_tiles.size());
+
+    return m_tiles[tile_index].m_pixel_samples;
+}
+
+void SampleBudget::allocate()
+{
+    if (m_pass_count < 2)
+        return;
+
+    const size_t tile_count = m_tiles.size();
+    const double remaining_passes = static_cast<double>(m_pass_count - 1);
+
+    // Compute the number of samples left in the budget after the measurement pass.
+    uint64 spent_samples = 0;
+    double total_variation = 0.0;
+    for (size_t i = 0; i < tile_count; ++i)
+    {
+        spent_samples += m_tiles[i].m_sample_count;
+        total_variation += m_tiles[i].m_variation;
+    }
+    double remaining_samples =
+        spent_samples < m_total_samples
+            ? static_cast<double>(m_total_samples - spent_samples)
+            : 0.0;
+
+    // Tiles are weighted by their variation, or by their size if no variation was measured.
+    vector<double> weights(tile_count);
+    for (size_t i = 0; i < tile_count; ++i)
+    {
+        weights[i] =
+            total_variation > 0.0
+                ? m_tiles[i].m_variation
+                : static_cast<double>(m_tiles[i].m_pixel_count);
+        m_tiles[i].m_pixel_samples = 0.0f;
+    }
+
+    // Distribute the remaining samples. Tiles that reach the maximum number of samples
+    // per pixel are capped and their excess is redistributed to the other tiles.
+    vector<bool> capped(tile_count, false);
+    while (remaining_samples > 0.0)
+    {
+        double total_weight = 0.0;
+        for (size_t i = 0; i < tile_count; ++i)
+        {
+            if (!capped[i])
+                total_weight += weights[i];
+        }
+
+        if (total_weight == 0.0)
+            break;
+
+        bool capped_any = false;
+        double capped_samples = 0.0;
+
+        for (size_t i = 0; i < tile_count; ++i)
+        {
+            if (capped[i] || weights[i] == 0.0)
+                continue;
+
+            const double pixel_pass_count = m_tiles[i].m_pixel_count * remaining_passes;
+            const double pixel_samples = remaining_samples * (weights[i] / total_weight) / pixel_pass_count;
+
+            if (pixel_samples >= m_max_pixel_samples)
+            {
+                m_tiles[i].m_pixel_samples = static_cast<float>(m_max_pixel_samples);
+                capped[i] = true;
+                capped_any = true;
+                capped_samples += m_max_pixel_samples * pixel_pass_count;
+            }
+        }
+
+        if (!capped_any)
+        {
+            for (size_t i = 0; i < tile_count; ++i)
+            {
+                if (capped[i] || weights[i] == 0.0)
+                    continue;
+
+                const double pixel_pass_count = m_tiles[i].m_pixel_count * remaining_passes;
+                m_tiles[i].m_pixel_samples =
+                    static_cast<float>(remaining_samples * (weights[i] / total_weight) / pixel_pass_count);
+            }
+
+            break;
+        }
+
+        remaining_samples -= capped_samples;
+    }
+}
+
+}   // namespace renderer
@@ -0,0 +1,110 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_FINAL_SAMPLEBUDGET_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_FINAL_SAMPLEBUDGET_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A frame-wide budget of pixel samples, redistributed across tiles by measured variation.
+//
+// The first pass of the frame is a measurement pass: every pixel takes the same number
+// of samples and records its variation. When the second pass begins, the samples left
+// in the budget are distributed across tiles in proportion to the variation measured in
+// each tile, and spread evenly over the remaining passes.
+//
+// All methods are thread-safe.
+//
+
+class SampleBudget
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    SampleBudget(
+        const size_t                tile_count,
+        const size_t                pass_count,
+        const foundation::uint64    total_samples,
+        const size_t                max_pixel_samples);     // maximum number of samples per pixel and per pass
+
+    // Notify the budget that a pixel of a given pass is about to be rendered.
+    // Return the index of this pass, starting at 0 for the measurement pass.
+    size_t begin_pass(const size_t pass_hash);
+
+    // Record the samples taken by a pixel of the measurement pass and its variation.
+    void record_pixel(
+        const size_t                tile_index,
+        const size_t                sample_count,
+        const float                 variation);
+
+    // Return the average number of samples per pixel and per pass allotted to a tile.
+    // Only valid once begin_pass() has returned a nonzero pass index to the caller:
+    // allotments are never modified afterward and can be read without locking.
+    float get_pixel_samples(const size_t tile_index) const;
+
+  private:
+    struct TileRecord
+    {
+        size_t                      m_pixel_count;
+        foundation::uint64          m_sample_count;
+        double                      m_variation;        // sum of the variations of the pixels
+        float                       m_pixel_samples;    // allotted samples per pixel and per pass
+
+        TileRecord();
+    };
+
+    const size_t                    m_pass_count;
+    const foundation::uint64        m_total_samples;
+    const size_t                    m_max_pixel_samples;
+    boost::mutex                    m_mutex;
+    bool                            m_has_pass;
+    size_t                          m_pass_hash;
+    size_t                          m_pass_index;
+    std::vector<TileRecord>         m_tiles;
+
+    // Distribute the remaining samples across tiles. Must be called with the mutex locked.
+    void allocate();
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_FINAL_SAMPLEBUDGET_H
@@ -57,7 +57,10 @@
 #include "foundation/utility/statistics.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class Tile; }
@@ -75,6 +78,9 @@ namespace
     // Uniform pixel renderer.
     //
 
+    // Maximum number of samples of a pixel rendered together.
+    const size_t SampleBatchSize = 16;
+
     class UniformPixelRenderer
       : public PixelRendererBase
     {
@@ -121,54 +127,88 @@ namespace
             SamplingContext::RNGType&   rng,
             ShadingResultFrameBuffer&   framebuffer) APPLESEED_OVERRIDE
         {
-            const size_t aov_count = frame.aov_images().size();
+            // AOVs are not computed for pixels outside the AOV window.
+            const size_t aov_count = frame.get_aov_count(pi);
 
             on_pixel_begin();
 
             if (m_params.m_decorrelate)
             {
-                // Create a sampling context.
+                // Create a sampling context. The hashed pixel index becomes the base instance
+                // number of the context: it decorrelates the child contexts and yields a per-pixel
+                // Cranley-Patterson offset, computed once per pixel. Pixel samples are then read
+                // from the start of the precomputed sequence and rotated by this offset.
+                // With blue-noise dithering, all pixels of a pass share the same sequence and
+                // the per-pixel rotation is read from a blue-noise mask instead.
                 const size_t frame_width = frame.image().properties().m_canvas_width;
-                const size_t instance = hash_uint32(static_cast<uint32>(pass_hash + pi.y * frame_width + pi.x));
-                SamplingContext sampling_context(
+                const size_t instance =
+                    m_params.m_blue_noise_dithering
+                        ? hash_uint32(static_cast<uint32>(pass_hash))
+                        : hash_uint32(static_cast<uint32>(pass_hash + pi.y * frame_width + pi.x));
+                SamplingContext parent_sampling_context(
                     rng,
                     m_params.m_sampling_mode,
-                    2,                          // number of dimensions
+                    0,                          // number of dimensions
                     0,                          // number of samples -- unknown
                     instance);                  // initial instance number
+                if (m_params.m_blue_noise_dithering)
+                {
+                    // Shift the mask from pass to pass.
+                    parent_sampling_context.set_dither_pixel(
+                        pi.x + pass_hash,
+                        pi.y + (pass_hash >> 6));
+                }
+                SamplingContext sampling_context =
+                    parent_sampling_context.split(
+                        2,                      // number of dimensions
+                        0);                     // number of samples -- unknown
 
-                for (size_t i = 0; i < m_sample_count; ++i)
+                // Samples are rendered in batches so that their camera rays are generated and traced together.
+                for (size_t first = 0; first < m_sample_count; first += SampleBatchSize)
                 {
-                    // Generate a uniform sample in [0,1)^2.
-                    const Vector2d s =
-                        m_sample_count > 1 || m_params.m_force_aa
-                            ? sampling_context.next2<Vector2d>()
-                            : Vector2d(0.5);
-
-                    // Compute the sample position in NDC.
-                    const Vector2d sample_position = frame.get_sample_position(pi.x + s.x, pi.y + s.y);
-
-                    // Create a pixel context that identifies the pixel and sample currently being rendered.
-                    const PixelContext pixel_context(pi, sample_position);
-
-                    // Render the sample.
-                    ShadingResult shading_result(aov_count);
-                    SamplingContext child_sampling_context(sampling_context);
-                    m_sample_renderer->render_sample(
-                        child_sampling_context,
-                        pixel_context,
-                        sample_position,
-                        shading_result);
-
-                    // Merge the sample into the framebuffer.
-                    if (shading_result.is_valid_linear_rgb())
+                    const size_t batch_size = min(m_sample_count - first, SampleBatchSize);
+
+                    Vector2d s[SampleBatchSize];
+                    Vector2d sample_positions[SampleBatchSize];
+                    m_sampling_contexts.clear();
+
+                    for (size_t i = 0; i < batch_size; ++i)
                     {
-                        framebuffer.add(
-                            static_cast<float>(pt.x + s.x),
-                            static_cast<float>(pt.y + s.y),
-                            shading_result);
+                        // Generate a uniform sample in [0,1)^2.
+                        s[i] =
+                            m_sample_count > 1 || m_params.m_force_aa
+                                ? sampling_context.next2<Vector2d>()
+                                : Vector2d(0.5);
+
+                        // Compute the sample position in NDC.
+                        sample_positions[i] = frame.get_sample_position(pi.x + s[i].x, pi.y + s[i].y);
+
+                        m_sampling_contexts.push_back(sampling_context);
+                        m_shading_results[i].reset(aov_count);
+                    }
+
+                    // Render the samples.
+                    m_sample_renderer->render_samples(
+                        batch_size,
+                        &m_sampling_contexts[0],
+                        pi,
+                        sample_positions,
+                        m_shading_results);
+
+                    // Merge the samples into the framebuffer.
+                    for (size_t i = 0; i < batch_size; ++i)
+                    {
+                        const ShadingResult& shading_result = m_shading_results[i];
+
+                        if (shading_result.is_valid_linear_rgb())
+                        {
+                            framebuffer.add(
+                                static_cast<float>(pt.x + s[i].x),
+                                static_cast<float>(pt.y + s[i].y),
+                                shading_result);
+                        }
+                        else signal_invalid_sample();
                     }
-                    else signal_invalid_sample();
                 }
             }
             else
@@ -225,6 +265,11 @@ namespace
             on_pixel_end(pi);
         }
 
+        virtual uint64 get_ray_count() const APPLESEED_OVERRIDE
+        {
+            return m_sample_renderer->get_ray_count();
+        }
+
         virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
         {
             return m_sample_renderer->get_statistics();
@@ -237,12 +282,14 @@ namespace
             const size_t                    m_samples;
             const bool                      m_force_aa;
             const bool                      m_decorrelate;
+            const bool                      m_blue_noise_dithering;
 
             explicit Parameters(const ParamArray& params)
               : m_sampling_mode(get_sampling_context_mode(params))
               , m_samples(params.get_required<size_t>("samples", 64))
               , m_force_aa(params.get_optional<bool>("force_antialiasing", false))
               , m_decorrelate(params.get_optional<bool>("decorrelate_pixels", true))
+              , m_blue_noise_dithering(params.get_optional<bool>("blue_noise_dithering", false))
             {
             }
         };
@@ -252,6 +299,8 @@ namespace
         const size_t                        m_sample_count;
         const int                           m_sqrt_sample_count;
         PixelSampler                        m_pixel_sampler;
+        vector<SamplingContext>             m_sampling_contexts;
+        ShadingResult                       m_shading_results[SampleBatchSize];
     };
 }
 
@@ -311,6 +360,16 @@ Dictionary UniformPixelRendererFactory::get_params_metadata()
                 "help",
                 "Avoid correlation patterns at the expense of slightly more sampling noise"));
 
+    metadata.dictionaries().insert(
+        "blue_noise_dithering",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Blue-Noise Dithering")
+            .insert(
+                "help",
+                "Distribute the sampling noise of decorrelated pixels as blue noise, which looks better at low sample counts"));
+
     return metadata;
 }
 
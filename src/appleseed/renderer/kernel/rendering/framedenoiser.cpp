@@ -0,0 +1,384 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "framedenoiser.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/aov/imagestack.h"
+#include "renderer/modeling/frame/frame.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/timers.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// FrameDenoiser class implementation.
+//
+
+namespace
+{
+    struct FeaturePixel
+    {
+        Color4f     m_color;
+        Color3f     m_albedo;
+        Vector3f    m_normal;
+        float       m_depth;
+        bool        m_has_features;
+    };
+
+    // Fetch the feature stored in a feature AOV, undoing partial pixel coverage.
+    inline bool fetch_feature(
+        const Image&        image,
+        const size_t        x,
+        const size_t        y,
+        Color3f&            feature)
+    {
+        Color4f value;
+        image.get_pixel(x, y, value);
+
+        if (value.a <= 0.0f)
+            return false;
+
+        feature = value.rgb() / value.a;
+        return true;
+    }
+
+    class DenoiseTileJob
+      : public IJob
+    {
+      public:
+        DenoiseTileJob(
+            const FrameDenoiser::Parameters&    params,
+            const Image&                        source,
+            const Image&                        depth,
+            const Image&                        normal,
+            const Image&                        albedo,
+            const AABB2u&                       crop_window,
+            const vector<float>&                spatial_weights,
+            Image&                              target,
+            const size_t                        tile_x,
+            const size_t                        tile_y,
+            IAbortSwitch*                       abort_switch,
+            uint8&                              success)
+          : m_params(params)
+          , m_source(source)
+          , m_depth(depth)
+          , m_normal(normal)
+          , m_albedo(albedo)
+          , m_crop_window(crop_window)
+          , m_spatial_weights(spatial_weights)
+          , m_target(target)
+          , m_tile_x(tile_x)
+          , m_tile_y(tile_y)
+          , m_abort_switch(abort_switch)
+          , m_success(success)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            if (is_aborted(m_abort_switch))
+            {
+                m_success = 0;
+                return;
+            }
+
+            const CanvasProperties& props = m_source.properties();
+
+            // Compute the pixels of the tile that lie inside the crop window.
+            const int r = static_cast<int>(m_params.m_radius);
+            const AABB2i crop_window(m_crop_window);
+            const AABB2i tile_bbox(
+                Vector2i(
+                    static_cast<int>(m_tile_x * props.m_tile_width),
+                    static_cast<int>(m_tile_y * props.m_tile_height)),
+                Vector2i(
+                    static_cast<int>(min((m_tile_x + 1) * props.m_tile_width, props.m_canvas_width)) - 1,
+                    static_cast<int>(min((m_tile_y + 1) * props.m_tile_height, props.m_canvas_height)) - 1));
+            const AABB2i bbox = AABB2i::intersect(tile_bbox, crop_window);
+
+            if (!bbox.is_valid())
+            {
+                m_success = 1;
+                return;
+            }
+
+            // Gather the tile and its apron into a local buffer.
+            const AABB2i window(
+                Vector2i(max(bbox.min.x - r, crop_window.min.x), max(bbox.min.y - r, crop_window.min.y)),
+                Vector2i(min(bbox.max.x + r, crop_window.max.x), min(bbox.max.y + r, crop_window.max.y)));
+            const int window_width = window.extent(0) + 1;
+            const int window_height = window.extent(1) + 1;
+
+            vector<FeaturePixel> pixels(window_width * window_height);
+
+            for (int y = window.min.y; y <= window.max.y; ++y)
+            {
+                for (int x = window.min.x; x <= window.max.x; ++x)
+                {
+                    FeaturePixel& pixel = pixels[(y - window.min.y) * window_width + (x - window.min.x)];
+
+                    m_source.get_pixel(x, y, pixel.m_color);
+
+                    Color3f depth, normal;
+                    pixel.m_has_features =
+                        fetch_feature(m_depth, x, y, depth) &&
+                        fetch_feature(m_normal, x, y, normal) &&
+                        fetch_feature(m_albedo, x, y, pixel.m_albedo);
+
+                    if (pixel.m_has_features)
+                    {
+                        pixel.m_depth = depth[0];
+                        pixel.m_normal = Vector3f(normal[0], normal[1], normal[2]) * 2.0f - Vector3f(1.0f);
+                    }
+                }
+            }
+
+            // Filter the pixels of the tile.
+            const float rcp_color_var = 1.0f / (2.0f * square(m_params.m_color_sigma));
+            const float rcp_albedo_var = 1.0f / (2.0f * square(m_params.m_albedo_sigma));
+            const float rcp_normal_var = 1.0f / (2.0f * square(m_params.m_normal_sigma));
+            const float rcp_depth_var = 1.0f / (2.0f * square(m_params.m_depth_sigma));
+            const int footprint_size = 2 * r + 1;
+
+            Tile& tile = m_target.tile(m_tile_x, m_tile_y);
+
+            for (int y = bbox.min.y; y <= bbox.max.y; ++y)
+            {
+                for (int x = bbox.min.x; x <= bbox.max.x; ++x)
+                {
+                    const FeaturePixel& center = pixels[(y - window.min.y) * window_width + (x - window.min.x)];
+
+                    Color4f sum(0.0f);
+                    float weight_sum = 0.0f;
+
+                    const int ymin = max(y - r, window.min.y), ymax = min(y + r, window.max.y);
+                    const int xmin = max(x - r, window.min.x), xmax = min(x + r, window.max.x);
+
+                    for (int qy = ymin; qy <= ymax; ++qy)
+                    {
+                        const FeaturePixel* row = &pixels[(qy - window.min.y) * window_width - window.min.x];
+                        const float* spatial_row = &m_spatial_weights[(qy - y + r) * footprint_size + r - x];
+
+                        for (int qx = xmin; qx <= xmax; ++qx)
+                        {
+                            const FeaturePixel& pixel = row[qx];
+
+                            // Never mix pixels with and without surface features.
+                            if (pixel.m_has_features != center.m_has_features)
+                                continue;
+
+                            float exponent = 0.0f;
+
+                            for (size_t i = 0; i < 3; ++i)
+                            {
+                                const float a = center.m_color[i], b = pixel.m_color[i];
+                                exponent += square(a - b) / (1.0e-2f + square(a) + square(b));
+                            }
+                            exponent *= rcp_color_var;
+
+                            if (center.m_has_features)
+                            {
+                                exponent += square_distance(center.m_albedo, pixel.m_albedo) * rcp_albedo_var;
+                                exponent += square_distance(center.m_normal, pixel.m_normal) * rcp_normal_var;
+                                exponent +=
+                                    square((center.m_depth - pixel.m_depth) / max(center.m_depth, 1.0e-4f))
+                                        * rcp_depth_var;
+                            }
+
+                            const float weight = spatial_row[qx] * exp(-exponent);
+
+                            sum += weight * pixel.m_color;
+                            weight_sum += weight;
+                        }
+                    }
+
+                    // The center pixel always contributes, hence weight_sum > 0.
+                    tile.set_pixel(
+                        x - tile_bbox.min.x,
+                        y - tile_bbox.min.y,
+                        sum / weight_sum);
+                }
+            }
+
+            m_success = 1;
+        }
+
+      private:
+        const FrameDenoiser::Parameters&    m_params;
+        const Image&                        m_source;
+        const Image&                        m_depth;
+        const Image&                        m_normal;
+        const Image&                        m_albedo;
+        const AABB2u&                       m_crop_window;
+        const vector<float>&                m_spatial_weights;
+        Image&                              m_target;
+        const size_t                        m_tile_x;
+        const size_t                        m_tile_y;
+        IAbortSwitch*                       m_abort_switch;
+        uint8&                              m_success;
+
+        static float square_distance(const Color3f& lhs, const Color3f& rhs)
+        {
+            return square(lhs[0] - rhs[0]) + square(lhs[1] - rhs[1]) + square(lhs[2] - rhs[2]);
+        }
+
+        static float square_distance(const Vector3f& lhs, const Vector3f& rhs)
+        {
+            return square_norm(lhs - rhs);
+        }
+    };
+}
+
+FrameDenoiser::Parameters::Parameters(const ParamArray& params)
+  : m_radius(params.get_optional<size_t>("radius", 5))
+  , m_spatial_sigma(params.get_optional<float>("spatial_sigma", 3.0f))
+  , m_color_sigma(params.get_optional<float>("color_sigma", 0.5f))
+  , m_albedo_sigma(params.get_optional<float>("albedo_sigma", 0.1f))
+  , m_normal_sigma(params.get_optional<float>("normal_sigma", 0.3f))
+  , m_depth_sigma(params.get_optional<float>("depth_sigma", 0.05f))
+{
+}
+
+FrameDenoiser::FrameDenoiser(const ParamArray& params)
+  : m_params(params)
+{
+}
+
+bool FrameDenoiser::denoise(
+    Frame&                  frame,
+    const size_t            thread_count,
+    IAbortSwitch*           abort_switch) const
+{
+    const ImageStack& aov_images = frame.aov_images();
+    const size_t depth_index = aov_images.get_index("depth");
+    const size_t normal_index = aov_images.get_index("normal");
+    const size_t albedo_index = aov_images.get_index("albedo");
+
+    if (depth_index == size_t(~0) || normal_index == size_t(~0) || albedo_index == size_t(~0))
+    {
+        RENDERER_LOG_ERROR("cannot denoise frame: feature aovs are missing.");
+        return false;
+    }
+
+    RENDERER_LOG_INFO(
+        "denoising frame using %s %s...",
+        pretty_uint(thread_count).c_str(),
+        plural(thread_count, "thread").c_str());
+
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    // Tiles of the main image are overwritten while neighboring tiles are being
+    // denoised, so read from a copy.
+    Image& image = frame.image();
+    const Image source(image);
+
+    // Precompute the spatial weights over the filter footprint.
+    const int r = static_cast<int>(m_params.m_radius);
+    const float rcp_spatial_var = 1.0f / (2.0f * square(m_params.m_spatial_sigma));
+    vector<float> spatial_weights((2 * r + 1) * (2 * r + 1));
+    for (int dy = -r; dy <= r; ++dy)
+    {
+        for (int dx = -r; dx <= r; ++dx)
+            spatial_weights[(dy + r) * (2 * r + 1) + dx + r] = exp(-(dx * dx + dy * dy) * rcp_spatial_var);
+    }
+
+    const CanvasProperties& props = image.properties();
+    const size_t tile_count = props.m_tile_count;
+    vector<uint8> success(tile_count, 0);
+
+    JobQueue job_queue;
+    for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+    {
+        for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+        {
+            job_queue.schedule(
+                new DenoiseTileJob(
+                    m_params,
+                    source,
+                    aov_images.get_image(depth_index),
+                    aov_images.get_image(normal_index),
+                    aov_images.get_image(albedo_index),
+                    frame.get_crop_window(),
+                    spatial_weights,
+                    image,
+                    tx,
+                    ty,
+                    abort_switch,
+                    success[ty * props.m_tile_count_x + tx]));
+        }
+    }
+
+    JobManager job_manager(
+        global_logger(),
+        job_queue,
+        max<size_t>(min(thread_count, tile_count), 1));
+
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    if (find(success.begin(), success.end(), 0) != success.end())
+        return false;
+
+    stopwatch.measure();
+
+    RENDERER_LOG_INFO(
+        "denoised frame in %s.",
+        pretty_time(stopwatch.get_seconds()).c_str());
+
+    return true;
+}
+
+}   // namespace renderer
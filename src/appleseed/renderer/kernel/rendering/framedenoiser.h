@@ -0,0 +1,95 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_FRAMEDENOISER_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_FRAMEDENOISER_H
+
+// appleseed.renderer headers.
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class Frame; }
+
+namespace renderer
+{
+
+//
+// Removes residual Monte Carlo noise from the main image of a frame.
+//
+// Each pixel is replaced by a weighted average of its neighbors (a joint bilateral
+// filter). Weights fall off with the distance between pixels and with differences in
+// color and in the albedo, normal and depth feature AOVs, so that edges and textures
+// present in the features are preserved while noise is smoothed away. Tiles are
+// denoised in parallel.
+//
+
+class APPLESEED_DLLSYMBOL FrameDenoiser
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    explicit FrameDenoiser(const ParamArray& params);
+
+    // Denoise the main image of a frame. The frame must contain the "depth", "normal"
+    // and "albedo" feature AOVs. Return true on success, false otherwise.
+    bool denoise(
+        Frame&                      frame,
+        const size_t                thread_count,
+        foundation::IAbortSwitch*   abort_switch = 0) const;
+
+    struct Parameters
+    {
+        const size_t    m_radius;           // radius of the filter footprint, in pixels
+        const float     m_spatial_sigma;    // standard deviation of the spatial weights, in pixels
+        const float     m_color_sigma;      // tolerance on relative color differences
+        const float     m_albedo_sigma;     // tolerance on albedo differences
+        const float     m_normal_sigma;     // tolerance on normal differences
+        const float     m_depth_sigma;      // tolerance on relative depth differences
+
+        explicit Parameters(const ParamArray& params);
+    };
+
+  private:
+    const Parameters                m_params;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_FRAMEDENOISER_H
@@ -32,26 +32,34 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/rendering/generic/tilecheckpoint.h"
 #include "renderer/kernel/rendering/generic/tilejob.h"
 #include "renderer/kernel/rendering/generic/tilejobfactory.h"
 #include "renderer/kernel/rendering/iframerenderer.h"
 #include "renderer/kernel/rendering/ipasscallback.h"
 #include "renderer/kernel/rendering/itilecallback.h"
 #include "renderer/kernel/rendering/itilerenderer.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/utility/renderstatistics.h"
 #include "renderer/utility/settingsparsing.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
 #include "foundation/math/hash.h"
+#include "foundation/platform/atomic.h"
 #include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/job.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <memory>
@@ -95,7 +103,7 @@ namespace
                     global_logger(),
                     m_job_queue,
                     m_params.m_thread_count,
-                    JobManager::KeepRunningOnEmptyQueue));
+                    JobManager::KeepRunningOnEmptyQueue | m_params.m_thread_affinity_flags));
 
             // Instantiate tile renderers, one per rendering thread.
             m_tile_renderers.reserve(m_params.m_thread_count);
@@ -110,6 +118,19 @@ namespace
                     m_tile_callbacks.push_back(tile_callback_factory->create());
             }
 
+            // Reuse tile rendering times from a previous render.
+            if (m_params.m_tile_ordering == TileJobFactory::CostOrdering && !m_params.m_tile_cost_file.empty())
+            {
+                if (m_tile_job_factory.load_tile_costs(m_frame.image().properties(), m_params.m_tile_cost_file))
+                    RENDERER_LOG_INFO("loaded tile costs from %s.", m_params.m_tile_cost_file.c_str());
+                else
+                    RENDERER_LOG_DEBUG("no usable tile costs in %s.", m_params.m_tile_cost_file.c_str());
+            }
+
+            // Record completed tiles so that interrupted renders can be resumed.
+            if (!m_params.m_checkpoint_file.empty())
+                m_checkpoint.reset(new TileCheckpoint(m_frame, m_params.m_checkpoint_file));
+
             RENDERER_LOG_INFO(
                 "rendering settings:\n"
                 "  sampling mode    %s\n"
@@ -168,11 +189,15 @@ namespace
                 new PassManagerFunc(
                     m_frame,
                     m_params.m_tile_ordering,
+                    m_params.m_tile_cost_file,
                     m_params.m_pass_count,
                     m_tile_renderers,
                     m_tile_callbacks,
                     m_pass_callback,
                     m_job_queue,
+                    m_tile_job_factory,
+                    m_checkpoint.get(),
+                    m_params.m_resume,
                     m_abort_switch,
                     m_is_rendering));
             ThreadFunctionWrapper<PassManagerFunc> wrapper(m_pass_manager_func.get());
@@ -204,6 +229,11 @@ namespace
             m_job_manager->resume();
         }
 
+        virtual void set_active_thread_count(const size_t thread_count) APPLESEED_OVERRIDE
+        {
+            m_job_manager->set_active_thread_count(thread_count);
+        }
+
         virtual void terminate_rendering() APPLESEED_OVERRIDE
         {
             stop_rendering();
@@ -211,17 +241,30 @@ namespace
             print_tile_renderers_stats();
         }
 
+        virtual double get_progress() const APPLESEED_OVERRIDE
+        {
+            return m_pass_manager_func.get() ? m_pass_manager_func->get_progress() : 0.0;
+        }
+
       private:
         struct Parameters
         {
             const size_t                        m_thread_count;     // number of rendering threads
+            const int                           m_thread_affinity_flags;    // job manager flags for thread affinity
             const TileJobFactory::TileOrdering  m_tile_ordering;    // tile rendering order
             const size_t                        m_pass_count;       // number of rendering passes
+            const string                        m_tile_cost_file;   // file storing tile rendering times across renders
+            const string                        m_checkpoint_file;  // file recording the tiles completed so far
+            const bool                          m_resume;           // continue from the checkpoint file if possible?
 
             explicit Parameters(const ParamArray& params)
               : m_thread_count(get_rendering_thread_count(params))
+              , m_thread_affinity_flags(get_rendering_thread_affinity_flags(params))
               , m_tile_ordering(get_tile_ordering(params))
               , m_pass_count(params.get_optional<size_t>("passes", 1))
+              , m_tile_cost_file(params.get_optional<string>("tile_cost_file", ""))
+              , m_checkpoint_file(params.get_optional<string>("checkpoint_file", ""))
+              , m_resume(params.get_optional<bool>("resume", false))
             {
             }
 
@@ -246,6 +289,10 @@ namespace
                 {
                     return TileJobFactory::RandomOrdering;
                 }
+                else if (tile_ordering == "cost")
+                {
+                    return TileJobFactory::CostOrdering;
+                }
                 else
                 {
                     RENDERER_LOG_ERROR(
@@ -266,29 +313,55 @@ namespace
             PassManagerFunc(
                 const Frame&                        frame,
                 const TileJobFactory::TileOrdering  tile_ordering,
+                const string&                       tile_cost_file,
                 const size_t                        pass_count,
                 vector<ITileRenderer*>&             tile_renderers,
                 vector<ITileCallback*>&             tile_callbacks,
                 IPassCallback*                      pass_callback,
                 JobQueue&                           job_queue,
+                TileJobFactory&                     tile_job_factory,
+                TileCheckpoint*                     checkpoint,
+                const bool                          resume,
                 IAbortSwitch&                       abort_switch,
                 bool&                               is_rendering)
               : m_frame(frame)
               , m_tile_ordering(tile_ordering)
+              , m_tile_cost_file(tile_cost_file)
               , m_pass_count(pass_count)
               , m_tile_renderers(tile_renderers)
               , m_tile_callbacks(tile_callbacks)
               , m_pass_callback(pass_callback)
               , m_job_queue(job_queue)
+              , m_tile_job_factory(tile_job_factory)
+              , m_checkpoint(checkpoint)
+              , m_resume(resume)
               , m_abort_switch(abort_switch)
               , m_is_rendering(is_rendering)
+              , m_current_pass(0)
+              , m_pass_tile_job_count(0)
             {
             }
 
             void operator()()
             {
-                for (size_t pass = 0; pass < m_pass_count && !m_abort_switch.is_aborted(); ++pass)
+                set_current_thread_name("pass_manager");
+                global_event_tracer().set_thread_name("pass_manager");
+
+                // Restore the tiles of an interrupted render.
+                size_t first_pass = 0;
+                vector<bool> completed_tiles;
+                if (m_checkpoint && m_resume)
+                    restore_checkpoint(first_pass, completed_tiles);
+
+                for (size_t pass = first_pass; pass < m_pass_count && !m_abort_switch.is_aborted(); ++pass)
                 {
+                    const bool resumed_pass = pass == first_pass && !completed_tiles.empty();
+
+                    m_current_pass = pass;
+                    m_pass_tile_job_count = 0;
+
+                    EventTraceScope trace_scope("rendering", "pass");
+
                     if (m_pass_count > 1)
                         RENDERER_LOG_INFO("--- beginning pass %s ---", pretty_uint(pass + 1).c_str());
 
@@ -297,9 +370,12 @@ namespace
                     {
                         assert(!m_job_queue.has_scheduled_or_running_jobs());
                         m_pass_callback->pre_render(m_frame, m_job_queue, m_abort_switch);
-                        assert(!m_job_queue.has_scheduled_or_running_jobs());
                     }
 
+                    // Start recording the tiles of this pass.
+                    if (m_checkpoint && !m_checkpoint->begin_pass(pass, resumed_pass))
+                        RENDERER_LOG_WARNING("failed to write checkpoint file, tiles will not be recorded.");
+
                     // Create tile jobs.
                     const uint32 pass_hash = hash_uint32(static_cast<uint32>(pass));
                     TileJobFactory::TileJobVector tile_jobs;
@@ -310,12 +386,21 @@ namespace
                         m_tile_callbacks,
                         pass_hash,
                         tile_jobs,
-                        m_abort_switch);
+                        m_abort_switch,
+                        m_checkpoint,
+                        resumed_pass ? &completed_tiles : 0);
 
                     // Schedule tile jobs.
                     for (const_each<TileJobFactory::TileJobVector> i = tile_jobs; i; ++i)
                         m_job_queue.schedule(*i);
 
+                    // Schedule one helper job per thread. Helper jobs come last: they let
+                    // threads that run out of tiles help finishing the tiles still in flight.
+                    for (size_t i = 0; i < m_tile_renderers.size(); ++i)
+                        m_job_queue.schedule(new TileHelperJob(m_tile_renderers, m_abort_switch));
+
+                    m_pass_tile_job_count = tile_jobs.size();
+
                     // Wait until tile jobs have effectively stopped.
                     m_job_queue.wait_until_completion();
 
@@ -328,20 +413,106 @@ namespace
                     }
                 }
 
+                if (!m_abort_switch.is_aborted())
+                    m_current_pass = m_pass_count;
+
+                // Save tile rendering times for subsequent renders.
+                if (m_tile_ordering == TileJobFactory::CostOrdering &&
+                    !m_tile_cost_file.empty() &&
+                    !m_abort_switch.is_aborted())
+                {
+                    if (!m_tile_job_factory.save_tile_costs(m_frame.image().properties(), m_tile_cost_file))
+                        RENDERER_LOG_WARNING("failed to write tile costs to %s.", m_tile_cost_file.c_str());
+                }
+
+                // The frame is complete: there is nothing left to resume.
+                if (m_checkpoint && !m_abort_switch.is_aborted())
+                    m_checkpoint->remove();
+
                 m_is_rendering = false;
             }
 
+            // Return the fraction of the frame rendered so far. Tiles are counted as
+            // rendered as soon as a thread picks them up.
+            double get_progress() const
+            {
+                const size_t pass = m_current_pass;
+                if (pass >= m_pass_count)
+                    return 1.0;
+
+                // Tile jobs of the current pass are not scheduled yet.
+                const size_t tile_job_count = m_pass_tile_job_count;
+                if (tile_job_count == 0)
+                    return static_cast<double>(pass) / m_pass_count;
+
+                // Helper jobs are scheduled after tile jobs, so they are the last to be picked up.
+                const size_t helper_job_count = m_tile_renderers.size();
+                const size_t scheduled_job_count = m_job_queue.get_scheduled_job_count();
+                const size_t remaining_tile_job_count =
+                    scheduled_job_count > helper_job_count
+                        ? min(scheduled_job_count - helper_job_count, tile_job_count)
+                        : 0;
+                const double pass_progress =
+                    1.0 - static_cast<double>(remaining_tile_job_count) / tile_job_count;
+
+                return (pass + pass_progress) / m_pass_count;
+            }
+
           private:
             const Frame&                            m_frame;
             const TileJobFactory::TileOrdering      m_tile_ordering;
+            const string                            m_tile_cost_file;
             vector<ITileRenderer*>&                 m_tile_renderers;
             vector<ITileCallback*>&                 m_tile_callbacks;
             IPassCallback*                          m_pass_callback;
             const size_t                            m_pass_count;
             JobQueue&                               m_job_queue;
+            TileJobFactory&                         m_tile_job_factory;
+            TileCheckpoint*                         m_checkpoint;
+            const bool                              m_resume;
             IAbortSwitch&                           m_abort_switch;
             bool&                                   m_is_rendering;
-            TileJobFactory                          m_tile_job_factory;
+            boost::atomic<size_t>                   m_current_pass;
+            boost::atomic<size_t>                   m_pass_tile_job_count;
+
+            void restore_checkpoint(size_t& first_pass, vector<bool>& completed_tiles)
+            {
+                size_t pass;
+                if (!m_checkpoint->restore(pass, completed_tiles) || pass >= m_pass_count)
+                {
+                    RENDERER_LOG_INFO("no usable checkpoint found, rendering from scratch.");
+                    completed_tiles.clear();
+                    return;
+                }
+
+                first_pass = pass;
+
+                const CanvasProperties& props = m_frame.image().properties();
+                size_t restored_tile_count = 0;
+
+                for (size_t i = 0; i < completed_tiles.size(); ++i)
+                {
+                    if (!completed_tiles[i])
+                        continue;
+
+                    ++restored_tile_count;
+
+                    // Present restored tiles as if they had just been rendered.
+                    if (!m_tile_callbacks.empty())
+                    {
+                        m_tile_callbacks[0]->post_render_tile(
+                            &m_frame,
+                            i % props.m_tile_count_x,
+                            i / props.m_tile_count_x);
+                    }
+                }
+
+                RENDERER_LOG_INFO(
+                    "resuming pass %s from checkpoint, %s of %s tiles already rendered.",
+                    pretty_uint(first_pass + 1).c_str(),
+                    pretty_uint(restored_tile_count).c_str(),
+                    pretty_uint(props.m_tile_count).c_str());
+            }
         };
 
         const Frame&                m_frame;            // target framebuffer
@@ -355,7 +526,8 @@ namespace
         vector<ITileCallback*>      m_tile_callbacks;   // tile callbacks, none or one per thread
         IPassCallback*              m_pass_callback;
 
-        TileJobFactory              m_tile_job_factory;
+        TileJobFactory              m_tile_job_factory;     // kept across renders to reuse tile costs
+        auto_ptr<TileCheckpoint>    m_checkpoint;
 
         bool                        m_is_rendering;
         auto_ptr<PassManagerFunc>   m_pass_manager_func;
@@ -371,6 +543,7 @@ namespace
                 stats.merge(m_tile_renderers[i]->get_statistics());
 
             RENDERER_LOG_DEBUG("%s", stats.to_string().c_str());
+            global_render_statistics().record(stats);
         }
     };
 }
@@ -442,7 +615,7 @@ Dictionary GenericFrameRendererFactory::get_params_metadata()
         "tile_ordering",
         Dictionary()
             .insert("type", "enum")
-            .insert("values", "linear|spiral|hilbert|random")
+            .insert("values", "linear|spiral|hilbert|random|cost")
             .insert("default", "spiral")
             .insert("label", "Tile Order")
             .insert("help", "Tile rendering order")
@@ -468,7 +641,36 @@ Dictionary GenericFrameRendererFactory::get_params_metadata()
                         "random",
                         Dictionary()
                             .insert("label", "Random")
-                            .insert("help", "Random tile ordering"))));
+                            .insert("help", "Random tile ordering"))
+                    .insert(
+                        "cost",
+                        Dictionary()
+                            .insert("label", "Cost")
+                            .insert("help", "Most expensive tiles first, based on the timings of the previous pass or render"))));
+
+    metadata.dictionaries().insert(
+        "tile_cost_file",
+        Dictionary()
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("label", "Tile Cost File")
+            .insert("help", "File in which tile rendering times are kept from one render to the next when using the cost tile ordering"));
+
+    metadata.dictionaries().insert(
+        "checkpoint_file",
+        Dictionary()
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("label", "Checkpoint File")
+            .insert("help", "File in which completed tiles are recorded so that an interrupted render can be resumed"));
+
+    metadata.dictionaries().insert(
+        "resume",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Resume")
+            .insert("help", "Continue an interrupted render from the checkpoint file"));
 
     return metadata;
 }
@@ -31,7 +31,9 @@
 #include "genericsamplegenerator.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/rendering/convergencemap.h"
 #include "renderer/kernel/rendering/isamplerenderer.h"
 #include "renderer/kernel/rendering/localsampleaccumulationbuffer.h"
 #include "renderer/kernel/rendering/pixelcontext.h"
@@ -51,7 +53,9 @@
 #include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
 #include <cassert>
@@ -75,12 +79,14 @@ namespace
         GenericSampleGenerator(
             const Frame&                    frame,
             ISampleRendererFactory*         sample_renderer_factory,
+            const ConvergenceMap*           convergence_map,
             const ParamArray&               params,
             const size_t                    generator_index,
             const size_t                    generator_count)
           : SampleGeneratorBase(generator_index, generator_count)
           , m_params(params)
           , m_frame(frame)
+          , m_convergence_map(convergence_map)
           , m_canvas_width(frame.image().properties().m_canvas_width)
           , m_canvas_height(frame.image().properties().m_canvas_height)
           , m_window_origin_x(static_cast<int>(frame.get_crop_window().min.x))
@@ -131,6 +137,7 @@ namespace
 
         const Parameters                    m_params;
         const Frame&                        m_frame;
+        const ConvergenceMap*               m_convergence_map;
         const size_t                        m_canvas_width;
         const size_t                        m_canvas_height;
         const int                           m_window_origin_x;
@@ -164,6 +171,13 @@ namespace
             if (x >= m_window_width || y >= m_window_height)
                 return 0;
 
+            // Skip samples that fall into pixels that have already converged.
+            if (m_convergence_map &&
+                m_convergence_map->is_converged(
+                    static_cast<size_t>(m_window_origin_x + x),
+                    static_cast<size_t>(m_window_origin_y + y)))
+                return 0;
+
             // Transform the sample position back to NDC. Full precision divisions are required
             // to ensure that the sample position indeed lies in the [0,1)^2 interval.
             const Vector2d sample_position(
@@ -173,7 +187,8 @@ namespace
             // Create a pixel context that identifies the pixel and sample currently being rendered.
             const PixelContext pixel_context(
                 Vector2i(m_window_origin_x + x, m_window_origin_y + y),
-                sample_position);
+                sample_position,
+                sequence_index);
 
             // Create a sampling context. We start with an initial dimension of 2,
             // corresponding to the Halton sequence used for the sample positions.
@@ -229,6 +244,31 @@ GenericSampleGeneratorFactory::GenericSampleGeneratorFactory(
   : m_frame(frame)
   , m_sample_renderer_factory(sample_renderer_factory)
   , m_params(params)
+{
+    const float noise_threshold = params.get_optional<float>("noise_threshold", 0.0f);
+
+    if (noise_threshold > 0.0f)
+    {
+        const CanvasProperties& props = frame.image().properties();
+        const size_t min_samples = params.get_optional<size_t>("min_samples", 16);
+
+        m_convergence_map.reset(
+            new ConvergenceMap(
+                props.m_canvas_width,
+                props.m_canvas_height,
+                frame.get_crop_window(),
+                noise_threshold,
+                min_samples));
+
+        RENDERER_LOG_INFO(
+            "adaptive sampling enabled: noise threshold %s, minimum %s sample%s per pixel.",
+            pretty_scalar(noise_threshold, 4).c_str(),
+            pretty_uint(min_samples).c_str(),
+            min_samples > 1 ? "s" : "");
+    }
+}
+
+GenericSampleGeneratorFactory::~GenericSampleGeneratorFactory()
 {
 }
 
@@ -245,6 +285,7 @@ ISampleGenerator* GenericSampleGeneratorFactory::create(
         new GenericSampleGenerator(
             m_frame,
             m_sample_renderer_factory,
+            m_convergence_map.get(),
             m_params,
             generator_index,
             generator_count);
@@ -258,7 +299,33 @@ SampleAccumulationBuffer* GenericSampleGeneratorFactory::create_sample_accumulat
         new LocalSampleAccumulationBuffer(
             props.m_canvas_width,
             props.m_canvas_height,
-            m_frame.get_filter());
+            m_frame.get_crop_window(),
+            m_frame.get_filter(),
+            m_convergence_map.get(),
+            m_frame.get_pixel_statistics());
+}
+
+Dictionary GenericSampleGeneratorFactory::get_params_metadata()
+{
+    Dictionary metadata;
+
+    metadata.dictionaries().insert(
+        "noise_threshold",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.0")
+            .insert("label", "Noise Threshold")
+            .insert("help", "Stop sampling image regions whose relative noise level falls below this threshold (0 disables adaptive sampling)"));
+
+    metadata.dictionaries().insert(
+        "min_samples",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "16")
+            .insert("label", "Min Samples")
+            .insert("help", "Minimum number of samples per pixel before a region can be considered converged"));
+
+    return metadata;
 }
 
 }   // namespace renderer
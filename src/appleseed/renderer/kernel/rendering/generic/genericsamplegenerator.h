@@ -39,11 +39,14 @@
 
 // Standard headers.
 #include <cstddef>
+#include <memory>
 
 // Forward declarations.
-namespace renderer  { class Frame; }
-namespace renderer  { class ISampleRendererFactory; }
-namespace renderer  { class SampleAccumulationBuffer; }
+namespace foundation    { class Dictionary; }
+namespace renderer      { class ConvergenceMap; }
+namespace renderer      { class Frame; }
+namespace renderer      { class ISampleRendererFactory; }
+namespace renderer      { class SampleAccumulationBuffer; }
 
 namespace renderer
 {
@@ -58,6 +61,12 @@ class GenericSampleGeneratorFactory
         ISampleRendererFactory* sample_renderer_factory,
         const ParamArray&       params);
 
+    // Destructor.
+    ~GenericSampleGeneratorFactory();
+
+    // Return parameters metadata.
+    static foundation::Dictionary get_params_metadata();
+
     // Delete this instance.
     virtual void release() APPLESEED_OVERRIDE;
 
@@ -70,9 +79,10 @@ class GenericSampleGeneratorFactory
     virtual SampleAccumulationBuffer* create_sample_accumulation_buffer() APPLESEED_OVERRIDE;
 
   private:
-    const Frame&                m_frame;
-    ISampleRendererFactory*     m_sample_renderer_factory;
-    const ParamArray            m_params;
+    const Frame&                    m_frame;
+    ISampleRendererFactory*         m_sample_renderer_factory;
+    const ParamArray                m_params;
+    std::auto_ptr<ConvergenceMap>   m_convergence_map;
 };
 
 }       // namespace renderer
@@ -33,11 +33,16 @@
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/aov/imagestack.h"
+#include "renderer/kernel/aov/objectidbuffer.h"
 #include "renderer/kernel/aov/spectrumstack.h"
 #include "renderer/kernel/intersection/intersector.h"
 #include "renderer/kernel/intersection/tracecontext.h"
 #include "renderer/kernel/lighting/ilightingengine.h"
+#include "renderer/kernel/lighting/scatteringmode.h"
 #include "renderer/kernel/lighting/tracer.h"
+#include "renderer/kernel/rendering/pixelcontext.h"
+#include "renderer/kernel/rendering/primaryhitcache.h"
 #include "renderer/kernel/shading/oslshadergroupexec.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingengine.h"
@@ -46,15 +51,21 @@
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/kernel/shading/shadingresult.h"
 #include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/modeling/bsdf/bsdf.h"
 #include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/material/material.h"
 #include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/hotpathcounters.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/image/image.h"
 #include "foundation/image/regularspectrum.h"
+#include "foundation/math/basis.h"
+#include "foundation/math/dual.h"
+#include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/arena.h"
@@ -62,6 +73,7 @@
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cstddef>
 #include <limits>
 #include <string>
@@ -85,6 +97,9 @@ namespace
     // the requested tile could be found in the cache or not.
     #undef DEBUG_DISPLAY_TEXTURE_CACHE_PERFORMANCES
 
+    // Maximum number of camera rays generated and traced together.
+    const size_t CameraRayBatchSize = 16;
+
     class GenericSampleRenderer
       : public ISampleRenderer
     {
@@ -98,6 +113,7 @@ namespace
             ShadingEngine&          shading_engine,
             OIIO::TextureSystem&    oiio_texture_system,
             OSL::ShadingSystem&     shading_system,
+            PrimaryHitCache*        primary_hit_cache,
             const size_t            thread_index,
             const ParamArray&       params)
           : m_params(params)
@@ -110,6 +126,9 @@ namespace
           , m_oiio_texture_system(oiio_texture_system)
           , m_shadergroup_exec(shading_system, m_arena)
           , m_thread_index(thread_index)
+          , m_primary_hit_cache(primary_hit_cache)
+          , m_restored_hit_count(0)
+          , m_cached_sample_count(0)
           , m_intersector(
                 trace_context,
                 m_texture_cache,
@@ -138,6 +157,16 @@ namespace
             const CanvasProperties& c = frame.image().properties();
             m_image_point_dx = Vector2d(1.0 / (4.0 * c.m_canvas_width), 0.0);
             m_image_point_dy = Vector2d(0.0, -1.0 / (4.0 * c.m_canvas_height));
+
+            // Feature AOVs are only present when the frame is denoised.
+            const ImageStack& aov_images = frame.aov_images();
+            m_depth_aov_index = aov_images.get_index("depth");
+            m_normal_aov_index = aov_images.get_index("normal");
+            m_albedo_aov_index = aov_images.get_index("albedo");
+            m_store_feature_aovs = frame.is_denoising_enabled();
+
+            // The object ID buffer is only present when picking is needed.
+            m_object_ids = frame.get_object_id_buffer();
         }
 
         ~GenericSampleRenderer()
@@ -156,13 +185,6 @@ namespace
             const Vector2d&         image_point,
             ShadingResult&          shading_result) APPLESEED_OVERRIDE
         {
-#ifdef DEBUG_DISPLAY_TEXTURE_CACHE_PERFORMANCES
-
-            const uint64 last_texture_cache_hit_count = m_texture_cache.get_hit_count();
-            const uint64 last_texture_cache_miss_count = m_texture_cache.get_miss_count();
-
-#endif
-
             // Construct a primary ray.
             ShadingRay primary_ray;
             m_scene.get_active_camera()->spawn_ray(
@@ -170,11 +192,147 @@ namespace
                 Dual2d(image_point, m_image_point_dx, m_image_point_dy),
                 primary_ray);
 
+            render_ray(
+                sampling_context,
+                pixel_context,
+                primary_ray,
+                0,
+                shading_result);
+        }
+
+        virtual void render_samples(
+            const size_t            sample_count,
+            SamplingContext*        sampling_contexts,
+            const Vector2i&         pixel_coords,
+            const Vector2d*         image_points,
+            ShadingResult*          shading_results) APPLESEED_OVERRIDE
+        {
+            const Camera* camera = m_scene.get_active_camera();
+
+            for (size_t first = 0; first < sample_count; first += CameraRayBatchSize)
+            {
+                const size_t batch_size = min(sample_count - first, CameraRayBatchSize);
+
+                // Generate the camera rays of the batch together.
+                Dual2d ndcs[CameraRayBatchSize];
+                for (size_t i = 0; i < batch_size; ++i)
+                    ndcs[i] = Dual2d(image_points[first + i], m_image_point_dx, m_image_point_dy);
+                ShadingRay camera_rays[CameraRayBatchSize];
+                camera->spawn_rays(batch_size, sampling_contexts + first, ndcs, camera_rays);
+
+                // Camera rays are coherent: let them traverse the assembly tree together.
+                for (size_t i = 0; i < batch_size; ++i)
+                    m_camera_hits[i].clear();
+                m_intersector.trace_batch(batch_size, camera_rays, m_camera_hits);
+
+                // Shade the samples one by one.
+                for (size_t i = 0; i < batch_size; ++i)
+                {
+                    render_ray(
+                        sampling_contexts[first + i],
+                        PixelContext(pixel_coords, image_points[first + i]),
+                        camera_rays[i],
+                        &m_camera_hits[i],
+                        shading_results[first + i]);
+                }
+            }
+        }
+
+        virtual uint64 get_ray_count() const APPLESEED_OVERRIDE
+        {
+            return m_intersector.get_ray_count();
+        }
+
+        virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
+        {
+            StatisticsVector stats;
+            stats.merge(m_texture_cache.get_statistics());
+            stats.merge(m_intersector.get_statistics());
+            stats.merge(m_lighting_engine->get_statistics());
+
+            if (m_primary_hit_cache)
+            {
+                Statistics cache_stats;
+                cache_stats.insert<uint64>("cached samples", m_cached_sample_count);
+                cache_stats.insert_percent("restored hits", m_restored_hit_count, m_cached_sample_count);
+                stats.insert("primary hit cache statistics", cache_stats);
+            }
+
+            return stats;
+        }
+
+      private:
+        struct Parameters
+        {
+            const float     m_transparency_threshold;
+            const size_t    m_max_iterations;
+            const bool      m_report_self_intersections;
+
+            explicit Parameters(const ParamArray& params)
+              : m_transparency_threshold(params.get_optional<float>("transparency_threshold", 0.001f))
+              , m_max_iterations(params.get_optional<size_t>("max_iterations", 1000))
+              , m_report_self_intersections(params.get_optional<bool>("report_self_intersections", false))
+            {
+            }
+        };
+
+        const Parameters            m_params;
+        const Scene&                m_scene;
+        const LightingConditions&   m_lighting_conditions;
+        const float                 m_opacity_threshold;
+        TextureCache                m_texture_cache;
+        ILightingEngine*            m_lighting_engine;
+        ShadingEngine&              m_shading_engine;
+        OIIO::TextureSystem&        m_oiio_texture_system;
+        const size_t                m_thread_index;
+
+        Arena                       m_arena;
+        OSLShaderGroupExec          m_shadergroup_exec;
+        PrimaryHitCache*            m_primary_hit_cache;
+        uint64                      m_restored_hit_count;
+        uint64                      m_cached_sample_count;
+        const Intersector           m_intersector;
+        Tracer                      m_tracer;
+        const ShadingContext        m_shading_context;
+
+        Vector2d                    m_image_point_dx;
+        Vector2d                    m_image_point_dy;
+        ShadingPoint                m_camera_hits[CameraRayBatchSize];
+
+        bool                        m_store_feature_aovs;
+        ObjectIDBuffer*             m_object_ids;
+        size_t                      m_depth_aov_index;
+        size_t                      m_normal_aov_index;
+        size_t                      m_albedo_aov_index;
+
+        void render_ray(
+            SamplingContext&        sampling_context,
+            const PixelContext&     pixel_context,
+            ShadingRay&             primary_ray,
+            const ShadingPoint*     camera_hit,
+            ShadingResult&          shading_result)
+        {
+#ifdef DEBUG_DISPLAY_TEXTURE_CACHE_PERFORMANCES
+
+            const uint64 last_texture_cache_hit_count = m_texture_cache.get_hit_count();
+            const uint64 last_texture_cache_miss_count = m_texture_cache.get_miss_count();
+
+#endif
+
             ShadingPoint shading_points[2];
             size_t shading_point_index = 0;
             const ShadingPoint* shading_point_ptr = 0;
             size_t iterations = 0;
 
+            // Only indexed samples can be looked up in the primary hit cache.
+            const size_t sample_index = pixel_context.get_sample_index();
+            PrimaryHitCache* primary_hit_cache =
+                sample_index != PixelContext::NoSampleIndex &&
+                m_primary_hit_cache &&
+                sample_index < m_primary_hit_cache->get_capacity()
+                    ? m_primary_hit_cache
+                    : 0;
+
             while (true)
             {
                 // Put a hard limit on the number of iterations.
@@ -188,12 +346,39 @@ namespace
 
                 m_arena.clear();
 
-                // Trace the ray.
+                // Trace the ray, or retrieve the hit of the camera ray, traced with the other
+                // camera rays of its batch or restored from the primary hit cache.
                 shading_points[shading_point_index].clear();
-                m_intersector.trace(
-                    primary_ray,
-                    shading_points[shading_point_index],
-                    shading_point_ptr);
+                if (iterations == 1 && camera_hit)
+                    shading_points[shading_point_index] = *camera_hit;
+                else if (iterations == 1 && primary_hit_cache)
+                {
+                    ++m_cached_sample_count;
+
+                    if (primary_hit_cache->restore(
+                            sample_index,
+                            primary_ray,
+                            m_intersector,
+                            shading_points[shading_point_index]))
+                        ++m_restored_hit_count;
+                    else
+                    {
+                        m_intersector.trace(
+                            primary_ray,
+                            shading_points[shading_point_index],
+                            shading_point_ptr);
+                        primary_hit_cache->store(
+                            sample_index,
+                            shading_points[shading_point_index]);
+                    }
+                }
+                else
+                {
+                    m_intersector.trace(
+                        primary_ray,
+                        shading_points[shading_point_index],
+                        shading_point_ptr);
+                }
 
                 // Update the pointers to the shading points.
                 shading_point_ptr = &shading_points[shading_point_index];
@@ -221,10 +406,47 @@ namespace
                         shading_point_ptr->hit()
                             ? shading_point_ptr->get_distance()
                             : -1.0;
+
+                    // Store the features used by the denoiser.
+                    if (m_store_feature_aovs && shading_point_ptr->hit())
+                        store_feature_aovs(*shading_point_ptr, shading_result);
+
+                    // Record the entities hit by the primary ray for picking.
+                    if (m_object_ids && shading_point_ptr->hit())
+                        m_object_ids->store(pixel_context.get_pixel_coords(), *shading_point_ptr);
+                }
+                else if (shading_point_ptr->hit())
+                {
+                    // Evaluate the opacity of the intersection point alone first:
+                    // compositing a fully transparent surface would be a no-op.
+                    Alpha opacity;
+                    m_shading_context.evaluate_opacity(*shading_point_ptr, opacity);
+
+                    if (opacity[0] > 0.0f || shading_point_ptr->shade_alpha_cutouts())
+                    {
+                        // Shade the intersection point.
+                        ShadingResult local_result(shading_result.m_aovs.size());
+                        m_shading_engine.shade_hit_point(
+                            sampling_context,
+                            pixel_context,
+                            m_shading_context,
+                            *shading_point_ptr,
+                            opacity,
+                            local_result);
+
+                        // Transform the result to the linear RGB color space.
+                        local_result.transform_to_linear_rgb(m_lighting_conditions);
+
+                        // Apply alpha premultiplication.
+                        local_result.apply_alpha_premult_linear_rgb();
+
+                        // Compositing.
+                        shading_result.composite_over_linear_rgb(local_result);
+                    }
                 }
                 else
                 {
-                    // Shade the intersection point.
+                    // Shade the environment.
                     ShadingResult local_result(shading_result.m_aovs.size());
                     m_shading_engine.shade(
                         sampling_context,
@@ -236,10 +458,6 @@ namespace
                     // Transform the result to the linear RGB color space.
                     local_result.transform_to_linear_rgb(m_lighting_conditions);
 
-                    // Apply alpha premultiplication.
-                    if (shading_point_ptr->hit())
-                        local_result.apply_alpha_premult_linear_rgb();
-
                     // Compositing.
                     shading_result.composite_over_linear_rgb(local_result);
                 }
@@ -287,48 +505,75 @@ namespace
 #endif
         }
 
-        virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
+        void store_feature_aovs(
+            const ShadingPoint&     shading_point,
+            ShadingResult&          shading_result)
         {
-            StatisticsVector stats;
-            stats.merge(m_texture_cache.get_statistics());
-            stats.merge(m_intersector.get_statistics());
-            stats.merge(m_lighting_engine->get_statistics());
-            return stats;
-        }
-
-      private:
-        struct Parameters
-        {
-            const float     m_transparency_threshold;
-            const size_t    m_max_iterations;
-            const bool      m_report_self_intersections;
-
-            explicit Parameters(const ParamArray& params)
-              : m_transparency_threshold(params.get_optional<float>("transparency_threshold", 0.001f))
-              , m_max_iterations(params.get_optional<size_t>("max_iterations", 1000))
-              , m_report_self_intersections(params.get_optional<bool>("report_self_intersections", false))
+            ShadingFragment fragment;
+            fragment.m_alpha.set(1.0f);
+
+            // Depth.
+            fragment.m_color = Spectrum(Color3f(static_cast<float>(shading_point.get_distance())));
+            shading_result.m_aovs.set(m_depth_aov_index, fragment);
+
+            // Shading normal, remapped to [0, 1] since AOVs cannot hold negative values.
+            const Vector3f n(shading_point.get_shading_normal());
+            fragment.m_color = Spectrum(Color3f(0.5f * (n.x + 1.0f), 0.5f * (n.y + 1.0f), 0.5f * (n.z + 1.0f)));
+            shading_result.m_aovs.set(m_normal_aov_index, fragment);
+
+            // Albedo, approximated by the BSDF value for normal incidence scaled by Pi,
+            // which is exact for Lambertian surfaces.
+            fragment.m_color = Spectrum(Color3f(0.0f));
+            const Material* material = shading_point.get_material();
+            if (material)
             {
-            }
-        };
+                const Material::RenderData& material_data = material->get_render_data();
 
-        const Parameters            m_params;
-        const Scene&                m_scene;
-        const LightingConditions&   m_lighting_conditions;
-        const float                 m_opacity_threshold;
-        TextureCache                m_texture_cache;
-        ILightingEngine*            m_lighting_engine;
-        ShadingEngine&              m_shading_engine;
-        OIIO::TextureSystem&        m_oiio_texture_system;
-        const size_t                m_thread_index;
-
-        Arena                       m_arena;
-        OSLShaderGroupExec          m_shadergroup_exec;
-        const Intersector           m_intersector;
-        Tracer                      m_tracer;
-        const ShadingContext        m_shading_context;
+                if (material_data.m_shader_group)
+                {
+                    m_shading_context.execute_osl_shading(
+                        *material_data.m_shader_group,
+                        shading_point);
+                }
 
-        Vector2d                    m_image_point_dx;
-        Vector2d                    m_image_point_dy;
+                if (material_data.m_bsdf)
+                {
+                    const void* data =
+                        material_data.m_bsdf->evaluate_inputs(m_shading_context, shading_point);
+
+                    const Vector3f outgoing(normalize(-shading_point.get_ray().m_dir));
+                    const Basis3f shading_basis(shading_point.get_shading_basis());
+                    const Vector3f incoming =
+                        dot(outgoing, shading_basis.get_normal()) < 0.0f
+                            ? -shading_basis.get_normal()
+                            : shading_basis.get_normal();
+
+                    APPLESEED_HOT_PATH_COUNT(hot_path_counters().m_bsdf_evaluations.increment(material_data.m_bsdf->get_model()));
+                    Spectrum value;
+                    const float pdf =
+                        material_data.m_bsdf->evaluate(
+                            data,
+                            false,
+                            false,
+                            Vector3f(shading_point.get_geometric_normal()),
+                            shading_basis,
+                            outgoing,
+                            incoming,
+                            ScatteringMode::All,
+                            value);
+
+                    if (pdf > 0.0f)
+                    {
+                        const Color3f albedo =
+                            value.is_spectral()
+                                ? ciexyz_to_linear_rgb(spectrum_to_ciexyz<float>(m_lighting_conditions, value))
+                                : Color3f(value[0], value[1], value[2]);
+                        fragment.m_color = Spectrum(saturate(albedo * Pi<float>()));
+                    }
+                }
+            }
+            shading_result.m_aovs.set(m_albedo_aov_index, fragment);
+        }
     };
 }
 
@@ -346,6 +591,7 @@ GenericSampleRendererFactory::GenericSampleRendererFactory(
     ShadingEngine&          shading_engine,
     OIIO::TextureSystem&    oiio_texture_system,
     OSL::ShadingSystem&     shading_system,
+    PrimaryHitCache*        primary_hit_cache,
     const ParamArray&       params)
   : m_scene(scene)
   , m_frame(frame)
@@ -355,6 +601,7 @@ GenericSampleRendererFactory::GenericSampleRendererFactory(
   , m_shading_engine(shading_engine)
   , m_oiio_texture_system(oiio_texture_system)
   , m_shading_system(shading_system)
+  , m_primary_hit_cache(primary_hit_cache)
   , m_params(params)
 {
 }
@@ -376,6 +623,7 @@ ISampleRenderer* GenericSampleRendererFactory::create(const size_t thread_index)
             m_shading_engine,
             m_oiio_texture_system,
             m_shading_system,
+            m_primary_hit_cache,
             thread_index,
             m_params);
 }
@@ -52,6 +52,7 @@ END_OIIO_INCLUDES
 // Forward declarations.
 namespace renderer  { class Frame; }
 namespace renderer  { class ILightingEngineFactory; }
+namespace renderer  { class PrimaryHitCache; }
 namespace renderer  { class Scene; }
 namespace renderer  { class ShadingEngine; }
 namespace renderer  { class TextureStore; }
@@ -68,7 +69,7 @@ class GenericSampleRendererFactory
   : public ISampleRendererFactory
 {
   public:
-    // Constructor.
+    // Constructor. primary_hit_cache may be 0.
     GenericSampleRendererFactory(
         const Scene&            scene,
         const Frame&            frame,
@@ -78,6 +79,7 @@ class GenericSampleRendererFactory
         ShadingEngine&          shading_engine,
         OIIO::TextureSystem&    oiio_texture_system,
         OSL::ShadingSystem&     shading_system,
+        PrimaryHitCache*        primary_hit_cache,
         const ParamArray&       params);
 
     // Delete this instance.
@@ -96,6 +98,7 @@ class GenericSampleRendererFactory
     ShadingEngine&              m_shading_engine;
     OIIO::TextureSystem&        m_oiio_texture_system;
     OSL::ShadingSystem&         m_shading_system;
+    PrimaryHitCache*            m_primary_hit_cache;
     const ParamArray            m_params;
 };
 
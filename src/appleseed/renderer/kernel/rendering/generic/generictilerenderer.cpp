@@ -33,16 +33,19 @@
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/aov/aovsettings.h"
 #include "renderer/kernel/aov/imagestack.h"
 #include "renderer/kernel/aov/tilestack.h"
 #include "renderer/kernel/rendering/ipixelrenderer.h"
 #include "renderer/kernel/rendering/ishadingresultframebufferfactory.h"
 #include "renderer/kernel/rendering/pixelcontext.h"
 #include "renderer/kernel/rendering/shadingresultframebuffer.h"
+#include "renderer/kernel/rendering/shadingresultframebufferpool.h"
 #include "renderer/modeling/frame/frame.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
 #include "foundation/image/image.h"
 #include "foundation/image/tile.h"
 #include "foundation/math/aabb.h"
@@ -53,6 +56,8 @@
 #include "foundation/math/vector.h"
 #include "foundation/platform/arch.h"
 #include "foundation/platform/breakpoint.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/timers.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/iostreamop.h"
@@ -60,7 +65,11 @@
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/string.h"
 
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <memory>
@@ -73,6 +82,162 @@ using namespace std;
 namespace renderer
 {
 
+namespace
+{
+    //
+    // A tile being rendered, split into chunks of pixels that several threads can render.
+    //
+    // The thread that owns the tile renders chunks in order. Other threads may render
+    // the remaining chunks into private framebuffers that the owner merges at the end.
+    //
+
+    // Number of chunks in a tile when tile splitting is enabled.
+    const size_t TileChunkCount = 16;
+
+    struct SharedTile
+      : public NonCopyable
+    {
+        const Frame&                            m_frame;
+        const size_t                            m_tile_x;
+        const size_t                            m_tile_y;
+        const size_t                            m_pass_hash;
+        AABB2i                                  m_tile_bbox;            // in tile space
+        AABB2i                                  m_padded_tile_bbox;     // in tile space
+        int                                     m_tile_origin_x;
+        int                                     m_tile_origin_y;
+        Tile*                                   m_cost_tile;            // render time and ray count per pixel, or 0
+        size_t                                  m_chunk_count;
+        boost::atomic<size_t>                   m_next_chunk;
+        boost::atomic<size_t>                   m_helper_count;
+        boost::mutex                            m_mutex;
+        vector<ShadingResultFrameBuffer*>       m_helper_framebuffers;
+
+        SharedTile(
+            const Frame&                        frame,
+            const size_t                        tile_x,
+            const size_t                        tile_y,
+            const size_t                        pass_hash)
+          : m_frame(frame)
+          , m_tile_x(tile_x)
+          , m_tile_y(tile_y)
+          , m_pass_hash(pass_hash)
+          , m_cost_tile(0)
+          , m_chunk_count(1)
+          , m_next_chunk(0)
+          , m_helper_count(0)
+        {
+        }
+
+        ~SharedTile()
+        {
+            for (size_t i = 0; i < m_helper_framebuffers.size(); ++i)
+                delete m_helper_framebuffers[i];
+        }
+
+        bool has_remaining_chunks() const
+        {
+            return m_next_chunk.load() < m_chunk_count;
+        }
+
+        void add_helper_framebuffer(ShadingResultFrameBuffer* framebuffer)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_helper_framebuffers.push_back(framebuffer);
+        }
+
+        // Only called by the owner once all helper threads are done.
+        void merge_helper_framebuffers(
+            ShadingResultFrameBuffer&           framebuffer,
+            ShadingResultFrameBufferPool&       pool)
+        {
+            for (size_t i = 0; i < m_helper_framebuffers.size(); ++i)
+            {
+                const ShadingResultFrameBuffer& source = *m_helper_framebuffers[i];
+
+                for (size_t y = 0; y < framebuffer.get_height(); ++y)
+                {
+                    for (size_t x = 0; x < framebuffer.get_width(); ++x)
+                        framebuffer.merge(x, y, source, x, y, 1.0f);
+                }
+
+                pool.release(m_helper_framebuffers[i]);
+            }
+
+            m_helper_framebuffers.clear();
+        }
+    };
+}
+
+
+//
+// The timer used to measure the render time of pixels for the cost AOVs.
+//
+
+class PixelCostTimer
+#ifdef APPLESEED_X86
+  : public X86Timer
+#else
+  : public DefaultProcessorTimer
+#endif
+{
+};
+
+
+//
+// The list of tiles in flight that are shared by the tile renderers of a factory.
+//
+
+class SharedTileList
+  : public NonCopyable
+{
+  public:
+    void insert(SharedTile* tile)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_tiles.push_back(tile);
+    }
+
+    // Once this method returns, no helper thread can acquire the tile anymore.
+    void remove(SharedTile* tile)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_tiles.erase(find(m_tiles.begin(), m_tiles.end(), tile));
+    }
+
+    // Return a tile with remaining chunks, or 0 if there is none.
+    SharedTile* acquire()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        for (size_t i = 0; i < m_tiles.size(); ++i)
+        {
+            if (m_tiles[i]->has_remaining_chunks())
+            {
+                ++m_tiles[i]->m_helper_count;
+                return m_tiles[i];
+            }
+        }
+
+        return 0;
+    }
+
+    void release(SharedTile* tile)
+    {
+        --tile->m_helper_count;
+    }
+
+    // Private framebuffers of helper threads, recycled across tiles and passes.
+    ShadingResultFrameBufferPool& framebuffer_pool()
+    {
+        return m_framebuffer_pool;
+    }
+
+  private:
+    boost::mutex                    m_mutex;
+    vector<SharedTile*>             m_tiles;
+    ShadingResultFrameBufferPool    m_framebuffer_pool;
+};
+
 namespace
 {
     //
@@ -95,13 +260,31 @@ namespace
             const Frame&                        frame,
             IPixelRendererFactory*              pixel_renderer_factory,
             IShadingResultFrameBufferFactory*   framebuffer_factory,
+            SharedTileList*                     shared_tiles,
+            PixelCostTimer*                     cost_timer,
             const ParamArray&                   params,
             const size_t                        thread_index)
           : m_pixel_renderer(pixel_renderer_factory->create(thread_index))
           , m_framebuffer_factory(framebuffer_factory)
+          , m_shared_tiles(shared_tiles)
+          , m_cost_timer(cost_timer)
+          , m_render_time_aov_index(~0)
+          , m_ray_count_aov_index(~0)
         {
             compute_tile_margins(frame, thread_index == 0);
             compute_pixel_ordering(frame);
+
+            // Diagnostics of the pixel renderer are stored by the tile owner in on_tile_end()
+            // and would miss the pixels rendered by helper threads: don't split tiles then.
+            if (m_shared_tiles && m_pixel_renderer->has_tile_diagnostics())
+            {
+                if (thread_index == 0)
+                    RENDERER_LOG_INFO("tile splitting disabled since pixel renderer diagnostics are enabled.");
+                m_shared_tiles = 0;
+            }
+
+            if (m_cost_timer)
+                create_cost_aovs(frame, thread_index == 0);
         }
 
         virtual void release() APPLESEED_OVERRIDE
@@ -116,16 +299,139 @@ namespace
             const size_t    pass_hash,
             IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE
         {
-            // Retrieve frame properties.
-            const CanvasProperties& frame_properties = frame.image().properties();
-            assert(tile_x < frame_properties.m_tile_count_x);
-            assert(tile_y < frame_properties.m_tile_count_y);
+            assert(tile_x < frame.image().properties().m_tile_count_x);
+            assert(tile_y < frame.image().properties().m_tile_count_y);
 
             // Retrieve tile properties.
             Tile& tile = frame.image().tile(tile_x, tile_y);
             TileStack aov_tiles = frame.aov_images().tiles(tile_x, tile_y);
-            const int tile_origin_x = static_cast<int>(frame_properties.m_tile_width * tile_x);
-            const int tile_origin_y = static_cast<int>(frame_properties.m_tile_height * tile_y);
+
+            // Compute the bounding boxes of the pixels to render.
+            SharedTile shared_tile(frame, tile_x, tile_y, pass_hash);
+            if (!compute_tile_bboxes(shared_tile))
+                return;
+
+            // Inform the pixel renderer that we are about to render a tile.
+            m_pixel_renderer->on_tile_begin(frame, tile, aov_tiles);
+
+            // Let the threads rendering this tile record the cost of its pixels.
+            if (m_cost_timer)
+                shared_tile.m_cost_tile = &prepare_cost_tile(tile);
+
+            // Create the framebuffer into which we will accumulate the samples.
+            ShadingResultFrameBuffer* framebuffer =
+                m_framebuffer_factory->create(
+                    frame,
+                    tile_x,
+                    tile_y,
+                    shared_tile.m_tile_bbox);
+            assert(framebuffer);
+
+            // Let other threads render chunks of this tile once they run out of tiles.
+            shared_tile.m_chunk_count = m_shared_tiles ? TileChunkCount : 1;
+            if (m_shared_tiles)
+                m_shared_tiles->insert(&shared_tile);
+
+            // Render chunks of the tile until all chunks are rendered or taken by other threads.
+            render_chunks(shared_tile, tile, aov_tiles, *framebuffer, abort_switch);
+
+            if (m_shared_tiles)
+            {
+                // Wait until the other threads are done with this tile and merge their samples.
+                m_shared_tiles->remove(&shared_tile);
+                while (shared_tile.m_helper_count.load() > 0)
+                    foundation::yield();
+                shared_tile.merge_helper_framebuffers(*framebuffer, m_shared_tiles->framebuffer_pool());
+            }
+
+            // Cancel any work done on this tile if rendering is aborted.
+            if (abort_switch.is_aborted())
+            {
+                m_framebuffer_factory->destroy(framebuffer);
+                return;
+            }
+
+            // Develop the framebuffer to the tile.
+            if (frame.is_premultiplied_alpha())
+                framebuffer->develop_to_tile_premult_alpha(tile, aov_tiles);
+            else framebuffer->develop_to_tile_straight_alpha(tile, aov_tiles);
+
+            // Release the framebuffer.
+            m_framebuffer_factory->destroy(framebuffer);
+
+            // Store pixel costs into their AOVs once the framebuffer has been developed.
+            if (m_cost_timer)
+                write_cost_aovs(aov_tiles);
+
+            // Inform the pixel renderer that we are done rendering the tile.
+            m_pixel_renderer->on_tile_end(frame, tile, aov_tiles);
+        }
+
+        virtual void help_render_tiles(
+            IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE
+        {
+            if (m_shared_tiles == 0)
+                return;
+
+            while (!abort_switch.is_aborted())
+            {
+                // Find a tile in flight that still has chunks to render.
+                SharedTile* shared_tile = m_shared_tiles->acquire();
+                if (shared_tile == 0)
+                    break;
+
+                const Frame& frame = shared_tile->m_frame;
+                Tile& tile = frame.image().tile(shared_tile->m_tile_x, shared_tile->m_tile_y);
+                TileStack aov_tiles = frame.aov_images().tiles(shared_tile->m_tile_x, shared_tile->m_tile_y);
+
+                // Helpers never call on_tile_end(): the pixel renderer has no tile diagnostics.
+                assert(!m_pixel_renderer->has_tile_diagnostics());
+                m_pixel_renderer->on_tile_begin(frame, tile, aov_tiles);
+
+                // Accumulate samples into a private framebuffer; the tile owner merges it.
+                ShadingResultFrameBuffer* framebuffer =
+                    m_shared_tiles->framebuffer_pool().acquire(
+                        tile.get_width(),
+                        tile.get_height(),
+                        frame.aov_images().size(),
+                        AABB2u(shared_tile->m_tile_bbox),
+                        frame.get_filter());
+                framebuffer->clear();
+
+                render_chunks(*shared_tile, tile, aov_tiles, *framebuffer, abort_switch);
+
+                shared_tile->add_helper_framebuffer(framebuffer);
+                m_shared_tiles->release(shared_tile);
+            }
+        }
+
+        virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
+        {
+            return m_pixel_renderer->get_statistics();
+        }
+
+      protected:
+        auto_release_ptr<IPixelRenderer>    m_pixel_renderer;
+        IShadingResultFrameBufferFactory*   m_framebuffer_factory;
+        SharedTileList*                     m_shared_tiles;
+        PixelCostTimer*                     m_cost_timer;
+        size_t                              m_render_time_aov_index;
+        size_t                              m_ray_count_aov_index;
+        double                              m_cost_timer_rcp_frequency;
+        auto_ptr<Tile>                      m_cost_tile;
+        int                                 m_margin_width;
+        int                                 m_margin_height;
+        vector<Vector<int16, 2> >           m_pixel_ordering;
+        SamplingContext::RNGType            m_rng;
+
+        // Compute the bounding boxes of the pixels to render. Return false if there is none.
+        bool compute_tile_bboxes(SharedTile& shared_tile) const
+        {
+            const Frame& frame = shared_tile.m_frame;
+            const CanvasProperties& frame_properties = frame.image().properties();
+            const Tile& tile = frame.image().tile(shared_tile.m_tile_x, shared_tile.m_tile_y);
+            const int tile_origin_x = static_cast<int>(frame_properties.m_tile_width * shared_tile.m_tile_x);
+            const int tile_origin_y = static_cast<int>(frame_properties.m_tile_height * shared_tile.m_tile_y);
 
             // Compute the image space bounding box of the pixels to render.
             AABB2i tile_bbox;
@@ -135,7 +441,7 @@ namespace
             tile_bbox.max.y = tile_origin_y + static_cast<int>(tile.get_height()) - 1;
             tile_bbox = AABB2i::intersect(tile_bbox, AABB2i(frame.get_crop_window()));
             if (!tile_bbox.is_valid())
-                return;
+                return false;
 
             // Transform the bounding box to local (tile) space.
             tile_bbox.min.x -= tile_origin_x;
@@ -150,91 +456,170 @@ namespace
             padded_tile_bbox.max.x = tile_bbox.max.x + m_margin_width;
             padded_tile_bbox.max.y = tile_bbox.max.y + m_margin_height;
 
-            // Inform the pixel renderer that we are about to render a tile.
-            m_pixel_renderer->on_tile_begin(frame, tile, aov_tiles);
+            shared_tile.m_tile_bbox = tile_bbox;
+            shared_tile.m_padded_tile_bbox = padded_tile_bbox;
+            shared_tile.m_tile_origin_x = tile_origin_x;
+            shared_tile.m_tile_origin_y = tile_origin_y;
 
-            // Create the framebuffer into which we will accumulate the samples.
-            ShadingResultFrameBuffer* framebuffer =
-                m_framebuffer_factory->create(
-                    frame,
-                    tile_x,
-                    tile_y,
-                    tile_bbox);
-            assert(framebuffer);
+            return true;
+        }
 
-            // Seed the RNG with the tile index and the pass hash.
-            // Seeding the RNG per tile instead of per pixel has potential consequences on
-            // debugging: rendering a subset of a tile may lead to different computations
-            // than rendering the full tile, e.g. if the sampling context switches to random
-            // sampling because the number of dimensions becomes too high.
-            const size_t tile_index = tile_y * frame_properties.m_tile_count_x + tile_x;
+        // Render chunks of a tile until none is left.
+        void render_chunks(
+            SharedTile&                 shared_tile,
+            Tile&                       tile,
+            TileStack&                  aov_tiles,
+            ShadingResultFrameBuffer&   framebuffer,
+            IAbortSwitch&               abort_switch)
+        {
+            const Frame& frame = shared_tile.m_frame;
+            const CanvasProperties& frame_properties = frame.image().properties();
+            const size_t tile_index = shared_tile.m_tile_y * frame_properties.m_tile_count_x + shared_tile.m_tile_x;
+            const size_t pixel_count = m_pixel_ordering.size();
+            const size_t chunk_count = shared_tile.m_chunk_count;
+
+            while (true)
+            {
+                // Take the next chunk.
+                const size_t chunk = shared_tile.m_next_chunk++;
+                if (chunk >= chunk_count)
+                    break;
+
+                // Seed the RNG with the tile index, the chunk index and the pass hash.
+                // Seeding the RNG per chunk instead of per pixel has potential consequences on
+                // debugging: rendering a subset of a tile may lead to different computations
+                // than rendering the full tile, e.g. if the sampling context switches to random
+                // sampling because the number of dimensions becomes too high. The first chunk
+                // uses the same seed as an unsplit tile.
+                const size_t seed = pass_hash_of_chunk(shared_tile.m_pass_hash, chunk) ^ tile_index;
 #ifdef APPLESEED_ARCH64
-            m_rng = SamplingContext::RNGType(hash_uint64_to_uint32(pass_hash ^ tile_index));
+                m_rng = SamplingContext::RNGType(hash_uint64_to_uint32(seed));
 #else
-            m_rng = SamplingContext::RNGType(pass_hash ^ tile_index);
+                m_rng = SamplingContext::RNGType(seed);
 #endif
 
-            // Loop over tile pixels.
-            for (size_t i = 0, e = m_pixel_ordering.size(); i < e; ++i)
-            {
-                // Cancel any work done on this tile if rendering is aborted.
-                if (abort_switch.is_aborted())
-                    return;
+                // Loop over the pixels of the chunk.
+                const size_t chunk_begin = (chunk * pixel_count) / chunk_count;
+                const size_t chunk_end = ((chunk + 1) * pixel_count) / chunk_count;
+
+                for (size_t i = chunk_begin; i < chunk_end; ++i)
+                {
+                    // Cancel any work done on this tile if rendering is aborted.
+                    if (abort_switch.is_aborted())
+                        return;
 
-                // Retrieve the coordinates of the pixel in the padded tile.
-                const Vector2i pt(m_pixel_ordering[i].x, m_pixel_ordering[i].y);
+                    // Retrieve the coordinates of the pixel in the padded tile.
+                    const Vector2i pt(m_pixel_ordering[i].x, m_pixel_ordering[i].y);
 
-                // Skip pixels outside the intersection of the padded tile and the crop window.
-                if (!padded_tile_bbox.contains(pt))
-                    continue;
+                    // Skip pixels outside the intersection of the padded tile and the crop window.
+                    if (!shared_tile.m_padded_tile_bbox.contains(pt))
+                        continue;
 
-                const Vector2i pi(tile_origin_x + pt.x, tile_origin_y + pt.y);
+                    const Vector2i pi(shared_tile.m_tile_origin_x + pt.x, shared_tile.m_tile_origin_y + pt.y);
 
 #ifdef DEBUG_BREAK_AT_PIXEL
 
-                // Break in the debugger when this pixel is reached.
-                if (pi == DEBUG_BREAK_AT_PIXEL)
-                    BREAKPOINT();
+                    // Break in the debugger when this pixel is reached.
+                    if (pi == DEBUG_BREAK_AT_PIXEL)
+                        BREAKPOINT();
 
 #endif
 
-                // Render this pixel.
-                m_pixel_renderer->render_pixel(
-                    frame,
-                    tile,
-                    aov_tiles,
-                    tile_bbox,
-                    pass_hash,
-                    pi,
-                    pt,
-                    m_rng,
-                    *framebuffer);
+                    // Pixels in tile margins only contribute to their neighbors: their cost is not recorded.
+                    Tile* cost_tile = shared_tile.m_tile_bbox.contains(pt) ? shared_tile.m_cost_tile : 0;
+                    uint64 begin_time = 0, begin_ray_count = 0;
+                    if (cost_tile)
+                    {
+                        begin_ray_count = m_pixel_renderer->get_ray_count();
+                        begin_time = m_cost_timer->read_start();
+                    }
+
+                    // Render this pixel.
+                    m_pixel_renderer->render_pixel(
+                        frame,
+                        tile,
+                        aov_tiles,
+                        shared_tile.m_tile_bbox,
+                        shared_tile.m_pass_hash,
+                        pi,
+                        pt,
+                        m_rng,
+                        framebuffer);
+
+                    // Record the render time (in microseconds) and the number of rays of this pixel.
+                    if (cost_tile)
+                    {
+                        const uint64 end_time = m_cost_timer->read_end();
+
+                        Color<float, 2> cost;
+                        cost[0] = static_cast<float>((end_time - begin_time) * m_cost_timer_rcp_frequency * 1.0e6);
+                        cost[1] = static_cast<float>(m_pixel_renderer->get_ray_count() - begin_ray_count);
+                        cost_tile->set_pixel(pt.x, pt.y, cost);
+                    }
+                }
             }
+        }
 
-            // Develop the framebuffer to the tile.
-            if (frame.is_premultiplied_alpha())
-                framebuffer->develop_to_tile_premult_alpha(tile, aov_tiles);
-            else framebuffer->develop_to_tile_straight_alpha(tile, aov_tiles);
+        void create_cost_aovs(const Frame& frame, const bool primary)
+        {
+            ImageStack& images = frame.aov_images();
 
-            // Release the framebuffer.
-            m_framebuffer_factory->destroy(framebuffer);
+            m_render_time_aov_index = images.get_index("render_time");
+            if (m_render_time_aov_index == size_t(~0) && images.size() < MaxAOVCount)
+                m_render_time_aov_index = images.append("render_time", ImageStack::IdentificationType, 4, PixelFormatFloat);
 
-            // Inform the pixel renderer that we are done rendering the tile.
-            m_pixel_renderer->on_tile_end(frame, tile, aov_tiles);
+            m_ray_count_aov_index = images.get_index("ray_count");
+            if (m_ray_count_aov_index == size_t(~0) && images.size() < MaxAOVCount)
+                m_ray_count_aov_index = images.append("ray_count", ImageStack::IdentificationType, 4, PixelFormatFloat);
+
+            if (primary && (m_render_time_aov_index == size_t(~0) || m_ray_count_aov_index == size_t(~0)))
+            {
+                RENDERER_LOG_WARNING(
+                    "could not create some of the cost AOVs, maximum number of AOVs (" FMT_SIZE_T ") reached.",
+                    MaxAOVCount);
+            }
+
+            m_cost_timer_rcp_frequency = 1.0 / m_cost_timer->frequency();
         }
 
-        virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
+        // Return a cleared tile for the costs of the pixels of a given tile.
+        Tile& prepare_cost_tile(const Tile& tile)
         {
-            return m_pixel_renderer->get_statistics();
+            if (m_cost_tile.get() == 0 ||
+                m_cost_tile->get_width() != tile.get_width() ||
+                m_cost_tile->get_height() != tile.get_height())
+                m_cost_tile.reset(new Tile(tile.get_width(), tile.get_height(), 2, PixelFormatFloat));
+
+            m_cost_tile->clear(Color<float, 2>(0.0f));
+
+            return *m_cost_tile;
         }
 
-      protected:
-        auto_release_ptr<IPixelRenderer>    m_pixel_renderer;
-        IShadingResultFrameBufferFactory*   m_framebuffer_factory;
-        int                                 m_margin_width;
-        int                                 m_margin_height;
-        vector<Vector<int16, 2> >           m_pixel_ordering;
-        SamplingContext::RNGType            m_rng;
+        void write_cost_aovs(TileStack& aov_tiles) const
+        {
+            const size_t width = m_cost_tile->get_width();
+            const size_t height = m_cost_tile->get_height();
+
+            for (size_t y = 0; y < height; ++y)
+            {
+                for (size_t x = 0; x < width; ++x)
+                {
+                    Color<float, 2> cost;
+                    m_cost_tile->get_pixel(x, y, cost);
+
+                    if (m_render_time_aov_index != size_t(~0))
+                        aov_tiles.set_pixel(x, y, m_render_time_aov_index, Color4f(cost[0], cost[0], cost[0], 1.0f));
+
+                    if (m_ray_count_aov_index != size_t(~0))
+                        aov_tiles.set_pixel(x, y, m_ray_count_aov_index, Color4f(cost[1], cost[1], cost[1], 1.0f));
+                }
+            }
+        }
+
+        static size_t pass_hash_of_chunk(const size_t pass_hash, const size_t chunk)
+        {
+            return chunk == 0 ? pass_hash : pass_hash ^ hash_uint32(static_cast<uint32>(chunk));
+        }
 
         void compute_tile_margins(const Frame& frame, const bool primary)
         {
@@ -306,7 +691,21 @@ GenericTileRendererFactory::GenericTileRendererFactory(
   , m_pixel_renderer_factory(pixel_renderer_factory)
   , m_framebuffer_factory(framebuffer_factory)
   , m_params(params)
+  , m_shared_tiles(
+        params.get_optional<bool>("split_tiles", true)
+            ? new SharedTileList()
+            : 0)
+  , m_cost_timer(
+        params.get_optional<bool>("cost_aovs", false)
+            ? new PixelCostTimer()
+            : 0)
+{
+}
+
+GenericTileRendererFactory::~GenericTileRendererFactory()
 {
+    delete m_cost_timer;
+    delete m_shared_tiles;
 }
 
 void GenericTileRendererFactory::release()
@@ -322,6 +721,8 @@ ITileRenderer* GenericTileRendererFactory::create(
             m_frame,
             m_pixel_renderer_factory,
             m_framebuffer_factory,
+            m_shared_tiles,
+            m_cost_timer,
             m_params,
             thread_index);
 }
@@ -44,6 +44,8 @@
 namespace renderer  { class Frame; }
 namespace renderer  { class IPixelRendererFactory; }
 namespace renderer  { class IShadingResultFrameBufferFactory; }
+namespace renderer  { class PixelCostTimer; }
+namespace renderer  { class SharedTileList; }
 
 namespace renderer
 {
@@ -63,6 +65,9 @@ class GenericTileRendererFactory
         IShadingResultFrameBufferFactory*   framebuffer_factory,
         const ParamArray&                   params);
 
+    // Destructor.
+    ~GenericTileRendererFactory();
+
     // Delete this instance.
     virtual void release() APPLESEED_OVERRIDE;
 
@@ -75,6 +80,8 @@ class GenericTileRendererFactory
     IPixelRendererFactory*                  m_pixel_renderer_factory;
     IShadingResultFrameBufferFactory*       m_framebuffer_factory;
     const ParamArray                        m_params;
+    SharedTileList*                         m_shared_tiles;     // tiles in flight, 0 if tiles are not split
+    PixelCostTimer*                         m_cost_timer;       // 0 if cost AOVs are disabled
 };
 
 }       // namespace renderer
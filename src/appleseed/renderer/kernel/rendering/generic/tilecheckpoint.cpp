@@ -0,0 +1,252 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "tilecheckpoint.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/aov/imagestack.h"
+#include "renderer/modeling/frame/frame.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/platform/types.h"
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+
+// Standard headers.
+#include <cstring>
+
+using namespace foundation;
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace renderer
+{
+
+//
+// TileCheckpoint class implementation.
+//
+
+namespace
+{
+    const uint64 CheckpointMagic = 0x4153544C43484B31ULL;      // 'ASTLCHK1'
+
+    const Image& get_plane(const Frame& frame, const size_t plane_index)
+    {
+        return
+            plane_index == 0
+                ? frame.image()
+                : frame.aov_images().get_image(plane_index - 1);
+    }
+
+    size_t get_plane_count(const Frame& frame)
+    {
+        return 1 + frame.aov_images().size();
+    }
+
+    bool read_words(istream& in, vector<uint64>& words)
+    {
+        in.read(reinterpret_cast<char*>(&words[0]), words.size() * sizeof(uint64));
+        return !in.fail();
+    }
+
+    void write_words(ostream& out, const vector<uint64>& words)
+    {
+        out.write(reinterpret_cast<const char*>(&words[0]), words.size() * sizeof(uint64));
+    }
+}
+
+TileCheckpoint::TileCheckpoint(
+    const Frame&        frame,
+    const string&       path)
+  : m_frame(frame)
+  , m_path(path)
+  , m_failed(false)
+{
+}
+
+bool TileCheckpoint::restore(
+    size_t&             pass,
+    vector<bool>&       completed_tiles)
+{
+    ifstream file(m_path.c_str(), ios_base::in | ios_base::binary);
+    if (!file.is_open())
+        return false;
+
+    // Check that the file was written for this frame.
+    vector<uint64> expected;
+    describe_frame(expected);
+
+    vector<uint64> header(expected.size() + 1);
+    if (!read_words(file, header))
+        return false;
+
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        if (header[i] != expected[i])
+            return false;
+    }
+
+    pass = static_cast<size_t>(header.back());
+
+    const CanvasProperties& props = m_frame.image().properties();
+    const size_t plane_count = get_plane_count(m_frame);
+
+    completed_tiles.assign(props.m_tile_count, false);
+
+    vector<uint64> record(2);
+    vector<char> pixels;
+
+    while (read_words(file, record))
+    {
+        const size_t tile_x = static_cast<size_t>(record[0]);
+        const size_t tile_y = static_cast<size_t>(record[1]);
+
+        if (tile_x >= props.m_tile_count_x || tile_y >= props.m_tile_count_y)
+            break;
+
+        // Read all planes before touching the frame to ignore incomplete records.
+        size_t record_size = 0;
+        for (size_t i = 0; i < plane_count; ++i)
+            record_size += get_plane(m_frame, i).tile(tile_x, tile_y).get_size();
+
+        pixels.resize(record_size);
+        file.read(&pixels[0], record_size);
+
+        if (file.fail())
+            break;
+
+        const char* ptr = &pixels[0];
+        for (size_t i = 0; i < plane_count; ++i)
+        {
+            const Tile& tile = get_plane(m_frame, i).tile(tile_x, tile_y);
+            memcpy(tile.get_storage(), ptr, tile.get_size());
+            ptr += tile.get_size();
+        }
+
+        completed_tiles[tile_y * props.m_tile_count_x + tile_x] = true;
+    }
+
+    return true;
+}
+
+bool TileCheckpoint::begin_pass(
+    const size_t        pass,
+    const bool          resume)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (m_file.is_open())
+        m_file.close();
+
+    m_file.clear();
+    m_failed = false;
+
+    if (resume)
+    {
+        // Keep the existing header and records; restore() has validated them.
+        m_file.open(m_path.c_str(), ios_base::out | ios_base::binary | ios_base::app);
+    }
+    else
+    {
+        m_file.open(m_path.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+
+        vector<uint64> header;
+        describe_frame(header);
+        header.push_back(pass);
+
+        write_words(m_file, header);
+        m_file.flush();
+    }
+
+    m_failed = !m_file.good();
+
+    return !m_failed;
+}
+
+void TileCheckpoint::store_tile(
+    const size_t        tile_x,
+    const size_t        tile_y)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (m_failed || !m_file.is_open())
+        return;
+
+    vector<uint64> record(2);
+    record[0] = tile_x;
+    record[1] = tile_y;
+    write_words(m_file, record);
+
+    for (size_t i = 0, e = get_plane_count(m_frame); i < e; ++i)
+    {
+        const Tile& tile = get_plane(m_frame, i).tile(tile_x, tile_y);
+        m_file.write(reinterpret_cast<const char*>(tile.get_storage()), tile.get_size());
+    }
+
+    // Make the record durable in case the process gets killed.
+    m_file.flush();
+
+    m_failed = !m_file.good();
+}
+
+void TileCheckpoint::remove()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (m_file.is_open())
+        m_file.close();
+
+    boost::system::error_code ec;
+    bf::remove(m_path, ec);
+}
+
+void TileCheckpoint::describe_frame(vector<uint64>& header) const
+{
+    const CanvasProperties& props = m_frame.image().properties();
+
+    header.push_back(CheckpointMagic);
+    header.push_back(props.m_canvas_width);
+    header.push_back(props.m_canvas_height);
+    header.push_back(props.m_tile_width);
+    header.push_back(props.m_tile_height);
+    header.push_back(get_plane_count(m_frame));
+
+    for (size_t i = 0, e = get_plane_count(m_frame); i < e; ++i)
+    {
+        const CanvasProperties& plane_props = get_plane(m_frame, i).properties();
+        header.push_back(plane_props.m_channel_count);
+        header.push_back(static_cast<uint64>(plane_props.m_pixel_format));
+    }
+}
+
+}   // namespace renderer
@@ -0,0 +1,104 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_TILECHECKPOINT_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_TILECHECKPOINT_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Forward declarations.
+namespace renderer      { class Frame; }
+
+namespace renderer
+{
+
+//
+// A file recording the tiles completed during the current rendering pass so that
+// an interrupted render can resume where it stopped.
+//
+// The file starts with a header describing the frame and holding the index of the
+// pass, followed by one record per completed tile with the pixels of the tile in
+// the main image and in all AOV images. Records are appended and flushed as tiles
+// complete; an incomplete last record, left by a process killed while writing it,
+// is ignored. The file uses the native byte order and is only meant to be read
+// back on the same kind of machine.
+//
+
+class TileCheckpoint
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. Does not access the file.
+    TileCheckpoint(
+        const Frame&            frame,
+        const std::string&      path);
+
+    // Copy the tiles recorded in the file to the frame and retrieve the index of the
+    // pass and which tiles were completed (indexed by tile_y * tile_count_x + tile_x).
+    // Return false if the file does not exist or was written for a different frame.
+    bool restore(
+        size_t&                 pass,
+        std::vector<bool>&      completed_tiles);
+
+    // Start recording a given pass, discarding the records of previous passes.
+    // If resume is true, records of this pass already in the file are kept.
+    // Return false if the file could not be written.
+    bool begin_pass(
+        const size_t            pass,
+        const bool              resume = false);
+
+    // Record a completed tile of the current pass. Thread-safe.
+    void store_tile(
+        const size_t            tile_x,
+        const size_t            tile_y);
+
+    // Close and delete the file, e.g. once the frame is complete.
+    void remove();
+
+  private:
+    const Frame&                m_frame;
+    const std::string           m_path;
+    boost::mutex                m_mutex;
+    std::ofstream               m_file;
+    bool                        m_failed;
+
+    void describe_frame(std::vector<foundation::uint64>& header) const;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_TILECHECKPOINT_H
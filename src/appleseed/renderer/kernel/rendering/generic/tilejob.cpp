@@ -31,6 +31,7 @@
 #include "tilejob.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/rendering/generic/tilecheckpoint.h"
 #include "renderer/kernel/rendering/itilecallback.h"
 #include "renderer/kernel/rendering/itilerenderer.h"
 #include "renderer/modeling/frame/frame.h"
@@ -39,6 +40,12 @@
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/image.h"
 #include "foundation/image/tile.h"
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/snprintf.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/eventtracer.h"
+#include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/stopwatch.h"
 
 // Standard headers.
 #include <cassert>
@@ -61,7 +68,9 @@ TileJob::TileJob(
     const size_t                tile_x,
     const size_t                tile_y,
     const size_t                pass_hash,
-    IAbortSwitch&               abort_switch)
+    IAbortSwitch&               abort_switch,
+    double*                     tile_cost,
+    TileCheckpoint*             checkpoint)
   : m_tile_renderers(tile_renderers)
   , m_tile_callbacks(tile_callbacks)
   , m_frame(frame)
@@ -69,6 +78,8 @@ TileJob::TileJob(
   , m_tile_y(tile_y)
   , m_pass_hash(pass_hash)
   , m_abort_switch(abort_switch)
+  , m_tile_cost(tile_cost)
+  , m_checkpoint(checkpoint)
 {
     // Either there is no tile callback, or there is the same number
     // of tile callbacks and rendering threads.
@@ -103,8 +114,24 @@ void TileJob::execute(const size_t thread_index)
         tile_callback->pre_render(x, y, width, height);
     }
 
+    Stopwatch<DefaultWallclockTimer> stopwatch(0);
+    stopwatch.start();
+
     try
     {
+        char trace_detail[EventTracer::MaxDetailLength + 1] = "";
+        if (global_event_tracer().is_enabled())
+        {
+            portable_snprintf(
+                trace_detail,
+                sizeof(trace_detail),
+                "(" FMT_SIZE_T ", " FMT_SIZE_T ")",
+                m_tile_x,
+                m_tile_y);
+        }
+
+        EventTraceScope trace_scope("rendering", "tile", trace_detail);
+
         // Render the tile.
         m_tile_renderers[thread_index]->render_tile(
             m_frame,
@@ -123,9 +150,40 @@ void TileJob::execute(const size_t thread_index)
         throw;
     }
 
+    // Record the rendering time of the tile, unless rendering was interrupted.
+    if (m_tile_cost && !m_abort_switch.is_aborted())
+    {
+        stopwatch.measure();
+        *m_tile_cost = stopwatch.get_seconds();
+    }
+
+    // Record the tile in the checkpoint file, unless rendering was interrupted.
+    if (m_checkpoint && !m_abort_switch.is_aborted())
+        m_checkpoint->store_tile(m_tile_x, m_tile_y);
+
     // Call the post-render tile callback.
     if (tile_callback)
         tile_callback->post_render_tile(&m_frame, m_tile_x, m_tile_y);
 }
 
+
+//
+// TileHelperJob class implementation.
+//
+
+TileHelperJob::TileHelperJob(
+    const TileJob::TileRendererVector&  tile_renderers,
+    IAbortSwitch&                       abort_switch)
+  : m_tile_renderers(tile_renderers)
+  , m_abort_switch(abort_switch)
+{
+}
+
+void TileHelperJob::execute(const size_t thread_index)
+{
+    assert(thread_index < m_tile_renderers.size());
+
+    m_tile_renderers[thread_index]->help_render_tiles(m_abort_switch);
+}
+
 }   // namespace renderer
@@ -41,6 +41,7 @@
 namespace renderer  { class Frame; }
 namespace renderer  { class ITileCallback; }
 namespace renderer  { class ITileRenderer; }
+namespace renderer  { class TileCheckpoint; }
 
 namespace renderer
 {
@@ -64,7 +65,9 @@ class TileJob
         const size_t                tile_x,
         const size_t                tile_y,
         const size_t                pass_hash,
-        foundation::IAbortSwitch&   abort_switch);
+        foundation::IAbortSwitch&   abort_switch,
+        double*                     tile_cost = 0,      // if set, receives the rendering time of the tile in seconds
+        TileCheckpoint*             checkpoint = 0);    // if set, records the tile once it is complete
 
     // Execute the job.
     virtual void execute(const size_t thread_index);
@@ -77,6 +80,30 @@ class TileJob
     const size_t                    m_tile_y;
     const size_t                    m_pass_hash;
     foundation::IAbortSwitch&       m_abort_switch;
+    double*                         m_tile_cost;
+    TileCheckpoint*                 m_checkpoint;
+};
+
+
+//
+// A job that lets an idle thread help other threads finish the tiles they are rendering.
+//
+
+class TileHelperJob
+  : public foundation::IJob
+{
+  public:
+    // Constructor.
+    TileHelperJob(
+        const TileJob::TileRendererVector&  tile_renderers,
+        foundation::IAbortSwitch&           abort_switch);
+
+    // Execute the job.
+    virtual void execute(const size_t thread_index);
+
+  private:
+    const TileJob::TileRendererVector&      m_tile_renderers;
+    foundation::IAbortSwitch&               m_abort_switch;
 };
 
 }       // namespace renderer
@@ -36,11 +36,15 @@
 // appleseed.foundation headers.
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/image.h"
+#include "foundation/math/aabb.h"
 #include "foundation/math/ordering.h"
+#include "foundation/math/vector.h"
 #include "foundation/utility/otherwise.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
+#include <fstream>
 
 using namespace foundation;
 using namespace std;
@@ -52,6 +56,24 @@ namespace renderer
 // TileJobFactory class implementation.
 //
 
+namespace
+{
+    struct DescendingCostPredicate
+    {
+        const vector<double>& m_costs;
+
+        explicit DescendingCostPredicate(const vector<double>& costs)
+          : m_costs(costs)
+        {
+        }
+
+        bool operator()(const size_t lhs, const size_t rhs) const
+        {
+            return m_costs[lhs] > m_costs[rhs];
+        }
+    };
+}
+
 void TileJobFactory::create(
     const Frame&                        frame,
     const TileOrdering                  tile_ordering,
@@ -59,7 +81,9 @@ void TileJobFactory::create(
     const TileJob::TileCallbackVector&  tile_callbacks,
     const size_t                        pass_hash,
     TileJobVector&                      tile_jobs,
-    IAbortSwitch&                       abort_switch)
+    IAbortSwitch&                       abort_switch,
+    TileCheckpoint*                     checkpoint,
+    const vector<bool>*                 completed_tiles)
 {
     // Retrieve frame properties.
     const CanvasProperties& props = frame.image().properties();
@@ -71,16 +95,41 @@ void TileJobFactory::create(
     // Make sure the right number of tiles was created.
     assert(tiles.size() == props.m_tile_count);
 
-    // Create tile jobs, one per tile.
+    // Tile rendering times are only recorded with the cost ordering.
+    if (tile_ordering == CostOrdering)
+        m_tile_costs.resize(props.m_tile_count, 0.0);
+    else
+        m_tile_costs.clear();
+
+    assert(completed_tiles == 0 || completed_tiles->size() == props.m_tile_count);
+
+    const AABB2u& crop_window = frame.get_crop_window();
+
+    // Create tile jobs, one per tile of the crop window that remains to be rendered.
     for (size_t i = 0; i < props.m_tile_count; ++i)
     {
-        // Compute coordinates of the tile in the frame.
+        // Skip tiles restored from a checkpoint.
         const size_t tile_index = tiles[i];
+        if (completed_tiles && (*completed_tiles)[tile_index])
+            continue;
+
+        // Compute coordinates of the tile in the frame.
         const size_t tile_x = tile_index % props.m_tile_count_x;
         const size_t tile_y = tile_index / props.m_tile_count_x;
         assert(tile_x < props.m_tile_count_x);
         assert(tile_y < props.m_tile_count_y);
 
+        // Skip tiles outside the crop window: their image tiles are never allocated.
+        const size_t origin_x = tile_x * props.m_tile_width;
+        const size_t origin_y = tile_y * props.m_tile_height;
+        const AABB2u tile_rect(
+            Vector2u(origin_x, origin_y),
+            Vector2u(
+                origin_x + props.get_tile_width(tile_x) - 1,
+                origin_y + props.get_tile_height(tile_y) - 1));
+        if (!AABB2u::overlap(tile_rect, crop_window))
+            continue;
+
         // Create the tile job.
         tile_jobs.push_back(
             new TileJob(
@@ -90,10 +139,56 @@ void TileJobFactory::create(
                 tile_x,
                 tile_y,
                 pass_hash,
-                abort_switch));
+                abort_switch,
+                m_tile_costs.empty() ? 0 : &m_tile_costs[tile_index],
+                checkpoint));
     }
 }
 
+bool TileJobFactory::load_tile_costs(
+    const CanvasProperties&             frame_properties,
+    const string&                       path)
+{
+    ifstream file(path.c_str());
+
+    size_t tile_count_x, tile_count_y;
+    if (!(file >> tile_count_x >> tile_count_y))
+        return false;
+
+    if (tile_count_x != frame_properties.m_tile_count_x ||
+        tile_count_y != frame_properties.m_tile_count_y)
+        return false;
+
+    vector<double> tile_costs(frame_properties.m_tile_count);
+
+    for (size_t i = 0; i < tile_costs.size(); ++i)
+    {
+        if (!(file >> tile_costs[i]))
+            return false;
+    }
+
+    m_tile_costs.swap(tile_costs);
+
+    return true;
+}
+
+bool TileJobFactory::save_tile_costs(
+    const CanvasProperties&             frame_properties,
+    const string&                       path) const
+{
+    if (m_tile_costs.size() != frame_properties.m_tile_count)
+        return false;
+
+    ofstream file(path.c_str());
+
+    file << frame_properties.m_tile_count_x << ' ' << frame_properties.m_tile_count_y << '\n';
+
+    for (size_t i = 0; i < m_tile_costs.size(); ++i)
+        file << m_tile_costs[i] << '\n';
+
+    return !file.fail();
+}
+
 void TileJobFactory::generate_tile_ordering(
     const CanvasProperties&             frame_properties,
     const TileOrdering                  tile_ordering,
@@ -128,6 +223,16 @@ void TileJobFactory::generate_tile_ordering(
             m_rng);
         break;
 
+      case CostOrdering:
+        // Without timings (first pass), or tiles of equal cost, fall back to the spiral ordering.
+        spiral_ordering(
+            tiles,
+            frame_properties.m_tile_count_x,
+            frame_properties.m_tile_count_y);
+        if (m_tile_costs.size() == frame_properties.m_tile_count)
+            stable_sort(tiles.begin(), tiles.end(), DescendingCostPredicate(m_tile_costs));
+        break;
+
       assert_otherwise;
     }
 }
@@ -38,12 +38,14 @@
 
 // Standard headers.
 #include <cstddef>
+#include <string>
 #include <vector>
 
 // Forward declarations.
 namespace foundation    { class CanvasProperties; }
 namespace foundation    { class IAbortSwitch; }
 namespace renderer      { class Frame; }
+namespace renderer      { class TileCheckpoint; }
 namespace renderer      { class TileJob; }
 
 namespace renderer
@@ -64,10 +66,13 @@ class TileJobFactory
         LinearOrdering,
         SpiralOrdering,
         HilbertOrdering,
-        RandomOrdering
+        RandomOrdering,
+        CostOrdering        // most expensive tiles first, based on the timings of the previous pass
     };
 
-    // Create tile jobs for a given frame.
+    // Create tile jobs for a given frame. Tiles flagged in completed_tiles (indexed
+    // by tile_y * tile_count_x + tile_x) are skipped, and completed tiles are
+    // recorded in the checkpoint if one is provided.
     void create(
         const Frame&                        frame,
         const TileOrdering                  tile_ordering,
@@ -75,10 +80,24 @@ class TileJobFactory
         const TileJob::TileCallbackVector&  tile_callbacks,
         const size_t                        pass_hash,
         TileJobVector&                      tile_jobs,
-        foundation::IAbortSwitch&           abort_switch);
+        foundation::IAbortSwitch&           abort_switch,
+        TileCheckpoint*                     checkpoint = 0,
+        const std::vector<bool>*            completed_tiles = 0);
+
+    // Load tile rendering times saved by a previous render. Return false if the file
+    // could not be read or if it was written for a frame with a different tiling.
+    bool load_tile_costs(
+        const foundation::CanvasProperties& frame_properties,
+        const std::string&                  path);
+
+    // Save the tile rendering times of the last pass. Return false if the file could not be written.
+    bool save_tile_costs(
+        const foundation::CanvasProperties& frame_properties,
+        const std::string&                  path) const;
 
   private:
     foundation::MersenneTwister             m_rng;
+    std::vector<double>                     m_tile_costs;   // rendering times in seconds, indexed by tile
 
     void generate_tile_ordering(
         const foundation::CanvasProperties& frame_properties,
@@ -40,24 +40,73 @@
 #include "foundation/image/image.h"
 #include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
 #include "foundation/utility/job/iabortswitch.h"
 
 // Boost headers.
 #include "boost/chrono/duration.hpp"
 
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
 using namespace foundation;
 using namespace std;
 
 namespace renderer
 {
 
+//
+// A full resolution framebuffer into which a single thread accumulates samples without
+// synchronization. Only the pixels covered by the filter footprints of the samples stored
+// since the last merge need to be merged into the shared framebuffer.
+//
+
+struct GlobalSampleAccumulationBuffer::PrivateSplatBuffer
+{
+    FilteredTile    m_fb;
+    AABB2f          m_bbox;     // bounding box of the stored samples, in continuous image space
+
+    explicit PrivateSplatBuffer(const FilteredTile& fb)
+      : m_fb(fb.get_width(), fb.get_height(), fb.get_channel_count() - 1, fb.get_filter())
+    {
+        m_fb.clear();
+        m_bbox.invalidate();
+    }
+};
+
+GlobalSampleAccumulationBuffer::GlobalSampleAccumulationBuffer(
+    const size_t    width,
+    const size_t    height,
+    const Filter2f& filter)
+  : m_crop_window(Vector2u(0, 0), Vector2u(width - 1, height - 1))
+  , m_fb(width, height, 3, filter)
+  , m_striped_fb(m_fb)
+  , m_filter_rcp_norm_factor(1.0f / compute_normalization_factor(filter))
+  , m_memory_account(MemoryTagFramebuffers)
+{
+    m_memory_account.set_size(m_fb.get_memory_size());
+}
+
 GlobalSampleAccumulationBuffer::GlobalSampleAccumulationBuffer(
     const size_t    width,
     const size_t    height,
+    const AABB2u&   crop_window,
     const Filter2f& filter)
-  : m_fb(width, height, 3, filter)
+  : m_crop_window(crop_window)
+  , m_fb(crop_window.extent()[0] + 1, crop_window.extent()[1] + 1, 3, filter)
+  , m_striped_fb(m_fb, width, height, crop_window)
   , m_filter_rcp_norm_factor(1.0f / compute_normalization_factor(filter))
+  , m_memory_account(MemoryTagFramebuffers)
 {
+    m_memory_account.set_size(m_fb.get_memory_size());
+}
+
+GlobalSampleAccumulationBuffer::~GlobalSampleAccumulationBuffer()
+{
+    for (size_t i = 0, e = m_private_buffers.size(); i < e; ++i)
+        delete m_private_buffers[i];
 }
 
 void GlobalSampleAccumulationBuffer::clear()
@@ -68,6 +117,7 @@ void GlobalSampleAccumulationBuffer::clear()
     m_sample_count = 0;
 
     m_fb.clear();
+    clear_private_buffers();
 }
 
 void GlobalSampleAccumulationBuffer::store_samples(
@@ -85,23 +135,53 @@ void GlobalSampleAccumulationBuffer::store_samples(
             break;
     }
 
-    const float fw = static_cast<float>(m_fb.get_width());
-    const float fh = static_cast<float>(m_fb.get_height());
-    size_t counter = 0;
+    // Samples are stored unscaled into stripes of the framebuffer (see StripedFilteredTile);
+    // the filter normalization factor is applied when developing the buffer.
+    m_striped_fb.store_samples(sample_count, samples, abort_switch);
+}
 
-    const Sample* sample_end = samples + sample_count;
-    for (const Sample* s = samples; s < sample_end; ++s)
+void GlobalSampleAccumulationBuffer::store_private_samples(
+    const size_t    private_buffer_index,
+    const size_t    sample_count,
+    const Sample    samples[],
+    IAbortSwitch&   abort_switch)
+{
+    // Request non-exclusive access.
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex, boost::defer_lock);
+    while (true)
     {
-        if ((counter++ & 4096) == 0 && abort_switch.is_aborted())
+        if (abort_switch.is_aborted())
             return;
+        if (lock.try_lock_for(boost::chrono::milliseconds(5)))
+            break;
+    }
+
+    // Make room for this private splat buffer the first time it is used.
+    if (private_buffer_index >= m_private_buffers.size())
+    {
+        lock.unlock();
+
+        {
+            // Request exclusive access.
+            boost::unique_lock<boost::shared_mutex> exclusive_lock(m_mutex);
+            if (private_buffer_index >= m_private_buffers.size())
+                m_private_buffers.resize(private_buffer_index + 1, 0);
+        }
 
-        const float fx = s->m_position.x * fw;
-        const float fy = s->m_position.y * fh;
+        lock.lock();
+    }
 
-        Color3f value(s->m_values);
-        value *= m_filter_rcp_norm_factor;
+    // Only the owner of this private splat buffer ever allocates or modifies it.
+    PrivateSplatBuffer*& buffer = m_private_buffers[private_buffer_index];
+    if (buffer == 0)
+        buffer = new PrivateSplatBuffer(m_fb);
 
-        m_fb.add(fx, fy, &value[0]);
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        const Sample& sample = samples[i];
+        const Vector2f p = m_striped_fb.get_tile_position(sample.m_position);
+        buffer->m_fb.add_exclusive(p.x, p.y, sample.m_values);
+        buffer->m_bbox.insert(p);
     }
 }
 
@@ -122,15 +202,23 @@ void GlobalSampleAccumulationBuffer::develop_to_frame(
     Image& image = frame.image();
     const CanvasProperties& frame_props = image.properties();
 
-    assert(frame_props.m_canvas_width == m_fb.get_width());
-    assert(frame_props.m_canvas_height == m_fb.get_height());
+    assert(m_crop_window.max.x < frame_props.m_canvas_width);
+    assert(m_crop_window.max.y < frame_props.m_canvas_height);
     assert(frame_props.m_channel_count == 4);
 
-    const float scale = 1.0f / m_sample_count;
+    merge_private_buffers();
 
-    for (size_t ty = 0; ty < frame_props.m_tile_count_y; ++ty)
+    const float scale = m_filter_rcp_norm_factor / m_sample_count;
+
+    // Only visit the tiles that intersect the crop window, leaving the others unallocated.
+    const size_t min_tx = m_crop_window.min.x / frame_props.m_tile_width;
+    const size_t min_ty = m_crop_window.min.y / frame_props.m_tile_height;
+    const size_t max_tx = m_crop_window.max.x / frame_props.m_tile_width;
+    const size_t max_ty = m_crop_window.max.y / frame_props.m_tile_height;
+
+    for (size_t ty = min_ty; ty <= max_ty; ++ty)
     {
-        for (size_t tx = 0; tx < frame_props.m_tile_count_x; ++tx)
+        for (size_t tx = min_tx; tx <= max_tx; ++tx)
         {
             if (abort_switch.is_aborted())
                 return;
@@ -140,37 +228,137 @@ void GlobalSampleAccumulationBuffer::develop_to_frame(
             const size_t x = tx * frame_props.m_tile_width;
             const size_t y = ty * frame_props.m_tile_height;
 
-            develop_to_tile(tile, x, y, tx, ty, scale);
+            const AABB2u tile_rect(
+                Vector2u(x, y),
+                Vector2u(x + tile.get_width() - 1, y + tile.get_height() - 1));
+
+            develop_to_tile(tile, x, y, AABB2u::intersect(tile_rect, m_crop_window), scale);
         }
     }
 }
 
+bool GlobalSampleAccumulationBuffer::save_samples(ostream& output)
+{
+    // Request exclusive access.
+    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+
+    merge_private_buffers();
+
+    return save_tile(output, m_fb, m_sample_count);
+}
+
+bool GlobalSampleAccumulationBuffer::load_samples(istream& input)
+{
+    // Request exclusive access.
+    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+
+    clear_private_buffers();
+
+    uint64 sample_count;
+    if (!load_tile(input, m_fb, sample_count))
+    {
+        m_sample_count = 0;
+        m_fb.clear();
+        return false;
+    }
+
+    m_sample_count = sample_count;
+    return true;
+}
+
+bool GlobalSampleAccumulationBuffer::merge_samples(istream& input)
+{
+    // Request exclusive access.
+    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+
+    merge_private_buffers();
+
+    uint64 sample_count;
+    if (!merge_tile(input, m_fb, sample_count))
+        return false;
+
+    m_sample_count += sample_count;
+    return true;
+}
+
 void GlobalSampleAccumulationBuffer::increment_sample_count(const uint64 delta_sample_count)
 {
     m_sample_count += delta_sample_count;
 }
 
+void GlobalSampleAccumulationBuffer::merge_private_buffers()
+{
+    const float xradius = m_fb.get_filter().get_xradius();
+    const float yradius = m_fb.get_filter().get_yradius();
+    const float max_x = static_cast<float>(m_fb.get_width() - 1);
+    const float max_y = static_cast<float>(m_fb.get_height() - 1);
+    const size_t channel_count = m_fb.get_channel_count();
+
+    for (size_t i = 0, e = m_private_buffers.size(); i < e; ++i)
+    {
+        PrivateSplatBuffer* buffer = m_private_buffers[i];
+        if (buffer == 0 || !buffer->m_bbox.is_valid())
+            continue;
+
+        // Pixels covered by the filter footprints of the stored samples.
+        const AABB2f& bbox = buffer->m_bbox;
+        const float x0 = max(fast_ceil(bbox.min.x - 0.5f - xradius), 0.0f);
+        const float y0 = max(fast_ceil(bbox.min.y - 0.5f - yradius), 0.0f);
+        const float x1 = min(fast_floor(bbox.max.x - 0.5f + xradius), max_x);
+        const float y1 = min(fast_floor(bbox.max.y - 0.5f + yradius), max_y);
+
+        if (x0 <= x1 && y0 <= y1)
+        {
+            for (size_t y = truncate<size_t>(y0), ye = truncate<size_t>(y1); y <= ye; ++y)
+            {
+                for (size_t x = truncate<size_t>(x0), xe = truncate<size_t>(x1); x <= xe; ++x)
+                {
+                    float* APPLESEED_RESTRICT src = buffer->m_fb.pixel(x, y);
+                    float* APPLESEED_RESTRICT dst = m_fb.pixel(x, y);
+
+                    for (size_t c = 0; c < channel_count; ++c)
+                    {
+                        dst[c] += src[c];
+                        src[c] = 0.0f;
+                    }
+                }
+            }
+        }
+
+        buffer->m_bbox.invalidate();
+    }
+}
+
+void GlobalSampleAccumulationBuffer::clear_private_buffers()
+{
+    for (size_t i = 0, e = m_private_buffers.size(); i < e; ++i)
+    {
+        PrivateSplatBuffer* buffer = m_private_buffers[i];
+        if (buffer)
+        {
+            buffer->m_fb.clear();
+            buffer->m_bbox.invalidate();
+        }
+    }
+}
+
 void GlobalSampleAccumulationBuffer::develop_to_tile(
     Tile&           tile,
     const size_t    origin_x,
     const size_t    origin_y,
-    const size_t    tile_x,
-    const size_t    tile_y,
+    const AABB2u&   rect,
     const float     scale) const
 {
-    const size_t tile_width = tile.get_width();
-    const size_t tile_height = tile.get_height();
-
-    for (size_t y = 0; y < tile_height; ++y)
+    for (size_t y = rect.min.y; y <= rect.max.y; ++y)
     {
-        for (size_t x = 0; x < tile_width; ++x)
+        for (size_t x = rect.min.x; x <= rect.max.x; ++x)
         {
-            const float* ptr = m_fb.pixel(origin_x + x, origin_y + y);
+            const float* ptr = m_fb.pixel(x - m_crop_window.min.x, y - m_crop_window.min.y);
 
             Color4f color(ptr[1], ptr[2], ptr[3], 1.0f);
             color.rgb() *= scale;
 
-            tile.set_pixel(x, y, color);
+            tile.set_pixel(x - origin_x, y - origin_y, color);
         }
     }
 }
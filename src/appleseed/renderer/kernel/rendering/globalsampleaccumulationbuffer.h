@@ -32,16 +32,22 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/rendering/sampleaccumulationbuffer.h"
+#include "renderer/kernel/rendering/stripedfilteredtile.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/filteredtile.h"
+#include "foundation/math/aabb.h"
 #include "foundation/math/filter.h"
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
+#include "foundation/utility/memoryaccounting.h"
 
 // Standard headers.
 #include <cstddef>
+#include <istream>
+#include <ostream>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
@@ -56,12 +62,22 @@ class GlobalSampleAccumulationBuffer
   : public SampleAccumulationBuffer
 {
   public:
-    // Constructor.
+    // Constructor. The buffer covers the entire frame.
     GlobalSampleAccumulationBuffer(
         const size_t                width,
         const size_t                height,
         const foundation::Filter2f& filter);
 
+    // Constructor. Only pixels inside the crop window are allocated and developed.
+    GlobalSampleAccumulationBuffer(
+        const size_t                width,
+        const size_t                height,
+        const foundation::AABB2u&   crop_window,
+        const foundation::Filter2f& filter);
+
+    // Destructor.
+    ~GlobalSampleAccumulationBuffer();
+
     // Reset the buffer to its initial state. Thread-safe.
     virtual void clear() APPLESEED_OVERRIDE;
 
@@ -76,20 +92,47 @@ class GlobalSampleAccumulationBuffer
         Frame&                      frame,
         foundation::IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE;
 
+    // Write the accumulated samples to a stream. Thread-safe.
+    virtual bool save_samples(std::ostream& output) APPLESEED_OVERRIDE;
+
+    // Replace the content of the buffer by samples written by save_samples(). Thread-safe.
+    virtual bool load_samples(std::istream& input) APPLESEED_OVERRIDE;
+
+    // Add samples written by save_samples() to the content of the buffer. Thread-safe.
+    virtual bool merge_samples(std::istream& input) APPLESEED_OVERRIDE;
+
+    // Store a set of samples into a private splat buffer identified by an arbitrary index.
+    // Private splat buffers cover the same pixels as the buffer itself, are allocated on
+    // first use and are merged into the buffer when it is developed or saved. Thread-safe,
+    // provided that a given private splat buffer is never used by two threads at once.
+    void store_private_samples(
+        const size_t                private_buffer_index,
+        const size_t                sample_count,
+        const Sample                samples[],
+        foundation::IAbortSwitch&   abort_switch);
+
     // Increment the number of samples used for pixel values renormalization. Thread-safe.
     void increment_sample_count(const foundation::uint64 delta_sample_count);
 
   private:
+    struct PrivateSplatBuffer;
+
     boost::shared_mutex             m_mutex;
+    const foundation::AABB2u        m_crop_window;
     foundation::FilteredTile        m_fb;
+    StripedFilteredTile             m_striped_fb;
     const float                     m_filter_rcp_norm_factor;
+    std::vector<PrivateSplatBuffer*> m_private_buffers;
+    foundation::MemoryAccount       m_memory_account;
+
+    void merge_private_buffers();
+    void clear_private_buffers();
 
     void develop_to_tile(
         foundation::Tile&           tile,
         const size_t                origin_x,
         const size_t                origin_y,
-        const size_t                tile_x,
-        const size_t                tile_y,
+        const foundation::AABB2u&   rect,
         const float                 scale) const;
 };
 
@@ -33,6 +33,9 @@
 // appleseed.foundation headers.
 #include "foundation/core/concepts/iunknown.h"
 
+// Standard headers.
+#include <cstddef>
+
 namespace renderer
 {
 
@@ -54,6 +57,15 @@ class IFrameRenderer
     virtual void pause_rendering() = 0;
     virtual void resume_rendering() = 0;
     virtual void terminate_rendering() = 0;
+
+    // Set the number of rendering threads allowed to pick up new work. The other
+    // threads are parked after completing their current work. May be called at
+    // any time, including during rendering.
+    virtual void set_active_thread_count(const size_t thread_count) = 0;
+
+    // Return the fraction of the frame rendered so far, in [0, 1], or a negative
+    // value if the renderer cannot tell. Thread-safe, but only approximate.
+    virtual double get_progress() const = 0;
 };
 
 
@@ -54,7 +54,8 @@ class APPLESEED_DLLSYMBOL IPassCallback
   : public foundation::IUnknown
 {
   public:
-    // This method is called at the beginning of a pass.
+    // This method is called at the beginning of a pass. Jobs it leaves in the job queue
+    // run along with the tile jobs of the pass and complete before post_render() is called.
     virtual void pre_render(
         const Frame&                frame,
         foundation::JobQueue&       job_queue,
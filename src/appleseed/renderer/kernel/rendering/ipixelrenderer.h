@@ -37,6 +37,7 @@
 #include "foundation/core/concepts/iunknown.h"
 #include "foundation/math/aabb.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 
 // Standard headers.
 #include <cstddef>
@@ -71,6 +72,10 @@ class IPixelRenderer
         foundation::Tile&           tile,
         TileStack&                  aov_tiles) = 0;
 
+    // Return true if this pixel renderer stores diagnostics of the whole tile in on_tile_end(),
+    // in which case all the pixels of a tile must be rendered by the same pixel renderer.
+    virtual bool has_tile_diagnostics() const = 0;
+
     // Render a pixel.
     virtual void render_pixel(
         const Frame&                frame,
@@ -83,6 +88,9 @@ class IPixelRenderer
         SamplingContext::RNGType&   rng,
         ShadingResultFrameBuffer&   framebuffer) = 0;
 
+    // Return the number of rays traced so far by this pixel renderer.
+    virtual foundation::uint64 get_ray_count() const = 0;
+
     // Retrieve performance statistics.
     virtual foundation::StatisticsVector get_statistics() const = 0;
 };
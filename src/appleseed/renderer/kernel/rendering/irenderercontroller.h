@@ -36,6 +36,9 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 namespace renderer
 {
 
@@ -86,11 +89,23 @@ class APPLESEED_DLLSYMBOL IRendererController
         RestartRendering,
 
         // Restart rendering from scratch, taking into account any configuration changes.
-        ReinitializeRendering
+        ReinitializeRendering,
+
+        // Restart rendering after only the camera was moved: the camera is prepared again
+        // but the rest of the scene is rendered as it was prepared for the previous frame.
+        RestartRenderingAfterCameraChange
     };
 
     // Return the current rendering status.
     virtual Status get_status() const = 0;
+
+    // Return the number of rendering threads that should be actively rendering, or 0
+    // to use all of them. Called continuously during rendering, from the thread that
+    // calls on_progress(); threads beyond that number are parked until it grows again.
+    virtual size_t get_active_thread_count() const
+    {
+        return 0;
+    }
 };
 
 }       // namespace renderer
@@ -52,9 +52,24 @@ class ISampleGenerator
   : public foundation::IUnknown
 {
   public:
+    // Restrict the sample generator to one of several disjoint partitions of the sample
+    // sequence, so that the same frame can be rendered on several machines and their
+    // samples combined. Takes effect at the next reset().
+    virtual void set_sequence_partition(
+        const size_t                partition_index,
+        const size_t                partition_count) = 0;
+
     // Reset the sample generator to its initial state.
     virtual void reset() = 0;
 
+    // Skip the positions of the sample sequence before a given one, for instance
+    // those used by a render that is being resumed. Call after reset().
+    virtual void skip_sequence(const size_t sequence_begin) = 0;
+
+    // Return a position of the sample sequence beyond all the positions used
+    // since the last reset. Thread-safe.
+    virtual size_t get_sequence_end() const = 0;
+
     // Generate a given number of samples and accumulate them into a buffer.
     virtual void generate_samples(
         const size_t                sample_count,
@@ -36,6 +36,7 @@
 // appleseed.foundation headers.
 #include "foundation/core/concepts/iunknown.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 
 // Standard headers.
 #include <cstddef>
@@ -64,6 +65,19 @@ class ISampleRenderer
         const foundation::Vector2d&     image_point,
         ShadingResult&                  shading_result) = 0;
 
+    // Render a batch of samples of a given pixel. shading_results[i] receives the result
+    // of the sample at image_points[i] rendered with sampling_contexts[i]. Camera rays of
+    // the batch may be generated and traced together.
+    virtual void render_samples(
+        const size_t                    sample_count,
+        SamplingContext*                sampling_contexts,
+        const foundation::Vector2i&     pixel_coords,
+        const foundation::Vector2d*     image_points,
+        ShadingResult*                  shading_results) = 0;
+
+    // Return the number of rays traced so far by this sample renderer.
+    virtual foundation::uint64 get_ray_count() const = 0;
+
     // Retrieve performance statistics.
     virtual foundation::StatisticsVector get_statistics() const = 0;
 };
@@ -60,6 +60,11 @@ class ITileRenderer
         const size_t                pass_hash,
         foundation::IAbortSwitch&   abort_switch) = 0;
 
+    // Help other threads finish the tiles they are currently rendering.
+    // Return once there is no more work to share.
+    virtual void help_render_tiles(
+        foundation::IAbortSwitch&   abort_switch) = 0;
+
     // Retrieve performance statistics.
     virtual foundation::StatisticsVector get_statistics() const = 0;
 };
@@ -33,7 +33,10 @@
 // appleseed.renderer headers.
 #include "renderer/kernel/aov/imagestack.h"
 #include "renderer/kernel/aov/tilestack.h"
+#include "renderer/kernel/rendering/convergencemap.h"
+#include "renderer/kernel/rendering/pixelstatistics.h"
 #include "renderer/kernel/rendering/sample.h"
+#include "renderer/kernel/rendering/stripedfilteredtile.h"
 #include "renderer/modeling/frame/frame.h"
 
 // appleseed.foundation headers.
@@ -46,6 +49,7 @@
 #include "foundation/math/scalar.h"
 #include "foundation/platform/atomic.h"
 #include "foundation/platform/timers.h"
+#include "foundation/utility/job/abortswitch.h"
 #include "foundation/utility/job/iabortswitch.h"
 #include "foundation/utility/stopwatch.h"
 
@@ -70,6 +74,8 @@ namespace renderer
 //   quarter of the resolution of the previous one (half the resolution in each dimension).
 //   We don't actually go down all the way to the 1x1 level; instead we stop when we reach
 //   a resolution that we consider provides a good balance between speed and usefulness.
+//   The coarsest levels are only displayed when the progressive frame renderer is asked
+//   to show a first image with very few samples to meet a target latency.
 //
 //   At render-time, the store_samples() method pushes the individual samples through this
 //   pyramid. Samples are stored starting at the highest resolution level and up to what
@@ -77,22 +83,57 @@ namespace renderer
 //   pushing samples to and the level that is displayed. As soon as a level contains enough
 //   samples, it becomes the new active level.
 //
+//   Each level is partitioned into horizontal stripes that have their own locks (see
+//   StripedFilteredTile). Threads storing samples only contend with threads storing
+//   samples into the same stripes, and samples are accumulated without atomic updates.
+//   The read/write lock only serializes store_samples() against clear() and
+//   develop_to_frame().
+//
 
 //#define PRINT_DETAILED_PERF_REPORTS
 
 LocalSampleAccumulationBuffer::LocalSampleAccumulationBuffer(
+    const size_t        width,
+    const size_t        height,
+    const Filter2f&     filter,
+    ConvergenceMap*     convergence_map,
+    PixelStatistics*    pixel_stats)
+  : m_crop_window(Vector2u(0, 0), Vector2u(width - 1, height - 1))
+  , m_convergence_map(convergence_map)
+  , m_pixel_stats(pixel_stats)
+{
+    create_levels(width, height, filter);
+}
+
+LocalSampleAccumulationBuffer::LocalSampleAccumulationBuffer(
+    const size_t        width,
+    const size_t        height,
+    const AABB2u&       crop_window,
+    const Filter2f&     filter,
+    ConvergenceMap*     convergence_map,
+    PixelStatistics*    pixel_stats)
+  : m_crop_window(crop_window)
+  , m_convergence_map(convergence_map)
+  , m_pixel_stats(pixel_stats)
+{
+    create_levels(width, height, filter);
+}
+
+void LocalSampleAccumulationBuffer::create_levels(
     const size_t        width,
     const size_t        height,
     const Filter2f&     filter)
 {
-    const size_t MinSize = 32;
+    const size_t MinSize = 8;
 
-    size_t level_width = width;
-    size_t level_height = height;
+    // The pyramid only covers the crop window.
+    size_t level_width = m_crop_window.extent()[0] + 1;
+    size_t level_height = m_crop_window.extent()[1] + 1;
 
     while (true)
     {
         m_levels.push_back(new FilteredTile(level_width, level_height, 5, filter));
+        m_striped_levels.push_back(new StripedFilteredTile(*m_levels.back(), width, height, m_crop_window));
 
         if (level_width <= MinSize && level_height <= MinSize)
             break;
@@ -111,7 +152,10 @@ LocalSampleAccumulationBuffer::~LocalSampleAccumulationBuffer()
     delete[] m_remaining_pixels;
 
     for (size_t i = 0, e = m_levels.size(); i < e; ++i)
+    {
+        delete m_striped_levels[i];
         delete m_levels[i];
+    }
 }
 
 void LocalSampleAccumulationBuffer::clear()
@@ -140,6 +184,12 @@ void LocalSampleAccumulationBuffer::clear()
     }
 
     m_active_level = static_cast<uint32>(m_levels.size() - 1);
+
+    if (m_convergence_map)
+        m_convergence_map->clear();
+
+    if (m_pixel_stats)
+        m_pixel_stats->clear();
 }
 
 void LocalSampleAccumulationBuffer::store_samples(
@@ -167,28 +217,21 @@ void LocalSampleAccumulationBuffer::store_samples(
 #endif
 
         // Store samples at every level, starting with the highest resolution level up to the active level.
-        size_t counter = 0;
         for (uint32 i = 0, e = m_active_level; i <= e; ++i)
         {
-            FilteredTile* level = m_levels[i];
-            const float level_width = static_cast<float>(level->get_width());
-            const float level_height = static_cast<float>(level->get_height());
-
-            const Sample* sample_end = samples + sample_count;
-            for (const Sample* s = samples; s < sample_end; ++s)
+            if (!m_striped_levels[i]->store_samples(sample_count, samples, abort_switch))
             {
-                if ((counter++ & 4096) == 0 && abort_switch.is_aborted())
-                {
-                    m_lock.unlock_read();
-                    return;
-                }
-
-                const float fx = s->m_position.x * level_width;
-                const float fy = s->m_position.y * level_height;
-                level->add(fx, fy, s->m_values);
+                m_lock.unlock_read();
+                return;
             }
         }
 
+        if (m_convergence_map)
+            m_convergence_map->store_samples(sample_count, samples);
+
+        if (m_pixel_stats)
+            m_pixel_stats->store_samples(sample_count, samples);
+
         m_lock.unlock_read();
     }
 
@@ -201,28 +244,111 @@ void LocalSampleAccumulationBuffer::store_samples(
 
     // Potentially update the new active level if we're not already at the highest resolution level.
     if (m_active_level > 0)
+        update_active_level(sample_count, 0);
+}
+
+bool LocalSampleAccumulationBuffer::store_preview_samples(
+    const size_t        sample_count,
+    const Sample        samples[])
+{
+    // Preview samples are never stored at the highest resolution level, so that they
+    // disappear as soon as enough samples are rendered to display that level.
+    if (m_active_level == 0)
+        return false;
+
     {
-        // Update pixel counters for all levels up to the active level.
-        const int32 n = static_cast<int32>(sample_count);
-        for (uint32 i = 0, e = m_active_level; i <= e; ++i)
-            m_remaining_pixels[i].fetch_sub(n);
+        // Request non-exclusive access.
+        LockType::ScopedReadLock lock(m_lock);
+
+        AbortSwitch no_abort;
+        for (uint32 i = 1, e = m_active_level; i <= e; ++i)
+            m_striped_levels[i]->store_samples(sample_count, samples, no_abort);
+    }
+
+    update_active_level(sample_count, 1);
 
-        // Find the new active level.
-        uint32 cur_active_level = m_active_level;
-        uint32 new_active_level = cur_active_level;
-        for (uint32 i = 0, e = cur_active_level; i < e; ++i)
+    return true;
+}
+
+void LocalSampleAccumulationBuffer::update_active_level(
+    const size_t        sample_count,
+    const uint32        first_level)
+{
+    // Update pixel counters for the levels that received the samples.
+    const int32 n = static_cast<int32>(sample_count);
+    for (uint32 i = first_level, e = m_active_level; i <= e; ++i)
+        m_remaining_pixels[i].fetch_sub(n);
+
+    // Find the new active level.
+    uint32 cur_active_level = m_active_level;
+    uint32 new_active_level = cur_active_level;
+    for (uint32 i = 0, e = cur_active_level; i < e; ++i)
+    {
+        if (m_remaining_pixels[i] <= 0)
         {
-            if (m_remaining_pixels[i] <= 0)
-            {
-                new_active_level = i;
-                break;
-            }
+            new_active_level = i;
+            break;
         }
+    }
+
+    // Attempt to update the active level. It's OK if we fail, another thread will succeed.
+    if (new_active_level < cur_active_level)
+        m_active_level.compare_exchange_strong(cur_active_level, new_active_level);
+}
+
+bool LocalSampleAccumulationBuffer::is_converged() const
+{
+    return m_convergence_map != 0 && m_convergence_map->is_converged();
+}
+
+bool LocalSampleAccumulationBuffer::save_samples(ostream& output)
+{
+    // Request exclusive access.
+    LockType::ScopedWriteLock lock(m_lock);
+
+    return save_tile(output, *m_levels[0], m_sample_count);
+}
+
+bool LocalSampleAccumulationBuffer::load_samples(istream& input)
+{
+    clear();
+
+    // Request exclusive access.
+    LockType::ScopedWriteLock lock(m_lock);
 
-        // Attempt to update the active level. It's OK if we fail, another thread will succeed.
-        if (new_active_level < cur_active_level)
-            m_active_level.compare_exchange_strong(cur_active_level, new_active_level);
+    uint64 sample_count;
+    if (!load_tile(input, *m_levels[0], sample_count))
+    {
+        m_levels[0]->clear();
+        return false;
     }
+
+    m_sample_count = sample_count;
+
+    // Display and keep accumulating samples at the highest resolution level;
+    // lower resolution levels were not saved and remain empty.
+    m_remaining_pixels[0] = 0;
+    m_active_level = 0;
+
+    return true;
+}
+
+bool LocalSampleAccumulationBuffer::merge_samples(istream& input)
+{
+    // Request exclusive access.
+    LockType::ScopedWriteLock lock(m_lock);
+
+    uint64 sample_count;
+    if (!merge_tile(input, *m_levels[0], sample_count))
+        return false;
+
+    m_sample_count += sample_count;
+
+    // Only the highest resolution level holds the merged samples.
+    m_remaining_pixels[0] = 0;
+    m_active_level = 0;
+
+    return true;
 }
 
 void LocalSampleAccumulationBuffer::develop_to_frame(
@@ -252,18 +378,24 @@ void LocalSampleAccumulationBuffer::develop_to_frame(
     Image& depth_image = frame.aov_images().get_image(0);
 
     const CanvasProperties& frame_props = color_image.properties();
-    assert(frame_props.m_canvas_width == m_levels[0]->get_width());
-    assert(frame_props.m_canvas_height == m_levels[0]->get_height());
+    assert(m_crop_window == frame.get_crop_window());
+    assert(m_crop_window.max.x < frame_props.m_canvas_width);
+    assert(m_crop_window.max.y < frame_props.m_canvas_height);
     assert(frame_props.m_channel_count == 4);
 
-    const AABB2u& crop_window = frame.get_crop_window();
     const bool undo_premultiplied_alpha = !frame.is_premultiplied_alpha();
 
     const FilteredTile& level = *m_levels[m_active_level];
 
-    for (size_t ty = 0; ty < frame_props.m_tile_count_y; ++ty)
+    // Only visit the tiles that intersect the crop window, leaving the others unallocated.
+    const size_t min_tx = m_crop_window.min.x / frame_props.m_tile_width;
+    const size_t min_ty = m_crop_window.min.y / frame_props.m_tile_height;
+    const size_t max_tx = m_crop_window.max.x / frame_props.m_tile_width;
+    const size_t max_ty = m_crop_window.max.y / frame_props.m_tile_height;
+
+    for (size_t ty = min_ty; ty <= max_ty; ++ty)
     {
-        for (size_t tx = 0; tx < frame_props.m_tile_count_x; ++tx)
+        for (size_t tx = min_tx; tx <= max_tx; ++tx)
         {
             if (abort_switch.is_aborted())
             {
@@ -281,15 +413,14 @@ void LocalSampleAccumulationBuffer::develop_to_frame(
                 Vector2u(origin_x, origin_y),
                 Vector2u(origin_x + color_tile.get_width() - 1, origin_y + color_tile.get_height() - 1));
 
-            const AABB2u rect = AABB2u::intersect(tile_rect, crop_window);
+            const AABB2u rect = AABB2u::intersect(tile_rect, m_crop_window);
 
             if (undo_premultiplied_alpha)
             {
                 develop_to_tile_undo_premult_alpha(
                     color_tile,
                     depth_tile,
-                    frame_props.m_canvas_width,
-                    frame_props.m_canvas_height,
+                    m_crop_window,
                     level,
                     origin_x,
                     origin_y,
@@ -300,8 +431,7 @@ void LocalSampleAccumulationBuffer::develop_to_frame(
                 develop_to_tile(
                     color_tile,
                     depth_tile,
-                    frame_props.m_canvas_width,
-                    frame_props.m_canvas_height,
+                    m_crop_window,
                     level,
                     origin_x,
                     origin_y,
@@ -322,8 +452,7 @@ void LocalSampleAccumulationBuffer::develop_to_frame(
 void LocalSampleAccumulationBuffer::develop_to_tile_undo_premult_alpha(
     Tile&               color_tile,
     Tile&               depth_tile,
-    const size_t        image_width,
-    const size_t        image_height,
+    const AABB2u&       window,
     const FilteredTile& level,
     const size_t        origin_x,
     const size_t        origin_y,
@@ -332,32 +461,40 @@ void LocalSampleAccumulationBuffer::develop_to_tile_undo_premult_alpha(
     if (rect.min.x > rect.max.x)
         return;
 
+    assert(window.contains(rect.min));
+    assert(window.contains(rect.max));
+
+    // Pixels are addressed relatively to the window in the level, and relatively to the tile in the tile.
+    const size_t window_width = window.extent()[0] + 1;
+    const size_t window_height = window.extent()[1] + 1;
     const size_t level_width = level.get_width();
-    const size_t m = image_width / level_width;
+    const size_t m = window_width / level_width;
+    const size_t min_x = rect.min.x - window.min.x;
+    const size_t max_x = rect.max.x - window.min.x;
 
-    if (image_width % level_width == 0 && is_pow2(m))
+    if (window_width % level_width == 0 && is_pow2(m))
     {
         const size_t s = log2_int(m);
-        const size_t prefix_end = min(next_multiple(rect.min.x, m), rect.max.x + 1);
-        const size_t suffix_begin = max(prev_multiple(rect.max.x + 1, m), prefix_end);
+        const size_t prefix_end = min(next_multiple(min_x, m), max_x + 1);
+        const size_t suffix_begin = max(prev_multiple(max_x + 1, m), prefix_end);
 
         for (size_t iy = rect.min.y; iy <= rect.max.y; ++iy)
         {
-            const size_t src_base = (iy * level.get_height() / image_height) * level_width;
-            const size_t dest_base = (iy - origin_y) * color_tile.get_width();
+            const size_t src_base = ((iy - window.min.y) * level.get_height() / window_height) * level_width;
+            const size_t dest_base = (iy - origin_y) * color_tile.get_width() + window.min.x - origin_x;
 
             Color<float, 5> values;
 
             // Prefix.
-            for (size_t ix = rect.min.x; ix < prefix_end; ++ix)
+            for (size_t ix = min_x; ix < prefix_end; ++ix)
             {
-                level.get_pixel(src_base + (rect.min.x >> s), &values[0]);
+                level.get_pixel(src_base + (min_x >> s), &values[0]);
                 const float rcp_alpha = values[3] == 0.0f ? 0.0f : 1.0f / values[3];
                 values[0] *= rcp_alpha;
                 values[1] *= rcp_alpha;
                 values[2] *= rcp_alpha;
-                color_tile.set_pixel<float>(dest_base + ix - origin_x, &values[0]);
-                depth_tile.set_component(dest_base + ix - origin_x, 0, values[4]);
+                color_tile.set_pixel<float>(dest_base + ix, &values[0]);
+                depth_tile.set_component(dest_base + ix, 0, values[4]);
             }
 
             // Quick run.
@@ -370,21 +507,21 @@ void LocalSampleAccumulationBuffer::develop_to_tile_undo_premult_alpha(
                 values[2] *= rcp_alpha;
                 for (size_t j = 0; j < m; ++j)
                 {
-                    color_tile.set_pixel<float>(dest_base + ix + j - origin_x, &values[0]);
-                    depth_tile.set_component(dest_base + ix + j - origin_x, 0, values[4]);
+                    color_tile.set_pixel<float>(dest_base + ix + j, &values[0]);
+                    depth_tile.set_component(dest_base + ix + j, 0, values[4]);
                 }
             }
 
             // Suffix.
-            for (size_t ix = suffix_begin; ix < rect.max.x + 1; ++ix)
+            for (size_t ix = suffix_begin; ix < max_x + 1; ++ix)
             {
-                level.get_pixel(src_base + (rect.max.x >> s), &values[0]);
+                level.get_pixel(src_base + (max_x >> s), &values[0]);
                 const float rcp_alpha = values[3] == 0.0f ? 0.0f : 1.0f / values[3];
                 values[0] *= rcp_alpha;
                 values[1] *= rcp_alpha;
                 values[2] *= rcp_alpha;
-                color_tile.set_pixel<float>(dest_base + ix - origin_x, &values[0]);
-                depth_tile.set_component(dest_base + ix - origin_x, 0, values[4]);
+                color_tile.set_pixel<float>(dest_base + ix, &values[0]);
+                depth_tile.set_component(dest_base + ix, 0, values[4]);
             }
         }
     }
@@ -392,15 +529,15 @@ void LocalSampleAccumulationBuffer::develop_to_tile_undo_premult_alpha(
     {
         for (size_t iy = rect.min.y; iy <= rect.max.y; ++iy)
         {
-            const size_t src_base = (iy * level.get_height() / image_height) * level_width;
-            const size_t dest_base = (iy - origin_y) * color_tile.get_width() - origin_x;
+            const size_t src_base = ((iy - window.min.y) * level.get_height() / window_height) * level_width;
+            const size_t dest_base = (iy - origin_y) * color_tile.get_width() + window.min.x - origin_x;
 
-            for (size_t ix = rect.min.x; ix <= rect.max.x; ++ix)
+            for (size_t ix = min_x; ix <= max_x; ++ix)
             {
                 Color<float, 5> values;
 
                 level.get_pixel(
-                    src_base + ix * level_width / image_width,
+                    src_base + ix * level_width / window_width,
                     &values[0]);
 
                 const float rcp_alpha = values[3] == 0.0f ? 0.0f : 1.0f / values[3];
@@ -418,8 +555,7 @@ void LocalSampleAccumulationBuffer::develop_to_tile_undo_premult_alpha(
 void LocalSampleAccumulationBuffer::develop_to_tile(
     Tile&               color_tile,
     Tile&               depth_tile,
-    const size_t        image_width,
-    const size_t        image_height,
+    const AABB2u&       window,
     const FilteredTile& level,
     const size_t        origin_x,
     const size_t        origin_y,
@@ -428,28 +564,36 @@ void LocalSampleAccumulationBuffer::develop_to_tile(
     if (rect.min.x > rect.max.x)
         return;
 
+    assert(window.contains(rect.min));
+    assert(window.contains(rect.max));
+
+    // Pixels are addressed relatively to the window in the level, and relatively to the tile in the tile.
+    const size_t window_width = window.extent()[0] + 1;
+    const size_t window_height = window.extent()[1] + 1;
     const size_t level_width = level.get_width();
-    const size_t m = image_width / level_width;
+    const size_t m = window_width / level_width;
+    const size_t min_x = rect.min.x - window.min.x;
+    const size_t max_x = rect.max.x - window.min.x;
 
-    if (image_width % level_width == 0 && is_pow2(m))
+    if (window_width % level_width == 0 && is_pow2(m))
     {
         const size_t s = log2_int(m);
-        const size_t prefix_end = min(next_multiple(rect.min.x, m), rect.max.x + 1);
-        const size_t suffix_begin = max(prev_multiple(rect.max.x + 1, m), prefix_end);
+        const size_t prefix_end = min(next_multiple(min_x, m), max_x + 1);
+        const size_t suffix_begin = max(prev_multiple(max_x + 1, m), prefix_end);
 
         for (size_t iy = rect.min.y; iy <= rect.max.y; ++iy)
         {
-            const size_t src_base = (iy * level.get_height() / image_height) * level_width;
-            const size_t dest_base = (iy - origin_y) * color_tile.get_width();
+            const size_t src_base = ((iy - window.min.y) * level.get_height() / window_height) * level_width;
+            const size_t dest_base = (iy - origin_y) * color_tile.get_width() + window.min.x - origin_x;
 
             Color<float, 5> values;
 
             // Prefix.
-            level.get_pixel(src_base + (rect.min.x >> s), &values[0]);
-            for (size_t ix = rect.min.x; ix < prefix_end; ++ix)
+            level.get_pixel(src_base + (min_x >> s), &values[0]);
+            for (size_t ix = min_x; ix < prefix_end; ++ix)
             {
-                color_tile.set_pixel<float>(dest_base + ix - origin_x, &values[0]);
-                depth_tile.set_component(dest_base + ix - origin_x, 0, values[4]);
+                color_tile.set_pixel<float>(dest_base + ix, &values[0]);
+                depth_tile.set_component(dest_base + ix, 0, values[4]);
             }
 
             // Quick run.
@@ -458,17 +602,17 @@ void LocalSampleAccumulationBuffer::develop_to_tile(
                 level.get_pixel(src_base + (ix >> s), &values[0]);
                 for (size_t j = 0; j < m; ++j)
                 {
-                    color_tile.set_pixel<float>(dest_base + ix + j - origin_x, &values[0]);
-                    depth_tile.set_component(dest_base + ix + j - origin_x, 0, values[4]);
+                    color_tile.set_pixel<float>(dest_base + ix + j, &values[0]);
+                    depth_tile.set_component(dest_base + ix + j, 0, values[4]);
                 }
             }
 
             // Suffix.
-            level.get_pixel(src_base + (rect.max.x >> s), &values[0]);
-            for (size_t ix = suffix_begin; ix < rect.max.x + 1; ++ix)
+            level.get_pixel(src_base + (max_x >> s), &values[0]);
+            for (size_t ix = suffix_begin; ix < max_x + 1; ++ix)
             {
-                color_tile.set_pixel<float>(dest_base + ix - origin_x, &values[0]);
-                depth_tile.set_component(dest_base + ix - origin_x, 0, values[4]);
+                color_tile.set_pixel<float>(dest_base + ix, &values[0]);
+                depth_tile.set_component(dest_base + ix, 0, values[4]);
             }
         }
     }
@@ -476,19 +620,19 @@ void LocalSampleAccumulationBuffer::develop_to_tile(
     {
         for (size_t iy = rect.min.y; iy <= rect.max.y; ++iy)
         {
-            const size_t src_base = (iy * level.get_height() / image_height) * level_width;
-            const size_t dest_base = (iy - origin_y) * color_tile.get_width();
+            const size_t src_base = ((iy - window.min.y) * level.get_height() / window_height) * level_width;
+            const size_t dest_base = (iy - origin_y) * color_tile.get_width() + window.min.x - origin_x;
 
-            for (size_t ix = rect.min.x; ix <= rect.max.x; ++ix)
+            for (size_t ix = min_x; ix <= max_x; ++ix)
             {
                 Color<float, 5> values;
 
                 level.get_pixel(
-                    src_base + ix * level_width / image_width,
+                    src_base + ix * level_width / window_width,
                     &values[0]);
 
-                color_tile.set_pixel<float>(dest_base + ix - origin_x, &values[0]);
-                depth_tile.set_component(dest_base + ix - origin_x, 0, values[4]);
+                color_tile.set_pixel<float>(dest_base + ix, &values[0]);
+                depth_tile.set_component(dest_base + ix, 0, values[4]);
             }
         }
     }
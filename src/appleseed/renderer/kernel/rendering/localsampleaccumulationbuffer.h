@@ -43,14 +43,19 @@
 
 // Standard headers.
 #include <cstddef>
+#include <istream>
+#include <ostream>
 #include <vector>
 
 // Forward declarations.
 namespace foundation    { class FilteredTile; }
 namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class Tile; }
+namespace renderer      { class ConvergenceMap; }
 namespace renderer      { class Frame; }
+namespace renderer      { class PixelStatistics; }
 namespace renderer      { class Sample; }
+namespace renderer      { class StripedFilteredTile; }
 
 namespace renderer
 {
@@ -59,11 +64,23 @@ class LocalSampleAccumulationBuffer
   : public SampleAccumulationBuffer
 {
   public:
-    // Constructor.
+    // Constructor. If a convergence map or pixel statistics are provided, they are
+    // updated with every sample stored into the buffer. They are not owned by the buffer.
     LocalSampleAccumulationBuffer(
         const size_t                        width,
         const size_t                        height,
-        const foundation::Filter2f&         filter);
+        const foundation::Filter2f&         filter,
+        ConvergenceMap*                     convergence_map = 0,
+        PixelStatistics*                    pixel_stats = 0);
+
+    // Constructor. Only pixels inside the crop window are allocated and developed.
+    LocalSampleAccumulationBuffer(
+        const size_t                        width,
+        const size_t                        height,
+        const foundation::AABB2u&           crop_window,
+        const foundation::Filter2f&         filter,
+        ConvergenceMap*                     convergence_map = 0,
+        PixelStatistics*                    pixel_stats = 0);
 
     // Destructor.
     ~LocalSampleAccumulationBuffer();
@@ -82,12 +99,32 @@ class LocalSampleAccumulationBuffer
         Frame&                              frame,
         foundation::IAbortSwitch&           abort_switch) APPLESEED_OVERRIDE;
 
+    // Store preview samples into every level but the highest resolution one, which
+    // only ever receives rendered samples. Thread-safe.
+    virtual bool store_preview_samples(
+        const size_t                        sample_count,
+        const Sample                        samples[]) APPLESEED_OVERRIDE;
+
+    // Return true if all pixels of the convergence map have converged. Thread-safe.
+    virtual bool is_converged() const APPLESEED_OVERRIDE;
+
+    // Write the samples accumulated at the highest resolution level to a stream. Thread-safe.
+    virtual bool save_samples(std::ostream& output) APPLESEED_OVERRIDE;
+
+    // Replace the content of the buffer by samples written by save_samples().
+    // Only the highest resolution level is restored and becomes the active level. Thread-safe.
+    virtual bool load_samples(std::istream& input) APPLESEED_OVERRIDE;
+
+    // Add samples written by save_samples() to the content of the buffer. Thread-safe.
+    virtual bool merge_samples(std::istream& input) APPLESEED_OVERRIDE;
+
+    // Develop the pixels of `rect` (in image space) from a level covering the region
+    // `window` of the image to a tile whose top-left pixel is at (origin_x, origin_y).
     // Exposed for tests and benchmarks.
     static void develop_to_tile_undo_premult_alpha(
         foundation::Tile&                   color_tile,
         foundation::Tile&                   depth_tile,
-        const size_t                        image_width,
-        const size_t                        image_height,
+        const foundation::AABB2u&           window,
         const foundation::FilteredTile&     level,
         const size_t                        origin_x,
         const size_t                        origin_y,
@@ -95,8 +132,7 @@ class LocalSampleAccumulationBuffer
     static void develop_to_tile(
         foundation::Tile&                   color_tile,
         foundation::Tile&                   depth_tile,
-        const size_t                        image_width,
-        const size_t                        image_height,
+        const foundation::AABB2u&           window,
         const foundation::FilteredTile&     level,
         const size_t                        origin_x,
         const size_t                        origin_y,
@@ -108,9 +144,22 @@ class LocalSampleAccumulationBuffer
     > LockType;
 
     LockType                                m_lock;
+    const foundation::AABB2u                m_crop_window;
     std::vector<foundation::FilteredTile*>  m_levels;
+    std::vector<StripedFilteredTile*>       m_striped_levels;
     boost::atomic<foundation::int32>*       m_remaining_pixels;
     boost::atomic<foundation::uint32>       m_active_level;
+    ConvergenceMap*                         m_convergence_map;
+    PixelStatistics*                        m_pixel_stats;
+
+    void create_levels(
+        const size_t                        width,
+        const size_t                        height,
+        const foundation::Filter2f&         filter);
+
+    void update_active_level(
+        const size_t                        sample_count,
+        const foundation::uint32            first_level);
 };
 
 }       // namespace renderer
@@ -32,28 +32,65 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/aov/imagestack.h"
+#include "renderer/kernel/aov/objectidbuffer.h"
+#include "renderer/kernel/intersection/assemblytree.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/lighting/lightsampler.h"
+#include "renderer/kernel/rendering/framedenoiser.h"
 #include "renderer/kernel/rendering/iframerenderer.h"
+#include "renderer/kernel/rendering/memorybudget.h"
+#include "renderer/kernel/rendering/primaryhitcache.h"
 #include "renderer/kernel/rendering/renderercomponents.h"
 #include "renderer/kernel/rendering/serialrenderercontroller.h"
 #include "renderer/kernel/rendering/serialtilecallback.h"
+#include "renderer/kernel/rendering/telemetrymonitor.h"
+#include "renderer/kernel/tessellation/meshdicer.h"
 #include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/kernel/volume/volumebrickstore.h"
 #include "renderer/modeling/display/display.h"
 #include "renderer/modeling/entity/onframebeginrecorder.h"
 #include "renderer/modeling/frame/frame.h"
 #include "renderer/modeling/input/inputbinder.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
 #include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/hotpathcounters.h"
+#include "renderer/utility/renderstatistics.h"
+#include "renderer/utility/settingsparsing.h"
+#include "renderer/utility/shadingprofiler.h"
+#include "renderer/utility/startupprofiler.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/system.h"
 #include "foundation/platform/thread.h"
+#include "foundation/utility/eventtracer.h"
+#include "foundation/utility/foreach.h"
 #include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/makevector.h"
+#include "foundation/utility/memory.h"
+#include "foundation/utility/memoryaccounting.h"
 #include "foundation/utility/otherwise.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <exception>
+#include <fstream>
+#include <memory>
+#include <set>
 #include <string>
 
 using namespace foundation;
@@ -77,6 +114,9 @@ MasterRenderer::MasterRenderer(
   , m_serial_renderer_controller(0)
   , m_serial_tile_callback_factory(0)
   , m_display(0)
+  , m_telemetry_callback(0)
+  , m_light_sampler(0)
+  , m_primary_hit_cache(0)
 {
     if (m_tile_callback_factory == 0)
     {
@@ -100,6 +140,9 @@ MasterRenderer::MasterRenderer(
   , m_serial_tile_callback_factory(
         new SerialTileCallbackFactory(m_serial_renderer_controller))
   , m_display(0)
+  , m_telemetry_callback(0)
+  , m_light_sampler(0)
+  , m_primary_hit_cache(0)
 {
     m_renderer_controller = m_serial_renderer_controller;
     m_tile_callback_factory = m_serial_tile_callback_factory;
@@ -110,6 +153,8 @@ MasterRenderer::~MasterRenderer()
     if (m_display)
         m_display->close();
 
+    delete m_light_sampler;
+    delete m_primary_hit_cache;
     delete m_serial_tile_callback_factory;
     delete m_serial_renderer_controller;
 }
@@ -160,6 +205,16 @@ bool MasterRenderer::render()
 #endif
 }
 
+StatisticsVector MasterRenderer::get_render_statistics() const
+{
+    return global_render_statistics().get_statistics();
+}
+
+void MasterRenderer::set_telemetry_callback(ITelemetryCallback* callback)
+{
+    m_telemetry_callback = callback;
+}
+
 bool MasterRenderer::do_render()
 {
     while (true)
@@ -210,71 +265,704 @@ namespace
       private:
         IRendererController& m_renderer_controller;
     };
+
+    // Wait for background tree construction to complete when going out of scope. The scene
+    // must no longer be accessed by background tree builds once rendering has ended, since
+    // it may be modified as soon as rendering returns.
+    class TreeConstructionWaiter
+      : public NonCopyable
+    {
+      public:
+        explicit TreeConstructionWaiter(const Project& project)
+          : m_project(project)
+        {
+        }
+
+        ~TreeConstructionWaiter()
+        {
+            wait();
+        }
+
+        void wait() const
+        {
+            if (m_project.has_trace_context())
+                m_project.get_trace_context().wait_for_tree_construction();
+        }
+
+      private:
+        const Project& m_project;
+    };
+
+    //
+    // Memory pools of the renderer-wide memory budget.
+    //
+
+    class RayTracingTreesPool
+      : public MemoryBudget::IPool
+    {
+      public:
+        explicit RayTracingTreesPool(const Project& project)
+          : m_project(project)
+        {
+        }
+
+        virtual size_t get_memory_size() const APPLESEED_OVERRIDE
+        {
+            if (!m_project.has_trace_context())
+                return 0;
+
+            const AssemblyTree& assembly_tree = m_project.get_trace_context().get_assembly_tree();
+
+            return
+                  assembly_tree.get_memory_size()
+                + assembly_tree.get_triangle_trees_memory_size();
+        }
+
+      private:
+        const Project& m_project;
+    };
+
+    size_t get_image_memory_size(const Image& image)
+    {
+        const CanvasProperties& props = image.properties();
+        return props.m_pixel_count * props.m_pixel_size;
+    }
+
+    class FramePool
+      : public MemoryBudget::IPool
+    {
+      public:
+        explicit FramePool(const Frame& frame)
+          : m_frame(frame)
+        {
+        }
+
+        virtual size_t get_memory_size() const APPLESEED_OVERRIDE
+        {
+            size_t memory_size = get_image_memory_size(m_frame.image());
+
+            const ImageStack& aov_images = m_frame.aov_images();
+            for (size_t i = 0, e = aov_images.size(); i < e; ++i)
+                memory_size += get_image_memory_size(aov_images.get_image(i));
+
+            return memory_size;
+        }
+
+      private:
+        const Frame& m_frame;
+    };
+
+    class TextureStorePool
+      : public MemoryBudget::IPool
+    {
+      public:
+        explicit TextureStorePool(const TextureStore& texture_store)
+          : m_texture_store(texture_store)
+        {
+        }
+
+        virtual size_t get_memory_size() const APPLESEED_OVERRIDE
+        {
+            return m_texture_store.get_memory_size();
+        }
+
+      private:
+        const TextureStore& m_texture_store;
+    };
+
+    class VolumeBrickStorePool
+      : public MemoryBudget::IPool
+    {
+      public:
+        explicit VolumeBrickStorePool(const VolumeBrickStore& volume_brick_store)
+          : m_volume_brick_store(volume_brick_store)
+        {
+        }
+
+        virtual size_t get_memory_size() const APPLESEED_OVERRIDE
+        {
+            return m_volume_brick_store.get_memory_size();
+        }
+
+      private:
+        const VolumeBrickStore& m_volume_brick_store;
+    };
+
+    //
+    // Exposes the memory used by all other pools of the memory budget to the texture store
+    // or to the volume brick store, so that the store evicts its content whenever the whole
+    // budget is exceeded.
+    //
+
+    class MemoryBudgetCache
+      : public TextureStore::IExternalCache
+    {
+      public:
+        MemoryBudgetCache(
+            MemoryBudget&   memory_budget,
+            const size_t    store_pool_index)
+          : m_memory_budget(memory_budget)
+          , m_store_pool_index(store_pool_index)
+        {
+        }
+
+        virtual size_t get_memory_size() const APPLESEED_OVERRIDE
+        {
+            const size_t total_memory_size = m_memory_budget.poll();
+            const size_t store_memory_size =
+                m_memory_budget.get_pool_memory_size(m_store_pool_index);
+
+            return
+                total_memory_size > store_memory_size
+                    ? total_memory_size - store_memory_size
+                    : 0;
+        }
+
+      private:
+        MemoryBudget&   m_memory_budget;
+        const size_t    m_store_pool_index;
+    };
+
+    // Make a volume brick store available to the entities of a project while it is alive.
+    class VolumeBrickStoreBinding
+      : public NonCopyable
+    {
+      public:
+        VolumeBrickStoreBinding(
+            Project&            project,
+            VolumeBrickStore&   volume_brick_store)
+          : m_project(project)
+        {
+            m_project.set_volume_brick_store(&volume_brick_store);
+        }
+
+        ~VolumeBrickStoreBinding()
+        {
+            m_project.set_volume_brick_store(0);
+        }
+
+      private:
+        Project&    m_project;
+    };
+
+    // Estimate the memory used by the mesh objects of a hierarchy of assemblies.
+    size_t estimate_geometry_memory_size(const AssemblyContainer& assemblies)
+    {
+        size_t size = 0;
+
+        for (const_each<AssemblyContainer> i = assemblies; i; ++i)
+        {
+            for (const_each<ObjectContainer> j = i->objects(); j; ++j)
+            {
+                const MeshObject* mesh = dynamic_cast<const MeshObject*>(&*j);
+
+                if (mesh)
+                {
+                    const size_t pose_count = mesh->get_motion_segment_count() + 1;
+                    size +=
+                          (mesh->get_vertex_count() + mesh->get_vertex_normal_count() + mesh->get_vertex_tangent_count())
+                        * pose_count * sizeof(GVector3)
+                        + mesh->get_tex_coords_count() * sizeof(GVector2)
+                        + mesh->get_triangle_count() * sizeof(Triangle);
+                }
+            }
+
+            size += estimate_geometry_memory_size(i->assemblies());
+        }
+
+        return size;
+    }
+
+    // Collect the objects of a hierarchy of assemblies that are instanced with an emitting material.
+    void collect_emitting_objects(
+        const AssemblyContainer&    assemblies,
+        set<const Object*>&         objects)
+    {
+        for (const_each<AssemblyContainer> i = assemblies; i; ++i)
+        {
+            for (const_each<ObjectInstanceContainer> j = i->object_instances(); j; ++j)
+            {
+                if (has_emitting_materials(j->get_front_materials()) ||
+                    has_emitting_materials(j->get_back_materials()))
+                    objects.insert(&j->get_object());
+            }
+
+            collect_emitting_objects(i->assemblies(), objects);
+        }
+    }
+
+    // Release the vertices of the mesh objects of a hierarchy of assemblies, except those of
+    // emitting objects which the light sampler reads. Return the number of released objects.
+    size_t release_mesh_vertices(
+        AssemblyContainer&          assemblies,
+        const set<const Object*>&   emitting_objects)
+    {
+        size_t count = 0;
+
+        for (each<AssemblyContainer> i = assemblies; i; ++i)
+        {
+            for (each<ObjectContainer> j = i->objects(); j; ++j)
+            {
+                MeshObject* mesh = dynamic_cast<MeshObject*>(&*j);
+
+                if (mesh && emitting_objects.find(mesh) == emitting_objects.end())
+                {
+                    mesh->release_vertices();
+
+                    if (mesh->has_released_vertices())
+                        ++count;
+                }
+            }
+
+            count += release_mesh_vertices(i->assemblies(), emitting_objects);
+        }
+
+        return count;
+    }
+
+    HugePageMode get_huge_page_mode_param(const ParamArray& params)
+    {
+        const string value =
+            params.get_optional<string>(
+                "huge_pages",
+                "disabled",
+                make_vector("disabled", "transparent", "explicit"));
+
+        return
+            value == "transparent" ? HugePagesTransparent :
+            value == "explicit" ? HugePagesExplicit :
+            HugePagesDisabled;
+    }
+
+    // Record an event trace of a render and export it to a file, if a trace file was specified.
+    class EventTraceSession
+      : public NonCopyable
+    {
+      public:
+        explicit EventTraceSession(const ParamArray& params)
+          : m_filepath(params.get_optional<string>("trace_file", ""))
+        {
+            if (!m_filepath.empty())
+            {
+                EventTracer& tracer = global_event_tracer();
+                tracer.clear();
+                tracer.set_thread_name("master_renderer");
+                tracer.set_enabled(true);
+            }
+        }
+
+        ~EventTraceSession()
+        {
+            if (!m_filepath.empty())
+            {
+                EventTracer& tracer = global_event_tracer();
+                tracer.set_enabled(false);
+
+                if (tracer.write_chrome_trace(m_filepath.c_str()))
+                {
+                    RENDERER_LOG_INFO(
+                        "wrote %s %s to %s.",
+                        pretty_uint(tracer.get_event_count()).c_str(),
+                        plural(tracer.get_event_count(), "trace event").c_str(),
+                        m_filepath.c_str());
+                }
+                else RENDERER_LOG_ERROR("failed to write event trace to %s.", m_filepath.c_str());
+            }
+        }
+
+      private:
+        const string m_filepath;
+    };
 }
 
 IRendererController::Status MasterRenderer::initialize_and_render_frame_sequence()
 {
+    // Report peak memory usage for this render only.
+    reset_peak_accounted_memory_sizes();
+
+    // Only export statistics of this render.
+    global_render_statistics().clear();
+
+    // Let large arrays such as ray tracing tree nodes and big texture tiles use huge pages.
+    set_huge_page_mode(get_huge_page_mode_param(m_params));
+
     // Construct an abort switch based on the renderer controller.
     RendererControllerAbortSwitch abort_switch(*m_renderer_controller);
 
+    // Record a timeline of the render if requested.
+    EventTraceSession trace_session(m_params);
+
+    // Time the preparation of the render, until the first frame starts.
+    auto_ptr<StartupPhase> setup_phase(new StartupPhase("render setup"));
+
     // We start by expanding all procedural assemblies.
-    if (!m_project.get_scene()->expand_procedural_assemblies(m_project, &abort_switch))
-        return IRendererController::AbortRendering;
+    {
+        StartupPhase phase("procedural expansion");
+        if (!m_project.get_scene()->expand_procedural_assemblies(m_project, &abort_switch))
+            return IRendererController::AbortRendering;
+    }
 
     // Bind entities inputs. This must be done before creating/updating the trace context.
-    if (!bind_scene_entities_inputs())
-        return IRendererController::AbortRendering;
+    {
+        StartupPhase phase("input binding");
+        if (!bind_scene_entities_inputs())
+            return IRendererController::AbortRendering;
+    }
+
+    // Dice mesh objects that request it. This must also be done before creating/updating the trace context.
+    {
+        StartupPhase phase("mesh dicing");
+        MeshDicer mesh_dicer(m_project, m_params.child("dicing"));
+        if (!mesh_dicer.dice(&abort_switch))
+            return m_renderer_controller->get_status();
+    }
 
     m_project.create_aov_images();
-    m_project.update_trace_context();
+    TreeConstructionWaiter tree_construction_waiter(m_project);
+    const bool background_tree_construction =
+        m_params.get_optional<bool>("background_tree_construction", false);
+    m_project.set_background_tree_construction(background_tree_construction);
+
+    {
+        StartupPhase phase("trace context update");
+        m_project.update_trace_context();
+    }
+
+    // Triangle trees hold their own copy of the vertices: optionally release the ones of mesh objects.
+    // This requires all trees to be built now, and prevents them from being rebuilt in later renders.
+    if (m_params.get_optional<bool>("release_mesh_vertices", false))
+    {
+        if (background_tree_construction)
+            RENDERER_LOG_WARNING("mesh vertices are not released when triangle trees are built in the background.");
+        else
+        {
+            set<const Object*> emitting_objects;
+            collect_emitting_objects(m_project.get_scene()->assemblies(), emitting_objects);
+
+            const size_t count = release_mesh_vertices(m_project.get_scene()->assemblies(), emitting_objects);
+            RENDERER_LOG_INFO(
+                "released the vertices of %s %s.",
+                pretty_uint(count).c_str(),
+                plural(count, "mesh object").c_str());
+        }
+    }
+
+    // Account for the memory used by mesh geometry.
+    MemoryAccount geometry_memory_account(MemoryTagGeometry);
+    geometry_memory_account.set_size(estimate_geometry_memory_size(m_project.get_scene()->assemblies()));
+
     m_project.get_frame()->print_settings();
 
+    // Report CPU restrictions (affinity, container CPU quota) that reduce the default thread count.
+    const size_t logical_core_count = System::get_logical_cpu_core_count();
+    const size_t available_core_count = System::get_available_cpu_core_count();
+    if (available_core_count < logical_core_count)
+    {
+        RENDERER_LOG_INFO(
+            "process is restricted to %s of %s logical cores, automatic thread counts will be based on %s %s.",
+            pretty_uint(available_core_count).c_str(),
+            pretty_uint(logical_core_count).c_str(),
+            pretty_uint(available_core_count).c_str(),
+            plural(available_core_count, "core").c_str());
+    }
+
+    // Create the renderer-wide memory budget if one is set. The texture store and the
+    // volume brick store may then use the whole budget, minus the memory used by all other pools.
+    // When no budget is set but the process runs under a memory limit (e.g. in a container),
+    // a budget is derived from that limit so that caches don't grow until the process is killed.
+    ParamArray texture_store_params = m_params.child("texture_store");
+    ParamArray volume_store_params = m_params.child("volume_store");
+    auto_ptr<MemoryBudget> memory_budget;
+    size_t max_memory = m_params.get_optional<size_t>("max_memory", 0);
+    if (max_memory == 0)
+    {
+        const uint64 total_memory = System::get_total_physical_memory_size();
+        const uint64 available_memory = System::get_available_physical_memory_size();
+        if (available_memory < total_memory)
+        {
+            max_memory = static_cast<size_t>(available_memory / 4 * 3);
+            RENDERER_LOG_INFO(
+                "process memory is limited to %s, deriving renderer memory budget from that limit.",
+                pretty_size(available_memory).c_str());
+        }
+    }
+    if (max_memory > 0)
+    {
+        RENDERER_LOG_INFO("setting renderer memory budget to %s.", pretty_size(max_memory).c_str());
+        memory_budget.reset(new MemoryBudget(max_memory));
+        memory_budget->register_pool(
+            "ray tracing trees",
+            MemoryBudget::FixedPool,
+            auto_ptr<MemoryBudget::IPool>(new RayTracingTreesPool(m_project)));
+        memory_budget->register_pool(
+            "frame",
+            MemoryBudget::FixedPool,
+            auto_ptr<MemoryBudget::IPool>(new FramePool(*m_project.get_frame())));
+        texture_store_params.insert("max_size", max_memory);
+        volume_store_params.insert("max_size", max_memory);
+    }
+
     // Create the texture store.
     TextureStore texture_store(
         *m_project.get_scene(),
-        m_params.child("texture_store"));
+        texture_store_params);
 
-    if (!initialize_shading_system(texture_store, abort_switch))
-        return IRendererController::AbortRendering;
+    if (memory_budget.get())
+    {
+        const size_t pool_index =
+            memory_budget->register_pool(
+                "texture store",
+                MemoryBudget::EvictablePool,
+                auto_ptr<MemoryBudget::IPool>(new TextureStorePool(texture_store)));
+        texture_store.set_external_cache(
+            auto_ptr<TextureStore::IExternalCache>(new MemoryBudgetCache(*memory_budget, pool_index)));
+    }
+
+    // Create the store of volume bricks, shared by all volumes of the scene.
+    VolumeBrickStore volume_brick_store(volume_store_params);
+    const VolumeBrickStoreBinding volume_brick_store_binding(m_project, volume_brick_store);
+
+    if (memory_budget.get())
+    {
+        const size_t pool_index =
+            memory_budget->register_pool(
+                "volume store",
+                MemoryBudget::EvictablePool,
+                auto_ptr<MemoryBudget::IPool>(new VolumeBrickStorePool(volume_brick_store)));
+        volume_brick_store.set_external_cache(
+            auto_ptr<VolumeBrickStore::IExternalCache>(new MemoryBudgetCache(*memory_budget, pool_index)));
+    }
+
+    {
+        StartupPhase phase("shading system initialization");
+        if (!initialize_shading_system(texture_store, abort_switch, memory_budget.get()))
+            return IRendererController::AbortRendering;
+    }
+
+    if (memory_budget.get() && memory_budget->get_memory_size() > max_memory)
+    {
+        RENDERER_LOG_WARNING(
+            "renderer memory budget of %s is already exceeded before rendering (%s used).",
+            pretty_size(max_memory).c_str(),
+            pretty_size(memory_budget->get_memory_size()).c_str());
+    }
 
     // Don't proceed further if rendering was aborted.
     if (abort_switch.is_aborted())
         return m_renderer_controller->get_status();
 
     // Perform pre-render rendering actions. Don't proceed if that failed.
-    if (!m_project.get_scene()->on_render_begin(m_project, &abort_switch))
-        return IRendererController::AbortRendering;
+    {
+        StartupPhase phase("scene render begin");
+        if (!m_project.get_scene()->on_render_begin(m_project, &abort_switch))
+            return IRendererController::AbortRendering;
+    }
+
+    // Create the light sampler, or update the one of the previous initialization or of the
+    // previous render (e.g. the previous frame of a sequence) so that it is only rebuilt as
+    // far as lights and emitters changed. Changing its parameters requires a new one.
+    const ParamArray light_sampler_params = m_params.child("light_sampler");
+    if (m_light_sampler && light_sampler_params == m_light_sampler_params)
+        m_light_sampler->update(*m_project.get_scene());
+    else
+    {
+        delete m_light_sampler;
+        m_light_sampler =
+            new LightSampler(
+                *m_project.get_scene(),
+                light_sampler_params);
+        m_light_sampler_params = light_sampler_params;
+    }
+
+    // Create the primary hit cache, or keep the one of the previous initialization if its
+    // parameters did not change. It forgets its hits by itself when the geometry changes.
+    const ParamArray primary_hit_cache_params = m_params.child("primary_hit_cache");
+    if (!m_primary_hit_cache || primary_hit_cache_params != m_primary_hit_cache_params)
+    {
+        delete m_primary_hit_cache;
+        m_primary_hit_cache = 0;
+        m_primary_hit_cache_params = primary_hit_cache_params;
+
+        const size_t max_size = primary_hit_cache_params.get_optional<size_t>("max_size", 0);
+        if (max_size > 0)
+        {
+            m_primary_hit_cache = new PrimaryHitCache(max_size);
+            RENDERER_LOG_INFO(
+                "primary hit cache can hold the camera ray hits of %s %s.",
+                pretty_uint(m_primary_hit_cache->get_capacity()).c_str(),
+                plural(m_primary_hit_cache->get_capacity(), "sample").c_str());
+        }
+    }
+    if (m_primary_hit_cache)
+        m_primary_hit_cache->update(m_project);
 
     // Create the renderer components.
+    auto_ptr<StartupPhase> components_phase(new StartupPhase("renderer components"));
     RendererComponents components(
         m_project,
         m_params,
         m_tile_callback_factory,
         texture_store,
+        *m_light_sampler,
+        m_primary_hit_cache,
         *m_texture_system,
         *m_shading_system);
     if (!components.initialize())
         return IRendererController::AbortRendering;
+    components_phase.reset();
+
+    setup_phase.reset();
+
+    // Only count hot path events of this render.
+    clear_hot_path_counters();
+
+    // Attribute sampled shading times to shader groups, materials and BSDF models if requested.
+    const ParamArray& shading_profiler_params = m_params.child("shading_profiler");
+    const bool profile_shading = shading_profiler_params.get_optional<bool>("enabled", false);
+    if (profile_shading)
+    {
+        enable_shading_profiler(
+            max<size_t>(shading_profiler_params.get_optional<size_t>("sampling_period", 16), 1));
+    }
+    else disable_shading_profiler();
+    m_shading_system->attribute("profile", profile_shading ? 1 : 0);
+
+    // Report live telemetry while rendering if requested.
+    auto_ptr<TelemetryMonitor> telemetry_monitor;
+    if (m_telemetry_callback)
+    {
+        telemetry_monitor.reset(
+            new TelemetryMonitor(
+                *m_telemetry_callback,
+                m_params.get_optional<double>("telemetry_interval", 10.0),
+                &texture_store));
+    }
 
     // Execute the main rendering loop.
+    Stopwatch<DefaultWallclockTimer> render_stopwatch(0);
+    render_stopwatch.start();
     const IRendererController::Status status =
         render_frame_sequence(
             components.get_frame_renderer(),
+            telemetry_monitor.get(),
             abort_switch);
+    render_stopwatch.measure();
 
     // Perform post-render rendering actions.
+    tree_construction_waiter.wait();
     m_project.get_scene()->on_render_end(m_project);
 
     // Print texture store performance statistics.
-    RENDERER_LOG_DEBUG("%s", texture_store.get_statistics().to_string().c_str());
+    const StatisticsVector texture_store_stats = texture_store.get_statistics();
+    RENDERER_LOG_DEBUG("%s", texture_store_stats.to_string().c_str());
+    global_render_statistics().record(texture_store_stats);
+
+    // Print volume store performance statistics.
+    const StatisticsVector volume_store_stats = volume_brick_store.get_statistics();
+    RENDERER_LOG_DEBUG("%s", volume_store_stats.to_string().c_str());
+    global_render_statistics().record(volume_store_stats);
+
+    // Account for the memory used by the OIIO texture cache of OSL shaders, and print memory statistics.
+    MemoryAccount osl_memory_account(MemoryTagOSL);
+    long long oiio_cache_memory_size = 0;
+    m_texture_system->getattribute("stat:cache_memory_used", OIIO::TypeDesc::INT64, &oiio_cache_memory_size);
+    osl_memory_account.set_size(static_cast<size_t>(oiio_cache_memory_size));
+    const StatisticsVector memory_stats = get_memory_accounting_statistics();
+    RENDERER_LOG_DEBUG("%s", memory_stats.to_string().c_str());
+    global_render_statistics().record(memory_stats);
+
+    // Report peak memory usage against the memory budget, including the trees built during rendering.
+    if (memory_budget.get())
+    {
+        memory_budget->refresh();
+        const StatisticsVector memory_budget_stats = memory_budget->get_statistics();
+        RENDERER_LOG_INFO("%s", memory_budget_stats.to_string().c_str());
+        global_render_statistics().record(memory_budget_stats);
+    }
+
+    // Export per-texture cache statistics if requested.
+    const string texture_stats_filepath =
+        m_params.child("texture_store").get_optional<string>("statistics_file", "");
+    if (!texture_stats_filepath.empty())
+    {
+        ofstream output(texture_stats_filepath.c_str());
+        if (output.is_open())
+            texture_store.write_texture_statistics(output);
+        else RENDERER_LOG_ERROR("failed to write texture statistics to %s.", texture_stats_filepath.c_str());
+    }
+
+    // Print startup performance statistics.
+    const StatisticsVector startup_stats = global_startup_profiler().get_statistics();
+    RENDERER_LOG_INFO("%s", startup_stats.to_string(40).c_str());
+    global_render_statistics().record(startup_stats);
+
+    // Print hot path statistics.
+    const StatisticsVector hot_path_stats = get_hot_path_statistics();
+    RENDERER_LOG_INFO("%s", hot_path_stats.to_string(30).c_str());
+    global_render_statistics().record(hot_path_stats);
+
+    // Print the ranked shading profile.
+    if (profile_shading)
+    {
+        const StatisticsVector shading_profile_stats = get_shading_profile_statistics();
+        RENDERER_LOG_INFO("%s", shading_profile_stats.to_string(40).c_str());
+        global_render_statistics().record(shading_profile_stats);
+        disable_shading_profiler();
+    }
+
+    // Record overall render performance.
+    {
+        HotPathCounters counters;
+        get_hot_path_counters(counters);
+
+        uint64 ray_count = 0;
+        for (size_t i = 0; i < HotPathCounters::RayTypeCount; ++i)
+            ray_count += counters.m_rays[i];
+
+        const double render_time = render_stopwatch.get_seconds();
+
+        Statistics stats;
+        stats.insert_time("render time", render_time);
+        stats.insert<uint64>("rays", ray_count);
+        stats.insert("rays per second", render_time > 0.0 ? ray_count / render_time : 0.0);
+        stats.insert_size("peak memory", get_peak_total_accounted_memory_size());
+        global_render_statistics().record(StatisticsVector::make("render statistics", stats));
+    }
+
+    // Export startup statistics if requested.
+    const string startup_stats_filepath =
+        m_params.get_optional<string>("startup_statistics_file", "");
+    if (!startup_stats_filepath.empty())
+    {
+        ofstream output(startup_stats_filepath.c_str());
+        if (output.is_open())
+            global_startup_profiler().write_json(output);
+        else RENDERER_LOG_ERROR("failed to write startup statistics to %s.", startup_stats_filepath.c_str());
+    }
+
+    // Export render statistics if requested.
+    const string render_stats_filepath =
+        m_params.get_optional<string>("statistics_file", "");
+    if (!render_stats_filepath.empty())
+    {
+        ofstream output(render_stats_filepath.c_str());
+        if (output.is_open())
+            global_render_statistics().write_json(output);
+        else RENDERER_LOG_ERROR("failed to write render statistics to %s.", render_stats_filepath.c_str());
+    }
 
     return status;
 }
 
 IRendererController::Status MasterRenderer::render_frame_sequence(
     IFrameRenderer&         frame_renderer,
+    TelemetryMonitor*       telemetry_monitor,
     IAbortSwitch&           abort_switch)
 {
+    // Entities prepared for rendering, kept prepared across restarts that only move the camera.
+    OnFrameBeginRecorder recorder;
+    bool scene_prepared = false;
+
     while (true)
     {
         assert(!frame_renderer.is_rendering());
@@ -285,8 +973,21 @@ IRendererController::Status MasterRenderer::render_frame_sequence(
         m_renderer_controller->on_frame_begin();
 
         // Perform pre-frame rendering actions. Don't proceed if that failed.
-        OnFrameBeginRecorder recorder;
-        if (!m_project.get_scene()->on_frame_begin(m_project, 0, recorder, &abort_switch))
+        bool frame_prepared;
+        if (scene_prepared)
+        {
+            // Only the camera moved since the previous frame: leave the rest of the scene,
+            // such as environments and lights, as it was prepared.
+            StartupPhase phase("camera update");
+            frame_prepared = m_project.get_scene()->on_camera_change(m_project, &abort_switch);
+        }
+        else
+        {
+            StartupPhase phase("frame preparation");
+            frame_prepared = m_project.get_scene()->on_frame_begin(m_project, 0, recorder, &abort_switch);
+            scene_prepared = true;
+        }
+        if (!frame_prepared)
         {
             recorder.on_frame_end(m_project);
             m_renderer_controller->on_frame_end();
@@ -301,9 +1002,16 @@ IRendererController::Status MasterRenderer::render_frame_sequence(
             return m_renderer_controller->get_status();
         }
 
+        if (telemetry_monitor)
+            telemetry_monitor->on_frame_begin();
+
+        // Forget the entities recorded for picking during the previous frame.
+        if (ObjectIDBuffer* object_ids = m_project.get_frame()->get_object_id_buffer())
+            object_ids->clear();
+
         frame_renderer.start_rendering();
 
-        const IRendererController::Status status = wait_for_event(frame_renderer);
+        const IRendererController::Status status = wait_for_event(frame_renderer, telemetry_monitor);
 
         switch (status)
         {
@@ -314,6 +1022,7 @@ IRendererController::Status MasterRenderer::render_frame_sequence(
             break;
 
           case IRendererController::RestartRendering:
+          case IRendererController::RestartRenderingAfterCameraChange:
             frame_renderer.stop_rendering();
             break;
 
@@ -322,8 +1031,27 @@ IRendererController::Status MasterRenderer::render_frame_sequence(
 
         assert(!frame_renderer.is_rendering());
 
-        // Perform post-frame rendering actions
-        recorder.on_frame_end(m_project);
+        // Report the final telemetry of the frame.
+        if (telemetry_monitor)
+            telemetry_monitor->update(frame_renderer, true);
+
+        // Denoise the completed frame.
+        if (status == IRendererController::TerminateRendering &&
+            m_project.get_frame()->is_denoising_enabled())
+        {
+            const FrameDenoiser denoiser(m_params.child("denoiser"));
+            denoiser.denoise(
+                *m_project.get_frame(),
+                get_rendering_thread_count(m_params),
+                &abort_switch);
+        }
+
+        // Perform post-frame rendering actions, keeping the scene prepared if only the camera moved.
+        if (status != IRendererController::RestartRenderingAfterCameraChange)
+        {
+            recorder.on_frame_end(m_project);
+            scene_prepared = false;
+        }
         m_renderer_controller->on_frame_end();
 
         switch (status)
@@ -334,6 +1062,7 @@ IRendererController::Status MasterRenderer::render_frame_sequence(
             return status;
 
           case IRendererController::RestartRendering:
+          case IRendererController::RestartRenderingAfterCameraChange:
             break;
 
           assert_otherwise;
@@ -341,15 +1070,39 @@ IRendererController::Status MasterRenderer::render_frame_sequence(
     }
 }
 
-IRendererController::Status MasterRenderer::wait_for_event(IFrameRenderer& frame_renderer) const
+IRendererController::Status MasterRenderer::wait_for_event(
+    IFrameRenderer&         frame_renderer,
+    TelemetryMonitor*       telemetry_monitor) const
 {
     bool is_paused = false;
 
+    const size_t thread_count = get_rendering_thread_count(m_params);
+    size_t active_thread_count = ~size_t(0);
+
     while (true)
     {
         if (!frame_renderer.is_rendering())
             return IRendererController::TerminateRendering;
 
+        // Park or unpark rendering threads as requested by the renderer controller.
+        const size_t requested_thread_count = m_renderer_controller->get_active_thread_count();
+        const size_t new_active_thread_count =
+            requested_thread_count > 0 ? min(requested_thread_count, thread_count) : thread_count;
+        if (new_active_thread_count != active_thread_count)
+        {
+            if (active_thread_count != ~size_t(0) || new_active_thread_count < thread_count)
+            {
+                RENDERER_LOG_INFO(
+                    "rendering with %s of %s %s.",
+                    pretty_uint(new_active_thread_count).c_str(),
+                    pretty_uint(thread_count).c_str(),
+                    plural(thread_count, "thread").c_str());
+            }
+
+            frame_renderer.set_active_thread_count(new_active_thread_count);
+            active_thread_count = new_active_thread_count;
+        }
+
         const IRendererController::Status status = m_renderer_controller->get_status();
 
         switch (status)
@@ -376,6 +1129,9 @@ IRendererController::Status MasterRenderer::wait_for_event(IFrameRenderer& frame
 
         m_renderer_controller->on_progress();
 
+        if (telemetry_monitor)
+            telemetry_monitor->update(frame_renderer);
+
         foundation::sleep(1);   // namespace qualifer required
     }
 }
@@ -40,12 +40,17 @@
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
+namespace foundation    { class StatisticsVector; }
 namespace renderer      { class Display; }
 namespace renderer      { class IFrameRenderer; }
+namespace renderer      { class ITelemetryCallback; }
 namespace renderer      { class ITileCallback; }
 namespace renderer      { class ITileCallbackFactory; }
+namespace renderer      { class LightSampler; }
+namespace renderer      { class PrimaryHitCache; }
 namespace renderer      { class Project; }
 namespace renderer      { class SerialRendererController; }
+namespace renderer      { class TelemetryMonitor; }
 
 namespace renderer
 {
@@ -78,6 +83,13 @@ class APPLESEED_DLLSYMBOL MasterRenderer
     // Render the project. Return true on success, false otherwise.
     bool render();
 
+    // Return the statistics of the last render.
+    foundation::StatisticsVector get_render_statistics() const;
+
+    // Set the callback receiving live telemetry while rendering, or 0 to disable telemetry.
+    // The callback is invoked every "telemetry_interval" seconds (10 by default).
+    void set_telemetry_callback(ITelemetryCallback* callback);
+
   private:
     IRendererController*            m_renderer_controller;
     ITileCallbackFactory*           m_tile_callback_factory;
@@ -87,6 +99,16 @@ class APPLESEED_DLLSYMBOL MasterRenderer
     ITileCallbackFactory*           m_serial_tile_callback_factory;
 
     Display*                        m_display;
+    ITelemetryCallback*             m_telemetry_callback;
+
+    // Light sampler kept across reinitializations and renders, only updated to reflect scene edits.
+    LightSampler*                   m_light_sampler;
+    ParamArray                      m_light_sampler_params;
+
+    // Hits of camera rays kept across reinitializations, so that edits that only change
+    // lighting don't trace camera rays again.
+    PrimaryHitCache*                m_primary_hit_cache;
+    ParamArray                      m_primary_hit_cache_params;
 
     // Render frame sequences, each time reinitializing the rendering components.
     bool do_render();
@@ -97,10 +119,13 @@ class APPLESEED_DLLSYMBOL MasterRenderer
     // Render a frame sequence until the sequence is completed or rendering is aborted.
     IRendererController::Status render_frame_sequence(
         IFrameRenderer&             frame_renderer,
+        TelemetryMonitor*           telemetry_monitor,
         foundation::IAbortSwitch&   abort_switch);
 
     // Wait until the the frame is completed or rendering is aborted.
-    IRendererController::Status wait_for_event(IFrameRenderer& frame_renderer) const;
+    IRendererController::Status wait_for_event(
+        IFrameRenderer&             frame_renderer,
+        TelemetryMonitor*           telemetry_monitor) const;
 
     // Bind all scene entities inputs. Return true on success, false otherwise.
     bool bind_scene_entities_inputs() const;
@@ -0,0 +1,166 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "memorybudget.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+#include "foundation/utility/statistics.h"
+
+// Standard headers.
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// MemoryBudget class implementation.
+//
+
+struct MemoryBudget::Pool
+  : public NonCopyable
+{
+    string                  m_name;
+    PoolType                m_type;
+    auto_ptr<IPool>         m_pool;
+    boost::atomic<size_t>   m_memory_size;
+    boost::atomic<size_t>   m_peak_memory_size;
+};
+
+MemoryBudget::MemoryBudget(const size_t max_memory_size)
+  : m_max_memory_size(max_memory_size)
+  , m_fixed_memory_size(0)
+  , m_memory_size(0)
+  , m_peak_memory_size(0)
+{
+    assert(m_max_memory_size > 0);
+}
+
+MemoryBudget::~MemoryBudget()
+{
+    for (size_t i = 0, e = m_pools.size(); i < e; ++i)
+        delete m_pools[i];
+}
+
+size_t MemoryBudget::register_pool(
+    const char*             name,
+    const PoolType          type,
+    auto_ptr<IPool>         pool)
+{
+    assert(name);
+    assert(pool.get());
+
+    Pool* p = new Pool();
+    p->m_name = name;
+    p->m_type = type;
+    p->m_pool = pool;
+    p->m_memory_size.store(0);
+    p->m_peak_memory_size.store(0);
+
+    m_pools.push_back(p);
+
+    refresh();
+
+    return m_pools.size() - 1;
+}
+
+void MemoryBudget::refresh()
+{
+    size_t fixed_memory_size = 0;
+
+    for (size_t i = 0, e = m_pools.size(); i < e; ++i)
+    {
+        Pool& pool = *m_pools[i];
+
+        if (pool.m_type == FixedPool)
+        {
+            const size_t memory_size = pool.m_pool->get_memory_size();
+            pool.m_memory_size.store(memory_size);
+            update_peak(pool.m_peak_memory_size, memory_size);
+            fixed_memory_size += memory_size;
+        }
+    }
+
+    m_fixed_memory_size.store(fixed_memory_size);
+
+    poll();
+}
+
+size_t MemoryBudget::poll()
+{
+    size_t total_memory_size = m_fixed_memory_size.load();
+
+    for (size_t i = 0, e = m_pools.size(); i < e; ++i)
+    {
+        Pool& pool = *m_pools[i];
+
+        if (pool.m_type == EvictablePool)
+        {
+            const size_t memory_size = pool.m_pool->get_memory_size();
+            pool.m_memory_size.store(memory_size);
+            update_peak(pool.m_peak_memory_size, memory_size);
+            total_memory_size += memory_size;
+        }
+    }
+
+    m_memory_size.store(total_memory_size);
+    update_peak(m_peak_memory_size, total_memory_size);
+
+    return total_memory_size;
+}
+
+size_t MemoryBudget::get_pool_memory_size(const size_t index) const
+{
+    assert(index < m_pools.size());
+    return m_pools[index]->m_memory_size.load();
+}
+
+StatisticsVector MemoryBudget::get_statistics() const
+{
+    const size_t peak_memory_size = m_peak_memory_size.load();
+
+    Statistics stats;
+    stats.insert_size("budget", m_max_memory_size);
+    stats.insert_size("peak size", peak_memory_size);
+    stats.insert_percent("peak usage", static_cast<uint64>(peak_memory_size), static_cast<uint64>(m_max_memory_size));
+
+    for (size_t i = 0, e = m_pools.size(); i < e; ++i)
+    {
+        const Pool& pool = *m_pools[i];
+        stats.insert_size(pool.m_name + " peak", pool.m_peak_memory_size.load());
+    }
+
+    return StatisticsVector::make("memory budget statistics", stats);
+}
+
+}   // namespace renderer
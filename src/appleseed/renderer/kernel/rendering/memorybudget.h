@@ -0,0 +1,163 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_MEMORYBUDGET_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_MEMORYBUDGET_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/atomic.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class StatisticsVector; }
+
+namespace renderer
+{
+
+//
+// A renderer-wide memory budget.
+//
+// Subsystems register the memory pools they own, along with a way to query their size.
+// Fixed pools (ray tracing trees, frame buffers) cannot release memory: their size is
+// sampled when they are registered or when the budget is refreshed. Evictable pools
+// (texture caches) are polled whenever a subsystem needs to know how much memory is left,
+// and are expected to evict their content to keep the total within the budget.
+//
+// The budget records the peak memory usage of each pool and of all pools together.
+//
+
+class MemoryBudget
+  : public foundation::NonCopyable
+{
+  public:
+    // Interface of a memory pool accounted against the budget.
+    class IPool
+      : public foundation::NonCopyable
+    {
+      public:
+        // Destructor.
+        virtual ~IPool() {}
+
+        // Return the current memory size in bytes of the pool. Must be thread-safe
+        // if the pool is evictable.
+        virtual size_t get_memory_size() const = 0;
+    };
+
+    enum PoolType
+    {
+        FixedPool,                                  // sampled at registration and refresh time
+        EvictablePool                               // polled continuously
+    };
+
+    // Constructor.
+    explicit MemoryBudget(const size_t max_memory_size);
+
+    // Destructor.
+    ~MemoryBudget();
+
+    // Return the maximum amount of memory in bytes shared by all pools.
+    size_t get_max_memory_size() const;
+
+    // Register a memory pool and return its index. The budget takes ownership of the
+    // pool object. Not thread-safe, must be called before the budget is polled.
+    size_t register_pool(
+        const char*                 name,
+        const PoolType              type,
+        std::auto_ptr<IPool>        pool);
+
+    // Sample the size of all pools, including fixed ones. Not thread-safe.
+    void refresh();
+
+    // Poll the size of the evictable pools and return the total memory size in bytes
+    // of all pools. Thread-safe.
+    size_t poll();
+
+    // Return the memory size in bytes of a given pool when it was last polled.
+    size_t get_pool_memory_size(const size_t index) const;
+
+    // Return the total memory size in bytes of all pools when they were last polled.
+    size_t get_memory_size() const;
+
+    // Return the peak total memory size in bytes of all pools.
+    size_t get_peak_memory_size() const;
+
+    // Retrieve usage statistics.
+    foundation::StatisticsVector get_statistics() const;
+
+  private:
+    struct Pool;
+
+    const size_t                    m_max_memory_size;
+    std::vector<Pool*>              m_pools;
+    boost::atomic<size_t>           m_fixed_memory_size;
+    boost::atomic<size_t>           m_memory_size;
+    boost::atomic<size_t>           m_peak_memory_size;
+
+    static void update_peak(
+        boost::atomic<size_t>&      peak,
+        const size_t                value);
+};
+
+
+//
+// MemoryBudget class implementation.
+//
+
+inline size_t MemoryBudget::get_max_memory_size() const
+{
+    return m_max_memory_size;
+}
+
+inline size_t MemoryBudget::get_memory_size() const
+{
+    return m_memory_size.load();
+}
+
+inline size_t MemoryBudget::get_peak_memory_size() const
+{
+    return m_peak_memory_size.load();
+}
+
+inline void MemoryBudget::update_peak(
+    boost::atomic<size_t>&          peak,
+    const size_t                    value)
+{
+    size_t peak_value = peak.load();
+    while (peak_value < value && !peak.compare_exchange_weak(peak_value, value)) ;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_MEMORYBUDGET_H
@@ -40,29 +40,46 @@
 #include "foundation/image/image.h"
 #include "foundation/image/tile.h"
 
+// Standard headers.
+#include <cassert>
+
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
 
+namespace
+{
+    // The weight and the four channels of the main image.
+    const size_t MainChannelCount = 5;
+}
+
 void PermanentShadingResultFrameBufferFactory::release()
 {
     delete this;
 }
 
 PermanentShadingResultFrameBufferFactory::PermanentShadingResultFrameBufferFactory(
-    const Frame&                frame)
+    const Frame&                frame,
+    const bool                  compact)
+  : m_compact(compact)
 {
     const size_t tile_count_x = frame.image().properties().m_tile_count_x;
     const size_t tile_count_y = frame.image().properties().m_tile_count_y;
 
-    m_framebuffers.resize(tile_count_x * tile_count_y, 0);
+    if (m_compact)
+        m_compact_framebuffers.resize(tile_count_x * tile_count_y, 0);
+    else m_framebuffers.resize(tile_count_x * tile_count_y, 0);
 }
 
 PermanentShadingResultFrameBufferFactory::~PermanentShadingResultFrameBufferFactory()
 {
     for (size_t i = 0; i < m_framebuffers.size(); ++i)
         delete m_framebuffers[i];
+
+    for (size_t i = 0; i < m_compact_framebuffers.size(); ++i)
+        delete m_compact_framebuffers[i];
 }
 
 ShadingResultFrameBuffer* PermanentShadingResultFrameBufferFactory::create(
@@ -74,6 +91,62 @@ ShadingResultFrameBuffer* PermanentShadingResultFrameBufferFactory::create(
     const size_t tile_count_x = frame.image().properties().m_tile_count_x;
     const size_t index = tile_y * tile_count_x + tile_x;
 
+    if (m_compact)
+    {
+        const Tile& tile = frame.image().tile(tile_x, tile_y);
+
+        ShadingResultFrameBuffer* framebuffer =
+            m_pool.acquire(
+                tile.get_width(),
+                tile.get_height(),
+                frame.aov_images().size(),
+                tile_bbox,
+                frame.get_filter());
+
+        const size_t pixel_count = framebuffer->get_pixel_count();
+        const size_t aov_channel_count = framebuffer->get_channel_count() - MainChannelCount;
+
+        CompactFrameBuffer*& compact_framebuffer = m_compact_framebuffers[index];
+
+        if (compact_framebuffer)
+        {
+            // Expand the samples accumulated during previous passes.
+            const size_t stored_aov_channel_count = compact_framebuffer->m_aov_channel_count;
+            const float* main_ptr = &compact_framebuffer->m_main[0];
+            const half* aov_ptr = stored_aov_channel_count > 0 ? &compact_framebuffer->m_aovs[0] : 0;
+            float* ptr = framebuffer->pixel(0);
+
+            for (size_t i = 0; i < pixel_count; ++i)
+            {
+                for (size_t c = 0; c < MainChannelCount; ++c)
+                    *ptr++ = *main_ptr++;
+
+                for (size_t c = 0; c < stored_aov_channel_count; ++c)
+                    *ptr++ = *aov_ptr++;
+
+                for (size_t c = stored_aov_channel_count; c < aov_channel_count; ++c)
+                    *ptr++ = 0.0f;
+            }
+        }
+        else
+        {
+            // Samples outside the AOV window carry no AOVs: only allocate AOV storage
+            // for tiles that overlap the AOV window.
+            compact_framebuffer = new CompactFrameBuffer();
+            compact_framebuffer->m_aov_channel_count =
+                frame.get_aov_count(tile_x, tile_y) > 0 ? aov_channel_count : 0;
+            compact_framebuffer->m_main.resize(pixel_count * MainChannelCount);
+            compact_framebuffer->m_aovs.resize(pixel_count * compact_framebuffer->m_aov_channel_count);
+
+            framebuffer->clear();
+        }
+
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_tile_indices[framebuffer] = index;
+
+        return framebuffer;
+    }
+
     if (m_framebuffers[index] == 0)
     {
         const Tile& tile = frame.image().tile(tile_x, tile_y);
@@ -95,6 +168,43 @@ ShadingResultFrameBuffer* PermanentShadingResultFrameBufferFactory::create(
 void PermanentShadingResultFrameBufferFactory::destroy(
     ShadingResultFrameBuffer*   framebuffer)
 {
+    if (!m_compact)
+        return;
+
+    size_t index;
+
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        const map<const ShadingResultFrameBuffer*, size_t>::iterator i = m_tile_indices.find(framebuffer);
+        assert(i != m_tile_indices.end());
+        index = i->second;
+        m_tile_indices.erase(i);
+    }
+
+    // Store the accumulated samples until the next pass.
+    const size_t pixel_count = framebuffer->get_pixel_count();
+    const size_t aov_channel_count = framebuffer->get_channel_count() - MainChannelCount;
+
+    CompactFrameBuffer* compact_framebuffer = m_compact_framebuffers[index];
+    assert(compact_framebuffer);
+
+    const size_t stored_aov_channel_count = compact_framebuffer->m_aov_channel_count;
+    const float* ptr = framebuffer->pixel(0);
+    float* main_ptr = &compact_framebuffer->m_main[0];
+    half* aov_ptr = stored_aov_channel_count > 0 ? &compact_framebuffer->m_aovs[0] : 0;
+
+    for (size_t i = 0; i < pixel_count; ++i)
+    {
+        for (size_t c = 0; c < MainChannelCount; ++c)
+            *main_ptr++ = *ptr++;
+
+        for (size_t c = 0; c < stored_aov_channel_count; ++c)
+            *aov_ptr++ = *ptr++;
+
+        ptr += aov_channel_count - stored_aov_channel_count;
+    }
+
+    m_pool.release(framebuffer);
 }
 
 }   // namespace renderer
@@ -32,13 +32,24 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/rendering/ishadingresultframebufferfactory.h"
+#include "renderer/kernel/rendering/shadingresultframebufferpool.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/aabb.h"
 #include "foundation/platform/compiler.h"
 
+// OpenEXR headers.
+#include "foundation/platform/exrheaderguards.h"
+BEGIN_EXR_INCLUDES
+#include "OpenEXR/half.h"
+END_EXR_INCLUDES
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
 // Standard headers.
 #include <cstddef>
+#include <map>
 #include <vector>
 
 // Forward declarations.
@@ -52,9 +63,12 @@ class PermanentShadingResultFrameBufferFactory
   : public IShadingResultFrameBufferFactory
 {
   public:
-    // Constructor.
-    explicit PermanentShadingResultFrameBufferFactory(
-        const Frame&                frame);
+    // Constructor. In compact mode, accumulated samples are stored between passes with
+    // the weights and the main image in single precision and the AOVs in half precision;
+    // samples of the current pass are still accumulated in single precision.
+    PermanentShadingResultFrameBufferFactory(
+        const Frame&                frame,
+        const bool                  compact = false);
 
     // Destructor.
     ~PermanentShadingResultFrameBufferFactory();
@@ -72,7 +86,19 @@ class PermanentShadingResultFrameBufferFactory
         ShadingResultFrameBuffer*   framebuffer) APPLESEED_OVERRIDE;
 
   private:
-    std::vector<ShadingResultFrameBuffer*> m_framebuffers;
+    struct CompactFrameBuffer
+    {
+        std::vector<float>  m_main;     // weight and main image channels
+        std::vector<half>   m_aovs;     // AOV channels, empty if the tile does not overlap the AOV window
+        size_t              m_aov_channel_count;
+    };
+
+    const bool                                          m_compact;
+    std::vector<ShadingResultFrameBuffer*>              m_framebuffers;
+    std::vector<CompactFrameBuffer*>                    m_compact_framebuffers;
+    boost::mutex                                        m_mutex;
+    std::map<const ShadingResultFrameBuffer*, size_t>   m_tile_indices;
+    ShadingResultFrameBufferPool                        m_pool;     // expanded framebuffers in compact mode
 };
 
 }       // namespace renderer
@@ -33,6 +33,9 @@
 // appleseed.foundation headers.
 #include "foundation/math/vector.h"
 
+// Standard headers.
+#include <cstddef>
+
 namespace renderer
 {
 
@@ -43,10 +46,14 @@ namespace renderer
 class PixelContext
 {
   public:
+    // Value of the sample index when samples are not indexed.
+    static const size_t NoSampleIndex = ~size_t(0);
+
     // Constructor.
     PixelContext(
         const foundation::Vector2i& pixel_coords,
-        const foundation::Vector2d& sample_position);
+        const foundation::Vector2d& sample_position,
+        const size_t                sample_index = NoSampleIndex);
 
     // Return pixel coordinates.
     const foundation::Vector2i& get_pixel_coords() const;
@@ -54,9 +61,14 @@ class PixelContext
     // Return sample coordinates.
     const foundation::Vector2d& get_sample_position() const;
 
+    // Return the index of the sample in the sequence of samples of the frame,
+    // or NoSampleIndex if the frame renderer does not index its samples.
+    size_t get_sample_index() const;
+
   private:
     const foundation::Vector2i  m_pixel_coords;
     const foundation::Vector2d  m_sample_position;
+    const size_t                m_sample_index;
 };
 
 
@@ -66,9 +78,11 @@ class PixelContext
 
 inline PixelContext::PixelContext(
     const foundation::Vector2i& pixel_coords,
-    const foundation::Vector2d& sample_position)
+    const foundation::Vector2d& sample_position,
+    const size_t                sample_index)
   : m_pixel_coords(pixel_coords)
   , m_sample_position(sample_position)
+  , m_sample_index(sample_index)
 {
 }
 
@@ -82,6 +96,11 @@ inline const foundation::Vector2d& PixelContext::get_sample_position() const
     return m_sample_position;
 }
 
+inline size_t PixelContext::get_sample_index() const
+{
+    return m_sample_index;
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_PIXELCONTEXT_H
@@ -71,6 +71,9 @@ class PixelRendererBase
         foundation::Tile&           tile,
         TileStack&                  aov_tiles) APPLESEED_OVERRIDE;
 
+    // Return false: this base class does not collect tile diagnostics.
+    virtual bool has_tile_diagnostics() const APPLESEED_OVERRIDE;
+
   protected:
     void on_pixel_begin();
     void on_pixel_end(const foundation::Vector2i& pi);
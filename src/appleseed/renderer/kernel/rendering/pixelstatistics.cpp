@@ -0,0 +1,108 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "pixelstatistics.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/math/scalar.h"
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// PixelStatistics class implementation.
+//
+
+PixelStatistics::PixelStatistics(
+    const size_t            width,
+    const size_t            height)
+  : m_width(width)
+  , m_height(height)
+  , m_entries(width * height)
+  , m_row_locks(new Spinlock[height])
+{
+    clear();
+}
+
+PixelStatistics::~PixelStatistics()
+{
+    delete[] m_row_locks;
+}
+
+void PixelStatistics::clear()
+{
+    Entry empty;
+    empty.m_sample_count = 0;
+    empty.m_max = 0.0f;
+    empty.m_sum = 0.0;
+    empty.m_sum_sq = 0.0;
+
+    fill(m_entries.begin(), m_entries.end(), empty);
+}
+
+void PixelStatistics::store_samples(
+    const size_t            sample_count,
+    const Sample            samples[])
+{
+    const float fw = static_cast<float>(m_width);
+    const float fh = static_cast<float>(m_height);
+
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        const Sample& sample = samples[i];
+
+        const size_t x = truncate<size_t>(sample.m_position.x * fw);
+        const size_t y = truncate<size_t>(sample.m_position.y * fh);
+        if (x >= m_width || y >= m_height)
+            continue;
+
+        const Color3f rgb(sample.m_values[0], sample.m_values[1], sample.m_values[2]);
+        const float lum = max(luminance(rgb), 0.0f);
+        const double dlum = static_cast<double>(lum);
+
+        Spinlock::ScopedLock lock(m_row_locks[y]);
+
+        Entry& entry = m_entries[y * m_width + x];
+        ++entry.m_sample_count;
+        entry.m_max = max(entry.m_max, lum);
+        entry.m_sum += dlum;
+        entry.m_sum_sq += dlum * dlum;
+    }
+}
+
+}   // namespace renderer
@@ -0,0 +1,153 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_PIXELSTATISTICS_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_PIXELSTATISTICS_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace renderer      { class Sample; }
+
+namespace renderer
+{
+
+//
+// Per-pixel statistics of the luminance of the samples accumulated during progressive
+// rendering: sample count, mean, variance and maximum value. They help diagnose noise
+// and fireflies, and give adaptive sampling a per-pixel error estimate.
+//
+// Unlike the convergence map, sample luminances are not clamped so that fireflies
+// show up in the maximum value.
+//
+
+class PixelStatistics
+  : public foundation::NonCopyable
+{
+  public:
+    struct Entry
+    {
+        foundation::uint32  m_sample_count;
+        float               m_max;
+        double              m_sum;
+        double              m_sum_sq;
+
+        float get_mean() const;
+        float get_variance() const;
+    };
+
+    // Constructor.
+    PixelStatistics(
+        const size_t        width,
+        const size_t        height);
+
+    // Destructor.
+    ~PixelStatistics();
+
+    size_t get_width() const;
+    size_t get_height() const;
+
+    // Forget all samples. Not thread-safe.
+    void clear();
+
+    // Update the statistics of the pixels that received a set of samples. Samples outside
+    // the frame are ignored. Thread-safe.
+    void store_samples(
+        const size_t        sample_count,
+        const Sample        samples[]);
+
+    // Retrieve the statistics of a pixel, which must be inside the frame. Values may be
+    // slightly stale while samples are being stored.
+    const Entry& get(
+        const size_t        x,
+        const size_t        y) const;
+
+  private:
+    const size_t            m_width;
+    const size_t            m_height;
+    std::vector<Entry>      m_entries;
+    foundation::Spinlock*   m_row_locks;
+};
+
+
+//
+// PixelStatistics class implementation.
+//
+
+inline float PixelStatistics::Entry::get_mean() const
+{
+    return
+        m_sample_count > 0
+            ? static_cast<float>(m_sum / m_sample_count)
+            : 0.0f;
+}
+
+inline float PixelStatistics::Entry::get_variance() const
+{
+    if (m_sample_count < 2)
+        return 0.0f;
+
+    // Unbiased estimate of the variance of the sample luminances.
+    const double n = static_cast<double>(m_sample_count);
+    const double mean = m_sum / n;
+    return static_cast<float>(std::max((m_sum_sq - n * mean * mean) / (n - 1.0), 0.0));
+}
+
+inline size_t PixelStatistics::get_width() const
+{
+    return m_width;
+}
+
+inline size_t PixelStatistics::get_height() const
+{
+    return m_height;
+}
+
+inline const PixelStatistics::Entry& PixelStatistics::get(
+    const size_t            x,
+    const size_t            y) const
+{
+    assert(x < m_width);
+    assert(y < m_height);
+
+    return m_entries[y * m_width + x];
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_PIXELSTATISTICS_H
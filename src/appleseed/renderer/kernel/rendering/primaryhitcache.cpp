@@ -0,0 +1,240 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "primaryhitcache.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/modeling/material/material.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/basegroup.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/textureinstance.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/siphash.h"
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    uint64 compute_ray_signature(const ShadingRay& ray)
+    {
+        const double values[8] =
+        {
+            ray.m_org.x, ray.m_org.y, ray.m_org.z,
+            ray.m_dir.x, ray.m_dir.y, ray.m_dir.z,
+            static_cast<double>(ray.m_time.m_absolute),
+            static_cast<double>(ray.m_flags)
+        };
+
+        // 0 marks empty entries.
+        const uint64 signature = siphash24(values, sizeof(values));
+        return signature != 0 ? signature : 1;
+    }
+
+    uint64 compute_transform_sequence_signature(const TransformSequence& transform_sequence)
+    {
+        uint64 signature = transform_sequence.size();
+
+        for (size_t i = 0, e = transform_sequence.size(); i < e; ++i)
+        {
+            float time;
+            Transformd transform;
+            transform_sequence.get_transform(i, time, transform);
+            signature = siphash24(signature, siphash24(time));
+            signature = siphash24(signature, siphash24(transform.get_local_to_parent()));
+        }
+
+        return signature;
+    }
+
+    // Compute a signature of everything in a hierarchy of assemblies that affects which
+    // surface points camera rays hit. Materials are included since alpha maps cut out
+    // surfaces. Lights and EDFs are left out on purpose.
+    uint64 compute_geometry_signature(const BaseGroup& group)
+    {
+        uint64 signature = 0;
+
+        for (const_each<TextureInstanceContainer> i = group.texture_instances(); i; ++i)
+            signature = siphash24(signature, i->compute_signature());
+
+        for (const_each<AssemblyInstanceContainer> i = group.assembly_instances(); i; ++i)
+        {
+            signature = siphash24(signature, i->compute_signature());
+            signature = siphash24(signature, compute_transform_sequence_signature(i->transform_sequence()));
+        }
+
+        for (const_each<AssemblyContainer> i = group.assemblies(); i; ++i)
+        {
+            const Assembly& assembly = *i;
+
+            for (const_each<ObjectContainer> j = assembly.objects(); j; ++j)
+                signature = siphash24(signature, j->compute_signature());
+
+            for (const_each<ObjectInstanceContainer> j = assembly.object_instances(); j; ++j)
+            {
+                signature = siphash24(signature, j->compute_signature());
+                signature = siphash24(signature, siphash24(j->get_transform().get_local_to_parent()));
+            }
+
+            for (const_each<MaterialContainer> j = assembly.materials(); j; ++j)
+                signature = siphash24(signature, j->compute_signature());
+
+            signature = siphash24(signature, compute_geometry_signature(assembly));
+        }
+
+        return signature;
+    }
+}
+
+
+//
+// PrimaryHitCache class implementation.
+//
+
+PrimaryHitCache::PrimaryHitCache(const size_t max_size)
+  : m_entries(max_size / sizeof(Entry))
+  , m_geometry_signature(0)
+  , m_memory_account(MemoryTagFramebuffers)
+{
+    m_memory_account.set_size(m_entries.size() * sizeof(Entry));
+    clear();
+}
+
+void PrimaryHitCache::update(const Project& project)
+{
+    const uint64 geometry_signature = compute_geometry_signature(*project.get_scene());
+
+    if (geometry_signature != m_geometry_signature)
+    {
+        RENDERER_LOG_DEBUG("scene geometry changed, clearing primary hit cache.");
+        clear();
+        m_geometry_signature = geometry_signature;
+    }
+}
+
+void PrimaryHitCache::store(
+    const size_t            sample_index,
+    const ShadingPoint&     shading_point)
+{
+    if (sample_index >= m_entries.size())
+        return;
+
+    Entry& entry = m_entries[sample_index];
+
+    // Misses are not cached: they are cheap to trace again.
+    if (!shading_point.hit())
+    {
+        entry.m_ray_signature = 0;
+        return;
+    }
+
+    entry.m_ray_signature = compute_ray_signature(shading_point.get_ray());
+    entry.m_assembly_instance = shading_point.m_assembly_instance;
+    entry.m_assembly_instance_transform = shading_point.m_assembly_instance_transform;
+    entry.m_triangle_support_plane = shading_point.m_triangle_support_plane;
+    entry.m_distance = shading_point.m_ray.m_tmax;
+    entry.m_bary = shading_point.m_bary;
+    entry.m_primitive_type = static_cast<uint32>(shading_point.m_primitive_type);
+    entry.m_object_instance_index = shading_point.m_object_instance_index;
+    entry.m_region_index = shading_point.m_region_index;
+    entry.m_primitive_index = shading_point.m_primitive_index;
+}
+
+bool PrimaryHitCache::restore(
+    const size_t            sample_index,
+    const ShadingRay&       ray,
+    const Intersector&      intersector,
+    ShadingPoint&           shading_point) const
+{
+    if (sample_index >= m_entries.size())
+        return false;
+
+    const Entry& entry = m_entries[sample_index];
+
+    if (entry.m_ray_signature == 0 || entry.m_ray_signature != compute_ray_signature(ray))
+        return false;
+
+    ShadingRay hit_ray(ray);
+    hit_ray.m_tmax = entry.m_distance;
+
+    intersector.manufacture_hit(
+        shading_point,
+        hit_ray,
+        static_cast<ShadingPoint::PrimitiveType>(entry.m_primitive_type),
+        entry.m_bary,
+        entry.m_assembly_instance,
+        entry.m_assembly_instance_transform,
+        entry.m_object_instance_index,
+        entry.m_region_index,
+        entry.m_primitive_index,
+        entry.m_triangle_support_plane);
+
+    return true;
+}
+
+Dictionary PrimaryHitCache::get_params_metadata()
+{
+    Dictionary metadata;
+
+    metadata.dictionaries().insert(
+        "max_size",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "0")
+            .insert("label", "Max Size")
+            .insert("help", "Memory size in bytes of the cache of camera ray hits reused by progressive rendering when only lights change (0 disables the cache)"));
+
+    return metadata;
+}
+
+void PrimaryHitCache::clear()
+{
+    for (size_t i = 0, e = m_entries.size(); i < e; ++i)
+        m_entries[i].m_ray_signature = 0;
+}
+
+}   // namespace renderer
@@ -0,0 +1,136 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_PRIMARYHITCACHE_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_PRIMARYHITCACHE_H
+
+// appleseed.renderer headers.
+#include "renderer/kernel/intersection/intersectionsettings.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/memoryaccounting.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class Dictionary; }
+namespace renderer      { class AssemblyInstance; }
+namespace renderer      { class Intersector; }
+namespace renderer      { class Project; }
+namespace renderer      { class ShadingPoint; }
+namespace renderer      { class ShadingRay; }
+
+namespace renderer
+{
+
+//
+// A cache of the surface points hit by the camera rays of progressive rendering.
+//
+// After each restart, progressive rendering draws the same sequence of samples again.
+// As long as the geometry does not change, the camera rays of these samples hit the
+// same surface points: when only lights are edited, the sample renderer restores the
+// hits from the cache instead of tracing the camera rays through the scene.
+//
+// Hits are indexed by sample index. Each hit also records a signature of its camera
+// ray, so that hits whose ray changed (for instance because the camera moved) are
+// never restored. The cache is not thread-safe in general, but a given sample is only
+// rendered by one thread at a time, which is all that store() and restore() require.
+//
+
+class PrimaryHitCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. max_size is the memory size of the cache, in bytes.
+    explicit PrimaryHitCache(const size_t max_size);
+
+    // Forget all hits if the geometry of the scene changed since the last call.
+    // Must not be called while rendering.
+    void update(const Project& project);
+
+    // Return the number of samples whose hit can be cached.
+    size_t get_capacity() const;
+
+    // Store the hit of the camera ray of a given sample.
+    void store(
+        const size_t            sample_index,
+        const ShadingPoint&     shading_point);
+
+    // Restore the hit of the camera ray of a given sample into a shading point.
+    // Return false if the cache holds no hit for this sample and this ray.
+    bool restore(
+        const size_t            sample_index,
+        const ShadingRay&       ray,
+        const Intersector&      intersector,
+        ShadingPoint&           shading_point) const;
+
+    // Return the metadata of the primary hit cache parameters.
+    static foundation::Dictionary get_params_metadata();
+
+  private:
+    struct Entry
+    {
+        foundation::uint64          m_ray_signature;        // 0 if the entry is empty
+        const AssemblyInstance*     m_assembly_instance;
+        foundation::Transformd      m_assembly_instance_transform;
+        TriangleSupportPlaneType    m_triangle_support_plane;
+        double                      m_distance;
+        foundation::Vector2f        m_bary;
+        foundation::uint32          m_primitive_type;
+        foundation::uint32          m_object_instance_index;
+        foundation::uint32          m_region_index;
+        foundation::uint32          m_primitive_index;
+    };
+
+    std::vector<Entry>              m_entries;
+    foundation::uint64              m_geometry_signature;
+    foundation::MemoryAccount       m_memory_account;
+
+    void clear();
+};
+
+
+//
+// PrimaryHitCache class implementation.
+//
+
+inline size_t PrimaryHitCache::get_capacity() const
+{
+    return m_entries.size();
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_PRIMARYHITCACHE_H
@@ -0,0 +1,212 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "frameanalyzer.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/frame/frame.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/analysis.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/job.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// FrameAnalyzer class implementation.
+//
+
+namespace
+{
+    class AnalyzeTileJob
+      : public IJob
+    {
+      public:
+        AnalyzeTileJob(
+            const Frame&        frame,
+            const Image*        ref_image,
+            Image&              snapshot,
+            const size_t        tile_x,
+            const size_t        tile_y,
+            uint8&              analyzed,
+            uint8&              updated,
+            double&             luminance_sum,
+            size_t&             luminance_pixel_count,
+            double&             square_deviation_sum)
+          : m_frame(frame)
+          , m_ref_image(ref_image)
+          , m_snapshot(snapshot)
+          , m_tile_x(tile_x)
+          , m_tile_y(tile_y)
+          , m_analyzed(analyzed)
+          , m_updated(updated)
+          , m_luminance_sum(luminance_sum)
+          , m_luminance_pixel_count(luminance_pixel_count)
+          , m_square_deviation_sum(square_deviation_sum)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            const Tile& tile = m_frame.image().tile(m_tile_x, m_tile_y);
+            Tile& snapshot_tile = m_snapshot.tile(m_tile_x, m_tile_y);
+            assert(snapshot_tile.get_size() == tile.get_size());
+
+            // Comparing raw pixels is much cheaper than analyzing them.
+            if (m_analyzed &&
+                memcmp(snapshot_tile.get_storage(), tile.get_storage(), tile.get_size()) == 0)
+                return;
+
+            memcpy(snapshot_tile.get_storage(), tile.get_storage(), tile.get_size());
+
+            Tile transformed_tile(snapshot_tile);
+            m_frame.transform_to_output_color_space(transformed_tile);
+
+            m_luminance_sum = 0.0;
+            m_luminance_pixel_count = 0;
+            accumulate_luminance(transformed_tile, m_luminance_sum, m_luminance_pixel_count);
+
+            if (m_ref_image)
+            {
+                m_square_deviation_sum =
+                    compute_square_deviation_sum(
+                        transformed_tile,
+                        m_ref_image->tile(m_tile_x, m_tile_y));
+            }
+
+            m_analyzed = 1;
+            m_updated = 1;
+        }
+
+      private:
+        const Frame&            m_frame;
+        const Image*            m_ref_image;
+        Image&                  m_snapshot;
+        const size_t            m_tile_x;
+        const size_t            m_tile_y;
+        uint8&                  m_analyzed;
+        uint8&                  m_updated;
+        double&                 m_luminance_sum;
+        size_t&                 m_luminance_pixel_count;
+        double&                 m_square_deviation_sum;
+    };
+}
+
+FrameAnalyzer::FrameAnalyzer(
+    const Frame&            frame,
+    const Image*            ref_image,
+    const size_t            thread_count)
+  : m_frame(frame)
+  , m_ref_image(ref_image)
+  , m_thread_count(thread_count)
+  , m_snapshot(frame.image().properties())
+  , m_analyzed_tiles(m_snapshot.properties().m_tile_count, 0)
+  , m_luminance_sums(m_snapshot.properties().m_tile_count, 0.0)
+  , m_luminance_pixel_counts(m_snapshot.properties().m_tile_count, 0)
+  , m_square_deviation_sums(m_snapshot.properties().m_tile_count, 0.0)
+  , m_average_luminance(0.0)
+  , m_rms_deviation(0.0)
+{
+    assert(m_ref_image == 0 || are_images_compatible(frame.image(), *m_ref_image));
+}
+
+size_t FrameAnalyzer::update()
+{
+    const CanvasProperties& props = m_snapshot.properties();
+    vector<uint8> updated_tiles(props.m_tile_count, 0);
+
+    JobQueue job_queue;
+    for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+    {
+        for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+        {
+            const size_t tile_index = ty * props.m_tile_count_x + tx;
+            job_queue.schedule(
+                new AnalyzeTileJob(
+                    m_frame,
+                    m_ref_image,
+                    m_snapshot,
+                    tx,
+                    ty,
+                    m_analyzed_tiles[tile_index],
+                    updated_tiles[tile_index],
+                    m_luminance_sums[tile_index],
+                    m_luminance_pixel_counts[tile_index],
+                    m_square_deviation_sums[tile_index]));
+        }
+    }
+
+    JobManager job_manager(
+        global_logger(),
+        job_queue,
+        max<size_t>(min(m_thread_count, props.m_tile_count), 1));
+
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    // Combine the results of all tiles, always in the same order.
+    double luminance_sum = 0.0;
+    size_t luminance_pixel_count = 0;
+    double square_deviation_sum = 0.0;
+
+    for (size_t i = 0; i < props.m_tile_count; ++i)
+    {
+        luminance_sum += m_luminance_sums[i];
+        luminance_pixel_count += m_luminance_pixel_counts[i];
+        square_deviation_sum += m_square_deviation_sums[i];
+    }
+
+    m_average_luminance =
+        luminance_pixel_count > 0
+            ? luminance_sum / luminance_pixel_count
+            : 0.0;
+
+    // Same normalization as foundation::compute_rms_deviation().
+    m_rms_deviation =
+        sqrt(square_deviation_sum / (props.m_pixel_count * square(props.m_channel_count)));
+
+    return count(updated_tiles.begin(), updated_tiles.end(), 1);
+}
+
+}   // namespace renderer
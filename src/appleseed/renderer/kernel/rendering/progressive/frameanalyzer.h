@@ -0,0 +1,105 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_PROGRESSIVE_FRAMEANALYZER_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_PROGRESSIVE_FRAMEANALYZER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/image.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace renderer      { class Frame; }
+
+namespace renderer
+{
+
+//
+// Computes the average luminance of the main image of a frame, and optionally its RMS
+// deviation from a reference image, as the frame gets rendered.
+//
+// Tiles are analyzed in parallel. The results of each tile are cached and only computed
+// again once the content of the tile has changed.
+//
+
+class FrameAnalyzer
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. The reference image, if any, must be compatible with the frame.
+    FrameAnalyzer(
+        const Frame&                frame,
+        const foundation::Image*    ref_image,
+        const size_t                thread_count);
+
+    // Analyze the tiles of the frame that changed since the last call.
+    // Return the number of tiles that were analyzed.
+    size_t update();
+
+    // Return the results of the last update.
+    double get_average_luminance() const;
+    double get_rms_deviation() const;
+
+  private:
+    const Frame&                    m_frame;
+    const foundation::Image*        m_ref_image;
+    const size_t                    m_thread_count;
+    foundation::Image               m_snapshot;                 // untransformed frame pixels last analyzed
+    std::vector<foundation::uint8>  m_analyzed_tiles;
+    std::vector<double>             m_luminance_sums;
+    std::vector<size_t>             m_luminance_pixel_counts;
+    std::vector<double>             m_square_deviation_sums;
+    double                          m_average_luminance;
+    double                          m_rms_deviation;
+};
+
+
+//
+// FrameAnalyzer class implementation.
+//
+
+inline double FrameAnalyzer::get_average_luminance() const
+{
+    return m_average_luminance;
+}
+
+inline double FrameAnalyzer::get_rms_deviation() const
+{
+    return m_rms_deviation;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_PROGRESSIVE_FRAMEANALYZER_H
@@ -32,23 +32,30 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/aov/imagestack.h"
 #include "renderer/kernel/rendering/iframerenderer.h"
 #include "renderer/kernel/rendering/isamplegenerator.h"
 #include "renderer/kernel/rendering/itilecallback.h"
+#include "renderer/kernel/rendering/progressive/frameanalyzer.h"
+#include "renderer/kernel/rendering/progressive/samplecheckpoint.h"
 #include "renderer/kernel/rendering/progressive/samplecounter.h"
 #include "renderer/kernel/rendering/progressive/samplecounthistory.h"
 #include "renderer/kernel/rendering/progressive/samplegeneratorjob.h"
+#include "renderer/kernel/rendering/sample.h"
 #include "renderer/kernel/rendering/sampleaccumulationbuffer.h"
 #include "renderer/modeling/frame/frame.h"
 #include "renderer/modeling/project/project.h"
+#include "renderer/utility/renderstatistics.h"
 #include "renderer/utility/settingsparsing.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/image/analysis.h"
 #include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
 #include "foundation/image/genericimagefilereader.h"
 #include "foundation/image/image.h"
+#include "foundation/image/tile.h"
 #include "foundation/math/aabb.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
@@ -69,6 +76,7 @@
 #include "boost/filesystem.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
@@ -92,6 +100,12 @@ namespace
 
 //#define PRINT_DISPLAY_THREAD_PERFS
 
+    // Number of samples to wait for before displaying the first frame.
+    const uint64 DefaultDisplaySampleCount = 32 * 32 * 2;
+
+    // Smallest number of samples that fills the coarsest level of the accumulation buffer.
+    const uint64 MinDisplaySampleCount = 8 * 8;
+
     class ProgressiveFrameRenderer
       : public IFrameRenderer
     {
@@ -105,6 +119,9 @@ namespace
           , m_params(params)
           , m_sample_counter(m_params.m_max_sample_count)
           , m_ref_image_avg_lum(0.0)
+          , m_resume_pending(m_params.m_resume)
+          , m_session_start_sample_count(0)
+          , m_samples_per_second(0.0)
         {
             // We must have a generator factory, but it's OK not to have a callback factory.
             assert(generator_factory);
@@ -118,7 +135,7 @@ namespace
                     global_logger(),
                     m_job_queue,
                     m_params.m_thread_count,
-                    JobManager::KeepRunningOnEmptyQueue));
+                    JobManager::KeepRunningOnEmptyQueue | m_params.m_thread_affinity_flags));
 
             // Instantiate sample generators, one per rendering thread.
             m_sample_generators.reserve(m_params.m_thread_count);
@@ -126,6 +143,17 @@ namespace
             {
                 m_sample_generators.push_back(
                     generator_factory->create(i, m_params.m_thread_count));
+                m_sample_generators.back()->set_sequence_partition(
+                    m_params.m_sample_partition_index,
+                    m_params.m_sample_partition_count);
+            }
+
+            if (m_params.m_sample_partition_count > 1)
+            {
+                RENDERER_LOG_INFO(
+                    "rendering sample partition " FMT_SIZE_T " of " FMT_SIZE_T ".",
+                    m_params.m_sample_partition_index + 1,
+                    m_params.m_sample_partition_count);
             }
 
             // Create rendering jobs, one per rendering thread.
@@ -147,6 +175,10 @@ namespace
             if (callback_factory)
                 m_tile_callback.reset(callback_factory->create());
 
+            // Periodically save accumulated samples so that interrupted renders can be resumed.
+            if (!m_params.m_checkpoint_file.empty())
+                m_checkpoint.reset(new SampleCheckpoint(m_params.m_checkpoint_file));
+
             // Load the reference image if one is specified.
             if (!m_params.m_ref_image_path.empty())
             {
@@ -186,10 +218,12 @@ namespace
 
         virtual ~ProgressiveFrameRenderer()
         {
-            // Stop the statistics thread.
+            // Stop the statistics and checkpoint threads.
             m_abort_switch.abort();
             if (m_statistics_thread.get() && m_statistics_thread->joinable())
                 m_statistics_thread->join();
+            if (m_checkpoint_thread.get() && m_checkpoint_thread->joinable())
+                m_checkpoint_thread->join();
 
             // Stop the display thread.
             m_display_thread_abort_switch.abort();
@@ -238,6 +272,21 @@ namespace
             for (size_t i = 0, e = m_sample_generators.size(); i < e; ++i)
                 m_sample_generators[i]->reset();
 
+            // Combine samples rendered on other machines instead of rendering the frame,
+            // or continue an interrupted render, but only the first time we render.
+            if (!m_params.m_merge_sample_files.empty())
+                merge_sample_files();
+            else if (m_checkpoint.get() && m_resume_pending)
+                restore_checkpoint();
+            m_resume_pending = false;
+
+            // Otherwise show the preview left in the frame, if any, until enough samples are rendered.
+            const bool has_preview = store_preview_samples();
+
+            // Measure the sample throughput of this rendering session.
+            m_session_start_sample_count = m_buffer->get_sample_count();
+            m_session_stopwatch.start();
+
             // Schedule rendering jobs.
             for (size_t i = 0, e = m_sample_generator_jobs.size(); i < e; ++i)
             {
@@ -258,11 +307,27 @@ namespace
                     m_params.m_luminance_stats,
                     m_ref_image.get(),
                     m_ref_image_avg_lum,
+                    m_params.m_thread_count,
                     m_abort_switch));
             m_statistics_thread.reset(
                 new boost::thread(
                     ThreadFunctionWrapper<StatisticsFunc>(m_statistics_func.get())));
 
+            // Create and start the checkpoint thread.
+            if (m_checkpoint.get())
+            {
+                m_checkpoint_func.reset(
+                    new CheckpointFunc(
+                        *m_checkpoint.get(),
+                        *m_buffer.get(),
+                        m_sample_generators,
+                        m_params.m_checkpoint_interval,
+                        m_abort_switch));
+                m_checkpoint_thread.reset(
+                    new boost::thread(
+                        ThreadFunctionWrapper<CheckpointFunc>(m_checkpoint_func.get())));
+            }
+
             // Create and start the display thread.
             if (m_tile_callback.get() != 0 && m_display_thread.get() == 0)
             {
@@ -271,8 +336,9 @@ namespace
                         *m_project.get_frame(),
                         *m_buffer.get(),
                         m_tile_callback.get(),
-                        m_params.m_max_sample_count,
+                        has_preview ? 0 : compute_min_display_sample_count(),
                         m_params.m_max_fps,
+                        m_params.m_target_latency,
                         m_display_thread_abort_switch));
                 m_display_thread.reset(
                     new boost::thread(
@@ -296,6 +362,10 @@ namespace
 
             // Wait until the statistics thread has stopped.
             m_statistics_thread->join();
+
+            // Wait until the checkpoint thread has stopped.
+            if (m_checkpoint_thread.get())
+                m_checkpoint_thread->join();
         }
 
         virtual void pause_rendering() APPLESEED_OVERRIDE
@@ -306,10 +376,16 @@ namespace
                 m_display_func->pause();
 
             m_statistics_func->pause();
+
+            if (m_checkpoint_func.get())
+                m_checkpoint_func->pause();
         }
 
         virtual void resume_rendering() APPLESEED_OVERRIDE
         {
+            if (m_checkpoint_func.get())
+                m_checkpoint_func->resume();
+
             m_statistics_func->resume();
 
             if (m_display_func.get())
@@ -318,16 +394,46 @@ namespace
             m_job_manager->resume();
         }
 
+        virtual void set_active_thread_count(const size_t thread_count) APPLESEED_OVERRIDE
+        {
+            m_job_manager->set_active_thread_count(thread_count);
+        }
+
         virtual void terminate_rendering() APPLESEED_OVERRIDE
         {
             // Completely stop rendering.
             stop_rendering();
             m_job_manager->stop();
 
+            // Update the sample throughput estimate used to pick the first displayed resolution.
+            update_throughput_estimate();
+
             // The statistics thread has already been joined in stop_rendering().
             m_statistics_thread.reset();
             m_statistics_func.reset();
 
+            // So has the checkpoint thread.
+            m_checkpoint_thread.reset();
+            m_checkpoint_func.reset();
+
+            // Save the last samples, or discard the checkpoint if the frame is complete.
+            if (m_checkpoint.get())
+            {
+                if (m_sample_counter.read() >= m_params.m_max_sample_count || m_buffer->is_converged())
+                    m_checkpoint->remove();
+                else if (!m_checkpoint->save(*m_buffer.get(), m_sample_generators))
+                    RENDERER_LOG_WARNING("failed to write checkpoint file %s.", m_params.m_checkpoint_file.c_str());
+            }
+
+            // Save the samples of this partition of the frame so that they can be merged with the others.
+            if (!m_params.m_sample_file.empty())
+            {
+                const SampleCheckpoint sample_file(m_params.m_sample_file);
+                if (sample_file.save(*m_buffer.get(), m_sample_generators))
+                    RENDERER_LOG_INFO("wrote samples to %s.", m_params.m_sample_file.c_str());
+                else RENDERER_LOG_ERROR("failed to write sample file %s.", m_params.m_sample_file.c_str());
+            }
+
             // Join and delete the display thread.
             if (m_display_thread.get())
             {
@@ -356,6 +462,21 @@ namespace
             print_sample_generators_stats();
         }
 
+        virtual double get_progress() const APPLESEED_OVERRIDE
+        {
+            if (m_buffer->is_converged())
+                return 1.0;
+
+            // Without a sample budget, rendering only stops when the renderer controller says so.
+            if (m_params.m_max_sample_count == numeric_limits<uint64>::max())
+                return -1.0;
+
+            const double progress =
+                static_cast<double>(m_buffer->get_sample_count()) / m_params.m_max_sample_count;
+
+            return min(progress, 1.0);
+        }
+
       private:
         //
         // Progressive frame renderer parameters.
@@ -364,20 +485,38 @@ namespace
         struct Parameters
         {
             const size_t    m_thread_count;             // number of rendering threads
+            const int       m_thread_affinity_flags;    // job manager flags for thread affinity
             const uint64    m_max_sample_count;         // maximum total number of samples to compute
             const double    m_max_fps;                  // maximum display frequency in frames/second
+            const double    m_target_latency;           // maximum time in seconds before the first display, 0 to disable
             const bool      m_perf_stats;               // collect and print performance statistics?
             const bool      m_luminance_stats;          // collect and print luminance statistics?
             const string    m_ref_image_path;           // path to the reference image
+            const string    m_checkpoint_file;          // file in which accumulated samples are saved
+            const double    m_checkpoint_interval;      // time between checkpoints in seconds
+            const bool      m_resume;                   // continue from the checkpoint file if possible?
+            const size_t    m_sample_partition_count;   // number of machines rendering the frame
+            const size_t    m_sample_partition_index;   // partition of the sample sequence rendered by this machine
+            const string    m_sample_file;              // file in which all samples are saved at the end of the render
+            vector<string>  m_merge_sample_files;       // files of samples to merge instead of rendering
 
             explicit Parameters(const ParamArray& params)
               : m_thread_count(get_rendering_thread_count(params))
+              , m_thread_affinity_flags(get_rendering_thread_affinity_flags(params))
               , m_max_sample_count(params.get_optional<uint64>("max_samples", numeric_limits<uint64>::max()))
               , m_max_fps(params.get_optional<double>("max_fps", 30.0))
+              , m_target_latency(params.get_optional<double>("target_latency", 0.0))
               , m_perf_stats(params.get_optional<bool>("performance_statistics", false))
               , m_luminance_stats(params.get_optional<bool>("luminance_statistics", false))
               , m_ref_image_path(params.get_optional<string>("reference_image", ""))
+              , m_checkpoint_file(params.get_optional<string>("checkpoint_file", ""))
+              , m_checkpoint_interval(params.get_optional<double>("checkpoint_interval", 300.0))
+              , m_resume(params.get_optional<bool>("resume", false))
+              , m_sample_partition_count(max<size_t>(params.get_optional<size_t>("sample_partition_count", 1), 1))
+              , m_sample_partition_index(min(params.get_optional<size_t>("sample_partition_index", 0), m_sample_partition_count - 1))
+              , m_sample_file(params.get_optional<string>("sample_file", ""))
             {
+                tokenize(params.get_optional<string>("merge_sample_files", ""), ";", m_merge_sample_files);
             }
         };
 
@@ -393,15 +532,18 @@ namespace
                 Frame&                      frame,
                 SampleAccumulationBuffer&   buffer,
                 ITileCallback*              tile_callback,
-                const uint64                max_sample_count,
+                const uint64                min_sample_count,
                 const double                max_fps,
+                const double                target_latency,
                 IAbortSwitch&               abort_switch)
               : m_frame(frame)
               , m_buffer(buffer)
               , m_tile_callback(tile_callback)
-              , m_min_sample_count(min<uint64>(max_sample_count, 32 * 32 * 2))
+              , m_min_sample_count(min_sample_count)
               , m_target_elapsed(1.0 / max_fps)
+              , m_target_latency(target_latency)
               , m_abort_switch(abort_switch)
+              , m_displayed_sample_count(~uint64(0))
             {
             }
 
@@ -421,7 +563,8 @@ namespace
 
                 DefaultWallclockTimer timer;
                 const double rcp_timer_freq = 1.0 / timer.frequency();
-                uint64 last_time = timer.read();
+                const uint64 start_time = timer.read();
+                uint64 last_time = start_time;
 
 #ifdef PRINT_DISPLAY_THREAD_PERFS
                 m_stopwatch.start();
@@ -433,13 +576,24 @@ namespace
                     {
                         // It's time to display but the sample accumulation buffer doesn't contain
                         // enough samples yet. Giving up would lead to noticeable jerkiness, so we
-                        // wait until enough samples are available.
+                        // wait until enough samples are available. With a target latency, we
+                        // settle for a coarse but complete image once the latency is exceeded.
                         while (!m_abort_switch.is_aborted() &&
                                m_buffer.get_sample_count() < m_min_sample_count)
+                        {
+                            if (m_target_latency > 0.0 &&
+                                m_buffer.get_sample_count() >= MinDisplaySampleCount &&
+                                (timer.read() - start_time) * rcp_timer_freq >= m_target_latency)
+                                break;
+
                             yield();
+                        }
 
-                        // Merge the samples and display the final frame.
-                        develop_and_display();
+                        // Merge the samples and display the final frame, unless no new
+                        // samples were accumulated since the last refresh (for instance
+                        // when rendering is paused or the sample budget is exhausted).
+                        if (m_buffer.get_sample_count() != m_displayed_sample_count)
+                            develop_and_display();
                     }
 
                     // Compute time elapsed since last call to display().
@@ -464,6 +618,7 @@ namespace
 #endif
 
                 // Develop the accumulation buffer to the frame.
+                const uint64 sample_count = m_buffer.get_sample_count();
                 m_buffer.develop_to_frame(m_frame, m_abort_switch);
 
 #ifdef PRINT_DISPLAY_THREAD_PERFS
@@ -477,6 +632,7 @@ namespace
 
                 // Present the frame.
                 m_tile_callback->post_render(&m_frame);
+                m_displayed_sample_count = sample_count;
 
 #ifdef PRINT_DISPLAY_THREAD_PERFS
                 m_stopwatch.measure();
@@ -500,8 +656,10 @@ namespace
             ITileCallback*                      m_tile_callback;
             const uint64                        m_min_sample_count;
             const double                        m_target_elapsed;
+            const double                        m_target_latency;
             IAbortSwitch&                       m_abort_switch;
             ThreadFlag                          m_pause_flag;
+            uint64                              m_displayed_sample_count;
             Stopwatch<DefaultWallclockTimer>    m_stopwatch;
         };
 
@@ -520,6 +678,7 @@ namespace
                 const bool                  luminance_stats,
                 const Image*                ref_image,
                 const double                ref_image_avg_lum,
+                const size_t                thread_count,
                 IAbortSwitch&               abort_switch)
               : m_project(project)
               , m_buffer(buffer)
@@ -528,6 +687,7 @@ namespace
               , m_ref_image(ref_image)
               , m_ref_image_avg_lum(ref_image_avg_lum)
               , m_abort_switch(abort_switch)
+              , m_frame_analyzer(*project.get_frame(), ref_image, thread_count)
               , m_rcp_timer_frequency(1.0 / m_timer.frequency())
               , m_timer_start_value(m_timer.read())
             {
@@ -609,6 +769,7 @@ namespace
             const double                    m_ref_image_avg_lum;
             IAbortSwitch&                   m_abort_switch;
             ThreadFlag                      m_pause_flag;
+            FrameAnalyzer                   m_frame_analyzer;
 
             DefaultWallclockTimer           m_timer;
             double                          m_rcp_timer_frequency;
@@ -643,12 +804,12 @@ namespace
 
                 string output;
 
-                Image current_image(m_project.get_frame()->image());
-                m_project.get_frame()->transform_to_output_color_space(current_image);
+                // Only tiles that changed since the last update are analyzed again.
+                m_frame_analyzer.update();
 
                 if (m_luminance_stats)
                 {
-                    const double avg_lum = compute_average_luminance(current_image);
+                    const double avg_lum = m_frame_analyzer.get_average_luminance();
                     output += "average luminance " + pretty_scalar(avg_lum, 6);
 
                     if (m_ref_image)
@@ -663,7 +824,7 @@ namespace
                 if (m_ref_image)
                 {
                     const double samples_per_pixel = m_buffer.get_sample_count() * m_rcp_pixel_count;
-                    const double rmsd = compute_rms_deviation(current_image, *m_ref_image);
+                    const double rmsd = m_frame_analyzer.get_rms_deviation();
                     m_rmsd_records.push_back(Vector2d(samples_per_pixel, rmsd));
 
                     if (m_luminance_stats)
@@ -675,6 +836,63 @@ namespace
             }
         };
 
+        //
+        // Checkpoint thread.
+        //
+
+        class CheckpointFunc
+          : public NonCopyable
+        {
+          public:
+            CheckpointFunc(
+                const SampleCheckpoint&             checkpoint,
+                SampleAccumulationBuffer&           buffer,
+                const vector<ISampleGenerator*>&    sample_generators,
+                const double                        interval,
+                IAbortSwitch&                       abort_switch)
+              : m_checkpoint(checkpoint)
+              , m_buffer(buffer)
+              , m_sample_generators(sample_generators)
+              , m_interval_ms(static_cast<uint32>(max(interval, 1.0) * 1000.0))
+              , m_abort_switch(abort_switch)
+            {
+            }
+
+            void pause()
+            {
+                m_pause_flag.set();
+            }
+
+            void resume()
+            {
+                m_pause_flag.clear();
+            }
+
+            void operator()()
+            {
+                set_current_thread_name("checkpoint");
+
+                while (true)
+                {
+                    sleep(m_interval_ms, m_abort_switch);
+
+                    if (m_abort_switch.is_aborted())
+                        break;
+
+                    if (m_pause_flag.is_clear() && !m_checkpoint.save(m_buffer, m_sample_generators))
+                        RENDERER_LOG_WARNING("failed to write checkpoint file.");
+                }
+            }
+
+          private:
+            const SampleCheckpoint&             m_checkpoint;
+            SampleAccumulationBuffer&           m_buffer;
+            const vector<ISampleGenerator*>&    m_sample_generators;
+            const uint32                        m_interval_ms;
+            IAbortSwitch&                       m_abort_switch;
+            ThreadFlag                          m_pause_flag;
+        };
+
         //
         // Progressive frame renderer implementation details.
         //
@@ -707,6 +925,166 @@ namespace
         auto_ptr<StatisticsFunc>            m_statistics_func;
         auto_ptr<boost::thread>             m_statistics_thread;
 
+        auto_ptr<SampleCheckpoint>          m_checkpoint;
+        bool                                m_resume_pending;
+        auto_ptr<CheckpointFunc>            m_checkpoint_func;
+        auto_ptr<boost::thread>             m_checkpoint_thread;
+
+        Stopwatch<DefaultWallclockTimer>    m_session_stopwatch;
+        uint64                              m_session_start_sample_count;
+        double                              m_samples_per_second;
+
+        uint64 compute_min_display_sample_count() const
+        {
+            // By default, wait for about two samples per pixel of the 32x32 level of
+            // the accumulation buffer before displaying anything.
+            uint64 count = DefaultDisplaySampleCount;
+
+            // In adaptive mode, display as soon as the samples that can be rendered within
+            // the target latency are available. Fewer samples only fill coarser levels of
+            // the accumulation buffer: the first frame is displayed at a lower resolution
+            // and refined as finer levels fill up.
+            if (m_params.m_target_latency > 0.0 && m_samples_per_second > 0.0)
+            {
+                const double n = m_samples_per_second * m_params.m_target_latency;
+                count =
+                    n < MinDisplaySampleCount ? MinDisplaySampleCount :
+                    n > DefaultDisplaySampleCount ? DefaultDisplaySampleCount :
+                    static_cast<uint64>(n);
+            }
+
+            return min(count, m_params.m_max_sample_count);
+        }
+
+        void update_throughput_estimate()
+        {
+            m_session_stopwatch.measure();
+            const double seconds = m_session_stopwatch.get_seconds();
+            const uint64 samples = m_buffer->get_sample_count() - m_session_start_sample_count;
+
+            // Ignore sessions too short to give a meaningful measure.
+            if (seconds < 0.01 || samples < MinDisplaySampleCount)
+                return;
+
+            // Smooth the estimate over restarts since the cost of samples varies with the view.
+            const double samples_per_second = samples / seconds;
+            m_samples_per_second =
+                m_samples_per_second > 0.0
+                    ? 0.5 * (m_samples_per_second + samples_per_second)
+                    : samples_per_second;
+        }
+
+        void restore_checkpoint()
+        {
+            size_t sequence_begin;
+            if (!m_checkpoint->restore(*m_buffer.get(), sequence_begin))
+            {
+                RENDERER_LOG_INFO("no usable checkpoint found, rendering from scratch.");
+                return;
+            }
+
+            // Don't reuse the sample positions of the interrupted render.
+            for (size_t i = 0, e = m_sample_generators.size(); i < e; ++i)
+                m_sample_generators[i]->skip_sequence(sequence_begin);
+
+            // Count restored samples toward the sample budget.
+            const uint64 sample_count = m_buffer->get_sample_count();
+            m_sample_counter.reserve(sample_count);
+
+            RENDERER_LOG_INFO(
+                "resuming from checkpoint with %s samples already rendered.",
+                pretty_uint(sample_count).c_str());
+        }
+
+        void merge_sample_files()
+        {
+            for (const_each<vector<string> > i = m_params.m_merge_sample_files; i; ++i)
+            {
+                const SampleCheckpoint sample_file(*i);
+                if (!sample_file.merge(*m_buffer.get()))
+                    RENDERER_LOG_ERROR("failed to merge sample file %s.", i->c_str());
+            }
+
+            // The merged samples complete the frame: don't render any more.
+            m_sample_counter.reserve(m_params.m_max_sample_count);
+
+            RENDERER_LOG_INFO(
+                "merged " FMT_SIZE_T " sample file%s with %s samples in total.",
+                m_params.m_merge_sample_files.size(),
+                m_params.m_merge_sample_files.size() > 1 ? "s" : "",
+                pretty_uint(m_buffer->get_sample_count()).c_str());
+        }
+
+        bool store_preview_samples()
+        {
+            Frame& frame = *m_project.get_frame();
+            if (!frame.has_preview())
+                return false;
+
+            // The preview is only valid for this restart.
+            frame.set_has_preview(false);
+
+            const Image& color_image = frame.image();
+            const Image& depth_image = frame.aov_images().get_image(0);
+            const CanvasProperties& frame_props = color_image.properties();
+            const AABB2u& crop_window = frame.get_crop_window();
+            const bool premultiply_alpha = !frame.is_premultiplied_alpha();
+
+            // Turn every valid pixel of the preview into a sample at the center of the pixel.
+            vector<Sample> samples;
+            samples.reserve(frame.get_pixel_count());
+
+            for (size_t ty = 0; ty < frame_props.m_tile_count_y; ++ty)
+            {
+                for (size_t tx = 0; tx < frame_props.m_tile_count_x; ++tx)
+                {
+                    const Tile& color_tile = color_image.tile(tx, ty);
+                    const Tile& depth_tile = depth_image.tile(tx, ty);
+                    const size_t origin_x = tx * frame_props.m_tile_width;
+                    const size_t origin_y = ty * frame_props.m_tile_height;
+
+                    for (size_t py = 0, ph = color_tile.get_height(); py < ph; ++py)
+                    {
+                        for (size_t px = 0, pw = color_tile.get_width(); px < pw; ++px)
+                        {
+                            const Vector2u pi(origin_x + px, origin_y + py);
+                            if (!crop_window.contains(pi))
+                                continue;
+
+                            // Skip pixels that were disoccluded or not covered by the preview.
+                            const float depth = depth_tile.get_component<float>(px, py, 0);
+                            if (depth < 0.0f)
+                                continue;
+
+                            Color4f color;
+                            color_tile.get_pixel(px, py, color);
+
+                            if (premultiply_alpha)
+                            {
+                                color[0] *= color[3];
+                                color[1] *= color[3];
+                                color[2] *= color[3];
+                            }
+
+                            Sample sample;
+                            sample.m_position = Vector2f(frame.get_sample_position(pi.x + 0.5, pi.y + 0.5));
+                            sample.m_values[0] = color[0];
+                            sample.m_values[1] = color[1];
+                            sample.m_values[2] = color[2];
+                            sample.m_values[3] = color[3];
+                            sample.m_values[4] = depth;
+                            samples.push_back(sample);
+                        }
+                    }
+                }
+            }
+
+            if (samples.empty())
+                return false;
+
+            return m_buffer->store_preview_samples(samples.size(), &samples[0]);
+        }
+
         void print_sample_generators_stats() const
         {
             assert(!m_sample_generators.empty());
@@ -717,6 +1095,7 @@ namespace
                 stats.merge(m_sample_generators[i]->get_statistics());
 
             RENDERER_LOG_DEBUG("%s", stats.to_string().c_str());
+            global_render_statistics().record(stats);
         }
     };
 }
@@ -779,6 +1158,14 @@ Dictionary ProgressiveFrameRendererFactory::get_params_metadata()
             .insert("label", "Max FPS")
             .insert("help", "Maximum progressive rendering update rate in frames per second"));
 
+    metadata.dictionaries().insert(
+        "target_latency",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.0")
+            .insert("label", "Target Latency")
+            .insert("help", "Maximum time in seconds before the first image is displayed after a restart; the first images are displayed at a lower resolution if needed (0 to disable)"));
+
     metadata.dictionaries().insert(
         "max_samples",
         Dictionary()
@@ -786,6 +1173,62 @@ Dictionary ProgressiveFrameRendererFactory::get_params_metadata()
             .insert("label", "Max Samples")
             .insert("help", "Maximum number of samples per pixel"));
 
+    metadata.dictionaries().insert(
+        "checkpoint_file",
+        Dictionary()
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("label", "Checkpoint File")
+            .insert("help", "File in which accumulated samples are periodically saved so that an interrupted render can be resumed"));
+
+    metadata.dictionaries().insert(
+        "checkpoint_interval",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "300.0")
+            .insert("label", "Checkpoint Interval")
+            .insert("help", "Time in seconds between two checkpoints"));
+
+    metadata.dictionaries().insert(
+        "resume",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Resume")
+            .insert("help", "Continue an interrupted render from the checkpoint file"));
+
+    metadata.dictionaries().insert(
+        "sample_partition_index",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "0")
+            .insert("label", "Sample Partition Index")
+            .insert("help", "Index of the partition of the sample sequence rendered by this machine"));
+
+    metadata.dictionaries().insert(
+        "sample_partition_count",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "1")
+            .insert("label", "Sample Partition Count")
+            .insert("help", "Number of disjoint partitions of the sample sequence, i.e. of machines rendering the frame"));
+
+    metadata.dictionaries().insert(
+        "sample_file",
+        Dictionary()
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("label", "Sample File")
+            .insert("help", "File in which the accumulated samples are saved at the end of the render, to be merged with those of other partitions"));
+
+    metadata.dictionaries().insert(
+        "merge_sample_files",
+        Dictionary()
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("label", "Merge Sample Files")
+            .insert("help", "Semicolon-separated list of sample files whose samples are merged into the frame instead of rendering it"));
+
     return metadata;
 }
 
@@ -0,0 +1,153 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "samplecheckpoint.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/isamplegenerator.h"
+#include "renderer/kernel/rendering/sampleaccumulationbuffer.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <fstream>
+
+using namespace foundation;
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace renderer
+{
+
+//
+// SampleCheckpoint class implementation.
+//
+
+namespace
+{
+    const uint64 CheckpointMagic = 0x415350524F434B31ULL;      // 'ASPROCK1'
+}
+
+SampleCheckpoint::SampleCheckpoint(const string& path)
+  : m_path(path)
+{
+}
+
+bool SampleCheckpoint::save(
+    SampleAccumulationBuffer&       buffer,
+    const SampleGeneratorVector&    sample_generators) const
+{
+    const string tmp_path = m_path + ".tmp";
+
+    {
+        ofstream file(tmp_path.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+        if (!file.is_open())
+            return false;
+
+        file.write(reinterpret_cast<const char*>(&CheckpointMagic), sizeof(CheckpointMagic));
+
+        if (!buffer.save_samples(file))
+            return false;
+
+        // Sample generators only move forward: positions read after saving the
+        // buffer are beyond the positions of all the samples it contains.
+        uint64 sequence_end = 0;
+        for (size_t i = 0, e = sample_generators.size(); i < e; ++i)
+            sequence_end = max<uint64>(sequence_end, sample_generators[i]->get_sequence_end());
+
+        file.write(reinterpret_cast<const char*>(&sequence_end), sizeof(sequence_end));
+
+        if (file.fail())
+            return false;
+    }
+
+    boost::system::error_code ec;
+    bf::rename(tmp_path, m_path, ec);
+
+    return !ec;
+}
+
+bool SampleCheckpoint::restore(
+    SampleAccumulationBuffer&       buffer,
+    size_t&                         sequence_begin) const
+{
+    ifstream file(m_path.c_str(), ios_base::in | ios_base::binary);
+    if (!file.is_open())
+        return false;
+
+    uint64 magic;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+
+    if (file.fail() || magic != CheckpointMagic)
+        return false;
+
+    if (!buffer.load_samples(file))
+        return false;
+
+    uint64 sequence_end;
+    file.read(reinterpret_cast<char*>(&sequence_end), sizeof(sequence_end));
+
+    if (file.fail())
+    {
+        buffer.clear();
+        return false;
+    }
+
+    sequence_begin = static_cast<size_t>(sequence_end);
+    return true;
+}
+
+bool SampleCheckpoint::merge(SampleAccumulationBuffer& buffer) const
+{
+    ifstream file(m_path.c_str(), ios_base::in | ios_base::binary);
+    if (!file.is_open())
+        return false;
+
+    uint64 magic;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+
+    if (file.fail() || magic != CheckpointMagic)
+        return false;
+
+    // The position reached in the sample sequence is irrelevant once merged.
+    return buffer.merge_samples(file);
+}
+
+void SampleCheckpoint::remove() const
+{
+    boost::system::error_code ec;
+    bf::remove(m_path, ec);
+}
+
+}   // namespace renderer
@@ -0,0 +1,96 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_PROGRESSIVE_SAMPLECHECKPOINT_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_PROGRESSIVE_SAMPLECHECKPOINT_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations.
+namespace renderer      { class ISampleGenerator; }
+namespace renderer      { class SampleAccumulationBuffer; }
+
+namespace renderer
+{
+
+//
+// A file holding the samples accumulated by a progressive render so far, and the
+// position reached in the sample sequence, so that an interrupted render can resume
+// where it stopped without reusing sample positions.
+//
+// The same files hold the partial results of a frame rendered on several machines,
+// each one rendering a distinct partition of the sample sequence: merging them gives
+// the same result as rendering all the samples on a single machine.
+//
+// The file is first written under a temporary name then renamed, so that a process
+// killed while saving leaves the previous checkpoint intact. The file uses the
+// native byte order and is only meant to be read back on the same kind of machine.
+//
+
+class SampleCheckpoint
+  : public foundation::NonCopyable
+{
+  public:
+    typedef std::vector<ISampleGenerator*> SampleGeneratorVector;
+
+    // Constructor. Does not access the file.
+    explicit SampleCheckpoint(const std::string& path);
+
+    // Save the content of an accumulation buffer and the position reached by a set
+    // of sample generators. May be called while rendering. Return false on failure.
+    bool save(
+        SampleAccumulationBuffer&       buffer,
+        const SampleGeneratorVector&    sample_generators) const;
+
+    // Restore the content of an accumulation buffer and retrieve the position of the
+    // sample sequence from which to continue. Return false if the file does not
+    // exist or was written for a different buffer.
+    bool restore(
+        SampleAccumulationBuffer&       buffer,
+        size_t&                         sequence_begin) const;
+
+    // Add the samples of the file to the content of an accumulation buffer. Return false
+    // if the file does not exist or was written for a different buffer.
+    bool merge(SampleAccumulationBuffer& buffer) const;
+
+    // Delete the file, e.g. once the frame is complete.
+    void remove() const;
+
+  private:
+    const std::string                   m_path;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_PROGRESSIVE_SAMPLECHECKPOINT_H
@@ -41,6 +41,9 @@
 #include "foundation/image/image.h"
 #include "foundation/math/scalar.h"
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/snprintf.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/stopwatch.h"
 
 // Boost headers.
@@ -116,6 +119,10 @@ void SampleGeneratorJob::execute(const size_t thread_index)
     const double t1 = stopwatch.get_seconds();
 #endif
 
+    // Terminate this job if all pixels have converged.
+    if (m_buffer.is_converged())
+        return;
+
     // We will base the number of samples to be rendered by this job on
     // the number of samples already reserved (not necessarily rendered).
     const uint64 current_sample_count = m_sample_counter.read();
@@ -134,6 +141,18 @@ void SampleGeneratorJob::execute(const size_t thread_index)
     // samples during this phase; fix.
     const bool abortable = current_sample_count > SamplesInUninterruptiblePhase;
 
+    char trace_detail[EventTracer::MaxDetailLength + 1] = "";
+    if (global_event_tracer().is_enabled())
+    {
+        portable_snprintf(
+            trace_detail,
+            sizeof(trace_detail),
+            FMT_UINT64 " samples",
+            acquired_sample_count);
+    }
+
+    EventTraceScope trace_scope("rendering", "sample batch", trace_detail);
+
     // Render the samples and store them into the accumulation buffer.
     if (abortable)
     {
@@ -0,0 +1,238 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "qualityrenderercontroller.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/rendering/pixelstatistics.h"
+#include "renderer/modeling/frame/frame.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/math/aabb.h"
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// QualityRendererController class implementation.
+//
+
+namespace
+{
+    // Minimum number of samples of every pixel before its noise is estimated.
+    const uint32 MinSamplesPerPixel = 4;
+
+    // Average luminance below which the noise is measured relative to this value,
+    // same as in the convergence map.
+    const double MinLuminance = 0.01;
+
+    // Return the noise of a rectangle of pixels, or a negative value if some of them
+    // did not receive enough samples.
+    double estimate_noise(
+        const PixelStatistics&  stats,
+        const size_t            x0,
+        const size_t            y0,
+        const size_t            x1,
+        const size_t            y1)
+    {
+        double sum_mean = 0.0;
+        double sum_sq_error = 0.0;
+
+        for (size_t y = y0; y <= y1; ++y)
+        {
+            for (size_t x = x0; x <= x1; ++x)
+            {
+                const PixelStatistics::Entry& entry = stats.get(x, y);
+
+                if (entry.m_sample_count < MinSamplesPerPixel)
+                    return -1.0;
+
+                sum_mean += entry.get_mean();
+                sum_sq_error += entry.get_variance() / entry.m_sample_count;
+            }
+        }
+
+        const double pixel_count = static_cast<double>((x1 - x0 + 1) * (y1 - y0 + 1));
+        const double mean = sum_mean / pixel_count;
+        const double rms_error = sqrt(sum_sq_error / pixel_count);
+
+        return rms_error / max(mean, MinLuminance);
+    }
+}
+
+struct QualityRendererController::Impl
+{
+    Frame&                              m_frame;
+    const float                         m_noise_threshold;
+    const Scope                         m_scope;
+    const double                        m_max_seconds;
+    const double                        m_check_interval;
+    Stopwatch<DefaultWallclockTimer>    m_stopwatch;
+    double                              m_last_check_time;
+    double                              m_noise;
+
+    Impl(
+        Frame&          frame,
+        const float     noise_threshold,
+        const Scope     scope,
+        const double    max_seconds,
+        const double    check_interval)
+      : m_frame(frame)
+      , m_noise_threshold(noise_threshold)
+      , m_scope(scope)
+      , m_max_seconds(max_seconds)
+      , m_check_interval(check_interval)
+      , m_last_check_time(0.0)
+      , m_noise(-1.0)
+    {
+    }
+
+    double estimate_frame_noise() const
+    {
+        const PixelStatistics* stats = m_frame.get_pixel_statistics();
+        assert(stats);
+
+        const AABB2u& crop_window = m_frame.get_crop_window();
+
+        if (m_scope == WholeFrame)
+        {
+            return
+                estimate_noise(
+                    *stats,
+                    crop_window.min.x,
+                    crop_window.min.y,
+                    crop_window.max.x,
+                    crop_window.max.y);
+        }
+
+        // Return the noise of the noisiest tile.
+        const CanvasProperties& props = m_frame.image().properties();
+        double max_noise = 0.0;
+
+        for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+        {
+            for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+            {
+                const size_t x0 = max(tx * props.m_tile_width, crop_window.min.x);
+                const size_t y0 = max(ty * props.m_tile_height, crop_window.min.y);
+                const size_t x1 = min((tx + 1) * props.m_tile_width - 1, crop_window.max.x);
+                const size_t y1 = min((ty + 1) * props.m_tile_height - 1, crop_window.max.y);
+
+                if (x0 > x1 || y0 > y1)
+                    continue;
+
+                const double noise = estimate_noise(*stats, x0, y0, x1, y1);
+
+                if (noise < 0.0)
+                    return noise;
+
+                max_noise = max(max_noise, noise);
+            }
+        }
+
+        return max_noise;
+    }
+};
+
+QualityRendererController::QualityRendererController(
+    Frame&          frame,
+    const float     noise_threshold,
+    const Scope     scope,
+    const double    max_seconds,
+    const double    check_interval)
+  : impl(new Impl(frame, noise_threshold, scope, max_seconds, check_interval))
+{
+    frame.enable_pixel_statistics();
+}
+
+QualityRendererController::~QualityRendererController()
+{
+    delete impl;
+}
+
+void QualityRendererController::on_frame_begin()
+{
+    impl->m_stopwatch.start();
+    impl->m_last_check_time = 0.0;
+    impl->m_noise = -1.0;
+}
+
+IRendererController::Status QualityRendererController::get_status() const
+{
+    const double seconds = impl->m_stopwatch.measure().get_seconds();
+
+    if (impl->m_max_seconds > 0.0 && seconds > impl->m_max_seconds)
+    {
+        RENDERER_LOG_INFO("time limit reached, stopping rendering.");
+        return TerminateRendering;
+    }
+
+    // Estimating the noise requires a pass over the whole frame: don't do it too often.
+    if (seconds - impl->m_last_check_time < impl->m_check_interval)
+        return ContinueRendering;
+
+    impl->m_last_check_time = seconds;
+    impl->m_noise = impl->estimate_frame_noise();
+
+    if (impl->m_noise >= 0.0 && impl->m_noise <= impl->m_noise_threshold)
+    {
+        RENDERER_LOG_INFO(
+            "noise %s below target %s reached after %s, stopping rendering.",
+            pretty_scalar(impl->m_noise, 4).c_str(),
+            pretty_scalar(impl->m_noise_threshold, 4).c_str(),
+            pretty_time(seconds).c_str());
+        return TerminateRendering;
+    }
+
+    return ContinueRendering;
+}
+
+float QualityRendererController::get_noise() const
+{
+    return static_cast<float>(impl->m_noise);
+}
+
+}   // namespace renderer
@@ -0,0 +1,96 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_QUALITYRENDERERCONTROLLER_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_QUALITYRENDERERCONTROLLER_H
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/defaultrenderercontroller.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Forward declarations.
+namespace renderer  { class Frame; }
+
+namespace renderer
+{
+
+//
+// A renderer controller that terminates rendering once the image is good enough,
+// with an optional time limit.
+//
+// The noise of a region of the frame is the RMS standard error of the average
+// luminance of its pixels, relative to the average luminance of the region. It is
+// estimated from the per-pixel sample statistics of the frame, which are enabled
+// by the controller and only accumulated by progressive rendering.
+//
+
+class APPLESEED_DLLSYMBOL QualityRendererController
+  : public DefaultRendererController
+{
+  public:
+    enum Scope
+    {
+        WholeFrame,                             // the noise of the whole frame must be below the threshold
+        EveryTile                               // the noise of every tile must be below the threshold
+    };
+
+    // Constructor.
+    QualityRendererController(
+        Frame&          frame,
+        const float     noise_threshold,
+        const Scope     scope = WholeFrame,
+        const double    max_seconds = 0.0,      // 0 for no time limit
+        const double    check_interval = 1.0);  // time in seconds between two noise estimates
+
+    // Destructor.
+    ~QualityRendererController();
+
+    // This method is called before rendering a single frame.
+    virtual void on_frame_begin() APPLESEED_OVERRIDE;
+
+    // Return the current rendering status.
+    virtual Status get_status() const APPLESEED_OVERRIDE;
+
+    // Return the noise of the frame, or of its noisiest tile, at the last estimate.
+    // Return a negative value if some pixels did not receive enough samples yet.
+    float get_noise() const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_QUALITYRENDERERCONTROLLER_H
@@ -33,6 +33,7 @@
 #include "renderer/global/globallogger.h"
 #include "renderer/kernel/lighting/drt/drtlightingengine.h"
 #include "renderer/kernel/lighting/lighttracing/lighttracingsamplegenerator.h"
+#include "renderer/kernel/lighting/pt/ptguidingpasscallback.h"
 #include "renderer/kernel/lighting/pt/ptlightingengine.h"
 #include "renderer/kernel/lighting/sppm/sppmlightingengine.h"
 #include "renderer/kernel/lighting/sppm/sppmparameters.h"
@@ -83,6 +84,7 @@ namespace
         ParamArray child = source.child(name);
         copy_param(child, source, "sampling_mode");
         copy_param(child, source, "rendering_threads");
+        copy_param(child, source, "rendering_threads_affinity");
         return child;
     }
 }
@@ -92,6 +94,8 @@ RendererComponents::RendererComponents(
     const ParamArray&       params,
     ITileCallbackFactory*   tile_callback_factory,
     TextureStore&           texture_store,
+    LightSampler&           light_sampler,
+    PrimaryHitCache*        primary_hit_cache,
     OIIO::TextureSystem&    texture_system,
     OSL::ShadingSystem&     shading_system
     )
@@ -101,7 +105,8 @@ RendererComponents::RendererComponents(
   , m_scene(*project.get_scene())
   , m_frame(*project.get_frame())
   , m_trace_context(project.get_trace_context())
-  , m_light_sampler(m_scene, get_child_and_inherit_globals(params, "light_sampler"))
+  , m_light_sampler(light_sampler)
+  , m_primary_hit_cache(primary_hit_cache)
   , m_shading_engine(get_child_and_inherit_globals(params, "shading_engine"))
   , m_texture_store(texture_store)
   , m_texture_system(texture_system)
@@ -152,16 +157,36 @@ bool RendererComponents::create_lighting_engine_factory()
     {
         m_lighting_engine_factory.reset(
             new DRTLightingEngineFactory(
+                m_scene,
                 m_light_sampler,
                 get_child_and_inherit_globals(m_params, "drt")));   // todo: change to "drt_lighting_engine"?
         return true;
     }
     else if (name == "pt")
     {
+        const ParamArray pt_params = get_child_and_inherit_globals(m_params, "pt");     // todo: change to "pt_lighting_engine"?
+
+        // The path guiding tree is trained between the passes of the generic frame renderer.
+        PathGuidingTree* guiding_tree = 0;
+        if (pt_params.get_optional<bool>("enable_path_guiding", false))
+        {
+            if (m_params.get_optional<string>("frame_renderer", "generic") == "generic")
+            {
+                PTGuidingPassCallback* pt_guiding_pass_callback =
+                    new PTGuidingPassCallback(m_scene, pt_params);
+
+                m_pass_callback.reset(pt_guiding_pass_callback);
+                guiding_tree = &pt_guiding_pass_callback->get_guiding_tree();
+            }
+            else RENDERER_LOG_WARNING("path guiding is only supported by the generic frame renderer.");
+        }
+
         m_lighting_engine_factory.reset(
             new PTLightingEngineFactory(
+                m_frame,
                 m_light_sampler,
-                get_child_and_inherit_globals(m_params, "pt")));    // todo: change to "pt_lighting_engine"?
+                pt_params,
+                guiding_tree));
         return true;
     }
     else if (name == "sppm")
@@ -177,7 +202,8 @@ bool RendererComponents::create_lighting_engine_factory()
                 m_texture_store,
                 m_texture_system,
                 m_shading_system,
-                sppm_params);
+                sppm_params,
+                m_params.get_path_optional<size_t>("generic_frame_renderer.passes", 1));
 
         m_pass_callback.reset(sppm_pass_callback);
 
@@ -218,6 +244,7 @@ bool RendererComponents::create_sample_renderer_factory()
                 m_shading_engine,
                 m_texture_system,
                 m_shading_system,
+                m_primary_hit_cache,
                 get_child_and_inherit_globals(m_params, "generic_sample_renderer")));
         return true;
     }
@@ -318,11 +345,14 @@ bool RendererComponents::create_pixel_renderer_factory()
             return false;
         }
 
+        // The frame sample budget of the adaptive pixel renderer is spread over the passes.
+        ParamArray params = get_child_and_inherit_globals(m_params, "adaptive_pixel_renderer");
+        params.insert("passes", m_params.get_path_optional<size_t>("generic_frame_renderer.passes", 1));
         m_pixel_renderer_factory.reset(
             new AdaptivePixelRendererFactory(
                 m_frame,
                 m_sample_renderer_factory.get(),
-                get_child_and_inherit_globals(m_params, "adaptive_pixel_renderer")));
+                params));
         return true;
     }
     else
@@ -354,6 +384,12 @@ bool RendererComponents::create_shading_result_framebuffer_factory()
             new PermanentShadingResultFrameBufferFactory(m_frame));
         return true;
     }
+    else if (name == "permanent_compact")
+    {
+        m_shading_result_framebuffer_factory.reset(
+            new PermanentShadingResultFrameBufferFactory(m_frame, true));
+        return true;
+    }
     else
     {
         RENDERER_LOG_ERROR(
@@ -64,6 +64,7 @@ namespace renderer  { class Frame; }
 namespace renderer  { class IFrameRenderer; }
 namespace renderer  { class ITileCallbackFactory; }
 namespace renderer  { class ParamArray; }
+namespace renderer  { class PrimaryHitCache; }
 namespace renderer  { class Project; }
 namespace renderer  { class Scene; }
 namespace renderer  { class TextureStore; }
@@ -85,6 +86,8 @@ class RendererComponents
         const ParamArray&       params,
         ITileCallbackFactory*   tile_callback_factory,
         TextureStore&           texture_store,
+        LightSampler&           light_sampler,
+        PrimaryHitCache*        primary_hit_cache,
         OIIO::TextureSystem&    texture_system,
         OSL::ShadingSystem&     shading_system);
 
@@ -99,7 +102,8 @@ class RendererComponents
     const Scene&                m_scene;
     const Frame&                m_frame;
     const TraceContext&         m_trace_context;
-    LightSampler                m_light_sampler;
+    LightSampler&               m_light_sampler;
+    PrimaryHitCache*            m_primary_hit_cache;
     ShadingEngine               m_shading_engine;
     TextureStore&               m_texture_store;
     OIIO::TextureSystem&        m_texture_system;
@@ -40,6 +40,7 @@
 #include "renderer/modeling/project/project.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/version.h"
@@ -95,6 +96,8 @@ RendererServices::RendererServices(
     OIIO::TextureSystem&        texture_sys)
   : OSL::RendererServices(&texture_sys)
   , m_texture_sys(texture_sys)
+  , m_camera(0)
+  , m_camera_is_animated(false)
   , m_project(project)
   , m_texture_store(0)
 {
@@ -147,6 +150,16 @@ void RendererServices::initialize(TextureStore& texture_store)
         m_shutter[0] = m_camera->get_shutter_open_time();
         m_shutter[1] = m_camera->get_shutter_close_time();
         m_shutter_interval = m_camera->get_shutter_open_time_interval();
+
+        // Static camera transforms are queried by shaders at every shading point: compute them once.
+        const TransformSequence& transform_sequence = m_camera->transform_sequence();
+        m_camera_is_animated = transform_sequence.size() > 1;
+        if (!m_camera_is_animated)
+        {
+            const Transformd& transform = transform_sequence.get_earliest_transform();
+            m_camera_transform = Matrix4f(transform.get_local_to_parent());
+            m_camera_inverse_transform = Matrix4f(transform.get_parent_to_local());
+        }
     }
 
     const CanvasProperties& props = m_project.get_frame()->image().properties();
@@ -268,12 +281,17 @@ bool RendererServices::get_matrix(
     OIIO::ustring               from,
     float                       time)
 {
-    if (from == g_camera_ustr)
+    if (from == g_camera_ustr && m_camera)
     {
-        Transformd scratch;
-        const Transformd& transform =
-            m_camera->transform_sequence().evaluate(time, scratch);
-        result = Matrix4f(transform.get_local_to_parent());
+        if (m_camera_is_animated)
+        {
+            Transformd scratch;
+            const Transformd& transform =
+                m_camera->transform_sequence().evaluate(time, scratch);
+            result = Matrix4f(transform.get_local_to_parent());
+        }
+        else result = m_camera_transform;
+
         return true;
     }
 
@@ -286,12 +304,17 @@ bool RendererServices::get_inverse_matrix(
     OSL::ustring                to,
     float                       time)
 {
-    if (to == g_camera_ustr)
+    if (to == g_camera_ustr && m_camera)
     {
-        Transformd scratch;
-        const Transformd& transform =
-            m_camera->transform_sequence().evaluate(time, scratch);
-        result = Matrix4f(transform.get_parent_to_local());
+        if (m_camera_is_animated)
+        {
+            Transformd scratch;
+            const Transformd& transform =
+                m_camera->transform_sequence().evaluate(time, scratch);
+            result = Matrix4f(transform.get_parent_to_local());
+        }
+        else result = m_camera_inverse_transform;
+
         return true;
     }
 
@@ -307,14 +330,12 @@ bool RendererServices::get_matrix(
     OSL::Matrix44&              result,
     OIIO::ustring               from)
 {
-    if (from == g_camera_ustr)
+    if (from == g_camera_ustr && m_camera)
     {
-        if (m_camera->transform_sequence().size() > 1)
+        if (m_camera_is_animated)
             return false;
 
-        const Transformd& scratch =
-            m_camera->transform_sequence().get_earliest_transform();
-        result = Matrix4f(scratch.get_local_to_parent());
+        result = m_camera_transform;
         return true;
     }
 
@@ -326,14 +347,12 @@ bool RendererServices::get_inverse_matrix(
     OSL::Matrix44&              result,
     OSL::ustring                to)
 {
-    if (to == g_camera_ustr)
+    if (to == g_camera_ustr && m_camera)
     {
-        if (m_camera->transform_sequence().size() > 1)
+        if (m_camera_is_animated)
             return false;
 
-        const Transformd& scratch =
-            m_camera->transform_sequence().get_earliest_transform();
-        result = Matrix4f(scratch.get_parent_to_local());
+        result = m_camera_inverse_transform;
         return true;
     }
 
@@ -546,7 +565,7 @@ bool RendererServices::get_attribute(
     void*                       val)
 {
     // We don't support getting attributes from named objects, yet.
-    if (object != g_empty_ustr)
+    if (!object.empty())
         return false;
 
     // Try global attributes.
@@ -558,10 +577,7 @@ bool RendererServices::get_attribute(
     }
 
     // Try user data from the current object.
-    if (object.empty())
-        return get_userdata(derivatives, name, type, sg, val);
-
-    return false;
+    return get_userdata(derivatives, name, type, sg, val);
 }
 
 bool RendererServices::get_array_attribute(
@@ -328,6 +328,9 @@ class RendererServices
     AttrGetterMapType               m_global_attr_getters;
     UserDataGetterMapType           m_global_user_data_getters;
     const Camera*                   m_camera;
+    bool                            m_camera_is_animated;
+    OSL::Matrix44                   m_camera_transform;
+    OSL::Matrix44                   m_camera_inverse_transform;
     foundation::Vector2i            m_resolution;
     OIIO::ustring                   m_cam_projection_str;
     float                           m_shutter[2];
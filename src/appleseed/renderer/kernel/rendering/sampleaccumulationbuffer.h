@@ -32,11 +32,15 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/filteredtile.h"
 #include "foundation/platform/atomic.h"
 #include "foundation/platform/types.h"
 
 // Standard headers.
 #include <cstddef>
+#include <istream>
+#include <ostream>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
@@ -70,8 +74,49 @@ class SampleAccumulationBuffer
         Frame&                      frame,
         foundation::IAbortSwitch&   abort_switch) = 0;
 
+    // Store samples that only serve as a preview until enough samples have been rendered,
+    // for instance samples reprojected from a previous frame. They are not counted in the
+    // number of samples stored in the buffer. Return false if this buffer doesn't support
+    // previews. Thread-safe.
+    virtual bool store_preview_samples(
+        const size_t                sample_count,
+        const Sample                samples[]);
+
+    // Return true if enough samples were stored and no more are needed. Thread-safe.
+    virtual bool is_converged() const;
+
+    // Write the accumulated samples to a stream. Return false on I/O error or if
+    // this buffer cannot be saved. Thread-safe.
+    virtual bool save_samples(std::ostream& output);
+
+    // Replace the content of the buffer by samples written by save_samples().
+    // Return false if they could not be read or do not fit this buffer. Thread-safe.
+    virtual bool load_samples(std::istream& input);
+
+    // Add samples written by save_samples(), for instance by another machine rendering
+    // a different partition of the sample sequence, to the content of the buffer.
+    // Return false if they could not be read or do not fit this buffer. Thread-safe.
+    virtual bool merge_samples(std::istream& input);
+
   protected:
     boost::atomic<foundation::uint64> m_sample_count;
+
+    // Write or read the raw content of a framebuffer and the sample count.
+    static bool save_tile(
+        std::ostream&                   output,
+        const foundation::FilteredTile& tile,
+        const foundation::uint64        sample_count);
+    static bool load_tile(
+        std::istream&                   input,
+        foundation::FilteredTile&       tile,
+        foundation::uint64&             sample_count);
+
+    // Add the raw content of a framebuffer written by save_tile() to a framebuffer.
+    // The framebuffer is left unchanged on failure.
+    static bool merge_tile(
+        std::istream&                   input,
+        foundation::FilteredTile&       tile,
+        foundation::uint64&             sample_count);
 };
 
 
@@ -84,6 +129,105 @@ inline foundation::uint64 SampleAccumulationBuffer::get_sample_count() const
     return m_sample_count;
 }
 
+inline bool SampleAccumulationBuffer::store_preview_samples(
+    const size_t                    sample_count,
+    const Sample                    samples[])
+{
+    return false;
+}
+
+inline bool SampleAccumulationBuffer::is_converged() const
+{
+    return false;
+}
+
+inline bool SampleAccumulationBuffer::save_samples(std::ostream& output)
+{
+    return false;
+}
+
+inline bool SampleAccumulationBuffer::load_samples(std::istream& input)
+{
+    return false;
+}
+
+inline bool SampleAccumulationBuffer::merge_samples(std::istream& input)
+{
+    return false;
+}
+
+inline bool SampleAccumulationBuffer::save_tile(
+    std::ostream&                   output,
+    const foundation::FilteredTile& tile,
+    const foundation::uint64        sample_count)
+{
+    const foundation::uint64 header[4] =
+    {
+        tile.get_width(),
+        tile.get_height(),
+        tile.get_channel_count(),
+        sample_count
+    };
+
+    output.write(reinterpret_cast<const char*>(header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(tile.get_storage()), tile.get_size());
+
+    return !output.fail();
+}
+
+inline bool SampleAccumulationBuffer::load_tile(
+    std::istream&                   input,
+    foundation::FilteredTile&       tile,
+    foundation::uint64&             sample_count)
+{
+    foundation::uint64 header[4];
+    input.read(reinterpret_cast<char*>(header), sizeof(header));
+
+    if (input.fail() ||
+        header[0] != tile.get_width() ||
+        header[1] != tile.get_height() ||
+        header[2] != tile.get_channel_count())
+        return false;
+
+    input.read(reinterpret_cast<char*>(tile.get_storage()), tile.get_size());
+
+    if (input.fail())
+        return false;
+
+    sample_count = header[3];
+    return true;
+}
+
+inline bool SampleAccumulationBuffer::merge_tile(
+    std::istream&                   input,
+    foundation::FilteredTile&       tile,
+    foundation::uint64&             sample_count)
+{
+    foundation::uint64 header[4];
+    input.read(reinterpret_cast<char*>(header), sizeof(header));
+
+    if (input.fail() ||
+        header[0] != tile.get_width() ||
+        header[1] != tile.get_height() ||
+        header[2] != tile.get_channel_count())
+        return false;
+
+    // Framebuffers store unnormalized weighted sums and weights: merging them is a sum.
+    const size_t value_count = tile.get_size() / sizeof(float);
+    std::vector<float> values(value_count);
+    input.read(reinterpret_cast<char*>(&values[0]), tile.get_size());
+
+    if (input.fail())
+        return false;
+
+    float* ptr = reinterpret_cast<float*>(tile.get_storage());
+    for (size_t i = 0; i < value_count; ++i)
+        ptr[i] += values[i];
+
+    sample_count = header[3];
+    return true;
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_SAMPLEACCUMULATIONBUFFER_H
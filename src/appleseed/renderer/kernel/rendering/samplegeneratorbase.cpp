@@ -58,18 +58,55 @@ SampleGeneratorBase::SampleGeneratorBase(
     const size_t                generator_index,
     const size_t                generator_count)
   : m_generator_index(generator_index)
+  , m_generator_count(generator_count)
+  , m_partition_index(0)
+  , m_partition_count(1)
   , m_stride((generator_count - 1) * SampleBatchSize)
 {
     reset();
 }
 
+void SampleGeneratorBase::set_sequence_partition(
+    const size_t                partition_index,
+    const size_t                partition_count)
+{
+    assert(partition_index < partition_count);
+
+    // Batches are interleaved between partitions, then between the generators of
+    // a partition: the partitions remain disjoint whatever their generator counts.
+    m_partition_index = partition_index;
+    m_partition_count = partition_count;
+    m_stride = (m_generator_count * partition_count - 1) * SampleBatchSize;
+}
+
 void SampleGeneratorBase::reset()
 {
-    m_sequence_index = m_generator_index * SampleBatchSize;
+    m_sequence_index = get_first_batch_index() * SampleBatchSize;
+    m_sequence_end = m_sequence_index;
     m_current_batch_size = 0;
     m_invalid_sample_count = 0;
 }
 
+void SampleGeneratorBase::skip_sequence(const size_t sequence_begin)
+{
+    // Keep the interleaving of batches between partitions and generators.
+    const size_t period = m_partition_count * SampleBatchSize;
+    const size_t aligned_begin = ((sequence_begin + period - 1) / period) * period;
+    m_sequence_index = aligned_begin + get_first_batch_index() * SampleBatchSize;
+    m_sequence_end = m_sequence_index;
+    m_current_batch_size = 0;
+}
+
+size_t SampleGeneratorBase::get_sequence_end() const
+{
+    return m_sequence_end;
+}
+
+size_t SampleGeneratorBase::get_first_batch_index() const
+{
+    return m_generator_index * m_partition_count + m_partition_index;
+}
+
 void SampleGeneratorBase::generate_samples(
     const size_t                sample_count,
     SampleAccumulationBuffer&   buffer,
@@ -94,11 +131,28 @@ void SampleGeneratorBase::generate_samples(
 
             if (abort_switch.is_aborted())
                 break;
+
+            // Don't keep looking for unconverged pixels if there are none left.
+            if (buffer.is_converged())
+                break;
         }
     }
 
+    // Publish the position before storing the samples so that it is always
+    // beyond the positions of the samples found in the buffer.
+    m_sequence_end = m_sequence_index;
+
     if (stored > 0)
-        buffer.store_samples(stored, &m_samples[0], abort_switch);
+        store_samples(stored, &m_samples[0], buffer, abort_switch);
+}
+
+void SampleGeneratorBase::store_samples(
+    const size_t                sample_count,
+    const Sample                samples[],
+    SampleAccumulationBuffer&   buffer,
+    IAbortSwitch&               abort_switch)
+{
+    buffer.store_samples(sample_count, samples, abort_switch);
 }
 
 void SampleGeneratorBase::signal_invalid_sample()
@@ -35,6 +35,7 @@
 #include "renderer/kernel/rendering/sample.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/atomic.h"
 #include "foundation/platform/types.h"
 
 // Standard headers.
@@ -60,9 +61,20 @@ class SampleGeneratorBase
         const size_t                generator_index,
         const size_t                generator_count);
 
+    // Restrict the sample generator to one of several disjoint partitions of the sample sequence.
+    virtual void set_sequence_partition(
+        const size_t                partition_index,
+        const size_t                partition_count);
+
     // Reset the sample generator to its initial state.
     virtual void reset();
 
+    // Skip the positions of the sample sequence before a given one.
+    virtual void skip_sequence(const size_t sequence_begin);
+
+    // Return a position of the sample sequence beyond all the positions used since the last reset.
+    virtual size_t get_sequence_end() const;
+
     // Generate a given number of samples and accumulate them into a buffer.
     virtual void generate_samples(
         const size_t                sample_count,
@@ -78,15 +90,29 @@ class SampleGeneratorBase
         const size_t                sequence_index,
         SampleVector&               samples) = 0;
 
+    // Store the samples generated by generate_samples() into the accumulation buffer.
+    virtual void store_samples(
+        const size_t                sample_count,
+        const Sample                samples[],
+        SampleAccumulationBuffer&   buffer,
+        foundation::IAbortSwitch&   abort_switch);
+
     void signal_invalid_sample();
 
   private:
     const size_t                    m_generator_index;
-    const size_t                    m_stride;
+    const size_t                    m_generator_count;
+    size_t                          m_partition_index;
+    size_t                          m_partition_count;
+    size_t                          m_stride;
     size_t                          m_sequence_index;
+    boost::atomic<size_t>           m_sequence_end;     // published copy of m_sequence_index
     size_t                          m_current_batch_size;
     SampleVector                    m_samples;
     foundation::uint64              m_invalid_sample_count;
+
+    // Return the index of the first batch of the sequence generated by this generator.
+    size_t get_first_batch_index() const;
 };
 
 }       // namespace renderer
@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/aov/objectidbuffer.h"
 #include "renderer/kernel/intersection/intersector.h"
 #include "renderer/kernel/intersection/tracecontext.h"
 #include "renderer/kernel/shading/shadingray.h"
@@ -46,15 +47,23 @@
 #include "renderer/modeling/material/material.h"
 #include "renderer/modeling/material/materialtraits.h"
 #include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/basegroup.h"
+#include "renderer/modeling/scene/containers.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/modeling/surfaceshader/surfaceshadertraits.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/image.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/uid.h"
 
 // Standard headers.
 #include <limits>
+#include <map>
+#include <memory>
 
 using namespace foundation;
 using namespace std;
@@ -64,22 +73,132 @@ namespace renderer
 
 struct ScenePicker::Impl
 {
-    const Project&      m_project;
-    const TraceContext& m_trace_context;
-    TextureStore        m_texture_store;
-    TextureCache        m_texture_cache;
-    Intersector         m_intersector;
+    typedef map<UniqueID, const AssemblyInstance*> AssemblyInstanceMap;
+
+    const Project&              m_project;
+    const TraceContext&         m_trace_context;
+
+    // Ray tracing resources, only created when a ray is traced.
+    auto_ptr<TextureStore>      m_texture_store;
+    auto_ptr<TextureCache>      m_texture_cache;
+    auto_ptr<Intersector>       m_intersector;
+
+    // Assembly instances by unique ID, only collected when the object ID buffer is used.
+    bool                        m_assembly_instances_collected;
+    AssemblyInstanceMap         m_assembly_instances;
 
     explicit Impl(const Project& project)
       : m_project(project)
       , m_trace_context(m_project.get_trace_context())
-      , m_texture_store(m_trace_context.get_scene())
-      , m_texture_cache(m_texture_store)
-      , m_intersector(m_trace_context, m_texture_cache)
+      , m_assembly_instances_collected(false)
+    {
+    }
+
+    const Intersector& get_intersector()
+    {
+        if (m_intersector.get() == 0)
+        {
+            m_texture_store.reset(new TextureStore(m_trace_context.get_scene()));
+            m_texture_cache.reset(new TextureCache(*m_texture_store));
+            m_intersector.reset(new Intersector(m_trace_context, *m_texture_cache));
+        }
+
+        return *m_intersector;
+    }
+
+    const AssemblyInstance* find_assembly_instance(const UniqueID uid)
+    {
+        if (!m_assembly_instances_collected)
+        {
+            collect_assembly_instances(*m_project.get_scene());
+            m_assembly_instances_collected = true;
+        }
+
+        const AssemblyInstanceMap::const_iterator i = m_assembly_instances.find(uid);
+        return i != m_assembly_instances.end() ? i->second : 0;
+    }
+
+    void collect_assembly_instances(const BaseGroup& group)
     {
+        for (const_each<AssemblyInstanceContainer> i = group.assembly_instances(); i; ++i)
+            m_assembly_instances[i->get_uid()] = &*i;
+
+        for (const_each<AssemblyContainer> i = group.assemblies(); i; ++i)
+            collect_assembly_instances(*i);
     }
 };
 
+namespace
+{
+    void init_result(const Project& project, ScenePicker::PickingResult& result)
+    {
+        result.m_hit = false;
+        result.m_primitive_type = ShadingPoint::PrimitiveNone;
+        result.m_distance = numeric_limits<double>::max();
+
+        result.m_bary = Vector2f(0.0);
+        result.m_uv = Vector2f(0.0);
+        result.m_duvdx = Vector2f(0.0);
+        result.m_duvdy = Vector2f(0.0);
+        result.m_point = Vector3d(0.0);
+        result.m_dpdu = Vector3d(0.0);
+        result.m_dpdv = Vector3d(0.0);
+        result.m_dndu = Vector3d(0.0);
+        result.m_dndv = Vector3d(0.0);
+        result.m_dpdx = Vector3d(0.0);
+        result.m_dpdy = Vector3d(0.0);
+        result.m_geometric_normal = Vector3d(0.0);
+        result.m_original_shading_normal = Vector3d(0.0);
+        result.m_side = ObjectInstance::FrontSide;
+
+        result.m_camera = project.get_uncached_active_camera();
+        result.m_assembly_instance = 0;
+        result.m_assembly = 0;
+        result.m_object_instance = 0;
+        result.m_object = 0;
+        result.m_material = 0;
+        result.m_surface_shader = 0;
+        result.m_bsdf = 0;
+        result.m_bssrdf = 0;
+        result.m_edf = 0;
+    }
+
+    // Find the material of the picked primitive, and the entities it references.
+    void find_material_entities(const size_t pa_index, ScenePicker::PickingResult& result)
+    {
+        if (pa_index != Triangle::None)
+        {
+            const char* material_name =
+                result.m_object_instance->get_material_name(pa_index, result.m_side);
+
+            if (material_name)
+            {
+                result.m_material =
+                    InputBinder::find_entity<Material>(
+                        material_name,
+                        result.m_object_instance->get_parent());
+            }
+        }
+
+        if (result.m_material)
+        {
+            const Entity* parent = result.m_material->get_parent();
+
+            const char* ss_name = result.m_material->get_surface_shader_name();
+            result.m_surface_shader = ss_name ? InputBinder::find_entity<SurfaceShader>(ss_name, parent) : 0;
+
+            const char* bsdf_name = result.m_material->get_bsdf_name();
+            result.m_bsdf = bsdf_name ? InputBinder::find_entity<BSDF>(bsdf_name, parent) : 0;
+
+            const char* bssrdf_name = result.m_material->get_bssrdf_name();
+            result.m_bssrdf = bssrdf_name ? InputBinder::find_entity<BSSRDF>(bssrdf_name, parent) : 0;
+
+            const char* edf = result.m_material->get_edf_name();
+            result.m_edf = edf ? InputBinder::find_entity<EDF>(edf, parent) : 0;
+        }
+    }
+}
+
 ScenePicker::ScenePicker(const Project& project)
   : impl(new Impl(project))
 {
@@ -93,36 +212,7 @@ ScenePicker::~ScenePicker()
 ScenePicker::PickingResult ScenePicker::pick(const Vector2d& ndc) const
 {
     PickingResult result;
-
-    result.m_hit = false;
-    result.m_primitive_type = ShadingPoint::PrimitiveNone;
-    result.m_distance = numeric_limits<double>::max();
-
-    result.m_bary = Vector2f(0.0);
-    result.m_uv = Vector2f(0.0);
-    result.m_duvdx = Vector2f(0.0);
-    result.m_duvdy = Vector2f(0.0);
-    result.m_point = Vector3d(0.0);
-    result.m_dpdu = Vector3d(0.0);
-    result.m_dpdv = Vector3d(0.0);
-    result.m_dndu = Vector3d(0.0);
-    result.m_dndv = Vector3d(0.0);
-    result.m_dpdx = Vector3d(0.0);
-    result.m_dpdy = Vector3d(0.0);
-    result.m_geometric_normal = Vector3d(0.0);
-    result.m_original_shading_normal = Vector3d(0.0);
-    result.m_side = ObjectInstance::FrontSide;
-
-    result.m_camera = impl->m_project.get_uncached_active_camera();
-    result.m_assembly_instance = 0;
-    result.m_assembly = 0;
-    result.m_object_instance = 0;
-    result.m_object = 0;
-    result.m_material = 0;
-    result.m_surface_shader = 0;
-    result.m_bsdf = 0;
-    result.m_bssrdf = 0;
-    result.m_edf = 0;
+    init_result(impl->m_project, result);
 
     if (result.m_camera == 0)
         return result;
@@ -141,7 +231,7 @@ ScenePicker::PickingResult ScenePicker::pick(const Vector2d& ndc) const
         ray);
 
     ShadingPoint shading_point;
-    impl->m_intersector.trace(ray, shading_point);
+    impl->get_intersector().trace(ray, shading_point);
 
     result.m_hit = shading_point.hit();
 
@@ -172,40 +262,54 @@ ScenePicker::PickingResult ScenePicker::pick(const Vector2d& ndc) const
     result.m_object_instance = &shading_point.get_object_instance();
     result.m_object = &shading_point.get_object();
 
-    const size_t pa_index = shading_point.get_primitive_attribute_index();
+    find_material_entities(shading_point.get_primitive_attribute_index(), result);
 
-    if (pa_index != Triangle::None)
-    {
-        const char* material_name =
-            result.m_object_instance->get_material_name(pa_index, shading_point.get_side());
+    return result;
+}
 
-        if (material_name)
-        {
-            result.m_material =
-                InputBinder::find_entity<Material>(
-                    material_name,
-                    result.m_object_instance->get_parent());
-        }
-    }
+bool ScenePicker::pick_entities(
+    const Vector2i&     pi,
+    PickingResult&      result) const
+{
+    init_result(impl->m_project, result);
 
-    if (result.m_material)
-    {
-        const Entity* parent = result.m_material->get_parent();
+    const ObjectIDBuffer* object_ids = impl->m_project.get_frame()->get_object_id_buffer();
 
-        const char* ss_name = result.m_material->get_surface_shader_name();
-        result.m_surface_shader = ss_name ? InputBinder::find_entity<SurfaceShader>(ss_name, parent) : 0;
+    if (object_ids == 0 ||
+        pi.x < 0 || pi.y < 0 ||
+        static_cast<size_t>(pi.x) >= object_ids->get_width() ||
+        static_cast<size_t>(pi.y) >= object_ids->get_height())
+        return false;
 
-        const char* bsdf_name = result.m_material->get_bsdf_name();
-        result.m_bsdf = bsdf_name ? InputBinder::find_entity<BSDF>(bsdf_name, parent) : 0;
+    const ObjectIDBuffer::Entry& entry = object_ids->get(pi.x, pi.y);
 
-        const char* bssrdf_name = result.m_material->get_bssrdf_name();
-        result.m_bssrdf = bssrdf_name ? InputBinder::find_entity<BSSRDF>(bssrdf_name, parent) : 0;
+    if (!entry.is_valid())
+        return false;
 
-        const char* edf = result.m_material->get_edf_name();
-        result.m_edf = edf ? InputBinder::find_entity<EDF>(edf, parent) : 0;
-    }
+    // Entities that no longer exist invalidate the record.
+    const AssemblyInstance* assembly_instance =
+        impl->find_assembly_instance(entry.m_assembly_instance_uid);
+    if (assembly_instance == 0)
+        return false;
 
-    return result;
+    const Assembly* assembly = assembly_instance->find_assembly();
+    if (assembly == 0 || entry.m_object_instance_index >= assembly->object_instances().size())
+        return false;
+
+    const ObjectInstance* object_instance =
+        assembly->object_instances().get_by_index(entry.m_object_instance_index);
+
+    result.m_hit = true;
+    result.m_side = static_cast<ObjectInstance::Side>(entry.m_side);
+    result.m_assembly_instance = assembly_instance;
+    result.m_assembly_instance_transform = assembly_instance->transform_sequence().get_earliest_transform();
+    result.m_assembly = assembly;
+    result.m_object_instance = object_instance;
+    result.m_object = object_instance->find_object();
+
+    find_material_entities(entry.m_primitive_attribute_index, result);
+
+    return true;
 }
 
 }   // namespace renderer
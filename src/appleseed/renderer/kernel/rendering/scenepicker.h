@@ -101,8 +101,18 @@ class APPLESEED_DLLSYMBOL ScenePicker
 
     ~ScenePicker();
 
+    // Trace a ray through a given point of the image.
     PickingResult pick(const foundation::Vector2d& ndc) const;
 
+    // Retrieve the entities recorded at a given pixel by the frame's object ID buffer,
+    // without tracing a ray. Only entities are returned: geometric fields are left
+    // empty and the assembly instance transform ignores parent assembly instances.
+    // Return false if there is no valid record for this pixel, for instance because
+    // the buffer is disabled, the pixel was not rendered yet or the scene changed.
+    bool pick_entities(
+        const foundation::Vector2i& pi,
+        PickingResult&              result) const;
+
   private:
     struct Impl;
     Impl* impl;
@@ -93,6 +93,11 @@ IRendererController::Status SerialRendererController::get_status() const
     return m_controller->get_status();
 }
 
+size_t SerialRendererController::get_active_thread_count() const
+{
+    return m_controller->get_active_thread_count();
+}
+
 void SerialRendererController::add_pre_render_tile_callback(
     const size_t            x,
     const size_t            y,
@@ -68,6 +68,7 @@ class SerialRendererController
     virtual void on_frame_end() APPLESEED_OVERRIDE;
     virtual void on_progress() APPLESEED_OVERRIDE;
     virtual Status get_status() const APPLESEED_OVERRIDE;
+    virtual size_t get_active_thread_count() const APPLESEED_OVERRIDE;
 
     void add_pre_render_tile_callback(
         const size_t            x,
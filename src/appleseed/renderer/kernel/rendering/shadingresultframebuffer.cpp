@@ -42,6 +42,7 @@
 #include "foundation/platform/compiler.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 
 using namespace foundation;
@@ -105,7 +106,10 @@ void ShadingResultFrameBuffer::add(
     *ptr++ = sample.m_main.m_color[2];
     *ptr++ = sample.m_main.m_alpha[0];
 
-    for (size_t i = 0; i < m_aov_count; ++i)
+    // Samples outside the AOV window carry no AOVs.
+    const size_t sample_aov_count = min(sample.m_aovs.size(), m_aov_count);
+
+    for (size_t i = 0; i < sample_aov_count; ++i)
     {
         const ShadingFragment& aov = sample.m_aovs[i];
 
@@ -115,6 +119,14 @@ void ShadingResultFrameBuffer::add(
         *ptr++ = aov.m_alpha[0];
     }
 
+    for (size_t i = sample_aov_count; i < m_aov_count; ++i)
+    {
+        *ptr++ = 0.0f;
+        *ptr++ = 0.0f;
+        *ptr++ = 0.0f;
+        *ptr++ = 0.0f;
+    }
+
     FilteredTile::add(x, y, &m_scratch[0]);
 }
 
@@ -64,6 +64,9 @@ class ShadingResultFrameBuffer
         const foundation::AABB2u&       crop_window,
         const foundation::Filter2f&     filter);
 
+    // Return the number of AOVs stored in this framebuffer.
+    size_t get_aov_count() const;
+
     // The sample must be in the linear RGB color space.
     void add(
         const float                     x,
@@ -91,6 +94,16 @@ class ShadingResultFrameBuffer
     std::vector<float>                  m_scratch;
 };
 
+
+//
+// ShadingResultFrameBuffer class implementation.
+//
+
+inline size_t ShadingResultFrameBuffer::get_aov_count() const
+{
+    return m_aov_count;
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_SHADINGRESULTFRAMEBUFFER_H
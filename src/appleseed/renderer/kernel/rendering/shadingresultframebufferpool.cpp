@@ -0,0 +1,128 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "shadingresultframebufferpool.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/shadingresultframebuffer.h"
+
+// Standard headers.
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// ShadingResultFrameBufferPool class implementation.
+//
+
+ShadingResultFrameBufferPool::ShadingResultFrameBufferPool(const size_t max_pooled_count)
+  : m_max_pooled_count(max_pooled_count)
+{
+}
+
+ShadingResultFrameBufferPool::~ShadingResultFrameBufferPool()
+{
+    clear();
+}
+
+ShadingResultFrameBuffer* ShadingResultFrameBufferPool::acquire(
+    const size_t                    width,
+    const size_t                    height,
+    const size_t                    aov_count,
+    const AABB2u&                   crop_window,
+    const Filter2f&                 filter)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        // Most recently released framebuffers are at the end and are most likely still in cache.
+        for (size_t i = m_framebuffers.size(); i > 0; --i)
+        {
+            ShadingResultFrameBuffer* framebuffer = m_framebuffers[i - 1];
+
+            if (framebuffer->get_width() == width &&
+                framebuffer->get_height() == height &&
+                framebuffer->get_aov_count() == aov_count &&
+                framebuffer->get_crop_window() == crop_window &&
+                &framebuffer->get_filter() == &filter)
+            {
+                m_framebuffers.erase(m_framebuffers.begin() + (i - 1));
+                return framebuffer;
+            }
+        }
+    }
+
+    return
+        new ShadingResultFrameBuffer(
+            width,
+            height,
+            aov_count,
+            crop_window,
+            filter);
+}
+
+void ShadingResultFrameBufferPool::release(ShadingResultFrameBuffer* framebuffer)
+{
+    assert(framebuffer);
+
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        if (m_framebuffers.size() < m_max_pooled_count)
+        {
+            m_framebuffers.push_back(framebuffer);
+            return;
+        }
+    }
+
+    delete framebuffer;
+}
+
+void ShadingResultFrameBufferPool::clear()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    for (size_t i = 0; i < m_framebuffers.size(); ++i)
+        delete m_framebuffers[i];
+
+    m_framebuffers.clear();
+}
+
+size_t ShadingResultFrameBufferPool::size() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_framebuffers.size();
+}
+
+}   // namespace renderer
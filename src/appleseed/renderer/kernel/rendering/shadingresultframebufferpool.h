@@ -0,0 +1,95 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_SHADINGRESULTFRAMEBUFFERPOOL_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_SHADINGRESULTFRAMEBUFFERPOOL_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/filter.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class ShadingResultFrameBuffer; }
+
+namespace renderer
+{
+
+//
+// A thread-safe pool of shading result framebuffers.
+//
+// Framebuffers released to the pool are handed out again to later requests for
+// framebuffers with the same dimensions, number of AOVs, crop window and filter,
+// so that rendering tiles pass after pass does not allocate and page in fresh
+// framebuffers every time.
+//
+
+class ShadingResultFrameBufferPool
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. At most max_pooled_count framebuffers are kept in the pool.
+    explicit ShadingResultFrameBufferPool(const size_t max_pooled_count = 64);
+
+    // Destructor, deletes all pooled framebuffers.
+    ~ShadingResultFrameBufferPool();
+
+    // Return a framebuffer with given properties. Its content is undefined.
+    ShadingResultFrameBuffer* acquire(
+        const size_t                    width,
+        const size_t                    height,
+        const size_t                    aov_count,
+        const foundation::AABB2u&       crop_window,
+        const foundation::Filter2f&     filter);
+
+    // Return a framebuffer to the pool, or delete it if the pool is full.
+    void release(ShadingResultFrameBuffer* framebuffer);
+
+    // Delete all pooled framebuffers.
+    void clear();
+
+    // Return the number of pooled framebuffers.
+    size_t size() const;
+
+  private:
+    const size_t                            m_max_pooled_count;
+    mutable boost::mutex                    m_mutex;
+    std::vector<ShadingResultFrameBuffer*>  m_framebuffers;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_SHADINGRESULTFRAMEBUFFERPOOL_H
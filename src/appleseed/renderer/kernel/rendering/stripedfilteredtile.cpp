@@ -0,0 +1,234 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "stripedfilteredtile.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/filteredtile.h"
+#include "foundation/math/filter.h"
+#include "foundation/math/scalar.h"
+#include "foundation/utility/job/iabortswitch.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// StripedFilteredTile class implementation.
+//
+
+namespace
+{
+    // Minimum height of a stripe, in pixels.
+    const size_t MinStripeHeight = 16;
+
+    // Size of a cache line, in bytes.
+    const size_t CacheLineSize = 64;
+}
+
+// Keep every lock on its own cache line to avoid false sharing between stripes.
+struct StripedFilteredTile::StripeLock
+{
+    Spinlock    m_lock;
+    uint8       m_padding[CacheLineSize - sizeof(Spinlock)];
+};
+
+StripedFilteredTile::StripedFilteredTile(FilteredTile& tile)
+  : m_tile(tile)
+  , m_scale_x(static_cast<float>(tile.get_width()))
+  , m_scale_y(static_cast<float>(tile.get_height()))
+  , m_offset_x(0.0f)
+  , m_offset_y(0.0f)
+{
+    init_stripes();
+}
+
+StripedFilteredTile::StripedFilteredTile(
+    FilteredTile&       tile,
+    const size_t        image_width,
+    const size_t        image_height,
+    const AABB2u&       window)
+  : m_tile(tile)
+{
+    assert(window.is_valid());
+    assert(window.max.x < image_width);
+    assert(window.max.y < image_height);
+
+    // Map sample positions from NDC to the continuous image space of the tile.
+    const float sx = static_cast<float>(tile.get_width()) / (window.extent()[0] + 1);
+    const float sy = static_cast<float>(tile.get_height()) / (window.extent()[1] + 1);
+    m_scale_x = image_width * sx;
+    m_scale_y = image_height * sy;
+    m_offset_x = window.min.x * sx;
+    m_offset_y = window.min.y * sy;
+
+    init_stripes();
+}
+
+StripedFilteredTile::~StripedFilteredTile()
+{
+    delete[] m_locks;
+}
+
+void StripedFilteredTile::init_stripes()
+{
+    // The footprint of a sample spans at most floor(2 * radius) + 1 rows.
+    const float yradius = m_tile.get_filter().get_yradius();
+    const size_t footprint_height = truncate<size_t>(fast_floor(2.0f * yradius)) + 1;
+
+    m_stripe_height = max(MinStripeHeight, footprint_height);
+    m_stripe_count = (m_tile.get_height() + m_stripe_height - 1) / m_stripe_height;
+    m_locks = new StripeLock[m_stripe_count];
+}
+
+bool StripedFilteredTile::store_samples(
+    const size_t        sample_count,
+    const Sample        samples[],
+    IAbortSwitch&       abort_switch)
+{
+    // Bucket samples per stripe (counting sort).
+    vector<size_t> offsets(m_stripe_count + 1, 0);
+    vector<uint32> stripes(sample_count);
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        const size_t stripe = get_stripe(samples[i].m_position.y * m_scale_y - m_offset_y);
+        stripes[i] = static_cast<uint32>(stripe);
+        ++offsets[stripe + 1];
+    }
+    for (size_t i = 0; i < m_stripe_count; ++i)
+        offsets[i + 1] += offsets[i];
+    vector<uint32> indices(sample_count);
+    {
+        vector<size_t> cursors(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < sample_count; ++i)
+            indices[cursors[stripes[i]]++] = static_cast<uint32>(i);
+    }
+
+    // First, store samples into the stripes that are immediately available,
+    // deferring the others. Then wait for the deferred stripes one at a time.
+    vector<uint32> deferred;
+    for (size_t stripe = 0; stripe < m_stripe_count; ++stripe)
+    {
+        const size_t count = offsets[stripe + 1] - offsets[stripe];
+        if (count == 0)
+            continue;
+
+        if (abort_switch.is_aborted())
+            return false;
+
+        if (try_lock_stripe(stripe))
+        {
+            store_stripe_samples(samples, &indices[offsets[stripe]], count);
+            unlock_stripe(stripe);
+        }
+        else deferred.push_back(static_cast<uint32>(stripe));
+    }
+
+    for (size_t i = 0, e = deferred.size(); i < e; ++i)
+    {
+        if (abort_switch.is_aborted())
+            return false;
+
+        const size_t stripe = deferred[i];
+        lock_stripe(stripe);
+        store_stripe_samples(samples, &indices[offsets[stripe]], offsets[stripe + 1] - offsets[stripe]);
+        unlock_stripe(stripe);
+    }
+
+    return true;
+}
+
+size_t StripedFilteredTile::get_stripe(const float y) const
+{
+    // First row of the footprint of a sample at vertical position y (continuous image space).
+    const float first_row = fast_ceil(y - 0.5f - m_tile.get_filter().get_yradius());
+
+    if (first_row <= 0.0f)
+        return 0;
+
+    const size_t stripe = truncate<size_t>(first_row) / m_stripe_height;
+
+    return min(stripe, m_stripe_count - 1);
+}
+
+bool StripedFilteredTile::try_lock_stripe(const size_t stripe)
+{
+    // Locks are always acquired in increasing stripe order.
+    if (!m_locks[stripe].m_lock.try_lock())
+        return false;
+
+    if (stripe + 1 < m_stripe_count && !m_locks[stripe + 1].m_lock.try_lock())
+    {
+        m_locks[stripe].m_lock.unlock();
+        return false;
+    }
+
+    return true;
+}
+
+void StripedFilteredTile::lock_stripe(const size_t stripe)
+{
+    // Locks are always acquired in increasing stripe order.
+    m_locks[stripe].m_lock.lock();
+
+    if (stripe + 1 < m_stripe_count)
+        m_locks[stripe + 1].m_lock.lock();
+}
+
+void StripedFilteredTile::unlock_stripe(const size_t stripe)
+{
+    if (stripe + 1 < m_stripe_count)
+        m_locks[stripe + 1].m_lock.unlock();
+
+    m_locks[stripe].m_lock.unlock();
+}
+
+void StripedFilteredTile::store_stripe_samples(
+    const Sample        samples[],
+    const uint32*       indices,
+    const size_t        index_count)
+{
+    for (size_t i = 0; i < index_count; ++i)
+    {
+        const Sample& s = samples[indices[i]];
+        const Vector2f p = get_tile_position(s.m_position);
+        m_tile.add_exclusive(p.x, p.y, s.m_values);
+    }
+}
+
+}   // namespace renderer
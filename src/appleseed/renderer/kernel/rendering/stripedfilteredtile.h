@@ -0,0 +1,138 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_STRIPEDFILTEREDTILE_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_STRIPEDFILTEREDTILE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class FilteredTile; }
+namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class Sample; }
+
+namespace renderer
+{
+
+//
+// A filtered tile partitioned into horizontal stripes, each protected by its own lock.
+//
+// Samples are dispatched to the stripe that contains the first row of their filter
+// footprint. Stripes are at least as tall as the filter footprint, so a sample only
+// ever touches its own stripe and the one below it; holding both locks gives a thread
+// exclusive ownership of these rows and allows it to accumulate samples without atomic
+// operations. Threads storing samples in different regions of the image don't contend.
+//
+
+class StripedFilteredTile
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. The tile is not owned by this object and covers the entire image.
+    explicit StripedFilteredTile(foundation::FilteredTile& tile);
+
+    // Constructor. The tile is not owned by this object and covers the region
+    // `window` of an image of `image_width` x `image_height` pixels.
+    StripedFilteredTile(
+        foundation::FilteredTile&   tile,
+        const size_t                image_width,
+        const size_t                image_height,
+        const foundation::AABB2u&   window);
+
+    // Destructor.
+    ~StripedFilteredTile();
+
+    // Return the number of stripes.
+    size_t get_stripe_count() const;
+
+    // Map a sample position from NDC to the continuous image space of the tile.
+    foundation::Vector2f get_tile_position(const foundation::Vector2f& position) const;
+
+    // Store a set of samples into the tile. Thread-safe.
+    // Return false if the operation was aborted, in which case only some samples were stored.
+    bool store_samples(
+        const size_t                sample_count,
+        const Sample                samples[],
+        foundation::IAbortSwitch&   abort_switch);
+
+  private:
+    struct StripeLock;
+
+    foundation::FilteredTile&       m_tile;
+    float                           m_scale_x;
+    float                           m_scale_y;
+    float                           m_offset_x;
+    float                           m_offset_y;
+    size_t                          m_stripe_height;
+    size_t                          m_stripe_count;
+    StripeLock*                     m_locks;
+
+    void init_stripes();
+
+    size_t get_stripe(const float y) const;
+
+    bool try_lock_stripe(const size_t stripe);
+    void lock_stripe(const size_t stripe);
+    void unlock_stripe(const size_t stripe);
+
+    void store_stripe_samples(
+        const Sample                samples[],
+        const foundation::uint32*   indices,
+        const size_t                index_count);
+};
+
+
+//
+// StripedFilteredTile class implementation.
+//
+
+inline size_t StripedFilteredTile::get_stripe_count() const
+{
+    return m_stripe_count;
+}
+
+inline foundation::Vector2f StripedFilteredTile::get_tile_position(const foundation::Vector2f& position) const
+{
+    return
+        foundation::Vector2f(
+            position.x * m_scale_x - m_offset_x,
+            position.y * m_scale_y - m_offset_y);
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_STRIPEDFILTEREDTILE_H
@@ -0,0 +1,190 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "telemetrymonitor.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/iframerenderer.h"
+#include "renderer/kernel/rendering/itelemetrycallback.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/hotpathcounters.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/memoryaccounting.h"
+
+// Standard headers.
+#include <cassert>
+
+using namespace foundation;
+
+namespace renderer
+{
+
+//
+// RenderTelemetry class implementation.
+//
+
+RenderTelemetry::RenderTelemetry()
+  : m_elapsed_time(0.0)
+  , m_progress(-1.0)
+  , m_remaining_time(-1.0)
+  , m_sample_count(0)
+  , m_samples_per_second(0.0)
+  , m_ray_count(0)
+  , m_rays_per_second(0.0)
+  , m_memory_size(0)
+  , m_texture_cache_hit_count(0)
+  , m_texture_cache_miss_count(0)
+{
+}
+
+StatisticsVector RenderTelemetry::get_statistics() const
+{
+    Statistics stats;
+    stats.insert_time("elapsed time", m_elapsed_time);
+    if (m_progress >= 0.0)
+        stats.insert_percent("progress", m_progress, 1.0);
+    if (m_remaining_time >= 0.0)
+        stats.insert_time("remaining time", m_remaining_time);
+    stats.insert("samples", m_sample_count);
+    stats.insert("samples per second", m_samples_per_second);
+    stats.insert("rays", m_ray_count);
+    stats.insert("rays per second", m_rays_per_second);
+    stats.insert_size("memory", m_memory_size);
+    stats.insert_percent(
+        "texture cache hit rate",
+        m_texture_cache_hit_count,
+        m_texture_cache_hit_count + m_texture_cache_miss_count);
+
+    StatisticsVector vec = StatisticsVector::make("render telemetry", stats);
+    vec.update(m_memory_statistics);
+
+    return vec;
+}
+
+
+//
+// TelemetryMonitor class implementation.
+//
+
+namespace
+{
+    void get_sample_and_ray_counts(uint64& sample_count, uint64& ray_count)
+    {
+        HotPathCounters counters;
+        get_hot_path_counters(counters);
+
+        sample_count = counters.m_rays[HotPathCounters::ray_type_index(VisibilityFlags::CameraRay)];
+
+        ray_count = 0;
+        for (size_t i = 0; i < HotPathCounters::RayTypeCount; ++i)
+            ray_count += counters.m_rays[i];
+    }
+}
+
+TelemetryMonitor::TelemetryMonitor(
+    ITelemetryCallback&     callback,
+    const double            interval,
+    const TextureStore*     texture_store)
+  : m_callback(callback)
+  , m_interval(interval)
+  , m_texture_store(texture_store)
+  , m_stopwatch(0)
+{
+    on_frame_begin();
+}
+
+void TelemetryMonitor::on_frame_begin()
+{
+    m_last_time = 0.0;
+
+    get_sample_and_ray_counts(m_initial_sample_count, m_initial_ray_count);
+    m_last_sample_count = m_initial_sample_count;
+    m_last_ray_count = m_initial_ray_count;
+
+    m_initial_hit_count = 0;
+    m_initial_miss_count = 0;
+    if (m_texture_store)
+        m_texture_store->get_lookup_counts(m_initial_hit_count, m_initial_miss_count);
+
+    m_stopwatch.start();
+}
+
+void TelemetryMonitor::update(
+    const IFrameRenderer&   frame_renderer,
+    const bool              force)
+{
+    const double time = m_stopwatch.measure().get_seconds();
+
+    if (!force && time - m_last_time < m_interval)
+        return;
+
+    RenderTelemetry telemetry;
+    telemetry.m_elapsed_time = time;
+
+    // Estimate the remaining time assuming that the rest of the frame renders at the same pace.
+    telemetry.m_progress = frame_renderer.get_progress();
+    if (telemetry.m_progress >= 1.0)
+        telemetry.m_remaining_time = 0.0;
+    else if (telemetry.m_progress > 0.0)
+        telemetry.m_remaining_time = time * (1.0 - telemetry.m_progress) / telemetry.m_progress;
+
+    uint64 sample_count, ray_count;
+    get_sample_and_ray_counts(sample_count, ray_count);
+    const double interval = time - m_last_time;
+    telemetry.m_sample_count = sample_count - m_initial_sample_count;
+    telemetry.m_ray_count = ray_count - m_initial_ray_count;
+    if (interval > 0.0)
+    {
+        telemetry.m_samples_per_second = (sample_count - m_last_sample_count) / interval;
+        telemetry.m_rays_per_second = (ray_count - m_last_ray_count) / interval;
+    }
+
+    telemetry.m_memory_size = get_total_accounted_memory_size();
+    telemetry.m_memory_statistics = get_memory_accounting_statistics();
+
+    if (m_texture_store)
+    {
+        uint64 hit_count, miss_count;
+        m_texture_store->get_lookup_counts(hit_count, miss_count);
+        telemetry.m_texture_cache_hit_count = hit_count - m_initial_hit_count;
+        telemetry.m_texture_cache_miss_count = miss_count - m_initial_miss_count;
+    }
+
+    m_last_time = time;
+    m_last_sample_count = sample_count;
+    m_last_ray_count = ray_count;
+
+    m_callback.on_telemetry(telemetry);
+}
+
+}   // namespace renderer
@@ -0,0 +1,125 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_TELEMETRYMONITOR_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_TELEMETRYMONITOR_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace renderer  { class IFrameRenderer; }
+namespace renderer  { class ITelemetryCallback; }
+namespace renderer  { class TextureStore; }
+
+namespace renderer
+{
+
+//
+// A snapshot of the progress, throughput and memory usage of the frame being rendered.
+//
+// Samples are counted as camera rays. Rates are measured over the last reporting
+// interval rather than since the beginning of the frame, so that they reflect the
+// current speed of the renderer.
+//
+
+class APPLESEED_DLLSYMBOL RenderTelemetry
+{
+  public:
+    double                          m_elapsed_time;             // seconds since the frame started
+    double                          m_progress;                 // fraction of the frame rendered, negative if unknown
+    double                          m_remaining_time;           // estimated seconds until completion, negative if unknown
+    foundation::uint64              m_sample_count;             // samples rendered since the frame started
+    double                          m_samples_per_second;
+    foundation::uint64              m_ray_count;                // rays traced since the frame started
+    double                          m_rays_per_second;
+    foundation::uint64              m_memory_size;              // total accounted memory in bytes
+    foundation::uint64              m_texture_cache_hit_count;  // texture store lookups since the frame started
+    foundation::uint64              m_texture_cache_miss_count;
+    foundation::StatisticsVector    m_memory_statistics;        // memory usage of each subsystem
+
+    // Constructor.
+    RenderTelemetry();
+
+    // Return the telemetry as statistics.
+    foundation::StatisticsVector get_statistics() const;
+};
+
+
+//
+// Collects render telemetry at regular intervals and hands it to a telemetry callback.
+//
+
+class TelemetryMonitor
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. The texture store is optional.
+    TelemetryMonitor(
+        ITelemetryCallback&         callback,
+        const double                interval,           // in seconds
+        const TextureStore*         texture_store);
+
+    // Call this method when a frame starts rendering.
+    void on_frame_begin();
+
+    // Call this method often while a frame is rendering. Telemetry is only collected
+    // and sent when the reporting interval has elapsed, or if force is true.
+    void update(
+        const IFrameRenderer&       frame_renderer,
+        const bool                  force = false);
+
+  private:
+    ITelemetryCallback&                                         m_callback;
+    const double                                                m_interval;
+    const TextureStore*                                         m_texture_store;
+    foundation::Stopwatch<foundation::DefaultWallclockTimer>    m_stopwatch;
+    double                                                      m_last_time;
+    foundation::uint64                                          m_initial_sample_count;
+    foundation::uint64                                          m_initial_ray_count;
+    foundation::uint64                                          m_last_sample_count;
+    foundation::uint64                                          m_last_ray_count;
+    foundation::uint64                                          m_initial_hit_count;
+    foundation::uint64                                          m_initial_miss_count;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_TELEMETRYMONITOR_H
@@ -0,0 +1,155 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "tilebatchscheduler.h"
+
+// appleseed.renderer headers.
+#include "renderer/modeling/frame/frame.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+
+// Boost headers.
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <deque>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    AABB2u get_tile_bbox(const CanvasProperties& props, const size_t tile_x, const size_t tile_y)
+    {
+        AABB2u bbox;
+        bbox.min.x = tile_x * props.m_tile_width;
+        bbox.min.y = tile_y * props.m_tile_height;
+        bbox.max.x = min((tile_x + 1) * props.m_tile_width, props.m_canvas_width) - 1;
+        bbox.max.y = min((tile_y + 1) * props.m_tile_height, props.m_canvas_height) - 1;
+        return bbox;
+    }
+}
+
+struct TileBatchScheduler::Impl
+{
+    boost::mutex                m_mutex;
+    boost::condition_variable   m_condition;
+    deque<AABB2u>               m_pending;
+    size_t                      m_batch_count;
+    size_t                      m_remaining;
+};
+
+TileBatchScheduler::TileBatchScheduler(
+    const Frame&                frame,
+    const size_t                tiles_per_batch)
+  : impl(new Impl())
+{
+    assert(tiles_per_batch > 0);
+
+    const CanvasProperties& props = frame.image().properties();
+    const AABB2u& crop_window = frame.get_crop_window();
+
+    for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+    {
+        for (size_t tx = 0; tx < props.m_tile_count_x; tx += tiles_per_batch)
+        {
+            const size_t last_tx = min(tx + tiles_per_batch, props.m_tile_count_x) - 1;
+
+            AABB2u batch = get_tile_bbox(props, tx, ty);
+            batch.max.x = get_tile_bbox(props, last_tx, ty).max.x;
+
+            if (AABB2u::overlap(batch, crop_window))
+                impl->m_pending.push_back(AABB2u::intersect(batch, crop_window));
+        }
+    }
+
+    impl->m_batch_count = impl->m_remaining = impl->m_pending.size();
+}
+
+TileBatchScheduler::~TileBatchScheduler()
+{
+    delete impl;
+}
+
+size_t TileBatchScheduler::get_batch_count() const
+{
+    return impl->m_batch_count;
+}
+
+bool TileBatchScheduler::acquire(AABB2u& batch)
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    while (impl->m_pending.empty())
+    {
+        if (impl->m_remaining == 0)
+            return false;
+
+        impl->m_condition.wait(lock);
+    }
+
+    batch = impl->m_pending.front();
+    impl->m_pending.pop_front();
+
+    return true;
+}
+
+void TileBatchScheduler::complete()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    assert(impl->m_remaining > 0);
+    --impl->m_remaining;
+    impl->m_condition.notify_all();
+}
+
+void TileBatchScheduler::abandon(const AABB2u& batch)
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->m_pending.push_front(batch);
+    impl->m_condition.notify_all();
+}
+
+void TileBatchScheduler::wait()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    while (impl->m_remaining > 0)
+        impl->m_condition.wait(lock);
+}
+
+}   // namespace renderer
@@ -0,0 +1,92 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_TILEBATCHSCHEDULER_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_TILEBATCHSCHEDULER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace renderer  { class Frame; }
+
+namespace renderer
+{
+
+//
+// Splits the crop window of a frame into batches of tiles and hands them out to
+// concurrent consumers, such as the workers of a distributed render. A batch is a
+// run of consecutive tiles of a tile row, clipped to the crop window. Batches
+// given back by a consumer (e.g. a worker that disconnected) are handed out again.
+//
+
+class APPLESEED_DLLSYMBOL TileBatchScheduler
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    TileBatchScheduler(
+        const Frame&            frame,
+        const size_t            tiles_per_batch);
+
+    // Destructor.
+    ~TileBatchScheduler();
+
+    // Return the total number of batches.
+    size_t get_batch_count() const;
+
+    // Retrieve a batch to render. Block while all remaining batches are held
+    // by other consumers since they may still be given back. Return false
+    // once all batches are complete.
+    bool acquire(foundation::AABB2u& batch);
+
+    // Mark an acquired batch as complete.
+    void complete();
+
+    // Give back an acquired batch so that another consumer renders it.
+    void abandon(const foundation::AABB2u& batch);
+
+    // Wait until all batches are complete.
+    void wait();
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_TILEBATCHSCHEDULER_H
@@ -77,6 +77,12 @@ double compute_ambient_occlusion(
     ray.m_flags = VisibilityFlags::ProbeRay;
     ray.m_depth = shading_point.get_ray().m_depth + 1;
 
+    // Ambient occlusion rays share their origin and are traced in batches.
+    const size_t BatchSize = 64;
+    ShadingRay batch_rays[BatchSize];
+    bool batch_hits[BatchSize];
+    size_t batch_size = 0;
+
     size_t computed_samples = 0;
     size_t occluded_samples = 0;
 
@@ -98,11 +104,22 @@ double compute_ambient_occlusion(
         // Count the number of computed samples.
         ++computed_samples;
 
-        // Trace the ambient occlusion ray and count the number of occluded samples.
-        if (intersector.trace_probe(ray, &shading_point))
-            ++occluded_samples;
+        // Queue the ambient occlusion ray.
+        batch_rays[batch_size++] = ray;
+
+        // Trace the queued rays and count the number of occluded samples.
+        if (batch_size == BatchSize)
+        {
+            occluded_samples +=
+                intersector.trace_probe_batch(batch_size, batch_rays, batch_hits, &shading_point);
+            batch_size = 0;
+        }
     }
 
+    // Trace the remaining rays.
+    if (batch_size > 0)
+        occluded_samples += intersector.trace_probe_batch(batch_size, batch_rays, batch_hits, &shading_point);
+
     // Compute occlusion as a scalar between 0.0 and 1.0.
     double occlusion = static_cast<double>(occluded_samples);
     if (computed_samples > 1)
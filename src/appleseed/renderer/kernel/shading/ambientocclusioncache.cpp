@@ -0,0 +1,483 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "ambientocclusioncache.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/tessellation/statictessellation.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/object/iregion.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/regionkit.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/basis.h"
+#include "foundation/math/hash.h"
+#include "foundation/math/qmc.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/system.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/lazy.h"
+#include "foundation/utility/siphash.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    //
+    // The vertices of a region of a mesh instance, in world space.
+    //
+
+    struct VertexSet
+    {
+        size_t              m_region_index;
+        vector<Vector3d>    m_positions;
+        vector<Vector3d>    m_normals;
+        vector<uint32>      m_corners;          // vertex indices of the corners of each triangle
+        vector<float>       m_occlusion;
+    };
+
+    //
+    // A job computing the occlusion at a range of vertices of a vertex set.
+    //
+
+    class ComputeOcclusionJob
+      : public IJob
+    {
+      public:
+        ComputeOcclusionJob(
+            const TraceContext&         trace_context,
+            TextureStore&               texture_store,
+            VertexSet&                  vertex_set,
+            const size_t                vertex_begin,
+            const size_t                vertex_end,
+            const double                max_distance,
+            const size_t                sample_count,
+            const bool                  cosine_weighted,
+            const double                ray_offset,
+            const ShadingRay::Time&     ray_time,
+            IAbortSwitch*               abort_switch)
+          : m_trace_context(trace_context)
+          , m_texture_store(texture_store)
+          , m_vertex_set(vertex_set)
+          , m_vertex_begin(vertex_begin)
+          , m_vertex_end(vertex_end)
+          , m_max_distance(max_distance)
+          , m_sample_count(sample_count)
+          , m_cosine_weighted(cosine_weighted)
+          , m_ray_offset(ray_offset)
+          , m_ray_time(ray_time)
+          , m_abort_switch(abort_switch)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+        {
+            if (is_aborted(m_abort_switch))
+                return;
+
+            TextureCache texture_cache(m_texture_store);
+            const Intersector intersector(m_trace_context, texture_cache);
+
+            for (size_t i = m_vertex_begin; i < m_vertex_end; ++i)
+            {
+                m_vertex_set.m_occlusion[i] =
+                    compute_occlusion(
+                        intersector,
+                        m_vertex_set.m_positions[i],
+                        m_vertex_set.m_normals[i],
+                        static_cast<uint32>(i));
+            }
+        }
+
+      private:
+        const TraceContext&             m_trace_context;
+        TextureStore&                   m_texture_store;
+        VertexSet&                      m_vertex_set;
+        const size_t                    m_vertex_begin;
+        const size_t                    m_vertex_end;
+        const double                    m_max_distance;
+        const size_t                    m_sample_count;
+        const bool                      m_cosine_weighted;
+        const double                    m_ray_offset;
+        const ShadingRay::Time          m_ray_time;
+        IAbortSwitch*                   m_abort_switch;
+
+        float compute_occlusion(
+            const Intersector&          intersector,
+            const Vector3d&             position,
+            const Vector3d&             normal,
+            const uint32                vertex_index) const
+        {
+            // Degenerate vertices (e.g. only shared by degenerate triangles) are left unoccluded.
+            if (normal == Vector3d(0.0))
+                return 0.0f;
+
+            const Basis3d basis(normal);
+
+            ShadingRay ray(
+                position + m_ray_offset * normal,
+                normal,
+                0.0,
+                m_max_distance,
+                m_ray_time,
+                VisibilityFlags::ProbeRay,
+                0);
+
+            // Decorrelate the sample directions of neighboring vertices.
+            const Vector2d rotation(
+                hash_uint32(vertex_index) * (1.0 / 4294967296.0),
+                hash_uint32_alt(vertex_index) * (1.0 / 4294967296.0));
+
+            size_t occluded_samples = 0;
+
+            for (size_t i = 0; i < m_sample_count; ++i)
+            {
+                static const size_t Bases[] = { 2 };
+                const Vector2d h = hammersley_sequence<double, 2>(Bases, m_sample_count, i);
+                const Vector2d s(
+                    wrap(h[0] + rotation[0]),
+                    wrap(h[1] + rotation[1]));
+
+                const Vector3d local_dir =
+                    m_cosine_weighted
+                        ? sample_hemisphere_cosine(s)
+                        : sample_hemisphere_uniform(s);
+                ray.m_dir = basis.transform_to_parent(local_dir);
+
+                if (intersector.trace_probe(ray))
+                    ++occluded_samples;
+            }
+
+            return
+                m_sample_count > 0
+                    ? static_cast<float>(occluded_samples) / m_sample_count
+                    : 0.0f;
+        }
+    };
+
+    // Number of vertices processed by a single job.
+    const size_t VerticesPerJob = 1024;
+
+    void collect_vertices(
+        const ObjectInstance&           object_instance,
+        const Transformd&               transform,
+        vector<VertexSet>&              vertex_sets)
+    {
+        Object& object = object_instance.get_object();
+        Access<RegionKit> region_kit(&object.get_region_kit());
+
+        for (size_t region_index = 0, e = region_kit->size(); region_index < e; ++region_index)
+        {
+            const IRegion* region = (*region_kit)[region_index];
+            Access<StaticTriangleTess> tess(&region->get_static_triangle_tess());
+
+            // Regions whose vertices were released are not cached.
+            if (tess->has_released_vertices())
+                continue;
+
+            vertex_sets.push_back(VertexSet());
+            VertexSet& vertex_set = vertex_sets.back();
+            vertex_set.m_region_index = region_index;
+
+            // Transform the vertices to world space.
+            const size_t vertex_count = tess->m_vertices.size();
+            vertex_set.m_positions.resize(vertex_count);
+            for (size_t i = 0; i < vertex_count; ++i)
+                vertex_set.m_positions[i] = transform.point_to_parent(Vector3d(tess->m_vertices[i]));
+
+            // Compute area-weighted vertex normals from the winding of the triangles.
+            const size_t triangle_count = tess->m_primitives.size();
+            vertex_set.m_normals.assign(vertex_count, Vector3d(0.0));
+            vertex_set.m_corners.resize(3 * triangle_count);
+            for (size_t i = 0; i < triangle_count; ++i)
+            {
+                const Triangle& triangle = tess->m_primitives[i];
+                vertex_set.m_corners[3 * i + 0] = triangle.m_v0;
+                vertex_set.m_corners[3 * i + 1] = triangle.m_v1;
+                vertex_set.m_corners[3 * i + 2] = triangle.m_v2;
+
+                const Vector3d& v0 = vertex_set.m_positions[triangle.m_v0];
+                const Vector3d& v1 = vertex_set.m_positions[triangle.m_v1];
+                const Vector3d& v2 = vertex_set.m_positions[triangle.m_v2];
+                const Vector3d n = cross(v1 - v0, v2 - v0);
+
+                vertex_set.m_normals[triangle.m_v0] += n;
+                vertex_set.m_normals[triangle.m_v1] += n;
+                vertex_set.m_normals[triangle.m_v2] += n;
+            }
+
+            for (size_t i = 0; i < vertex_count; ++i)
+            {
+                const double norm2 = square_norm(vertex_set.m_normals[i]);
+                vertex_set.m_normals[i] =
+                    norm2 > 0.0
+                        ? vertex_set.m_normals[i] / sqrt(norm2)
+                        : Vector3d(0.0);
+            }
+
+            vertex_set.m_occlusion.resize(vertex_count);
+        }
+    }
+
+    uint64 compute_geometry_signature(const Scene& scene, const float time)
+    {
+        uint64 signature = 0;
+
+        for (const_each<AssemblyInstanceContainer> i = scene.assembly_instances(); i; ++i)
+        {
+            const AssemblyInstance& assembly_instance = *i;
+            const Assembly& assembly = assembly_instance.get_assembly();
+
+            const Transformd transform = assembly_instance.transform_sequence().evaluate(time);
+            signature = siphash24(signature, assembly_instance.compute_signature());
+            signature = siphash24(signature, assembly.compute_signature());
+            signature = siphash24(signature, siphash24(transform.get_local_to_parent()));
+
+            for (const_each<ObjectInstanceContainer> j = assembly.object_instances(); j; ++j)
+            {
+                const ObjectInstance& object_instance = *j;
+                signature = siphash24(signature, object_instance.compute_signature());
+                signature = siphash24(signature, object_instance.get_object().compute_signature());
+            }
+        }
+
+        return signature;
+    }
+}
+
+
+//
+// AmbientOcclusionCache class implementation.
+//
+
+AmbientOcclusionCache::AmbientOcclusionCache(
+    const double            max_distance,
+    const size_t            sample_count,
+    const bool              cosine_weighted)
+  : m_max_distance(max_distance)
+  , m_sample_count(sample_count)
+  , m_cosine_weighted(cosine_weighted)
+  , m_valid(false)
+  , m_geometry_signature(0)
+{
+}
+
+bool AmbientOcclusionCache::update(
+    const Project&          project,
+    IAbortSwitch*           abort_switch)
+{
+    const Scene& scene = *project.get_scene();
+
+    // The cache is built using the scene geometry at the middle of the shutter interval.
+    const Camera* camera = scene.get_active_camera();
+    const float shutter_open = camera ? camera->get_shutter_open_time() : 0.0f;
+    const float shutter_close = camera ? camera->get_shutter_close_time() : 0.0f;
+    const ShadingRay::Time ray_time =
+        ShadingRay::Time::create_with_normalized_time(0.5f, shutter_open, shutter_close);
+
+    // Reuse the cache if the scene geometry did not change.
+    const uint64 signature = compute_geometry_signature(scene, ray_time.m_absolute);
+    if (m_valid && signature == m_geometry_signature)
+        return true;
+
+    m_valid = false;
+    m_occlusion.clear();
+
+    // Collect the vertices of all mesh instances.
+    vector<VertexSet> vertex_sets;
+    vector<InstanceKey> vertex_set_keys;
+    size_t total_vertex_count = 0;
+
+    for (const_each<AssemblyInstanceContainer> i = scene.assembly_instances(); i; ++i)
+    {
+        const AssemblyInstance& assembly_instance = *i;
+        const Assembly& assembly = assembly_instance.get_assembly();
+        const Transformd assembly_instance_transform =
+            assembly_instance.transform_sequence().evaluate(ray_time.m_absolute);
+
+        for (const_each<ObjectInstanceContainer> j = assembly.object_instances(); j; ++j)
+        {
+            const ObjectInstance& object_instance = *j;
+            const InstanceKey key(assembly_instance.get_uid(), object_instance.get_uid());
+
+            const size_t first_vertex_set = vertex_sets.size();
+            collect_vertices(
+                object_instance,
+                assembly_instance_transform * object_instance.get_transform(),
+                vertex_sets);
+
+            for (size_t k = first_vertex_set; k < vertex_sets.size(); ++k)
+            {
+                vertex_set_keys.push_back(key);
+                total_vertex_count += vertex_sets[k].m_positions.size();
+            }
+        }
+    }
+
+    RENDERER_LOG_INFO(
+        "computing ambient occlusion at %s %s...",
+        pretty_uint(total_vertex_count).c_str(),
+        plural(total_vertex_count, "vertex", "vertices").c_str());
+
+    // Offset ray origins to avoid self-intersections.
+    const GAABB3 scene_bbox = scene.compute_bbox();
+    const double ray_offset =
+        scene_bbox.is_valid() ? 1.0e-5 * norm(Vector3d(scene_bbox.extent())) : 0.0;
+
+    // Compute the occlusion at all vertices in parallel.
+    TextureStore texture_store(scene);
+
+    JobQueue job_queue;
+    for (size_t i = 0, e = vertex_sets.size(); i < e; ++i)
+    {
+        VertexSet& vertex_set = vertex_sets[i];
+        const size_t vertex_count = vertex_set.m_positions.size();
+
+        for (size_t vertex_begin = 0; vertex_begin < vertex_count; vertex_begin += VerticesPerJob)
+        {
+            job_queue.schedule(
+                new ComputeOcclusionJob(
+                    project.get_trace_context(),
+                    texture_store,
+                    vertex_set,
+                    vertex_begin,
+                    min(vertex_begin + VerticesPerJob, vertex_count),
+                    m_max_distance,
+                    m_sample_count,
+                    m_cosine_weighted,
+                    ray_offset,
+                    ray_time,
+                    abort_switch));
+        }
+    }
+
+    JobManager job_manager(global_logger(), job_queue, System::get_available_cpu_core_count());
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    if (is_aborted(abort_switch))
+        return false;
+
+    // Store the occlusion at the corners of each triangle.
+    for (size_t i = 0, e = vertex_sets.size(); i < e; ++i)
+    {
+        const VertexSet& vertex_set = vertex_sets[i];
+
+        InstanceOcclusion& instance_occlusion = m_occlusion[vertex_set_keys[i]];
+        if (instance_occlusion.size() <= vertex_set.m_region_index)
+            instance_occlusion.resize(vertex_set.m_region_index + 1);
+
+        vector<float>& corners = instance_occlusion[vertex_set.m_region_index];
+        corners.resize(vertex_set.m_corners.size());
+        for (size_t j = 0, je = corners.size(); j < je; ++j)
+            corners[j] = vertex_set.m_occlusion[vertex_set.m_corners[j]];
+    }
+
+    m_valid = true;
+    m_geometry_signature = signature;
+
+    RENDERER_LOG_INFO("computed ambient occlusion cache.");
+
+    return true;
+}
+
+bool AmbientOcclusionCache::lookup(
+    const ShadingPoint&     shading_point,
+    double&                 occlusion) const
+{
+    if (!m_valid || shading_point.get_primitive_type() != ShadingPoint::PrimitiveTriangle)
+        return false;
+
+    const OcclusionMap::const_iterator it =
+        m_occlusion.find(
+            InstanceKey(
+                shading_point.get_assembly_instance().get_uid(),
+                shading_point.get_object_instance().get_uid()));
+    if (it == m_occlusion.end())
+        return false;
+
+    const size_t region_index = shading_point.get_region_index();
+    if (region_index >= it->second.size())
+        return false;
+
+    const vector<float>& corners = it->second[region_index];
+    const size_t primitive_index = shading_point.get_primitive_index();
+    if (3 * primitive_index + 2 >= corners.size())
+        return false;
+
+    // Occlusion is only cached on the front side of triangles.
+    const Vector3d& v0 = shading_point.get_vertex(0);
+    const Vector3d& v1 = shading_point.get_vertex(1);
+    const Vector3d& v2 = shading_point.get_vertex(2);
+    if (dot(cross(v1 - v0, v2 - v0), shading_point.get_geometric_normal()) <= 0.0)
+        return false;
+
+    // Interpolate the occlusion at the corners of the triangle.
+    const Vector2f& bary = shading_point.get_bary();
+    const float* c = &corners[3 * primitive_index];
+    occlusion = (1.0f - bary[0] - bary[1]) * c[0] + bary[0] * c[1] + bary[1] * c[2];
+
+    return true;
+}
+
+}   // namespace renderer
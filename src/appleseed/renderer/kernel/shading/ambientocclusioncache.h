@@ -0,0 +1,101 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_KERNEL_SHADING_AMBIENTOCCLUSIONCACHE_H
+#define APPLESEED_RENDERER_KERNEL_SHADING_AMBIENTOCCLUSIONCACHE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class Project; }
+namespace renderer      { class ShadingPoint; }
+
+namespace renderer
+{
+
+//
+// A cache of ambient occlusion values at the vertices of the mesh objects of a scene.
+//
+// Occlusion is computed at every vertex of every mesh instance, in parallel, using the
+// scene geometry at the middle of the shutter interval. It is then interpolated across
+// triangles at lookup time. The cache is only rebuilt when the scene geometry changes.
+//
+
+class AmbientOcclusionCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    AmbientOcclusionCache(
+        const double                    max_distance,
+        const size_t                    sample_count,
+        const bool                      cosine_weighted);
+
+    // Rebuild the cache if the scene geometry changed since it was last built.
+    // Return false if the operation was aborted.
+    bool update(
+        const Project&                  project,
+        foundation::IAbortSwitch*       abort_switch = 0);
+
+    // Look up the occlusion at a given shading point. Return false if the shading point
+    // is not covered by the cache, for instance because it lies on a curve or because it
+    // is seen from the back side of a triangle.
+    bool lookup(
+        const ShadingPoint&             shading_point,
+        double&                         occlusion) const;
+
+  private:
+    typedef std::pair<foundation::uint64, foundation::uint64> InstanceKey;
+
+    // Occlusion at the three corners of each triangle of each region, indexed by region.
+    typedef std::vector<std::vector<float> > InstanceOcclusion;
+    typedef std::map<InstanceKey, InstanceOcclusion> OcclusionMap;
+
+    const double                        m_max_distance;
+    const size_t                        m_sample_count;
+    const bool                          m_cosine_weighted;
+
+    bool                                m_valid;
+    foundation::uint64                  m_geometry_signature;
+    OcclusionMap                        m_occlusion;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_SHADING_AMBIENTOCCLUSIONCACHE_H
@@ -612,6 +612,7 @@ namespace
             values->m_roughness = max(p->roughness, 0.0f);
             values->m_anisotropy = clamp(p->anisotropy, -1.0f, 1.0f);
             values->m_ior = max(p->ior, 0.001f);
+            values->m_energy_compensation = 0.0f;
         }
     };
 
@@ -729,6 +730,7 @@ namespace
             values->m_reflectance_multiplier = 1.0f;
             values->m_roughness = max(p->roughness, 0.0f);
             values->m_anisotropy = clamp(p->anisotropy, -1.0f, 1.0f);
+            values->m_energy_compensation = 0.0f;
         }
     };
 
@@ -900,6 +902,7 @@ namespace
             values->m_roughness = 0.0f;
             values->m_anisotropy = 0.0f;
             values->m_ior = max(p->ior, 0.001f);
+            values->m_energy_compensation = 0.0f;
         }
     };
 
@@ -34,6 +34,7 @@
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/utility/shadingprofiler.h"
 
 // Standard headers.
 #include <cassert>
@@ -168,6 +169,8 @@ Color3f OSLShaderGroupExec::execute_background(
     assert(m_osl_shading_context);
     assert(m_osl_thread_info);
 
+    ShadingProfileScope profile_scope(ShadingProfile::ShaderGroups, shader_group.get_name());
+
     OSL::ShaderGlobals sg;
     memset(&sg, 0, sizeof(OSL::ShaderGlobals));
     sg.I = outgoing;
@@ -208,6 +211,8 @@ void OSLShaderGroupExec::do_execute(
     assert(m_osl_shading_context);
     assert(m_osl_thread_info);
 
+    ShadingProfileScope profile_scope(ShadingProfile::ShaderGroups, shader_group.get_name());
+
     shading_point.initialize_osl_shader_globals(
         shader_group,
         ray_flags,
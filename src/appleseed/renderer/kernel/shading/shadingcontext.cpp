@@ -33,7 +33,10 @@
 // appleseed.renderer headers.
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/closures.h"
+#include "renderer/modeling/material/material.h"
+#include "renderer/modeling/object/object.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/utility/hotpathcounters.h"
 
 using namespace foundation;
 
@@ -87,6 +90,8 @@ void ShadingContext::execute_osl_shading(
     const ShaderGroup&      shader_group,
     const ShadingPoint&     shading_point) const
 {
+    APPLESEED_HOT_PATH_COUNT(++hot_path_counters().m_osl_executions[HotPathCounters::OSLShading]);
+
     m_shadergroup_exec.execute_shading(
         shader_group,
         shading_point);
@@ -96,17 +101,50 @@ void ShadingContext::execute_osl_subsurface(
     const ShaderGroup&      shader_group,
     const ShadingPoint&     shading_point) const
 {
+    APPLESEED_HOT_PATH_COUNT(++hot_path_counters().m_osl_executions[HotPathCounters::OSLSubsurface]);
+
     m_shadergroup_exec.execute_subsurface(
         shader_group,
         shading_point);
 }
 
+void ShadingContext::evaluate_opacity(
+    const ShadingPoint&     shading_point,
+    Alpha&                  alpha) const
+{
+    const Material* material = shading_point.get_material();
+
+    // Skip the evaluation of alpha maps altogether on fully opaque surfaces.
+    if (material &&
+        material->get_render_data().is_opaque() &&
+        shading_point.get_object().get_alpha_map() == 0)
+    {
+        alpha.set(1.0f);
+        return;
+    }
+
+    alpha = shading_point.get_alpha();
+
+    // Apply OSL transparency if needed.
+    if (material && material->get_render_data().m_osl_transparency)
+    {
+        Alpha a;
+        execute_osl_transparency(
+            *material->get_render_data().m_shader_group,
+            shading_point,
+            a);
+        alpha *= a;
+    }
+}
+
 void ShadingContext::execute_osl_transparency(
     const ShaderGroup&      shader_group,
     const ShadingPoint&     shading_point,
     Alpha&                  alpha,
     float*                  holdout) const
 {
+    APPLESEED_HOT_PATH_COUNT(++hot_path_counters().m_osl_executions[HotPathCounters::OSLTransparency]);
+
     m_shadergroup_exec.execute_transparency(
         shader_group,
         shading_point,
@@ -118,6 +156,8 @@ void ShadingContext::execute_osl_emission(
     const ShaderGroup&      shader_group,
     const ShadingPoint&     shading_point) const
 {
+    APPLESEED_HOT_PATH_COUNT(++hot_path_counters().m_osl_executions[HotPathCounters::OSLEmission]);
+
     m_shadergroup_exec.execute_emission(
         shader_group,
         shading_point);
@@ -128,6 +168,8 @@ void ShadingContext::execute_osl_bump(
     const ShadingPoint&     shading_point,
     const Vector2f&         s) const
 {
+    APPLESEED_HOT_PATH_COUNT(++hot_path_counters().m_osl_executions[HotPathCounters::OSLBump]);
+
     m_shadergroup_exec.execute_bump(
         shader_group,
         shading_point,
@@ -139,6 +181,8 @@ void ShadingContext::execute_osl_background(
     const Vector3f&         outgoing,
     Spectrum&               value) const
 {
+    APPLESEED_HOT_PATH_COUNT(++hot_path_counters().m_osl_executions[HotPathCounters::OSLBackground]);
+
     value =
         m_shadergroup_exec.execute_background(
             shader_group,
@@ -151,6 +195,8 @@ void ShadingContext::execute_osl_surface_shader(
     const Color3f&          color,
     const float             alpha) const
 {
+    APPLESEED_HOT_PATH_COUNT(++hot_path_counters().m_osl_executions[HotPathCounters::OSLSurfaceShader]);
+
     m_shadergroup_exec.execute_surface_shader(
         shader_group,
         shading_point,
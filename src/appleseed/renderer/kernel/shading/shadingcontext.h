@@ -99,6 +99,12 @@ class ShadingContext
     // Return the maximum number of iterations in ray/path tracing loops.
     size_t get_max_iterations() const;
 
+    // Evaluate only the opacity of a given shading point: alpha maps and OSL
+    // transparency are evaluated, but no BSDF or surface shader is set up.
+    void evaluate_opacity(
+        const ShadingPoint&         shading_point,
+        Alpha&                      alpha) const;
+
     OSL::ShadingSystem& get_osl_shading_system() const;
     OSL::ShadingContext* get_osl_shading_context() const;
 
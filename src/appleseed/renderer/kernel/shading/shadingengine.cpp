@@ -48,6 +48,7 @@
 #include "renderer/modeling/shadergroup/shadergroup.h"
 #include "renderer/modeling/surfaceshader/diagnosticsurfaceshader.h"
 #include "renderer/utility/paramarray.h"
+#include "renderer/utility/shadingprofiler.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/vector.h"
@@ -84,26 +85,19 @@ void ShadingEngine::shade_hit_point(
     const PixelContext&     pixel_context,
     const ShadingContext&   shading_context,
     const ShadingPoint&     shading_point,
+    const Alpha&            opacity,
     ShadingResult&          shading_result) const
 {
-    // Compute the alpha channel of the main output.
-    shading_result.m_main.m_alpha = shading_point.get_alpha();
-
     // Retrieve the material of the intersected surface.
     const Material* material = shading_point.get_material();
 
-    // Apply OSL transparency if needed.
-    if (material &&
-        material->get_render_data().m_shader_group &&
-        material->get_render_data().m_shader_group->has_transparency())
-    {
-        Alpha alpha;
-        shading_context.execute_osl_transparency(
-            *material->get_render_data().m_shader_group,
-            shading_point,
-            alpha);
-        shading_result.m_main.m_alpha *= alpha;
-    }
+    // Attribute the time spent shading this point to its material.
+    ShadingProfileScope profile_scope(
+        ShadingProfile::Materials,
+        material ? material->get_name() : "no material");
+
+    // Set the alpha channel of the main output.
+    shading_result.m_main.m_alpha = opacity;
 
     // Shade the sample if it isn't fully transparent.
     if (shading_result.m_main.m_alpha[0] > 0.0f || shading_point.shade_alpha_cutouts())
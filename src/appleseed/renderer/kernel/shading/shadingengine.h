@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/modeling/surfaceshader/surfaceshader.h"
 
@@ -42,7 +43,6 @@
 // Forward declarations.
 namespace renderer  { class ParamArray; }
 namespace renderer  { class PixelContext; }
-namespace renderer  { class ShadingContext; }
 namespace renderer  { class ShadingResult; }
 
 namespace renderer
@@ -67,18 +67,21 @@ class ShadingEngine
         const ShadingPoint&     shading_point,
         ShadingResult&          shading_result) const;
 
-  private:
-    foundation::auto_release_ptr<SurfaceShader> m_diagnostic_surface_shader;
-
-    void create_diagnostic_surface_shader(const ParamArray& params);
-
+    // Shade a given intersection point whose opacity was already evaluated
+    // with ShadingContext::evaluate_opacity().
     void shade_hit_point(
         SamplingContext&        sampling_context,
         const PixelContext&     pixel_context,
         const ShadingContext&   shading_context,
         const ShadingPoint&     shading_point,
+        const Alpha&            opacity,
         ShadingResult&          shading_result) const;
 
+  private:
+    foundation::auto_release_ptr<SurfaceShader> m_diagnostic_surface_shader;
+
+    void create_diagnostic_surface_shader(const ParamArray& params);
+
     void shade_environment(
         SamplingContext&        sampling_context,
         const PixelContext&     pixel_context,
@@ -101,12 +104,16 @@ inline void ShadingEngine::shade(
 {
     if (shading_point.hit())
     {
+        Alpha opacity;
+        shading_context.evaluate_opacity(shading_point, opacity);
+
         return
             shade_hit_point(
                 sampling_context,
                 pixel_context,
                 shading_context,
                 shading_point,
+                opacity,
                 shading_result);
     }
     else
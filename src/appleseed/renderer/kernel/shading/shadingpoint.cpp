@@ -157,13 +157,13 @@ void ShadingPoint::fetch_source_geometry() const
     // Retrieve the assembly.
     m_assembly = &m_assembly_instance->get_assembly();
 
-    // Retrieve the object instance.
-    m_object_instance = m_assembly->object_instances().get_by_index(m_object_instance_index);
+    // Retrieve the object instance and the object from the shading record of the object instance.
+    assert(m_object_instance_index < m_assembly->get_shading_record_count());
+    m_shading_record = &m_assembly->get_shading_records()[m_object_instance_index];
+    m_object_instance = m_shading_record->m_object_instance;
+    m_object = m_shading_record->m_object;
     assert(m_object_instance);
 
-    // Retrieve the object.
-    m_object = &m_object_instance->get_object();
-
     // Fetch primitive-specific geometry.
     if (m_primitive_type == PrimitiveTriangle)
         fetch_triangle_source_geometry();
@@ -249,6 +249,16 @@ void ShadingPoint::fetch_triangle_source_geometry() const
         m_v1 += tess.get_vertex_pose(triangle.m_v1, base_index) * frac;
         m_v2 += tess.get_vertex_pose(triangle.m_v2, base_index) * frac;
     }
+    else if (tess.has_released_vertices())
+    {
+        // The vertices were released once the triangle tree was built: recover them
+        // from the support plane of the hit triangle, which lies in assembly space.
+        const Transformd& obj_instance_transform = m_object_instance->get_transform();
+        const Vector3d& v0_as = m_triangle_support_plane.m_v0;
+        m_v0 = GVector3(obj_instance_transform.point_to_local(v0_as));
+        m_v1 = GVector3(obj_instance_transform.point_to_local(v0_as + m_triangle_support_plane.m_e0));
+        m_v2 = GVector3(obj_instance_transform.point_to_local(v0_as + m_triangle_support_plane.m_e1));
+    }
     else
     {
         m_v0 = tess.m_vertices[triangle.m_v0];
@@ -266,9 +276,9 @@ void ShadingPoint::fetch_triangle_source_geometry() const
             // Fetch vertex normals from previous pose.
             if (base_index == 0)
             {
-                m_n0 = tess.m_vertex_normals[triangle.m_n0];
-                m_n1 = tess.m_vertex_normals[triangle.m_n1];
-                m_n2 = tess.m_vertex_normals[triangle.m_n2];
+                m_n0 = tess.get_vertex_normal(triangle.m_n0);
+                m_n1 = tess.get_vertex_normal(triangle.m_n1);
+                m_n2 = tess.get_vertex_normal(triangle.m_n2);
             }
             else
             {
@@ -293,9 +303,9 @@ void ShadingPoint::fetch_triangle_source_geometry() const
         }
         else
         {
-            m_n0 = tess.m_vertex_normals[triangle.m_n0];
-            m_n1 = tess.m_vertex_normals[triangle.m_n1];
-            m_n2 = tess.m_vertex_normals[triangle.m_n2];
+            m_n0 = tess.get_vertex_normal(triangle.m_n0);
+            m_n1 = tess.get_vertex_normal(triangle.m_n1);
+            m_n2 = tess.get_vertex_normal(triangle.m_n2);
         }
 
         assert(is_normalized(m_n0));
@@ -880,12 +890,13 @@ void ShadingPoint::compute_alpha() const
         if (const Material* material = get_material())
         {
             const Material::RenderData& material_data = material->get_render_data();
-            if (material_data.m_alpha_map)
+            if (material_data.m_varying_alpha)
             {
                 Alpha a;
                 material_data.m_alpha_map->evaluate(*m_texture_cache, get_uv(0), a);
                 m_alpha *= a;
             }
+            else m_alpha *= material_data.m_uniform_alpha;
         }
     }
     else
@@ -992,6 +1003,7 @@ void ShadingPoint::initialize_osl_shader_globals(
         // Transformations.
         m_obj_transform_info.m_assembly_instance_transform = m_assembly_instance_transform_seq;
         m_obj_transform_info.m_object_instance_transform = &m_object_instance->get_transform();
+        m_obj_transform_info.invalidate();
         m_shader_globals.object2common = reinterpret_cast<OSL::TransformationPtr>(&m_obj_transform_info);
         m_shader_globals.shader2common = 0;
 
@@ -1016,53 +1028,92 @@ void ShadingPoint::initialize_osl_shader_globals(
 // ShadingPoint::OSLObjectTransformInfo class implementation.
 //
 
+void ShadingPoint::OSLObjectTransformInfo::invalidate()
+{
+    m_cached = 0;
+}
+
 bool ShadingPoint::OSLObjectTransformInfo::is_animated() const
 {
-    return !m_assembly_instance_transform->empty();
+    return m_assembly_instance_transform->size() > 1;
 }
 
-OSL::Matrix44 ShadingPoint::OSLObjectTransformInfo::get_transform() const
+const OSL::Matrix44& ShadingPoint::OSLObjectTransformInfo::get_transform() const
 {
     assert(!is_animated());
 
-    const Transformd& assembly_xform = m_assembly_instance_transform->get_earliest_transform();
-    const Transformd::MatrixType m(
-        m_object_instance_transform->get_local_to_parent() *
-        assembly_xform.get_local_to_parent());
+    if (!(m_cached & HasTransform))
+    {
+        const Transformd& assembly_xform = m_assembly_instance_transform->get_earliest_transform();
+        const Transformd::MatrixType m(
+            m_object_instance_transform->get_local_to_parent() *
+            assembly_xform.get_local_to_parent());
 
-    return Matrix4f(m);
+        m_transform = Matrix4f(m);
+        m_cached |= HasTransform;
+    }
+
+    return m_transform;
 }
 
-OSL::Matrix44 ShadingPoint::OSLObjectTransformInfo::get_transform(const float t) const
+const OSL::Matrix44& ShadingPoint::OSLObjectTransformInfo::get_transform(const float t) const
 {
-    const Transformd assembly_xform = m_assembly_instance_transform->evaluate(t);
-    const Transformd::MatrixType m(
-        m_object_instance_transform->get_local_to_parent() *
-        assembly_xform.get_local_to_parent());
+    if (!is_animated())
+        return get_transform();
+
+    if (!(m_cached & HasTransform) || m_transform_time != t)
+    {
+        Transformd scratch;
+        const Transformd& assembly_xform = m_assembly_instance_transform->evaluate(t, scratch);
+        const Transformd::MatrixType m(
+            m_object_instance_transform->get_local_to_parent() *
+            assembly_xform.get_local_to_parent());
+
+        m_transform = Matrix4f(m);
+        m_transform_time = t;
+        m_cached |= HasTransform;
+    }
 
-    return Matrix4f(m);
+    return m_transform;
 }
 
-OSL::Matrix44 ShadingPoint::OSLObjectTransformInfo::get_inverse_transform() const
+const OSL::Matrix44& ShadingPoint::OSLObjectTransformInfo::get_inverse_transform() const
 {
     assert(!is_animated());
 
-    const Transformd& assembly_xform = m_assembly_instance_transform->get_earliest_transform();
-    const Transformd::MatrixType m(
-        m_object_instance_transform->get_parent_to_local() *
-        assembly_xform.get_parent_to_local());
+    if (!(m_cached & HasInverseTransform))
+    {
+        const Transformd& assembly_xform = m_assembly_instance_transform->get_earliest_transform();
+        const Transformd::MatrixType m(
+            m_object_instance_transform->get_parent_to_local() *
+            assembly_xform.get_parent_to_local());
+
+        m_inverse_transform = Matrix4f(m);
+        m_cached |= HasInverseTransform;
+    }
 
-    return Matrix4f(m);
+    return m_inverse_transform;
 }
 
-OSL::Matrix44 ShadingPoint::OSLObjectTransformInfo::get_inverse_transform(const float t) const
+const OSL::Matrix44& ShadingPoint::OSLObjectTransformInfo::get_inverse_transform(const float t) const
 {
-    const Transformd assembly_xform = m_assembly_instance_transform->evaluate(t);
-    const Transformd::MatrixType m(
-        m_object_instance_transform->get_parent_to_local() *
-        assembly_xform.get_parent_to_local());
+    if (!is_animated())
+        return get_inverse_transform();
+
+    if (!(m_cached & HasInverseTransform) || m_inverse_transform_time != t)
+    {
+        Transformd scratch;
+        const Transformd& assembly_xform = m_assembly_instance_transform->evaluate(t, scratch);
+        const Transformd::MatrixType m(
+            m_object_instance_transform->get_parent_to_local() *
+            assembly_xform.get_parent_to_local());
+
+        m_inverse_transform = Matrix4f(m);
+        m_inverse_transform_time = t;
+        m_cached |= HasInverseTransform;
+    }
 
-    return Matrix4f(m);
+    return m_inverse_transform;
 }
 
 }   // namespace renderer
@@ -1104,6 +1155,7 @@ void PoisonImpl<renderer::ShadingPoint>::do_poison(renderer::ShadingPoint& point
 
     poison(point.m_assembly);
     poison(point.m_object_instance);
+    poison(point.m_shading_record);
     poison(point.m_object);
     poison(point.m_primitive_pa);
     poison(point.m_v0_uv);
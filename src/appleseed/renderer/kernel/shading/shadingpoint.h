@@ -232,16 +232,33 @@ class ShadingPoint
 
     struct OSLObjectTransformInfo
     {
+        // The matrices are computed on first use and cached until the next call to
+        // invalidate(): shaders commonly query the same transform many times per point.
+        void invalidate();
+
         bool is_animated() const;
 
-        OSL::Matrix44 get_transform() const;
-        OSL::Matrix44 get_transform(const float t) const;
+        const OSL::Matrix44& get_transform() const;
+        const OSL::Matrix44& get_transform(const float t) const;
 
-        OSL::Matrix44 get_inverse_transform() const;
-        OSL::Matrix44 get_inverse_transform(const float t) const;
+        const OSL::Matrix44& get_inverse_transform() const;
+        const OSL::Matrix44& get_inverse_transform(const float t) const;
 
         const TransformSequence*        m_assembly_instance_transform;
         const foundation::Transformd*   m_object_instance_transform;
+
+      private:
+        enum
+        {
+            HasTransform        = 1UL << 0,
+            HasInverseTransform = 1UL << 1
+        };
+
+        mutable foundation::uint32      m_cached;
+        mutable float                   m_transform_time;
+        mutable float                   m_inverse_transform_time;
+        mutable OSL::Matrix44           m_transform;
+        mutable OSL::Matrix44           m_inverse_transform;
     };
 
     struct OSLTraceData
@@ -262,12 +279,21 @@ class ShadingPoint
     friend class CurveLeafVisitor;
     friend class Intersector;
     friend class OSLShaderGroupExec;
+    friend class PrimaryHitCache;
     friend class RegionLeafVisitor;
     friend class RendererServices;
     friend class ShadingPointBuilder;
     friend class TriangleLeafVisitor;
     friend class foundation::PoisonImpl<ShadingPoint>;
 
+    //
+    // The members are grouped by how often they are used: hot members are set by the
+    // intersection or used to shade most points, cold members are only used by some
+    // shading points (ray differentials, motion blur, ambient occlusion, OSL shaders).
+    // Only the primary intersection results are copied; everything else is computed
+    // on demand, at most once, as tracked by m_members.
+    //
+
     // Context.
     RegionKitAccessCache*               m_region_kit_cache;
     StaticTriangleTessAccessCache*      m_tess_cache;
@@ -276,15 +302,15 @@ class ShadingPoint
     mutable ShadingRay                  m_ray;                              // world space ray (m_tmax = distance to intersection)
 
     // Primary intersection results.
-    PrimitiveType                       m_primitive_type;                   // type of the hit primitive
-    foundation::Vector2f                m_bary;                             // barycentric coordinates of intersection point
     const AssemblyInstance*             m_assembly_instance;                // hit assembly instance
-    foundation::Transformd              m_assembly_instance_transform;      // transform of the hit assembly instance at ray time
     const TransformSequence*            m_assembly_instance_transform_seq;  // transform sequence of the hit assembly instance.
-    size_t                              m_object_instance_index;            // index of the object instance that was hit
-    size_t                              m_region_index;                     // index of the region containing the hit triangle
-    size_t                              m_primitive_index;                  // index of the hit primitive
+    foundation::Transformd              m_assembly_instance_transform;      // transform of the hit assembly instance at ray time
     TriangleSupportPlaneType            m_triangle_support_plane;           // support plane of the hit triangle
+    foundation::Vector2f                m_bary;                             // barycentric coordinates of intersection point
+    PrimitiveType                       m_primitive_type;                   // type of the hit primitive
+    foundation::uint32                  m_object_instance_index;            // index of the object instance that was hit
+    foundation::uint32                  m_region_index;                     // index of the region containing the hit triangle
+    foundation::uint32                  m_primitive_index;                  // index of the hit primitive
 
     // Flags to keep track of which on-demand results have been computed and cached.
     enum Members
@@ -310,36 +336,29 @@ class ShadingPoint
     mutable foundation::uint32          m_members;
 
     // Source geometry (derived from primary intersection results).
+    mutable foundation::uint32          m_primitive_pa;                 // hit primitive attribute index
     mutable const Assembly*             m_assembly;                     // hit assembly
     mutable const ObjectInstance*       m_object_instance;              // hit object instance
+    mutable const ObjectInstanceShadingRecord* m_shading_record;        // shading record of the hit object instance
     mutable Object*                     m_object;                       // hit object
-    mutable foundation::uint32          m_primitive_pa;                 // hit primitive attribute index
     mutable GVector2                    m_v0_uv, m_v1_uv, m_v2_uv;      // texture coordinates from UV set #0 at triangle vertices
     mutable GVector3                    m_v0, m_v1, m_v2;               // object instance space triangle vertices
     mutable GVector3                    m_n0, m_n1, m_n2;               // object instance space triangle vertex normals
     mutable GVector3                    m_t0, m_t1, m_t2;               // object instance space triangle vertex tangents
 
-    // On-demand intersection results (derived from primary intersection results).
+    // On-demand intersection results used to shade most points (derived from primary intersection results).
     mutable foundation::Vector2f        m_uv;                           // texture coordinates from UV set #0
-    mutable foundation::Vector2f        m_duvdx;                        // screen space partial derivative of the texture coords wrt. X
-    mutable foundation::Vector2f        m_duvdy;                        // screen space partial derivative of the texture coords wrt. Y
     mutable foundation::Vector3d        m_point;                        // world space intersection point
     mutable foundation::Vector3d        m_biased_point;                 // world space intersection point with per-object-instance bias applied
     mutable foundation::Vector3d        m_dpdu;                         // world space partial derivative of the intersection point wrt. U
     mutable foundation::Vector3d        m_dpdv;                         // world space partial derivative of the intersection point wrt. V
-    mutable foundation::Vector3d        m_dndu;                         // world space partial derivative of the intersection normal wrt. U
-    mutable foundation::Vector3d        m_dndv;                         // world space partial derivative of the intersection normal wrt. V
-    mutable foundation::Vector3d        m_dpdx;                         // screen space partial derivative of the intersection point wrt. X
-    mutable foundation::Vector3d        m_dpdy;                         // screen space partial derivative of the intersection point wrt. Y
     mutable foundation::Vector3d        m_geometric_normal;             // world space geometric normal, unit-length
     mutable foundation::Vector3d        m_original_shading_normal;      // original world space shading normal, unit-length
     mutable foundation::Basis3d         m_shading_basis;                // world space orthonormal basis around shading normal
-    mutable ObjectInstance::Side        m_side;                         // side of the surface that was hit
-    mutable foundation::Vector3d        m_v0_w, m_v1_w, m_v2_w;         // world space triangle vertices
-    mutable foundation::Vector3d        m_point_velocity;               // world space point velocity
     mutable const Material*             m_material;                     // material at intersection point
     mutable const Material*             m_opposite_material;            // opposite material at intersection point
     mutable Alpha                       m_alpha;                        // opacity at intersection point
+    mutable ObjectInstance::Side        m_side;                         // side of the surface that was hit
     mutable bool                        m_shade_alpha_cutouts;
 
     // Data required to avoid self-intersections.
@@ -347,6 +366,16 @@ class ShadingPoint
     mutable foundation::Vector3d        m_front_point;                  // hit point refined to front, in assembly instance space
     mutable foundation::Vector3d        m_back_point;                   // hit point refined to back, in assembly instance space
 
+    // Cold on-demand intersection results (derived from primary intersection results).
+    mutable foundation::Vector2f        m_duvdx;                        // screen space partial derivative of the texture coords wrt. X
+    mutable foundation::Vector2f        m_duvdy;                        // screen space partial derivative of the texture coords wrt. Y
+    mutable foundation::Vector3d        m_dndu;                         // world space partial derivative of the intersection normal wrt. U
+    mutable foundation::Vector3d        m_dndv;                         // world space partial derivative of the intersection normal wrt. V
+    mutable foundation::Vector3d        m_dpdx;                         // screen space partial derivative of the intersection point wrt. X
+    mutable foundation::Vector3d        m_dpdy;                         // screen space partial derivative of the intersection point wrt. Y
+    mutable foundation::Vector3d        m_v0_w, m_v1_w, m_v2_w;         // world space triangle vertices
+    mutable foundation::Vector3d        m_point_velocity;               // world space point velocity
+
     // OSl-related data.
     mutable OSLObjectTransformInfo      m_obj_transform_info;
     mutable OSLTraceData                m_osl_trace_data;
@@ -404,15 +433,15 @@ inline ShadingPoint::ShadingPoint(const ShadingPoint& rhs)
   , m_texture_cache(rhs.m_texture_cache)
   , m_scene(rhs.m_scene)
   , m_ray(rhs.m_ray)
-  , m_primitive_type(rhs.m_primitive_type)
-  , m_bary(rhs.m_bary)
   , m_assembly_instance(rhs.m_assembly_instance)
-  , m_assembly_instance_transform(rhs.m_assembly_instance_transform)
   , m_assembly_instance_transform_seq(rhs.m_assembly_instance_transform_seq)
+  , m_assembly_instance_transform(rhs.m_assembly_instance_transform)
+  , m_triangle_support_plane(rhs.m_triangle_support_plane)
+  , m_bary(rhs.m_bary)
+  , m_primitive_type(rhs.m_primitive_type)
   , m_object_instance_index(rhs.m_object_instance_index)
   , m_region_index(rhs.m_region_index)
   , m_primitive_index(rhs.m_primitive_index)
-  , m_triangle_support_plane(rhs.m_triangle_support_plane)
   , m_members(0)
 {
 }
@@ -424,15 +453,15 @@ inline ShadingPoint& ShadingPoint::operator=(const ShadingPoint& rhs)
     m_texture_cache = rhs.m_texture_cache;
     m_scene = rhs.m_scene;
     m_ray = rhs.m_ray;
-    m_primitive_type = rhs.m_primitive_type;
-    m_bary = rhs.m_bary;
     m_assembly_instance = rhs.m_assembly_instance;
-    m_assembly_instance_transform = rhs.m_assembly_instance_transform;
     m_assembly_instance_transform_seq = rhs.m_assembly_instance_transform_seq;
+    m_assembly_instance_transform = rhs.m_assembly_instance_transform;
+    m_triangle_support_plane = rhs.m_triangle_support_plane;
+    m_bary = rhs.m_bary;
+    m_primitive_type = rhs.m_primitive_type;
     m_object_instance_index = rhs.m_object_instance_index;
     m_region_index = rhs.m_region_index;
     m_primitive_index = rhs.m_primitive_index;
-    m_triangle_support_plane = rhs.m_triangle_support_plane;
     m_members = 0;
     return *this;
 }
@@ -894,29 +923,28 @@ inline void ShadingPoint::fetch_materials() const
     // Proceed with retrieving the material only if the hit primitive has one.
     if (m_primitive_pa != Triangle::None)
     {
-        // Retrieve material indices from the object instance.
-        const MaterialArray* materials;
-        const MaterialArray* opposite_materials;
+        const ObjectInstanceShadingRecord& record = *m_shading_record;
+
+        // Fetch the materials from the shading record of the object instance.
         if (get_side() == ObjectInstance::FrontSide)
         {
-            materials = &m_object_instance->get_front_materials();
-            opposite_materials = &m_object_instance->get_back_materials();
+            if (m_primitive_pa < record.m_front_material_count)
+                m_material = record.m_front_materials[m_primitive_pa];
+
+            if (m_primitive_pa < record.m_back_material_count)
+                m_opposite_material = record.m_back_materials[m_primitive_pa];
         }
         else
         {
-            materials = &m_object_instance->get_back_materials();
-            opposite_materials = &m_object_instance->get_front_materials();
-        }
-
-        // Fetch the materials.
-        if (static_cast<size_t>(m_primitive_pa) < materials->size())
-            m_material = (*materials)[m_primitive_pa];
+            if (m_primitive_pa < record.m_back_material_count)
+                m_material = record.m_back_materials[m_primitive_pa];
 
-        if (static_cast<size_t>(m_primitive_pa) < opposite_materials->size())
-            m_opposite_material = (*opposite_materials)[m_primitive_pa];
+            if (m_primitive_pa < record.m_front_material_count)
+                m_opposite_material = record.m_front_materials[m_primitive_pa];
+        }
     }
 
-    m_shade_alpha_cutouts = m_object->shade_alpha_cutouts();
+    m_shade_alpha_cutouts = m_shading_record->m_shade_alpha_cutouts;
 
     if (m_material && m_material->shade_alpha_cutouts())
         m_shade_alpha_cutouts = true;
@@ -63,6 +63,9 @@ class ShadingResult
     // AOVs are cleared to transparent black but the main output is left uninitialized.
     explicit ShadingResult(const size_t aov_count = 0);
 
+    // Reinitialize this shading result as if it was constructed with a given number of AOVs.
+    void reset(const size_t aov_count);
+
     // Return true if this shading result contains valid linear RGB values;
     // false if the color, alpha or any AOV contain NaN or negative values.
     bool is_valid_linear_rgb() const;
@@ -116,6 +119,17 @@ inline ShadingResult::ShadingResult(const size_t aov_count)
     set_aovs_to_transparent_black_linear_rgba();
 }
 
+inline void ShadingResult::reset(const size_t aov_count)
+{
+    m_aovs.resize(aov_count);
+
+#ifdef DEBUG
+    poison(*this);
+#endif
+
+    set_aovs_to_transparent_black_linear_rgba();
+}
+
 inline void ShadingResult::set_main_to_linear_rgb(const foundation::Color3f& linear_rgb)
 {
     m_color_space = foundation::ColorSpaceLinearRGB;
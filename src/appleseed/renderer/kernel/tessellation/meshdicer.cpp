@@ -0,0 +1,719 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "meshdicer.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/input/source.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectoperations.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/unordered/unordered_map.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// MeshDicer class implementation.
+//
+
+namespace
+{
+    //
+    // Subdivision.
+    //
+
+    typedef boost::unordered_map<uint64, uint32> EdgeMidpointMap;
+
+    struct DicedGeometry
+    {
+        vector<GVector3>    m_vertices;
+        vector<GVector3>    m_normals;
+        vector<GVector2>    m_tex_coords;
+        vector<Triangle>    m_triangles;
+    };
+
+    // Return the index of the value at the middle of the edge (a, b), creating it if necessary.
+    // Edges are keyed by their sorted end indices so that adjacent triangles share midpoints.
+    template <typename T>
+    uint32 get_midpoint(
+        vector<T>&          values,
+        EdgeMidpointMap&    midpoints,
+        const uint32        a,
+        const uint32        b)
+    {
+        if (a == Triangle::None || b == Triangle::None)
+            return Triangle::None;
+
+        if (a == b)
+            return a;
+
+        const uint64 key =
+            a < b
+                ? (static_cast<uint64>(a) << 32) | b
+                : (static_cast<uint64>(b) << 32) | a;
+
+        const EdgeMidpointMap::const_iterator it = midpoints.find(key);
+        if (it != midpoints.end())
+            return it->second;
+
+        const T midpoint = (values[a] + values[b]) * GScalar(0.5);
+        const uint32 index = static_cast<uint32>(values.size());
+        values.push_back(midpoint);
+        midpoints.insert(make_pair(key, index));
+
+        return index;
+    }
+
+    // Split each triangle into four triangles.
+    void subdivide(DicedGeometry& geometry)
+    {
+        EdgeMidpointMap vertex_midpoints, normal_midpoints, tex_coords_midpoints;
+
+        const size_t triangle_count = geometry.m_triangles.size();
+        vector<Triangle> triangles;
+        triangles.reserve(4 * triangle_count);
+
+        for (size_t i = 0; i < triangle_count; ++i)
+        {
+            const Triangle& t = geometry.m_triangles[i];
+
+            const uint32 v01 = get_midpoint(geometry.m_vertices, vertex_midpoints, t.m_v0, t.m_v1);
+            const uint32 v12 = get_midpoint(geometry.m_vertices, vertex_midpoints, t.m_v1, t.m_v2);
+            const uint32 v20 = get_midpoint(geometry.m_vertices, vertex_midpoints, t.m_v2, t.m_v0);
+
+            const uint32 n01 = get_midpoint(geometry.m_normals, normal_midpoints, t.m_n0, t.m_n1);
+            const uint32 n12 = get_midpoint(geometry.m_normals, normal_midpoints, t.m_n1, t.m_n2);
+            const uint32 n20 = get_midpoint(geometry.m_normals, normal_midpoints, t.m_n2, t.m_n0);
+
+            const uint32 a01 = get_midpoint(geometry.m_tex_coords, tex_coords_midpoints, t.m_a0, t.m_a1);
+            const uint32 a12 = get_midpoint(geometry.m_tex_coords, tex_coords_midpoints, t.m_a1, t.m_a2);
+            const uint32 a20 = get_midpoint(geometry.m_tex_coords, tex_coords_midpoints, t.m_a2, t.m_a0);
+
+            triangles.push_back(Triangle(t.m_v0, v01, v20, t.m_n0, n01, n20, t.m_a0, a01, a20, t.m_pa));
+            triangles.push_back(Triangle(v01, t.m_v1, v12, n01, t.m_n1, n12, a01, t.m_a1, a12, t.m_pa));
+            triangles.push_back(Triangle(v20, v12, t.m_v2, n20, n12, t.m_n2, a20, a12, t.m_a2, t.m_pa));
+            triangles.push_back(Triangle(v01, v12, v20, n01, n12, n20, a01, a12, a20, t.m_pa));
+        }
+
+        geometry.m_triangles.swap(triangles);
+    }
+
+    // Move each vertex along its normal by the value of the displacement map at the vertex.
+    void displace(
+        DicedGeometry&      geometry,
+        const Source&       displacement_map,
+        TextureCache&       texture_cache,
+        const float         displacement_amount)
+    {
+        const size_t vertex_count = geometry.m_vertices.size();
+        vector<GVector3> directions(vertex_count, GVector3(0.0));
+        vector<GVector2> tex_coords(vertex_count, GVector2(0.0));
+        vector<bool> has_tex_coords(vertex_count, false);
+
+        // Vertices on normal or texture seams have several normals and texture coordinates:
+        // average the normals and use the first texture coordinates found, so that all the
+        // copies of a vertex move to the same place and no crack opens along the seams.
+        for (const_each<vector<Triangle> > i = geometry.m_triangles; i; ++i)
+        {
+            const Triangle& t = *i;
+            const uint32* v = &t.m_v0;
+            const uint32* n = &t.m_n0;
+            const uint32* a = &t.m_a0;
+
+            const GVector3 face_normal =
+                safe_normalize(
+                    cross(
+                        geometry.m_vertices[t.m_v1] - geometry.m_vertices[t.m_v0],
+                        geometry.m_vertices[t.m_v2] - geometry.m_vertices[t.m_v0]));
+
+            for (size_t j = 0; j < 3; ++j)
+            {
+                directions[v[j]] += n[j] != Triangle::None ? geometry.m_normals[n[j]] : face_normal;
+
+                if (a[j] != Triangle::None && !has_tex_coords[v[j]])
+                {
+                    tex_coords[v[j]] = geometry.m_tex_coords[a[j]];
+                    has_tex_coords[v[j]] = true;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < vertex_count; ++i)
+        {
+            float displacement;
+            displacement_map.evaluate(
+                texture_cache,
+                Vector2f(tex_coords[i]),
+                displacement);
+
+            geometry.m_vertices[i] +=
+                safe_normalize(directions[i]) * static_cast<GScalar>(displacement * displacement_amount);
+        }
+
+        // The interpolated normals no longer match the displaced surface.
+        geometry.m_normals.clear();
+
+        for (each<vector<Triangle> > i = geometry.m_triangles; i; ++i)
+            i->m_n0 = i->m_n1 = i->m_n2 = Triangle::None;
+    }
+}
+
+auto_release_ptr<MeshObject> create_diced_mesh_object(
+    const MeshObject&               mesh,
+    const size_t                    level,
+    const Source*                   displacement_map,
+    TextureCache*                   texture_cache,
+    const float                     displacement_amount)
+{
+    assert(mesh.get_motion_segment_count() == 0);
+    assert(displacement_map == 0 || texture_cache != 0);
+
+    DicedGeometry geometry;
+
+    const size_t vertex_count = mesh.get_vertex_count();
+    geometry.m_vertices.reserve(vertex_count);
+    for (size_t i = 0; i < vertex_count; ++i)
+        geometry.m_vertices.push_back(mesh.get_vertex(i));
+
+    const size_t normal_count = mesh.get_vertex_normal_count();
+    geometry.m_normals.reserve(normal_count);
+    for (size_t i = 0; i < normal_count; ++i)
+        geometry.m_normals.push_back(mesh.get_vertex_normal(i));
+
+    const size_t tex_coords_count = mesh.get_tex_coords_count();
+    geometry.m_tex_coords.reserve(tex_coords_count);
+    for (size_t i = 0; i < tex_coords_count; ++i)
+        geometry.m_tex_coords.push_back(mesh.get_tex_coords(i));
+
+    const size_t triangle_count = mesh.get_triangle_count();
+    geometry.m_triangles.reserve(triangle_count);
+    for (size_t i = 0; i < triangle_count; ++i)
+        geometry.m_triangles.push_back(mesh.get_triangle(i));
+
+    for (size_t i = 0; i < level; ++i)
+        subdivide(geometry);
+
+    if (displacement_map)
+        displace(geometry, *displacement_map, *texture_cache, displacement_amount);
+
+    auto_release_ptr<MeshObject> diced =
+        MeshObjectFactory::create(mesh.get_name(), mesh.get_parameters());
+
+    diced->reserve_vertices(geometry.m_vertices.size());
+    for (const_each<vector<GVector3> > i = geometry.m_vertices; i; ++i)
+        diced->push_vertex(*i);
+
+    diced->reserve_vertex_normals(geometry.m_normals.size());
+    for (const_each<vector<GVector3> > i = geometry.m_normals; i; ++i)
+        diced->push_vertex_normal(safe_normalize(*i));
+
+    diced->reserve_tex_coords(geometry.m_tex_coords.size());
+    for (const_each<vector<GVector2> > i = geometry.m_tex_coords; i; ++i)
+        diced->push_tex_coords(*i);
+
+    diced->reserve_triangles(geometry.m_triangles.size());
+    for (const_each<vector<Triangle> > i = geometry.m_triangles; i; ++i)
+        diced->push_triangle(*i);
+
+    const size_t material_slot_count = mesh.get_material_slot_count();
+    diced->reserve_material_slots(material_slot_count);
+    for (size_t i = 0; i < material_slot_count; ++i)
+        diced->push_material_slot(mesh.get_material_slot(i));
+
+    if (normal_count > 0 && diced->get_vertex_normal_count() == 0)
+        compute_smooth_vertex_normals(diced.ref());
+
+    if (mesh.get_vertex_tangent_count() > 0 && tex_coords_count > 0)
+        compute_smooth_vertex_tangents(diced.ref());
+
+    if (mesh.has_compact_vertex_attributes())
+        diced->compact_vertex_attributes();
+
+    return diced;
+}
+
+namespace
+{
+    //
+    // Dicing level selection.
+    //
+
+    // Approximate number of bytes taken by a diced triangle: its Triangle record,
+    // about half a vertex with its normal and texture coordinates, and its share
+    // of the triangle tree.
+    const size_t BytesPerDicedTriangle = 96;
+
+    struct DicingRequest
+    {
+        size_t  m_level;
+        bool    m_displaced;
+    };
+
+    typedef map<MeshObject*, DicingRequest> DicingRequestMap;
+
+    class DicingLevelEstimator
+      : public NonCopyable
+    {
+      public:
+        DicingLevelEstimator(const Project& project)
+          : m_camera(project.get_uncached_active_camera())
+          , m_pixels_per_unit(0.0)
+          , m_orthographic(false)
+        {
+            if (m_camera == 0)
+                return;
+
+            const CanvasProperties& props = project.get_frame()->image().properties();
+            const ParamArray& params = m_camera->get_parameters();
+            const double frame_width = static_cast<double>(props.m_canvas_width);
+
+            if (strcmp(m_camera->get_model(), "spherical_camera") == 0)
+            {
+                // One pixel spans the same angle everywhere on the film.
+                m_pixels_per_unit = frame_width / TwoPi<double>();
+                return;
+            }
+
+            // The camera is only approximated from its parameters: its projection
+            // is not prepared until the beginning of the frame.
+            double film_width = 0.025;
+            if (params.strings().exist("film_width"))
+                film_width = params.get_optional<double>("film_width", film_width);
+            else if (params.strings().exist("film_height") && params.strings().exist("aspect_ratio"))
+            {
+                film_width =
+                      params.get_optional<double>("film_height", film_width)
+                    * params.get_optional<double>("aspect_ratio", 1.0);
+            }
+            else film_width = params.get_optional<Vector2d>("film_dimensions", Vector2d(film_width))[0];
+
+            if (film_width <= 0.0)
+                return;
+
+            if (strcmp(m_camera->get_model(), "orthographic_camera") == 0)
+            {
+                // Distances don't matter; the film width is expressed in scene units.
+                m_pixels_per_unit = frame_width / film_width;
+                m_orthographic = true;
+                return;
+            }
+
+            double focal_length = 0.035;
+            if (params.strings().exist("horizontal_fov"))
+            {
+                const double hfov = params.get_optional<double>("horizontal_fov", 54.0);
+                focal_length = 0.5 * film_width / tan(0.5 * deg_to_rad(hfov));
+            }
+            else focal_length = params.get_optional<double>("focal_length", focal_length);
+
+            m_pixels_per_unit = frame_width * focal_length / film_width;
+        }
+
+        // Return the approximate length, in pixels, of a segment of a given length,
+        // expressed in world space, at the location closest to the camera in a given
+        // world space bounding box.
+        double get_pixel_length(const double length, const AABB3d& bbox) const
+        {
+            if (m_pixels_per_unit == 0.0)
+                return 0.0;
+
+            if (m_orthographic)
+                return length * m_pixels_per_unit;
+
+            const Vector3d camera_position =
+                m_camera->transform_sequence().get_earliest_transform().get_local_to_parent().extract_translation();
+
+            double square_distance = 0.0;
+            for (size_t i = 0; i < 3; ++i)
+            {
+                const double d =
+                    max(max(bbox.min[i] - camera_position[i], camera_position[i] - bbox.max[i]), 0.0);
+                square_distance += d * d;
+            }
+
+            // Don't let objects around the camera request infinite dicing levels.
+            const double distance = max(sqrt(square_distance), 1.0e-3 * length);
+
+            return length * m_pixels_per_unit / distance;
+        }
+
+      private:
+        const Camera*   m_camera;
+        double          m_pixels_per_unit;
+        bool            m_orthographic;
+    };
+
+    // Return the average length of the edges of a mesh object.
+    double compute_average_edge_length(const MeshObject& mesh)
+    {
+        const size_t triangle_count = mesh.get_triangle_count();
+        if (triangle_count == 0)
+            return 0.0;
+
+        double total_length = 0.0;
+
+        for (size_t i = 0; i < triangle_count; ++i)
+        {
+            const Triangle& t = mesh.get_triangle(i);
+            const Vector3d v0(mesh.get_vertex(t.m_v0));
+            const Vector3d v1(mesh.get_vertex(t.m_v1));
+            const Vector3d v2(mesh.get_vertex(t.m_v2));
+            total_length += norm(v1 - v0) + norm(v2 - v1) + norm(v0 - v2);
+        }
+
+        return total_length / (3 * triangle_count);
+    }
+
+    // Return the largest factor by which a transform scales lengths.
+    double get_max_scale(const Transformd& transform)
+    {
+        return
+            max(
+                max(
+                    norm(transform.vector_to_parent(Vector3d(1.0, 0.0, 0.0))),
+                    norm(transform.vector_to_parent(Vector3d(0.0, 1.0, 0.0)))),
+                norm(transform.vector_to_parent(Vector3d(0.0, 0.0, 1.0))));
+    }
+
+    class DicingRequestCollector
+      : public NonCopyable
+    {
+      public:
+        DicingRequestCollector(
+            const Project&      project,
+            DicingRequestMap&   requests)
+          : m_estimator(project)
+          , m_requests(requests)
+        {
+        }
+
+        void collect(
+            const AssemblyInstanceContainer&    assembly_instances,
+            const Transformd&                   parent_transform)
+        {
+            for (const_each<AssemblyInstanceContainer> i = assembly_instances; i; ++i)
+            {
+                const Assembly* assembly = i->find_assembly();
+                if (assembly == 0)
+                    continue;
+
+                const Transformd transform =
+                    i->transform_sequence().get_earliest_transform() * parent_transform;
+
+                for (const_each<ObjectInstanceContainer> j = assembly->object_instances(); j; ++j)
+                {
+                    MeshObject* mesh = dynamic_cast<MeshObject*>(j->find_object());
+                    if (mesh)
+                        collect(*mesh, j->get_transform() * transform);
+                }
+
+                collect(assembly->assembly_instances(), transform);
+            }
+        }
+
+      private:
+        struct MeshInfo
+        {
+            double  m_average_edge_length;
+            GAABB3  m_bbox;
+        };
+
+        typedef map<const MeshObject*, MeshInfo> MeshInfoMap;
+
+        const DicingLevelEstimator  m_estimator;
+        DicingRequestMap&           m_requests;
+        MeshInfoMap                 m_mesh_infos;
+
+        void collect(MeshObject& mesh, const Transformd& transform)
+        {
+            const ParamArray& params = mesh.get_parameters();
+            const double dicing_rate = params.get_optional<double>("dicing_rate", 0.0);
+            if (dicing_rate <= 0.0)
+                return;
+
+            const MeshObject& undiced = mesh.get_undiced_mesh();
+
+            if (undiced.get_motion_segment_count() > 0)
+            {
+                if (m_requests.find(&mesh) == m_requests.end())
+                {
+                    RENDERER_LOG_WARNING(
+                        "mesh object \"%s\" has motion and will not be diced.",
+                        mesh.get_path().c_str());
+                }
+                m_requests[&mesh].m_level = 0;
+                m_requests[&mesh].m_displaced = false;
+                return;
+            }
+
+            MeshInfoMap::const_iterator info_it = m_mesh_infos.find(&mesh);
+            if (info_it == m_mesh_infos.end())
+            {
+                MeshInfo info;
+                info.m_average_edge_length = compute_average_edge_length(undiced);
+                info.m_bbox = undiced.compute_local_bbox();
+                info_it = m_mesh_infos.insert(make_pair(&mesh, info)).first;
+            }
+
+            const double edge_length = info_it->second.m_average_edge_length * get_max_scale(transform);
+            const double pixel_length =
+                m_estimator.get_pixel_length(edge_length, transform.to_parent(AABB3d(info_it->second.m_bbox)));
+
+            // Each level halves the length of the edges.
+            const size_t max_level = params.get_optional<size_t>("max_dicing_level", 6);
+            const size_t level =
+                pixel_length > dicing_rate
+                    ? min(static_cast<size_t>(ceil(log(pixel_length / dicing_rate) / log(2.0))), max_level)
+                    : 0;
+
+            DicingRequestMap::iterator request_it = m_requests.find(&mesh);
+            if (request_it == m_requests.end())
+            {
+                DicingRequest request;
+                request.m_level = level;
+                request.m_displaced = mesh.get_uncached_displacement_map() != 0;
+                m_requests.insert(make_pair(&mesh, request));
+            }
+            else request_it->second.m_level = max(request_it->second.m_level, level);
+        }
+    };
+
+    // Lower the dicing levels of the most finely diced objects until the diced geometry fits in the budget.
+    void enforce_memory_budget(DicingRequestMap& requests, const size_t memory_budget)
+    {
+        while (true)
+        {
+            size_t total_size = 0;
+            DicingRequestMap::iterator finest = requests.end();
+
+            for (DicingRequestMap::iterator i = requests.begin(), e = requests.end(); i != e; ++i)
+            {
+                const DicingRequest& request = i->second;
+
+                if (request.m_level == 0 && !request.m_displaced)
+                    continue;
+
+                total_size +=
+                      i->first->get_undiced_mesh().get_triangle_count()
+                    * (size_t(1) << (2 * request.m_level))
+                    * BytesPerDicedTriangle;
+
+                if (request.m_level > 0 && (finest == requests.end() || request.m_level > finest->second.m_level))
+                    finest = i;
+            }
+
+            if (total_size <= memory_budget || finest == requests.end())
+                return;
+
+            --finest->second.m_level;
+        }
+    }
+
+    void collect_mesh_objects(const AssemblyContainer& assemblies, vector<MeshObject*>& meshes)
+    {
+        for (const_each<AssemblyContainer> i = assemblies; i; ++i)
+        {
+            for (each<ObjectContainer> j = i->objects(); j; ++j)
+            {
+                MeshObject* mesh = dynamic_cast<MeshObject*>(&*j);
+                if (mesh)
+                    meshes.push_back(mesh);
+            }
+
+            collect_mesh_objects(i->assemblies(), meshes);
+        }
+    }
+
+    //
+    // Dicing job.
+    //
+
+    class DiceMeshObjectJob
+      : public IJob
+    {
+      public:
+        DiceMeshObjectJob(
+            MeshObject&         mesh,
+            const size_t        level,
+            TextureStore&       texture_store)
+          : m_mesh(mesh)
+          , m_level(level)
+          , m_texture_store(texture_store)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+        {
+            TextureCache texture_cache(m_texture_store);
+
+            m_mesh.set_diced_geometry(
+                create_diced_mesh_object(
+                    m_mesh.get_undiced_mesh(),
+                    m_level,
+                    m_mesh.get_uncached_displacement_map(),
+                    &texture_cache,
+                    m_mesh.get_parameters().get_optional<float>("displacement_amount", 1.0f)),
+                m_level);
+        }
+
+      private:
+        MeshObject&         m_mesh;
+        const size_t        m_level;
+        TextureStore&       m_texture_store;
+    };
+}
+
+MeshDicer::MeshDicer(
+    const Project&                  project,
+    const ParamArray&               params)
+  : m_project(project)
+  , m_memory_budget(params.get_optional<size_t>("memory_budget", 1024) * 1024 * 1024)
+{
+}
+
+bool MeshDicer::dice(IAbortSwitch* abort_switch)
+{
+    const Scene& scene = *m_project.get_scene();
+
+    if (is_aborted(abort_switch))
+        return false;
+
+    // Choose a dicing level for each object that requests dicing.
+    DicingRequestMap requests;
+    DicingRequestCollector collector(m_project, requests);
+    collector.collect(scene.assembly_instances(), Transformd::identity());
+    enforce_memory_budget(requests, m_memory_budget);
+
+    // Only dice objects whose dicing level changed, and restore the others.
+    vector<MeshObject*> meshes;
+    collect_mesh_objects(scene.assemblies(), meshes);
+
+    TextureStore texture_store(scene);
+    JobQueue job_queue;
+    size_t diced_count = 0;
+    size_t restored_count = 0;
+
+    for (const_each<vector<MeshObject*> > i = meshes; i; ++i)
+    {
+        MeshObject& mesh = **i;
+        const bool diced = &mesh.get_undiced_mesh() != &mesh;
+
+        const DicingRequestMap::const_iterator request_it = requests.find(&mesh);
+        const bool requested =
+            request_it != requests.end() &&
+            (request_it->second.m_level > 0 || request_it->second.m_displaced);
+
+        if (!requested)
+        {
+            if (diced)
+            {
+                mesh.restore_undiced_geometry();
+                mesh.get_parent()->bump_version_id();
+                ++restored_count;
+            }
+        }
+        else if (!diced || mesh.get_dicing_level() != request_it->second.m_level)
+        {
+            job_queue.schedule(new DiceMeshObjectJob(mesh, request_it->second.m_level, texture_store));
+            mesh.get_parent()->bump_version_id();
+            ++diced_count;
+        }
+    }
+
+    if (diced_count > 0)
+    {
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            System::get_available_cpu_core_count());
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+    }
+
+    if (diced_count > 0 || restored_count > 0)
+    {
+        RENDERER_LOG_INFO(
+            "diced %s mesh object%s, restored %s mesh object%s.",
+            pretty_uint(diced_count).c_str(),
+            diced_count > 1 ? "s" : "",
+            pretty_uint(restored_count).c_str(),
+            restored_count > 1 ? "s" : "");
+    }
+
+    return !is_aborted(abort_switch);
+}
+
+}   // namespace renderer
@@ -0,0 +1,104 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_TESSELLATION_MESHDICER_H
+#define APPLESEED_RENDERER_KERNEL_TESSELLATION_MESHDICER_H
+
+// appleseed.renderer headers.
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/utility/autoreleaseptr.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class MeshObject; }
+namespace renderer      { class Project; }
+namespace renderer      { class Source; }
+namespace renderer      { class TextureCache; }
+
+namespace renderer
+{
+
+//
+// Render-time dicing of mesh objects.
+//
+// Mesh objects with a "dicing_rate" parameter (the desired length of their edges,
+// in pixels) are uniformly subdivided before the trace context is built, to a level
+// that depends on how large they appear from the active camera, and then optionally
+// displaced along their normals by their "displacement_map" input scaled by their
+// "displacement_amount" parameter.
+//
+// The original geometry of diced objects is kept aside: subsequent renders only dice
+// again the objects whose dicing level changed, and restore the original geometry of
+// the objects that no longer request dicing. The total memory taken by diced geometry
+// is capped by the "memory_budget" parameter (in megabytes): when the requested levels
+// would exceed it, the objects with the finest dicing are diced less finely.
+//
+
+class MeshDicer
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    MeshDicer(
+        const Project&              project,
+        const ParamArray&           params);
+
+    // Dice the mesh objects of the scene, or restore their original geometry.
+    // Returns false if dicing was aborted, true otherwise.
+    bool dice(foundation::IAbortSwitch* abort_switch = 0);
+
+  private:
+    const Project&  m_project;
+    const size_t    m_memory_budget;
+};
+
+// Create a copy of a mesh object in which each triangle was split into four triangles,
+// `level` times, by inserting vertices at the middle of its edges. Vertex normals and
+// texture coordinates are interpolated. If a displacement map is given, the vertices are
+// then moved along their normal by the value of the map times `displacement_amount`,
+// and the vertex normals are recomputed. The mesh object must not have motion segments.
+APPLESEED_DLLSYMBOL foundation::auto_release_ptr<MeshObject> create_diced_mesh_object(
+    const MeshObject&               mesh,
+    const size_t                    level,
+    const Source*                   displacement_map = 0,
+    TextureCache*                   texture_cache = 0,
+    const float                     displacement_amount = 1.0f);
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_TESSELLATION_MESHDICER_H
@@ -36,11 +36,21 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/octahedral.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/attributeset.h"
 #include "foundation/utility/lazy.h"
+#include "foundation/utility/memory.h"
 #include "foundation/utility/numerictype.h"
 #include "foundation/utility/poolallocator.h"
 
+// OpenEXR headers.
+#include "foundation/platform/exrheaderguards.h"
+BEGIN_EXR_INCLUDES
+#include "OpenEXR/half.h"
+END_EXR_INCLUDES
+
 // Standard headers.
 #include <cassert>
 #include <cstddef>
@@ -67,6 +77,7 @@ class StaticTessellation
     typedef std::vector<PrimitiveType> PrimitiveArray;
 
     // Primary features.
+    // m_vertex_normals is empty when vertex attributes are compact.
     VectorArray                 m_vertices;
     VectorArray                 m_vertex_normals;
     PrimitiveArray              m_primitives;
@@ -83,6 +94,25 @@ class StaticTessellation
     // Constructor.
     StaticTessellation();
 
+    // Store vertex normals and tangents (and their poses) as octahedral-encoded
+    // unit vectors and texture coordinates as half floats from now on. This is
+    // lossy, and roughly halves the memory used by these attributes.
+    void compact_vertex_attributes();
+    bool has_compact_vertex_attributes() const;
+
+    // Release the vertex positions, once a copy of them is held elsewhere (for instance
+    // in a triangle tree). The local bounding box is retained. Tessellations with motion
+    // segments keep their vertices. This cannot be undone.
+    void release_vertices();
+    bool has_released_vertices() const;
+
+    // Insert and access vertex normals.
+    void reserve_vertex_normals(const size_t count);
+    size_t push_vertex_normal(const GVector3& normal);      // the normal must be unit-length
+    size_t get_vertex_normal_count() const;
+    GVector3 get_vertex_normal(const size_t index) const;
+    void clear_vertex_normals();
+
     // Insert and access texture coordinates.
     void reserve_tex_coords(const size_t count);
     size_t push_tex_coords(const GVector2& uv);
@@ -145,6 +175,17 @@ class StaticTessellation
     GAABB3 compute_local_bbox() const;
 
   private:
+    typedef std::vector<foundation::uint32> PackedVectorArray;
+
+    bool                                m_compact;
+    bool                                m_released_vertices;
+    GAABB3                              m_released_vertices_bbox;
+    PackedVectorArray                   m_packed_vertex_normals;
+    PackedVectorArray                   m_packed_vertex_normal_poses;
+    PackedVectorArray                   m_packed_vertex_tangents;
+    PackedVectorArray                   m_packed_vertex_tangent_poses;
+    std::vector<half>                   m_packed_tex_coords;
+
     foundation::AttributeSet::ChannelID m_uv_0_cid;         // UV coordinates set #0
     foundation::AttributeSet::ChannelID m_tangents_cid;     // per-vertex tangent vectors
     foundation::AttributeSet::ChannelID m_ms_count_cid;     // motion segment count
@@ -178,7 +219,9 @@ typedef foundation::AccessCache<
 
 template <typename Primitive>
 inline StaticTessellation<Primitive>::StaticTessellation()
-  : m_uv_0_cid(foundation::AttributeSet::InvalidChannelID)
+  : m_compact(false)
+  , m_released_vertices(false)
+  , m_uv_0_cid(foundation::AttributeSet::InvalidChannelID)
   , m_tangents_cid(foundation::AttributeSet::InvalidChannelID)
   , m_ms_count_cid(foundation::AttributeSet::InvalidChannelID)
   , m_vp_cid(foundation::AttributeSet::InvalidChannelID)
@@ -187,9 +230,161 @@ inline StaticTessellation<Primitive>::StaticTessellation()
 {
 }
 
+template <typename Primitive>
+void StaticTessellation<Primitive>::compact_vertex_attributes()
+{
+    if (m_compact)
+        return;
+
+    const size_t motion_segment_count = get_motion_segment_count();
+
+    // Vertex normals and their poses.
+    const size_t normal_count = m_vertex_normals.size();
+    m_packed_vertex_normals.resize(normal_count);
+    for (size_t i = 0; i < normal_count; ++i)
+        m_packed_vertex_normals[i] = foundation::encode_octahedral(m_vertex_normals[i]);
+    foundation::clear_release_memory(m_vertex_normals);
+
+    if (m_vnp_cid != foundation::AttributeSet::InvalidChannelID)
+    {
+        m_packed_vertex_normal_poses.resize(normal_count * motion_segment_count);
+        for (size_t i = 0, e = m_packed_vertex_normal_poses.size(); i < e; ++i)
+        {
+            GVector3 normal;
+            m_vertex_normal_attributes.get_attribute(m_vnp_cid, i, &normal);
+            m_packed_vertex_normal_poses[i] = foundation::encode_octahedral(normal);
+        }
+
+        m_vertex_normal_attributes.delete_channel(m_vnp_cid);
+        m_vnp_cid = foundation::AttributeSet::InvalidChannelID;
+    }
+
+    // Vertex tangents and their poses.
+    const size_t tangent_count = get_vertex_tangent_count();
+    if (m_tangents_cid != foundation::AttributeSet::InvalidChannelID)
+    {
+        m_packed_vertex_tangents.resize(tangent_count);
+        for (size_t i = 0; i < tangent_count; ++i)
+            m_packed_vertex_tangents[i] = foundation::encode_octahedral(get_vertex_tangent(i));
+
+        // Other channels of this attribute set are referenced by ID, so the channel is kept.
+        m_vertex_attributes.clear_attributes(m_tangents_cid);
+    }
+
+    if (m_vtp_cid != foundation::AttributeSet::InvalidChannelID)
+    {
+        m_packed_vertex_tangent_poses.resize(tangent_count * motion_segment_count);
+        for (size_t i = 0, e = m_packed_vertex_tangent_poses.size(); i < e; ++i)
+        {
+            GVector3 tangent;
+            m_vertex_tangent_poses.get_attribute(m_vtp_cid, i, &tangent);
+            m_packed_vertex_tangent_poses[i] = foundation::encode_octahedral(tangent);
+        }
+
+        m_vertex_tangent_poses.delete_channel(m_vtp_cid);
+        m_vtp_cid = foundation::AttributeSet::InvalidChannelID;
+    }
+
+    // Texture coordinates.
+    if (m_uv_0_cid != foundation::AttributeSet::InvalidChannelID)
+    {
+        const size_t tex_coords_count = get_tex_coords_count();
+        m_packed_tex_coords.resize(tex_coords_count * 2);
+        for (size_t i = 0; i < tex_coords_count; ++i)
+        {
+            const GVector2 uv = get_tex_coords(i);
+            m_packed_tex_coords[i * 2 + 0] = static_cast<float>(uv[0]);
+            m_packed_tex_coords[i * 2 + 1] = static_cast<float>(uv[1]);
+        }
+
+        m_vertex_attributes.clear_attributes(m_uv_0_cid);
+    }
+
+    m_compact = true;
+}
+
+template <typename Primitive>
+inline bool StaticTessellation<Primitive>::has_compact_vertex_attributes() const
+{
+    return m_compact;
+}
+
+template <typename Primitive>
+void StaticTessellation<Primitive>::release_vertices()
+{
+    if (m_released_vertices || get_motion_segment_count() > 0)
+        return;
+
+    m_released_vertices_bbox = compute_local_bbox();
+    foundation::clear_release_memory(m_vertices);
+
+    m_released_vertices = true;
+}
+
+template <typename Primitive>
+inline bool StaticTessellation<Primitive>::has_released_vertices() const
+{
+    return m_released_vertices;
+}
+
+template <typename Primitive>
+inline void StaticTessellation<Primitive>::reserve_vertex_normals(const size_t count)
+{
+    if (m_compact)
+        m_packed_vertex_normals.reserve(count);
+    else m_vertex_normals.reserve(count);
+}
+
+template <typename Primitive>
+inline size_t StaticTessellation<Primitive>::push_vertex_normal(const GVector3& normal)
+{
+    if (m_compact)
+    {
+        const size_t index = m_packed_vertex_normals.size();
+        m_packed_vertex_normals.push_back(foundation::encode_octahedral(normal));
+        return index;
+    }
+    else
+    {
+        const size_t index = m_vertex_normals.size();
+        m_vertex_normals.push_back(normal);
+        return index;
+    }
+}
+
+template <typename Primitive>
+inline size_t StaticTessellation<Primitive>::get_vertex_normal_count() const
+{
+    return m_compact ? m_packed_vertex_normals.size() : m_vertex_normals.size();
+}
+
+template <typename Primitive>
+inline GVector3 StaticTessellation<Primitive>::get_vertex_normal(const size_t index) const
+{
+    assert(index < get_vertex_normal_count());
+
+    return
+        m_compact
+            ? foundation::decode_octahedral<GScalar>(m_packed_vertex_normals[index])
+            : m_vertex_normals[index];
+}
+
+template <typename Primitive>
+inline void StaticTessellation<Primitive>::clear_vertex_normals()
+{
+    m_vertex_normals.clear();
+    m_packed_vertex_normals.clear();
+}
+
 template <typename Primitive>
 inline void StaticTessellation<Primitive>::reserve_tex_coords(const size_t count)
 {
+    if (m_compact)
+    {
+        m_packed_tex_coords.reserve(count * 2);
+        return;
+    }
+
     if (m_uv_0_cid == foundation::AttributeSet::InvalidChannelID)
         create_uv_0_attribute();
 
@@ -199,6 +394,14 @@ inline void StaticTessellation<Primitive>::reserve_tex_coords(const size_t count
 template <typename Primitive>
 inline size_t StaticTessellation<Primitive>::push_tex_coords(const GVector2& uv)
 {
+    if (m_compact)
+    {
+        const size_t index = m_packed_tex_coords.size() / 2;
+        m_packed_tex_coords.push_back(static_cast<float>(uv[0]));
+        m_packed_tex_coords.push_back(static_cast<float>(uv[1]));
+        return index;
+    }
+
     if (m_uv_0_cid == foundation::AttributeSet::InvalidChannelID)
         create_uv_0_attribute();
 
@@ -208,6 +411,9 @@ inline size_t StaticTessellation<Primitive>::push_tex_coords(const GVector2& uv)
 template <typename Primitive>
 inline size_t StaticTessellation<Primitive>::get_tex_coords_count() const
 {
+    if (m_compact)
+        return m_packed_tex_coords.size() / 2;
+
     if (m_uv_0_cid == foundation::AttributeSet::InvalidChannelID)
         return 0;
 
@@ -217,6 +423,16 @@ inline size_t StaticTessellation<Primitive>::get_tex_coords_count() const
 template <typename Primitive>
 inline GVector2 StaticTessellation<Primitive>::get_tex_coords(const size_t index) const
 {
+    if (m_compact)
+    {
+        assert(index < get_tex_coords_count());
+
+        return
+            GVector2(
+                static_cast<GScalar>(static_cast<float>(m_packed_tex_coords[index * 2 + 0])),
+                static_cast<GScalar>(static_cast<float>(m_packed_tex_coords[index * 2 + 1])));
+    }
+
     assert(m_uv_0_cid != foundation::AttributeSet::InvalidChannelID);
 
     GVector2 uv;
@@ -228,6 +444,12 @@ inline GVector2 StaticTessellation<Primitive>::get_tex_coords(const size_t index
 template <typename Primitive>
 inline void StaticTessellation<Primitive>::reserve_vertex_tangents(const size_t count)
 {
+    if (m_compact)
+    {
+        m_packed_vertex_tangents.reserve(count);
+        return;
+    }
+
     if (m_tangents_cid == foundation::AttributeSet::InvalidChannelID)
         create_tangents_attribute();
 
@@ -237,6 +459,13 @@ inline void StaticTessellation<Primitive>::reserve_vertex_tangents(const size_t
 template <typename Primitive>
 inline size_t StaticTessellation<Primitive>::push_vertex_tangent(const GVector3& tangent)
 {
+    if (m_compact)
+    {
+        const size_t index = m_packed_vertex_tangents.size();
+        m_packed_vertex_tangents.push_back(foundation::encode_octahedral(tangent));
+        return index;
+    }
+
     if (m_tangents_cid == foundation::AttributeSet::InvalidChannelID)
         create_tangents_attribute();
 
@@ -246,6 +475,9 @@ inline size_t StaticTessellation<Primitive>::push_vertex_tangent(const GVector3&
 template <typename Primitive>
 inline size_t StaticTessellation<Primitive>::get_vertex_tangent_count() const
 {
+    if (m_compact)
+        return m_packed_vertex_tangents.size();
+
     if (m_tangents_cid == foundation::AttributeSet::InvalidChannelID)
         return 0;
 
@@ -255,6 +487,12 @@ inline size_t StaticTessellation<Primitive>::get_vertex_tangent_count() const
 template <typename Primitive>
 inline GVector3 StaticTessellation<Primitive>::get_vertex_tangent(const size_t index) const
 {
+    if (m_compact)
+    {
+        assert(index < m_packed_vertex_tangents.size());
+        return foundation::decode_octahedral<GScalar>(m_packed_vertex_tangents[index]);
+    }
+
     assert(m_tangents_cid != foundation::AttributeSet::InvalidChannelID);
 
     GVector3 tangent;
@@ -352,11 +590,19 @@ inline void StaticTessellation<Primitive>::set_vertex_normal_pose(
     const size_t    motion_segment_index,
     const GVector3& normal)
 {
-    assert(normal_index < m_vertex_normals.size());
+    assert(normal_index < get_vertex_normal_count());
 
     const size_t motion_segment_count = get_motion_segment_count();
     assert(motion_segment_index < motion_segment_count);
 
+    if (m_compact)
+    {
+        const size_t index = normal_index * motion_segment_count + motion_segment_index;
+        foundation::ensure_minimum_size(m_packed_vertex_normal_poses, index + 1);
+        m_packed_vertex_normal_poses[index] = foundation::encode_octahedral(normal);
+        return;
+    }
+
     if (m_vnp_cid == foundation::AttributeSet::InvalidChannelID)
     {
         m_vnp_cid =
@@ -377,12 +623,20 @@ inline GVector3 StaticTessellation<Primitive>::get_vertex_normal_pose(
     const size_t    normal_index,
     const size_t    motion_segment_index) const
 {
-    assert(m_vnp_cid != foundation::AttributeSet::InvalidChannelID);
-    assert(normal_index < m_vertex_normals.size());
+    assert(normal_index < get_vertex_normal_count());
 
     const size_t motion_segment_count = get_motion_segment_count();
     assert(motion_segment_index < motion_segment_count);
 
+    if (m_compact)
+    {
+        const size_t index = normal_index * motion_segment_count + motion_segment_index;
+        assert(index < m_packed_vertex_normal_poses.size());
+        return foundation::decode_octahedral<GScalar>(m_packed_vertex_normal_poses[index]);
+    }
+
+    assert(m_vnp_cid != foundation::AttributeSet::InvalidChannelID);
+
     GVector3 normal;
     m_vertex_normal_attributes.get_attribute(
         m_vnp_cid,
@@ -395,6 +649,8 @@ inline GVector3 StaticTessellation<Primitive>::get_vertex_normal_pose(
 template <typename Primitive>
 void StaticTessellation<Primitive>::clear_vertex_normal_poses()
 {
+    foundation::clear_release_memory(m_packed_vertex_normal_poses);
+
     if (m_vnp_cid != foundation::AttributeSet::InvalidChannelID)
     {
         m_vertex_normal_attributes.delete_channel(m_vnp_cid);
@@ -413,6 +669,14 @@ inline void StaticTessellation<Primitive>::set_vertex_tangent_pose(
     const size_t motion_segment_count = get_motion_segment_count();
     assert(motion_segment_index < motion_segment_count);
 
+    if (m_compact)
+    {
+        const size_t index = tangent_index * motion_segment_count + motion_segment_index;
+        foundation::ensure_minimum_size(m_packed_vertex_tangent_poses, index + 1);
+        m_packed_vertex_tangent_poses[index] = foundation::encode_octahedral(tangent);
+        return;
+    }
+
     if (m_vtp_cid == foundation::AttributeSet::InvalidChannelID)
     {
         m_vtp_cid =
@@ -433,12 +697,20 @@ inline GVector3 StaticTessellation<Primitive>::get_vertex_tangent_pose(
     const size_t    tangent_index,
     const size_t    motion_segment_index) const
 {
-    assert(m_vtp_cid != foundation::AttributeSet::InvalidChannelID);
-    assert(tangent_index < m_vertex_normals.size());
+    assert(tangent_index < get_vertex_tangent_count());
 
     const size_t motion_segment_count = get_motion_segment_count();
     assert(motion_segment_index < motion_segment_count);
 
+    if (m_compact)
+    {
+        const size_t index = tangent_index * motion_segment_count + motion_segment_index;
+        assert(index < m_packed_vertex_tangent_poses.size());
+        return foundation::decode_octahedral<GScalar>(m_packed_vertex_tangent_poses[index]);
+    }
+
+    assert(m_vtp_cid != foundation::AttributeSet::InvalidChannelID);
+
     GVector3 tangent;
     m_vertex_tangent_poses.get_attribute(
         m_vtp_cid,
@@ -451,6 +723,8 @@ inline GVector3 StaticTessellation<Primitive>::get_vertex_tangent_pose(
 template <typename Primitive>
 void StaticTessellation<Primitive>::clear_vertex_tangent_poses()
 {
+    foundation::clear_release_memory(m_packed_vertex_tangent_poses);
+
     if (m_vtp_cid != foundation::AttributeSet::InvalidChannelID)
     {
         m_vertex_tangent_poses.delete_channel(m_vtp_cid);
@@ -461,6 +735,9 @@ void StaticTessellation<Primitive>::clear_vertex_tangent_poses()
 template <typename Primitive>
 GAABB3 StaticTessellation<Primitive>::compute_local_bbox() const
 {
+    if (m_released_vertices)
+        return m_released_vertices_bbox;
+
     GAABB3 bbox;
     bbox.invalidate();
 
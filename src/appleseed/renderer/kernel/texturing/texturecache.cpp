@@ -0,0 +1,137 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "texturecache.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <cassert>
+
+using namespace foundation;
+
+namespace renderer
+{
+
+//
+// TextureCache class implementation.
+//
+
+namespace
+{
+    // Grow the cache when it misses more often than this during an adaptation period.
+    const double GrowMissRate = 0.02;
+
+    // Shrink the cache when it misses less often than this during an adaptation period.
+    const double ShrinkMissRate = 0.001;
+}
+
+TextureCache::TextureCache(TextureStore& store)
+  : m_store(store)
+  , m_tile_record_swapper(store)
+  , m_tile_cache(m_tile_key_hasher, m_tile_record_swapper, TileKey::invalid())
+  , m_line_count(InitialLineCount)
+  , m_lookup_count(0)
+  , m_period_miss_count(0)
+  , m_skip_period(false)
+  , m_grow_count(0)
+  , m_shrink_count(0)
+{
+    m_tile_key_hasher.m_line_mask = m_line_count - 1;
+    m_store.reserve_thread_cache_lines(m_line_count);
+    m_line_counts.insert(m_line_count);
+}
+
+TextureCache::~TextureCache()
+{
+    m_tile_cache.flush();
+    m_store.release_thread_cache_lines(m_line_count);
+}
+
+StatisticsVector TextureCache::get_statistics() const
+{
+    Statistics stats = make_single_stage_cache_stats(m_tile_cache);
+    stats.insert("cache lines", m_line_counts);
+    stats.insert("grown", m_grow_count);
+    stats.insert("shrunk", m_shrink_count);
+
+    return StatisticsVector::make("texture cache statistics", stats);
+}
+
+void TextureCache::adapt()
+{
+    m_lookup_count = 0;
+
+    const uint64 miss_count = m_tile_cache.get_miss_count();
+    const double miss_rate =
+        static_cast<double>(miss_count - m_period_miss_count) / AdaptationPeriod;
+    m_period_miss_count = miss_count;
+
+    // Ignore the period following a resize, during which the cache was refilling.
+    if (m_skip_period)
+    {
+        m_skip_period = false;
+        return;
+    }
+
+    if (miss_rate > GrowMissRate && m_line_count < MaxLineCount)
+    {
+        // Grow the cache if the global budget allows it.
+        if (m_store.try_reserve_thread_cache_lines(m_line_count))
+        {
+            resize(2 * m_line_count);
+            ++m_grow_count;
+        }
+    }
+    else if (miss_rate < ShrinkMissRate && m_line_count > MinLineCount)
+    {
+        // Shrink the cache and return the lines to the global budget.
+        m_store.release_thread_cache_lines(m_line_count / 2);
+        resize(m_line_count / 2);
+        ++m_shrink_count;
+    }
+
+    m_line_counts.insert(m_line_count);
+}
+
+void TextureCache::resize(const size_t line_count)
+{
+    assert(is_pow2(line_count));
+    assert(line_count >= MinLineCount && line_count <= MaxLineCount);
+
+    // Keys map to different cache lines once the mask changes.
+    m_tile_cache.flush();
+
+    m_line_count = line_count;
+    m_tile_key_hasher.m_line_mask = line_count - 1;
+    m_skip_period = true;
+}
+
+}   // namespace renderer
@@ -36,6 +36,7 @@
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/hash.h"
+#include "foundation/math/population.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/cache.h"
 #include "foundation/utility/statistics.h"
@@ -53,6 +54,11 @@ namespace renderer
 //
 // A thread-local cache of texture tiles.
 //
+// The number of cache lines in use adapts to the observed miss rate: the cache grows
+// when it misses often and shrinks when it almost never misses, within the limits of
+// a budget shared by all texture caches and held by the texture store. Resizing the
+// cache flushes it.
+//
 
 class TextureCache
   : public foundation::NonCopyable
@@ -61,12 +67,16 @@ class TextureCache
     // Constructor.
     explicit TextureCache(TextureStore& store);
 
-    // Get a tile from the cache.
+    // Destructor.
+    ~TextureCache();
+
+    // Get a tile of a given MIP level from the cache.
     foundation::Tile& get(
         const foundation::UniqueID  assembly_uid,
         const foundation::UniqueID  texture_uid,
         const size_t                tile_x,
-        const size_t                tile_y);
+        const size_t                tile_y,
+        const size_t                level = 0);
 
     // Retrieve performance statistics.
     foundation::StatisticsVector get_statistics() const;
@@ -81,6 +91,9 @@ class TextureCache
     struct TileKeyHasher
       : public foundation::NonCopyable
     {
+        // Mask restricting hashes to the cache lines in use.
+        size_t m_line_mask;
+
         // Hash a key into an integer.
         size_t operator()(const TileKey& key) const;
     };
@@ -102,18 +115,40 @@ class TextureCache
         TextureStore& m_store;
     };
 
+    enum
+    {
+        MinLineCount = 64,              // minimum number of cache lines in use
+        InitialLineCount = 512,         // initial number of cache lines in use
+        MaxLineCount = 2048,            // maximum number of cache lines in use
+        AdaptationPeriod = 16 * 1024    // number of lookups between two adaptations
+    };
+
     typedef foundation::SACache<
         TileKey,
         TileKeyHasher,
         TileRecordPtr,
         TileRecordSwapper,
-        512,                // number of cache lines
+        MaxLineCount,       // number of cache lines
         4                   // number of ways
     > TileCache;
 
+    TextureStore&           m_store;
     TileKeyHasher           m_tile_key_hasher;
     TileRecordSwapper       m_tile_record_swapper;
     TileCache               m_tile_cache;
+    size_t                  m_line_count;
+    size_t                  m_lookup_count;
+    foundation::uint64      m_period_miss_count;
+    bool                    m_skip_period;
+    foundation::uint64      m_grow_count;
+    foundation::uint64      m_shrink_count;
+    foundation::Population<foundation::uint64> m_line_counts;
+
+    // Grow or shrink the cache based on the miss rate of the last adaptation period.
+    void adapt();
+
+    // Flush the cache and change the number of cache lines in use.
+    void resize(const size_t line_count);
 };
 
 
@@ -121,28 +156,18 @@ class TextureCache
 //  TextureCache class implementation.
 //
 
-inline TextureCache::TextureCache(TextureStore& store)
-  : m_tile_record_swapper(store)
-  , m_tile_cache(m_tile_key_hasher, m_tile_record_swapper, TileKey::invalid())
-{
-}
-
 inline foundation::Tile& TextureCache::get(
     const foundation::UniqueID      assembly_uid,
     const foundation::UniqueID      texture_uid,
     const size_t                    tile_x,
-    const size_t                    tile_y)
+    const size_t                    tile_y,
+    const size_t                    level)
 {
-    const TileKey key(assembly_uid, texture_uid, tile_x, tile_y);
-    return *m_tile_cache.get(key)->m_tile;
-}
+    if (++m_lookup_count == AdaptationPeriod)
+        adapt();
 
-inline foundation::StatisticsVector TextureCache::get_statistics() const
-{
-    return
-        foundation::StatisticsVector::make(
-            "texture cache statistics",
-            foundation::make_single_stage_cache_stats(m_tile_cache));
+    const TileKey key(assembly_uid, texture_uid, tile_x, tile_y, level);
+    return *m_tile_cache.get(key)->m_tile;
 }
 
 inline foundation::uint64 TextureCache::get_hit_count() const
@@ -166,7 +191,8 @@ inline size_t TextureCache::TileKeyHasher::operator()(const TileKey& key) const
         foundation::mix_uint32(
             static_cast<foundation::uint32>(key.m_assembly_uid),
             static_cast<foundation::uint32>(key.m_texture_uid),
-            static_cast<foundation::uint32>(key.m_tile_xy));
+            static_cast<foundation::uint32>(key.m_tile_xy),
+            static_cast<foundation::uint32>(key.m_level)) & m_line_mask;
 }
 
 
@@ -38,19 +38,34 @@
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
 #include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
+#include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/compiler.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
+#include "foundation/platform/timers.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/memoryaccounting.h"
+#include "foundation/utility/sharedfilecache.h"
+#include "foundation/utility/siphash.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
 #include <algorithm>
+#include <cstring>
+#include <ostream>
 #include <string>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -62,20 +77,325 @@ namespace renderer
 // TextureStore class implementation.
 //
 
+//
+// A job that prefetches the tiles adjacent to a given tile.
+//
+
+class TextureStore::PrefetchJob
+  : public IJob
+{
+  public:
+    PrefetchJob(
+        TextureStore&       store,
+        const TileKey&      key)
+      : m_store(store)
+      , m_key(key)
+    {
+    }
+
+    virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+    {
+        m_store.prefetch_neighbors(m_key);
+    }
+
+  private:
+    TextureStore&           m_store;
+    const TileKey           m_key;
+};
+
+namespace
+{
+    // Maximum number of pending prefetch jobs. Hints are dropped beyond this number.
+    const size_t MaxPrefetchJobCount = 256;
+}
+
+namespace
+{
+    typedef pair<TextureStore::TextureID, TextureStore::TextureStats> TextureStatsEntry;
+
+    // Order textures by decreasing stall time, then by decreasing amount of data read.
+    struct CostlierTextureStats
+    {
+        bool operator()(const TextureStatsEntry& lhs, const TextureStatsEntry& rhs) const
+        {
+            return
+                lhs.second.m_stall_time == rhs.second.m_stall_time
+                    ? lhs.second.m_bytes_read > rhs.second.m_bytes_read
+                    : lhs.second.m_stall_time > rhs.second.m_stall_time;
+        }
+    };
+
+    // Maximum number of textures in the statistics returned by TextureStore::get_statistics().
+    const size_t MaxReportedTextureCount = 10;
+}
+
 TextureStore::TextureStore(
     const Scene&        scene,
     const ParamArray&   params)
-  : m_tile_swapper(scene, params)
-  , m_tile_cache(m_tile_key_hasher, m_tile_swapper)
+  : m_tile_swapper(*this, scene, params)
+  , m_thread_cache_line_budget(params.get_optional<size_t>("thread_cache_budget", 16 * 1024))
+  , m_thread_cache_line_count(0)
+{
+    for (size_t i = 0; i < ShardCount; ++i)
+        m_shards[i] = new Shard(m_tile_key_hasher, m_tile_swapper);
+
+    const size_t prefetch_thread_count = params.get_optional<size_t>("prefetch_thread_count", 0);
+
+    if (prefetch_thread_count > 0)
+    {
+        m_prefetch_job_queue.reset(new JobQueue());
+        m_prefetch_job_manager.reset(
+            new JobManager(
+                global_logger(),
+                *m_prefetch_job_queue,
+                prefetch_thread_count,
+                JobManager::KeepRunningOnEmptyQueue | JobManager::KeepRunningOnJobFailure));
+        m_prefetch_job_manager->start();
+    }
+}
+
+TextureStore::~TextureStore()
+{
+    // Stop prefetching before destroying the shards.
+    if (m_prefetch_job_manager.get())
+    {
+        m_prefetch_job_queue->clear_scheduled_jobs();
+        m_prefetch_job_manager->stop();
+        m_prefetch_job_manager.reset();
+        m_prefetch_job_queue.reset();
+    }
+
+    for (size_t i = 0; i < ShardCount; ++i)
+        delete m_shards[i];
+}
+
+void TextureStore::wait_for_tile(Shard& shard, const TileKey& key, TileRecord& record)
+{
+    Stopwatch<DefaultWallclockTimer> stopwatch(0);
+    stopwatch.start();
+
+    while (true)
+    {
+        const uint32 state = atomic_read(&record.m_state);
+
+        if (state == TileRecord::Ready)
+            break;
+
+        // Load the tile ourselves if no other thread is loading it.
+        if (state == TileRecord::Pending &&
+            atomic_cas(&record.m_state, TileRecord::Pending, TileRecord::Loading) == TileRecord::Pending)
+        {
+            load_tile(shard, key, record);
+
+            // Hint the prefetcher about the neighbors of the missed tile.
+            if (m_prefetch_job_queue.get() &&
+                m_prefetch_job_queue->get_scheduled_job_count() < MaxPrefetchJobCount)
+                m_prefetch_job_queue->schedule(new PrefetchJob(*this, key));
+
+            break;
+        }
+
+        // Wait for the thread loading the tile.
+        boost::mutex::scoped_lock lock(shard.m_loading_mutex);
+        while (atomic_read(&record.m_state) == TileRecord::Loading)
+            shard.m_loading_event.wait(lock);
+    }
+
+    stopwatch.measure();
+    m_tile_swapper.record_stall_time(key, stopwatch.get_seconds());
+}
+
+void TextureStore::load_tile(Shard& shard, const TileKey& key, TileRecord& record)
+{
+    assert(atomic_read(&record.m_state) == TileRecord::Loading);
+
+    try
+    {
+        m_tile_swapper.load_tile(key, record);
+    }
+    catch (...)
+    {
+        // Let another thread retry loading the tile.
+        {
+            boost::mutex::scoped_lock lock(shard.m_loading_mutex);
+            atomic_write(&record.m_state, TileRecord::Pending);
+        }
+
+        shard.m_loading_event.notify_all();
+        throw;
+    }
+
+    {
+        boost::mutex::scoped_lock lock(shard.m_loading_mutex);
+        atomic_write(&record.m_state, TileRecord::Ready);
+    }
+
+    shard.m_loading_event.notify_all();
+}
+
+void TextureStore::prefetch(const TileKey& key)
+{
+    Shard& shard = get_shard(key);
+    TileRecord* record;
+
+    {
+        boost::mutex::scoped_lock lock(shard.m_mutex);
+
+        if (shard.m_tile_cache.contains(key))
+            return;
+
+        // Own the record while loading it so that it doesn't get evicted.
+        record = &shard.m_tile_cache.get(key);
+        atomic_inc(&record->m_owners);
+    }
+
+    if (atomic_cas(&record->m_state, TileRecord::Pending, TileRecord::Loading) == TileRecord::Pending)
+    {
+        try
+        {
+            load_tile(shard, key, *record);
+        }
+        catch (const exception& e)
+        {
+            RENDERER_LOG_DEBUG("failed to prefetch texture tile: %s", e.what());
+        }
+    }
+
+    release(*record);
+}
+
+void TextureStore::prefetch_neighbors(const TileKey& key)
 {
+    size_t count_x, count_y;
+    m_tile_swapper.get_tile_counts(key, count_x, count_y);
+
+    const size_t tile_x = key.get_tile_x();
+    const size_t tile_y = key.get_tile_y();
+    const size_t level = key.get_level();
+
+    if (tile_x > 0)
+        prefetch(TileKey(key.m_assembly_uid, key.m_texture_uid, tile_x - 1, tile_y, level));
+    if (tile_x + 1 < count_x)
+        prefetch(TileKey(key.m_assembly_uid, key.m_texture_uid, tile_x + 1, tile_y, level));
+    if (tile_y > 0)
+        prefetch(TileKey(key.m_assembly_uid, key.m_texture_uid, tile_x, tile_y - 1, level));
+    if (tile_y + 1 < count_y)
+        prefetch(TileKey(key.m_assembly_uid, key.m_texture_uid, tile_x, tile_y + 1, level));
+}
+
+namespace
+{
+    // Combined cache statistics of all the shards of the store.
+    struct CombinedCacheStats
+    {
+        uint64  m_hit_count;
+        uint64  m_miss_count;
+
+        uint64 get_hit_count() const { return m_hit_count; }
+        uint64 get_miss_count() const { return m_miss_count; }
+    };
+}
+
+void TextureStore::reserve_thread_cache_lines(const size_t count)
+{
+    m_thread_cache_line_count.fetch_add(count);
+}
+
+bool TextureStore::try_reserve_thread_cache_lines(const size_t count)
+{
+    size_t line_count = m_thread_cache_line_count.load();
+
+    do
+    {
+        if (line_count + count > m_thread_cache_line_budget)
+            return false;
+    } while (!m_thread_cache_line_count.compare_exchange_weak(line_count, line_count + count));
+
+    return true;
+}
+
+void TextureStore::release_thread_cache_lines(const size_t count)
+{
+    assert(m_thread_cache_line_count.load() >= count);
+    m_thread_cache_line_count.fetch_sub(count);
+}
+
+void TextureStore::set_external_cache(auto_ptr<IExternalCache> external_cache)
+{
+    m_tile_swapper.set_external_cache(external_cache);
+}
+
+void TextureStore::get_lookup_counts(
+    uint64&             hit_count,
+    uint64&             miss_count) const
+{
+    hit_count = 0;
+    miss_count = 0;
+
+    for (size_t i = 0; i < ShardCount; ++i)
+    {
+        hit_count += m_shards[i]->m_tile_cache.get_hit_count();
+        miss_count += m_shards[i]->m_tile_cache.get_miss_count();
+    }
 }
 
 StatisticsVector TextureStore::get_statistics() const
 {
-    Statistics stats = make_single_stage_cache_stats(m_tile_cache);
+    CombinedCacheStats combined;
+    get_lookup_counts(combined.m_hit_count, combined.m_miss_count);
+
+    Statistics stats = make_single_stage_cache_stats(combined);
+    stats.insert("shards", static_cast<uint64>(ShardCount));
     stats.insert_size("peak size", m_tile_swapper.get_peak_memory_size());
+    if (m_tile_swapper.has_external_cache())
+        stats.insert_size("shared size", m_tile_swapper.get_external_memory_size());
+
+    StatisticsVector vec = StatisticsVector::make("texture store statistics", stats);
+
+    // Report the textures that stalled the renderer the most.
+    const TextureStatsMap texture_stats = m_tile_swapper.get_texture_stats();
+    vector<TextureStatsEntry> entries(texture_stats.begin(), texture_stats.end());
+    sort(entries.begin(), entries.end(), CostlierTextureStats());
+
+    const size_t reported_count = min(entries.size(), MaxReportedTextureCount);
+
+    for (size_t i = 0; i < reported_count; ++i)
+    {
+        const TextureStats& ts = entries[i].second;
+
+        Statistics entry_stats;
+        entry_stats.insert("tile loads", ts.m_load_count);
+        entry_stats.insert("tile evictions", ts.m_unload_count);
+        entry_stats.insert_size("bytes read", ts.m_bytes_read);
+        entry_stats.insert_time("stall time", ts.m_stall_time);
 
-    return StatisticsVector::make("texture store statistics", stats);
+        vec.insert(
+            "texture " + m_tile_swapper.get_texture_path(entries[i].first),
+            entry_stats);
+    }
+
+    return vec;
+}
+
+void TextureStore::write_texture_statistics(ostream& output) const
+{
+    const TextureStatsMap texture_stats = m_tile_swapper.get_texture_stats();
+    vector<TextureStatsEntry> entries(texture_stats.begin(), texture_stats.end());
+    sort(entries.begin(), entries.end(), CostlierTextureStats());
+
+    output << "texture,tile_loads,tile_evictions,bytes_read,stall_time" << endl;
+
+    for (const_each<vector<TextureStatsEntry> > i = entries; i; ++i)
+    {
+        const TextureStats& ts = i->second;
+
+        output
+            << '"' << replace(m_tile_swapper.get_texture_path(i->first), "\"", "\"\"") << '"' << ','
+            << ts.m_load_count << ','
+            << ts.m_unload_count << ','
+            << ts.m_bytes_read << ','
+            << ts.m_stall_time << endl;
+    }
 }
 
 Dictionary TextureStore::get_params_metadata()
@@ -91,16 +411,86 @@ Dictionary TextureStore::get_params_metadata()
             .insert("label", "Texture Cache Size")
             .insert("help", "Texture cache size in bytes"));
 
+    metadata.dictionaries().insert(
+        "prefetch_thread_count",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "0")
+            .insert("label", "Prefetch Threads")
+            .insert("help", "Number of background threads loading the texture tiles adjacent to missed tiles"));
+
+    metadata.dictionaries().insert(
+        "thread_cache_budget",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "16384")
+            .insert("label", "Thread Cache Budget")
+            .insert("help", "Total number of cache lines shared by the per-thread texture caches as they grow and shrink"));
+
+    metadata.dictionaries().insert(
+        "share_budget_with_oiio",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Share Budget With OIIO")
+            .insert("help", "Count the memory used by the OIIO texture cache of OSL shaders against the texture cache size"));
+
+    metadata.dictionaries().insert(
+        "statistics_file",
+        Dictionary()
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("label", "Texture Statistics File")
+            .insert("help", "If set, per-texture cache statistics are written to this file in CSV format at the end of the render"));
+
+    metadata.dictionaries().insert(
+        "shared_cache_directory",
+        Dictionary()
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("label", "Shared Cache Directory")
+            .insert("help", "If set, converted texture tiles are shared with the other renders of this machine through files in this node-local directory"));
+
     return metadata;
 }
 
 
+//
+// TextureStore::Shard class implementation.
+//
+
+TextureStore::Shard::Shard(
+    TileKeyHasher&  tile_key_hasher,
+    TileSwapper&    tile_swapper)
+  : m_tile_cache(tile_key_hasher, tile_swapper)
+{
+}
+
+
 //
 // TextureStore::TileSwapper class implementation.
 //
 
 namespace
 {
+    // Lookup table converting 8-bit sRGB values to 8-bit linear RGB values,
+    // rounding exactly like the generic float -> uint8 pixel conversion.
+    struct SRGBToLinearRGBTable
+    {
+        uint8 m_values[256];
+
+        SRGBToLinearRGBTable()
+        {
+            for (size_t i = 0; i < 256; ++i)
+            {
+                const float linear_rgb = srgb_to_linear_rgb(static_cast<float>(i) * (1.0f / 255));
+                m_values[i] = truncate<uint8>(clamp(linear_rgb * 256.0f, 0.0f, 255.0f));
+            }
+        }
+    };
+
+    const SRGBToLinearRGBTable g_srgb_to_linear_rgb_table;
+
     // Convert a tile from the sRGB color space to the linear RGB color space.
     void convert_tile_srgb_to_linear_rgb(Tile& tile)
     {
@@ -109,7 +499,22 @@ namespace
 
         assert(channel_count == 3 || channel_count == 4);
 
-        if (channel_count == 3)
+        if (tile.get_pixel_format() == PixelFormatUInt8)
+        {
+            // Most sRGB textures are 8-bit: use a table lookup instead of evaluating
+            // the transfer function for every channel of every pixel.
+            const uint8* APPLESEED_RESTRICT table = g_srgb_to_linear_rgb_table.m_values;
+            uint8* APPLESEED_RESTRICT ptr = tile.get_storage();
+
+            for (size_t i = 0; i < pixel_count; ++i)
+            {
+                ptr[0] = table[ptr[0]];
+                ptr[1] = table[ptr[1]];
+                ptr[2] = table[ptr[2]];
+                ptr += channel_count;
+            }
+        }
+        else if (channel_count == 3)
         {
             for (size_t i = 0; i < pixel_count; ++i)
             {
@@ -147,6 +552,22 @@ namespace
                 tile.set_pixel(i, ciexyz_to_linear_rgb(color));
             }
         }
+#ifdef APPLESEED_USE_SSE
+        else if (tile.get_pixel_format() == PixelFormatFloat)
+        {
+            float* ptr = reinterpret_cast<float*>(tile.get_storage());
+
+            for (size_t i = 0; i < pixel_count; ++i)
+            {
+                APPLESEED_SIMD4_ALIGN float color[4] = { ptr[0], ptr[1], ptr[2], ptr[3] };
+                _mm_store_ps(color, ciexyz_to_linear_rgb(_mm_load_ps(color)));
+                ptr[0] = color[0];
+                ptr[1] = color[1];
+                ptr[2] = color[2];
+                ptr += 4;
+            }
+        }
+#endif
         else
         {
             for (size_t i = 0; i < pixel_count; ++i)
@@ -158,123 +579,455 @@ namespace
             }
         }
     }
+
+    // Retrieve a pixel of a tile with three or four channels.
+    Color4f get_tile_pixel(const Tile& tile, const size_t x, const size_t y)
+    {
+        if (tile.get_channel_count() == 3)
+        {
+            Color3f rgb;
+            tile.get_pixel(x, y, rgb);
+            return Color4f(rgb[0], rgb[1], rgb[2], 1.0f);
+        }
+        else
+        {
+            Color4f rgba;
+            tile.get_pixel(x, y, rgba);
+            return rgba;
+        }
+    }
+
+    // Store a pixel into a tile with three or four channels.
+    void set_tile_pixel(Tile& tile, const size_t x, const size_t y, const Color4f& color)
+    {
+        if (tile.get_channel_count() == 3)
+            tile.set_pixel(x, y, color.rgb());
+        else tile.set_pixel(x, y, color);
+    }
+
+    // Release tiles acquired from a texture store when going out of scope.
+    template <typename Store, typename Record>
+    class ScopedTileRelease
+      : public NonCopyable
+    {
+      public:
+        explicit ScopedTileRelease(const Store& store)
+          : m_store(store)
+          , m_count(0)
+        {
+        }
+
+        ~ScopedTileRelease()
+        {
+            for (size_t i = 0; i < m_count; ++i)
+                m_store.release(*m_records[i]);
+        }
+
+        void add(Record& record)
+        {
+            assert(m_count < 4);
+            m_records[m_count++] = &record;
+        }
+
+      private:
+        const Store&    m_store;
+        Record*         m_records[4];
+        size_t          m_count;
+    };
+
+    // Header of the files of tiles stored in the shared cache. Its size keeps the pixels aligned.
+    struct SharedTileHeader
+    {
+        uint32  m_magic;
+        uint32  m_width;
+        uint32  m_height;
+        uint32  m_channel_count;
+        uint32  m_pixel_format;
+        uint32  m_padding[3];
+    };
+
+    const uint32 SharedTileMagic = 0x54534153;      // 'SAST'
 }
 
 TextureStore::TileSwapper::TileSwapper(
+    TextureStore&       store,
     const Scene&        scene,
     const ParamArray&   params)
-  : m_scene(scene)
+  : m_store(store)
+  , m_scene(scene)
   , m_params(params)
   , m_memory_size(0)
   , m_peak_memory_size(0)
+  , m_external_memory_size(0)
 {
     gather_assemblies(scene.assemblies());
+
+    const string shared_cache_directory = params.get_optional<string>("shared_cache_directory", "");
+
+    if (!shared_cache_directory.empty())
+    {
+        RENDERER_LOG_INFO("sharing texture tiles through directory %s.", shared_cache_directory.c_str());
+        m_shared_cache.reset(new SharedFileCache(shared_cache_directory.c_str()));
+    }
 }
 
 void TextureStore::TileSwapper::load(const TileKey& key, TileRecord& record)
 {
-    // Fetch the texture container.
-    const TextureContainer& textures =
-        key.m_assembly_uid == UniqueID(~0)
-            ? m_scene.textures()
-            : m_assemblies[key.m_assembly_uid]->textures();
+    // The tile is loaded outside of the cache lock, see TextureStore::wait_for_tile().
+    record.m_tile = 0;
+    record.m_tile_owned = false;
+    record.m_shared_view = 0;
+    record.m_owners = 0;
+    record.m_state = TileRecord::Pending;
+}
 
+void TextureStore::TileSwapper::load_tile(const TileKey& key, TileRecord& record)
+{
     // Fetch the texture.
-    Texture* texture = textures.get_by_uid(key.m_texture_uid);
+    Texture* texture = get_texture(key);
+
+    EventTraceScope trace_scope("texturing", "texture tile", texture->get_name());
 
     if (m_params.m_track_tile_loading)
     {
         RENDERER_LOG_DEBUG(
             "loading tile (" FMT_SIZE_T ", " FMT_SIZE_T ") "
-            "from texture \"%s\"...",
+            "of level " FMT_SIZE_T " from texture \"%s\"...",
             key.get_tile_x(),
             key.get_tile_y(),
+            key.get_level(),
             texture->get_path().c_str());
     }
 
-    // Load the tile.
-    record.m_tile = texture->load_tile(key.get_tile_x(), key.get_tile_y());
-    record.m_owners = 0;
+    // Identify the tile across processes if its texture can be shared.
+    uint64 shared_key;
+    const bool shared =
+        m_shared_cache.get() != 0 &&
+        texture->compute_shared_cache_key(shared_key);
 
-    // Convert the tile to the linear RGB color space.
-    switch (texture->get_color_space())
+    if (shared)
     {
-      case ColorSpaceLinearRGB:
-        break;
+        shared_key = siphash24(shared_key, static_cast<uint64>(key.m_tile_xy));
+        shared_key = siphash24(shared_key, static_cast<uint64>(key.m_level));
+        shared_key = siphash24(shared_key, static_cast<uint64>(texture->use_half_tile_storage()));
+    }
 
-      case ColorSpaceSRGB:
-        convert_tile_srgb_to_linear_rgb(*record.m_tile);
-        break;
+    // Map the tile from the shared cache, or load it and share it.
+    if (!shared || !load_shared_tile(shared_key, record))
+    {
+        load_texture_tile(*texture, key, record);
 
-      case ColorSpaceCIEXYZ:
-        convert_tile_ciexyz_to_linear_rgb(*record.m_tile);
-        break;
+        if (shared)
+            publish_shared_tile(shared_key, *record.m_tile);
+    }
 
-      assert_otherwise;
+    {
+        boost::mutex::scoped_lock lock(m_texture_stats_mutex);
+        ++get_texture_stats(key).m_load_count;
     }
 
+    // Poll the memory usage of the cache sharing our budget.
+    if (m_external_cache.get())
+        m_external_memory_size.store(m_external_cache->get_memory_size());
+
     // Track the amount of memory used by the tile cache.
-    m_memory_size += record.m_tile->get_memory_size();
-    m_peak_memory_size = max(m_peak_memory_size, m_memory_size);
+    const size_t tile_memory_size = record.m_tile->get_memory_size();
+    const size_t memory_size = m_memory_size.fetch_add(tile_memory_size) + tile_memory_size;
+    account_memory_allocation(MemoryTagTextures, tile_memory_size);
+    size_t peak_memory_size = m_peak_memory_size.load();
+    while (peak_memory_size < memory_size &&
+           !m_peak_memory_size.compare_exchange_weak(peak_memory_size, memory_size)) ;
 
     if (m_params.m_track_store_size)
     {
-        if (m_memory_size > m_params.m_memory_limit)
+        if (memory_size > m_params.m_memory_limit)
         {
             RENDERER_LOG_DEBUG(
                 "texture store size is %s, exceeding capacity %s by %s",
-                pretty_size(m_memory_size).c_str(),
+                pretty_size(memory_size).c_str(),
                 pretty_size(m_params.m_memory_limit).c_str(),
-                pretty_size(m_memory_size - m_params.m_memory_limit).c_str());
+                pretty_size(memory_size - m_params.m_memory_limit).c_str());
         }
         else
         {
             RENDERER_LOG_DEBUG(
                 "texture store size is %s, below capacity %s by %s",
-                pretty_size(m_memory_size).c_str(),
+                pretty_size(memory_size).c_str(),
                 pretty_size(m_params.m_memory_limit).c_str(),
-                pretty_size(m_params.m_memory_limit - m_memory_size).c_str());
+                pretty_size(m_params.m_memory_limit - memory_size).c_str());
+        }
+    }
+}
+
+void TextureStore::TileSwapper::load_texture_tile(Texture& texture, const TileKey& key, TileRecord& record)
+{
+    // Load the tile. Tiles of MIP levels are loaded from the texture if it provides them.
+    record.m_tile =
+        key.get_level() == 0
+            ? texture.load_tile(key.get_tile_x(), key.get_tile_y())
+            : texture.load_mip_tile(key.get_level(), key.get_tile_x(), key.get_tile_y());
+
+    record.m_tile_owned = key.get_level() > 0;
+
+    if (record.m_tile)
+    {
+        {
+            boost::mutex::scoped_lock lock(m_texture_stats_mutex);
+            get_texture_stats(key).m_bytes_read += record.m_tile->get_memory_size();
+        }
+
+        // Convert the tile to the linear RGB color space.
+        switch (texture.get_color_space())
+        {
+          case ColorSpaceLinearRGB:
+            break;
+
+          case ColorSpaceSRGB:
+            convert_tile_srgb_to_linear_rgb(*record.m_tile);
+            break;
+
+          case ColorSpaceCIEXYZ:
+            convert_tile_ciexyz_to_linear_rgb(*record.m_tile);
+            break;
+
+          assert_otherwise;
         }
     }
+    else
+    {
+        // Build the tile of this MIP level from the finer level; it is already in the linear RGB color space.
+        record.m_tile = build_mip_tile(texture, key);
+        record.m_tile_owned = true;
+    }
+
+    // Keep floating-point tiles as half floats if requested.
+    if (texture.use_half_tile_storage() &&
+        (record.m_tile->get_pixel_format() == PixelFormatFloat ||
+         record.m_tile->get_pixel_format() == PixelFormatDouble))
+    {
+        Tile* half_tile = new Tile(*record.m_tile, PixelFormatHalf);
+
+        if (record.m_tile_owned)
+            delete record.m_tile;
+        else texture.unload_tile(key.get_tile_x(), key.get_tile_y(), record.m_tile);
+
+        record.m_tile = half_tile;
+        record.m_tile_owned = true;
+    }
+}
+
+Tile* TextureStore::TileSwapper::build_mip_tile(Texture& texture, const TileKey& key)
+{
+    const size_t level = key.get_level();
+    assert(level > 0);
+
+    const CanvasProperties& props = texture.properties();
+
+    // Dimensions of this level and of the finer level.
+    const size_t level_width = get_mip_level_size(props.m_canvas_width, level);
+    const size_t level_height = get_mip_level_size(props.m_canvas_height, level);
+    const size_t finer_width = get_mip_level_size(props.m_canvas_width, level - 1);
+    const size_t finer_height = get_mip_level_size(props.m_canvas_height, level - 1);
+
+    // Origin and dimensions of this tile.
+    const size_t tile_x = key.get_tile_x();
+    const size_t tile_y = key.get_tile_y();
+    const size_t origin_x = tile_x * props.m_tile_width;
+    const size_t origin_y = tile_y * props.m_tile_height;
+    assert(origin_x < level_width);
+    assert(origin_y < level_height);
+    const size_t width = min(props.m_tile_width, level_width - origin_x);
+    const size_t height = min(props.m_tile_height, level_height - origin_y);
+
+    // Acquire the (up to) four tiles of the finer level covered by this tile from the store,
+    // so that they are cached and shared with the neighboring tiles of this level. They are
+    // already in the linear RGB color space.
+    ScopedTileRelease<TextureStore, TileRecord> release_children(m_store);
+    const Tile* children[2][2];
+    for (size_t cy = 0; cy < 2; ++cy)
+    {
+        for (size_t cx = 0; cx < 2; ++cx)
+        {
+            const size_t child_x = 2 * tile_x + cx;
+            const size_t child_y = 2 * tile_y + cy;
+
+            if (child_x * props.m_tile_width < finer_width &&
+                child_y * props.m_tile_height < finer_height)
+            {
+                TileRecord& child =
+                    m_store.acquire(
+                        TileKey(key.m_assembly_uid, key.m_texture_uid, child_x, child_y, level - 1));
+                release_children.add(child);
+                children[cy][cx] = child.m_tile;
+            }
+            else children[cy][cx] = 0;
+        }
+    }
+
+    assert(children[0][0]);
+
+    Tile* tile =
+        new Tile(
+            width,
+            height,
+            children[0][0]->get_channel_count(),
+            children[0][0]->get_pixel_format());
+
+    // Box-filter the texels of the finer level.
+    for (size_t y = 0; y < height; ++y)
+    {
+        for (size_t x = 0; x < width; ++x)
+        {
+            Color4f sum(0.0f);
+
+            for (size_t j = 0; j < 2; ++j)
+            {
+                for (size_t i = 0; i < 2; ++i)
+                {
+                    // Coordinates of the texel in the finer level, clamped to the canvas.
+                    const size_t fx = min(2 * (origin_x + x) + i, finer_width - 1);
+                    const size_t fy = min(2 * (origin_y + y) + j, finer_height - 1);
+
+                    const size_t child_x = fx / props.m_tile_width;
+                    const size_t child_y = fy / props.m_tile_height;
+                    const Tile* child = children[child_y - 2 * tile_y][child_x - 2 * tile_x];
+                    assert(child);
+
+                    sum +=
+                        get_tile_pixel(
+                            *child,
+                            fx - child_x * props.m_tile_width,
+                            fy - child_y * props.m_tile_height);
+                }
+            }
+
+            set_tile_pixel(*tile, x, y, 0.25f * sum);
+        }
+    }
+
+    return tile;
+}
+
+bool TextureStore::TileSwapper::load_shared_tile(const uint64 shared_key, TileRecord& record) const
+{
+    auto_ptr<SharedFileView> view(m_shared_cache->acquire(shared_key));
+    if (view.get() == 0 || view->get_size() < sizeof(SharedTileHeader))
+        return false;
+
+    const SharedTileHeader* header = static_cast<const SharedTileHeader*>(view->get_data());
+    if (header->m_magic != SharedTileMagic)
+        return false;
+
+    // The mapping is read-only: the tiles of the store are never modified once loaded.
+    uint8* pixels = const_cast<uint8*>(reinterpret_cast<const uint8*>(header + 1));
+
+    auto_ptr<Tile> tile(
+        new Tile(
+            header->m_width,
+            header->m_height,
+            header->m_channel_count,
+            static_cast<PixelFormat>(header->m_pixel_format),
+            pixels));
+
+    if (view->get_size() != sizeof(SharedTileHeader) + tile->get_size())
+        return false;
+
+    record.m_tile = tile.release();
+    record.m_tile_owned = true;
+    record.m_shared_view = view.release();
+
+    return true;
+}
+
+void TextureStore::TileSwapper::publish_shared_tile(const uint64 shared_key, const Tile& tile) const
+{
+    SharedTileHeader header;
+    header.m_magic = SharedTileMagic;
+    header.m_width = static_cast<uint32>(tile.get_width());
+    header.m_height = static_cast<uint32>(tile.get_height());
+    header.m_channel_count = static_cast<uint32>(tile.get_channel_count());
+    header.m_pixel_format = static_cast<uint32>(tile.get_pixel_format());
+    header.m_padding[0] = header.m_padding[1] = header.m_padding[2] = 0;
+
+    vector<uint8> data(sizeof(SharedTileHeader) + tile.get_size());
+    memcpy(&data[0], &header, sizeof(SharedTileHeader));
+    memcpy(&data[sizeof(SharedTileHeader)], tile.get_storage(), tile.get_size());
+
+    if (!m_shared_cache->publish(shared_key, &data[0], data.size()))
+        RENDERER_LOG_DEBUG("failed to publish texture tile to the shared cache.");
 }
 
 bool TextureStore::TileSwapper::unload(const TileKey& key, TileRecord& record)
 {
-    // Cannot unload tiles that are still in use.
+    // Cannot unload tiles that are still in use or being loaded.
     if (atomic_read(&record.m_owners) > 0)
         return false;
 
+    // Nothing to unload if the tile was never loaded.
+    if (record.m_tile == 0)
+        return true;
+
     // Track the amount of memory used by the tile cache.
     const size_t tile_memory_size = record.m_tile->get_memory_size();
-    assert(m_memory_size >= tile_memory_size);
-    m_memory_size -= tile_memory_size;
-
-    // Fetch the texture container.
-    const TextureContainer& textures =
-        key.m_assembly_uid == UniqueID(~0)
-            ? m_scene.textures()
-            : m_assemblies[key.m_assembly_uid]->textures();
+    assert(m_memory_size.load() >= tile_memory_size);
+    m_memory_size.fetch_sub(tile_memory_size);
+    account_memory_deallocation(MemoryTagTextures, tile_memory_size);
 
     // Fetch the texture.
-    Texture* texture = textures.get_by_uid(key.m_texture_uid);
+    Texture* texture = get_texture(key);
 
     if (m_params.m_track_tile_unloading)
     {
         RENDERER_LOG_DEBUG(
             "unloading tile (" FMT_SIZE_T ", " FMT_SIZE_T ") "
-            "from texture \"%s\"...",
+            "of level " FMT_SIZE_T " from texture \"%s\"...",
             key.get_tile_x(),
             key.get_tile_y(),
+            key.get_level(),
             texture->get_path().c_str());
     }
 
+    {
+        boost::mutex::scoped_lock lock(m_texture_stats_mutex);
+        ++get_texture_stats(key).m_unload_count;
+    }
+
     // Unload the tile.
-    texture->unload_tile(key.get_tile_x(), key.get_tile_y(), record.m_tile);
+    if (record.m_tile_owned)
+        delete record.m_tile;
+    else texture->unload_tile(key.get_tile_x(), key.get_tile_y(), record.m_tile);
+
+    // Unmap the pixels of a tile mapped from the shared cache.
+    delete record.m_shared_view;
+    record.m_shared_view = 0;
 
     // Successfully unloaded the tile.
     return true;
 }
 
+void TextureStore::TileSwapper::set_external_cache(auto_ptr<IExternalCache> external_cache)
+{
+    m_external_cache = external_cache;
+    m_external_memory_size.store(m_external_cache.get() ? m_external_cache->get_memory_size() : 0);
+}
+
+void TextureStore::TileSwapper::record_stall_time(const TileKey& key, const double seconds)
+{
+    boost::mutex::scoped_lock lock(m_texture_stats_mutex);
+    get_texture_stats(key).m_stall_time += seconds;
+}
+
+TextureStore::TextureStatsMap TextureStore::TileSwapper::get_texture_stats() const
+{
+    boost::mutex::scoped_lock lock(m_texture_stats_mutex);
+    return m_texture_stats;
+}
+
+string TextureStore::TileSwapper::get_texture_path(const TextureID& id) const
+{
+    return get_texture(TileKey(id.first, id.second, 0, 0))->get_path().c_str();
+}
+
 void TextureStore::TileSwapper::gather_assemblies(const AssemblyContainer& assemblies)
 {
     for (const_each<AssemblyContainer> i = assemblies; i; ++i)
@@ -284,6 +1037,50 @@ void TextureStore::TileSwapper::gather_assemblies(const AssemblyContainer& assem
     }
 }
 
+void TextureStore::TileSwapper::get_tile_counts(const TileKey& key, size_t& count_x, size_t& count_y) const
+{
+    const CanvasProperties& props = get_texture(key)->properties();
+
+    const size_t level_width = get_mip_level_size(props.m_canvas_width, key.get_level());
+    const size_t level_height = get_mip_level_size(props.m_canvas_height, key.get_level());
+
+    count_x = (level_width + props.m_tile_width - 1) / props.m_tile_width;
+    count_y = (level_height + props.m_tile_height - 1) / props.m_tile_height;
+}
+
+Texture* TextureStore::TileSwapper::get_texture(const TileKey& key) const
+{
+    // Fetch the texture container.
+    if (key.m_assembly_uid == UniqueID(~0))
+        return m_scene.textures().get_by_uid(key.m_texture_uid);
+
+    // The assembly map is only read once the store is constructed,
+    // hence it can safely be accessed concurrently from all shards.
+    const AssemblyMap::const_iterator i = m_assemblies.find(key.m_assembly_uid);
+    assert(i != m_assemblies.end());
+
+    return i->second->textures().get_by_uid(key.m_texture_uid);
+}
+
+TextureStore::TextureStats& TextureStore::TileSwapper::get_texture_stats(const TileKey& key)
+{
+    // The caller must hold m_texture_stats_mutex.
+    return m_texture_stats[TextureID(key.m_assembly_uid, key.m_texture_uid)];
+}
+
+
+//
+// TextureStore::TextureStats class implementation.
+//
+
+TextureStore::TextureStats::TextureStats()
+  : m_load_count(0)
+  , m_unload_count(0)
+  , m_bytes_read(0)
+  , m_stall_time(0.0)
+{
+}
+
 
 //
 // TextureStore::TileSwapper::Parameters class implementation.
@@ -42,17 +42,28 @@
 #include "foundation/utility/cache.h"
 #include "foundation/utility/uid.h"
 
+// Boost headers.
+#include "boost/thread/condition_variable.hpp"
+
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <iosfwd>
 #include <map>
+#include <memory>
+#include <utility>
 
 // Forward declarations.
 namespace foundation    { class Dictionary; }
+namespace foundation    { class JobManager; }
+namespace foundation    { class JobQueue; }
+namespace foundation    { class SharedFileCache; }
+namespace foundation    { class SharedFileView; }
 namespace foundation    { class StatisticsVector; }
 namespace foundation    { class Tile; }
 namespace renderer      { class ParamArray; }
 namespace renderer      { class Scene; }
+namespace renderer      { class Texture; }
 
 namespace renderer
 {
@@ -60,17 +71,36 @@ namespace renderer
 //
 // A shared store for texture tiles (the backend of the thread-local texture cache).
 //
+// The store is split into a number of independently locked shards, each with its own
+// LRU cache, so that concurrent cache misses from different render threads rarely
+// contend for the same lock. All shards share a single memory budget: a shard evicts
+// its least recently used tiles whenever the total size of the store exceeds it.
+//
+// Tiles are loaded outside of the shard locks: a cache miss first inserts a pending
+// record, then the tile is loaded by the first thread that needs it, while other
+// threads needing the same tile wait for this tile only. Optionally, a pool of
+// background threads prefetches the tiles adjacent to each missed tile.
+//
+// The memory budget may be shared with another texture cache (e.g. the OIIO texture
+// system used by OSL shaders): its memory usage then counts against the budget.
+//
+// Optionally, converted tiles are published to a node-local shared file cache and
+// memory-mapped from it by other renders, so that concurrent renders of the same
+// textures on a machine load and convert each tile only once and share its memory.
+//
 
 class TextureStore
   : public foundation::NonCopyable
 {
   public:
     // This structure uniquely identifies a texture tile in a scene.
+    // Level 0 is the base level of the texture, level n + 1 has half the resolution of level n.
     struct TileKey
     {
         foundation::UniqueID    m_assembly_uid;
         foundation::UniqueID    m_texture_uid;
         foundation::uint32      m_tile_xy;
+        foundation::uint32      m_level;
 
         TileKey();
 
@@ -78,7 +108,8 @@ class TextureStore
             const foundation::UniqueID  assembly_uid,
             const foundation::UniqueID  texture_uid,
             const size_t                tile_x,
-            const size_t                tile_y);
+            const size_t                tile_y,
+            const size_t                level = 0);
 
         TileKey(
             const foundation::UniqueID  assembly_uid,
@@ -89,6 +120,7 @@ class TextureStore
 
         size_t get_tile_x() const;
         size_t get_tile_y() const;
+        size_t get_level() const;
 
         // Return an invalid key.
         static TileKey invalid();
@@ -101,8 +133,45 @@ class TextureStore
 
     struct TileRecord
     {
+        enum State
+        {
+            Pending,                                // the tile is not loaded yet
+            Loading,                                // the tile is being loaded
+            Ready                                   // the tile is loaded
+        };
+
         foundation::Tile*           m_tile;
+        bool                        m_tile_owned;   // true if the tile is owned by the store rather than by the texture
+        foundation::SharedFileView* m_shared_view;  // if not null, the pixels of the tile are mapped from this file
         volatile foundation::uint32 m_owners;
+        volatile foundation::uint32 m_state;        // one of the State values
+    };
+
+    // Cache statistics of a single texture.
+    struct TextureStats
+    {
+        foundation::uint64          m_load_count;
+        foundation::uint64          m_unload_count;
+        foundation::uint64          m_bytes_read;
+        double                      m_stall_time;   // in seconds
+
+        TextureStats();
+    };
+
+    // Texture statistics indexed by assembly and texture UIDs.
+    typedef std::pair<foundation::UniqueID, foundation::UniqueID> TextureID;
+    typedef std::map<TextureID, TextureStats> TextureStatsMap;
+
+    // Interface of a texture cache sharing the memory budget of the store.
+    class IExternalCache
+      : public foundation::NonCopyable
+    {
+      public:
+        // Destructor.
+        virtual ~IExternalCache() {}
+
+        // Return the current memory size in bytes of the cache.
+        virtual size_t get_memory_size() const = 0;
     };
 
     // Constructor.
@@ -110,18 +179,50 @@ class TextureStore
         const Scene&        scene,
         const ParamArray&   params = ParamArray());
 
+    // Destructor.
+    ~TextureStore();
+
     // Acquire an element from the cache. Thread-safe.
     TileRecord& acquire(const TileKey& key);
 
     // Release a previously-acquired element. Thread-safe.
     void release(TileRecord& record) const;
 
-    // Retrieve performance statistics.
+    // Account for the cache lines of the per-thread texture caches against a global budget.
+    // reserve_thread_cache_lines() always succeeds, try_reserve_thread_cache_lines() fails
+    // if the budget would be exceeded.
+    void reserve_thread_cache_lines(const size_t count);
+    bool try_reserve_thread_cache_lines(const size_t count);
+    void release_thread_cache_lines(const size_t count);
+
+    // Share the memory budget of the store with another texture cache.
+    // Must be called before the store is used. The store takes ownership of the object.
+    void set_external_cache(std::auto_ptr<IExternalCache> external_cache);
+
+    // Return the current memory size in bytes of the tiles held by the store. Thread-safe.
+    size_t get_memory_size() const;
+
+    // Return the number of tile lookups that hit or missed the store. Thread-safe,
+    // but only approximate while the store is being used.
+    void get_lookup_counts(
+        foundation::uint64&         hit_count,
+        foundation::uint64&         miss_count) const;
+
+    // Retrieve performance statistics, including those of the most expensive textures.
     foundation::StatisticsVector get_statistics() const;
 
+    // Write the cache statistics of every texture in CSV format.
+    void write_texture_statistics(std::ostream& output) const;
+
     // Return the metadata of the texture store parameters.
     static foundation::Dictionary get_params_metadata();
 
+    // Return the width or height of a given MIP level, given the width or height of the base level.
+    static size_t get_mip_level_size(const size_t base_size, const size_t level);
+
+    // Return the number of MIP levels of a texture, including the base level.
+    static size_t get_mip_level_count(const size_t base_width, const size_t base_height);
+
   private:
     struct TileKeyHasher
     {
@@ -132,23 +233,51 @@ class TextureStore
       : public foundation::NonCopyable
     {
       public:
-        // Constructor.
+        // Constructor. Tiles of MIP levels are built from tiles of finer levels acquired from the store.
         TileSwapper(
+            TextureStore&       store,
             const Scene&        scene,
             const ParamArray&   params);
 
-        // Load a cache line.
+        // Load a cache line. The record is left pending, the tile is not loaded yet.
         void load(const TileKey& key, TileRecord& record);
 
+        // Load the tile of a pending cache line.
+        void load_tile(const TileKey& key, TileRecord& record);
+
+        // Retrieve the number of tiles of the MIP level of a given tile.
+        void get_tile_counts(const TileKey& key, size_t& count_x, size_t& count_y) const;
+
         // Unload a cache line.
         bool unload(const TileKey& key, TileRecord& record);
 
         // Return true if the cache is full, false otherwise.
         bool is_full(const size_t element_count) const;
 
-        // Return the peak memory size in bytes of the tile cache.
+        // Return the current and peak memory size in bytes of the tile cache.
+        size_t get_memory_size() const;
         size_t get_peak_memory_size() const;
 
+        // Share the memory budget with another texture cache.
+        void set_external_cache(std::auto_ptr<IExternalCache> external_cache);
+
+        // Return true if the memory budget is shared with another texture cache.
+        bool has_external_cache() const;
+
+        // Return the memory size in bytes of the external cache when it was last polled.
+        size_t get_external_memory_size() const;
+
+        // Accumulate the time a thread spent waiting for a tile of a given texture.
+        void record_stall_time(const TileKey& key, const double seconds);
+
+        // Return a snapshot of the statistics of all textures.
+        TextureStatsMap get_texture_stats() const;
+
+        // Return the path of a given texture.
+        std::string get_texture_path(const TextureID& id) const;
+
+        // The methods of this class may be called concurrently from different shards.
+
       private:
         struct Parameters
         {
@@ -162,13 +291,35 @@ class TextureStore
 
         typedef std::map<foundation::UniqueID, const Assembly*> AssemblyMap;
 
-        const Scene&        m_scene;
-        const Parameters    m_params;
-        size_t              m_memory_size;
-        size_t              m_peak_memory_size;
-        AssemblyMap         m_assemblies;
+        TextureStore&               m_store;
+        const Scene&                m_scene;
+        const Parameters            m_params;
+        std::auto_ptr<foundation::SharedFileCache> m_shared_cache;
+        boost::atomic<size_t>       m_memory_size;
+        boost::atomic<size_t>       m_peak_memory_size;
+        std::auto_ptr<IExternalCache> m_external_cache;
+        boost::atomic<size_t>       m_external_memory_size;
+        AssemblyMap                 m_assemblies;
+        mutable boost::mutex        m_texture_stats_mutex;
+        TextureStatsMap             m_texture_stats;
 
         void gather_assemblies(const AssemblyContainer& assemblies);
+
+        // Load a tile from its texture and convert it to its storage format.
+        void load_texture_tile(Texture& texture, const TileKey& key, TileRecord& record);
+
+        // Build a tile of a MIP level (level > 0) by box-filtering the tiles of the next finer level.
+        foundation::Tile* build_mip_tile(Texture& texture, const TileKey& key);
+
+        // Map a tile from the shared cache. Return false if the cache does not hold the tile.
+        bool load_shared_tile(const foundation::uint64 shared_key, TileRecord& record) const;
+
+        // Publish a tile to the shared cache.
+        void publish_shared_tile(const foundation::uint64 shared_key, const foundation::Tile& tile) const;
+
+        Texture* get_texture(const TileKey& key) const;
+
+        TextureStats& get_texture_stats(const TileKey& key);
     };
 
     typedef foundation::LRUCache<
@@ -178,10 +329,46 @@ class TextureStore
         TileSwapper
     > TileCache;
 
-    boost::mutex            m_mutex;
-    TileKeyHasher           m_tile_key_hasher;
-    TileSwapper             m_tile_swapper;
-    TileCache               m_tile_cache;
+    struct Shard
+      : public foundation::NonCopyable
+    {
+        boost::mutex                m_mutex;
+        TileCache                   m_tile_cache;
+
+        // Used to wait for tiles being loaded, without holding the cache lock.
+        boost::mutex                m_loading_mutex;
+        boost::condition_variable   m_loading_event;
+
+        Shard(
+            TileKeyHasher&  tile_key_hasher,
+            TileSwapper&    tile_swapper);
+    };
+
+    enum { ShardCount = 16 };
+
+    class PrefetchJob;
+
+    TileKeyHasher                           m_tile_key_hasher;
+    TileSwapper                             m_tile_swapper;
+    Shard*                                  m_shards[ShardCount];
+    std::auto_ptr<foundation::JobQueue>     m_prefetch_job_queue;
+    std::auto_ptr<foundation::JobManager>   m_prefetch_job_manager;
+    const size_t                            m_thread_cache_line_budget;
+    boost::atomic<size_t>                   m_thread_cache_line_count;
+
+    Shard& get_shard(const TileKey& key);
+
+    // Wait until the tile of a record is loaded, loading it if no other thread does.
+    void wait_for_tile(Shard& shard, const TileKey& key, TileRecord& record);
+
+    // Load the tile of a record whose state was switched to TileRecord::Loading.
+    void load_tile(Shard& shard, const TileKey& key, TileRecord& record);
+
+    // Load a tile in the background if it isn't in the store already.
+    void prefetch(const TileKey& key);
+
+    // Load the tiles adjacent to a given tile in the background.
+    void prefetch_neighbors(const TileKey& key);
 };
 
 
@@ -189,14 +376,29 @@ class TextureStore
 // TextureStore class implementation.
 //
 
+inline TextureStore::Shard& TextureStore::get_shard(const TileKey& key)
+{
+    // Rehash the key hash so that the choice of shard is decorrelated from
+    // the position of the key in the index of the shard's LRU cache.
+    const foundation::uint32 h = static_cast<foundation::uint32>(m_tile_key_hasher(key));
+    return *m_shards[foundation::hash_uint32(h) % ShardCount];
+}
+
 inline TextureStore::TileRecord& TextureStore::acquire(const TileKey& key)
 {
-    boost::mutex::scoped_lock lock(m_mutex);
+    Shard& shard = get_shard(key);
+    TileRecord* record;
+
+    {
+        boost::mutex::scoped_lock lock(shard.m_mutex);
+        record = &shard.m_tile_cache.get(key);
+        foundation::atomic_inc(&record->m_owners);
+    }
 
-    TileRecord& record = m_tile_cache.get(key);
-    foundation::atomic_inc(&record.m_owners);
+    if (foundation::atomic_read(&record->m_state) != TileRecord::Ready)
+        wait_for_tile(shard, key, *record);
 
-    return record;
+    return *record;
 }
 
 inline void TextureStore::release(TileRecord& record) const
@@ -205,6 +407,32 @@ inline void TextureStore::release(TileRecord& record) const
     foundation::atomic_dec(&record.m_owners);
 }
 
+inline size_t TextureStore::get_memory_size() const
+{
+    return m_tile_swapper.get_memory_size();
+}
+
+
+inline size_t TextureStore::get_mip_level_size(const size_t base_size, const size_t level)
+{
+    const size_t size = base_size >> level;
+    return size > 0 ? size : 1;
+}
+
+inline size_t TextureStore::get_mip_level_count(const size_t base_width, const size_t base_height)
+{
+    size_t level_count = 1;
+    size_t size = base_width > base_height ? base_width : base_height;
+
+    while (size > 1)
+    {
+        size >>= 1;
+        ++level_count;
+    }
+
+    return level_count;
+}
+
 
 //
 // TextureStore::TileKey class implementation.
@@ -218,10 +446,12 @@ inline TextureStore::TileKey::TileKey(
     const foundation::UniqueID  assembly_uid,
     const foundation::UniqueID  texture_uid,
     const size_t                tile_x,
-    const size_t                tile_y)
+    const size_t                tile_y,
+    const size_t                level)
   : m_assembly_uid(assembly_uid)
   , m_texture_uid(texture_uid)
   , m_tile_xy(static_cast<foundation::uint32>((tile_y << 16) | tile_x))
+  , m_level(static_cast<foundation::uint32>(level))
 {
     assert(tile_x < (1UL << 16));
     assert(tile_y < (1UL << 16));
@@ -234,6 +464,7 @@ inline TextureStore::TileKey::TileKey(
   : m_assembly_uid(assembly_uid)
   , m_texture_uid(texture_uid)
   , m_tile_xy(tile_xy)
+  , m_level(0)
 {
 }
 
@@ -241,6 +472,7 @@ inline TextureStore::TileKey::TileKey(const TileKey& rhs)
   : m_assembly_uid(rhs.m_assembly_uid)
   , m_texture_uid(rhs.m_texture_uid)
   , m_tile_xy(rhs.m_tile_xy)
+  , m_level(rhs.m_level)
 {
 }
 
@@ -254,15 +486,23 @@ inline size_t TextureStore::TileKey::get_tile_y() const
     return static_cast<size_t>(m_tile_xy >> 16);
 }
 
+inline size_t TextureStore::TileKey::get_level() const
+{
+    return static_cast<size_t>(m_level);
+}
+
 inline TextureStore::TileKey TextureStore::TileKey::invalid()
 {
-    return TileKey(~0, ~0, ~0);
+    TileKey key(~0, ~0, ~0);
+    key.m_level = ~0U;
+    return key;
 }
 
 inline bool TextureStore::TileKey::operator==(const TileKey& rhs) const
 {
     return
         m_tile_xy == rhs.m_tile_xy &&
+        m_level == rhs.m_level &&
         m_texture_uid == rhs.m_texture_uid &&
         m_assembly_uid == rhs.m_assembly_uid;
 }
@@ -277,7 +517,9 @@ inline bool TextureStore::TileKey::operator<(const TileKey& rhs) const
     return
         m_assembly_uid == rhs.m_assembly_uid ?
             m_texture_uid == rhs.m_texture_uid ?
-                m_tile_xy < rhs.m_tile_xy :
+                m_level == rhs.m_level ?
+                    m_tile_xy < rhs.m_tile_xy :
+                m_level < rhs.m_level :
             m_texture_uid < rhs.m_texture_uid :
         m_assembly_uid < rhs.m_assembly_uid;
 }
@@ -289,7 +531,7 @@ inline bool TextureStore::TileKey::operator<(const TileKey& rhs) const
 
 inline size_t TextureStore::TileKeyHasher::operator()(const TileKey& key) const
 {
-    return foundation::mix_uint64(key.m_assembly_uid, key.m_texture_uid, key.m_tile_xy);
+    return foundation::mix_uint64(key.m_assembly_uid, key.m_texture_uid, key.m_tile_xy, key.m_level);
 }
 
 
@@ -299,12 +541,27 @@ inline size_t TextureStore::TileKeyHasher::operator()(const TileKey& key) const
 
 inline bool TextureStore::TileSwapper::is_full(const size_t element_count) const
 {
-    return m_memory_size >= m_params.m_memory_limit;
+    return m_memory_size.load() + m_external_memory_size.load() >= m_params.m_memory_limit;
+}
+
+inline size_t TextureStore::TileSwapper::get_memory_size() const
+{
+    return m_memory_size.load();
 }
 
 inline size_t TextureStore::TileSwapper::get_peak_memory_size() const
 {
-    return m_peak_memory_size;
+    return m_peak_memory_size.load();
+}
+
+inline bool TextureStore::TileSwapper::has_external_cache() const
+{
+    return m_external_cache.get() != 0;
+}
+
+inline size_t TextureStore::TileSwapper::get_external_memory_size() const
+{
+    return m_external_memory_size.load();
 }
 
 }       // namespace renderer
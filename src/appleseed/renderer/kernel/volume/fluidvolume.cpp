@@ -0,0 +1,109 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "fluidvolume.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/occupancygrid.h"
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// FluidVolume class implementation.
+//
+
+FluidVolume::FluidVolume(
+    auto_ptr<VoxelGrid>     voxel_grid,
+    const size_t            density_channel_index,
+    const AABB3d&           bbox,
+    const float             density_scale,
+    const float             albedo,
+    const float             occupancy_threshold)
+  : m_voxel_grid(voxel_grid)
+  , m_density_channel_index(density_channel_index)
+  , m_bbox(bbox)
+  , m_density_scale(density_scale)
+  , m_albedo(albedo)
+{
+    assert(m_voxel_grid.get());
+    assert(density_channel_index < m_voxel_grid->get_channel_count());
+
+    const OccupancyGrid occupancy_grid(*m_voxel_grid, density_channel_index, occupancy_threshold);
+    m_majorant_grid.reset(new MajorantGrid(*m_voxel_grid, density_channel_index, occupancy_grid));
+
+    initialize_mapping(
+        m_voxel_grid->get_xres(),
+        m_voxel_grid->get_yres(),
+        m_voxel_grid->get_zres());
+}
+
+FluidVolume::FluidVolume(
+    auto_ptr<SparseVoxelGrid>   sparse_grid,
+    const AABB3d&               bbox,
+    const float                 density_scale,
+    const float                 albedo,
+    const float                 occupancy_threshold)
+  : m_sparse_grid(sparse_grid)
+  , m_density_channel_index(0)
+  , m_bbox(bbox)
+  , m_density_scale(density_scale)
+  , m_albedo(albedo)
+{
+    assert(m_sparse_grid.get());
+
+    m_majorant_grid.reset(new MajorantGrid(*m_sparse_grid, occupancy_threshold));
+
+    initialize_mapping(
+        m_sparse_grid->get_xres(),
+        m_sparse_grid->get_yres(),
+        m_sparse_grid->get_zres());
+}
+
+void FluidVolume::initialize_mapping(
+    const size_t                xres,
+    const size_t                yres,
+    const size_t                zres)
+{
+    assert(m_bbox.is_valid());
+
+    const Vector3d extent = m_bbox.extent();
+    m_rcp_extent = Vector3d(1.0 / extent.x, 1.0 / extent.y, 1.0 / extent.z);
+    m_world_to_voxel =
+        Vector3d(
+            (xres - 1) * m_rcp_extent.x,
+            (yres - 1) * m_rcp_extent.y,
+            (zres - 1) * m_rcp_extent.z);
+}
+
+}   // namespace renderer
@@ -0,0 +1,412 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_VOLUME_FLUIDVOLUME_H
+#define APPLESEED_RENDERER_KERNEL_VOLUME_FLUIDVOLUME_H
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/majorantgrid.h"
+#include "renderer/kernel/volume/sparsevoxelgrid.h"
+#include "renderer/kernel/volume/volume.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+namespace renderer
+{
+
+//
+// A heterogeneous participating medium whose density is given by a voxel grid
+// mapped onto an axis-aligned box in world space. The voxel grid is either a dense,
+// in-memory grid or a sparse grid whose bricks are loaded on demand.
+//
+// Free-flight distances are sampled with delta tracking and transmittance is
+// estimated with ratio tracking. Both walk the cells of a majorant grid along
+// the ray: empty cells are skipped at once and tentative collisions are only
+// generated at the rate of the local majorant, i.e. densely in dense regions.
+//
+// The random number generators passed to the tracking methods are functors
+// returning uniform floats in [0,1).
+//
+
+class FluidVolume
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. Takes ownership of the voxel grid.
+    FluidVolume(
+        std::auto_ptr<VoxelGrid>        voxel_grid,
+        const size_t                    density_channel_index,
+        const foundation::AABB3d&       bbox,
+        const float                     density_scale,
+        const float                     albedo,
+        const float                     occupancy_threshold = 0.0f);
+
+    // Constructor. Takes ownership of the sparse voxel grid, whose single channel is the density.
+    FluidVolume(
+        std::auto_ptr<SparseVoxelGrid>  sparse_grid,
+        const foundation::AABB3d&       bbox,
+        const float                     density_scale,
+        const float                     albedo,
+        const float                     occupancy_threshold = 0.0f);
+
+    // Return the world space box covered by the voxel grid.
+    const foundation::AABB3d& get_bbox() const;
+
+    // Return the single-scattering albedo of the medium.
+    float get_albedo() const;
+
+    // Return the majorant grid.
+    const MajorantGrid& get_majorant_grid() const;
+
+    // Return the extinction coefficient at a given point, in world units.
+    float get_extinction(const foundation::Vector3d& point) const;
+
+    // Sample a collision with the medium along the segment [0, tmax) of a ray.
+    // Return false if the ray leaves the segment without colliding.
+    template <typename RNG>
+    bool sample_distance(
+        const foundation::Vector3d&     origin,
+        const foundation::Vector3d&     direction,
+        const double                    tmax,
+        RNG&                            rng,
+        double&                         distance) const;
+
+    // Estimate the transmittance along the segment [0, tmax) of a ray.
+    template <typename RNG>
+    float evaluate_transmittance(
+        const foundation::Vector3d&     origin,
+        const foundation::Vector3d&     direction,
+        const double                    tmax,
+        RNG&                            rng) const;
+
+  private:
+    const std::auto_ptr<VoxelGrid>      m_voxel_grid;
+    const std::auto_ptr<SparseVoxelGrid> m_sparse_grid;
+    const size_t                        m_density_channel_index;
+    const foundation::AABB3d            m_bbox;
+    const float                         m_density_scale;
+    const float                         m_albedo;
+    foundation::Vector3d                m_world_to_voxel;
+    foundation::Vector3d                m_rcp_extent;
+    std::auto_ptr<MajorantGrid>         m_majorant_grid;
+
+    void initialize_mapping(
+        const size_t                    xres,
+        const size_t                    yres,
+        const size_t                    zres);
+
+    // Invoke visitor.visit(t0, t1, majorant) on the successive majorant cells crossed by
+    // the segment [0, tmax) of a ray, until the visitor returns false.
+    template <typename Visitor>
+    void visit_cells(
+        const foundation::Vector3d&     origin,
+        const foundation::Vector3d&     direction,
+        const double                    tmax,
+        Visitor&                        visitor) const;
+
+    template <typename RNG> struct DeltaTrackingVisitor;
+    template <typename RNG> struct RatioTrackingVisitor;
+};
+
+
+//
+// FluidVolume class implementation.
+//
+
+inline const foundation::AABB3d& FluidVolume::get_bbox() const
+{
+    return m_bbox;
+}
+
+inline float FluidVolume::get_albedo() const
+{
+    return m_albedo;
+}
+
+inline const MajorantGrid& FluidVolume::get_majorant_grid() const
+{
+    return *m_majorant_grid;
+}
+
+inline float FluidVolume::get_extinction(const foundation::Vector3d& point) const
+{
+    const foundation::Vector3d p = (point - m_bbox.min) * m_rcp_extent;
+
+    if (m_sparse_grid.get())
+        return std::max(m_sparse_grid->linear_lookup(p), 0.0f) * m_density_scale;
+
+    float values[32];
+    assert(m_voxel_grid->get_channel_count() <= 32);
+    m_voxel_grid->linear_lookup(p, values);
+
+    return std::max(values[m_density_channel_index], 0.0f) * m_density_scale;
+}
+
+template <typename RNG>
+struct FluidVolume::DeltaTrackingVisitor
+{
+    const FluidVolume&                  m_volume;
+    const foundation::Vector3d&         m_origin;
+    const foundation::Vector3d&         m_direction;
+    RNG&                                m_rng;
+    double                              m_distance;
+    bool                                m_collided;
+
+    DeltaTrackingVisitor(
+        const FluidVolume&              volume,
+        const foundation::Vector3d&     origin,
+        const foundation::Vector3d&     direction,
+        RNG&                            rng)
+      : m_volume(volume)
+      , m_origin(origin)
+      , m_direction(direction)
+      , m_rng(rng)
+      , m_collided(false)
+    {
+    }
+
+    bool visit(const double t0, const double t1, const float majorant)
+    {
+        if (majorant <= 0.0f)
+            return true;
+
+        // Free-flight distances are memoryless, so sampling restarts at each cell boundary.
+        double t = t0;
+
+        while (true)
+        {
+            t -= std::log(1.0 - static_cast<double>(m_rng())) / majorant;
+            if (t >= t1)
+                return true;
+
+            // Accept the tentative collision with probability extinction / majorant.
+            const float extinction = m_volume.get_extinction(m_origin + t * m_direction);
+            if (m_rng() * majorant < extinction)
+            {
+                m_distance = t;
+                m_collided = true;
+                return false;
+            }
+        }
+    }
+};
+
+template <typename RNG>
+struct FluidVolume::RatioTrackingVisitor
+{
+    const FluidVolume&                  m_volume;
+    const foundation::Vector3d&         m_origin;
+    const foundation::Vector3d&         m_direction;
+    RNG&                                m_rng;
+    float                               m_transmittance;
+
+    RatioTrackingVisitor(
+        const FluidVolume&              volume,
+        const foundation::Vector3d&     origin,
+        const foundation::Vector3d&     direction,
+        RNG&                            rng)
+      : m_volume(volume)
+      , m_origin(origin)
+      , m_direction(direction)
+      , m_rng(rng)
+      , m_transmittance(1.0f)
+    {
+    }
+
+    bool visit(const double t0, const double t1, const float majorant)
+    {
+        if (majorant <= 0.0f)
+            return true;
+
+        double t = t0;
+
+        while (true)
+        {
+            t -= std::log(1.0 - static_cast<double>(m_rng())) / majorant;
+            if (t >= t1)
+                return true;
+
+            // Weight the transmittance by the probability of a null collision.
+            const float extinction = m_volume.get_extinction(m_origin + t * m_direction);
+            m_transmittance *= 1.0f - std::min(extinction / majorant, 1.0f);
+
+            // Stop once the contribution becomes negligible.
+            if (m_transmittance < 1.0e-4f)
+            {
+                m_transmittance = 0.0f;
+                return false;
+            }
+        }
+    }
+};
+
+template <typename RNG>
+inline bool FluidVolume::sample_distance(
+    const foundation::Vector3d&         origin,
+    const foundation::Vector3d&         direction,
+    const double                        tmax,
+    RNG&                                rng,
+    double&                             distance) const
+{
+    DeltaTrackingVisitor<RNG> visitor(*this, origin, direction, rng);
+    visit_cells(origin, direction, tmax, visitor);
+
+    if (visitor.m_collided)
+        distance = visitor.m_distance;
+
+    return visitor.m_collided;
+}
+
+template <typename RNG>
+inline float FluidVolume::evaluate_transmittance(
+    const foundation::Vector3d&         origin,
+    const foundation::Vector3d&         direction,
+    const double                        tmax,
+    RNG&                                rng) const
+{
+    RatioTrackingVisitor<RNG> visitor(*this, origin, direction, rng);
+    visit_cells(origin, direction, tmax, visitor);
+    return visitor.m_transmittance;
+}
+
+template <typename Visitor>
+void FluidVolume::visit_cells(
+    const foundation::Vector3d&         origin,
+    const foundation::Vector3d&         direction,
+    const double                        tmax,
+    Visitor&                            visitor) const
+{
+    // Clip the segment against the box covered by the voxel grid.
+    double t0 = 0.0;
+    double t1 = tmax;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        if (direction[i] == 0.0)
+        {
+            if (origin[i] < m_bbox.min[i] || origin[i] > m_bbox.max[i])
+                return;
+            continue;
+        }
+
+        const double rcp_dir = 1.0 / direction[i];
+        double near_t = (m_bbox.min[i] - origin[i]) * rcp_dir;
+        double far_t = (m_bbox.max[i] - origin[i]) * rcp_dir;
+        if (near_t > far_t)
+            std::swap(near_t, far_t);
+
+        t0 = std::max(t0, near_t);
+        t1 = std::min(t1, far_t);
+    }
+
+    if (t0 >= t1)
+        return;
+
+    // Express the ray in cell coordinates, keeping the ray parameter in world units.
+    const double rcp_cell_size = 1.0 / m_majorant_grid->get_cell_size();
+    const foundation::Vector3d cell_origin = (origin - m_bbox.min) * m_world_to_voxel * rcp_cell_size;
+    const foundation::Vector3d cell_direction = direction * m_world_to_voxel * rcp_cell_size;
+    const size_t res[3] =
+    {
+        m_majorant_grid->get_xres(),
+        m_majorant_grid->get_yres(),
+        m_majorant_grid->get_zres()
+    };
+
+    // Initialize the 3D DDA.
+    size_t cell[3];
+    int step[3];
+    double next_t[3];
+    double delta_t[3];
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const double c = cell_origin[i] + t0 * cell_direction[i];
+        cell[i] = std::min(foundation::truncate<size_t>(std::max(c, 0.0)), res[i] - 1);
+
+        if (cell_direction[i] > 0.0)
+        {
+            step[i] = 1;
+            delta_t[i] = 1.0 / cell_direction[i];
+            next_t[i] = (cell[i] + 1 - cell_origin[i]) * delta_t[i];
+        }
+        else if (cell_direction[i] < 0.0)
+        {
+            step[i] = -1;
+            delta_t[i] = -1.0 / cell_direction[i];
+            next_t[i] = (cell_origin[i] - cell[i]) * delta_t[i];
+        }
+        else
+        {
+            step[i] = 0;
+            delta_t[i] = std::numeric_limits<double>::max();
+            next_t[i] = std::numeric_limits<double>::max();
+        }
+    }
+
+    double t = t0;
+
+    while (t < t1)
+    {
+        // Find the axis along which the next cell boundary is crossed.
+        const size_t axis =
+            next_t[0] < next_t[1]
+                ? (next_t[0] < next_t[2] ? 0 : 2)
+                : (next_t[1] < next_t[2] ? 1 : 2);
+
+        const double cell_t1 = std::min(next_t[axis], t1);
+        const float majorant = m_majorant_grid->get_majorant(cell[0], cell[1], cell[2]) * m_density_scale;
+
+        if (cell_t1 > t && !visitor.visit(t, cell_t1, majorant))
+            return;
+
+        // Step into the next cell.
+        t = cell_t1;
+        if (step[axis] > 0 ? cell[axis] + 1 >= res[axis] : cell[axis] == 0)
+            return;
+        if (step[axis] > 0)
+            ++cell[axis];
+        else --cell[axis];
+        next_t[axis] += delta_t[axis];
+    }
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_VOLUME_FLUIDVOLUME_H
@@ -0,0 +1,137 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "majorantgrid.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/occupancygrid.h"
+#include "renderer/kernel/volume/sparsevoxelgrid.h"
+
+// Standard headers.
+#include <algorithm>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// MajorantGrid class implementation.
+//
+
+namespace
+{
+    size_t get_cell_count(const size_t voxel_count, const size_t cell_size)
+    {
+        // Voxel centers span voxel_count - 1 intervals.
+        return max<size_t>((voxel_count - 1 + cell_size - 1) / cell_size, 1);
+    }
+}
+
+MajorantGrid::MajorantGrid(
+    const VoxelGrid&        voxel_grid,
+    const size_t            density_channel_index,
+    const OccupancyGrid&    occupancy_grid,
+    const size_t            cell_size)
+  : m_cell_size(cell_size)
+{
+    assert(cell_size > 0);
+
+    const size_t nx = voxel_grid.get_xres();
+    const size_t ny = voxel_grid.get_yres();
+    const size_t nz = voxel_grid.get_zres();
+
+    m_xres = get_cell_count(nx, cell_size);
+    m_yres = get_cell_count(ny, cell_size);
+    m_zres = get_cell_count(nz, cell_size);
+    m_majorants.resize(m_xres * m_yres * m_zres);
+
+    for (size_t cz = 0; cz < m_zres; ++cz)
+    {
+        for (size_t cy = 0; cy < m_yres; ++cy)
+        {
+            for (size_t cx = 0; cx < m_xres; ++cx)
+            {
+                // Linear lookups inside the cell blend the voxels at both ends of its range.
+                const size_t x0 = cx * cell_size, x1 = min(x0 + cell_size, nx - 1);
+                const size_t y0 = cy * cell_size, y1 = min(y0 + cell_size, ny - 1);
+                const size_t z0 = cz * cell_size, z1 = min(z0 + cell_size, nz - 1);
+
+                bool has_fluid = false;
+                float majorant = 0.0f;
+
+                for (size_t z = z0; z <= z1; ++z)
+                {
+                    for (size_t y = y0; y <= y1; ++y)
+                    {
+                        for (size_t x = x0; x <= x1; ++x)
+                        {
+                            has_fluid = has_fluid || occupancy_grid.has_fluid(x, y, z);
+                            majorant = max(majorant, voxel_grid.voxel(x, y, z)[density_channel_index]);
+                        }
+                    }
+                }
+
+                m_majorants[(cz * m_yres + cy) * m_xres + cx] = has_fluid ? majorant : 0.0f;
+            }
+        }
+    }
+}
+
+MajorantGrid::MajorantGrid(
+    const SparseVoxelGrid&  voxel_grid,
+    const float             occupancy_threshold)
+  : m_cell_size(voxel_grid.get_reader().get_brick_size())
+{
+    const VolumeFileReader& reader = voxel_grid.get_reader();
+
+    // Bricks hold the voxels blended by linear lookups in the cells.
+    m_xres = reader.get_brick_xres();
+    m_yres = reader.get_brick_yres();
+    m_zres = reader.get_brick_zres();
+    m_majorants.resize(m_xres * m_yres * m_zres);
+
+    for (size_t cz = 0; cz < m_zres; ++cz)
+    {
+        for (size_t cy = 0; cy < m_yres; ++cy)
+        {
+            for (size_t cx = 0; cx < m_xres; ++cx)
+            {
+                const float majorant = voxel_grid.get_brick_max(cx, cy, cz);
+
+                m_majorants[(cz * m_yres + cy) * m_xres + cx] =
+                    majorant > occupancy_threshold ? max(majorant, 0.0f) : 0.0f;
+            }
+        }
+    }
+}
+
+}   // namespace renderer
@@ -0,0 +1,139 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_VOLUME_MAJORANTGRID_H
+#define APPLESEED_RENDERER_KERNEL_VOLUME_MAJORANTGRID_H
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/volume.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace renderer      { class OccupancyGrid; }
+namespace renderer      { class SparseVoxelGrid; }
+
+namespace renderer
+{
+
+//
+// A coarse grid storing, for each cell of a voxel grid, an upper bound of the density
+// found by linear lookups inside the cell. Cells where the occupancy grid reports no
+// fluid have a zero majorant so that free-flight sampling can skip them entirely.
+//
+// Cell (cx, cy, cz) covers the continuous voxel coordinates [cx * CellSize, (cx + 1) * CellSize]
+// along x (and likewise along y and z), where voxel centers have integer coordinates.
+//
+
+class MajorantGrid
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    MajorantGrid(
+        const VoxelGrid&        voxel_grid,
+        const size_t            density_channel_index,
+        const OccupancyGrid&    occupancy_grid,
+        const size_t            cell_size = 8);
+
+    // Constructor. Cells match the bricks of the sparse voxel grid, and the majorant of
+    // a brick is the maximum value of its voxels, or zero if that maximum is at most
+    // the occupancy threshold. No brick is loaded.
+    MajorantGrid(
+        const SparseVoxelGrid&  voxel_grid,
+        const float             occupancy_threshold);
+
+    // Return the size of a cell in voxels.
+    size_t get_cell_size() const;
+
+    // Return the number of cells in each dimension.
+    size_t get_xres() const;
+    size_t get_yres() const;
+    size_t get_zres() const;
+
+    // Return the majorant of a given cell.
+    float get_majorant(
+        const size_t            cx,
+        const size_t            cy,
+        const size_t            cz) const;
+
+  private:
+    const size_t                m_cell_size;
+    size_t                      m_xres;
+    size_t                      m_yres;
+    size_t                      m_zres;
+    std::vector<float>          m_majorants;
+};
+
+
+//
+// MajorantGrid class implementation.
+//
+
+inline size_t MajorantGrid::get_cell_size() const
+{
+    return m_cell_size;
+}
+
+inline size_t MajorantGrid::get_xres() const
+{
+    return m_xres;
+}
+
+inline size_t MajorantGrid::get_yres() const
+{
+    return m_yres;
+}
+
+inline size_t MajorantGrid::get_zres() const
+{
+    return m_zres;
+}
+
+inline float MajorantGrid::get_majorant(
+    const size_t                cx,
+    const size_t                cy,
+    const size_t                cz) const
+{
+    assert(cx < m_xres);
+    assert(cy < m_yres);
+    assert(cz < m_zres);
+
+    return m_majorants[(cz * m_yres + cy) * m_xres + cx];
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_VOLUME_MAJORANTGRID_H
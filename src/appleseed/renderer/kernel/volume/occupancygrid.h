@@ -48,8 +48,15 @@ class OccupancyGrid
         const size_t        density_channel_index,
         const float         occupancy_threshold);
 
+    // Return true if there is fluid around a given point of the unit cube.
     bool has_fluid(const foundation::Vector3d& point) const;
 
+    // Return true if there is fluid around a given voxel.
+    bool has_fluid(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+
   private:
     foundation::VoxelGrid3<unsigned char, double> m_grid;
 
@@ -78,6 +85,14 @@ inline bool OccupancyGrid::has_fluid(const foundation::Vector3d& point) const
     return result == 1;
 }
 
+inline bool OccupancyGrid::has_fluid(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z) const
+{
+    return m_grid.voxel(x, y, z)[0] == 1;
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_VOLUME_OCCUPANCYGRID_H
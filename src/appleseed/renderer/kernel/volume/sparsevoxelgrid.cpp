@@ -0,0 +1,71 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sparsevoxelgrid.h"
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// SparseVoxelGrid class implementation.
+//
+
+SparseVoxelGrid::SparseVoxelGrid(
+    auto_ptr<VolumeFileReader>  reader,
+    const size_t                channel_index,
+    VolumeBrickStore*           brick_store)
+  : m_reader(reader)
+  , m_channel_index(channel_index)
+  , m_private_brick_store(brick_store ? 0 : new VolumeBrickStore())
+  , m_brick_store(brick_store ? *brick_store : *m_private_brick_store)
+{
+    assert(m_reader.get());
+    assert(m_reader->is_open());
+    assert(channel_index < m_reader->get_channel_count());
+
+    m_file_index = m_brick_store.register_file(*m_reader);
+    m_brick_size = m_reader->get_brick_size();
+
+    m_res[0] = m_reader->get_xres();
+    m_res[1] = m_reader->get_yres();
+    m_res[2] = m_reader->get_zres();
+
+    m_brick_res[0] = m_reader->get_brick_xres();
+    m_brick_res[1] = m_reader->get_brick_yres();
+    m_brick_res[2] = m_reader->get_brick_zres();
+
+    for (size_t d = 0; d < 3; ++d)
+        m_max[d] = static_cast<double>(m_res[d] - 1);
+}
+
+}   // namespace renderer
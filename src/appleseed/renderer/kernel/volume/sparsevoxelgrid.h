@@ -0,0 +1,187 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_VOLUME_SPARSEVOXELGRID_H
+#define APPLESEED_RENDERER_KERNEL_VOLUME_SPARSEVOXELGRID_H
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/volumebrickstore.h"
+#include "renderer/kernel/volume/volumefilereader.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+namespace renderer
+{
+
+//
+// A single channel of a voxel grid stored in a volume file.
+//
+// Only the bricks touched by lookups are loaded, through a volume brick store.
+// Bricks with a constant value are never loaded. Lookups have the same semantics
+// as those of foundation::VoxelGrid3. Lookups are thread-safe.
+//
+
+class SparseVoxelGrid
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. Takes ownership of the reader, which must be open. If no brick store
+    // is given, the grid uses a private store with default parameters.
+    SparseVoxelGrid(
+        std::auto_ptr<VolumeFileReader>     reader,
+        const size_t                        channel_index,
+        VolumeBrickStore*                   brick_store = 0);
+
+    // Return the volume file reader.
+    const VolumeFileReader& get_reader() const;
+
+    // Return the number of voxels in each dimension.
+    size_t get_xres() const;
+    size_t get_yres() const;
+    size_t get_zres() const;
+
+    // Return the maximum value of a given brick, without loading it.
+    float get_brick_max(
+        const size_t                        bx,
+        const size_t                        by,
+        const size_t                        bz) const;
+
+    // Perform a trilinearly interpolated lookup of the voxel grid.
+    // 'point' must be expressed in the unit cube [0,1]^3.
+    float linear_lookup(const foundation::Vector3d& point) const;
+
+  private:
+    const std::auto_ptr<VolumeFileReader>   m_reader;
+    const size_t                            m_channel_index;
+    std::auto_ptr<VolumeBrickStore>         m_private_brick_store;
+    VolumeBrickStore&                       m_brick_store;
+    size_t                                  m_file_index;
+    size_t                                  m_brick_size;
+    size_t                                  m_res[3];
+    size_t                                  m_brick_res[3];
+    double                                  m_max[3];
+};
+
+
+//
+// SparseVoxelGrid class implementation.
+//
+
+inline const VolumeFileReader& SparseVoxelGrid::get_reader() const
+{
+    return *m_reader;
+}
+
+inline size_t SparseVoxelGrid::get_xres() const
+{
+    return m_res[0];
+}
+
+inline size_t SparseVoxelGrid::get_yres() const
+{
+    return m_res[1];
+}
+
+inline size_t SparseVoxelGrid::get_zres() const
+{
+    return m_res[2];
+}
+
+inline float SparseVoxelGrid::get_brick_max(
+    const size_t                            bx,
+    const size_t                            by,
+    const size_t                            bz) const
+{
+    return m_reader->get_brick_entry(m_channel_index, bx, by, bz).m_max;
+}
+
+inline float SparseVoxelGrid::linear_lookup(const foundation::Vector3d& point) const
+{
+    // Compute the coordinates of the voxel containing the lookup point,
+    // the brick containing that voxel and the coordinates of the voxel in the brick.
+    size_t b[3], i[3], size[3];
+    float w[3];
+    for (size_t d = 0; d < 3; ++d)
+    {
+        const double x = foundation::saturate(point[d]) * m_max[d];
+        const size_t ix = foundation::truncate<size_t>(x);
+        w[d] = static_cast<float>(x - ix);
+        b[d] = std::min(ix / m_brick_size, m_brick_res[d] - 1);
+        i[d] = ix - b[d] * m_brick_size;
+        size[d] = std::min(m_brick_size, m_res[d] - 1 - b[d] * m_brick_size) + 1;
+    }
+
+    // Bricks with a constant value have no data.
+    const volume_file_format::BrickEntry& entry =
+        m_reader->get_brick_entry(m_channel_index, b[0], b[1], b[2]);
+    if (entry.m_size == 0)
+        return entry.m_min;
+
+    // Compute source offsets.
+    const size_t row_size = size[0];
+    const size_t slice_size = size[0] * size[1];
+    const size_t dx = i[0] + 1 < size[0] ? 1 : 0;
+    const size_t dy = i[1] + 1 < size[1] ? row_size : 0;
+    const size_t dz = i[2] + 1 < size[2] ? slice_size : 0;
+    const size_t o000 = (i[2] * size[1] + i[1]) * size[0] + i[0];
+
+    // Fetch the voxels and interpolate them.
+    const VolumeBrickStore::BrickKey key(
+        m_file_index,
+        m_channel_index,
+        (b[2] * m_brick_res[1] + b[1]) * m_brick_res[0] + b[0]);
+    VolumeBrickStore::BrickRecord& record = m_brick_store.acquire(key);
+    assert(o000 + dx + dy + dz < record.m_value_count);
+    const float* values = record.m_values + o000;
+
+    const float v00 = values[0]       + w[0] * (values[dx]           - values[0]);
+    const float v10 = values[dy]      + w[0] * (values[dy + dx]      - values[dy]);
+    const float v01 = values[dz]      + w[0] * (values[dz + dx]      - values[dz]);
+    const float v11 = values[dz + dy] + w[0] * (values[dz + dy + dx] - values[dz + dy]);
+
+    m_brick_store.release(record);
+
+    const float v0 = v00 + w[1] * (v10 - v00);
+    const float v1 = v01 + w[1] * (v11 - v01);
+
+    return v0 + w[2] * (v1 - v0);
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_VOLUME_SPARSEVOXELGRID_H
@@ -37,6 +37,8 @@
 // Standard headers.
 #include <cassert>
 #include <cstdio>
+#include <string>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -60,6 +62,47 @@ FluidChannels::FluidChannels()
 {
 }
 
+namespace
+{
+    const char* ColorComponents[] = { ".r", ".g", ".b" };
+    const char* VectorComponents[] = { ".x", ".y", ".z" };
+
+    void add_channel_names(
+        vector<string>&     names,
+        const size_t        index,
+        const char*         name,
+        const char*         components[] = 0)
+    {
+        if (index == FluidChannels::NotPresent)
+            return;
+
+        const size_t count = components ? 3 : 1;
+        if (names.size() < index + count)
+            names.resize(index + count);
+
+        if (components)
+        {
+            for (size_t i = 0; i < count; ++i)
+                names[index + i] = string(name) + components[i];
+        }
+        else names[index] = name;
+    }
+}
+
+vector<string> FluidChannels::get_channel_names() const
+{
+    vector<string> names;
+    add_channel_names(names, m_color_index, "color", ColorComponents);
+    add_channel_names(names, m_density_index, "density");
+    add_channel_names(names, m_temperature_index, "temperature");
+    add_channel_names(names, m_fuel_index, "fuel");
+    add_channel_names(names, m_falloff_index, "falloff");
+    add_channel_names(names, m_pressure_index, "pressure");
+    add_channel_names(names, m_coordinates_index, "coordinates", VectorComponents);
+    add_channel_names(names, m_velocity_index, "velocity", VectorComponents);
+    return names;
+}
+
 
 //
 // Voxel grid I/O.
@@ -33,9 +33,14 @@
 // appleseed.foundation headers.
 #include "foundation/math/voxelgrid.h"
 
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
 // Standard headers.
 #include <cstddef>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace renderer
 {
@@ -51,7 +56,7 @@ typedef foundation::VoxelGrid3<float, double> VoxelGrid;
 // A structure to keep track of the channels in a voxel grid.
 //
 
-struct FluidChannels
+struct APPLESEED_DLLSYMBOL FluidChannels
 {
     static const size_t NotPresent = ~0;
 
@@ -66,6 +71,10 @@ struct FluidChannels
 
     // Constructor, initializes all channel indices to NotPresent.
     FluidChannels();
+
+    // Return the names of the individual channels of a voxel grid with these channels,
+    // e.g. "density", or "velocity.x", "velocity.y" and "velocity.z" for vector channels.
+    std::vector<std::string> get_channel_names() const;
 };
 
 
@@ -74,7 +83,7 @@ struct FluidChannels
 //
 
 // Read a fluid file created by 3Delight for Maya.
-std::auto_ptr<VoxelGrid> read_fluid_file(
+APPLESEED_DLLSYMBOL std::auto_ptr<VoxelGrid> read_fluid_file(
     const char*         filename,
     FluidChannels&      channels);
 
@@ -0,0 +1,250 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "volumebrickstore.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/volume/volumefilereader.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/memoryaccounting.h"
+#include "foundation/utility/statistics.h"
+
+// Standard headers.
+#include <algorithm>
+#include <exception>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// VolumeBrickStore class implementation.
+//
+
+namespace
+{
+    // Combined cache statistics of all the shards of the store.
+    struct CombinedCacheStats
+    {
+        uint64  m_hit_count;
+        uint64  m_miss_count;
+
+        uint64 get_hit_count() const { return m_hit_count; }
+        uint64 get_miss_count() const { return m_miss_count; }
+    };
+}
+
+VolumeBrickStore::VolumeBrickStore(const ParamArray& params)
+  : m_brick_swapper(params)
+{
+    for (size_t i = 0; i < ShardCount; ++i)
+        m_shards[i] = new Shard(m_brick_key_hasher, m_brick_swapper);
+}
+
+VolumeBrickStore::~VolumeBrickStore()
+{
+    for (size_t i = 0; i < ShardCount; ++i)
+        delete m_shards[i];
+}
+
+size_t VolumeBrickStore::register_file(const VolumeFileReader& reader)
+{
+    return m_brick_swapper.register_file(reader);
+}
+
+void VolumeBrickStore::set_external_cache(auto_ptr<IExternalCache> external_cache)
+{
+    m_brick_swapper.set_external_cache(external_cache);
+}
+
+StatisticsVector VolumeBrickStore::get_statistics() const
+{
+    CombinedCacheStats combined;
+    combined.m_hit_count = 0;
+    combined.m_miss_count = 0;
+
+    for (size_t i = 0; i < ShardCount; ++i)
+    {
+        combined.m_hit_count += m_shards[i]->m_brick_cache.get_hit_count();
+        combined.m_miss_count += m_shards[i]->m_brick_cache.get_miss_count();
+    }
+
+    Statistics stats = make_single_stage_cache_stats(combined);
+    stats.insert_size("peak size", m_brick_swapper.get_peak_memory_size());
+    if (m_brick_swapper.has_external_cache())
+        stats.insert_size("shared size", m_brick_swapper.get_external_memory_size());
+
+    return StatisticsVector::make("volume store statistics", stats);
+}
+
+Dictionary VolumeBrickStore::get_params_metadata()
+{
+    Dictionary metadata;
+
+    const size_t DefaultVolumeStoreSizeMB = 1024;
+    metadata.dictionaries().insert(
+        "max_size",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", DefaultVolumeStoreSizeMB * 1024 * 1024)
+            .insert("label", "Volume Cache Size")
+            .insert("help", "Size in bytes of the cache of volume file bricks"));
+
+    return metadata;
+}
+
+
+//
+// VolumeBrickStore::Shard class implementation.
+//
+
+VolumeBrickStore::Shard::Shard(
+    BrickKeyHasher&     brick_key_hasher,
+    BrickSwapper&       brick_swapper)
+  : m_brick_cache(brick_key_hasher, brick_swapper)
+{
+}
+
+
+//
+// VolumeBrickStore::BrickSwapper class implementation.
+//
+
+VolumeBrickStore::BrickSwapper::BrickSwapper(const ParamArray& params)
+  : m_memory_limit(params.get_optional<size_t>("max_size", 1024 * 1024 * 1024))
+  , m_memory_size(0)
+  , m_peak_memory_size(0)
+  , m_external_memory_size(0)
+{
+    assert(m_memory_limit > 0);
+}
+
+size_t VolumeBrickStore::BrickSwapper::register_file(const VolumeFileReader& reader)
+{
+    assert(reader.is_open());
+
+    const string filename = reader.get_filename();
+    const FileIndexMap::const_iterator i = m_file_indices.find(filename);
+
+    if (i != m_file_indices.end())
+    {
+        m_files[i->second] = &reader;
+        return i->second;
+    }
+
+    const size_t index = m_files.size();
+    m_files.push_back(&reader);
+    m_file_indices[filename] = index;
+
+    return index;
+}
+
+void VolumeBrickStore::BrickSwapper::load(const BrickKey& key, BrickRecord& record)
+{
+    assert(key.m_file_index < m_files.size());
+
+    // The file table is only modified while no brick is being loaded,
+    // hence it can safely be accessed concurrently from all shards.
+    const VolumeFileReader& reader = *m_files[key.m_file_index];
+
+    const size_t brick_xres = reader.get_brick_xres();
+    const size_t brick_yres = reader.get_brick_yres();
+    const size_t bx = key.m_brick_index % brick_xres;
+    const size_t by = (key.m_brick_index / brick_xres) % brick_yres;
+    const size_t bz = key.m_brick_index / (brick_xres * brick_yres);
+
+    size_t width, height, depth;
+    reader.get_brick_dimensions(bx, by, bz, width, height, depth);
+
+    record.m_value_count = width * height * depth;
+    record.m_values = new float[record.m_value_count];
+    record.m_owners = 0;
+
+    try
+    {
+        reader.read_brick(key.m_channel_index, bx, by, bz, record.m_values);
+    }
+    catch (const exception& e)
+    {
+        RENDERER_LOG_ERROR(
+            "failed to read brick (" FMT_SIZE_T ", " FMT_SIZE_T ", " FMT_SIZE_T ") "
+            "of channel \"%s\" from volume file \"%s\": %s",
+            bx,
+            by,
+            bz,
+            reader.get_channel_name(key.m_channel_index),
+            reader.get_filename(),
+            e.what());
+
+        fill(record.m_values, record.m_values + record.m_value_count, 0.0f);
+    }
+
+    // Poll the memory usage of the cache sharing our budget.
+    if (m_external_cache.get())
+        m_external_memory_size.store(m_external_cache->get_memory_size());
+
+    // Track the amount of memory used by the brick cache.
+    const size_t brick_memory_size = record.m_value_count * sizeof(float);
+    const size_t memory_size = m_memory_size.fetch_add(brick_memory_size) + brick_memory_size;
+    account_memory_allocation(MemoryTagVolumes, brick_memory_size);
+    size_t peak_memory_size = m_peak_memory_size.load();
+    while (peak_memory_size < memory_size &&
+           !m_peak_memory_size.compare_exchange_weak(peak_memory_size, memory_size)) ;
+}
+
+bool VolumeBrickStore::BrickSwapper::unload(const BrickKey& key, BrickRecord& record)
+{
+    // Cannot unload bricks that are still in use.
+    if (atomic_read(&record.m_owners) > 0)
+        return false;
+
+    // Track the amount of memory used by the brick cache.
+    const size_t brick_memory_size = record.m_value_count * sizeof(float);
+    assert(m_memory_size.load() >= brick_memory_size);
+    m_memory_size.fetch_sub(brick_memory_size);
+    account_memory_deallocation(MemoryTagVolumes, brick_memory_size);
+
+    delete [] record.m_values;
+
+    return true;
+}
+
+void VolumeBrickStore::BrickSwapper::set_external_cache(auto_ptr<IExternalCache> external_cache)
+{
+    m_external_cache = external_cache;
+    m_external_memory_size.store(m_external_cache.get() ? m_external_cache->get_memory_size() : 0);
+}
+
+}   // namespace renderer
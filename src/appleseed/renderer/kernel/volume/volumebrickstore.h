@@ -0,0 +1,317 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_VOLUME_VOLUMEBRICKSTORE_H
+#define APPLESEED_RENDERER_KERNEL_VOLUME_VOLUMEBRICKSTORE_H
+
+// appleseed.renderer headers.
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/hash.h"
+#include "foundation/platform/atomic.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/cache.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class Dictionary; }
+namespace foundation    { class StatisticsVector; }
+namespace renderer      { class VolumeFileReader; }
+
+namespace renderer
+{
+
+//
+// A shared store for the bricks of volume files.
+//
+// Like the texture store, the store is split into independently locked shards, each
+// with its own LRU cache, and all shards share a single memory budget. Bricks are loaded
+// from their (memory-mapped) volume file on demand, under the lock of their shard.
+//
+// The memory budget may be shared with other caches, for instance with the texture store
+// through the renderer-wide memory budget: their memory usage then counts against it.
+//
+
+class VolumeBrickStore
+  : public foundation::NonCopyable
+{
+  public:
+    // This structure uniquely identifies a brick of a channel of a volume file.
+    struct BrickKey
+    {
+        foundation::uint32          m_file_index;
+        foundation::uint32          m_channel_index;
+        foundation::uint32          m_brick_index;
+
+        BrickKey();
+
+        BrickKey(
+            const size_t            file_index,
+            const size_t            channel_index,
+            const size_t            brick_index);
+
+        bool operator==(const BrickKey& rhs) const;
+    };
+
+    struct BrickRecord
+    {
+        float*                      m_values;
+        size_t                      m_value_count;
+        volatile foundation::uint32 m_owners;
+    };
+
+    // Interface of a cache sharing the memory budget of the store.
+    typedef TextureStore::IExternalCache IExternalCache;
+
+    // Constructor.
+    explicit VolumeBrickStore(const ParamArray& params = ParamArray());
+
+    // Destructor.
+    ~VolumeBrickStore();
+
+    // Register a volume file and return its index. Registering a file with the same path
+    // as a previously registered file returns the index of that file, so that its bricks
+    // remain cached. The store does not take ownership of the reader, which must outlive
+    // the bricks acquired from it. Not thread-safe.
+    size_t register_file(const VolumeFileReader& reader);
+
+    // Acquire a brick from the store. Thread-safe.
+    BrickRecord& acquire(const BrickKey& key);
+
+    // Release a previously-acquired brick. Thread-safe.
+    void release(BrickRecord& record) const;
+
+    // Share the memory budget of the store with another cache.
+    // Must be called before the store is used. The store takes ownership of the object.
+    void set_external_cache(std::auto_ptr<IExternalCache> external_cache);
+
+    // Return the current memory size in bytes of the bricks held by the store. Thread-safe.
+    size_t get_memory_size() const;
+
+    // Retrieve performance statistics.
+    foundation::StatisticsVector get_statistics() const;
+
+    // Return the metadata of the volume store parameters.
+    static foundation::Dictionary get_params_metadata();
+
+  private:
+    struct BrickKeyHasher
+    {
+        size_t operator()(const BrickKey& key) const;
+    };
+
+    class BrickSwapper
+      : public foundation::NonCopyable
+    {
+      public:
+        // Constructor.
+        explicit BrickSwapper(const ParamArray& params);
+
+        // Register a volume file and return its index.
+        size_t register_file(const VolumeFileReader& reader);
+
+        // Load a cache line.
+        void load(const BrickKey& key, BrickRecord& record);
+
+        // Unload a cache line.
+        bool unload(const BrickKey& key, BrickRecord& record);
+
+        // Return true if the cache is full, false otherwise.
+        bool is_full(const size_t element_count) const;
+
+        // Return the current and peak memory size in bytes of the brick cache.
+        size_t get_memory_size() const;
+        size_t get_peak_memory_size() const;
+
+        // Share the memory budget with another cache.
+        void set_external_cache(std::auto_ptr<IExternalCache> external_cache);
+
+        // Return true if the memory budget is shared with another cache.
+        bool has_external_cache() const;
+
+        // Return the memory size in bytes of the external cache when it was last polled.
+        size_t get_external_memory_size() const;
+
+        // The methods of this class may be called concurrently from different shards.
+
+      private:
+        typedef std::map<std::string, size_t> FileIndexMap;
+
+        const size_t                    m_memory_limit;
+        std::vector<const VolumeFileReader*> m_files;
+        FileIndexMap                    m_file_indices;
+        boost::atomic<size_t>           m_memory_size;
+        boost::atomic<size_t>           m_peak_memory_size;
+        std::auto_ptr<IExternalCache>   m_external_cache;
+        boost::atomic<size_t>           m_external_memory_size;
+    };
+
+    typedef foundation::LRUCache<
+        BrickKey,
+        BrickKeyHasher,
+        BrickRecord,
+        BrickSwapper
+    > BrickCache;
+
+    struct Shard
+      : public foundation::NonCopyable
+    {
+        boost::mutex                    m_mutex;
+        BrickCache                      m_brick_cache;
+
+        Shard(
+            BrickKeyHasher&     brick_key_hasher,
+            BrickSwapper&       brick_swapper);
+    };
+
+    enum { ShardCount = 16 };
+
+    BrickKeyHasher                      m_brick_key_hasher;
+    BrickSwapper                        m_brick_swapper;
+    Shard*                              m_shards[ShardCount];
+
+    Shard& get_shard(const BrickKey& key);
+};
+
+
+//
+// VolumeBrickStore class implementation.
+//
+
+inline VolumeBrickStore::Shard& VolumeBrickStore::get_shard(const BrickKey& key)
+{
+    // Rehash the key hash so that the choice of shard is decorrelated from
+    // the position of the key in the index of the shard's LRU cache.
+    const foundation::uint32 h = static_cast<foundation::uint32>(m_brick_key_hasher(key));
+    return *m_shards[foundation::hash_uint32(h) % ShardCount];
+}
+
+inline VolumeBrickStore::BrickRecord& VolumeBrickStore::acquire(const BrickKey& key)
+{
+    Shard& shard = get_shard(key);
+    boost::mutex::scoped_lock lock(shard.m_mutex);
+
+    BrickRecord& record = shard.m_brick_cache.get(key);
+    foundation::atomic_inc(&record.m_owners);
+
+    return record;
+}
+
+inline void VolumeBrickStore::release(BrickRecord& record) const
+{
+    assert(foundation::atomic_read(&record.m_owners) > 0);
+    foundation::atomic_dec(&record.m_owners);
+}
+
+inline size_t VolumeBrickStore::get_memory_size() const
+{
+    return m_brick_swapper.get_memory_size();
+}
+
+
+//
+// VolumeBrickStore::BrickKey class implementation.
+//
+
+inline VolumeBrickStore::BrickKey::BrickKey()
+{
+}
+
+inline VolumeBrickStore::BrickKey::BrickKey(
+    const size_t                file_index,
+    const size_t                channel_index,
+    const size_t                brick_index)
+  : m_file_index(static_cast<foundation::uint32>(file_index))
+  , m_channel_index(static_cast<foundation::uint32>(channel_index))
+  , m_brick_index(static_cast<foundation::uint32>(brick_index))
+{
+}
+
+inline bool VolumeBrickStore::BrickKey::operator==(const BrickKey& rhs) const
+{
+    return
+        m_brick_index == rhs.m_brick_index &&
+        m_channel_index == rhs.m_channel_index &&
+        m_file_index == rhs.m_file_index;
+}
+
+
+//
+// VolumeBrickStore::BrickKeyHasher class implementation.
+//
+
+inline size_t VolumeBrickStore::BrickKeyHasher::operator()(const BrickKey& key) const
+{
+    return foundation::mix_uint32(key.m_file_index, key.m_channel_index, key.m_brick_index);
+}
+
+
+//
+// VolumeBrickStore::BrickSwapper class implementation.
+//
+
+inline bool VolumeBrickStore::BrickSwapper::is_full(const size_t element_count) const
+{
+    return m_memory_size.load() + m_external_memory_size.load() >= m_memory_limit;
+}
+
+inline size_t VolumeBrickStore::BrickSwapper::get_memory_size() const
+{
+    return m_memory_size.load();
+}
+
+inline size_t VolumeBrickStore::BrickSwapper::get_peak_memory_size() const
+{
+    return m_peak_memory_size.load();
+}
+
+inline bool VolumeBrickStore::BrickSwapper::has_external_cache() const
+{
+    return m_external_cache.get() != 0;
+}
+
+inline size_t VolumeBrickStore::BrickSwapper::get_external_memory_size() const
+{
+    return m_external_memory_size.load();
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_VOLUME_VOLUMEBRICKSTORE_H
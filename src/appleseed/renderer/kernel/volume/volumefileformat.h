@@ -0,0 +1,105 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_VOLUME_VOLUMEFILEFORMAT_H
+#define APPLESEED_RENDERER_KERNEL_VOLUME_VOLUMEFILEFORMAT_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+
+namespace renderer {
+namespace volume_file_format {
+
+//
+// Layout of appleseed volume files (all values are in native byte order):
+//
+//   char[16]   signature
+//   uint16     version
+//   uint16     flags
+//   uint32     number of voxels along x
+//   uint32     number of voxels along y
+//   uint32     number of voxels along z
+//   uint32     brick size, in voxels
+//   uint32     number of channels
+//
+// followed by one ChannelNameSize-byte, zero-padded name for each channel, followed by
+// one BrickEntry for each brick of each channel (channels in order, bricks with x varying
+// fastest, then y, then z), followed by the brick data. Each channel is stored separately
+// so that channels can be loaded independently.
+//
+// Brick (bx, by, bz) holds the voxels [bx * BrickSize, min(bx * BrickSize + BrickSize, nx - 1)]
+// along x (and likewise along y and z), i.e. the voxels blended by linear lookups in the
+// brick, so that a lookup never needs more than one brick. Voxels are stored as floats,
+// with x varying fastest. Bricks whose voxels all have the same value have no data: their
+// entry has a zero size and their value is both the minimum and the maximum of the entry.
+//
+// Brick data are aligned on DataAlignment bytes.
+//
+
+const char Signature[16] =
+{
+    'A', 'P', 'P', 'L', 'E', 'S', 'E', 'E', 'D', 'V', 'O', 'L', 'U', 'M', 'E', 'S'
+};
+
+const foundation::uint16 Version = 1;
+
+// Conventional extension of volume files.
+const char Extension[] = ".avl";
+
+// Flags.
+const foundation::uint16 FlagCompressed = 1 << 0;  // bricks are compressed with LZ4
+
+// Size in bytes of the header.
+const size_t HeaderSize = sizeof(Signature) + 2 * sizeof(foundation::uint16) + 5 * sizeof(foundation::uint32);
+
+// Size in bytes of a channel name, including the terminating zero.
+const size_t ChannelNameSize = 32;
+
+// Alignment in bytes of brick data.
+const size_t DataAlignment = 16;
+
+// Location and value range of a brick in the file.
+struct BrickEntry
+{
+    foundation::uint64  m_offset;           // offset in bytes from the start of the file
+    foundation::uint64  m_size;             // size in bytes of the (possibly compressed) data, 0 for constant bricks
+    float               m_min;              // minimum value of the voxels of the brick
+    float               m_max;              // maximum value of the voxels of the brick
+};
+
+// Size in bytes of a brick entry in the file.
+const size_t BrickEntrySize = 2 * sizeof(foundation::uint64) + 2 * sizeof(float);
+
+}       // namespace volume_file_format
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_VOLUME_VOLUMEFILEFORMAT_H
@@ -0,0 +1,428 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "volumefilereader.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/platform/types.h"
+
+// lz4 headers.
+#include "lz4.h"
+
+// Boost headers.
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace boost;
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// VolumeFileReader class implementation.
+//
+
+namespace
+{
+    size_t get_brick_count(const size_t voxel_count, const size_t brick_size)
+    {
+        // Voxel centers span voxel_count - 1 intervals.
+        return max<size_t>((voxel_count - 1 + brick_size - 1) / brick_size, 1);
+    }
+
+    size_t get_brick_extent(const size_t voxel_count, const size_t brick_size, const size_t b)
+    {
+        const size_t first = b * brick_size;
+        const size_t last = min(first + brick_size, voxel_count - 1);
+        return last - first + 1;
+    }
+}
+
+struct VolumeFileReader::Impl
+{
+    string                                      m_filename;
+    auto_ptr<interprocess::file_mapping>        m_file_mapping;
+    auto_ptr<interprocess::mapped_region>       m_mapped_region;
+    const uint8*                                m_data;
+    size_t                                      m_data_size;
+    bool                                        m_compressed;
+    size_t                                      m_res[3];
+    size_t                                      m_brick_size;
+    size_t                                      m_brick_res[3];
+    size_t                                      m_bricks_per_channel;
+    vector<string>                              m_channel_names;
+    vector<volume_file_format::BrickEntry>      m_entries;
+
+    template <typename T>
+    void read(size_t& offset, T& object) const
+    {
+        if (offset + sizeof(T) > m_data_size)
+            throw ExceptionIOError("truncated volume file");
+
+        memcpy(&object, m_data + offset, sizeof(T));
+        offset += sizeof(T);
+    }
+
+    void open()
+    {
+        using namespace volume_file_format;
+
+        try
+        {
+            m_file_mapping.reset(
+                new interprocess::file_mapping(m_filename.c_str(), interprocess::read_only));
+            m_mapped_region.reset(
+                new interprocess::mapped_region(*m_file_mapping, interprocess::read_only));
+        }
+        catch (const interprocess::interprocess_exception& e)
+        {
+            throw ExceptionIOError(e.what());
+        }
+
+        m_data = static_cast<const uint8*>(m_mapped_region->get_address());
+        m_data_size = m_mapped_region->get_size();
+
+        // Check the signature.
+        if (m_data_size < HeaderSize || memcmp(m_data, Signature, sizeof(Signature)))
+            throw ExceptionIOError("invalid volume file signature");
+
+        size_t offset = sizeof(Signature);
+
+        uint16 version, flags;
+        read(offset, version);
+        read(offset, flags);
+
+        if (version != Version)
+            throw ExceptionIOError("unknown volume file format version");
+
+        m_compressed = (flags & FlagCompressed) != 0;
+
+        uint32 xres, yres, zres, brick_size, channel_count;
+        read(offset, xres);
+        read(offset, yres);
+        read(offset, zres);
+        read(offset, brick_size);
+        read(offset, channel_count);
+
+        if (xres == 0 || yres == 0 || zres == 0 ||
+            brick_size == 0 || brick_size > 1024 ||
+            channel_count == 0 || channel_count > 256)
+            throw ExceptionIOError("invalid volume file header");
+
+        m_res[0] = xres;
+        m_res[1] = yres;
+        m_res[2] = zres;
+        m_brick_size = brick_size;
+
+        for (size_t i = 0; i < 3; ++i)
+            m_brick_res[i] = get_brick_count(m_res[i], m_brick_size);
+
+        m_bricks_per_channel = m_brick_res[0] * m_brick_res[1] * m_brick_res[2];
+
+        // Read the channel names.
+        if (offset + channel_count * ChannelNameSize > m_data_size)
+            throw ExceptionIOError("truncated volume file");
+
+        m_channel_names.resize(channel_count);
+        for (size_t i = 0; i < channel_count; ++i)
+        {
+            const char* name = reinterpret_cast<const char*>(m_data + offset);
+            m_channel_names[i].assign(name, find(name, name + ChannelNameSize, '\0'));
+            offset += ChannelNameSize;
+        }
+
+        // Read the brick table.
+        const size_t entry_count = channel_count * m_bricks_per_channel;
+        if (entry_count > (m_data_size - offset) / BrickEntrySize)
+            throw ExceptionIOError("truncated volume file");
+
+        m_entries.resize(entry_count);
+        for (size_t i = 0; i < entry_count; ++i)
+        {
+            BrickEntry& entry = m_entries[i];
+            read(offset, entry.m_offset);
+            read(offset, entry.m_size);
+            read(offset, entry.m_min);
+            read(offset, entry.m_max);
+
+            if (entry.m_offset > m_data_size || entry.m_size > m_data_size - entry.m_offset)
+                throw ExceptionIOError("invalid volume file brick table");
+        }
+    }
+
+    void close()
+    {
+        m_mapped_region.reset();
+        m_file_mapping.reset();
+        m_data = 0;
+        m_data_size = 0;
+        m_channel_names.clear();
+        m_entries.clear();
+    }
+
+    size_t get_entry_index(
+        const size_t        channel_index,
+        const size_t        bx,
+        const size_t        by,
+        const size_t        bz) const
+    {
+        assert(channel_index < m_channel_names.size());
+        assert(bx < m_brick_res[0]);
+        assert(by < m_brick_res[1]);
+        assert(bz < m_brick_res[2]);
+
+        return
+              channel_index * m_bricks_per_channel
+            + (bz * m_brick_res[1] + by) * m_brick_res[0] + bx;
+    }
+};
+
+VolumeFileReader::VolumeFileReader()
+  : impl(new Impl())
+{
+    impl->m_data = 0;
+    impl->m_data_size = 0;
+    impl->m_compressed = false;
+}
+
+VolumeFileReader::~VolumeFileReader()
+{
+    if (is_open())
+        close();
+
+    delete impl;
+}
+
+void VolumeFileReader::open(const char* filename)
+{
+    assert(filename);
+    assert(!is_open());
+
+    impl->m_filename = filename;
+
+    try
+    {
+        impl->open();
+    }
+    catch (...)
+    {
+        impl->close();
+        throw;
+    }
+}
+
+void VolumeFileReader::close()
+{
+    assert(is_open());
+
+    impl->close();
+}
+
+bool VolumeFileReader::is_open() const
+{
+    return impl->m_data != 0;
+}
+
+const char* VolumeFileReader::get_filename() const
+{
+    return impl->m_filename.c_str();
+}
+
+bool VolumeFileReader::is_compressed() const
+{
+    assert(is_open());
+
+    return impl->m_compressed;
+}
+
+size_t VolumeFileReader::get_xres() const
+{
+    assert(is_open());
+
+    return impl->m_res[0];
+}
+
+size_t VolumeFileReader::get_yres() const
+{
+    assert(is_open());
+
+    return impl->m_res[1];
+}
+
+size_t VolumeFileReader::get_zres() const
+{
+    assert(is_open());
+
+    return impl->m_res[2];
+}
+
+size_t VolumeFileReader::get_brick_size() const
+{
+    assert(is_open());
+
+    return impl->m_brick_size;
+}
+
+size_t VolumeFileReader::get_brick_xres() const
+{
+    assert(is_open());
+
+    return impl->m_brick_res[0];
+}
+
+size_t VolumeFileReader::get_brick_yres() const
+{
+    assert(is_open());
+
+    return impl->m_brick_res[1];
+}
+
+size_t VolumeFileReader::get_brick_zres() const
+{
+    assert(is_open());
+
+    return impl->m_brick_res[2];
+}
+
+size_t VolumeFileReader::get_channel_count() const
+{
+    assert(is_open());
+
+    return impl->m_channel_names.size();
+}
+
+const char* VolumeFileReader::get_channel_name(const size_t channel_index) const
+{
+    assert(is_open());
+    assert(channel_index < impl->m_channel_names.size());
+
+    return impl->m_channel_names[channel_index].c_str();
+}
+
+size_t VolumeFileReader::find_channel(const char* name) const
+{
+    assert(is_open());
+    assert(name);
+
+    for (size_t i = 0, e = impl->m_channel_names.size(); i < e; ++i)
+    {
+        if (impl->m_channel_names[i] == name)
+            return i;
+    }
+
+    return NotFound;
+}
+
+const volume_file_format::BrickEntry& VolumeFileReader::get_brick_entry(
+    const size_t        channel_index,
+    const size_t        bx,
+    const size_t        by,
+    const size_t        bz) const
+{
+    assert(is_open());
+
+    return impl->m_entries[impl->get_entry_index(channel_index, bx, by, bz)];
+}
+
+void VolumeFileReader::get_brick_dimensions(
+    const size_t        bx,
+    const size_t        by,
+    const size_t        bz,
+    size_t&             width,
+    size_t&             height,
+    size_t&             depth) const
+{
+    assert(is_open());
+
+    width = get_brick_extent(impl->m_res[0], impl->m_brick_size, bx);
+    height = get_brick_extent(impl->m_res[1], impl->m_brick_size, by);
+    depth = get_brick_extent(impl->m_res[2], impl->m_brick_size, bz);
+}
+
+void VolumeFileReader::read_brick(
+    const size_t        channel_index,
+    const size_t        bx,
+    const size_t        by,
+    const size_t        bz,
+    float*              values) const
+{
+    assert(is_open());
+    assert(values);
+
+    const volume_file_format::BrickEntry& entry =
+        impl->m_entries[impl->get_entry_index(channel_index, bx, by, bz)];
+
+    size_t width, height, depth;
+    get_brick_dimensions(bx, by, bz, width, height, depth);
+
+    const size_t value_count = width * height * depth;
+    const size_t size = value_count * sizeof(float);
+
+    // Constant bricks have no data.
+    if (entry.m_size == 0)
+    {
+        fill(values, values + value_count, entry.m_min);
+        return;
+    }
+
+    const uint8* data = impl->m_data + entry.m_offset;
+
+    if (!impl->m_compressed)
+    {
+        if (entry.m_size != size)
+            throw ExceptionIOError("invalid volume file brick size");
+
+        memcpy(values, data, size);
+        return;
+    }
+
+    const int decompressed_size =
+        LZ4_decompress_safe(
+            reinterpret_cast<const char*>(data),
+            reinterpret_cast<char*>(values),
+            static_cast<int>(entry.m_size),
+            static_cast<int>(size));
+
+    if (decompressed_size != static_cast<int>(size))
+        throw ExceptionIOError("failed to decompress volume file brick");
+}
+
+}   // namespace renderer
@@ -0,0 +1,139 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_VOLUME_VOLUMEFILEREADER_H
+#define APPLESEED_RENDERER_KERNEL_VOLUME_VOLUMEFILEREADER_H
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/volumefileformat.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+namespace renderer
+{
+
+//
+// Reader for the appleseed volume file format (see renderer::VolumeFileWriter).
+//
+// The file is memory-mapped: opening a file only reads its header, its channel
+// names and its brick table, and the voxels of a brick are only read from the
+// mapping (and decompressed if needed) when the brick is requested.
+//
+// Throws a foundation::ExceptionIOError when the file is invalid.
+// This class is thread-safe once a file is open.
+//
+
+class APPLESEED_DLLSYMBOL VolumeFileReader
+  : public foundation::NonCopyable
+{
+  public:
+    // Value returned by find_channel() when a channel does not exist.
+    static const size_t NotFound = ~size_t(0);
+
+    // Constructor.
+    VolumeFileReader();
+
+    // Destructor.
+    ~VolumeFileReader();
+
+    // Open a volume file.
+    void open(const char* filename);
+
+    // Close the volume file.
+    void close();
+
+    // Return true if a volume file is currently open.
+    bool is_open() const;
+
+    // Return the path of the volume file.
+    const char* get_filename() const;
+
+    // Return true if bricks are stored compressed.
+    bool is_compressed() const;
+
+    // Return the number of voxels in each dimension.
+    size_t get_xres() const;
+    size_t get_yres() const;
+    size_t get_zres() const;
+
+    // Return the size of a brick in voxels.
+    size_t get_brick_size() const;
+
+    // Return the number of bricks in each dimension.
+    size_t get_brick_xres() const;
+    size_t get_brick_yres() const;
+    size_t get_brick_zres() const;
+
+    // Return the number of channels and the name of a given channel.
+    size_t get_channel_count() const;
+    const char* get_channel_name(const size_t channel_index) const;
+
+    // Return the index of the channel with a given name, or NotFound.
+    size_t find_channel(const char* name) const;
+
+    // Return the entry of a given brick of a given channel.
+    const volume_file_format::BrickEntry& get_brick_entry(
+        const size_t        channel_index,
+        const size_t        bx,
+        const size_t        by,
+        const size_t        bz) const;
+
+    // Return the number of voxels stored in a given brick in each dimension.
+    void get_brick_dimensions(
+        const size_t        bx,
+        const size_t        by,
+        const size_t        bz,
+        size_t&             width,
+        size_t&             height,
+        size_t&             depth) const;
+
+    // Read the voxels of a given brick of a given channel. 'values' must have room
+    // for width * height * depth values, as returned by get_brick_dimensions().
+    void read_brick(
+        const size_t        channel_index,
+        const size_t        bx,
+        const size_t        by,
+        const size_t        bz,
+        float*              values) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_VOLUME_VOLUMEFILEREADER_H
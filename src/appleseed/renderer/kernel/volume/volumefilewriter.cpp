@@ -0,0 +1,277 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "volumefilewriter.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/volumefileformat.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/bufferedfile.h"
+
+// lz4 headers.
+#include "lz4.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// VolumeFileWriter class implementation.
+//
+
+namespace
+{
+    typedef vector<uint8> Blob;
+
+    template <typename T>
+    void checked_write(BufferedFile& file, const T& object)
+    {
+        if (file.write(object) != sizeof(T))
+            throw ExceptionIOError();
+    }
+
+    void checked_write(BufferedFile& file, const void* inbuf, const size_t size)
+    {
+        if (size > 0 && file.write(inbuf, size) != size)
+            throw ExceptionIOError();
+    }
+
+    size_t get_brick_count(const size_t voxel_count, const size_t brick_size)
+    {
+        // Voxel centers span voxel_count - 1 intervals.
+        return max<size_t>((voxel_count - 1 + brick_size - 1) / brick_size, 1);
+    }
+
+    // Gather the voxels of a brick of a channel, and return the range of their values.
+    void gather_brick(
+        const VoxelGrid&    grid,
+        const size_t        channel_index,
+        const size_t        brick_size,
+        const size_t        bx,
+        const size_t        by,
+        const size_t        bz,
+        vector<float>&      values,
+        float&              min_value,
+        float&              max_value)
+    {
+        const size_t x0 = bx * brick_size, x1 = min(x0 + brick_size, grid.get_xres() - 1);
+        const size_t y0 = by * brick_size, y1 = min(y0 + brick_size, grid.get_yres() - 1);
+        const size_t z0 = bz * brick_size, z1 = min(z0 + brick_size, grid.get_zres() - 1);
+
+        values.clear();
+        min_value = grid.voxel(x0, y0, z0)[channel_index];
+        max_value = min_value;
+
+        for (size_t z = z0; z <= z1; ++z)
+        {
+            for (size_t y = y0; y <= y1; ++y)
+            {
+                for (size_t x = x0; x <= x1; ++x)
+                {
+                    const float value = grid.voxel(x, y, z)[channel_index];
+                    values.push_back(value);
+                    min_value = min(min_value, value);
+                    max_value = max(max_value, value);
+                }
+            }
+        }
+    }
+
+    // Store the voxels of a brick, optionally compressing them.
+    void store_brick(
+        const vector<float>&    values,
+        const bool              compress,
+        Blob&                   blob)
+    {
+        const uint8* storage = reinterpret_cast<const uint8*>(&values[0]);
+        const size_t size = values.size() * sizeof(float);
+
+        if (compress)
+        {
+            blob.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(size))));
+
+            const int compressed_size =
+                LZ4_compress(
+                    reinterpret_cast<const char*>(storage),
+                    reinterpret_cast<char*>(&blob[0]),
+                    static_cast<int>(size));
+
+            if (compressed_size <= 0)
+                throw ExceptionIOError("failed to compress volume brick");
+
+            blob.resize(static_cast<size_t>(compressed_size));
+        }
+        else blob.assign(storage, storage + size);
+    }
+}
+
+VolumeFileWriter::VolumeFileWriter(
+    const char*                 filename,
+    const int                   options,
+    const size_t                brick_size)
+  : m_filename(filename)
+  , m_options(options)
+  , m_brick_size(brick_size)
+{
+    assert(brick_size > 0);
+}
+
+void VolumeFileWriter::write(
+    const VoxelGrid&            grid,
+    const vector<string>&       channel_names)
+{
+    using namespace volume_file_format;
+
+    assert(channel_names.size() == grid.get_channel_count());
+
+    for (size_t i = 0; i < channel_names.size(); ++i)
+    {
+        if (channel_names[i].size() >= ChannelNameSize)
+            throw ExceptionIOError("volume channel name is too long");
+    }
+
+    const bool compress = (m_options & Compress) != 0;
+
+    const size_t brick_xres = get_brick_count(grid.get_xres(), m_brick_size);
+    const size_t brick_yres = get_brick_count(grid.get_yres(), m_brick_size);
+    const size_t brick_zres = get_brick_count(grid.get_zres(), m_brick_size);
+
+    // Store the bricks of all channels. Constant bricks are left empty.
+    vector<BrickEntry> entries;
+    vector<Blob> blobs;
+    vector<float> values;
+
+    for (size_t c = 0; c < grid.get_channel_count(); ++c)
+    {
+        for (size_t bz = 0; bz < brick_zres; ++bz)
+        {
+            for (size_t by = 0; by < brick_yres; ++by)
+            {
+                for (size_t bx = 0; bx < brick_xres; ++bx)
+                {
+                    BrickEntry entry;
+                    gather_brick(grid, c, m_brick_size, bx, by, bz, values, entry.m_min, entry.m_max);
+                    entries.push_back(entry);
+
+                    blobs.push_back(Blob());
+                    if (entry.m_min != entry.m_max)
+                        store_brick(values, compress, blobs.back());
+                }
+            }
+        }
+    }
+
+    // Compute the location of the bricks in the file.
+    uint64 offset =
+          HeaderSize
+        + channel_names.size() * ChannelNameSize
+        + entries.size() * BrickEntrySize;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        if (blobs[i].empty())
+        {
+            entries[i].m_offset = 0;
+            entries[i].m_size = 0;
+            continue;
+        }
+
+        offset = (offset + DataAlignment - 1) & ~static_cast<uint64>(DataAlignment - 1);
+        entries[i].m_offset = offset;
+        entries[i].m_size = blobs[i].size();
+        offset += entries[i].m_size;
+    }
+
+    BufferedFile file(
+        m_filename.c_str(),
+        BufferedFile::BinaryType,
+        BufferedFile::WriteMode);
+
+    if (!file.is_open())
+        throw ExceptionIOError("failed to open volume file for writing");
+
+    // Write the header.
+    checked_write(file, Signature, sizeof(Signature));
+    checked_write(file, Version);
+    checked_write(file, compress ? FlagCompressed : static_cast<uint16>(0));
+    checked_write(file, static_cast<uint32>(grid.get_xres()));
+    checked_write(file, static_cast<uint32>(grid.get_yres()));
+    checked_write(file, static_cast<uint32>(grid.get_zres()));
+    checked_write(file, static_cast<uint32>(m_brick_size));
+    checked_write(file, static_cast<uint32>(channel_names.size()));
+
+    // Write the channel names.
+    for (size_t i = 0; i < channel_names.size(); ++i)
+    {
+        char name[ChannelNameSize];
+        memset(name, 0, sizeof(name));
+        memcpy(name, channel_names[i].c_str(), channel_names[i].size());
+        checked_write(file, name, sizeof(name));
+    }
+
+    // Write the brick table.
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        checked_write(file, entries[i].m_offset);
+        checked_write(file, entries[i].m_size);
+        checked_write(file, entries[i].m_min);
+        checked_write(file, entries[i].m_max);
+    }
+
+    // Write the brick data.
+    uint64 position =
+          HeaderSize
+        + channel_names.size() * ChannelNameSize
+        + entries.size() * BrickEntrySize;
+    const uint8 Padding[DataAlignment] = { 0 };
+    for (size_t i = 0; i < blobs.size(); ++i)
+    {
+        if (blobs[i].empty())
+            continue;
+
+        checked_write(file, Padding, static_cast<size_t>(entries[i].m_offset - position));
+        checked_write(file, &blobs[i][0], blobs[i].size());
+        position = entries[i].m_offset + entries[i].m_size;
+    }
+
+    file.close();
+}
+
+}   // namespace renderer
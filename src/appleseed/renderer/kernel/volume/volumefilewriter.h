@@ -0,0 +1,90 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_VOLUME_VOLUMEFILEWRITER_H
+#define APPLESEED_RENDERER_KERNEL_VOLUME_VOLUMEFILEWRITER_H
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/volume.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// Writer for the appleseed volume file format.
+//
+// Volume files store each channel of a voxel grid as a sequence of cubic bricks,
+// optionally compressed with LZ4. Bricks whose voxels all have the same value (in
+// particular empty bricks) are not stored. Volume files are designed to be memory-
+// mapped by renderer::VolumeFileReader so that only the bricks of the channels
+// actually used by the renderer need to be loaded, and only when they are needed.
+//
+
+class APPLESEED_DLLSYMBOL VolumeFileWriter
+  : public foundation::NonCopyable
+{
+  public:
+    enum Options
+    {
+        Defaults        = 0,
+        Compress        = 1 << 0        // compress bricks with LZ4
+    };
+
+    // Constructor.
+    explicit VolumeFileWriter(
+        const char*                     filename,
+        const int                       options = Defaults,
+        const size_t                    brick_size = 16);
+
+    // Write a voxel grid to disk. There must be one name per channel of the grid.
+    // Throws a foundation::ExceptionIOError.
+    void write(
+        const VoxelGrid&                grid,
+        const std::vector<std::string>& channel_names);
+
+  private:
+    const std::string                   m_filename;
+    const int                           m_options;
+    const size_t                        m_brick_size;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_VOLUME_VOLUMEFILEWRITER_H
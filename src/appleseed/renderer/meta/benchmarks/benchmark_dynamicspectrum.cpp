@@ -0,0 +1,119 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/utility/dynamicspectrum.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/benchmark.h"
+
+using namespace foundation;
+using namespace renderer;
+
+BENCHMARK_SUITE(Renderer_Utility_DynamicSpectrum31f)
+{
+    typedef DynamicSpectrum<float, 31> Spectrum31f;
+
+    struct Fixture
+    {
+        Spectrum31f m_spectrum1;
+        Spectrum31f m_spectrum2;
+        Spectrum31f m_spectrum3;
+
+        Fixture()
+        {
+            float values[31];
+
+            for (size_t i = 0; i < 31; ++i)
+                values[i] = 0.1f * i - 1.0f;
+
+            m_spectrum1 = Spectrum31f(values);
+
+            for (size_t i = 0; i < 31; ++i)
+                values[i] = 1.1f;
+
+            m_spectrum2 = Spectrum31f(values);
+
+            for (size_t i = 0; i < 31; ++i)
+                values[i] = 0.5f;
+
+            m_spectrum3 = Spectrum31f(values);
+        }
+    };
+
+    BENCHMARK_CASE_F(InPlaceAddition, Fixture)
+    {
+        m_spectrum1 += m_spectrum2;
+    }
+
+    BENCHMARK_CASE_F(InPlaceSubtraction, Fixture)
+    {
+        m_spectrum1 -= m_spectrum2;
+    }
+
+    BENCHMARK_CASE_F(InPlaceMultiplicationByScalar, Fixture)
+    {
+        m_spectrum1 *= 1.1f;
+    }
+
+    BENCHMARK_CASE_F(InPlaceMultiplicationBySpectrum, Fixture)
+    {
+        m_spectrum1 *= m_spectrum2;
+    }
+
+    BENCHMARK_CASE_F(MultiplyAddBySpectrum, Fixture)
+    {
+        madd(m_spectrum1, m_spectrum2, m_spectrum3);
+    }
+
+    BENCHMARK_CASE_F(MultiplyAddByScalar, Fixture)
+    {
+        madd(m_spectrum1, m_spectrum2, 0.5f);
+    }
+
+    BENCHMARK_CASE_F(Clamp, Fixture)
+    {
+        m_spectrum3 = clamp(m_spectrum1, 0.0f, 1.0f);
+    }
+
+    BENCHMARK_CASE_F(InPlaceClamp, Fixture)
+    {
+        clamp_in_place(m_spectrum1, 0.0f, 1.0f);
+    }
+
+    BENCHMARK_CASE_F(InPlaceClampLow, Fixture)
+    {
+        clamp_low_in_place(m_spectrum1, 0.0f);
+    }
+
+    BENCHMARK_CASE_F(Exp, Fixture)
+    {
+        m_spectrum3 = exp(m_spectrum1);
+    }
+}
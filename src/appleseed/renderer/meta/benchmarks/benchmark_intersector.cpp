@@ -0,0 +1,329 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/assemblytree.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/input/inputbinder.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectprimitives.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/basis.h"
+#include "foundation/math/matrix.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Kernel_Intersection_Intersector)
+{
+    //
+    // The benchmark scene is made of a finely tessellated sphere sitting on a
+    // large grid and surrounded by a torus, for a total of about 300K triangles.
+    //
+
+    struct TestScene
+    {
+        auto_release_ptr<Scene> m_scene;
+
+        TestScene()
+          : m_scene(SceneFactory::create())
+        {
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", ParamArray()));
+
+            create_primitive(
+                assembly.ref(),
+                "sphere",
+                ParamArray()
+                    .insert("primitive", "sphere")
+                    .insert("resolution_u", 512)
+                    .insert("resolution_v", 256)
+                    .insert("radius", 1.0),
+                Matrix4d::identity());
+
+            create_primitive(
+                assembly.ref(),
+                "torus",
+                ParamArray()
+                    .insert("primitive", "torus")
+                    .insert("resolution_u", 256)
+                    .insert("resolution_v", 64)
+                    .insert("major_radius", 2.0)
+                    .insert("minor_radius", 0.4),
+                Matrix4d::make_rotation_x(Pi<double>() / 6.0));
+
+            create_primitive(
+                assembly.ref(),
+                "grid",
+                ParamArray()
+                    .insert("primitive", "grid")
+                    .insert("resolution_u", 64)
+                    .insert("resolution_v", 64)
+                    .insert("width", 20.0)
+                    .insert("height", 20.0),
+                Matrix4d::make_translation(Vector3d(0.0, -1.0, 0.0)));
+
+            m_scene->assembly_instances().insert(
+                AssemblyInstanceFactory::create(
+                    "assembly_instance",
+                    ParamArray(),
+                    "assembly"));
+
+            m_scene->assemblies().insert(assembly);
+
+            InputBinder input_binder;
+            input_binder.bind(m_scene.ref());
+            assert(input_binder.get_error_count() == 0);
+        }
+
+        static void create_primitive(
+            Assembly&           assembly,
+            const char*         name,
+            const ParamArray&   params,
+            const Matrix4d&     transform)
+        {
+            auto_release_ptr<MeshObject> mesh_object = create_primitive_mesh(name, params);
+            assert(mesh_object.get());
+
+            assembly.objects().insert(auto_release_ptr<Object>(mesh_object));
+
+            const string instance_name = string(name) + "_inst";
+            assembly.object_instances().insert(
+                ObjectInstanceFactory::create(
+                    instance_name.c_str(),
+                    ParamArray(),
+                    name,
+                    Transformd::from_local_to_parent(transform),
+                    StringDictionary()));
+        }
+    };
+
+    BENCHMARK_CASE_F(BuildAccelerationStructures, TestScene)
+    {
+        TraceContext trace_context(m_scene.ref());
+        trace_context.update();
+    }
+
+    //
+    // Ray distributions.
+    //
+    //   Primary:   coherent rays shot from a pinhole-like camera toward the scene.
+    //   Diffuse:   incoherent rays leaving the first hits of the primary rays,
+    //              distributed according to a cosine-weighted hemisphere.
+    //   Shadow:    rays of finite length going from the first hits of the
+    //              primary rays toward a point light.
+    //
+
+    struct Fixture
+      : public TestScene
+    {
+        static const size_t RayCount = 1024;
+
+        TraceContext        m_trace_context;
+        TextureStore        m_texture_store;
+        TextureCache        m_texture_cache;
+        Intersector         m_intersector;
+
+        vector<ShadingRay>  m_primary_rays;
+        vector<ShadingRay>  m_diffuse_rays;
+        vector<ShadingRay>  m_shadow_rays;
+
+        ShadingPoint        m_shading_point;
+        size_t              m_hit_count;
+
+        Fixture()
+          : m_trace_context(m_scene.ref())
+          , m_texture_store(m_scene.ref())
+          , m_texture_cache(m_texture_store)
+          , m_intersector(m_trace_context, m_texture_cache)
+          , m_hit_count(0)
+        {
+            m_trace_context.update();
+
+            const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
+            RENDERER_LOG_INFO(
+                "intersector benchmark scene: assembly tree uses %s, triangle trees use %s.",
+                pretty_size(assembly_tree.get_memory_size()).c_str(),
+                pretty_size(assembly_tree.get_triangle_trees_memory_size()).c_str());
+
+            generate_rays();
+        }
+
+        void generate_rays()
+        {
+            MersenneTwister rng;
+
+            const Vector3d camera_position(0.0, 2.0, 6.0);
+            const Vector3d light_position(4.0, 6.0, 3.0);
+            const Basis3d camera_basis(normalize(-camera_position));
+
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                // Primary ray.
+                const double x = rand_double2(rng, -0.5, 0.5);
+                const double y = rand_double2(rng, -0.5, 0.5);
+                const Vector3d primary_dir =
+                    normalize(
+                        camera_basis.get_normal() +
+                        x * camera_basis.get_tangent_u() +
+                        y * camera_basis.get_tangent_v());
+                m_primary_rays.push_back(make_ray(camera_position, primary_dir, VisibilityFlags::CameraRay, 0));
+
+                ShadingPoint shading_point;
+                if (!m_intersector.trace(m_primary_rays.back(), shading_point))
+                    continue;
+
+                const Vector3d& point = shading_point.get_point();
+                Vector3d normal = shading_point.get_geometric_normal();
+                if (dot(normal, primary_dir) > 0.0)
+                    normal = -normal;
+
+                // Diffuse ray.
+                Vector2d s;
+                s[0] = rand_double2(rng);
+                s[1] = rand_double2(rng);
+                const Vector3d diffuse_dir =
+                    Basis3d(normal).transform_to_parent(sample_hemisphere_cosine(s));
+                m_diffuse_rays.push_back(
+                    make_ray(
+                        shading_point.get_biased_point(diffuse_dir),
+                        diffuse_dir,
+                        VisibilityFlags::DiffuseRay,
+                        1));
+
+                // Shadow ray.
+                const Vector3d to_light = light_position - point;
+                const Vector3d shadow_origin = shading_point.get_biased_point(to_light);
+                m_shadow_rays.push_back(
+                    make_ray(
+                        shadow_origin,
+                        to_light,
+                        VisibilityFlags::ShadowRay,
+                        1,
+                        1.0 - 1.0e-6));
+            }
+        }
+
+        static ShadingRay make_ray(
+            const Vector3d&                 org,
+            const Vector3d&                 dir,
+            const VisibilityFlags::Type     flags,
+            const ShadingRay::DepthType     depth,
+            const double                    tmax = numeric_limits<double>::max())
+        {
+            return
+                ShadingRay(
+                    org,
+                    dir,
+                    0.0,                    // tmin
+                    tmax,
+                    ShadingRay::Time(),
+                    flags,
+                    depth);
+        }
+
+        void trace(const vector<ShadingRay>& rays)
+        {
+            for (size_t i = 0, e = rays.size(); i < e; ++i)
+            {
+                m_shading_point.clear();
+                if (m_intersector.trace(rays[i], m_shading_point))
+                    ++m_hit_count;
+            }
+        }
+
+        void trace_probe(const vector<ShadingRay>& rays)
+        {
+            for (size_t i = 0, e = rays.size(); i < e; ++i)
+            {
+                if (m_intersector.trace_probe(rays[i]))
+                    ++m_hit_count;
+            }
+        }
+    };
+
+    BENCHMARK_CASE_F(Trace_PrimaryRays, Fixture)
+    {
+        trace(m_primary_rays);
+    }
+
+    BENCHMARK_CASE_F(TraceProbe_PrimaryRays, Fixture)
+    {
+        trace_probe(m_primary_rays);
+    }
+
+    BENCHMARK_CASE_F(Trace_DiffuseRays, Fixture)
+    {
+        trace(m_diffuse_rays);
+    }
+
+    BENCHMARK_CASE_F(TraceProbe_DiffuseRays, Fixture)
+    {
+        trace_probe(m_diffuse_rays);
+    }
+
+    BENCHMARK_CASE_F(TraceProbe_ShadowRays, Fixture)
+    {
+        trace_probe(m_shadow_rays);
+    }
+}
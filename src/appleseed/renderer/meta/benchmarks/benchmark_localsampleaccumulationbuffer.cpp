@@ -28,6 +28,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/rendering/localsampleaccumulationbuffer.h"
+#include "renderer/kernel/rendering/sample.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/filteredtile.h"
@@ -35,11 +36,19 @@
 #include "foundation/image/tile.h"
 #include "foundation/math/aabb.h"
 #include "foundation/math/filter.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
 #include "foundation/math/vector.h"
 #include "foundation/utility/benchmark.h"
+#include "foundation/utility/job/abortswitch.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
 
 using namespace foundation;
 using namespace renderer;
+using namespace std;
 
 BENCHMARK_SUITE(Renderer_Kernel_Rendering_LocalSampleAccumulationBuffer)
 {
@@ -67,7 +76,7 @@ BENCHMARK_SUITE(Renderer_Kernel_Rendering_LocalSampleAccumulationBuffer)
         LocalSampleAccumulationBuffer::develop_to_tile_undo_premult_alpha(
             m_color_tile,
             m_depth_tile,
-            1024, 1024,
+            AABB2u(Vector2u(0, 0), Vector2u(1023, 1023)),
             m_level,
             0, 0,
             m_rect);
@@ -78,7 +87,7 @@ BENCHMARK_SUITE(Renderer_Kernel_Rendering_LocalSampleAccumulationBuffer)
         LocalSampleAccumulationBuffer::develop_to_tile_undo_premult_alpha(
             m_color_tile,
             m_depth_tile,
-            1025, 1025,
+            AABB2u(Vector2u(0, 0), Vector2u(1024, 1024)),
             m_level,
             0, 0,
             m_rect);
@@ -89,7 +98,7 @@ BENCHMARK_SUITE(Renderer_Kernel_Rendering_LocalSampleAccumulationBuffer)
         LocalSampleAccumulationBuffer::develop_to_tile(
             m_color_tile,
             m_depth_tile,
-            1024, 1024,
+            AABB2u(Vector2u(0, 0), Vector2u(1023, 1023)),
             m_level,
             0, 0,
             m_rect);
@@ -100,9 +109,39 @@ BENCHMARK_SUITE(Renderer_Kernel_Rendering_LocalSampleAccumulationBuffer)
         LocalSampleAccumulationBuffer::develop_to_tile(
             m_color_tile,
             m_depth_tile,
-            1025, 1025,
+            AABB2u(Vector2u(0, 0), Vector2u(1024, 1024)),
             m_level,
             0, 0,
             m_rect);
     }
+
+    struct StoreSamplesFixture
+    {
+        BlackmanHarrisFilter2<float>    m_filter;
+        LocalSampleAccumulationBuffer   m_buffer;
+        vector<Sample>                  m_samples;
+        AbortSwitch                     m_abort_switch;
+
+        StoreSamplesFixture()
+          : m_filter(1.5f, 1.5f)
+          , m_buffer(512, 512, m_filter)
+          , m_samples(1024)
+        {
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < m_samples.size(); ++i)
+            {
+                m_samples[i].m_position.x = rand_float2(rng);
+                m_samples[i].m_position.y = rand_float2(rng);
+
+                for (size_t c = 0; c < 5; ++c)
+                    m_samples[i].m_values[c] = 1.0f;
+            }
+        }
+    };
+
+    BENCHMARK_CASE_F(StoreSamples, StoreSamplesFixture)
+    {
+        m_buffer.store_samples(m_samples.size(), &m_samples[0], m_abort_switch);
+    }
 }
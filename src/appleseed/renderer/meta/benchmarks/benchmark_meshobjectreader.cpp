@@ -0,0 +1,154 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectreader.h"
+#include "renderer/modeling/object/meshobjectwriter.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/searchpaths.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+namespace bf = boost::filesystem;
+
+BENCHMARK_SUITE(Renderer_Modeling_Object_MeshObjectReader)
+{
+    // Write a square grid of quads, each split into two triangles, to a mesh file.
+    string write_grid_mesh_file(const size_t resolution, const char* extension)
+    {
+        auto_release_ptr<MeshObject> object(MeshObjectFactory::create("grid", ParamArray()));
+
+        for (size_t y = 0; y <= resolution; ++y)
+        {
+            for (size_t x = 0; x <= resolution; ++x)
+            {
+                object->push_vertex(GVector3(static_cast<GScalar>(x), 0.0f, static_cast<GScalar>(y)));
+                object->push_tex_coords(GVector2(static_cast<GScalar>(x), static_cast<GScalar>(y)) / static_cast<GScalar>(resolution));
+            }
+        }
+
+        object->push_vertex_normal(GVector3(0.0f, 1.0f, 0.0f));
+        object->push_material_slot("material");
+
+        for (size_t y = 0; y < resolution; ++y)
+        {
+            for (size_t x = 0; x < resolution; ++x)
+            {
+                const size_t v0 = y * (resolution + 1) + x;
+                const size_t v1 = v0 + 1;
+                const size_t v2 = v0 + resolution + 2;
+                const size_t v3 = v0 + resolution + 1;
+                object->push_triangle(Triangle(v0, v1, v2, 0, 0, 0, v0, v1, v2, 0));
+                object->push_triangle(Triangle(v0, v2, v3, 0, 0, 0, v0, v2, v3, 0));
+            }
+        }
+
+        const string filename =
+            "unit benchmarks/outputs/benchmark_meshobjectreader_" +
+            to_string(resolution) + "." + extension;
+
+        MeshObjectWriter::write(object.ref(), "grid", filename.c_str());
+
+        return filename;
+    }
+
+    template <size_t Resolution>
+    struct Fixture
+    {
+        const string    m_obj_filename;
+        const string    m_binarymesh_filename;
+        const size_t    m_obj_file_size;
+        const size_t    m_binarymesh_file_size;
+
+        Fixture()
+          : m_obj_filename(write_grid_mesh_file(Resolution, "obj"))
+          , m_binarymesh_filename(write_grid_mesh_file(Resolution, "binarymesh"))
+          , m_obj_file_size(static_cast<size_t>(bf::file_size(m_obj_filename)))
+          , m_binarymesh_file_size(static_cast<size_t>(bf::file_size(m_binarymesh_filename)))
+        {
+        }
+
+        static size_t get_triangle_count()
+        {
+            return 2 * Resolution * Resolution;
+        }
+
+        static void read(const string& filename)
+        {
+            MeshObjectArray objects;
+            MeshObjectReader::read(
+                SearchPaths(),
+                "grid",
+                ParamArray().insert("filename", filename),
+                objects);
+
+            for (size_t i = 0; i < objects.size(); ++i)
+                objects[i]->release();
+        }
+    };
+
+    // Small, medium and large grids: 2,048, 32,768 and 524,288 triangles.
+
+#define DEFINE_READ_BENCHMARK_CASES(Resolution, Count)                                          \
+    BENCHMARK_CASE_F(ReadOBJFile_##Count##Triangles, Fixture<Resolution>)                       \
+    {                                                                                           \
+        set_processed_bytes(m_obj_file_size);                                                   \
+        set_processed_items(get_triangle_count());                                              \
+        read(m_obj_filename);                                                                   \
+    }                                                                                           \
+                                                                                                \
+    BENCHMARK_CASE_F(ReadBinaryMeshFile_##Count##Triangles, Fixture<Resolution>)                \
+    {                                                                                           \
+        set_processed_bytes(m_binarymesh_file_size);                                            \
+        set_processed_items(get_triangle_count());                                              \
+        read(m_binarymesh_filename);                                                            \
+    }
+
+    DEFINE_READ_BENCHMARK_CASES(32, 2K)
+    DEFINE_READ_BENCHMARK_CASES(128, 32K)
+    DEFINE_READ_BENCHMARK_CASES(512, 512K)
+
+#undef DEFINE_READ_BENCHMARK_CASES
+}
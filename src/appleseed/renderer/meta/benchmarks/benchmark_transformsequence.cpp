@@ -71,4 +71,58 @@ BENCHMARK_SUITE(Renderer_Utility_TransformSequence)
     {
         m_motion_bbox = m_sequence.to_parent(m_bbox);
     }
+
+    struct EvaluateFixture
+    {
+        TransformSequence   m_rotating_sequence;
+        TransformSequence   m_translating_sequence;
+        Transformd          m_scratch;
+        double              m_dummy;
+
+        EvaluateFixture()
+          : m_dummy(0.0)
+        {
+            const Vector3d axis = normalize(Vector3d(0.1, 0.2, 1.0));
+
+            m_rotating_sequence.set_transform(
+                0.0f,
+                Transformd::from_local_to_parent(
+                    Matrix4d::make_rotation(axis, 0.0)));
+            m_rotating_sequence.set_transform(
+                1.0f,
+                Transformd::from_local_to_parent(
+                    Matrix4d::make_rotation(axis, HalfPi<double>())));
+            m_rotating_sequence.prepare();
+
+            m_translating_sequence.set_transform(
+                0.0f,
+                Transformd::from_local_to_parent(
+                    Matrix4d::make_translation(Vector3d(1.0, 2.0, 3.0)) *
+                    Matrix4d::make_rotation(axis, 0.5)));
+            m_translating_sequence.set_transform(
+                1.0f,
+                Transformd::from_local_to_parent(
+                    Matrix4d::make_translation(Vector3d(4.0, 5.0, 6.0)) *
+                    Matrix4d::make_rotation(axis, 0.5)));
+            m_translating_sequence.prepare();
+        }
+    };
+
+    BENCHMARK_CASE_F(Evaluate_RotatingSegment, EvaluateFixture)
+    {
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const float time = static_cast<float>(i) * 0.01f;
+            m_dummy += m_rotating_sequence.evaluate(time, m_scratch).get_local_to_parent()[3];
+        }
+    }
+
+    BENCHMARK_CASE_F(Evaluate_TranslatingSegment, EvaluateFixture)
+    {
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const float time = static_cast<float>(i) * 0.01f;
+            m_dummy += m_translating_sequence.evaluate(time, m_scratch).get_local_to_parent()[3];
+        }
+    }
 }
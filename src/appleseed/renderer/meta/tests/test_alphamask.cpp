@@ -0,0 +1,210 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/intersection/alphamask.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/bitmask.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Intersection_AlphaMask)
+{
+    const size_t Width = 37;
+    const size_t Height = 29;
+
+    // Fill the mask with an opaque band, a transparent band and a random band,
+    // such that the mask has opaque, transparent and mixed tiles.
+    void fill_bitmask(BitMask2& bitmask)
+    {
+        MersenneTwister rng;
+
+        for (size_t y = 0; y < bitmask.get_height(); ++y)
+        {
+            for (size_t x = 0; x < bitmask.get_width(); ++x)
+            {
+                if (x < 16)
+                    bitmask.set(x, y, true);
+                else if (x < 24)
+                    bitmask.set(x, y, false);
+                else bitmask.set(x, y, rand_int1(rng, 0, 1) == 1);
+            }
+        }
+    }
+
+    size_t rand_index(MersenneTwister& rng, const size_t min, const size_t max)
+    {
+        return
+            static_cast<size_t>(
+                rand_int1(
+                    rng,
+                    static_cast<int32>(min),
+                    static_cast<int32>(max)));
+    }
+
+    Vector2f texel_center(const size_t x, const size_t y)
+    {
+        return
+            Vector2f(
+                (x + 0.5f) / Width,
+                (y + 0.5f) / Height);
+    }
+
+    AlphaMask::Coverage compute_coverage(
+        const BitMask2&     bitmask,
+        const size_t        x0,
+        const size_t        y0,
+        const size_t        x1,
+        const size_t        y1)
+    {
+        int coverage = 0;
+
+        for (size_t y = y0; y <= y1; ++y)
+        {
+            for (size_t x = x0; x <= x1; ++x)
+            {
+                coverage |=
+                    bitmask.is_set(x, y)
+                        ? AlphaMask::CoverageOpaque
+                        : AlphaMask::CoverageTransparent;
+            }
+        }
+
+        return static_cast<AlphaMask::Coverage>(coverage);
+    }
+
+    TEST_CASE(Constructor_PreservesDimensions)
+    {
+        BitMask2 bitmask(Width, Height);
+        fill_bitmask(bitmask);
+
+        const AlphaMask mask(bitmask);
+
+        EXPECT_EQ(Width, mask.get_width());
+        EXPECT_EQ(Height, mask.get_height());
+    }
+
+    TEST_CASE(IsOpaque_AtTexelCenters_MatchesBitMask)
+    {
+        BitMask2 bitmask(Width, Height);
+        fill_bitmask(bitmask);
+
+        const AlphaMask mask(bitmask);
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                EXPECT_EQ(bitmask.is_set(x, y), mask.is_opaque(texel_center(x, y)));
+                EXPECT_EQ(bitmask.is_clear(x, y), mask.is_transparent(texel_center(x, y)));
+            }
+        }
+    }
+
+    TEST_CASE(IsOpaque_OutsideUnitSquare_ClampsToBorderTexels)
+    {
+        BitMask2 bitmask(Width, Height);
+        fill_bitmask(bitmask);
+
+        const AlphaMask mask(bitmask);
+
+        EXPECT_EQ(bitmask.is_set(0, 0), mask.is_opaque(Vector2f(-1.0f, -1.0f)));
+        EXPECT_EQ(bitmask.is_set(Width - 1, Height - 1), mask.is_opaque(Vector2f(2.0f, 2.0f)));
+    }
+
+    TEST_CASE(GetCoverage_MatchesBruteForce)
+    {
+        BitMask2 bitmask(Width, Height);
+        fill_bitmask(bitmask);
+
+        const AlphaMask mask(bitmask);
+
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const size_t x0 = rand_index(rng, 0, Width - 1);
+            const size_t y0 = rand_index(rng, 0, Height - 1);
+            const size_t x1 = rand_index(rng, x0, Width - 1);
+            const size_t y1 = rand_index(rng, y0, Height - 1);
+
+            EXPECT_EQ(
+                compute_coverage(bitmask, x0, y0, x1, y1),
+                mask.get_coverage(texel_center(x0, y0), texel_center(x1, y1)));
+        }
+    }
+
+    TEST_CASE(GetCoverage_GivenOpaqueBitMask_ReturnsOpaque)
+    {
+        BitMask2 bitmask(Width, Height);
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+                bitmask.set(x, y, true);
+        }
+
+        const AlphaMask mask(bitmask);
+
+        EXPECT_EQ(AlphaMask::CoverageOpaque, mask.get_coverage(Vector2f(0.0f), Vector2f(1.0f)));
+    }
+
+    TEST_CASE(GetCoverage_GivenTransparentBitMask_ReturnsTransparent)
+    {
+        BitMask2 bitmask(Width, Height);
+        bitmask.clear();
+
+        const AlphaMask mask(bitmask);
+
+        EXPECT_EQ(AlphaMask::CoverageTransparent, mask.get_coverage(Vector2f(0.0f), Vector2f(1.0f)));
+    }
+
+    TEST_CASE(GetMemorySize_GivenUniformBitMask_IsSmallerThanGivenMixedBitMask)
+    {
+        BitMask2 uniform_bitmask(Width, Height);
+        uniform_bitmask.clear();
+
+        BitMask2 mixed_bitmask(Width, Height);
+        fill_bitmask(mixed_bitmask);
+
+        const AlphaMask uniform_mask(uniform_bitmask);
+        const AlphaMask mixed_mask(mixed_bitmask);
+
+        EXPECT_LT(mixed_mask.get_memory_size(), uniform_mask.get_memory_size());
+    }
+}
@@ -0,0 +1,201 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/shading/ambientocclusioncache.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Shading_AmbientOcclusionCache)
+{
+    // A unit plane facing +X, and a much larger plane parallel to it that only occludes
+    // probe rays. The occluder is out of reach of occlusion rays until it is moved.
+    struct Fixture
+    {
+        auto_release_ptr<Project>   m_project;
+        AssemblyInstance*           m_occluder_instance;
+
+        Fixture()
+          : m_project(ProjectFactory::create("project"))
+        {
+            m_project->set_scene(SceneFactory::create());
+            Scene& scene = *m_project->get_scene();
+
+            scene.assemblies().insert(create_assembly("assembly", ParamArray(), Transformd::identity()));
+            scene.assemblies().insert(
+                create_assembly(
+                    "occluder_assembly",
+                    ParamArray().insert_path("visibility.camera", "false"),
+                    Transformd::from_local_to_parent(Matrix4d::make_scaling(Vector3d(1.0, 100.0, 100.0)))));
+
+            scene.assembly_instances().insert(
+                AssemblyInstanceFactory::create("assembly_instance", ParamArray(), "assembly"));
+            scene.assembly_instances().insert(
+                AssemblyInstanceFactory::create("occluder_instance", ParamArray(), "occluder_assembly"));
+            m_occluder_instance = scene.assembly_instances().get_by_name("occluder_instance");
+
+            move_occluder(10.0);
+        }
+
+        static auto_release_ptr<Assembly> create_assembly(
+            const char*                 name,
+            const ParamArray&           object_instance_params,
+            const Transformd&           object_instance_transform)
+        {
+            auto_release_ptr<Assembly> assembly(AssemblyFactory().create(name, ParamArray()));
+
+            auto_release_ptr<MeshObject> mesh_object =
+                MeshObjectFactory::create("plane", ParamArray());
+
+            mesh_object->push_vertex(GVector3(0.0f, -0.5f, -0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, +0.5f, -0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, +0.5f, +0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, -0.5f, +0.5f));
+
+            mesh_object->push_vertex_normal(GVector3(1.0f, 0.0f, 0.0f));
+
+            mesh_object->push_triangle(Triangle(0, 1, 2, 0, 0, 0, 0));
+            mesh_object->push_triangle(Triangle(2, 3, 0, 0, 0, 0, 0));
+
+            assembly->objects().insert(auto_release_ptr<Object>(mesh_object.release()));
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "plane_instance",
+                    object_instance_params,
+                    "plane",
+                    object_instance_transform,
+                    StringDictionary()));
+
+            return assembly;
+        }
+
+        void move_occluder(const double x)
+        {
+            m_occluder_instance->transform_sequence().clear();
+            m_occluder_instance->transform_sequence().set_transform(
+                0.0f,
+                Transformd::from_local_to_parent(Matrix4d::make_translation(Vector3d(x, 0.0, 0.0))));
+        }
+
+        // Look up the occlusion at the point of the unit plane seen from +X.
+        bool lookup(const AmbientOcclusionCache& cache, double& occlusion) const
+        {
+            TextureStore texture_store(*m_project->get_scene());
+            TextureCache texture_cache(texture_store);
+            const Intersector intersector(m_project->get_trace_context(), texture_cache);
+
+            const ShadingRay ray(
+                Vector3d(1.0, 0.1, 0.2),
+                Vector3d(-1.0, 0.0, 0.0),
+                0.0,                                // tmin
+                2.0,                                // tmax
+                ShadingRay::Time(),
+                VisibilityFlags::CameraRay,
+                0);                                 // depth
+
+            ShadingPoint shading_point;
+            if (!intersector.trace(ray, shading_point))
+                return false;
+
+            return cache.lookup(shading_point, occlusion);
+        }
+    };
+
+    TEST_CASE_F(Lookup_BeforeUpdate_ReturnsFalse, Fixture)
+    {
+        const AmbientOcclusionCache cache(1.0, 64, true);
+
+        double occlusion;
+        EXPECT_FALSE(lookup(cache, occlusion));
+    }
+
+    TEST_CASE_F(Lookup_GivenUnoccludedPlane_ReturnsZero, Fixture)
+    {
+        AmbientOcclusionCache cache(1.0, 64, true);
+        ASSERT_TRUE(cache.update(m_project.ref()));
+
+        double occlusion;
+        ASSERT_TRUE(lookup(cache, occlusion));
+        EXPECT_EQ(0.0, occlusion);
+    }
+
+    TEST_CASE_F(Lookup_GivenOccludedPlane_ReturnsHighOcclusion, Fixture)
+    {
+        move_occluder(0.1);
+
+        AmbientOcclusionCache cache(1.0, 64, true);
+        ASSERT_TRUE(cache.update(m_project.ref()));
+
+        double occlusion;
+        ASSERT_TRUE(lookup(cache, occlusion));
+        EXPECT_GT(0.9, occlusion);
+    }
+
+    TEST_CASE_F(Update_AfterOccluderMoved_RecomputesOcclusion, Fixture)
+    {
+        AmbientOcclusionCache cache(1.0, 64, true);
+        ASSERT_TRUE(cache.update(m_project.ref()));
+
+        move_occluder(0.1);
+        m_project->update_trace_context();
+        ASSERT_TRUE(cache.update(m_project.ref()));
+
+        double occlusion;
+        ASSERT_TRUE(lookup(cache, occlusion));
+        EXPECT_GT(0.9, occlusion);
+    }
+}
@@ -0,0 +1,89 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/brightnessmap.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_BrightnessMap)
+{
+    TEST_CASE(GetPixelLuminance_GivenNoPaths_ReturnsZero)
+    {
+        BrightnessMap map(32, 32);
+
+        EXPECT_EQ(0.0f, map.get_pixel_luminance(5, 5));
+    }
+
+    TEST_CASE(GetPixelLuminance_GivenEnoughPathsInBlock_ReturnsAverageLuminance)
+    {
+        BrightnessMap map(32, 32);
+
+        for (size_t i = 0; i < 100; ++i)
+            map.record_path(i % 4, i % 8, i % 2 == 0 ? 1.0f : 3.0f);
+
+        EXPECT_FEQ(2.0f, map.get_pixel_luminance(7, 7));
+        EXPECT_EQ(0.0f, map.get_pixel_luminance(8, 8));
+    }
+
+    TEST_CASE(GetPixelLuminance_GivenPixelOutsideCanvas_ReturnsLuminanceOfNearestBlock)
+    {
+        BrightnessMap map(12, 12);
+
+        for (size_t i = 0; i < 100; ++i)
+            map.record_path(11, 11, 2.0f);
+
+        EXPECT_FEQ(2.0f, map.get_pixel_luminance(20, 20));
+    }
+
+    TEST_CASE(GetImageLuminance_GivenFewPaths_ReturnsZero)
+    {
+        BrightnessMap map(32, 32);
+
+        map.record_image_paths(10.0, 10);
+
+        EXPECT_EQ(0.0f, map.get_image_luminance());
+    }
+
+    TEST_CASE(GetImageLuminance_GivenEnoughPaths_ReturnsAverageLuminance)
+    {
+        BrightnessMap map(32, 32);
+
+        map.record_image_paths(1000.0, 1000);
+        map.record_image_paths(15000.0, 5000);
+
+        EXPECT_FEQ(16000.0f / 6000.0f, map.get_image_luminance());
+    }
+}
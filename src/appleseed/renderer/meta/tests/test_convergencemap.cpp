@@ -0,0 +1,157 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/convergencemap.h"
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_ConvergenceMap)
+{
+    const size_t Width = 40;
+    const size_t Height = 20;
+
+    // Store a given number of samples per pixel into a region of the map,
+    // alternating between two luminance values.
+    void store_samples(
+        ConvergenceMap&     map,
+        const AABB2u&       region,
+        const size_t        samples_per_pixel,
+        const float         value1,
+        const float         value2)
+    {
+        vector<Sample> samples;
+
+        for (size_t i = 0; i < samples_per_pixel; ++i)
+        {
+            for (size_t y = region.min.y; y <= region.max.y; ++y)
+            {
+                for (size_t x = region.min.x; x <= region.max.x; ++x)
+                {
+                    const float value = samples.size() % 2 == 0 ? value1 : value2;
+
+                    Sample sample;
+                    sample.m_position = Vector2f((x + 0.5f) / Width, (y + 0.5f) / Height);
+                    sample.m_values[0] = value;
+                    sample.m_values[1] = value;
+                    sample.m_values[2] = value;
+                    sample.m_values[3] = 1.0f;
+                    sample.m_values[4] = 0.0f;
+                    samples.push_back(sample);
+                }
+            }
+        }
+
+        map.store_samples(samples.size(), &samples[0]);
+    }
+
+    const AABB2u FullFrame(Vector2u(0, 0), Vector2u(Width - 1, Height - 1));
+
+    TEST_CASE(Constructor_CoversCropWindowWithBlocks)
+    {
+        const ConvergenceMap map(Width, Height, FullFrame, 0.1f, 4);
+
+        EXPECT_EQ(6, map.get_block_count());
+        EXPECT_EQ(0, map.get_converged_block_count());
+        EXPECT_FALSE(map.is_converged());
+    }
+
+    TEST_CASE(StoreSamples_NoiseFreeSamples_ConvergesAfterMinSamples)
+    {
+        ConvergenceMap map(Width, Height, FullFrame, 0.1f, 4);
+
+        store_samples(map, FullFrame, 3, 1.0f, 1.0f);
+        EXPECT_FALSE(map.is_converged());
+
+        store_samples(map, FullFrame, 1, 1.0f, 1.0f);
+        EXPECT_TRUE(map.is_converged());
+    }
+
+    TEST_CASE(StoreSamples_NoisySamples_DoesNotConvergeAfterMinSamples)
+    {
+        ConvergenceMap map(Width, Height, FullFrame, 0.1f, 4);
+
+        store_samples(map, FullFrame, 4, 0.0f, 2.0f);
+
+        EXPECT_FALSE(map.is_converged());
+    }
+
+    TEST_CASE(StoreSamples_NoisySamples_EventuallyConverges)
+    {
+        ConvergenceMap map(Width, Height, FullFrame, 0.1f, 4);
+
+        store_samples(map, FullFrame, 128, 0.0f, 2.0f);
+
+        EXPECT_TRUE(map.is_converged());
+    }
+
+    TEST_CASE(IsConverged_GivenPixelOfConvergedBlock_ReturnsTrue)
+    {
+        ConvergenceMap map(Width, Height, FullFrame, 0.1f, 4);
+
+        store_samples(map, AABB2u(Vector2u(0, 0), Vector2u(15, 15)), 4, 1.0f, 1.0f);
+
+        EXPECT_TRUE(map.is_converged(5, 5));
+        EXPECT_FALSE(map.is_converged(20, 5));
+        EXPECT_EQ(1, map.get_converged_block_count());
+    }
+
+    TEST_CASE(StoreSamples_SamplesOutsideCropWindow_AreIgnored)
+    {
+        const AABB2u crop_window(Vector2u(10, 5), Vector2u(25, 15));
+        ConvergenceMap map(Width, Height, crop_window, 0.1f, 4);
+
+        store_samples(map, FullFrame, 4, 1.0f, 1.0f);
+
+        EXPECT_EQ(1, map.get_block_count());
+        EXPECT_TRUE(map.is_converged());
+    }
+
+    TEST_CASE(Clear_ResetsConvergence)
+    {
+        ConvergenceMap map(Width, Height, FullFrame, 0.1f, 4);
+        store_samples(map, FullFrame, 4, 1.0f, 1.0f);
+
+        map.clear();
+
+        EXPECT_FALSE(map.is_converged());
+        EXPECT_EQ(0, map.get_converged_block_count());
+    }
+}
@@ -42,6 +42,53 @@
 using namespace foundation;
 using namespace renderer;
 
+#ifdef APPLESEED_USE_RGB_SPECTRUM
+
+TEST_SUITE(Renderer_Utility_DynamicSpectrum31f_RGBOnly)
+{
+    TEST_CASE(ConstructorTakingAnArrayOfValues_CreatesRGB)
+    {
+        float values[31];
+        for (size_t i = 0; i < 31; ++i)
+            values[i] = 0.5f;
+
+        const DynamicSpectrum31f s(values);
+
+        EXPECT_TRUE(s.is_rgb());
+        EXPECT_FALSE(s.is_spectral());
+        EXPECT_EQ(3, s.size());
+    }
+
+    TEST_CASE(ConstructorTakingAnArrayOfValues_ConvertsToLinearRGB)
+    {
+        float values[31];
+        for (size_t i = 0; i < 31; ++i)
+            values[i] = 0.5f;
+
+        const DynamicSpectrum31f s(values);
+
+        const LightingConditions lighting_conditions(IlluminantCIED65, XYZCMFCIE196410Deg);
+        const Color3f expected =
+            ciexyz_to_linear_rgb(
+                spectrum_to_ciexyz<float>(lighting_conditions, RegularSpectrum31f(values)));
+
+        EXPECT_FEQ(expected, s.rgb());
+    }
+
+    TEST_CASE(Upgrade_GivenRGB_KeepsRGB)
+    {
+        const DynamicSpectrum31f source(Color3f(0.2f, 0.4f, 0.6f));
+
+        DynamicSpectrum31f dest;
+        DynamicSpectrum31f::upgrade(source, dest);
+
+        EXPECT_TRUE(dest.is_rgb());
+        EXPECT_EQ(Color3f(0.2f, 0.4f, 0.6f), dest.rgb());
+    }
+}
+
+#else
+
 TEST_SUITE(Renderer_Utility_DynamicSpectrum31f)
 {
     static const float SpectrumValues[31] =
@@ -403,3 +450,5 @@ TEST_SUITE(Renderer_Utility_DynamicSpectrum31f)
             EXPECT_FEQ(sqrt(Values[i]), result[i]);
     }
 }
+
+#endif
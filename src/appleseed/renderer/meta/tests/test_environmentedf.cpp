@@ -41,6 +41,7 @@
 #include "renderer/modeling/environmentedf/constantenvironmentedf.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
 #include "renderer/modeling/environmentedf/gradientenvironmentedf.h"
+#include "renderer/modeling/environmentedf/hosekenvironmentedf.h"
 #include "renderer/modeling/environmentedf/latlongmapenvironmentedf.h"
 #include "renderer/modeling/environmentedf/mirrorballmapenvironmentedf.h"
 #include "renderer/modeling/scene/containers.h"
@@ -287,6 +288,25 @@ TEST_SUITE(Renderer_Modeling_EnvironmentEDF)
         EXPECT_TRUE(consistent);
     }
 
+    TEST_CASE_F(CheckTabulatedHosekEnvironmentEDFConsistency, Fixture)
+    {
+        auto_release_ptr<EnvironmentEDF> env_edf(
+            HosekEnvironmentEDFFactory().create(
+                "env_edf",
+                ParamArray()
+                    .insert("sun_theta", "45.0")
+                    .insert("sun_phi", "30.0")
+                    .insert("turbidity", "1.0")
+                    .insert("tabulate", "true")
+                    .insert("table_resolution", "64")));
+        EnvironmentEDF& env_edf_ref = env_edf.ref();
+        m_scene.environment_edfs().insert(env_edf);
+
+        const bool consistent = check_consistency(env_edf_ref);
+
+        EXPECT_TRUE(consistent);
+    }
+
     TEST_CASE_F(CheckLatLongMapEnvironmentEDFConsistency, Fixture)
     {
         create_horizontal_gradient_texture("horiz_gradient_texture");
@@ -0,0 +1,165 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/environmentimportancemap.h"
+#include "renderer/modeling/environmentedf/sphericalcoordinates.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Lighting_EnvironmentImportanceMap)
+{
+    const size_t Width = 16;
+    const size_t Height = 8;
+
+    size_t direction_to_texel(const Vector3f& direction)
+    {
+        float theta, phi, u, v;
+        unit_vector_to_angles(direction, theta, phi);
+        angles_to_unit_square(theta, phi, u, v);
+
+        const size_t x = min(truncate<size_t>(u * Width), Width - 1);
+        const size_t y = min(truncate<size_t>(v * Height), Height - 1);
+
+        return y * Width + x;
+    }
+
+    TEST_CASE(Sample_GivenSingleBrightTexel_ReturnsDirectionsInsideThisTexel)
+    {
+        vector<float> luminances(Width * Height, 0.0f);
+        luminances[3 * Width + 5] = 1.0f;
+
+        EnvironmentImportanceMap map(Width, Height, false);
+        map.build(&luminances[0]);
+
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const Vector2f s(rand_float2(rng), rand_float2(rng));
+
+            Vector3f outgoing;
+            const float pdf = map.sample(s, outgoing);
+
+            EXPECT_GT(0.0f, pdf);
+            EXPECT_EQ(3 * Width + 5, direction_to_texel(outgoing));
+        }
+    }
+
+    TEST_CASE(Sample_ReturnsSameProbabilityDensityAsEvaluatePDF)
+    {
+        MersenneTwister rng;
+
+        vector<float> luminances(Width * Height);
+        for (size_t i = 0; i < luminances.size(); ++i)
+            luminances[i] = rand_float1(rng, 0.0f, 10.0f);
+
+        EnvironmentImportanceMap map(Width, Height, true);
+        map.build(&luminances[0]);
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const Vector2f s(rand_float2(rng), rand_float2(rng));
+
+            Vector3f outgoing;
+            const float pdf = map.sample(s, outgoing);
+
+            EXPECT_FEQ_EPS(pdf, map.evaluate_pdf(outgoing), 1.0e-3f * pdf);
+        }
+    }
+
+    TEST_CASE(EvaluatePDF_IntegratesToOneOverTheSphere)
+    {
+        MersenneTwister rng;
+
+        vector<float> luminances(Width * Height);
+        for (size_t i = 0; i < luminances.size(); ++i)
+            luminances[i] = rand_float1(rng, 0.0f, 10.0f);
+
+        EnvironmentImportanceMap map(Width, Height, false);
+        map.build(&luminances[0]);
+
+        const size_t SampleCount = 100000;
+        double integral = 0.0;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const Vector2f s(rand_float2(rng), rand_float2(rng));
+            const Vector3f direction = sample_sphere_uniform(s);
+            integral += map.evaluate_pdf(direction) / RcpFourPi<float>();
+        }
+
+        EXPECT_FEQ_EPS(1.0, integral / SampleCount, 0.02);
+    }
+
+    TEST_CASE(EvaluatePDF_GivenMISCompensation_ReturnsZeroForTexelsDarkerThanAverage)
+    {
+        vector<float> luminances(Width * Height, 1.0f);
+        luminances[3 * Width + 5] = 100.0f;
+
+        EnvironmentImportanceMap map(Width, Height, true);
+        map.build(&luminances[0]);
+
+        EXPECT_EQ(0.0f, map.evaluate_pdf(Vector3f(0.0f, 0.0f, 1.0f)));
+    }
+
+    TEST_CASE(EvaluatePDF_GivenMISCompensationAndConstantMap_ReturnsNonZeroDensity)
+    {
+        const vector<float> luminances(Width * Height, 1.0f);
+
+        EnvironmentImportanceMap map(Width, Height, true);
+        map.build(&luminances[0]);
+
+        EXPECT_GT(0.0f, map.evaluate_pdf(Vector3f(0.0f, 0.0f, 1.0f)));
+    }
+
+    TEST_CASE(Sample_GivenBlackMap_ReturnsZeroProbabilityDensity)
+    {
+        const vector<float> luminances(Width * Height, 0.0f);
+
+        EnvironmentImportanceMap map(Width, Height, true);
+        map.build(&luminances[0]);
+
+        Vector3f outgoing;
+        EXPECT_EQ(0.0f, map.sample(Vector2f(0.5f, 0.5f), outgoing));
+    }
+}
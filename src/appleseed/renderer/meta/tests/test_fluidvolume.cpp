@@ -0,0 +1,174 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/fluidvolume.h"
+#include "renderer/kernel/volume/majorantgrid.h"
+#include "renderer/kernel/volume/occupancygrid.h"
+#include "renderer/kernel/volume/volume.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/xorshift.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Volume_FluidVolume)
+{
+    struct RNG
+    {
+        Xorshift m_rng;
+
+        float operator()()
+        {
+            return rand_float1(m_rng);
+        }
+    };
+
+    auto_ptr<VoxelGrid> make_grid(const size_t res, const float density)
+    {
+        auto_ptr<VoxelGrid> grid(new VoxelGrid(res, res, res, 1));
+
+        for (size_t z = 0; z < res; ++z)
+        {
+            for (size_t y = 0; y < res; ++y)
+            {
+                for (size_t x = 0; x < res; ++x)
+                    grid->voxel(x, y, z)[0] = density;
+            }
+        }
+
+        return grid;
+    }
+
+    const AABB3d UnitBox(Vector3d(0.0), Vector3d(1.0));
+
+    TEST_CASE(MajorantGrid_SingleDenseVoxel_OnlyCellsTouchingVoxelHaveNonZeroMajorant)
+    {
+        auto_ptr<VoxelGrid> grid = make_grid(33, 0.0f);
+        grid->voxel(4, 4, 4)[0] = 2.0f;
+
+        const OccupancyGrid occupancy_grid(*grid, 0, 0.0f);
+        const MajorantGrid majorant_grid(*grid, 0, occupancy_grid, 8);
+
+        EXPECT_EQ(4, majorant_grid.get_xres());
+        EXPECT_EQ(2.0f, majorant_grid.get_majorant(0, 0, 0));
+        EXPECT_EQ(0.0f, majorant_grid.get_majorant(1, 0, 0));
+        EXPECT_EQ(0.0f, majorant_grid.get_majorant(3, 3, 3));
+    }
+
+    TEST_CASE(MajorantGrid_DensityBelowOccupancyThreshold_MajorantIsZero)
+    {
+        auto_ptr<VoxelGrid> grid = make_grid(17, 0.001f);
+
+        const OccupancyGrid occupancy_grid(*grid, 0, 0.1f);
+        const MajorantGrid majorant_grid(*grid, 0, occupancy_grid, 8);
+
+        EXPECT_EQ(0.0f, majorant_grid.get_majorant(1, 1, 1));
+    }
+
+    TEST_CASE(SampleDistance_EmptyVolume_ReturnsFalse)
+    {
+        const FluidVolume volume(make_grid(17, 0.0f), 0, UnitBox, 1.0f, 1.0f);
+        RNG rng;
+
+        double distance;
+        EXPECT_FALSE(
+            volume.sample_distance(
+                Vector3d(0.5, 0.5, -1.0),
+                Vector3d(0.0, 0.0, 1.0),
+                10.0,
+                rng,
+                distance));
+    }
+
+    TEST_CASE(SampleDistance_HomogeneousVolume_MeanFreePathMatchesExtinction)
+    {
+        const FluidVolume volume(make_grid(17, 1.0f), 0, AABB3d(Vector3d(0.0), Vector3d(100.0)), 2.0f, 1.0f);
+        RNG rng;
+
+        const size_t SampleCount = 10000;
+        double sum = 0.0;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            double distance;
+            if (volume.sample_distance(Vector3d(50.0, 50.0, 0.0), Vector3d(0.0, 0.0, 1.0), 100.0, rng, distance))
+                sum += distance;
+        }
+
+        EXPECT_FEQ_EPS(0.5, sum / SampleCount, 0.02);
+    }
+
+    TEST_CASE(EvaluateTransmittance_HomogeneousVolume_MatchesBeerLambert)
+    {
+        const FluidVolume volume(make_grid(17, 1.0f), 0, UnitBox, 1.0f, 1.0f);
+        RNG rng;
+
+        const size_t SampleCount = 10000;
+        double sum = 0.0;
+
+        // The ray enters the box at z = 0 and stops halfway through it.
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            sum +=
+                volume.evaluate_transmittance(
+                    Vector3d(0.5, 0.5, -1.0),
+                    Vector3d(0.0, 0.0, 1.0),
+                    1.5,
+                    rng);
+        }
+
+        EXPECT_FEQ_EPS(exp(-0.5), sum / SampleCount, 0.02);
+    }
+
+    TEST_CASE(EvaluateTransmittance_RayMissesVolume_ReturnsOne)
+    {
+        const FluidVolume volume(make_grid(17, 1.0f), 0, UnitBox, 1.0f, 1.0f);
+        RNG rng;
+
+        EXPECT_EQ(
+            1.0f,
+            volume.evaluate_transmittance(
+                Vector3d(2.0, 0.5, -1.0),
+                Vector3d(0.0, 0.0, 1.0),
+                10.0,
+                rng));
+    }
+}
@@ -0,0 +1,114 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/progressive/frameanalyzer.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/image.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Rendering_Progressive_FrameAnalyzer)
+{
+    auto_release_ptr<Frame> create_frame()
+    {
+        return
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "32 32")
+                    .insert("tile_size", "16 16")
+                    .insert("pixel_format", "float")
+                    .insert("color_space", "linear_rgb"));
+    }
+
+    TEST_CASE(Update_GivenUniformFrame_ComputesAverageLuminance)
+    {
+        auto_release_ptr<Frame> frame(create_frame());
+        frame->image().clear(Color4f(0.5f, 0.5f, 0.5f, 1.0f));
+
+        FrameAnalyzer analyzer(frame.ref(), 0, 2);
+        const size_t analyzed_tiles = analyzer.update();
+
+        EXPECT_EQ(4, analyzed_tiles);
+        EXPECT_FEQ(0.5, analyzer.get_average_luminance());
+    }
+
+    TEST_CASE(Update_GivenUnchangedFrame_AnalyzesNoTile)
+    {
+        auto_release_ptr<Frame> frame(create_frame());
+        frame->image().clear(Color4f(0.5f, 0.5f, 0.5f, 1.0f));
+
+        FrameAnalyzer analyzer(frame.ref(), 0, 2);
+        analyzer.update();
+        const size_t analyzed_tiles = analyzer.update();
+
+        EXPECT_EQ(0, analyzed_tiles);
+        EXPECT_FEQ(0.5, analyzer.get_average_luminance());
+    }
+
+    TEST_CASE(Update_GivenSinglePixelChange_AnalyzesOnlyItsTile)
+    {
+        auto_release_ptr<Frame> frame(create_frame());
+        frame->image().clear(Color4f(0.0f, 0.0f, 0.0f, 1.0f));
+
+        FrameAnalyzer analyzer(frame.ref(), 0, 2);
+        analyzer.update();
+
+        frame->image().set_pixel(20, 4, Color4f(1.0f, 1.0f, 1.0f, 1.0f));
+        const size_t analyzed_tiles = analyzer.update();
+
+        EXPECT_EQ(1, analyzed_tiles);
+        EXPECT_FEQ(1.0 / (32 * 32), analyzer.get_average_luminance());
+    }
+
+    TEST_CASE(Update_GivenReferenceIdenticalToFrame_ReturnsZeroRMSDeviation)
+    {
+        auto_release_ptr<Frame> frame(create_frame());
+        frame->image().clear(Color4f(0.2f, 0.4f, 0.6f, 1.0f));
+
+        const Image ref_image(frame->image());
+
+        FrameAnalyzer analyzer(frame.ref(), &ref_image, 2);
+        analyzer.update();
+
+        EXPECT_EQ(0.0, analyzer.get_rms_deviation());
+    }
+}
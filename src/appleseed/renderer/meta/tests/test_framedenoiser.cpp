@@ -0,0 +1,143 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/kernel/aov/imagestack.h"
+#include "renderer/kernel/rendering/framedenoiser.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Rendering_FrameDenoiser)
+{
+    const size_t Width = 32;
+    const size_t Height = 32;
+
+    auto_release_ptr<Frame> create_frame()
+    {
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "32 32")
+                    .insert("tile_size", "16 16")
+                    .insert("pixel_format", "float")
+                    .insert("denoise", "true")));
+
+        ImageStack& aov_images = frame->aov_images();
+        aov_images.append("depth", ImageStack::ContributionType, 4, PixelFormatFloat);
+        aov_images.append("normal", ImageStack::IdentificationType, 4, PixelFormatFloat);
+        aov_images.append("albedo", ImageStack::IdentificationType, 4, PixelFormatFloat);
+
+        aov_images.get_image(0).clear(Color4f(1.0f));
+        aov_images.get_image(1).clear(Color4f(0.5f, 0.5f, 1.0f, 1.0f));
+        aov_images.get_image(2).clear(Color4f(0.8f, 0.8f, 0.8f, 1.0f));
+
+        return frame;
+    }
+
+    TEST_CASE(Denoise_GivenFrameWithoutFeatureAOVs_ReturnsFalse)
+    {
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray().insert("resolution", "32 32")));
+
+        const FrameDenoiser denoiser((ParamArray()));
+        const bool success = denoiser.denoise(frame.ref(), 1);
+
+        EXPECT_FALSE(success);
+    }
+
+    TEST_CASE(Denoise_GivenUniformFrame_LeavesFrameUnchanged)
+    {
+        auto_release_ptr<Frame> frame(create_frame());
+        frame->image().clear(Color4f(0.3f, 0.4f, 0.5f, 1.0f));
+
+        const FrameDenoiser denoiser((ParamArray()));
+        const bool success = denoiser.denoise(frame.ref(), 2);
+        ASSERT_TRUE(success);
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                Color4f color;
+                frame->image().get_pixel(x, y, color);
+                EXPECT_FEQ(Color4f(0.3f, 0.4f, 0.5f, 1.0f), color);
+            }
+        }
+    }
+
+    TEST_CASE(Denoise_GivenNormalDiscontinuity_PreservesEdge)
+    {
+        auto_release_ptr<Frame> frame(create_frame());
+        Image& image = frame->image();
+        Image& normals = frame->aov_images().get_image(1);
+
+        // Left half faces +Z and is white, right half faces +X and is black.
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = Width / 2; x < Width; ++x)
+            {
+                image.set_pixel(x, y, Color4f(0.0f, 0.0f, 0.0f, 1.0f));
+                normals.set_pixel(x, y, Color4f(1.0f, 0.5f, 0.5f, 1.0f));
+            }
+
+            for (size_t x = 0; x < Width / 2; ++x)
+                image.set_pixel(x, y, Color4f(1.0f));
+        }
+
+        // Disable the color term so that only the features can preserve the edge.
+        const FrameDenoiser denoiser(ParamArray().insert("color_sigma", "1000.0"));
+        const bool success = denoiser.denoise(frame.ref(), 2);
+        ASSERT_TRUE(success);
+
+        Color4f left, right;
+        image.get_pixel(Width / 2 - 1, Height / 2, left);
+        image.get_pixel(Width / 2, Height / 2, right);
+
+        EXPECT_FEQ_EPS(1.0f, left[0], 1.0e-3f);
+        EXPECT_FEQ_EPS(0.0f, right[0], 1.0e-3f);
+    }
+}
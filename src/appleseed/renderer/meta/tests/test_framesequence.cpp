@@ -0,0 +1,183 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/camera/pinholecamera.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/framesequence.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/matrix.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/log/logger.h"
+#include "foundation/utility/test.h"
+#include "foundation/utility/version.h"
+
+// Standard headers.
+#include <sstream>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Utility_FrameSequence)
+{
+    struct Fixture
+    {
+        auto_release_ptr<Project>   m_project;
+        ParamArray                  m_params;
+        Logger                      m_logger;       // no target: errors are not printed
+        FrameSequence               m_sequence;
+
+        Fixture()
+          : m_project(ProjectFactory::create("project"))
+        {
+            m_project->set_scene(SceneFactory::create());
+            Scene& scene = *m_project->get_scene();
+
+            scene.cameras().insert(PinholeCameraFactory().create("camera", ParamArray()));
+            scene.assemblies().insert(AssemblyFactory().create("assembly", ParamArray()));
+            scene.assembly_instances().insert(
+                AssemblyInstanceFactory::create("assembly_instance", ParamArray(), "assembly"));
+        }
+
+        bool read(const char* sequence)
+        {
+            istringstream input(sequence);
+            return m_sequence.read(input, "sequence", m_logger);
+        }
+
+        bool apply(const size_t frame)
+        {
+            return m_sequence.apply(frame, m_project.ref(), m_params, m_logger);
+        }
+
+        AssemblyInstance& get_assembly_instance() const
+        {
+            return *m_project->get_scene()->assembly_instances().get_by_name("assembly_instance");
+        }
+    };
+
+    TEST_CASE_F(Read_GivenValidSequence_ReturnsFirstAndLastFrames, Fixture)
+    {
+        const bool success =
+            read(
+                "# Comment.\n"
+                "frame 2\n"
+                "parameter a.b 1    # trailing comment\n"
+                "\n"
+                "frame 7\n"
+                "parameter a.b 2\n");
+
+        ASSERT_TRUE(success);
+        EXPECT_FALSE(m_sequence.empty());
+        EXPECT_EQ(2, m_sequence.get_first_frame());
+        EXPECT_EQ(7, m_sequence.get_last_frame());
+    }
+
+    TEST_CASE_F(Read_GivenFramesInDecreasingOrder_ReturnsFalse, Fixture)
+    {
+        EXPECT_FALSE(read("frame 3\nframe 2\n"));
+    }
+
+    TEST_CASE_F(Read_GivenDirectiveBeforeFirstFrame_ReturnsFalse, Fixture)
+    {
+        EXPECT_FALSE(read("parameter a.b 1\nframe 1\n"));
+    }
+
+    TEST_CASE_F(Read_GivenInvalidNumber_ReturnsFalse, Fixture)
+    {
+        EXPECT_FALSE(read("frame one\n"));
+    }
+
+    TEST_CASE_F(Apply_GivenLaterFrame_AppliesChangesOfAllPrecedingFrames, Fixture)
+    {
+        ASSERT_TRUE(
+            read(
+                "frame 1\n"
+                "parameter a.x 1\n"
+                "frame 3\n"
+                "parameter a.y 2\n"
+                "frame 5\n"
+                "parameter a.x 3\n"));
+
+        ASSERT_TRUE(apply(4));
+        EXPECT_EQ("1", string(m_params.get_path("a.x")));
+        EXPECT_EQ("2", string(m_params.get_path("a.y")));
+
+        ASSERT_TRUE(apply(5));
+        EXPECT_EQ("3", string(m_params.get_path("a.x")));
+        EXPECT_EQ("2", string(m_params.get_path("a.y")));
+    }
+
+    TEST_CASE_F(Apply_GivenTransform_SetsTransformAndBumpsVersionID, Fixture)
+    {
+        ASSERT_TRUE(read("frame 1\ntransform assembly_instance 1 0 0 1 0 1 0 2 0 0 1 3 0 0 0 1\n"));
+
+        AssemblyInstance& assembly_instance = get_assembly_instance();
+        const VersionID initial_version_id = assembly_instance.get_version_id();
+
+        ASSERT_TRUE(apply(1));
+
+        EXPECT_NEQ(initial_version_id, assembly_instance.get_version_id());
+        EXPECT_EQ(
+            Matrix4d::make_translation(Vector3d(1.0, 2.0, 3.0)),
+            assembly_instance.transform_sequence().get_earliest_transform().get_local_to_parent());
+    }
+
+    TEST_CASE_F(Apply_GivenAlreadyAppliedFrame_LeavesSceneUnchanged, Fixture)
+    {
+        ASSERT_TRUE(read("frame 1\ntransform camera 1 0 0 1 0 1 0 2 0 0 1 3 0 0 0 1\n"));
+        ASSERT_TRUE(apply(1));
+
+        const Camera& camera = *m_project->get_scene()->cameras().get_by_name("camera");
+        const VersionID version_id = camera.get_version_id();
+
+        ASSERT_TRUE(apply(1));
+
+        EXPECT_EQ(version_id, camera.get_version_id());
+    }
+
+    TEST_CASE_F(Apply_GivenUnknownEntity_ReturnsFalse, Fixture)
+    {
+        ASSERT_TRUE(read("frame 1\ntransform unknown 1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1\n"));
+
+        EXPECT_FALSE(apply(1));
+    }
+}
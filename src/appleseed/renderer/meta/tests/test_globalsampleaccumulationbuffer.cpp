@@ -0,0 +1,172 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/globalsampleaccumulationbuffer.h"
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/filter.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_GlobalSampleAccumulationBuffer)
+{
+    void make_samples(vector<Sample>& samples, const size_t count)
+    {
+        MersenneTwister rng;
+
+        samples.resize(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            samples[i].m_position.x = rand_float2(rng);
+            samples[i].m_position.y = rand_float2(rng);
+
+            for (size_t c = 0; c < 5; ++c)
+                samples[i].m_values[c] = rand_float1(rng);
+        }
+    }
+
+    // Return the pixels of a buffer, as written by save_samples().
+    vector<float> get_pixels(GlobalSampleAccumulationBuffer& buffer)
+    {
+        stringstream stream;
+        buffer.save_samples(stream);
+
+        const string bytes = stream.str();
+        const size_t header_size = 4 * sizeof(uint64);
+
+        vector<float> pixels((bytes.size() - header_size) / sizeof(float));
+        if (!pixels.empty())
+            memcpy(&pixels[0], bytes.data() + header_size, pixels.size() * sizeof(float));
+
+        return pixels;
+    }
+
+    bool pixels_match(const vector<float>& lhs, const vector<float>& rhs)
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+
+        for (size_t i = 0; i < lhs.size(); ++i)
+        {
+            if (!feq(lhs[i], rhs[i], 1.0e-3f))
+                return false;
+        }
+
+        return true;
+    }
+
+    struct Fixture
+    {
+        BlackmanHarrisFilter2<float>    m_filter;
+        vector<Sample>                  m_samples;
+        AbortSwitch                     m_abort_switch;
+
+        Fixture()
+          : m_filter(1.5f, 1.5f)
+        {
+            make_samples(m_samples, 5000);
+        }
+    };
+
+    TEST_CASE_F(StorePrivateSamples_MatchesStoreSamples, Fixture)
+    {
+        GlobalSampleAccumulationBuffer ref_buffer(61, 93, m_filter);
+        ref_buffer.clear();
+        ref_buffer.store_samples(m_samples.size(), &m_samples[0], m_abort_switch);
+
+        GlobalSampleAccumulationBuffer buffer(61, 93, m_filter);
+        buffer.clear();
+        const size_t half_count = m_samples.size() / 2;
+        buffer.store_private_samples(0, half_count, &m_samples[0], m_abort_switch);
+        buffer.store_private_samples(2, m_samples.size() - half_count, &m_samples[half_count], m_abort_switch);
+
+        EXPECT_TRUE(pixels_match(get_pixels(ref_buffer), get_pixels(buffer)));
+    }
+
+    TEST_CASE_F(StorePrivateSamples_BufferCoversCropWindow_MatchesStoreSamples, Fixture)
+    {
+        const AABB2u crop_window(Vector2u(17, 41), Vector2u(77, 133));
+
+        GlobalSampleAccumulationBuffer ref_buffer(200, 300, crop_window, m_filter);
+        ref_buffer.clear();
+        ref_buffer.store_samples(m_samples.size(), &m_samples[0], m_abort_switch);
+
+        GlobalSampleAccumulationBuffer buffer(200, 300, crop_window, m_filter);
+        buffer.clear();
+        buffer.store_private_samples(1, m_samples.size(), &m_samples[0], m_abort_switch);
+
+        EXPECT_TRUE(pixels_match(get_pixels(ref_buffer), get_pixels(buffer)));
+    }
+
+    TEST_CASE_F(StorePrivateSamples_SavedTwice_MergesSamplesOnce, Fixture)
+    {
+        GlobalSampleAccumulationBuffer ref_buffer(61, 93, m_filter);
+        ref_buffer.clear();
+        ref_buffer.store_samples(m_samples.size(), &m_samples[0], m_abort_switch);
+
+        GlobalSampleAccumulationBuffer buffer(61, 93, m_filter);
+        buffer.clear();
+        buffer.store_private_samples(0, m_samples.size(), &m_samples[0], m_abort_switch);
+        get_pixels(buffer);
+
+        EXPECT_TRUE(pixels_match(get_pixels(ref_buffer), get_pixels(buffer)));
+    }
+
+    TEST_CASE_F(Clear_DiscardsPrivateSamples, Fixture)
+    {
+        GlobalSampleAccumulationBuffer ref_buffer(61, 93, m_filter);
+        ref_buffer.clear();
+
+        GlobalSampleAccumulationBuffer buffer(61, 93, m_filter);
+        buffer.clear();
+        buffer.store_private_samples(0, m_samples.size(), &m_samples[0], m_abort_switch);
+        buffer.clear();
+
+        EXPECT_TRUE(pixels_match(get_pixels(ref_buffer), get_pixels(buffer)));
+    }
+}
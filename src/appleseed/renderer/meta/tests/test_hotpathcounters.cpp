@@ -0,0 +1,119 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/hotpathcounters.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Utility_HotPathCounters)
+{
+    const char* LambertianModel = "lambertian_brdf";
+    const char* SpecularModel = "specular_brdf";
+
+    TEST_CASE(Increment_GivenSameModelTwice_CountsItOnce)
+    {
+        ModelCounts counts;
+        counts.increment(LambertianModel);
+        counts.increment(SpecularModel);
+        counts.increment(LambertianModel);
+
+        ASSERT_EQ(2, counts.get_model_count());
+        EXPECT_EQ(LambertianModel, counts.get_model(0));
+        EXPECT_EQ(2, counts.get_count(0));
+        EXPECT_EQ(SpecularModel, counts.get_model(1));
+        EXPECT_EQ(1, counts.get_count(1));
+    }
+
+    TEST_CASE(Increment_GivenTooManyModels_CountsAdditionalOnesAsOther)
+    {
+        static char models[ModelCounts::MaxModelCount + 2];
+
+        ModelCounts counts;
+
+        for (size_t i = 0; i < ModelCounts::MaxModelCount + 2; ++i)
+            counts.increment(&models[i]);
+
+        EXPECT_EQ(ModelCounts::MaxModelCount, counts.get_model_count());
+        EXPECT_EQ(2, counts.get_other_count());
+    }
+
+    TEST_CASE(Merge_GivenCommonAndDistinctModels_SumsCounts)
+    {
+        ModelCounts a;
+        a.increment(LambertianModel);
+
+        ModelCounts b;
+        b.increment(SpecularModel);
+        b.increment(LambertianModel);
+
+        a.merge(b);
+
+        ASSERT_EQ(2, a.get_model_count());
+        EXPECT_EQ(2, a.get_count(0));
+        EXPECT_EQ(SpecularModel, a.get_model(1));
+        EXPECT_EQ(1, a.get_count(1));
+    }
+
+    TEST_CASE(RayTypeIndex_GivenNoFlag_ReturnsLastSlot)
+    {
+        EXPECT_EQ(HotPathCounters::RayTypeCount - 1, HotPathCounters::ray_type_index(0));
+    }
+
+    TEST_CASE(RayTypeIndex_GivenSeveralFlags_ReturnsLowestOne)
+    {
+        EXPECT_EQ(
+            2,
+            HotPathCounters::ray_type_index(VisibilityFlags::ShadowRay | VisibilityFlags::ProbeRay));
+    }
+
+    TEST_CASE(VisitLeaf_AttributesVisitToCurrentRayType)
+    {
+        HotPathCounters counters;
+        counters.begin_ray(VisibilityFlags::ShadowRay);
+        counters.visit_leaf(4);
+        counters.end_ray(true);
+
+        const size_t shadow = HotPathCounters::ray_type_index(VisibilityFlags::ShadowRay);
+        EXPECT_EQ(1, counters.m_rays[shadow]);
+        EXPECT_EQ(1, counters.m_ray_hits[shadow]);
+        EXPECT_EQ(1, counters.m_leaf_visits[shadow]);
+        EXPECT_EQ(4, counters.m_primitive_tests[shadow]);
+    }
+}
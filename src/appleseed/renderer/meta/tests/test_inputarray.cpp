@@ -28,16 +28,24 @@
 //
 
 // appleseed.renderer headers.
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/modeling/input/inputarray.h"
 #include "renderer/modeling/input/scalarsource.h"
 #include "renderer/modeling/input/source.h"
+#include "renderer/modeling/scene/scene.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
 #include <string>
 
+using namespace foundation;
 using namespace renderer;
 using namespace std;
 
@@ -95,4 +103,84 @@ TEST_SUITE(Renderer_Modeling_Input_InputArray)
 
         EXPECT_EQ(expected_source, source);
     }
+
+    // A varying source returning the first texture coordinate.
+    class USource
+      : public Source
+    {
+      public:
+        USource()
+          : Source(false)
+        {
+        }
+
+        virtual uint64 compute_signature() const APPLESEED_OVERRIDE
+        {
+            return 0;
+        }
+
+        virtual void evaluate(
+            TextureCache&               texture_cache,
+            const Vector2f&             uv,
+            float&                      scalar) const APPLESEED_OVERRIDE
+        {
+            scalar = uv[0];
+        }
+    };
+
+    APPLESEED_DECLARE_INPUT_VALUES(InputValues)
+    {
+        float   m_a;
+        float   m_b;
+        float   m_c;
+    };
+
+    struct Fixture
+    {
+        auto_release_ptr<Scene> m_scene;
+        TextureStore            m_texture_store;
+        TextureCache            m_texture_cache;
+        InputArray              m_inputs;
+
+        Fixture()
+          : m_scene(SceneFactory::create())
+          , m_texture_store(m_scene.ref())
+          , m_texture_cache(m_texture_store)
+        {
+            m_inputs.declare("a", InputFormatFloat);
+            m_inputs.declare("b", InputFormatFloat);
+            m_inputs.declare("c", InputFormatFloat, "0.0");
+        }
+
+        InputValues evaluate()
+        {
+            InputValues values;
+            m_inputs.evaluate(m_texture_cache, Vector2f(0.25f, 0.5f), &values);
+            return values;
+        }
+    };
+
+    TEST_CASE_F(Evaluate_GivenPrecomputedUniformValues_EvaluatesUniformAndVaryingInputs, Fixture)
+    {
+        m_inputs.find("a").bind(new ScalarSource(2.0));
+        m_inputs.find("b").bind(new USource());
+        m_inputs.precompute_uniform_values();
+
+        const InputValues values = evaluate();
+
+        EXPECT_EQ(2.0f, values.m_a);
+        EXPECT_EQ(0.25f, values.m_b);
+        EXPECT_EQ(0.0f, values.m_c);
+    }
+
+    TEST_CASE_F(Evaluate_GivenSourceBoundAfterPrecomputingUniformValues_ReturnsValueOfNewSource, Fixture)
+    {
+        m_inputs.find("a").bind(new ScalarSource(2.0));
+        m_inputs.precompute_uniform_values();
+        m_inputs.find("a").bind(new ScalarSource(3.0));
+
+        const InputValues values = evaluate();
+
+        EXPECT_EQ(3.0f, values.m_a);
+    }
 }
@@ -0,0 +1,136 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersectionfilter.h"
+#include "renderer/kernel/intersection/trianglekey.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Intersection_IntersectionFilter)
+{
+    struct Fixture
+      : public TestFixtureBase
+    {
+        Object*                 m_object;
+        MaterialArray           m_materials;
+        TextureStore            m_texture_store;
+        TextureCache            m_texture_cache;
+
+        Fixture()
+          : m_texture_store(m_scene)
+          , m_texture_cache(m_texture_store)
+        {
+            auto_release_ptr<MeshObject> mesh_object =
+                MeshObjectFactory::create("triangle", ParamArray());
+
+            mesh_object->push_vertex(GVector3(0.0f, 0.0f, 0.0f));
+            mesh_object->push_vertex(GVector3(1.0f, 0.0f, 0.0f));
+            mesh_object->push_vertex(GVector3(0.0f, 1.0f, 0.0f));
+
+            mesh_object->push_vertex_normal(GVector3(0.0f, 0.0f, 1.0f));
+
+            mesh_object->push_triangle(Triangle(0, 1, 2, 0, 0, 0, 0));
+
+            m_object = mesh_object.get();
+            m_assembly.objects().insert(auto_release_ptr<Object>(mesh_object));
+        }
+
+        void set_alpha_map(const char* alpha_map)
+        {
+            m_object->get_parameters().insert("alpha_map", alpha_map);
+            bind_inputs();
+        }
+
+        bool accept(const IntersectionFilter& filter) const
+        {
+            return filter.accept(TriangleKey(0, 0, 0, 0), 0.25, 0.25);
+        }
+    };
+
+    TEST_CASE_F(Constructor_GivenNoAlphaMap_CreatesNoAlphaMask, Fixture)
+    {
+        bind_inputs();
+
+        const IntersectionFilter filter(*m_object, m_materials, m_texture_cache);
+
+        EXPECT_FALSE(filter.has_alpha_masks());
+    }
+
+    TEST_CASE_F(Constructor_GivenTransparentAlphaMap_RejectsTriangle, Fixture)
+    {
+        set_alpha_map("0.0");
+
+        const IntersectionFilter filter(*m_object, m_materials, m_texture_cache);
+
+        ASSERT_TRUE(filter.has_alpha_masks());
+        EXPECT_FALSE(accept(filter));
+    }
+
+    TEST_CASE_F(Update_GivenUnchangedAlphaMap_KeepsAlphaMask, Fixture)
+    {
+        set_alpha_map("0.0");
+        IntersectionFilter filter(*m_object, m_materials, m_texture_cache);
+        const size_t memory_size = filter.get_masks_memory_size();
+
+        set_alpha_map("0.0");
+        filter.update(*m_object, m_materials, m_texture_cache);
+
+        ASSERT_TRUE(filter.has_alpha_masks());
+        EXPECT_EQ(memory_size, filter.get_masks_memory_size());
+        EXPECT_FALSE(accept(filter));
+    }
+
+    TEST_CASE_F(Update_GivenOpaqueAlphaMap_DiscardsAlphaMask, Fixture)
+    {
+        set_alpha_map("0.0");
+        IntersectionFilter filter(*m_object, m_materials, m_texture_cache);
+
+        set_alpha_map("1.0");
+        filter.update(*m_object, m_materials, m_texture_cache);
+
+        EXPECT_FALSE(filter.has_alpha_masks());
+    }
+}
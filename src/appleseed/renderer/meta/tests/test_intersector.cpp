@@ -35,7 +35,9 @@
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/kernel/texturing/texturecache.h"
 #include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/object/meshobject.h"
 #include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/containers.h"
@@ -93,23 +95,71 @@ TEST_SUITE(Renderer_Kernel_Intersection_Intersector)
         }
     };
 
-    struct Fixture
-      : public BindInputs<TestScene>
+    struct PlaneScene
+    {
+        auto_release_ptr<Scene> m_scene;
+
+        PlaneScene()
+          : m_scene(SceneFactory::create())
+        {
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", ParamArray()));
+
+            auto_release_ptr<MeshObject> mesh_object =
+                MeshObjectFactory::create("plane", ParamArray());
+
+            mesh_object->push_vertex(GVector3(0.0f, -0.5f, -0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, +0.5f, -0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, +0.5f, +0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, -0.5f, +0.5f));
+
+            mesh_object->push_vertex_normal(GVector3(-1.0f, 0.0f, 0.0f));
+
+            mesh_object->push_triangle(Triangle(0, 1, 2, 0, 0, 0, 0));
+            mesh_object->push_triangle(Triangle(2, 3, 0, 0, 0, 0, 0));
+
+            assembly->objects().insert(auto_release_ptr<Object>(mesh_object.release()));
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "plane_instance",
+                    ParamArray(),
+                    "plane",
+                    Transformd::identity(),
+                    StringDictionary()));
+
+            m_scene->assembly_instances().insert(
+                auto_release_ptr<AssemblyInstance>(
+                    AssemblyInstanceFactory::create(
+                        "assembly_instance",
+                        ParamArray(),
+                        "assembly")));
+
+            m_scene->assemblies().insert(assembly);
+        }
+    };
+
+    template <typename SceneType>
+    struct FixtureBase
+      : public BindInputs<SceneType>
     {
         TraceContext    m_trace_context;
         TextureStore    m_texture_store;
         TextureCache    m_texture_cache;
         Intersector     m_intersector;
 
-        Fixture()
-          : m_trace_context(m_scene.ref())
-          , m_texture_store(m_scene.ref())
+        FixtureBase()
+          : m_trace_context(SceneType::m_scene.ref())
+          , m_texture_store(SceneType::m_scene.ref())
           , m_texture_cache(m_texture_store)
           , m_intersector(m_trace_context, m_texture_cache)
         {
         }
     };
 
+    typedef FixtureBase<TestScene> Fixture;
+    typedef FixtureBase<PlaneScene> PlaneFixture;
+
     TEST_CASE_F(Trace_GivenAssemblyContainingEmptyBoundingBoxAndRayWithTMaxInsideAssembly_ReturnsFalse, Fixture)
     {
         const ShadingRay ray(
@@ -142,4 +192,78 @@ TEST_SUITE(Renderer_Kernel_Intersection_Intersector)
 
         EXPECT_FALSE(hit);
     }
+
+    TEST_CASE_F(TraceBatch_GivenAssemblyContainingEmptyBoundingBoxAndRaysWithTMaxInsideAssembly_ReturnsZero, Fixture)
+    {
+        ShadingRay rays[2];
+        rays[0] = ShadingRay(
+            Vector3d(0.0, 0.0, 2.0),
+            Vector3d(0.0, 0.0, -1.0),
+            0.0,                                // tmin
+            2.0,                                // tmax
+            ShadingRay::Time(),
+            VisibilityFlags::CameraRay,
+            0);                                 // depth
+        rays[1] = rays[0];
+        rays[1].m_org = Vector3d(0.5, 0.0, 2.0);
+
+        ShadingPoint shading_points[2];
+        const size_t hit_count = m_intersector.trace_batch(2, rays, shading_points);
+
+        EXPECT_EQ(0, hit_count);
+        EXPECT_FALSE(shading_points[0].hit());
+        EXPECT_FALSE(shading_points[1].hit());
+    }
+
+    TEST_CASE_F(TraceProbeBatch_GivenAssemblyContainingEmptyBoundingBoxAndRaysWithTMaxInsideAssembly_ReturnsZero, Fixture)
+    {
+        ShadingRay rays[2];
+        rays[0] = ShadingRay(
+            Vector3d(0.0, 0.0, 2.0),
+            Vector3d(0.0, 0.0, -1.0),
+            0.0,                                // tmin
+            2.0,                                // tmax
+            ShadingRay::Time(),
+            VisibilityFlags::CameraRay,
+            0);                                 // depth
+        rays[1] = rays[0];
+        rays[1].m_org = Vector3d(0.5, 0.0, 2.0);
+
+        bool hits[2] = { true, true };
+        const size_t hit_count = m_intersector.trace_probe_batch(2, rays, hits);
+
+        EXPECT_EQ(0, hit_count);
+        EXPECT_FALSE(hits[0]);
+        EXPECT_FALSE(hits[1]);
+    }
+
+    TEST_CASE_F(TraceProbe_GivenCachedOccluderIsParentTriangle_ReturnsFalse, PlaneFixture)
+    {
+        const ShadingRay incoming_ray(
+            Vector3d(-1.0, 0.1, 0.2),
+            Vector3d(1.0, 0.0, 0.0),
+            0.0,                                // tmin
+            2.0,                                // tmax
+            ShadingRay::Time(),
+            VisibilityFlags::ShadowRay,
+            0);                                 // depth
+
+        // Leave the plane in the occluder cache.
+        ASSERT_TRUE(m_intersector.trace_probe(incoming_ray));
+
+        ShadingPoint shading_point;
+        ASSERT_TRUE(m_intersector.trace(incoming_ray, shading_point));
+
+        // A ray leaving the plane on the side it was hit from must not be occluded by it.
+        const ShadingRay outgoing_ray(
+            shading_point.get_point(),
+            normalize(Vector3d(-1.0, 0.3, 0.0)),
+            0.0,                                // tmin
+            10.0,                               // tmax
+            ShadingRay::Time(),
+            VisibilityFlags::ShadowRay,
+            1);                                 // depth
+
+        EXPECT_FALSE(m_intersector.trace_probe(outgoing_ray, &shading_point));
+    }
 }
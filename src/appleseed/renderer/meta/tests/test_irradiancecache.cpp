@@ -0,0 +1,111 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/lighting/irradiancecache.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_IrradianceCache)
+{
+    const Vector3f Up(0.0f, 1.0f, 0.0f);
+
+    TEST_CASE(Lookup_GivenEmptyCache_ReturnsFalse)
+    {
+        IrradianceCache cache(0.5f, 0.01f, 1.0f);
+
+        Spectrum irradiance;
+        EXPECT_FALSE(cache.lookup(Vector3d(0.0), Up, irradiance));
+    }
+
+    TEST_CASE(Lookup_AtRecordPosition_ReturnsRecordIrradiance)
+    {
+        IrradianceCache cache(0.5f, 0.01f, 1.0f);
+        cache.insert(Vector3d(0.0), Up, 1.0f, Spectrum(2.0f, Spectrum::Illuminance));
+
+        Spectrum irradiance;
+        ASSERT_TRUE(cache.lookup(Vector3d(0.0), Up, irradiance));
+
+        EXPECT_FEQ(2.0f, irradiance[0]);
+    }
+
+    TEST_CASE(Lookup_OutsideValidityRadius_ReturnsFalse)
+    {
+        IrradianceCache cache(0.5f, 0.01f, 1.0f);
+        cache.insert(Vector3d(0.0), Up, 1.0f, Spectrum(2.0f, Spectrum::Illuminance));
+
+        Spectrum irradiance;
+        EXPECT_FALSE(cache.lookup(Vector3d(0.6, 0.0, 0.0), Up, irradiance));
+    }
+
+    TEST_CASE(Lookup_GivenOppositeNormal_ReturnsFalse)
+    {
+        IrradianceCache cache(0.5f, 0.01f, 1.0f);
+        cache.insert(Vector3d(0.0), Up, 1.0f, Spectrum(2.0f, Spectrum::Illuminance));
+
+        Spectrum irradiance;
+        EXPECT_FALSE(cache.lookup(Vector3d(0.0), -Up, irradiance));
+    }
+
+    TEST_CASE(Lookup_GivenRecordInFrontOfPoint_ReturnsFalse)
+    {
+        IrradianceCache cache(0.5f, 0.01f, 1.0f);
+        cache.insert(Vector3d(0.0, 0.2, 0.0), Up, 1.0f, Spectrum(2.0f, Spectrum::Illuminance));
+
+        Spectrum irradiance;
+        EXPECT_FALSE(cache.lookup(Vector3d(0.0), Up, irradiance));
+    }
+
+    TEST_CASE(Lookup_BetweenTwoRecords_InterpolatesIrradiance)
+    {
+        IrradianceCache cache(0.5f, 0.01f, 1.0f);
+        cache.insert(Vector3d(-0.2, 0.0, 0.0), Up, 1.0f, Spectrum(1.0f, Spectrum::Illuminance));
+        cache.insert(Vector3d(+0.2, 0.0, 0.0), Up, 1.0f, Spectrum(3.0f, Spectrum::Illuminance));
+
+        Spectrum irradiance;
+        ASSERT_TRUE(cache.lookup(Vector3d(0.0), Up, irradiance));
+
+        EXPECT_FEQ(2.0f, irradiance[0]);
+    }
+
+    TEST_CASE(Insert_GivenSmallHarmonicMeanDistance_ClampsValidityRadius)
+    {
+        IrradianceCache cache(0.5f, 0.1f, 1.0f);
+        cache.insert(Vector3d(0.0), Up, 1.0e-6f, Spectrum(2.0f, Spectrum::Illuminance));
+
+        Spectrum irradiance;
+        EXPECT_TRUE(cache.lookup(Vector3d(0.04, 0.0, 0.0), Up, irradiance));
+        EXPECT_EQ(1, cache.size());
+    }
+}
@@ -36,6 +36,10 @@
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/test.h"
 
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
 using namespace foundation;
 using namespace renderer;
 
@@ -49,4 +53,82 @@ TEST_SUITE(Renderer_Kernel_Lighting_LightSampler)
 
         EXPECT_FALSE(light_sampler.has_lights_or_emitting_triangles());
     }
+
+    TEST_CASE(HasLightsOrEmittingTriangles_AfterUpdateGivenEmptyScene_ReturnsFalse)
+    {
+        auto_release_ptr<Scene> scene(SceneFactory::create());
+        scene->cameras().insert(PinholeCameraFactory().create("camera", ParamArray()));
+        LightSampler light_sampler(scene.ref());
+
+        light_sampler.update(scene.ref());
+
+        EXPECT_FALSE(light_sampler.has_lights_or_emitting_triangles());
+    }
+}
+
+TEST_SUITE(Renderer_Kernel_Lighting_EmitterDistribution)
+{
+    void insert_emitters(EmitterDistribution& distribution)
+    {
+        distribution.insert(0, 1.0f);
+        distribution.insert(1, 2.0f);
+        distribution.insert(2, 3.0f);
+        distribution.insert(3, 2.0f);
+    }
+
+    std::vector<size_t> sample_stratified(
+        const EmitterDistribution&  distribution,
+        const size_t                sample_count)
+    {
+        std::vector<size_t> items;
+
+        for (size_t i = 0; i < sample_count; ++i)
+            items.push_back(distribution.sample((i + 0.5f) / sample_count).first);
+
+        return items;
+    }
+
+    TEST_CASE(Sample_GivenStratifiedSamples_SelectsEmittersInOrder)
+    {
+        EmitterDistribution distribution;
+        insert_emitters(distribution);
+        distribution.prepare();
+
+        const std::vector<size_t> items = sample_stratified(distribution, 8);
+
+        const size_t Expected[] = { 0, 1, 1, 2, 2, 2, 3, 3 };
+        EXPECT_SEQUENCE_EQ(8, Expected, &items[0]);
+    }
+
+    TEST_CASE(Sample_GivenStratifiedSamplesAndAliasTable_SelectsEmittersProportionallyToTheirWeights)
+    {
+        EmitterDistribution distribution;
+        distribution.set_use_alias_table(true);
+        insert_emitters(distribution);
+        distribution.prepare();
+
+        const std::vector<size_t> items = sample_stratified(distribution, 80);
+
+        std::vector<size_t> counts(4, 0);
+        for (size_t i = 0; i < items.size(); ++i)
+            ++counts[items[i]];
+
+        const size_t Expected[] = { 10, 20, 30, 20 };
+        EXPECT_SEQUENCE_EQ(4, Expected, &counts[0]);
+    }
+
+    TEST_CASE(Prepare_GivenAliasTable_LeavesEmitterProbabilitiesUnchanged)
+    {
+        EmitterDistribution cdf;
+        insert_emitters(cdf);
+        cdf.prepare();
+
+        EmitterDistribution alias_table;
+        alias_table.set_use_alias_table(true);
+        insert_emitters(alias_table);
+        alias_table.prepare();
+
+        for (size_t i = 0; i < 4; ++i)
+            EXPECT_FEQ(cdf[i].second, alias_table[i].second);
+    }
 }
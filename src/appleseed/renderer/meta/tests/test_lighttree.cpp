@@ -0,0 +1,175 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/lighttree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Lighting_LightTree)
+{
+    LightTree::Item make_item(
+        const Vector3d&     center,
+        const Vector3f&     axis,
+        const float         power)
+    {
+        LightTree::Item item;
+        item.m_bbox = AABB3d(center - Vector3d(0.1), center + Vector3d(0.1));
+        item.m_axis = axis;
+        item.m_cos_theta_o = 1.0f;
+        item.m_power = power;
+        return item;
+    }
+
+    void make_random_items(vector<LightTree::Item>& items, const size_t count)
+    {
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Vector3d center(
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0));
+
+            const Vector3f axis =
+                normalize(
+                    Vector3f(
+                        rand_float1(rng, -1.0f, 1.0f),
+                        rand_float1(rng, -1.0f, 1.0f),
+                        rand_float1(rng, -1.0f, 1.0f)));
+
+            items.push_back(make_item(center, axis, rand_float1(rng, 0.1f, 2.0f)));
+        }
+    }
+
+    TEST_CASE(Build_GivenItems_CreatesBinaryTree)
+    {
+        vector<LightTree::Item> items;
+        make_random_items(items, 37);
+
+        LightTree tree;
+        tree.build(items);
+
+        EXPECT_EQ(2 * 37 - 1, tree.get_node_count());
+    }
+
+    TEST_CASE(Build_GivenNoItem_CreatesEmptyTree)
+    {
+        LightTree tree;
+        tree.build(vector<LightTree::Item>());
+
+        EXPECT_TRUE(tree.empty());
+    }
+
+    TEST_CASE(Sample_ReturnsProbabilityMatchingEvaluatePDF)
+    {
+        vector<LightTree::Item> items;
+        make_random_items(items, 100);
+
+        LightTree tree;
+        tree.build(items);
+
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const Vector3d point(
+                rand_double1(rng, -12.0, 12.0),
+                rand_double1(rng, -12.0, 12.0),
+                rand_double1(rng, -12.0, 12.0));
+
+            float probability;
+            const size_t item_index = tree.sample(point, rand_float2(rng), probability);
+
+            EXPECT_LT(items.size(), item_index);
+            EXPECT_GT(0.0f, probability);
+            EXPECT_FEQ_EPS(probability, tree.evaluate_pdf(point, item_index), 1.0e-4f);
+        }
+    }
+
+    TEST_CASE(EvaluatePDF_SumsToOneOverAllItems)
+    {
+        vector<LightTree::Item> items;
+        make_random_items(items, 100);
+
+        LightTree tree;
+        tree.build(items);
+
+        const Vector3d point(1.0, -2.0, 3.0);
+
+        float sum = 0.0f;
+        for (size_t i = 0; i < items.size(); ++i)
+            sum += tree.evaluate_pdf(point, i);
+
+        EXPECT_FEQ_EPS(1.0f, sum, 1.0e-4f);
+    }
+
+    TEST_CASE(EvaluatePDF_GivenItemFacingAwayFromPoint_ReturnsZero)
+    {
+        vector<LightTree::Item> items;
+        items.push_back(make_item(Vector3d(0.0, 1.0, 0.0), Vector3f(0.0f, -1.0f, 0.0f), 1.0f));
+        items.push_back(make_item(Vector3d(0.0, -1.0, 0.0), Vector3f(0.0f, -1.0f, 0.0f), 1.0f));
+
+        LightTree tree;
+        tree.build(items);
+
+        const Vector3d point(0.0, 0.0, 0.0);
+
+        EXPECT_FEQ(1.0f, tree.evaluate_pdf(point, 0));
+        EXPECT_EQ(0.0f, tree.evaluate_pdf(point, 1));
+    }
+
+    TEST_CASE(EvaluatePDF_GivenCloserItem_FavorsCloserItem)
+    {
+        vector<LightTree::Item> items;
+        items.push_back(make_item(Vector3d(0.0, 1.0, 0.0), Vector3f(0.0f, -1.0f, 0.0f), 1.0f));
+        items.push_back(make_item(Vector3d(0.0, 10.0, 0.0), Vector3f(0.0f, -1.0f, 0.0f), 1.0f));
+
+        LightTree tree;
+        tree.build(items);
+
+        const Vector3d point(0.0, 0.0, 0.0);
+
+        EXPECT_GT(tree.evaluate_pdf(point, 1), tree.evaluate_pdf(point, 0));
+    }
+}
@@ -28,6 +28,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/rendering/localsampleaccumulationbuffer.h"
+#include "renderer/kernel/rendering/sample.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/color.h"
@@ -43,6 +44,7 @@
 
 // Standard headers.
 #include <cstddef>
+#include <vector>
 
 using namespace foundation;
 using namespace renderer;
@@ -85,7 +87,7 @@ TEST_SUITE(Renderer_Kernel_Rendering_LocalSampleAccumulationBuffer)
             LocalSampleAccumulationBuffer::develop_to_tile_undo_premult_alpha(
                 color_tile,
                 depth_tile,
-                256, 256,
+                AABB2u(Vector2u(0, 0), Vector2u(255, 255)),
                 level,
                 0, 0,
                 rect);
@@ -95,7 +97,7 @@ TEST_SUITE(Renderer_Kernel_Rendering_LocalSampleAccumulationBuffer)
             LocalSampleAccumulationBuffer::develop_to_tile(
                 color_tile,
                 depth_tile,
-                256, 256,
+                AABB2u(Vector2u(0, 0), Vector2u(255, 255)),
                 level,
                 0, 0,
                 rect);
@@ -138,6 +140,54 @@ TEST_SUITE(Renderer_Kernel_Rendering_LocalSampleAccumulationBuffer)
         EXPECT_TRUE(honors_crop_window(AABB2u(Vector2u(5, 3), Vector2u(6, 3)), false));
     }
 
+    TEST_CASE(DevelopToTile_LevelCoversWindowOfImage_ReadsLevelInWindowSpace)
+    {
+        // A level covering the 16x8 pixels window (40, 20)-(55, 27) of the image at full resolution.
+        const BoxFilter2<float> filter(0.5f, 0.5f);
+        FilteredTile level(16, 8, 5, filter);
+        level.clear();
+
+        for (size_t y = 0; y < level.get_height(); ++y)
+        {
+            for (size_t x = 0; x < level.get_width(); ++x)
+            {
+                const float value = static_cast<float>(y * level.get_width() + x);
+                const float values[5] = { value, value, value, 1.0f, value };
+                level.add(x + 0.5f, y + 0.5f, values);
+            }
+        }
+
+        // The tile at (32, 16) of the image.
+        Tile color_tile(32, 16, 4, PixelFormatFloat);
+        Tile depth_tile(32, 16, 1, PixelFormatFloat);
+        color_tile.clear(Color4f(-1.0f));
+        depth_tile.clear(Color<float, 1>(-1.0f));
+
+        const AABB2u window(Vector2u(40, 20), Vector2u(55, 27));
+
+        LocalSampleAccumulationBuffer::develop_to_tile(
+            color_tile,
+            depth_tile,
+            window,
+            level,
+            32, 16,
+            window);
+
+        float color[4];
+        color_tile.get_pixel(8, 4, color);
+        EXPECT_EQ(0.0f, color[0]);
+
+        color_tile.get_pixel(23, 11, color);
+        EXPECT_EQ(127.0f, color[0]);
+
+        float depth[1];
+        depth_tile.get_pixel(9, 5, depth);
+        EXPECT_EQ(17.0f, depth[0]);
+
+        color_tile.get_pixel(7, 4, color);
+        EXPECT_EQ(-1.0f, color[0]);
+    }
+
     TEST_CASE(DevelopToTileUndoPremultAlpha_StressTest)
     {
         MersenneTwister rng;
@@ -161,4 +211,39 @@ TEST_SUITE(Renderer_Kernel_Rendering_LocalSampleAccumulationBuffer)
             EXPECT_TRUE(honors_crop_window(crop_window, false));
         }
     }
+
+    TEST_CASE(StorePreviewSamples_DoesNotCountPreviewSamples)
+    {
+        const BoxFilter2<float> filter(0.5f, 0.5f);
+        LocalSampleAccumulationBuffer buffer(64, 64, filter);
+
+        vector<Sample> samples(64 * 64);
+        for (size_t y = 0; y < 64; ++y)
+        {
+            for (size_t x = 0; x < 64; ++x)
+            {
+                Sample& sample = samples[y * 64 + x];
+                sample.m_position = Vector2f((x + 0.5f) / 64.0f, (y + 0.5f) / 64.0f);
+                for (size_t c = 0; c < 5; ++c)
+                    sample.m_values[c] = 1.0f;
+            }
+        }
+
+        EXPECT_TRUE(buffer.store_preview_samples(samples.size(), &samples[0]));
+        EXPECT_EQ(0, buffer.get_sample_count());
+    }
+
+    TEST_CASE(StorePreviewSamples_HighestResolutionLevelIsActive_ReturnsFalse)
+    {
+        const BoxFilter2<float> filter(0.5f, 0.5f);
+        LocalSampleAccumulationBuffer buffer(8, 8, filter);
+
+        Sample sample;
+        sample.m_position = Vector2f(0.5f, 0.5f);
+        for (size_t c = 0; c < 5; ++c)
+            sample.m_values[c] = 1.0f;
+
+        // An 8x8 buffer only has a single level.
+        EXPECT_FALSE(buffer.store_preview_samples(1, &sample));
+    }
 }
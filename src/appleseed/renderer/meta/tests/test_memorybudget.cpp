@@ -0,0 +1,118 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/memorybudget.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_MemoryBudget)
+{
+    class FakePool
+      : public MemoryBudget::IPool
+    {
+      public:
+        explicit FakePool(size_t& memory_size)
+          : m_memory_size(memory_size)
+        {
+        }
+
+        virtual size_t get_memory_size() const APPLESEED_OVERRIDE
+        {
+            return m_memory_size;
+        }
+
+      private:
+        size_t& m_memory_size;
+    };
+
+    TEST_CASE(Poll_SumsPoolSizes)
+    {
+        size_t fixed_size = 100;
+        size_t evictable_size = 20;
+
+        MemoryBudget budget(1000);
+        budget.register_pool("fixed", MemoryBudget::FixedPool, auto_ptr<MemoryBudget::IPool>(new FakePool(fixed_size)));
+        budget.register_pool("evictable", MemoryBudget::EvictablePool, auto_ptr<MemoryBudget::IPool>(new FakePool(evictable_size)));
+
+        EXPECT_EQ(120, budget.poll());
+        EXPECT_EQ(120, budget.get_memory_size());
+    }
+
+    TEST_CASE(Poll_SamplesFixedPoolsOnlyOnRefresh)
+    {
+        size_t fixed_size = 100;
+        size_t evictable_size = 20;
+
+        MemoryBudget budget(1000);
+        const size_t fixed_index =
+            budget.register_pool("fixed", MemoryBudget::FixedPool, auto_ptr<MemoryBudget::IPool>(new FakePool(fixed_size)));
+        const size_t evictable_index =
+            budget.register_pool("evictable", MemoryBudget::EvictablePool, auto_ptr<MemoryBudget::IPool>(new FakePool(evictable_size)));
+
+        fixed_size = 200;
+        evictable_size = 30;
+
+        EXPECT_EQ(130, budget.poll());
+        EXPECT_EQ(100, budget.get_pool_memory_size(fixed_index));
+        EXPECT_EQ(30, budget.get_pool_memory_size(evictable_index));
+
+        budget.refresh();
+
+        EXPECT_EQ(230, budget.get_memory_size());
+        EXPECT_EQ(200, budget.get_pool_memory_size(fixed_index));
+    }
+
+    TEST_CASE(GetPeakMemorySize_ReturnsLargestPolledTotal)
+    {
+        size_t evictable_size = 50;
+
+        MemoryBudget budget(1000);
+        budget.register_pool("evictable", MemoryBudget::EvictablePool, auto_ptr<MemoryBudget::IPool>(new FakePool(evictable_size)));
+
+        evictable_size = 300;
+        budget.poll();
+
+        evictable_size = 10;
+        budget.poll();
+
+        EXPECT_EQ(10, budget.get_memory_size());
+        EXPECT_EQ(300, budget.get_peak_memory_size());
+    }
+}
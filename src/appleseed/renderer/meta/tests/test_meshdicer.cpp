@@ -0,0 +1,106 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// appleseed.renderer headers.
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/tessellation/meshdicer.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Tessellation_MeshDicer)
+{
+    auto_release_ptr<MeshObject> create_quad_mesh()
+    {
+        auto_release_ptr<MeshObject> object(MeshObjectFactory::create("quad", ParamArray()));
+
+        object->push_vertex(GVector3(0.0f, 0.0f, 0.0f));
+        object->push_vertex(GVector3(1.0f, 0.0f, 0.0f));
+        object->push_vertex(GVector3(1.0f, 1.0f, 0.0f));
+        object->push_vertex(GVector3(0.0f, 1.0f, 0.0f));
+        object->push_vertex_normal(GVector3(0.0f, 0.0f, 1.0f));
+        object->push_triangle(Triangle(0, 1, 2, 0, 0, 0, 0));
+        object->push_triangle(Triangle(0, 2, 3, 0, 0, 0, 0));
+        object->push_material_slot("material");
+
+        return object;
+    }
+
+    TEST_CASE(CreateDicedMeshObject_SharesVerticesBetweenAdjacentTriangles)
+    {
+        auto_release_ptr<MeshObject> mesh(create_quad_mesh());
+
+        auto_release_ptr<MeshObject> diced(create_diced_mesh_object(mesh.ref(), 2));
+
+        // Two triangles split four ways twice, over a 5x5 grid of vertices.
+        EXPECT_EQ(32, diced->get_triangle_count());
+        EXPECT_EQ(25, diced->get_vertex_count());
+        EXPECT_EQ(1, diced->get_vertex_normal_count());
+        EXPECT_EQ(1, diced->get_material_slot_count());
+    }
+
+    TEST_CASE(CreateDicedMeshObject_GivenLevelZero_CopiesGeometry)
+    {
+        auto_release_ptr<MeshObject> mesh(create_quad_mesh());
+
+        auto_release_ptr<MeshObject> diced(create_diced_mesh_object(mesh.ref(), 0));
+
+        EXPECT_EQ(2, diced->get_triangle_count());
+        EXPECT_EQ(4, diced->get_vertex_count());
+    }
+
+    TEST_CASE(SetDicedGeometry_ThenRestoreUndicedGeometry_RestoresOriginalGeometry)
+    {
+        auto_release_ptr<MeshObject> mesh(create_quad_mesh());
+
+        mesh->set_diced_geometry(create_diced_mesh_object(mesh.ref(), 1), 1);
+
+        EXPECT_EQ(8, mesh->get_triangle_count());
+        EXPECT_EQ(1, mesh->get_dicing_level());
+        EXPECT_EQ(2, mesh->get_undiced_mesh().get_triangle_count());
+
+        mesh->set_diced_geometry(create_diced_mesh_object(mesh->get_undiced_mesh(), 2), 2);
+
+        EXPECT_EQ(32, mesh->get_triangle_count());
+        EXPECT_EQ(2, mesh->get_undiced_mesh().get_triangle_count());
+
+        mesh->restore_undiced_geometry();
+
+        EXPECT_EQ(2, mesh->get_triangle_count());
+        EXPECT_EQ(0, mesh->get_dicing_level());
+        EXPECT_TRUE(&mesh->get_undiced_mesh() == &mesh.ref());
+    }
+}
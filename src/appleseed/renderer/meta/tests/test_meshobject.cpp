@@ -0,0 +1,83 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Object_MeshObject)
+{
+    auto_release_ptr<MeshObject> create_triangle_mesh()
+    {
+        auto_release_ptr<MeshObject> object(MeshObjectFactory::create("object", ParamArray()));
+
+        object->push_vertex(GVector3(0.0f, 0.0f, 0.0f));
+        object->push_vertex(GVector3(1.0f, 0.0f, 0.0f));
+        object->push_vertex(GVector3(0.0f, 1.0f, 2.0f));
+        object->push_triangle(Triangle(0, 1, 2));
+
+        return object;
+    }
+
+    TEST_CASE(ReleaseVertices_ReleasesVerticesAndRetainsBoundingBox)
+    {
+        auto_release_ptr<MeshObject> object(create_triangle_mesh());
+        const GAABB3 expected_bbox = object->compute_local_bbox();
+
+        object->release_vertices();
+
+        EXPECT_TRUE(object->has_released_vertices());
+        EXPECT_EQ(0, object->get_vertex_count());
+        EXPECT_EQ(1, object->get_triangle_count());
+        EXPECT_EQ(expected_bbox, object->compute_local_bbox());
+    }
+
+    TEST_CASE(ReleaseVertices_GivenMovingMesh_KeepsVertices)
+    {
+        auto_release_ptr<MeshObject> object(create_triangle_mesh());
+        object->set_motion_segment_count(1);
+        for (size_t i = 0; i < 3; ++i)
+            object->set_vertex_pose(i, 0, object->get_vertex(i) + GVector3(1.0f, 0.0f, 0.0f));
+
+        object->release_vertices();
+
+        EXPECT_FALSE(object->has_released_vertices());
+        EXPECT_EQ(3, object->get_vertex_count());
+    }
+}
@@ -0,0 +1,147 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectoperations.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/transform.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstring>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Object_MeshObjectOperations)
+{
+    auto_release_ptr<MeshObject> create_triangle_mesh(
+        const char*         name,
+        const ParamArray&   params,
+        const GScalar       z)
+    {
+        auto_release_ptr<MeshObject> object(MeshObjectFactory::create(name, params));
+
+        object->push_vertex(GVector3(0.0f, 0.0f, z));
+        object->push_vertex(GVector3(1.0f, 0.0f, z));
+        object->push_vertex(GVector3(0.0f, 1.0f, z));
+        object->push_triangle(Triangle(0, 1, 2));
+
+        return object;
+    }
+
+    void insert_object_instance(Assembly& assembly, const char* name, const char* object_name)
+    {
+        assembly.object_instances().insert(
+            ObjectInstanceFactory::create(
+                name,
+                ParamArray(),
+                object_name,
+                Transformd::identity(),
+                StringDictionary()));
+    }
+
+    TEST_CASE(ComputeGeometryHash_GivenIdenticalMeshes_ReturnsSameHash)
+    {
+        auto_release_ptr<MeshObject> object1(create_triangle_mesh("object1", ParamArray(), 0.0f));
+        auto_release_ptr<MeshObject> object2(create_triangle_mesh("object2", ParamArray(), 0.0f));
+
+        EXPECT_EQ(compute_geometry_hash(object1.ref()), compute_geometry_hash(object2.ref()));
+    }
+
+    TEST_CASE(ComputeGeometryHash_GivenMeshesWithDifferentVertices_ReturnsDifferentHashes)
+    {
+        auto_release_ptr<MeshObject> object1(create_triangle_mesh("object1", ParamArray(), 0.0f));
+        auto_release_ptr<MeshObject> object2(create_triangle_mesh("object2", ParamArray(), 1.0f));
+
+        EXPECT_NEQ(compute_geometry_hash(object1.ref()), compute_geometry_hash(object2.ref()));
+    }
+
+    TEST_CASE(MergeIdenticalMeshObjects_RemovesDuplicatesAndRetargetsInstances)
+    {
+        auto_release_ptr<Assembly> assembly(AssemblyFactory().create("assembly", ParamArray()));
+        assembly->objects().insert(
+            auto_release_ptr<Object>(create_triangle_mesh("object1", ParamArray().insert("filename", "a.obj"), 0.0f)));
+        assembly->objects().insert(
+            auto_release_ptr<Object>(create_triangle_mesh("object2", ParamArray().insert("filename", "b.obj"), 0.0f)));
+        assembly->objects().insert(
+            auto_release_ptr<Object>(create_triangle_mesh("object3", ParamArray().insert("filename", "c.obj"), 1.0f)));
+        insert_object_instance(assembly.ref(), "object1_inst", "object1");
+        insert_object_instance(assembly.ref(), "object2_inst", "object2");
+        insert_object_instance(assembly.ref(), "object3_inst", "object3");
+
+        const size_t removed_count = merge_identical_mesh_objects(assembly.ref());
+
+        EXPECT_EQ(1, removed_count);
+        EXPECT_EQ(2, assembly->objects().size());
+        EXPECT_TRUE(assembly->objects().get_by_name("object2") == 0);
+        EXPECT_EQ(0, strcmp("object1", assembly->object_instances().get_by_name("object2_inst")->get_object_name()));
+        EXPECT_EQ(0, strcmp("object3", assembly->object_instances().get_by_name("object3_inst")->get_object_name()));
+    }
+
+    TEST_CASE(MergeIdenticalMeshObjects_GivenMeshesWithDifferentParameters_KeepsBoth)
+    {
+        auto_release_ptr<Assembly> assembly(AssemblyFactory().create("assembly", ParamArray()));
+        assembly->objects().insert(
+            auto_release_ptr<Object>(create_triangle_mesh("object1", ParamArray(), 0.0f)));
+        assembly->objects().insert(
+            auto_release_ptr<Object>(create_triangle_mesh("object2", ParamArray().insert("alpha_map", "0.5"), 0.0f)));
+
+        const size_t removed_count = merge_identical_mesh_objects(assembly.ref());
+
+        EXPECT_EQ(0, removed_count);
+        EXPECT_EQ(2, assembly->objects().size());
+    }
+
+    TEST_CASE(MergeIdenticalMeshObjects_GivenMeshesWithReleasedVertices_KeepsBoth)
+    {
+        auto_release_ptr<MeshObject> object1(create_triangle_mesh("object1", ParamArray(), 0.0f));
+        auto_release_ptr<MeshObject> object2(create_triangle_mesh("object2", ParamArray(), 1.0f));
+        object1->release_vertices();
+        object2->release_vertices();
+
+        auto_release_ptr<Assembly> assembly(AssemblyFactory().create("assembly", ParamArray()));
+        assembly->objects().insert(auto_release_ptr<Object>(object1));
+        assembly->objects().insert(auto_release_ptr<Object>(object2));
+
+        const size_t removed_count = merge_identical_mesh_objects(assembly.ref());
+
+        EXPECT_EQ(0, removed_count);
+        EXPECT_EQ(2, assembly->objects().size());
+    }
+}
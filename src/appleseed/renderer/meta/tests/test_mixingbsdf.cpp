@@ -0,0 +1,354 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/tracer.h"
+#include "renderer/kernel/rendering/rendererservices.h"
+#include "renderer/kernel/shading/oslshadergroupexec.h"
+#include "renderer/kernel/shading/shadingcontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/bsdf/bsdf.h"
+#include "renderer/modeling/bsdf/bsdfmix.h"
+#include "renderer/modeling/bsdf/lambertianbrdf.h"
+#include "renderer/modeling/entity/onframebeginrecorder.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/math/basis.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/arena.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/test.h"
+
+// OSL headers.
+#include "foundation/platform/oslheaderguards.h"
+BEGIN_OSL_INCLUDES
+#include "OSL/oslexec.h"
+END_OSL_INCLUDES
+
+// OpenImageIO headers.
+#include "foundation/platform/oiioheaderguards.h"
+BEGIN_OIIO_INCLUDES
+#include "OpenImageIO/texture.h"
+END_OIIO_INCLUDES
+
+// Boost headers.
+#include "boost/bind.hpp"
+#include "boost/shared_ptr.hpp"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_BSDF_MixingBSDF)
+{
+    struct Fixture
+      : public TestFixtureBase
+    {
+        Fixture()
+        {
+            auto_release_ptr<MeshObject> mesh_object =
+                MeshObjectFactory::create("plane", ParamArray());
+
+            mesh_object->push_vertex(GVector3(0.0f, -0.5f, -0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, +0.5f, -0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, +0.5f, +0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, -0.5f, +0.5f));
+
+            mesh_object->push_vertex_normal(GVector3(-1.0f, 0.0f, 0.0f));
+
+            mesh_object->push_triangle(Triangle(0, 1, 2, 0, 0, 0, 0));
+            mesh_object->push_triangle(Triangle(2, 3, 0, 0, 0, 0, 0));
+
+            m_assembly.objects().insert(auto_release_ptr<Object>(mesh_object.release()));
+
+            m_assembly.object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "plane_inst",
+                    ParamArray(),
+                    "plane",
+                    Transformd::identity(),
+                    StringDictionary()));
+
+            m_scene.assembly_instances().insert(
+                AssemblyInstanceFactory::create(
+                    "assembly_inst",
+                    ParamArray(),
+                    "assembly"));
+
+            create_color_entity("red", Color3f(0.8f, 0.1f, 0.1f));
+            create_color_entity("green", Color3f(0.1f, 0.7f, 0.2f));
+            create_color_entity("blue", Color3f(0.2f, 0.3f, 0.9f));
+
+            create_lambertian_brdf("red_brdf", "red");
+            create_lambertian_brdf("green_brdf", "green");
+            create_lambertian_brdf("blue_brdf", "blue");
+        }
+
+        void create_lambertian_brdf(const char* name, const char* reflectance)
+        {
+            m_assembly.bsdfs().insert(
+                LambertianBRDFFactory().create(
+                    name,
+                    ParamArray().insert("reflectance", reflectance)));
+        }
+
+        void create_bsdf_mix(
+            const char*     name,
+            const char*     bsdf0,
+            const float     weight0,
+            const char*     bsdf1,
+            const float     weight1)
+        {
+            m_assembly.bsdfs().insert(
+                BSDFMixFactory().create(
+                    name,
+                    ParamArray()
+                        .insert("bsdf0", bsdf0)
+                        .insert("weight0", weight0)
+                        .insert("bsdf1", bsdf1)
+                        .insert("weight1", weight1)));
+        }
+
+        const BSDF& get_bsdf(const char* name) const
+        {
+            return *m_assembly.bsdfs().get_by_name(name);
+        }
+
+        // Evaluate the mixing BSDF 'mix' and the leaf BSDFs it is expected to reduce to,
+        // and return true if the mix matches the weighted sum of the leaves.
+        bool check_mix(
+            const char*     mix,
+            const size_t    leaf_count,
+            const char*     leaves[],
+            const float     weights[])
+        {
+            bind_inputs();
+
+            OnFrameBeginRecorder recorder;
+            for (each<BSDFContainer> i = m_assembly.bsdfs(); i; ++i)
+            {
+                if (!i->on_frame_begin(m_project, &m_assembly, recorder))
+                {
+                    recorder.on_frame_end(m_project);
+                    return false;
+                }
+            }
+
+            TraceContext trace_context(m_scene);
+            TextureStore texture_store(m_scene);
+            TextureCache texture_cache(texture_store);
+            Intersector intersector(trace_context, texture_cache);
+
+            boost::shared_ptr<OIIO::TextureSystem> texture_system(
+                OIIO::TextureSystem::create(),
+                boost::bind(&OIIO::TextureSystem::destroy, _1));
+
+            RendererServices renderer_services(m_project, *texture_system);
+
+            boost::shared_ptr<OSL::ShadingSystem> shading_system(
+                new OSL::ShadingSystem(&renderer_services, texture_system.get()));
+
+            Arena arena;
+            OSLShaderGroupExec sg_exec(*shading_system, arena);
+
+            Tracer tracer(m_scene, intersector, texture_cache, sg_exec);
+
+            ShadingContext shading_context(
+                intersector,
+                tracer,
+                texture_cache,
+                *texture_system,
+                sg_exec,
+                arena,
+                0);
+
+            const ShadingRay ray(
+                Vector3d(-1.0, 0.1, 0.2),
+                Vector3d(1.0, 0.0, 0.0),
+                0.0,                                // tmin
+                2.0,                                // tmax
+                ShadingRay::Time(),
+                VisibilityFlags::CameraRay,
+                0);                                 // depth
+
+            ShadingPoint shading_point;
+            if (!intersector.trace(ray, shading_point))
+            {
+                recorder.on_frame_end(m_project);
+                return false;
+            }
+
+            const Vector3f n(-1.0f, 0.0f, 0.0f);
+            const Basis3f basis(n);
+            const Vector3f outgoing = normalize(Vector3f(-1.0f, 0.3f, 0.2f));
+            const Vector3f incoming = normalize(Vector3f(-1.0f, -0.4f, 0.1f));
+
+            Spectrum expected_value(0.0f);
+            float expected_probability = 0.0f;
+
+            for (size_t i = 0; i < leaf_count; ++i)
+            {
+                const BSDF& leaf = get_bsdf(leaves[i]);
+
+                Spectrum leaf_value;
+                const float leaf_probability =
+                    leaf.evaluate(
+                        leaf.evaluate_inputs(shading_context, shading_point),
+                        false,                      // adjoint
+                        false,                      // do not multiply by |cos(incoming, normal)|
+                        n,
+                        basis,
+                        outgoing,
+                        incoming,
+                        ScatteringMode::All,
+                        leaf_value);
+
+                madd(expected_value, leaf_value, weights[i]);
+                expected_probability += leaf_probability * weights[i];
+            }
+
+            const BSDF& mix_bsdf = get_bsdf(mix);
+            const void* mix_data = mix_bsdf.evaluate_inputs(shading_context, shading_point);
+
+            Spectrum value;
+            const float probability =
+                mix_bsdf.evaluate(
+                    mix_data,
+                    false,                          // adjoint
+                    false,                          // do not multiply by |cos(incoming, normal)|
+                    n,
+                    basis,
+                    outgoing,
+                    incoming,
+                    ScatteringMode::All,
+                    value);
+
+            const float pdf =
+                mix_bsdf.evaluate_pdf(
+                    mix_data,
+                    n,
+                    basis,
+                    outgoing,
+                    incoming,
+                    ScatteringMode::All);
+
+            recorder.on_frame_end(m_project);
+
+            return
+                feq(value, expected_value, 1.0e-5f) &&
+                feq(probability, expected_probability, 1.0e-5f) &&
+                feq(pdf, expected_probability, 1.0e-5f);
+        }
+    };
+
+    TEST_CASE_F(Evaluate_GivenSingleMix_MatchesWeightedSumOfChildren, Fixture)
+    {
+        create_bsdf_mix("mix", "red_brdf", 0.3f, "green_brdf", 0.1f);
+
+        const char* leaves[] = { "red_brdf", "green_brdf" };
+        const float weights[] = { 0.75f, 0.25f };
+
+        EXPECT_TRUE(check_mix("mix", 2, leaves, weights));
+    }
+
+    TEST_CASE_F(Evaluate_GivenNestedMixes_MatchesNestedEvaluation, Fixture)
+    {
+        // mix(mix(red, green), blue): the inner mix gets 0.6, the blue leaf gets 0.4.
+        create_bsdf_mix("inner_mix", "red_brdf", 0.2f, "green_brdf", 0.6f);
+        create_bsdf_mix("outer_mix", "inner_mix", 0.3f, "blue_brdf", 0.2f);
+
+        const char* leaves[] = { "red_brdf", "green_brdf", "blue_brdf" };
+        const float weights[] = { 0.6f * 0.25f, 0.6f * 0.75f, 0.4f };
+
+        EXPECT_TRUE(check_mix("outer_mix", 3, leaves, weights));
+    }
+
+    TEST_CASE_F(Evaluate_GivenLeafReachableThroughTwoPaths_AccumulatesItsWeights, Fixture)
+    {
+        // mix(mix(red, green), red): the red leaf is shared by both levels.
+        create_bsdf_mix("inner_mix", "red_brdf", 0.5f, "green_brdf", 0.5f);
+        create_bsdf_mix("outer_mix", "inner_mix", 0.5f, "red_brdf", 0.5f);
+
+        const char* leaves[] = { "red_brdf", "green_brdf" };
+        const float weights[] = { 0.5f * 0.5f + 0.5f, 0.5f * 0.5f };
+
+        EXPECT_TRUE(check_mix("outer_mix", 2, leaves, weights));
+    }
+
+    TEST_CASE_F(Evaluate_GivenZeroWeightBranch_IgnoresIt, Fixture)
+    {
+        create_bsdf_mix("inner_mix", "red_brdf", 0.5f, "green_brdf", 0.5f);
+        create_bsdf_mix("outer_mix", "inner_mix", 0.0f, "blue_brdf", 1.0f);
+
+        const char* leaves[] = { "blue_brdf" };
+        const float weights[] = { 1.0f };
+
+        EXPECT_TRUE(check_mix("outer_mix", 1, leaves, weights));
+    }
+
+    TEST_CASE_F(OnFrameBegin_GivenCyclicMixes_ReturnsFalse, Fixture)
+    {
+        create_bsdf_mix("mix_a", "mix_b", 0.5f, "red_brdf", 0.5f);
+        create_bsdf_mix("mix_b", "mix_a", 0.5f, "green_brdf", 0.5f);
+
+        bind_inputs();
+
+        OnFrameBeginRecorder recorder;
+        const bool success =
+            m_assembly.bsdfs().get_by_name("mix_a")->on_frame_begin(m_project, &m_assembly, recorder);
+        recorder.on_frame_end(m_project);
+
+        EXPECT_FALSE(success);
+    }
+}
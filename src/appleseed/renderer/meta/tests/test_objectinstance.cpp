@@ -0,0 +1,119 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// appleseed.renderer headers.
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/transform.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Scene_ObjectInstance)
+{
+    auto_release_ptr<ObjectInstance> create_object_instance(const ParamArray& params)
+    {
+        return
+            ObjectInstanceFactory::create(
+                "object_inst",
+                params,
+                "object",
+                Transformd::identity(),
+                StringDictionary());
+    }
+
+    TEST_CASE(IsIlluminatedBy_GivenNoLightLinks_ReturnsTrue)
+    {
+        auto_release_ptr<ObjectInstance> object_instance(create_object_instance(ParamArray()));
+
+        EXPECT_FALSE(object_instance->has_light_links());
+        EXPECT_TRUE(object_instance->is_illuminated_by("light"));
+    }
+
+    TEST_CASE(IsIlluminatedBy_GivenIncludedLights_ReturnsTrueOnlyForIncludedLights)
+    {
+        auto_release_ptr<ObjectInstance> object_instance(
+            create_object_instance(ParamArray().insert("included_lights", "key_light  rim_light")));
+
+        EXPECT_TRUE(object_instance->has_light_links());
+        EXPECT_TRUE(object_instance->is_illuminated_by("key_light"));
+        EXPECT_TRUE(object_instance->is_illuminated_by("rim_light"));
+        EXPECT_FALSE(object_instance->is_illuminated_by("fill_light"));
+    }
+
+    TEST_CASE(IsIlluminatedBy_GivenExcludedLights_ReturnsFalseOnlyForExcludedLights)
+    {
+        auto_release_ptr<ObjectInstance> object_instance(
+            create_object_instance(ParamArray().insert("excluded_lights", "fill_light")));
+
+        EXPECT_TRUE(object_instance->has_light_links());
+        EXPECT_TRUE(object_instance->is_illuminated_by("key_light"));
+        EXPECT_FALSE(object_instance->is_illuminated_by("fill_light"));
+    }
+
+    TEST_CASE(IsIlluminatedBy_GivenLightBothIncludedAndExcluded_ReturnsFalse)
+    {
+        auto_release_ptr<ObjectInstance> object_instance(
+            create_object_instance(
+                ParamArray()
+                    .insert("included_lights", "key_light fill_light")
+                    .insert("excluded_lights", "fill_light")));
+
+        EXPECT_TRUE(object_instance->is_illuminated_by("key_light"));
+        EXPECT_FALSE(object_instance->is_illuminated_by("fill_light"));
+    }
+
+    TEST_CASE(IsLODSelected_GivenNoLODRange_ReturnsTrueAtAnySize)
+    {
+        auto_release_ptr<ObjectInstance> object_instance(create_object_instance(ParamArray()));
+
+        EXPECT_FALSE(object_instance->has_lod_range());
+        EXPECT_TRUE(object_instance->is_lod_selected(0.0f));
+        EXPECT_TRUE(object_instance->is_lod_selected(1.0e6f));
+    }
+
+    TEST_CASE(IsLODSelected_GivenLODRange_ReturnsTrueOnlyWithinRange)
+    {
+        auto_release_ptr<ObjectInstance> object_instance(
+            create_object_instance(
+                ParamArray()
+                    .insert("lod_min_size", "0.1")
+                    .insert("lod_max_size", "0.5")));
+
+        EXPECT_TRUE(object_instance->has_lod_range());
+        EXPECT_FALSE(object_instance->is_lod_selected(0.05f));
+        EXPECT_TRUE(object_instance->is_lod_selected(0.1f));
+        EXPECT_TRUE(object_instance->is_lod_selected(0.3f));
+        EXPECT_FALSE(object_instance->is_lod_selected(0.5f));
+    }
+}
@@ -0,0 +1,140 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/intersection/occludercache.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Intersection_OccluderCache)
+{
+    const TriangleType Triangle(
+        Vector3d(-1.0, -1.0, 0.0),
+        Vector3d( 1.0, -1.0, 0.0),
+        Vector3d( 0.0,  1.0, 0.0));
+
+    ShadingRay make_ray(const double tmax, const VisibilityFlags::Type flags)
+    {
+        return
+            ShadingRay(
+                Vector3d(0.0, 0.0, 1.0),
+                Vector3d(0.0, 0.0, -1.0),
+                0.0,
+                tmax,
+                ShadingRay::Time(),
+                flags,
+                0);
+    }
+
+    struct Fixture
+    {
+        auto_release_ptr<AssemblyInstance> m_assembly_instance;
+
+        Fixture()
+          : m_assembly_instance(
+                AssemblyInstanceFactory::create(
+                    "assembly_instance",
+                    ParamArray(),
+                    "assembly"))
+        {
+        }
+
+        void set(
+            OccluderCache&          cache,
+            const uint32            vis_flags,
+            const Transformd&       transform = Transformd::identity()) const
+        {
+            cache.set(Triangle, vis_flags, m_assembly_instance.ref(), transform);
+        }
+    };
+
+    TEST_CASE(Intersect_GivenEmptyCache_ReturnsFalse)
+    {
+        const OccluderCache cache;
+
+        EXPECT_FALSE(cache.intersect(make_ray(2.0, VisibilityFlags::ShadowRay)));
+    }
+
+    TEST_CASE_F(Intersect_GivenCachedOccluderOnRayPath_ReturnsTrue, Fixture)
+    {
+        OccluderCache cache;
+        set(cache, VisibilityFlags::CameraRay | VisibilityFlags::ShadowRay);
+
+        EXPECT_TRUE(cache.intersect(make_ray(2.0, VisibilityFlags::ShadowRay)));
+    }
+
+    TEST_CASE_F(Intersect_GivenCachedOccluderBeyondRayTMax_ReturnsFalse, Fixture)
+    {
+        OccluderCache cache;
+        set(cache, VisibilityFlags::CameraRay | VisibilityFlags::ShadowRay);
+
+        EXPECT_FALSE(cache.intersect(make_ray(0.5, VisibilityFlags::ShadowRay)));
+    }
+
+    TEST_CASE_F(Intersect_GivenCachedOccluderInvisibleToRay_ReturnsFalse, Fixture)
+    {
+        OccluderCache cache;
+        set(cache, VisibilityFlags::CameraRay);
+
+        EXPECT_FALSE(cache.intersect(make_ray(2.0, VisibilityFlags::ShadowRay)));
+    }
+
+    TEST_CASE_F(Intersect_AfterClear_ReturnsFalse, Fixture)
+    {
+        OccluderCache cache;
+        set(cache, VisibilityFlags::CameraRay | VisibilityFlags::ShadowRay);
+        cache.clear();
+
+        EXPECT_FALSE(cache.intersect(make_ray(2.0, VisibilityFlags::ShadowRay)));
+    }
+
+    TEST_CASE_F(Intersect_GivenTranslatedAssemblyInstance_TransformsRayToOccluderSpace, Fixture)
+    {
+        OccluderCache cache;
+        set(
+            cache,
+            VisibilityFlags::ShadowRay,
+            Transformd::from_local_to_parent(Matrix4d::make_translation(Vector3d(3.0, 0.0, 0.0))));
+
+        EXPECT_FALSE(cache.intersect(make_ray(2.0, VisibilityFlags::ShadowRay)));
+    }
+}
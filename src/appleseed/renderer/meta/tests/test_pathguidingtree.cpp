@@ -0,0 +1,186 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/pathguidingtree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_PathGuidingTree)
+{
+    const AABB3d SceneBBox(Vector3d(-1.0), Vector3d(1.0));
+
+    PathGuidingTree::Record make_record(
+        const Vector3f&     position,
+        const Vector3f&     direction,
+        const float         radiance)
+    {
+        PathGuidingTree::Record record;
+        record.m_position = position;
+        record.m_direction = direction;
+        record.m_radiance = radiance;
+        return record;
+    }
+
+    // Train a tree with light mostly coming from +Y, and some from every direction.
+    void train(PathGuidingTree& tree, const size_t record_count)
+    {
+        MersenneTwister rng;
+        PathGuidingTree::RecordVector records;
+
+        for (size_t i = 0; i < record_count; ++i)
+        {
+            const Vector3f position(
+                rand_float1(rng, -1.0f, 1.0f),
+                rand_float1(rng, -1.0f, 1.0f),
+                rand_float1(rng, -1.0f, 1.0f));
+
+            const Vector2f s(rand_float2(rng), rand_float2(rng));
+            const Vector3f direction = sample_sphere_uniform(s);
+
+            records.push_back(make_record(position, direction, direction[1] > 0.9f ? 10.0f : 0.1f));
+        }
+
+        tree.append(records);
+        tree.update();
+    }
+
+    TEST_CASE(IsTrained_GivenNoRecord_ReturnsFalse)
+    {
+        PathGuidingTree tree(SceneBBox, 100);
+        tree.update();
+
+        EXPECT_FALSE(tree.is_trained());
+        EXPECT_EQ(1, tree.get_leaf_count());
+    }
+
+    TEST_CASE(Update_GivenManyRecords_SplitsTree)
+    {
+        PathGuidingTree tree(SceneBBox, 100);
+        train(tree, 1000);
+
+        EXPECT_TRUE(tree.is_trained());
+        EXPECT_GT(1, tree.get_leaf_count());
+    }
+
+    TEST_CASE(Update_GivenFewRecords_DoesNotSplitTree)
+    {
+        PathGuidingTree tree(SceneBBox, 100);
+        train(tree, 50);
+
+        EXPECT_TRUE(tree.is_trained());
+        EXPECT_EQ(1, tree.get_leaf_count());
+    }
+
+    TEST_CASE(EvaluatePDF_IntegratesToOne)
+    {
+        PathGuidingTree tree(SceneBBox, 100);
+        train(tree, 1000);
+
+        MersenneTwister rng;
+        const Vector3d point(0.3, -0.2, 0.7);
+
+        // Integrate the density over the sphere with stratified uniform directions.
+        const size_t N = 256;
+        float integral = 0.0f;
+
+        for (size_t y = 0; y < N; ++y)
+        {
+            for (size_t x = 0; x < N; ++x)
+            {
+                const Vector2f s(
+                    (x + rand_float2(rng)) / N,
+                    (y + rand_float2(rng)) / N);
+
+                integral += tree.evaluate_pdf(point, sample_sphere_uniform(s));
+            }
+        }
+
+        integral *= FourPi<float>() / (N * N);
+
+        EXPECT_FEQ_EPS(1.0f, integral, 0.02f);
+    }
+
+    TEST_CASE(Sample_ReturnsPDFOfSampledDirection)
+    {
+        PathGuidingTree tree(SceneBBox, 100);
+        train(tree, 1000);
+
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const Vector3d point(
+                rand_double1(rng, -1.0, 1.0),
+                rand_double1(rng, -1.0, 1.0),
+                rand_double1(rng, -1.0, 1.0));
+
+            Vector3f direction;
+            const float pdf = tree.sample(point, Vector2f(rand_float2(rng), rand_float2(rng)), direction);
+
+            EXPECT_TRUE(is_normalized(direction));
+            EXPECT_FEQ_EPS(pdf, tree.evaluate_pdf(point, direction), 1.0e-3f * pdf);
+        }
+    }
+
+    TEST_CASE(Sample_FavorsBrightDirections)
+    {
+        PathGuidingTree tree(SceneBBox, 100);
+        train(tree, 1000);
+
+        MersenneTwister rng;
+        const Vector3d point(0.0);
+        const size_t SampleCount = 1000;
+        size_t bright_count = 0;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            Vector3f direction;
+            tree.sample(point, Vector2f(rand_float2(rng), rand_float2(rng)), direction);
+
+            if (direction[1] > 0.8f)
+                ++bright_count;
+        }
+
+        // Only 10% of the directions would be this close to +Y with uniform sampling.
+        EXPECT_GT(SampleCount / 2, bright_count);
+    }
+}
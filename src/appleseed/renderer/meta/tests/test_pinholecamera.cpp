@@ -28,6 +28,8 @@
 //
 
 // appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/shading/shadingray.h"
 #include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/camera/pinholecamera.h"
 #include "renderer/modeling/entity/onframebeginrecorder.h"
@@ -37,11 +39,17 @@
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/dual.h"
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/iostreamop.h"
 #include "foundation/utility/test.h"
 
+// Standard headers.
+#include <cstddef>
+
 using namespace foundation;
 using namespace renderer;
 
@@ -85,4 +93,69 @@ TEST_SUITE(Renderer_Modeling_Camera_PinholeCamera)
         recorder.on_frame_end(project.ref());
         project->get_scene()->on_render_end(project.ref());
     }
+
+    TEST_CASE(SpawnRays_ReturnsSameRaysAsSpawnRay)
+    {
+        auto_release_ptr<Camera> camera(
+            PinholeCameraFactory().create(
+                "camera",
+                ParamArray()
+                    .insert("film_width", "0.025")
+                    .insert("film_height", "0.025")
+                    .insert("focal_length", "0.035")));
+
+        camera->transform_sequence().set_transform(
+            0.0f,
+            Transformd::from_local_to_parent(
+                Matrix4d::make_translation(Vector3d(1.0, 2.0, 3.0)) *
+                Matrix4d::make_rotation_y(0.5)));
+
+        auto_release_ptr<Scene> scene(SceneFactory::create());
+        scene->cameras().insert(camera);
+
+        auto_release_ptr<Project> project(ProjectFactory::create("test"));
+        project->set_scene(scene);
+        project->set_frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "512 512")
+                    .insert("camera", "camera")));
+
+        bool success = project->get_scene()->on_render_begin(project.ref());
+        ASSERT_TRUE(success);
+
+        OnFrameBeginRecorder recorder;
+        success = project->get_scene()->on_frame_begin(project.ref(), 0, recorder);
+        ASSERT_TRUE(success);
+
+        const Camera* active_camera = project->get_scene()->get_active_camera();
+
+        SamplingContext::RNGType rng;
+        SamplingContext sampling_context(rng, SamplingContext::QMCMode);
+        SamplingContext sampling_contexts[2] = { sampling_context, sampling_context };
+
+        const Dual2d ndcs[2] =
+        {
+            Dual2d(Vector2d(0.2, 0.7), Vector2d(0.01, 0.0), Vector2d(0.0, -0.01)),
+            Dual2d(Vector2d(0.9, 0.1), Vector2d(0.01, 0.0), Vector2d(0.0, -0.01))
+        };
+
+        ShadingRay rays[2];
+        active_camera->spawn_rays(2, sampling_contexts, ndcs, rays);
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            ShadingRay expected;
+            active_camera->spawn_ray(sampling_context, ndcs[i], expected);
+
+            EXPECT_FEQ(expected.m_org, rays[i].m_org);
+            EXPECT_FEQ(expected.m_dir, rays[i].m_dir);
+            EXPECT_FEQ(expected.m_rx.m_dir, rays[i].m_rx.m_dir);
+            EXPECT_FEQ(expected.m_ry.m_dir, rays[i].m_ry.m_dir);
+        }
+
+        recorder.on_frame_end(project.ref());
+        project->get_scene()->on_render_end(project.ref());
+    }
 }
@@ -0,0 +1,116 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/pixelstatistics.h"
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Rendering_PixelStatistics)
+{
+    const size_t Width = 4;
+    const size_t Height = 2;
+
+    Sample make_sample(const size_t x, const size_t y, const float value)
+    {
+        Sample sample;
+        sample.m_position = Vector2f((x + 0.5f) / Width, (y + 0.5f) / Height);
+        sample.m_values[0] = value;
+        sample.m_values[1] = value;
+        sample.m_values[2] = value;
+        sample.m_values[3] = 1.0f;
+        sample.m_values[4] = 0.0f;
+        return sample;
+    }
+
+    TEST_CASE(Constructor_PixelsHaveNoSamples)
+    {
+        const PixelStatistics stats(Width, Height);
+
+        EXPECT_EQ(0, stats.get(3, 1).m_sample_count);
+        EXPECT_EQ(0.0f, stats.get(3, 1).get_mean());
+        EXPECT_EQ(0.0f, stats.get(3, 1).get_variance());
+    }
+
+    TEST_CASE(StoreSamples_AccumulatesStatisticsOfPixel)
+    {
+        PixelStatistics stats(Width, Height);
+
+        const Sample samples[] =
+        {
+            make_sample(2, 1, 1.0f),
+            make_sample(2, 1, 3.0f),
+            make_sample(0, 0, 5.0f)
+        };
+        stats.store_samples(3, samples);
+
+        const PixelStatistics::Entry& entry = stats.get(2, 1);
+        EXPECT_EQ(2, entry.m_sample_count);
+        EXPECT_FEQ(2.0f, entry.get_mean());
+        EXPECT_FEQ(2.0f, entry.get_variance());
+        EXPECT_FEQ(3.0f, entry.m_max);
+        EXPECT_EQ(1, stats.get(0, 0).m_sample_count);
+    }
+
+    TEST_CASE(StoreSamples_SamplesOutsideFrame_AreIgnored)
+    {
+        PixelStatistics stats(Width, Height);
+
+        Sample sample = make_sample(0, 0, 1.0f);
+        sample.m_position = Vector2f(1.5f, 0.5f);
+        stats.store_samples(1, &sample);
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+                EXPECT_EQ(0, stats.get(x, y).m_sample_count);
+        }
+    }
+
+    TEST_CASE(Clear_ForgetsSamples)
+    {
+        PixelStatistics stats(Width, Height);
+        const Sample sample = make_sample(1, 1, 1.0f);
+        stats.store_samples(1, &sample);
+
+        stats.clear();
+
+        EXPECT_EQ(0, stats.get(1, 1).m_sample_count);
+        EXPECT_EQ(0.0f, stats.get(1, 1).m_max);
+    }
+}
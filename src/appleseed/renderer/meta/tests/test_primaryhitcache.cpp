@@ -0,0 +1,283 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/rendering/primaryhitcache.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/light/light.h"
+#include "renderer/modeling/light/pointlight.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_PrimaryHitCache)
+{
+    // A unit plane facing +X, seen from +X.
+    struct Fixture
+    {
+        auto_release_ptr<Project>   m_project;
+        Assembly*                   m_assembly;
+        AssemblyInstance*           m_assembly_instance;
+        auto_ptr<TextureStore>      m_texture_store;
+        auto_ptr<TextureCache>      m_texture_cache;
+        auto_ptr<Intersector>       m_intersector;
+
+        Fixture()
+          : m_project(ProjectFactory::create("project"))
+        {
+            m_project->set_scene(SceneFactory::create());
+            Scene& scene = *m_project->get_scene();
+
+            auto_release_ptr<MeshObject> mesh_object =
+                MeshObjectFactory::create("plane", ParamArray());
+
+            mesh_object->push_vertex(GVector3(0.0f, -0.5f, -0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, +0.5f, -0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, +0.5f, +0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, -0.5f, +0.5f));
+
+            mesh_object->push_vertex_normal(GVector3(1.0f, 0.0f, 0.0f));
+
+            mesh_object->push_triangle(Triangle(0, 1, 2, 0, 0, 0, 0));
+            mesh_object->push_triangle(Triangle(2, 3, 0, 0, 0, 0, 0));
+
+            auto_release_ptr<Assembly> assembly(AssemblyFactory().create("assembly", ParamArray()));
+            assembly->objects().insert(auto_release_ptr<Object>(mesh_object.release()));
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "plane_instance",
+                    ParamArray(),
+                    "plane",
+                    Transformd::identity(),
+                    StringDictionary()));
+            m_assembly = assembly.get();
+            scene.assemblies().insert(assembly);
+
+            scene.assembly_instances().insert(
+                AssemblyInstanceFactory::create("assembly_instance", ParamArray(), "assembly"));
+            m_assembly_instance = scene.assembly_instances().get_by_name("assembly_instance");
+
+            update_trace_context();
+        }
+
+        void update_trace_context()
+        {
+            m_project->update_trace_context();
+
+            m_intersector.reset();
+            m_texture_cache.reset();
+            m_texture_store.reset(new TextureStore(*m_project->get_scene()));
+            m_texture_cache.reset(new TextureCache(*m_texture_store));
+            m_intersector.reset(new Intersector(m_project->get_trace_context(), *m_texture_cache));
+        }
+
+        void move_plane(const double x)
+        {
+            m_assembly_instance->transform_sequence().clear();
+            m_assembly_instance->transform_sequence().set_transform(
+                0.0f,
+                Transformd::from_local_to_parent(Matrix4d::make_translation(Vector3d(x, 0.0, 0.0))));
+
+            update_trace_context();
+        }
+
+        static ShadingRay make_ray(const double y)
+        {
+            return
+                ShadingRay(
+                    Vector3d(1.0, y, 0.2),
+                    Vector3d(-1.0, 0.0, 0.0),
+                    0.0,                                // tmin
+                    10.0,                               // tmax
+                    ShadingRay::Time(),
+                    VisibilityFlags::CameraRay,
+                    0);                                 // depth
+        }
+
+        // Trace a ray and store its hit in the cache.
+        void trace_and_store(PrimaryHitCache& cache, const size_t sample_index, const ShadingRay& ray) const
+        {
+            ShadingPoint shading_point;
+            m_intersector->trace(ray, shading_point);
+            cache.store(sample_index, shading_point);
+        }
+
+        bool restore(const PrimaryHitCache& cache, const size_t sample_index, const ShadingRay& ray) const
+        {
+            ShadingPoint shading_point;
+            return cache.restore(sample_index, ray, *m_intersector, shading_point);
+        }
+    };
+
+    const size_t CacheSize = 1024 * 1024;
+
+    TEST_CASE(Constructor_GivenZeroSize_HasNoCapacity)
+    {
+        const PrimaryHitCache cache(0);
+
+        EXPECT_EQ(0, cache.get_capacity());
+    }
+
+    TEST_CASE_F(Restore_GivenStoredHit_RestoresSameHit, Fixture)
+    {
+        PrimaryHitCache cache(CacheSize);
+        cache.update(m_project.ref());
+
+        const ShadingRay ray = make_ray(0.1);
+
+        ShadingPoint traced_point;
+        ASSERT_TRUE(m_intersector->trace(ray, traced_point));
+        cache.store(3, traced_point);
+
+        ShadingPoint restored_point;
+        ASSERT_TRUE(cache.restore(3, ray, *m_intersector, restored_point));
+
+        ASSERT_TRUE(restored_point.hit());
+        EXPECT_EQ(traced_point.get_distance(), restored_point.get_distance());
+        EXPECT_EQ(traced_point.get_bary(), restored_point.get_bary());
+        EXPECT_EQ(traced_point.get_primitive_index(), restored_point.get_primitive_index());
+        EXPECT_EQ(&traced_point.get_object_instance(), &restored_point.get_object_instance());
+        EXPECT_FEQ(traced_point.get_point(), restored_point.get_point());
+    }
+
+    TEST_CASE_F(Restore_GivenOtherSampleIndex_ReturnsFalse, Fixture)
+    {
+        PrimaryHitCache cache(CacheSize);
+        cache.update(m_project.ref());
+
+        const ShadingRay ray = make_ray(0.1);
+        trace_and_store(cache, 3, ray);
+
+        EXPECT_FALSE(restore(cache, 4, ray));
+    }
+
+    TEST_CASE_F(Restore_GivenOtherRay_ReturnsFalse, Fixture)
+    {
+        PrimaryHitCache cache(CacheSize);
+        cache.update(m_project.ref());
+
+        trace_and_store(cache, 3, make_ray(0.1));
+
+        EXPECT_FALSE(restore(cache, 3, make_ray(0.2)));
+    }
+
+    TEST_CASE_F(Restore_GivenStoredMiss_ReturnsFalse, Fixture)
+    {
+        PrimaryHitCache cache(CacheSize);
+        cache.update(m_project.ref());
+
+        const ShadingRay ray = make_ray(10.0);
+        trace_and_store(cache, 3, ray);
+
+        EXPECT_FALSE(restore(cache, 3, ray));
+    }
+
+    TEST_CASE_F(Restore_GivenSampleIndexBeyondCapacity_ReturnsFalse, Fixture)
+    {
+        PrimaryHitCache cache(CacheSize);
+        cache.update(m_project.ref());
+
+        const ShadingRay ray = make_ray(0.1);
+        trace_and_store(cache, cache.get_capacity(), ray);
+
+        EXPECT_FALSE(restore(cache, cache.get_capacity(), ray));
+    }
+
+    TEST_CASE_F(Update_GivenUnchangedScene_KeepsHits, Fixture)
+    {
+        PrimaryHitCache cache(CacheSize);
+        cache.update(m_project.ref());
+
+        const ShadingRay ray = make_ray(0.1);
+        trace_and_store(cache, 3, ray);
+
+        cache.update(m_project.ref());
+
+        EXPECT_TRUE(restore(cache, 3, ray));
+    }
+
+    TEST_CASE_F(Update_AfterLightAdded_KeepsHits, Fixture)
+    {
+        PrimaryHitCache cache(CacheSize);
+        cache.update(m_project.ref());
+
+        const ShadingRay ray = make_ray(0.1);
+        trace_and_store(cache, 3, ray);
+
+        m_assembly->lights().insert(
+            PointLightFactory().create("light", ParamArray().insert("intensity", "1.0")));
+        cache.update(m_project.ref());
+
+        EXPECT_TRUE(restore(cache, 3, ray));
+    }
+
+    TEST_CASE_F(Update_AfterGeometryMoved_ForgetsHits, Fixture)
+    {
+        PrimaryHitCache cache(CacheSize);
+        cache.update(m_project.ref());
+
+        const ShadingRay ray = make_ray(0.1);
+        trace_and_store(cache, 3, ray);
+
+        move_plane(-0.5);
+        cache.update(m_project.ref());
+
+        EXPECT_FALSE(restore(cache, 3, ray));
+    }
+}
@@ -67,4 +67,84 @@ TEST_SUITE(Renderer_Modeling_Project_ProjectFileReader)
 
         EXPECT_TRUE(identical);
     }
+
+    TEST_CASE(ParsingOfProjectSnapshot)
+    {
+        ProjectFileReader reader;
+        auto_release_ptr<Project> project =
+            reader.read(
+                "unit tests/inputs/test_projectfilereader_configurationblocks.appleseed",
+                "../../../schemas/project.xsd");    // path relative to input file
+
+        ASSERT_NEQ(0, project.get());
+
+        const bool snapshot_success =
+            ProjectFileWriter::write_snapshot(
+                project.ref(),
+                "unit tests/outputs/test_projectfilereader_configurationblocks.appleseedsnapshot");
+
+        ASSERT_TRUE(snapshot_success);
+
+        auto_release_ptr<Project> snapshot_project =
+            reader.read(
+                "unit tests/outputs/test_projectfilereader_configurationblocks.appleseedsnapshot",
+                "../../../schemas/project.xsd");    // ignored for project snapshots
+
+        ASSERT_NEQ(0, snapshot_project.get());
+
+        const bool success =
+            ProjectFileWriter::write(
+                snapshot_project.ref(),
+                "unit tests/outputs/test_projectfilereader_projectsnapshot.appleseed",
+                ProjectFileWriter::OmitHeaderComment);
+
+        ASSERT_TRUE(success);
+
+        const bool identical =
+            compare_text_files(
+                "unit tests/inputs/test_projectfilereader_configurationblocks.appleseed",
+                "unit tests/outputs/test_projectfilereader_projectsnapshot.appleseed");
+
+        EXPECT_TRUE(identical);
+    }
+
+    TEST_CASE(ParsingOfProjectBundle)
+    {
+        ProjectFileReader reader;
+        auto_release_ptr<Project> project =
+            reader.read(
+                "unit tests/inputs/test_projectfilereader_configurationblocks.appleseed",
+                "../../../schemas/project.xsd");    // path relative to input file
+
+        ASSERT_NEQ(0, project.get());
+
+        const bool bundle_success =
+            ProjectFileWriter::write_bundle(
+                project.ref(),
+                "unit tests/outputs/test_projectfilereader_configurationblocks.appleseedz");
+
+        ASSERT_TRUE(bundle_success);
+
+        auto_release_ptr<Project> bundle_project =
+            reader.read(
+                "unit tests/outputs/test_projectfilereader_configurationblocks.appleseedz",
+                "../../../schemas/project.xsd");    // ignored for project bundles
+
+        ASSERT_NEQ(0, bundle_project.get());
+
+        const bool success =
+            ProjectFileWriter::write(
+                bundle_project.ref(),
+                "unit tests/outputs/test_projectfilereader_projectbundle.appleseed",
+                ProjectFileWriter::OmitHeaderComment);
+
+        ASSERT_TRUE(success);
+
+        const bool identical =
+            compare_text_files(
+                "unit tests/inputs/test_projectfilereader_configurationblocks.appleseed",
+                "unit tests/outputs/test_projectfilereader_projectbundle.appleseed");
+
+        EXPECT_TRUE(identical);
+    }
 }
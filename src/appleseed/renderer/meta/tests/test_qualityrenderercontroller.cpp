@@ -0,0 +1,139 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/pixelstatistics.h"
+#include "renderer/kernel/rendering/qualityrenderercontroller.h"
+#include "renderer/kernel/rendering/sample.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_QualityRendererController)
+{
+    const size_t Size = 32;
+
+    struct Fixture
+    {
+        auto_release_ptr<Frame> m_frame;
+
+        Fixture()
+          : m_frame(
+                FrameFactory::create(
+                    "frame",
+                    ParamArray()
+                        .insert("resolution", "32 32")
+                        .insert("tile_size", "16 16")
+                        .insert("pixel_format", "float")
+                        .insert("color_space", "linear_rgb")))
+        {
+        }
+
+        // Store four samples into every pixel. Pixels of the first tile get noisy samples
+        // alternating between 0 and 2 if requested, other pixels get constant samples.
+        void store_samples(const bool noisy_first_tile)
+        {
+            vector<Sample> samples;
+
+            for (size_t y = 0; y < Size; ++y)
+            {
+                for (size_t x = 0; x < Size; ++x)
+                {
+                    const bool noisy = noisy_first_tile && x < 16 && y < 16;
+
+                    for (size_t i = 0; i < 4; ++i)
+                    {
+                        const float value = noisy ? static_cast<float>(2 * (i & 1)) : 1.0f;
+
+                        Sample sample;
+                        sample.m_position = Vector2f((x + 0.5f) / Size, (y + 0.5f) / Size);
+                        sample.m_values[0] = value;
+                        sample.m_values[1] = value;
+                        sample.m_values[2] = value;
+                        sample.m_values[3] = 1.0f;
+                        sample.m_values[4] = 0.0f;
+                        samples.push_back(sample);
+                    }
+                }
+            }
+
+            m_frame->get_pixel_statistics()->store_samples(samples.size(), &samples[0]);
+        }
+    };
+
+    TEST_CASE_F(GetStatus_GivenPixelsWithoutSamples_ContinuesRendering, Fixture)
+    {
+        QualityRendererController controller(m_frame.ref(), 0.1f, QualityRendererController::WholeFrame, 0.0, 0.0);
+        controller.on_frame_begin();
+
+        EXPECT_EQ(IRendererController::ContinueRendering, controller.get_status());
+        EXPECT_TRUE(controller.get_noise() < 0.0f);
+    }
+
+    TEST_CASE_F(GetStatus_GivenConvergedFrame_TerminatesRendering, Fixture)
+    {
+        QualityRendererController controller(m_frame.ref(), 0.1f, QualityRendererController::WholeFrame, 0.0, 0.0);
+        controller.on_frame_begin();
+        store_samples(false);
+
+        EXPECT_EQ(IRendererController::TerminateRendering, controller.get_status());
+        EXPECT_EQ(0.0f, controller.get_noise());
+    }
+
+    TEST_CASE_F(GetStatus_GivenNoisyTileAndWholeFrameScope_TerminatesRendering, Fixture)
+    {
+        QualityRendererController controller(m_frame.ref(), 0.3f, QualityRendererController::WholeFrame, 0.0, 0.0);
+        controller.on_frame_begin();
+        store_samples(true);
+
+        EXPECT_EQ(IRendererController::TerminateRendering, controller.get_status());
+    }
+
+    TEST_CASE_F(GetStatus_GivenNoisyTileAndEveryTileScope_ContinuesRendering, Fixture)
+    {
+        QualityRendererController controller(m_frame.ref(), 0.3f, QualityRendererController::EveryTile, 0.0, 0.0);
+        controller.on_frame_begin();
+        store_samples(true);
+
+        EXPECT_EQ(IRendererController::ContinueRendering, controller.get_status());
+        EXPECT_FEQ(0.57735f, controller.get_noise());
+    }
+}
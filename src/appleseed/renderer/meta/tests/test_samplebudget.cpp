@@ -0,0 +1,102 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/final/samplebudget.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Rendering_Final_SampleBudget)
+{
+    TEST_CASE(BeginPass_GivenSamePassHash_ReturnsSamePassIndex)
+    {
+        SampleBudget budget(1, 2, 100, 256);
+
+        EXPECT_EQ(0, budget.begin_pass(42));
+        EXPECT_EQ(0, budget.begin_pass(42));
+        EXPECT_EQ(1, budget.begin_pass(7));
+        EXPECT_EQ(1, budget.begin_pass(7));
+    }
+
+    TEST_CASE(GetPixelSamples_DistributesRemainingSamplesInProportionToVariation)
+    {
+        SampleBudget budget(2, 2, 102, 256);
+
+        budget.begin_pass(1);
+        budget.record_pixel(0, 1, 3.0f);
+        budget.record_pixel(1, 1, 1.0f);
+        budget.begin_pass(2);
+
+        EXPECT_FEQ(75.0f, budget.get_pixel_samples(0));
+        EXPECT_FEQ(25.0f, budget.get_pixel_samples(1));
+    }
+
+    TEST_CASE(GetPixelSamples_GivenNoVariation_DistributesRemainingSamplesUniformly)
+    {
+        SampleBudget budget(2, 3, 104, 256);
+
+        budget.begin_pass(1);
+        budget.record_pixel(0, 1, 0.0f);
+        budget.record_pixel(0, 1, 0.0f);
+        budget.record_pixel(1, 1, 0.0f);
+        budget.record_pixel(1, 1, 0.0f);
+        budget.begin_pass(2);
+
+        EXPECT_FEQ(12.5f, budget.get_pixel_samples(0));
+        EXPECT_FEQ(12.5f, budget.get_pixel_samples(1));
+    }
+
+    TEST_CASE(GetPixelSamples_GivenTileReachingMaxSamples_RedistributesExcessToOtherTiles)
+    {
+        SampleBudget budget(2, 2, 102, 60);
+
+        budget.begin_pass(1);
+        budget.record_pixel(0, 1, 9.0f);
+        budget.record_pixel(1, 1, 1.0f);
+        budget.begin_pass(2);
+
+        EXPECT_FEQ(60.0f, budget.get_pixel_samples(0));
+        EXPECT_FEQ(40.0f, budget.get_pixel_samples(1));
+    }
+
+    TEST_CASE(GetPixelSamples_GivenExhaustedBudget_ReturnsZero)
+    {
+        SampleBudget budget(1, 2, 10, 256);
+
+        budget.begin_pass(1);
+        budget.record_pixel(0, 16, 1.0f);
+        budget.begin_pass(2);
+
+        EXPECT_EQ(0.0f, budget.get_pixel_samples(0));
+    }
+}
@@ -0,0 +1,254 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/progressive/samplecheckpoint.h"
+#include "renderer/kernel/rendering/globalsampleaccumulationbuffer.h"
+#include "renderer/kernel/rendering/isamplegenerator.h"
+#include "renderer/kernel/rendering/localsampleaccumulationbuffer.h"
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/filter.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_Progressive_SampleCheckpoint)
+{
+    const char* CheckpointPath = "unit tests/outputs/test_samplecheckpoint.checkpoint";
+
+    class FakeSampleGenerator
+      : public ISampleGenerator
+    {
+      public:
+        explicit FakeSampleGenerator(const size_t sequence_end)
+          : m_sequence_end(sequence_end)
+        {
+        }
+
+        virtual void release() APPLESEED_OVERRIDE
+        {
+            delete this;
+        }
+
+        virtual void set_sequence_partition(
+            const size_t                partition_index,
+            const size_t                partition_count) APPLESEED_OVERRIDE
+        {
+        }
+
+        virtual void reset() APPLESEED_OVERRIDE
+        {
+            m_sequence_end = 0;
+        }
+
+        virtual void skip_sequence(const size_t sequence_begin) APPLESEED_OVERRIDE
+        {
+            m_sequence_end = sequence_begin;
+        }
+
+        virtual size_t get_sequence_end() const APPLESEED_OVERRIDE
+        {
+            return m_sequence_end;
+        }
+
+        virtual void generate_samples(
+            const size_t                sample_count,
+            SampleAccumulationBuffer&   buffer,
+            IAbortSwitch&               abort_switch) APPLESEED_OVERRIDE
+        {
+        }
+
+        virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
+        {
+            return StatisticsVector();
+        }
+
+      private:
+        size_t m_sequence_end;
+    };
+
+    void store_random_samples(SampleAccumulationBuffer& buffer, const size_t count)
+    {
+        MersenneTwister rng;
+        vector<Sample> samples(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            samples[i].m_position.x = rand_float2(rng);
+            samples[i].m_position.y = rand_float2(rng);
+
+            for (size_t c = 0; c < 5; ++c)
+                samples[i].m_values[c] = rand_float1(rng);
+        }
+
+        AbortSwitch abort_switch;
+        buffer.store_samples(count, &samples[0], abort_switch);
+    }
+
+    string save_to_string(SampleAccumulationBuffer& buffer)
+    {
+        stringstream stream;
+        buffer.save_samples(stream);
+        return stream.str();
+    }
+
+    struct Fixture
+    {
+        const BoxFilter2<float>                     m_filter;
+        SampleCheckpoint                            m_checkpoint;
+        SampleCheckpoint::SampleGeneratorVector     m_generators;
+
+        Fixture()
+          : m_filter(1.5f, 1.5f)
+          , m_checkpoint(CheckpointPath)
+        {
+            m_generators.push_back(new FakeSampleGenerator(1000));
+            m_generators.push_back(new FakeSampleGenerator(1067));
+        }
+
+        ~Fixture()
+        {
+            for (size_t i = 0; i < m_generators.size(); ++i)
+                m_generators[i]->release();
+
+            m_checkpoint.remove();
+        }
+    };
+
+    TEST_CASE_F(Restore_GivenGlobalBuffer_RestoresSamplesAndSequencePosition, Fixture)
+    {
+        GlobalSampleAccumulationBuffer buffer(32, 32, m_filter);
+        store_random_samples(buffer, 1000);
+        ASSERT_TRUE(m_checkpoint.save(buffer, m_generators));
+
+        GlobalSampleAccumulationBuffer restored_buffer(32, 32, m_filter);
+        size_t sequence_begin = 0;
+        const bool success = m_checkpoint.restore(restored_buffer, sequence_begin);
+
+        ASSERT_TRUE(success);
+        EXPECT_EQ(1067, sequence_begin);
+        EXPECT_EQ(buffer.get_sample_count(), restored_buffer.get_sample_count());
+        EXPECT_TRUE(save_to_string(buffer) == save_to_string(restored_buffer));
+    }
+
+    TEST_CASE_F(Restore_GivenLocalBuffer_RestoresSamples, Fixture)
+    {
+        LocalSampleAccumulationBuffer buffer(64, 64, m_filter);
+        store_random_samples(buffer, 1000);
+        ASSERT_TRUE(m_checkpoint.save(buffer, m_generators));
+
+        LocalSampleAccumulationBuffer restored_buffer(64, 64, m_filter);
+        size_t sequence_begin = 0;
+        const bool success = m_checkpoint.restore(restored_buffer, sequence_begin);
+
+        ASSERT_TRUE(success);
+        EXPECT_EQ(1000, restored_buffer.get_sample_count());
+        EXPECT_TRUE(save_to_string(buffer) == save_to_string(restored_buffer));
+    }
+
+    TEST_CASE_F(Restore_GivenBufferOfDifferentResolution_ReturnsFalseAndLeavesBufferEmpty, Fixture)
+    {
+        GlobalSampleAccumulationBuffer buffer(32, 32, m_filter);
+        store_random_samples(buffer, 1000);
+        ASSERT_TRUE(m_checkpoint.save(buffer, m_generators));
+
+        GlobalSampleAccumulationBuffer restored_buffer(16, 32, m_filter);
+        size_t sequence_begin = 0;
+        const bool success = m_checkpoint.restore(restored_buffer, sequence_begin);
+
+        EXPECT_FALSE(success);
+        EXPECT_EQ(0, restored_buffer.get_sample_count());
+    }
+
+    TEST_CASE_F(Restore_GivenMissingFile_ReturnsFalse, Fixture)
+    {
+        GlobalSampleAccumulationBuffer buffer(32, 32, m_filter);
+        size_t sequence_begin = 0;
+        const bool success = m_checkpoint.restore(buffer, sequence_begin);
+
+        EXPECT_FALSE(success);
+    }
+
+    TEST_CASE_F(Merge_GivenGlobalBuffer_AddsSamples, Fixture)
+    {
+        GlobalSampleAccumulationBuffer buffer(32, 32, m_filter);
+        store_random_samples(buffer, 1000);
+        ASSERT_TRUE(m_checkpoint.save(buffer, m_generators));
+
+        GlobalSampleAccumulationBuffer merged_buffer(32, 32, m_filter);
+        const bool success1 = m_checkpoint.merge(merged_buffer);
+        const bool success2 = m_checkpoint.merge(merged_buffer);
+
+        ASSERT_TRUE(success1);
+        ASSERT_TRUE(success2);
+        EXPECT_EQ(2 * buffer.get_sample_count(), merged_buffer.get_sample_count());
+    }
+
+    TEST_CASE_F(Merge_GivenLocalBuffer_AddsSamples, Fixture)
+    {
+        LocalSampleAccumulationBuffer buffer(64, 64, m_filter);
+        store_random_samples(buffer, 1000);
+        ASSERT_TRUE(m_checkpoint.save(buffer, m_generators));
+
+        LocalSampleAccumulationBuffer merged_buffer(64, 64, m_filter);
+        const bool success1 = m_checkpoint.merge(merged_buffer);
+        const bool success2 = m_checkpoint.merge(merged_buffer);
+
+        ASSERT_TRUE(success1);
+        ASSERT_TRUE(success2);
+        EXPECT_EQ(2000, merged_buffer.get_sample_count());
+    }
+
+    TEST_CASE_F(Merge_GivenBufferOfDifferentResolution_ReturnsFalseAndLeavesBufferUnchanged, Fixture)
+    {
+        GlobalSampleAccumulationBuffer buffer(32, 32, m_filter);
+        store_random_samples(buffer, 1000);
+        ASSERT_TRUE(m_checkpoint.save(buffer, m_generators));
+
+        GlobalSampleAccumulationBuffer merged_buffer(16, 32, m_filter);
+        store_random_samples(merged_buffer, 100);
+        const bool success = m_checkpoint.merge(merged_buffer);
+
+        EXPECT_FALSE(success);
+        EXPECT_EQ(100, merged_buffer.get_sample_count());
+    }
+}
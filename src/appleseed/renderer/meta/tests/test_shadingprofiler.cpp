@@ -0,0 +1,138 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/utility/shadingprofiler.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Utility_ShadingProfiler)
+{
+    const char* MaterialName = "material";
+    const char* ShaderGroupName = "shader_group";
+    const char* BSDFModel = "lambertian_brdf";
+
+    TEST_CASE(BeginScope_GivenSamplingPeriodOfTwo_TimesEveryOtherOutermostScope)
+    {
+        ShadingProfile profile;
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            profile.begin_scope(2, ShadingProfile::Materials, MaterialName);
+            profile.end_scope();
+        }
+
+        EXPECT_EQ(2, profile.get_sample_count());
+    }
+
+    TEST_CASE(BeginScope_GivenNestedScopes_ChargesEachScopeInItsCategory)
+    {
+        ShadingProfile profile;
+
+        profile.begin_scope(1, ShadingProfile::Materials, MaterialName);
+        profile.begin_scope(1, ShadingProfile::ShaderGroups, ShaderGroupName);
+        profile.end_scope();
+        profile.begin_scope(1, ShadingProfile::BSDFModels, BSDFModel);
+        profile.end_scope();
+        profile.end_scope();
+
+        EXPECT_EQ(1, profile.get_sample_count());
+        ASSERT_EQ(1, profile.get_entry_count(ShadingProfile::Materials));
+        EXPECT_EQ(MaterialName, profile.get_name(ShadingProfile::Materials, 0));
+        ASSERT_EQ(1, profile.get_entry_count(ShadingProfile::ShaderGroups));
+        EXPECT_EQ(ShaderGroupName, profile.get_name(ShadingProfile::ShaderGroups, 0));
+        ASSERT_EQ(1, profile.get_entry_count(ShadingProfile::BSDFModels));
+        EXPECT_EQ(BSDFModel, profile.get_name(ShadingProfile::BSDFModels, 0));
+    }
+
+    TEST_CASE(BeginScope_GivenScopeNestedInSkippedScope_DoesNotTimeIt)
+    {
+        ShadingProfile profile;
+
+        profile.begin_scope(2, ShadingProfile::Materials, MaterialName);
+        profile.begin_scope(2, ShadingProfile::BSDFModels, BSDFModel);
+        profile.end_scope();
+        profile.end_scope();
+
+        EXPECT_EQ(0, profile.get_sample_count());
+        EXPECT_EQ(0, profile.get_entry_count(ShadingProfile::Materials));
+        EXPECT_EQ(0, profile.get_entry_count(ShadingProfile::BSDFModels));
+    }
+
+    TEST_CASE(BeginScope_GivenScopesDeeperThanMaxDepth_ChargesThemToDeepestTimedScope)
+    {
+        static char names[ShadingProfile::MaxDepth + 1];
+
+        ShadingProfile profile;
+
+        for (size_t i = 0; i < ShadingProfile::MaxDepth + 1; ++i)
+            profile.begin_scope(1, ShadingProfile::ShaderGroups, &names[i]);
+
+        for (size_t i = 0; i < ShadingProfile::MaxDepth + 1; ++i)
+            profile.end_scope();
+
+        EXPECT_EQ(ShadingProfile::MaxDepth, profile.get_entry_count(ShadingProfile::ShaderGroups));
+    }
+
+    TEST_CASE(Merge_GivenCommonAndDistinctNames_SumsTimesAndSampleCounts)
+    {
+        ShadingProfile a;
+        a.begin_scope(1, ShadingProfile::Materials, MaterialName);
+        a.end_scope();
+
+        ShadingProfile b;
+        b.begin_scope(1, ShadingProfile::ShaderGroups, ShaderGroupName);
+        b.end_scope();
+        b.begin_scope(1, ShadingProfile::Materials, MaterialName);
+        b.end_scope();
+
+        a.merge(b);
+
+        EXPECT_EQ(3, a.get_sample_count());
+        EXPECT_EQ(1, a.get_entry_count(ShadingProfile::Materials));
+        EXPECT_EQ(1, a.get_entry_count(ShadingProfile::ShaderGroups));
+    }
+
+    TEST_CASE(Clear_ForgetsRecordedTimes)
+    {
+        ShadingProfile profile;
+        profile.begin_scope(1, ShadingProfile::Materials, MaterialName);
+        profile.end_scope();
+
+        profile.clear();
+
+        EXPECT_EQ(0, profile.get_sample_count());
+        EXPECT_EQ(0, profile.get_entry_count(ShadingProfile::Materials));
+    }
+}
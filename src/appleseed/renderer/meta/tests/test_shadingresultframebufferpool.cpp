@@ -0,0 +1,119 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/shadingresultframebuffer.h"
+#include "renderer/kernel/rendering/shadingresultframebufferpool.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/filter.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Rendering_ShadingResultFrameBufferPool)
+{
+    struct Fixture
+    {
+        const BoxFilter2<float>     m_filter;
+        const AABB2u                m_crop_window;
+
+        Fixture()
+          : m_filter(0.5f, 0.5f)
+          , m_crop_window(Vector2u(0, 0), Vector2u(15, 15))
+        {
+        }
+    };
+
+    TEST_CASE_F(Acquire_GivenEmptyPool_ReturnsNewFrameBuffer, Fixture)
+    {
+        ShadingResultFrameBufferPool pool;
+
+        ShadingResultFrameBuffer* framebuffer = pool.acquire(16, 16, 2, m_crop_window, m_filter);
+
+        EXPECT_EQ(16, framebuffer->get_width());
+        EXPECT_EQ(16, framebuffer->get_height());
+        EXPECT_EQ(2, framebuffer->get_aov_count());
+
+        delete framebuffer;
+    }
+
+    TEST_CASE_F(Acquire_AfterReleasingMatchingFrameBuffer_ReturnsReleasedFrameBuffer, Fixture)
+    {
+        ShadingResultFrameBufferPool pool;
+
+        ShadingResultFrameBuffer* framebuffer = pool.acquire(16, 16, 2, m_crop_window, m_filter);
+        pool.release(framebuffer);
+
+        EXPECT_EQ(1, pool.size());
+        EXPECT_EQ(framebuffer, pool.acquire(16, 16, 2, m_crop_window, m_filter));
+        EXPECT_EQ(0, pool.size());
+
+        delete framebuffer;
+    }
+
+    TEST_CASE_F(Acquire_AfterReleasingFrameBufferWithDifferentAOVCount_ReturnsNewFrameBuffer, Fixture)
+    {
+        ShadingResultFrameBufferPool pool;
+
+        pool.release(pool.acquire(16, 16, 2, m_crop_window, m_filter));
+
+        ShadingResultFrameBuffer* framebuffer = pool.acquire(16, 16, 3, m_crop_window, m_filter);
+
+        EXPECT_EQ(3, framebuffer->get_aov_count());
+        EXPECT_EQ(1, pool.size());
+
+        delete framebuffer;
+    }
+
+    TEST_CASE_F(Release_GivenFullPool_DeletesFrameBuffer, Fixture)
+    {
+        ShadingResultFrameBufferPool pool(1);
+
+        ShadingResultFrameBuffer* framebuffer1 = pool.acquire(16, 16, 0, m_crop_window, m_filter);
+        ShadingResultFrameBuffer* framebuffer2 = pool.acquire(16, 16, 0, m_crop_window, m_filter);
+        pool.release(framebuffer1);
+        pool.release(framebuffer2);
+
+        EXPECT_EQ(1, pool.size());
+    }
+
+    TEST_CASE_F(Clear_DeletesPooledFrameBuffers, Fixture)
+    {
+        ShadingResultFrameBufferPool pool;
+
+        pool.release(pool.acquire(16, 16, 0, m_crop_window, m_filter));
+        pool.clear();
+
+        EXPECT_EQ(0, pool.size());
+    }
+}
@@ -0,0 +1,144 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/lighting/sppm/sppmphoton.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_SPPM_SPPMPhoton)
+{
+    Vector3f round_trip(const Vector3f& v)
+    {
+        SPPMPackedDirection packed;
+        packed.set(v);
+        return packed.get();
+    }
+
+    TEST_CASE(PackedDirection_GivenAxisAlignedDirections_RoundTripsThem)
+    {
+        EXPECT_FEQ_EPS(Vector3f(+1.0f, 0.0f, 0.0f), round_trip(Vector3f(+1.0f, 0.0f, 0.0f)), 1.0e-4f);
+        EXPECT_FEQ_EPS(Vector3f(-1.0f, 0.0f, 0.0f), round_trip(Vector3f(-1.0f, 0.0f, 0.0f)), 1.0e-4f);
+        EXPECT_FEQ_EPS(Vector3f(0.0f, +1.0f, 0.0f), round_trip(Vector3f(0.0f, +1.0f, 0.0f)), 1.0e-4f);
+        EXPECT_FEQ_EPS(Vector3f(0.0f, -1.0f, 0.0f), round_trip(Vector3f(0.0f, -1.0f, 0.0f)), 1.0e-4f);
+        EXPECT_FEQ_EPS(Vector3f(0.0f, 0.0f, +1.0f), round_trip(Vector3f(0.0f, 0.0f, +1.0f)), 1.0e-4f);
+        EXPECT_FEQ_EPS(Vector3f(0.0f, 0.0f, -1.0f), round_trip(Vector3f(0.0f, 0.0f, -1.0f)), 1.0e-4f);
+    }
+
+    TEST_CASE(PackedDirection_GivenRandomDirections_RoundTripsThem)
+    {
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const Vector3f v(
+                rand_float1(rng, -1.0f, 1.0f),
+                rand_float1(rng, -1.0f, 1.0f),
+                rand_float1(rng, -1.0f, 1.0f));
+
+            if (square_norm(v) > 1.0e-2f)
+                EXPECT_FEQ_EPS(normalize(v), round_trip(normalize(v)), 1.0e-4f);
+        }
+    }
+
+    TEST_CASE(PackedSpectrum_GivenRGBSpectrum_RoundTripsIt)
+    {
+        Spectrum s(Color3f(0.8f, 40.0f, 1.0e-3f), Spectrum::Illuminance);
+
+        SPPMPackedSpectrum packed;
+        packed.set(s);
+
+        Spectrum result;
+        packed.get(result);
+
+        ASSERT_EQ(3, result.size());
+        EXPECT_EQ(Spectrum::Illuminance, result.get_intent());
+
+        // Each component is within half a quantization step of the largest component.
+        const float eps = 40.0f / 256.0f;
+        EXPECT_FEQ_EPS(0.8f, result[0], eps);
+        EXPECT_FEQ_EPS(40.0f, result[1], eps);
+        EXPECT_FEQ_EPS(1.0e-3f, result[2], eps);
+    }
+
+#ifndef APPLESEED_USE_RGB_SPECTRUM
+
+    TEST_CASE(PackedSpectrum_GivenSpectralSpectrum_RoundTripsIt)
+    {
+        MersenneTwister rng;
+
+        float values[Spectrum::Samples];
+        for (size_t i = 0; i < Spectrum::Samples; ++i)
+            values[i] = rand_float1(rng, 0.0f, 3.0f);
+
+        const Spectrum s(values);
+
+        SPPMPackedSpectrum packed;
+        packed.set(s);
+
+        Spectrum result;
+        packed.get(result);
+
+        ASSERT_EQ(Spectrum::Samples, result.size());
+
+        for (size_t i = 0; i < Spectrum::Samples; ++i)
+            EXPECT_FEQ_EPS(values[i], result[i], 4.0f / 256.0f);
+    }
+
+#endif
+
+    TEST_CASE(PackedSpectrum_GivenBlackSpectrum_RoundTripsIt)
+    {
+        SPPMPackedSpectrum packed;
+        packed.set(Spectrum(0.0f));
+
+        Spectrum result;
+        packed.get(result);
+
+        EXPECT_EQ(0.0f, result[0]);
+        EXPECT_EQ(0.0f, result[1]);
+        EXPECT_EQ(0.0f, result[2]);
+    }
+
+    TEST_CASE(PolyPhoton_IsSubstantiallySmallerThanUncompressedPhoton)
+    {
+        EXPECT_LT(sizeof(SPPMPolyPhoton) * 3, 2 * sizeof(Vector3f) + sizeof(Spectrum));
+    }
+}
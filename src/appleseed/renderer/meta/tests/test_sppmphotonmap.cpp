@@ -0,0 +1,180 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sppm/sppmparameters.h"
+#include "renderer/kernel/lighting/sppm/sppmphoton.h"
+#include "renderer/kernel/lighting/sppm/sppmphotonmap.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/knn.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Lighting_SPPM_SPPMPhotonMap)
+{
+    struct Fixture
+    {
+        Logger              m_logger;
+        JobQueue            m_job_queue;
+        JobManager          m_job_manager;
+        SPPMPhotonVector    m_photons;
+
+        Fixture()
+          : m_job_manager(m_logger, m_job_queue, 4)
+        {
+            m_job_manager.start();
+
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < 10000; ++i)
+            {
+                const Vector3f position(
+                    rand_float1(rng, -1.0f, 1.0f),
+                    rand_float1(rng, -1.0f, 1.0f),
+                    rand_float1(rng, -1.0f, 1.0f));
+
+                SPPMPolyPhoton photon;
+                photon.m_incoming.set(Vector3f(0.0f, 1.0f, 0.0f));
+                photon.m_geometric_normal.set(Vector3f(0.0f, 1.0f, 0.0f));
+                photon.m_flux.set(Spectrum(1.0f));
+
+                m_photons.push_back(position, photon);
+            }
+        }
+
+        // Find the nearest photons by testing all of them.
+        void find_nearest_brute_force(
+            const Vector3f&     point,
+            const float         max_square_dist,
+            const size_t        max_photons,
+            vector<float>&      square_dists) const
+        {
+            square_dists.clear();
+
+            for (size_t i = 0; i < m_photons.size(); ++i)
+            {
+                const float square_dist = square_distance(m_photons.m_positions[i], point);
+                if (square_dist <= max_square_dist)
+                    square_dists.push_back(square_dist);
+            }
+
+            sort(square_dists.begin(), square_dists.end());
+
+            if (square_dists.size() > max_photons)
+                square_dists.resize(max_photons);
+        }
+
+        bool lookups_match_brute_force(
+            const float         lookup_radius,
+            const float         query_radius,
+            const size_t        max_photons)
+        {
+            SPPMPhotonVector photons;
+            photons.append(m_photons);
+            const SPPMPhotonMap hash_grid(photons, SPPMParameters::HashGrid, lookup_radius, m_job_queue);
+
+            knn::Answer<float> answer(max_photons);
+            vector<float> expected;
+
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                const Vector3f point(
+                    rand_float1(rng, -1.0f, 1.0f),
+                    rand_float1(rng, -1.0f, 1.0f),
+                    rand_float1(rng, -1.0f, 1.0f));
+
+                hash_grid.find_nearest(point, query_radius * query_radius, answer);
+                find_nearest_brute_force(point, query_radius * query_radius, max_photons, expected);
+
+                if (answer.size() != expected.size())
+                    return false;
+
+                answer.sort();
+
+                for (size_t j = 0; j < expected.size(); ++j)
+                {
+                    const knn::Answer<float>::Entry& entry = answer.get(j);
+
+                    if (entry.m_square_dist != expected[j])
+                        return false;
+
+                    // Entries must reference the photon they were computed from.
+                    const Vector3f& position = m_photons.m_positions[hash_grid.remap(entry.m_index)];
+                    if (square_distance(position, point) != entry.m_square_dist ||
+                        position != hash_grid.get_point(entry.m_index))
+                        return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    TEST_CASE_F(FindNearest_HashGrid_ReturnsNearestPhotons, Fixture)
+    {
+        EXPECT_TRUE(lookups_match_brute_force(0.1f, 0.1f, 100));
+    }
+
+    TEST_CASE_F(FindNearest_HashGridWithFewPhotonsPerEstimate_ReturnsNearestPhotons, Fixture)
+    {
+        EXPECT_TRUE(lookups_match_brute_force(0.1f, 0.1f, 5));
+    }
+
+    TEST_CASE_F(FindNearest_HashGridWithQueryRadiusLargerThanLookupRadius_ReturnsNearestPhotons, Fixture)
+    {
+        EXPECT_TRUE(lookups_match_brute_force(0.02f, 0.2f, 50));
+    }
+
+    TEST_CASE_F(FindNearest_HashGridWithQueryPointFarFromPhotons_ReturnsNoPhoton, Fixture)
+    {
+        SPPMPhotonVector photons;
+        photons.append(m_photons);
+        const SPPMPhotonMap hash_grid(photons, SPPMParameters::HashGrid, 0.1f, m_job_queue);
+
+        knn::Answer<float> answer(100);
+        hash_grid.find_nearest(Vector3f(10.0f), 0.01f, answer);
+
+        EXPECT_TRUE(answer.empty());
+    }
+}
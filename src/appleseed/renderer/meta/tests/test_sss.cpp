@@ -787,6 +787,23 @@ TEST_SUITE(Renderer_Modeling_BSSRDF_SSS)
         }
     }
 
+    TEST_CASE(NormalizedDiffusion_Sample_InvertsCDF)
+    {
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const float u = rand_float2(rng);
+            const float a = rand_float1(rng);
+            const float l = rand_float1(rng, 0.001f, 10.0f);
+
+            const float s = normalized_diffusion_s_mfp(a);
+            const float r = normalized_diffusion_sample(u, l, s);
+
+            EXPECT_LT(2.0e-4f, abs(normalized_diffusion_cdf(r, l, s) - u));
+        }
+    }
+
     TEST_CASE(NormalizedDiffusion_IntegrateProfile)
     {
         const float Rd = 0.5f;
@@ -0,0 +1,122 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/utility/startupprofiler.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <sstream>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Utility_StartupProfiler)
+{
+    TEST_CASE(WriteJson_GivenNestedPhases_WritesPhaseHierarchy)
+    {
+        StartupProfiler profiler;
+        profiler.begin_phase("loading");
+        profiler.begin_phase("parsing");
+        profiler.end_phase(1.0);
+        profiler.end_phase(2.0);
+
+        stringstream sstr;
+        profiler.write_json(sstr);
+
+        const string expected =
+            "{\n"
+            "  \"phases\":\n"
+            "    [\n"
+            "      { \"name\": \"loading\", \"seconds\": 2, \"phases\":\n"
+            "        [\n"
+            "          { \"name\": \"parsing\", \"seconds\": 1 }\n"
+            "        ] }\n"
+            "    ],\n"
+            "  \"entities\":\n"
+            "    []\n"
+            "}\n";
+
+        EXPECT_EQ(expected, sstr.str());
+    }
+
+    TEST_CASE(BeginPhase_GivenExistingTopLevelPhase_ReplacesIt)
+    {
+        StartupProfiler profiler;
+        profiler.begin_phase("setup");
+        profiler.begin_phase("child");
+        profiler.end_phase(1.0);
+        profiler.end_phase(1.0);
+        profiler.begin_phase("setup");
+        profiler.end_phase(3.0);
+
+        stringstream sstr;
+        profiler.write_json(sstr);
+
+        const string expected =
+            "{\n"
+            "  \"phases\":\n"
+            "    [\n"
+            "      { \"name\": \"setup\", \"seconds\": 3 }\n"
+            "    ],\n"
+            "  \"entities\":\n"
+            "    []\n"
+            "}\n";
+
+        EXPECT_EQ(expected, sstr.str());
+    }
+
+    TEST_CASE(RecordEntity_GivenManyEntities_KeepsMostExpensiveOnesInDecreasingOrder)
+    {
+        StartupProfiler profiler;
+
+        for (size_t i = 0; i < 20; ++i)
+        {
+            stringstream sstr;
+            sstr << "entity" << i;
+            profiler.record_entity("meshes", sstr.str(), static_cast<double>(i));
+        }
+
+        profiler.record_entity("meshes", "entity19", 1.0);
+
+        stringstream sstr;
+        profiler.write_json(sstr);
+        const string json = sstr.str();
+
+        EXPECT_NEQ(string::npos, json.find("\"count\": 21"));
+        EXPECT_NEQ(string::npos, json.find("{ \"name\": \"entity19\", \"seconds\": 19 },\n"));
+        EXPECT_NEQ(string::npos, json.find("{ \"name\": \"entity10\", \"seconds\": 10 }\n"));
+        EXPECT_EQ(string::npos, json.find("\"entity9\""));
+    }
+}
@@ -0,0 +1,210 @@
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/sample.h"
+#include "renderer/kernel/rendering/stripedfilteredtile.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/filteredtile.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/filter.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_StripedFilteredTile)
+{
+    void make_samples(vector<Sample>& samples, const size_t count)
+    {
+        MersenneTwister rng;
+
+        samples.resize(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            samples[i].m_position.x = rand_float2(rng);
+            samples[i].m_position.y = rand_float2(rng);
+
+            for (size_t c = 0; c < 5; ++c)
+                samples[i].m_values[c] = rand_float1(rng);
+        }
+    }
+
+    void add_samples(FilteredTile& tile, const vector<Sample>& samples)
+    {
+        const float w = static_cast<float>(tile.get_width());
+        const float h = static_cast<float>(tile.get_height());
+
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            const Sample& s = samples[i];
+            tile.add(s.m_position.x * w, s.m_position.y * h, s.m_values);
+        }
+    }
+
+    bool tiles_match(const FilteredTile& lhs, const FilteredTile& rhs)
+    {
+        const size_t component_count = lhs.get_pixel_count() * lhs.get_channel_count();
+        const float* lhs_ptr = lhs.pixel(0);
+        const float* rhs_ptr = rhs.pixel(0);
+
+        for (size_t i = 0; i < component_count; ++i)
+        {
+            if (!feq(lhs_ptr[i], rhs_ptr[i], 1.0e-3f))
+                return false;
+        }
+
+        return true;
+    }
+
+    struct Fixture
+    {
+        BlackmanHarrisFilter2<float>    m_filter;
+        FilteredTile                    m_tile;
+        FilteredTile                    m_ref_tile;
+        vector<Sample>                  m_samples;
+
+        Fixture()
+          : m_filter(1.5f, 1.5f)
+          , m_tile(61, 93, 5, m_filter)
+          , m_ref_tile(61, 93, 5, m_filter)
+        {
+            m_tile.clear();
+            m_ref_tile.clear();
+            make_samples(m_samples, 5000);
+        }
+    };
+
+    TEST_CASE(Constructor_StripesAreAtLeastAsTallAsFilterFootprint)
+    {
+        const BoxFilter2<float> filter(20.0f, 20.0f);
+        FilteredTile tile(32, 100, 1, filter);
+
+        StripedFilteredTile striped_tile(tile);
+
+        EXPECT_EQ(3, striped_tile.get_stripe_count());
+    }
+
+    TEST_CASE_F(StoreSamples_MatchesFilteredTileAdd, Fixture)
+    {
+        StripedFilteredTile striped_tile(m_tile);
+        AbortSwitch abort_switch;
+
+        const bool completed =
+            striped_tile.store_samples(m_samples.size(), &m_samples[0], abort_switch);
+        add_samples(m_ref_tile, m_samples);
+
+        EXPECT_TRUE(completed);
+        EXPECT_TRUE(tiles_match(m_ref_tile, m_tile));
+    }
+
+    TEST_CASE_F(StoreSamples_TileCoversWindowOfImage_MatchesFilteredTileAddInWindowSpace, Fixture)
+    {
+        const AABB2u window(Vector2u(17, 41), Vector2u(77, 133));
+        StripedFilteredTile striped_tile(m_tile, 200, 300, window);
+        AbortSwitch abort_switch;
+
+        const bool completed =
+            striped_tile.store_samples(m_samples.size(), &m_samples[0], abort_switch);
+
+        for (size_t i = 0; i < m_samples.size(); ++i)
+        {
+            const Sample& s = m_samples[i];
+            m_ref_tile.add(s.m_position.x * 200.0f - 17.0f, s.m_position.y * 300.0f - 41.0f, s.m_values);
+        }
+
+        EXPECT_TRUE(completed);
+        EXPECT_TRUE(tiles_match(m_ref_tile, m_tile));
+    }
+
+    TEST_CASE_F(StoreSamples_AbortSwitchIsSet_ReturnsFalse, Fixture)
+    {
+        StripedFilteredTile striped_tile(m_tile);
+        AbortSwitch abort_switch;
+        abort_switch.abort();
+
+        EXPECT_FALSE(striped_tile.store_samples(m_samples.size(), &m_samples[0], abort_switch));
+    }
+
+    class StoreSamplesJob
+      : public IJob
+    {
+      public:
+        StoreSamplesJob(
+            StripedFilteredTile&    striped_tile,
+            const vector<Sample>&   samples)
+          : m_striped_tile(striped_tile)
+          , m_samples(samples)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            AbortSwitch abort_switch;
+            m_striped_tile.store_samples(m_samples.size(), &m_samples[0], abort_switch);
+        }
+
+      private:
+        StripedFilteredTile&        m_striped_tile;
+        const vector<Sample>&       m_samples;
+    };
+
+    TEST_CASE_F(StoreSamples_FromMultipleThreads_MatchesFilteredTileAdd, Fixture)
+    {
+        const size_t JobCount = 16;
+
+        StripedFilteredTile striped_tile(m_tile);
+
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(logger, job_queue, 4);
+
+        for (size_t i = 0; i < JobCount; ++i)
+        {
+            job_queue.schedule(new StoreSamplesJob(striped_tile, m_samples));
+            add_samples(m_ref_tile, m_samples);
+        }
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        EXPECT_TRUE(tiles_match(m_ref_tile, m_tile));
+    }
+}
@@ -0,0 +1,187 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/iframerenderer.h"
+#include "renderer/kernel/rendering/itelemetrycallback.h"
+#include "renderer/kernel/rendering/telemetrymonitor.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_TelemetryMonitor)
+{
+    class FakeFrameRenderer
+      : public IFrameRenderer
+    {
+      public:
+        explicit FakeFrameRenderer(const double progress)
+          : m_progress(progress)
+        {
+        }
+
+        virtual void release() APPLESEED_OVERRIDE {}
+        virtual void render() APPLESEED_OVERRIDE {}
+        virtual bool is_rendering() const APPLESEED_OVERRIDE { return true; }
+        virtual void start_rendering() APPLESEED_OVERRIDE {}
+        virtual void stop_rendering() APPLESEED_OVERRIDE {}
+        virtual void pause_rendering() APPLESEED_OVERRIDE {}
+        virtual void resume_rendering() APPLESEED_OVERRIDE {}
+        virtual void terminate_rendering() APPLESEED_OVERRIDE {}
+        virtual void set_active_thread_count(const size_t thread_count) APPLESEED_OVERRIDE {}
+
+        virtual double get_progress() const APPLESEED_OVERRIDE
+        {
+            return m_progress;
+        }
+
+        double m_progress;
+    };
+
+    class TelemetryRecorder
+      : public ITelemetryCallback
+    {
+      public:
+        vector<RenderTelemetry> m_telemetry;
+
+        virtual void release() APPLESEED_OVERRIDE {}
+
+        virtual void on_telemetry(const RenderTelemetry& telemetry) APPLESEED_OVERRIDE
+        {
+            m_telemetry.push_back(telemetry);
+        }
+    };
+
+    TEST_CASE(Update_IntervalNotElapsed_DoesNotInvokeCallback)
+    {
+        FakeFrameRenderer frame_renderer(0.5);
+        TelemetryRecorder recorder;
+        TelemetryMonitor monitor(recorder, 3600.0, 0);
+
+        monitor.update(frame_renderer);
+
+        EXPECT_TRUE(recorder.m_telemetry.empty());
+    }
+
+    TEST_CASE(Update_Forced_InvokesCallback)
+    {
+        FakeFrameRenderer frame_renderer(0.5);
+        TelemetryRecorder recorder;
+        TelemetryMonitor monitor(recorder, 3600.0, 0);
+
+        monitor.update(frame_renderer, true);
+
+        ASSERT_EQ(1, recorder.m_telemetry.size());
+        EXPECT_EQ(0.5, recorder.m_telemetry[0].m_progress);
+        EXPECT_EQ(0, recorder.m_telemetry[0].m_sample_count);
+    }
+
+    TEST_CASE(Update_ZeroInterval_InvokesCallbackEveryTime)
+    {
+        FakeFrameRenderer frame_renderer(0.5);
+        TelemetryRecorder recorder;
+        TelemetryMonitor monitor(recorder, 0.0, 0);
+
+        monitor.update(frame_renderer);
+        monitor.update(frame_renderer);
+
+        EXPECT_EQ(2, recorder.m_telemetry.size());
+    }
+
+    TEST_CASE(Update_HalfwayThrough_EstimatesRemainingTimeAsElapsedTime)
+    {
+        FakeFrameRenderer frame_renderer(0.5);
+        TelemetryRecorder recorder;
+        TelemetryMonitor monitor(recorder, 3600.0, 0);
+
+        monitor.update(frame_renderer, true);
+
+        ASSERT_EQ(1, recorder.m_telemetry.size());
+        EXPECT_FEQ(recorder.m_telemetry[0].m_elapsed_time, recorder.m_telemetry[0].m_remaining_time);
+    }
+
+    TEST_CASE(Update_UnknownProgress_DoesNotEstimateRemainingTime)
+    {
+        FakeFrameRenderer frame_renderer(-1.0);
+        TelemetryRecorder recorder;
+        TelemetryMonitor monitor(recorder, 3600.0, 0);
+
+        monitor.update(frame_renderer, true);
+
+        ASSERT_EQ(1, recorder.m_telemetry.size());
+        EXPECT_LT(0.0, recorder.m_telemetry[0].m_remaining_time);
+    }
+
+    TEST_CASE(Update_Completed_EstimatesZeroRemainingTime)
+    {
+        FakeFrameRenderer frame_renderer(1.0);
+        TelemetryRecorder recorder;
+        TelemetryMonitor monitor(recorder, 3600.0, 0);
+
+        monitor.update(frame_renderer, true);
+
+        ASSERT_EQ(1, recorder.m_telemetry.size());
+        EXPECT_EQ(0.0, recorder.m_telemetry[0].m_remaining_time);
+    }
+
+    TEST_CASE(GetStatistics_WritesTelemetryAndMemoryStatistics)
+    {
+        RenderTelemetry telemetry;
+        telemetry.m_progress = 0.25;
+        telemetry.m_texture_cache_hit_count = 3;
+        telemetry.m_texture_cache_miss_count = 1;
+
+        Statistics memory_stats;
+        memory_stats.insert_size("textures", 1024);
+        telemetry.m_memory_statistics = StatisticsVector::make("memory statistics", memory_stats);
+
+        stringstream sstr;
+        telemetry.get_statistics().write_json(sstr);
+        const string json = sstr.str();
+
+        EXPECT_NEQ(string::npos, json.find("\"render telemetry\""));
+        EXPECT_NEQ(string::npos, json.find("\"progress\": 25"));
+        EXPECT_NEQ(string::npos, json.find("\"texture cache hit rate\": 75"));
+        EXPECT_NEQ(string::npos, json.find("\"memory statistics\""));
+        EXPECT_NEQ(string::npos, json.find("\"textures\": 1024"));
+    }
+}
@@ -29,10 +29,30 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/texture/memorytexture2d.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/platform/atomic.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
 #include "foundation/utility/test.h"
+#include "foundation/utility/uid.h"
 
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
 using namespace renderer;
 
 TEST_SUITE(Renderer_Kernel_Texturing_TextureStore_TileKey)
@@ -45,5 +65,384 @@ TEST_SUITE(Renderer_Kernel_Texturing_TextureStore_TileKey)
         EXPECT_EQ(12345, key.m_texture_uid);
         EXPECT_EQ(32323, key.get_tile_x());
         EXPECT_EQ(56565, key.get_tile_y());
+        EXPECT_EQ(0, key.get_level());
+    }
+
+    TEST_CASE(StoreAndRetrieveLevel)
+    {
+        const TextureStore::TileKey key(123, 12345, 32323, 56565, 7);
+
+        EXPECT_EQ(32323, key.get_tile_x());
+        EXPECT_EQ(56565, key.get_tile_y());
+        EXPECT_EQ(7, key.get_level());
+    }
+
+    TEST_CASE(KeysOfDifferentLevelsAreDifferent)
+    {
+        const TextureStore::TileKey key0(123, 12345, 3, 5, 0);
+        const TextureStore::TileKey key1(123, 12345, 3, 5, 1);
+
+        EXPECT_FALSE(key0 == key1);
+        EXPECT_TRUE(key0 < key1);
+    }
+}
+
+TEST_SUITE(Renderer_Kernel_Texturing_TextureStore)
+{
+    TEST_CASE(GetMipLevelSize)
+    {
+        EXPECT_EQ(512, TextureStore::get_mip_level_size(512, 0));
+        EXPECT_EQ(128, TextureStore::get_mip_level_size(512, 2));
+        EXPECT_EQ(2, TextureStore::get_mip_level_size(5, 1));
+        EXPECT_EQ(1, TextureStore::get_mip_level_size(5, 6));
+    }
+
+    TEST_CASE(GetMipLevelCount)
+    {
+        EXPECT_EQ(1, TextureStore::get_mip_level_count(1, 1));
+        EXPECT_EQ(10, TextureStore::get_mip_level_count(512, 512));
+        EXPECT_EQ(10, TextureStore::get_mip_level_count(512, 3));
+        EXPECT_EQ(3, TextureStore::get_mip_level_count(5, 4));
+    }
+}
+
+TEST_SUITE(Renderer_Kernel_Texturing_TextureStore_Tiles)
+{
+    const size_t TileCountX = 8;
+    const size_t TileCountY = 8;
+    const size_t TileSize = 8;
+
+    // A scene holding an in-memory texture whose pixels identify their tile.
+    struct Fixture
+      : public TestFixtureBase
+    {
+        UniqueID    m_texture_uid;
+        size_t      m_tile_memory_size;
+
+        Fixture()
+        {
+            auto_release_ptr<Image> image(
+                new Image(
+                    TileCountX * TileSize,
+                    TileCountY * TileSize,
+                    TileSize,
+                    TileSize,
+                    1,
+                    PixelFormatFloat));
+
+            for (size_t ty = 0; ty < TileCountY; ++ty)
+            {
+                for (size_t tx = 0; tx < TileCountX; ++tx)
+                    image->tile(tx, ty).clear(Color<float, 1>(get_tile_value(tx, ty)));
+            }
+
+            m_tile_memory_size = image->tile(0, 0).get_memory_size();
+
+            auto_release_ptr<Texture> texture(
+                MemoryTexture2dFactory::static_create(
+                    "texture",
+                    ParamArray().insert("color_space", "linear_rgb"),
+                    image));
+
+            m_texture_uid = texture->get_uid();
+            m_scene.textures().insert(texture);
+        }
+
+        static float get_tile_value(const size_t tile_x, const size_t tile_y)
+        {
+            return static_cast<float>(tile_y * TileCountX + tile_x);
+        }
+
+        TextureStore::TileKey make_key(const size_t tile_x, const size_t tile_y) const
+        {
+            return TextureStore::TileKey(UniqueID(~0), m_texture_uid, tile_x, tile_y);
+        }
+    };
+
+    // Acquire a tile, check that it holds the pixels of the texture, then release it.
+    bool acquire_and_check(
+        TextureStore&                   store,
+        const TextureStore::TileKey&    key)
+    {
+        TextureStore::TileRecord& record = store.acquire(key);
+
+        const Tile* tile = record.m_tile;
+        const bool ok =
+            tile != 0 &&
+            tile->get_width() == TileSize &&
+            tile->get_height() == TileSize &&
+            tile->get_component<float>(0, 0, 0) == Fixture::get_tile_value(key.get_tile_x(), key.get_tile_y()) &&
+            tile->get_component<float>(TileSize - 1, TileSize - 1, 0) == Fixture::get_tile_value(key.get_tile_x(), key.get_tile_y());
+
+        store.release(record);
+
+        return ok;
+    }
+
+    TEST_CASE_F(Acquire_ReturnsTilesOfTexture, Fixture)
+    {
+        TextureStore store(m_scene);
+
+        for (size_t ty = 0; ty < TileCountY; ++ty)
+        {
+            for (size_t tx = 0; tx < TileCountX; ++tx)
+                EXPECT_TRUE(acquire_and_check(store, make_key(tx, ty)));
+        }
+
+        EXPECT_EQ(TileCountX * TileCountY * m_tile_memory_size, store.get_memory_size());
+    }
+
+    TEST_CASE_F(Acquire_GivenTileAlreadyInStore_HitsStore, Fixture)
+    {
+        TextureStore store(m_scene);
+
+        TextureStore::TileRecord& record1 = store.acquire(make_key(3, 5));
+        store.release(record1);
+
+        TextureStore::TileRecord& record2 = store.acquire(make_key(3, 5));
+        store.release(record2);
+
+        uint64 hit_count, miss_count;
+        store.get_lookup_counts(hit_count, miss_count);
+
+        EXPECT_EQ(&record1, &record2);
+        EXPECT_EQ(1, hit_count);
+        EXPECT_EQ(1, miss_count);
+    }
+
+    TEST_CASE_F(Acquire_GivenSmallMemoryBudget_EvictsAndReloadsTiles, Fixture)
+    {
+        TextureStore store(m_scene, ParamArray().insert("max_size", 4 * m_tile_memory_size));
+
+        for (size_t ty = 0; ty < TileCountY; ++ty)
+        {
+            for (size_t tx = 0; tx < TileCountX; ++tx)
+                ASSERT_TRUE(acquire_and_check(store, make_key(tx, ty)));
+        }
+
+        // Released tiles were evicted to stay within the budget of the store.
+        const size_t resident_tile_count = store.get_memory_size() / m_tile_memory_size;
+        EXPECT_LT(TileCountX * TileCountY, resident_tile_count);
+
+        uint64 hit_count_before, miss_count_before;
+        store.get_lookup_counts(hit_count_before, miss_count_before);
+
+        // Evicted tiles are loaded again, with the same pixels.
+        for (size_t ty = 0; ty < TileCountY; ++ty)
+        {
+            for (size_t tx = 0; tx < TileCountX; ++tx)
+                EXPECT_TRUE(acquire_and_check(store, make_key(tx, ty)));
+        }
+
+        uint64 hit_count_after, miss_count_after;
+        store.get_lookup_counts(hit_count_after, miss_count_after);
+
+        // Only tiles that were still in the store can hit it.
+        EXPECT_TRUE(hit_count_after - hit_count_before <= resident_tile_count);
+        EXPECT_EQ(TileCountX * TileCountY, (hit_count_after - hit_count_before) + (miss_count_after - miss_count_before));
+    }
+
+    TEST_CASE_F(Acquire_GivenAcquiredTile_DoesNotEvictIt, Fixture)
+    {
+        TextureStore store(m_scene, ParamArray().insert("max_size", m_tile_memory_size));
+
+        TextureStore::TileRecord& record = store.acquire(make_key(0, 0));
+
+        for (size_t ty = 0; ty < TileCountY; ++ty)
+        {
+            for (size_t tx = 1; tx < TileCountX; ++tx)
+                ASSERT_TRUE(acquire_and_check(store, make_key(tx, ty)));
+        }
+
+        ASSERT_NEQ(0, record.m_tile);
+        EXPECT_EQ(Fixture::get_tile_value(0, 0), record.m_tile->get_component<float>(0, 0, 0));
+
+        store.release(record);
+    }
+
+    class AcquireTilesJob
+      : public IJob
+    {
+      public:
+        AcquireTilesJob(
+            TextureStore&       store,
+            const Fixture&      fixture,
+            const size_t        offset,
+            volatile uint32&    failure_count)
+          : m_store(store)
+          , m_fixture(fixture)
+          , m_offset(offset)
+          , m_failure_count(failure_count)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            const size_t tile_count = TileCountX * TileCountY;
+
+            for (size_t pass = 0; pass < 16; ++pass)
+            {
+                for (size_t i = 0; i < tile_count; ++i)
+                {
+                    const size_t tile_index = (i + m_offset) % tile_count;
+                    const TextureStore::TileKey key =
+                        m_fixture.make_key(
+                            tile_index % TileCountX,
+                            tile_index / TileCountX);
+
+                    if (!acquire_and_check(m_store, key))
+                        atomic_inc(&m_failure_count);
+                }
+            }
+        }
+
+      private:
+        TextureStore&           m_store;
+        const Fixture&          m_fixture;
+        const size_t            m_offset;
+        volatile uint32&        m_failure_count;
+    };
+
+    TEST_CASE_F(Acquire_FromMultipleThreads_ReturnsTilesOfTexture, Fixture)
+    {
+        const size_t JobCount = 8;
+
+        // Use a budget smaller than the texture so that shards evict tiles concurrently.
+        TextureStore store(m_scene, ParamArray().insert("max_size", 16 * m_tile_memory_size));
+        volatile uint32 failure_count = 0;
+
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(logger, job_queue, 4);
+
+        for (size_t i = 0; i < JobCount; ++i)
+            job_queue.schedule(new AcquireTilesJob(store, *this, i * 7, failure_count));
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        EXPECT_EQ(0, atomic_read(&failure_count));
+    }
+}
+
+TEST_SUITE(Renderer_Kernel_Texturing_TextureStore_MipTiles)
+{
+    const size_t TextureSize = 16;
+    const size_t TileSize = 4;
+
+    // A scene holding an in-memory RGB texture whose pixels identify their position.
+    struct Fixture
+      : public TestFixtureBase
+    {
+        UniqueID    m_texture_uid;
+
+        Fixture()
+        {
+            auto_release_ptr<Image> image(
+                new Image(
+                    TextureSize,
+                    TextureSize,
+                    TileSize,
+                    TileSize,
+                    3,
+                    PixelFormatFloat));
+
+            for (size_t y = 0; y < TextureSize; ++y)
+            {
+                for (size_t x = 0; x < TextureSize; ++x)
+                    image->set_pixel(x, y, Color3f(get_pixel_value(x, y, 0)));
+            }
+
+            auto_release_ptr<Texture> texture(
+                MemoryTexture2dFactory::static_create(
+                    "texture",
+                    ParamArray().insert("color_space", "linear_rgb"),
+                    image));
+
+            m_texture_uid = texture->get_uid();
+            m_scene.textures().insert(texture);
+        }
+
+        // Value of a pixel of a given MIP level: the average of the values of the
+        // base level pixels it covers, since the values vary linearly with x and y.
+        static float get_pixel_value(const size_t x, const size_t y, const size_t level)
+        {
+            const float scale = static_cast<float>(1 << level);
+            const float offset = 0.5f * (scale - 1.0f);
+            return (x * scale + offset) + TextureSize * (y * scale + offset);
+        }
+
+        TextureStore::TileKey make_key(const size_t tile_x, const size_t tile_y, const size_t level) const
+        {
+            return TextureStore::TileKey(UniqueID(~0), m_texture_uid, tile_x, tile_y, level);
+        }
+    };
+
+    // Acquire a tile of a MIP level, check that it holds the filtered pixels of the texture, then release it.
+    bool acquire_and_check(
+        TextureStore&                   store,
+        const TextureStore::TileKey&    key)
+    {
+        TextureStore::TileRecord& record = store.acquire(key);
+
+        const Tile* tile = record.m_tile;
+        bool ok = tile != 0 && tile->get_channel_count() == 3;
+
+        if (ok)
+        {
+            for (size_t y = 0; y < tile->get_height(); ++y)
+            {
+                for (size_t x = 0; x < tile->get_width(); ++x)
+                {
+                    Color3f color;
+                    tile->get_pixel(x, y, color);
+
+                    const float expected =
+                        Fixture::get_pixel_value(
+                            key.get_tile_x() * TileSize + x,
+                            key.get_tile_y() * TileSize + y,
+                            key.get_level());
+
+                    if (color != Color3f(expected))
+                        ok = false;
+                }
+            }
+        }
+
+        store.release(record);
+
+        return ok;
+    }
+
+    TEST_CASE_F(Acquire_GivenTileOfMipLevel_ReturnsFilteredPixels, Fixture)
+    {
+        TextureStore store(m_scene);
+
+        EXPECT_TRUE(acquire_and_check(store, make_key(0, 0, 1)));
+        EXPECT_TRUE(acquire_and_check(store, make_key(1, 1, 1)));
+        EXPECT_TRUE(acquire_and_check(store, make_key(0, 0, 2)));
+    }
+
+    TEST_CASE_F(Acquire_GivenTileOfMipLevel_CachesTilesOfFinerLevels, Fixture)
+    {
+        TextureStore store(m_scene);
+
+        // Building the single tile of level 2 acquires the four tiles of level 1,
+        // which in turn acquire the sixteen tiles of level 0.
+        EXPECT_TRUE(acquire_and_check(store, make_key(0, 0, 2)));
+
+        uint64 hit_count, miss_count;
+        store.get_lookup_counts(hit_count, miss_count);
+
+        EXPECT_EQ(0, hit_count);
+        EXPECT_EQ(1 + 4 + 16, miss_count);
+
+        // The tiles of the finer levels are then found in the store.
+        EXPECT_TRUE(acquire_and_check(store, make_key(1, 0, 1)));
+
+        store.get_lookup_counts(hit_count, miss_count);
+
+        EXPECT_EQ(1, hit_count);
+        EXPECT_EQ(1 + 4 + 16, miss_count);
     }
 }
@@ -0,0 +1,132 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/tilebatchscheduler.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_TileBatchScheduler)
+{
+    // A 10x6 frame made of 5x3 tiles of 2x2 pixels.
+    auto_release_ptr<Frame> create_frame(const char* crop_window = 0)
+    {
+        ParamArray params;
+        params.insert("resolution", "10 6");
+        params.insert("tile_size", "2 2");
+
+        if (crop_window)
+            params.insert("crop_window", crop_window);
+
+        return FrameFactory::create("frame", params);
+    }
+
+    TEST_CASE(Constructor_SplitsTileRowsIntoBatches)
+    {
+        auto_release_ptr<Frame> frame(create_frame());
+        TileBatchScheduler scheduler(frame.ref(), 2);
+
+        ASSERT_EQ(9, scheduler.get_batch_count());
+
+        AABB2u batches[3];
+        for (size_t i = 0; i < 3; ++i)
+            ASSERT_TRUE(scheduler.acquire(batches[i]));
+
+        EXPECT_EQ(AABB2u(Vector2u(0, 0), Vector2u(3, 1)), batches[0]);
+        EXPECT_EQ(AABB2u(Vector2u(4, 0), Vector2u(7, 1)), batches[1]);
+        EXPECT_EQ(AABB2u(Vector2u(8, 0), Vector2u(9, 1)), batches[2]);
+    }
+
+    TEST_CASE(Acquire_GivenCropWindow_CoversCropWindowExactlyOnce)
+    {
+        auto_release_ptr<Frame> frame(create_frame("1 1 8 4"));
+        TileBatchScheduler scheduler(frame.ref(), 2);
+
+        vector<size_t> coverage(10 * 6, 0);
+
+        AABB2u batch;
+        while (scheduler.acquire(batch))
+        {
+            for (size_t y = batch.min.y; y <= batch.max.y; ++y)
+            {
+                for (size_t x = batch.min.x; x <= batch.max.x; ++x)
+                    ++coverage[y * 10 + x];
+            }
+
+            scheduler.complete();
+        }
+
+        for (size_t y = 0; y < 6; ++y)
+        {
+            for (size_t x = 0; x < 10; ++x)
+            {
+                const bool inside = x >= 1 && x <= 8 && y >= 1 && y <= 4;
+                EXPECT_EQ(inside ? 1 : 0, coverage[y * 10 + x]);
+            }
+        }
+    }
+
+    TEST_CASE(Acquire_AfterAbandon_HandsOutAbandonedBatchAgain)
+    {
+        auto_release_ptr<Frame> frame(create_frame());
+        TileBatchScheduler scheduler(frame.ref(), 2);
+
+        AABB2u abandoned;
+        ASSERT_TRUE(scheduler.acquire(abandoned));
+        scheduler.abandon(abandoned);
+
+        AABB2u batch;
+        ASSERT_TRUE(scheduler.acquire(batch));
+        EXPECT_EQ(abandoned, batch);
+        scheduler.complete();
+
+        size_t completed_batch_count = 1;
+        while (scheduler.acquire(batch))
+        {
+            scheduler.complete();
+            ++completed_batch_count;
+        }
+
+        EXPECT_EQ(scheduler.get_batch_count(), completed_batch_count);
+    }
+}
@@ -701,6 +701,64 @@ TEST_SUITE(Renderer_Kernel_Lighting_Tracer)
         EXPECT_EQ(1.0f, transmission);
     }
 
+    TEST_CASE_F(TraceBetweenBatch_GivenTwoOpaqueOccluders_MatchesTraceBetween, Fixture<SceneWithTwoOpaqueOccluders>)
+    {
+        Tracer parent_tracer(
+            *m_scene,
+            m_intersector,
+            m_texture_cache,
+            *m_shading_group_exec);
+
+        float parent_transmission;
+        const ShadingPoint& parent_shading_point =
+            parent_tracer.trace(
+                Vector3d(0.0, 0.0, 0.0),
+                Vector3d(1.0, 0.0, 0.0),
+                ShadingRay::Time(),
+                VisibilityFlags::ShadowRay,
+                0,
+                parent_transmission);
+
+        ASSERT_TRUE(parent_shading_point.hit());
+
+        Tracer tracer(
+            *m_scene,
+            m_intersector,
+            m_texture_cache,
+            *m_shading_group_exec);
+
+        const Vector3d targets[] =
+        {
+            Vector3d(4.0, 0.0, 0.0),
+            Vector3d(6.0, 0.0, 0.0),
+            Vector3d(3.0, 0.2, 0.1),
+            Vector3d(0.0, 0.0, 0.0)
+        };
+        const size_t TargetCount = sizeof(targets) / sizeof(targets[0]);
+
+        float transmissions[TargetCount];
+        tracer.trace_between_batch(
+            parent_shading_point,
+            TargetCount,
+            targets,
+            VisibilityFlags::ShadowRay,
+            transmissions);
+
+        EXPECT_EQ(1.0f, transmissions[0]);
+        EXPECT_EQ(0.0f, transmissions[1]);
+
+        for (size_t i = 0; i < TargetCount; ++i)
+        {
+            const float expected =
+                tracer.trace_between(
+                    parent_shading_point,
+                    targets[i],
+                    VisibilityFlags::ShadowRay);
+
+            EXPECT_EQ(expected, transmissions[i]);
+        }
+    }
+
     struct SceneWithTwoOpaqueOccludersAndScaledAssemblyInstance
       : public SceneWithTwoOpaqueOccluders
     {
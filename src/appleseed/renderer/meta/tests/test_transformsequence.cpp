@@ -405,6 +405,35 @@ TEST_SUITE(Renderer_Utility_TransformSequence)
         EXPECT_FEQ(expected, sequence.evaluate(2.0));
     }
 
+    TEST_CASE(Evaluate_GivenThreeTransforms_WhenTimeInRotatingSegment_ReturnsCorrectlyInterpolatedTransform)
+    {
+        const Transformd FirstTransform(
+            Transformd::from_local_to_parent(
+                Matrix4d::make_translation(Vector3d(1.0, 2.0, 3.0))));
+        const Transformd SecondTransform(
+            Transformd::from_local_to_parent(
+                Matrix4d::make_translation(Vector3d(4.0, 5.0, 6.0))));
+        const Transformd ThirdTransform(
+            Transformd::from_local_to_parent(
+                Matrix4d::make_translation(Vector3d(4.0, 5.0, 6.0)) *
+                Matrix4d::make_rotation_y(HalfPi<double>())));
+
+        TransformSequence sequence;
+        sequence.set_transform(0.0f, FirstTransform);
+        sequence.set_transform(1.0f, SecondTransform);
+        sequence.set_transform(2.0f, ThirdTransform);
+        sequence.prepare();
+
+        const TransformInterpolatord interpolator(
+            SecondTransform,
+            ThirdTransform);
+
+        Transformd expected;
+        interpolator.evaluate(0.5, expected);
+
+        EXPECT_FEQ(expected, sequence.evaluate(1.5));
+    }
+
     TEST_CASE(CompositionOperator_GivenTwoEmptyTransformSequences_ReturnsEmptyTransformSequence)
     {
         TransformSequence seq1, seq2;
@@ -876,6 +905,44 @@ TEST_SUITE(Renderer_Utility_TransformSequence)
             bbox);
     }
 
+    TEST_CASE(ToParent_GivenAABBAndTimeRange_ReturnsBoundingBoxOfMotionInTimeRange)
+    {
+        TransformSequence sequence;
+        sequence.set_transform(
+            0.0f,
+            Transformd::from_local_to_parent(
+                Matrix4d::make_rotation(Vector3d(0.0, 0.0, 1.0), 0.0)));
+        sequence.set_transform(
+            0.5f,
+            Transformd::from_local_to_parent(
+                Matrix4d::make_translation(Vector3d(5.0, 0.0, 0.0)) *
+                Matrix4d::make_rotation(Vector3d(0.0, 0.0, 1.0), HalfPi<double>())));
+        sequence.set_transform(
+            1.0f,
+            Transformd::from_local_to_parent(
+                Matrix4d::make_translation(Vector3d(10.0, 0.0, 0.0)) *
+                Matrix4d::make_rotation(Vector3d(0.0, 0.0, 1.0), Pi<double>())));
+        sequence.prepare();
+
+        const AABB3d bbox(Vector3d(-2.0, -2.0, -0.5), Vector3d(-1.0, -1.0, 0.5));
+        const float TimeBegin = 0.3f;
+        const float TimeEnd = 0.7f;
+
+        AABB3d range_bbox = sequence.to_parent(bbox, TimeBegin, TimeEnd);
+        range_bbox.robust_grow(1.0e-6);
+
+        for (size_t i = 0; i <= 100; ++i)
+        {
+            const float time = lerp(TimeBegin, TimeEnd, static_cast<float>(i) / 100);
+            const AABB3d pose_bbox = sequence.evaluate(time).to_parent(bbox);
+            EXPECT_TRUE(range_bbox.contains(pose_bbox.min));
+            EXPECT_TRUE(range_bbox.contains(pose_bbox.max));
+        }
+
+        const AABB3d motion_bbox = sequence.to_parent(bbox);
+        EXPECT_LT(motion_bbox.volume(), range_bbox.volume());
+    }
+
     TEST_CASE(TestSwapsHandednessNegativeScale1Axis)
     {
         TransformSequence sequence;
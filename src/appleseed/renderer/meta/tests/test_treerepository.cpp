@@ -0,0 +1,186 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/intersection/treerepository.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+#include "foundation/utility/lazy.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Intersection_TreeRepository)
+{
+    struct DummyTree
+    {
+        size_t get_memory_size() const
+        {
+            return 100;
+        }
+    };
+
+    struct DummyTreeFactory
+      : public ILazyFactory<DummyTree>
+    {
+        virtual auto_ptr<DummyTree> create() APPLESEED_OVERRIDE
+        {
+            return auto_ptr<DummyTree>(new DummyTree());
+        }
+    };
+
+    typedef TreeRepository<DummyTree> DummyTreeRepository;
+
+    DummyTreeRepository::LazyTreeType* make_tree()
+    {
+        return
+            new DummyTreeRepository::LazyTreeType(
+                auto_ptr<ILazyFactory<DummyTree> >(new DummyTreeFactory()));
+    }
+
+    struct CountTrees
+    {
+        size_t m_count;
+
+        CountTrees()
+          : m_count(0)
+        {
+        }
+
+        void operator()(Lazy<DummyTree>& tree, const size_t ref_count)
+        {
+            ++m_count;
+        }
+    };
+
+    TEST_CASE(Acquire_GivenUnknownKey_ReturnsNull)
+    {
+        DummyTreeRepository repository;
+
+        EXPECT_EQ(0, repository.acquire(1));
+    }
+
+    TEST_CASE(Acquire_GivenKeyOfInsertedTree_ReturnsTree)
+    {
+        DummyTreeRepository repository;
+        DummyTreeRepository::LazyTreeType* tree = make_tree();
+        repository.insert(1, tree);
+
+        EXPECT_EQ(tree, repository.acquire(1));
+        EXPECT_EQ(1, repository.size());
+    }
+
+    TEST_CASE(Release_GivenLastReference_KeepsTreeAlive)
+    {
+        DummyTreeRepository repository;
+        DummyTreeRepository::LazyTreeType* tree = make_tree();
+        repository.insert(1, tree);
+
+        repository.release(tree);
+
+        EXPECT_EQ(0, repository.size());
+        EXPECT_EQ(1, repository.get_released_count());
+        EXPECT_EQ(tree, repository.acquire(1));
+        EXPECT_EQ(1, repository.size());
+        EXPECT_EQ(0, repository.get_released_count());
+    }
+
+    TEST_CASE(Release_BeyondKeepAliveCount_DeletesLeastRecentlyReleasedTree)
+    {
+        DummyTreeRepository repository(1);
+        DummyTreeRepository::LazyTreeType* tree1 = make_tree();
+        DummyTreeRepository::LazyTreeType* tree2 = make_tree();
+        repository.insert(1, tree1);
+        repository.insert(2, tree2);
+
+        repository.release(tree1);
+        repository.release(tree2);
+
+        EXPECT_EQ(1, repository.get_released_count());
+        EXPECT_EQ(0, repository.acquire(1));
+        EXPECT_EQ(tree2, repository.acquire(2));
+    }
+
+    TEST_CASE(Purge_DeletesReleasedTrees)
+    {
+        DummyTreeRepository repository;
+        DummyTreeRepository::LazyTreeType* tree = make_tree();
+        repository.insert(1, tree);
+        repository.release(tree);
+
+        repository.purge();
+
+        EXPECT_EQ(0, repository.get_released_count());
+        EXPECT_EQ(0, repository.acquire(1));
+    }
+
+    TEST_CASE(ForEach_SkipsReleasedTrees)
+    {
+        DummyTreeRepository repository;
+        DummyTreeRepository::LazyTreeType* tree = make_tree();
+        repository.insert(1, tree);
+        repository.insert(2, make_tree());
+        repository.release(tree);
+
+        CountTrees count_trees;
+        repository.for_each(count_trees);
+
+        EXPECT_EQ(1, count_trees.m_count);
+    }
+
+    TEST_CASE(GetMemorySize_GivenTreeNotBuiltYet_ReturnsZero)
+    {
+        DummyTreeRepository repository;
+        repository.insert(1, make_tree());
+
+        EXPECT_EQ(0, repository.get_memory_size(1));
+    }
+
+    TEST_CASE(GetReleasedMemorySize_GivenReleasedBuiltTree_ReturnsTreeSize)
+    {
+        DummyTreeRepository repository;
+        DummyTreeRepository::LazyTreeType* tree = make_tree();
+        repository.insert(1, tree);
+        Access<DummyTree>(tree).get();
+
+        EXPECT_EQ(100, repository.get_memory_size(1));
+        EXPECT_EQ(0, repository.get_released_memory_size());
+
+        repository.release(tree);
+
+        EXPECT_EQ(100, repository.get_released_memory_size());
+    }
+}
@@ -0,0 +1,143 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/intersection/triangleencoder.h"
+#include "renderer/kernel/intersection/trianglevertexinfo.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/memory.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Intersection_TriangleEncoder)
+{
+    struct Fixture
+    {
+        vector<TriangleVertexInfo>  m_vertex_infos;
+        vector<GVector3>            m_vertices;
+        vector<size_t>              m_indices;
+
+        Fixture()
+        {
+            // Two triangles sharing an edge.
+            add_triangle(GVector3(0.0f, 0.0f, 0.0f), GVector3(1.0f, 0.0f, 0.0f), GVector3(0.0f, 1.0f, 0.0f), 1);
+            add_triangle(GVector3(1.0f, 0.0f, 0.0f), GVector3(1.0f, 1.0f, 0.0f), GVector3(0.0f, 1.0f, 0.0f), 1);
+        }
+
+        void add_triangle(
+            const GVector3&     v0,
+            const GVector3&     v1,
+            const GVector3&     v2,
+            const uint32        vis_flags)
+        {
+            m_vertex_infos.push_back(TriangleVertexInfo(m_vertices.size(), 0, vis_flags));
+            m_vertices.push_back(v0);
+            m_vertices.push_back(v1);
+            m_vertices.push_back(v2);
+            m_indices.push_back(m_indices.size());
+        }
+
+        size_t compact_size() const
+        {
+            return TriangleEncoder::compute_compact_size(m_vertex_infos, m_vertices, m_indices, 0, m_indices.size());
+        }
+    };
+
+    TEST_CASE_F(ComputeCompactSize_GivenTwoTrianglesSharingAnEdge_StoresFourVertices, Fixture)
+    {
+        EXPECT_EQ(TriangleEncoder::compute_compact_header_size(2) + 4 * sizeof(GVector3), compact_size());
+    }
+
+    TEST_CASE_F(ComputeCompactSize_GivenTwoTrianglesSharingAnEdge_IsSmallerThanFullSize, Fixture)
+    {
+        const size_t full_size = TriangleEncoder::compute_size(m_vertex_infos, m_indices, 0, m_indices.size());
+
+        EXPECT_GT(compact_size(), full_size);
+    }
+
+    TEST_CASE_F(EncodeCompact_GivenTwoTrianglesSharingAnEdge_DecodesIdenticalTriangles, Fixture)
+    {
+        vector<uint8> leaf_data(compact_size());
+        MemoryWriter writer(&leaf_data[0]);
+        TriangleEncoder::encode_compact(m_vertex_infos, m_vertices, m_indices, 0, m_indices.size(), writer);
+
+        EXPECT_EQ(leaf_data.size(), writer.offset());
+        ASSERT_TRUE(TriangleEncoder::is_compact(&leaf_data[0]));
+
+        const CompactTriangleLeafReader reader(&leaf_data[0], m_indices.size());
+
+        EXPECT_EQ(1, reader.get_vis_flags());
+
+        for (size_t i = 0; i < m_indices.size(); ++i)
+        {
+            const GTriangleType expected(m_vertices[i * 3 + 0], m_vertices[i * 3 + 1], m_vertices[i * 3 + 2]);
+            const GTriangleType triangle = reader.get_triangle(i);
+
+            EXPECT_EQ(expected.m_v0, triangle.m_v0);
+            EXPECT_EQ(expected.m_e0, triangle.m_e0);
+            EXPECT_EQ(expected.m_e1, triangle.m_e1);
+        }
+    }
+
+    TEST_CASE_F(IsCompact_GivenFullFormat_ReturnsFalse, Fixture)
+    {
+        vector<uint8> leaf_data(TriangleEncoder::compute_size(m_vertex_infos, m_indices, 0, m_indices.size()));
+        MemoryWriter writer(&leaf_data[0]);
+        TriangleEncoder::encode(m_vertex_infos, m_vertices, m_indices, 0, m_indices.size(), writer);
+
+        EXPECT_FALSE(TriangleEncoder::is_compact(&leaf_data[0]));
+    }
+
+    TEST_CASE_F(IsCompactable_GivenTrianglesWithDifferentVisibilityFlags_ReturnsFalse, Fixture)
+    {
+        add_triangle(GVector3(2.0f, 0.0f, 0.0f), GVector3(3.0f, 0.0f, 0.0f), GVector3(2.0f, 1.0f, 0.0f), 2);
+
+        EXPECT_FALSE(TriangleEncoder::is_compactable(m_vertex_infos, m_vertices, m_indices, 0, m_indices.size()));
+    }
+
+    TEST_CASE_F(IsCompactable_GivenMovingTriangle_ReturnsFalse, Fixture)
+    {
+        m_vertex_infos[1].m_motion_segment_count = 1;
+
+        EXPECT_FALSE(TriangleEncoder::is_compactable(m_vertex_infos, m_vertices, m_indices, 0, m_indices.size()));
+    }
+}
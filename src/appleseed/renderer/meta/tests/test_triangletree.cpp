@@ -0,0 +1,211 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/input/inputbinder.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/test.h"
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+
+// Standard headers.
+#include <ctime>
+#include <fstream>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+namespace bf = boost::filesystem;
+
+TEST_SUITE(Renderer_Kernel_Intersection_TriangleTree)
+{
+    const char* Directory = "unit tests/outputs/test_triangletree/";
+
+    struct Fixture
+    {
+        Fixture()
+        {
+            bf::remove_all(Directory);
+        }
+
+        ~Fixture()
+        {
+            bf::remove_all(Directory);
+        }
+
+        // Build the triangle tree of a plane orthogonal to the x axis, with the tree cache
+        // enabled, and return the distance from x = -1 to the plane, or -1 if the plane is missed.
+        static double trace_plane(const float plane_x)
+        {
+            auto_release_ptr<Scene> scene(SceneFactory::create());
+
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create(
+                    "assembly",
+                    ParamArray().insert_path("acceleration_structure.cache_directory", Directory)));
+
+            auto_release_ptr<MeshObject> mesh_object =
+                MeshObjectFactory::create("plane", ParamArray());
+
+            mesh_object->push_vertex(GVector3(plane_x, -0.5f, -0.5f));
+            mesh_object->push_vertex(GVector3(plane_x, +0.5f, -0.5f));
+            mesh_object->push_vertex(GVector3(plane_x, +0.5f, +0.5f));
+            mesh_object->push_vertex(GVector3(plane_x, -0.5f, +0.5f));
+
+            mesh_object->push_vertex_normal(GVector3(-1.0f, 0.0f, 0.0f));
+
+            mesh_object->push_triangle(Triangle(0, 1, 2, 0, 0, 0, 0));
+            mesh_object->push_triangle(Triangle(2, 3, 0, 0, 0, 0, 0));
+
+            assembly->objects().insert(auto_release_ptr<Object>(mesh_object.release()));
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "plane_instance",
+                    ParamArray(),
+                    "plane",
+                    Transformd::identity(),
+                    StringDictionary()));
+
+            scene->assembly_instances().insert(
+                auto_release_ptr<AssemblyInstance>(
+                    AssemblyInstanceFactory::create(
+                        "assembly_instance",
+                        ParamArray(),
+                        "assembly")));
+
+            scene->assemblies().insert(assembly);
+
+            InputBinder input_binder;
+            input_binder.bind(scene.ref());
+
+            TraceContext trace_context(scene.ref());
+            TextureStore texture_store(scene.ref());
+            TextureCache texture_cache(texture_store);
+            Intersector intersector(trace_context, texture_cache);
+
+            const ShadingRay ray(
+                Vector3d(-1.0, 0.1, 0.2),
+                Vector3d(1.0, 0.0, 0.0),
+                0.0,                                // tmin
+                4.0,                                // tmax
+                ShadingRay::Time(),
+                VisibilityFlags::CameraRay,
+                0);                                 // depth
+
+            ShadingPoint shading_point;
+            return intersector.trace(ray, shading_point) ? shading_point.get_distance() : -1.0;
+        }
+
+        static vector<bf::path> get_cache_files()
+        {
+            vector<bf::path> files;
+
+            for (bf::directory_iterator i(Directory), e; i != e; ++i)
+                files.push_back(i->path());
+
+            return files;
+        }
+    };
+
+    TEST_CASE_F(Build_GivenCacheDirectory_WritesCacheFile, Fixture)
+    {
+        EXPECT_FEQ(1.0, trace_plane(0.0f));
+
+        EXPECT_EQ(1, get_cache_files().size());
+    }
+
+    TEST_CASE_F(Build_GivenCachedTree_LoadsTreeFromCache, Fixture)
+    {
+        trace_plane(0.0f);
+
+        // Backdate the cache file: rebuilding the tree would replace it by a new file.
+        const vector<bf::path> files = get_cache_files();
+        ASSERT_EQ(1, files.size());
+        const time_t backdated_time = bf::last_write_time(files[0]) - 3600;
+        bf::last_write_time(files[0], backdated_time);
+
+        EXPECT_FEQ(1.0, trace_plane(0.0f));
+
+        EXPECT_EQ(1, get_cache_files().size());
+        EXPECT_EQ(backdated_time, bf::last_write_time(files[0]));
+    }
+
+    TEST_CASE_F(Build_GivenModifiedGeometry_WritesNewCacheFile, Fixture)
+    {
+        trace_plane(0.0f);
+
+        EXPECT_FEQ(1.5, trace_plane(0.5f));
+
+        EXPECT_EQ(2, get_cache_files().size());
+    }
+
+    TEST_CASE_F(Build_GivenCorruptedCacheFile_RebuildsTree, Fixture)
+    {
+        trace_plane(0.0f);
+
+        const vector<bf::path> files = get_cache_files();
+        ASSERT_EQ(1, files.size());
+
+        {
+            ofstream file(files[0].string().c_str(), ios::binary | ios::trunc);
+            file << "garbage";
+        }
+
+        EXPECT_FEQ(1.0, trace_plane(0.0f));
+
+        EXPECT_EQ(1, get_cache_files().size());
+        EXPECT_GT(7, bf::file_size(files[0]));
+    }
+}
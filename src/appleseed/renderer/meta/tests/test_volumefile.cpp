@@ -0,0 +1,275 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/majorantgrid.h"
+#include "renderer/kernel/volume/occupancygrid.h"
+#include "renderer/kernel/volume/sparsevoxelgrid.h"
+#include "renderer/kernel/volume/volume.h"
+#include "renderer/kernel/volume/volumebrickstore.h"
+#include "renderer/kernel/volume/volumefileformat.h"
+#include "renderer/kernel/volume/volumefilereader.h"
+#include "renderer/kernel/volume/volumefilewriter.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/xorshift.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+namespace bf = boost::filesystem;
+
+TEST_SUITE(Renderer_Kernel_Volume_VolumeFile)
+{
+    struct Fixture
+    {
+        VoxelGrid               m_grid;
+        vector<string>          m_channel_names;
+        vector<string>          m_filenames;
+
+        // A 20x13x9 grid with a smooth density channel filling the low x half
+        // of the grid, and an everywhere varying temperature channel.
+        Fixture()
+          : m_grid(20, 13, 9, 2)
+        {
+            for (size_t z = 0; z < 9; ++z)
+            {
+                for (size_t y = 0; y < 13; ++y)
+                {
+                    for (size_t x = 0; x < 20; ++x)
+                    {
+                        float* voxel = m_grid.voxel(x, y, z);
+                        voxel[0] = x < 8 ? static_cast<float>(x + 2 * y + 3 * z) : 0.0f;
+                        voxel[1] = static_cast<float>(x * y) - static_cast<float>(z);
+                    }
+                }
+            }
+
+            m_channel_names.push_back("density");
+            m_channel_names.push_back("temperature");
+        }
+
+        // Delete the files written by the test; readers are closed by then.
+        ~Fixture()
+        {
+            for (size_t i = 0; i < m_filenames.size(); ++i)
+                bf::remove(m_filenames[i]);
+        }
+
+        void write(const char* filename, const int options)
+        {
+            m_filenames.push_back(filename);
+
+            VolumeFileWriter writer(filename, options, 8);
+            writer.write(m_grid, m_channel_names);
+        }
+
+        auto_ptr<VolumeFileReader> open(const char* filename) const
+        {
+            auto_ptr<VolumeFileReader> reader(new VolumeFileReader());
+            reader->open(filename);
+            return reader;
+        }
+    };
+
+    TEST_CASE_F(WriteAndRead_Uncompressed_ReturnsOriginalHeaderAndBricks, Fixture)
+    {
+        const char* Filename = "unit tests/outputs/test_volumefile_uncompressed.avl";
+        write(Filename, VolumeFileWriter::Defaults);
+
+        auto_ptr<VolumeFileReader> reader = open(Filename);
+
+        EXPECT_FALSE(reader->is_compressed());
+        EXPECT_EQ(20, reader->get_xres());
+        EXPECT_EQ(13, reader->get_yres());
+        EXPECT_EQ(9, reader->get_zres());
+        EXPECT_EQ(8, reader->get_brick_size());
+        EXPECT_EQ(3, reader->get_brick_xres());
+        EXPECT_EQ(2, reader->get_brick_yres());
+        EXPECT_EQ(1, reader->get_brick_zres());
+        ASSERT_EQ(2, reader->get_channel_count());
+        EXPECT_EQ(string("density"), reader->get_channel_name(0));
+        EXPECT_EQ(string("temperature"), reader->get_channel_name(1));
+        EXPECT_EQ(1, reader->find_channel("temperature"));
+        EXPECT_EQ(VolumeFileReader::NotFound, reader->find_channel("velocity.x"));
+
+        // Brick (1, 1, 0) holds the voxels [8, 16] x [8, 12] x [0, 8].
+        size_t width, height, depth;
+        reader->get_brick_dimensions(1, 1, 0, width, height, depth);
+        ASSERT_EQ(9, width);
+        ASSERT_EQ(5, height);
+        ASSERT_EQ(9, depth);
+
+        vector<float> values(width * height * depth);
+        reader->read_brick(1, 1, 1, 0, &values[0]);
+
+        EXPECT_EQ(m_grid.voxel(8, 8, 0)[1], values[0]);
+        EXPECT_EQ(m_grid.voxel(16, 8, 0)[1], values[8]);
+        EXPECT_EQ(m_grid.voxel(16, 12, 8)[1], values.back());
+    }
+
+    TEST_CASE_F(Write_ConstantBricks_StoresNoDataForThem, Fixture)
+    {
+        const char* Filename = "unit tests/outputs/test_volumefile_constantbricks.avl";
+        write(Filename, VolumeFileWriter::Compress);
+
+        auto_ptr<VolumeFileReader> reader = open(Filename);
+
+        EXPECT_TRUE(reader->is_compressed());
+
+        // Density is zero beyond x = 8, i.e. in the bricks whose x index is 1 or 2,
+        // except for the voxels at x = 8 shared with the first bricks.
+        const volume_file_format::BrickEntry& empty_entry = reader->get_brick_entry(0, 2, 0, 0);
+        EXPECT_EQ(0, empty_entry.m_size);
+        EXPECT_EQ(0.0f, empty_entry.m_min);
+        EXPECT_EQ(0.0f, empty_entry.m_max);
+
+        const volume_file_format::BrickEntry& full_entry = reader->get_brick_entry(0, 0, 0, 0);
+        EXPECT_NEQ(0, full_entry.m_size);
+        EXPECT_EQ(0.0f, full_entry.m_min);
+        EXPECT_EQ(7.0f + 2.0f * 8.0f + 3.0f * 8.0f, full_entry.m_max);
+
+        vector<float> values(9 * 9 * 9);
+        reader->read_brick(0, 2, 0, 0, &values[0]);
+        EXPECT_EQ(0.0f, values[0]);
+    }
+
+    TEST_CASE_F(LinearLookup_GivenSparseGrid_MatchesDenseGrid, Fixture)
+    {
+        const char* Filename = "unit tests/outputs/test_volumefile_lookups.avl";
+        write(Filename, VolumeFileWriter::Compress);
+
+        SparseVoxelGrid sparse_grid(open(Filename), 1);
+
+        Xorshift rng;
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const Vector3d point(
+                rand_double1(rng, -0.1, 1.1),
+                rand_double1(rng, -0.1, 1.1),
+                rand_double1(rng, -0.1, 1.1));
+
+            float expected[2];
+            m_grid.linear_lookup(point, expected);
+
+            EXPECT_FEQ_EPS(expected[1], sparse_grid.linear_lookup(point), 1.0e-3f);
+        }
+
+        // Corners of the grid.
+        float expected[2];
+        m_grid.linear_lookup(Vector3d(1.0), expected);
+        EXPECT_FEQ(expected[1], sparse_grid.linear_lookup(Vector3d(1.0)));
+    }
+
+    TEST_CASE_F(MajorantGrid_GivenSparseGrid_MatchesMajorantsOfDenseGrid, Fixture)
+    {
+        const char* Filename = "unit tests/outputs/test_volumefile_majorants.avl";
+        write(Filename, VolumeFileWriter::Defaults);
+
+        SparseVoxelGrid sparse_grid(open(Filename), 0);
+        const MajorantGrid sparse_majorants(sparse_grid, 0.0f);
+
+        const OccupancyGrid occupancy_grid(m_grid, 0, 0.0f);
+        const MajorantGrid dense_majorants(m_grid, 0, occupancy_grid, 8);
+
+        ASSERT_EQ(dense_majorants.get_xres(), sparse_majorants.get_xres());
+        ASSERT_EQ(dense_majorants.get_yres(), sparse_majorants.get_yres());
+        ASSERT_EQ(dense_majorants.get_zres(), sparse_majorants.get_zres());
+
+        for (size_t cz = 0; cz < dense_majorants.get_zres(); ++cz)
+        {
+            for (size_t cy = 0; cy < dense_majorants.get_yres(); ++cy)
+            {
+                for (size_t cx = 0; cx < dense_majorants.get_xres(); ++cx)
+                {
+                    EXPECT_EQ(
+                        dense_majorants.get_majorant(cx, cy, cz),
+                        sparse_majorants.get_majorant(cx, cy, cz));
+                }
+            }
+        }
+    }
+
+    TEST_CASE_F(LinearLookup_GivenTinyBrickStore_ReloadsEvictedBricks, Fixture)
+    {
+        const char* Filename = "unit tests/outputs/test_volumefile_eviction.avl";
+        write(Filename, VolumeFileWriter::Defaults);
+
+        // Too small to hold even a single brick: every lookup evicts bricks of its shard.
+        ParamArray params;
+        params.insert("max_size", 1);
+        VolumeBrickStore store(params);
+
+        SparseVoxelGrid sparse_grid(open(Filename), 1, &store);
+
+        Xorshift rng;
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const Vector3d point(
+                rand_double1(rng),
+                rand_double1(rng),
+                rand_double1(rng));
+
+            float expected[2];
+            m_grid.linear_lookup(point, expected);
+
+            EXPECT_FEQ_EPS(expected[1], sparse_grid.linear_lookup(point), 1.0e-3f);
+        }
+    }
+
+    TEST_CASE(GetChannelNames_GivenFluidChannels_ReturnsOneNamePerScalarChannel)
+    {
+        FluidChannels channels;
+        channels.m_color_index = 0;
+        channels.m_density_index = 3;
+        channels.m_velocity_index = 4;
+
+        const vector<string> names = channels.get_channel_names();
+
+        ASSERT_EQ(7, names.size());
+        EXPECT_EQ("color.r", names[0]);
+        EXPECT_EQ("color.b", names[2]);
+        EXPECT_EQ("density", names[3]);
+        EXPECT_EQ("velocity.x", names[4]);
+        EXPECT_EQ("velocity.z", names[6]);
+    }
+}
@@ -101,6 +101,23 @@ void BSDFSample::compute_transmitted_differentials(const float eta)
     }
 }
 
+void BSDFSample::compute_diffuse_differentials()
+{
+    if (m_outgoing.has_derivatives())
+    {
+        assert(m_probability > 0.0f);
+
+        const float spread = get_pdf_spread(m_probability);
+        const Basis3f basis(m_incoming.get_value());
+
+        m_incoming =
+            Dual3f(
+                m_incoming.get_value(),
+                basis.get_tangent_u() * spread,
+                basis.get_tangent_v() * spread);
+    }
+}
+
 void BSDFSample::compute_normal_derivatives(
     Vector3f&   dndx,
     Vector3f&   dndy,
@@ -128,20 +145,22 @@ void BSDFSample::compute_normal_derivatives(
 
 void BSDFSample::apply_pdf_differentials_heuristic()
 {
-    //
-    // Reference:
-    //
-    //   https://renderman.pixar.com/resources/RenderMan_20/integratorRef.html#about-ray-differentials-ray-spreads
-    //
-
     assert(m_incoming.has_derivatives());
     assert(m_probability > 0.0f);
 
-    const float pdf_spread = 1.0f / (8.0f * sqrt(m_probability));
+    const float pdf_spread = get_pdf_spread(m_probability);
 
     const float rx_spread = norm(m_incoming.get_dx());
     const float ry_spread = norm(m_incoming.get_dy());
 
+    // Degenerate derivatives, e.g. on flat surfaces hit by parallel rays: fall back to
+    // derivatives that only depend on the PDF.
+    if (rx_spread == 0.0f || ry_spread == 0.0f)
+    {
+        compute_diffuse_differentials();
+        return;
+    }
+
     const float sx = max(pdf_spread, rx_spread) / rx_spread;
     const float sy = max(pdf_spread, ry_spread) / ry_spread;
 
@@ -39,6 +39,9 @@
 #include "foundation/math/dual.h"
 #include "foundation/math/vector.h"
 
+// Standard headers.
+#include <cmath>
+
 namespace renderer
 {
 
@@ -70,6 +73,14 @@ class BSDFSample
     void compute_reflected_differentials();
     void compute_transmitted_differentials(const float eta);
 
+    // Compute derivatives of the incoming direction of samples that are not related to the
+    // outgoing direction, such as diffusely transmitted or guided directions. The footprint
+    // is only widened according to the PDF of the sample.
+    void compute_diffuse_differentials();
+
+    // Return the spread of the derivatives of a direction sampled with a given PDF value.
+    static float get_pdf_spread(const float probability);
+
   private:
     void compute_normal_derivatives(
         foundation::Vector3f&       dndx,
@@ -96,6 +107,17 @@ inline BSDFSample::BSDFSample(
 {
 }
 
+inline float BSDFSample::get_pdf_spread(const float probability)
+{
+    //
+    // Reference:
+    //
+    //   https://renderman.pixar.com/resources/RenderMan_20/integratorRef.html#about-ray-differentials-ray-spreads
+    //
+
+    return 1.0f / (8.0f * std::sqrt(probability));
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_MODELING_BSDF_BSDFSAMPLE_H
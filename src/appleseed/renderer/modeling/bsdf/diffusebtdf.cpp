@@ -134,6 +134,8 @@ namespace
 
             // Set the scattering mode.
             sample.m_mode = ScatteringMode::Diffuse;
+
+            sample.compute_diffuse_differentials();
         }
 
         virtual float evaluate(
@@ -72,9 +72,9 @@ namespace
     //
     // Glossy BRDF.
     //
-    //    A future version of this BRDF will support multiple scattering.
-    //    For that reason, the only available microfacet distribution functions
-    //    are those that support it (Beckmann and GGX).
+    //    Energy lost to multiple scattering between microfacets can be compensated
+    //    for using precomputed albedo tables, which are only available for the
+    //    Beckmann and GGX microfacet distribution functions.
     //
     // References:
     //
@@ -95,12 +95,14 @@ namespace
             const char*             name,
             const ParamArray&       params)
           : BSDF(name, Reflective, ScatteringMode::Glossy | ScatteringMode::Specular, params)
+          , m_albedo_table(0)
         {
             m_inputs.declare("reflectance", InputFormatSpectralReflectance);
             m_inputs.declare("reflectance_multiplier", InputFormatFloat, "1.0");
             m_inputs.declare("roughness", InputFormatFloat, "0.15");
             m_inputs.declare("anisotropy", InputFormatFloat, "0.0");
             m_inputs.declare("ior", InputFormatFloat, "1.5");
+            m_inputs.declare("energy_compensation", InputFormatFloat, "0.0");
         }
 
         virtual void release() APPLESEED_OVERRIDE
@@ -126,6 +128,16 @@ namespace
             InputValues* values = static_cast<InputValues*>(data);
             new (&values->m_precomputed) InputValues::Precomputed();
             values->m_precomputed.m_outside_ior = shading_point.get_ray().get_current_ior();
+
+            if (values->m_energy_compensation > 0.0f)
+            {
+                // Precompute the average Fresnel reflectance.
+                const float eta = values->m_precomputed.m_outside_ior / values->m_ior;
+                const float f0 = square((eta - 1.0f) / (eta + 1.0f));
+                values->m_precomputed.m_average_fresnel = values->m_reflectance;
+                values->m_precomputed.m_average_fresnel *=
+                    MicrofacetBRDFHelper::average_fresnel_schlick(f0) * values->m_reflectance_multiplier;
+            }
         }
 
         virtual bool on_frame_begin(
@@ -153,6 +165,17 @@ namespace
                 m_mdf.reset(new BlinnMDF());
             else return false;
 
+            // Fetch the albedo tables only if energy compensation may be used.
+            m_albedo_table = 0;
+            const Source* energy_compensation = m_inputs.source("energy_compensation");
+            if (energy_compensation && !is_uniform_zero_scalar(energy_compensation))
+            {
+                if (mdf == "ggx")
+                    m_albedo_table = &get_ggx_albedo_table();
+                else if (mdf == "beckmann")
+                    m_albedo_table = &get_beckmann_albedo_table();
+            }
+
             return true;
         }
 
@@ -198,6 +221,21 @@ namespace
                 f,
                 cos_on,
                 sample);
+
+            if (m_albedo_table &&
+                values->m_energy_compensation > 0.0f &&
+                sample.m_mode == ScatteringMode::Glossy)
+            {
+                MicrofacetBRDFHelper::add_energy_compensation_term(
+                    *m_albedo_table,
+                    alpha_x,
+                    alpha_y,
+                    values->m_precomputed.m_average_fresnel,
+                    values->m_energy_compensation,
+                    dot(sample.m_incoming.get_value(), n),
+                    cos_on,
+                    sample.m_value);
+            }
         }
 
         virtual float evaluate(
@@ -235,17 +273,33 @@ namespace
                 values->m_reflectance_multiplier,
                 values->m_precomputed.m_outside_ior / values->m_ior);
 
-            return MicrofacetBRDFHelper::evaluate(
-                *m_mdf,
-                alpha_x,
-                alpha_y,
-                shading_basis,
-                outgoing,
-                incoming,
-                f,
-                cos_in,
-                cos_on,
-                value);
+            const float pdf =
+                MicrofacetBRDFHelper::evaluate(
+                    *m_mdf,
+                    alpha_x,
+                    alpha_y,
+                    shading_basis,
+                    outgoing,
+                    incoming,
+                    f,
+                    cos_in,
+                    cos_on,
+                    value);
+
+            if (m_albedo_table && values->m_energy_compensation > 0.0f)
+            {
+                MicrofacetBRDFHelper::add_energy_compensation_term(
+                    *m_albedo_table,
+                    alpha_x,
+                    alpha_y,
+                    values->m_precomputed.m_average_fresnel,
+                    values->m_energy_compensation,
+                    cos_in,
+                    cos_on,
+                    value);
+            }
+
+            return pdf;
         }
 
         virtual float evaluate_pdf(
@@ -287,7 +341,8 @@ namespace
       private:
         typedef GlossyBRDFInputValues InputValues;
 
-        auto_ptr<MDF> m_mdf;
+        auto_ptr<MDF>               m_mdf;
+        const MDFAlbedoTable*       m_albedo_table;
     };
 
     typedef BSDFWrapper<GlossyBRDFImpl> GlossyBRDF;
@@ -387,6 +442,18 @@ DictionaryArray GlossyBRDFFactory::get_input_metadata() const
             .insert("use", "required")
             .insert("default", "1.5"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "energy_compensation")
+            .insert("label", "Energy Compensation")
+            .insert("type", "colormap")
+            .insert("entity_types",
+                Dictionary().insert("texture_instance", "Textures"))
+            .insert("use", "optional")
+            .insert("min_value", "0.0")
+            .insert("max_value", "1.0")
+            .insert("default", "0.0"));
+
     return metadata;
 }
 
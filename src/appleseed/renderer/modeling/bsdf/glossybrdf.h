@@ -61,10 +61,12 @@ APPLESEED_DECLARE_INPUT_VALUES(GlossyBRDFInputValues)
     float       m_roughness;
     float       m_anisotropy;
     float       m_ior;
+    float       m_energy_compensation;
 
     struct Precomputed
     {
-        float   m_outside_ior;
+        float       m_outside_ior;
+        Spectrum    m_average_fresnel;
     };
 
     Precomputed m_precomputed;
@@ -71,9 +71,9 @@ namespace
     //
     // Metal BRDF.
     //
-    //    A future version of this BRDF will support multiple scattering.
-    //    For that reason, the only available microfacet distribution functions
-    //    are those that support it (Beckmann and GGX).
+    //    Energy lost to multiple scattering between microfacets can be compensated
+    //    for using precomputed albedo tables, which are only available for the
+    //    Beckmann and GGX microfacet distribution functions.
     //
     // References:
     //
@@ -99,12 +99,14 @@ namespace
             const char*             name,
             const ParamArray&       params)
           : BSDF(name, Reflective, ScatteringMode::Glossy | ScatteringMode::Specular, params)
+          , m_albedo_table(0)
         {
             m_inputs.declare("normal_reflectance", InputFormatSpectralReflectance);
             m_inputs.declare("edge_tint", InputFormatSpectralReflectance);
             m_inputs.declare("reflectance_multiplier", InputFormatFloat, "1.0");
             m_inputs.declare("roughness", InputFormatFloat, "0.15");
             m_inputs.declare("anisotropy", InputFormatFloat, "0.0");
+            m_inputs.declare("energy_compensation", InputFormatFloat, "0.0");
         }
 
         virtual void release() APPLESEED_OVERRIDE
@@ -135,6 +137,21 @@ namespace
                 values->m_edge_tint,
                 values->m_precomputed.m_n,
                 values->m_precomputed.m_k);
+
+            if (values->m_energy_compensation > 0.0f)
+            {
+                // Precompute the average Fresnel reflectance, approximating the
+                // conductor Fresnel term by Schlick's approximation.
+                const Spectrum& f0 = values->m_normal_reflectance;
+                Spectrum& favg = values->m_precomputed.m_average_fresnel;
+                favg.resize(f0.size());
+                for (size_t i = 0, e = f0.size(); i < e; ++i)
+                {
+                    favg[i] =
+                        MicrofacetBRDFHelper::average_fresnel_schlick(f0[i]) *
+                        values->m_reflectance_multiplier;
+                }
+            }
         }
 
         virtual bool on_frame_begin(
@@ -160,6 +177,17 @@ namespace
                 m_mdf.reset(new BeckmannMDF());
             else return false;
 
+            // Fetch the albedo tables only if energy compensation may be used.
+            m_albedo_table = 0;
+            const Source* energy_compensation = m_inputs.source("energy_compensation");
+            if (energy_compensation && !is_uniform_zero_scalar(energy_compensation))
+            {
+                if (mdf == "ggx")
+                    m_albedo_table = &get_ggx_albedo_table();
+                else if (mdf == "beckmann")
+                    m_albedo_table = &get_beckmann_albedo_table();
+            }
+
             return true;
         }
 
@@ -205,6 +233,21 @@ namespace
                 f,
                 cos_on,
                 sample);
+
+            if (m_albedo_table &&
+                values->m_energy_compensation > 0.0f &&
+                sample.m_mode == ScatteringMode::Glossy)
+            {
+                MicrofacetBRDFHelper::add_energy_compensation_term(
+                    *m_albedo_table,
+                    alpha_x,
+                    alpha_y,
+                    values->m_precomputed.m_average_fresnel,
+                    values->m_energy_compensation,
+                    dot(sample.m_incoming.get_value(), n),
+                    cos_on,
+                    sample.m_value);
+            }
         }
 
         virtual float evaluate(
@@ -242,17 +285,33 @@ namespace
                 values->m_precomputed.m_k,
                 values->m_reflectance_multiplier);
 
-            return MicrofacetBRDFHelper::evaluate(
-                *m_mdf,
-                alpha_x,
-                alpha_y,
-                shading_basis,
-                outgoing,
-                incoming,
-                f,
-                cos_in,
-                cos_on,
-                value);
+            const float pdf =
+                MicrofacetBRDFHelper::evaluate(
+                    *m_mdf,
+                    alpha_x,
+                    alpha_y,
+                    shading_basis,
+                    outgoing,
+                    incoming,
+                    f,
+                    cos_in,
+                    cos_on,
+                    value);
+
+            if (m_albedo_table && values->m_energy_compensation > 0.0f)
+            {
+                MicrofacetBRDFHelper::add_energy_compensation_term(
+                    *m_albedo_table,
+                    alpha_x,
+                    alpha_y,
+                    values->m_precomputed.m_average_fresnel,
+                    values->m_energy_compensation,
+                    cos_in,
+                    cos_on,
+                    value);
+            }
+
+            return pdf;
         }
 
         virtual float evaluate_pdf(
@@ -294,7 +353,8 @@ namespace
       private:
         typedef MetalBRDFInputValues InputValues;
 
-        auto_ptr<MDF> m_mdf;
+        auto_ptr<MDF>               m_mdf;
+        const MDFAlbedoTable*       m_albedo_table;
     };
 
     typedef BSDFWrapper<MetalBRDFImpl> MetalBRDF;
@@ -396,6 +456,18 @@ DictionaryArray MetalBRDFFactory::get_input_metadata() const
             .insert("max_value", "1.0")
             .insert("default", "0.0"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "energy_compensation")
+            .insert("label", "Energy Compensation")
+            .insert("type", "colormap")
+            .insert("entity_types",
+                Dictionary().insert("texture_instance", "Textures"))
+            .insert("use", "optional")
+            .insert("min_value", "0.0")
+            .insert("max_value", "1.0")
+            .insert("default", "0.0"));
+
     return metadata;
 }
 
@@ -61,11 +61,13 @@ APPLESEED_DECLARE_INPUT_VALUES(MetalBRDFInputValues)
     float       m_reflectance_multiplier;
     float       m_roughness;
     float       m_anisotropy;
+    float       m_energy_compensation;
 
     struct Precomputed
     {
         Spectrum m_n;
         Spectrum m_k;
+        Spectrum m_average_fresnel;
     };
 
     Precomputed m_precomputed;
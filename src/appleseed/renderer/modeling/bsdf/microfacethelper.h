@@ -38,12 +38,15 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/basis.h"
+#include "foundation/math/microfacet.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 
 // Standard headers.
 #include <algorithm>
+#include <cassert>
 #include <cmath>
+#include <cstddef>
 
 namespace renderer
 {
@@ -173,6 +176,50 @@ class MicrofacetBRDFHelper
                 alpha_x,
                 alpha_y) / (4.0f * cos_oh);
     }
+
+    // Return the average of Schlick's approximation of the Fresnel reflectance over
+    // the hemisphere, given the reflectance at normal incidence.
+    static float average_fresnel_schlick(const float f0)
+    {
+        return f0 + (1.0f - f0) * (1.0f / 21.0f);
+    }
+
+    // Add the multiple scattering term of Kulla and Conty that compensates for the energy
+    // lost by single scattering microfacet models on rough surfaces:
+    //
+    //   fms(o, i) = Fms * (1 - E(o)) * (1 - E(i)) / (pi * (1 - Eavg))
+    //   Fms = Favg^2 * Eavg / (1 - Favg * (1 - Eavg))
+    //
+    // where E and Eavg are the directional and average albedos of the MDF and Favg is
+    // the average Fresnel reflectance. 'weight' scales the compensation term.
+    static void add_energy_compensation_term(
+        const foundation::MDFAlbedoTable&   albedo_table,
+        const float                         alpha_x,
+        const float                         alpha_y,
+        const Spectrum&                     average_fresnel,
+        const float                         weight,
+        const float                         cos_in,
+        const float                         cos_on,
+        Spectrum&                           value)
+    {
+        assert(average_fresnel.size() == value.size());
+
+        const float alpha = std::sqrt(alpha_x * alpha_y);
+        const float eavg = albedo_table.get_average_albedo(alpha);
+        if (eavg >= 1.0f)
+            return;
+
+        const float eo = albedo_table.get_directional_albedo(cos_on, alpha);
+        const float ei = albedo_table.get_directional_albedo(cos_in, alpha);
+        const float fms =
+            weight * (1.0f - eo) * (1.0f - ei) / (foundation::Pi<float>() * (1.0f - eavg));
+
+        for (size_t i = 0, e = value.size(); i < e; ++i)
+        {
+            const float favg = average_fresnel[i];
+            value[i] += fms * foundation::square(favg) * eavg / (1.0f - favg * (1.0f - eavg));
+        }
+    }
 };
 
 }       // namespace renderer
@@ -0,0 +1,348 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "mixingbsdf.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/shading/shadingcontext.h"
+#include "renderer/modeling/bsdf/bsdfsample.h"
+#include "renderer/modeling/scene/assembly.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/arena.h"
+
+// Standard headers.
+#include <cassert>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Maximum nesting depth of mixing BSDFs; deeper trees are assumed to be cyclic.
+    const size_t MaxDepth = 32;
+
+    // Per-leaf values stored in the input block of a mixing BSDF.
+    struct LeafValues
+    {
+        const void*     m_inputs;       // input values of the leaf, null if its weight is zero
+        float           m_weight;       // combined weight of the leaf
+    };
+}
+
+
+//
+// MixingBSDF class implementation.
+//
+
+MixingBSDF::MixingBSDF(
+    const char*                 name,
+    const ParamArray&           params)
+  : BSDF(name, Reflective, ScatteringMode::All, params)
+{
+}
+
+bool MixingBSDF::on_frame_begin(
+    const Project&              project,
+    const BaseGroup*            parent,
+    OnFrameBeginRecorder&       recorder,
+    IAbortSwitch*               abort_switch)
+{
+    if (!BSDF::on_frame_begin(project, parent, recorder, abort_switch))
+        return false;
+
+    const Assembly* assembly = static_cast<const Assembly*>(parent);
+
+    m_nodes.clear();
+    m_leaves.clear();
+
+    return flatten(*assembly, *this, 0);
+}
+
+void* MixingBSDF::evaluate_inputs(
+    const ShadingContext&       shading_context,
+    const ShadingPoint&         shading_point) const
+{
+    assert(!m_nodes.empty());
+
+    Arena& arena = shading_context.get_arena();
+
+    const size_t node_count = m_nodes.size();
+    const size_t leaf_count = m_leaves.size();
+
+    LeafValues* values =
+        static_cast<LeafValues*>(arena.allocate(leaf_count * sizeof(LeafValues)));
+    float* node_weights =
+        static_cast<float*>(arena.allocate(node_count * sizeof(float)));
+
+    for (size_t i = 0; i < leaf_count; ++i)
+        values[i].m_weight = 0.0f;
+
+    for (size_t i = 1; i < node_count; ++i)
+        node_weights[i] = 0.0f;
+
+    // Nodes are stored in depth-first order, so a node's weight is final when it is reached.
+    node_weights[0] = 1.0f;
+    for (size_t i = 0; i < node_count; ++i)
+    {
+        const float node_weight = node_weights[i];
+        if (node_weight == 0.0f)
+            continue;
+
+        const Node& node = m_nodes[i];
+
+        // Only evaluate the node's own inputs; its children are handled separately.
+        const void* node_inputs =
+            node.m_bsdf->BSDF::evaluate_inputs(shading_context, shading_point);
+
+        float weights[2];
+        node.m_bsdf->compute_child_weights(node_inputs, weights);
+
+        for (size_t j = 0; j < 2; ++j)
+        {
+            if (weights[j] <= 0.0f)
+                continue;
+
+            const Child& child = node.m_children[j];
+            float& child_weight =
+                child.m_is_leaf
+                    ? values[child.m_index].m_weight
+                    : node_weights[child.m_index];
+
+            child_weight += node_weight * weights[j];
+        }
+    }
+
+    // Evaluate the inputs of the leaves that contribute at this shading point.
+    for (size_t i = 0; i < leaf_count; ++i)
+    {
+        values[i].m_inputs =
+            values[i].m_weight > 0.0f
+                ? m_leaves[i]->evaluate_inputs(shading_context, shading_point)
+                : 0;
+    }
+
+    return values;
+}
+
+void MixingBSDF::sample(
+    SamplingContext&            sampling_context,
+    const void*                 data,
+    const bool                  adjoint,
+    const bool                  cosine_mult,
+    BSDFSample&                 sample) const
+{
+    const LeafValues* values = static_cast<const LeafValues*>(data);
+
+    // Choose which leaf BSDF to sample.
+    sampling_context.split_in_place(1, 1);
+    const float s = sampling_context.next2<float>();
+
+    float cdf = 0.0f;
+    for (size_t i = 0, e = m_leaves.size(); i < e; ++i)
+    {
+        if (values[i].m_weight == 0.0f)
+            continue;
+
+        cdf += values[i].m_weight;
+
+        if (s < cdf)
+        {
+            // Sample the chosen BSDF.
+            m_leaves[i]->sample(
+                sampling_context,
+                values[i].m_inputs,
+                adjoint,
+                false,                      // do not multiply by |cos(incoming, normal)|
+                sample);
+            return;
+        }
+    }
+
+    // The remaining weight, if any, is absorbed.
+}
+
+float MixingBSDF::evaluate(
+    const void*                 data,
+    const bool                  adjoint,
+    const bool                  cosine_mult,
+    const Vector3f&             geometric_normal,
+    const Basis3f&              shading_basis,
+    const Vector3f&             outgoing,
+    const Vector3f&             incoming,
+    const int                   modes,
+    Spectrum&                   value) const
+{
+    const LeafValues* values = static_cast<const LeafValues*>(data);
+
+    value.set(0.0f);
+    float probability = 0.0f;
+
+    for (size_t i = 0, e = m_leaves.size(); i < e; ++i)
+    {
+        const float weight = values[i].m_weight;
+        if (weight == 0.0f)
+            continue;
+
+        Spectrum leaf_value;
+        const float leaf_prob =
+            m_leaves[i]->evaluate(
+                values[i].m_inputs,
+                adjoint,
+                false,                      // do not multiply by |cos(incoming, normal)|
+                geometric_normal,
+                shading_basis,
+                outgoing,
+                incoming,
+                modes,
+                leaf_value);
+
+        // Blend BSDF and PDF values.
+        if (leaf_prob > 0.0f)
+        {
+            madd(value, leaf_value, weight);
+            probability += leaf_prob * weight;
+        }
+    }
+
+    return probability;
+}
+
+float MixingBSDF::evaluate_pdf(
+    const void*                 data,
+    const Vector3f&             geometric_normal,
+    const Basis3f&              shading_basis,
+    const Vector3f&             outgoing,
+    const Vector3f&             incoming,
+    const int                   modes) const
+{
+    const LeafValues* values = static_cast<const LeafValues*>(data);
+
+    float probability = 0.0f;
+
+    for (size_t i = 0, e = m_leaves.size(); i < e; ++i)
+    {
+        const float weight = values[i].m_weight;
+        if (weight == 0.0f)
+            continue;
+
+        probability +=
+            weight *
+            m_leaves[i]->evaluate_pdf(
+                values[i].m_inputs,
+                geometric_normal,
+                shading_basis,
+                outgoing,
+                incoming,
+                modes);
+    }
+
+    return probability;
+}
+
+bool MixingBSDF::flatten(
+    const Assembly&             assembly,
+    const MixingBSDF&           bsdf,
+    const size_t                depth)
+{
+    if (depth > MaxDepth)
+    {
+        RENDERER_LOG_ERROR(
+            "while preparing bsdf \"%s\": bsdf \"%s\" is nested too deeply or references itself.",
+            get_path().c_str(),
+            bsdf.get_path().c_str());
+        return false;
+    }
+
+    const size_t node_index = m_nodes.size();
+    m_nodes.push_back(Node());
+    m_nodes[node_index].m_bsdf = &bsdf;
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        const BSDF* child_bsdf = bsdf.retrieve_child(assembly, i == 0 ? "bsdf0" : "bsdf1");
+        if (child_bsdf == 0)
+            return false;
+
+        Child& child = m_nodes[node_index].m_children[i];
+
+        const MixingBSDF* mixing_child = dynamic_cast<const MixingBSDF*>(child_bsdf);
+        if (mixing_child)
+        {
+            child.m_is_leaf = false;
+            child.m_index = m_nodes.size();
+
+            if (!flatten(assembly, *mixing_child, depth + 1))
+                return false;
+        }
+        else
+        {
+            // A BSDF reachable through several paths gets a single leaf.
+            size_t leaf_index = 0;
+            while (leaf_index < m_leaves.size() && m_leaves[leaf_index] != child_bsdf)
+                ++leaf_index;
+
+            if (leaf_index == m_leaves.size())
+                m_leaves.push_back(child_bsdf);
+
+            child.m_is_leaf = true;
+            child.m_index = leaf_index;
+        }
+    }
+
+    return true;
+}
+
+const BSDF* MixingBSDF::retrieve_child(
+    const Assembly&             assembly,
+    const char*                 param_name) const
+{
+    const string bsdf_name = m_params.get_required<string>(param_name, "");
+    if (bsdf_name.empty())
+    {
+        RENDERER_LOG_ERROR("while preparing bsdf \"%s\": no bsdf bound to \"%s\".", get_path().c_str(), param_name);
+        return 0;
+    }
+
+    const BSDF* bsdf = assembly.bsdfs().get_by_name(bsdf_name.c_str());
+    if (bsdf == 0)
+        RENDERER_LOG_ERROR("while preparing bsdf \"%s\": cannot find bsdf \"%s\".", get_path().c_str(), bsdf_name.c_str());
+
+    return bsdf;
+}
+
+}   // namespace renderer
@@ -0,0 +1,150 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_MODELING_BSDF_MIXINGBSDF_H
+#define APPLESEED_RENDERER_MODELING_BSDF_MIXINGBSDF_H
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/bsdf/bsdf.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/basis.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class Assembly; }
+namespace renderer      { class BaseGroup; }
+namespace renderer      { class BSDFSample; }
+namespace renderer      { class OnFrameBeginRecorder; }
+namespace renderer      { class ParamArray; }
+namespace renderer      { class Project; }
+namespace renderer      { class ShadingContext; }
+namespace renderer      { class ShadingPoint; }
+
+namespace renderer
+{
+
+//
+// Base class for BSDFs that combine two child BSDFs bound to the "bsdf0" and
+// "bsdf1" parameters, such as bsdf_mix and bsdf_blend.
+//
+// At frame begin, the tree formed by nested mixing BSDFs is flattened into a
+// linear list of leaf BSDFs. At shading time, the weights of all mixing nodes
+// are combined into one weight per leaf, and leaves are evaluated or sampled
+// in a single pass instead of recursing through every level of the tree.
+//
+
+class MixingBSDF
+  : public BSDF
+{
+  public:
+    // Constructor.
+    MixingBSDF(
+        const char*                 name,
+        const ParamArray&           params);
+
+    virtual bool on_frame_begin(
+        const Project&              project,
+        const BaseGroup*            parent,
+        OnFrameBeginRecorder&       recorder,
+        foundation::IAbortSwitch*   abort_switch = 0) APPLESEED_OVERRIDE;
+
+    virtual void* evaluate_inputs(
+        const ShadingContext&       shading_context,
+        const ShadingPoint&         shading_point) const APPLESEED_OVERRIDE;
+
+    virtual void sample(
+        SamplingContext&            sampling_context,
+        const void*                 data,
+        const bool                  adjoint,
+        const bool                  cosine_mult,
+        BSDFSample&                 sample) const APPLESEED_OVERRIDE;
+
+    virtual float evaluate(
+        const void*                 data,
+        const bool                  adjoint,
+        const bool                  cosine_mult,
+        const foundation::Vector3f& geometric_normal,
+        const foundation::Basis3f&  shading_basis,
+        const foundation::Vector3f& outgoing,
+        const foundation::Vector3f& incoming,
+        const int                   modes,
+        Spectrum&                   value) const APPLESEED_OVERRIDE;
+
+    virtual float evaluate_pdf(
+        const void*                 data,
+        const foundation::Vector3f& geometric_normal,
+        const foundation::Basis3f&  shading_basis,
+        const foundation::Vector3f& outgoing,
+        const foundation::Vector3f& incoming,
+        const int                   modes) const APPLESEED_OVERRIDE;
+
+  protected:
+    // Compute the weights of the two child BSDFs given the input values of
+    // this BSDF. The weights must sum to one, or both be zero for absorption.
+    virtual void compute_child_weights(
+        const void*                 inputs,
+        float                       weights[2]) const = 0;
+
+  private:
+    struct Child
+    {
+        bool    m_is_leaf;
+        size_t  m_index;                // index of the leaf or of the node
+    };
+
+    struct Node
+    {
+        const MixingBSDF*   m_bsdf;
+        Child               m_children[2];
+    };
+
+    std::vector<Node>           m_nodes;        // mixing nodes in depth-first order, starting with this BSDF
+    std::vector<const BSDF*>    m_leaves;       // distinct leaf BSDFs
+
+    bool flatten(
+        const Assembly&             assembly,
+        const MixingBSDF&           bsdf,
+        const size_t                depth);
+
+    const BSDF* retrieve_child(
+        const Assembly&             assembly,
+        const char*                 param_name) const;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_MODELING_BSDF_MIXINGBSDF_H
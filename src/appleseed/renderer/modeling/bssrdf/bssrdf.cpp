@@ -81,6 +81,8 @@ void* BSSRDF::evaluate_inputs(
     get_inputs().evaluate(
         shading_context.get_texture_cache(),
         shading_point.get_uv(0),
+        shading_point.get_duvdx(0),
+        shading_point.get_duvdy(0),
         data);
 
     prepare_inputs(
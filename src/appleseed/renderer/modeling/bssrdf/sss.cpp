@@ -192,32 +192,49 @@ float normalized_diffusion_profile(
 
 namespace
 {
-    const size_t NDCDFTableSize = 128;
+    //
+    // Since cdf(r, d) == cdf(r/d, 1), a single table of the inverse of cdf(r, 1) serves
+    // all materials and all channels. The table is indexed by u, so sampling the profile
+    // only requires a table lookup followed by (usually at most) one Newton refinement
+    // step instead of a binary search followed by a root search over a wide interval.
+    //
+
+    const size_t NDInvCDFTableSize = 1024;
     const float NDCDFTableRmax = 55.0f;
-    const float NDCDFTableStep = NDCDFTableRmax / NDCDFTableSize;
 
-    float nd_cdf_table[NDCDFTableSize];
+    float nd_inv_cdf_table[NDInvCDFTableSize];
     float nd_cdf_rmax;
 
-    struct InitializeNDCDFTable
+    // Invert cdf(r, 1) analytically. With t = exp(-r/3), cdf(r, 1) = u is the cubic
+    // t^3 + 3t - 4(1 - u) = 0 which has a single real root given by Cardano's formula.
+    double normalized_diffusion_inverse_cdf(const double u)
     {
-        InitializeNDCDFTable()
+        const double w = 2.0 * (1.0 - u);
+        const double a = pow(w + sqrt(w * w + 1.0), 1.0 / 3.0);
+        const double t = a - 1.0 / a;
+        return t > 0.0 ? -3.0 * log(t) : NDCDFTableRmax;
+    }
+
+    struct InitializeNDInvCDFTable
+    {
+        InitializeNDInvCDFTable()
         {
-            for (size_t i = 0; i < NDCDFTableSize; ++i)
+            nd_cdf_rmax = normalized_diffusion_cdf(NDCDFTableRmax, 1.0f);
+
+            for (size_t i = 0; i < NDInvCDFTableSize; ++i)
             {
-                const float r = fit<size_t, float>(i, 0, NDCDFTableSize - 1, 0.0f, NDCDFTableRmax);
-                nd_cdf_table[i] = normalized_diffusion_cdf(r, 1.0f);
+                const double u = fit<size_t, double>(i, 0, NDInvCDFTableSize - 1, 0.0, nd_cdf_rmax);
+                nd_inv_cdf_table[i] =
+                    min(static_cast<float>(normalized_diffusion_inverse_cdf(u)), NDCDFTableRmax);
             }
 
-            // Save the real value of cdf(Rmax, 1).
-            nd_cdf_rmax = nd_cdf_table[NDCDFTableSize - 1];
-
-            // Make sure the last value is exactly 1.
-            nd_cdf_table[NDCDFTableSize - 1] = 1.0f;
+            // Make sure the table spans exactly [0, Rmax].
+            nd_inv_cdf_table[0] = 0.0f;
+            nd_inv_cdf_table[NDInvCDFTableSize - 1] = NDCDFTableRmax;
         }
     };
 
-    InitializeNDCDFTable initialize_nd_cdf_table;
+    InitializeNDInvCDFTable initialize_nd_inv_cdf_table;
 
     struct NDCDFFun
     {
@@ -266,15 +283,16 @@ float normalized_diffusion_sample(
     if (u >= nd_cdf_rmax)
         return NDCDFTableRmax * d;
 
-    // Use the CDF to find an initial interval for the root of cdf(r, 1) - u = 0.
-    const size_t i = sample_cdf(nd_cdf_table, nd_cdf_table + NDCDFTableSize, u);
-    assert(i > 0);
-    assert(nd_cdf_table[i - 1] <= u);
-    assert(nd_cdf_table[i] > u);
+    // Look up the bracketing entries of the inverse CDF table and interpolate between them.
+    const float x = u * ((NDInvCDFTableSize - 1) / nd_cdf_rmax);
+    const size_t i = min(truncate<size_t>(x), NDInvCDFTableSize - 2);
+    const float r0 = nd_inv_cdf_table[i];
+    const float r1 = nd_inv_cdf_table[i + 1];
 
     // Transform the cdf(r, 1) interval to cdf(r, d) using the fact that cdf(r, d) == cdf(r/d, 1).
-    const float rmin = fit<size_t, float>(i - 1, 0, NDCDFTableSize - 1, 0.0f, NDCDFTableRmax) * d;
-    const float rmax = fit<size_t, float>(i,     0, NDCDFTableSize - 1, 0.0f, NDCDFTableRmax) * d;
+    const float rmin = r0 * d;
+    const float rmax = r1 * d;
+    const float guess = lerp(r0, r1, x - static_cast<float>(i)) * d;
 
     return invert_cdf_function(
         NDCDFFun(d),
@@ -282,7 +300,7 @@ float normalized_diffusion_sample(
         u,
         rmin,
         rmax,
-        (rmax + rmin) * 0.5f,
+        guess,
         eps,
         max_iterations);
 }
@@ -107,6 +107,16 @@ bool Camera::on_frame_begin(
     return true;
 }
 
+void Camera::spawn_rays(
+    const size_t            ray_count,
+    SamplingContext*        sampling_contexts,
+    const Dual2d*           ndcs,
+    ShadingRay*             rays) const
+{
+    for (size_t i = 0; i < ray_count; ++i)
+        spawn_ray(sampling_contexts[i], ndcs[i], rays[i]);
+}
+
 bool Camera::project_point(
     const float             time,
     const Vector3d&         point,
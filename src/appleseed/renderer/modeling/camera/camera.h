@@ -44,6 +44,9 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation    { class DictionaryArray; }
 namespace foundation    { class IAbortSwitch; }
@@ -118,6 +121,15 @@ class APPLESEED_DLLSYMBOL Camera
         const foundation::Dual2d&       ndc,
         ShadingRay&                     ray) const = 0;
 
+    // Generate a batch of rays, one per sampling context and point on the film plane.
+    // The default implementation calls spawn_ray() for each ray; camera models override
+    // it to compute the work shared by all rays of the batch only once.
+    virtual void spawn_rays(
+        const size_t                    ray_count,
+        SamplingContext*                sampling_contexts,
+        const foundation::Dual2d*       ndcs,
+        ShadingRay*                     rays) const;
+
     // Connect a vertex to the camera and return the direction vector from the
     // point to the camera, the normalized device coordinates of the projected
     // point on the camera film and the emitted importance. The direction vector
@@ -155,6 +155,55 @@ namespace
             }
         }
 
+        virtual void spawn_rays(
+            const size_t        ray_count,
+            SamplingContext*    sampling_contexts,
+            const Dual2d*       ndcs,
+            ShadingRay*         rays) const APPLESEED_OVERRIDE
+        {
+            // The transform of a moving camera depends on the time of each ray.
+            if (m_transform_sequence.size() > 1)
+            {
+                Camera::spawn_rays(ray_count, sampling_contexts, ndcs, rays);
+                return;
+            }
+
+            const Transformd& transform = m_transform_sequence.get_earliest_transform();
+
+            // All rays share the same direction and the world space origin of a ray is an affine
+            // function of its film point: compute it once for the batch as o0 + ndc.x * ox + ndc.y * oy.
+            const Vector3d dir = normalize(transform.vector_to_parent(Vector3d(0.0, 0.0, -1.0)));
+            const Vector3d o0 = transform.point_to_parent(ndc_to_camera(Vector2d(0.0, 0.0)));
+            const Vector3d ox = transform.point_to_parent(ndc_to_camera(Vector2d(1.0, 0.0))) - o0;
+            const Vector3d oy = transform.point_to_parent(ndc_to_camera(Vector2d(0.0, 1.0))) - o0;
+
+            for (size_t i = 0; i < ray_count; ++i)
+            {
+                const Dual2d& ndc = ndcs[i];
+                ShadingRay& ray = rays[i];
+
+                initialize_ray(sampling_contexts[i], ray);
+
+                const Vector2d& p = ndc.get_value();
+                ray.m_org = o0 + p.x * ox + p.y * oy;
+                ray.m_dir = dir;
+
+                if (ndc.has_derivatives())
+                {
+                    const Vector2d px(p + ndc.get_dx());
+                    const Vector2d py(p + ndc.get_dy());
+
+                    ray.m_rx.m_org = o0 + px.x * ox + px.y * oy;
+                    ray.m_ry.m_org = o0 + py.x * ox + py.y * oy;
+
+                    ray.m_rx.m_dir = dir;
+                    ray.m_ry.m_dir = dir;
+
+                    ray.m_has_differentials = true;
+                }
+            }
+        }
+
         virtual bool connect_vertex(
             SamplingContext&    sampling_context,
             const float         time,
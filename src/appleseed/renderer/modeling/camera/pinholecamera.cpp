@@ -186,6 +186,52 @@ namespace
             }
         }
 
+        virtual void spawn_rays(
+            const size_t        ray_count,
+            SamplingContext*    sampling_contexts,
+            const Dual2d*       ndcs,
+            ShadingRay*         rays) const APPLESEED_OVERRIDE
+        {
+            // The transform of a moving camera depends on the time of each ray.
+            if (m_transform_sequence.size() > 1)
+            {
+                Camera::spawn_rays(ray_count, sampling_contexts, ndcs, rays);
+                return;
+            }
+
+            const Transformd& transform = m_transform_sequence.get_earliest_transform();
+
+            // The unnormalized world space direction of a ray is an affine function of its
+            // film point: compute it once for the batch as d0 + ndc.x * dx + ndc.y * dy.
+            const Vector3d org = transform.get_local_to_parent().extract_translation();
+            const Vector3d d0 = transform.vector_to_parent(-ndc_to_camera(Vector2d(0.0, 0.0)));
+            const Vector3d dx = transform.vector_to_parent(-ndc_to_camera(Vector2d(1.0, 0.0))) - d0;
+            const Vector3d dy = transform.vector_to_parent(-ndc_to_camera(Vector2d(0.0, 1.0))) - d0;
+
+            for (size_t i = 0; i < ray_count; ++i)
+            {
+                const Dual2d& ndc = ndcs[i];
+                ShadingRay& ray = rays[i];
+
+                initialize_ray(sampling_contexts[i], ray);
+
+                const Vector2d& p = ndc.get_value();
+                ray.m_org = org;
+                ray.m_dir = normalize(d0 + p.x * dx + p.y * dy);
+
+                if (ndc.has_derivatives())
+                {
+                    const Vector2d px(p + ndc.get_dx());
+                    const Vector2d py(p + ndc.get_dy());
+                    ray.m_rx.m_org = org;
+                    ray.m_ry.m_org = org;
+                    ray.m_rx.m_dir = normalize(d0 + px.x * dx + px.y * dy);
+                    ray.m_ry.m_dir = normalize(d0 + py.x * dx + py.y * dy);
+                    ray.m_has_differentials = true;
+                }
+            }
+        }
+
         virtual bool connect_vertex(
             SamplingContext&    sampling_context,
             const float         time,
@@ -140,6 +140,49 @@ namespace
             }
         }
 
+        virtual void spawn_rays(
+            const size_t        ray_count,
+            SamplingContext*    sampling_contexts,
+            const Dual2d*       ndcs,
+            ShadingRay*         rays) const APPLESEED_OVERRIDE
+        {
+            // The transform of a moving camera depends on the time of each ray.
+            if (m_transform_sequence.size() > 1)
+            {
+                Camera::spawn_rays(ray_count, sampling_contexts, ndcs, rays);
+                return;
+            }
+
+            // Directions are not an affine function of film points: only the transform is shared.
+            const Transformd& transform = m_transform_sequence.get_earliest_transform();
+            const Vector3d org = transform.get_local_to_parent().extract_translation();
+
+            for (size_t i = 0; i < ray_count; ++i)
+            {
+                const Dual2d& ndc = ndcs[i];
+                ShadingRay& ray = rays[i];
+
+                initialize_ray(sampling_contexts[i], ray);
+
+                ray.m_org = org;
+                ray.m_dir = normalize(transform.vector_to_parent(ndc_to_camera(ndc.get_value())));
+
+                if (ndc.has_derivatives())
+                {
+                    const Vector2d px(ndc.get_value() + ndc.get_dx());
+                    const Vector2d py(ndc.get_value() + ndc.get_dy());
+
+                    ray.m_rx.m_org = org;
+                    ray.m_ry.m_org = org;
+
+                    ray.m_rx.m_dir = normalize(transform.vector_to_parent(ndc_to_camera(px)));
+                    ray.m_ry.m_dir = normalize(transform.vector_to_parent(ndc_to_camera(py)));
+
+                    ray.m_has_differentials = true;
+                }
+            }
+        }
+
         virtual bool connect_vertex(
             SamplingContext&    sampling_context,
             const float         time,
@@ -322,6 +322,64 @@ namespace
             }
         }
 
+        virtual void spawn_rays(
+            const size_t            ray_count,
+            SamplingContext*        sampling_contexts,
+            const Dual2d*           ndcs,
+            ShadingRay*             rays) const APPLESEED_OVERRIDE
+        {
+            // The transform of a moving camera depends on the time of each ray.
+            if (m_transform_sequence.size() > 1)
+            {
+                Camera::spawn_rays(ray_count, sampling_contexts, ndcs, rays);
+                return;
+            }
+
+            const Transformd& transform = m_transform_sequence.get_earliest_transform();
+
+            // The world space focal point of a film point and the world space lens point of a
+            // lens sample are affine functions of their coordinates: compute them once for the
+            // batch as f0 + ndc.x * fx + ndc.y * fy and l0 + lens.x * lx + lens.y * ly.
+            const Vector3d f0 = transform.point_to_parent(-m_focal_ratio * ndc_to_camera(Vector2d(0.0, 0.0)));
+            const Vector3d fx = transform.point_to_parent(-m_focal_ratio * ndc_to_camera(Vector2d(1.0, 0.0))) - f0;
+            const Vector3d fy = transform.point_to_parent(-m_focal_ratio * ndc_to_camera(Vector2d(0.0, 1.0))) - f0;
+            const Vector3d l0 = transform.get_local_to_parent().extract_translation();
+            const Vector3d lx = transform.vector_to_parent(Vector3d(1.0, 0.0, 0.0));
+            const Vector3d ly = transform.vector_to_parent(Vector3d(0.0, 1.0, 0.0));
+
+            for (size_t i = 0; i < ray_count; ++i)
+            {
+                const Dual2d& ndc = ndcs[i];
+                ShadingRay& ray = rays[i];
+
+                initialize_ray(sampling_contexts[i], ray);
+
+                // Compute lens point in world space.
+                const Vector3d lens_sample = sample_lens(sampling_contexts[i]);
+                const Vector3d lens_point = l0 + lens_sample.x * lx + lens_sample.y * ly;
+
+                // Compute ray origin and direction.
+                const Vector2d& p = ndc.get_value();
+                ray.m_org = lens_point;
+                ray.m_dir = normalize(f0 + p.x * fx + p.y * fy - lens_point);
+
+                // Compute ray derivatives.
+                if (ndc.has_derivatives())
+                {
+                    const Vector2d px(p + ndc.get_dx());
+                    const Vector2d py(p + ndc.get_dy());
+
+                    ray.m_rx.m_org = lens_point;
+                    ray.m_ry.m_org = lens_point;
+
+                    ray.m_rx.m_dir = normalize(f0 + px.x * fx + px.y * fy - lens_point);
+                    ray.m_ry.m_dir = normalize(f0 + py.x * fx + py.y * fy - lens_point);
+
+                    ray.m_has_differentials = true;
+                }
+            }
+        }
+
         virtual bool connect_vertex(
             SamplingContext&        sampling_context,
             const float             time,
@@ -48,8 +48,8 @@ namespace renderer
 // Range of wavelengths used throughout the light simulation.
 //
 
-Spectrum g_light_wavelengths_nm;
-Spectrum g_light_wavelengths_um;
+RegularSpectrum31f g_light_wavelengths_nm;
+RegularSpectrum31f g_light_wavelengths_um;
 
 namespace
 {
@@ -57,11 +57,10 @@ namespace
     {
         InitializeLightWavelengths()
         {
-            g_light_wavelengths_nm.resize(Spectrum::Samples);
             generate_wavelengths(
                 LowWavelength,
                 HighWavelength,
-                Spectrum::Samples,
+                RegularSpectrum31f::Samples,
                 &g_light_wavelengths_nm[0]);
 
             g_light_wavelengths_um = g_light_wavelengths_nm / 1000.0f;
@@ -121,7 +120,7 @@ void spectral_values_to_spectrum(
         input_spectrum_count,
         &wavelengths[0],
         input_spectrum,
-        Spectrum::Samples,
+        RegularSpectrum31f::Samples,
         &g_light_wavelengths_nm[0],
         output_spectrum);
 }
@@ -33,6 +33,9 @@
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
 
+// appleseed.foundation headers.
+#include "foundation/image/regularspectrum.h"
+
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
@@ -48,8 +51,8 @@ namespace renderer
 
 const float LowWavelength = 400.0f;         // low wavelength, in nm
 const float HighWavelength = 700.0f;        // high wavelength, in nm
-extern Spectrum g_light_wavelengths_nm;     // wavelengths, in nm
-extern Spectrum g_light_wavelengths_um;     // wavelengths, in um
+extern foundation::RegularSpectrum31f g_light_wavelengths_nm;   // wavelengths, in nm
+extern foundation::RegularSpectrum31f g_light_wavelengths_um;   // wavelengths, in um
 
 
 //
@@ -33,8 +33,13 @@
 // appleseed.foundation headers.
 #include "foundation/utility/foreach.h"
 
+// Boost headers.
+#include "boost/functional/hash.hpp"
+#include "boost/unordered_map.hpp"
+
 // Standard headers.
 #include <cassert>
+#include <cstring>
 #include <map>
 
 using namespace foundation;
@@ -43,10 +48,42 @@ using namespace std;
 namespace renderer
 {
 
+namespace
+{
+    // Hash and equality functors accepting both std::string and C string names,
+    // allowing lookups by C string without constructing an std::string.
+
+    struct NameHash
+    {
+        size_t operator()(const char* name) const
+        {
+            return boost::hash_range(name, name + strlen(name));
+        }
+
+        size_t operator()(const string& name) const
+        {
+            return operator()(name.c_str());
+        }
+    };
+
+    struct NameEqual
+    {
+        bool operator()(const string& lhs, const string& rhs) const
+        {
+            return lhs == rhs;
+        }
+
+        bool operator()(const char* lhs, const string& rhs) const
+        {
+            return rhs == lhs;
+        }
+    };
+}
+
 struct EntityMap::Impl
 {
     typedef map<UniqueID, Entity*> Storage;
-    typedef map<string, Entity*> Index;
+    typedef boost::unordered_map<string, Entity*, NameHash, NameEqual> Index;
 
     Storage m_storage;
     Index   m_index;
@@ -311,7 +348,7 @@ Entity* EntityMap::get_by_uid(const UniqueID id) const
 Entity* EntityMap::get_by_name(const char* name) const
 {
     assert(name);
-    const Impl::Index::iterator it = impl->m_index.find(name);
+    const Impl::Index::iterator it = impl->m_index.find(name, NameHash(), NameEqual());
     return it == impl->m_index.end() ? 0 : it->second;
 }
 
@@ -32,6 +32,9 @@
 // appleseed.renderer headers.
 #include "renderer/modeling/entity/entity.h"
 
+// appleseed.foundation headers.
+#include "foundation/platform/thread.h"
+
 // Standard headers.
 #include <cassert>
 #include <stack>
@@ -49,7 +52,8 @@ struct OnFrameBeginRecorder::Impl
         const BaseGroup*    m_parent;
     };
 
-    stack<Record> m_records;
+    boost::mutex    m_mutex;
+    stack<Record>   m_records;
 };
 
 OnFrameBeginRecorder::OnFrameBeginRecorder()
@@ -68,6 +72,8 @@ void OnFrameBeginRecorder::record(Entity* entity, const BaseGroup* parent)
     Impl::Record record;
     record.m_entity = entity;
     record.m_parent = parent;
+
+    boost::lock_guard<boost::mutex> lock(impl->m_mutex);
     impl->m_records.push(record);
 }
 
@@ -81,4 +87,10 @@ void OnFrameBeginRecorder::on_frame_end(const Project& project)
     }
 }
 
+void OnFrameBeginRecorder::discard()
+{
+    while (!impl->m_records.empty())
+        impl->m_records.pop();
+}
+
 }   // namespace renderer
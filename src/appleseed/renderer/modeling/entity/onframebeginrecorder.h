@@ -44,6 +44,9 @@ namespace renderer
 // Keep tracks of which entity we have called on_frame_begin() on,
 // and allows to call on_frame_end() on all those entities, in reverse order.
 //
+// record() may be called concurrently from multiple threads. Entities recorded
+// by the same thread are guaranteed to be ended in reverse order of recording.
+//
 
 class APPLESEED_DLLSYMBOL OnFrameBeginRecorder
 {
@@ -54,6 +57,9 @@ class APPLESEED_DLLSYMBOL OnFrameBeginRecorder
     void record(Entity* entity, const BaseGroup* parent);
     void on_frame_end(const Project& project);
 
+    // Forget the recorded entities without calling on_frame_end() on them.
+    void discard();
+
   private:
     struct Impl;
     Impl* impl;
@@ -0,0 +1,161 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "parallelonframebegin.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/entity/entity.h"
+#include "renderer/utility/startupprofiler.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/system.h"
+#include "foundation/platform/timers.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/eventtracer.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/stopwatch.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    bool timed_on_frame_begin(
+        const Project&          project,
+        const BaseGroup*        parent,
+        Entity&                 entity,
+        OnFrameBeginRecorder&   recorder,
+        IAbortSwitch*           abort_switch)
+    {
+        EventTraceScope trace_scope("preparation", "entity preparation", entity.get_name());
+
+        Stopwatch<DefaultWallclockTimer> stopwatch(0);
+        stopwatch.start();
+
+        const bool success = entity.on_frame_begin(project, parent, recorder, abort_switch);
+
+        stopwatch.measure();
+        global_startup_profiler().record_entity(
+            "entity preparation",
+            entity.get_path().c_str(),
+            stopwatch.get_seconds());
+
+        return success;
+    }
+
+    class OnFrameBeginJob
+      : public IJob
+    {
+      public:
+        OnFrameBeginJob(
+            const Project&          project,
+            const BaseGroup*        parent,
+            Entity&                 entity,
+            OnFrameBeginRecorder&   recorder,
+            IAbortSwitch*           abort_switch,
+            uint8&                  success)
+          : m_project(project)
+          , m_parent(parent)
+          , m_entity(entity)
+          , m_recorder(recorder)
+          , m_abort_switch(abort_switch)
+          , m_success(success)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            if (!is_aborted(m_abort_switch))
+                m_success = timed_on_frame_begin(m_project, m_parent, m_entity, m_recorder, m_abort_switch) ? 1 : 0;
+        }
+
+      private:
+        const Project&              m_project;
+        const BaseGroup*            m_parent;
+        Entity&                     m_entity;
+        OnFrameBeginRecorder&       m_recorder;
+        IAbortSwitch*               m_abort_switch;
+        uint8&                      m_success;
+    };
+}
+
+bool parallel_on_frame_begin(
+    const Project&                  project,
+    const BaseGroup*                parent,
+    const vector<Entity*>&          entities,
+    OnFrameBeginRecorder&           recorder,
+    IAbortSwitch*                   abort_switch)
+{
+    const size_t entity_count = entities.size();
+
+    // Spawning worker threads is not worth it for a single entity.
+    if (entity_count < 2)
+    {
+        if (entity_count == 0 || is_aborted(abort_switch))
+            return true;
+
+        return timed_on_frame_begin(project, parent, *entities[0], recorder, abort_switch);
+    }
+
+    // Entities whose job was aborted or terminated by an exception count as failures.
+    vector<uint8> success(entity_count, 0);
+
+    JobQueue job_queue;
+    for (size_t i = 0; i < entity_count; ++i)
+    {
+        job_queue.schedule(
+            new OnFrameBeginJob(project, parent, *entities[i], recorder, abort_switch, success[i]));
+    }
+
+    JobManager job_manager(
+        global_logger(),
+        job_queue,
+        min(System::get_available_cpu_core_count(), entity_count));
+
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    if (is_aborted(abort_switch))
+        return true;
+
+    return find(success.begin(), success.end(), 0) == success.end();
+}
+
+}   // namespace renderer
@@ -0,0 +1,64 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_MODELING_ENTITY_PARALLELONFRAMEBEGIN_H
+#define APPLESEED_RENDERER_MODELING_ENTITY_PARALLELONFRAMEBEGIN_H
+
+// Standard headers.
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class BaseGroup; }
+namespace renderer      { class Entity; }
+namespace renderer      { class OnFrameBeginRecorder; }
+namespace renderer      { class Project; }
+
+namespace renderer
+{
+
+//
+// Invoke on_frame_begin() on a set of mutually independent entities, concurrently
+// when there is more than one of them. Return true if all invocations succeeded.
+//
+// Unlike a serial invocation, a failure does not prevent on_frame_begin() from being
+// called on the remaining entities; all of them are recorded in the recorder either way.
+//
+
+bool parallel_on_frame_begin(
+    const Project&                  project,
+    const BaseGroup*                parent,
+    const std::vector<Entity*>&     entities,
+    OnFrameBeginRecorder&           recorder,
+    foundation::IAbortSwitch*       abort_switch);
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_MODELING_ENTITY_PARALLELONFRAMEBEGIN_H
@@ -31,9 +31,11 @@
 #include "hosekenvironmentedf.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/environmentedf/skytable.h"
 #include "renderer/modeling/environmentedf/sphericalcoordinates.h"
 #include "renderer/modeling/input/inputarray.h"
 #include "renderer/modeling/input/source.h"
@@ -49,6 +51,8 @@
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
 
@@ -57,6 +61,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <memory>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
@@ -155,6 +160,26 @@ namespace
                     m_uniform_master_Y);
             }
 
+            // Optionally bake the sky into a table, only when the sky has changed since the last bake.
+            const bool tabulate = m_params.get_optional<bool>("tabulate", false);
+            if (tabulate && m_uniform_turbidity && m_uniform_values.m_luminance_multiplier > 0.0f)
+            {
+                const size_t width = max(m_params.get_optional<size_t>("table_resolution", 1024), size_t(2));
+                if (!is_sky_table_up_to_date(width))
+                    bake_sky_table(width);
+            }
+            else
+            {
+                if (tabulate && !m_uniform_turbidity)
+                {
+                    RENDERER_LOG_WARNING(
+                        "cannot tabulate environment edf \"%s\" because its turbidity is not uniform.",
+                        get_path().c_str());
+                }
+
+                m_sky_table.reset();
+            }
+
             return true;
         }
 
@@ -165,10 +190,19 @@ namespace
             Spectrum&               value,
             float&                  probability) const APPLESEED_OVERRIDE
         {
-            const Vector3f local_outgoing = sample_hemisphere_cosine(s);
-
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
+
+            if (m_sky_table.get())
+            {
+                Vector3f local_outgoing;
+                m_sky_table->sample(s, local_outgoing, probability);
+                outgoing = transform.vector_to_parent(local_outgoing);
+                m_sky_table->lookup(local_outgoing, value);
+                return;
+            }
+
+            const Vector3f local_outgoing = sample_hemisphere_cosine(s);
             outgoing = transform.vector_to_parent(local_outgoing);
             const Vector3f shifted_outgoing = shift(local_outgoing);
 
@@ -189,6 +223,13 @@ namespace
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
             const Vector3f local_outgoing = transform.vector_to_local(outgoing);
+
+            if (m_sky_table.get())
+            {
+                m_sky_table->lookup(local_outgoing, value);
+                return;
+            }
+
             const Vector3f shifted_outgoing = shift(local_outgoing);
 
             if (shifted_outgoing.y > 0.0f)
@@ -207,6 +248,14 @@ namespace
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
             const Vector3f local_outgoing = transform.vector_to_local(outgoing);
+
+            if (m_sky_table.get())
+            {
+                m_sky_table->lookup(local_outgoing, value);
+                probability = m_sky_table->evaluate_pdf(local_outgoing);
+                return;
+            }
+
             const Vector3f shifted_outgoing = shift(local_outgoing);
 
             if (shifted_outgoing.y > 0.0f)
@@ -224,6 +273,10 @@ namespace
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
             const Vector3f local_outgoing = transform.vector_to_local(outgoing);
+
+            if (m_sky_table.get())
+                return m_sky_table->evaluate_pdf(local_outgoing);
+
             const Vector3f shifted_outgoing = shift(local_outgoing);
 
             return shifted_outgoing.y > 0.0f ? shifted_outgoing.y * RcpPi<float>() : 0.0f;
@@ -255,6 +308,9 @@ namespace
         float                       m_uniform_coeffs[3 * 9];
         float                       m_uniform_master_Y[3];
 
+        auto_ptr<SkyTable>          m_sky_table;
+        InputValues                 m_table_values;     // uniform values the sky table was baked with
+
         // Compute the coefficients of the radiance distribution function and the master luminance value.
         static void compute_coefficients(
             const float             turbidity,
@@ -380,19 +436,8 @@ namespace
                 return;
             }
 
-            const float sqrt_cos_theta = sqrt(outgoing.y);
-            const float cos_gamma = dot(outgoing, m_sun_dir);
-            const float gamma = acos(cos_gamma);
-
-            Color3f ciexyz;
-
             if (m_uniform_turbidity)
-            {
-                // Compute the sky color in the CIE XYZ color space.
-                ciexyz[0] = perez(outgoing.y, sqrt_cos_theta, gamma, cos_gamma, m_uniform_coeffs + 0 * 9) * m_uniform_master_Y[0];
-                ciexyz[1] = perez(outgoing.y, sqrt_cos_theta, gamma, cos_gamma, m_uniform_coeffs + 1 * 9) * m_uniform_master_Y[1];
-                ciexyz[2] = perez(outgoing.y, sqrt_cos_theta, gamma, cos_gamma, m_uniform_coeffs + 2 * 9) * m_uniform_master_Y[2];
-            }
+                sky_ciexyy_to_radiance(compute_uniform_sky_color(outgoing), value);
             else
             {
                 // Evaluate turbidity.
@@ -417,12 +462,36 @@ namespace
                     coeffs,
                     master_Y);
 
-                // Compute the sky color in the CIE XYZ color space.
-                ciexyz[0] = perez(outgoing.y, sqrt_cos_theta, gamma, cos_gamma, coeffs + 0 * 9) * master_Y[0];
-                ciexyz[1] = perez(outgoing.y, sqrt_cos_theta, gamma, cos_gamma, coeffs + 1 * 9) * master_Y[1];
-                ciexyz[2] = perez(outgoing.y, sqrt_cos_theta, gamma, cos_gamma, coeffs + 2 * 9) * master_Y[2];
+                sky_ciexyy_to_radiance(adjust_sky_color(compute_sky_ciexyz(outgoing, coeffs, master_Y)), value);
             }
+        }
+
+        // Compute the sky color in the CIE XYZ color space along a given direction.
+        Color3f compute_sky_ciexyz(
+            const Vector3f&         outgoing,
+            const float             coeffs[3 * 9],
+            const float             master_Y[3]) const
+        {
+            const float sqrt_cos_theta = sqrt(outgoing.y);
+            const float cos_gamma = dot(outgoing, m_sun_dir);
+            const float gamma = fast_acos(cos_gamma);
+
+            return
+                Color3f(
+                    perez(outgoing.y, sqrt_cos_theta, gamma, cos_gamma, coeffs + 0 * 9) * master_Y[0],
+                    perez(outgoing.y, sqrt_cos_theta, gamma, cos_gamma, coeffs + 1 * 9) * master_Y[1],
+                    perez(outgoing.y, sqrt_cos_theta, gamma, cos_gamma, coeffs + 2 * 9) * master_Y[2]);
+        }
 
+        // Compute the adjusted sky color in the CIE xyY color space along a given direction, assuming uniform turbidity.
+        Color3f compute_uniform_sky_color(const Vector3f& outgoing) const
+        {
+            return adjust_sky_color(compute_sky_ciexyz(outgoing, m_uniform_coeffs, m_uniform_master_Y));
+        }
+
+        // Apply saturation, luminance gamma and luminance multiplier to a sky color, return it in the CIE xyY color space.
+        Color3f adjust_sky_color(Color3f ciexyz) const
+        {
             // Apply an optional saturation correction.
             if (m_uniform_values.m_saturation_multiplier != 1.0f)
             {
@@ -438,24 +507,58 @@ namespace
                 ciexyz = linear_rgb_to_ciexyz(linear_rgb);
             }
 
-            // Split sky color into luminance and chromaticity.
             Color3f xyY = ciexyz_to_ciexyy(ciexyz);
-            float luminance = xyY[2];
-            RegularSpectrum31f spectrum;
-            daylight_ciexy_to_spectrum(xyY[0], xyY[1], spectrum);
-            value = spectrum;
 
             // Apply luminance gamma and multiplier.
             if (m_uniform_values.m_luminance_gamma != 1.0f)
-                luminance = fast_pow(luminance, m_uniform_values.m_luminance_gamma);
-            luminance *= m_uniform_values.m_luminance_multiplier;
-
-            // Compute the final sky radiance.
-            value *=
-                  luminance                                         // start with computed luminance
-                / sum_value(value * Spectrum(XYZCMFCIE19312Deg[1])) // normalize to unit luminance
-                * (1.0f / 683.0f)                                   // convert lumens to Watts
-                * RcpPi<float>();                                   // convert irradiance to radiance
+                xyY[2] = fast_pow(xyY[2], m_uniform_values.m_luminance_gamma);
+            xyY[2] *= m_uniform_values.m_luminance_multiplier;
+
+            return xyY;
+        }
+
+        // Return true if the sky table exists and was baked with the current parameters.
+        bool is_sky_table_up_to_date(const size_t width) const
+        {
+            return
+                m_sky_table.get() != 0 &&
+                m_sky_table->get_width() == width &&
+                m_table_values.m_sun_theta == m_uniform_values.m_sun_theta &&
+                m_table_values.m_sun_phi == m_uniform_values.m_sun_phi &&
+                m_table_values.m_turbidity == m_uniform_values.m_turbidity &&
+                m_table_values.m_ground_albedo == m_uniform_values.m_ground_albedo &&
+                m_table_values.m_luminance_multiplier == m_uniform_values.m_luminance_multiplier &&
+                m_table_values.m_luminance_gamma == m_uniform_values.m_luminance_gamma &&
+                m_table_values.m_saturation_multiplier == m_uniform_values.m_saturation_multiplier &&
+                m_table_values.m_horizon_shift == m_uniform_values.m_horizon_shift;
+        }
+
+        // Bake the sky into a latitude-longitude table of a given width.
+        void bake_sky_table(const size_t width)
+        {
+            const size_t height = max(width / 2, size_t(1));
+
+            RENDERER_LOG_INFO(
+                "baking " FMT_SIZE_T "x" FMT_SIZE_T " sky table for environment edf \"%s\"...",
+                width,
+                height,
+                get_path().c_str());
+
+            m_sky_table.reset(new SkyTable(width, height));
+
+            for (size_t y = 0; y < height; ++y)
+            {
+                for (size_t x = 0; x < width; ++x)
+                {
+                    const Vector3f shifted_outgoing = shift(m_sky_table->get_texel_direction(x, y));
+
+                    if (shifted_outgoing.y > 0.0f)
+                        m_sky_table->set_texel(x, y, ciexyy_to_ciexyz(compute_uniform_sky_color(shifted_outgoing)));
+                }
+            }
+
+            m_sky_table->build_importance_map();
+            m_table_values = m_uniform_values;
         }
 
         Vector3f shift(Vector3f v) const
@@ -125,6 +125,26 @@ void IEnvironmentEDFFactory::add_common_sky_input_metadata(DictionaryArray& meta
             .insert("use", "optional")
             .insert("default", "0.0")
             .insert("help", "Rotate the sky horizontally by a given number of degrees"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "tabulate")
+            .insert("label", "Tabulate")
+            .insert("type", "boolean")
+            .insert("use", "optional")
+            .insert("default", "false")
+            .insert("help", "Bake the sky into a table at the start of each frame and importance sample it (requires uniform turbidity)"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "table_resolution")
+            .insert("label", "Table Resolution")
+            .insert("type", "numeric")
+            .insert("min_value", "2")
+            .insert("max_value", "8192")
+            .insert("use", "optional")
+            .insert("default", "1024")
+            .insert("help", "Horizontal resolution of the sky table"));
 }
 
 }   // namespace renderer
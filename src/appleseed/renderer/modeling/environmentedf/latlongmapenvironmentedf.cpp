@@ -54,25 +54,41 @@
 #include "foundation/image/colorspace.h"
 #include "foundation/math/fp.h"
 #include "foundation/math/matrix.h"
-#include "foundation/math/sampling/imageimportancesampler.h"
+#include "foundation/math/sampling/hierarchicalimageimportancesampler.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/system.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/countof.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/searchpaths.h"
+#include "foundation/utility/siphash.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
 #include <memory>
+#include <sstream>
+#include <string>
 
 using namespace foundation;
 using namespace std;
+namespace bf = boost::filesystem;
 
 namespace renderer
 {
@@ -92,7 +108,7 @@ namespace
     //   http://www.cs.kuleuven.be/~graphics/index.php/environment-maps
     //
 
-    typedef ImageImportanceSampler<Color3f, float> ImageImportanceSamplerType;
+    typedef HierarchicalImageImportanceSampler<Color3f, float> ImageImportanceSamplerType;
 
     class ImageSampler
     {
@@ -155,6 +171,88 @@ namespace
         const float     m_rcp_height;
     };
 
+    //
+    // A job building a range of rows of the importance map.
+    //
+
+    class ImportanceMapRowsJob
+      : public IJob
+    {
+      public:
+        ImportanceMapRowsJob(
+            ImageImportanceSamplerType& importance_sampler,
+            TextureStore&               texture_store,
+            const Source*               radiance_source,
+            const Source*               multiplier_source,
+            const Source*               exposure_source,
+            const size_t                width,
+            const size_t                height,
+            const size_t                row_begin,
+            const size_t                row_end,
+            IAbortSwitch*               abort_switch)
+          : m_importance_sampler(importance_sampler)
+          , m_texture_store(texture_store)
+          , m_radiance_source(radiance_source)
+          , m_multiplier_source(multiplier_source)
+          , m_exposure_source(exposure_source)
+          , m_width(width)
+          , m_height(height)
+          , m_row_begin(row_begin)
+          , m_row_end(row_end)
+          , m_abort_switch(abort_switch)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+        {
+            if (is_aborted(m_abort_switch))
+                return;
+
+            TextureCache texture_cache(m_texture_store);
+            ImageSampler sampler(
+                texture_cache,
+                m_radiance_source,
+                m_multiplier_source,
+                m_exposure_source,
+                m_width,
+                m_height);
+
+            m_importance_sampler.rebuild_rows(sampler, m_row_begin, m_row_end);
+        }
+
+      private:
+        ImageImportanceSamplerType&     m_importance_sampler;
+        TextureStore&                   m_texture_store;
+        const Source*                   m_radiance_source;
+        const Source*                   m_multiplier_source;
+        const Source*                   m_exposure_source;
+        const size_t                    m_width;
+        const size_t                    m_height;
+        const size_t                    m_row_begin;
+        const size_t                    m_row_end;
+        IAbortSwitch*                   m_abort_switch;
+    };
+
+    // Number of rows of the importance map built by a single job.
+    const size_t ImportanceMapRowsPerJob = 16;
+
+    //
+    // Importance map cache files.
+    //
+    // A cache file stores the built importance map of an environment EDF:
+    //
+    //   uint32     magic number
+    //   uint32     format version
+    //   uint64     cache key
+    //   the serialized importance sampler
+    //
+    // The cache key is derived from the path, size and modification time of the
+    // environment texture, and from the parameters affecting the importance map.
+    //
+
+    const uint32 ImportanceMapCacheMagicNumber = 0x4D494153;    // "SAIM"
+    const uint32 ImportanceMapCacheFormatVersion = 2;
+
     const char* Model = "latlong_map_environment_edf";
 
     class LatLongMapEnvironmentEDF
@@ -168,6 +266,7 @@ namespace
           , m_importance_map_width(0)
           , m_importance_map_height(0)
           , m_probability_scale(0.0f)
+          , m_importance_map_signature(0)
         {
             m_inputs.declare("radiance", InputFormatSpectralIlluminance);
             m_inputs.declare("radiance_multiplier", InputFormatFloat, "1.0");
@@ -202,8 +301,21 @@ namespace
             {
                 check_non_zero_emission("radiance", "radiance_multiplier");
 
+                // The importance map is kept across frames as long as the inputs it was built from are unchanged.
+                const uint64 importance_map_signature = compute_importance_map_signature();
+                if (m_importance_sampler.get() && importance_map_signature != m_importance_map_signature)
+                {
+                    RENDERER_LOG_INFO(
+                        "radiance of environment edf \"%s\" changed, rebuilding importance map.",
+                        get_path().c_str());
+                    m_importance_sampler.reset();
+                }
+
                 if (m_importance_sampler.get() == 0)
-                    build_importance_map(*project.get_scene(), abort_switch);
+                {
+                    build_importance_map(project, abort_switch);
+                    m_importance_map_signature = importance_map_signature;
+                }
             }
 
             return true;
@@ -373,16 +485,36 @@ namespace
         float   m_probability_scale;
 
         auto_ptr<ImageImportanceSamplerType> m_importance_sampler;
+        uint64  m_importance_map_signature;
+
+        // Compute a signature of the inputs the importance map is built from.
+        uint64 compute_importance_map_signature() const
+        {
+            static const char* InputNames[] = { "radiance", "radiance_multiplier", "exposure" };
+
+            uint64 signature = compute_signature();
 
-        void build_importance_map(const Scene& scene, IAbortSwitch*abort_switch)
+            for (size_t i = 0; i < countof(InputNames); ++i)
+            {
+                if (const Source* source = m_inputs.source(InputNames[i]))
+                    signature = combine_signatures(signature, source->compute_signature());
+            }
+
+            return signature;
+        }
+
+        void build_importance_map(const Project& project, IAbortSwitch* abort_switch)
         {
             const Source* radiance_source = m_inputs.source("radiance");
             assert(radiance_source);
 
+            const Texture* texture = 0;
+
             if (dynamic_cast<const TextureSource*>(radiance_source))
             {
                 const TextureSource* texture_source = static_cast<const TextureSource*>(radiance_source);
                 const TextureInstance& texture_instance = texture_source->get_texture_instance();
+                texture = &texture_instance.get_texture();
                 const CanvasProperties& texture_props = texture_instance.get_texture().properties();
 
                 m_importance_map_width = texture_props.m_canvas_width;
@@ -405,21 +537,25 @@ namespace
             const size_t texel_count = m_importance_map_width * m_importance_map_height;
             m_probability_scale = texel_count / (2.0f * PiSquare<float>());
 
-            TextureStore texture_store(scene);
-            TextureCache texture_cache(texture_store);
-            ImageSampler sampler(
-                texture_cache,
-                radiance_source,
-                m_inputs.source("radiance_multiplier"),
-                m_inputs.source("exposure"),
-                m_importance_map_width,
-                m_importance_map_height);
-
             m_importance_sampler.reset(
                 new ImageImportanceSamplerType(
                     m_importance_map_width,
                     m_importance_map_height));
 
+            // Try to load the importance map from the cache.
+            const string cache_directory = m_params.get_optional<string>("importance_map_cache_directory", "");
+            string cache_file_path;
+            uint64 cache_key = 0;
+            if (!cache_directory.empty() && texture != 0)
+            {
+                if (compute_cache_key(project, *texture, cache_key))
+                {
+                    cache_file_path = make_cache_file_path(cache_directory, cache_key);
+                    if (load_from_cache(cache_file_path, cache_key))
+                        return;
+                }
+            }
+
             RENDERER_LOG_INFO(
                 "building " FMT_SIZE_T "x" FMT_SIZE_T " importance map "
                 "for environment edf \"%s\"...",
@@ -427,16 +563,171 @@ namespace
                 m_importance_map_height,
                 get_path().c_str());
 
-            m_importance_sampler->rebuild(sampler, abort_switch);
+            // Build the rows of the importance map in parallel.
+            size_t thread_count = m_params.get_optional<size_t>("importance_map_build_thread_count", 0);
+            if (thread_count == 0)
+                thread_count = System::get_available_cpu_core_count();
+
+            TextureStore texture_store(*project.get_scene());
+
+            JobQueue job_queue;
+            for (size_t row_begin = 0; row_begin < m_importance_map_height; row_begin += ImportanceMapRowsPerJob)
+            {
+                job_queue.schedule(
+                    new ImportanceMapRowsJob(
+                        *m_importance_sampler,
+                        texture_store,
+                        radiance_source,
+                        m_inputs.source("radiance_multiplier"),
+                        m_inputs.source("exposure"),
+                        m_importance_map_width,
+                        m_importance_map_height,
+                        row_begin,
+                        min(row_begin + ImportanceMapRowsPerJob, m_importance_map_height),
+                        abort_switch));
+            }
+
+            JobManager job_manager(global_logger(), job_queue, thread_count);
+            job_manager.start();
+            job_queue.wait_until_completion();
 
             if (is_aborted(abort_switch))
+            {
                 m_importance_sampler.reset();
-            else
+                return;
+            }
+
+            m_importance_sampler->rebuild_pyramid();
+
+            RENDERER_LOG_INFO(
+                "built importance map for environment edf \"%s\".",
+                get_path().c_str());
+
+            // Store the importance map into the cache.
+            if (!cache_file_path.empty())
+                save_to_cache(cache_file_path, cache_key);
+        }
+
+        bool compute_cache_key(const Project& project, const Texture& texture, uint64& cache_key) const
+        {
+            const string filepath =
+                project.search_paths().qualify(
+                    texture.get_parameters().get_optional<string>("filename", ""));
+
+            boost::system::error_code ec;
+            const uint64 file_size = bf::file_size(filepath, ec);
+            if (ec)
+                return false;
+            const time_t file_time = bf::last_write_time(filepath, ec);
+            if (ec)
+                return false;
+
+            string key;
+            key += "filename=" + filepath + ';';
+            key += "size=" + to_string(file_size) + ';';
+            key += "time=" + to_string(static_cast<int64>(file_time)) + ';';
+            key += "color_space=" + texture.get_parameters().get_optional<string>("color_space", "") + ';';
+            key += "radiance_multiplier=" + m_params.get_optional<string>("radiance_multiplier", "1.0") + ';';
+            key += "exposure=" + m_params.get_optional<string>("exposure", "0.0") + ';';
+            key += "width=" + to_string(m_importance_map_width) + ';';
+            key += "height=" + to_string(m_importance_map_height) + ';';
+
+            uint64 hashes[2];
+            hashes[0] = ImportanceMapCacheFormatVersion;
+            hashes[1] = siphash24(key.c_str(), key.size());
+
+            cache_key = siphash24(hashes, sizeof(hashes));
+            return true;
+        }
+
+        static string make_cache_file_path(const string& cache_directory, const uint64 cache_key)
+        {
+            stringstream sstr;
+            sstr << "importancemap-" << hex << setw(16) << setfill('0') << cache_key << ".bin";
+            return (bf::path(cache_directory) / sstr.str()).string();
+        }
+
+        bool load_from_cache(const string& path, const uint64 cache_key)
+        {
+            ifstream file(path.c_str(), ios_base::in | ios_base::binary);
+            if (!file.is_open())
+                return false;
+
+            uint32 magic_number, format_version;
+            uint64 key;
+
+            file.read(reinterpret_cast<char*>(&magic_number), sizeof(magic_number));
+            file.read(reinterpret_cast<char*>(&format_version), sizeof(format_version));
+            file.read(reinterpret_cast<char*>(&key), sizeof(key));
+
+            const bool success =
+                file &&
+                magic_number == ImportanceMapCacheMagicNumber &&
+                format_version == ImportanceMapCacheFormatVersion &&
+                key == cache_key &&
+                m_importance_sampler->read(file);
+
+            if (!success)
             {
-                RENDERER_LOG_INFO(
-                    "built importance map for environment edf \"%s\".",
-                    get_path().c_str());
+                m_importance_sampler.reset(
+                    new ImageImportanceSamplerType(
+                        m_importance_map_width,
+                        m_importance_map_height));
+                return false;
             }
+
+            RENDERER_LOG_INFO(
+                "loaded importance map for environment edf \"%s\" from cache file %s.",
+                get_path().c_str(),
+                path.c_str());
+
+            return true;
+        }
+
+        void save_to_cache(const string& path, const uint64 cache_key) const
+        {
+            // Write to a temporary file first so that concurrent processes never see a partial file.
+            const bf::path file_path(path);
+            boost::system::error_code ec;
+            bf::create_directories(file_path.parent_path(), ec);
+            const bf::path tmp_file_path =
+                file_path.parent_path() / bf::unique_path(file_path.filename().string() + ".%%%%-%%%%-%%%%.tmp", ec);
+
+            bool success = !ec;
+
+            if (success)
+            {
+                ofstream file(tmp_file_path.string().c_str(), ios_base::out | ios_base::binary);
+
+                file.write(reinterpret_cast<const char*>(&ImportanceMapCacheMagicNumber), sizeof(ImportanceMapCacheMagicNumber));
+                file.write(reinterpret_cast<const char*>(&ImportanceMapCacheFormatVersion), sizeof(ImportanceMapCacheFormatVersion));
+                file.write(reinterpret_cast<const char*>(&cache_key), sizeof(cache_key));
+                m_importance_sampler->write(file);
+
+                file.close();
+                success = !file.fail();
+            }
+
+            if (success)
+            {
+                bf::rename(tmp_file_path, file_path, ec);
+                success = !ec;
+            }
+
+            if (!success)
+            {
+                bf::remove(tmp_file_path, ec);
+                RENDERER_LOG_WARNING(
+                    "failed to write importance map for environment edf \"%s\" to cache file %s.",
+                    get_path().c_str(),
+                    path.c_str());
+                return;
+            }
+
+            RENDERER_LOG_INFO(
+                "wrote importance map for environment edf \"%s\" to cache file %s.",
+                get_path().c_str(),
+                path.c_str());
         }
 
         void lookup_environment_map(
@@ -558,6 +849,15 @@ DictionaryArray LatLongMapEnvironmentEDFFactory::get_input_metadata() const
             .insert("use", "optional")
             .insert("help", "Environment texture vertical shift in degrees"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "importance_map_cache_directory")
+            .insert("label", "Importance Map Cache Directory")
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("use", "optional")
+            .insert("help", "If set, built importance maps are stored in this directory and reused across renders"));
+
     return metadata;
 }
 
@@ -31,9 +31,11 @@
 #include "preethamenvironmentedf.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/environmentedf/skytable.h"
 #include "renderer/modeling/environmentedf/sphericalcoordinates.h"
 #include "renderer/modeling/input/inputarray.h"
 #include "renderer/modeling/input/source.h"
@@ -49,12 +51,17 @@
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <memory>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
@@ -151,6 +158,26 @@ namespace
                 m_uniform_Y_zenith = compute_zenith_Y(m_uniform_values.m_turbidity, m_sun_theta);
             }
 
+            // Optionally bake the sky into a table, only when the sky has changed since the last bake.
+            const bool tabulate = m_params.get_optional<bool>("tabulate", false);
+            if (tabulate && m_uniform_turbidity && m_uniform_values.m_luminance_multiplier > 0.0f)
+            {
+                const size_t width = max(m_params.get_optional<size_t>("table_resolution", 1024), size_t(2));
+                if (!is_sky_table_up_to_date(width))
+                    bake_sky_table(width);
+            }
+            else
+            {
+                if (tabulate && !m_uniform_turbidity)
+                {
+                    RENDERER_LOG_WARNING(
+                        "cannot tabulate environment edf \"%s\" because its turbidity is not uniform.",
+                        get_path().c_str());
+                }
+
+                m_sky_table.reset();
+            }
+
             return true;
         }
 
@@ -161,10 +188,19 @@ namespace
             Spectrum&               value,
             float&                  probability) const APPLESEED_OVERRIDE
         {
-            const Vector3f local_outgoing = sample_hemisphere_cosine(s);
-
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
+
+            if (m_sky_table.get())
+            {
+                Vector3f local_outgoing;
+                m_sky_table->sample(s, local_outgoing, probability);
+                outgoing = transform.vector_to_parent(local_outgoing);
+                m_sky_table->lookup(local_outgoing, value);
+                return;
+            }
+
+            const Vector3f local_outgoing = sample_hemisphere_cosine(s);
             outgoing = transform.vector_to_parent(local_outgoing);
             const Vector3f shifted_outgoing = shift(local_outgoing);
 
@@ -185,6 +221,13 @@ namespace
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
             const Vector3f local_outgoing = transform.vector_to_local(outgoing);
+
+            if (m_sky_table.get())
+            {
+                m_sky_table->lookup(local_outgoing, value);
+                return;
+            }
+
             const Vector3f shifted_outgoing = shift(local_outgoing);
 
             if (shifted_outgoing.y > 0.0f)
@@ -203,6 +246,14 @@ namespace
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
             const Vector3f local_outgoing = transform.vector_to_local(outgoing);
+
+            if (m_sky_table.get())
+            {
+                m_sky_table->lookup(local_outgoing, value);
+                probability = m_sky_table->evaluate_pdf(local_outgoing);
+                return;
+            }
+
             const Vector3f shifted_outgoing = shift(local_outgoing);
 
             if (shifted_outgoing.y > 0.0f)
@@ -220,6 +271,10 @@ namespace
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
             const Vector3f local_outgoing = transform.vector_to_local(outgoing);
+
+            if (m_sky_table.get())
+                return m_sky_table->evaluate_pdf(local_outgoing);
+
             const Vector3f shifted_outgoing = shift(local_outgoing);
 
             return shifted_outgoing.y > 0.0f ? shifted_outgoing.y * RcpPi<float>() : 0.0f;
@@ -255,6 +310,9 @@ namespace
         float                       m_uniform_y_zenith;
         float                       m_uniform_Y_zenith;
 
+        auto_ptr<SkyTable>          m_sky_table;
+        InputValues                 m_table_values;     // uniform values the sky table was baked with
+
         // Compute the coefficients of the luminance distribution function.
         static void compute_Y_coefficients(
             const float             turbidity,
@@ -365,19 +423,8 @@ namespace
                 return;
             }
 
-            const float rcp_cos_theta = 1.0f / outgoing.y;
-            const float cos_gamma = clamp(dot(outgoing, m_sun_dir), -1.0f, 1.0f);
-            const float gamma = acos(cos_gamma);
-
-            Color3f xyY;
-
             if (m_uniform_turbidity)
-            {
-                // Compute the sky color in the xyY color space.
-                xyY[0] = compute_quantity(rcp_cos_theta, gamma, cos_gamma, m_sun_theta, m_cos_sun_theta, m_uniform_x_zenith, m_uniform_x_coeffs);
-                xyY[1] = compute_quantity(rcp_cos_theta, gamma, cos_gamma, m_sun_theta, m_cos_sun_theta, m_uniform_y_zenith, m_uniform_y_coeffs);
-                xyY[2] = compute_quantity(rcp_cos_theta, gamma, cos_gamma, m_sun_theta, m_cos_sun_theta, m_uniform_Y_zenith, m_uniform_Y_coeffs);
-            }
+                sky_ciexyy_to_radiance(compute_uniform_sky_color(outgoing), value);
             else
             {
                 // Evaluate turbidity.
@@ -404,12 +451,52 @@ namespace
                 const float y_zenith = compute_zenith_y(turbidity, m_sun_theta);
                 const float Y_zenith = compute_zenith_Y(turbidity, m_sun_theta);
 
-                // Compute the sky color in the xyY color space.
-                xyY[0] = compute_quantity(rcp_cos_theta, gamma, cos_gamma, m_sun_theta, m_cos_sun_theta, x_zenith, x_coeffs);
-                xyY[1] = compute_quantity(rcp_cos_theta, gamma, cos_gamma, m_sun_theta, m_cos_sun_theta, y_zenith, y_coeffs);
-                xyY[2] = compute_quantity(rcp_cos_theta, gamma, cos_gamma, m_sun_theta, m_cos_sun_theta, Y_zenith, Y_coeffs);
+                const Color3f xyY =
+                    compute_sky_ciexyy(
+                        outgoing,
+                        x_zenith, y_zenith, Y_zenith,
+                        x_coeffs, y_coeffs, Y_coeffs);
+
+                sky_ciexyy_to_radiance(adjust_sky_color(xyY), value);
             }
+        }
+
+        // Compute the sky color in the CIE xyY color space along a given direction.
+        Color3f compute_sky_ciexyy(
+            const Vector3f&         outgoing,
+            const float             x_zenith,
+            const float             y_zenith,
+            const float             Y_zenith,
+            const float             x_coeffs[5],
+            const float             y_coeffs[5],
+            const float             Y_coeffs[5]) const
+        {
+            const float rcp_cos_theta = 1.0f / outgoing.y;
+            const float cos_gamma = clamp(dot(outgoing, m_sun_dir), -1.0f, 1.0f);
+            const float gamma = fast_acos(cos_gamma);
 
+            return
+                Color3f(
+                    compute_quantity(rcp_cos_theta, gamma, cos_gamma, m_sun_theta, m_cos_sun_theta, x_zenith, x_coeffs),
+                    compute_quantity(rcp_cos_theta, gamma, cos_gamma, m_sun_theta, m_cos_sun_theta, y_zenith, y_coeffs),
+                    compute_quantity(rcp_cos_theta, gamma, cos_gamma, m_sun_theta, m_cos_sun_theta, Y_zenith, Y_coeffs));
+        }
+
+        // Compute the adjusted sky color in the CIE xyY color space along a given direction, assuming uniform turbidity.
+        Color3f compute_uniform_sky_color(const Vector3f& outgoing) const
+        {
+            const Color3f xyY =
+                compute_sky_ciexyy(
+                    outgoing,
+                    m_uniform_x_zenith, m_uniform_y_zenith, m_uniform_Y_zenith,
+                    m_uniform_x_coeffs, m_uniform_y_coeffs, m_uniform_Y_coeffs);
+
+            return adjust_sky_color(xyY);
+        }
+
+        // Apply saturation, luminance gamma and luminance multiplier to a sky color in the CIE xyY color space.
+        Color3f adjust_sky_color(Color3f xyY) const
+        {
             // Apply an optional saturation correction.
             if (m_uniform_values.m_saturation_multiplier != 1.0f)
             {
@@ -427,23 +514,55 @@ namespace
                 xyY = ciexyz_to_ciexyy(ciexyz);
             }
 
-            // Split sky color into luminance and chromaticity.
-            float luminance = xyY[2];
-            RegularSpectrum31f spectrum;
-            daylight_ciexy_to_spectrum(xyY[0], xyY[1], spectrum);
-            value = spectrum;
-
             // Apply luminance gamma and multiplier.
             if (m_uniform_values.m_luminance_gamma != 1.0f)
-                luminance = fast_pow(luminance, m_uniform_values.m_luminance_gamma);
-            luminance *= m_uniform_values.m_luminance_multiplier;
-
-            // Compute the final sky radiance.
-            value *=
-                  luminance                                         // start with computed luminance
-                / sum_value(value * Spectrum(XYZCMFCIE19312Deg[1])) // normalize to unit luminance
-                * (1.0f / 683.0f)                                   // convert lumens to Watts
-                * RcpPi<float>();                                   // convert irradiance to radiance
+                xyY[2] = fast_pow(xyY[2], m_uniform_values.m_luminance_gamma);
+            xyY[2] *= m_uniform_values.m_luminance_multiplier;
+
+            return xyY;
+        }
+
+        // Return true if the sky table exists and was baked with the current parameters.
+        bool is_sky_table_up_to_date(const size_t width) const
+        {
+            return
+                m_sky_table.get() != 0 &&
+                m_sky_table->get_width() == width &&
+                m_table_values.m_sun_theta == m_uniform_values.m_sun_theta &&
+                m_table_values.m_sun_phi == m_uniform_values.m_sun_phi &&
+                m_table_values.m_turbidity == m_uniform_values.m_turbidity &&
+                m_table_values.m_luminance_multiplier == m_uniform_values.m_luminance_multiplier &&
+                m_table_values.m_luminance_gamma == m_uniform_values.m_luminance_gamma &&
+                m_table_values.m_saturation_multiplier == m_uniform_values.m_saturation_multiplier &&
+                m_table_values.m_horizon_shift == m_uniform_values.m_horizon_shift;
+        }
+
+        // Bake the sky into a latitude-longitude table of a given width.
+        void bake_sky_table(const size_t width)
+        {
+            const size_t height = max(width / 2, size_t(1));
+
+            RENDERER_LOG_INFO(
+                "baking " FMT_SIZE_T "x" FMT_SIZE_T " sky table for environment edf \"%s\"...",
+                width,
+                height,
+                get_path().c_str());
+
+            m_sky_table.reset(new SkyTable(width, height));
+
+            for (size_t y = 0; y < height; ++y)
+            {
+                for (size_t x = 0; x < width; ++x)
+                {
+                    const Vector3f shifted_outgoing = shift(m_sky_table->get_texel_direction(x, y));
+
+                    if (shifted_outgoing.y > 0.0f)
+                        m_sky_table->set_texel(x, y, ciexyy_to_ciexyz(compute_uniform_sky_color(shifted_outgoing)));
+                }
+            }
+
+            m_sky_table->build_importance_map();
+            m_table_values = m_uniform_values;
         }
 
         Vector3f shift(Vector3f v) const
@@ -0,0 +1,236 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "skytable.h"
+
+// appleseed.renderer headers.
+#include "renderer/modeling/environmentedf/sphericalcoordinates.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/colorspace.h"
+#include "foundation/image/regularspectrum.h"
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    class TexelSampler
+    {
+      public:
+        TexelSampler(
+            const vector<Color3f>&  texels,
+            const size_t            width)
+          : m_texels(texels)
+          , m_width(width)
+        {
+        }
+
+        void sample(const size_t x, const size_t y, Color3f& payload, float& importance)
+        {
+            payload = m_texels[y * m_width + x];
+            importance = payload[1];
+        }
+
+      private:
+        const vector<Color3f>&  m_texels;
+        const size_t            m_width;
+    };
+}
+
+
+//
+// SkyTable class implementation.
+//
+
+SkyTable::SkyTable(
+    const size_t    width,
+    const size_t    height)
+  : m_width(width)
+  , m_height(height)
+  , m_rcp_width(1.0f / width)
+  , m_rcp_height(1.0f / height)
+  , m_probability_scale((width * height) / (2.0f * PiSquare<float>()))
+  , m_texels(width * height, Color3f(0.0f))
+{
+    assert(width > 0);
+    assert(height > 0);
+}
+
+Vector3f SkyTable::get_texel_direction(
+    const size_t    x,
+    const size_t    y) const
+{
+    assert(x < m_width);
+    assert(y < m_height);
+
+    float theta, phi;
+    unit_square_to_angles(
+        (x + 0.5f) * m_rcp_width,
+        (y + 0.5f) * m_rcp_height,
+        theta,
+        phi);
+
+    return Vector3f::make_unit_vector(theta, phi);
+}
+
+void SkyTable::set_texel(
+    const size_t    x,
+    const size_t    y,
+    const Color3f&  ciexyz)
+{
+    assert(x < m_width);
+    assert(y < m_height);
+
+    m_texels[y * m_width + x] = ciexyz;
+}
+
+void SkyTable::build_importance_map()
+{
+    m_importance_sampler.reset(new ImageImportanceSamplerType(m_width, m_height));
+
+    TexelSampler sampler(m_texels, m_width);
+    m_importance_sampler->rebuild(sampler);
+}
+
+void SkyTable::lookup(
+    const Vector3f& local_outgoing,
+    Spectrum&       value) const
+{
+    float theta, phi;
+    unit_vector_to_angles(local_outgoing, theta, phi);
+
+    float u, v;
+    angles_to_unit_square(theta, phi, u, v);
+
+    // Compute the texels surrounding the lookup point, wrapping around horizontally.
+    const float fx = u * m_width - 0.5f;
+    const float fy = clamp(v * m_height - 0.5f, 0.0f, static_cast<float>(m_height - 1));
+    const float floor_fx = floor(fx);
+    const float wx = fx - floor_fx;
+    const size_t x0 = (static_cast<size_t>(static_cast<long>(floor_fx) + static_cast<long>(m_width))) % m_width;
+    const size_t x1 = x0 + 1 < m_width ? x0 + 1 : 0;
+    const size_t y0 = truncate<size_t>(fy);
+    const size_t y1 = min(y0 + 1, m_height - 1);
+    const float wy = fy - y0;
+
+    // Bilinearly interpolate the sky color in the CIE XYZ color space.
+    const Color3f ciexyz =
+        lerp(
+            lerp(m_texels[y0 * m_width + x0], m_texels[y0 * m_width + x1], wx),
+            lerp(m_texels[y1 * m_width + x0], m_texels[y1 * m_width + x1], wx),
+            wy);
+
+    if (ciexyz[1] > 0.0f)
+        sky_ciexyy_to_radiance(ciexyz_to_ciexyy(ciexyz), value);
+    else value.set(0.0f);
+}
+
+void SkyTable::sample(
+    const Vector2f& s,
+    Vector3f&       local_outgoing,
+    float&          probability) const
+{
+    assert(m_importance_sampler.get());
+
+    // Sample the importance map.
+    size_t x, y;
+    float prob_xy;
+    m_importance_sampler->sample(s, x, y, prob_xy);
+
+    // Compute the spherical coordinates of the sample.
+    float theta, phi;
+    unit_square_to_angles(
+        (x + 0.5f) * m_rcp_width,
+        (y + 0.5f) * m_rcp_height,
+        theta,
+        phi);
+
+    // Compute the local space emission direction.
+    const float cos_theta = cos(theta);
+    const float sin_theta = sin(theta);
+    const float cos_phi = cos(phi);
+    const float sin_phi = sin(phi);
+    local_outgoing = Vector3f::make_unit_vector(cos_theta, sin_theta, cos_phi, sin_phi);
+
+    // Compute the probability density of this direction.
+    probability = prob_xy * m_probability_scale / sin_theta;
+}
+
+float SkyTable::evaluate_pdf(const Vector3f& local_outgoing) const
+{
+    assert(m_importance_sampler.get());
+
+    float theta, phi;
+    unit_vector_to_angles(local_outgoing, theta, phi);
+
+    float u, v;
+    angles_to_unit_square(theta, phi, u, v);
+
+    const size_t x = min(truncate<size_t>(u * m_width), m_width - 1);
+    const size_t y = min(truncate<size_t>(v * m_height), m_height - 1);
+    const float prob_xy = m_importance_sampler->get_pdf(x, y);
+
+    const float sin_theta = sin(theta);
+    return sin_theta > 0.0f ? prob_xy * m_probability_scale / sin_theta : 0.0f;
+}
+
+
+//
+// Sky color conversion implementation.
+//
+
+void sky_ciexyy_to_radiance(
+    const Color3f&  ciexyy,
+    Spectrum&       value)
+{
+    // Split sky color into luminance and chromaticity.
+    RegularSpectrum31f spectrum;
+    daylight_ciexy_to_spectrum(ciexyy[0], ciexyy[1], spectrum);
+    value = spectrum;
+
+    // Compute the final sky radiance.
+    value *=
+          ciexyy[2]                                         // start with computed luminance
+        / sum_value(spectrum * XYZCMFCIE19312Deg[1])        // normalize to unit luminance
+        * (1.0f / 683.0f)                                   // convert lumens to Watts
+        * RcpPi<float>();                                   // convert irradiance to radiance
+}
+
+}   // namespace renderer
@@ -0,0 +1,134 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_MODELING_ENVIRONMENTEDF_SKYTABLE_H
+#define APPLESEED_RENDERER_MODELING_ENVIRONMENTEDF_SKYTABLE_H
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/color.h"
+#include "foundation/math/sampling/hierarchicalimageimportancesampler.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A latitude-longitude table of sky colors, used by the analytic sky models
+// to replace the evaluation of the model by a bilinear table lookup, and to
+// importance sample the sky according to its luminance.
+//
+// The table covers the whole sphere of local space directions and stores
+// CIE XYZ colors whose Y component is the final (adjusted) sky luminance.
+//
+
+class SkyTable
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    SkyTable(
+        const size_t                width,
+        const size_t                height);
+
+    size_t get_width() const;
+    size_t get_height() const;
+
+    // Return the local space direction through the center of a given texel.
+    foundation::Vector3f get_texel_direction(
+        const size_t                x,
+        const size_t                y) const;
+
+    // Set the CIE XYZ color of a given texel.
+    void set_texel(
+        const size_t                x,
+        const size_t                y,
+        const foundation::Color3f&  ciexyz);
+
+    // Build the importance map once all texels have been set.
+    void build_importance_map();
+
+    // Return the sky radiance along a given local space direction.
+    void lookup(
+        const foundation::Vector3f& local_outgoing,
+        Spectrum&                   value) const;
+
+    // Sample the sky and return a local space direction and its probability density.
+    void sample(
+        const foundation::Vector2f& s,
+        foundation::Vector3f&       local_outgoing,
+        float&                      probability) const;
+
+    // Return the probability density of a given local space direction.
+    float evaluate_pdf(
+        const foundation::Vector3f& local_outgoing) const;
+
+  private:
+    typedef foundation::HierarchicalImageImportanceSampler<foundation::Color3f, float> ImageImportanceSamplerType;
+
+    const size_t                                m_width;
+    const size_t                                m_height;
+    const float                                 m_rcp_width;
+    const float                                 m_rcp_height;
+    const float                                 m_probability_scale;
+    std::vector<foundation::Color3f>            m_texels;
+    std::auto_ptr<ImageImportanceSamplerType>   m_importance_sampler;
+};
+
+// Convert a sky color in the CIE xyY color space to spectral radiance.
+void sky_ciexyy_to_radiance(
+    const foundation::Color3f&      ciexyy,
+    Spectrum&                       value);
+
+
+//
+// SkyTable class implementation.
+//
+
+inline size_t SkyTable::get_width() const
+{
+    return m_width;
+}
+
+inline size_t SkyTable::get_height() const
+{
+    return m_height;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_MODELING_ENVIRONMENTEDF_SKYTABLE_H
@@ -33,6 +33,8 @@
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
 #include "renderer/kernel/aov/imagestack.h"
+#include "renderer/kernel/aov/objectidbuffer.h"
+#include "renderer/kernel/rendering/pixelstatistics.h"
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
@@ -52,10 +54,14 @@
 #ifdef APPLESEED_USE_SSE
 #include "foundation/platform/sse.h"
 #endif
+#include "foundation/platform/system.h"
 #include "foundation/platform/timers.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/iostreamop.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/memoryaccounting.h"
 #include "foundation/utility/otherwise.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
@@ -64,9 +70,11 @@
 #include "boost/filesystem/path.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <string>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -91,25 +99,37 @@ UniqueID Frame::get_class_uid()
 
 struct Frame::Impl
 {
-    size_t                  m_frame_width;
-    size_t                  m_frame_height;
-    size_t                  m_tile_width;
-    size_t                  m_tile_height;
-    PixelFormat             m_pixel_format;
-    string                  m_filter_name;
-    float                   m_filter_radius;
-    auto_ptr<Filter2f>      m_filter;
-    bool                    m_clamp;
-    float                   m_target_gamma;
-    float                   m_rcp_target_gamma;
-    LightingConditions      m_lighting_conditions;
-    AABB2u                  m_crop_window;
-
-    auto_ptr<Image>         m_image;
-    auto_ptr<ImageStack>    m_aov_images;
+    size_t                    m_frame_width;
+    size_t                    m_frame_height;
+    size_t                    m_tile_width;
+    size_t                    m_tile_height;
+    PixelFormat               m_pixel_format;
+    string                    m_filter_name;
+    float                     m_filter_radius;
+    auto_ptr<Filter2f>        m_filter;
+    bool                      m_clamp;
+    bool                      m_denoise;
+    float                     m_target_gamma;
+    float                     m_rcp_target_gamma;
+    LightingConditions        m_lighting_conditions;
+    AABB2u                    m_crop_window;
+    AABB2u                    m_aov_window;
+
+    auto_ptr<Image>           m_image;
+    auto_ptr<ImageStack>      m_aov_images;
+    auto_ptr<ObjectIDBuffer>  m_object_ids;
+    auto_ptr<PixelStatistics> m_pixel_stats;
+    MemoryAccount             m_image_memory_account;
+    MemoryAccount             m_object_ids_memory_account;
+    MemoryAccount             m_pixel_stats_memory_account;
+    bool                      m_has_preview;
 
     Impl()
       : m_lighting_conditions(IlluminantCIED65, XYZCMFCIE196410Deg)
+      , m_image_memory_account(MemoryTagFramebuffers)
+      , m_object_ids_memory_account(MemoryTagFramebuffers)
+      , m_pixel_stats_memory_account(MemoryTagFramebuffers)
+      , m_has_preview(false)
     {
     }
 };
@@ -136,6 +156,7 @@ Frame::Frame(
 
     // Retrieve the image properties.
     m_props = impl->m_image->properties();
+    impl->m_image_memory_account.set_size(m_props.m_pixel_count * m_props.m_pixel_size);
 
     // Create the image stack for AOVs.
     impl->m_aov_images.reset(
@@ -169,8 +190,10 @@ void Frame::print_settings()
         "  color space      %s\n"
         "  premult. alpha   %s\n"
         "  clamping         %s\n"
+        "  denoiser         %s\n"
         "  gamma correction %f\n"
-        "  crop window      (%s, %s)-(%s, %s)",
+        "  crop window      (%s, %s)-(%s, %s)\n"
+        "  aov window       (%s, %s)-(%s, %s)",
         get_active_camera_name(),
         pretty_uint(impl->m_frame_width).c_str(),
         pretty_uint(impl->m_frame_height).c_str(),
@@ -182,11 +205,16 @@ void Frame::print_settings()
         color_space_name(m_color_space),
         m_is_premultiplied_alpha ? "on" : "off",
         impl->m_clamp ? "on" : "off",
+        impl->m_denoise ? "on" : "off",
         impl->m_target_gamma,
         pretty_uint(impl->m_crop_window.min[0]).c_str(),
         pretty_uint(impl->m_crop_window.min[1]).c_str(),
         pretty_uint(impl->m_crop_window.max[0]).c_str(),
-        pretty_uint(impl->m_crop_window.max[1]).c_str());
+        pretty_uint(impl->m_crop_window.max[1]).c_str(),
+        pretty_uint(impl->m_aov_window.min[0]).c_str(),
+        pretty_uint(impl->m_aov_window.min[1]).c_str(),
+        pretty_uint(impl->m_aov_window.max[0]).c_str(),
+        pretty_uint(impl->m_aov_window.max[1]).c_str());
 }
 
 const char* Frame::get_active_camera_name() const
@@ -207,6 +235,36 @@ ImageStack& Frame::aov_images() const
     return *impl->m_aov_images.get();
 }
 
+void Frame::enable_object_id_buffer()
+{
+    if (impl->m_object_ids.get() == 0)
+    {
+        impl->m_object_ids.reset(new ObjectIDBuffer(impl->m_frame_width, impl->m_frame_height));
+        impl->m_object_ids_memory_account.set_size(
+            impl->m_frame_width * impl->m_frame_height * sizeof(ObjectIDBuffer::Entry));
+    }
+}
+
+ObjectIDBuffer* Frame::get_object_id_buffer() const
+{
+    return impl->m_object_ids.get();
+}
+
+void Frame::enable_pixel_statistics()
+{
+    if (impl->m_pixel_stats.get() == 0)
+    {
+        impl->m_pixel_stats.reset(new PixelStatistics(impl->m_frame_width, impl->m_frame_height));
+        impl->m_pixel_stats_memory_account.set_size(
+            impl->m_frame_width * impl->m_frame_height * sizeof(PixelStatistics::Entry));
+    }
+}
+
+PixelStatistics* Frame::get_pixel_statistics() const
+{
+    return impl->m_pixel_stats.get();
+}
+
 const Filter2f& Frame::get_filter() const
 {
     return *impl->m_filter.get();
@@ -217,6 +275,11 @@ const LightingConditions& Frame::get_lighting_conditions() const
     return impl->m_lighting_conditions;
 }
 
+bool Frame::is_denoising_enabled() const
+{
+    return impl->m_denoise;
+}
+
 void Frame::reset_crop_window()
 {
     impl->m_crop_window =
@@ -248,6 +311,53 @@ const AABB2u& Frame::get_crop_window() const
     return impl->m_crop_window;
 }
 
+bool Frame::has_aov_window() const
+{
+    return
+        impl->m_aov_window.min.x > 0 ||
+        impl->m_aov_window.min.y > 0 ||
+        impl->m_aov_window.max.x < impl->m_frame_width - 1 ||
+        impl->m_aov_window.max.y < impl->m_frame_height - 1;
+}
+
+const AABB2u& Frame::get_aov_window() const
+{
+    return impl->m_aov_window;
+}
+
+size_t Frame::get_aov_count(const Vector2i& pi) const
+{
+    const AABB2u& w = impl->m_aov_window;
+
+    return
+        pi.x >= static_cast<int>(w.min.x) && pi.x <= static_cast<int>(w.max.x) &&
+        pi.y >= static_cast<int>(w.min.y) && pi.y <= static_cast<int>(w.max.y)
+            ? impl->m_aov_images->size()
+            : 0;
+}
+
+size_t Frame::get_aov_count(const size_t tile_x, const size_t tile_y) const
+{
+    // Pixels of a tile receive samples from neighboring pixels within the filter's footprint.
+    const int margin_x = truncate<int>(ceil(impl->m_filter->get_xradius()));
+    const int margin_y = truncate<int>(ceil(impl->m_filter->get_yradius()));
+    const int tile_origin_x = static_cast<int>(tile_x * impl->m_tile_width);
+    const int tile_origin_y = static_cast<int>(tile_y * impl->m_tile_height);
+
+    const AABB2i padded_tile_bbox(
+        Vector2i(
+            tile_origin_x - margin_x,
+            tile_origin_y - margin_y),
+        Vector2i(
+            tile_origin_x + static_cast<int>(impl->m_tile_width) - 1 + margin_x,
+            tile_origin_y + static_cast<int>(impl->m_tile_height) - 1 + margin_y));
+
+    return
+        AABB2i::overlap(padded_tile_bbox, AABB2i(impl->m_aov_window))
+            ? impl->m_aov_images->size()
+            : 0;
+}
+
 size_t Frame::get_pixel_count() const
 {
     return impl->m_crop_window.volume();
@@ -292,7 +402,15 @@ namespace
                 break;
 
               case ColorSpaceCIEXYZ:
+#ifdef APPLESEED_USE_SSE
+                {
+                    const float old_alpha = color[3];
+                    _mm_store_ps(&color[0], linear_rgb_to_ciexyz(_mm_load_ps(&color[0])));
+                    color[3] = old_alpha;
+                }
+#else
                 color.rgb() = linear_rgb_to_ciexyz(color.rgb());
+#endif
                 break;
 
               default:
@@ -326,7 +444,6 @@ namespace
     >
     void transform_float_tile(Tile& tile, const float rcp_target_gamma)
     {
-        assert(ColorSpace == ColorSpaceLinearRGB || ColorSpace == ColorSpaceSRGB);
         assert(tile.get_channel_count() == 4);
 
         float* pixel_ptr = reinterpret_cast<float*>(tile.pixel(0));
@@ -341,6 +458,8 @@ namespace
             // Apply color space conversion.
             if (ColorSpace == ColorSpaceSRGB)
                 color = fast_linear_rgb_to_srgb(color);
+            else if (ColorSpace == ColorSpaceCIEXYZ)
+                color = linear_rgb_to_ciexyz(color);
 
             // Apply clamping.
             // todo: mark clamped pixels in the diagnostic map.
@@ -365,7 +484,6 @@ namespace
     >
     void transform_float_tile(Tile& tile, const float rcp_target_gamma)
     {
-        assert(ColorSpace == ColorSpaceLinearRGB || ColorSpace == ColorSpaceSRGB);
         assert(tile.get_channel_count() == 4);
 
         Color4f* pixel_ptr = reinterpret_cast<Color4f*>(tile.pixel(0));
@@ -379,6 +497,8 @@ namespace
             // Apply color space conversion.
             if (ColorSpace == ColorSpaceSRGB)
                 color.rgb() = fast_linear_rgb_to_srgb(color.rgb());
+            else if (ColorSpace == ColorSpaceCIEXYZ)
+                color.rgb() = linear_rgb_to_ciexyz(color.rgb());
 
             // Apply clamping.
             // todo: mark clamped pixels in the diagnostic map.
@@ -444,7 +564,7 @@ void Frame::transform_to_output_color_space(Tile& tile) const
             break;
 
           case ColorSpaceCIEXYZ:
-            TRANSFORM_GENERIC_TILE(ColorSpaceCIEXYZ);
+            TRANSFORM_FLOAT_TILE(ColorSpaceCIEXYZ);
             break;
 
           assert_otherwise;
@@ -488,6 +608,17 @@ void Frame::transform_to_output_color_space(Image& image) const
 void Frame::clear_main_image()
 {
     impl->m_image->clear(Color4f(0.0));
+    impl->m_has_preview = false;
+}
+
+void Frame::set_has_preview(const bool has_preview)
+{
+    impl->m_has_preview = has_preview;
+}
+
+bool Frame::has_preview() const
+{
+    return impl->m_has_preview;
 }
 
 bool Frame::write_main_image(const char* file_path) const
@@ -503,6 +634,103 @@ bool Frame::write_main_image(const char* file_path) const
     return write_image(file_path, transformed_image, image_attributes);
 }
 
+namespace
+{
+    bool write_image_file(
+        const char*             file_path,
+        const Image&            image,
+        const ImageAttributes&  image_attributes)
+    {
+        assert(file_path);
+
+        Stopwatch<DefaultWallclockTimer> stopwatch;
+        stopwatch.start();
+
+        try
+        {
+            try
+            {
+                GenericImageFileWriter writer;
+                writer.write(file_path, image, image_attributes);
+            }
+            catch (const ExceptionUnsupportedFileFormat&)
+            {
+                const string extension = lower_case(bf::path(file_path).extension().string());
+
+                RENDERER_LOG_ERROR(
+                    "file format '%s' not supported, writing the image in OpenEXR format "
+                    "(but keeping the filename unmodified).",
+                    extension.c_str());
+
+                EXRImageFileWriter writer;
+                writer.write(file_path, image, image_attributes);
+            }
+        }
+        catch (const ExceptionUnsupportedImageFormat&)
+        {
+            RENDERER_LOG_ERROR(
+                "failed to write image file %s: unsupported image format.",
+                file_path);
+
+            return false;
+        }
+        catch (const ExceptionIOError&)
+        {
+            RENDERER_LOG_ERROR(
+                "failed to write image file %s: i/o error.",
+                file_path);
+
+            return false;
+        }
+        catch (const Exception& e)
+        {
+            RENDERER_LOG_ERROR(
+                "failed to write image file %s: %s.",
+                file_path,
+                e.what());
+
+            return false;
+        }
+
+        stopwatch.measure();
+
+        RENDERER_LOG_INFO(
+            "wrote image file %s in %s.",
+            file_path,
+            pretty_time(stopwatch.get_seconds()).c_str());
+
+        return true;
+    }
+
+    class WriteImageJob
+      : public IJob
+    {
+      public:
+        WriteImageJob(
+            const string&           file_path,
+            const Image&            image,
+            const ImageAttributes&  image_attributes,
+            uint8&                  success)
+          : m_file_path(file_path)
+          , m_image(image)
+          , m_image_attributes(image_attributes)
+          , m_success(success)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            m_success = write_image_file(m_file_path.c_str(), m_image, m_image_attributes) ? 1 : 0;
+        }
+
+      private:
+        const string                m_file_path;
+        const Image&                m_image;
+        const ImageAttributes&      m_image_attributes;
+        uint8&                      m_success;
+    };
+}
+
 bool Frame::write_aov_images(const char* file_path) const
 {
     assert(file_path);
@@ -519,7 +747,14 @@ bool Frame::write_aov_images(const char* file_path) const
         const string base_file_name = boost_file_path.stem().string();
         const string extension = boost_file_path.extension().string();
 
-        for (size_t i = 0; i < impl->m_aov_images->size(); ++i)
+        const size_t aov_count = impl->m_aov_images->size();
+
+        // AOV images are independent of each other: encode and write them concurrently.
+        // Jobs terminated by an exception count as failures.
+        vector<uint8> success(aov_count, 0);
+
+        JobQueue job_queue;
+        for (size_t i = 0; i < aov_count; ++i)
         {
             const string aov_name = impl->m_aov_images->get_name(i);
             const string safe_aov_name = make_safe_filename(aov_name);
@@ -527,12 +762,23 @@ bool Frame::write_aov_images(const char* file_path) const
             const string aov_file_path = (directory / aov_file_name).string();
 
             // Note: AOVs are always in the linear color space.
-            if (!write_image(
-                    aov_file_path.c_str(),
+            job_queue.schedule(
+                new WriteImageJob(
+                    aov_file_path,
                     impl->m_aov_images->get_image(i),
-                    image_attributes))
-                result = false;
+                    image_attributes,
+                    success[i]));
         }
+
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            min(System::get_available_cpu_core_count(), aov_count));
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        result = find(success.begin(), success.end(), 0) == success.end();
     }
 
     return result;
@@ -698,6 +944,9 @@ void Frame::extract_parameters()
     // Retrieve clamping parameter.
     impl->m_clamp = m_params.get_optional<bool>("clamping", false);
 
+    // Retrieve denoising parameter.
+    impl->m_denoise = m_params.get_optional<bool>("denoise", false);
+
     // Retrieve gamma correction parameter.
     impl->m_target_gamma = m_params.get_optional<float>("gamma_correction", 1.0f);
     impl->m_rcp_target_gamma = 1.0f / impl->m_target_gamma;
@@ -707,6 +956,9 @@ void Frame::extract_parameters()
         Vector2u(0, 0),
         Vector2u(impl->m_frame_width - 1, impl->m_frame_height - 1));
     impl->m_crop_window = m_params.get_optional<AABB2u>("crop_window", default_crop_window);
+
+    // Retrieve AOV window parameter.
+    impl->m_aov_window = m_params.get_optional<AABB2u>("aov_window", default_crop_window);
 }
 
 bool Frame::write_image(
@@ -714,65 +966,7 @@ bool Frame::write_image(
     const Image&            image,
     const ImageAttributes&  image_attributes) const
 {
-    assert(file_path);
-
-    Stopwatch<DefaultWallclockTimer> stopwatch;
-    stopwatch.start();
-
-    try
-    {
-        try
-        {
-            GenericImageFileWriter writer;
-            writer.write(file_path, image, image_attributes);
-        }
-        catch (const ExceptionUnsupportedFileFormat&)
-        {
-            const string extension = lower_case(bf::path(file_path).extension().string());
-
-            RENDERER_LOG_ERROR(
-                "file format '%s' not supported, writing the image in OpenEXR format "
-                "(but keeping the filename unmodified).",
-                extension.c_str());
-
-            EXRImageFileWriter writer;
-            writer.write(file_path, image, image_attributes);
-        }
-    }
-    catch (const ExceptionUnsupportedImageFormat&)
-    {
-        RENDERER_LOG_ERROR(
-            "failed to write image file %s: unsupported image format.",
-            file_path);
-
-        return false;
-    }
-    catch (const ExceptionIOError&)
-    {
-        RENDERER_LOG_ERROR(
-            "failed to write image file %s: i/o error.",
-            file_path);
-
-        return false;
-    }
-    catch (const Exception& e)
-    {
-        RENDERER_LOG_ERROR(
-            "failed to write image file %s: %s.",
-            file_path,
-            e.what());
-
-        return false;
-    }
-
-    stopwatch.measure();
-
-    RENDERER_LOG_INFO(
-        "wrote image file %s in %s.",
-        file_path,
-        pretty_time(stopwatch.get_seconds()).c_str());
-
-    return true;
+    return write_image_file(file_path, image, image_attributes);
 }
 
 
@@ -807,6 +1001,13 @@ DictionaryArray FrameFactory::get_input_metadata()
             .insert("type", "text")
             .insert("use", "optional"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "aov_window")
+            .insert("label", "AOV Window")
+            .insert("type", "text")
+            .insert("use", "optional"));
+
     metadata.push_back(
         Dictionary()
             .insert("name", "tile_size")
@@ -885,6 +1086,14 @@ DictionaryArray FrameFactory::get_input_metadata()
             .insert("use", "optional")
             .insert("default", "false"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "denoise")
+            .insert("label", "Denoise")
+            .insert("type", "boolean")
+            .insert("use", "optional")
+            .insert("default", "false"));
+
     metadata.push_back(
         Dictionary()
             .insert("name", "gamma_correction")
@@ -57,6 +57,8 @@ namespace foundation    { class ImageAttributes; }
 namespace foundation    { class LightingConditions; }
 namespace foundation    { class Tile; }
 namespace renderer      { class ImageStack; }
+namespace renderer      { class ObjectIDBuffer; }
+namespace renderer      { class PixelStatistics; }
 namespace renderer      { class ParamArray; }
 
 namespace renderer
@@ -90,6 +92,20 @@ class APPLESEED_DLLSYMBOL Frame
     // Access the AOV images.
     ImageStack& aov_images() const;
 
+    // Create the object ID buffer, which records the entities hit by primary rays for
+    // picking. It is not created by default. Does nothing if it already exists.
+    void enable_object_id_buffer();
+
+    // Access the object ID buffer. Return 0 if it was not enabled.
+    ObjectIDBuffer* get_object_id_buffer() const;
+
+    // Create the per-pixel sample statistics, which are accumulated during progressive
+    // rendering. They are not created by default. Does nothing if they already exist.
+    void enable_pixel_statistics();
+
+    // Access the per-pixel sample statistics. Return 0 if they were not enabled.
+    PixelStatistics* get_pixel_statistics() const;
+
     // Return the reconstruction filter used by the main image and the AOV images.
     const foundation::Filter2f& get_filter() const;
 
@@ -102,12 +118,24 @@ class APPLESEED_DLLSYMBOL Frame
     // Return true if the frame uses premultiplied alpha, false if it uses straight alpha.
     bool is_premultiplied_alpha() const;
 
+    // Return true if the main image should be denoised after rendering.
+    bool is_denoising_enabled() const;
+
     // Set/get the crop window. The crop window is inclusive on all sides.
     void reset_crop_window();
     bool has_crop_window() const;
     void set_crop_window(const foundation::AABB2u& crop_window);
     const foundation::AABB2u& get_crop_window() const;
 
+    // Get the AOV window. AOVs are only computed and stored for pixels inside this
+    // window, which is inclusive on all sides and defaults to the entire frame.
+    bool has_aov_window() const;
+    const foundation::AABB2u& get_aov_window() const;
+
+    // Return the number of AOVs computed for a given pixel or tile.
+    size_t get_aov_count(const foundation::Vector2i& pi) const;
+    size_t get_aov_count(const size_t tile_x, const size_t tile_y) const;
+
     // Return the number of pixels in the frame, taking into account the crop window.
     size_t get_pixel_count() const;
 
@@ -135,6 +163,12 @@ class APPLESEED_DLLSYMBOL Frame
     // Clear the main image to transparent black.
     void clear_main_image();
 
+    // Mark the main image and the depth AOV as a preview of the next render, for instance
+    // a reprojection of the previous one. Frame renderers may use it during their first
+    // passes; pixels with a negative depth are ignored. The flag is reset by clear_main_image().
+    void set_has_preview(const bool has_preview);
+    bool has_preview() const;
+
     // Write the main image / the AOV images to disk.
     // Return true if successful, false otherwise.
     bool write_main_image(const char* file_path) const;
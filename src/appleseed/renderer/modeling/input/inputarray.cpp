@@ -36,6 +36,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/platform/types.h"
+#include "foundation/utility/alignedallocator.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/memory.h"
 #include "foundation/utility/otherwise.h"
@@ -124,6 +125,8 @@ namespace
         uint8* evaluate(
             TextureCache&       texture_cache,
             const Vector2f&     uv,
+            const Vector2f&     duvdx,
+            const Vector2f&     duvdy,
             uint8*              ptr) const
         {
             switch (m_format)
@@ -134,7 +137,7 @@ namespace
                     float* out_scalar = reinterpret_cast<float*>(ptr);
 
                     if (m_source)
-                        m_source->evaluate(texture_cache, uv, *out_scalar);
+                        m_source->evaluate(texture_cache, uv, duvdx, duvdy, *out_scalar);
                     else *out_scalar = 0.0f;
 
                     ptr += sizeof(float);
@@ -149,7 +152,7 @@ namespace
                     new (out_spectrum) Spectrum();
 
                     if (m_source)
-                        m_source->evaluate(texture_cache, uv, *out_spectrum);
+                        m_source->evaluate(texture_cache, uv, duvdx, duvdy, *out_spectrum);
                     else out_spectrum->set(0.0f);
 
                     out_spectrum->set_intent(Spectrum::Reflectance);
@@ -166,7 +169,7 @@ namespace
                     new (out_spectrum) Spectrum();
 
                     if (m_source)
-                        m_source->evaluate(texture_cache, uv, *out_spectrum);
+                        m_source->evaluate(texture_cache, uv, duvdx, duvdy, *out_spectrum);
                     else out_spectrum->set(0.0f);
 
                     out_spectrum->set_intent(Spectrum::Illuminance);
@@ -185,7 +188,7 @@ namespace
                     new (out_alpha) Alpha();
 
                     if (m_source)
-                        m_source->evaluate(texture_cache, uv, *out_spectrum, *out_alpha);
+                        m_source->evaluate(texture_cache, uv, duvdx, duvdy, *out_spectrum, *out_alpha);
                     else
                     {
                         out_spectrum->set(0.0f);
@@ -209,7 +212,7 @@ namespace
                     new (out_alpha) Alpha();
 
                     if (m_source)
-                        m_source->evaluate(texture_cache, uv, *out_spectrum, *out_alpha);
+                        m_source->evaluate(texture_cache, uv, duvdx, duvdy, *out_spectrum, *out_alpha);
                     else
                     {
                         out_spectrum->set(0.0f);
@@ -348,7 +351,23 @@ namespace
 
 struct InputArray::Impl
 {
-    InputVector m_inputs;
+    typedef vector<uint8, AlignedAllocator<uint8> > ValueBlock;
+
+    InputVector     m_inputs;
+
+    // Precomputed values of all inputs (varying inputs are zero), empty if not precomputed.
+    ValueBlock      m_uniform_values;
+
+    // Indices and offsets in the value block of the varying inputs.
+    vector<size_t>  m_varying_inputs;
+    vector<size_t>  m_varying_offsets;
+
+    void invalidate_uniform_values()
+    {
+        m_uniform_values.clear();
+        m_varying_inputs.clear();
+        m_varying_offsets.clear();
+    }
 };
 
 InputArray::InputArray()
@@ -477,6 +496,17 @@ void InputArray::evaluate(
     TextureCache&       texture_cache,
     const Vector2f&     uv,
     void*               values) const
+{
+    const Vector2f Zero(0.0f);
+    evaluate(texture_cache, uv, Zero, Zero, values);
+}
+
+void InputArray::evaluate(
+    TextureCache&       texture_cache,
+    const Vector2f&     uv,
+    const Vector2f&     duvdx,
+    const Vector2f&     duvdy,
+    void*               values) const
 {
     assert(values);
 
@@ -486,8 +516,26 @@ void InputArray::evaluate(
     assert(is_aligned(ptr, 16));
 #endif
 
-    for (const_each<InputVector> i = impl->m_inputs; i; ++i)
-        ptr = i->evaluate(texture_cache, uv, ptr);
+    if (!impl->m_uniform_values.empty())
+    {
+        // Start from the precomputed values and only evaluate varying inputs.
+        memcpy(ptr, &impl->m_uniform_values[0], impl->m_uniform_values.size());
+
+        for (size_t i = 0, e = impl->m_varying_inputs.size(); i < e; ++i)
+        {
+            impl->m_inputs[impl->m_varying_inputs[i]].evaluate(
+                texture_cache,
+                uv,
+                duvdx,
+                duvdy,
+                ptr + impl->m_varying_offsets[i]);
+        }
+    }
+    else
+    {
+        for (const_each<InputVector> i = impl->m_inputs; i; ++i)
+            ptr = i->evaluate(texture_cache, uv, duvdx, duvdy, ptr);
+    }
 }
 
 void InputArray::evaluate_uniforms(
@@ -505,6 +553,33 @@ void InputArray::evaluate_uniforms(
         ptr = i->evaluate_uniform(ptr);
 }
 
+void InputArray::precompute_uniform_values()
+{
+    impl->invalidate_uniform_values();
+
+    const size_t data_size = compute_data_size();
+    if (data_size == 0)
+        return;
+
+    size_t offset = 0;
+
+    for (size_t i = 0, e = impl->m_inputs.size(); i < e; ++i)
+    {
+        const Input& input = impl->m_inputs[i];
+
+        if (input.m_source && !input.m_source->is_uniform())
+        {
+            impl->m_varying_inputs.push_back(i);
+            impl->m_varying_offsets.push_back(offset);
+        }
+
+        offset = input.add_size(offset);
+    }
+
+    impl->m_uniform_values.resize(data_size);
+    evaluate_uniforms(&impl->m_uniform_values[0]);
+}
+
 
 //
 // InputArray::const_iterator class implementation.
@@ -637,6 +712,8 @@ void InputArray::iterator::bind(Source* source)
     Input& input = m_input_array->impl->m_inputs[m_input_index];
     delete input.m_source;
     input.m_source = source;
+
+    m_input_array->impl->invalidate_uniform_values();
 }
 
 void InputArray::iterator::bind(Entity* entity)
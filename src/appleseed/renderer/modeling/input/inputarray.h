@@ -221,11 +221,24 @@ class APPLESEED_DLLSYMBOL InputArray
         const foundation::Vector2f& uv,
         void*                       values) const;
 
+    // Same as above, but also provide the screen space partial derivatives of the
+    // texture coordinates to allow sources to filter their values.
+    void evaluate(
+        TextureCache&               texture_cache,
+        const foundation::Vector2f& uv,
+        const foundation::Vector2f& duvdx,
+        const foundation::Vector2f& duvdy,
+        void*                       values) const;
+
     // Evaluate all uniform inputs into a preallocated block of memory.
     // 'values' must be 16-byte aligned.
     void evaluate_uniforms(
         void*                       values) const;
 
+    // Precompute the values of all uniform inputs so that evaluate() only needs to evaluate
+    // varying inputs. Binding a new source to any input discards the precomputed values.
+    void precompute_uniform_values();
+
   private:
     struct Impl;
     Impl* impl;
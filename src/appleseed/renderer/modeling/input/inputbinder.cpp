@@ -80,6 +80,7 @@ namespace renderer
 
 InputBinder::InputBinder()
   : m_error_count(0)
+  , m_texture_instance_count(0)
 {
 }
 
@@ -100,6 +101,17 @@ void InputBinder::bind(const Scene& scene)
             assert(m_assembly_info.empty());
             bind_assembly_entities_inputs(scene, scene_symbols, *i);
         }
+
+        // Texture files of texture instances that no input references are never opened.
+        if (m_referenced_texture_instances.size() < m_texture_instance_count)
+        {
+            RENDERER_LOG_DEBUG(
+                FMT_SIZE_T " texture instance%s out of " FMT_SIZE_T " %s not referenced and will not be loaded.",
+                m_texture_instance_count - m_referenced_texture_instances.size(),
+                m_texture_instance_count - m_referenced_texture_instances.size() > 1 ? "s" : "",
+                m_texture_instance_count,
+                m_texture_instance_count - m_referenced_texture_instances.size() > 1 ? "are" : "is");
+        }
     }
     catch (const ExceptionUnknownEntity& e)
     {
@@ -194,6 +206,7 @@ void InputBinder::bind_scene_entities_inputs(
         i->unbind_texture();
         i->bind_texture(scene.textures());
         i->check_texture();
+        ++m_texture_instance_count;
     }
 
     // Bind the inputs of the default surface shader.
@@ -311,6 +324,8 @@ void InputBinder::bind_scene_entity_inputs(
 
         ++m_error_count;
     }
+
+    entity.get_inputs().precompute_uniform_values();
 }
 
 void InputBinder::bind_assembly_entities_inputs(
@@ -341,6 +356,7 @@ void InputBinder::bind_assembly_entities_inputs(
         i->bind_texture(scene.textures());
 
         i->check_texture();
+        ++m_texture_instance_count;
     }
 
     // Bind BSDFs inputs.
@@ -534,6 +550,8 @@ void InputBinder::bind_assembly_entity_inputs(
 
         ++m_error_count;
     }
+
+    entity.get_inputs().precompute_uniform_values();
 }
 
 bool InputBinder::try_bind_scene_entity_to_input(
@@ -715,6 +733,10 @@ void InputBinder::bind_texture_instance_to_input(
 
     try
     {
+        // Texture instances are only inspected once they are known to be referenced.
+        if (m_referenced_texture_instances.insert(texture_instance).second)
+            texture_instance->detect_alpha_mode();
+
         input.bind(
             new TextureSource(
                 assembly_uid,
@@ -44,6 +44,7 @@
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -51,6 +52,7 @@
 namespace renderer  { class ConnectableEntity; }
 namespace renderer  { class Scene; }
 namespace renderer  { class SymbolTable; }
+namespace renderer  { class TextureInstance; }
 
 namespace renderer
 {
@@ -90,6 +92,8 @@ class InputBinder
 
     size_t                  m_error_count;
     AssemblyInfoVector      m_assembly_info;
+    size_t                  m_texture_instance_count;
+    std::set<const TextureInstance*> m_referenced_texture_instances;
 
     // Build the symbol table for a given scene.
     void build_scene_symbol_table(
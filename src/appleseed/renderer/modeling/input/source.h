@@ -91,6 +91,30 @@ class Source
         Spectrum&                   spectrum,
         Alpha&                      alpha) const;
 
+    // Evaluate the source at a given shading point, given the screen space partial
+    // derivatives of the texture coordinates. Sources that support filtering (such
+    // as texture sources) use them to select a level of detail; the default
+    // implementations ignore them.
+    virtual void evaluate(
+        TextureCache&               texture_cache,
+        const foundation::Vector2f& uv,
+        const foundation::Vector2f& duvdx,
+        const foundation::Vector2f& duvdy,
+        float&                      scalar) const;
+    virtual void evaluate(
+        TextureCache&               texture_cache,
+        const foundation::Vector2f& uv,
+        const foundation::Vector2f& duvdx,
+        const foundation::Vector2f& duvdy,
+        Spectrum&                   spectrum) const;
+    virtual void evaluate(
+        TextureCache&               texture_cache,
+        const foundation::Vector2f& uv,
+        const foundation::Vector2f& duvdx,
+        const foundation::Vector2f& duvdy,
+        Spectrum&                   spectrum,
+        Alpha&                      alpha) const;
+
     // Evaluate the source as a uniform source.
     virtual void evaluate_uniform(
         float&                      scalar) const;
@@ -180,6 +204,37 @@ inline void Source::evaluate(
     evaluate_uniform(spectrum, alpha);
 }
 
+inline void Source::evaluate(
+    TextureCache&                   texture_cache,
+    const foundation::Vector2f&     uv,
+    const foundation::Vector2f&     duvdx,
+    const foundation::Vector2f&     duvdy,
+    float&                          scalar) const
+{
+    evaluate(texture_cache, uv, scalar);
+}
+
+inline void Source::evaluate(
+    TextureCache&                   texture_cache,
+    const foundation::Vector2f&     uv,
+    const foundation::Vector2f&     duvdx,
+    const foundation::Vector2f&     duvdy,
+    Spectrum&                       spectrum) const
+{
+    evaluate(texture_cache, uv, spectrum);
+}
+
+inline void Source::evaluate(
+    TextureCache&                   texture_cache,
+    const foundation::Vector2f&     uv,
+    const foundation::Vector2f&     duvdx,
+    const foundation::Vector2f&     duvdy,
+    Spectrum&                       spectrum,
+    Alpha&                          alpha) const
+{
+    evaluate(texture_cache, uv, spectrum, alpha);
+}
+
 inline void Source::evaluate_uniform(
     float&                          scalar) const
 {
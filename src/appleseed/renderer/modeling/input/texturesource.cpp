@@ -32,16 +32,20 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/modeling/entity/entity.h"
 #include "renderer/modeling/texture/texture.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/tile.h"
+#include "foundation/math/fastmath.h"
 #include "foundation/math/hash.h"
 #include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 
 using namespace foundation;
@@ -141,6 +145,7 @@ namespace
         TextureCache&               texture_cache,
         const UniqueID              assembly_uid,
         const UniqueID              texture_uid,
+        const size_t                level,
         const size_t                tile_x,
         const size_t                tile_y,
         const size_t                pixel_x,
@@ -153,7 +158,8 @@ namespace
                 assembly_uid,
                 texture_uid,
                 tile_x,
-                tile_y);
+                tile_y,
+                level);
 
         // Sample the tile.
         if (tile.get_channel_count() == 3)
@@ -182,6 +188,10 @@ TextureSource::TextureSource(
   , m_scalar_canvas_height(static_cast<float>(m_texture_props.m_canvas_height))
   , m_max_x(static_cast<float>(m_texture_props.m_canvas_width - 1))
   , m_max_y(static_cast<float>(m_texture_props.m_canvas_height - 1))
+  , m_level_count(
+        TextureStore::get_mip_level_count(
+            m_texture_props.m_canvas_width,
+            m_texture_props.m_canvas_height))
 {
 }
 
@@ -204,11 +214,13 @@ Vector2f TextureSource::apply_transform(const Vector2f& uv) const
 
 Color4f TextureSource::get_texel(
     TextureCache&               texture_cache,
+    const size_t                level,
     const size_t                ix,
     const size_t                iy) const
 {
-    assert(ix < m_texture_props.m_canvas_width);
-    assert(iy < m_texture_props.m_canvas_height);
+    assert(level < m_level_count);
+    assert(ix < TextureStore::get_mip_level_size(m_texture_props.m_canvas_width, level));
+    assert(iy < TextureStore::get_mip_level_size(m_texture_props.m_canvas_height, level));
 
     // Compute the coordinates of the tile containing the texel (x, y).
     const size_t tile_x = truncate<size_t>(ix * m_texture_props.m_rcp_tile_width);
@@ -240,6 +252,7 @@ Color4f TextureSource::get_texel(
         texture_cache,
         m_assembly_uid,
         m_texture_uid,
+        level,
         tile_x,
         tile_y,
         pixel_x,
@@ -251,6 +264,7 @@ Color4f TextureSource::get_texel(
 
 void TextureSource::get_texels_2x2(
     TextureCache&               texture_cache,
+    const size_t                level,
     const int                   ix,
     const int                   iy,
     Color4f&                    t00,
@@ -258,19 +272,24 @@ void TextureSource::get_texels_2x2(
     Color4f&                    t01,
     Color4f&                    t11) const
 {
+    assert(level < m_level_count);
+
+    const size_t level_width = TextureStore::get_mip_level_size(m_texture_props.m_canvas_width, level);
+    const size_t level_height = TextureStore::get_mip_level_size(m_texture_props.m_canvas_height, level);
+
     const Vector<size_t, 2> p00 =
         constrain_to_canvas(
             m_texture_instance.get_addressing_mode(),
-            m_texture_props.m_canvas_width,
-            m_texture_props.m_canvas_height,
+            level_width,
+            level_height,
             ix + 0,
             iy + 0);
 
     const Vector<size_t, 2> p11 =
         constrain_to_canvas(
             m_texture_instance.get_addressing_mode(),
-            m_texture_props.m_canvas_width,
-            m_texture_props.m_canvas_height,
+            level_width,
+            level_height,
             ix + 1,
             iy + 1);
 
@@ -296,10 +315,10 @@ void TextureSource::get_texels_2x2(
         const size_t pixel_y_11 = p11.y - tile_y_11 * m_texture_props.m_tile_height;
 
         // Sample the tile.
-        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, tile_x_00, tile_y_00, pixel_x_00, pixel_y_00, t00);
-        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, tile_x_11, tile_y_00, pixel_x_11, pixel_y_00, t10);
-        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, tile_x_00, tile_y_11, pixel_x_00, pixel_y_11, t01);
-        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, tile_x_11, tile_y_11, pixel_x_11, pixel_y_11, t11);
+        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, level, tile_x_00, tile_y_00, pixel_x_00, pixel_y_00, t00);
+        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, level, tile_x_11, tile_y_00, pixel_x_11, pixel_y_00, t10);
+        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, level, tile_x_00, tile_y_11, pixel_x_00, pixel_y_11, t01);
+        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, level, tile_x_11, tile_y_11, pixel_x_11, pixel_y_11, t11);
     }
     else
     {
@@ -317,7 +336,8 @@ void TextureSource::get_texels_2x2(
                 m_assembly_uid,
                 m_texture_uid,
                 tile_x_00,
-                tile_y_00);
+                tile_y_00,
+                level);
 
         // Sample the tile.
         if (tile.get_channel_count() == 3)
@@ -358,48 +378,49 @@ void TextureSource::get_texels_2x2(
     }
 }
 
-Color4f TextureSource::sample_texture(
+Color4f TextureSource::sample_level(
     TextureCache&               texture_cache,
-    const Vector2f&             uv) const
+    const size_t                level,
+    const Vector2f&             p) const
 {
-    // Start with the transformed input texture coordinates.
-    Vector2f p = apply_transform(uv);
-    p.y = 1.0f - p.y;
-
-    // Apply the texture addressing mode.
-    apply_addressing_mode(m_texture_instance.get_addressing_mode(), p);
+    // Dimensions of this MIP level.
+    const size_t level_width = TextureStore::get_mip_level_size(m_texture_props.m_canvas_width, level);
+    const size_t level_height = TextureStore::get_mip_level_size(m_texture_props.m_canvas_height, level);
+    const float max_x = static_cast<float>(level_width - 1);
+    const float max_y = static_cast<float>(level_height - 1);
 
     switch (m_texture_instance.get_filtering_mode())
     {
       case TextureFilteringNearest:
         {
-            p.x = clamp(p.x * m_scalar_canvas_width, 0.0f, m_max_x);
-            p.y = clamp(p.y * m_scalar_canvas_height, 0.0f, m_max_y);
+            const float x = clamp(p.x * static_cast<float>(level_width), 0.0f, max_x);
+            const float y = clamp(p.y * static_cast<float>(level_height), 0.0f, max_y);
 
-            const size_t ix = truncate<size_t>(p.x);
-            const size_t iy = truncate<size_t>(p.y);
+            const size_t ix = truncate<size_t>(x);
+            const size_t iy = truncate<size_t>(y);
 
-            return get_texel(texture_cache, ix, iy);
+            return get_texel(texture_cache, level, ix, iy);
         }
 
       case TextureFilteringBilinear:
         {
-            p.x *= m_max_x;
-            p.y *= m_max_y;
+            const float x = p.x * max_x;
+            const float y = p.y * max_y;
 
-            const int ix = truncate<int>(p.x);
-            const int iy = truncate<int>(p.y);
+            const int ix = truncate<int>(x);
+            const int iy = truncate<int>(y);
 
             // Retrieve the four surrounding texels.
             Color4f t00, t10, t01, t11;
             get_texels_2x2(
                 texture_cache,
+                level,
                 ix, iy,
                 t00, t10, t01, t11);
 
             // Compute weights.
-            const float wx1 = p.x - ix;
-            const float wy1 = p.y - iy;
+            const float wx1 = x - ix;
+            const float wy1 = y - iy;
             const float wx0 = 1.0f - wx1;
             const float wy0 = 1.0f - wy1;
 
@@ -423,4 +444,69 @@ Color4f TextureSource::sample_texture(
     }
 }
 
+Color4f TextureSource::sample_texture(
+    TextureCache&               texture_cache,
+    const Vector2f&             uv) const
+{
+    // Start with the transformed input texture coordinates.
+    Vector2f p = apply_transform(uv);
+    p.y = 1.0f - p.y;
+
+    // Apply the texture addressing mode.
+    apply_addressing_mode(m_texture_instance.get_addressing_mode(), p);
+
+    return sample_level(texture_cache, 0, p);
+}
+
+Color4f TextureSource::sample_texture(
+    TextureCache&               texture_cache,
+    const Vector2f&             uv,
+    const Vector2f&             duvdx,
+    const Vector2f&             duvdy) const
+{
+    // Start with the transformed input texture coordinates.
+    Vector2f p = apply_transform(uv);
+    p.y = 1.0f - p.y;
+
+    // Apply the texture addressing mode.
+    apply_addressing_mode(m_texture_instance.get_addressing_mode(), p);
+
+    if (m_level_count == 1)
+        return sample_level(texture_cache, 0, p);
+
+    // Transform the partial derivatives to texel space.
+    const Vector3f dx = m_texture_transform.vector_to_local(Vector3f(duvdx.x, duvdx.y, 0.0f));
+    const Vector3f dy = m_texture_transform.vector_to_local(Vector3f(duvdy.x, duvdy.y, 0.0f));
+    const Vector2f dx_texels(dx.x * m_scalar_canvas_width, dx.y * m_scalar_canvas_height);
+    const Vector2f dy_texels(dy.x * m_scalar_canvas_width, dy.y * m_scalar_canvas_height);
+
+    // Compute the level of detail from the largest extent of the footprint.
+    const float width = max(norm(dx_texels), norm(dy_texels));
+    if (!(width > 1.0f))
+        return sample_level(texture_cache, 0, p);
+
+    const float max_lod = static_cast<float>(m_level_count - 1);
+    const float lod = min(fast_log2(width), max_lod);
+
+    if (m_texture_instance.get_filtering_mode() == TextureFilteringNearest)
+        return sample_level(texture_cache, round<size_t>(lod), p);
+
+    // Blend the two nearest MIP levels.
+    const size_t level = truncate<size_t>(lod);
+    if (level + 1 >= m_level_count)
+        return sample_level(texture_cache, level, p);
+
+    const float w1 = lod - static_cast<float>(level);
+
+    Color4f result = sample_level(texture_cache, level, p);
+    result *= 1.0f - w1;
+
+    Color4f next = sample_level(texture_cache, level + 1, p);
+    next *= w1;
+
+    result += next;
+
+    return result;
+}
+
 }   // namespace renderer
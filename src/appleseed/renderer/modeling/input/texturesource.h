@@ -100,6 +100,28 @@ class TextureSource
         Spectrum&                           spectrum,
         Alpha&                              alpha) const APPLESEED_OVERRIDE;
 
+    // Evaluate the source at a given shading point, filtering the texture according
+    // to the screen space partial derivatives of the texture coordinates.
+    virtual void evaluate(
+        TextureCache&                       texture_cache,
+        const foundation::Vector2f&         uv,
+        const foundation::Vector2f&         duvdx,
+        const foundation::Vector2f&         duvdy,
+        float&                              scalar) const APPLESEED_OVERRIDE;
+    virtual void evaluate(
+        TextureCache&                       texture_cache,
+        const foundation::Vector2f&         uv,
+        const foundation::Vector2f&         duvdx,
+        const foundation::Vector2f&         duvdy,
+        Spectrum&                           spectrum) const APPLESEED_OVERRIDE;
+    virtual void evaluate(
+        TextureCache&                       texture_cache,
+        const foundation::Vector2f&         uv,
+        const foundation::Vector2f&         duvdx,
+        const foundation::Vector2f&         duvdy,
+        Spectrum&                           spectrum,
+        Alpha&                              alpha) const APPLESEED_OVERRIDE;
+
   private:
     const foundation::UniqueID              m_assembly_uid;
     const TextureInstance&                  m_texture_instance;
@@ -110,20 +132,23 @@ class TextureSource
     const float                             m_scalar_canvas_height;
     const float                             m_max_x;
     const float                             m_max_y;
+    const size_t                            m_level_count;
 
     // Apply the texture instance transform to UV coordinates.
     foundation::Vector2f apply_transform(
         const foundation::Vector2f&         uv) const;
 
-    // Retrieve a given texel. Return a color in the linear RGB color space.
+    // Retrieve a given texel of a given MIP level. Return a color in the linear RGB color space.
     foundation::Color4f get_texel(
         TextureCache&                       texture_cache,
+        const size_t                        level,
         const size_t                        ix,
         const size_t                        iy) const;
 
-    // Retrieve a 2x2 block of texels. Texels are expressed in the linear RGB color space.
+    // Retrieve a 2x2 block of texels of a given MIP level. Texels are expressed in the linear RGB color space.
     void get_texels_2x2(
         TextureCache&                       texture_cache,
+        const size_t                        level,
         const int                           ix,
         const int                           iy,
         foundation::Color4f&                t00,
@@ -131,11 +156,25 @@ class TextureSource
         foundation::Color4f&                t01,
         foundation::Color4f&                t11) const;
 
-    // Sample the texture. Return a color in the linear RGB color space.
+    // Sample a given MIP level of the texture at given (addressed) texture coordinates.
+    foundation::Color4f sample_level(
+        TextureCache&                       texture_cache,
+        const size_t                        level,
+        const foundation::Vector2f&         p) const;
+
+    // Sample the base level of the texture. Return a color in the linear RGB color space.
     foundation::Color4f sample_texture(
         TextureCache&                       texture_cache,
         const foundation::Vector2f&         uv) const;
 
+    // Sample the texture, selecting the MIP level(s) from the footprint of the shading point
+    // in texture space. Return a color in the linear RGB color space.
+    foundation::Color4f sample_texture(
+        TextureCache&                       texture_cache,
+        const foundation::Vector2f&         uv,
+        const foundation::Vector2f&         duvdx,
+        const foundation::Vector2f&         duvdy) const;
+
     // Compute an alpha value given a linear RGBA color and the alpha mode of the texture instance.
     void evaluate_alpha(
         const foundation::Color4f&          color,
@@ -210,6 +249,41 @@ inline void TextureSource::evaluate(
     evaluate_alpha(color, alpha);
 }
 
+inline void TextureSource::evaluate(
+    TextureCache&                           texture_cache,
+    const foundation::Vector2f&             uv,
+    const foundation::Vector2f&             duvdx,
+    const foundation::Vector2f&             duvdy,
+    float&                                  scalar) const
+{
+    const foundation::Color4f color = sample_texture(texture_cache, uv, duvdx, duvdy);
+    scalar = color[0];
+}
+
+inline void TextureSource::evaluate(
+    TextureCache&                           texture_cache,
+    const foundation::Vector2f&             uv,
+    const foundation::Vector2f&             duvdx,
+    const foundation::Vector2f&             duvdy,
+    Spectrum&                               spectrum) const
+{
+    const foundation::Color4f color = sample_texture(texture_cache, uv, duvdx, duvdy);
+    spectrum = color.rgb();
+}
+
+inline void TextureSource::evaluate(
+    TextureCache&                           texture_cache,
+    const foundation::Vector2f&             uv,
+    const foundation::Vector2f&             duvdx,
+    const foundation::Vector2f&             duvdy,
+    Spectrum&                               spectrum,
+    Alpha&                                  alpha) const
+{
+    const foundation::Color4f color = sample_texture(texture_cache, uv, duvdx, duvdy);
+    spectrum = color.rgb();
+    evaluate_alpha(color, alpha);
+}
+
 inline void TextureSource::evaluate_alpha(
     const foundation::Color4f&              color,
     Alpha&                                  alpha) const
@@ -41,6 +41,7 @@
 #include "renderer/modeling/scene/scene.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/regularspectrum.h"
 #include "foundation/math/basis.h"
 #include "foundation/math/sampling/mappings.h"
 #include "foundation/math/scalar.h"
@@ -241,8 +242,8 @@ namespace
 
         InputValues     m_values;
 
-        Spectrum        m_k1;
-        Spectrum        m_k2;
+        RegularSpectrum31f  m_k1;
+        RegularSpectrum31f  m_k2;
 
         void apply_env_edf_overrides(const EnvironmentEDF* env_edf)
         {
@@ -278,14 +279,12 @@ namespace
 
         void precompute_constants()
         {
-            m_k1.resize(Spectrum::Samples);
-            for (size_t i = 0; i < Spectrum::Samples; ++i)
+            for (size_t i = 0; i < RegularSpectrum31f::Samples; ++i)
                 m_k1[i] = -0.008735f * pow(g_light_wavelengths_um[i], -4.08f);
 
             const float Alpha = 1.3f;               // ratio of small to large particle sizes (0 to 4, typically 1.3)
 
-            m_k2.resize(Spectrum::Samples);
-            for (size_t i = 0; i < Spectrum::Samples; ++i)
+            for (size_t i = 0; i < RegularSpectrum31f::Samples; ++i)
                 m_k2[i] = pow(g_light_wavelengths_um[i], -Alpha);
         }
 
@@ -301,15 +300,13 @@ namespace
             const float m = 1.0f / (cos_theta + 0.15f * pow(93.885f - rad_to_deg(theta), -1.253f));
 
             // Compute transmittance due to Rayleigh scattering.
-            Spectrum tau_r;
-            tau_r.resize(Spectrum::Samples);
+            RegularSpectrum31f tau_r;
             for (size_t i = 0; i < 31; ++i)
                 tau_r[i] = exp(m * m_k1[i]);
 
             // Compute transmittance due to aerosols.
             const float beta = 0.04608f * turbidity - 0.04586f;
-            Spectrum tau_a;
-            tau_a.resize(Spectrum::Samples);
+            RegularSpectrum31f tau_a;
             for (size_t i = 0; i < 31; ++i)
                 tau_a[i] = exp(-beta * m * m_k2[i]);
 
@@ -326,8 +323,7 @@ namespace
                 0.079f, 0.067f, 0.057f, 0.048f,
                 0.036f, 0.028f, 0.023f
             };
-            Spectrum tau_o;
-            tau_o.resize(Spectrum::Samples);
+            RegularSpectrum31f tau_o;
             for (size_t i = 0; i < 31; ++i)
                 tau_o[i] = exp(-Ko[i] * L * m);
 
@@ -345,8 +341,7 @@ namespace
                 0.000f, 0.000f, 0.000f, 0.000f,
                 0.000f, 0.000f, 0.000f
             };
-            Spectrum tau_g;
-            tau_g.resize(Spectrum::Samples);
+            RegularSpectrum31f tau_g;
             for (size_t i = 0; i < 31; ++i)
                 tau_g[i] = exp(-1.41f * Kg[i] * m / pow(1.0f + 118.93f * Kg[i] * m, 0.45f));
 #endif
@@ -364,8 +359,7 @@ namespace
                 0.000f, 0.000f, 0.000f, 0.000f,
                 0.000f, 0.016f, 0.024f
             };
-            Spectrum tau_wa;
-            tau_wa.resize(Spectrum::Samples);
+            RegularSpectrum31f tau_wa;
             for (size_t i = 0; i < 31; ++i)
                 tau_wa[i] = exp(-0.2385f * Kwa[i] * W * m / pow(1.0f + 20.07f * Kwa[i] * W * m, 0.45f));
 
@@ -386,14 +380,15 @@ namespace
             };
 
             // Compute the attenuated radiance of the Sun.
-            radiance = Spectrum(SunRadianceValues, Spectrum::Illuminance);
-            radiance *= tau_r;
-            radiance *= tau_a;
-            radiance *= tau_o;
+            RegularSpectrum31f sun_radiance(SunRadianceValues);
+            sun_radiance *= tau_r;
+            sun_radiance *= tau_a;
+            sun_radiance *= tau_o;
 #ifdef COMPUTE_REDUNDANT
-            radiance *= tau_g;      // always 1.0
+            sun_radiance *= tau_g;  // always 1.0
 #endif
-            radiance *= tau_wa;
+            sun_radiance *= tau_wa;
+            radiance = Spectrum(sun_radiance, Spectrum::Illuminance);
             radiance *= radiance_multiplier;
         }
 
@@ -51,6 +51,8 @@
 
 // Standard headers.
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <string>
@@ -65,6 +67,25 @@ namespace renderer
 
 namespace
 {
+    //
+    // Prepared expressions are shared by the layers of all the Disney materials evaluated
+    // by the same rendering thread. The last cache is used outside of rendering threads.
+    //
+
+    const size_t MaxExprCacheThreadCount = 256;
+
+    SeAppleseedExprCache g_expr_caches[MaxExprCacheThreadCount + 1];
+
+    SeAppleseedExprCache& get_expr_cache(const size_t thread_index)
+    {
+        if (thread_index == size_t(~0))
+            return g_expr_caches[MaxExprCacheThreadCount];
+
+        assert(thread_index < MaxExprCacheThreadCount);
+        return g_expr_caches[thread_index];
+    }
+
+
     //
     // The DisneyLayerParam class wraps an SeAppleseedExpr object to add basic optimizations
     // for straightforward expressions such as a single scalar or a simple texture lookup.
@@ -82,9 +103,12 @@ namespace
           , m_is_vector(is_vector)
           , m_is_constant(false)
           , m_texture_is_srgb(true)
+          , m_expr_cache(0)
+          , m_expression(0)
         {
         }
 
+        // The copy shares the prepared expression of the original.
         DisneyLayerParam(const DisneyLayerParam& other)
           : m_param_name(other.m_param_name)
           , m_expr(other.m_expr)
@@ -94,7 +118,16 @@ namespace
           , m_texture_filename(other.m_texture_filename)
           , m_texture_options(other.m_texture_options)
           , m_texture_is_srgb(other.m_texture_is_srgb)
+          , m_expr_cache(other.m_expr_cache)
+          , m_expression(0)
         {
+            if (other.m_expression)
+                m_expression = m_expr_cache->acquire(m_expr, m_is_vector);
+        }
+
+        ~DisneyLayerParam()
+        {
+            release_expression();
         }
 
         string& expression()
@@ -107,30 +140,32 @@ namespace
             return m_expr;
         }
 
-        bool prepare()
+        bool prepare(SeAppleseedExprCache& expr_cache)
         {
-            m_expression.setWantVec(m_is_vector);
-            m_expression.set_expr(m_expr);
+            release_expression();
+
+            m_expr_cache = &expr_cache;
+            m_expression = expr_cache.acquire(m_expr, m_is_vector);
 
-            if (!m_expression.isValid())
+            if (!m_expression->isValid())
             {
                 RENDERER_LOG_ERROR("expression error for \"%s\" parameter: %s",
-                    m_param_name, m_expression.parseError().c_str());
+                    m_param_name, m_expression->parseError().c_str());
                 return false;
             }
 
             // Case of a simple constant.
-            m_is_constant = m_expression.isConstant();
+            m_is_constant = m_expression->isConstant();
             if (m_is_constant)
             {
-                const SeVec3d result = m_expression.evaluate();
+                const SeVec3d result = m_expression->evaluate();
                 m_constant_value = Color3d(result[0], result[1], result[2]);
                 return true;
             }
 
             // Case of a simple texture lookup of the form texture("path/to/texture", $u, $v).
             {
-                const string expression = trim_both(m_expression.getExpr(), " \r\n");
+                const string expression = trim_both(m_expression->getExpr(), " \r\n");
                 vector<string> tokens;
                 tokenize(expression, "()", tokens);
 
@@ -204,7 +239,7 @@ namespace
             }
 
             return
-                m_expression.update_and_evaluate(
+                m_expression->update_and_evaluate(
                     shading_point,
                     texture_system);
         }
@@ -218,7 +253,19 @@ namespace
         OIIO::ustring               m_texture_filename;
         mutable OIIO::TextureOpt    m_texture_options;
         bool                        m_texture_is_srgb;
-        mutable SeAppleseedExpr     m_expression;
+        SeAppleseedExprCache*       m_expr_cache;
+        SeAppleseedExpr*            m_expression;       // owned by m_expr_cache
+
+        DisneyLayerParam& operator=(const DisneyLayerParam& rhs);
+
+        void release_expression()
+        {
+            if (m_expression)
+            {
+                m_expr_cache->release(m_expr, m_is_vector);
+                m_expression = 0;
+            }
+        }
     };
 }
 
@@ -311,21 +358,23 @@ int DisneyMaterialLayer::get_layer_number() const
     return impl->m_layer_number;
 }
 
-bool DisneyMaterialLayer::prepare_expressions() const
+bool DisneyMaterialLayer::prepare_expressions(const size_t thread_index) const
 {
+    SeAppleseedExprCache& expr_cache = get_expr_cache(thread_index);
+
     return
-        impl->m_mask.prepare() &&
-        impl->m_base_color.prepare() &&
-        impl->m_subsurface.prepare() &&
-        impl->m_metallic.prepare() &&
-        impl->m_specular.prepare() &&
-        impl->m_specular_tint.prepare() &&
-        impl->m_anisotropic.prepare() &&
-        impl->m_roughness.prepare() &&
-        impl->m_sheen.prepare() &&
-        impl->m_sheen_tint.prepare() &&
-        impl->m_clearcoat.prepare() &&
-        impl->m_clearcoat_gloss.prepare();
+        impl->m_mask.prepare(expr_cache) &&
+        impl->m_base_color.prepare(expr_cache) &&
+        impl->m_subsurface.prepare(expr_cache) &&
+        impl->m_metallic.prepare(expr_cache) &&
+        impl->m_specular.prepare(expr_cache) &&
+        impl->m_specular_tint.prepare(expr_cache) &&
+        impl->m_anisotropic.prepare(expr_cache) &&
+        impl->m_roughness.prepare(expr_cache) &&
+        impl->m_sheen.prepare(expr_cache) &&
+        impl->m_sheen_tint.prepare(expr_cache) &&
+        impl->m_clearcoat.prepare(expr_cache) &&
+        impl->m_clearcoat_gloss.prepare(expr_cache);
 }
 
 void DisneyMaterialLayer::evaluate_expressions(
@@ -754,7 +803,7 @@ const DisneyMaterialLayer& DisneyMaterial::get_layer(
 
         for (const_each<vector<DisneyMaterialLayer> > it = *layers; it; ++it)
         {
-            APPLESEED_UNUSED const bool ok = it->prepare_expressions();
+            APPLESEED_UNUSED const bool ok = it->prepare_expressions(thread_index);
             assert(ok);
         }
 
@@ -826,6 +875,7 @@ DictionaryArray DisneyMaterialFactory::get_input_metadata() const
 
     add_alpha_map_metadata(metadata);
     add_displacement_metadata(metadata);
+    add_volume_metadata(metadata);
 
     return metadata;
 }
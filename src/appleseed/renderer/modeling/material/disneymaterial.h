@@ -48,6 +48,9 @@ BEGIN_OIIO_INCLUDES
 #include "OpenImageIO/texture.h"
 END_OIIO_INCLUDES
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation    { class Dictionary; }
 namespace foundation    { class DictionaryArray; }
@@ -85,7 +88,9 @@ class APPLESEED_DLLSYMBOL DisneyMaterialLayer
 
     int get_layer_number() const;
 
-    bool prepare_expressions() const;
+    // Parse and prepare the expressions of the layer, or retrieve them from the
+    // expressions already prepared for the given rendering thread.
+    bool prepare_expressions(const size_t thread_index = ~0) const;
 
     void evaluate_expressions(
         const ShadingPoint&             shading_point,
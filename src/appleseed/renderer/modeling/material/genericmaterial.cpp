@@ -155,6 +155,7 @@ DictionaryArray GenericMaterialFactory::get_input_metadata() const
 
     add_alpha_map_metadata(metadata);
     add_displacement_metadata(metadata);
+    add_volume_metadata(metadata);
 
     return metadata;
 }
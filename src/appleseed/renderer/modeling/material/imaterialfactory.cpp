@@ -137,4 +137,62 @@ void IMaterialFactory::add_displacement_metadata(DictionaryArray& metadata)
                     .insert("displacement_method", "normal")));
 }
 
+void IMaterialFactory::add_volume_metadata(DictionaryArray& metadata)
+{
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "volume_file")
+            .insert("label", "Fluid File")
+            .insert("type", "file")
+            .insert("file_picker_mode", "open")
+            .insert("file_picker_type", "fluid")
+            .insert("use", "optional"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "volume_bbox_min")
+            .insert("label", "Fluid Box Min Corner")
+            .insert("type", "text")
+            .insert("use", "optional")
+            .insert("default", "0.0 0.0 0.0"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "volume_bbox_max")
+            .insert("label", "Fluid Box Max Corner")
+            .insert("type", "text")
+            .insert("use", "optional")
+            .insert("default", "1.0 1.0 1.0"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "volume_density_scale")
+            .insert("label", "Fluid Density Scale")
+            .insert("type", "numeric")
+            .insert("min_value", "0.0")
+            .insert("max_value", "100.0")
+            .insert("use", "optional")
+            .insert("default", "1.0"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "volume_albedo")
+            .insert("label", "Fluid Albedo")
+            .insert("type", "numeric")
+            .insert("min_value", "0.0")
+            .insert("max_value", "1.0")
+            .insert("use", "optional")
+            .insert("default", "0.8"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "volume_occupancy_threshold")
+            .insert("label", "Fluid Occupancy Threshold")
+            .insert("type", "numeric")
+            .insert("min_value", "0.0")
+            .insert("max_value", "1.0")
+            .insert("use", "optional")
+            .insert("default", "0.0"));
+}
+
 }   // namespace renderer
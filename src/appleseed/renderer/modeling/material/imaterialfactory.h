@@ -76,6 +76,7 @@ class APPLESEED_DLLSYMBOL IMaterialFactory
     static void add_surface_shader_metadata(foundation::DictionaryArray& metadata);
     static void add_alpha_map_metadata(foundation::DictionaryArray& metadata);
     static void add_displacement_metadata(foundation::DictionaryArray& metadata);
+    static void add_volume_metadata(foundation::DictionaryArray& metadata);
 };
 
 }       // namespace renderer
@@ -32,6 +32,11 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/volume/fluidvolume.h"
+#include "renderer/kernel/volume/sparsevoxelgrid.h"
+#include "renderer/kernel/volume/volume.h"
+#include "renderer/kernel/volume/volumefileformat.h"
+#include "renderer/kernel/volume/volumefilereader.h"
 #include "renderer/modeling/bsdf/bsdf.h"
 #include "renderer/modeling/bssrdf/bssrdf.h"
 #include "renderer/modeling/edf/edf.h"
@@ -50,11 +55,17 @@
 
 // appleseed.foundation headers.
 #include "foundation/image/colorspace.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
 #include "foundation/utility/api/apistring.h"
+#include "foundation/utility/iostreamop.h"
 #include "foundation/utility/makevector.h"
+#include "foundation/utility/searchpaths.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <exception>
+#include <memory>
 #include <string>
 
 using namespace foundation;
@@ -94,6 +105,11 @@ bool Material::has_alpha_map() const
     return get_non_empty(m_params, "alpha_map") != 0;
 }
 
+bool Material::has_volume() const
+{
+    return get_non_empty(m_params, "volume_file") != 0;
+}
+
 const char* Material::get_surface_shader_name() const
 {
     return get_non_empty(m_params, "surface_shader");
@@ -164,8 +180,28 @@ bool Material::on_frame_begin(
     m_render_data.m_alpha_map = get_uncached_alpha_map();
     m_render_data.m_shader_group = 0;
     m_render_data.m_basis_modifier = 0;
+    m_render_data.m_volume = 0;
+    m_render_data.m_uniform_alpha.set(1.0f);
+    m_render_data.m_varying_alpha = false;
+    m_render_data.m_osl_transparency = false;
     m_has_render_data = true;
 
+    if (m_render_data.m_alpha_map)
+    {
+        if (m_render_data.m_alpha_map->is_uniform())
+            m_render_data.m_alpha_map->evaluate_uniform(m_render_data.m_uniform_alpha);
+        else m_render_data.m_varying_alpha = true;
+    }
+
+    if (has_volume())
+    {
+        const EntityDefMessageContext context("material", this);
+
+        m_render_data.m_volume = create_volume(project, context);
+        if (m_render_data.m_volume == 0)
+            return false;
+    }
+
     return true;
 }
 
@@ -176,6 +212,7 @@ void Material::on_frame_end(
     if (m_has_render_data)
     {
         delete m_render_data.m_basis_modifier;
+        delete m_render_data.m_volume;
         m_has_render_data = false;
     }
 
@@ -256,4 +293,94 @@ IBasisModifier* Material::create_basis_modifier(const MessageContext& context) c
     }
 }
 
+FluidVolume* Material::create_volume(
+    const Project&          project,
+    const MessageContext&   context) const
+{
+    // Retrieve the world space box covered by the fluid.
+    const AABB3d bbox(
+        m_params.get_optional<Vector3d>("volume_bbox_min", Vector3d(0.0)),
+        m_params.get_optional<Vector3d>("volume_bbox_max", Vector3d(1.0)));
+    if (!bbox.is_valid() || bbox.rank() < 3)
+    {
+        RENDERER_LOG_ERROR(
+            "%s: the box covered by the fluid must have a non-zero volume.",
+            context.get());
+        return 0;
+    }
+
+    const string filepath = project.search_paths().qualify(m_params.get<string>("volume_file"));
+    const float density_scale = m_params.get_optional<float>("volume_density_scale", 1.0f);
+    const float albedo = m_params.get_optional<float>("volume_albedo", 0.8f);
+    const float occupancy_threshold = m_params.get_optional<float>("volume_occupancy_threshold", 0.0f);
+
+    // Volume files are memory-mapped and their density bricks are loaded on demand.
+    if (ends_with(lower_case(filepath), volume_file_format::Extension))
+    {
+        auto_ptr<VolumeFileReader> reader(new VolumeFileReader());
+
+        try
+        {
+            reader->open(filepath.c_str());
+        }
+        catch (const exception& e)
+        {
+            RENDERER_LOG_ERROR(
+                "%s: failed to open volume file \"%s\": %s.",
+                context.get(),
+                filepath.c_str(),
+                e.what());
+            return 0;
+        }
+
+        const size_t density_index = reader->find_channel("density");
+        if (density_index == VolumeFileReader::NotFound)
+        {
+            RENDERER_LOG_ERROR(
+                "%s: volume file \"%s\" has no density channel.",
+                context.get(),
+                filepath.c_str());
+            return 0;
+        }
+
+        auto_ptr<SparseVoxelGrid> grid(
+            new SparseVoxelGrid(
+                reader,
+                density_index,
+                project.get_volume_brick_store()));
+
+        return new FluidVolume(grid, bbox, density_scale, albedo, occupancy_threshold);
+    }
+
+    // Read the whole fluid file.
+    FluidChannels channels;
+    auto_ptr<VoxelGrid> grid = read_fluid_file(filepath.c_str(), channels);
+    if (grid.get() == 0)
+    {
+        RENDERER_LOG_ERROR(
+            "%s: failed to read fluid file \"%s\".",
+            context.get(),
+            filepath.c_str());
+        return 0;
+    }
+
+    if (channels.m_density_index == FluidChannels::NotPresent)
+    {
+        RENDERER_LOG_ERROR(
+            "%s: fluid file \"%s\" has no density channel.",
+            context.get(),
+            filepath.c_str());
+        return 0;
+    }
+
+    return
+        new FluidVolume(
+            grid,
+            channels.m_density_index,
+            bbox,
+            density_scale,
+            albedo,
+            occupancy_threshold);
+}
+
 }   // namespace renderer
@@ -31,6 +31,7 @@
 #define APPLESEED_RENDERER_MODELING_MATERIAL_MATERIAL_H
 
 // appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
 #include "renderer/modeling/entity/connectableentity.h"
 
 // appleseed.foundation headers.
@@ -50,6 +51,7 @@ namespace renderer      { class BaseGroup; }
 namespace renderer      { class BSDF; }
 namespace renderer      { class BSSRDF; }
 namespace renderer      { class EDF; }
+namespace renderer      { class FluidVolume; }
 namespace renderer      { class IBasisModifier; }
 namespace renderer      { class MessageContext; }
 namespace renderer      { class OnFrameBeginRecorder; }
@@ -82,6 +84,9 @@ class APPLESEED_DLLSYMBOL Material
     // Return true if this material has an alpha map.
     bool has_alpha_map() const;
 
+    // Return true if this material fills the inside of objects with a fluid volume.
+    bool has_volume() const;
+
     // Return the name the surface shader bound to this material, or 0 if the material doesn't have one.
     const char* get_surface_shader_name() const;
 
@@ -137,6 +142,15 @@ class APPLESEED_DLLSYMBOL Material
         const Source*               m_alpha_map;
         const ShaderGroup*          m_shader_group;
         const IBasisModifier*       m_basis_modifier;   // owned by RenderData
+        const FluidVolume*          m_volume;           // owned by RenderData
+
+        // Opacity inputs, packed for opacity-only shading of shadow and transparency rays.
+        Alpha                       m_uniform_alpha;    // value of a uniform alpha map, or 1
+        bool                        m_varying_alpha;    // true if the alpha map must be evaluated at each point
+        bool                        m_osl_transparency; // true if the OSL shader group computes transparency
+
+        // Return true if the material is fully opaque everywhere.
+        bool is_opaque() const;
     };
 
     // Return render-time data of this entity.
@@ -156,6 +170,10 @@ class APPLESEED_DLLSYMBOL Material
     const char* get_non_empty(const ParamArray& params, const char* name) const;
 
     IBasisModifier* create_basis_modifier(const MessageContext& context) const;
+
+    FluidVolume* create_volume(
+        const Project&              project,
+        const MessageContext&       context) const;
 };
 
 
@@ -174,6 +192,11 @@ inline const Material::RenderData& Material::get_render_data() const
     return m_render_data;
 }
 
+inline bool Material::RenderData::is_opaque() const
+{
+    return m_uniform_alpha[0] >= 1.0f && !m_varying_alpha && !m_osl_transparency;
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_MODELING_MATERIAL_MATERIAL_H
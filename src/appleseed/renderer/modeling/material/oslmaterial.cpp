@@ -117,6 +117,8 @@ namespace
 
             if (m_render_data.m_shader_group)
             {
+                m_render_data.m_osl_transparency = m_render_data.m_shader_group->has_transparency();
+
                 if (m_render_data.m_shader_group->has_bsdfs())
                     m_render_data.m_bsdf = m_osl_bsdf.get();
 
@@ -180,6 +182,7 @@ DictionaryArray OSLMaterialFactory::get_input_metadata() const
             .insert("use", "optional"));
 
     add_alpha_map_metadata(metadata);
+    add_volume_metadata(metadata);
 
     return metadata;
 }
@@ -29,9 +29,14 @@
 // Interface header.
 #include "curveobject.h"
 
+// appleseed.renderer headers.
+#include "renderer/utility/messagecontext.h"
+#include "renderer/utility/paramarray.h"
+
 // appleseed.foundation headers.
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/makevector.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
@@ -113,6 +118,18 @@ Lazy<RegionKit>& CurveObject::get_region_kit()
     return impl->m_lazy_region_kit;
 }
 
+CurveObject::CurveType CurveObject::get_curve_type() const
+{
+    const string curve_type =
+        m_params.get_optional<string>(
+            "curve_type",
+            "tube",
+            make_vector("tube", "ribbon"),
+            EntityDefMessageContext("curve object", this));
+
+    return curve_type == "ribbon" ? CurveTypeRibbon : CurveTypeTube;
+}
+
 void CurveObject::reserve_curves1(const size_t count)
 {
     impl->m_curves1.reserve(count);
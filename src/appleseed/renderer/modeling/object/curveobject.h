@@ -74,6 +74,16 @@ class APPLESEED_DLLSYMBOL CurveObject
     // Return the region kit of the object.
     virtual foundation::Lazy<RegionKit>& get_region_kit() APPLESEED_OVERRIDE;
 
+    // Shape used when intersecting the curves of this object.
+    enum CurveType
+    {
+        CurveTypeTube,      // accurate intersection of curves of varying width
+        CurveTypeRibbon     // coarse flat ribbons, much cheaper to intersect (e.g. distant fur)
+    };
+
+    // Return the curve type of the object, as set by the "curve_type" parameter.
+    CurveType get_curve_type() const;
+
     // Insert and access curves.
     void reserve_curves1(const size_t count);
     void reserve_curves3(const size_t count);
@@ -42,6 +42,7 @@
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <string>
 #include <vector>
@@ -92,13 +93,23 @@ struct MeshObject::Impl
     RegionKit                   m_region_kit;
     mutable Lazy<RegionKit>     m_lazy_region_kit;
     vector<string>              m_material_slots;
+    MeshObject*                 m_undiced;
+    size_t                      m_dicing_level;
 
     Impl()
       : m_region(&m_tess)
       , m_lazy_region_kit(&m_region_kit)
+      , m_undiced(0)
+      , m_dicing_level(0)
     {
         m_region_kit.push_back(&m_region);
     }
+
+    ~Impl()
+    {
+        if (m_undiced)
+            m_undiced->release();
+    }
 };
 
 MeshObject::MeshObject(
@@ -108,6 +119,7 @@ MeshObject::MeshObject(
   , impl(new Impl())
 {
     m_inputs.declare("alpha_map", InputFormatFloat, "");
+    m_inputs.declare("displacement_map", InputFormatFloat, "");
 }
 
 MeshObject::~MeshObject()
@@ -175,6 +187,72 @@ Lazy<RegionKit>& MeshObject::get_region_kit()
     return impl->m_lazy_region_kit;
 }
 
+const Source* MeshObject::get_uncached_displacement_map() const
+{
+    return m_inputs.source("displacement_map");
+}
+
+void MeshObject::set_diced_geometry(
+    auto_release_ptr<MeshObject>    diced,
+    const size_t                    dicing_level)
+{
+    assert(diced.get());
+    assert(diced->impl->m_undiced == 0);
+
+    // If this object was already diced, the previous diced geometry ends up
+    // in `diced` and is released with it. Otherwise `diced` becomes the holder
+    // of the original geometry.
+    MeshObject* undiced = impl->m_undiced;
+    impl->m_undiced = 0;
+    swap(impl, diced->impl);
+    impl->m_undiced = undiced != 0 ? undiced : diced.release();
+    impl->m_dicing_level = dicing_level;
+
+    bump_version_id();
+}
+
+void MeshObject::restore_undiced_geometry()
+{
+    if (impl->m_undiced == 0)
+        return;
+
+    auto_release_ptr<MeshObject> undiced(impl->m_undiced);
+    impl->m_undiced = 0;
+    swap(impl, undiced->impl);
+
+    bump_version_id();
+}
+
+size_t MeshObject::get_dicing_level() const
+{
+    return impl->m_dicing_level;
+}
+
+const MeshObject& MeshObject::get_undiced_mesh() const
+{
+    return impl->m_undiced != 0 ? *impl->m_undiced : *this;
+}
+
+void MeshObject::compact_vertex_attributes()
+{
+    impl->m_tess.compact_vertex_attributes();
+}
+
+bool MeshObject::has_compact_vertex_attributes() const
+{
+    return impl->m_tess.has_compact_vertex_attributes();
+}
+
+void MeshObject::release_vertices()
+{
+    impl->m_tess.release_vertices();
+}
+
+bool MeshObject::has_released_vertices() const
+{
+    return impl->m_tess.has_released_vertices();
+}
+
 void MeshObject::reserve_vertices(const size_t count)
 {
     impl->m_tess.m_vertices.reserve(count);
@@ -182,11 +260,22 @@ void MeshObject::reserve_vertices(const size_t count)
 
 size_t MeshObject::push_vertex(const GVector3& vertex)
 {
+    assert(!impl->m_tess.has_released_vertices());
+
     const size_t index = impl->m_tess.m_vertices.size();
     impl->m_tess.m_vertices.push_back(vertex);
     return index;
 }
 
+size_t MeshObject::push_vertices(const GVector3* vertices, const size_t count)
+{
+    assert(!impl->m_tess.has_released_vertices());
+
+    const size_t index = impl->m_tess.m_vertices.size();
+    impl->m_tess.m_vertices.insert(impl->m_tess.m_vertices.end(), vertices, vertices + count);
+    return index;
+}
+
 size_t MeshObject::get_vertex_count() const
 {
     return impl->m_tess.m_vertices.size();
@@ -199,31 +288,44 @@ const GVector3& MeshObject::get_vertex(const size_t index) const
 
 void MeshObject::reserve_vertex_normals(const size_t count)
 {
-    impl->m_tess.m_vertex_normals.reserve(count);
+    impl->m_tess.reserve_vertex_normals(count);
 }
 
 size_t MeshObject::push_vertex_normal(const GVector3& normal)
 {
     assert(is_normalized(normal));
 
-    const size_t index = impl->m_tess.m_vertex_normals.size();
-    impl->m_tess.m_vertex_normals.push_back(normal);
+    return impl->m_tess.push_vertex_normal(normal);
+}
+
+size_t MeshObject::push_vertex_normals(const GVector3* normals, const size_t count)
+{
+    const size_t index = impl->m_tess.get_vertex_normal_count();
+    impl->m_tess.reserve_vertex_normals(index + count);
+
+    // Go through the tessellation so that normals are packed if attributes are compact.
+    for (size_t i = 0; i < count; ++i)
+    {
+        assert(is_normalized(normals[i]));
+        impl->m_tess.push_vertex_normal(normals[i]);
+    }
+
     return index;
 }
 
 size_t MeshObject::get_vertex_normal_count() const
 {
-    return impl->m_tess.m_vertex_normals.size();
+    return impl->m_tess.get_vertex_normal_count();
 }
 
-const GVector3& MeshObject::get_vertex_normal(const size_t index) const
+GVector3 MeshObject::get_vertex_normal(const size_t index) const
 {
-    return impl->m_tess.m_vertex_normals[index];
+    return impl->m_tess.get_vertex_normal(index);
 }
 
 void MeshObject::clear_vertex_normals()
 {
-    impl->m_tess.m_vertex_normals.clear();
+    impl->m_tess.clear_vertex_normals();
 }
 
 void MeshObject::reserve_vertex_tangents(const size_t count)
@@ -256,6 +358,17 @@ size_t MeshObject::push_tex_coords(const GVector2& tex_coords)
     return impl->m_tess.push_tex_coords(tex_coords);
 }
 
+size_t MeshObject::push_tex_coords(const GVector2* tex_coords, const size_t count)
+{
+    const size_t index = impl->m_tess.get_tex_coords_count();
+    impl->m_tess.reserve_tex_coords(index + count);
+
+    for (size_t i = 0; i < count; ++i)
+        impl->m_tess.push_tex_coords(tex_coords[i]);
+
+    return index;
+}
+
 size_t MeshObject::get_tex_coords_count() const
 {
     return impl->m_tess.get_tex_coords_count();
@@ -278,6 +391,13 @@ size_t MeshObject::push_triangle(const Triangle& triangle)
     return index;
 }
 
+size_t MeshObject::push_triangles(const Triangle* triangles, const size_t count)
+{
+    const size_t index = impl->m_tess.m_primitives.size();
+    impl->m_tess.m_primitives.insert(impl->m_tess.m_primitives.end(), triangles, triangles + count);
+    return index;
+}
+
 size_t MeshObject::get_triangle_count() const
 {
     return impl->m_tess.m_primitives.size();
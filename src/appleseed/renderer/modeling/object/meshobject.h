@@ -101,17 +101,47 @@ class APPLESEED_DLLSYMBOL MeshObject
     // Return the region kit of the object.
     virtual foundation::Lazy<RegionKit>& get_region_kit() APPLESEED_OVERRIDE;
 
+    // Return the source bound to the displacement map input, or 0 if the object doesn't have one.
+    const Source* get_uncached_displacement_map() const;
+
+    // Replace the geometry of this object by the one of `diced`, a finer tessellation
+    // of the original geometry. The original geometry is kept aside and remains
+    // accessible via get_undiced_mesh() until restore_undiced_geometry() is called.
+    void set_diced_geometry(
+        foundation::auto_release_ptr<MeshObject>    diced,
+        const size_t                                dicing_level);
+    void restore_undiced_geometry();
+
+    // Return the dicing level of the current geometry (0 if the geometry is not diced).
+    size_t get_dicing_level() const;
+
+    // Return the mesh object holding the original geometry, or this object if it is not diced.
+    const MeshObject& get_undiced_mesh() const;
+
+    // Store vertex normals and tangents in 32 bits each and texture coordinates in
+    // half precision from now on. This is lossy and cannot be undone.
+    void compact_vertex_attributes();
+    bool has_compact_vertex_attributes() const;
+
+    // Release the vertex positions once the triangle trees have been built. Shading then
+    // recovers the vertices of hit triangles from the triangle trees. The bounding box of
+    // the object is retained. Objects with motion keep their vertices. This cannot be undone.
+    void release_vertices();
+    bool has_released_vertices() const;
+
     // Insert and access vertices.
     void reserve_vertices(const size_t count);
     size_t push_vertex(const GVector3& vertex);
+    size_t push_vertices(const GVector3* vertices, const size_t count);     // returns the index of the first vertex
     size_t get_vertex_count() const;
     const GVector3& get_vertex(const size_t index) const;
 
     // Insert and access vertex normals.
     void reserve_vertex_normals(const size_t count);
     size_t push_vertex_normal(const GVector3& normal);      // the normal must be unit-length
+    size_t push_vertex_normals(const GVector3* normals, const size_t count);
     size_t get_vertex_normal_count() const;
-    const GVector3& get_vertex_normal(const size_t index) const;
+    GVector3 get_vertex_normal(const size_t index) const;
     void clear_vertex_normals();
 
     // Insert and access vertex tangents.
@@ -123,12 +153,14 @@ class APPLESEED_DLLSYMBOL MeshObject
     // Insert and access texture coordinates.
     void reserve_tex_coords(const size_t count);
     size_t push_tex_coords(const GVector2& tex_coords);
+    size_t push_tex_coords(const GVector2* tex_coords, const size_t count);
     size_t get_tex_coords_count() const;
     GVector2 get_tex_coords(const size_t index) const;
 
     // Insert and access triangles.
     void reserve_triangles(const size_t count);
     size_t push_triangle(const Triangle& triangle);
+    size_t push_triangles(const Triangle* triangles, const size_t count);
     size_t get_triangle_count() const;
     const Triangle& get_triangle(const size_t index) const;
     Triangle& get_triangle(const size_t index);
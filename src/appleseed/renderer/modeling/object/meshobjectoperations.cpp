@@ -33,13 +33,23 @@
 #include "renderer/global/globaltypes.h"
 #include "renderer/modeling/object/meshobject.h"
 #include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/vector.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/siphash.h"
 
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <cstring>
+#include <map>
+#include <string>
 #include <vector>
 
 using namespace foundation;
@@ -222,4 +232,248 @@ void compute_smooth_vertex_tangents(MeshObject& object)
         compute_smooth_vertex_tangents_pose(object, i);
 }
 
+namespace
+{
+    // Hash a stream of values in blocks, without ever holding the whole stream in memory.
+    class GeometryHasher
+    {
+      public:
+        GeometryHasher()
+          : m_hash(0)
+        {
+            m_buffer.reserve(BufferSize);
+        }
+
+        template <typename T>
+        void append(const T& value)
+        {
+            const uint8* bytes = reinterpret_cast<const uint8*>(&value);
+            m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(T));
+
+            if (m_buffer.size() >= BufferSize)
+                flush();
+        }
+
+        void append(const GVector2& v)
+        {
+            append(v[0]);
+            append(v[1]);
+        }
+
+        void append(const GVector3& v)
+        {
+            append(v[0]);
+            append(v[1]);
+            append(v[2]);
+        }
+
+        void append(const char* s)
+        {
+            const size_t length = strlen(s);
+            append(static_cast<uint64>(length));
+            m_buffer.insert(m_buffer.end(), s, s + length);
+
+            if (m_buffer.size() >= BufferSize)
+                flush();
+        }
+
+        uint64 get_hash()
+        {
+            flush();
+            return m_hash;
+        }
+
+      private:
+        enum { BufferSize = 64 * 1024 };
+
+        uint64          m_hash;
+        vector<uint8>   m_buffer;
+
+        void flush()
+        {
+            if (!m_buffer.empty())
+            {
+                m_hash = siphash24(&m_buffer[0], m_buffer.size(), m_hash, 0);
+                m_buffer.clear();
+            }
+        }
+    };
+}
+
+uint64 compute_geometry_hash(const MeshObject& object)
+{
+    GeometryHasher hasher;
+
+    const size_t vertex_count = object.get_vertex_count();
+    const size_t normal_count = object.get_vertex_normal_count();
+    const size_t tangent_count = object.get_vertex_tangent_count();
+    const size_t tex_coords_count = object.get_tex_coords_count();
+    const size_t triangle_count = object.get_triangle_count();
+    const size_t motion_segment_count = object.get_motion_segment_count();
+    const size_t material_slot_count = object.get_material_slot_count();
+
+    hasher.append(static_cast<uint64>(vertex_count));
+    hasher.append(static_cast<uint64>(normal_count));
+    hasher.append(static_cast<uint64>(tangent_count));
+    hasher.append(static_cast<uint64>(tex_coords_count));
+    hasher.append(static_cast<uint64>(triangle_count));
+    hasher.append(static_cast<uint64>(motion_segment_count));
+    hasher.append(static_cast<uint64>(material_slot_count));
+
+    for (size_t i = 0; i < vertex_count; ++i)
+        hasher.append(object.get_vertex(i));
+
+    for (size_t i = 0; i < normal_count; ++i)
+        hasher.append(object.get_vertex_normal(i));
+
+    for (size_t i = 0; i < tangent_count; ++i)
+        hasher.append(object.get_vertex_tangent(i));
+
+    for (size_t i = 0; i < tex_coords_count; ++i)
+        hasher.append(object.get_tex_coords(i));
+
+    for (size_t i = 0; i < triangle_count; ++i)
+    {
+        const Triangle& triangle = object.get_triangle(i);
+        hasher.append(triangle.m_v0);
+        hasher.append(triangle.m_v1);
+        hasher.append(triangle.m_v2);
+        hasher.append(triangle.m_n0);
+        hasher.append(triangle.m_n1);
+        hasher.append(triangle.m_n2);
+        hasher.append(triangle.m_a0);
+        hasher.append(triangle.m_a1);
+        hasher.append(triangle.m_a2);
+        hasher.append(triangle.m_pa);
+    }
+
+    for (size_t m = 0; m < motion_segment_count; ++m)
+    {
+        for (size_t i = 0; i < vertex_count; ++i)
+            hasher.append(object.get_vertex_pose(i, m));
+
+        for (size_t i = 0; i < normal_count; ++i)
+            hasher.append(object.get_vertex_normal_pose(i, m));
+
+        for (size_t i = 0; i < tangent_count; ++i)
+            hasher.append(object.get_vertex_tangent_pose(i, m));
+    }
+
+    for (size_t i = 0; i < material_slot_count; ++i)
+        hasher.append(object.get_material_slot(i));
+
+    return hasher.get_hash();
+}
+
+namespace
+{
+    bool have_same_parameters(const MeshObject& lhs, const MeshObject& rhs)
+    {
+        // Duplicates are typically read from different files.
+        ParamArray lhs_params = lhs.get_parameters();
+        ParamArray rhs_params = rhs.get_parameters();
+        lhs_params.strings().remove("filename");
+        rhs_params.strings().remove("filename");
+
+        return lhs_params == rhs_params;
+    }
+
+    // Return true if a child assembly of a given assembly defines an object with a given name.
+    bool is_object_name_shadowed(const Assembly& assembly, const char* object_name)
+    {
+        for (const_each<AssemblyContainer> i = assembly.assemblies(); i; ++i)
+        {
+            if (i->objects().get_by_name(object_name) != 0)
+                return true;
+
+            if (is_object_name_shadowed(*i, object_name))
+                return true;
+        }
+
+        return false;
+    }
+
+    // Retarget the object instances of an assembly and of its child assemblies.
+    void rename_instantiated_objects(Assembly& assembly, const StringDictionary& renames)
+    {
+        for (each<ObjectInstanceContainer> i = assembly.object_instances(); i; ++i)
+        {
+            if (renames.exist(i->get_object_name()))
+                i->set_object_name(renames.get(i->get_object_name()));
+        }
+
+        for (each<AssemblyContainer> i = assembly.assemblies(); i; ++i)
+        {
+            // Don't cross assemblies that define their own object with the same name.
+            StringDictionary child_renames;
+            for (const_each<StringDictionary> j = renames; j; ++j)
+            {
+                if (i->objects().get_by_name(j->key()) == 0)
+                    child_renames.insert(j->key(), j->value());
+            }
+
+            if (!child_renames.empty())
+                rename_instantiated_objects(*i, child_renames);
+        }
+    }
+}
+
+size_t merge_identical_mesh_objects(Assembly& assembly)
+{
+    typedef multimap<uint64, MeshObject*> ObjectMap;
+
+    ObjectMap unique_objects;
+    StringDictionary renames;
+    vector<Object*> duplicates;
+
+    for (each<ObjectContainer> i = assembly.objects(); i; ++i)
+    {
+        if (strcmp(i->get_model(), MeshObjectFactory::get_model()) != 0)
+            continue;
+
+        MeshObject& object = static_cast<MeshObject&>(*i);
+
+        // Meshes without vertices cannot be compared.
+        if (object.has_released_vertices())
+            continue;
+
+        const uint64 hash = compute_geometry_hash(object);
+
+        MeshObject* original = 0;
+
+        for (ObjectMap::const_iterator j = unique_objects.lower_bound(hash),
+             e = unique_objects.upper_bound(hash); j != e; ++j)
+        {
+            if (have_same_parameters(*j->second, object) &&
+                !is_object_name_shadowed(assembly, j->second->get_name()))
+            {
+                original = j->second;
+                break;
+            }
+        }
+
+        if (original)
+        {
+            renames.insert(object.get_name(), original->get_name());
+            duplicates.push_back(&object);
+        }
+        else unique_objects.insert(make_pair(hash, &object));
+    }
+
+    if (!duplicates.empty())
+    {
+        rename_instantiated_objects(assembly, renames);
+
+        for (size_t i = 0, e = duplicates.size(); i < e; ++i)
+            assembly.objects().remove(duplicates[i]);
+    }
+
+    size_t removed_count = duplicates.size();
+
+    for (each<AssemblyContainer> i = assembly.assemblies(); i; ++i)
+        removed_count += merge_identical_mesh_objects(*i);
+
+    return removed_count;
+}
+
 }   // namespace renderer
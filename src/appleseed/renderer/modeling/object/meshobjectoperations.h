@@ -29,10 +29,17 @@
 #ifndef APPLESEED_RENDERER_MODELING_OBJECT_MESHOBJECTOPERATIONS_H
 #define APPLESEED_RENDERER_MODELING_OBJECT_MESHOBJECTOPERATIONS_H
 
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
+namespace renderer  { class Assembly; }
 namespace renderer  { class MeshObject; }
 
 namespace renderer
@@ -47,6 +54,16 @@ APPLESEED_DLLSYMBOL void compute_smooth_vertex_normals(MeshObject& object);
 // The mesh object must have texture coordinates.
 APPLESEED_DLLSYMBOL void compute_smooth_vertex_tangents(MeshObject& object);
 
+// Compute a hash of the geometry of a mesh object: vertices, vertex normals, vertex tangents,
+// texture coordinates, triangles, motion poses and material slots. Parameters are not hashed.
+APPLESEED_DLLSYMBOL foundation::uint64 compute_geometry_hash(const MeshObject& object);
+
+// Find mesh objects with identical geometry and parameters (the source filename excepted)
+// in an assembly and its child assemblies, retarget the object instances that refer to
+// duplicates to a single one of them, and remove the duplicates from the assembly.
+// Returns the number of mesh objects that were removed.
+APPLESEED_DLLSYMBOL size_t merge_identical_mesh_objects(Assembly& assembly);
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_MODELING_OBJECT_MESHOBJECTOPERATIONS_H
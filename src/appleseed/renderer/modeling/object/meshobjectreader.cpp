@@ -432,6 +432,13 @@ namespace
                 reader.get_obj_options() | OBJMeshFileReader::FavorSpeedOverPrecision);
         }
 
+        // Split OBJ files into chunks parsed on all cores.
+        reader.set_obj_options(
+            reader.get_obj_options() | OBJMeshFileReader::ParseInParallel);
+
+        // Only read the Alembic samples at the requested time.
+        reader.set_alembic_sample_time(params.get_optional<double>("alembic_sample_time", 0.0));
+
         MeshObjectBuilder builder(params, base_object_name);
 
         Stopwatch<DefaultWallclockTimer> stopwatch;
@@ -946,6 +953,13 @@ bool MeshObjectReader::read(
         }
     }
 
+    // Compact vertex attributes.
+    if (params.get_optional<bool>("compact_vertex_attributes", false))
+    {
+        for (size_t i = 0; i < objects.size(); ++i)
+            objects[i]->compact_vertex_attributes();
+    }
+
     return true;
 }
 
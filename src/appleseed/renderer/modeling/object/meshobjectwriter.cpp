@@ -181,7 +181,8 @@ bool MeshObjectWriter::write(
     try
     {
         GenericMeshFileWriter writer(filename);
-        MeshObjectWalker walker(object, object_name);
+        // Always write the original geometry, never the one produced by render-time dicing.
+        MeshObjectWalker walker(object.get_undiced_mesh(), object_name);
         writer.write(walker);
     }
     catch (const ExceptionIOError&)
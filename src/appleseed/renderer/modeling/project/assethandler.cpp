@@ -42,6 +42,7 @@
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/otherwise.h"
+#include "foundation/utility/remotefilecache.h"
 #include "foundation/utility/searchpaths.h"
 #include "foundation/utility/string.h"
 
@@ -198,6 +199,10 @@ bool AssetHandler::handle_assets() const
 
 bool AssetHandler::handle_asset(string& asset_path) const
 {
+    // Remote assets are left as they are, or copied from the remote file cache.
+    if (RemoteFileCache::is_url(asset_path))
+        return handle_remote_asset(asset_path);
+
     // Let's first get rid of the case where the asset path is absolute.
     if (path(asset_path).is_absolute())
         return handle_absolute_asset(asset_path);
@@ -210,6 +215,10 @@ bool AssetHandler::handle_asset(string& asset_path) const
         qualified_asset_path,
         search_path);
 
+    // Relative asset path, found in a URL search path.
+    if (RemoteFileCache::is_url(search_path))
+        return handle_remote_asset(asset_path);
+
     if (search_path.empty() || path(search_path).is_relative())
     {
         // Relative asset path, found in a relative search path or in the root directory.
@@ -257,6 +266,21 @@ bool AssetHandler::handle_absolute_asset(string& asset_path) const
     }
 }
 
+bool AssetHandler::handle_remote_asset(string& asset_path) const
+{
+    switch (m_mode)
+    {
+      case CopyRelativeAssetsOnly:
+        // The asset will be fetched again from its server.
+        return true;
+
+      case CopyAllAssets:
+        return copy_absolute_asset(asset_path);
+
+      assert_otherwise_and_return(false);
+    }
+}
+
 bool AssetHandler::make_absolute_asset_path(string& asset_path) const
 {
     // Make sure the asset path is qualified and canonized.
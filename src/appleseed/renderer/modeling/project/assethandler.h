@@ -68,6 +68,7 @@ class AssetHandler
 
     bool handle_asset(std::string& asset_path) const;
     bool handle_absolute_asset(std::string& asset_path) const;
+    bool handle_remote_asset(std::string& asset_path) const;
     bool make_absolute_asset_path(std::string& asset_path) const;
     bool copy_absolute_asset(std::string& asset_path) const;
     bool copy_relative_asset(std::string& asset_path) const;
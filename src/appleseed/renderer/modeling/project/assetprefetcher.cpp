@@ -0,0 +1,177 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "assetprefetcher.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/project/configuration.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/project/renderlayerrule.h"
+#include "renderer/modeling/scene/scene.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/path.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/timers.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/api/specializedapiarrays.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/searchpaths.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// AssetPrefetcher class implementation.
+//
+
+namespace
+{
+    // Prefetching is bound by file system latency, not by computations,
+    // so it is worth running more threads than there are CPU cores.
+    const size_t MinPrefetchThreadCount = 16;
+
+    template <typename EntityCollection>
+    void do_collect_asset_paths(
+        StringArray&            paths,
+        const EntityCollection& entities)
+    {
+        for (const_each<EntityCollection> i = entities; i; ++i)
+            i->collect_asset_paths(paths);
+    }
+
+    class PrefetchAssetJob
+      : public IJob
+    {
+      public:
+        PrefetchAssetJob(
+            const SearchPaths&  search_paths,
+            const string&       asset_path,
+            uint8&              success)
+          : m_search_paths(search_paths)
+          , m_asset_path(asset_path)
+          , m_success(success)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            const string filepath = m_search_paths.qualify(m_asset_path);
+            m_success = prefetch_file(filepath.c_str()) ? 1 : 0;
+        }
+
+      private:
+        const SearchPaths&      m_search_paths;
+        const string            m_asset_path;
+        uint8&                  m_success;
+    };
+}
+
+AssetPrefetcher::AssetPrefetcher(const Project& project)
+  : m_project(project)
+{
+}
+
+void AssetPrefetcher::prefetch_assets() const
+{
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    StringArray paths;
+
+    const Scene* scene = m_project.get_scene();
+    if (scene)
+        scene->collect_asset_paths(paths);
+
+    const Frame* frame = m_project.get_frame();
+    if (frame)
+        frame->collect_asset_paths(paths);
+
+    do_collect_asset_paths(paths, m_project.render_layer_rules());
+    do_collect_asset_paths(paths, m_project.configurations());
+
+    vector<string> unique_paths = array_vector<vector<string> >(paths);
+    sort(unique_paths.begin(), unique_paths.end());
+    unique_paths.erase(
+        unique(unique_paths.begin(), unique_paths.end()),
+        unique_paths.end());
+
+    if (unique_paths.empty())
+        return;
+
+    const size_t path_count = unique_paths.size();
+    vector<uint8> success(path_count, 0);
+
+    JobQueue job_queue;
+    for (size_t i = 0; i < path_count; ++i)
+    {
+        job_queue.schedule(
+            new PrefetchAssetJob(m_project.search_paths(), unique_paths[i], success[i]));
+    }
+
+    JobManager job_manager(
+        global_logger(),
+        job_queue,
+        min(
+            max(System::get_available_cpu_core_count(), MinPrefetchThreadCount),
+            path_count));
+
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    stopwatch.measure();
+
+    // Missing files are reported by the readers that need them.
+    const size_t prefetched_count = count(success.begin(), success.end(), 1);
+
+    RENDERER_LOG_DEBUG(
+        "prefetched %s of %s asset file%s in %s.",
+        pretty_uint(prefetched_count).c_str(),
+        pretty_uint(path_count).c_str(),
+        path_count > 1 ? "s" : "",
+        pretty_time(stopwatch.get_seconds()).c_str());
+}
+
+}   // namespace renderer
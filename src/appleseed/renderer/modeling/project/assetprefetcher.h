@@ -0,0 +1,65 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_MODELING_PROJECT_ASSETPREFETCHER_H
+#define APPLESEED_RENDERER_MODELING_PROJECT_ASSETPREFETCHER_H
+
+// Forward declarations.
+namespace renderer { class Project; }
+
+namespace renderer
+{
+
+//
+// Resolves all the asset files referenced by a project against its search paths,
+// concurrently, and asks the operating system to read them ahead so that they are
+// already in the file cache by the time mesh, texture and archive readers open them.
+//
+// On network file systems, file access is dominated by latency rather than bandwidth;
+// resolving and opening many files in parallel hides most of that latency.
+//
+
+class AssetPrefetcher
+{
+  public:
+    // Constructor.
+    explicit AssetPrefetcher(const Project& project);
+
+    // Prefetch all asset files. Returns once all files have been resolved and
+    // read-ahead requests have been issued, without waiting for the reads.
+    void prefetch_assets() const;
+
+  private:
+    const Project& m_project;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_MODELING_PROJECT_ASSETPREFETCHER_H
@@ -32,13 +32,17 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/lighting/drt/drtlightingengine.h"
+#include "renderer/kernel/lighting/lightsampler.h"
 #include "renderer/kernel/lighting/pt/ptlightingengine.h"
 #include "renderer/kernel/lighting/sppm/sppmlightingengine.h"
 #include "renderer/kernel/rendering/final/adaptivepixelrenderer.h"
 #include "renderer/kernel/rendering/final/uniformpixelrenderer.h"
 #include "renderer/kernel/rendering/generic/genericframerenderer.h"
+#include "renderer/kernel/rendering/generic/genericsamplegenerator.h"
+#include "renderer/kernel/rendering/primaryhitcache.h"
 #include "renderer/kernel/rendering/progressive/progressiveframerenderer.h"
 #include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/kernel/volume/volumebrickstore.h"
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
@@ -112,7 +116,7 @@ Dictionary Configuration::get_metadata()
         "sampling_mode",
         Dictionary()
             .insert("type", "enum")
-            .insert("values", "rng|qmc")
+            .insert("values", "rng|qmc|sobol")
             .insert("default", "rng")
             .insert("label", "Sampler")
             .insert("help", "Sampler to use when generating samples")
@@ -128,7 +132,12 @@ Dictionary Configuration::get_metadata()
                         "qmc",
                         Dictionary()
                             .insert("label", "QMC")
-                            .insert("help", "Quasi Monte Carlo sampler"))));
+                            .insert("help", "Quasi Monte Carlo sampler"))
+                    .insert(
+                        "sobol",
+                        Dictionary()
+                            .insert("label", "Sobol")
+                            .insert("help", "Owen-scrambled Sobol sampler"))));
 
     metadata.insert(
         "lighting_engine",
@@ -164,10 +173,60 @@ Dictionary Configuration::get_metadata()
             .insert("label", "Render Threads")
             .insert("help", "Number of threads to use for rendering"));
 
+    metadata.insert(
+        "rendering_threads_affinity",
+        Dictionary()
+            .insert("type", "enum")
+            .insert("values", "none|numa")
+            .insert("default", "none")
+            .insert("label", "Render Threads Affinity")
+            .insert("help", "Binding of rendering threads to CPU cores")
+            .insert(
+                "options",
+                Dictionary()
+                    .insert(
+                        "none",
+                        Dictionary()
+                            .insert("label", "None")
+                            .insert("help", "Let the operating system schedule rendering threads"))
+                    .insert(
+                        "numa",
+                        Dictionary()
+                            .insert("label", "NUMA")
+                            .insert("help", "Bind rendering threads to CPU cores grouped by NUMA node"))));
+
+    metadata.insert(
+        "background_tree_construction",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Background Tree Construction")
+            .insert("help", "Start rendering while acceleration structures are built in the background, nearest to the camera first"));
+
+    metadata.insert(
+        "optimize_shader_groups_upfront",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Optimize Shader Groups Upfront")
+            .insert("help", "Optimize and compile all OSL shader groups in parallel before rendering instead of on first use"));
+
     metadata.dictionaries().insert(
         "texture_store",
         TextureStore::get_params_metadata());
 
+    metadata.dictionaries().insert(
+        "volume_store",
+        VolumeBrickStore::get_params_metadata());
+
+    metadata.dictionaries().insert(
+        "light_sampler",
+        LightSampler::get_params_metadata());
+
+    metadata.dictionaries().insert(
+        "primary_hit_cache",
+        PrimaryHitCache::get_params_metadata());
+
     metadata.dictionaries().insert(
         "uniform_pixel_renderer",
         UniformPixelRendererFactory::get_params_metadata());
@@ -184,6 +243,10 @@ Dictionary Configuration::get_metadata()
         "progressive_frame_renderer",
         ProgressiveFrameRendererFactory::get_params_metadata());
 
+    metadata.dictionaries().insert(
+        "generic_sample_generator",
+        GenericSampleGeneratorFactory::get_params_metadata());
+
     metadata.dictionaries().insert("drt", DRTLightingEngineFactory::get_params_metadata());
     metadata.dictionaries().insert("pt", PTLightingEngineFactory::get_params_metadata());
     metadata.dictionaries().insert("sppm", SPPMLightingEngineFactory::get_params_metadata());
@@ -257,6 +320,8 @@ auto_release_ptr<Configuration> BaseConfigurationFactory::create_base_interactiv
     parameters.insert("sample_renderer", "generic");
     parameters.insert("lighting_engine", "pt");
 
+    parameters.insert("background_tree_construction", true);
+
     return configuration;
 }
 
@@ -102,10 +102,14 @@ struct Project::Impl
     ConfigurationContainer      m_configurations;
     SearchPaths                 m_search_paths;
     auto_ptr<TraceContext>      m_trace_context;
+    bool                        m_background_tree_construction;
+    VolumeBrickStore*           m_volume_brick_store;
 
     Impl()
       : m_format_revision(ProjectFormatRevision)
       , m_search_paths("APPLESEED_SEARCHPATH", SearchPaths::environment_path_separator())
+      , m_background_tree_construction(false)
+      , m_volume_brick_store(0)
     {
     }
 };
@@ -434,6 +438,13 @@ void Project::create_aov_images()
 
     impl->m_frame->aov_images().append("depth", ImageStack::ContributionType, 4, PixelFormatFloat);
 
+    // Feature AOVs consumed by the denoiser.
+    if (impl->m_frame->is_denoising_enabled())
+    {
+        impl->m_frame->aov_images().append("normal", ImageStack::IdentificationType, 4, PixelFormatFloat);
+        impl->m_frame->aov_images().append("albedo", ImageStack::IdentificationType, 4, PixelFormatFloat);
+    }
+
     ApplyRenderLayer apply_render_layers(
         impl->m_scene.ref(),
         impl->m_frame.ref());
@@ -451,18 +462,39 @@ const TraceContext& Project::get_trace_context() const
     if (impl->m_trace_context.get() == 0)
     {
         assert(impl->m_scene.get());
-        impl->m_trace_context.reset(new TraceContext(*impl->m_scene));
+        impl->m_trace_context.reset(
+            new TraceContext(
+                *impl->m_scene,
+                impl->m_background_tree_construction));
     }
 
     return *impl->m_trace_context;
 }
 
+void Project::set_background_tree_construction(const bool enabled)
+{
+    impl->m_background_tree_construction = enabled;
+
+    if (impl->m_trace_context.get())
+        impl->m_trace_context->set_background_tree_construction(enabled);
+}
+
 void Project::update_trace_context()
 {
     if (impl->m_trace_context.get())
         impl->m_trace_context->update();
 }
 
+void Project::set_volume_brick_store(VolumeBrickStore* store)
+{
+    impl->m_volume_brick_store = store;
+}
+
+VolumeBrickStore* Project::get_volume_brick_store() const
+{
+    return impl->m_volume_brick_store;
+}
+
 void Project::add_base_configurations()
 {
     impl->m_configurations.insert(BaseConfigurationFactory::create_base_final());
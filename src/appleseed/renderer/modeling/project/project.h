@@ -55,6 +55,7 @@ namespace renderer      { class Display; }
 namespace renderer      { class Frame; }
 namespace renderer      { class Scene; }
 namespace renderer      { class TraceContext; }
+namespace renderer      { class VolumeBrickStore; }
 
 namespace renderer
 {
@@ -136,9 +137,19 @@ class APPLESEED_DLLSYMBOL Project
     // Get the trace context.
     const TraceContext& get_trace_context() const;
 
+    // Enable or disable background construction of the trace context's acceleration structures.
+    void set_background_tree_construction(const bool enabled);
+
     // Synchronize the trace context with the scene.
     void update_trace_context();
 
+    // Set the store from which volume bricks are loaded during rendering, or 0 if there is none.
+    // The project does not take ownership of the store.
+    void set_volume_brick_store(VolumeBrickStore* store);
+
+    // Return the store from which volume bricks are loaded during rendering, or 0 if there is none.
+    VolumeBrickStore* get_volume_brick_store() const;
+
   private:
     friend class ProjectFactory;
 
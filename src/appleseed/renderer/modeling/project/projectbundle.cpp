@@ -0,0 +1,585 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "projectbundle.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exception.h"
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/siphash.h"
+#include "foundation/utility/string.h"
+
+// lz4 headers.
+#include "lz4.h"
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace renderer
+{
+
+//
+// ProjectBundle class implementation.
+//
+// File layout:
+//
+//   signature      char[15]        "APPLESEEDBUNDLE"
+//   version        uint16
+//   file data      for each file, a sequence of chunks
+//   index          uint32 count, count x (string name, uint64 offset, uint64 size, uint32 chunk count)
+//   index offset   uint64          offset of the index from the beginning of the bundle
+//
+// Chunks:
+//
+//   compressed size    uint32
+//   size               uint32
+//   data               LZ4-compressed data
+//
+// Strings are stored as a uint32 length followed by that many characters.
+//
+
+const char* ProjectBundle::ProjectFileName = "project.appleseed";
+
+namespace
+{
+    const char Signature[15] =
+        { 'A', 'P', 'P', 'L', 'E', 'S', 'E', 'E', 'D', 'B', 'U', 'N', 'D', 'L', 'E' };
+
+    const uint16 Version = 1;
+
+    const size_t ChunkSize = 1024 * 1024;
+
+    // Maximum length of a file name; protects against corrupted bundles.
+    const uint32 MaxNameLength = 4096;
+
+    // Name of the file marking a fully unpacked bundle in the bundle cache.
+    const char* CompletionMarkerName = ".complete";
+
+    struct ExceptionEOF : public Exception {};
+
+    struct IndexEntry
+    {
+        string  m_name;
+        uint64  m_offset;
+        uint64  m_size;
+        uint32  m_chunk_count;
+    };
+
+    void checked_write(BufferedFile& file, const void* inbuf, const size_t size)
+    {
+        const size_t bytes_written = file.write(inbuf, size);
+
+        if (bytes_written < size)
+            throw ExceptionIOError();
+    }
+
+    template <typename T>
+    void checked_write(BufferedFile& file, const T& object)
+    {
+        checked_write(file, &object, sizeof(T));
+    }
+
+    void write_string(BufferedFile& file, const string& s)
+    {
+        checked_write(file, static_cast<uint32>(s.size()));
+        checked_write(file, s.data(), s.size());
+    }
+
+    void checked_read(BufferedFile& file, void* outbuf, const size_t size)
+    {
+        if (size == 0)
+            return;
+
+        const size_t bytes_read = file.read(outbuf, size);
+
+        if (bytes_read < size)
+            throw ExceptionEOF();
+    }
+
+    template <typename T>
+    void checked_read(BufferedFile& file, T& object)
+    {
+        checked_read(file, &object, sizeof(T));
+    }
+
+    string read_string(BufferedFile& file)
+    {
+        uint32 length;
+        checked_read(file, length);
+
+        if (length > MaxNameLength)
+            throw ExceptionIOError("invalid file name");
+
+        string s(length, '\0');
+        if (length > 0)
+            checked_read(file, &s[0], length);
+
+        return s;
+    }
+
+    bool read_header(BufferedFile& file)
+    {
+        char signature[sizeof(Signature)];
+        uint16 version;
+
+        return
+            file.read(signature, sizeof(signature)) == sizeof(signature) &&
+            memcmp(signature, Signature, sizeof(Signature)) == 0 &&
+            file.read(version) == sizeof(version) &&
+            version == Version;
+    }
+
+    // Compress a file into a sequence of chunks and append them to the bundle.
+    IndexEntry write_chunks(
+        BufferedFile&               bundle,
+        const ProjectBundle::File&  input)
+    {
+        BufferedFile file(
+            input.m_filepath.c_str(),
+            BufferedFile::BinaryType,
+            BufferedFile::ReadMode);
+
+        if (!file.is_open())
+            throw ExceptionIOError(("failed to open " + input.m_filepath).c_str());
+
+        IndexEntry entry;
+        entry.m_name = input.m_name;
+        entry.m_offset = static_cast<uint64>(bundle.tell());
+        entry.m_size = 0;
+        entry.m_chunk_count = 0;
+
+        vector<char> buffer(ChunkSize);
+        vector<char> compressed(LZ4_compressBound(static_cast<int>(ChunkSize)));
+
+        while (true)
+        {
+            const size_t size = file.read(&buffer[0], ChunkSize);
+            if (size == 0)
+                break;
+
+            const int compressed_size =
+                LZ4_compress(
+                    &buffer[0],
+                    &compressed[0],
+                    static_cast<int>(size));
+
+            checked_write(bundle, static_cast<uint32>(compressed_size));
+            checked_write(bundle, static_cast<uint32>(size));
+            checked_write(bundle, &compressed[0], static_cast<size_t>(compressed_size));
+
+            entry.m_size += size;
+            ++entry.m_chunk_count;
+        }
+
+        return entry;
+    }
+
+    void read_index(BufferedFile& file, vector<IndexEntry>& index)
+    {
+        uint64 index_offset;
+
+        if (!file.seek(-static_cast<int64>(sizeof(index_offset)), BufferedFile::SeekFromEnd))
+            throw ExceptionIOError();
+        checked_read(file, index_offset);
+
+        if (!file.seek(static_cast<int64>(index_offset), BufferedFile::SeekFromBeginning))
+            throw ExceptionIOError();
+
+        uint32 count;
+        checked_read(file, count);
+
+        index.clear();
+
+        for (uint32 i = 0; i < count; ++i)
+        {
+            IndexEntry entry;
+            entry.m_name = read_string(file);
+            checked_read(file, entry.m_offset);
+            checked_read(file, entry.m_size);
+            checked_read(file, entry.m_chunk_count);
+            index.push_back(entry);
+        }
+    }
+
+    // Decompress the chunks of a file and pass them one at a time to a consumer.
+    template <typename Consumer>
+    void read_chunks(
+        BufferedFile&               bundle,
+        const IndexEntry&           entry,
+        Consumer&                   consumer)
+    {
+        if (!bundle.seek(static_cast<int64>(entry.m_offset), BufferedFile::SeekFromBeginning))
+            throw ExceptionIOError();
+
+        vector<char> compressed;
+        vector<char> buffer;
+
+        for (uint32 i = 0; i < entry.m_chunk_count; ++i)
+        {
+            uint32 compressed_size, size;
+            checked_read(bundle, compressed_size);
+            checked_read(bundle, size);
+
+            if (size > ChunkSize || compressed_size > static_cast<uint32>(LZ4_compressBound(static_cast<int>(ChunkSize))))
+                throw ExceptionIOError("invalid chunk");
+
+            compressed.resize(compressed_size);
+            buffer.resize(size);
+            checked_read(bundle, &compressed[0], compressed_size);
+
+            const int decompressed_size =
+                LZ4_decompress_safe(
+                    &compressed[0],
+                    &buffer[0],
+                    static_cast<int>(compressed_size),
+                    static_cast<int>(size));
+
+            if (decompressed_size != static_cast<int>(size))
+                throw ExceptionIOError("corrupted chunk");
+
+            consumer.consume(&buffer[0], size);
+        }
+    }
+
+    struct MemoryConsumer
+    {
+        vector<uint8>& m_data;
+
+        explicit MemoryConsumer(vector<uint8>& data)
+          : m_data(data)
+        {
+        }
+
+        void consume(const char* data, const size_t size)
+        {
+            m_data.insert(m_data.end(), data, data + size);
+        }
+    };
+
+    struct FileConsumer
+    {
+        BufferedFile& m_file;
+
+        explicit FileConsumer(BufferedFile& file)
+          : m_file(file)
+        {
+        }
+
+        void consume(const char* data, const size_t size)
+        {
+            checked_write(m_file, data, size);
+        }
+    };
+
+    // Only accept relative paths that stay inside the directory they are unpacked to.
+    bool is_safe_name(const string& name)
+    {
+        const bf::path p(name);
+
+        if (name.empty() || p.has_root_path())
+            return false;
+
+        for (bf::path::const_iterator i = p.begin(), e = p.end(); i != e; ++i)
+        {
+            if (*i == "..")
+                return false;
+        }
+
+        return true;
+    }
+
+    void unpack_files(
+        const char*                 bundle_filepath,
+        const bf::path&             directory)
+    {
+        BufferedFile bundle(
+            bundle_filepath,
+            BufferedFile::BinaryType,
+            BufferedFile::ReadMode);
+
+        if (!bundle.is_open() || !read_header(bundle))
+            throw ExceptionIOError("invalid file header");
+
+        vector<IndexEntry> index;
+        read_index(bundle, index);
+
+        for (size_t i = 0, e = index.size(); i < e; ++i)
+        {
+            const IndexEntry& entry = index[i];
+
+            if (!is_safe_name(entry.m_name))
+                throw ExceptionIOError(("invalid file name " + entry.m_name).c_str());
+
+            const bf::path filepath = directory / entry.m_name;
+            bf::create_directories(filepath.parent_path());
+
+            BufferedFile file(
+                filepath.string().c_str(),
+                BufferedFile::BinaryType,
+                BufferedFile::WriteMode);
+
+            if (!file.is_open())
+                throw ExceptionIOError(("failed to write " + filepath.string()).c_str());
+
+            FileConsumer consumer(file);
+            read_chunks(bundle, entry, consumer);
+
+            if (!file.close())
+                throw ExceptionIOError(("failed to write " + filepath.string()).c_str());
+        }
+    }
+
+    // The cache directory of a bundle depends on its location, size and modification time,
+    // so that modified bundles are unpacked again.
+    bf::path get_cache_directory(const char* bundle_filepath)
+    {
+        const string path = bf::canonical(bundle_filepath).string();
+        const uint64 size = static_cast<uint64>(bf::file_size(bundle_filepath));
+        const uint64 time = static_cast<uint64>(bf::last_write_time(bundle_filepath));
+
+        const uint64 signature =
+            siphash24(
+                siphash24(path.data(), path.size()),
+                siphash24(size, time));
+
+        return
+              bf::temp_directory_path()
+            / "appleseed-bundles"
+            / (bf::path(bundle_filepath).stem().string() + "-" + to_string(signature));
+    }
+}
+
+bool ProjectBundle::is_bundle(const char* filepath)
+{
+    BufferedFile file(
+        filepath,
+        BufferedFile::BinaryType,
+        BufferedFile::ReadMode);
+
+    return file.is_open() && read_header(file);
+}
+
+bool ProjectBundle::write(
+    const char*                     bundle_filepath,
+    const vector<File>&             files)
+{
+    RENDERER_LOG_INFO("writing project bundle %s...", bundle_filepath);
+
+    BufferedFile file(
+        bundle_filepath,
+        BufferedFile::BinaryType,
+        BufferedFile::WriteMode);
+
+    if (!file.is_open())
+    {
+        RENDERER_LOG_ERROR("failed to write project bundle %s: i/o error.", bundle_filepath);
+        return false;
+    }
+
+    try
+    {
+        checked_write(file, Signature, sizeof(Signature));
+        checked_write(file, Version);
+
+        vector<IndexEntry> index;
+
+        for (size_t i = 0, e = files.size(); i < e; ++i)
+            index.push_back(write_chunks(file, files[i]));
+
+        const uint64 index_offset = static_cast<uint64>(file.tell());
+
+        checked_write(file, static_cast<uint32>(index.size()));
+
+        for (size_t i = 0, e = index.size(); i < e; ++i)
+        {
+            write_string(file, index[i].m_name);
+            checked_write(file, index[i].m_offset);
+            checked_write(file, index[i].m_size);
+            checked_write(file, index[i].m_chunk_count);
+        }
+
+        checked_write(file, index_offset);
+    }
+    catch (const ExceptionIOError& e)
+    {
+        RENDERER_LOG_ERROR("failed to write project bundle %s: %s.", bundle_filepath, e.what());
+        return false;
+    }
+
+    if (!file.close())
+    {
+        RENDERER_LOG_ERROR("failed to write project bundle %s: i/o error.", bundle_filepath);
+        return false;
+    }
+
+    RENDERER_LOG_INFO("wrote project bundle %s (%s file%s).", bundle_filepath, pretty_uint(files.size()).c_str(), files.size() > 1 ? "s" : "");
+
+    return true;
+}
+
+bool ProjectBundle::read_file(
+    const char*                     bundle_filepath,
+    const char*                     name,
+    vector<uint8>&                  data)
+{
+    BufferedFile file(
+        bundle_filepath,
+        BufferedFile::BinaryType,
+        BufferedFile::ReadMode);
+
+    if (!file.is_open() || !read_header(file))
+    {
+        RENDERER_LOG_ERROR("failed to read project bundle %s: invalid file header.", bundle_filepath);
+        return false;
+    }
+
+    try
+    {
+        vector<IndexEntry> index;
+        read_index(file, index);
+
+        for (size_t i = 0, e = index.size(); i < e; ++i)
+        {
+            if (index[i].m_name == name)
+            {
+                data.clear();
+                data.reserve(static_cast<size_t>(index[i].m_size));
+
+                MemoryConsumer consumer(data);
+                read_chunks(file, index[i], consumer);
+
+                return true;
+            }
+        }
+    }
+    catch (const ExceptionEOF&)
+    {
+        RENDERER_LOG_ERROR("failed to read project bundle %s: unexpected end of file.", bundle_filepath);
+        return false;
+    }
+    catch (const ExceptionIOError& e)
+    {
+        RENDERER_LOG_ERROR("failed to read project bundle %s: %s.", bundle_filepath, e.what());
+        return false;
+    }
+
+    RENDERER_LOG_ERROR("failed to read project bundle %s: no file named %s.", bundle_filepath, name);
+    return false;
+}
+
+bool ProjectBundle::unpack(
+    const char*                     bundle_filepath,
+    string&                         project_filepath)
+{
+    try
+    {
+        const bf::path cache_dir = get_cache_directory(bundle_filepath);
+
+        if (!bf::exists(cache_dir / CompletionMarkerName))
+        {
+            RENDERER_LOG_INFO("unpacking project bundle %s to %s...", bundle_filepath, cache_dir.string().c_str());
+
+            // Unpack into a private directory and move it in place once complete,
+            // so that concurrent loads never see a partially unpacked bundle.
+            const bf::path staging_dir =
+                cache_dir.parent_path() / bf::unique_path("staging-%%%%-%%%%-%%%%-%%%%");
+            bf::create_directories(staging_dir);
+
+            try
+            {
+                unpack_files(bundle_filepath, staging_dir);
+
+                BufferedFile marker(
+                    (staging_dir / CompletionMarkerName).string().c_str(),
+                    BufferedFile::BinaryType,
+                    BufferedFile::WriteMode);
+
+                if (!marker.is_open() || !marker.close())
+                    throw ExceptionIOError("i/o error");
+            }
+            catch (...)
+            {
+                boost::system::error_code ec;
+                bf::remove_all(staging_dir, ec);
+                throw;
+            }
+
+            // Another process may have unpacked the same bundle in the meantime.
+            boost::system::error_code ec;
+            bf::rename(staging_dir, cache_dir, ec);
+            if (ec)
+            {
+                bf::remove_all(staging_dir, ec);
+
+                if (!bf::exists(cache_dir / CompletionMarkerName))
+                    throw ExceptionIOError(("failed to move unpacked files to " + cache_dir.string()).c_str());
+            }
+        }
+        else RENDERER_LOG_DEBUG("reusing unpacked project bundle %s.", cache_dir.string().c_str());
+
+        project_filepath = (cache_dir / ProjectFileName).string();
+    }
+    catch (const ExceptionEOF&)
+    {
+        RENDERER_LOG_ERROR("failed to unpack project bundle %s: unexpected end of file.", bundle_filepath);
+        return false;
+    }
+    catch (const ExceptionIOError& e)
+    {
+        RENDERER_LOG_ERROR("failed to unpack project bundle %s: %s.", bundle_filepath, e.what());
+        return false;
+    }
+    catch (const bf::filesystem_error& e)
+    {
+        RENDERER_LOG_ERROR("failed to unpack project bundle %s: %s.", bundle_filepath, e.what());
+        return false;
+    }
+
+    return true;
+}
+
+}   // namespace renderer
@@ -0,0 +1,97 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_MODELING_PROJECT_PROJECTBUNDLE_H
+#define APPLESEED_RENDERER_MODELING_PROJECT_PROJECTBUNDLE_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <string>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// Project bundles.
+//
+// A project bundle is a single file holding a project file together with
+// the files it depends on (meshes, textures, compiled shaders, etc.). Each
+// file is stored as a sequence of independently LZ4-compressed chunks, and
+// an index at the end of the bundle maps names to chunk sequences so that
+// any file can be read without decompressing the others.
+//
+// Names are relative POSIX paths. Since mesh readers, OpenImageIO and OSL
+// open files by path, loading a bundle unpacks it once into a local cache
+// directory that becomes the project's root path; subsequent loads of the
+// same, unmodified bundle reuse the cache.
+//
+
+class ProjectBundle
+{
+  public:
+    // Name of the project file inside a bundle.
+    static const char* ProjectFileName;
+
+    struct File
+    {
+        std::string     m_name;             // name inside the bundle
+        std::string     m_filepath;         // path of the file on disk
+    };
+
+    // Return true if a given file starts with a project bundle signature.
+    static bool is_bundle(const char* filepath);
+
+    // Pack a set of files into a project bundle.
+    // Return true on success, false otherwise.
+    static bool write(
+        const char*                     bundle_filepath,
+        const std::vector<File>&        files);
+
+    // Read the content of a single file of a project bundle.
+    // Return true on success, false otherwise.
+    static bool read_file(
+        const char*                     bundle_filepath,
+        const char*                     name,
+        std::vector<foundation::uint8>& data);
+
+    // Unpack a project bundle into the bundle cache, unless this was already done,
+    // and return the path to the unpacked project file.
+    // Return true on success, false otherwise.
+    static bool unpack(
+        const char*                     bundle_filepath,
+        std::string&                    project_filepath);
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_MODELING_PROJECT_PROJECTBUNDLE_H
@@ -64,15 +64,19 @@
 #include "renderer/modeling/object/curveobject.h"
 #include "renderer/modeling/object/curveobjectreader.h"
 #include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectoperations.h"
 #include "renderer/modeling/object/meshobjectreader.h"
 #include "renderer/modeling/object/object.h"
+#include "renderer/modeling/project/assetprefetcher.h"
 #include "renderer/modeling/project/configuration.h"
 #include "renderer/modeling/project/configurationcontainer.h"
 #include "renderer/modeling/project/eventcounters.h"
 #include "renderer/modeling/project/irenderlayerrulefactory.h"
 #include "renderer/modeling/project/project.h"
+#include "renderer/modeling/project/projectbundle.h"
 #include "renderer/modeling/project/projectfileupdater.h"
 #include "renderer/modeling/project/projectformatrevision.h"
+#include "renderer/modeling/project/projectsnapshot.h"
 #include "renderer/modeling/project/renderlayerrule.h"
 #include "renderer/modeling/project/renderlayerrulefactoryregistrar.h"
 #include "renderer/modeling/project-builtin/cornellboxproject.h"
@@ -93,6 +97,7 @@
 #include "renderer/modeling/texture/texture.h"
 #include "renderer/modeling/texture/texturefactoryregistrar.h"
 #include "renderer/utility/paramarray.h"
+#include "renderer/utility/startupprofiler.h"
 #include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
@@ -1580,6 +1585,9 @@ namespace
         {
             ParametrizedElementHandler::end_element();
 
+            Stopwatch<DefaultWallclockTimer> stopwatch(0);
+            stopwatch.start();
+
             try
             {
                 if (m_model == MeshObjectFactory::get_model())
@@ -1628,6 +1636,9 @@ namespace
                     e.string());
                 m_context.get_event_counters().signal_error();
             }
+
+            stopwatch.measure();
+            global_startup_profiler().record_entity("object loading", m_name, stopwatch.get_seconds());
         }
 
         const ObjectVector& get_objects() const
@@ -3048,11 +3059,29 @@ auto_release_ptr<Project> ProjectFileReader::read(
     if (is_builtin_project(project_filepath, project_name))
         return load_builtin(project_name.c_str());
 
+    // Project bundles are unpacked to a local cache and loaded from there.
+    // Like project snapshots, they were validated when they were written.
+    if (ProjectBundle::is_bundle(project_filepath))
+    {
+        string bundled_project_filepath;
+        if (!ProjectBundle::unpack(project_filepath, bundled_project_filepath))
+            return auto_release_ptr<Project>(0);
+
+        return
+            read(
+                bundled_project_filepath.c_str(),
+                schema_filepath,
+                options | OmitProjectSchemaValidation);
+    }
+
     XercesCContext xerces_context(global_logger());
     if (!xerces_context.is_initialized())
         return auto_release_ptr<Project>(0);
 
-    if ((options & OmitProjectSchemaValidation) == false && schema_filepath == 0)
+    // Project snapshots were validated when they were written.
+    const bool is_snapshot = ProjectSnapshot::is_snapshot(project_filepath);
+
+    if (!is_snapshot && (options & OmitProjectSchemaValidation) == false && schema_filepath == 0)
     {
         RENDERER_LOG_ERROR(
             "project schema validation enabled, but no schema filepath provided.");
@@ -3062,16 +3091,33 @@ auto_release_ptr<Project> ProjectFileReader::read(
     Stopwatch<DefaultWallclockTimer> stopwatch;
     stopwatch.start();
 
+    // Startup timings are collected from the moment a project starts loading.
+    global_startup_profiler().clear();
+    StartupPhase loading_phase("project loading");
+
     EventCounters event_counters;
-    auto_release_ptr<Project> project(
-        load_project_file(
-            project_filepath,
-            schema_filepath,
-            options,
-            event_counters));
+    auto_release_ptr<Project> project;
+
+    {
+        StartupPhase phase("parsing");
+        project =
+            is_snapshot
+                ? load_project_snapshot(
+                      project_filepath,
+                      options,
+                      event_counters)
+                : load_project_file(
+                      project_filepath,
+                      schema_filepath,
+                      options,
+                      event_counters);
+    }
 
     if (project.get())
+    {
+        StartupPhase phase("post-processing");
         postprocess_project(project.ref(), event_counters, options);
+    }
 
     stopwatch.measure();
 
@@ -3138,6 +3184,9 @@ auto_release_ptr<Assembly> ProjectFileReader::read_archive(
     {
         if (Assembly* assembly = project->get_scene()->assemblies().get_by_name("assembly"))
         {
+            if (options & MergeIdenticalMeshObjects)
+                merge_identical_mesh_objects(*project);
+
             return auto_release_ptr<Assembly>(
                 project->get_scene()->assemblies().remove(assembly));
         }
@@ -3255,6 +3304,36 @@ auto_release_ptr<Project> ProjectFileReader::load_project_file(
     return project;
 }
 
+auto_release_ptr<Project> ProjectFileReader::load_project_snapshot(
+    const char*                     snapshot_filepath,
+    const int                       options,
+    EventCounters&                  event_counters) const
+{
+    // Create an empty project.
+    auto_release_ptr<Project> project(ProjectFactory::create(snapshot_filepath));
+    project->set_path(snapshot_filepath);
+
+    if ((options & OmitSearchPaths) == false)
+    {
+        project->search_paths().set_root_path(
+            bf::absolute(snapshot_filepath).parent_path().string());
+    }
+
+    // Create the content handler.
+    ParseContext context(project.ref(), options, event_counters);
+    auto_ptr<ContentHandler> content_handler(
+        new ContentHandler(
+            project.get(),
+            context));
+
+    // Replay the snapshot into the content handler.
+    RENDERER_LOG_INFO("loading project snapshot %s...", snapshot_filepath);
+    if (!ProjectSnapshot::replay(snapshot_filepath, *content_handler.get()))
+        return auto_release_ptr<Project>(0);
+
+    return project;
+}
+
 auto_release_ptr<Project> ProjectFileReader::construct_builtin_project(
     const char*             project_name,
     EventCounters&          event_counters) const
@@ -3290,6 +3369,12 @@ void ProjectFileReader::postprocess_project(
         !(options & OmitProjectFileUpdate) &&
         project.get_format_revision() < ProjectFormatRevision)
         upgrade_project(project, event_counters);
+
+    if (!event_counters.has_errors() && (options & MergeIdenticalMeshObjects))
+        merge_identical_mesh_objects(project);
+
+    if (!event_counters.has_errors() && !(options & OmitPrefetchingAssets))
+        AssetPrefetcher(project).prefetch_assets();
 }
 
 void ProjectFileReader::validate_project(
@@ -3345,6 +3430,23 @@ void ProjectFileReader::complete_project(
     }
 }
 
+void ProjectFileReader::merge_identical_mesh_objects(
+    Project&                project) const
+{
+    size_t removed_count = 0;
+
+    for (each<AssemblyContainer> i = project.get_scene()->assemblies(); i; ++i)
+        removed_count += renderer::merge_identical_mesh_objects(*i);
+
+    if (removed_count > 0)
+    {
+        RENDERER_LOG_INFO(
+            "merged %s duplicate mesh object%s.",
+            pretty_uint(removed_count).c_str(),
+            removed_count > 1 ? "s" : "");
+    }
+}
+
 void ProjectFileReader::upgrade_project(
     Project&                project,
     EventCounters&          event_counters) const
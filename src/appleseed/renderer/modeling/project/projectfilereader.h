@@ -58,10 +58,12 @@ class APPLESEED_DLLSYMBOL ProjectFileReader
         OmitReadingMeshFiles        = 1 << 0,   // do not read mesh files from disk
         OmitProjectFileUpdate       = 1 << 1,   // do not update the project file format to the latest revision
         OmitSearchPaths             = 1 << 2,   // do not read search paths from the project
-        OmitProjectSchemaValidation = 1 << 3    // do not validate project against schema
+        OmitProjectSchemaValidation = 1 << 3,   // do not validate project against schema
+        MergeIdenticalMeshObjects   = 1 << 4,   // make instances of identical mesh objects share a single one
+        OmitPrefetchingAssets       = 1 << 5    // do not prefetch asset files after the project is loaded
     };
 
-    // Read a project from disk (or load a built-in project).
+    // Read a project file or a project snapshot from disk (or load a built-in project).
     // Return 0 if reading or parsing the file failed.
     foundation::auto_release_ptr<Project> read(
         const char*                     project_filepath,
@@ -89,6 +91,11 @@ class APPLESEED_DLLSYMBOL ProjectFileReader
         EventCounters&                  event_counters,
         const foundation::SearchPaths*  search_paths = 0) const;
 
+    foundation::auto_release_ptr<Project> load_project_snapshot(
+        const char*                     snapshot_filepath,
+        const int                       options,
+        EventCounters&                  event_counters) const;
+
     foundation::auto_release_ptr<Project> construct_builtin_project(
         const char*                     project_name,
         EventCounters&                  event_counters) const;
@@ -109,6 +116,10 @@ class APPLESEED_DLLSYMBOL ProjectFileReader
         Project&                        project,
         EventCounters&                  event_counters) const;
 
+    // Remove duplicate mesh objects from the assemblies of a project.
+    void merge_identical_mesh_objects(
+        Project&                        project) const;
+
     // Update a project to the latest project format revision.
     void upgrade_project(
         Project&                        project,
@@ -31,6 +31,7 @@
 #include "projectfilewriter.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/modeling/bsdf/bsdf.h"
 #include "renderer/modeling/bssrdf/bssrdf.h"
 #include "renderer/modeling/camera/camera.h"
@@ -52,10 +53,13 @@
 #include "renderer/modeling/project/configuration.h"
 #include "renderer/modeling/project/configurationcontainer.h"
 #include "renderer/modeling/project/project.h"
+#include "renderer/modeling/project/projectbundle.h"
+#include "renderer/modeling/project/projectsnapshot.h"
 #include "renderer/modeling/project/renderlayerrule.h"
 #include "renderer/modeling/project/renderlayerrulecontainer.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/basegroup.h"
 #include "renderer/modeling/scene/containers.h"
 #include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/proceduralassembly.h"
@@ -72,14 +76,20 @@
 // appleseed.foundation headers.
 #include "foundation/core/appleseed.h"
 #include "foundation/math/transform.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/indenter.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/searchpaths.h"
+#include "foundation/utility/siphash.h"
 #include "foundation/utility/string.h"
 #include "foundation/utility/xmlelement.h"
 
 // Boost headers.
+#include "boost/filesystem/operations.hpp"
 #include "boost/filesystem/path.hpp"
 
 // Standard headers.
@@ -87,6 +97,7 @@
 #include <cassert>
 #include <cstdio>
 #include <cstring>
+#include <ctime>
 #include <exception>
 #include <map>
 #include <set>
@@ -110,6 +121,65 @@ namespace
     const char* MatrixFormat     = "%.15f";
     const char* ColorValueFormat = "%.6f";
 
+    // A mesh file to write once the project file is written.
+    struct MeshFile
+    {
+        const MeshObject*   m_object;
+        string              m_object_name;
+        string              m_filepath;
+    };
+
+    class WriteMeshFileJob
+      : public IJob
+    {
+      public:
+        WriteMeshFileJob(
+            const MeshFile&     mesh_file,
+            uint8&              success)
+          : m_mesh_file(mesh_file)
+          , m_success(success)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            m_success =
+                MeshObjectWriter::write(
+                    *m_mesh_file.m_object,
+                    m_mesh_file.m_object_name.c_str(),
+                    m_mesh_file.m_filepath.c_str()) ? 1 : 0;
+        }
+
+      private:
+        const MeshFile&         m_mesh_file;
+        uint8&                  m_success;
+    };
+
+    // Write mesh files in parallel. Return true if all files were written.
+    bool write_mesh_files(const vector<MeshFile>& mesh_files)
+    {
+        if (mesh_files.empty())
+            return true;
+
+        const size_t file_count = mesh_files.size();
+        vector<uint8> success(file_count, 0);
+
+        JobQueue job_queue;
+
+        for (size_t i = 0; i < file_count; ++i)
+            job_queue.schedule(new WriteMeshFileJob(mesh_files[i], success[i]));
+
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            min(System::get_available_cpu_core_count(), file_count));
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        return count(success.begin(), success.end(), 1) == file_count;
+    }
+
     class Writer
     {
       public:
@@ -126,6 +196,12 @@ namespace
         {
         }
 
+        // Access the mesh files that remain to be written.
+        const vector<MeshFile>& get_mesh_files() const
+        {
+            return m_mesh_files;
+        }
+
         // Write the <project> element.
         void write_project(const Project& project)
         {
@@ -151,6 +227,7 @@ namespace
         FILE*                   m_file;
         const int               m_options;
         Indenter                m_indenter;
+        vector<MeshFile>        m_mesh_files;
 
         // Write a vector of scalars.
         template <typename Vec>
@@ -642,9 +719,12 @@ namespace
 
             if (!(m_options & ProjectFileWriter::OmitWritingGeometryFiles))
             {
-                // Write the mesh file to disk.
-                const string filepath = (m_project_new_root_dir / filename).string();
-                MeshObjectWriter::write(object, object_name.c_str(), filepath.c_str());
+                // Mesh files are written in parallel once the project file is written.
+                MeshFile mesh_file;
+                mesh_file.m_object = &object;
+                mesh_file.m_object_name = object_name;
+                mesh_file.m_filepath = (m_project_new_root_dir / filename).string();
+                m_mesh_files.push_back(mesh_file);
             }
 
             // Write the <object> element.
@@ -921,8 +1001,272 @@ bool ProjectFileWriter::write(
     // Close the file.
     fclose(file);
 
+    // Write the mesh files of the objects that don't reference one.
+    if (!write_mesh_files(writer.get_mesh_files()))
+    {
+        RENDERER_LOG_ERROR("failed to write project file %s: could not write all mesh files.", filepath);
+        return false;
+    }
+
     RENDERER_LOG_INFO("wrote project file %s.", filepath);
     return true;
 }
 
+bool ProjectFileWriter::write_snapshot(
+    const Project&  project,
+    const char*     filepath,
+    const int       options)
+{
+    // Write a temporary project file next to the snapshot so that relative paths remain valid.
+    const string project_filepath = string(filepath) + ".tmp.appleseed";
+
+    if (!write(project, project_filepath.c_str(), options | OmitHeaderComment))
+        return false;
+
+    RENDERER_LOG_INFO("writing project snapshot %s...", filepath);
+
+    const bool success = ProjectSnapshot::compile(project_filepath.c_str(), filepath);
+
+    system::error_code ec;
+    filesystem::remove(project_filepath, ec);
+
+    if (success)
+        RENDERER_LOG_INFO("wrote project snapshot %s.", filepath);
+
+    return success;
+}
+
+
+namespace
+{
+    template <typename EntityCollection>
+    void do_collect_asset_paths(
+        StringArray&            paths,
+        const EntityCollection& entities)
+    {
+        for (const_each<EntityCollection> i = entities; i; ++i)
+            i->collect_asset_paths(paths);
+    }
+
+    template <typename EntityCollection>
+    void do_update_asset_paths(
+        const StringDictionary& mappings,
+        EntityCollection&       entities)
+    {
+        for (each<EntityCollection> i = entities; i; ++i)
+            i->update_asset_paths(mappings);
+    }
+
+    vector<string> collect_asset_paths(const Project& project)
+    {
+        StringArray paths;
+
+        if (project.get_scene())
+            project.get_scene()->collect_asset_paths(paths);
+
+        if (project.get_frame())
+            project.get_frame()->collect_asset_paths(paths);
+
+        do_collect_asset_paths(paths, project.render_layer_rules());
+        do_collect_asset_paths(paths, project.configurations());
+
+        vector<string> unique_paths = array_vector<vector<string> >(paths);
+        sort(unique_paths.begin(), unique_paths.end());
+        unique_paths.erase(
+            unique(unique_paths.begin(), unique_paths.end()),
+            unique_paths.end());
+
+        return unique_paths;
+    }
+
+    void update_asset_paths(
+        const Project&          project,
+        const StringDictionary& mappings)
+    {
+        if (project.get_scene())
+            project.get_scene()->update_asset_paths(mappings);
+
+        if (project.get_frame())
+            project.get_frame()->update_asset_paths(mappings);
+
+        do_update_asset_paths(mappings, project.render_layer_rules());
+        do_update_asset_paths(mappings, project.configurations());
+    }
+
+    void collect_shader_names(
+        const BaseGroup&        group,
+        set<string>&            names)
+    {
+        for (const_each<ShaderGroupContainer> i = group.shader_groups(); i; ++i)
+        {
+            for (const_each<ShaderContainer> j = i->shaders(); j; ++j)
+                names.insert(j->get_shader());
+        }
+
+        for (const_each<AssemblyContainer> i = group.assemblies(); i; ++i)
+            collect_shader_names(*i, names);
+    }
+
+    // Name of the bundle directory holding compiled shaders; added to the project's search paths.
+    const char* BundleShaderDirectory = "shaders";
+}
+
+bool ProjectFileWriter::write_bundle(
+    const Project&  project,
+    const char*     filepath,
+    const int       options)
+{
+    vector<ProjectBundle::File> files;
+
+    // Write a temporary project file next to the bundle; it becomes the bundle's project file.
+    const string project_filepath = string(filepath) + ".tmp.appleseed";
+    ProjectBundle::File project_file;
+    project_file.m_name = ProjectBundle::ProjectFileName;
+    project_file.m_filepath = project_filepath;
+    files.push_back(project_file);
+
+    // Give each asset file a unique name in the bundle, keeping its file name and extension.
+    const vector<string> asset_paths = collect_asset_paths(project);
+    StringDictionary mappings;
+    StringDictionary reverse_mappings;
+
+    for (size_t i = 0, e = asset_paths.size(); i < e; ++i)
+    {
+        const string qualified_path = project.search_paths().qualify(asset_paths[i]);
+
+        if (!filesystem::exists(qualified_path))
+        {
+            RENDERER_LOG_ERROR(
+                "failed to write project bundle %s: asset file %s not found.",
+                filepath,
+                asset_paths[i].c_str());
+            return false;
+        }
+
+        ProjectBundle::File file;
+        file.m_name = format("assets/{0}/{1}", i, filesystem::path(qualified_path).filename().string());
+        file.m_filepath = qualified_path;
+        files.push_back(file);
+
+        mappings.insert(asset_paths[i], file.m_name);
+        reverse_mappings.insert(file.m_name, asset_paths[i]);
+    }
+
+    // Bundle the compiled shaders found in the project's search paths. Shaders that are not
+    // found are assumed to ship with the renderer.
+    set<string> shader_names;
+    if (project.get_scene())
+        collect_shader_names(*project.get_scene(), shader_names);
+
+    for (const_each<set<string> > i = shader_names; i; ++i)
+    {
+        const string shader_filename = *i + ".oso";
+        const string qualified_path = project.search_paths().qualify(shader_filename);
+
+        if (filesystem::exists(qualified_path))
+        {
+            ProjectBundle::File file;
+            file.m_name = string(BundleShaderDirectory) + "/" + shader_filename;
+            file.m_filepath = qualified_path;
+            files.push_back(file);
+        }
+        else RENDERER_LOG_DEBUG("not bundling shader %s: file not found in search paths.", i->c_str());
+    }
+
+    // Temporarily point the project to the files in the bundle while writing it.
+    const SearchPaths search_paths(project.search_paths());
+    if (files.size() > asset_paths.size() + 1)
+        project.search_paths().push_back(BundleShaderDirectory);
+    update_asset_paths(project, mappings);
+
+    bool success =
+        write(
+            project,
+            project_filepath.c_str(),
+            options | OmitHeaderComment | OmitWritingGeometryFiles | OmitHandlingAssetFiles);
+
+    update_asset_paths(project, reverse_mappings);
+    project.search_paths() = search_paths;
+
+    if (success)
+        success = ProjectBundle::write(filepath, files);
+
+    system::error_code ec;
+    filesystem::remove(project_filepath, ec);
+
+    return success;
+}
+
+namespace
+{
+    // Combine a file, identified by its path, size and modification time, into a hash.
+    // Missing files are hashed too so that the hash changes when they appear.
+    void hash_file(const string& filepath, uint64& hash)
+    {
+        system::error_code size_ec, time_ec;
+        const uint64 size = filesystem::file_size(filepath, size_ec);
+        const time_t time = filesystem::last_write_time(filepath, time_ec);
+
+        hash = siphash24(hash, siphash24(filepath.c_str(), filepath.size()));
+        hash = siphash24(hash, size_ec ? ~uint64(0) : size);
+        hash = siphash24(hash, time_ec ? ~uint64(0) : static_cast<uint64>(time));
+    }
+}
+
+bool ProjectFileWriter::compute_hash(
+    const Project&  project,
+    uint64&         hash)
+{
+    // Write the project to an anonymous temporary file. Geometry files are not written
+    // and asset paths are left untouched: they are accounted for below.
+    FILE* file = tmpfile();
+    if (file == 0)
+    {
+        RENDERER_LOG_ERROR("failed to compute project hash: i/o error.");
+        return false;
+    }
+
+    Writer writer(
+        project,
+        "",
+        file,
+        OmitHeaderComment | OmitWritingGeometryFiles | OmitHandlingAssetFiles);
+    writer.write_project(project);
+
+    // A different version of appleseed may render the same project differently.
+    const char* version = Appleseed::get_synthetic_version_string();
+    hash = siphash24(version, strlen(version));
+
+    // Hash the project file.
+    rewind(file);
+    vector<char> buffer(1024 * 1024);
+    size_t size;
+    while ((size = fread(&buffer[0], 1, buffer.size(), file)) > 0)
+        hash = siphash24(hash, siphash24(&buffer[0], size));
+
+    const bool success = ferror(file) == 0;
+    fclose(file);
+
+    if (!success)
+    {
+        RENDERER_LOG_ERROR("failed to compute project hash: i/o error.");
+        return false;
+    }
+
+    // Hash the asset files.
+    const vector<string> asset_paths = collect_asset_paths(project);
+    for (size_t i = 0, e = asset_paths.size(); i < e; ++i)
+        hash_file(project.search_paths().qualify(asset_paths[i]), hash);
+
+    // Hash the compiled shaders.
+    set<string> shader_names;
+    if (project.get_scene())
+        collect_shader_names(*project.get_scene(), shader_names);
+
+    for (const_each<set<string> > i = shader_names; i; ++i)
+        hash_file(project.search_paths().qualify(*i + ".oso"), hash);
+
+    return true;
+}
+
 }   // namespace renderer
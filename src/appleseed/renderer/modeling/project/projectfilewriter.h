@@ -30,6 +30,9 @@
 #ifndef APPLESEED_RENDERER_MODELING_PROJECT_PROJECTFILEWRITER_H
 #define APPLESEED_RENDERER_MODELING_PROJECT_PROJECTFILEWRITER_H
 
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
@@ -60,6 +63,32 @@ class APPLESEED_DLLSYMBOL ProjectFileWriter
         const Project&  project,
         const char*     filepath,
         const int       options = Defaults);
+
+    // Write a project to disk as a project snapshot, a binary file that loads much faster
+    // than a project file. Geometry and asset files are handled like in write().
+    // Return true on success, false otherwise.
+    static bool write_snapshot(
+        const Project&  project,
+        const char*     filepath,
+        const int       options = Defaults);
+
+    // Write a project to disk as a project bundle, a single file containing the project
+    // together with its asset files and the compiled shaders it uses. Geometry files are
+    // not written: objects must reference existing geometry files.
+    // Return true on success, false otherwise.
+    static bool write_bundle(
+        const Project&  project,
+        const char*     filepath,
+        const int       options = Defaults);
+
+    // Compute a hash of everything in a project that affects rendering: the project itself,
+    // as it would be written to disk, together with the asset files and the compiled shaders
+    // it references, and the version of appleseed. Files are identified by their path, size
+    // and modification time rather than by their contents. The hash is stable across runs.
+    // Return true on success, false otherwise.
+    static bool compute_hash(
+        const Project&      project,
+        foundation::uint64& hash);
 };
 
 }       // namespace renderer
@@ -0,0 +1,581 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "projectsnapshot.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exception.h"
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/xercesc.h"
+
+// Xerces-C++ headers.
+#include "xercesc/sax2/Attributes.hpp"
+#include "xercesc/sax2/DefaultHandler.hpp"
+#include "xercesc/sax2/SAX2XMLReader.hpp"
+#include "xercesc/sax2/XMLReaderFactory.hpp"
+#include "xercesc/sax/SAXParseException.hpp"
+#include "xercesc/util/XMLException.hpp"
+#include "xercesc/util/XMLString.hpp"
+#include "xercesc/util/XMLUni.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+using namespace xercesc;
+
+namespace renderer
+{
+
+//
+// ProjectSnapshot class implementation.
+//
+// File layout:
+//
+//   signature      char[17]        "APPLESEEDSNAPSHOT"
+//   version        uint16
+//   char size      uint8           sizeof(XMLCh) on the machine that wrote the snapshot
+//   records        LZ4-compressed stream of records, terminated by an EndOfStream record
+//
+// Records:
+//
+//   DefineName     uint8 opcode, string            interns an element or attribute name
+//   StartElement   uint8 opcode, uint32 name,
+//                  uint32 count, count x (uint32 name, string value)
+//   EndElement     uint8 opcode
+//   Characters     uint8 opcode, string
+//   EndOfStream    uint8 opcode
+//
+// Strings are stored as a uint32 length followed by that many XMLCh characters.
+//
+
+namespace
+{
+    typedef basic_string<XMLCh> XMLString16;
+
+    const char Signature[17] =
+        { 'A', 'P', 'P', 'L', 'E', 'S', 'E', 'E', 'D', 'S', 'N', 'A', 'P', 'S', 'H', 'O', 'T' };
+
+    const uint16 Version = 1;
+
+    // Type reported for all replayed attributes.
+    const XMLCh CDATAType[] = { 'C', 'D', 'A', 'T', 'A', 0 };
+
+    enum Opcode
+    {
+        OpcodeDefineName    = 0,
+        OpcodeStartElement  = 1,
+        OpcodeEndElement    = 2,
+        OpcodeCharacters    = 3,
+        OpcodeEndOfStream   = 4
+    };
+
+    struct ExceptionEOF : public Exception {};
+
+    template <typename File>
+    inline void checked_write(File& file, const void* inbuf, const size_t size)
+    {
+        const size_t bytes_written = file.write(inbuf, size);
+
+        if (bytes_written < size)
+            throw ExceptionIOError();
+    }
+
+    template <typename File, typename T>
+    inline void checked_write(File& file, const T& object)
+    {
+        checked_write(file, &object, sizeof(T));
+    }
+
+    template <typename File>
+    inline void checked_read(File& file, void* outbuf, const size_t size)
+    {
+        if (size == 0)
+            return;
+
+        const size_t bytes_read = file.read(outbuf, size);
+
+        if (bytes_read == 0)
+            throw ExceptionEOF();
+
+        if (bytes_read < size)
+            throw ExceptionIOError();
+    }
+
+    template <typename File, typename T>
+    inline void checked_read(File& file, T& object)
+    {
+        checked_read(file, &object, sizeof(T));
+    }
+
+    void write_string(WriterAdapter& writer, const XMLCh* s, const size_t length)
+    {
+        checked_write(writer, static_cast<uint32>(length));
+        checked_write(writer, s, length * sizeof(XMLCh));
+    }
+
+    void read_string(ReaderAdapter& reader, XMLString16& s)
+    {
+        uint32 length;
+        checked_read(reader, length);
+
+        s.resize(length);
+
+        if (length > 0)
+            checked_read(reader, &s[0], length * sizeof(XMLCh));
+    }
+
+    bool read_header(BufferedFile& file)
+    {
+        char signature[sizeof(Signature)];
+        if (file.read(signature, sizeof(signature)) < sizeof(signature) ||
+            memcmp(signature, Signature, sizeof(Signature)))
+            return false;
+
+        uint16 version;
+        if (file.read(version) < sizeof(version) || version != Version)
+            return false;
+
+        uint8 char_size;
+        if (file.read(char_size) < sizeof(char_size) || char_size != sizeof(XMLCh))
+            return false;
+
+        return true;
+    }
+
+
+    //
+    // A content handler that records the events it receives into a snapshot.
+    //
+
+    class RecordingHandler
+      : public DefaultHandler
+    {
+      public:
+        explicit RecordingHandler(WriterAdapter& writer)
+          : m_writer(writer)
+        {
+        }
+
+        virtual void startElement(
+            const XMLCh* const  uri,
+            const XMLCh* const  localname,
+            const XMLCh* const  qname,
+            const Attributes&   attrs) APPLESEED_OVERRIDE
+        {
+            const uint32 name = intern(localname);
+
+            const XMLSize_t attr_count = attrs.getLength();
+
+            vector<uint32> attr_names(attr_count);
+            for (XMLSize_t i = 0; i < attr_count; ++i)
+                attr_names[i] = intern(attrs.getLocalName(i));
+
+            checked_write(m_writer, static_cast<uint8>(OpcodeStartElement));
+            checked_write(m_writer, name);
+            checked_write(m_writer, static_cast<uint32>(attr_count));
+
+            for (XMLSize_t i = 0; i < attr_count; ++i)
+            {
+                const XMLCh* value = attrs.getValue(i);
+                checked_write(m_writer, attr_names[i]);
+                write_string(m_writer, value, XMLString::stringLen(value));
+            }
+        }
+
+        virtual void endElement(
+            const XMLCh* const  uri,
+            const XMLCh* const  localname,
+            const XMLCh* const  qname) APPLESEED_OVERRIDE
+        {
+            checked_write(m_writer, static_cast<uint8>(OpcodeEndElement));
+        }
+
+        virtual void characters(
+            const XMLCh* const  chars,
+            const XMLSize_t     length) APPLESEED_OVERRIDE
+        {
+            checked_write(m_writer, static_cast<uint8>(OpcodeCharacters));
+            write_string(m_writer, chars, length);
+        }
+
+        void end_stream()
+        {
+            checked_write(m_writer, static_cast<uint8>(OpcodeEndOfStream));
+        }
+
+      private:
+        typedef map<XMLString16, uint32> NameMap;
+
+        WriterAdapter&  m_writer;
+        NameMap         m_names;
+
+        uint32 intern(const XMLCh* name)
+        {
+            const XMLString16 key(name);
+
+            const NameMap::const_iterator i = m_names.find(key);
+            if (i != m_names.end())
+                return i->second;
+
+            const uint32 index = static_cast<uint32>(m_names.size());
+            m_names.insert(make_pair(key, index));
+
+            checked_write(m_writer, static_cast<uint8>(OpcodeDefineName));
+            write_string(m_writer, key.c_str(), key.size());
+
+            return index;
+        }
+    };
+
+
+    //
+    // The attributes of an element replayed from a snapshot.
+    //
+
+    class ReplayedAttributes
+      : public Attributes
+    {
+      public:
+        explicit ReplayedAttributes(const vector<XMLString16>& names)
+          : m_names(names)
+          , m_count(0)
+        {
+        }
+
+        void resize(const size_t count)
+        {
+            m_count = count;
+
+            if (m_attributes.size() < count)
+                m_attributes.resize(count);
+        }
+
+        pair<uint32, XMLString16>& operator[](const size_t index)
+        {
+            return m_attributes[index];
+        }
+
+        virtual XMLSize_t getLength() const APPLESEED_OVERRIDE
+        {
+            return m_count;
+        }
+
+        virtual const XMLCh* getURI(const XMLSize_t index) const APPLESEED_OVERRIDE
+        {
+            return index < m_count ? XMLUni::fgZeroLenString : 0;
+        }
+
+        virtual const XMLCh* getLocalName(const XMLSize_t index) const APPLESEED_OVERRIDE
+        {
+            return index < m_count ? m_names[m_attributes[index].first].c_str() : 0;
+        }
+
+        virtual const XMLCh* getQName(const XMLSize_t index) const APPLESEED_OVERRIDE
+        {
+            return getLocalName(index);
+        }
+
+        virtual const XMLCh* getType(const XMLSize_t index) const APPLESEED_OVERRIDE
+        {
+            return index < m_count ? CDATAType : 0;
+        }
+
+        virtual const XMLCh* getValue(const XMLSize_t index) const APPLESEED_OVERRIDE
+        {
+            return index < m_count ? m_attributes[index].second.c_str() : 0;
+        }
+
+        virtual bool getIndex(
+            const XMLCh* const  uri,
+            const XMLCh* const  local_part,
+            XMLSize_t&          index) const APPLESEED_OVERRIDE
+        {
+            return getIndex(local_part, index);
+        }
+
+        virtual int getIndex(
+            const XMLCh* const  uri,
+            const XMLCh* const  local_part) const APPLESEED_OVERRIDE
+        {
+            return getIndex(local_part);
+        }
+
+        virtual bool getIndex(
+            const XMLCh* const  qname,
+            XMLSize_t&          index) const APPLESEED_OVERRIDE
+        {
+            for (XMLSize_t i = 0; i < m_count; ++i)
+            {
+                if (XMLString::equals(m_names[m_attributes[i].first].c_str(), qname))
+                {
+                    index = i;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        virtual int getIndex(const XMLCh* const qname) const APPLESEED_OVERRIDE
+        {
+            XMLSize_t index;
+            return getIndex(qname, index) ? static_cast<int>(index) : -1;
+        }
+
+        virtual const XMLCh* getType(
+            const XMLCh* const  uri,
+            const XMLCh* const  local_part) const APPLESEED_OVERRIDE
+        {
+            return getType(local_part);
+        }
+
+        virtual const XMLCh* getType(const XMLCh* const qname) const APPLESEED_OVERRIDE
+        {
+            XMLSize_t index;
+            return getIndex(qname, index) ? getType(index) : 0;
+        }
+
+        virtual const XMLCh* getValue(
+            const XMLCh* const  uri,
+            const XMLCh* const  local_part) const APPLESEED_OVERRIDE
+        {
+            return getValue(local_part);
+        }
+
+        virtual const XMLCh* getValue(const XMLCh* const qname) const APPLESEED_OVERRIDE
+        {
+            XMLSize_t index;
+            return getIndex(qname, index) ? getValue(index) : 0;
+        }
+
+      private:
+        const vector<XMLString16>&              m_names;
+        vector<pair<uint32, XMLString16> >      m_attributes;
+        size_t                                  m_count;
+    };
+
+    void replay_records(ReaderAdapter& reader, ContentHandler& handler)
+    {
+        vector<XMLString16> names;
+        vector<uint32> element_stack;
+        ReplayedAttributes attrs(names);
+        XMLString16 chars;
+
+        while (true)
+        {
+            uint8 opcode;
+            checked_read(reader, opcode);
+
+            switch (opcode)
+            {
+              case OpcodeDefineName:
+                names.push_back(XMLString16());
+                read_string(reader, names.back());
+                break;
+
+              case OpcodeStartElement:
+                {
+                    uint32 name;
+                    checked_read(reader, name);
+
+                    uint32 attr_count;
+                    checked_read(reader, attr_count);
+
+                    attrs.resize(attr_count);
+
+                    for (uint32 i = 0; i < attr_count; ++i)
+                    {
+                        checked_read(reader, attrs[i].first);
+                        read_string(reader, attrs[i].second);
+
+                        if (attrs[i].first >= names.size())
+                            throw ExceptionIOError("invalid attribute name");
+                    }
+
+                    if (name >= names.size())
+                        throw ExceptionIOError("invalid element name");
+
+                    element_stack.push_back(name);
+
+                    const XMLCh* element_name = names[name].c_str();
+                    handler.startElement(XMLUni::fgZeroLenString, element_name, element_name, attrs);
+                }
+                break;
+
+              case OpcodeEndElement:
+                {
+                    if (element_stack.empty())
+                        throw ExceptionIOError("unbalanced elements");
+
+                    const XMLCh* element_name = names[element_stack.back()].c_str();
+                    element_stack.pop_back();
+
+                    handler.endElement(XMLUni::fgZeroLenString, element_name, element_name);
+                }
+                break;
+
+              case OpcodeCharacters:
+                read_string(reader, chars);
+                handler.characters(chars.c_str(), chars.size());
+                break;
+
+              case OpcodeEndOfStream:
+                if (!element_stack.empty())
+                    throw ExceptionIOError("unbalanced elements");
+                return;
+
+              default:
+                throw ExceptionIOError("unknown record");
+            }
+        }
+    }
+}
+
+bool ProjectSnapshot::is_snapshot(const char* filepath)
+{
+    BufferedFile file(
+        filepath,
+        BufferedFile::BinaryType,
+        BufferedFile::ReadMode);
+
+    return file.is_open() && read_header(file);
+}
+
+bool ProjectSnapshot::compile(
+    const char*                 project_filepath,
+    const char*                 snapshot_filepath)
+{
+    XercesCContext xerces_context(global_logger());
+    if (!xerces_context.is_initialized())
+        return false;
+
+    BufferedFile file(
+        snapshot_filepath,
+        BufferedFile::BinaryType,
+        BufferedFile::WriteMode);
+
+    if (!file.is_open())
+    {
+        RENDERER_LOG_ERROR("failed to write project snapshot %s: i/o error.", snapshot_filepath);
+        return false;
+    }
+
+    try
+    {
+        checked_write(file, Signature, sizeof(Signature));
+        checked_write(file, Version);
+        checked_write(file, static_cast<uint8>(sizeof(XMLCh)));
+
+        {
+            LZ4CompressedWriterAdapter writer(file);
+            RecordingHandler handler(writer);
+
+            // The project file was just written by ProjectFileWriter; don't validate it again.
+            auto_ptr<SAX2XMLReader> parser(XMLReaderFactory::createXMLReader());
+            parser->setFeature(XMLUni::fgSAX2CoreNameSpaces, true);
+            parser->setFeature(XMLUni::fgSAX2CoreValidation, false);
+            parser->setFeature(XMLUni::fgXercesSchema, false);
+            parser->setContentHandler(&handler);
+            parser->setErrorHandler(&handler);
+
+            parser->parse(project_filepath);
+
+            handler.end_stream();
+        }
+    }
+    catch (const ExceptionIOError&)
+    {
+        RENDERER_LOG_ERROR("failed to write project snapshot %s: i/o error.", snapshot_filepath);
+        return false;
+    }
+    catch (const XMLException&)
+    {
+        RENDERER_LOG_ERROR("failed to write project snapshot %s: could not parse %s.", snapshot_filepath, project_filepath);
+        return false;
+    }
+    catch (const SAXParseException&)
+    {
+        RENDERER_LOG_ERROR("failed to write project snapshot %s: could not parse %s.", snapshot_filepath, project_filepath);
+        return false;
+    }
+
+    return file.close();
+}
+
+bool ProjectSnapshot::replay(
+    const char*                 snapshot_filepath,
+    ContentHandler&             handler)
+{
+    BufferedFile file(
+        snapshot_filepath,
+        BufferedFile::BinaryType,
+        BufferedFile::ReadMode);
+
+    if (!file.is_open() || !read_header(file))
+    {
+        RENDERER_LOG_ERROR("failed to read project snapshot %s: invalid file header.", snapshot_filepath);
+        return false;
+    }
+
+    try
+    {
+        LZ4CompressedReaderAdapter reader(file);
+        replay_records(reader, handler);
+    }
+    catch (const ExceptionEOF&)
+    {
+        RENDERER_LOG_ERROR("failed to read project snapshot %s: unexpected end of file.", snapshot_filepath);
+        return false;
+    }
+    catch (const ExceptionIOError& e)
+    {
+        RENDERER_LOG_ERROR("failed to read project snapshot %s: %s.", snapshot_filepath, e.what());
+        return false;
+    }
+
+    return true;
+}
+
+}   // namespace renderer
@@ -0,0 +1,75 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_MODELING_PROJECT_PROJECTSNAPSHOT_H
+#define APPLESEED_RENDERER_MODELING_PROJECT_PROJECTSNAPSHOT_H
+
+// Xerces-C++ headers.
+#include "xercesc/sax2/ContentHandler.hpp"
+
+namespace renderer
+{
+
+//
+// Project snapshots.
+//
+// A project snapshot is a compact binary recording of the element tree of a
+// project file: element and attribute names are interned, text is stored in
+// the parser's native character encoding and the whole stream is compressed.
+// Loading a snapshot replays this recording into the same content handler
+// used for project files, skipping XML tokenization, character decoding and
+// schema validation while guaranteeing identical results.
+//
+// Geometry and other assets stay in their own files (e.g. binarymesh files
+// written alongside the snapshot) and are referenced exactly like they are
+// from the project file the snapshot was compiled from.
+//
+
+class ProjectSnapshot
+{
+  public:
+    // Return true if a given file starts with a project snapshot signature.
+    static bool is_snapshot(const char* filepath);
+
+    // Compile an XML project file into a project snapshot.
+    // Return true on success, false otherwise.
+    static bool compile(
+        const char*                 project_filepath,
+        const char*                 snapshot_filepath);
+
+    // Replay the content of a project snapshot into a SAX2 content handler.
+    // Return true on success, false otherwise.
+    static bool replay(
+        const char*                 snapshot_filepath,
+        xercesc::ContentHandler&    handler);
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_MODELING_PROJECT_PROJECTSNAPSHOT_H
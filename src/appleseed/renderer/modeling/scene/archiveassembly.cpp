@@ -99,34 +99,25 @@ bool ArchiveAssembly::expand_contents(
 {
     if (!m_archive_opened)
     {
-        // Establish and store the qualified path to the archive project.
-        const SearchPaths& search_paths = project.search_paths();
-        const string filepath = search_paths.qualify(m_params.get_required<string>("filename", ""));
-
-        ProjectFileReader reader;
-        auto_release_ptr<Assembly> assembly =
-            reader.read_archive(
-                filepath.c_str(),
-                0,  // for now, we don't validate archives
-                search_paths,
-                ProjectFileReader::OmitProjectSchemaValidation);
-
-        if (assembly.get())
+        read_archive(project);
+
+        if (m_archive.get())
         {
-            assemblies().swap(assembly->assemblies());
-            assembly_instances().swap(assembly->assembly_instances());
-            bsdfs().swap(assembly->bsdfs());
-            bssrdfs().swap(assembly->bssrdfs());
-            colors().swap(assembly->colors());
-            edfs().swap(assembly->edfs());
-            lights().swap(assembly->lights());
-            materials().swap(assembly->materials());
-            objects().swap(assembly->objects());
-            object_instances().swap(assembly->object_instances());
-            shader_groups().swap(assembly->shader_groups());
-            surface_shaders().swap(assembly->surface_shaders());
-            textures().swap(assembly->textures());
-            texture_instances().swap(assembly->texture_instances());
+            assemblies().swap(m_archive->assemblies());
+            assembly_instances().swap(m_archive->assembly_instances());
+            bsdfs().swap(m_archive->bsdfs());
+            bssrdfs().swap(m_archive->bssrdfs());
+            colors().swap(m_archive->colors());
+            edfs().swap(m_archive->edfs());
+            lights().swap(m_archive->lights());
+            materials().swap(m_archive->materials());
+            objects().swap(m_archive->objects());
+            object_instances().swap(m_archive->object_instances());
+            shader_groups().swap(m_archive->shader_groups());
+            surface_shaders().swap(m_archive->surface_shaders());
+            textures().swap(m_archive->textures());
+            texture_instances().swap(m_archive->texture_instances());
+            m_archive.reset();
             m_archive_opened = true;
         }
     }
@@ -134,6 +125,25 @@ bool ArchiveAssembly::expand_contents(
     return true;
 }
 
+void ArchiveAssembly::read_archive(const Project& project)
+{
+    if (m_archive_opened || m_archive.get())
+        return;
+
+    // Establish and store the qualified path to the archive project.
+    const SearchPaths& search_paths = project.search_paths();
+    const string filepath = search_paths.qualify(m_params.get_required<string>("filename", ""));
+
+    ProjectFileReader reader;
+    m_archive =
+        reader.read_archive(
+            filepath.c_str(),
+            0,  // for now, we don't validate archives
+            search_paths,
+            ProjectFileReader::OmitProjectSchemaValidation |
+            ProjectFileReader::MergeIdenticalMeshObjects);
+}
+
 
 //
 // ArchiveAssemblyFactory class implementation.
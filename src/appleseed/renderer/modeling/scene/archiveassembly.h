@@ -75,6 +75,12 @@ class APPLESEED_DLLSYMBOL ArchiveAssembly
         const Assembly*             parent,
         foundation::IAbortSwitch*   abort_switch = 0) APPLESEED_OVERRIDE;
 
+    // Read the archive project without modifying the contents of this assembly.
+    // The archive is swapped in later by expand_contents(). Distinct archive
+    // assemblies may be read concurrently. Does nothing if the archive was
+    // already read or expanded.
+    void read_archive(const Project& project);
+
   private:
     friend class ArchiveAssemblyFactory;
 
@@ -83,7 +89,8 @@ class APPLESEED_DLLSYMBOL ArchiveAssembly
         const char*                 name,
         const ParamArray&           params);
 
-    bool m_archive_opened;
+    bool                                    m_archive_opened;
+    foundation::auto_release_ptr<Assembly>  m_archive;
 };
 
 
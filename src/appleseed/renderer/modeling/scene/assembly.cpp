@@ -35,6 +35,7 @@
 #include "renderer/modeling/bssrdf/bssrdf.h"
 #include "renderer/modeling/color/colorentity.h"
 #include "renderer/modeling/edf/edf.h"
+#include "renderer/modeling/entity/parallelonframebegin.h"
 #include "renderer/modeling/light/light.h"
 #include "renderer/modeling/material/material.h"
 #include "renderer/modeling/object/object.h"
@@ -53,6 +54,10 @@
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/job/abortswitch.h"
 
+// Standard headers.
+#include <cassert>
+#include <vector>
+
 using namespace foundation;
 using namespace std;
 
@@ -105,6 +110,9 @@ Assembly::Assembly(
   : Entity(g_class_uid, params)
   , BaseGroup(this)
   , impl(new Impl(this))
+  , m_shading_records(0)
+  , m_shading_record_count(0)
+  , m_shading_materials(0)
 {
     set_name(name);
 
@@ -113,6 +121,8 @@ Assembly::Assembly(
 
 Assembly::~Assembly()
 {
+    delete [] m_shading_records;
+    delete [] m_shading_materials;
     delete impl;
 }
 
@@ -257,6 +267,25 @@ namespace
 
         return success;
     }
+
+    // Entities of a given collection do not depend on each other, only on entities
+    // of collections invoked before them, so they can be prepared concurrently.
+    template <typename EntityCollection>
+    bool invoke_on_frame_begin_in_parallel(
+        const Project&          project,
+        const BaseGroup*        parent,
+        EntityCollection&       entities,
+        OnFrameBeginRecorder&   recorder,
+        IAbortSwitch*           abort_switch)
+    {
+        vector<Entity*> entity_ptrs;
+        entity_ptrs.reserve(entities.size());
+
+        for (each<EntityCollection> i = entities; i; ++i)
+            entity_ptrs.push_back(&*i);
+
+        return parallel_on_frame_begin(project, parent, entity_ptrs, recorder, abort_switch);
+    }
 }
 
 bool Assembly::on_frame_begin(
@@ -270,22 +299,73 @@ bool Assembly::on_frame_begin(
 
     bool success = true;
     success = success && invoke_on_frame_begin(project, this, colors(), recorder, abort_switch);
-    success = success && invoke_on_frame_begin(project, this, textures(), recorder, abort_switch);
+    success = success && invoke_on_frame_begin_in_parallel(project, this, textures(), recorder, abort_switch);
     success = success && invoke_on_frame_begin(project, this, texture_instances(), recorder, abort_switch);
     success = success && invoke_on_frame_begin(project, this, shader_groups(), recorder, abort_switch);
-    success = success && invoke_on_frame_begin(project, this, bsdfs(), recorder, abort_switch);
+    success = success && invoke_on_frame_begin_in_parallel(project, this, bsdfs(), recorder, abort_switch);
     success = success && invoke_on_frame_begin(project, this, bssrdfs(), recorder, abort_switch);
-    success = success && invoke_on_frame_begin(project, this, edfs(), recorder, abort_switch);
+    success = success && invoke_on_frame_begin_in_parallel(project, this, edfs(), recorder, abort_switch);
     success = success && invoke_on_frame_begin(project, this, surface_shaders(), recorder, abort_switch);
-    success = success && invoke_on_frame_begin(project, this, materials(), recorder, abort_switch);
-    success = success && invoke_on_frame_begin(project, this, lights(), recorder, abort_switch);
-    success = success && invoke_on_frame_begin(project, this, objects(), recorder, abort_switch);
+    success = success && invoke_on_frame_begin_in_parallel(project, this, materials(), recorder, abort_switch);
+    success = success && invoke_on_frame_begin_in_parallel(project, this, lights(), recorder, abort_switch);
+    success = success && invoke_on_frame_begin_in_parallel(project, this, objects(), recorder, abort_switch);
     success = success && invoke_on_frame_begin(project, this, object_instances(), recorder, abort_switch);
     success = success && invoke_on_frame_begin(project, this, assemblies(), recorder, abort_switch);
     success = success && invoke_on_frame_begin(project, this, assembly_instances(), recorder, abort_switch);
+
+    if (success)
+        build_shading_records();
+
     return success;
 }
 
+void Assembly::build_shading_records()
+{
+    delete [] m_shading_records;
+    delete [] m_shading_materials;
+
+    const ObjectInstanceContainer& instances = object_instances();
+
+    // Count the materials referenced by all object instances.
+    size_t material_count = 0;
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        const ObjectInstance* object_instance = instances.get_by_index(i);
+        material_count += object_instance->get_front_materials().size();
+        material_count += object_instance->get_back_materials().size();
+    }
+
+    m_shading_record_count = instances.size();
+    m_shading_records = new ObjectInstanceShadingRecord[m_shading_record_count];
+    m_shading_materials = new const Material*[material_count];
+
+    // Store the materials of all object instances contiguously, front materials first.
+    const Material** materials = m_shading_materials;
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        const ObjectInstance* object_instance = instances.get_by_index(i);
+        const MaterialArray& front_materials = object_instance->get_front_materials();
+        const MaterialArray& back_materials = object_instance->get_back_materials();
+
+        ObjectInstanceShadingRecord& record = m_shading_records[i];
+        record.m_object_instance = object_instance;
+        record.m_object = &object_instance->get_object();
+        record.m_shade_alpha_cutouts = record.m_object->shade_alpha_cutouts();
+
+        record.m_front_materials = materials;
+        record.m_front_material_count = static_cast<uint32>(front_materials.size());
+        for (size_t j = 0; j < front_materials.size(); ++j)
+            *materials++ = front_materials[j];
+
+        record.m_back_materials = materials;
+        record.m_back_material_count = static_cast<uint32>(back_materials.size());
+        for (size_t j = 0; j < back_materials.size(); ++j)
+            *materials++ = back_materials[j];
+    }
+
+    assert(materials == m_shading_materials + material_count);
+}
+
 
 //
 // AssemblyFactory class implementation.
@@ -36,6 +36,7 @@
 #include "renderer/modeling/scene/basegroup.h"
 #include "renderer/modeling/scene/containers.h"
 #include "renderer/modeling/scene/iassemblyfactory.h"
+#include "renderer/modeling/scene/objectinstance.h"
 
 // appleseed.foundation headers.
 #include "foundation/platform/compiler.h"
@@ -45,10 +46,14 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class StringArray; }
 namespace foundation    { class StringDictionary; }
+namespace renderer      { class Material; }
 namespace renderer      { class OnFrameBeginRecorder; }
 namespace renderer      { class ParamArray; }
 namespace renderer      { class Project; }
@@ -99,6 +104,11 @@ class APPLESEED_DLLSYMBOL Assembly
     // Access the object instances.
     ObjectInstanceContainer& object_instances() const;
 
+    // Return the shading records of the object instances, in the order of object_instances().
+    // Shading records are available after on_frame_begin() was called.
+    const ObjectInstanceShadingRecord* get_shading_records() const;
+    size_t get_shading_record_count() const;
+
     // Return true if this assembly is tagged as flushable.
     bool is_flushable() const;
 
@@ -138,7 +148,12 @@ class APPLESEED_DLLSYMBOL Assembly
     Impl* impl;
 
     // Derogate to the private implementation rule, for performance reasons.
-    bool m_flushable;
+    bool                            m_flushable;
+    ObjectInstanceShadingRecord*    m_shading_records;
+    size_t                          m_shading_record_count;
+    const Material**                m_shading_materials;
+
+    void build_shading_records();
 };
 
 
@@ -175,6 +190,16 @@ inline bool Assembly::is_flushable() const
     return m_flushable;
 }
 
+inline const ObjectInstanceShadingRecord* Assembly::get_shading_records() const
+{
+    return m_shading_records;
+}
+
+inline size_t Assembly::get_shading_record_count() const
+{
+    return m_shading_record_count;
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_MODELING_SCENE_ASSEMBLY_H
@@ -37,10 +37,15 @@
 #include "renderer/modeling/scene/textureinstance.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
 #include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/startupprofiler.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/timers.h"
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/stopwatch.h"
 
 using namespace foundation;
 
@@ -98,8 +103,9 @@ ShaderGroupContainer& BaseGroup::shader_groups() const
 }
 
 bool BaseGroup::create_optimized_osl_shader_groups(
-    OSL::ShadingSystem& shading_system,
-    IAbortSwitch*       abort_switch)
+    OSL::ShadingSystem&     shading_system,
+    IAbortSwitch*           abort_switch,
+    const ShaderGroupSet*   used_shader_groups)
 {
     bool success = true;
 
@@ -110,7 +116,8 @@ bool BaseGroup::create_optimized_osl_shader_groups(
 
         success = success && i->create_optimized_osl_shader_groups(
             shading_system,
-            abort_switch);
+            abort_switch,
+            used_shader_groups);
     }
 
     for (each<ShaderGroupContainer> i = shader_groups(); i; ++i)
@@ -118,9 +125,23 @@ bool BaseGroup::create_optimized_osl_shader_groups(
         if (is_aborted(abort_switch))
             return true;
 
+        if (used_shader_groups && used_shader_groups->count(&*i) == 0)
+            continue;
+
+        EventTraceScope trace_scope("shading", "osl shader group", i->get_name());
+
+        Stopwatch<DefaultWallclockTimer> stopwatch(0);
+        stopwatch.start();
+
         success = success && i->create_optimized_osl_shader_group(
             shading_system,
             abort_switch);
+
+        stopwatch.measure();
+        global_startup_profiler().record_entity(
+            "osl shader groups",
+            i->get_path().c_str(),
+            stopwatch.get_seconds());
     }
 
     return success;
@@ -42,11 +42,15 @@ BEGIN_OSL_INCLUDES
 #include "OSL/oslexec.h"
 END_OSL_INCLUDES
 
+// Standard headers.
+#include <set>
+
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class StringArray; }
 namespace foundation    { class StringDictionary; }
 namespace renderer      { class Entity; }
+namespace renderer      { class ShaderGroup; }
 
 namespace renderer
 {
@@ -76,10 +80,15 @@ class APPLESEED_DLLSYMBOL BaseGroup
     // Access the OSL shader groups.
     ShaderGroupContainer& shader_groups() const;
 
-    // Create OSL shader groups and optimize them.
+    typedef std::set<const ShaderGroup*> ShaderGroupSet;
+
+    // Create OSL shader groups and optimize them. If 'used_shader_groups' is
+    // not null, only the shader groups it contains are created; the shaders of
+    // the other groups are then not loaded at all.
     bool create_optimized_osl_shader_groups(
         OSL::ShadingSystem&         shading_system,
-        foundation::IAbortSwitch*   abort_switch = 0);
+        foundation::IAbortSwitch*   abort_switch = 0,
+        const ShaderGroupSet*       used_shader_groups = 0);
 
     // Release internal OSL shader groups.
     void release_optimized_osl_shader_groups();
@@ -44,9 +44,13 @@
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/makevector.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
+#include <limits>
 #include <string>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -80,6 +84,10 @@ bool uses_alpha_mapping(const MaterialArray& materials)
             if (materials[i]->has_alpha_map())
                 return true;
 
+            // Shadow rays go through the boundaries of fluid volumes.
+            if (materials[i]->has_volume())
+                return true;
+
             if (const ShaderGroup* sg = materials[i]->get_uncached_osl_surface())
                 return sg->has_transparency();
         }
@@ -110,6 +118,8 @@ struct ObjectInstance::Impl
     string                  m_object_name;
     StringDictionary        m_front_material_mappings;
     StringDictionary        m_back_material_mappings;
+    vector<string>          m_included_lights;      // sorted; empty means all lights
+    vector<string>          m_excluded_lights;      // sorted
 };
 
 ObjectInstance::ObjectInstance(
@@ -155,6 +165,18 @@ ObjectInstance::ObjectInstance(
     // Retrieve ray bias distance.
     m_ray_bias_distance = params.get_optional<double>("ray_bias_distance", 0.0);
 
+    // Retrieve the range of projected sizes in which this level of detail is rendered.
+    m_lod_min_size = params.get_optional<float>("lod_min_size", 0.0f);
+    const float lod_max_size = params.get_optional<float>("lod_max_size", 0.0f);
+    m_lod_max_size = lod_max_size > 0.0f ? lod_max_size : numeric_limits<float>::max();
+
+    // Retrieve light links.
+    tokenize(params.get_optional<string>("included_lights", ""), " ", impl->m_included_lights);
+    tokenize(params.get_optional<string>("excluded_lights", ""), " ", impl->m_excluded_lights);
+    sort(impl->m_included_lights.begin(), impl->m_included_lights.end());
+    sort(impl->m_excluded_lights.begin(), impl->m_excluded_lights.end());
+    m_has_light_links = !impl->m_included_lights.empty() || !impl->m_excluded_lights.empty();
+
     // No bound object yet.
     m_object = 0;
 }
@@ -182,11 +204,32 @@ const char* ObjectInstance::get_object_name() const
     return impl->m_object_name.c_str();
 }
 
+void ObjectInstance::set_object_name(const char* object_name)
+{
+    assert(object_name);
+
+    impl->m_object_name = object_name;
+    m_object = 0;
+
+    bump_version_id();
+}
+
 const Transformd& ObjectInstance::get_transform() const
 {
     return impl->m_transform;
 }
 
+bool ObjectInstance::is_illuminated_by(const char* light_name) const
+{
+    const string name(light_name);
+
+    if (!impl->m_included_lights.empty() &&
+        !binary_search(impl->m_included_lights.begin(), impl->m_included_lights.end(), name))
+        return false;
+
+    return !binary_search(impl->m_excluded_lights.begin(), impl->m_excluded_lights.end(), name);
+}
+
 Object* ObjectInstance::find_object() const
 {
     const Entity* parent = get_parent();
@@ -488,6 +531,42 @@ DictionaryArray ObjectInstanceFactory::get_input_metadata()
             .insert("use", "optional")
             .insert("default", "0.0"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "lod_min_size")
+            .insert("label", "LOD Min Size")
+            .insert("type", "text")
+            .insert("use", "optional")
+            .insert("default", "0.0")
+            .insert("help", "Smallest projected size (diameter over distance to the camera) of the assembly at which this instance is rendered"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "lod_max_size")
+            .insert("label", "LOD Max Size")
+            .insert("type", "text")
+            .insert("use", "optional")
+            .insert("default", "0.0")
+            .insert("help", "Projected size of the assembly from which a finer level of detail replaces this instance; unbounded if 0"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "included_lights")
+            .insert("label", "Included Lights")
+            .insert("type", "text")
+            .insert("use", "optional")
+            .insert("default", "")
+            .insert("help", "Space-separated names of the lights and light-emitting object instances that illuminate this instance; all lights if empty"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "excluded_lights")
+            .insert("label", "Excluded Lights")
+            .insert("type", "text")
+            .insert("use", "optional")
+            .insert("default", "")
+            .insert("help", "Space-separated names of the lights and light-emitting object instances that do not illuminate this instance"));
+
     return metadata;
 }
 
@@ -49,6 +49,7 @@
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <limits>
 
 // Forward declarations.
 namespace foundation    { class DictionaryArray; }
@@ -97,6 +98,9 @@ class APPLESEED_DLLSYMBOL ObjectInstance
     // Return the name of the instantiated object.
     const char* get_object_name() const;
 
+    // Set the name of the instantiated object. The instance must be bound again afterward.
+    void set_object_name(const char* object_name);
+
     // Return the transform of this instance.
     const foundation::Transformd& get_transform() const;
 
@@ -121,6 +125,20 @@ class APPLESEED_DLLSYMBOL ObjectInstance
     RayBiasMethod get_ray_bias_method() const;
     double get_ray_bias_distance() const;
 
+    // Return true if this instance is a level of detail of an asset, i.e. if it is only
+    // rendered within a range of projected sizes of its assembly. The projected size of an
+    // assembly instance is the ratio of its diameter to its distance from the camera.
+    bool has_lod_range() const;
+
+    // Return true if this instance is rendered at a given projected size of its assembly.
+    bool is_lod_selected(const float projected_size) const;
+
+    // Return true if this instance is only illuminated by a subset of the lights of the scene.
+    bool has_light_links() const;
+
+    // Return true if a given light, or a given light-emitting object instance, illuminates this instance.
+    bool is_illuminated_by(const char* light_name) const;
+
     // Find the object bound to this instance.
     Object* find_object() const;
 
@@ -195,7 +213,10 @@ class APPLESEED_DLLSYMBOL ObjectInstance
     foundation::uint8   m_medium_priority;
     RayBiasMethod       m_ray_bias_method;
     double              m_ray_bias_distance;
+    float               m_lod_min_size;
+    float               m_lod_max_size;
     bool                m_transform_swaps_handedness;
+    bool                m_has_light_links;
 
     Object*             m_object;
     MaterialArray       m_front_materials;
@@ -215,6 +236,23 @@ class APPLESEED_DLLSYMBOL ObjectInstance
 };
 
 
+//
+// Shading-time data of an object instance, packed by its assembly at frame begin
+// for fast lookup by object instance index (see Assembly::get_shading_records()).
+//
+
+struct ObjectInstanceShadingRecord
+{
+    const ObjectInstance*   m_object_instance;
+    Object*                 m_object;
+    const Material* const*  m_front_materials;
+    const Material* const*  m_back_materials;
+    foundation::uint32      m_front_material_count;
+    foundation::uint32      m_back_material_count;
+    bool                    m_shade_alpha_cutouts;  // Object::shade_alpha_cutouts() of the object
+};
+
+
 //
 // Object instance factory.
 //
@@ -265,6 +303,21 @@ inline double ObjectInstance::get_ray_bias_distance() const
     return m_ray_bias_distance;
 }
 
+inline bool ObjectInstance::has_lod_range() const
+{
+    return m_lod_min_size > 0.0f || m_lod_max_size < std::numeric_limits<float>::max();
+}
+
+inline bool ObjectInstance::is_lod_selected(const float projected_size) const
+{
+    return projected_size >= m_lod_min_size && projected_size < m_lod_max_size;
+}
+
+inline bool ObjectInstance::has_light_links() const
+{
+    return m_has_light_links;
+}
+
 inline Object& ObjectInstance::get_object() const
 {
     assert(m_object);
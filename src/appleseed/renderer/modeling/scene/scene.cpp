@@ -31,12 +31,17 @@
 #include "scene.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/color/colorentity.h"
+#include "renderer/modeling/entity/onframebeginrecorder.h"
+#include "renderer/modeling/entity/parallelonframebegin.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
 #include "renderer/modeling/environmentshader/environmentshader.h"
 #include "renderer/modeling/frame/frame.h"
 #include "renderer/modeling/object/object.h"
 #include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/archiveassembly.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/objectinstance.h"
@@ -51,12 +56,16 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/vector.h"
+#include "foundation/platform/system.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/foreach.h"
-#include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/job.h"
 
 // Standard headers.
+#include <cassert>
+#include <cstddef>
 #include <set>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -288,6 +297,74 @@ void Scene::on_render_end(const Project& project)
 
 namespace
 {
+    class ReadArchiveJob
+      : public IJob
+    {
+      public:
+        ReadArchiveJob(
+            ArchiveAssembly&    archive,
+            const Project&      project,
+            IAbortSwitch*       abort_switch)
+          : m_archive(archive)
+          , m_project(project)
+          , m_abort_switch(abort_switch)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            if (!is_aborted(m_abort_switch))
+                m_archive.read_archive(m_project);
+        }
+
+      private:
+        ArchiveAssembly&        m_archive;
+        const Project&          m_project;
+        IAbortSwitch*           m_abort_switch;
+    };
+
+    void collect_archive_assemblies(
+        AssemblyContainer&          assemblies,
+        vector<ArchiveAssembly*>&   archives)
+    {
+        for (each<AssemblyContainer> i = assemblies; i; ++i)
+        {
+            ArchiveAssembly* archive = dynamic_cast<ArchiveAssembly*>(&*i);
+
+            if (archive)
+                archives.push_back(archive);
+
+            collect_archive_assemblies(i->assemblies(), archives);
+        }
+    }
+
+    // Read all the archives found in a hierarchy of assemblies concurrently,
+    // ahead of their expansion. Archives brought in by other archives are
+    // discovered and read when their parent archive gets expanded.
+    void read_archives(
+        AssemblyContainer&      assemblies,
+        const Project&          project,
+        IAbortSwitch*           abort_switch)
+    {
+        vector<ArchiveAssembly*> archives;
+        collect_archive_assemblies(assemblies, archives);
+
+        if (archives.size() < 2)
+            return;
+
+        JobQueue job_queue;
+        for (size_t i = 0, e = archives.size(); i < e; ++i)
+            job_queue.schedule(new ReadArchiveJob(*archives[i], project, abort_switch));
+
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            System::get_available_cpu_core_count());
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+    }
+
     bool invoke_procedural_expand(
         Assembly&               assembly,
         const Project&          project,
@@ -301,6 +378,9 @@ namespace
         {
             if (!proc_assembly->expand_contents(project, parent, abort_switch))
                 return false;
+
+            // Child archives may have just been brought in by this assembly.
+            read_archives(assembly.assemblies(), project, abort_switch);
         }
 
         for (each<AssemblyContainer> i = assembly.assemblies(); i; ++i)
@@ -317,6 +397,8 @@ bool Scene::expand_procedural_assemblies(
     const Project&          project,
     IAbortSwitch*           abort_switch)
 {
+    read_archives(assemblies(), project, abort_switch);
+
     for (each<AssemblyContainer> i = assemblies(); i; ++i)
     {
         if (!invoke_procedural_expand(*i, project, 0, abort_switch))
@@ -348,6 +430,25 @@ namespace
 
         return success;
     }
+
+    // Entities of a given collection do not depend on each other, only on entities
+    // of collections invoked before them, so they can be prepared concurrently.
+    template <typename EntityCollection>
+    bool invoke_on_frame_begin_in_parallel(
+        const Project&          project,
+        const BaseGroup*        parent,
+        EntityCollection&       entities,
+        OnFrameBeginRecorder&   recorder,
+        IAbortSwitch*           abort_switch)
+    {
+        vector<Entity*> entity_ptrs;
+        entity_ptrs.reserve(entities.size());
+
+        for (each<EntityCollection> i = entities; i; ++i)
+            entity_ptrs.push_back(&*i);
+
+        return parallel_on_frame_begin(project, parent, entity_ptrs, recorder, abort_switch);
+    }
 }
 
 bool Scene::on_frame_begin(
@@ -371,12 +472,12 @@ bool Scene::on_frame_begin(
     bool success = true;
 
     success = success && invoke_on_frame_begin(project, this, colors(), recorder, abort_switch);
-    success = success && invoke_on_frame_begin(project, this, textures(), recorder, abort_switch);
+    success = success && invoke_on_frame_begin_in_parallel(project, this, textures(), recorder, abort_switch);
     success = success && invoke_on_frame_begin(project, this, texture_instances(), recorder, abort_switch);
     success = success && invoke_on_frame_begin(project, this, shader_groups(), recorder, abort_switch);
 
     success = success && invoke_on_frame_begin(project, this, cameras(), recorder, abort_switch);
-    success = success && invoke_on_frame_begin(project, this, environment_edfs(), recorder, abort_switch);
+    success = success && invoke_on_frame_begin_in_parallel(project, this, environment_edfs(), recorder, abort_switch);
     success = success && invoke_on_frame_begin(project, this, environment_shaders(), recorder, abort_switch);
 
     if (!is_aborted(abort_switch) && impl->m_environment.get())
@@ -396,6 +497,24 @@ void Scene::on_frame_end(
     Entity::on_frame_end(project, parent);
 }
 
+bool Scene::on_camera_change(
+    const Project&          project,
+    IAbortSwitch*           abort_switch)
+{
+    assert(m_camera);
+    assert(m_camera == project.get_uncached_active_camera());
+
+    // The camera was recorded when the scene was prepared and will be ended with the rest
+    // of the scene: end it now and prepare it again without recording it a second time.
+    m_camera->on_frame_end(project, this);
+
+    OnFrameBeginRecorder camera_recorder;
+    const bool success = m_camera->on_frame_begin(project, this, camera_recorder, abort_switch);
+    camera_recorder.discard();
+
+    return success;
+}
+
 void Scene::create_render_data()
 {
     assert(!m_has_render_data);
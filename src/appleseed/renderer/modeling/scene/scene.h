@@ -135,6 +135,13 @@ class APPLESEED_DLLSYMBOL Scene
         const Project&              project,
         const BaseGroup*            parent) APPLESEED_OVERRIDE;
 
+    // Prepare the active camera again after it was moved, leaving the rest of the scene
+    // as it is. Must be called between on_frame_begin() and on_frame_end().
+    // Returns true on success, false otherwise.
+    bool on_camera_change(
+        const Project&              project,
+        foundation::IAbortSwitch*   abort_switch = 0);
+
     struct RenderData
     {
         GAABB3      m_bbox;
@@ -47,6 +47,7 @@
 #include "foundation/utility/makevector.h"
 
 // Standard headers.
+#include <cassert>
 #include <cstddef>
 #include <string>
 
@@ -200,7 +201,7 @@ namespace
         return false;
     }
 
-    TextureAlphaMode detect_alpha_mode(Texture& texture)
+    TextureAlphaMode detect_texture_alpha_mode(Texture& texture)
     {
         const CanvasProperties& props = texture.properties();
 
@@ -227,22 +228,25 @@ namespace
 void TextureInstance::bind_texture(const TextureContainer& textures)
 {
     if (m_texture == 0)
-    {
         m_texture = textures.get_by_name(impl->m_texture_name.c_str());
+}
 
-        // We need to resolve the alpha mode as soon as a texture is bound to this instance.
-        // We cannot do it in on_frame_begin() because the texture instance might be needed
-        // before it gets called. For instance, updating the trace context implies updating
-        // the intersection filters, and those need to be able to sample texture instances.
-        if (m_effective_alpha_mode == TextureAlphaModeDetect)
-        {
-            m_effective_alpha_mode = detect_alpha_mode(*m_texture);
+void TextureInstance::detect_alpha_mode() const
+{
+    assert(m_texture);
 
-            RENDERER_LOG_DEBUG(
-                "texture instance \"%s\" was detected to use the \"%s\" alpha mode.",
-                get_path().c_str(),
-                m_effective_alpha_mode == TextureAlphaModeAlphaChannel ? "alpha_channel" : "luminance");
-        }
+    // The alpha mode must be resolved before the texture instance is sampled.
+    // We cannot do it in on_frame_begin() because the texture instance might be needed
+    // before it gets called. For instance, updating the trace context implies updating
+    // the intersection filters, and those need to be able to sample texture instances.
+    if (m_effective_alpha_mode == TextureAlphaModeDetect)
+    {
+        m_effective_alpha_mode = detect_texture_alpha_mode(*m_texture);
+
+        RENDERER_LOG_DEBUG(
+            "texture instance \"%s\" was detected to use the \"%s\" alpha mode.",
+            get_path().c_str(),
+            m_effective_alpha_mode == TextureAlphaModeAlphaChannel ? "alpha_channel" : "luminance");
     }
 }
 
@@ -127,6 +127,11 @@ class APPLESEED_DLLSYMBOL TextureInstance
     // Return the texture bound to this instance.
     Texture& get_texture() const;
 
+    // Detect the alpha mode of the bound texture if the alpha mode is "detect".
+    // This reads the whole texture, hence it is only done once the instance is
+    // known to be referenced by an entity. A texture must be bound to this instance.
+    void detect_alpha_mode() const;
+
     // Return the effective (detected) alpha mode.
     // A texture must be bound to this instance.
     TextureAlphaMode get_effective_alpha_mode() const;
@@ -140,7 +145,7 @@ class APPLESEED_DLLSYMBOL TextureInstance
     TextureAddressingMode   m_addressing_mode;
     TextureFilteringMode    m_filtering_mode;
     TextureAlphaMode        m_alpha_mode;
-    TextureAlphaMode        m_effective_alpha_mode;
+    mutable TextureAlphaMode m_effective_alpha_mode;
     Texture*                m_texture;
 
     // Constructor.
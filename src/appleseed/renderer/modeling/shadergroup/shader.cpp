@@ -71,154 +71,147 @@ struct Shader::Impl
     {
         for (const_each<StringDictionary> i = params.strings(); i; ++i)
         {
-            try
-            {
-                ShaderParamParser parser(i.it().value());
-
-                switch (parser.param_type())
-                {
-                  case OSLParamTypeColor:
-                    {
-                        float r, g, b;
-                        parser.parse_three_values<float>(r, g, b, true);
-                        m_params.insert(ShaderParam::create_color_param(i.it().key(), r, g, b));
-                    }
-                    break;
-
-                case OSLParamTypeColorArray:
-                  {
-                      vector<float> values;
-                      parser.parse_float3_array(values);
-                      m_params.insert(ShaderParam::create_color_array_param(i.it().key(), values));
-                  }
-                  break;
-
-                  case OSLParamTypeFloat:
-                    {
-                        const float val = parser.parse_one_value<float>();
-                        m_params.insert(ShaderParam::create_float_param(i.it().key(), val));
-                    }
-                    break;
-
-                case OSLParamTypeFloatArray:
-                  {
-                      vector<float> values;
-                      parser.parse_float_array(values);
-                      m_params.insert(ShaderParam::create_float_array_param(i.it().key(), values));
-                  }
-                  break;
-
-                  case OSLParamTypeInt:
-                    {
-                        const int val = parser.parse_one_value<int>();
-                        m_params.insert(ShaderParam::create_int_param(i.it().key(), val));
-                    }
-                    break;
-
-                case OSLParamTypeIntArray:
-                  {
-                      vector<int> values;
-                      parser.parse_int_array(values);
-                      m_params.insert(ShaderParam::create_int_array_param(i.it().key(), values));
-                  }
-                  break;
-
-                  case OSLParamTypeMatrix:
-                    {
-                        float val[16];
-                        parser.parse_n_values(16, val);
-                        m_params.insert(ShaderParam::create_matrix_param(i.it().key(), val));
-                    }
-                    break;
-
-                  case OSLParamTypeMatrixArray:
-                    {
-                        vector<float> values;
-                        parser.parse_matrix_array(values);
-                        m_params.insert(ShaderParam::create_matrix_array_param(i.it().key(), values));
-                    }
-                    break;
-
-                  case OSLParamTypeNormal:
-                    {
-                        float x, y, z;
-                        parser.parse_three_values<float>(x, y, z);
-                        m_params.insert(ShaderParam::create_normal_param(i.it().key(), x, y, z));
-                    }
-                    break;
-
-                case OSLParamTypeNormalArray:
-                  {
-                      vector<float> values;
-                      parser.parse_float3_array(values);
-                      m_params.insert(ShaderParam::create_normal_array_param(i.it().key(), values));
-                  }
-                  break;
-
-                  case OSLParamTypePoint:
-                    {
-                        float x, y, z;
-                        parser.parse_three_values<float>(x, y, z);
-                        m_params.insert(ShaderParam::create_point_param(i.it().key(), x, y, z));
-                    }
-                    break;
-
-                case OSLParamTypePointArray:
-                  {
-                      vector<float> values;
-                      parser.parse_float3_array(values);
-                      m_params.insert(ShaderParam::create_point_array_param(i.it().key(), values));
-                  }
-                  break;
-
-                  case OSLParamTypeString:
-                    {
-                        m_params.insert(
-                            ShaderParam::create_string_param(
-                                i.it().key(),
-                                parser.parse_string_value().c_str()));
-                    }
-                    break;
-
-                  case OSLParamTypeVector:
-                    {
-                        float x, y, z;
-                        parser.parse_three_values<float>(x, y, z);
-                        m_params.insert(ShaderParam::create_vector_param(i.it().key(), x, y, z));
-                    }
-                    break;
-
-                case OSLParamTypeVectorArray:
-                  {
-                      vector<float> values;
-                      parser.parse_float3_array(values);
-                      m_params.insert(ShaderParam::create_vector_array_param(i.it().key(), values));
-                  }
-                  break;
-
-                  default:
-                    RENDERER_LOG_ERROR(
-                        "error adding OSL param %s, of unknown type %s; will use the default value.",
-                        i.it().key(),
-                        i.it().value());
-                    break;
-                }
-            }
-            catch (const ExceptionOSLParamParseError&)
-            {
-                RENDERER_LOG_ERROR(
-                    "error parsing OSL param value, param = %s, value = %s; will use the default value.",
-                    i.it().key(),
-                    i.it().value());
-            }
+            auto_release_ptr<ShaderParam> param = parse_param(i.it().key(), i.it().value());
+            if (param.get())
+                m_params.insert(param);
         }
     }
 
     string                  m_type;
     string                  m_shader;
     ShaderParamContainer    m_params;
+
+    static auto_release_ptr<ShaderParam> parse_param(const char* name, const char* value);
 };
 
+auto_release_ptr<ShaderParam> Shader::Impl::parse_param(const char* name, const char* value)
+{
+    try
+    {
+        ShaderParamParser parser(value);
+
+        switch (parser.param_type())
+        {
+          case OSLParamTypeColor:
+            {
+                float r, g, b;
+                parser.parse_three_values<float>(r, g, b, true);
+                return ShaderParam::create_color_param(name, r, g, b);
+            }
+
+          case OSLParamTypeColorArray:
+            {
+                vector<float> values;
+                parser.parse_float3_array(values);
+                return ShaderParam::create_color_array_param(name, values);
+            }
+
+          case OSLParamTypeFloat:
+            {
+                const float val = parser.parse_one_value<float>();
+                return ShaderParam::create_float_param(name, val);
+            }
+
+          case OSLParamTypeFloatArray:
+            {
+                vector<float> values;
+                parser.parse_float_array(values);
+                return ShaderParam::create_float_array_param(name, values);
+            }
+
+          case OSLParamTypeInt:
+            {
+                const int val = parser.parse_one_value<int>();
+                return ShaderParam::create_int_param(name, val);
+            }
+
+          case OSLParamTypeIntArray:
+            {
+                vector<int> values;
+                parser.parse_int_array(values);
+                return ShaderParam::create_int_array_param(name, values);
+            }
+
+          case OSLParamTypeMatrix:
+            {
+                float val[16];
+                parser.parse_n_values(16, val);
+                return ShaderParam::create_matrix_param(name, val);
+            }
+
+          case OSLParamTypeMatrixArray:
+            {
+                vector<float> values;
+                parser.parse_matrix_array(values);
+                return ShaderParam::create_matrix_array_param(name, values);
+            }
+
+          case OSLParamTypeNormal:
+            {
+                float x, y, z;
+                parser.parse_three_values<float>(x, y, z);
+                return ShaderParam::create_normal_param(name, x, y, z);
+            }
+
+          case OSLParamTypeNormalArray:
+            {
+                vector<float> values;
+                parser.parse_float3_array(values);
+                return ShaderParam::create_normal_array_param(name, values);
+            }
+
+          case OSLParamTypePoint:
+            {
+                float x, y, z;
+                parser.parse_three_values<float>(x, y, z);
+                return ShaderParam::create_point_param(name, x, y, z);
+            }
+
+          case OSLParamTypePointArray:
+            {
+                vector<float> values;
+                parser.parse_float3_array(values);
+                return ShaderParam::create_point_array_param(name, values);
+            }
+
+          case OSLParamTypeString:
+            {
+                return ShaderParam::create_string_param(name, parser.parse_string_value().c_str());
+            }
+
+          case OSLParamTypeVector:
+            {
+                float x, y, z;
+                parser.parse_three_values<float>(x, y, z);
+                return ShaderParam::create_vector_param(name, x, y, z);
+            }
+
+          case OSLParamTypeVectorArray:
+            {
+                vector<float> values;
+                parser.parse_float3_array(values);
+                return ShaderParam::create_vector_array_param(name, values);
+            }
+
+          default:
+            RENDERER_LOG_ERROR(
+                "error adding OSL param %s, of unknown type %s; will use the default value.",
+                name,
+                value);
+            break;
+        }
+    }
+    catch (const ExceptionOSLParamParseError&)
+    {
+        RENDERER_LOG_ERROR(
+            "error parsing OSL param value, param = %s, value = %s; will use the default value.",
+            name,
+            value);
+    }
+
+    return auto_release_ptr<ShaderParam>();
+}
+
 Shader::Shader(
     const char*          type,
     const char*          shader,
@@ -261,6 +254,26 @@ const ShaderParamContainer& Shader::shader_params() const
     return impl->m_params;
 }
 
+ShaderParam* Shader::set_param(const char* name, const char* value, bool& type_changed)
+{
+    auto_release_ptr<ShaderParam> new_param = Impl::parse_param(name, value);
+    if (new_param.get() == 0)
+        return 0;
+
+    ShaderParam* param = impl->m_params.get_by_name(name);
+
+    if (param == 0)
+    {
+        param = new_param.get();
+        impl->m_params.insert(new_param);
+        type_changed = true;
+        return param;
+    }
+
+    type_changed = !param->set_value(*new_param);
+    return param;
+}
+
 bool Shader::add(OSL::ShadingSystem& shading_system)
 {
     for (each<ShaderParamContainer> i = impl->m_params; i; ++i)
@@ -92,6 +92,10 @@ class APPLESEED_DLLSYMBOL Shader
     // Destructor.
     ~Shader();
 
+    // Replace the value of a parameter, or add the parameter if the shader doesn't have it.
+    // Return 0 if the value could not be parsed.
+    ShaderParam* set_param(const char* name, const char* value, bool& type_changed);
+
     bool add(OSL::ShadingSystem& shading_system);
 };
 
@@ -34,6 +34,7 @@
 #include "renderer/modeling/project/project.h"
 #include "renderer/modeling/shadergroup/shader.h"
 #include "renderer/modeling/shadergroup/shaderconnection.h"
+#include "renderer/modeling/shadergroup/shaderparam.h"
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
@@ -46,8 +47,11 @@
 #include "boost/unordered/unordered_map.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <exception>
+#include <string>
 #include <utility>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -82,8 +86,30 @@ struct ShaderGroup::Impl
     mutable SurfaceAreaMap      m_surface_areas;
     const OSL::ShaderSymbol*    m_surface_shader_color_sym;
     const OSL::ShaderSymbol*    m_surface_shader_alpha_sym;
+
+    // Interactive parameters edited since the shader group was optimized, as (layer, param).
+    typedef pair<string, string> ParamKey;
+    vector<ParamKey>            m_edited_params;
+
+    bool update_edited_params(OSL::ShadingSystem& shading_system);
 };
 
+bool ShaderGroup::Impl::update_edited_params(OSL::ShadingSystem& shading_system)
+{
+    for (size_t i = 0, e = m_edited_params.size(); i < e; ++i)
+    {
+        const char* layer = m_edited_params[i].first.c_str();
+        const Shader* shader = m_shaders.get_by_name(layer);
+        ShaderParam* param = shader->shader_params().get_by_name(m_edited_params[i].second.c_str());
+
+        if (!param->reparameter(shading_system, *m_shader_group_ref, layer))
+            return false;
+    }
+
+    m_edited_params.clear();
+    return true;
+}
+
 ShaderGroup::ShaderGroup(const char* name)
   : ConnectableEntity(g_class_uid, ParamArray())
   , impl(new Impl())
@@ -112,6 +138,7 @@ void ShaderGroup::clear()
     impl->m_shaders.clear();
     impl->m_connections.clear();
     impl->m_shader_group_ref.reset();
+    impl->m_edited_params.clear();
     m_flags = 0;
     impl->m_surface_shader_color_sym = 0;
     impl->m_surface_shader_alpha_sym = 0;
@@ -158,12 +185,67 @@ void ShaderGroup::add_connection(
             dst_param);
 }
 
+bool ShaderGroup::set_shader_param(
+    const char*         layer,
+    const char*         param,
+    const char*         value)
+{
+    Shader* shader = impl->m_shaders.get_by_name(layer);
+
+    if (shader == 0)
+    {
+        RENDERER_LOG_ERROR(
+            "cannot set parameter %s of shader group \"%s\": no layer named %s.",
+            param,
+            get_path().c_str(),
+            layer);
+        return false;
+    }
+
+    bool type_changed;
+    ShaderParam* shader_param = shader->set_param(param, value, type_changed);
+
+    if (shader_param == 0)
+        return false;
+
+    if (is_valid())
+    {
+        if (shader_param->is_interactive() && !type_changed)
+        {
+            // Only update the value of the parameter in the optimized shader group.
+            const Impl::ParamKey key(layer, param);
+            if (find(impl->m_edited_params.begin(), impl->m_edited_params.end(), key) == impl->m_edited_params.end())
+                impl->m_edited_params.push_back(key);
+        }
+        else
+        {
+            // Optimize the shader group again, leaving the parameter unoptimized
+            // so that it can be edited again without recompiling the shader group.
+            shader_param->set_interactive(true);
+            release_optimized_osl_shader_group();
+        }
+    }
+
+    bump_version_id();
+
+    return true;
+}
+
 bool ShaderGroup::create_optimized_osl_shader_group(
     OSL::ShadingSystem& shading_system,
     IAbortSwitch*       abort_switch)
 {
     if (is_valid())
-        return true;
+    {
+        if (impl->m_edited_params.empty() || impl->update_edited_params(shading_system))
+            return true;
+
+        RENDERER_LOG_DEBUG(
+            "could not update the parameters of shader group \"%s\", optimizing it again...",
+            get_path().c_str());
+
+        release_optimized_osl_shader_group();
+    }
 
     RENDERER_LOG_DEBUG("setting up shader group \"%s\"...", get_path().c_str());
 
@@ -279,6 +361,7 @@ bool ShaderGroup::create_optimized_osl_shader_group(
 void ShaderGroup::release_optimized_osl_shader_group()
 {
     impl->m_shader_group_ref.reset();
+    impl->m_edited_params.clear();
 }
 
 const ShaderContainer& ShaderGroup::shaders() const
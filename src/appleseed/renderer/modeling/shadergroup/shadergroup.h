@@ -87,7 +87,18 @@ class APPLESEED_DLLSYMBOL ShaderGroup
         const char*                 dst_layer,
         const char*                 dst_param);
 
-    // Create OSL shader group.
+    // Set the value of a parameter of a shader, using the syntax of add_shader() params.
+    // Only this shader group is optimized again, the next time it is created. Parameters
+    // edited after the shader group was optimized become interactive: OSL no longer folds
+    // them into the shader group, and further edits only update their value without
+    // recompiling the shader group. Return false if the layer doesn't exist or the value
+    // is invalid.
+    bool set_shader_param(
+        const char*                 layer,
+        const char*                 param,
+        const char*                 value);
+
+    // Create OSL shader group, or update the interactive parameters of an existing one.
     bool create_optimized_osl_shader_group(
         OSL::ShadingSystem&         shading_system,
         foundation::IAbortSwitch*   abort_switch = 0);
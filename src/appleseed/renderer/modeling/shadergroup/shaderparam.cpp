@@ -64,6 +64,7 @@ struct ShaderParam::Impl
     const char*     m_string_value;
     vector<float>   m_float_array_value;
     vector<int>     m_int_array_value;
+    bool            m_interactive;
 };
 
 ShaderParam::ShaderParam(const char* name)
@@ -71,6 +72,7 @@ ShaderParam::ShaderParam(const char* name)
   , impl(new Impl)
 {
     set_name(name);
+    impl->m_interactive = false;
 }
 
 ShaderParam::~ShaderParam()
@@ -98,6 +100,32 @@ const void* ShaderParam::get_value() const
     return &impl->m_float_value;
 }
 
+bool ShaderParam::set_value(const ShaderParam& source)
+{
+    const bool same_type = impl->m_type_desc == source.impl->m_type_desc;
+
+    impl->m_type_desc = source.impl->m_type_desc;
+    impl->m_int_value = source.impl->m_int_value;
+    for (size_t i = 0; i < 16; ++i)
+        impl->m_float_value[i] = source.impl->m_float_value[i];
+    impl->m_string_storage = source.impl->m_string_storage;
+    impl->m_string_value = impl->m_string_storage.c_str();
+    impl->m_float_array_value = source.impl->m_float_array_value;
+    impl->m_int_array_value = source.impl->m_int_array_value;
+
+    return same_type;
+}
+
+bool ShaderParam::is_interactive() const
+{
+    return impl->m_interactive;
+}
+
+void ShaderParam::set_interactive(const bool interactive)
+{
+    impl->m_interactive = interactive;
+}
+
 string ShaderParam::get_value_as_string() const
 {
     stringstream ss;
@@ -349,7 +377,9 @@ auto_release_ptr<ShaderParam> ShaderParam::create_string_param(
 
 bool ShaderParam::add(OSL::ShadingSystem& shading_system)
 {
-    if (!shading_system.Parameter(get_name(), impl->m_type_desc, get_value()))
+    // OSL folds params whose lockgeom flag is set into the optimized shader group.
+    // Interactive params clear it so that they can be changed with ReParameter().
+    if (!shading_system.Parameter(get_name(), impl->m_type_desc, get_value(), !impl->m_interactive))
     {
         RENDERER_LOG_ERROR("error adding parameter %s.", get_path().c_str());
         return false;
@@ -358,4 +388,18 @@ bool ShaderParam::add(OSL::ShadingSystem& shading_system)
     return true;
 }
 
+bool ShaderParam::reparameter(
+    OSL::ShadingSystem& shading_system,
+    OSL::ShaderGroup&   shader_group,
+    const char*         layer)
+{
+    assert(impl->m_interactive);
+
+#if OSL_LIBRARY_VERSION_CODE >= 10700
+    return shading_system.ReParameter(shader_group, layer, get_name(), impl->m_type_desc, get_value());
+#else
+    return false;
+#endif
+}
+
 }   // namespace renderer
@@ -94,8 +94,12 @@ class APPLESEED_DLLSYMBOL ShaderParam
     // todo: STL classes cannot be used in DLL-exported classes.
     std::string get_value_as_string() const;
 
+    // Return true if this param can be changed without recompiling its shader group.
+    bool is_interactive() const;
+
   private:
     friend class Shader;
+    friend class ShaderGroup;
 
     struct Impl;
     Impl* impl;
@@ -192,8 +196,21 @@ class APPLESEED_DLLSYMBOL ShaderParam
     // Return a const void pointer to this param value.
     const void* get_value() const;
 
+    // Replace the type and the value of this param by those of another param.
+    // Return true if the type of this param did not change.
+    bool set_value(const ShaderParam& source);
+
+    // Interactive params are not folded into the optimized shader group by OSL.
+    void set_interactive(const bool interactive);
+
     // Add this param to OSL's shading system.
     bool add(OSL::ShadingSystem& shading_system);
+
+    // Update the value of this param in an optimized shader group. The param must be interactive.
+    bool reparameter(
+        OSL::ShadingSystem& shading_system,
+        OSL::ShaderGroup&   shader_group,
+        const char*         layer);
 };
 
 }       // namespace renderer
@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/shading/ambientocclusion.h"
+#include "renderer/kernel/shading/ambientocclusioncache.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingresult.h"
@@ -45,8 +46,15 @@
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
 
+// Standard headers.
+#include <memory>
+
 // Forward declarations.
-namespace renderer  { class PixelContext; }
+namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class BaseGroup; }
+namespace renderer      { class OnFrameBeginRecorder; }
+namespace renderer      { class PixelContext; }
+namespace renderer      { class Project; }
 
 using namespace foundation;
 using namespace std;
@@ -87,6 +95,15 @@ namespace
                     sampling_method.c_str());
                 m_sampling_method = UniformSampling;
             }
+
+            if (m_params.get_optional<bool>("vertex_cache", false))
+            {
+                m_cache.reset(
+                    new AmbientOcclusionCache(
+                        m_max_distance,
+                        m_samples,
+                        m_sampling_method == CosineWeightedSampling));
+            }
         }
 
         virtual void release() APPLESEED_OVERRIDE
@@ -99,6 +116,22 @@ namespace
             return Model;
         }
 
+        virtual bool on_frame_begin(
+            const Project&          project,
+            const BaseGroup*        parent,
+            OnFrameBeginRecorder&   recorder,
+            IAbortSwitch*           abort_switch) APPLESEED_OVERRIDE
+        {
+            if (!SurfaceShader::on_frame_begin(project, parent, recorder, abort_switch))
+                return false;
+
+            // Precompute occlusion at mesh vertices unless the scene geometry is unchanged.
+            if (m_cache.get() && !m_cache->update(project, abort_switch))
+                return false;
+
+            return true;
+        }
+
         virtual void evaluate(
             SamplingContext&        sampling_context,
             const PixelContext&     pixel_context,
@@ -108,27 +141,31 @@ namespace
         {
             double occlusion;
 
-            if (m_sampling_method == UniformSampling)
+            // Use the precomputed occlusion if the shading point is covered by the cache.
+            if (!m_cache.get() || !m_cache->lookup(shading_point, occlusion))
             {
-                occlusion =
-                    compute_ambient_occlusion(
-                        sampling_context,
-                        sample_hemisphere_uniform<double>,
-                        shading_context.get_intersector(),
-                        shading_point,
-                        m_max_distance,
-                        m_samples);
-            }
-            else
-            {
-                occlusion =
-                    compute_ambient_occlusion(
-                        sampling_context,
-                        sample_hemisphere_cosine<double>,
-                        shading_context.get_intersector(),
-                        shading_point,
-                        m_max_distance,
-                        m_samples);
+                if (m_sampling_method == UniformSampling)
+                {
+                    occlusion =
+                        compute_ambient_occlusion(
+                            sampling_context,
+                            sample_hemisphere_uniform<double>,
+                            shading_context.get_intersector(),
+                            shading_point,
+                            m_max_distance,
+                            m_samples);
+                }
+                else
+                {
+                    occlusion =
+                        compute_ambient_occlusion(
+                            sampling_context,
+                            sample_hemisphere_cosine<double>,
+                            shading_context.get_intersector(),
+                            shading_point,
+                            m_max_distance,
+                            m_samples);
+                }
             }
 
             const float accessibility = static_cast<float>(1.0 - occlusion);
@@ -143,9 +180,10 @@ namespace
             CosineWeightedSampling
         };
 
-        const size_t    m_samples;
-        const double    m_max_distance;
-        SamplingMethod  m_sampling_method;
+        const size_t                        m_samples;
+        const double                        m_max_distance;
+        SamplingMethod                      m_sampling_method;
+        auto_ptr<AmbientOcclusionCache>     m_cache;
     };
 }
 
@@ -199,6 +237,15 @@ DictionaryArray AOSurfaceShaderFactory::get_input_metadata() const
             .insert("use", "required")
             .insert("default", "1.0"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "vertex_cache")
+            .insert("label", "Cache Occlusion at Vertices")
+            .insert("type", "boolean")
+            .insert("use", "optional")
+            .insert("default", "false")
+            .insert("help", "Precompute occlusion at mesh vertices and reuse it until the scene geometry changes"));
+
     return metadata;
 }
 
@@ -158,6 +158,8 @@ namespace
             m_inputs.evaluate(
                 shading_context.get_texture_cache(),
                 shading_point.get_uv(0),
+                shading_point.get_duvdx(0),
+                shading_point.get_duvdy(0),
                 &values);
 
             Spectrum radiance(Spectrum::Illuminance);
@@ -40,19 +40,29 @@
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/image/genericprogressiveimagefilereader.h"
+#include "foundation/image/texturefilereader.h"
 #include "foundation/image/tile.h"
 #include "foundation/platform/thread.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/searchpaths.h"
+#include "foundation/utility/siphash.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+#include "boost/system/error_code.hpp"
 
 // Standard headers.
 #include <cstddef>
+#include <memory>
 #include <string>
 
 using namespace foundation;
 using namespace std;
+namespace bf = boost::filesystem;
 
 namespace renderer
 {
@@ -65,6 +75,9 @@ namespace
 
     const char* Model = "disk_texture_2d";
 
+    // Extension of appleseed texture files (see foundation::TextureFileWriter).
+    const char* TextureFileExtension = ".atx";
+
     class DiskTexture2d
       : public Texture
     {
@@ -74,13 +87,22 @@ namespace
             const ParamArray&   params,
             const SearchPaths&  search_paths)
           : Texture(name, params)
-          , m_reader(&global_logger())
+          , m_texture_file_reader(0)
+          , m_props_read(false)
         {
             const EntityDefMessageContext message_context("texture", this);
 
             // Establish and store the qualified path to the texture file.
             m_filepath = search_paths.qualify(m_params.get_required<string>("filename", ""));
 
+            // appleseed texture files are memory-mapped, other formats are read through OpenImageIO.
+            if (lower_case(bf::path(m_filepath).extension().string()) == TextureFileExtension)
+            {
+                m_texture_file_reader = new TextureFileReader();
+                m_reader.reset(m_texture_file_reader);
+            }
+            else m_reader.reset(new GenericProgressiveImageFileReader(&global_logger()));
+
             // Retrieve the color space.
             const string color_space =
                 m_params.get_required<string>(
@@ -109,8 +131,9 @@ namespace
             const Project&      project,
             const BaseGroup*    parent) APPLESEED_OVERRIDE
         {
-            if (m_reader.is_open())
-                m_reader.close();
+            // Tiles of texture files point into the file mapping and may outlive the frame.
+            if (m_texture_file_reader == 0 && m_reader->is_open())
+                m_reader->close();
         }
 
         virtual ColorSpace get_color_space() const APPLESEED_OVERRIDE
@@ -132,7 +155,18 @@ namespace
         virtual const CanvasProperties& properties() APPLESEED_OVERRIDE
         {
             boost::mutex::scoped_lock lock(m_mutex);
-            open_image_file();
+
+            if (!m_props_read)
+            {
+                const bool was_open = m_reader->is_open();
+                open_image_file();
+
+                // Only keep the file open once its tiles are needed, to limit the
+                // number of open files when many textures are never sampled.
+                if (!was_open && m_texture_file_reader == 0)
+                    m_reader->close();
+            }
+
             return m_props;
         }
 
@@ -142,7 +176,32 @@ namespace
         {
             boost::mutex::scoped_lock lock(m_mutex);
             open_image_file();
-            return m_reader.read_tile(tile_x, tile_y);
+
+            if (m_texture_file_reader)
+            {
+                lock.unlock();
+                return load_texture_file_tile(0, tile_x, tile_y);
+            }
+
+            return m_reader->read_tile(tile_x, tile_y);
+        }
+
+        virtual Tile* load_mip_tile(
+            const size_t        level,
+            const size_t        tile_x,
+            const size_t        tile_y) APPLESEED_OVERRIDE
+        {
+            if (m_texture_file_reader == 0)
+                return 0;
+
+            boost::mutex::scoped_lock lock(m_mutex);
+            open_image_file();
+            lock.unlock();
+
+            if (level >= m_texture_file_reader->get_level_count())
+                return 0;
+
+            return load_texture_file_tile(level, tile_x, tile_y);
         }
 
         virtual void unload_tile(
@@ -153,25 +212,78 @@ namespace
             delete tile;
         }
 
+        virtual bool compute_shared_cache_key(uint64& key) const APPLESEED_OVERRIDE
+        {
+            // Identify the texels by the contents of the file, approximated by its
+            // absolute path, size and modification time, and by the color space.
+            boost::system::error_code ec;
+            const bf::path filepath = bf::absolute(m_filepath);
+            const uint64 file_size = static_cast<uint64>(bf::file_size(filepath, ec));
+            if (ec)
+                return false;
+            const uint64 file_time = static_cast<uint64>(bf::last_write_time(filepath, ec));
+            if (ec)
+                return false;
+
+            const string path = filepath.string();
+            key = siphash24(path.c_str(), path.size());
+            key = siphash24(key, file_size);
+            key = siphash24(key, file_time);
+            key = siphash24(key, static_cast<uint64>(m_color_space));
+
+            return true;
+        }
+
       private:
         string                              m_filepath;
         ColorSpace                          m_color_space;
 
-        mutable boost::mutex                m_mutex;
-        GenericProgressiveImageFileReader   m_reader;
-        CanvasProperties                    m_props;
+        mutable boost::mutex                    m_mutex;
+        auto_ptr<IProgressiveImageFileReader>   m_reader;
+        TextureFileReader*                      m_texture_file_reader;     // m_reader if reading a texture file
+        CanvasProperties                        m_props;
+        bool                                    m_props_read;
 
         void open_image_file()
         {
-            if (!m_reader.is_open())
+            if (!m_reader->is_open())
             {
-                RENDERER_LOG_INFO(
-                    "opening texture file %s and reading metadata...",
-                    m_filepath.c_str());
+                if (m_props_read)
+                {
+                    RENDERER_LOG_DEBUG("opening texture file %s...", m_filepath.c_str());
+                    m_reader->open(m_filepath.c_str());
+                }
+                else
+                {
+                    RENDERER_LOG_INFO(
+                        "opening texture file %s and reading metadata...",
+                        m_filepath.c_str());
+
+                    m_reader->open(m_filepath.c_str());
+                    m_reader->read_canvas_properties(m_props);
+                    m_props_read = true;
+                }
+            }
+        }
+
+        Tile* load_texture_file_tile(
+            const size_t        level,
+            const size_t        tile_x,
+            const size_t        tile_y)
+        {
+            // Reading tiles from a texture file is thread-safe.
+            Tile* tile = m_texture_file_reader->read_tile(level, tile_x, tile_y);
 
-                m_reader.open(m_filepath.c_str());
-                m_reader.read_canvas_properties(m_props);
+            // Uncompressed tiles live in the read-only file mapping but the texture
+            // store converts tiles to linear RGB in place, so copy them if necessary.
+            if (m_color_space != ColorSpaceLinearRGB && !m_texture_file_reader->is_compressed())
+            {
+                Tile* copy = new Tile(*tile);
+                delete tile;
+                tile = copy;
             }
+
+            return tile;
         }
     };
 }
@@ -221,6 +333,18 @@ DictionaryArray DiskTexture2dFactory::get_input_metadata() const
             .insert("use", "required")
             .insert("default", "srgb"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "tile_storage")
+            .insert("label", "Tile Storage")
+            .insert("type", "enumeration")
+            .insert("items",
+                Dictionary()
+                    .insert("Native", "native")
+                    .insert("Half Float", "half"))
+            .insert("use", "optional")
+            .insert("default", "native"));
+
     return metadata;
 }
 
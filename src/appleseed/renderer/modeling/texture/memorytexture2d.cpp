@@ -219,6 +219,18 @@ DictionaryArray MemoryTexture2dFactory::get_input_metadata() const
             .insert("use", "required")
             .insert("default", "srgb"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "tile_storage")
+            .insert("label", "Tile Storage")
+            .insert("type", "enumeration")
+            .insert("items",
+                Dictionary()
+                    .insert("Native", "native")
+                    .insert("Half Float", "half"))
+            .insert("use", "optional")
+            .insert("default", "native"));
+
     return metadata;
 }
 
@@ -30,7 +30,18 @@
 // Interface header.
 #include "texture.h"
 
+// appleseed.renderer headers.
+#include "renderer/utility/messagecontext.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/makevector.h"
+
+// Standard headers.
+#include <string>
+
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -55,6 +66,30 @@ Texture::Texture(
   : Entity(g_class_uid, params)
 {
     set_name(name);
+
+    const EntityDefMessageContext message_context("texture", this);
+
+    // Retrieve the storage of the tiles in the texture store.
+    const string tile_storage =
+        m_params.get_optional<string>(
+            "tile_storage",
+            "native",
+            make_vector("native", "half"),
+            message_context);
+    m_half_tile_storage = tile_storage == "half";
+}
+
+Tile* Texture::load_mip_tile(
+    const size_t        level,
+    const size_t        tile_x,
+    const size_t        tile_y)
+{
+    return 0;
+}
+
+bool Texture::compute_shared_cache_key(uint64& key) const
+{
+    return false;
 }
 
 }   // namespace renderer
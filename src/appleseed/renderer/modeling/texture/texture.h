@@ -35,6 +35,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/image/colorspace.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/uid.h"
 
 // appleseed.main headers.
@@ -73,6 +74,10 @@ class APPLESEED_DLLSYMBOL Texture
     // Return the color space of the texture.
     virtual foundation::ColorSpace get_color_space() const = 0;
 
+    // Return true if the texture store should keep the floating-point tiles
+    // of this texture as half floats (parameter "tile_storage").
+    bool use_half_tile_storage() const;
+
     // Access canvas properties.
     virtual const foundation::CanvasProperties& properties() = 0;
 
@@ -86,8 +91,34 @@ class APPLESEED_DLLSYMBOL Texture
         const size_t                tile_x,
         const size_t                tile_y,
         const foundation::Tile*     tile) = 0;
+
+    // Load a given tile of a given MIP level (level > 0) if the texture provides
+    // MIP levels, otherwise return 0. The caller takes ownership of the tile.
+    // The default implementation returns 0.
+    virtual foundation::Tile* load_mip_tile(
+        const size_t                level,
+        const size_t                tile_x,
+        const size_t                tile_y);
+
+    // Compute a key identifying the texels of this texture across processes, allowing
+    // the texture store to share its tiles with other renders through a node-local cache.
+    // Return false if the tiles cannot be shared. The default implementation returns false.
+    virtual bool compute_shared_cache_key(foundation::uint64& key) const;
+
+  private:
+    bool m_half_tile_storage;
 };
 
+
+//
+// Texture class implementation.
+//
+
+inline bool Texture::use_half_tile_storage() const
+{
+    return m_half_tile_storage;
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_MODELING_TEXTURE_TEXTURE_H
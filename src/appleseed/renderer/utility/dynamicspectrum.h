@@ -54,6 +54,11 @@ namespace renderer
 //
 // A spectrum that can switch between RGB and fully spectral as needed.
 //
+// When appleseed is built with APPLESEED_USE_RGB_SPECTRUM defined, spectra are always RGB:
+// only the RGB components are stored, spectral values are converted to linear RGB (under
+// the CIE D65 illuminant) as soon as they are assigned, and all RGB/spectral branches
+// resolve at compile time.
+//
 
 template <typename T, size_t N>
 class DynamicSpectrum
@@ -64,7 +69,11 @@ class DynamicSpectrum
     static const size_t Samples = N;
 
     // Number of stored samples such that the size of the sample array is a multiple of 16 bytes.
+#ifdef APPLESEED_USE_RGB_SPECTRUM
+    static const size_t StoredSamples = ((3 * sizeof(T) + 15) & ~15) / sizeof(T);
+#else
     static const size_t StoredSamples = (((N * sizeof(T)) + 15) & ~15) / sizeof(T);
+#endif
 
     enum Intent
     {
@@ -145,6 +154,10 @@ class DynamicSpectrum
     APPLESEED_SIMD4_ALIGN ValueType m_samples[StoredSamples];
     foundation::uint16              m_size;
     foundation::uint16              m_intent;
+
+#ifdef APPLESEED_USE_RGB_SPECTRUM
+    void set_from_spectral_values(const ValueType* values);
+#endif
 };
 
 // Combine intents of multiple spectra.
@@ -294,6 +307,23 @@ inline DynamicSpectrum<T, N>::DynamicSpectrum(const Intent intent)
         m_samples[i] = T(0.0);
 }
 
+#ifdef APPLESEED_USE_RGB_SPECTRUM
+
+template <typename T, size_t N>
+inline DynamicSpectrum<T, N>::DynamicSpectrum(const ValueType* rhs, const Intent intent)
+  : m_size(3)
+  , m_intent(static_cast<foundation::uint16>(intent))
+{
+    assert(rhs);
+
+    set_from_spectral_values(rhs);
+
+    for (size_t i = 3; i < StoredSamples; ++i)
+        m_samples[i] = T(0.0);
+}
+
+#else
+
 template <typename T, size_t N>
 inline DynamicSpectrum<T, N>::DynamicSpectrum(const ValueType* rhs, const Intent intent)
   : m_size(N)
@@ -308,6 +338,8 @@ inline DynamicSpectrum<T, N>::DynamicSpectrum(const ValueType* rhs, const Intent
         m_samples[i] = T(0.0);
 }
 
+#endif
+
 template <typename T, size_t N>
 inline DynamicSpectrum<T, N>::DynamicSpectrum(const ValueType val, const Intent intent)
   : m_size(3)
@@ -332,6 +364,21 @@ inline DynamicSpectrum<T, N>::DynamicSpectrum(const foundation::Color<ValueType,
         m_samples[i] = T(0.0);
 }
 
+#ifdef APPLESEED_USE_RGB_SPECTRUM
+
+template <typename T, size_t N>
+inline DynamicSpectrum<T, N>::DynamicSpectrum(const foundation::RegularSpectrum<ValueType, N>& rhs, const Intent intent)
+  : m_size(3)
+  , m_intent(static_cast<foundation::uint16>(intent))
+{
+    set_from_spectral_values(&rhs[0]);
+
+    for (size_t i = 3; i < StoredSamples; ++i)
+        m_samples[i] = T(0.0);
+}
+
+#else
+
 template <typename T, size_t N>
 inline DynamicSpectrum<T, N>::DynamicSpectrum(const foundation::RegularSpectrum<ValueType, N>& rhs, const Intent intent)
   : m_size(N)
@@ -344,6 +391,8 @@ inline DynamicSpectrum<T, N>::DynamicSpectrum(const foundation::RegularSpectrum<
         m_samples[i] = T(0.0);
 }
 
+#endif
+
 template <typename T, size_t N>
 template <typename U>
 inline DynamicSpectrum<T, N>::DynamicSpectrum(const DynamicSpectrum<U, N>& rhs)
@@ -371,6 +420,64 @@ inline DynamicSpectrum<T, N>& DynamicSpectrum<T, N>::operator=(const foundation:
     return *this;
 }
 
+#ifdef APPLESEED_USE_RGB_SPECTRUM
+
+template <typename T, size_t N>
+inline DynamicSpectrum<T, N>& DynamicSpectrum<T, N>::operator=(const foundation::RegularSpectrum<ValueType, N>& rhs)
+{
+    // The intent remains unchanged, on purpose.
+
+    set_from_spectral_values(&rhs[0]);
+
+    return *this;
+}
+
+template <typename T, size_t N>
+inline bool DynamicSpectrum<T, N>::is_rgb() const
+{
+    return true;
+}
+
+template <typename T, size_t N>
+inline bool DynamicSpectrum<T, N>::is_spectral() const
+{
+    return false;
+}
+
+template <typename T, size_t N>
+inline size_t DynamicSpectrum<T, N>::size() const
+{
+    return 3;
+}
+
+template <typename T, size_t N>
+inline void DynamicSpectrum<T, N>::resize(const size_t size)
+{
+    // Spectra always remain RGB.
+    assert(size == 3 || size == N);
+}
+
+template <typename T, size_t N>
+inline void DynamicSpectrum<T, N>::set_from_spectral_values(const ValueType* values)
+{
+    float spectrum[N];
+    for (size_t i = 0; i < N; ++i)
+        spectrum[i] = static_cast<float>(values[i]);
+
+    float ciexyz[3];
+    foundation::spectrum_to_ciexyz_standard(spectrum, ciexyz);
+
+    const foundation::Color3f linear_rgb =
+        foundation::ciexyz_to_linear_rgb(foundation::Color3f(ciexyz[0], ciexyz[1], ciexyz[2]));
+
+    m_size = 3;
+    m_samples[0] = static_cast<ValueType>(linear_rgb[0]);
+    m_samples[1] = static_cast<ValueType>(linear_rgb[1]);
+    m_samples[2] = static_cast<ValueType>(linear_rgb[2]);
+}
+
+#else
+
 template <typename T, size_t N>
 inline DynamicSpectrum<T, N>& DynamicSpectrum<T, N>::operator=(const foundation::RegularSpectrum<ValueType, N>& rhs)
 {
@@ -409,6 +516,8 @@ inline void DynamicSpectrum<T, N>::resize(const size_t size)
     m_size = static_cast<foundation::uint16>(size);
 }
 
+#endif
+
 template <typename T, size_t N>
 inline void DynamicSpectrum<T, N>::set_intent(const Intent intent)
 {
@@ -424,7 +533,7 @@ inline typename DynamicSpectrum<T, N>::Intent DynamicSpectrum<T, N>::get_intent(
 template <typename T, size_t N>
 inline void DynamicSpectrum<T, N>::set(const ValueType val)
 {
-    for (size_t i = 0; i < m_size; ++i)
+    for (size_t i = 0, e = size(); i < e; ++i)
         m_samples[i] = val;
 }
 
@@ -437,7 +546,7 @@ APPLESEED_FORCE_INLINE void DynamicSpectrum<float, 31>::set(const float val)
 
     _mm_store_ps(&m_samples[ 0], mval);
 
-    if (m_size > 3)
+    if (size() > 3)
     {
         _mm_store_ps(&m_samples[ 4], mval);
         _mm_store_ps(&m_samples[ 8], mval);
@@ -477,6 +586,36 @@ inline const foundation::Color<T, 3>& DynamicSpectrum<T, N>::rgb() const
     return reinterpret_cast<const foundation::Color<T, 3>&>(m_samples);
 }
 
+#ifdef APPLESEED_USE_RGB_SPECTRUM
+
+template <typename T, size_t N>
+inline foundation::Color<T, 3> DynamicSpectrum<T, N>::convert_to_rgb(
+    const foundation::LightingConditions& lighting_conditions) const
+{
+    return rgb();
+}
+
+template <typename T, size_t N>
+inline DynamicSpectrum<T, N>& DynamicSpectrum<T, N>::upgrade(
+    const DynamicSpectrum&                  source,
+    DynamicSpectrum&                        dest)
+{
+    dest = source;
+    return dest;
+}
+
+template <typename T, size_t N>
+inline DynamicSpectrum<T, N>& DynamicSpectrum<T, N>::downgrade(
+    const foundation::LightingConditions&   lighting_conditions,
+    const DynamicSpectrum&                  source,
+    DynamicSpectrum&                        dest)
+{
+    dest = source;
+    return dest;
+}
+
+#else
+
 template <typename T, size_t N>
 inline foundation::Color<T, 3> DynamicSpectrum<T, N>::convert_to_rgb(
     const foundation::LightingConditions& lighting_conditions) const
@@ -542,6 +681,8 @@ inline DynamicSpectrum<T, N>& DynamicSpectrum<T, N>::downgrade(
     return dest;
 }
 
+#endif
+
 template <typename T, size_t N>
 inline typename DynamicSpectrum<T, N>::Intent combine_intents(
     const DynamicSpectrum<T, N>&            a,
@@ -855,6 +996,51 @@ inline DynamicSpectrum<T, N>& operator-=(DynamicSpectrum<T, N>& lhs, const Dynam
     return lhs;
 }
 
+#ifdef APPLESEED_USE_SSE
+
+template <>
+APPLESEED_FORCE_INLINE DynamicSpectrum<float, 31>& operator-=(DynamicSpectrum<float, 31>& lhs, const DynamicSpectrum<float, 31>& rhs)
+{
+    assert(lhs.get_intent() == rhs.get_intent());
+
+    if (lhs.size() <= rhs.size())
+    {
+        if (lhs.size() < rhs.size())
+            DynamicSpectrum<float, 31>::upgrade(lhs, lhs);
+
+        _mm_store_ps(&lhs[ 0], _mm_sub_ps(_mm_load_ps(&lhs[ 0]), _mm_load_ps(&rhs[ 0])));
+
+        if (lhs.size() > 3)
+        {
+            _mm_store_ps(&lhs[ 4], _mm_sub_ps(_mm_load_ps(&lhs[ 4]), _mm_load_ps(&rhs[ 4])));
+            _mm_store_ps(&lhs[ 8], _mm_sub_ps(_mm_load_ps(&lhs[ 8]), _mm_load_ps(&rhs[ 8])));
+            _mm_store_ps(&lhs[12], _mm_sub_ps(_mm_load_ps(&lhs[12]), _mm_load_ps(&rhs[12])));
+            _mm_store_ps(&lhs[16], _mm_sub_ps(_mm_load_ps(&lhs[16]), _mm_load_ps(&rhs[16])));
+            _mm_store_ps(&lhs[20], _mm_sub_ps(_mm_load_ps(&lhs[20]), _mm_load_ps(&rhs[20])));
+            _mm_store_ps(&lhs[24], _mm_sub_ps(_mm_load_ps(&lhs[24]), _mm_load_ps(&rhs[24])));
+            _mm_store_ps(&lhs[28], _mm_sub_ps(_mm_load_ps(&lhs[28]), _mm_load_ps(&rhs[28])));
+        }
+    }
+    else
+    {
+        DynamicSpectrum<float, 31> up_rhs;
+        DynamicSpectrum<float, 31>::upgrade(rhs, up_rhs);
+
+        _mm_store_ps(&lhs[ 0], _mm_sub_ps(_mm_load_ps(&lhs[ 0]), _mm_load_ps(&up_rhs[ 0])));
+        _mm_store_ps(&lhs[ 4], _mm_sub_ps(_mm_load_ps(&lhs[ 4]), _mm_load_ps(&up_rhs[ 4])));
+        _mm_store_ps(&lhs[ 8], _mm_sub_ps(_mm_load_ps(&lhs[ 8]), _mm_load_ps(&up_rhs[ 8])));
+        _mm_store_ps(&lhs[12], _mm_sub_ps(_mm_load_ps(&lhs[12]), _mm_load_ps(&up_rhs[12])));
+        _mm_store_ps(&lhs[16], _mm_sub_ps(_mm_load_ps(&lhs[16]), _mm_load_ps(&up_rhs[16])));
+        _mm_store_ps(&lhs[20], _mm_sub_ps(_mm_load_ps(&lhs[20]), _mm_load_ps(&up_rhs[20])));
+        _mm_store_ps(&lhs[24], _mm_sub_ps(_mm_load_ps(&lhs[24]), _mm_load_ps(&up_rhs[24])));
+        _mm_store_ps(&lhs[28], _mm_sub_ps(_mm_load_ps(&lhs[28]), _mm_load_ps(&up_rhs[28])));
+    }
+
+    return lhs;
+}
+
+#endif  // APPLESEED_USE_SSE
+
 template <typename T, size_t N>
 inline DynamicSpectrum<T, N>& operator*=(DynamicSpectrum<T, N>& lhs, const T rhs)
 {
@@ -1265,6 +1451,39 @@ inline renderer::DynamicSpectrum<T, N> clamp(const renderer::DynamicSpectrum<T,
     return result;
 }
 
+#ifdef APPLESEED_USE_SSE
+
+// The bounds are passed as the first operand of the min/max instructions so that NaNs propagate
+// through them, matching the behavior of the scalar implementation.
+
+template <>
+APPLESEED_FORCE_INLINE renderer::DynamicSpectrum<float, 31> clamp(const renderer::DynamicSpectrum<float, 31>& s, const float min, const float max)
+{
+    renderer::DynamicSpectrum<float, 31> result(s.get_intent());
+    result.resize(s.size());
+
+    const __m128 mmin = _mm_set1_ps(min);
+    const __m128 mmax = _mm_set1_ps(max);
+
+    _mm_store_ps(&result[0], _mm_min_ps(mmax, _mm_max_ps(mmin, _mm_load_ps(&s[0]))));
+
+    if (s.size() > 3)
+    {
+        for (size_t i = 4; i < s.StoredSamples; i += 4)
+            _mm_store_ps(&result[i], _mm_min_ps(mmax, _mm_max_ps(mmin, _mm_load_ps(&s[i]))));
+    }
+
+    return result;
+}
+
+template <>
+APPLESEED_FORCE_INLINE renderer::DynamicSpectrum<float, 31> saturate(const renderer::DynamicSpectrum<float, 31>& s)
+{
+    return clamp(s, 0.0f, 1.0f);
+}
+
+#endif  // APPLESEED_USE_SSE
+
 template <typename T, size_t N>
 inline void clamp_in_place(renderer::DynamicSpectrum<T, N>& s, const T min, const T max)
 {
@@ -1278,6 +1497,25 @@ inline void clamp_in_place(renderer::DynamicSpectrum<T, N>& s, const T min, cons
     }
 }
 
+#ifdef APPLESEED_USE_SSE
+
+template <>
+APPLESEED_FORCE_INLINE void clamp_in_place(renderer::DynamicSpectrum<float, 31>& s, const float min, const float max)
+{
+    const __m128 mmin = _mm_set1_ps(min);
+    const __m128 mmax = _mm_set1_ps(max);
+
+    _mm_store_ps(&s[0], _mm_min_ps(mmax, _mm_max_ps(mmin, _mm_load_ps(&s[0]))));
+
+    if (s.size() > 3)
+    {
+        for (size_t i = 4; i < s.StoredSamples; i += 4)
+            _mm_store_ps(&s[i], _mm_min_ps(mmax, _mm_max_ps(mmin, _mm_load_ps(&s[i]))));
+    }
+}
+
+#endif  // APPLESEED_USE_SSE
+
 template <typename T, size_t N>
 inline renderer::DynamicSpectrum<T, N> clamp_low(const renderer::DynamicSpectrum<T, N>& s, const T min)
 {
@@ -1300,6 +1538,24 @@ inline void clamp_low_in_place(renderer::DynamicSpectrum<T, N>& s, const T min)
     }
 }
 
+#ifdef APPLESEED_USE_SSE
+
+template <>
+APPLESEED_FORCE_INLINE void clamp_low_in_place(renderer::DynamicSpectrum<float, 31>& s, const float min)
+{
+    const __m128 mmin = _mm_set1_ps(min);
+
+    _mm_store_ps(&s[0], _mm_max_ps(mmin, _mm_load_ps(&s[0])));
+
+    if (s.size() > 3)
+    {
+        for (size_t i = 4; i < s.StoredSamples; i += 4)
+            _mm_store_ps(&s[i], _mm_max_ps(mmin, _mm_load_ps(&s[i])));
+    }
+}
+
+#endif  // APPLESEED_USE_SSE
+
 template <typename T, size_t N>
 inline renderer::DynamicSpectrum<T, N> clamp_high(const renderer::DynamicSpectrum<T, N>& s, const T max)
 {
@@ -1322,6 +1578,24 @@ inline void clamp_high_in_place(renderer::DynamicSpectrum<T, N>& s, const T max)
     }
 }
 
+#ifdef APPLESEED_USE_SSE
+
+template <>
+APPLESEED_FORCE_INLINE void clamp_high_in_place(renderer::DynamicSpectrum<float, 31>& s, const float max)
+{
+    const __m128 mmax = _mm_set1_ps(max);
+
+    _mm_store_ps(&s[0], _mm_min_ps(mmax, _mm_load_ps(&s[0])));
+
+    if (s.size() > 3)
+    {
+        for (size_t i = 4; i < s.StoredSamples; i += 4)
+            _mm_store_ps(&s[i], _mm_min_ps(mmax, _mm_load_ps(&s[i])));
+    }
+}
+
+#endif  // APPLESEED_USE_SSE
+
 template <typename T, size_t N>
 inline renderer::DynamicSpectrum<T, N> lerp(
     const renderer::DynamicSpectrum<T, N>& a,
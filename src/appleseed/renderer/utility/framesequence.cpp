@@ -0,0 +1,300 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "framesequence.h"
+
+// appleseed.renderer headers.
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <cassert>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// FrameSequence class implementation.
+//
+
+struct FrameSequence::Impl
+{
+    struct Change
+    {
+        enum Type { Transform, Parameter };
+
+        Type                    m_type;
+        string                  m_name;
+        string                  m_value;
+        Transformd              m_transform;
+    };
+
+    struct SequenceFrame
+    {
+        size_t                  m_number;
+        vector<Change>          m_changes;
+    };
+
+    vector<SequenceFrame>       m_frames;
+    size_t                      m_next_frame_index;
+
+    Impl()
+      : m_next_frame_index(0)
+    {
+    }
+};
+
+FrameSequence::FrameSequence()
+  : impl(new Impl())
+{
+}
+
+FrameSequence::~FrameSequence()
+{
+    delete impl;
+}
+
+bool FrameSequence::read(
+    const char*     filepath,
+    Logger&         logger)
+{
+    ifstream file(filepath);
+    if (!file.is_open())
+    {
+        LOG_ERROR(logger, "failed to open sequence file %s.", filepath);
+        return false;
+    }
+
+    return read(file, filepath, logger);
+}
+
+bool FrameSequence::read(
+    istream&        input,
+    const char*     name,
+    Logger&         logger)
+{
+    typedef Impl::Change Change;
+    typedef Impl::SequenceFrame SequenceFrame;
+
+    vector<SequenceFrame>& frames = impl->m_frames;
+    frames.clear();
+    impl->m_next_frame_index = 0;
+
+    string line;
+    size_t line_number = 0;
+
+    while (getline(input, line))
+    {
+        ++line_number;
+
+        // Strip comments.
+        const string::size_type comment_pos = line.find('#');
+        if (comment_pos != string::npos)
+            line.erase(comment_pos);
+
+        vector<string> tokens;
+        tokenize(line, Blanks, tokens);
+
+        if (tokens.empty())
+            continue;
+
+        try
+        {
+            if (tokens[0] == "frame" && tokens.size() == 2)
+            {
+                SequenceFrame frame;
+                frame.m_number = from_string<size_t>(tokens[1]);
+
+                if (!frames.empty() && frame.m_number <= frames.back().m_number)
+                {
+                    LOG_ERROR(
+                        logger,
+                        "%s, line " FMT_SIZE_T ": frames must be listed in increasing order.",
+                        name,
+                        line_number);
+                    return false;
+                }
+
+                frames.push_back(frame);
+                continue;
+            }
+
+            if (frames.empty())
+            {
+                LOG_ERROR(
+                    logger,
+                    "%s, line " FMT_SIZE_T ": expected a frame directive.",
+                    name,
+                    line_number);
+                return false;
+            }
+
+            if (tokens[0] == "transform" && tokens.size() == 18)
+            {
+                Matrix4d matrix;
+                for (size_t i = 0; i < 16; ++i)
+                    matrix[i] = from_string<double>(tokens[i + 2]);
+
+                Change change;
+                change.m_type = Change::Transform;
+                change.m_name = tokens[1];
+                change.m_transform = Transformd::from_local_to_parent(matrix);
+                frames.back().m_changes.push_back(change);
+            }
+            else if (tokens[0] == "parameter" && tokens.size() == 3)
+            {
+                Change change;
+                change.m_type = Change::Parameter;
+                change.m_name = tokens[1];
+                change.m_value = tokens[2];
+                frames.back().m_changes.push_back(change);
+            }
+            else
+            {
+                LOG_ERROR(
+                    logger,
+                    "%s, line " FMT_SIZE_T ": invalid directive \"%s\".",
+                    name,
+                    line_number,
+                    tokens[0].c_str());
+                return false;
+            }
+        }
+        catch (const ExceptionStringConversionError&)
+        {
+            LOG_ERROR(
+                logger,
+                "%s, line " FMT_SIZE_T ": invalid number.",
+                name,
+                line_number);
+            return false;
+        }
+        catch (const ExceptionSingularMatrix&)
+        {
+            LOG_ERROR(
+                logger,
+                "%s, line " FMT_SIZE_T ": singular transform matrix.",
+                name,
+                line_number);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool FrameSequence::empty() const
+{
+    return impl->m_frames.empty();
+}
+
+size_t FrameSequence::get_first_frame() const
+{
+    assert(!impl->m_frames.empty());
+    return impl->m_frames.front().m_number;
+}
+
+size_t FrameSequence::get_last_frame() const
+{
+    assert(!impl->m_frames.empty());
+    return impl->m_frames.back().m_number;
+}
+
+bool FrameSequence::apply(
+    const size_t    frame,
+    Project&        project,
+    ParamArray&     params,
+    Logger&         logger)
+{
+    Scene* scene = project.get_scene();
+    assert(scene);
+
+    for (; impl->m_next_frame_index < impl->m_frames.size(); ++impl->m_next_frame_index)
+    {
+        const Impl::SequenceFrame& f = impl->m_frames[impl->m_next_frame_index];
+
+        if (f.m_number > frame)
+            break;
+
+        for (size_t i = 0, e = f.m_changes.size(); i < e; ++i)
+        {
+            const Impl::Change& change = f.m_changes[i];
+
+            if (change.m_type == Impl::Change::Parameter)
+            {
+                params.insert_path(change.m_name, change.m_value);
+            }
+            else if (Camera* camera = scene->cameras().get_by_name(change.m_name.c_str()))
+            {
+                camera->transform_sequence().clear();
+                camera->transform_sequence().set_transform(0.0f, change.m_transform);
+                camera->bump_version_id();
+            }
+            else if (AssemblyInstance* assembly_instance = scene->assembly_instances().get_by_name(change.m_name.c_str()))
+            {
+                assembly_instance->transform_sequence().clear();
+                assembly_instance->transform_sequence().set_transform(0.0f, change.m_transform);
+                assembly_instance->bump_version_id();
+            }
+            else
+            {
+                LOG_ERROR(
+                    logger,
+                    "frame " FMT_SIZE_T ": no camera or assembly instance named \"%s\".",
+                    f.m_number,
+                    change.m_name.c_str());
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+}   // namespace renderer
@@ -0,0 +1,112 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_UTILITY_FRAMESEQUENCE_H
+#define APPLESEED_RENDERER_UTILITY_FRAMESEQUENCE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+#include <iosfwd>
+
+// Forward declarations.
+namespace foundation    { class Logger; }
+namespace renderer      { class ParamArray; }
+namespace renderer      { class Project; }
+
+namespace renderer
+{
+
+//
+// A frame sequence is a list of frames, each with the changes to apply to the
+// scene and to the rendering parameters before the frame is rendered.
+//
+// Sequence files are text files with one directive per line:
+//
+//   frame <number>                             following directives apply from this frame on
+//   transform <name> <16 matrix coefficients>  set the transform of a camera or assembly instance
+//   parameter <path> <value>                   set a rendering parameter
+//
+// Everything following a '#' character is a comment. Changes persist until they
+// are overridden, so only what differs from the previous frame needs to be listed.
+//
+
+class APPLESEED_DLLSYMBOL FrameSequence
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    FrameSequence();
+
+    // Destructor.
+    ~FrameSequence();
+
+    // Read a sequence file. Return true on success, false otherwise.
+    bool read(
+        const char*             filepath,
+        foundation::Logger&     logger);
+
+    // Read a sequence from a stream. 'name' identifies the sequence in error messages.
+    // Return true on success, false otherwise.
+    bool read(
+        std::istream&           input,
+        const char*             name,
+        foundation::Logger&     logger);
+
+    // Return true if the sequence does not list any frame.
+    bool empty() const;
+
+    // Return the first and last frames listed in the sequence.
+    size_t get_first_frame() const;
+    size_t get_last_frame() const;
+
+    // Apply the changes of all listed frames up to a given frame and not applied yet.
+    // Frames must be applied in increasing order. Modified entities get a new version
+    // ID so that the data derived from them is updated before the frame is rendered.
+    // Return true on success, false otherwise.
+    bool apply(
+        const size_t            frame,
+        Project&                project,
+        ParamArray&             params,
+        foundation::Logger&     logger);
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_UTILITY_FRAMESEQUENCE_H
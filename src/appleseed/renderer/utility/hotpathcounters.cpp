@@ -0,0 +1,351 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "hotpathcounters.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/singleton.h"
+#include "foundation/platform/thread.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/statistics.h"
+
+// Boost headers.
+#include "boost/thread/tss.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// ModelCounts class implementation.
+//
+
+ModelCounts::ModelCounts()
+{
+    clear();
+}
+
+void ModelCounts::clear()
+{
+    m_model_count = 0;
+    m_other_count = 0;
+}
+
+void ModelCounts::merge(const ModelCounts& other)
+{
+    for (size_t i = 0; i < other.m_model_count; ++i)
+    {
+        size_t j = 0;
+
+        while (j < m_model_count && m_models[j] != other.m_models[i])
+            ++j;
+
+        if (j < m_model_count)
+            m_counts[j] += other.m_counts[i];
+        else if (m_model_count < MaxModelCount)
+        {
+            m_models[m_model_count] = other.m_models[i];
+            m_counts[m_model_count] = other.m_counts[i];
+            ++m_model_count;
+        }
+        else m_other_count += other.m_counts[i];
+    }
+
+    m_other_count += other.m_other_count;
+}
+
+
+//
+// HotPathCounters class implementation.
+//
+
+HotPathCounters::HotPathCounters()
+{
+    clear();
+}
+
+void HotPathCounters::clear()
+{
+    m_current_ray_type = RayTypeCount - 1;
+
+    fill(m_rays, m_rays + RayTypeCount, 0);
+    fill(m_ray_hits, m_ray_hits + RayTypeCount, 0);
+    fill(m_leaf_visits, m_leaf_visits + RayTypeCount, 0);
+    fill(m_primitive_tests, m_primitive_tests + RayTypeCount, 0);
+    fill(m_osl_executions, m_osl_executions + OSLExecutionCount, 0);
+
+    m_bsdf_evaluations.clear();
+    m_light_samples.clear();
+    m_shading_profile.clear();
+}
+
+void HotPathCounters::merge(const HotPathCounters& other)
+{
+    for (size_t i = 0; i < RayTypeCount; ++i)
+    {
+        m_rays[i] += other.m_rays[i];
+        m_ray_hits[i] += other.m_ray_hits[i];
+        m_leaf_visits[i] += other.m_leaf_visits[i];
+        m_primitive_tests[i] += other.m_primitive_tests[i];
+    }
+
+    for (size_t i = 0; i < OSLExecutionCount; ++i)
+        m_osl_executions[i] += other.m_osl_executions[i];
+
+    m_bsdf_evaluations.merge(other.m_bsdf_evaluations);
+    m_light_samples.merge(other.m_light_samples);
+    m_shading_profile.merge(other.m_shading_profile);
+}
+
+
+//
+// Registry of the counters of all threads.
+//
+
+APPLESEED_THREAD_LOCAL HotPathCounters* g_thread_hot_path_counters = 0;
+
+namespace
+{
+    class CounterRegistry
+      : public NonCopyable
+    {
+      public:
+        ~CounterRegistry()
+        {
+            for (const_each<vector<HotPathCounters*> > i = m_live; i; ++i)
+                delete *i;
+        }
+
+        HotPathCounters* add()
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            HotPathCounters* counters = new HotPathCounters();
+            m_live.push_back(counters);
+
+            return counters;
+        }
+
+        // Fold the counters of an exiting thread into the retired total.
+        void retire(HotPathCounters* counters)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            const vector<HotPathCounters*>::iterator i =
+                find(m_live.begin(), m_live.end(), counters);
+            assert(i != m_live.end());
+
+            m_retired.merge(*counters);
+            m_live.erase(i);
+
+            delete counters;
+        }
+
+        void clear()
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            m_retired.clear();
+
+            for (each<vector<HotPathCounters*> > i = m_live; i; ++i)
+                (*i)->clear();
+        }
+
+        void get_total(HotPathCounters& total) const
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            total = m_retired;
+
+            for (const_each<vector<HotPathCounters*> > i = m_live; i; ++i)
+                total.merge(**i);
+        }
+
+      private:
+        mutable boost::mutex        m_mutex;
+        vector<HotPathCounters*>    m_live;
+        HotPathCounters             m_retired;
+    };
+
+    class GlobalCounterRegistry
+      : public Singleton<CounterRegistry>
+    {
+      private:
+        friend class Singleton<CounterRegistry>;
+
+        GlobalCounterRegistry() {}
+    };
+
+    // Retires the counters of a thread when it exits.
+    struct ThreadCountersOwner
+    {
+        HotPathCounters*    m_counters;
+
+        ~ThreadCountersOwner()
+        {
+            g_thread_hot_path_counters = 0;
+            GlobalCounterRegistry::instance().retire(m_counters);
+        }
+    };
+
+    boost::thread_specific_ptr<ThreadCountersOwner> g_thread_counters_owner;
+
+    void insert_model_counts(
+        StatisticsVector&   stats,
+        const char*         name,
+        const ModelCounts&  counts)
+    {
+        Statistics model_stats;
+        uint64 total = counts.get_other_count();
+
+        for (size_t i = 0; i < counts.get_model_count(); ++i)
+        {
+            model_stats.insert<uint64>(counts.get_model(i), counts.get_count(i));
+            total += counts.get_count(i);
+        }
+
+        if (total == 0)
+            return;
+
+        if (counts.get_other_count() > 0)
+            model_stats.insert<uint64>("other", counts.get_other_count());
+
+        model_stats.insert<uint64>("total", total);
+
+        stats.insert(name, model_stats);
+    }
+}
+
+HotPathCounters& register_thread_hot_path_counters()
+{
+    assert(g_thread_hot_path_counters == 0);
+
+    ThreadCountersOwner* owner = new ThreadCountersOwner();
+    owner->m_counters = GlobalCounterRegistry::instance().add();
+    g_thread_counters_owner.reset(owner);
+
+    g_thread_hot_path_counters = owner->m_counters;
+
+    return *owner->m_counters;
+}
+
+void clear_hot_path_counters()
+{
+    GlobalCounterRegistry::instance().clear();
+}
+
+void get_hot_path_counters(HotPathCounters& total)
+{
+    GlobalCounterRegistry::instance().get_total(total);
+}
+
+StatisticsVector get_hot_path_statistics()
+{
+    assert(VisibilityFlags::Count == HotPathCounters::RayTypeCount - 1);
+
+    HotPathCounters total;
+    get_hot_path_counters(total);
+
+    StatisticsVector stats;
+
+    const size_t shadow_ray_type = HotPathCounters::ray_type_index(VisibilityFlags::ShadowRay);
+    Statistics ray_stats;
+    bool has_rays = false;
+
+    for (size_t i = 0; i < HotPathCounters::RayTypeCount; ++i)
+    {
+        if (total.m_rays[i] == 0)
+            continue;
+
+        has_rays = true;
+
+        const string type =
+            i < VisibilityFlags::Count ? VisibilityFlags::Names[i] : "other";
+
+        ray_stats.insert<uint64>(type + " rays", total.m_rays[i]);
+
+        // Hits of shadow rays are occluded light samples.
+        ray_stats.insert_percent(
+            type + (i == shadow_ray_type ? " rejection rate" : " hit rate"),
+            total.m_ray_hits[i],
+            total.m_rays[i]);
+
+        ray_stats.insert<uint64>(type + " leaf visits", total.m_leaf_visits[i]);
+        ray_stats.insert<uint64>(type + " primitive tests", total.m_primitive_tests[i]);
+    }
+
+    if (has_rays)
+        stats.insert("hot paths: ray tracing", ray_stats);
+
+    insert_model_counts(stats, "hot paths: bsdf evaluations", total.m_bsdf_evaluations);
+    insert_model_counts(stats, "hot paths: light samples", total.m_light_samples);
+
+    static const char* OSLExecutionNames[HotPathCounters::OSLExecutionCount] =
+    {
+        "shading",
+        "subsurface",
+        "transparency",
+        "emission",
+        "bump",
+        "background",
+        "surface shader"
+    };
+
+    Statistics osl_stats;
+    uint64 osl_total = 0;
+
+    for (size_t i = 0; i < HotPathCounters::OSLExecutionCount; ++i)
+    {
+        if (total.m_osl_executions[i] > 0)
+        {
+            osl_stats.insert<uint64>(OSLExecutionNames[i], total.m_osl_executions[i]);
+            osl_total += total.m_osl_executions[i];
+        }
+    }
+
+    if (osl_total > 0)
+    {
+        osl_stats.insert<uint64>("total", osl_total);
+        stats.insert("hot paths: osl executions", osl_stats);
+    }
+
+    return stats;
+}
+
+}   // namespace renderer
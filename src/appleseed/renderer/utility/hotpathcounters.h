@@ -0,0 +1,260 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_UTILITY_HOTPATHCOUNTERS_H
+#define APPLESEED_RENDERER_UTILITY_HOTPATHCOUNTERS_H
+
+// appleseed.renderer headers.
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/shadingprofiler.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class StatisticsVector; }
+
+//
+// Define APPLESEED_DISABLE_HOT_PATH_COUNTERS to compile out all hot path counters.
+//
+
+#ifdef APPLESEED_DISABLE_HOT_PATH_COUNTERS
+#define APPLESEED_HOT_PATH_COUNT(x)
+#else
+#define APPLESEED_HOT_PATH_COUNT(x) x
+#endif
+
+namespace renderer
+{
+
+//
+// Per-model event counts, keyed by model name. Model names are expected to be the
+// static strings returned by the get_model() methods of entities, so that they can
+// be compared by address.
+//
+
+class APPLESEED_DLLSYMBOL ModelCounts
+{
+  public:
+    // Maximum number of distinct models, additional ones are counted together.
+    enum { MaxModelCount = 32 };
+
+    ModelCounts();
+
+    void clear();
+
+    void increment(const char* model);
+
+    void merge(const ModelCounts& other);
+
+    size_t get_model_count() const;
+    const char* get_model(const size_t index) const;
+    foundation::uint64 get_count(const size_t index) const;
+    foundation::uint64 get_other_count() const;
+
+  private:
+    size_t              m_model_count;
+    const char*         m_models[MaxModelCount];
+    foundation::uint64  m_counts[MaxModelCount];
+    foundation::uint64  m_other_count;
+};
+
+
+//
+// Counters updated on the hot paths of a single rendering thread.
+//
+
+class APPLESEED_DLLSYMBOL HotPathCounters
+{
+  public:
+    // One slot per visibility flag, plus one for rays without any flag.
+    enum { RayTypeCount = 10 };
+
+    enum OSLExecution
+    {
+        OSLShading,
+        OSLSubsurface,
+        OSLTransparency,
+        OSLEmission,
+        OSLBump,
+        OSLBackground,
+        OSLSurfaceShader,
+        OSLExecutionCount
+    };
+
+    HotPathCounters();
+
+    void clear();
+
+    void merge(const HotPathCounters& other);
+
+    // Return the ray type slot of a set of visibility flags.
+    static size_t ray_type_index(const VisibilityFlags::Type flags);
+
+    // Set the type of the ray being traced, to which leaf visits are attributed.
+    void begin_ray(const VisibilityFlags::Type flags);
+
+    // Record the outcome of the ray being traced.
+    void end_ray(const bool hit);
+
+    // Record a leaf visit of the ray being traced.
+    void visit_leaf(const size_t primitive_count);
+
+    // Ray tracing, per ray type.
+    size_t              m_current_ray_type;
+    foundation::uint64  m_rays[RayTypeCount];
+    foundation::uint64  m_ray_hits[RayTypeCount];
+    foundation::uint64  m_leaf_visits[RayTypeCount];
+    foundation::uint64  m_primitive_tests[RayTypeCount];
+
+    // Shading and lighting.
+    foundation::uint64  m_osl_executions[OSLExecutionCount];
+    ModelCounts         m_bsdf_evaluations;
+    ModelCounts         m_light_samples;
+
+    // Sampled shading times, only recorded when the shading profiler is enabled.
+    ShadingProfile      m_shading_profile;
+};
+
+// Counters of the calling thread, or 0 if it did not use them yet.
+extern APPLESEED_THREAD_LOCAL HotPathCounters* g_thread_hot_path_counters;
+
+// Return the counters of the calling thread.
+HotPathCounters& hot_path_counters();
+
+// Create and register the counters of the calling thread.
+HotPathCounters& register_thread_hot_path_counters();
+
+// Reset the counters of all threads.
+APPLESEED_DLLSYMBOL void clear_hot_path_counters();
+
+// Return the sum of the counters of all threads. The counters of running threads
+// are read without synchronization: call this function while rendering is idle
+// to get exact numbers.
+APPLESEED_DLLSYMBOL void get_hot_path_counters(HotPathCounters& total);
+
+// Return the sum of the counters of all threads as statistics.
+APPLESEED_DLLSYMBOL foundation::StatisticsVector get_hot_path_statistics();
+
+
+//
+// ModelCounts class implementation.
+//
+
+inline void ModelCounts::increment(const char* model)
+{
+    for (size_t i = 0; i < m_model_count; ++i)
+    {
+        if (m_models[i] == model)
+        {
+            ++m_counts[i];
+            return;
+        }
+    }
+
+    if (m_model_count < MaxModelCount)
+    {
+        m_models[m_model_count] = model;
+        m_counts[m_model_count] = 1;
+        ++m_model_count;
+    }
+    else ++m_other_count;
+}
+
+inline size_t ModelCounts::get_model_count() const
+{
+    return m_model_count;
+}
+
+inline const char* ModelCounts::get_model(const size_t index) const
+{
+    return m_models[index];
+}
+
+inline foundation::uint64 ModelCounts::get_count(const size_t index) const
+{
+    return m_counts[index];
+}
+
+inline foundation::uint64 ModelCounts::get_other_count() const
+{
+    return m_other_count;
+}
+
+
+//
+// HotPathCounters class implementation.
+//
+
+inline size_t HotPathCounters::ray_type_index(const VisibilityFlags::Type flags)
+{
+    for (size_t i = 0; i < RayTypeCount - 1; ++i)
+    {
+        if (flags & (1UL << i))
+            return i;
+    }
+
+    return RayTypeCount - 1;
+}
+
+inline void HotPathCounters::begin_ray(const VisibilityFlags::Type flags)
+{
+    m_current_ray_type = ray_type_index(flags);
+    ++m_rays[m_current_ray_type];
+}
+
+inline void HotPathCounters::end_ray(const bool hit)
+{
+    if (hit)
+        ++m_ray_hits[m_current_ray_type];
+}
+
+inline void HotPathCounters::visit_leaf(const size_t primitive_count)
+{
+    ++m_leaf_visits[m_current_ray_type];
+    m_primitive_tests[m_current_ray_type] += primitive_count;
+}
+
+inline HotPathCounters& hot_path_counters()
+{
+    HotPathCounters* counters = g_thread_hot_path_counters;
+    return counters ? *counters : register_thread_hot_path_counters();
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_UTILITY_HOTPATHCOUNTERS_H
@@ -0,0 +1,110 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "renderstatistics.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/singleton.h"
+#include "foundation/platform/thread.h"
+#include "foundation/utility/statistics.h"
+
+// Standard headers.
+#include <ostream>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// RenderStatistics class implementation.
+//
+
+struct RenderStatistics::Impl
+{
+    mutable boost::mutex    m_mutex;
+    StatisticsVector        m_stats;
+};
+
+RenderStatistics::RenderStatistics()
+  : impl(new Impl())
+{
+}
+
+RenderStatistics::~RenderStatistics()
+{
+    delete impl;
+}
+
+void RenderStatistics::clear()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->m_stats = StatisticsVector();
+}
+
+void RenderStatistics::record(const StatisticsVector& stats)
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->m_stats.update(stats);
+}
+
+StatisticsVector RenderStatistics::get_statistics() const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    return impl->m_stats;
+}
+
+void RenderStatistics::write_json(ostream& output) const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->m_stats.write_json(output);
+    output << "\n";
+}
+
+namespace
+{
+    class GlobalRenderStatistics
+      : public Singleton<RenderStatistics>
+    {
+      private:
+        friend class Singleton<RenderStatistics>;
+
+        GlobalRenderStatistics() {}
+    };
+}
+
+RenderStatistics& global_render_statistics()
+{
+    return GlobalRenderStatistics::instance();
+}
+
+}   // namespace renderer
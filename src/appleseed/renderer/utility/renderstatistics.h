@@ -0,0 +1,89 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_UTILITY_RENDERSTATISTICS_H
+#define APPLESEED_RENDERER_UTILITY_RENDERSTATISTICS_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <iosfwd>
+
+// Forward declarations.
+namespace foundation    { class StatisticsVector; }
+
+namespace renderer
+{
+
+//
+// Collects the statistics printed during a render so that they can be exported
+// in a structured form once the render is complete.
+//
+// Collections are identified by name: recording a collection that was already
+// recorded replaces it, so that the latest statistics of each component are kept.
+//
+
+class APPLESEED_DLLSYMBOL RenderStatistics
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    RenderStatistics();
+
+    // Destructor.
+    ~RenderStatistics();
+
+    // Remove all recorded statistics.
+    void clear();
+
+    // Record collections of statistics. Thread-safe.
+    void record(const foundation::StatisticsVector& stats);
+
+    // Return a copy of all recorded statistics. Thread-safe.
+    foundation::StatisticsVector get_statistics() const;
+
+    // Write all recorded statistics to a stream in JSON format. Thread-safe.
+    void write_json(std::ostream& output) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+// Return the globally accessible render statistics.
+APPLESEED_DLLSYMBOL RenderStatistics& global_render_statistics();
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_UTILITY_RENDERSTATISTICS_H
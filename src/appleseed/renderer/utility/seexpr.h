@@ -34,6 +34,7 @@
 #include "renderer/kernel/shading/shadingpoint.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/math/vector.h"
@@ -58,10 +59,15 @@ END_OIIO_INCLUDES
 
 // Boost headers.
 #include "boost/ptr_container/ptr_vector.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
 
 // Standard headers.
 #include <cassert>
+#include <cstddef>
+#include <map>
 #include <string>
+#include <utility>
 
 namespace renderer
 {
@@ -181,11 +187,13 @@ class SeAppleseedExpr
 {
   public:
     SeAppleseedExpr()
+      : m_has_last_result(false)
     {
     }
 
     SeAppleseedExpr(const std::string& expr)
       : SeExpression(expr)
+      , m_has_last_result(false)
     {
         reset_vars();
     }
@@ -194,6 +202,7 @@ class SeAppleseedExpr
     {
         SeExpression::setExpr(expr);
         reset_vars();
+        m_has_last_result = false;
     }
 
     // Called during preparation.
@@ -227,15 +236,26 @@ class SeAppleseedExpr
         const ShadingPoint&     shading_point,
         OIIO::TextureSystem&    texture_system)
     {
+        // The only variables are the surface coordinates: when the expression is shared by
+        // several inputs, it is evaluated once per point.
+        const foundation::Vector2f& uv = shading_point.get_uv(0);
+        if (m_has_last_result && m_last_uv == uv && m_last_texture_system == &texture_system)
+            return m_last_result;
+
         for (foundation::each<boost::ptr_vector<TextureSeExprFunc> > i = m_functions_x; i; ++i)
             i->set_texture_system(&texture_system);
 
-        const foundation::Vector2f& uv = shading_point.get_uv(0);
         m_u_var.m_val = uv[0];
         m_v_var.m_val = uv[1];
 
         const SeVec3d result = evaluate();
-        return foundation::Color3d(result[0], result[1], result[2]);
+
+        m_has_last_result = true;
+        m_last_uv = uv;
+        m_last_texture_system = &texture_system;
+        m_last_result = foundation::Color3d(result[0], result[1], result[2]);
+
+        return m_last_result;
     }
 
   private:
@@ -267,6 +287,95 @@ class SeAppleseedExpr
     mutable Var                                     m_v_var;
     mutable boost::ptr_vector<TextureSeExprFunc>    m_functions_x;
     mutable boost::ptr_vector<SeExprFunc>           m_functions;
+
+    // Result of the last evaluation.
+    bool                                            m_has_last_result;
+    foundation::Vector2f                            m_last_uv;
+    const OIIO::TextureSystem*                      m_last_texture_system;
+    foundation::Color3d                             m_last_result;
+};
+
+
+//
+// SeAppleseedExprCache class.
+//
+// Parsing and preparing an expression is expensive, and many inputs share the same
+// expressions. A cache hands out a single prepared expression per source text to all
+// the entities that use it. Expressions are not reentrant: a cache must only be used
+// by one rendering thread at a time. Expressions are reference-counted and destroyed
+// when the last entity using them releases them.
+//
+
+class SeAppleseedExprCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Destructor.
+    ~SeAppleseedExprCache()
+    {
+        for (foundation::each<EntryMap> i = m_entries; i; ++i)
+            delete i->second.m_expr;
+    }
+
+    // Return the prepared expression for a given source text. The expression is
+    // parsed and prepared the first time it is requested. Check its validity with
+    // SeExpression::isValid() before evaluating it.
+    SeAppleseedExpr* acquire(
+        const std::string&      expr,
+        const bool              want_vec)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        Entry& entry = m_entries[std::make_pair(expr, want_vec)];
+
+        if (entry.m_expr == 0)
+        {
+            entry.m_expr = new SeAppleseedExpr();
+            entry.m_expr->setWantVec(want_vec);
+            entry.m_expr->set_expr(expr);
+            entry.m_expr->isValid();            // parse and prepare the expression
+        }
+
+        ++entry.m_ref_count;
+
+        return entry.m_expr;
+    }
+
+    // Release an expression returned by acquire().
+    void release(
+        const std::string&      expr,
+        const bool              want_vec)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        const EntryMap::iterator i = m_entries.find(std::make_pair(expr, want_vec));
+        assert(i != m_entries.end());
+        assert(i->second.m_ref_count > 0);
+
+        if (--i->second.m_ref_count == 0)
+        {
+            delete i->second.m_expr;
+            m_entries.erase(i);
+        }
+    }
+
+  private:
+    struct Entry
+    {
+        SeAppleseedExpr*    m_expr;
+        size_t              m_ref_count;
+
+        Entry()
+          : m_expr(0)
+          , m_ref_count(0)
+        {
+        }
+    };
+
+    typedef std::map<std::pair<std::string, bool>, Entry> EntryMap;
+
+    boost::mutex    m_mutex;
+    EntryMap        m_entries;
 };
 
 }       // namespace renderer
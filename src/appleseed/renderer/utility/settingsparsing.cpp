@@ -36,6 +36,7 @@
 // appleseed.foundation headers.
 #include "foundation/platform/system.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/job/jobmanager.h"
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/string.h"
 
@@ -54,12 +55,12 @@ SamplingContext::Mode get_sampling_context_mode(const ParamArray& params)
         params.get_required<string>(
             "sampling_mode",
             "rng",
-            make_vector("rng", "qmc"));
+            make_vector("rng", "qmc", "sobol"));
 
     return
-        sampling_mode == "rng"
-            ? SamplingContext::RNGMode
-            : SamplingContext::QMCMode;
+        sampling_mode == "rng" ? SamplingContext::RNGMode :
+        sampling_mode == "qmc" ? SamplingContext::QMCMode :
+        SamplingContext::SobolMode;
 }
 
 string get_sampling_context_mode_name(const SamplingContext::Mode mode)
@@ -68,13 +69,14 @@ string get_sampling_context_mode_name(const SamplingContext::Mode mode)
     {
       case SamplingContext::RNGMode: return "rng";
       case SamplingContext::QMCMode: return "qmc";
+      case SamplingContext::SobolMode: return "sobol";
       default: return "unknown";
     }
 }
 
 size_t get_rendering_thread_count(const ParamArray& params)
 {
-    const size_t core_count = System::get_logical_cpu_core_count();
+    const size_t core_count = System::get_available_cpu_core_count();
 
     static const char* ThreadCountParameterName = "rendering_threads";
 
@@ -119,4 +121,16 @@ size_t get_rendering_thread_count(const ParamArray& params)
     return thread_count;
 }
 
+int get_rendering_thread_affinity_flags(const ParamArray& params)
+{
+    const string affinity =
+        params.get_optional<string>(
+            "rendering_threads_affinity",
+            "none",
+            make_vector("none", "numa"));
+
+    // Rendering threads are pinned to CPU cores grouped by NUMA node.
+    return affinity == "numa" ? JobManager::PinWorkerThreads : 0;
+}
+
 }   // namespace renderer
@@ -52,6 +52,9 @@ std::string get_sampling_context_mode_name(const SamplingContext::Mode mode);
 // Rendering threads.
 APPLESEED_DLLSYMBOL size_t get_rendering_thread_count(const ParamArray& params);
 
+// Return the foundation::JobManager flags that control the CPU affinity of rendering threads.
+APPLESEED_DLLSYMBOL int get_rendering_thread_affinity_flags(const ParamArray& params);
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_UTILITY_SETTINGSPARSING_H
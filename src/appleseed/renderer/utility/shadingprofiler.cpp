@@ -0,0 +1,304 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "shadingprofiler.h"
+
+// appleseed.renderer headers.
+#include "renderer/utility/hotpathcounters.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// ShadingProfile class implementation.
+//
+
+ShadingProfile::ShadingProfile()
+  : m_skipped_count(0)
+  , m_nesting(0)
+  , m_timing(false)
+{
+    clear();
+}
+
+void ShadingProfile::clear()
+{
+    for (size_t i = 0; i < CategoryCount; ++i)
+    {
+        m_tables[i].m_count = 0;
+        m_tables[i].m_other_ticks = 0;
+    }
+
+    m_sample_count = 0;
+}
+
+void ShadingProfile::merge(const ShadingProfile& other)
+{
+    for (size_t c = 0; c < CategoryCount; ++c)
+    {
+        Table& table = m_tables[c];
+        const Table& other_table = other.m_tables[c];
+
+        for (size_t i = 0; i < other_table.m_count; ++i)
+        {
+            size_t j = 0;
+
+            while (j < table.m_count && table.m_names[j] != other_table.m_names[i])
+                ++j;
+
+            if (j < table.m_count)
+                table.m_ticks[j] += other_table.m_ticks[i];
+            else if (table.m_count < MaxEntryCount)
+            {
+                table.m_names[table.m_count] = other_table.m_names[i];
+                table.m_ticks[table.m_count] = other_table.m_ticks[i];
+                ++table.m_count;
+            }
+            else table.m_other_ticks += other_table.m_ticks[i];
+        }
+
+        table.m_other_ticks += other_table.m_other_ticks;
+    }
+
+    m_sample_count += other.m_sample_count;
+}
+
+void ShadingProfile::begin_scope(
+    const size_t        sampling_period,
+    const Category      category,
+    const char*         name)
+{
+    if (m_nesting == 0)
+    {
+        // Only time one outermost scope out of every sampling_period, with all the scopes it contains.
+        m_timing = ++m_skipped_count >= sampling_period;
+        if (m_timing)
+        {
+            m_skipped_count = 0;
+            ++m_sample_count;
+        }
+    }
+
+    const size_t depth = m_nesting++;
+
+    if (!m_timing || depth >= MaxDepth)
+        return;
+
+    const uint64 now = DefaultWallclockTimer().read();
+
+    // Stop charging the enclosing scope.
+    if (depth > 0)
+    {
+        const Scope& parent = m_stack[depth - 1];
+        charge(parent, now - parent.m_resume_time);
+    }
+
+    Scope& scope = m_stack[depth];
+    scope.m_category = category;
+    scope.m_name = name;
+    scope.m_resume_time = now;
+}
+
+void ShadingProfile::end_scope()
+{
+    assert(m_nesting > 0);
+
+    const size_t depth = --m_nesting;
+
+    if (!m_timing || depth >= MaxDepth)
+        return;
+
+    const uint64 now = DefaultWallclockTimer().read();
+
+    const Scope& scope = m_stack[depth];
+    charge(scope, now - scope.m_resume_time);
+
+    // Resume charging the enclosing scope.
+    if (depth > 0)
+        m_stack[depth - 1].m_resume_time = now;
+}
+
+void ShadingProfile::charge(const Scope& scope, const uint64 ticks)
+{
+    Table& table = m_tables[scope.m_category];
+
+    for (size_t i = 0; i < table.m_count; ++i)
+    {
+        if (table.m_names[i] == scope.m_name)
+        {
+            table.m_ticks[i] += ticks;
+            return;
+        }
+    }
+
+    if (table.m_count < MaxEntryCount)
+    {
+        table.m_names[table.m_count] = scope.m_name;
+        table.m_ticks[table.m_count] = ticks;
+        ++table.m_count;
+    }
+    else table.m_other_ticks += ticks;
+}
+
+
+//
+// Shading profiler implementation.
+//
+
+size_t g_shading_profiler_sampling_period = 0;
+
+void enable_shading_profiler(const size_t sampling_period)
+{
+    assert(sampling_period > 0);
+    g_shading_profiler_sampling_period = sampling_period;
+}
+
+void disable_shading_profiler()
+{
+    g_shading_profiler_sampling_period = 0;
+}
+
+ShadingProfile* begin_shading_profile_scope(
+    const ShadingProfile::Category      category,
+    const char*                         name)
+{
+    ShadingProfile& profile = hot_path_counters().m_shading_profile;
+    profile.begin_scope(g_shading_profiler_sampling_period, category, name);
+    return &profile;
+}
+
+namespace
+{
+    typedef pair<uint64, string> RankedEntry;
+
+    bool is_more_expensive(const RankedEntry& lhs, const RankedEntry& rhs)
+    {
+        return lhs.first > rhs.first;
+    }
+}
+
+StatisticsVector get_shading_profile_statistics()
+{
+    HotPathCounters total;
+    get_hot_path_counters(total);
+
+    const ShadingProfile& profile = total.m_shading_profile;
+
+    StatisticsVector stats;
+
+    if (profile.get_sample_count() == 0)
+        return stats;
+
+    // Scale sampled times to estimate the total times.
+    const double seconds_per_tick =
+        static_cast<double>(g_shading_profiler_sampling_period) /
+        DefaultWallclockTimer().frequency();
+
+    static const char* CategoryNames[ShadingProfile::CategoryCount] =
+    {
+        "shading profile: shader groups",
+        "shading profile: materials",
+        "shading profile: bsdf models"
+    };
+
+    uint64 total_ticks = 0;
+
+    for (size_t c = 0; c < ShadingProfile::CategoryCount; ++c)
+    {
+        const ShadingProfile::Category category = static_cast<ShadingProfile::Category>(c);
+
+        total_ticks += profile.get_other_ticks(category);
+
+        for (size_t i = 0; i < profile.get_entry_count(category); ++i)
+            total_ticks += profile.get_ticks(category, i);
+    }
+
+    for (size_t c = 0; c < ShadingProfile::CategoryCount; ++c)
+    {
+        const ShadingProfile::Category category = static_cast<ShadingProfile::Category>(c);
+
+        // Entities of different assemblies may share the same name: report them together.
+        map<string, uint64> times;
+        for (size_t i = 0; i < profile.get_entry_count(category); ++i)
+            times[profile.get_name(category, i)] += profile.get_ticks(category, i);
+
+        vector<RankedEntry> ranking;
+        for (const_each<map<string, uint64> > i = times; i; ++i)
+            ranking.push_back(make_pair(i->second, i->first));
+
+        if (profile.get_other_ticks(category) > 0)
+            ranking.push_back(make_pair(profile.get_other_ticks(category), string("other")));
+
+        if (ranking.empty())
+            continue;
+
+        stable_sort(ranking.begin(), ranking.end(), is_more_expensive);
+
+        Statistics category_stats;
+
+        for (const_each<vector<RankedEntry> > i = ranking; i; ++i)
+        {
+            category_stats.insert(
+                i->second,
+                pretty_time(i->first * seconds_per_tick) +
+                    " (" + pretty_percent(i->first, total_ticks) + ")");
+        }
+
+        stats.insert(CategoryNames[c], category_stats);
+    }
+
+    Statistics summary_stats;
+    summary_stats.insert_time("profiled time", total_ticks * seconds_per_tick);
+    summary_stats.insert<uint64>("sampling period", g_shading_profiler_sampling_period);
+    summary_stats.insert<uint64>("timed scopes", profile.get_sample_count());
+    stats.insert("shading profile", summary_stats);
+
+    return stats;
+}
+
+}   // namespace renderer
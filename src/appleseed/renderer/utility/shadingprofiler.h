@@ -0,0 +1,229 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_UTILITY_SHADINGPROFILER_H
+#define APPLESEED_RENDERER_UTILITY_SHADINGPROFILER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class StatisticsVector; }
+
+namespace renderer
+{
+
+//
+// Shading time of a single rendering thread, attributed to shader groups, materials
+// and BSDF models.
+//
+// Profiled scopes nest: the time spent in a scope is charged to the innermost open
+// scope, so that each category reports self times that add up to the total profiled
+// time. Only one outermost scope out of every N is timed (with all the scopes it
+// contains), which keeps the overhead low enough to profile production renders.
+//
+// Names are expected to remain valid until the profile is reported, and are compared
+// by address.
+//
+
+class APPLESEED_DLLSYMBOL ShadingProfile
+{
+  public:
+    enum Category
+    {
+        ShaderGroups,
+        Materials,
+        BSDFModels,
+        CategoryCount
+    };
+
+    // Maximum number of distinct names per category, additional ones are timed together.
+    enum { MaxEntryCount = 64 };
+
+    // Maximum nesting depth of timed scopes, deeper scopes are charged to their parent.
+    enum { MaxDepth = 32 };
+
+    ShadingProfile();
+
+    // Clear the recorded times. Must not be called while a scope is open.
+    void clear();
+
+    void merge(const ShadingProfile& other);
+
+    // Open a scope. Every call must be matched by a call to end_scope().
+    void begin_scope(
+        const size_t        sampling_period,
+        const Category      category,
+        const char*         name);
+
+    // Close the innermost scope.
+    void end_scope();
+
+    size_t get_entry_count(const Category category) const;
+    const char* get_name(const Category category, const size_t index) const;
+    foundation::uint64 get_ticks(const Category category, const size_t index) const;
+    foundation::uint64 get_other_ticks(const Category category) const;
+
+    // Return the number of timed outermost scopes.
+    foundation::uint64 get_sample_count() const;
+
+  private:
+    struct Table
+    {
+        size_t              m_count;
+        const char*         m_names[MaxEntryCount];
+        foundation::uint64  m_ticks[MaxEntryCount];
+        foundation::uint64  m_other_ticks;
+    };
+
+    struct Scope
+    {
+        Category            m_category;
+        const char*         m_name;
+        foundation::uint64  m_resume_time;  // time at which this scope became the innermost one
+    };
+
+    Table                   m_tables[CategoryCount];
+    foundation::uint64      m_sample_count;
+    size_t                  m_skipped_count;    // outermost scopes skipped since the last timed one
+    size_t                  m_nesting;          // number of open scopes, timed or not
+    bool                    m_timing;           // is the current outermost scope timed?
+    Scope                   m_stack[MaxDepth];
+
+    void charge(const Scope& scope, const foundation::uint64 ticks);
+};
+
+// Sampling period of the shading profiler, or 0 if it is disabled.
+extern size_t g_shading_profiler_sampling_period;
+
+// Enable the shading profiler: one outermost shading scope out of every
+// sampling_period is timed on each thread. Call while rendering is idle.
+APPLESEED_DLLSYMBOL void enable_shading_profiler(const size_t sampling_period);
+
+// Disable the shading profiler. Call while rendering is idle.
+APPLESEED_DLLSYMBOL void disable_shading_profiler();
+
+// Return true if the shading profiler is enabled.
+bool is_shading_profiler_enabled();
+
+// Return the estimated shading times of all threads, ranked from the most expensive
+// shader groups, materials and BSDF models to the least expensive ones.
+APPLESEED_DLLSYMBOL foundation::StatisticsVector get_shading_profile_statistics();
+
+
+//
+// Profile the shading time spent in the lifetime of an instance of this class.
+//
+
+class ShadingProfileScope
+  : public foundation::NonCopyable
+{
+  public:
+    ShadingProfileScope(
+        const ShadingProfile::Category  category,
+        const char*                     name);
+
+    ~ShadingProfileScope();
+
+  private:
+    ShadingProfile* m_profile;
+};
+
+// Open a scope in the profile of the calling thread and return this profile.
+ShadingProfile* begin_shading_profile_scope(
+    const ShadingProfile::Category      category,
+    const char*                         name);
+
+
+//
+// ShadingProfile class implementation.
+//
+
+inline size_t ShadingProfile::get_entry_count(const Category category) const
+{
+    return m_tables[category].m_count;
+}
+
+inline const char* ShadingProfile::get_name(const Category category, const size_t index) const
+{
+    return m_tables[category].m_names[index];
+}
+
+inline foundation::uint64 ShadingProfile::get_ticks(const Category category, const size_t index) const
+{
+    return m_tables[category].m_ticks[index];
+}
+
+inline foundation::uint64 ShadingProfile::get_other_ticks(const Category category) const
+{
+    return m_tables[category].m_other_ticks;
+}
+
+inline foundation::uint64 ShadingProfile::get_sample_count() const
+{
+    return m_sample_count;
+}
+
+inline bool is_shading_profiler_enabled()
+{
+    return g_shading_profiler_sampling_period > 0;
+}
+
+
+//
+// ShadingProfileScope class implementation.
+//
+
+inline ShadingProfileScope::ShadingProfileScope(
+    const ShadingProfile::Category      category,
+    const char*                         name)
+  : m_profile(
+        is_shading_profiler_enabled()
+            ? begin_shading_profile_scope(category, name)
+            : 0)
+{
+}
+
+inline ShadingProfileScope::~ShadingProfileScope()
+{
+    if (m_profile)
+        m_profile->end_scope();
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_UTILITY_SHADINGPROFILER_H
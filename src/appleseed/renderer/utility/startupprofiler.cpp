@@ -0,0 +1,377 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "startupprofiler.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/singleton.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/json.h"
+#include "foundation/utility/statistics.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// StartupProfiler class implementation.
+//
+
+namespace
+{
+    // Number of most expensive entities kept per category.
+    const size_t MaxEntitiesPerCategory = 10;
+
+    struct Phase
+    {
+        string      m_name;
+        size_t      m_depth;
+        double      m_seconds;
+    };
+
+    struct EntityTiming
+    {
+        string      m_name;
+        double      m_seconds;
+
+        bool operator<(const EntityTiming& rhs) const
+        {
+            return m_seconds > rhs.m_seconds;
+        }
+    };
+
+    struct Category
+    {
+        string                  m_name;
+        uint64                  m_count;
+        double                  m_total_seconds;
+        vector<EntityTiming>    m_top_entities;     // sorted by decreasing time
+    };
+
+    // Make a statistics entry name unique by appending a number to it if necessary.
+    string make_unique_name(set<string>& names, const string& name)
+    {
+        string unique_name = name;
+
+        for (size_t i = 2; names.count(unique_name) > 0; ++i)
+        {
+            stringstream sstr;
+            sstr << name << " #" << i;
+            unique_name = sstr.str();
+        }
+
+        names.insert(unique_name);
+
+        return unique_name;
+    }
+
+    void write_json_indent(ostream& output, const size_t level)
+    {
+        output << string(level * 2, ' ');
+    }
+
+    // Write the phases [begin, end) that are at a given depth, along with their children.
+    size_t write_json_phases(
+        ostream&                output,
+        const vector<Phase>&    phases,
+        size_t                  begin,
+        const size_t            depth,
+        const size_t            level)
+    {
+        write_json_indent(output, level);
+        output << "[";
+
+        bool first = true;
+
+        while (begin < phases.size() && phases[begin].m_depth == depth)
+        {
+            const Phase& phase = phases[begin++];
+
+            output << (first ? "\n" : ",\n");
+            first = false;
+
+            write_json_indent(output, level + 1);
+            output << "{ \"name\": ";
+            write_json_string(output, phase.m_name);
+            output << ", \"seconds\": " << phase.m_seconds;
+
+            if (begin < phases.size() && phases[begin].m_depth > depth)
+            {
+                output << ", \"phases\":\n";
+                begin = write_json_phases(output, phases, begin, depth + 1, level + 2);
+            }
+
+            output << " }";
+        }
+
+        if (!first)
+        {
+            output << "\n";
+            write_json_indent(output, level);
+        }
+
+        output << "]";
+
+        return begin;
+    }
+}
+
+struct StartupProfiler::Impl
+{
+    mutable boost::mutex    m_mutex;
+    vector<Phase>           m_phases;           // in depth-first order
+    vector<size_t>          m_open_phases;      // indices of the open phases, innermost last
+    vector<Category>        m_categories;
+
+    Category& get_category(const char* name)
+    {
+        for (each<vector<Category> > i = m_categories; i; ++i)
+        {
+            if (i->m_name == name)
+                return *i;
+        }
+
+        Category category;
+        category.m_name = name;
+        category.m_count = 0;
+        category.m_total_seconds = 0.0;
+        m_categories.push_back(category);
+
+        return m_categories.back();
+    }
+
+    // Remove a top-level phase and its children.
+    void remove_top_level_phase(const char* name)
+    {
+        for (size_t i = 0; i < m_phases.size(); ++i)
+        {
+            if (m_phases[i].m_depth == 0 && m_phases[i].m_name == name)
+            {
+                size_t end = i + 1;
+                while (end < m_phases.size() && m_phases[end].m_depth > 0)
+                    ++end;
+
+                m_phases.erase(m_phases.begin() + i, m_phases.begin() + end);
+                return;
+            }
+        }
+    }
+};
+
+StartupProfiler::StartupProfiler()
+  : impl(new Impl())
+{
+}
+
+StartupProfiler::~StartupProfiler()
+{
+    delete impl;
+}
+
+void StartupProfiler::clear()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    assert(impl->m_open_phases.empty());
+
+    impl->m_phases.clear();
+    impl->m_categories.clear();
+}
+
+void StartupProfiler::begin_phase(const char* name)
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    if (impl->m_open_phases.empty())
+        impl->remove_top_level_phase(name);
+
+    Phase phase;
+    phase.m_name = name;
+    phase.m_depth = impl->m_open_phases.size();
+    phase.m_seconds = 0.0;
+
+    impl->m_open_phases.push_back(impl->m_phases.size());
+    impl->m_phases.push_back(phase);
+}
+
+void StartupProfiler::end_phase(const double seconds)
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    assert(!impl->m_open_phases.empty());
+
+    impl->m_phases[impl->m_open_phases.back()].m_seconds = seconds;
+    impl->m_open_phases.pop_back();
+}
+
+void StartupProfiler::record_entity(
+    const char*         category_name,
+    const string&       entity_name,
+    const double        seconds)
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    Category& category = impl->get_category(category_name);
+    category.m_count++;
+    category.m_total_seconds += seconds;
+
+    vector<EntityTiming>& top = category.m_top_entities;
+
+    // An entity may be recorded multiple times (e.g. once per frame): keep its worst time.
+    for (each<vector<EntityTiming> > i = top; i; ++i)
+    {
+        if (i->m_name == entity_name)
+        {
+            if (seconds > i->m_seconds)
+            {
+                i->m_seconds = seconds;
+                sort(top.begin(), top.end());
+            }
+            return;
+        }
+    }
+
+    if (top.size() == MaxEntitiesPerCategory && seconds <= top.back().m_seconds)
+        return;
+
+    EntityTiming timing;
+    timing.m_name = entity_name;
+    timing.m_seconds = seconds;
+
+    top.insert(upper_bound(top.begin(), top.end(), timing), timing);
+
+    if (top.size() > MaxEntitiesPerCategory)
+        top.pop_back();
+}
+
+StatisticsVector StartupProfiler::get_statistics() const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    StatisticsVector stats;
+
+    if (!impl->m_phases.empty())
+    {
+        Statistics phase_stats;
+        set<string> names;
+
+        for (const_each<vector<Phase> > i = impl->m_phases; i; ++i)
+        {
+            phase_stats.insert_time(
+                make_unique_name(names, string(i->m_depth * 2, ' ') + i->m_name),
+                i->m_seconds);
+        }
+
+        stats.insert("startup phases", phase_stats);
+    }
+
+    for (const_each<vector<Category> > i = impl->m_categories; i; ++i)
+    {
+        Statistics category_stats;
+        set<string> names;
+
+        category_stats.insert<uint64>(make_unique_name(names, "count"), i->m_count);
+        category_stats.insert_time(make_unique_name(names, "total"), i->m_total_seconds);
+
+        for (const_each<vector<EntityTiming> > j = i->m_top_entities; j; ++j)
+            category_stats.insert_time(make_unique_name(names, "  " + j->m_name), j->m_seconds);
+
+        stats.insert("startup: " + i->m_name, category_stats);
+    }
+
+    return stats;
+}
+
+void StartupProfiler::write_json(ostream& output) const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    output << "{\n";
+    output << "  \"phases\":\n";
+    write_json_phases(output, impl->m_phases, 0, 0, 2);
+    output << ",\n";
+    output << "  \"entities\":\n";
+    output << "    [";
+
+    for (const_each<vector<Category> > i = impl->m_categories; i; ++i)
+    {
+        output << (i.it() == impl->m_categories.begin() ? "\n" : ",\n");
+        output << "      { \"category\": ";
+        write_json_string(output, i->m_name);
+        output << ", \"count\": " << i->m_count;
+        output << ", \"total_seconds\": " << i->m_total_seconds;
+        output << ", \"top\": [";
+
+        for (const_each<vector<EntityTiming> > j = i->m_top_entities; j; ++j)
+        {
+            output << (j.it() == i->m_top_entities.begin() ? "\n" : ",\n");
+            output << "          { \"name\": ";
+            write_json_string(output, j->m_name);
+            output << ", \"seconds\": " << j->m_seconds << " }";
+        }
+
+        output << (i->m_top_entities.empty() ? "] }" : "\n        ] }");
+    }
+
+    output << (impl->m_categories.empty() ? "]\n" : "\n    ]\n");
+    output << "}\n";
+}
+
+namespace
+{
+    class GlobalStartupProfiler
+      : public Singleton<StartupProfiler>
+    {
+      private:
+        friend class Singleton<StartupProfiler>;
+
+        GlobalStartupProfiler() {}
+    };
+}
+
+StartupProfiler& global_startup_profiler()
+{
+    return GlobalStartupProfiler::instance();
+}
+
+}   // namespace renderer
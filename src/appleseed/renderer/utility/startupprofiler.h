@@ -0,0 +1,145 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_UTILITY_STARTUPPROFILER_H
+#define APPLESEED_RENDERER_UTILITY_STARTUPPROFILER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/timers.h"
+#include "foundation/utility/eventtracer.h"
+#include "foundation/utility/stopwatch.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+// Forward declarations.
+namespace foundation    { class StatisticsVector; }
+
+namespace renderer
+{
+
+//
+// Records how long the different phases of loading a project and starting a render
+// take, as well as which entities are the most expensive to process during them.
+//
+// Phases are hierarchical and must be opened and closed from a single thread, usually
+// with the StartupPhase helper below. Starting a top-level phase that was already
+// recorded replaces it, so that restarting a render does not accumulate phases.
+//
+// Entity timings are grouped by category and can be recorded from any thread. Only
+// the most expensive entities of each category are kept, along with per-category
+// counts and totals. Entity timings accumulate until clear() is called.
+//
+
+class APPLESEED_DLLSYMBOL StartupProfiler
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    StartupProfiler();
+
+    // Destructor.
+    ~StartupProfiler();
+
+    // Remove all phases and entity timings.
+    void clear();
+
+    // Open a new phase, nested in the innermost open phase if any.
+    void begin_phase(const char* name);
+
+    // Close the innermost open phase.
+    void end_phase(const double seconds);
+
+    // Record the time spent on an entity. Thread-safe.
+    void record_entity(
+        const char*         category,
+        const std::string&  entity_name,
+        const double        seconds);
+
+    // Return phase and entity timings as statistics.
+    foundation::StatisticsVector get_statistics() const;
+
+    // Write phase and entity timings to a stream in JSON format.
+    void write_json(std::ostream& output) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+// Return the globally accessible startup profiler.
+APPLESEED_DLLSYMBOL StartupProfiler& global_startup_profiler();
+
+
+//
+// Time a phase in the global startup profiler for the duration of a scope.
+// The phase is also recorded in the global event tracer when it is enabled.
+//
+
+class StartupPhase
+  : public foundation::NonCopyable
+{
+  public:
+    explicit StartupPhase(const char* name);
+    ~StartupPhase();
+
+  private:
+    foundation::EventTraceScope                                 m_trace_scope;
+    foundation::Stopwatch<foundation::DefaultWallclockTimer>    m_stopwatch;
+};
+
+
+//
+// StartupPhase class implementation.
+//
+
+inline StartupPhase::StartupPhase(const char* name)
+  : m_trace_scope("startup", name)
+  , m_stopwatch(0)
+{
+    global_startup_profiler().begin_phase(name);
+    m_stopwatch.start();
+}
+
+inline StartupPhase::~StartupPhase()
+{
+    m_stopwatch.measure();
+    global_startup_profiler().end_phase(m_stopwatch.get_seconds());
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_UTILITY_STARTUPPROFILER_H
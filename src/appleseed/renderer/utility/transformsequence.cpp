@@ -48,11 +48,42 @@ using namespace std;
 namespace renderer
 {
 
+namespace
+{
+    // Return true if the upper-left 3x3 parts of two matrices are equal, up to a tolerance
+    // that keeps the error of matrix interpolation well below that of slerp-based interpolation.
+    bool has_same_linear_part(const Matrix4d& lhs, const Matrix4d& rhs)
+    {
+        const double Eps = 1.0e-9;
+
+        for (size_t i = 0; i < 3; ++i)
+        {
+            for (size_t j = 0; j < 3; ++j)
+            {
+                if (abs(lhs(i, j) - rhs(i, j)) > Eps * max(1.0, abs(lhs(i, j))))
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    inline Matrix4d lerp_matrices(const Matrix4d& lhs, const Matrix4d& rhs, const double t)
+    {
+        Matrix4d result;
+
+        for (size_t i = 0; i < 16; ++i)
+            result[i] = lhs[i] + (rhs[i] - lhs[i]) * t;
+
+        return result;
+    }
+}
+
 TransformSequence::TransformSequence()
   : m_capacity(0)
   , m_size(0)
   , m_keys(0)
-  , m_interpolators(0)
+  , m_segments(0)
   , m_can_swap_handedness(false)
   , m_all_swap_handedness(false)
 {
@@ -82,8 +113,8 @@ void TransformSequence::clear()
     delete [] m_keys;
     m_keys = 0;
 
-    delete [] m_interpolators;
-    m_interpolators = 0;
+    delete [] m_segments;
+    m_segments = 0;
 
     m_can_swap_handedness = false;
     m_all_swap_handedness = false;
@@ -181,8 +212,8 @@ void TransformSequence::optimize()
 
 bool TransformSequence::prepare()
 {
-    delete [] m_interpolators;
-    m_interpolators = 0;
+    delete [] m_segments;
+    m_segments = 0;
 
     bool success = true;
 
@@ -190,14 +221,19 @@ bool TransformSequence::prepare()
     {
         sort(m_keys, m_keys + m_size);
 
-        m_interpolators = new TransformInterpolatord[m_size - 1];
+        m_segments = new Segment[m_size - 1];
 
         for (size_t i = 0; i < m_size - 1; ++i)
         {
             success = success &&
-                m_interpolators[i].set_transforms(
+                m_segments[i].m_interpolator.set_transforms(
                     m_keys[i].m_transform,
                     m_keys[i + 1].m_transform);
+
+            m_segments[i].m_linear =
+                has_same_linear_part(
+                    m_keys[i].m_transform.get_local_to_parent(),
+                    m_keys[i + 1].m_transform.get_local_to_parent());
         }
     }
 
@@ -278,6 +314,45 @@ TransformSequence TransformSequence::operator*(const TransformSequence& rhs) con
     return result;
 }
 
+AABB3d TransformSequence::to_parent(
+    const AABB3d&       bbox,
+    const float         time_begin,
+    const float         time_end) const
+{
+    assert(time_begin <= time_end);
+
+    if (m_size == 0 || !bbox.is_valid())
+        return bbox;
+
+    Transformd scratch;
+    Transformd from = evaluate(time_begin, scratch);
+
+    AABB3d result;
+    result.invalidate();
+
+    // Insert the bounding boxes of the paths between the key frames inside the time range.
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        const float time = m_keys[i].m_time;
+
+        if (time <= time_begin)
+            continue;
+
+        if (time >= time_end)
+            break;
+
+        result.insert(compute_motion_segment_bbox(bbox, from, m_keys[i].m_transform));
+        from = m_keys[i].m_transform;
+    }
+
+    // Insert the bounding box of the path to the end of the time range.
+    const Transformd& to = evaluate(time_end, scratch);
+    result.insert(compute_motion_segment_bbox(bbox, from, to));
+    result.insert(to.to_parent(bbox));
+
+    return result;
+}
+
 void TransformSequence::copy_from(const TransformSequence& rhs)
 {
     m_capacity = rhs.m_size;    // shrink to size on copy
@@ -292,14 +367,14 @@ void TransformSequence::copy_from(const TransformSequence& rhs)
     }
     else m_keys = 0;
 
-    if (rhs.m_interpolators)
+    if (rhs.m_segments)
     {
-        m_interpolators = new TransformInterpolatord[m_size - 1];
+        m_segments = new Segment[m_size - 1];
 
         for (size_t i = 0; i < m_size - 1; ++i)
-            m_interpolators[i] = rhs.m_interpolators[i];
+            m_segments[i] = rhs.m_segments[i];
     }
-    else m_interpolators = 0;
+    else m_segments = 0;
 
     m_can_swap_handedness = rhs.m_can_swap_handedness;
     m_all_swap_handedness = rhs.m_all_swap_handedness;
@@ -309,27 +384,47 @@ void TransformSequence::interpolate(
     const float         time,
     Transformd&         result) const
 {
-    assert(m_size > 0);
+    assert(m_size > 1);
 
     size_t begin = 0;
-    size_t end = m_size;
 
-    while (end - begin > 1)
+    if (m_size > 2)
     {
-        const size_t mid = (begin + end) / 2;
-        if (time < m_keys[mid].m_time)
-            end = mid;
-        else begin = mid;
+        size_t end = m_size;
+
+        while (end - begin > 1)
+        {
+            const size_t mid = (begin + end) / 2;
+            if (time < m_keys[mid].m_time)
+                end = mid;
+            else begin = mid;
+        }
     }
 
-    const float begin_time = m_keys[begin].m_time;
-    const float end_time = m_keys[end].m_time;
+    const TransformKey& begin_key = m_keys[begin];
+    const TransformKey& end_key = m_keys[begin + 1];
+
+    assert(end_key.m_time > begin_key.m_time);
 
-    assert(end_time > begin_time);
+    const double t = static_cast<double>((time - begin_key.m_time) / (end_key.m_time - begin_key.m_time));
 
-    const float t = (time - begin_time) / (end_time - begin_time);
+    const Segment& segment = m_segments[begin];
 
-    m_interpolators[begin].evaluate(static_cast<double>(t), result);
+    if (segment.m_linear)
+    {
+        // Rotation and scaling are constant: both matrices are exactly linear in time.
+        result.set_local_to_parent(
+            lerp_matrices(
+                begin_key.m_transform.get_local_to_parent(),
+                end_key.m_transform.get_local_to_parent(),
+                t));
+        result.set_parent_to_local(
+            lerp_matrices(
+                begin_key.m_transform.get_parent_to_local(),
+                end_key.m_transform.get_parent_to_local(),
+                t));
+    }
+    else segment.m_interpolator.evaluate(t, result);
 }
 
 namespace
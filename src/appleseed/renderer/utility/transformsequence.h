@@ -124,6 +124,14 @@ class APPLESEED_DLLSYMBOL TransformSequence
     template <typename T>
     foundation::AABB<T, 3> to_parent(const foundation::AABB<T, 3>& bbox) const;
 
+    // Transform a 3D axis-aligned bounding box across the part of the motion between two times.
+    // This method can only be called after prepare() has been called.
+    // If the bounding box is invalid, it is returned unmodified.
+    foundation::AABB3d to_parent(
+        const foundation::AABB3d&       bbox,
+        const float                     time_begin,
+        const float                     time_end) const;
+
   private:
     struct TransformKey
     {
@@ -136,10 +144,19 @@ class APPLESEED_DLLSYMBOL TransformSequence
         }
     };
 
+    struct Segment
+    {
+        foundation::TransformInterpolatord  m_interpolator;
+
+        // True if rotation and scaling are constant over the segment, in which case
+        // both transformation matrices are linear in time and are lerped directly.
+        bool                                m_linear;
+    };
+
     size_t                              m_capacity;
     size_t                              m_size;
     TransformKey*                       m_keys;
-    foundation::TransformInterpolatord* m_interpolators;
+    Segment*                            m_segments;
     bool                                m_can_swap_handedness;
     bool                                m_all_swap_handedness;
 
@@ -188,7 +205,7 @@ APPLESEED_FORCE_INLINE const foundation::Transformd& TransformSequence::evaluate
     if (m_size == 0)
         return foundation::Transformd::identity();
 
-    assert(m_size == 1 || m_interpolators != 0);
+    assert(m_size == 1 || m_segments != 0);
 
     const TransformKey* first = m_keys;
 
@@ -50,13 +50,37 @@ CommandLineHandler::CommandLineHandler()
 
     parser().set_default_option_handler(
         &m_filenames
-            .set_exact_value_count(2));
+            .set_min_value_count(1));
 
     parser().add_option_handler(
         &m_print_bboxes
             .add_name("--print-bounding-boxes")
             .add_name("-b")
             .set_description("print mesh bounding boxes"));
+
+    parser().add_option_handler(
+        &m_batch
+            .add_name("--batch")
+            .add_name("-B")
+            .set_description("convert all input files to the given format, next to the input files or in the output directory")
+            .set_syntax("extension")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_output_directory
+            .add_name("--output-directory")
+            .add_name("-o")
+            .set_description("set the directory where converted files are written in batch mode")
+            .set_syntax("directory")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_threads
+            .add_name("--threads")
+            .add_name("-t")
+            .set_description("set the number of files converted concurrently in batch mode (default: number of logical cores)")
+            .set_syntax("n")
+            .set_exact_value_count(1));
 }
 
 void CommandLineHandler::print_program_usage(
@@ -68,6 +92,7 @@ void CommandLineHandler::print_program_usage(
     logger.set_format(LogMessage::Info, "{message}");
 
     LOG_INFO(logger, "usage: %s [options] input-file output-file", executable_name);
+    LOG_INFO(logger, "       %s [options] --batch extension input-file...", executable_name);
     LOG_INFO(logger, "options:");
 
     parser().print_usage(logger);
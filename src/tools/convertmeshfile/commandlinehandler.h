@@ -55,6 +55,9 @@ class CommandLineHandler
   public:
     foundation::ValueOptionHandler<std::string> m_filenames;
     foundation::FlagOptionHandler               m_print_bboxes;
+    foundation::ValueOptionHandler<std::string> m_batch;
+    foundation::ValueOptionHandler<std::string> m_output_directory;
+    foundation::ValueOptionHandler<size_t>      m_threads;
 
     // Constructor.
     CommandLineHandler();
@@ -41,16 +41,22 @@
 #include "foundation/mesh/genericmeshfilewriter.h"
 #include "foundation/mesh/imeshbuilder.h"
 #include "foundation/mesh/imeshwalker.h"
+#include "foundation/platform/atomic.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/system.h"
 #include "foundation/utility/containers/dictionary.h"
-#include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/filesystem/path.hpp"
 
 // Standard headers.
 #include <cstddef>
 #include <deque>
 #include <exception>
-#include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -58,6 +64,7 @@ using namespace appleseed::convertmeshfile;
 using namespace appleseed::shared;
 using namespace foundation;
 using namespace std;
+namespace bf = boost::filesystem;
 
 namespace
 {
@@ -79,93 +86,6 @@ namespace
         deque<Face>         m_faces;
     };
 
-    class MeshBuilder
-      : public IMeshBuilder
-    {
-      public:
-        const list<Mesh>& get_meshes() const
-        {
-            return m_meshes;
-        }
-
-        virtual void begin_mesh(const char* name) APPLESEED_OVERRIDE
-        {
-            m_current_mesh = Mesh();
-            m_current_mesh.m_name = name;
-        }
-
-        virtual size_t push_vertex(const Vector3d& v) APPLESEED_OVERRIDE
-        {
-            m_current_mesh.m_vertices.push_back(v);
-            return m_current_mesh.m_vertices.size() - 1;
-        }
-
-        virtual size_t push_vertex_normal(const Vector3d& v) APPLESEED_OVERRIDE
-        {
-            m_current_mesh.m_vertex_normals.push_back(safe_normalize(v));
-            return m_current_mesh.m_vertex_normals.size() - 1;
-        }
-
-        virtual size_t push_tex_coords(const Vector2d& v) APPLESEED_OVERRIDE
-        {
-            m_current_mesh.m_tex_coords.push_back(v);
-            return m_current_mesh.m_tex_coords.size() - 1;
-        }
-
-        virtual size_t push_material_slot(const char* name) APPLESEED_OVERRIDE
-        {
-            m_current_mesh.m_material_slots.push_back(name);
-            return m_current_mesh.m_material_slots.size() - 1;
-        }
-
-        virtual void begin_face(const size_t vertex_count) APPLESEED_OVERRIDE
-        {
-            m_current_face = Face();
-            m_current_face.m_vertices.resize(vertex_count);
-            m_current_face.m_vertex_normals.resize(vertex_count);
-            m_current_face.m_vertex_tex_coords.resize(vertex_count);
-            m_current_face.m_material = 0;
-        }
-
-        virtual void set_face_vertices(const size_t vertices[]) APPLESEED_OVERRIDE
-        {
-            for (size_t i = 0; i < m_current_face.m_vertices.size(); ++i)
-                m_current_face.m_vertices[i] = vertices[i];
-        }
-
-        virtual void set_face_vertex_normals(const size_t vertex_normals[]) APPLESEED_OVERRIDE
-        {
-            for (size_t i = 0; i < m_current_face.m_vertex_normals.size(); ++i)
-                m_current_face.m_vertex_normals[i] = vertex_normals[i];
-        }
-
-        virtual void set_face_vertex_tex_coords(const size_t tex_coords[]) APPLESEED_OVERRIDE
-        {
-            for (size_t i = 0; i < m_current_face.m_vertex_tex_coords.size(); ++i)
-                m_current_face.m_vertex_tex_coords[i] = tex_coords[i];
-        }
-
-        virtual void set_face_material(const size_t material) APPLESEED_OVERRIDE
-        {
-            m_current_face.m_material = material;
-        }
-
-        virtual void end_face() APPLESEED_OVERRIDE
-        {
-            m_current_mesh.m_faces.push_back(m_current_face);
-        }
-
-        virtual void end_mesh() APPLESEED_OVERRIDE
-        {
-            m_meshes.push_back(m_current_mesh);
-        }
-
-      private:
-        list<Mesh>  m_meshes;
-        Mesh        m_current_mesh;
-        Face        m_current_face;
-    };
-
     class MeshWalker
       : public IMeshWalker
     {
@@ -269,6 +189,220 @@ namespace
             bbox.min[0], bbox.min[1], bbox.min[2],
             bbox.max[0], bbox.max[1], bbox.max[2]);
     }
+
+    //
+    // A mesh builder that writes each mesh to the output file as soon as it is complete,
+    // such that at most one mesh is held in memory at any given time.
+    //
+
+    class StreamingMeshConverter
+      : public IMeshBuilder
+    {
+      public:
+        StreamingMeshConverter(
+            Logger&                 logger,
+            const string&           output_filepath,
+            const bool              print_bboxes)
+          : m_logger(logger)
+          , m_output_filepath(output_filepath)
+          , m_print_bboxes(print_bboxes)
+          , m_mesh_count(0)
+        {
+        }
+
+        size_t get_mesh_count() const
+        {
+            return m_mesh_count;
+        }
+
+        virtual void begin_mesh(const char* name) APPLESEED_OVERRIDE
+        {
+            m_current_mesh = Mesh();
+            m_current_mesh.m_name = name;
+        }
+
+        virtual size_t push_vertex(const Vector3d& v) APPLESEED_OVERRIDE
+        {
+            m_current_mesh.m_vertices.push_back(v);
+            return m_current_mesh.m_vertices.size() - 1;
+        }
+
+        virtual size_t push_vertex_normal(const Vector3d& v) APPLESEED_OVERRIDE
+        {
+            m_current_mesh.m_vertex_normals.push_back(safe_normalize(v));
+            return m_current_mesh.m_vertex_normals.size() - 1;
+        }
+
+        virtual size_t push_tex_coords(const Vector2d& v) APPLESEED_OVERRIDE
+        {
+            m_current_mesh.m_tex_coords.push_back(v);
+            return m_current_mesh.m_tex_coords.size() - 1;
+        }
+
+        virtual size_t push_material_slot(const char* name) APPLESEED_OVERRIDE
+        {
+            m_current_mesh.m_material_slots.push_back(name);
+            return m_current_mesh.m_material_slots.size() - 1;
+        }
+
+        virtual void begin_face(const size_t vertex_count) APPLESEED_OVERRIDE
+        {
+            m_current_face = Face();
+            m_current_face.m_vertices.resize(vertex_count);
+            m_current_face.m_vertex_normals.resize(vertex_count);
+            m_current_face.m_vertex_tex_coords.resize(vertex_count);
+            m_current_face.m_material = 0;
+        }
+
+        virtual void set_face_vertices(const size_t vertices[]) APPLESEED_OVERRIDE
+        {
+            for (size_t i = 0; i < m_current_face.m_vertices.size(); ++i)
+                m_current_face.m_vertices[i] = vertices[i];
+        }
+
+        virtual void set_face_vertex_normals(const size_t vertex_normals[]) APPLESEED_OVERRIDE
+        {
+            for (size_t i = 0; i < m_current_face.m_vertex_normals.size(); ++i)
+                m_current_face.m_vertex_normals[i] = vertex_normals[i];
+        }
+
+        virtual void set_face_vertex_tex_coords(const size_t tex_coords[]) APPLESEED_OVERRIDE
+        {
+            for (size_t i = 0; i < m_current_face.m_vertex_tex_coords.size(); ++i)
+                m_current_face.m_vertex_tex_coords[i] = tex_coords[i];
+        }
+
+        virtual void set_face_material(const size_t material) APPLESEED_OVERRIDE
+        {
+            m_current_face.m_material = material;
+        }
+
+        virtual void end_face() APPLESEED_OVERRIDE
+        {
+            m_current_mesh.m_faces.push_back(m_current_face);
+        }
+
+        virtual void end_mesh() APPLESEED_OVERRIDE
+        {
+            // Optionally print the bounding box of the mesh.
+            if (m_print_bboxes)
+                print_bbox(m_logger, m_current_mesh);
+
+            // Only create the output file once there is something to write to it.
+            if (m_writer.get() == 0)
+                m_writer.reset(new GenericMeshFileWriter(m_output_filepath.c_str()));
+
+            const MeshWalker walker(m_current_mesh);
+            m_writer->write(walker);
+
+            // Release the memory held by the mesh.
+            m_current_mesh = Mesh();
+            ++m_mesh_count;
+        }
+
+      private:
+        Logger&                         m_logger;
+        const string                    m_output_filepath;
+        const bool                      m_print_bboxes;
+        auto_ptr<GenericMeshFileWriter> m_writer;
+        size_t                          m_mesh_count;
+        Mesh                            m_current_mesh;
+        Face                            m_current_face;
+    };
+
+    // Convert a single mesh file. Return true on success.
+    bool convert_mesh_file(
+        Logger&                     logger,
+        const string&               input_filepath,
+        const string&               output_filepath,
+        const bool                  print_bboxes)
+    {
+        StreamingMeshConverter converter(logger, output_filepath, print_bboxes);
+
+        try
+        {
+            GenericMeshFileReader reader(input_filepath.c_str());
+            reader.read(converter);
+        }
+        catch (const exception& e)
+        {
+            LOG_ERROR(
+                logger,
+                "could not convert mesh file %s to %s (%s).",
+                input_filepath.c_str(),
+                output_filepath.c_str(),
+                e.what());
+            return false;
+        }
+
+        // Print a warning message if no mesh were defined in the input file.
+        if (converter.get_mesh_count() == 0)
+            LOG_WARNING(logger, "no mesh defined in %s.", input_filepath.c_str());
+
+        return true;
+    }
+
+    //
+    // A job converting one mesh file.
+    //
+
+    class ConvertMeshFileJob
+      : public IJob
+    {
+      public:
+        ConvertMeshFileJob(
+            Logger&                 logger,
+            const string&           input_filepath,
+            const string&           output_filepath,
+            const bool              print_bboxes,
+            boost::atomic<size_t>&  failure_count)
+          : m_logger(logger)
+          , m_input_filepath(input_filepath)
+          , m_output_filepath(output_filepath)
+          , m_print_bboxes(print_bboxes)
+          , m_failure_count(failure_count)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+        {
+            if (convert_mesh_file(m_logger, m_input_filepath, m_output_filepath, m_print_bboxes))
+            {
+                LOG_INFO(
+                    m_logger,
+                    "converted %s to %s.",
+                    m_input_filepath.c_str(),
+                    m_output_filepath.c_str());
+            }
+            else ++m_failure_count;
+        }
+
+      private:
+        Logger&                     m_logger;
+        const string                m_input_filepath;
+        const string                m_output_filepath;
+        const bool                  m_print_bboxes;
+        boost::atomic<size_t>&      m_failure_count;
+    };
+
+    // Compute the path of the file a given input file is converted to in batch mode.
+    string make_batch_output_filepath(
+        const string&               input_filepath,
+        const string&               output_extension,
+        const string&               output_directory)
+    {
+        bf::path output_filepath(input_filepath);
+
+        if (!output_directory.empty())
+            output_filepath = bf::path(output_directory) / output_filepath.filename();
+
+        const string extension =
+            !output_extension.empty() && output_extension[0] != '.'
+                ? "." + output_extension
+                : output_extension;
+
+        return output_filepath.replace_extension(extension).string();
+    }
 }
 
 
@@ -296,58 +430,68 @@ int main(int argc, const char* argv[])
     // Apply command line arguments.
     cl.apply(logger);
 
-    // Retrieve the input and output file paths.
-    const string& input_filepath = cl.m_filenames.values()[0];
-    const string& output_filepath = cl.m_filenames.values()[1];
+    const bool print_bboxes = cl.m_print_bboxes.is_set();
 
-    // Read the input mesh file.
-    MeshBuilder builder;
-    try
+    // Convert a single mesh file.
+    if (!cl.m_batch.is_set())
     {
-        GenericMeshFileReader reader(input_filepath.c_str());
-        reader.read(builder);
-    }
-    catch (const exception& e)
-    {
-        LOG_FATAL(
-            logger,
-            "could not read mesh file %s (%s).",
-            input_filepath.c_str(),
-            e.what());
-    }
+        if (cl.m_filenames.values().size() != 2)
+        {
+            LOG_ERROR(logger, "expected an input file and an output file.");
+            return 1;
+        }
 
-    // Print a warning message and exit if no mesh were defined in the input file.
-    if (builder.get_meshes().empty())
-    {
-        LOG_WARNING(logger, "no mesh defined.");
-        return 0;
-    }
+        const bool success =
+            convert_mesh_file(
+                logger,
+                cl.m_filenames.values()[0],
+                cl.m_filenames.values()[1],
+                print_bboxes);
 
-    // Optionally print the bounding box of each loaded mesh.
-    if (cl.m_print_bboxes.is_set())
-    {
-        for (const_each<list<Mesh> > i = builder.get_meshes(); i; ++i)
-            print_bbox(logger, *i);
+        return success ? 0 : 1;
     }
 
-    // Write the output mesh file.
-    GenericMeshFileWriter writer(output_filepath.c_str());
-    try
-    {
-        for (const_each<list<Mesh> > i = builder.get_meshes(); i; ++i)
-        {
-            const MeshWalker walker(*i);
-            writer.write(walker);
-        }
-    }
-    catch (const exception& e)
+    // Convert a batch of mesh files concurrently.
+    const string& output_extension = cl.m_batch.value();
+    const string output_directory =
+        cl.m_output_directory.is_set() ? cl.m_output_directory.value() : string();
+    const size_t thread_count =
+        cl.m_threads.is_set() && cl.m_threads.value() > 0
+            ? cl.m_threads.value()
+            : System::get_available_cpu_core_count();
+
+    JobQueue job_queue;
+    boost::atomic<size_t> failure_count(0);
+
+    const vector<string>& input_filepaths = cl.m_filenames.values();
+    for (size_t i = 0; i < input_filepaths.size(); ++i)
     {
-        LOG_FATAL(
-            logger,
-            "could not write mesh file %s (%s).",
-            output_filepath.c_str(),
-            e.what());
+        job_queue.schedule(
+            new ConvertMeshFileJob(
+                logger,
+                input_filepaths[i],
+                make_batch_output_filepath(input_filepaths[i], output_extension, output_directory),
+                print_bboxes,
+                failure_count));
     }
 
-    return 0;
+    JobManager job_manager(
+        logger,
+        job_queue,
+        thread_count,
+        JobManager::KeepRunningOnEmptyQueue);
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    const size_t failures = failure_count;
+    LOG_INFO(
+        logger,
+        "converted %s out of %s mesh file%s using %s thread%s.",
+        pretty_uint(input_filepaths.size() - failures).c_str(),
+        pretty_uint(input_filepaths.size()).c_str(),
+        input_filepaths.size() > 1 ? "s" : "",
+        pretty_uint(thread_count).c_str(),
+        thread_count > 1 ? "s" : "");
+
+    return failures == 0 ? 0 : 1;
 }
@@ -130,6 +130,14 @@ CommandLineHandler::CommandLineHandler()
             .set_syntax("regex")
             .set_exact_value_count(1)
             .set_default_value("/(?!)/"));      // match nothing -- http://stackoverflow.com/a/4589566/393756
+
+    parser().add_option_handler(
+        &m_threads
+            .add_name("--threads")
+            .add_name("-t")
+            .set_description("set the number of threads generating curves (default: number of logical cores)")
+            .set_syntax("n")
+            .set_exact_value_count(1));
 }
 
 void CommandLineHandler::print_program_usage(
@@ -63,6 +63,7 @@ class CommandLineHandler
     foundation::ValueOptionHandler<size_t>          m_presplits;
     foundation::ValueOptionHandler<std::string>     m_include;
     foundation::ValueOptionHandler<std::string>     m_exclude;
+    foundation::ValueOptionHandler<size_t>          m_threads;
 
     // Constructor.
     CommandLineHandler();
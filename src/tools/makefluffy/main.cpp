@@ -39,6 +39,7 @@
 #include "renderer/api/scene.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/cdf.h"
 #include "foundation/math/qmc.h"
 #include "foundation/math/rng/distribution.h"
@@ -46,10 +47,14 @@
 #include "foundation/math/sampling/mappings.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/filter.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/memory.h"
 #include "foundation/utility/uid.h"
 
 // Boost headers.
@@ -60,7 +65,9 @@
 #include <cassert>
 #include <cstddef>
 #include <cstring>
+#include <deque>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -89,6 +96,7 @@ namespace
         GScalar     m_length_fuzziness;
         GScalar     m_curliness;
         size_t      m_split_count;
+        size_t      m_thread_count;
 
         explicit FluffParams(const CommandLineHandler& cl)
         {
@@ -102,6 +110,10 @@ namespace
             m_length_fuzziness = static_cast<GScalar>(cl.m_length_fuzziness.value());
             m_curliness = static_cast<GScalar>(cl.m_curliness.value());
             m_split_count = cl.m_presplits.value();
+            m_thread_count =
+                cl.m_threads.is_set() && cl.m_threads.value() > 0
+                    ? cl.m_threads.value()
+                    : System::get_available_cpu_core_count();
         }
     };
 
@@ -161,7 +173,7 @@ namespace
     }
 
     void split_and_store(
-        CurveObject&                object,
+        vector<Curve3Type>&         curves,
         const Curve3Type&           curve,
         const size_t                split_count)
     {
@@ -169,69 +181,108 @@ namespace
         {
             Curve3Type child1, child2;
             curve.split(child1, child2);
-            split_and_store(object, child1, split_count - 1);
-            split_and_store(object, child2, split_count - 1);
+            split_and_store(curves, child1, split_count - 1);
+            split_and_store(curves, child2, split_count - 1);
         }
-        else object.push_curve3(curve);
+        else curves.push_back(curve);
     }
 
-    auto_release_ptr<CurveObject> create_curve_object(
-        const Assembly&             assembly,
-        const MeshObject&           support_object,
-        const FluffParams&          params)
-    {
-        const size_t ControlPointCount = 4;
-
-        vector<SupportTriangle> support_triangles;
-        CDF<size_t, GScalar> cdf;
-        extract_support_triangles(support_object, support_triangles, cdf);
+    // Number of curves generated by a single job.
+    const size_t CurveChunkSize = 16 * 1024;
 
-        const string curve_object_name = string(support_object.get_name()) + "_curves";
-        auto_release_ptr<CurveObject> curve_object =
-            CurveObjectFactory::create(
-                curve_object_name.c_str(),
-                ParamArray());
-
-        curve_object->reserve_curves3(params.m_curve_count);
+    // Support geometry of a mesh object, shared by all the jobs generating its curves.
+    struct SupportGeometry
+    {
+        vector<SupportTriangle>     m_triangles;
+        CDF<size_t, GScalar>        m_cdf;
+    };
 
-        GVector3 points[ControlPointCount];
-        GScalar widths[ControlPointCount];
+    //
+    // A job generating a contiguous range of the curves of a curve object.
+    //
+    // Each curve is rooted on the support triangle selected by its Hammersley sample,
+    // so a range of curves covers a region of the support mesh's area. Every job has
+    // its own random number generator, seeded by the index of the range, such that the
+    // result does not depend on the number of threads.
+    //
 
-        MersenneTwister rng;
+    class GenerateCurvesJob
+      : public IJob
+    {
+      public:
+        GenerateCurvesJob(
+            const SupportGeometry&  support_geometry,
+            const FluffParams&      params,
+            const size_t            begin,
+            const size_t            end,
+            vector<Curve3Type>&     curves)
+          : m_support_geometry(support_geometry)
+          , m_params(params)
+          , m_begin(begin)
+          , m_end(end)
+          , m_curves(curves)
+        {
+        }
 
-        for (size_t i = 0; i < params.m_curve_count; ++i)
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
         {
-            static const size_t Bases[] = { 2, 3 };
-            const GVector3 s(hammersley_sequence<double, 3>(Bases, params.m_curve_count, i));
+            const size_t ControlPointCount = 4;
 
-            const size_t triangle_index = cdf.sample(s[0]).first;
-            const SupportTriangle& st = support_triangles[triangle_index];
-            const GVector3 bary = sample_triangle_uniform(GVector2(s[1], s[2]));
+            GVector3 points[ControlPointCount];
+            GScalar widths[ControlPointCount];
 
-            points[0] = st.m_v0 * bary[0] + st.m_v1 * bary[1] + st.m_v2 * bary[2];
-            widths[0] = params.m_root_width;
+            MersenneTwister rng(static_cast<uint32>(m_begin / CurveChunkSize));
 
-            GScalar f, length;
-            do
-            {
-                f = rand1(rng, -params.m_length_fuzziness, +params.m_length_fuzziness);
-                length = max(params.m_curve_length * (GScalar(1.0) + f), GScalar(0.0));
-            } while (length <= 0.0);
+            m_curves.reserve((m_end - m_begin) << m_params.m_split_count);
 
-            for (size_t p = 1; p < ControlPointCount; ++p)
+            for (size_t i = m_begin; i < m_end; ++i)
             {
-                const GScalar r = static_cast<GScalar>(p) / (ControlPointCount - 1);
-                const GVector3 f = params.m_curliness * sample_sphere_uniform(rand_vector2<GVector2>(rng));
-                points[p] = points[0] + length * (r * st.m_normal + f);
-                widths[p] = lerp(params.m_root_width, params.m_tip_width, r);
+                static const size_t Bases[] = { 2, 3 };
+                const GVector3 s(hammersley_sequence<double, 3>(Bases, m_params.m_curve_count, i));
+
+                const size_t triangle_index = m_support_geometry.m_cdf.sample(s[0]).first;
+                const SupportTriangle& st = m_support_geometry.m_triangles[triangle_index];
+                const GVector3 bary = sample_triangle_uniform(GVector2(s[1], s[2]));
+
+                points[0] = st.m_v0 * bary[0] + st.m_v1 * bary[1] + st.m_v2 * bary[2];
+                widths[0] = m_params.m_root_width;
+
+                GScalar f, length;
+                do
+                {
+                    f = rand1(rng, -m_params.m_length_fuzziness, +m_params.m_length_fuzziness);
+                    length = max(m_params.m_curve_length * (GScalar(1.0) + f), GScalar(0.0));
+                } while (length <= 0.0);
+
+                for (size_t p = 1; p < ControlPointCount; ++p)
+                {
+                    const GScalar r = static_cast<GScalar>(p) / (ControlPointCount - 1);
+                    const GVector3 f = m_params.m_curliness * sample_sphere_uniform(rand_vector2<GVector2>(rng));
+                    points[p] = points[0] + length * (r * st.m_normal + f);
+                    widths[p] = lerp(m_params.m_root_width, m_params.m_tip_width, r);
+                }
+
+                const Curve3Type curve(&points[0], &widths[0]);
+                split_and_store(m_curves, curve, m_params.m_split_count);
             }
-
-            const Curve3Type curve(&points[0], &widths[0]);
-            split_and_store(curve_object.ref(), curve, params.m_split_count);
         }
 
-        return curve_object;
-    }
+      private:
+        const SupportGeometry&      m_support_geometry;
+        const FluffParams&          m_params;
+        const size_t                m_begin;
+        const size_t                m_end;
+        vector<Curve3Type>&         m_curves;
+    };
+
+    // Curve object being generated for a given support mesh object.
+    struct CurveObjectTask
+      : public NonCopyable
+    {
+        const MeshObject*           m_support_object;
+        SupportGeometry             m_support_geometry;
+        deque<vector<Curve3Type> >  m_chunks;
+    };
 
     void make_fluffy(const Assembly& assembly, const FluffParams& params)
     {
@@ -263,15 +314,64 @@ namespace
                 static_cast<const MeshObject*>(object)].push_back(&object_instance);
         }
 
-        // Loop over the collected objects.
+        // Schedule the generation of the curves of all collected objects.
+        JobQueue job_queue;
+        vector<CurveObjectTask*> tasks;
         for (const_each<ObjectToInstanceMap> i = objects_to_instances; i; ++i)
         {
-            const MeshObject& support_object = *i->first;
-            const ObjectInstanceVector& support_object_instances = i->second;
+            tasks.push_back(new CurveObjectTask());
+            CurveObjectTask& task = *tasks.back();
+            task.m_support_object = i->first;
+
+            extract_support_triangles(
+                *task.m_support_object,
+                task.m_support_geometry.m_triangles,
+                task.m_support_geometry.m_cdf);
+
+            for (size_t begin = 0; begin < params.m_curve_count; begin += CurveChunkSize)
+            {
+                task.m_chunks.push_back(vector<Curve3Type>());
+                job_queue.schedule(
+                    new GenerateCurvesJob(
+                        task.m_support_geometry,
+                        params,
+                        begin,
+                        min(begin + CurveChunkSize, params.m_curve_count),
+                        task.m_chunks.back()));
+            }
+        }
+
+        // Generate the curves.
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            params.m_thread_count,
+            JobManager::KeepRunningOnEmptyQueue);
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        // Create the curve objects and instantiate them into the assembly.
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            const auto_ptr<CurveObjectTask> task(tasks[i]);
+            const MeshObject& support_object = *task->m_support_object;
+            const ObjectInstanceVector& support_object_instances = objects_to_instances[&support_object];
 
             // Create a curve object.
+            const string curve_object_name = string(support_object.get_name()) + "_curves";
             auto_release_ptr<CurveObject> curve_object =
-                create_curve_object(assembly, support_object, params);
+                CurveObjectFactory::create(
+                    curve_object_name.c_str(),
+                    ParamArray());
+
+            // Store the curves, releasing chunks as soon as they are copied.
+            curve_object->reserve_curves3(params.m_curve_count << params.m_split_count);
+            for (each<deque<vector<Curve3Type> > > j = task->m_chunks; j; ++j)
+            {
+                for (size_t k = 0; k < j->size(); ++k)
+                    curve_object->push_curve3((*j)[k]);
+                clear_release_memory(*j);
+            }
 
             // Instantiate the curve object into the assembly.
             for (const_each<ObjectInstanceVector> j = support_object_instances; j; ++j)
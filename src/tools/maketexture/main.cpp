@@ -0,0 +1,150 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Project headers.
+#include "commandlinehandler.h"
+
+// appleseed.shared headers.
+#include "application/application.h"
+#include "application/superlogger.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/genericimagefilereader.h"
+#include "foundation/image/image.h"
+#include "foundation/image/texturefilewriter.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/log.h"
+
+// Standard headers.
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string>
+
+using namespace appleseed::maketexture;
+using namespace appleseed::shared;
+using namespace foundation;
+using namespace std;
+
+
+//
+// Entry point of maketexture.
+//
+
+int main(int argc, const char* argv[])
+{
+    // Initialize the logger that will be used throughout the program.
+    SuperLogger logger;
+
+    // Make sure appleseed is correctly installed.
+    Application::check_installation(logger);
+
+    // Parse the command line.
+    CommandLineHandler cl;
+    cl.parse(argc, argv, logger);
+
+    // Load an apply settings from the settings file.
+    Dictionary settings;
+    Application::load_settings("appleseed.tools.xml", settings, logger);
+    logger.configure_from_settings(settings);
+
+    // Apply command line arguments.
+    cl.apply(logger);
+
+    // Retrieve the input and output file paths.
+    const string& input_filepath = cl.m_filenames.values()[0];
+    const string& output_filepath = cl.m_filenames.values()[1];
+
+    // Retrieve the color space of the input image.
+    const string& color_space_name = cl.m_color_space.value();
+    ColorSpace color_space;
+    if (color_space_name == "linear_rgb")
+        color_space = ColorSpaceLinearRGB;
+    else if (color_space_name == "srgb")
+        color_space = ColorSpaceSRGB;
+    else if (color_space_name == "ciexyz")
+        color_space = ColorSpaceCIEXYZ;
+    else
+    {
+        LOG_FATAL(logger, "invalid color space: %s.", color_space_name.c_str());
+        return 1;
+    }
+
+    const size_t tile_size = cl.m_tile_size.value();
+    if (tile_size == 0)
+    {
+        LOG_FATAL(logger, "invalid tile size: tile size must be greater than zero.");
+        return 1;
+    }
+
+    // Read the input image.
+    auto_ptr<Image> image;
+    try
+    {
+        GenericImageFileReader reader;
+        image.reset(reader.read(input_filepath.c_str()));
+    }
+    catch (const exception& e)
+    {
+        LOG_FATAL(
+            logger,
+            "could not read image file %s (%s).",
+            input_filepath.c_str(),
+            e.what());
+    }
+
+    // Retile the image.
+    const CanvasProperties& props = image->properties();
+    if (props.m_tile_width != tile_size || props.m_tile_height != tile_size)
+        image.reset(new Image(*image, tile_size, tile_size, props.m_pixel_format));
+
+    // Write the texture file.
+    int options = TextureFileWriter::Defaults;
+    if (cl.m_compress.is_set())
+        options |= TextureFileWriter::Compress;
+    if (cl.m_no_mip_levels.is_set())
+        options |= TextureFileWriter::BaseLevelOnly;
+
+    try
+    {
+        TextureFileWriter writer(output_filepath.c_str(), options);
+        writer.write(*image, color_space);
+    }
+    catch (const exception& e)
+    {
+        LOG_FATAL(
+            logger,
+            "could not write texture file %s (%s).",
+            output_filepath.c_str(),
+            e.what());
+    }
+
+    return 0;
+}
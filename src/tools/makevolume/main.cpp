@@ -0,0 +1,130 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Project headers.
+#include "commandlinehandler.h"
+// Project headers.
+#include "commandlinehandler.h"
+
+// appleseed.shared headers.
+#include "application/application.h"
+#include "application/superlogger.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/volume.h"
+#include "renderer/kernel/volume/volumefilewriter.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/log.h"
+
+// Standard headers.
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string>
+
+using namespace appleseed::makevolume;
+using namespace appleseed::shared;
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+
+//
+// Entry point of makevolume.
+//
+
+int main(int argc, const char* argv[])
+{
+    // Initialize the logger that will be used throughout the program.
+    SuperLogger logger;
+
+    // Make sure appleseed is correctly installed.
+    Application::check_installation(logger);
+
+    // Parse the command line.
+    CommandLineHandler cl;
+    cl.parse(argc, argv, logger);
+
+    // Load an apply settings from the settings file.
+    Dictionary settings;
+    Application::load_settings("appleseed.tools.xml", settings, logger);
+    logger.configure_from_settings(settings);
+
+    // Apply command line arguments.
+    cl.apply(logger);
+
+    // Retrieve the input and output file paths.
+    const string& input_filepath = cl.m_filenames.values()[0];
+    const string& output_filepath = cl.m_filenames.values()[1];
+
+    const size_t brick_size = cl.m_brick_size.value();
+    if (brick_size == 0)
+    {
+        LOG_FATAL(logger, "invalid brick size: brick size must be greater than zero.");
+        return 1;
+    }
+
+    // Read the input fluid file.
+    FluidChannels channels;
+    auto_ptr<VoxelGrid> grid;
+    try
+    {
+        grid = read_fluid_file(input_filepath.c_str(), channels);
+    }
+    catch (const exception& e)
+    {
+        LOG_FATAL(
+            logger,
+            "could not read fluid file %s (%s).",
+            input_filepath.c_str(),
+            e.what());
+    }
+
+    // Write the volume file.
+    int options = VolumeFileWriter::Defaults;
+    if (cl.m_compress.is_set())
+        options |= VolumeFileWriter::Compress;
+
+    try
+    {
+        VolumeFileWriter writer(output_filepath.c_str(), options, brick_size);
+        writer.write(*grid, channels.get_channel_names());
+    }
+    catch (const exception& e)
+    {
+        LOG_FATAL(
+            logger,
+            "could not write volume file %s (%s).",
+            output_filepath.c_str(),
+            e.what());
+    }
+
+    return 0;
+}